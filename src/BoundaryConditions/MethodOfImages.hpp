@@ -58,21 +58,61 @@ public:
 	PID_VECTOR_TYPE pid_mirror; ///< Vector containing indices of mirror particles.
 	vd_subset_type Mirror; ///< Subset containing the mirror particles.
 	vd_subset_type Real;
-	openfpm::vector<openfpm::vector<size_t>> key_map_source_mirror;
+	size_t id_first_mirror = 0; ///< ID of the first mirror particle, the mirror of the source i has ID id_first_mirror + i.
+	bool mirrors_allocated = false; ///< True once the block of mirror particles has been added to vd.
+	
+	/**@brief Get the ID of the i-th source particle.
+	 *
+	 * @param i Index of the source-mirror pair.
+	 * @return ID of the source particle.
+	 */
+	size_t get_source_id(size_t i) const
+	{
+		return keys_source.get(i).getKey();
+	}
+	
+	/**@brief Get the ID of the mirror particle of the i-th source particle.
+	 *
+	 * @param i Index of the source-mirror pair.
+	 * @return ID of the mirror particle.
+	 */
+	size_t get_mirror_id(size_t i) const
+	{
+		return id_first_mirror + i;
+	}
 	
 	/**@brief Place mirror particles along the surface normal.
+	 *
+	 * @details The first call adds all the mirror particles at the end of the local particles with one resize, so
+	 * the mirror of the source i is the particle id_first_mirror + i and no source-mirror map has to be stored. The
+	 * following calls update the positions of the same mirror particles in place (for example after the surface
+	 * normals changed), nothing is removed or added. vd.map() changes the IDs of the particles, after a map a new
+	 * MethodOfImages has to be created.
 	 *
 	 * @param vd Input particle vector_dist of type vd_type.
 	 */
 	void get_mirror_particles(vd_type & vd)
 	{
-		auto lastReal = vd.size_local();
-		for (int i = 0; i < keys_source.size(); i++)
+		if (mirrors_allocated && vd.size_local() != id_first_mirror + keys_source.size())
+		{
+			std::cerr << __FILE__ << ":" << __LINE__ << " Error: the number of local particles changed since the mirror"
+			                                            " particles have been placed. Create a new MethodOfImages after"
+			                                            " vd.map(). Aborting..." << std::endl;
+			abort();
+		}
+		
+		bool allocate = !mirrors_allocated;
+		if (allocate)
+		{
+			id_first_mirror = vd.size_local();
+			vd.resizeAtEnd(id_first_mirror + keys_source.size());
+		}
+		
+		for (size_t i = 0; i < keys_source.size(); i++)
 		{
 			auto key_source  = keys_source.get(i);
-			
-			size_t id_source = key_source.getKey();
-			size_t id_mirror = lastReal + i;
+			vect_dist_key_dx key_mirror;
+			key_mirror.setKey(get_mirror_id(i));
 			
 			point_type xp   = vd.getPos(key_source);
 			point_type n    = vd.template getProp<SurfaceNormal>(key_source);
@@ -90,21 +130,22 @@ public:
 			}
 #endif // SE_CLASS1
 			
-			vd.add();
 			for (size_t d = 0; d < vd_type::dims; d++)
 			{
-				vd.getLastPos()[d] = xm[d];
+				vd.getPos(key_mirror)[d] = xm[d];
 			}
-			vd.getLastSubset(subset_id_mirror);
-			openfpm::vector<size_t> pair = {id_source, id_mirror};
-			key_map_source_mirror.add(pair);
+			if (allocate) {vd.setSubset(key_mirror, subset_id_mirror);}
 		}
 		// No vd.map() since this would change the IDs of the particles and then we wouldn't know which source and
 		// which mirror belong to each other
 		vd.template ghost_get();
 		////////////////////////////////////////////////////////////////////////////////////////////////////////////////
-		Mirror.update();
-		pid_mirror = Mirror.getIds();
+		if (allocate)
+		{
+			Mirror.update();
+			pid_mirror = Mirror.getIds();
+			mirrors_allocated = true;
+		}
 
 #ifdef SE_CLASS1
 		check_size_mirror_source_equal();
@@ -122,13 +163,11 @@ public:
 	{
 		vd.template ghost_get<PropToMirror>(KEEP_PROPERTIES); // Update Ghost layer.
 		
-		for(int i = 0; i < key_map_source_mirror.size(); ++i)
+		for (size_t i = 0; i < keys_source.size(); ++i)
 		{
-			openfpm::vector<size_t> row = key_map_source_mirror.get(i);
-			vect_dist_key_dx key_source, key_mirror;
-			key_source.setKey(row.get(0));
-			key_mirror.setKey(row.get(1));
-			vd.template getProp<PropToMirror>(key_mirror) = vd.template getProp<PropToMirror>(key_source);
+			vect_dist_key_dx key_mirror;
+			key_mirror.setKey(get_mirror_id(i));
+			vd.template getProp<PropToMirror>(key_mirror) = vd.template getProp<PropToMirror>(keys_source.get(i));
 		}
 	}
 
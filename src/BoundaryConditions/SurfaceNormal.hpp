@@ -9,64 +9,223 @@
 // Include OpenFPM header files
 #include "Vector/vector_dist_subset.hpp"
 
+//! Minimum number of particles to start the OpenMP threads in the surface normal loops.
+#define SURFACE_NORMAL_OMP_THRESHOLD 4096
+
+/**@brief Writes the surface normal of one particle from its gradient in one fused pass.
+ *
+ * @details The magnitude is computed once and the normal is written as gradient times a single scale factor,
+ * -1/|grad| for the unit normal and -phi/|grad| otherwise.
+ *
+ * @tparam Phi_SDF Index of property storing the signed distance function.
+ * @tparam Normal Index of property to which the surface normal is written.
+ * @param vd Particle vector_dist (or its kernel version on the device).
+ * @param key Particle.
+ * @param grad Gradient of the SDF at the particle, dims components.
+ * @param unit_vector If true the unit normal is written, otherwise the normal scaled by the SDF.
+ */
+template <size_t Phi_SDF, size_t Normal, unsigned int dims, typename vd_type, typename key_type>
+__host__ __device__ inline void surface_normal_write(vd_type & vd, const key_type & key, const double (& grad)[dims],
+		bool unit_vector)
+{
+	double sum = 0;
+	for(size_t d = 0; d < dims; d++)
+	{
+		sum += grad[d] * grad[d];
+	}
+	
+	double scale = - 1.0 / sqrt(sum);
+	if(!unit_vector) {scale *= vd.template getProp<Phi_SDF>(key);}
+	
+	for(size_t d = 0; d < dims; d++)
+	{
+		vd.template getProp<Normal>(key)[d] = grad[d] * scale;
+	}
+}
+
+/**@brief Loops over n items, with OpenMP static chunks if the loop is large enough.
+ *
+ * @param n Number of items.
+ * @param f Function called for each item, f(i).
+ */
+template <typename functor>
+inline void surface_normal_loop(size_t n, functor f)
+{
+#ifdef _OPENMP
+	#pragma omp parallel for schedule(static) if (n >= SURFACE_NORMAL_OMP_THRESHOLD)
+#endif
+	for(long int i = 0; i < (long int)n; i++)
+	{
+		f(i);
+	}
+}
+
+/**@brief Computes the surface normal from the gradient of the SDF stored on the particles.
+ *
+ * @details One pass over the real particles (threaded with OpenMP), every gradient is read once.
+ *
+ * @tparam Phi_SDF Index of property storing the signed distance function.
+ * @tparam Phi_Gradient Index of property storing the gradient of the SDF.
+ * @tparam Normal Index of property to which the surface normal is written.
+ * @param vd Particle vector_dist.
+ * @param unit_vector If true the unit normal is written, otherwise the normal scaled by the SDF.
+ */
 template <size_t Phi_SDF, size_t Phi_Gradient, size_t Normal, typename vd_type>
 void get_surface_normal_sdf(vd_type & vd, bool unit_vector=false)
 {
-	auto dom = vd.getDomainIterator();
-	while(dom.isNext())
+	surface_normal_loop(vd.size_local(), [&](size_t i)
 	{
-		auto key = dom.get();
+		vect_dist_key_dx key(i);
 		
-		// Get the magnitude of the gradient
-		double sum = 0;
+		double grad[vd_type::dims];
 		for(size_t d = 0; d < vd_type::dims; d++)
 		{
-			sum += vd.template getProp<Phi_Gradient>(key)[d] * vd.template getProp<Phi_Gradient>(key)[d];
+			grad[d] = vd.template getProp<Phi_Gradient>(key)[d];
 		}
 		
-		double gradient_magnitude = sqrt(sum);
-		for(size_t d = 0; d < vd_type::dims; d++)
-		{
-			if(unit_vector)
-			{
-				vd.template getProp<Normal>(key)[d] = - vd.template getProp<Phi_Gradient>(key)[d] / gradient_magnitude;
-			}
-			else
-			{
-				vd.template getProp<Normal>(key)[d] =
-						- vd.template getProp<Phi_Gradient>(key)[d] / gradient_magnitude
-								* vd.template getProp<Phi_SDF>(key);
-			}
-		}
-		++dom;
-	}
+		surface_normal_write<Phi_SDF, Normal>(vd, key, grad, unit_vector);
+	});
 }
 
+/**@brief Computes the surface normal from the gradient of the SDF for a list of particles.
+ *
+ * @tparam Phi_SDF Index of property storing the signed distance function.
+ * @tparam Phi_Gradient Index of property storing the gradient of the SDF.
+ * @tparam Normal Index of property to which the surface normal is written.
+ * @param vd Particle vector_dist.
+ * @param keys_subset Keys of the particles.
+ * @param unit_vector If true the unit normal is written, otherwise the normal scaled by the SDF.
+ */
 template <size_t Phi_SDF, size_t Phi_Gradient, size_t Normal, typename vd_type>
 void get_surface_normal_sdf_subset(vd_type & vd, const openfpm::vector<vect_dist_key_dx> & keys_subset, bool
 unit_vector=false)
 {
-	for (int i = 0; i < keys_subset.size(); i++)
+	surface_normal_loop(keys_subset.size(), [&](size_t i)
 	{
 		auto key = keys_subset.get(i);
-
-		// Get the magnitude of the gradient
-		double sum = 0;
+		
+		double grad[vd_type::dims];
 		for(size_t d = 0; d < vd_type::dims; d++)
 		{
-			sum += vd.template getProp<Phi_Gradient>(key)[d] * vd.template getProp<Phi_Gradient>(key)[d];
+			grad[d] = vd.template getProp<Phi_Gradient>(key)[d];
 		}
 		
-		double gradient_magnitude = sqrt(sum);
+		surface_normal_write<Phi_SDF, Normal>(vd, key, grad, unit_vector);
+	});
+}
+
+/**@brief Computes the surface normal directly from a gradient expression, without storing the gradient.
+ *
+ * @details The gradient is evaluated, normalized and written to Normal in the same pass, for example with a DCPSE
+ * gradient operator:
+ *
+ * @code{.cpp}
+ * Gradient Grad(vd, 2, rCut);
+ * vd.ghost_get<Phi_SDF>();
+ * get_surface_normal_sdf_expr<Phi_SDF, Normal>(vd, Grad(getV<Phi_SDF>(vd)));
+ * @endcode
+ *
+ * @tparam Phi_SDF Index of property storing the signed distance function.
+ * @tparam Normal Index of property to which the surface normal is written.
+ * @param vd Particle vector_dist.
+ * @param grad_expr Expression returning the gradient of the SDF of a particle (value(key)).
+ * @param unit_vector If true the unit normal is written, otherwise the normal scaled by the SDF.
+ */
+template <size_t Phi_SDF, size_t Normal, typename vd_type, typename grad_expr_type>
+void get_surface_normal_sdf_expr(vd_type & vd, const grad_expr_type & grad_expr, bool unit_vector=false)
+{
+	grad_expr.init();
+	
+	surface_normal_loop(vd.size_local(), [&](size_t i)
+	{
+		vect_dist_key_dx key(i);
+		
+		auto g = grad_expr.value(key);
+		
+		double grad[vd_type::dims];
 		for(size_t d = 0; d < vd_type::dims; d++)
 		{
-			vd.template getProp<Normal>(key)[d] = - vd.template getProp<Phi_Gradient>(key)[d] / gradient_magnitude;
+			grad[d] = g[d];
 		}
-		if(!unit_vector)
+		
+		surface_normal_write<Phi_SDF, Normal>(vd, key, grad, unit_vector);
+	});
+}
+
+#ifdef __NVCC__
+
+template <size_t Phi_SDF, size_t Phi_Gradient, size_t Normal, typename vd_type>
+__global__ void get_surface_normal_sdf_gpu_ker(vd_type vd, bool unit_vector)
+{
+	auto p = GET_PARTICLE(vd);
+	
+	double grad[vd_type::dims];
+	for(size_t d = 0; d < vd_type::dims; d++)
+	{
+		grad[d] = vd.template getProp<Phi_Gradient>(p)[d];
+	}
+	
+	surface_normal_write<Phi_SDF, Normal>(vd, p, grad, unit_vector);
+}
+
+/**@brief Computes the surface normal from the gradient of the SDF on the device.
+ *
+ * @details Phi_SDF and Phi_Gradient must be on the device (for example computed by a DCPSE operator on the GPU),
+ * the normal is left on the device.
+ *
+ * @tparam Phi_SDF Index of property storing the signed distance function.
+ * @tparam Phi_Gradient Index of property storing the gradient of the SDF.
+ * @tparam Normal Index of property to which the surface normal is written.
+ * @param vd Particle vector_dist_gpu.
+ * @param unit_vector If true the unit normal is written, otherwise the normal scaled by the SDF.
+ */
+template <size_t Phi_SDF, size_t Phi_Gradient, size_t Normal, typename vd_type>
+void get_surface_normal_sdf_gpu(vd_type & vd, bool unit_vector=false)
+{
+	if (vd.size_local() == 0) {return;}
+	
+	auto it = vd.getDomainIteratorGPU(256);
+	CUDA_LAUNCH((get_surface_normal_sdf_gpu_ker<Phi_SDF, Phi_Gradient, Normal>), it, vd.toKernel(), unit_vector);
+}
+
+#endif // __NVCC__
+
+/**@brief Computes the surface normal from the gradient of the SDF stored on a grid.
+ *
+ * @tparam Phi_SDF Index of property storing the signed distance function.
+ * @tparam Phi_Gradient Index of property storing the gradient of the SDF.
+ * @tparam Normal Index of property to which the surface normal is written.
+ * @param grid Grid (grid_dist_id).
+ * @param unit_vector If true the unit normal is written, otherwise the normal scaled by the SDF.
+ */
+template <size_t Phi_SDF, size_t Phi_Gradient, size_t Normal, typename grid_type>
+void get_surface_normal_sdf_grid(grid_type & grid, bool unit_vector=false)
+{
+	auto dom = grid.getDomainIterator();
+	while(dom.isNext())
+	{
+		auto key = dom.get();
+		
+		double grad[grid_type::dims];
+		for(size_t d = 0; d < grid_type::dims; d++)
+		{
+			grad[d] = grid.template get<Phi_Gradient>(key)[d];
+		}
+		
+		double sum = 0;
+		for(size_t d = 0; d < grid_type::dims; d++)
+		{
+			sum += grad[d] * grad[d];
+		}
+		
+		double scale = - 1.0 / sqrt(sum);
+		if(!unit_vector) {scale *= grid.template get<Phi_SDF>(key);}
+		
+		for(size_t d = 0; d < grid_type::dims; d++)
 		{
-			vd.template getProp<Normal>(key) = vd.template getProp<Normal>(key) * vd.template getProp<Phi_SDF>
-			        (key);
+			grid.template get<Normal>(key)[d] = grad[d] * scale;
 		}
+		++dom;
 	}
 }
 
@@ -13,6 +13,7 @@
 
 // For the Neumann BCs (Method of images)
 #include "BoundaryConditions/MethodOfImages.hpp"
+#include "BoundaryConditions/SurfaceNormal.hpp"
 
 
 constexpr int x = 0;
@@ -179,15 +180,95 @@ BOOST_AUTO_TEST_SUITE(MethodOfImagesTestSuite)
 		BOOST_CHECK(number_of_source_particles == number_of_border_particles);
 		BOOST_CHECK(number_of_mirror_particles == number_of_source_particles);
 		
-		for (int i = 0; i < NBCs.key_map_source_mirror.size(); ++i)
+		for (size_t i = 0; i < keys_source.size(); ++i)
 		{
-			openfpm::vector<size_t> row = NBCs.key_map_source_mirror.get(i);
 			vect_dist_key_dx key_source, key_mirror;
-			key_source.setKey(row.get(0));
-			key_mirror.setKey(row.get(1));
+			key_source.setKey(NBCs.get_source_id(i));
+			key_mirror.setKey(NBCs.get_mirror_id(i));
 			BOOST_CHECK(Particles.template getProp<CONCENTRATION>(key_mirror) == Particles.template getProp<CONCENTRATION>(key_source));
 		}
 		
+		// A second call updates the same mirror particles in place
+		size_t number_of_local_particles = Particles.size_local();
+		for (size_t i = 0; i < keys_source.size(); ++i)
+		{
+			Particles.template getProp<CONCENTRATION>(keys_source.get(i)) += 1.0;
+		}
+		NBCs.get_mirror_particles(Particles);
+		NBCs.apply_noflux<CONCENTRATION>(Particles);
+		
+		BOOST_CHECK(Particles.size_local() == number_of_local_particles);
+		for (size_t i = 0; i < keys_source.size(); ++i)
+		{
+			vect_dist_key_dx key_source, key_mirror;
+			key_source.setKey(NBCs.get_source_id(i));
+			key_mirror.setKey(NBCs.get_mirror_id(i));
+			BOOST_CHECK(Particles.template getProp<CONCENTRATION>(key_mirror) == Particles.template getProp<CONCENTRATION>(key_source));
+		}
+		
+	}
+	BOOST_AUTO_TEST_CASE(surface_normal_fused_test) {
+		constexpr size_t PHI = 0, GRAD = 1, NORMAL_P = 2, NORMAL_E = 3;
+		
+		Box<3, double> box({0.0, 0.0, 0.0}, {10.0, 10.0, 1.0});
+		size_t bc[3] = {NON_PERIODIC, NON_PERIODIC, PERIODIC};
+		Ghost<3, double> ghost(0.5);
+		
+		typedef vector_dist<3, double, aggregate<double, VectorS<3,double>, VectorS<3,double>, VectorS<3,double>>> vd_n_type;
+		vd_n_type vd(0, box, bc, ghost);
+		
+		// SDF of a cylinder of radius 3 with axis (5,5,z)
+		const size_t sz[3] = {40, 40, 4};
+		auto it = vd.getGridIterator(sz);
+		while (it.isNext())
+		{
+			auto key = it.get();
+			
+			vd.add();
+			vd.getLastPos()[x] = 0.1 + key.get(x) * 0.25;
+			vd.getLastPos()[y] = 0.1 + key.get(y) * 0.25;
+			vd.getLastPos()[z] = key.get(z) * 0.25;
+			
+			double dx = vd.getLastPos()[x] - 5.0;
+			double dy = vd.getLastPos()[y] - 5.0;
+			double r = sqrt(dx*dx + dy*dy);
+			
+			vd.getLastProp<PHI>() = 3.0 - r;
+			vd.getLastProp<GRAD>()[x] = - 2.0*dx/r;
+			vd.getLastProp<GRAD>()[y] = - 2.0*dy/r;
+			vd.getLastProp<GRAD>()[z] = 0.0;
+			
+			++it;
+		}
+		vd.map();
+		
+		// the normal from the stored gradient and from a gradient expression must be the outward normal scaled by phi
+		get_surface_normal_sdf<PHI, GRAD, NORMAL_P>(vd);
+		get_surface_normal_sdf_expr<PHI, NORMAL_E>(vd, getV<GRAD>(vd));
+		
+		bool ret = true;
+		auto dom = vd.getDomainIterator();
+		while (dom.isNext())
+		{
+			auto key = dom.get();
+			
+			double dx = vd.getPos(key)[x] - 5.0;
+			double dy = vd.getPos(key)[y] - 5.0;
+			double r = sqrt(dx*dx + dy*dy);
+			double phi = vd.getProp<PHI>(key);
+			
+			ret &= fabs(vd.getProp<NORMAL_P>(key)[x] - dx/r*phi) < 1e-12;
+			ret &= fabs(vd.getProp<NORMAL_P>(key)[y] - dy/r*phi) < 1e-12;
+			ret &= fabs(vd.getProp<NORMAL_P>(key)[z]) < 1e-12;
+			
+			for (size_t d = 0; d < 3; d++)
+			{
+				ret &= vd.getProp<NORMAL_E>(key)[d] == vd.getProp<NORMAL_P>(key)[d];
+			}
+			
+			++dom;
+		}
+		BOOST_REQUIRE(ret);
 	}
 BOOST_AUTO_TEST_SUITE_END()
 
@@ -0,0 +1,389 @@
+/*
+ * CellNeighbourSearch.hpp
+ *
+ *  Nearest neighbours and radius search on a cell list, shared by the DCPSE supports (SupportBuilder), the
+ *  regression supports (RegressionSupport) and the particle closest point method
+ */
+
+#ifndef OPENFPM_NUMERICS_SRC_DCPSE_CELLNEIGHBOURSEARCH_HPP_
+#define OPENFPM_NUMERICS_SRC_DCPSE_CELLNEIGHBOURSEARCH_HPP_
+
+#include <Space/Shape/Point.hpp>
+#include <Vector/vector_dist.hpp>
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <vector>
+
+/*! \brief Neighbour search on the cell list of a particle set
+ *
+ * The cells around the cell of a point are visited with precomputed stencils of cell offsets:
+ *
+ * * addCube: all the cells with up to n cells of distance in every direction (radius search)
+ * * addRings: rings of cells at increasing Manhattan distance, until enough particles have been visited
+ * * addShells: cubes of increasing size (Chebyshev distance), until enough particles have been visited
+ *
+ * The stencils are built once (the rings and shells are extended when a search needs more of them) and the
+ * candidates are kept in a buffer reused across the searches, so a search does not allocate. The candidates are
+ * then selected with selectNearest, selectRadius or selectAll. On strongly non uniform particle distributions the
+ * rings and the shells grow until they contain enough particles, independently of the cell size.
+ *
+ * An object is not thread safe, use one object per thread on the same cell list
+ *
+ * \tparam vector_type particle set of the neighbours
+ * \tparam cell_list_type cell list of the particle set
+ *
+ */
+template<typename vector_type, typename cell_list_type>
+class CellNeighbourSearch {
+public:
+
+    typedef typename vector_type::stype T;
+
+    //! Candidate neighbour
+    struct candidate {
+        T dist;
+        size_t offset;
+
+        bool operator<(const candidate &p) const { return this->dist < p.dist; }
+    };
+
+    //! No particle excluded from the search
+    static constexpr size_t no_exclude = std::numeric_limits<size_t>::max();
+
+private:
+
+    static constexpr unsigned int dims = vector_type::dims;
+
+    vector_type &domain;
+    cell_list_type &cellList;
+
+    //! Cell offsets sorted by Manhattan distance, ring r is in [ringStart[r], ringStart[r+1])
+    std::vector<grid_key_dx<dims>> ringStencil;
+    std::vector<size_t> ringStart;
+
+    //! Cell offsets sorted by Chebyshev distance, shell n is in [shellStart[n], shellStart[n+1])
+    std::vector<grid_key_dx<dims>> shellStencil;
+    std::vector<size_t> shellStart;
+
+    //! Cell offsets of the cube with cubeHalfWidth cells around the central one, in grid order
+    std::vector<grid_key_dx<dims>> cubeStencil;
+    int cubeHalfWidth = -1;
+
+    //! Candidates of the last search
+    openfpm::vector<candidate> candidates;
+
+public:
+
+    /*! \brief Constructor
+     *
+     * \param domain particle set of the neighbours
+     * \param cellList cell list of domain
+     *
+     */
+    CellNeighbourSearch(vector_type &domain, cell_list_type &cellList)
+            : domain(domain), cellList(cellList) {
+        ringStart.push_back(0);
+        shellStart.push_back(0);
+    }
+
+    //! Cell list used by the search
+    cell_list_type &getCellList() {
+        return cellList;
+    }
+
+    //! Size of a cell (along the first dimension)
+    T getCellSize() {
+        return cellList.getCellBox().getHigh(0);
+    }
+
+    /*! \brief Half width in cells of the cube covering a radius
+     *
+     * The cells can have a different size along every direction, the cube must cover r along all of them
+     *
+     * \param r radius
+     *
+     */
+    int getCubeHalfWidth(T r) {
+        int n = 0;
+        for (unsigned int i = 0; i < dims; ++i) {
+            n = std::max(n, (int)std::ceil(r / cellList.getCellBox().getHigh(i)));
+        }
+        return n;
+    }
+
+    //! Remove the candidates of the last search
+    void clear() {
+        candidates.clear();
+    }
+
+    //! Candidates found since the last clear()
+    openfpm::vector<candidate> &getCandidates() {
+        return candidates;
+    }
+
+    /*! \brief Add the particles of the cells with up to n cells of distance (in every direction) from the cell of pos
+     *
+     * \param pos position of the point
+     * \param n half width of the cube in cells
+     * \param exclude particle to skip (the point itself)
+     *
+     * \return the number of particles in the visited cells
+     *
+     */
+    size_t addCube(const Point<dims, T> &pos, int n, size_t exclude = no_exclude) {
+        if (n != cubeHalfWidth) {
+            buildCubeStencil(n);
+        }
+
+        grid_key_dx<dims> curCellKey = cellList.getCellGrid(pos);
+
+        size_t nElements = 0;
+        for (size_t i = 0; i < cubeStencil.size(); ++i) {
+            grid_key_dx<dims> key = curCellKey + cubeStencil[i];
+            if (isCellKeyInBounds(key)) {
+                nElements += addCandidates(key, pos, exclude);
+            }
+        }
+        return nElements;
+    }
+
+    /*! \brief Add the particles of the rings of cells (Manhattan distance) around the cell of pos until they contain
+     *         at least minElements particles, or all the cells have been visited
+     *
+     * \param pos position of the point
+     * \param minElements number of particles to visit
+     * \param exclude particle to skip (the point itself)
+     *
+     * \return the number of particles in the visited cells
+     *
+     */
+    size_t addRings(const Point<dims, T> &pos, size_t minElements, size_t exclude = no_exclude) {
+        grid_key_dx<dims> curCellKey = cellList.getCellGrid(pos);
+
+        size_t nElements = 0;
+        for (size_t r = 0; nElements < minElements; ++r) {
+            if (r + 1 >= ringStart.size()) {
+                addRing();
+            }
+
+            bool inBounds = false;
+            for (size_t i = ringStart[r]; i < ringStart[r + 1]; ++i) {
+                grid_key_dx<dims> key = curCellKey + ringStencil[i];
+                if (isCellKeyInBounds(key)) {
+                    nElements += addCandidates(key, pos, exclude);
+                    inBounds = true;
+                }
+            }
+
+            // all the cells have been visited
+            if (inBounds == false) {
+                break;
+            }
+        }
+        return nElements;
+    }
+
+    /*! \brief Add the particles of cubes of increasing size around the cell of pos until they contain at least
+     *         minElements particles, or all the cells have been visited
+     *
+     * \param pos position of the point
+     * \param minElements number of particles to visit
+     * \param exclude particle to skip (the point itself)
+     * \param minHalfWidth the cube has at least this half width in cells
+     *
+     * \return the number of particles in the visited cells
+     *
+     */
+    size_t addShells(const Point<dims, T> &pos, size_t minElements, size_t exclude = no_exclude, int minHalfWidth = 0) {
+        grid_key_dx<dims> curCellKey = cellList.getCellGrid(pos);
+
+        size_t nElements = 0;
+        for (int n = 0; n <= minHalfWidth || nElements < minElements; ++n) {
+            if (n + 1 >= (int)shellStart.size()) {
+                addShell();
+            }
+
+            bool inBounds = false;
+            for (size_t i = shellStart[n]; i < shellStart[n + 1]; ++i) {
+                grid_key_dx<dims> key = curCellKey + shellStencil[i];
+                if (isCellKeyInBounds(key)) {
+                    nElements += addCandidates(key, pos, exclude);
+                    inBounds = true;
+                }
+            }
+
+            // all the cells have been visited
+            if (inBounds == false) {
+                break;
+            }
+        }
+        return nElements;
+    }
+
+    /*! \brief Select the n nearest candidates, sorted by distance
+     *
+     * \param keys where to add the selected particles
+     * \param n number of particles
+     *
+     */
+    template<typename keys_type>
+    void selectNearest(keys_type &keys, size_t n) {
+        n = std::min(n, (size_t)candidates.size());
+        if (n == 0) {
+            return;
+        }
+
+        candidate * first = &candidates.get(0);
+        if (n < candidates.size()) {
+            std::nth_element(first, first + n, first + candidates.size());
+        }
+        std::sort(first, first + n);
+
+        for (size_t i = 0; i < n; i++) {
+            keys.add(candidates.get(i).offset);
+        }
+    }
+
+    /*! \brief Select the candidates closer than r
+     *
+     * \param keys where to add the selected particles
+     * \param r radius
+     *
+     */
+    template<typename keys_type>
+    void selectRadius(keys_type &keys, T r) {
+        for (size_t i = 0; i < candidates.size(); i++) {
+            if (candidates.get(i).dist < r) {
+                keys.add(candidates.get(i).offset);
+            }
+        }
+    }
+
+    /*! \brief Select all the candidates
+     *
+     * \param keys where to add the selected particles
+     *
+     */
+    template<typename keys_type>
+    void selectAll(keys_type &keys) {
+        for (size_t i = 0; i < candidates.size(); i++) {
+            keys.add(candidates.get(i).offset);
+        }
+    }
+
+private:
+
+    size_t getCellLinId(const grid_key_dx<dims> &cellKey) {
+        mem_id id = cellList.getGrid().LinId(cellKey);
+        return static_cast<size_t>(id);
+    }
+
+    //! Offsets of all the cells at up to n cells (in every direction) from the central cell
+    void buildCubeStencil(int n) {
+        cubeStencil.clear();
+        cubeHalfWidth = n;
+
+        grid_key_dx<dims> middle;
+        size_t sz[dims];
+        for (int i = 0; i < dims; i++) {
+            sz[i] = 2 * n + 1;
+            middle.set_d(i, n);
+        }
+        grid_sm<dims, void> g(sz);
+        grid_key_dx_iterator<dims> g_k(g);
+        while (g_k.isNext()) {
+            auto key = g_k.get();
+            cubeStencil.push_back(key - middle);
+            ++g_k;
+        }
+    }
+
+    //! Add the offsets of the cells at the next Manhattan distance to the ring stencil
+    void addRing() {
+        int r = ringStart.size() - 1;
+
+        grid_key_dx<dims> middle;
+        size_t sz[dims];
+        for (int i = 0; i < dims; i++) {
+            sz[i] = 2 * r + 1;
+            middle.set_d(i, r);
+        }
+        grid_sm<dims, void> g(sz);
+        grid_key_dx_iterator<dims> g_k(g);
+        while (g_k.isNext()) {
+            auto key = g_k.get() - middle;
+
+            int l1 = 0;
+            for (int i = 0; i < dims; i++) {
+                l1 += std::abs(key.get(i));
+            }
+            if (l1 == r) {
+                ringStencil.push_back(key);
+            }
+            ++g_k;
+        }
+
+        ringStart.push_back(ringStencil.size());
+    }
+
+    //! Add the offsets of the cells at the next Chebyshev distance to the shell stencil
+    void addShell() {
+        int n = shellStart.size() - 1;
+
+        grid_key_dx<dims> middle;
+        size_t sz[dims];
+        for (int i = 0; i < dims; i++) {
+            sz[i] = 2 * n + 1;
+            middle.set_d(i, n);
+        }
+        grid_sm<dims, void> g(sz);
+        grid_key_dx_iterator<dims> g_k(g);
+        while (g_k.isNext()) {
+            auto key = g_k.get() - middle;
+
+            int linf = 0;
+            for (int i = 0; i < dims; i++) {
+                linf = std::max(linf, (int)std::abs(key.get(i)));
+            }
+            if (linf == n) {
+                shellStencil.push_back(key);
+            }
+            ++g_k;
+        }
+
+        shellStart.push_back(shellStencil.size());
+    }
+
+    //! Add the particles of a cell to the candidates, return the number of particles in the cell
+    size_t addCandidates(const grid_key_dx<dims> &cellKey, const Point<dims, T> &xp, size_t exclude) {
+        const size_t cellLinId = getCellLinId(cellKey);
+        const size_t elemsInCell = cellList.getNelements(cellLinId);
+        for (size_t k = 0; k < elemsInCell; ++k) {
+            size_t el = cellList.get(cellLinId, k);
+
+            if (el == exclude) { continue; }
+
+            Point<dims, T> xq = domain.getPosOrig(el);
+
+            candidate pr;
+
+            pr.dist = xp.distance(xq);
+            pr.offset = el;
+            candidates.add(pr);
+        }
+        return elemsInCell;
+    }
+
+    bool isCellKeyInBounds(const grid_key_dx<dims> &key) {
+        const size_t *cellGridSize = cellList.getGrid().getSize();
+        for (size_t i = 0; i < dims; ++i) {
+            if (key.value(i) < 0 || key.value(i) >= cellGridSize[i]) {
+                return false;
+            }
+        }
+        return true;
+    }
+};
+
+#endif /* OPENFPM_NUMERICS_SRC_DCPSE_CELLNEIGHBOURSEARCH_HPP_ */
@@ -16,6 +16,43 @@
 #include "Solvers/umfpack_solver.hpp"
 #include "Solvers/petsc_solver.hpp"
 #include "util/eq_solve_common.hpp"
+#include "util/row_map.hpp"
+#include "Solvers/solver_metrics.hpp"
+#include "util/trace_span.hpp"
+#include "util/memory_report.hpp"
+
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
+#include <functional>
+#include <map>
+
+//! Property of the particles written by a solution expression (a property or one component of it)
+template<typename expr_type>
+struct dcpse_solution_prop
+{
+    static const unsigned int value = expr_type::prop;
+};
+
+template<typename exp, typename n>
+struct dcpse_solution_prop<vector_dist_expression_op<exp,n,VECT_COMP>>
+{
+    static const unsigned int value = exp::prop;
+};
+
+#if defined(__NVCC__) && defined(HAVE_PETSC)
+
+//! Copy the component comp of the local solution xa (on the device) in the property prp of the particles
+template<unsigned int prp, typename particles_type, typename T>
+__global__ void dcpse_copy_solution_gpu(particles_type parts, const T * xa, unsigned int nvar, unsigned int comp)
+{
+    auto p = GET_PARTICLE(parts);
+
+    parts.template getProp<prp>(p) = xa[p * nvar + comp];
+}
+
+#endif
 
 /*enum eq_struct
 {
@@ -53,6 +90,8 @@ class DCPSE_scheme {
     //! Sparse matrix triplet type
     typedef typename Sys_eqs::SparseMatrix_type::triplet_type triplet;
 
+public:
+
     //! Distributed grid map
     typedef vector_dist< Sys_eqs::dims,
         typename Sys_eqs::stype, aggregate<size_t>,
@@ -60,8 +99,13 @@ class DCPSE_scheme {
         typename Sys_eqs::b_part::Memory_type,
         layout_base> p_map_type;
 
+private:
+
+    //! numbering of the particles, possibly shared with the other schemes on the same particles
+    std::shared_ptr<row_map_data<p_map_type>> rmap;
+
     //! mapping grid
-    p_map_type p_map;
+    p_map_type * p_map;
 
     //! Grid points that has each processor
     openfpm::vector<size_t> pnt;
@@ -95,29 +139,446 @@ class DCPSE_scheme {
 
     size_t offset;
 
+    //! matrix free mode, the operators are not assembled
+    bool matrix_free = false;
 
-    /*! \brief Construct the gmap structure
- *
- */template<typename options>
-    void construct_pmap(options opt = options_solver::STANDARD) {
+    //! in matrix free mode, every imposed operator writes its rows of y = A x in the local part of y
+    std::vector<std::function<void(typename Sys_eqs::stype *)>> mf_rows;
+
+    //! matrix and vectors are stored on the device
+    bool device_solve = false;
+
+    //! time spent imposing the operators since the last reset
+    double assembly_time = 0.0;
+
+#ifdef HAVE_PETSC
+
+    //! matrix of a block of the nest, the rows of one equation and the columns of one variable
+    typedef SparseMatrix<double,int,PETSC_BASE> block_matrix_type;
+
+    //! Operators imposed in a named block, split by equation and variable of the columns (numbering of the particles)
+    struct named_block
+    {
+        //! triplets of the block (i,j) of the nest
+        openfpm::vector<typename block_matrix_type::triplet_type> trpl[Sys_eqs::nvar][Sys_eqs::nvar];
+
+        //! the block has been imposed again since the last fill of the nest
+        bool dirty = true;
+    };
+
+    //! block assembly mode, every operator is imposed in the selected named block
+    bool block_assembly = false;
+
+    //! named blocks
+    std::map<std::string,named_block> blocks;
+
+    //! named block where the operators are imposed
+    named_block * cur_block = NULL;
+
+    //! matrices of the nest (NULL for the zero blocks)
+    std::unique_ptr<block_matrix_type> nest_blk[Sys_eqs::nvar][Sys_eqs::nvar];
+
+    //! MatNest of the blocks
+    Mat nest = NULL;
+
+    //! rows of every equation in the interleaved numbering of the scheme
+    IS nest_is[Sys_eqs::nvar] = {};
+
+    //! keep the pattern of the blocks between fills
+    bool block_reuse = false;
+
+    //! number of blocks of the nest filled
+    size_t n_block_fill = 0;
+
+    //! Destroy the blocks and the nest, the named blocks are dropped
+    void clear_blocks()
+    {
+        blocks.clear();
+        cur_block = NULL;
+
+        for (size_t i = 0 ; i < Sys_eqs::nvar ; i++)
+        {
+            for (size_t j = 0 ; j < Sys_eqs::nvar ; j++)
+            {nest_blk[i][j].reset();}
+
+            if (nest_is[i] != NULL)
+            {PETSC_SAFE_CALL(ISDestroy(&nest_is[i]));}
+        }
+
+        if (nest != NULL)
+        {PETSC_SAFE_CALL(MatDestroy(&nest));}
+    }
+
+    /*! \brief Fill the blocks of the nest touched by a named block imposed again, and create the nest if its structure changed
+     *
+     * A block (i,j) exists if some named block has entries in it on some processor, the diagonal blocks always exist and
+     * get a zero on the rows without diagonal entry (as the monolithic assembly). A block is filled from the triplets of
+     * all the named blocks, only if one of them is dirty
+     *
+     */
+    void fill_nest()
+    {
+        const size_t nv = Sys_eqs::nvar;
+        auto & v_cl = create_vcluster();
+
+        size_t used[nv*nv];
+        size_t dirty[nv*nv];
+
+        for (size_t i = 0 ; i < nv ; i++)
+        {
+            for (size_t j = 0 ; j < nv ; j++)
+            {
+                used[i*nv+j] = (i == j)?1:0;
+                dirty[i*nv+j] = 0;
+
+                for (auto it = blocks.begin() ; it != blocks.end() ; ++it)
+                {
+                    if (it->second.trpl[i][j].size() != 0)
+                    {
+                        used[i*nv+j] = 1;
+                        if (it->second.dirty == true)	{dirty[i*nv+j] = 1;}
+                    }
+                }
+
+                v_cl.max(used[i*nv+j]);
+                v_cl.max(dirty[i*nv+j]);
+            }
+        }
+        v_cl.execute();
+
+        bool rebuild = (nest == NULL);
+        bool refill = false;
+        size_t nloc = p_map->size_local();
+
+        for (size_t i = 0 ; i < nv ; i++)
+        {
+            for (size_t j = 0 ; j < nv ; j++)
+            {
+                auto & blk = nest_blk[i][j];
+
+                if (used[i*nv+j] == 0)
+                {
+                    if (blk)	{blk.reset(); rebuild = true;}
+                    continue;
+                }
+
+                if (!blk)
+                {
+                    blk.reset(new block_matrix_type(tot,tot,nloc));
+                    blk->reusePattern(block_reuse);
+                    rebuild = true;
+                }
+                else if (dirty[i*nv+j] == 0)
+                {continue;}
+
+                auto & trpl = blk->getMatrixTriplets();
+                trpl.clear();
+
+                for (auto it = blocks.begin() ; it != blocks.end() ; ++it)
+                {
+                    auto & bt = it->second.trpl[i][j];
+                    for (size_t k = 0 ; k < bt.size() ; k++)
+                    {trpl.add(bt.get(k));}
+                }
+
+                if (i == j)
+                {
+                    std::vector<bool> has_diag(nloc,false);
+                    for (size_t k = 0 ; k < trpl.size() ; k++)
+                    {
+                        if (trpl.get(k).row() == trpl.get(k).col())
+                        {has_diag[trpl.get(k).row() - s_pnt] = true;}
+                    }
+
+                    for (size_t r = 0 ; r < nloc ; r++)
+                    {
+                        if (has_diag[r] == false)
+                        {trpl.add(typename block_matrix_type::triplet_type(s_pnt + r,s_pnt + r,0.0));}
+                    }
+                }
+
+                blk->getMat();
+                n_block_fill++;
+                refill = true;
+            }
+        }
+
+        for (auto it = blocks.begin() ; it != blocks.end() ; ++it)
+        {it->second.dirty = false;}
+
+        if (rebuild == true)
+        {
+            if (nest != NULL)
+            {PETSC_SAFE_CALL(MatDestroy(&nest));}
+
+            for (size_t i = 0 ; i < nv ; i++)
+            {
+                if (nest_is[i] == NULL)
+                {PETSC_SAFE_CALL(ISCreateStride(PETSC_COMM_WORLD,nloc,s_pnt*nv + i,nv,&nest_is[i]));}
+            }
+
+            Mat mats[nv*nv];
+            for (size_t k = 0 ; k < nv*nv ; k++)
+            {mats[k] = (nest_blk[k/nv][k%nv])?nest_blk[k/nv][k%nv]->getMat():NULL;}
+
+            PETSC_SAFE_CALL(MatCreateNest(PETSC_COMM_WORLD,nv,nest_is,nv,nest_is,mats,&nest));
+        }
+        else if (refill == true)
+        {
+            // the blocks changed, the state of the nest must change too (preconditioner reuse)
+            PETSC_SAFE_CALL(MatAssemblyBegin(nest,MAT_FINAL_ASSEMBLY));
+            PETSC_SAFE_CALL(MatAssemblyEnd(nest,MAT_FINAL_ASSEMBLY));
+        }
+    }
+
+    /*! \brief Impose an operator in the selected named block
+     *
+     * The columns of the variable j go in the block (id,j) of the nest, rows and columns are the numbers of the
+     * particles
+     *
+     * \param op Operator to impose (A term)
+     * \param num right hand side of the term (b term)
+     * \param id Equation id in the system that we are imposing
+     * \param subset indices of the particles where the operator is imposed
+     *
+     */
+    template<typename T, typename bop, typename index_type>
+    void impose_block(const T &op,
+                      bop num,
+                      long int id,
+                      openfpm::vector<index_type> &subset) {
+        if (cur_block == NULL)
+        {
+            std::cerr << __FILE__ << ":" << __LINE__ << " error, in block assembly mode select a block (selectBlock) before imposing" << std::endl;
+            return;
+        }
+
+        tsl::hopscotch_map<long int, typename particles_type::stype> cols;
+
+        for (size_t i = 0; i < subset.size(); i++) {
+            auto key = subset.template get<0>(i);
+            long int r = p_map->template getProp<0>(key);
+
+            typename Sys_eqs::stype coeff = 1.0;
+            op.template value_nz<Sys_eqs>(*p_map, key, cols, coeff, 0);
+
+            for (auto it2 = cols.begin(); it2 != cols.end(); ++it2) {
+                auto & trpl = cur_block->trpl[id][it2->first % Sys_eqs::nvar];
+                trpl.add();
+                trpl.last().row() = r;
+                trpl.last().col() = it2->first / Sys_eqs::nvar;
+                trpl.last().value() = it2->second;
+            }
+
+            b(r * Sys_eqs::nvar + id) = num.get(key);
+            cols.clear();
+        }
+
+        cur_block->dirty = true;
+
+        row += subset.size();
+        row_b += subset.size();
+        row_x_ig += subset.size();
+    }
+
+#endif
+
+    //! metrics of the last solve (reduced when they are read)
+    mutable solver_metrics metrics;
+
+    /*! \brief Pass the assembly time and the layout of the variables (for the field split) to the solver before a solve
+     *
+     * \param solver solver
+     *
+     */
+    template<typename SolverType>
+    void metrics_pre(SolverType & solver)
+    {
+        solver_metrics_access<SolverType>::set_assembly_time(solver, assembly_time);
+        solver_set_field_layout<SolverType>::set(solver, Sys_eqs::nvar);
+    }
+
+    /*! \brief Copy the metrics of the solver after a solve
+     *
+     * \param solver solver
+     *
+     */
+    template<typename SolverType>
+    void metrics_post(SolverType & solver)
+    {
+        if (solver_metrics_access<SolverType>::get(solver, metrics) == false)
+        {
+            metrics.reset_solve();
+            metrics.assembly_time = assembly_time;
+        }
+    }
+
+    //! number of previous solutions used to extrapolate the initial guess (0 no extrapolation)
+    size_t ig_k = 0;
+
+    //! local part of the previous solutions, the last one is the most recent
+    std::vector<std::vector<typename Sys_eqs::stype>> ig_hist;
+
+    /*! \brief Fill x_ig with the polynomial extrapolation of the solutions in ig_hist
+     *
+     * The m stored solutions are considered at equally spaced times 0 ... m-1, the polynomial of degree m-1
+     * through them evaluated at the time m has the coefficients (-1)^(m-1-j) binomial(m,j)
+     *
+     */
+    void extrapolate_x_ig()
+    {
+        size_t m = ig_hist.size();
+        size_t n = ig_hist.back().size();
+
+        std::vector<typename Sys_eqs::stype> c(m);
+        double bin = 1.0;
+        for (size_t j = 0 ; j < m ; j++)
+        {
+            c[j] = (((m - 1 - j) % 2 == 0)?1.0:-1.0) * bin;
+            bin = bin * (m - j) / (j + 1);
+        }
+
+        size_t start = s_pnt * Sys_eqs::nvar;
+        for (size_t i = 0 ; i < n ; i++)
+        {
+            typename Sys_eqs::stype g = 0.0;
+            for (size_t j = 0 ; j < m ; j++)
+            {g += c[j] * ig_hist[j][i];}
+
+            x_ig(start + i) = g;
+        }
+    }
+
+    /*! \brief Store the local part of the solution x in the history of the extrapolation
+     *
+     * \param x solution
+     *
+     */
+    template<typename solType>
+    void store_solution(solType & x)
+    {
+        if (ig_hist.size() == ig_k)
+        {ig_hist.erase(ig_hist.begin());}
+
+        size_t n = p_map->size_local() * Sys_eqs::nvar;
+        size_t start = s_pnt * Sys_eqs::nvar;
+
+        ig_hist.emplace_back(n);
+        for (size_t i = 0 ; i < n ; i++)
+        {ig_hist.back()[i] = x(start + i);}
+    }
+
+
+    /*! \brief Number the particles of parts in the map d
+     *
+     */
+    void number_pmap(row_map_data<p_map_type> & d) {
         Vcluster<> &v_cl = create_vcluster();
 
         // Calculate the size of the local domain
-        size_t sz = p_map.size_local();
+        size_t sz = d.map.size_local();
 
         // Get the total size of the local grids on each processors
-        v_cl.allGather(sz, pnt);
+        v_cl.allGather(sz, d.pnt);
         v_cl.execute();
-        s_pnt = 0;
+        d.s_pnt = 0;
 
         // calculate the starting point for this processor
         for (size_t i = 0; i < v_cl.getProcessUnitID(); i++)
-            s_pnt += pnt.get(i);
+            d.s_pnt += d.pnt.get(i);
 
-        tot = sz;
-        v_cl.sum(tot);
+        d.tot = sz;
+        v_cl.sum(d.tot);
         v_cl.execute();
 
+        // Counter
+        size_t cnt = 0;
+
+        // Create the re-mapping grid
+        auto it = d.map.getDomainIterator();
+
+        while (it.isNext()) {
+            auto key = it.get();
+
+            for (int i = 0; i < particles_type::dims; i++) {
+                d.map.getPos(key)[i] = parts.getPos(key)[i];
+            }
+
+            d.map.template getProp<0>(key) = cnt + d.s_pnt;
+
+            ++cnt;
+            ++it;
+        }
+
+        // sync the ghost
+        NUMERICS_TRACE_SPAN("dcpse_scheme.ghost_get");
+        d.map.template ghost_get<0>();
+    }
+
+    /*! \brief Number the particles, or take the numbering in rm if it was built on the same particles after their last map
+     *
+     * The ghost of the numbering is the ghost of the particles when it was built, so the key also contains the number
+     * of ghost particles. A ghost_get after the particles moved can change the ghost without changing its size, with
+     * SE_CLASS1 the positions of the numbering are compared with the ones of the particles
+     *
+     * \param rm shared row map (NULL to build a private one)
+     *
+     */
+    void acquire_pmap(row_map<p_map_type> * rm) {
+        std::vector<long int> ext({(long int)parts.size_local(), (long int)parts.size_local_with_ghost()});
+
+        if (rm != NULL) {
+            rmap = rm->find(&parts, parts.getMapCtr(), ext);
+        }
+
+#ifdef SE_CLASS1
+        if (rmap && rmap->map.size_local_with_ghost() == parts.size_local_with_ghost()) {
+            for (size_t k = 0; k < parts.size_local_with_ghost(); k++) {
+                bool same = true;
+                for (int i = 0; i < particles_type::dims; i++) {
+                    same &= (rmap->map.getPos(k)[i] == parts.getPos(k)[i]);
+                }
+
+                if (same == false) {
+                    std::cerr << __FILE__ << ":" << __LINE__ << " error, the particles moved after the numbering in the row_map was built, it is built again" << std::endl;
+                    rmap.reset();
+                    break;
+                }
+            }
+        }
+#endif
+
+        if (!rmap) {
+            rmap = std::make_shared<row_map_data<p_map_type>>(parts.getDecomposition(), 0);
+            rmap->map.resize(parts.size_local());
+            number_pmap(*rmap);
+            rmap->geom = &parts;
+            rmap->ctr = parts.getMapCtr();
+            rmap->ext = ext;
+
+            if (rm != NULL) {rm->set(rmap);}
+        }
+
+        p_map = &rmap->map;
+    }
+
+    /*! \brief Construct the gmap structure
+ *
+ */template<typename options>
+    void construct_pmap(options opt = options_solver::STANDARD) {
+        Vcluster<> &v_cl = create_vcluster();
+
+        // Calculate the size of the local domain
+        size_t sz = p_map->size_local();
+
+        pnt = rmap->pnt;
+        s_pnt = rmap->s_pnt;
+        tot = rmap->tot;
+
+        // the rows of b and x_ig are the ones of the local particles
+        b.setLocalRows(true);
+        x_ig.setLocalRows(true);
+
         // resize b if needed
         if (opt == options_solver::STANDARD) {
             b.resize(Sys_eqs::nvar * tot, Sys_eqs::nvar * sz);
@@ -143,29 +604,6 @@ class DCPSE_scheme {
             }
         }
 
-        // Calculate the starting point
-
-        // Counter
-        size_t cnt = 0;
-
-        // Create the re-mapping grid
-        auto it = p_map.getDomainIterator();
-
-        while (it.isNext()) {
-            auto key = it.get();
-
-            for (int i = 0; i < particles_type::dims; i++) {
-                p_map.getPos(key)[i] = parts.getPos(key)[i];
-            }
-
-            p_map.template getProp<0>(key) = cnt + s_pnt;
-
-            ++cnt;
-            ++it;
-        }
-
-        // sync the ghost
-        p_map.template ghost_get<0>();
     }
 
     //! Encapsulation of the b term as constant
@@ -243,9 +681,9 @@ class DCPSE_scheme {
             return;
         }
 
-        if (row_b != p_map.size_local() * Sys_eqs::nvar) {
+        if (row_b != p_map->size_local() * Sys_eqs::nvar) {
             std::cerr << "Error " << __FILE__ << ":" << __LINE__ << " your system is underdetermined you set "
-                      << row_b << " conditions " << " but i am expecting " << p_map.size_local() * Sys_eqs::nvar
+                      << row_b << " conditions " << " but i am expecting " << p_map->size_local() * Sys_eqs::nvar
                       << std::endl;
             return;
         }
@@ -322,6 +760,28 @@ class DCPSE_scheme {
         }
     }
 
+#ifdef HAVE_PETSC
+
+    /*! \brief Copy the component comp of a PETSc solution, reading its local array instead of the row values
+     *
+     * \param x solution
+     * \param exp where to store the result
+     * \param comp component
+     *
+     */
+    template<typename expr_type>
+    void copy_impl(Vector<double,PETSC_BASE> & x, expr_type exp, unsigned int comp)
+    {
+        const Vec & x_ = x.getVecNoSet();
+        const PetscScalar * xa;
+
+        PETSC_SAFE_CALL(VecGetArrayRead(x_,&xa));
+        copy_local_impl(xa, exp, comp);
+        PETSC_SAFE_CALL(VecRestoreArrayRead(x_,&xa));
+    }
+
+#endif
+
     template<typename solType, typename exp1, typename ... othersExp>
     void copy_nested(solType &x, unsigned int &comp, exp1 exp, othersExp ... exps) {
         copy_impl(x, exp, comp);
@@ -337,6 +797,103 @@ class DCPSE_scheme {
         comp++;
     }
 
+    //! Copy the local part xa of a solution vector in the expressions
+    template<typename expr_type>
+    void copy_local_impl(const typename Sys_eqs::stype * xa, expr_type exp, unsigned int comp)
+    {
+        auto & parts = exp.getVector();
+
+        long int n = parts.size_local();
+
+        #pragma omp parallel for
+        for (long int i = 0; i < n; i++) {
+            vect_dist_key_dx p(i);
+            exp.value(p) = xa[i * Sys_eqs::nvar + comp];
+        }
+    }
+
+    template<typename exp1, typename ... othersExp>
+    void copy_local_nested(const typename Sys_eqs::stype * xa, unsigned int &comp, exp1 exp, othersExp ... exps) {
+        copy_local_impl(xa, exp, comp);
+        comp++;
+
+        copy_local_nested(xa, comp, exps ...);
+    }
+
+    template<typename exp1>
+    void copy_local_nested(const typename Sys_eqs::stype * xa, unsigned int &comp, exp1 exp) {
+        copy_local_impl(xa, exp, comp);
+        comp++;
+    }
+
+#ifdef HAVE_PETSC
+
+#if defined(__NVCC__) && (defined(PETSC_HAVE_CUDA) || defined(PETSC_HAVE_HIP))
+
+    //! Copy the local part xa (on the device) of the solution in a property of the particles on the device
+    template<unsigned int prp, typename vector>
+    void copy_device_impl(const typename Sys_eqs::stype * xa, vector_dist_expression<prp,vector> exp, unsigned int comp)
+    {
+        auto & parts = exp.getVector();
+
+        auto ite = parts.getDomainIteratorGPU(256);
+
+        CUDA_LAUNCH((dcpse_copy_solution_gpu<prp>),ite,parts.toKernel(),xa,(unsigned int)Sys_eqs::nvar,comp);
+    }
+
+    //! The expression is not a property (a component for example), the solution is copied on the host
+    template<typename expr_type>
+    void copy_device_impl(const typename Sys_eqs::stype * xa, expr_type exp, unsigned int comp, Vec & x_)
+    {
+        const PetscScalar * xh;
+        PETSC_SAFE_CALL(VecGetArrayRead(x_,&xh));
+        copy_local_impl(xh, exp, comp);
+        PETSC_SAFE_CALL(VecRestoreArrayRead(x_,&xh));
+    }
+
+    template<unsigned int prp, typename vector>
+    void copy_device_impl(const typename Sys_eqs::stype * xa, vector_dist_expression<prp,vector> exp, unsigned int comp, Vec & x_)
+    {
+        copy_device_impl(xa, exp, comp);
+    }
+
+    template<typename exp1, typename ... othersExp>
+    void copy_device_nested(const typename Sys_eqs::stype * xa, Vec & x_, unsigned int &comp, exp1 exp, othersExp ... exps) {
+        copy_device_impl(xa, exp, comp, x_);
+        comp++;
+
+        copy_device_nested(xa, x_, comp, exps ...);
+    }
+
+    template<typename exp1>
+    void copy_device_nested(const typename Sys_eqs::stype * xa, Vec & x_, unsigned int &comp, exp1 exp) {
+        copy_device_impl(xa, exp, comp, x_);
+        comp++;
+    }
+
+#endif
+
+    //! Multiplication of the matrix free operator, the context is the function computing y = A x on the local parts
+    static PetscErrorCode mf_mult(Mat A_, Vec x_, Vec y_)
+    {
+        std::function<void(const PetscScalar *, PetscScalar *)> * mult;
+        PetscFunctionBeginUser;
+        PETSC_SAFE_CALL(MatShellGetContext(A_,(void **)&mult));
+
+        const PetscScalar * xa;
+        PetscScalar * ya;
+        PETSC_SAFE_CALL(VecGetArrayRead(x_,&xa));
+        PETSC_SAFE_CALL(VecGetArray(y_,&ya));
+
+        (*mult)(xa,ya);
+
+        PETSC_SAFE_CALL(VecRestoreArray(y_,&ya));
+        PETSC_SAFE_CALL(VecRestoreArrayRead(x_,&xa));
+        PetscFunctionReturn(0);
+    }
+
+#endif
+
 public:
 
     /*! \brief Set the structure of the system of equation
@@ -376,22 +933,324 @@ public:
      * \param exp where to store the result
      *
      */
-    template<typename ... expr_type>
-    void solve(expr_type ... exps) {
+    template<typename ... expr_type>
+    void solve(expr_type ... exps) {
+        if (sizeof...(exps) != Sys_eqs::nvar) {
+            std::cerr << __FILE__ << ":" << __LINE__ << " Error the number of properties you gave does not match the solution in\
+    													dimensionality, I am expecting " << Sys_eqs::nvar <<
+                      " properties " << std::endl;
+        };
+        typename Sys_eqs::solver_type solver;
+//        umfpack_solver<double> solver;
+        NUMERICS_TRACE_SPAN("dcpse_scheme.solve");
+        metrics_pre(solver);
+        auto x = solver.solve(getA(opt), getB(opt));
+        metrics_post(solver);
+
+        unsigned int comp = 0;
+        copy_nested(x, comp, exps ...);
+    }
+
+#ifdef HAVE_PETSC
+
+    /*! \brief Solve the system imposed in matrix free mode
+     *
+     * The matrix is a PETSc MatShell. Every multiplication copies x in the unknowns, gets their ghosts and
+     * evaluates the imposed operators. The preconditioner is built on P, for example the assembled matrix of a
+     * low order discretization of the same system, without P no preconditioner is used
+     *
+     *  \warning exp must be a scalar type
+     *
+     * \param solver petsc solver
+     * \param P preconditioning matrix (can be NULL)
+     * \param exp the unknowns the operators were imposed on, one for each variable, they contain the solution at the end
+     *
+     */
+    template<typename ... expr_type>
+    void solve_matrix_free(petsc_solver<double> &solver, SparseMatrix<double,int,PETSC_BASE> * P, expr_type ... exps) {
+        if (sizeof...(exps) != Sys_eqs::nvar) {
+            std::cerr << __FILE__ << ":" << __LINE__ << " Error the number of properties you gave does not match the solution in\
+    													dimensionality, I am expecting " << Sys_eqs::nvar <<
+                      " properties " << std::endl;
+            return;
+        }
+        if (opt != options_solver::STANDARD) {
+            std::cerr << __FILE__ << ":" << __LINE__ << " Error the matrix free mode supports only options_solver::STANDARD" << std::endl;
+            return;
+        }
+
+        PetscInt nLoc = p_map->size_local() * Sys_eqs::nvar;
+        PetscInt nGlob = tot * Sys_eqs::nvar;
+
+        size_t ghostOpt = 0;
+        std::function<void(const PetscScalar *, PetscScalar *)> mult = [&](const PetscScalar * xa, PetscScalar * ya) {
+            unsigned int comp = 0;
+            copy_local_nested(xa, comp, exps ...);
+            {
+                NUMERICS_TRACE_SPAN("dcpse_scheme.ghost_get");
+                parts.template ghost_get<dcpse_solution_prop<expr_type>::value ...>(ghostOpt);
+            }
+            ghostOpt = SKIP_LABELLING;
+
+            std::fill(ya, ya + nLoc, 0.0);
+            for (size_t i = 0; i < mf_rows.size(); i++)
+            {mf_rows[i](ya);}
+        };
+
+        Mat A_;
+        PETSC_SAFE_CALL(MatCreateShell(PETSC_COMM_WORLD, nLoc, nLoc, nGlob, nGlob, &mult, &A_));
+        PETSC_SAFE_CALL(MatShellSetOperation(A_, MATOP_MULT, (void (*)(void)) mf_mult));
+
+        KSP ksp = solver.getKSP();
+        PETSC_SAFE_CALL(KSPSetOperators(ksp, A_, (P != NULL) ? P->getMat() : A_));
+        PETSC_SAFE_CALL(KSPSetFromOptions(ksp));
+        if (P == NULL) {
+            PC pc;
+            PETSC_SAFE_CALL(KSPGetPC(ksp, &pc));
+            PETSC_SAFE_CALL(PCSetType(pc, PCNONE));
+        }
+
+        Vector<double,PETSC_BASE> x(nGlob, nLoc);
+        {
+            NUMERICS_TRACE_SPAN("dcpse_scheme.solve");
+            PETSC_SAFE_CALL(KSPSolve(ksp, getB(opt).getVec(), x.getVec()));
+        }
+        x.update();
+
+        PETSC_SAFE_CALL(MatDestroy(&A_));
+
+        unsigned int comp = 0;
+        copy_nested(x, comp, exps ...);
+    }
+
+#endif
+
+#ifdef HAVE_PETSC
+
+    /*! \brief Solve an equation on the device
+     *
+     * Matrix and right hand side must be on the device (setDeviceSolve). The solution stay in a device vector and
+     * it is copied from there in the properties of the particles on the device with a kernel, the host copy of
+     * the properties is not updated (use deviceToHostProp if needed). Expressions that are not a property (a
+     * component of a vector property) are copied on the host. Without CUDA/HIP it works as solve_with_solver
+     *
+     *  \warning exp must be a scalar type
+     *
+     * \param solver petsc solver
+     * \param exp where to store the result
+     *
+     */
+    template<typename ... expr_type>
+    void solve_with_solver_device(petsc_solver<double> &solver, expr_type ... exps) {
+#ifdef SE_CLASS1
+
+        if (sizeof...(exps) != Sys_eqs::nvar) {
+            std::cerr << __FILE__ << ":" << __LINE__ << " Error the number of properties you gave does not match the solution in\
+    													dimensionality, I am expecting " << Sys_eqs::nvar <<
+                      " properties " << std::endl;
+        };
+#endif
+#if defined(__NVCC__) && (defined(PETSC_HAVE_CUDA) || defined(PETSC_HAVE_HIP))
+        auto & A_ = getA(opt);
+
+        PetscInt row;
+        PetscInt col;
+        PetscInt row_loc;
+        PetscInt col_loc;
+        PETSC_SAFE_CALL(MatGetSize(A_.getMat(),&row,&col));
+        PETSC_SAFE_CALL(MatGetLocalSize(A_.getMat(),&row_loc,&col_loc));
+
+        Vector<double,PETSC_BASE> x(row, row_loc);
+        x.setDevice(device_solve);
+
+        NUMERICS_TRACE_SPAN("dcpse_scheme.solve");
+        metrics_pre(solver);
+        solver.solve_no_update(A_, x, getB(opt));
+        metrics_post(solver);
+
+        Vec & x_ = x.getVec();
+        const PetscScalar * xa;
+        unsigned int comp = 0;
+
+        if (device_solve == true)
+        {
+#if defined(PETSC_HAVE_CUDA)
+            PETSC_SAFE_CALL(VecCUDAGetArrayRead(x_,&xa));
+            copy_device_nested(xa, x_, comp, exps ...);
+            PETSC_SAFE_CALL(VecCUDARestoreArrayRead(x_,&xa));
+#else
+            PETSC_SAFE_CALL(VecHIPGetArrayRead(x_,&xa));
+            copy_device_nested(xa, x_, comp, exps ...);
+            PETSC_SAFE_CALL(VecHIPRestoreArrayRead(x_,&xa));
+#endif
+        }
+        else
+        {
+            PETSC_SAFE_CALL(VecGetArrayRead(x_,&xa));
+            copy_local_nested(xa, comp, exps ...);
+            PETSC_SAFE_CALL(VecRestoreArrayRead(x_,&xa));
+        }
+#else
+        solve_with_solver(solver, exps ...);
+#endif
+    }
+
+#endif
+
+#ifdef HAVE_PETSC
+
+    /*! \brief Solve an equation with a PETSc solver
+     *
+     * The solution is not copied in the row values of a Vector (Vector::update), the properties are filled
+     * from the local array of the PETSc vector
+     *
+     *  \warning exp must be a scalar type
+     *
+     * \param solver petsc solver
+     * \param exp where to store the result
+     *
+     */
+    template<typename ... expr_type>
+    void solve_with_solver(petsc_solver<double> &solver, expr_type ... exps) {
+#ifdef SE_CLASS1
+
+        if (sizeof...(exps) != Sys_eqs::nvar) {
+            std::cerr << __FILE__ << ":" << __LINE__ << " Error the number of properties you gave does not match the solution in\
+    													dimensionality, I am expecting " << Sys_eqs::nvar <<
+                      " properties " << std::endl;
+        };
+#endif
+        if (block_assembly == true) {
+            Mat & N_ = getNestMat();
+
+            PetscInt row;
+            PetscInt col;
+            PetscInt row_loc;
+            PetscInt col_loc;
+            PETSC_SAFE_CALL(MatGetSize(N_,&row,&col));
+            PETSC_SAFE_CALL(MatGetLocalSize(N_,&row_loc,&col_loc));
+
+            Vector<double,PETSC_BASE> x(row, row_loc);
+
+            NUMERICS_TRACE_SPAN("dcpse_scheme.solve");
+            metrics_pre(solver);
+            solver.solve_no_update(N_, x.getVec(), getB(opt));
+            metrics_post(solver);
+
+            unsigned int comp = 0;
+            copy_nested(x, comp, exps ...);
+            return;
+        }
+
+        auto & A_ = getA(opt);
+
+        PetscInt row;
+        PetscInt col;
+        PetscInt row_loc;
+        PetscInt col_loc;
+        PETSC_SAFE_CALL(MatGetSize(A_.getMat(),&row,&col));
+        PETSC_SAFE_CALL(MatGetLocalSize(A_.getMat(),&row_loc,&col_loc));
+
+        Vector<double,PETSC_BASE> x(row, row_loc);
+        x.setDevice(device_solve);
+
+        NUMERICS_TRACE_SPAN("dcpse_scheme.solve");
+        metrics_pre(solver);
+        solver.solve_no_update(A_, x, getB(opt));
+        metrics_post(solver);
+
+        unsigned int comp = 0;
+        copy_nested(x, comp, exps ...);
+    }
+
+    /*! \brief Solve a scalar equation writing the solution directly in the property prp
+     *
+     * The PETSc solution vector is created with VecCreateMPIWithArray over the memory of the property, so the
+     * solver writes there and nothing is copied. It needs one unknown per particle, options_solver::STANDARD, a
+     * host solve and a property stored contiguously (a layout with one array per property, or a particle set
+     * with only this property), otherwise it works as solve_with_solver
+     *
+     * \tparam prp property of the particles where to store the solution
+     *
+     * \param solver petsc solver
+     *
+     */
+    template<unsigned int prp>
+    void solve_with_solver_in_place(petsc_solver<double> &solver) {
+        typedef typename boost::mpl::at<typename particles_type::value_type::type,boost::mpl::int_<prp>>::type prop_type;
+
+        static_assert(Sys_eqs::nvar == 1,"solve_with_solver_in_place needs one unknown per particle");
+        static_assert(std::is_same<prop_type,PetscScalar>::value,"solve_with_solver_in_place needs a property of type PetscScalar");
+
+        auto & v_cl = create_vcluster();
+        auto & A_ = getA(opt);
+
+        PetscInt row;
+        PetscInt col;
+        PetscInt row_loc;
+        PetscInt col_loc;
+        PETSC_SAFE_CALL(MatGetSize(A_.getMat(),&row,&col));
+        PETSC_SAFE_CALL(MatGetLocalSize(A_.getMat(),&row_loc,&col_loc));
+
+        size_t nLoc = parts.size_local();
+        PetscScalar * xa = (nLoc != 0) ? &parts.template getProp<prp>(0) : NULL;
+
+        // every processor must agree
+        size_t in_place = (device_solve == false && (size_t)row_loc == nLoc &&
+                           (nLoc < 2 || &parts.template getProp<prp>(1) == xa + 1)) ? 1 : 0;
+        v_cl.min(in_place);
+        v_cl.execute();
+
+        if (in_place == 0) {
+            solve_with_solver(solver, getV<prp>(parts));
+            return;
+        }
+
+        Vec x_;
+        PETSC_SAFE_CALL(VecCreateMPIWithArray(PETSC_COMM_WORLD, 1, row_loc, row, xa, &x_));
+
+        NUMERICS_TRACE_SPAN("dcpse_scheme.solve");
+        metrics_pre(solver);
+        solver.solve_no_update(A_, x_, getB(opt));
+        metrics_post(solver);
+
+        PETSC_SAFE_CALL(VecDestroy(&x_));
+    }
+
+#endif
+
+    /*! \brief Solve an equation
+     *
+     *  \warning exp must be a scalar type
+     *
+     * \param Solver Manually created Solver instead from the Equation structure
+     * \param exp where to store the result
+     *
+     */
+    template<typename SolverType, typename ... expr_type>
+    void solve_with_solver(SolverType &solver, expr_type ... exps) {
+#ifdef SE_CLASS1
+
         if (sizeof...(exps) != Sys_eqs::nvar) {
             std::cerr << __FILE__ << ":" << __LINE__ << " Error the number of properties you gave does not match the solution in\
     													dimensionality, I am expecting " << Sys_eqs::nvar <<
                       " properties " << std::endl;
         };
-        typename Sys_eqs::solver_type solver;
-//        umfpack_solver<double> solver;
+#endif
+        NUMERICS_TRACE_SPAN("dcpse_scheme.solve");
+        metrics_pre(solver);
         auto x = solver.solve(getA(opt), getB(opt));
+        metrics_post(solver);
 
         unsigned int comp = 0;
         copy_nested(x, comp, exps ...);
     }
 
-    /*! \brief Solve an equation
+    /*! \brief Solve an equation starting from an initial guess extrapolated from the previous solutions
+     *
+     * For time dependent problems (setInitialGuessExtrapolation): the initial guess is the polynomial extrapolation
+     * of the last k solutions computed with this function, the first solve start from zero. The solutions are
+     * stored in the scheme, reset_extrapolation (or reset on new particles) drop them
      *
      *  \warning exp must be a scalar type
      *
@@ -400,7 +1259,7 @@ public:
      *
      */
     template<typename SolverType, typename ... expr_type>
-    void solve_with_solver(SolverType &solver, expr_type ... exps) {
+    void solve_with_solver_extrapolated(SolverType &solver,expr_type ... exps) {
 #ifdef SE_CLASS1
 
         if (sizeof...(exps) != Sys_eqs::nvar) {
@@ -409,7 +1268,28 @@ public:
                       " properties " << std::endl;
         };
 #endif
-        auto x = solver.solve(getA(opt), getB(opt));
+        if (ig_k == 0 || ig_hist.size() == 0 || ig_hist.back().size() != p_map->size_local() * Sys_eqs::nvar)
+        {
+            ig_hist.clear();
+
+            NUMERICS_TRACE_SPAN("dcpse_scheme.solve");
+            metrics_pre(solver);
+            auto x = solver.solve(getA(opt),getB(opt));
+            metrics_post(solver);
+            if (ig_k != 0)	{store_solution(x);}
+
+            unsigned int comp = 0;
+            copy_nested(x, comp, exps ...);
+            return;
+        }
+
+        extrapolate_x_ig();
+
+        NUMERICS_TRACE_SPAN("dcpse_scheme.solve");
+        metrics_pre(solver);
+        auto x = solver.solve(getA(opt),get_x_ig(opt),getB(opt));
+        metrics_post(solver);
+        store_solution(x);
 
         unsigned int comp = 0;
         copy_nested(x, comp, exps ...);
@@ -433,7 +1313,10 @@ public:
                       " properties " << std::endl;
         };
 #endif
+        NUMERICS_TRACE_SPAN("dcpse_scheme.solve");
+        metrics_pre(solver);
         auto x = solver.solve(getA(opt),get_x_ig(opt),getB(opt));
+        metrics_post(solver);
 
         unsigned int comp = 0;
         copy_nested(x, comp, exps ...);
@@ -457,7 +1340,10 @@ public:
                       " properties " << std::endl;
         };
 #endif
+        NUMERICS_TRACE_SPAN("dcpse_scheme.solve");
+        metrics_pre(solver);
         auto x = solver.solve_successive(getB(opt));
+        metrics_post(solver);
 
         unsigned int comp = 0;
         copy_nested(x, comp, exps ...);
@@ -481,13 +1367,19 @@ public:
                       " properties " << std::endl;
         };
 #endif
+        NUMERICS_TRACE_SPAN("dcpse_scheme.solve");
+        metrics_pre(solver);
         auto x = solver.solve_successive(get_x_ig(opt),getB(opt));
+        metrics_post(solver);
 
         unsigned int comp = 0;
         copy_nested(x, comp, exps ...);
     }
 
     /*! \brief Solve an equation with a given Nullspace
+     *
+     * The nullspace is the one set on the solver with petsc_solver::setNullSpace, it is built once and reused
+     * by every solve
      *
      *  \warning exp must be a scalar type
      *
@@ -495,8 +1387,8 @@ public:
      * \param exp where to store the result
      *
      */
-/*    template<typename NullspaceType, typename SolverType, typename ... expr_type>
-    void solve_with_nullspace_solver(NullspaceType &nullspace,SolverType &solver, expr_type ... exps) {
+    template<typename SolverType, typename ... expr_type>
+    void solve_with_nullspace_solver(SolverType &solver, expr_type ... exps) {
 #ifdef SE_CLASS1
 
         if (sizeof...(exps) != Sys_eqs::nvar) {
@@ -505,13 +1397,19 @@ public:
                       " properties " << std::endl;
         };
 #endif
-        auto x = solver.nullspace_solve(nullspace,getA(opt), getB(opt));
+        NUMERICS_TRACE_SPAN("dcpse_scheme.solve");
+        metrics_pre(solver);
+        auto x = solver.nullspace_solve(getA(opt), getB(opt));
+        metrics_post(solver);
 
         unsigned int comp = 0;
         copy_nested(x, comp, exps ...);
-    }*/
+    }
 
-    /*! \brief Solve an equation with a constant Nullspace from PETSC Hack
+    /*! \brief Solve an equation with a constant Nullspace
+     *
+     * The solver keep the nullspace between calls (petsc_solver::with_constant_nullspace_solve), repeated solves
+     * on the same particles do not build it again
      *
      *  \warning exp must be a scalar type
      *
@@ -529,7 +1427,10 @@ public:
                       " properties " << std::endl;
         };
 #endif
-        auto x = solver.with_nullspace_solve(getA(opt), getB(opt));
+        NUMERICS_TRACE_SPAN("dcpse_scheme.solve");
+        metrics_pre(solver);
+        auto x = solver.with_constant_nullspace_solve(getA(opt), getB(opt));
+        metrics_post(solver);
 
         unsigned int comp = 0;
         copy_nested(x, comp, exps ...);
@@ -550,6 +1451,7 @@ public:
                       " properties " << std::endl;
         };
 
+        NUMERICS_TRACE_SPAN("dcpse_scheme.solve");
         auto x = solver.try_solve(getA(opt), getB(opt));
 
         unsigned int comp = 0;
@@ -571,12 +1473,50 @@ public:
     	row_b = 0;
         row_x_ig = 0;
 
+        // the previous solutions are on the old particles
+        ig_hist.clear();
+        assembly_time = 0.0;
+
+
+    	A.getMatrixTriplets().clear();
+        mf_rows.clear();
+
+#ifdef HAVE_PETSC
+        // the blocks are on the old particles
+        clear_blocks();
+#endif
+
+        // the numbering can be shared, a new one is built
+        rmap.reset();
+        acquire_pmap(NULL);
+    	construct_pmap(opt);
+    }
 
-        p_map.clear();
-    	p_map.resize(part.size_local());
+    /*! \brief Reset the scheme, taking the numbering of the particles from a shared row map
+     *
+     * \param part particle set
+     * \param rm shared row map
+     * \param opt solver options
+     *
+     */
+    void reset(particles_type &part, row_map<p_map_type> & rm, options_solver opt = options_solver::STANDARD)
+    {
+    	row = 0;
+    	row_b = 0;
+        row_x_ig = 0;
+        ig_hist.clear();
+        assembly_time = 0.0;
 
     	A.getMatrixTriplets().clear();
+        mf_rows.clear();
+
+#ifdef HAVE_PETSC
+        // the blocks are on the old particles
+        clear_blocks();
+#endif
 
+        rmap.reset();
+        acquire_pmap(&rm);
     	construct_pmap(opt);
     }
 
@@ -585,8 +1525,238 @@ public:
     	row = 0;
     	row_b = 0;
         row_x_ig = 0;
+        assembly_time = 0.0;
 
     	A.getMatrixTriplets().clear();
+        mf_rows.clear();
+    }
+
+    /*! \brief Return the metrics of the last solve
+     *
+     * Assembly time (operators imposed since the last reset), and for solvers with metrics (petsc_solver,
+     * umfpack_solver) fill, set-up and solve times, iterations, residuals and estimated bytes and flops.
+     * With petsc_solver the first call after a solve reduces them, so it is collective
+     *
+     * \return the metrics
+     *
+     */
+    const solver_metrics & getMetrics() const
+    {
+        metrics.reduce();
+
+        return metrics;
+    }
+
+    /*! \brief Memory used by the scheme in byte on this processor
+     *
+     * Matrix (triplets and assembled storage), b, initial guess and its history, and the row map. The row map
+     * can be shared with other schemes (row_map), in that case it is counted by all of them
+     *
+     * \return the memory in byte
+     *
+     */
+    size_t getMemoryUsage() const
+    {
+        size_t mem = A.getMemoryUsage() + b.getMemoryUsage() + x_ig.getMemoryUsage() + pnt.size()*sizeof(size_t);
+
+        for (size_t i = 0; i < ig_hist.size(); i++)
+            mem += ig_hist[i].size()*sizeof(typename Sys_eqs::stype);
+
+#ifdef HAVE_PETSC
+        for (size_t i = 0; i < Sys_eqs::nvar; i++)
+        {
+            for (size_t j = 0; j < Sys_eqs::nvar; j++)
+            {
+                for (auto it = blocks.begin(); it != blocks.end(); ++it)
+                    mem += it->second.trpl[i][j].size()*sizeof(typename block_matrix_type::triplet_type);
+
+                if (nest_blk[i][j])
+                    mem += nest_blk[i][j]->getMemoryUsage();
+            }
+        }
+#endif
+
+        if (p_map != NULL)
+            mem += particlesMemoryUsage(*p_map);
+
+        return mem;
+    }
+
+    /*! \brief Extrapolate the initial guess of solve_with_solver_extrapolated from the last k solutions
+     *
+     * k = 1 start from the previous solution, k = 2 is a linear extrapolation, k = 3 a quadratic one. For
+     * smooth time evolutions with constant time step the guess error decrease with k, higher k amplify the noise
+     *
+     * \param k number of solutions to keep (0 disable the extrapolation)
+     *
+     */
+    void setInitialGuessExtrapolation(size_t k)
+    {
+        ig_k = k;
+
+        while (ig_hist.size() > ig_k)
+        {ig_hist.erase(ig_hist.begin());}
+    }
+
+    //! drop the solutions stored for the initial guess extrapolation
+    void reset_extrapolation()
+    {
+        ig_hist.clear();
+    }
+
+    /*! \brief Matrix free mode
+     *
+     * The operators imposed after this call (on a subset or on an iterator with impose_git) are not assembled: they
+     * are kept and evaluated through their DCPSE kernels at every multiplication of solve_matrix_free. The right hand
+     * side is filled as usual. Only options_solver::STANDARD is supported
+     *
+     * \param mf true to activate the matrix free mode
+     *
+     */
+    void setMatrixFree(bool mf)
+    {
+        matrix_free = mf;
+    }
+
+    /*! \brief Keep the sparsity pattern of the matrix between assemblies (refill values mode)
+     *
+     * For repeated solves where only the coefficients change: call reset_nodec(), impose the same operators on
+     * the same subsets in the same order and solve again. The matrix keeps its pattern (and PETSc its
+     * preallocation) and only the values are overwritten. Together with petsc_solver::setReusePreconditioner
+     * the preconditioner setup is kept too
+     *
+     * \param reuse true to keep the pattern
+     *
+     */
+    void reuse_pattern(bool reuse)
+    {
+        A.reusePattern(reuse);
+
+#ifdef HAVE_PETSC
+        block_reuse = reuse;
+        for (size_t i = 0 ; i < Sys_eqs::nvar ; i++)
+        {
+            for (size_t j = 0 ; j < Sys_eqs::nvar ; j++)
+            {
+                if (nest_blk[i][j])	{nest_blk[i][j]->reusePattern(reuse);}
+            }
+        }
+#endif
+    }
+
+#ifdef HAVE_PETSC
+
+    /*! \brief Block assembly mode, the matrix is a MatNest of one PETSc matrix for every couple equation-variable
+     *
+     * Every operator is imposed in a named block (selectBlock), its columns of the variable j in the block (id,j)
+     * of the nest. Between solves (reset_nodec) the named blocks are kept: reset_block drops the operators of one of
+     * them to impose it again, and only the blocks of the nest it touches are filled again, for example the advection
+     * in a coupled system while the pressure gradient stay. A row can be imposed by several named blocks on
+     * different variables, the right hand side is the one of the last impose (impose_b). The system is solved with
+     * solve_with_solver and a petsc_solver, the nest works with the field split preconditioners
+     * (petsc_solver::setPreconditionerFieldSplit), PCJACOBI or PCNONE. Only options_solver::STANDARD is supported.
+     * It must be called before imposing the operators
+     *
+     * \param ba true to activate the block assembly
+     *
+     */
+    void setBlockAssembly(bool ba)
+    {
+        if (ba == true && opt != options_solver::STANDARD)
+        {
+            std::cerr << __FILE__ << ":" << __LINE__ << " error, the block assembly supports only options_solver::STANDARD" << std::endl;
+            return;
+        }
+
+        block_assembly = ba;
+    }
+
+    /*! \brief Select the named block where the next operators are imposed (created if it does not exist)
+     *
+     * \param name name of the block
+     *
+     */
+    void selectBlock(const std::string & name)
+    {
+        cur_block = &blocks[name];
+    }
+
+    /*! \brief Drop the operators of a named block and select it, to impose them again
+     *
+     * \param name name of the block
+     *
+     */
+    void reset_block(const std::string & name)
+    {
+        named_block & nb = blocks[name];
+
+        for (size_t i = 0 ; i < Sys_eqs::nvar ; i++)
+        {
+            for (size_t j = 0 ; j < Sys_eqs::nvar ; j++)
+            {nb.trpl[i][j].clear();}
+        }
+
+        nb.dirty = true;
+        cur_block = &nb;
+    }
+
+    /*! \brief Return the MatNest of the block assembly, filling the blocks touched by the named blocks imposed again
+     *
+     * \return the MatNest
+     *
+     */
+    Mat & getNestMat()
+    {
+        NUMERICS_TRACE_SPAN("dcpse_scheme.fill");
+        fill_nest();
+
+        return nest;
+    }
+
+    /*! \brief Number of blocks of the nest filled since the scheme was created
+     *
+     * \return the number of fills
+     *
+     */
+    size_t getNBlockFills() const
+    {
+        return n_block_fill;
+    }
+
+#endif
+
+    /*! \brief Store the matrix in blocks of size Sys_eqs::nvar
+     *
+     * The unknowns of a particle are interleaved (row = particle*nvar + component), with the PETSc backend the
+     * matrix become BAIJ (or SBAIJ when symmetric) with one dense nvar x nvar block for every couple of particles.
+     * With options_solver::LAGRANGE_MULTIPLIER the extra row break the blocks and the matrix stay AIJ. It must be
+     * called before imposing the operators
+     *
+     * \param symmetric the system is symmetric and only the upper triangular blocks are stored
+     *
+     */
+    void block_matrix(bool symmetric = false)
+    {
+        A.setBlockSize(Sys_eqs::nvar,symmetric);
+    }
+
+    /*! \brief Store matrix and vectors of the system on the GPU
+     *
+     * With the PETSc backend the matrix become AIJCUSPARSE/AIJHIPSPARSE and the vectors CUDA/HIP vectors, so the
+     * Krylov iterations run on the device, use solve_with_solver_device to get the solution in the particle
+     * properties on the device. The matrix is still imposed from the host triplets and moved to the device once
+     * at the assembly. The Eigen backend ignore it. It must be called before imposing the operators
+     *
+     * \param dev true to solve on the device
+     *
+     */
+    void setDeviceSolve(bool dev)
+    {
+        device_solve = dev;
+
+        A.setDevice(dev);
+        b.setDevice(dev);
+        x_ig.setDevice(dev);
     }
 
     /*! \brief Constructor for the solver
@@ -597,12 +1767,37 @@ public:
      *
      */
     DCPSE_scheme(particles_type &part, options_solver opt = options_solver::STANDARD)
-            : parts(part), p_map(part.getDecomposition(), 0), row(0), row_b(0), opt(opt) {
-        p_map.resize(part.size_local());
+            : parts(part), row(0), row_b(0), opt(opt) {
+        acquire_pmap(NULL);
+        construct_pmap(opt);
+    }
 
+    /*! \brief Constructor that reuse the numbering of the particles of the previous schemes on part
+     *
+     * The numbering is built by the first scheme and stored in rm, the next schemes on the same particle set take
+     * it without communications until the particles are mapped again (map counter of the particle set)
+     *
+     * \param parts Particle set
+     * \param rm shared row map
+     * \param option_solver opt=options_solver::LAGRANGE_MULTIPLIER can be used for purely Neumann system
+     *
+     */
+    DCPSE_scheme(particles_type &part, row_map<p_map_type> & rm, options_solver opt = options_solver::STANDARD)
+            : parts(part), row(0), row_b(0), opt(opt) {
+        acquire_pmap(&rm);
         construct_pmap(opt);
     }
 
+#ifdef HAVE_PETSC
+
+    ~DCPSE_scheme()
+    {
+        if (is_openfpm_init() == true)
+        {clear_blocks();}
+    }
+
+#endif
+
     /*DCPSE_scheme(particles_type &part, int option_num)
             : parts(part), p_map(part.getDecomposition(), 0), row(0), row_b(0),opt(options_solver::CUSTOM),offset(option_num) {
         p_map.resize(part.size_local());
@@ -627,11 +1822,9 @@ public:
     void impose(const T &op, openfpm::vector<index_type> &subset,
                 const prop_id<prp_id> &num,
                 eq_id id = eq_id()) {
-        auto itd = subset.template getIteratorElements<0>();
-
         variable_b<prp_id> vb(parts);
 
-        impose_git(op, vb, id.getId(), itd);
+        impose_git_subset(op, vb, id.getId(), subset);
     }
 
     /*! \brief Impose b part only in the Matrix System Ax=b
@@ -693,9 +1886,7 @@ public:
     void impose(const T &op, openfpm::vector<index_type> &subset,
                 const RHS_type &rhs,
                 eq_id id = eq_id()) {
-        auto itd = subset.template getIteratorElements<0>();
-
-        impose_git(op, rhs, id.getId(), itd);
+        impose_git_subset(op, rhs, id.getId(), subset);
     }
     /*! \brief Impose b part only in the Matrix System Ax=b
     *
@@ -750,11 +1941,9 @@ public:
                 openfpm::vector<index_type> &subset,
                 const typename Sys_eqs::stype num,
                 eq_id id = eq_id()) {
-        auto itd = subset.template getIteratorElements<0>();
-
         constant_b b(num);
 
-        impose_git(op, b, id.getId(), itd);
+        impose_git_subset(op, b, id.getId(), subset);
     }
     /*! \brief Impose b part only in the Matrix System Ax=b
     *
@@ -807,11 +1996,16 @@ public:
  */
     template<typename options>
     typename Sys_eqs::SparseMatrix_type &getA(options opt) {
+#ifdef HAVE_PETSC
+        if (block_assembly == true)
+        {std::cerr << __FILE__ << ":" << __LINE__ << " error, in block assembly mode the matrix is the nest (getNestMat), solve with a petsc_solver" << std::endl;}
+#endif
         if (A.isMatrixFilled()) return A;
+        NUMERICS_TRACE_SPAN("dcpse_scheme.fill");
         if (opt == options_solver::STANDARD) {
             A.resize(tot * Sys_eqs::nvar, tot * Sys_eqs::nvar,
-                     p_map.size_local() * Sys_eqs::nvar,
-                     p_map.size_local() * Sys_eqs::nvar);
+                     p_map->size_local() * Sys_eqs::nvar,
+                     p_map->size_local() * Sys_eqs::nvar);
         }
         else if (opt == options_solver::LAGRANGE_MULTIPLIER) {
             auto &v_cl = create_vcluster();
@@ -819,8 +2013,8 @@ public:
 
             if (v_cl.rank() == v_cl.size() - 1) {
                 A.resize(Sys_eqs::nvar * (tot + 1), Sys_eqs::nvar * (tot + 1),
-                         Sys_eqs::nvar * (p_map.size_local() + 1),
-                         Sys_eqs::nvar * (p_map.size_local() + 1));
+                         Sys_eqs::nvar * (p_map->size_local() + 1),
+                         Sys_eqs::nvar * (p_map->size_local() + 1));
 
                 for (int j = 0; j < Sys_eqs::nvar; j++) {
                     for (int i = 0; i < tot; i++) {
@@ -830,7 +2024,7 @@ public:
                         t1.value() = 1;
                         trpl.add(t1);
                     }
-                    for (int i = 0; i < p_map.size_local(); i++) {
+                    for (int i = 0; i < p_map->size_local(); i++) {
                         triplet t2;
                         t2.row() = s_pnt * Sys_eqs::nvar + i * Sys_eqs::nvar + j;
                         t2.col() = tot * Sys_eqs::nvar + j;
@@ -845,10 +2039,10 @@ public:
                 }
             } else {
                 A.resize(Sys_eqs::nvar * (tot + 1), Sys_eqs::nvar * (tot + 1),
-                         p_map.size_local() * Sys_eqs::nvar,
-                         p_map.size_local() * Sys_eqs::nvar);
+                         p_map->size_local() * Sys_eqs::nvar,
+                         p_map->size_local() * Sys_eqs::nvar);
                 for (int j = 0; j < Sys_eqs::nvar; j++) {
-                    for (int i = 0; i < p_map.size_local(); i++) {
+                    for (int i = 0; i < p_map->size_local(); i++) {
                         triplet t2;
                         t2.row() = s_pnt * Sys_eqs::nvar + i * Sys_eqs::nvar + j;
                         t2.col() = tot * Sys_eqs::nvar + j;
@@ -862,13 +2056,13 @@ public:
             auto &v_cl = create_vcluster();
             if (v_cl.rank() == v_cl.size() - 1) {
                 A.resize(tot * Sys_eqs::nvar - offset, tot * Sys_eqs::nvar - offset,
-                         p_map.size_local() * Sys_eqs::nvar - offset,
-                         p_map.size_local() * Sys_eqs::nvar - offset);
+                         p_map->size_local() * Sys_eqs::nvar - offset,
+                         p_map->size_local() * Sys_eqs::nvar - offset);
             }
             else {
                 A.resize(tot * Sys_eqs::nvar - offset, tot * Sys_eqs::nvar - offset,
-                         p_map.size_local() * Sys_eqs::nvar,
-                         p_map.size_local() * Sys_eqs::nvar);
+                         p_map->size_local() * Sys_eqs::nvar,
+                         p_map->size_local() * Sys_eqs::nvar);
             }
         }
 #ifdef SE_CLASS1
@@ -927,8 +2121,8 @@ public:
             // get the particle
             auto key = it.get();
             // Calculate the non-zero colums
-            b(p_map.template getProp<0>(key) * Sys_eqs::nvar + id) = num.get(key);
-//       std::cout << "b=(" << p_map.template getProp<0>(key)*Sys_eqs::nvar + id << "," << num.get(key)<<")" <<"\n";
+            b(p_map->template getProp<0>(key) * Sys_eqs::nvar + id) = num.get(key);
+//       std::cout << "b=(" << p_map->template getProp<0>(key)*Sys_eqs::nvar + id << "," << num.get(key)<<")" <<"\n";
 
             // if SE_CLASS1 is defined check the position
 #ifdef SE_CLASS1
@@ -949,8 +2143,8 @@ public:
             // get the particle
             auto key = it.get();
             // Calculate the non-zero colums
-            x_ig(p_map.template getProp<0>(key) * Sys_eqs::nvar + id) = num.get(key);
-//       std::cout << "b=(" << p_map.template getProp<0>(key)*Sys_eqs::nvar + id << "," << num.get(key)<<")" <<"\n";
+            x_ig(p_map->template getProp<0>(key) * Sys_eqs::nvar + id) = num.get(key);
+//       std::cout << "b=(" << p_map->template getProp<0>(key)*Sys_eqs::nvar + id << "," << num.get(key)<<")" <<"\n";
 
             // if SE_CLASS1 is defined check the position
 #ifdef SE_CLASS1
@@ -982,6 +2176,31 @@ public:
                     bop num,
                     long int id,
                     const iterator &it_d) {
+        NUMERICS_TRACE_SPAN("dcpse_scheme.impose");
+        timer t_asm;
+        t_asm.start();
+
+        // in matrix free mode the particles of the iterator become a subset
+        if (matrix_free == true)
+        {
+            openfpm::vector<aggregate<size_t>> subset;
+
+            auto it = it_d;
+            while (it.isNext()) {
+                vect_dist_key_dx key(it.get());
+
+                subset.add();
+                subset.last().template get<0>() = key.getKey();
+                ++it;
+            }
+
+            impose_matrix_free(op, num, id, subset);
+
+            t_asm.stop();
+            assembly_time += t_asm.getwct();
+            return;
+        }
+
         openfpm::vector<triplet> &trpl = A.getMatrixTriplets();
 
         auto it = it_d;
@@ -997,7 +2216,7 @@ public:
 
             // Calculate the non-zero colums
             typename Sys_eqs::stype coeff = 1.0;
-            op.template value_nz<Sys_eqs>(p_map, key, cols, coeff, 0);
+            op.template value_nz<Sys_eqs>(*p_map, key, cols, coeff, 0);
 
             // indicate if the diagonal has been set
             bool is_diag = false;
@@ -1005,7 +2224,7 @@ public:
             // create the triplet
             for (auto it2 = cols.begin(); it2 != cols.end(); ++it2) {
                 trpl.add();
-                trpl.last().row() = p_map.template getProp<0>(key) * Sys_eqs::nvar + id;
+                trpl.last().row() = p_map->template getProp<0>(key) * Sys_eqs::nvar + id;
                 trpl.last().col() = it2->first;
                 trpl.last().value() = it2->second;
                 if (trpl.last().row() == trpl.last().col())
@@ -1016,11 +2235,11 @@ public:
             if (is_diag == false)
             {
                 trpl.add();
-                trpl.last().row() = p_map.template getProp<0>(key) * Sys_eqs::nvar + id;
-                trpl.last().col() = p_map.template getProp<0>(key) * Sys_eqs::nvar + id;
+                trpl.last().row() = p_map->template getProp<0>(key) * Sys_eqs::nvar + id;
+                trpl.last().col() = p_map->template getProp<0>(key) * Sys_eqs::nvar + id;
                 trpl.last().value() = 0.0;
             }
-            b(p_map.template getProp<0>(key) * Sys_eqs::nvar + id) = num.get(key);
+            b(p_map->template getProp<0>(key) * Sys_eqs::nvar + id) = num.get(key);
             cols.clear();
 
             // if SE_CLASS1 is defined check the position
@@ -1033,6 +2252,175 @@ public:
             ++row_x_ig;
             ++it;
         }
+
+        t_asm.stop();
+        assembly_time += t_asm.getwct();
+    }
+
+
+    /*! \brief Impose an operator on the particles of a subset, assembling the rows in parallel
+     *
+     * Same result of impose_git on the subset iterator. Every thread evaluates the non-zero columns of a
+     * contiguous range of the subset into its own triplet buffer. The buffers are counted, the matrix triplets
+     * are resized once and the buffers are copied in parallel, in the order of the subset. The right hand side is
+     * evaluated in parallel and written serially, because the vector can insert new entries
+     *
+     * \param op Operator to impose (A term)
+     * \param num right hand side of the term (b term)
+     * \param id Equation id in the system that we are imposing
+     * \param subset indices of the particles where the operator is imposed
+     *
+     */
+    template<typename T, typename bop, typename index_type>
+    void impose_git_subset(const T &op,
+                           bop num,
+                           long int id,
+                           openfpm::vector<index_type> &subset) {
+        NUMERICS_TRACE_SPAN("dcpse_scheme.impose");
+        timer t_asm;
+        t_asm.start();
+
+        if (matrix_free == true)
+        {
+            impose_matrix_free(op, num, id, subset);
+
+            t_asm.stop();
+            assembly_time += t_asm.getwct();
+            return;
+        }
+
+#ifdef HAVE_PETSC
+        if (block_assembly == true)
+        {
+            impose_block(op, num, id, subset);
+
+            t_asm.stop();
+            assembly_time += t_asm.getwct();
+            return;
+        }
+#endif
+
+        openfpm::vector<triplet> &trpl = A.getMatrixTriplets();
+
+        long int n = subset.size();
+        size_t trplStart = trpl.size();
+
+        int maxThreads = 1;
+#ifdef _OPENMP
+        maxThreads = omp_get_max_threads();
+#endif
+
+        std::vector<openfpm::vector<triplet>> localTrpl(maxThreads);
+        std::vector<size_t> threadStart(maxThreads + 1, 0);
+        openfpm::vector<typename Sys_eqs::stype> rhs;
+        rhs.resize(n);
+
+        #pragma omp parallel
+        {
+            int t = 0, nt = 1;
+#ifdef _OPENMP
+            t = omp_get_thread_num();
+            nt = omp_get_num_threads();
+#endif
+            openfpm::vector<triplet> &lt = localTrpl[t];
+            tsl::hopscotch_map<long int, typename particles_type::stype> cols;
+
+            // contiguous ranges keep the triplets in the order of the subset
+            long int chunk = (n + nt - 1) / nt;
+            long int iStart = std::min(n, t * chunk);
+            long int iEnd = std::min(n, iStart + chunk);
+
+            for (long int i = iStart; i < iEnd; i++) {
+                auto key = subset.template get<0>(i);
+                long int r = p_map->template getProp<0>(key) * Sys_eqs::nvar + id;
+
+                // Calculate the non-zero colums
+                typename Sys_eqs::stype coeff = 1.0;
+                op.template value_nz<Sys_eqs>(*p_map, key, cols, coeff, 0);
+
+                // indicate if the diagonal has been set
+                bool is_diag = false;
+
+                for (auto it2 = cols.begin(); it2 != cols.end(); ++it2) {
+                    lt.add();
+                    lt.last().row() = r;
+                    lt.last().col() = it2->first;
+                    lt.last().value() = it2->second;
+                    if (it2->first == r)
+                    {is_diag = true;}
+                }
+
+                // If does not have a diagonal entry put it to zero
+                if (is_diag == false)
+                {
+                    lt.add();
+                    lt.last().row() = r;
+                    lt.last().col() = r;
+                    lt.last().value() = 0.0;
+                }
+
+                rhs.get(i) = num.get(key);
+                cols.clear();
+            }
+            threadStart[t + 1] = lt.size();
+
+            #pragma omp barrier
+            #pragma omp single
+            {
+                for (int k = 0; k < nt; k++)
+                {threadStart[k + 1] += threadStart[k];}
+                trpl.resize(trplStart + threadStart[nt]);
+            }
+
+            for (size_t j = 0; j < lt.size(); j++)
+            {trpl.get(trplStart + threadStart[t] + j) = lt.get(j);}
+        }
+
+        for (long int i = 0; i < n; i++) {
+            auto key = subset.template get<0>(i);
+            b(p_map->template getProp<0>(key) * Sys_eqs::nvar + id) = rhs.get(i);
+        }
+
+        row += n;
+        row_b += n;
+        row_x_ig += n;
+
+        t_asm.stop();
+        assembly_time += t_asm.getwct();
+    }
+
+    /*! \brief Keep the operator for the matrix free multiplication and fill the right hand side
+     *
+     * \param op Operator to impose (A term)
+     * \param num right hand side of the term (b term)
+     * \param id Equation id in the system that we are imposing
+     * \param subset indices of the particles where the operator is imposed
+     *
+     */
+    template<typename T, typename bop, typename index_type>
+    void impose_matrix_free(const T &op,
+                            bop num,
+                            long int id,
+                            openfpm::vector<index_type> &subset) {
+        std::vector<size_t> keys(subset.size());
+        for (size_t i = 0; i < subset.size(); i++) {
+            auto key = subset.template get<0>(i);
+            keys[i] = key;
+            b(p_map->template getProp<0>(key) * Sys_eqs::nvar + id) = num.get(key);
+        }
+
+        long int rowOffset = s_pnt * Sys_eqs::nvar;
+        p_map_type & pm = *p_map;
+        mf_rows.push_back([op, keys, id, rowOffset, &pm](typename Sys_eqs::stype * y) {
+            for (size_t i = 0; i < keys.size(); i++) {
+                vect_dist_key_dx key(keys[i]);
+                y[pm.template getProp<0>(key) * Sys_eqs::nvar + id - rowOffset] = op.value(key);
+            }
+        });
+
+        row += keys.size();
+        row_b += keys.size();
+        row_x_ig += keys.size();
     }
 
 };
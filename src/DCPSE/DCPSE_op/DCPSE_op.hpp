@@ -635,6 +635,88 @@ public:
     */
 
 
+/*! \brief Construct the operators of a DCPSE_op class that share the support
+ *
+ * With Dcpse the operators are built together (Dcpse::initializeGroup): one support and, for the operators with the
+ * same monomial basis, one factorization of the moment matrix per particle. The other Dcpse_type construct the first
+ * operator and the others on its support
+ *
+ */
+template<template<unsigned int, typename, typename...> class Dcpse_type, typename particles_type,
+         bool is_dcpse = std::is_same<Dcpse_type<particles_type::dims, particles_type>, Dcpse<particles_type::dims, particles_type>>::value>
+struct dcpse_construct_shared {
+    typedef Dcpse_type<particles_type::dims, particles_type> dcpse_type;
+
+    static void construct(dcpse_type *dcpse_ptr, const Point<particles_type::dims, unsigned int> *sig, size_t n,
+                          particles_type &parts, unsigned int ord, typename particles_type::stype rCut,
+                          double oversampling_factor, support_options opt) {
+        for (size_t i = 0; i < n; i++) {
+            if (i)
+                new(&dcpse_ptr[i]) dcpse_type(parts, dcpse_ptr[0], sig[i], ord, rCut, oversampling_factor, opt);
+            else
+                new(&dcpse_ptr[i]) dcpse_type(parts, sig[i], ord, rCut, oversampling_factor, opt);
+        }
+    }
+
+    static void update(dcpse_type *dcpse_ptr, size_t n, particles_type &parts) {
+        for (size_t i = 0; i < n; i++)
+            dcpse_ptr[i].initializeUpdate(parts);
+    }
+
+    //! Only Dcpse rebuilds in background, the others are rebuilt immediately
+    static void updateAsync(dcpse_type *dcpse_ptr, size_t n, particles_type &parts) {
+        update(dcpse_ptr, n, parts);
+    }
+
+    static bool finalizeUpdateAsync(dcpse_type *dcpse_ptr, size_t n, bool wait) {
+        return false;
+    }
+};
+
+template<template<unsigned int, typename, typename...> class Dcpse_type, typename particles_type>
+struct dcpse_construct_shared<Dcpse_type, particles_type, true> {
+    typedef Dcpse_type<particles_type::dims, particles_type> dcpse_type;
+
+    static void construct(dcpse_type *dcpse_ptr, const Point<particles_type::dims, unsigned int> *sig, size_t n,
+                          particles_type &parts, unsigned int ord, typename particles_type::stype rCut,
+                          double oversampling_factor, support_options opt) {
+        DcpseContext<particles_type> ctx(parts, ord, rCut, oversampling_factor, opt);
+
+        for (size_t i = 0; i < n; i++)
+            ctx.addOperator(sig[i], &dcpse_ptr[i]);
+
+        ctx.build();
+    }
+
+    static void update(dcpse_type *dcpse_ptr, size_t n, particles_type &parts) {
+        std::vector<dcpse_type *> ops;
+        for (size_t i = 0; i < n; i++)
+            ops.push_back(&dcpse_ptr[i]);
+
+        dcpse_type::initializeGroup(ops);
+    }
+
+    static void updateAsync(dcpse_type *dcpse_ptr, size_t n, particles_type &parts) {
+        std::vector<dcpse_type *> ops;
+        for (size_t i = 0; i < n; i++)
+            ops.push_back(&dcpse_ptr[i]);
+
+        dcpse_type::initializeGroupAsync(ops);
+    }
+
+    static bool finalizeUpdateAsync(dcpse_type *dcpse_ptr, size_t n, bool wait) {
+        std::vector<dcpse_type *> ops;
+        for (size_t i = 0; i < n; i++)
+            ops.push_back(&dcpse_ptr[i]);
+
+        return dcpse_type::finalizeGroupAsync(ops, wait);
+    }
+};
+
+//! The operators constructed on a DcpseContext are Dcpse
+#define DCPSE_CONTEXT_CHECK(particles_type) static_assert(std::is_same<Dcpse_type<particles_type::dims, particles_type>, \
+        Dcpse<particles_type::dims, particles_type>>::value, "the operators on a DcpseContext must use Dcpse as Dcpse_type")
+
 /*! \brief Class for Creating the DCPSE Operator Dx and objects and computes DCPSE Kernels.
  *
  *
@@ -676,6 +758,23 @@ public:
         dcpse = new Dcpse_type<particles_type::dims, particles_type>(parts, p, ord, rCut, oversampling_factor, opt);
     }
 
+    /*! \brief Register the operator on a DcpseContext, the kernels are computed by DcpseContext::build
+     *
+     * \param parts particle set
+     * \param ctx context with the support and the factorizations shared with the other operators
+     *
+     */
+    template<typename particles_type>
+    Derivative_x_T(particles_type &parts, DcpseContext<particles_type> &ctx) {
+        DCPSE_CONTEXT_CHECK(particles_type);
+
+        Point<particles_type::dims, unsigned int> p;
+        p.zero();
+        p.get(0) = 1;
+
+        dcpse = ctx.addOperator(p);
+    }
+
     template<typename particles_type>
     void deallocate(particles_type &parts) {
         delete (Dcpse_type<particles_type::dims, particles_type> *) dcpse;
@@ -742,6 +841,76 @@ public:
 
     }
 
+    /*! \brief Rebuild the DCPSE Kernels in background, the current kernels are used until finalizeUpdateAsync
+     *
+     * The particles must not be mapped before the swap (see Dcpse::initializeGroupAsync)
+     *
+     * \param parts particle set
+     */
+    template<typename particles_type>
+    void updateAsync(particles_type &particles) {
+        auto dcpse_temp = (Dcpse_type<particles_type::dims, particles_type> *) dcpse;
+        dcpse_construct_shared<Dcpse_type, particles_type>::updateAsync(dcpse_temp, 1, particles);
+    }
+
+    /*! \brief Swap in the kernels rebuilt by updateAsync
+     *
+     * \param parts particle set
+     * \param wait wait for the rebuild if it is still running
+     *
+     * \return true if the new kernels are in use
+     */
+    template<typename particles_type>
+    bool finalizeUpdateAsync(particles_type &particles, bool wait = false) {
+        auto dcpse_temp = (Dcpse_type<particles_type::dims, particles_type> *) dcpse;
+        return dcpse_construct_shared<Dcpse_type, particles_type>::finalizeUpdateAsync(dcpse_temp, 1, wait);
+    }
+
+    /*! \brief Memory used by the operator in byte (see Dcpse::getMemoryUsage)
+     *
+     * \param parts particle set
+     */
+    template<typename particles_type>
+    size_t getMemoryUsage(particles_type &particles) {
+        auto dcpse_temp = (Dcpse_type<particles_type::dims, particles_type> *) dcpse;
+        return dcpse_temp->getMemoryUsage();
+    }
+
+    /*! \brief Remove the neighbours with a negligible weight and recompute the kernels (see Dcpse::pruneKernels)
+     *
+     * \param parts particle set
+     * \param threshold relative weight under which a neighbour is removed
+     *
+     * \return the number of weights removed on all the processors
+     */
+    template<typename particles_type>
+    size_t pruneKernels(particles_type &particles, typename particles_type::stype threshold) {
+        auto dcpse_temp = (Dcpse_type<particles_type::dims, particles_type> *) dcpse;
+        return dcpse_temp->pruneKernels(particles, threshold);
+    }
+
+    /*! \brief Materialise the operator as a sparse matrix (see Dcpse::getSparseMatrix)
+     *
+     * \param parts particle set
+     * \param M sparse matrix
+     */
+    template<typename particles_type, typename SparseMatrix_type>
+    void getSparseMatrix(particles_type &particles, SparseMatrix_type &M) {
+        auto dcpse_temp = (Dcpse_type<particles_type::dims, particles_type> *) dcpse;
+        dcpse_temp->getSparseMatrix(M);
+    }
+
+    /*! \brief Apply the operator to prp1 and store the result in prp2, the ghost of prp1 is exchanged while
+     *         the interior particles are evaluated (see Dcpse::computeDifferentialOperatorOverlap)
+     *
+     * \param parts particle set
+     */
+    template<unsigned int prp1, unsigned int prp2, typename particles_type>
+    void computeOverlap(particles_type &particles) {
+        auto dcpse_temp = (Dcpse_type<particles_type::dims, particles_type> *) dcpse;
+        dcpse_temp->template computeDifferentialOperatorOverlap<prp1, prp2>(particles);
+    }
+
 };
 
 /*! \brief Class for Creating the DCPSE Operator Dy and objects and computes DCPSE Kernels.
@@ -786,6 +955,23 @@ public:
         dcpse = new Dcpse_type<particles_type::dims, particles_type>(parts, p, ord, rCut, oversampling_factor, opt);
     }
 
+    /*! \brief Register the operator on a DcpseContext, the kernels are computed by DcpseContext::build
+     *
+     * \param parts particle set
+     * \param ctx context with the support and the factorizations shared with the other operators
+     *
+     */
+    template<typename particles_type>
+    Derivative_y_T(particles_type &parts, DcpseContext<particles_type> &ctx) {
+        DCPSE_CONTEXT_CHECK(particles_type);
+
+        Point<particles_type::dims, unsigned int> p;
+        p.zero();
+        p.get(1) = 1;
+
+        dcpse = ctx.addOperator(p);
+    }
+
     template<typename particles_type>
     void deallocate(particles_type &parts) {
         delete (Dcpse_type<particles_type::dims, particles_type> *) dcpse;
@@ -845,6 +1031,76 @@ public:
         dcpse_temp->initializeUpdate(particles);
 
     }
+
+    /*! \brief Rebuild the DCPSE Kernels in background, the current kernels are used until finalizeUpdateAsync
+     *
+     * The particles must not be mapped before the swap (see Dcpse::initializeGroupAsync)
+     *
+     * \param parts particle set
+     */
+    template<typename particles_type>
+    void updateAsync(particles_type &particles) {
+        auto dcpse_temp = (Dcpse_type<particles_type::dims, particles_type> *) dcpse;
+        dcpse_construct_shared<Dcpse_type, particles_type>::updateAsync(dcpse_temp, 1, particles);
+    }
+
+    /*! \brief Swap in the kernels rebuilt by updateAsync
+     *
+     * \param parts particle set
+     * \param wait wait for the rebuild if it is still running
+     *
+     * \return true if the new kernels are in use
+     */
+    template<typename particles_type>
+    bool finalizeUpdateAsync(particles_type &particles, bool wait = false) {
+        auto dcpse_temp = (Dcpse_type<particles_type::dims, particles_type> *) dcpse;
+        return dcpse_construct_shared<Dcpse_type, particles_type>::finalizeUpdateAsync(dcpse_temp, 1, wait);
+    }
+
+    /*! \brief Memory used by the operator in byte (see Dcpse::getMemoryUsage)
+     *
+     * \param parts particle set
+     */
+    template<typename particles_type>
+    size_t getMemoryUsage(particles_type &particles) {
+        auto dcpse_temp = (Dcpse_type<particles_type::dims, particles_type> *) dcpse;
+        return dcpse_temp->getMemoryUsage();
+    }
+
+    /*! \brief Remove the neighbours with a negligible weight and recompute the kernels (see Dcpse::pruneKernels)
+     *
+     * \param parts particle set
+     * \param threshold relative weight under which a neighbour is removed
+     *
+     * \return the number of weights removed on all the processors
+     */
+    template<typename particles_type>
+    size_t pruneKernels(particles_type &particles, typename particles_type::stype threshold) {
+        auto dcpse_temp = (Dcpse_type<particles_type::dims, particles_type> *) dcpse;
+        return dcpse_temp->pruneKernels(particles, threshold);
+    }
+
+    /*! \brief Materialise the operator as a sparse matrix (see Dcpse::getSparseMatrix)
+     *
+     * \param parts particle set
+     * \param M sparse matrix
+     */
+    template<typename particles_type, typename SparseMatrix_type>
+    void getSparseMatrix(particles_type &particles, SparseMatrix_type &M) {
+        auto dcpse_temp = (Dcpse_type<particles_type::dims, particles_type> *) dcpse;
+        dcpse_temp->getSparseMatrix(M);
+    }
+
+    /*! \brief Apply the operator to prp1 and store the result in prp2, the ghost of prp1 is exchanged while
+     *         the interior particles are evaluated (see Dcpse::computeDifferentialOperatorOverlap)
+     *
+     * \param parts particle set
+     */
+    template<unsigned int prp1, unsigned int prp2, typename particles_type>
+    void computeOverlap(particles_type &particles) {
+        auto dcpse_temp = (Dcpse_type<particles_type::dims, particles_type> *) dcpse;
+        dcpse_temp->template computeDifferentialOperatorOverlap<prp1, prp2>(particles);
+    }
 };
 
 /*! \brief Class for Creating the DCPSE Operator Dz and objects and computes DCPSE Kernels.
@@ -888,6 +1144,23 @@ public:
         dcpse = new Dcpse_type<particles_type::dims, particles_type>(parts, p, ord, rCut, oversampling_factor, opt);
     }
 
+    /*! \brief Register the operator on a DcpseContext, the kernels are computed by DcpseContext::build
+     *
+     * \param parts particle set
+     * \param ctx context with the support and the factorizations shared with the other operators
+     *
+     */
+    template<typename particles_type>
+    Derivative_z_T(particles_type &parts, DcpseContext<particles_type> &ctx) {
+        DCPSE_CONTEXT_CHECK(particles_type);
+
+        Point<particles_type::dims, unsigned int> p;
+        p.zero();
+        p.get(2) = 1;
+
+        dcpse = ctx.addOperator(p);
+    }
+
     template<typename particles_type>
     void deallocate(particles_type &parts) {
         delete (Dcpse_type<particles_type::dims, particles_type> *) dcpse;
@@ -933,6 +1206,76 @@ public:
 
     }
 
+    /*! \brief Rebuild the DCPSE Kernels in background, the current kernels are used until finalizeUpdateAsync
+     *
+     * The particles must not be mapped before the swap (see Dcpse::initializeGroupAsync)
+     *
+     * \param parts particle set
+     */
+    template<typename particles_type>
+    void updateAsync(particles_type &particles) {
+        auto dcpse_temp = (Dcpse_type<particles_type::dims, particles_type> *) dcpse;
+        dcpse_construct_shared<Dcpse_type, particles_type>::updateAsync(dcpse_temp, 1, particles);
+    }
+
+    /*! \brief Swap in the kernels rebuilt by updateAsync
+     *
+     * \param parts particle set
+     * \param wait wait for the rebuild if it is still running
+     *
+     * \return true if the new kernels are in use
+     */
+    template<typename particles_type>
+    bool finalizeUpdateAsync(particles_type &particles, bool wait = false) {
+        auto dcpse_temp = (Dcpse_type<particles_type::dims, particles_type> *) dcpse;
+        return dcpse_construct_shared<Dcpse_type, particles_type>::finalizeUpdateAsync(dcpse_temp, 1, wait);
+    }
+
+    /*! \brief Memory used by the operator in byte (see Dcpse::getMemoryUsage)
+     *
+     * \param parts particle set
+     */
+    template<typename particles_type>
+    size_t getMemoryUsage(particles_type &particles) {
+        auto dcpse_temp = (Dcpse_type<particles_type::dims, particles_type> *) dcpse;
+        return dcpse_temp->getMemoryUsage();
+    }
+
+    /*! \brief Remove the neighbours with a negligible weight and recompute the kernels (see Dcpse::pruneKernels)
+     *
+     * \param parts particle set
+     * \param threshold relative weight under which a neighbour is removed
+     *
+     * \return the number of weights removed on all the processors
+     */
+    template<typename particles_type>
+    size_t pruneKernels(particles_type &particles, typename particles_type::stype threshold) {
+        auto dcpse_temp = (Dcpse_type<particles_type::dims, particles_type> *) dcpse;
+        return dcpse_temp->pruneKernels(particles, threshold);
+    }
+
+    /*! \brief Materialise the operator as a sparse matrix (see Dcpse::getSparseMatrix)
+     *
+     * \param parts particle set
+     * \param M sparse matrix
+     */
+    template<typename particles_type, typename SparseMatrix_type>
+    void getSparseMatrix(particles_type &particles, SparseMatrix_type &M) {
+        auto dcpse_temp = (Dcpse_type<particles_type::dims, particles_type> *) dcpse;
+        dcpse_temp->getSparseMatrix(M);
+    }
+
+    /*! \brief Apply the operator to prp1 and store the result in prp2, the ghost of prp1 is exchanged while
+     *         the interior particles are evaluated (see Dcpse::computeDifferentialOperatorOverlap)
+     *
+     * \param parts particle set
+     */
+    template<unsigned int prp1, unsigned int prp2, typename particles_type>
+    void computeOverlap(particles_type &particles) {
+        auto dcpse_temp = (Dcpse_type<particles_type::dims, particles_type> *) dcpse;
+        dcpse_temp->template computeDifferentialOperatorOverlap<prp1, prp2>(particles);
+    }
+
     template<typename particles_type>
     void checkMomenta(particles_type &particles) {
         auto dcpse_temp = (Dcpse_type<particles_type::dims, particles_type> *) dcpse;
@@ -986,16 +1329,37 @@ public:
 
         Dcpse_type<particles_type::dims, particles_type> *dcpse_ptr = (Dcpse_type<particles_type::dims, particles_type> *) dcpse;
 
+        Point<particles_type::dims, unsigned int> p[particles_type::dims];
         for (int i = 0; i < particles_type::dims; i++) {
-            Point<particles_type::dims, unsigned int> p;
-            p.zero();
-            p.get(i) = 1;
+            p[i].zero();
+            p[i].get(i) = 1;
+        }
 
-            if (i)
-                new(&dcpse_ptr[i]) Dcpse_type<particles_type::dims, particles_type>(parts, dcpse_ptr[0], p, ord, rCut, oversampling_factor, opt);
-            else
-                new(&dcpse_ptr[i]) Dcpse_type<particles_type::dims, particles_type>(parts, p, ord, rCut, oversampling_factor, opt);
+        dcpse_construct_shared<Dcpse_type, particles_type>::construct(dcpse_ptr, p, particles_type::dims, parts, ord, rCut, oversampling_factor, opt);
+    }
+
+    /*! \brief Register the operator on a DcpseContext, the kernels are computed by DcpseContext::build
+     *
+     * \param parts particle set
+     * \param ctx context with the support and the factorizations shared with the other operators
+     *
+     */
+    template<typename particles_type>
+    Gradient_T(particles_type &parts, DcpseContext<particles_type> &ctx) {
+        DCPSE_CONTEXT_CHECK(particles_type);
+        typedef Dcpse_type<particles_type::dims, particles_type> DCPSE_type;
+
+        dcpse = new unsigned char[particles_type::dims * sizeof(DCPSE_type)];
+
+        DCPSE_type *dcpse_ptr = (DCPSE_type *) dcpse;
+        Point<particles_type::dims, unsigned int> p[particles_type::dims];
+        for (int i = 0; i < particles_type::dims; i++) {
+            p[i].zero();
+            p[i].get(i) = 1;
         }
+
+        for (int i = 0; i < particles_type::dims; i++)
+            ctx.addOperator(p[i], &dcpse_ptr[i]);
     }
 
     template<typename particles_type>
@@ -1032,10 +1396,47 @@ public:
     template<typename particles_type>
     void update(particles_type &particles) {
         Dcpse_type<particles_type::dims, particles_type> *dcpse_ptr = (Dcpse_type<particles_type::dims, particles_type> *) dcpse;
+        dcpse_construct_shared<Dcpse_type, particles_type>::update(dcpse_ptr, particles_type::dims, particles);
+    }
+
+    /*! \brief Rebuild the DCPSE Kernels in background, the current kernels are used until finalizeUpdateAsync
+     *
+     * The particles must not be mapped before the swap (see Dcpse::initializeGroupAsync)
+     *
+     * \param parts particle set
+     */
+    template<typename particles_type>
+    void updateAsync(particles_type &particles) {
+        Dcpse_type<particles_type::dims, particles_type> *dcpse_ptr = (Dcpse_type<particles_type::dims, particles_type> *) dcpse;
+        dcpse_construct_shared<Dcpse_type, particles_type>::updateAsync(dcpse_ptr, particles_type::dims, particles);
+    }
+
+    /*! \brief Swap in the kernels rebuilt by updateAsync
+     *
+     * \param parts particle set
+     * \param wait wait for the rebuild if it is still running
+     *
+     * \return true if the new kernels are in use
+     */
+    template<typename particles_type>
+    bool finalizeUpdateAsync(particles_type &particles, bool wait = false) {
+        Dcpse_type<particles_type::dims, particles_type> *dcpse_ptr = (Dcpse_type<particles_type::dims, particles_type> *) dcpse;
+        return dcpse_construct_shared<Dcpse_type, particles_type>::finalizeUpdateAsync(dcpse_ptr, particles_type::dims, wait);
+    }
+
+    /*! \brief Memory used by the operators of all the components in byte (see Dcpse::getMemoryUsage)
+     *
+     * \param parts particle set
+     */
+    template<typename particles_type>
+    size_t getMemoryUsage(particles_type &particles) {
+        Dcpse_type<particles_type::dims, particles_type> *dcpse_ptr = (Dcpse_type<particles_type::dims, particles_type> *) dcpse;
+
+        size_t mem = 0;
         for (int i = 0; i < particles_type::dims; i++) {
-            dcpse_ptr[i].initializeUpdate(particles);
+            mem += dcpse_ptr[i].getMemoryUsage();
         }
-
+        return mem;
     }
 
 
@@ -1081,16 +1482,42 @@ public:
         dcpse = new unsigned char[particles_type::dims * sizeof(DCPSE_type)];
 
         Dcpse_type<particles_type::dims, particles_type> *dcpse_ptr = (Dcpse_type<particles_type::dims, particles_type> *) dcpse;
-        Point<particles_type::dims, unsigned int> p;
+        Point<particles_type::dims, unsigned int> p[2];
 
-        p.zero();
-        p.get(1) = 1;
-        new(dcpse_ptr) Dcpse_type<particles_type::dims, particles_type>(parts, p, ord, rCut, oversampling_factor, opt);
+        p[0].zero();
+        p[0].get(1) = 1;
 
-        p.zero();
-        p.get(0) = 1;
-        new(dcpse_ptr+1) Dcpse_type<particles_type::dims, particles_type>(parts, dcpse_ptr[0], p, ord, rCut, oversampling_factor, opt);
+        p[1].zero();
+        p[1].get(0) = 1;
+
+        dcpse_construct_shared<Dcpse_type, particles_type>::construct(dcpse_ptr, p, 2, parts, ord, rCut, oversampling_factor, opt);
+
+    }
+
+    /*! \brief Register the operator on a DcpseContext, the kernels are computed by DcpseContext::build
+     *
+     * \param parts particle set
+     * \param ctx context with the support and the factorizations shared with the other operators
+     *
+     */
+    template<typename particles_type>
+    Curl2D_T(particles_type &parts, DcpseContext<particles_type> &ctx) {
+        DCPSE_CONTEXT_CHECK(particles_type);
+        typedef Dcpse_type<particles_type::dims, particles_type> DCPSE_type;
+
+        dcpse = new unsigned char[2 * sizeof(DCPSE_type)];
+
+        DCPSE_type *dcpse_ptr = (DCPSE_type *) dcpse;
+        Point<particles_type::dims, unsigned int> p[2];
+
+        p[0].zero();
+        p[0].get(1) = 1;
+
+        p[1].zero();
+        p[1].get(0) = 1;
 
+        for (int i = 0; i < 2; i++)
+            ctx.addOperator(p[i], &dcpse_ptr[i]);
     }
 
     template<typename operand_type>
@@ -1101,6 +1528,16 @@ public:
         return vector_dist_expression_op<operand_type, dcpse_type, VECT_DCPSE_V_CURL2D>(arg,
                                                                                         *(dcpse_type(*)[operand_type::vtype::dims]) dcpse);
     }
+    /*! \brief Memory used by the two operators in byte (see Dcpse::getMemoryUsage)
+     *
+     * \param parts particle set
+     */
+    template<typename particles_type>
+    size_t getMemoryUsage(particles_type &particles) {
+        Dcpse_type<particles_type::dims, particles_type> *dcpse_ptr = (Dcpse_type<particles_type::dims, particles_type> *) dcpse;
+
+        return dcpse_ptr[0].getMemoryUsage() + dcpse_ptr[1].getMemoryUsage();
+    }
 };
 /*! \brief Class for Creating the DCPSE Laplacian Operator
      *
@@ -1145,16 +1582,37 @@ public:
 
         Dcpse_type<particles_type::dims, particles_type> *dcpse_ptr = (Dcpse_type<particles_type::dims, particles_type> *) dcpse;
 
+        Point<particles_type::dims, unsigned int> p[particles_type::dims];
         for (int i = 0; i < particles_type::dims; i++) {
-            Point<particles_type::dims, unsigned int> p;
-            p.zero();
-            p.get(i) = 2;
+            p[i].zero();
+            p[i].get(i) = 2;
+        }
 
-            if (i)
-                new(&dcpse_ptr[i]) Dcpse_type<particles_type::dims, particles_type>(parts, dcpse_ptr[0], p, ord, rCut, oversampling_factor, opt);
-            else
-                new(&dcpse_ptr[i]) Dcpse_type<particles_type::dims, particles_type>(parts, p, ord, rCut, oversampling_factor, opt);
+        dcpse_construct_shared<Dcpse_type, particles_type>::construct(dcpse_ptr, p, particles_type::dims, parts, ord, rCut, oversampling_factor, opt);
+    }
+
+    /*! \brief Register the operator on a DcpseContext, the kernels are computed by DcpseContext::build
+     *
+     * \param parts particle set
+     * \param ctx context with the support and the factorizations shared with the other operators
+     *
+     */
+    template<typename particles_type>
+    Laplacian_T(particles_type &parts, DcpseContext<particles_type> &ctx) {
+        DCPSE_CONTEXT_CHECK(particles_type);
+        typedef Dcpse_type<particles_type::dims, particles_type> DCPSE_type;
+
+        dcpse = new unsigned char[particles_type::dims * sizeof(DCPSE_type)];
+
+        DCPSE_type *dcpse_ptr = (DCPSE_type *) dcpse;
+        Point<particles_type::dims, unsigned int> p[particles_type::dims];
+        for (int i = 0; i < particles_type::dims; i++) {
+            p[i].zero();
+            p[i].get(i) = 2;
         }
+
+        for (int i = 0; i < particles_type::dims; i++)
+            ctx.addOperator(p[i], &dcpse_ptr[i]);
     }
 
     template<typename operand_type>
@@ -1190,6 +1648,15 @@ public:
     void deallocate(particles_type &parts) {
         delete (Dcpse_type<particles_type::dims, particles_type> *) dcpse;
     }
+    /*! \brief DCPSE operators of the components, one for each dimension (see DcpseAdvectionDiffusion)
+     *
+     * \param particles particle set
+     */
+    template<typename particles_type>
+    Dcpse_type<particles_type::dims, particles_type> * getDcpse(particles_type &particles) {
+        return (Dcpse_type<particles_type::dims, particles_type> *) dcpse;
+    }
+
     /*! \brief Method for Updating the DCPSE Operator by recomputing DCPSE Kernels.
      *
      *
@@ -1198,10 +1665,88 @@ public:
     template<typename particles_type>
     void update(particles_type &particles) {
         Dcpse_type<particles_type::dims, particles_type> *dcpse_ptr = (Dcpse_type<particles_type::dims, particles_type> *) dcpse;
+        dcpse_construct_shared<Dcpse_type, particles_type>::update(dcpse_ptr, particles_type::dims, particles);
+    }
+
+    /*! \brief Rebuild the DCPSE Kernels in background, the current kernels are used until finalizeUpdateAsync
+     *
+     * The particles must not be mapped before the swap (see Dcpse::initializeGroupAsync)
+     *
+     * \param parts particle set
+     */
+    template<typename particles_type>
+    void updateAsync(particles_type &particles) {
+        Dcpse_type<particles_type::dims, particles_type> *dcpse_ptr = (Dcpse_type<particles_type::dims, particles_type> *) dcpse;
+        dcpse_construct_shared<Dcpse_type, particles_type>::updateAsync(dcpse_ptr, particles_type::dims, particles);
+    }
+
+    /*! \brief Swap in the kernels rebuilt by updateAsync
+     *
+     * \param parts particle set
+     * \param wait wait for the rebuild if it is still running
+     *
+     * \return true if the new kernels are in use
+     */
+    template<typename particles_type>
+    bool finalizeUpdateAsync(particles_type &particles, bool wait = false) {
+        Dcpse_type<particles_type::dims, particles_type> *dcpse_ptr = (Dcpse_type<particles_type::dims, particles_type> *) dcpse;
+        return dcpse_construct_shared<Dcpse_type, particles_type>::finalizeUpdateAsync(dcpse_ptr, particles_type::dims, wait);
+    }
+
+    /*! \brief Memory used by the operators of all the components in byte (see Dcpse::getMemoryUsage)
+     *
+     * \param parts particle set
+     */
+    template<typename particles_type>
+    size_t getMemoryUsage(particles_type &particles) {
+        Dcpse_type<particles_type::dims, particles_type> *dcpse_ptr = (Dcpse_type<particles_type::dims, particles_type> *) dcpse;
+
+        size_t mem = 0;
         for (int i = 0; i < particles_type::dims; i++) {
-            dcpse_ptr[i].initializeUpdate(particles);
+            mem += dcpse_ptr[i].getMemoryUsage();
         }
+        return mem;
+    }
+
+    /*! \brief Materialise the Laplacian as a sparse matrix, the entries of the dimensions are summed
+     *
+     * \param parts particle set
+     * \param M sparse matrix
+     */
+    template<typename particles_type, typename SparseMatrix_type>
+    void getSparseMatrix(particles_type &particles, SparseMatrix_type &M) {
+        typedef typename SparseMatrix_type::triplet_type triplet_type;
+        Dcpse_type<particles_type::dims, particles_type> *dcpse_ptr = (Dcpse_type<particles_type::dims, particles_type> *) dcpse;
+
+        openfpm::vector<size_t> colIds;
+        size_t rowStart, nRows, nCols;
+        dcpse_ptr[0].getGlobalIds(colIds, rowStart, nRows, nCols);
+
+        M.resize(nRows, nCols, particles.size_local(), particles.size_local());
 
+        auto &trpl = M.getMatrixTriplets();
+        trpl.clear();
+
+        openfpm::vector<triplet_type> rowTrpl;
+        for (size_t p = 0; p < particles.size_local(); p++) {
+            rowTrpl.clear();
+            for (int i = 0; i < particles_type::dims; i++) {
+                dcpse_ptr[i].addRowTriplets(rowTrpl, p, colIds, rowStart);
+            }
+
+            // merge the entries with the same column, PETSc does not sum them
+            size_t rowBegin = trpl.size();
+            for (size_t j = 0; j < rowTrpl.size(); j++) {
+                size_t k = rowBegin;
+                while (k < trpl.size() && trpl.get(k).col() != rowTrpl.get(j).col()) {k++;}
+
+                if (k < trpl.size()) {
+                    trpl.get(k).value() += rowTrpl.get(j).value();
+                } else {
+                    trpl.add(rowTrpl.get(j));
+                }
+            }
+        }
     }
 
 
@@ -1251,16 +1796,37 @@ public:
 
         Dcpse_type<particles_type::dims, particles_type> *dcpse_ptr = (Dcpse_type<particles_type::dims, particles_type> *) dcpse;
 
+        Point<particles_type::dims, unsigned int> p[particles_type::dims];
         for (int i = 0; i < particles_type::dims; i++) {
-            Point<particles_type::dims, unsigned int> p;
-            p.zero();
-            p.get(i) = 1;
+            p[i].zero();
+            p[i].get(i) = 1;
+        }
 
-            if (i)
-                new(&dcpse_ptr[i]) Dcpse_type<particles_type::dims, particles_type>(parts, dcpse_ptr[0], p, ord, rCut, oversampling_factor, opt);
-            else
-                new(&dcpse_ptr[i]) Dcpse_type<particles_type::dims, particles_type>(parts, p, ord, rCut, oversampling_factor, opt);
+        dcpse_construct_shared<Dcpse_type, particles_type>::construct(dcpse_ptr, p, particles_type::dims, parts, ord, rCut, oversampling_factor, opt);
+    }
+
+    /*! \brief Register the operator on a DcpseContext, the kernels are computed by DcpseContext::build
+     *
+     * \param parts particle set
+     * \param ctx context with the support and the factorizations shared with the other operators
+     *
+     */
+    template<typename particles_type>
+    Divergence_T(particles_type &parts, DcpseContext<particles_type> &ctx) {
+        DCPSE_CONTEXT_CHECK(particles_type);
+        typedef Dcpse_type<particles_type::dims, particles_type> DCPSE_type;
+
+        dcpse = new unsigned char[particles_type::dims * sizeof(DCPSE_type)];
+
+        DCPSE_type *dcpse_ptr = (DCPSE_type *) dcpse;
+        Point<particles_type::dims, unsigned int> p[particles_type::dims];
+        for (int i = 0; i < particles_type::dims; i++) {
+            p[i].zero();
+            p[i].get(i) = 1;
         }
+
+        for (int i = 0; i < particles_type::dims; i++)
+            ctx.addOperator(p[i], &dcpse_ptr[i]);
     }
 
     template<typename operand_type>
@@ -1280,10 +1846,47 @@ public:
     template<typename particles_type>
     void update(particles_type &particles) {
         Dcpse_type<particles_type::dims, particles_type> *dcpse_ptr = (Dcpse_type<particles_type::dims, particles_type> *) dcpse;
+        dcpse_construct_shared<Dcpse_type, particles_type>::update(dcpse_ptr, particles_type::dims, particles);
+    }
+
+    /*! \brief Rebuild the DCPSE Kernels in background, the current kernels are used until finalizeUpdateAsync
+     *
+     * The particles must not be mapped before the swap (see Dcpse::initializeGroupAsync)
+     *
+     * \param parts particle set
+     */
+    template<typename particles_type>
+    void updateAsync(particles_type &particles) {
+        Dcpse_type<particles_type::dims, particles_type> *dcpse_ptr = (Dcpse_type<particles_type::dims, particles_type> *) dcpse;
+        dcpse_construct_shared<Dcpse_type, particles_type>::updateAsync(dcpse_ptr, particles_type::dims, particles);
+    }
+
+    /*! \brief Swap in the kernels rebuilt by updateAsync
+     *
+     * \param parts particle set
+     * \param wait wait for the rebuild if it is still running
+     *
+     * \return true if the new kernels are in use
+     */
+    template<typename particles_type>
+    bool finalizeUpdateAsync(particles_type &particles, bool wait = false) {
+        Dcpse_type<particles_type::dims, particles_type> *dcpse_ptr = (Dcpse_type<particles_type::dims, particles_type> *) dcpse;
+        return dcpse_construct_shared<Dcpse_type, particles_type>::finalizeUpdateAsync(dcpse_ptr, particles_type::dims, wait);
+    }
+
+    /*! \brief Memory used by the operators of all the components in byte (see Dcpse::getMemoryUsage)
+     *
+     * \param parts particle set
+     */
+    template<typename particles_type>
+    size_t getMemoryUsage(particles_type &particles) {
+        Dcpse_type<particles_type::dims, particles_type> *dcpse_ptr = (Dcpse_type<particles_type::dims, particles_type> *) dcpse;
+
+        size_t mem = 0;
         for (int i = 0; i < particles_type::dims; i++) {
-            dcpse_ptr[i].initializeUpdate(particles);
+            mem += dcpse_ptr[i].getMemoryUsage();
         }
-
+        return mem;
     }
 
 };
@@ -1332,18 +1935,39 @@ public:
 
         Dcpse_type<particles_type::dims, particles_type> *dcpse_ptr = (Dcpse_type<particles_type::dims, particles_type> *) dcpse;
 
+        Point<particles_type::dims, unsigned int> p[particles_type::dims];
         for (int i = 0; i < particles_type::dims; i++) {
-            Point<particles_type::dims, unsigned int> p;
-            p.zero();
-            p.get(i) = 1;
-
-            if (i)
-                new(&dcpse_ptr[i]) Dcpse_type<particles_type::dims, particles_type>(parts, dcpse_ptr[0], p, ord, rCut, oversampling_factor, opt);
-            else
-                new(&dcpse_ptr[i]) Dcpse_type<particles_type::dims, particles_type>(parts, p, ord, rCut, oversampling_factor, opt);
+            p[i].zero();
+            p[i].get(i) = 1;
         }
 
+        dcpse_construct_shared<Dcpse_type, particles_type>::construct(dcpse_ptr, p, particles_type::dims, parts, ord, rCut, oversampling_factor, opt);
+
+
+    }
+
+    /*! \brief Register the operator on a DcpseContext, the kernels are computed by DcpseContext::build
+     *
+     * \param parts particle set
+     * \param ctx context with the support and the factorizations shared with the other operators
+     *
+     */
+    template<typename particles_type>
+    Advection_T(particles_type &parts, DcpseContext<particles_type> &ctx) {
+        DCPSE_CONTEXT_CHECK(particles_type);
+        typedef Dcpse_type<particles_type::dims, particles_type> DCPSE_type;
+
+        dcpse = new unsigned char[particles_type::dims * sizeof(DCPSE_type)];
+
+        DCPSE_type *dcpse_ptr = (DCPSE_type *) dcpse;
+        Point<particles_type::dims, unsigned int> p[particles_type::dims];
+        for (int i = 0; i < particles_type::dims; i++) {
+            p[i].zero();
+            p[i].get(i) = 1;
+        }
 
+        for (int i = 0; i < particles_type::dims; i++)
+            ctx.addOperator(p[i], &dcpse_ptr[i]);
     }
 
     template<typename operand_type1, typename operand_type2>
@@ -1376,6 +2000,15 @@ public:
 
     }
 
+    /*! \brief DCPSE operators of the components, one for each dimension (see DcpseAdvectionDiffusion)
+     *
+     * \param particles particle set
+     */
+    template<typename particles_type>
+    Dcpse_type<particles_type::dims, particles_type> * getDcpse(particles_type &particles) {
+        return (Dcpse_type<particles_type::dims, particles_type> *) dcpse;
+    }
+
     /*! \brief Method for Updating the DCPSE Operator by recomputing DCPSE Kernels.
      *
      *
@@ -1384,10 +2017,47 @@ public:
     template<typename particles_type>
     void update(particles_type &particles) {
         Dcpse_type<particles_type::dims, particles_type> *dcpse_ptr = (Dcpse_type<particles_type::dims, particles_type> *) dcpse;
+        dcpse_construct_shared<Dcpse_type, particles_type>::update(dcpse_ptr, particles_type::dims, particles);
+    }
+
+    /*! \brief Rebuild the DCPSE Kernels in background, the current kernels are used until finalizeUpdateAsync
+     *
+     * The particles must not be mapped before the swap (see Dcpse::initializeGroupAsync)
+     *
+     * \param parts particle set
+     */
+    template<typename particles_type>
+    void updateAsync(particles_type &particles) {
+        Dcpse_type<particles_type::dims, particles_type> *dcpse_ptr = (Dcpse_type<particles_type::dims, particles_type> *) dcpse;
+        dcpse_construct_shared<Dcpse_type, particles_type>::updateAsync(dcpse_ptr, particles_type::dims, particles);
+    }
+
+    /*! \brief Swap in the kernels rebuilt by updateAsync
+     *
+     * \param parts particle set
+     * \param wait wait for the rebuild if it is still running
+     *
+     * \return true if the new kernels are in use
+     */
+    template<typename particles_type>
+    bool finalizeUpdateAsync(particles_type &particles, bool wait = false) {
+        Dcpse_type<particles_type::dims, particles_type> *dcpse_ptr = (Dcpse_type<particles_type::dims, particles_type> *) dcpse;
+        return dcpse_construct_shared<Dcpse_type, particles_type>::finalizeUpdateAsync(dcpse_ptr, particles_type::dims, wait);
+    }
+
+    /*! \brief Memory used by the operators of all the components in byte (see Dcpse::getMemoryUsage)
+     *
+     * \param parts particle set
+     */
+    template<typename particles_type>
+    size_t getMemoryUsage(particles_type &particles) {
+        Dcpse_type<particles_type::dims, particles_type> *dcpse_ptr = (Dcpse_type<particles_type::dims, particles_type> *) dcpse;
+
+        size_t mem = 0;
         for (int i = 0; i < particles_type::dims; i++) {
-            dcpse_ptr[i].initializeUpdate(particles);
+            mem += dcpse_ptr[i].getMemoryUsage();
         }
-
+        return mem;
     }
 
 
@@ -1435,6 +2105,24 @@ public:
         dcpse = new Dcpse_type<particles_type::dims, particles_type>(parts, p, ord, rCut, oversampling_factor, opt);
     }
 
+    /*! \brief Register the operator on a DcpseContext, the kernels are computed by DcpseContext::build
+     *
+     * \param parts particle set
+     * \param ctx context with the support and the factorizations shared with the other operators
+     *
+     */
+    template<typename particles_type>
+    Derivative_xy_T(particles_type &parts, DcpseContext<particles_type> &ctx) {
+        DCPSE_CONTEXT_CHECK(particles_type);
+
+        Point<particles_type::dims, unsigned int> p;
+        p.zero();
+        p.get(0) = 1;
+        p.get(1) = 1;
+
+        dcpse = ctx.addOperator(p);
+    }
+
     template<typename particles_type>
     void deallocate(particles_type &parts) {
         delete (Dcpse_type<particles_type::dims, particles_type> *) dcpse;
@@ -1494,6 +2182,76 @@ public:
         dcpse_temp->initializeUpdate(particles);
 
     }
+
+    /*! \brief Rebuild the DCPSE Kernels in background, the current kernels are used until finalizeUpdateAsync
+     *
+     * The particles must not be mapped before the swap (see Dcpse::initializeGroupAsync)
+     *
+     * \param parts particle set
+     */
+    template<typename particles_type>
+    void updateAsync(particles_type &particles) {
+        auto dcpse_temp = (Dcpse_type<particles_type::dims, particles_type> *) dcpse;
+        dcpse_construct_shared<Dcpse_type, particles_type>::updateAsync(dcpse_temp, 1, particles);
+    }
+
+    /*! \brief Swap in the kernels rebuilt by updateAsync
+     *
+     * \param parts particle set
+     * \param wait wait for the rebuild if it is still running
+     *
+     * \return true if the new kernels are in use
+     */
+    template<typename particles_type>
+    bool finalizeUpdateAsync(particles_type &particles, bool wait = false) {
+        auto dcpse_temp = (Dcpse_type<particles_type::dims, particles_type> *) dcpse;
+        return dcpse_construct_shared<Dcpse_type, particles_type>::finalizeUpdateAsync(dcpse_temp, 1, wait);
+    }
+
+    /*! \brief Memory used by the operator in byte (see Dcpse::getMemoryUsage)
+     *
+     * \param parts particle set
+     */
+    template<typename particles_type>
+    size_t getMemoryUsage(particles_type &particles) {
+        auto dcpse_temp = (Dcpse_type<particles_type::dims, particles_type> *) dcpse;
+        return dcpse_temp->getMemoryUsage();
+    }
+
+    /*! \brief Remove the neighbours with a negligible weight and recompute the kernels (see Dcpse::pruneKernels)
+     *
+     * \param parts particle set
+     * \param threshold relative weight under which a neighbour is removed
+     *
+     * \return the number of weights removed on all the processors
+     */
+    template<typename particles_type>
+    size_t pruneKernels(particles_type &particles, typename particles_type::stype threshold) {
+        auto dcpse_temp = (Dcpse_type<particles_type::dims, particles_type> *) dcpse;
+        return dcpse_temp->pruneKernels(particles, threshold);
+    }
+
+    /*! \brief Materialise the operator as a sparse matrix (see Dcpse::getSparseMatrix)
+     *
+     * \param parts particle set
+     * \param M sparse matrix
+     */
+    template<typename particles_type, typename SparseMatrix_type>
+    void getSparseMatrix(particles_type &particles, SparseMatrix_type &M) {
+        auto dcpse_temp = (Dcpse_type<particles_type::dims, particles_type> *) dcpse;
+        dcpse_temp->getSparseMatrix(M);
+    }
+
+    /*! \brief Apply the operator to prp1 and store the result in prp2, the ghost of prp1 is exchanged while
+     *         the interior particles are evaluated (see Dcpse::computeDifferentialOperatorOverlap)
+     *
+     * \param parts particle set
+     */
+    template<unsigned int prp1, unsigned int prp2, typename particles_type>
+    void computeOverlap(particles_type &particles) {
+        auto dcpse_temp = (Dcpse_type<particles_type::dims, particles_type> *) dcpse;
+        dcpse_temp->template computeDifferentialOperatorOverlap<prp1, prp2>(particles);
+    }
 };
 /*! \brief Class for Creating the DCPSE Operator Dyz and objects and computes DCPSE Kernels.
      *
@@ -1537,6 +2295,24 @@ public:
         dcpse = new Dcpse_type<particles_type::dims, particles_type>(parts, p, ord, rCut, oversampling_factor, opt);
     }
 
+    /*! \brief Register the operator on a DcpseContext, the kernels are computed by DcpseContext::build
+     *
+     * \param parts particle set
+     * \param ctx context with the support and the factorizations shared with the other operators
+     *
+     */
+    template<typename particles_type>
+    Derivative_yz_T(particles_type &parts, DcpseContext<particles_type> &ctx) {
+        DCPSE_CONTEXT_CHECK(particles_type);
+
+        Point<particles_type::dims, unsigned int> p;
+        p.zero();
+        p.get(1) = 1;
+        p.get(2) = 1;
+
+        dcpse = ctx.addOperator(p);
+    }
+
     template<typename particles_type>
     void deallocate(particles_type &parts) {
         delete (Dcpse_type<particles_type::dims, particles_type> *) dcpse;
@@ -1596,40 +2372,110 @@ public:
         dcpse_temp->initializeUpdate(particles);
 
     }
-};
-/*! \brief Class for Creating the DCPSE Operator Dxz and objects and computes DCPSE Kernels.
+
+    /*! \brief Rebuild the DCPSE Kernels in background, the current kernels are used until finalizeUpdateAsync
      *
+     * The particles must not be mapped before the swap (see Dcpse::initializeGroupAsync)
      *
      * \param parts particle set
-     * \param ord order of convergence of the operator
-     * \param rCut Argument for cell list construction
-     * \param oversampling_factor multiplier to the minimum no. of particles required by the operator in support
-     * \param support_options default:N_particles, Radius can be used to select all particles inside rCut. Overrides oversampling.
-     *
-     * \return Operator Dxz which is a function on Vector_dist_Expressions
-     *
      */
-template<template<unsigned int, typename, typename...> class Dcpse_type = Dcpse>
-class Derivative_xz_T {
-
-    void *dcpse;
+    template<typename particles_type>
+    void updateAsync(particles_type &particles) {
+        auto dcpse_temp = (Dcpse_type<particles_type::dims, particles_type> *) dcpse;
+        dcpse_construct_shared<Dcpse_type, particles_type>::updateAsync(dcpse_temp, 1, particles);
+    }
 
-public:
-    /*! \brief Constructor for Creating the DCPSE Operator Dxz and objects and computes DCPSE Kernels.
-     *
+    /*! \brief Swap in the kernels rebuilt by updateAsync
      *
      * \param parts particle set
-     * \param ord order of convergence of the operator
-     * \param rCut Argument for cell list construction
-     * \param oversampling_factor multiplier to the minimum no. of particles required by the operator in support
-     * \param support_options default:N_particles, Radius can be used to select all particles inside rCut. Overrides oversampling.
+     * \param wait wait for the rebuild if it is still running
      *
-     * \return Operator Dxz which is a function on Vector_dist_Expressions
+     * \return true if the new kernels are in use
+     */
+    template<typename particles_type>
+    bool finalizeUpdateAsync(particles_type &particles, bool wait = false) {
+        auto dcpse_temp = (Dcpse_type<particles_type::dims, particles_type> *) dcpse;
+        return dcpse_construct_shared<Dcpse_type, particles_type>::finalizeUpdateAsync(dcpse_temp, 1, wait);
+    }
+
+    /*! \brief Memory used by the operator in byte (see Dcpse::getMemoryUsage)
      *
+     * \param parts particle set
      */
     template<typename particles_type>
-    Derivative_xz_T(particles_type &parts, unsigned int ord, typename particles_type::stype rCut,
-                  double oversampling_factor = dcpse_oversampling_factor,
+    size_t getMemoryUsage(particles_type &particles) {
+        auto dcpse_temp = (Dcpse_type<particles_type::dims, particles_type> *) dcpse;
+        return dcpse_temp->getMemoryUsage();
+    }
+
+    /*! \brief Remove the neighbours with a negligible weight and recompute the kernels (see Dcpse::pruneKernels)
+     *
+     * \param parts particle set
+     * \param threshold relative weight under which a neighbour is removed
+     *
+     * \return the number of weights removed on all the processors
+     */
+    template<typename particles_type>
+    size_t pruneKernels(particles_type &particles, typename particles_type::stype threshold) {
+        auto dcpse_temp = (Dcpse_type<particles_type::dims, particles_type> *) dcpse;
+        return dcpse_temp->pruneKernels(particles, threshold);
+    }
+
+    /*! \brief Materialise the operator as a sparse matrix (see Dcpse::getSparseMatrix)
+     *
+     * \param parts particle set
+     * \param M sparse matrix
+     */
+    template<typename particles_type, typename SparseMatrix_type>
+    void getSparseMatrix(particles_type &particles, SparseMatrix_type &M) {
+        auto dcpse_temp = (Dcpse_type<particles_type::dims, particles_type> *) dcpse;
+        dcpse_temp->getSparseMatrix(M);
+    }
+
+    /*! \brief Apply the operator to prp1 and store the result in prp2, the ghost of prp1 is exchanged while
+     *         the interior particles are evaluated (see Dcpse::computeDifferentialOperatorOverlap)
+     *
+     * \param parts particle set
+     */
+    template<unsigned int prp1, unsigned int prp2, typename particles_type>
+    void computeOverlap(particles_type &particles) {
+        auto dcpse_temp = (Dcpse_type<particles_type::dims, particles_type> *) dcpse;
+        dcpse_temp->template computeDifferentialOperatorOverlap<prp1, prp2>(particles);
+    }
+};
+/*! \brief Class for Creating the DCPSE Operator Dxz and objects and computes DCPSE Kernels.
+     *
+     *
+     * \param parts particle set
+     * \param ord order of convergence of the operator
+     * \param rCut Argument for cell list construction
+     * \param oversampling_factor multiplier to the minimum no. of particles required by the operator in support
+     * \param support_options default:N_particles, Radius can be used to select all particles inside rCut. Overrides oversampling.
+     *
+     * \return Operator Dxz which is a function on Vector_dist_Expressions
+     *
+     */
+template<template<unsigned int, typename, typename...> class Dcpse_type = Dcpse>
+class Derivative_xz_T {
+
+    void *dcpse;
+
+public:
+    /*! \brief Constructor for Creating the DCPSE Operator Dxz and objects and computes DCPSE Kernels.
+     *
+     *
+     * \param parts particle set
+     * \param ord order of convergence of the operator
+     * \param rCut Argument for cell list construction
+     * \param oversampling_factor multiplier to the minimum no. of particles required by the operator in support
+     * \param support_options default:N_particles, Radius can be used to select all particles inside rCut. Overrides oversampling.
+     *
+     * \return Operator Dxz which is a function on Vector_dist_Expressions
+     *
+     */
+    template<typename particles_type>
+    Derivative_xz_T(particles_type &parts, unsigned int ord, typename particles_type::stype rCut,
+                  double oversampling_factor = dcpse_oversampling_factor,
                   support_options opt = support_options::RADIUS) {
         Point<particles_type::dims, unsigned int> p;
         p.zero();
@@ -1639,6 +2485,24 @@ public:
         dcpse = new Dcpse_type<particles_type::dims, particles_type>(parts, p, ord, rCut, oversampling_factor, opt);
     }
 
+    /*! \brief Register the operator on a DcpseContext, the kernels are computed by DcpseContext::build
+     *
+     * \param parts particle set
+     * \param ctx context with the support and the factorizations shared with the other operators
+     *
+     */
+    template<typename particles_type>
+    Derivative_xz_T(particles_type &parts, DcpseContext<particles_type> &ctx) {
+        DCPSE_CONTEXT_CHECK(particles_type);
+
+        Point<particles_type::dims, unsigned int> p;
+        p.zero();
+        p.get(0) = 1;
+        p.get(2) = 1;
+
+        dcpse = ctx.addOperator(p);
+    }
+
     template<typename particles_type>
     void deallocate(particles_type &parts) {
         delete (Dcpse_type<particles_type::dims, particles_type> *) dcpse;
@@ -1698,6 +2562,76 @@ public:
         dcpse_temp->initializeUpdate(particles);
 
     }
+
+    /*! \brief Rebuild the DCPSE Kernels in background, the current kernels are used until finalizeUpdateAsync
+     *
+     * The particles must not be mapped before the swap (see Dcpse::initializeGroupAsync)
+     *
+     * \param parts particle set
+     */
+    template<typename particles_type>
+    void updateAsync(particles_type &particles) {
+        auto dcpse_temp = (Dcpse_type<particles_type::dims, particles_type> *) dcpse;
+        dcpse_construct_shared<Dcpse_type, particles_type>::updateAsync(dcpse_temp, 1, particles);
+    }
+
+    /*! \brief Swap in the kernels rebuilt by updateAsync
+     *
+     * \param parts particle set
+     * \param wait wait for the rebuild if it is still running
+     *
+     * \return true if the new kernels are in use
+     */
+    template<typename particles_type>
+    bool finalizeUpdateAsync(particles_type &particles, bool wait = false) {
+        auto dcpse_temp = (Dcpse_type<particles_type::dims, particles_type> *) dcpse;
+        return dcpse_construct_shared<Dcpse_type, particles_type>::finalizeUpdateAsync(dcpse_temp, 1, wait);
+    }
+
+    /*! \brief Memory used by the operator in byte (see Dcpse::getMemoryUsage)
+     *
+     * \param parts particle set
+     */
+    template<typename particles_type>
+    size_t getMemoryUsage(particles_type &particles) {
+        auto dcpse_temp = (Dcpse_type<particles_type::dims, particles_type> *) dcpse;
+        return dcpse_temp->getMemoryUsage();
+    }
+
+    /*! \brief Remove the neighbours with a negligible weight and recompute the kernels (see Dcpse::pruneKernels)
+     *
+     * \param parts particle set
+     * \param threshold relative weight under which a neighbour is removed
+     *
+     * \return the number of weights removed on all the processors
+     */
+    template<typename particles_type>
+    size_t pruneKernels(particles_type &particles, typename particles_type::stype threshold) {
+        auto dcpse_temp = (Dcpse_type<particles_type::dims, particles_type> *) dcpse;
+        return dcpse_temp->pruneKernels(particles, threshold);
+    }
+
+    /*! \brief Materialise the operator as a sparse matrix (see Dcpse::getSparseMatrix)
+     *
+     * \param parts particle set
+     * \param M sparse matrix
+     */
+    template<typename particles_type, typename SparseMatrix_type>
+    void getSparseMatrix(particles_type &particles, SparseMatrix_type &M) {
+        auto dcpse_temp = (Dcpse_type<particles_type::dims, particles_type> *) dcpse;
+        dcpse_temp->getSparseMatrix(M);
+    }
+
+    /*! \brief Apply the operator to prp1 and store the result in prp2, the ghost of prp1 is exchanged while
+     *         the interior particles are evaluated (see Dcpse::computeDifferentialOperatorOverlap)
+     *
+     * \param parts particle set
+     */
+    template<unsigned int prp1, unsigned int prp2, typename particles_type>
+    void computeOverlap(particles_type &particles) {
+        auto dcpse_temp = (Dcpse_type<particles_type::dims, particles_type> *) dcpse;
+        dcpse_temp->template computeDifferentialOperatorOverlap<prp1, prp2>(particles);
+    }
 };
 
 /*! \brief Constructor for Creating the DCPSE Operator Dxx and objects and computes DCPSE Kernels.
@@ -1742,6 +2676,24 @@ public:
         dcpse = new Dcpse_type<particles_type::dims, particles_type>(parts, p, ord, rCut, oversampling_factor, opt);
     }
 
+    /*! \brief Register the operator on a DcpseContext, the kernels are computed by DcpseContext::build
+     *
+     * \param parts particle set
+     * \param ctx context with the support and the factorizations shared with the other operators
+     *
+     */
+    template<typename particles_type>
+    Derivative_xx_T(particles_type &parts, DcpseContext<particles_type> &ctx) {
+        DCPSE_CONTEXT_CHECK(particles_type);
+
+        Point<particles_type::dims, unsigned int> p;
+        p.zero();
+        p.get(0) = 2;
+        p.get(1) = 0;
+
+        dcpse = ctx.addOperator(p);
+    }
+
     template<typename particles_type>
     void deallocate(particles_type &parts) {
         delete (Dcpse_type<particles_type::dims, particles_type> *) dcpse;
@@ -1800,6 +2752,76 @@ public:
         dcpse_temp->initializeUpdate(particles);
 
     }
+
+    /*! \brief Rebuild the DCPSE Kernels in background, the current kernels are used until finalizeUpdateAsync
+     *
+     * The particles must not be mapped before the swap (see Dcpse::initializeGroupAsync)
+     *
+     * \param parts particle set
+     */
+    template<typename particles_type>
+    void updateAsync(particles_type &particles) {
+        auto dcpse_temp = (Dcpse_type<particles_type::dims, particles_type> *) dcpse;
+        dcpse_construct_shared<Dcpse_type, particles_type>::updateAsync(dcpse_temp, 1, particles);
+    }
+
+    /*! \brief Swap in the kernels rebuilt by updateAsync
+     *
+     * \param parts particle set
+     * \param wait wait for the rebuild if it is still running
+     *
+     * \return true if the new kernels are in use
+     */
+    template<typename particles_type>
+    bool finalizeUpdateAsync(particles_type &particles, bool wait = false) {
+        auto dcpse_temp = (Dcpse_type<particles_type::dims, particles_type> *) dcpse;
+        return dcpse_construct_shared<Dcpse_type, particles_type>::finalizeUpdateAsync(dcpse_temp, 1, wait);
+    }
+
+    /*! \brief Memory used by the operator in byte (see Dcpse::getMemoryUsage)
+     *
+     * \param parts particle set
+     */
+    template<typename particles_type>
+    size_t getMemoryUsage(particles_type &particles) {
+        auto dcpse_temp = (Dcpse_type<particles_type::dims, particles_type> *) dcpse;
+        return dcpse_temp->getMemoryUsage();
+    }
+
+    /*! \brief Remove the neighbours with a negligible weight and recompute the kernels (see Dcpse::pruneKernels)
+     *
+     * \param parts particle set
+     * \param threshold relative weight under which a neighbour is removed
+     *
+     * \return the number of weights removed on all the processors
+     */
+    template<typename particles_type>
+    size_t pruneKernels(particles_type &particles, typename particles_type::stype threshold) {
+        auto dcpse_temp = (Dcpse_type<particles_type::dims, particles_type> *) dcpse;
+        return dcpse_temp->pruneKernels(particles, threshold);
+    }
+
+    /*! \brief Materialise the operator as a sparse matrix (see Dcpse::getSparseMatrix)
+     *
+     * \param parts particle set
+     * \param M sparse matrix
+     */
+    template<typename particles_type, typename SparseMatrix_type>
+    void getSparseMatrix(particles_type &particles, SparseMatrix_type &M) {
+        auto dcpse_temp = (Dcpse_type<particles_type::dims, particles_type> *) dcpse;
+        dcpse_temp->getSparseMatrix(M);
+    }
+
+    /*! \brief Apply the operator to prp1 and store the result in prp2, the ghost of prp1 is exchanged while
+     *         the interior particles are evaluated (see Dcpse::computeDifferentialOperatorOverlap)
+     *
+     * \param parts particle set
+     */
+    template<unsigned int prp1, unsigned int prp2, typename particles_type>
+    void computeOverlap(particles_type &particles) {
+        auto dcpse_temp = (Dcpse_type<particles_type::dims, particles_type> *) dcpse;
+        dcpse_temp->template computeDifferentialOperatorOverlap<prp1, prp2>(particles);
+    }
 };
 
 /*! \brief Class for Creating the DCPSE Operator Dyy and objects and computes DCPSE Kernels.
@@ -1844,6 +2866,24 @@ public:
         dcpse = new Dcpse_type<particles_type::dims, particles_type>(parts, p, ord, rCut, oversampling_factor, opt);
     }
 
+    /*! \brief Register the operator on a DcpseContext, the kernels are computed by DcpseContext::build
+     *
+     * \param parts particle set
+     * \param ctx context with the support and the factorizations shared with the other operators
+     *
+     */
+    template<typename particles_type>
+    Derivative_yy_T(particles_type &parts, DcpseContext<particles_type> &ctx) {
+        DCPSE_CONTEXT_CHECK(particles_type);
+
+        Point<particles_type::dims, unsigned int> p;
+        p.zero();
+        p.get(0) = 0;
+        p.get(1) = 2;
+
+        dcpse = ctx.addOperator(p);
+    }
+
     template<typename particles_type>
     void deallocate(particles_type &parts) {
         delete (Dcpse_type<particles_type::dims, particles_type> *) dcpse;
@@ -1902,6 +2942,76 @@ public:
         dcpse_temp->initializeUpdate(particles);
 
     }
+
+    /*! \brief Rebuild the DCPSE Kernels in background, the current kernels are used until finalizeUpdateAsync
+     *
+     * The particles must not be mapped before the swap (see Dcpse::initializeGroupAsync)
+     *
+     * \param parts particle set
+     */
+    template<typename particles_type>
+    void updateAsync(particles_type &particles) {
+        auto dcpse_temp = (Dcpse_type<particles_type::dims, particles_type> *) dcpse;
+        dcpse_construct_shared<Dcpse_type, particles_type>::updateAsync(dcpse_temp, 1, particles);
+    }
+
+    /*! \brief Swap in the kernels rebuilt by updateAsync
+     *
+     * \param parts particle set
+     * \param wait wait for the rebuild if it is still running
+     *
+     * \return true if the new kernels are in use
+     */
+    template<typename particles_type>
+    bool finalizeUpdateAsync(particles_type &particles, bool wait = false) {
+        auto dcpse_temp = (Dcpse_type<particles_type::dims, particles_type> *) dcpse;
+        return dcpse_construct_shared<Dcpse_type, particles_type>::finalizeUpdateAsync(dcpse_temp, 1, wait);
+    }
+
+    /*! \brief Memory used by the operator in byte (see Dcpse::getMemoryUsage)
+     *
+     * \param parts particle set
+     */
+    template<typename particles_type>
+    size_t getMemoryUsage(particles_type &particles) {
+        auto dcpse_temp = (Dcpse_type<particles_type::dims, particles_type> *) dcpse;
+        return dcpse_temp->getMemoryUsage();
+    }
+
+    /*! \brief Remove the neighbours with a negligible weight and recompute the kernels (see Dcpse::pruneKernels)
+     *
+     * \param parts particle set
+     * \param threshold relative weight under which a neighbour is removed
+     *
+     * \return the number of weights removed on all the processors
+     */
+    template<typename particles_type>
+    size_t pruneKernels(particles_type &particles, typename particles_type::stype threshold) {
+        auto dcpse_temp = (Dcpse_type<particles_type::dims, particles_type> *) dcpse;
+        return dcpse_temp->pruneKernels(particles, threshold);
+    }
+
+    /*! \brief Materialise the operator as a sparse matrix (see Dcpse::getSparseMatrix)
+     *
+     * \param parts particle set
+     * \param M sparse matrix
+     */
+    template<typename particles_type, typename SparseMatrix_type>
+    void getSparseMatrix(particles_type &particles, SparseMatrix_type &M) {
+        auto dcpse_temp = (Dcpse_type<particles_type::dims, particles_type> *) dcpse;
+        dcpse_temp->getSparseMatrix(M);
+    }
+
+    /*! \brief Apply the operator to prp1 and store the result in prp2, the ghost of prp1 is exchanged while
+     *         the interior particles are evaluated (see Dcpse::computeDifferentialOperatorOverlap)
+     *
+     * \param parts particle set
+     */
+    template<unsigned int prp1, unsigned int prp2, typename particles_type>
+    void computeOverlap(particles_type &particles) {
+        auto dcpse_temp = (Dcpse_type<particles_type::dims, particles_type> *) dcpse;
+        dcpse_temp->template computeDifferentialOperatorOverlap<prp1, prp2>(particles);
+    }
 };
 /*! \brief Class for Creating the DCPSE Operator Dzz and objects and computes DCPSE Kernels.
      *
@@ -1944,6 +3054,23 @@ public:
         dcpse = new Dcpse_type<particles_type::dims, particles_type>(parts, p, ord, rCut, oversampling_factor, opt);
     }
 
+    /*! \brief Register the operator on a DcpseContext, the kernels are computed by DcpseContext::build
+     *
+     * \param parts particle set
+     * \param ctx context with the support and the factorizations shared with the other operators
+     *
+     */
+    template<typename particles_type>
+    Derivative_zz_T(particles_type &parts, DcpseContext<particles_type> &ctx) {
+        DCPSE_CONTEXT_CHECK(particles_type);
+
+        Point<particles_type::dims, unsigned int> p;
+        p.zero();
+        p.get(2) = 2;
+
+        dcpse = ctx.addOperator(p);
+    }
+
     template<typename particles_type>
     void deallocate(particles_type &parts) {
         delete (Dcpse_type<particles_type::dims, particles_type> *) dcpse;
@@ -2002,6 +3129,76 @@ public:
         dcpse_temp->initializeUpdate(particles);
 
     }
+
+    /*! \brief Rebuild the DCPSE Kernels in background, the current kernels are used until finalizeUpdateAsync
+     *
+     * The particles must not be mapped before the swap (see Dcpse::initializeGroupAsync)
+     *
+     * \param parts particle set
+     */
+    template<typename particles_type>
+    void updateAsync(particles_type &particles) {
+        auto dcpse_temp = (Dcpse_type<particles_type::dims, particles_type> *) dcpse;
+        dcpse_construct_shared<Dcpse_type, particles_type>::updateAsync(dcpse_temp, 1, particles);
+    }
+
+    /*! \brief Swap in the kernels rebuilt by updateAsync
+     *
+     * \param parts particle set
+     * \param wait wait for the rebuild if it is still running
+     *
+     * \return true if the new kernels are in use
+     */
+    template<typename particles_type>
+    bool finalizeUpdateAsync(particles_type &particles, bool wait = false) {
+        auto dcpse_temp = (Dcpse_type<particles_type::dims, particles_type> *) dcpse;
+        return dcpse_construct_shared<Dcpse_type, particles_type>::finalizeUpdateAsync(dcpse_temp, 1, wait);
+    }
+
+    /*! \brief Memory used by the operator in byte (see Dcpse::getMemoryUsage)
+     *
+     * \param parts particle set
+     */
+    template<typename particles_type>
+    size_t getMemoryUsage(particles_type &particles) {
+        auto dcpse_temp = (Dcpse_type<particles_type::dims, particles_type> *) dcpse;
+        return dcpse_temp->getMemoryUsage();
+    }
+
+    /*! \brief Remove the neighbours with a negligible weight and recompute the kernels (see Dcpse::pruneKernels)
+     *
+     * \param parts particle set
+     * \param threshold relative weight under which a neighbour is removed
+     *
+     * \return the number of weights removed on all the processors
+     */
+    template<typename particles_type>
+    size_t pruneKernels(particles_type &particles, typename particles_type::stype threshold) {
+        auto dcpse_temp = (Dcpse_type<particles_type::dims, particles_type> *) dcpse;
+        return dcpse_temp->pruneKernels(particles, threshold);
+    }
+
+    /*! \brief Materialise the operator as a sparse matrix (see Dcpse::getSparseMatrix)
+     *
+     * \param parts particle set
+     * \param M sparse matrix
+     */
+    template<typename particles_type, typename SparseMatrix_type>
+    void getSparseMatrix(particles_type &particles, SparseMatrix_type &M) {
+        auto dcpse_temp = (Dcpse_type<particles_type::dims, particles_type> *) dcpse;
+        dcpse_temp->getSparseMatrix(M);
+    }
+
+    /*! \brief Apply the operator to prp1 and store the result in prp2, the ghost of prp1 is exchanged while
+     *         the interior particles are evaluated (see Dcpse::computeDifferentialOperatorOverlap)
+     *
+     * \param parts particle set
+     */
+    template<unsigned int prp1, unsigned int prp2, typename particles_type>
+    void computeOverlap(particles_type &particles) {
+        auto dcpse_temp = (Dcpse_type<particles_type::dims, particles_type> *) dcpse;
+        dcpse_temp->template computeDifferentialOperatorOverlap<prp1, prp2>(particles);
+    }
 };
 
 template<template<unsigned int, typename, typename...> class Dcpse_type = Dcpse>
@@ -2077,6 +3274,76 @@ public:
         dcpse_temp->initializeUpdate(particles);
 
     }
+
+    /*! \brief Rebuild the DCPSE Kernels in background, the current kernels are used until finalizeUpdateAsync
+     *
+     * The particles must not be mapped before the swap (see Dcpse::initializeGroupAsync)
+     *
+     * \param parts particle set
+     */
+    template<typename particles_type>
+    void updateAsync(particles_type &particles) {
+        auto dcpse_temp = (Dcpse_type<particles_type::dims, particles_type> *) dcpse;
+        dcpse_construct_shared<Dcpse_type, particles_type>::updateAsync(dcpse_temp, 1, particles);
+    }
+
+    /*! \brief Swap in the kernels rebuilt by updateAsync
+     *
+     * \param parts particle set
+     * \param wait wait for the rebuild if it is still running
+     *
+     * \return true if the new kernels are in use
+     */
+    template<typename particles_type>
+    bool finalizeUpdateAsync(particles_type &particles, bool wait = false) {
+        auto dcpse_temp = (Dcpse_type<particles_type::dims, particles_type> *) dcpse;
+        return dcpse_construct_shared<Dcpse_type, particles_type>::finalizeUpdateAsync(dcpse_temp, 1, wait);
+    }
+
+    /*! \brief Memory used by the operator in byte (see Dcpse::getMemoryUsage)
+     *
+     * \param parts particle set
+     */
+    template<typename particles_type>
+    size_t getMemoryUsage(particles_type &particles) {
+        auto dcpse_temp = (Dcpse_type<particles_type::dims, particles_type> *) dcpse;
+        return dcpse_temp->getMemoryUsage();
+    }
+
+    /*! \brief Remove the neighbours with a negligible weight and recompute the kernels (see Dcpse::pruneKernels)
+     *
+     * \param parts particle set
+     * \param threshold relative weight under which a neighbour is removed
+     *
+     * \return the number of weights removed on all the processors
+     */
+    template<typename particles_type>
+    size_t pruneKernels(particles_type &particles, typename particles_type::stype threshold) {
+        auto dcpse_temp = (Dcpse_type<particles_type::dims, particles_type> *) dcpse;
+        return dcpse_temp->pruneKernels(particles, threshold);
+    }
+
+    /*! \brief Materialise the operator as a sparse matrix (see Dcpse::getSparseMatrix)
+     *
+     * \param parts particle set
+     * \param M sparse matrix
+     */
+    template<typename particles_type, typename SparseMatrix_type>
+    void getSparseMatrix(particles_type &particles, SparseMatrix_type &M) {
+        auto dcpse_temp = (Dcpse_type<particles_type::dims, particles_type> *) dcpse;
+        dcpse_temp->getSparseMatrix(M);
+    }
+
+    /*! \brief Apply the operator to prp1 and store the result in prp2, the ghost of prp1 is exchanged while
+     *         the interior particles are evaluated (see Dcpse::computeDifferentialOperatorOverlap)
+     *
+     * \param parts particle set
+     */
+    template<unsigned int prp1, unsigned int prp2, typename particles_type>
+    void computeOverlap(particles_type &particles) {
+        auto dcpse_temp = (Dcpse_type<particles_type::dims, particles_type> *) dcpse;
+        dcpse_temp->template computeDifferentialOperatorOverlap<prp1, prp2>(particles);
+    }
 };
 
 template<template<unsigned int, typename, typename...> class Dcpse_type = Dcpse>
@@ -2134,41 +3401,256 @@ public:
     /*! \brief Method for Loading the DCPSE Operator.
      *
      * \param parts particle set
-     * \param file name for data to be loaded from.
+     * \param file name for data to be loaded from.
+     */
+    template<typename particles_type>
+    void load(particles_type &particles, const std::string &file) {
+        auto dcpse_temp = (Dcpse_type<particles_type::dims, particles_type> *) dcpse;
+        dcpse_temp->load(file);
+    }
+    /*! \brief Method for Updating the DCPSE Operator by recomputing DCPSE Kernels.
+     *
+     *
+     * \param parts particle set
+     */
+    template<typename particles_type>
+    void update(particles_type &particles) {
+        auto dcpse_temp = (Dcpse_type<particles_type::dims, particles_type> *) dcpse;
+        dcpse_temp->initializeUpdate(particles);
+
+    }
+
+    /*! \brief Rebuild the DCPSE Kernels in background, the current kernels are used until finalizeUpdateAsync
+     *
+     * The particles must not be mapped before the swap (see Dcpse::initializeGroupAsync)
+     *
+     * \param parts particle set
+     */
+    template<typename particles_type>
+    void updateAsync(particles_type &particles) {
+        auto dcpse_temp = (Dcpse_type<particles_type::dims, particles_type> *) dcpse;
+        dcpse_construct_shared<Dcpse_type, particles_type>::updateAsync(dcpse_temp, 1, particles);
+    }
+
+    /*! \brief Swap in the kernels rebuilt by updateAsync
+     *
+     * \param parts particle set
+     * \param wait wait for the rebuild if it is still running
+     *
+     * \return true if the new kernels are in use
+     */
+    template<typename particles_type>
+    bool finalizeUpdateAsync(particles_type &particles, bool wait = false) {
+        auto dcpse_temp = (Dcpse_type<particles_type::dims, particles_type> *) dcpse;
+        return dcpse_construct_shared<Dcpse_type, particles_type>::finalizeUpdateAsync(dcpse_temp, 1, wait);
+    }
+
+    /*! \brief Memory used by the operator in byte (see Dcpse::getMemoryUsage)
+     *
+     * \param parts particle set
+     */
+    template<typename particles_type>
+    size_t getMemoryUsage(particles_type &particles) {
+        auto dcpse_temp = (Dcpse_type<particles_type::dims, particles_type> *) dcpse;
+        return dcpse_temp->getMemoryUsage();
+    }
+
+    /*! \brief Remove the neighbours with a negligible weight and recompute the kernels (see Dcpse::pruneKernels)
+     *
+     * \param parts particle set
+     * \param threshold relative weight under which a neighbour is removed
+     *
+     * \return the number of weights removed on all the processors
+     */
+    template<typename particles_type>
+    size_t pruneKernels(particles_type &particles, typename particles_type::stype threshold) {
+        auto dcpse_temp = (Dcpse_type<particles_type::dims, particles_type> *) dcpse;
+        return dcpse_temp->pruneKernels(particles, threshold);
+    }
+
+    /*! \brief Materialise the operator as a sparse matrix (see Dcpse::getSparseMatrix)
+     *
+     * \param parts particle set
+     * \param M sparse matrix
+     */
+    template<typename particles_type, typename SparseMatrix_type>
+    void getSparseMatrix(particles_type &particles, SparseMatrix_type &M) {
+        auto dcpse_temp = (Dcpse_type<particles_type::dims, particles_type> *) dcpse;
+        dcpse_temp->getSparseMatrix(M);
+    }
+
+    /*! \brief Apply the operator to prp1 and store the result in prp2, the ghost of prp1 is exchanged while
+     *         the interior particles are evaluated (see Dcpse::computeDifferentialOperatorOverlap)
+     *
+     * \param parts particle set
+     */
+    template<unsigned int prp1, unsigned int prp2, typename particles_type>
+    void computeOverlap(particles_type &particles) {
+        auto dcpse_temp = (Dcpse_type<particles_type::dims, particles_type> *) dcpse;
+        dcpse_temp->template computeDifferentialOperatorOverlap<prp1, prp2>(particles);
+    }
+};
+
+template<template<unsigned int, typename, typename...> class Dcpse_type = Dcpse>
+class Derivative_yyx_T {
+
+    void *dcpse;
+
+public:
+
+    template<typename particles_type>
+    Derivative_yyx_T(particles_type &parts, unsigned int ord, typename particles_type::stype rCut,
+                   double oversampling_factor = dcpse_oversampling_factor,
+                   support_options opt = support_options::RADIUS) {
+        Point<particles_type::dims, unsigned int> p;
+        p.zero();
+        p.get(0) = 1;
+        p.get(1) = 2;
+
+        dcpse = new Dcpse_type<particles_type::dims, particles_type>(parts, p, ord, rCut, oversampling_factor, opt);
+    }
+
+    template<typename operand_type>
+
+    vector_dist_expression_op<operand_type, Dcpse_type<operand_type::vtype::dims, typename operand_type::vtype>, VECT_DCPSE>
+    operator()(operand_type arg) {
+        typedef Dcpse_type<operand_type::vtype::dims, typename operand_type::vtype> dcpse_type;
+
+        return vector_dist_expression_op<operand_type, dcpse_type, VECT_DCPSE>(arg, *(dcpse_type *) dcpse);
+    }
+
+    template<typename particles_type>
+    void checkMomenta(particles_type &particles) {
+        auto dcpse_temp = (Dcpse_type<particles_type::dims, particles_type> *) dcpse;
+        dcpse_temp->checkMomenta(particles);
+
+    }
+
+    template<unsigned int prp, typename particles_type>
+    void DrawKernel(particles_type &particles, int k) {
+        auto dcpse_temp = (Dcpse_type<particles_type::dims, particles_type> *) dcpse;
+        dcpse_temp->template DrawKernel<prp>(particles, k);
+
+    }
+
+    /*! \brief Method for Saving the DCPSE Operator.
+     *
+     * \param parts particle set
+     * \param file name for data to be saved.
+     */
+    template<typename particles_type>
+    void save(particles_type &particles, const std::string &file) {
+        auto dcpse_temp = (Dcpse_type<particles_type::dims, particles_type> *) dcpse;
+        dcpse_temp->save(file);
+    }
+    /*! \brief Method for Loading the DCPSE Operator.
+     *
+     * \param parts particle set
+     * \param file name for data to be loaded from.
+     */
+    template<typename particles_type>
+    void load(particles_type &particles, const std::string &file) {
+        auto dcpse_temp = (Dcpse_type<particles_type::dims, particles_type> *) dcpse;
+        dcpse_temp->load(file);
+    }
+    /*! \brief Method for Updating the DCPSE Operator by recomputing DCPSE Kernels.
+     *
+     *
+     * \param parts particle set
+     */
+    template<typename particles_type>
+    void update(particles_type &particles) {
+        auto dcpse_temp = (Dcpse_type<particles_type::dims, particles_type> *) dcpse;
+        dcpse_temp->initializeUpdate(particles);
+
+    }
+
+    /*! \brief Rebuild the DCPSE Kernels in background, the current kernels are used until finalizeUpdateAsync
+     *
+     * The particles must not be mapped before the swap (see Dcpse::initializeGroupAsync)
+     *
+     * \param parts particle set
+     */
+    template<typename particles_type>
+    void updateAsync(particles_type &particles) {
+        auto dcpse_temp = (Dcpse_type<particles_type::dims, particles_type> *) dcpse;
+        dcpse_construct_shared<Dcpse_type, particles_type>::updateAsync(dcpse_temp, 1, particles);
+    }
+
+    /*! \brief Swap in the kernels rebuilt by updateAsync
+     *
+     * \param parts particle set
+     * \param wait wait for the rebuild if it is still running
+     *
+     * \return true if the new kernels are in use
+     */
+    template<typename particles_type>
+    bool finalizeUpdateAsync(particles_type &particles, bool wait = false) {
+        auto dcpse_temp = (Dcpse_type<particles_type::dims, particles_type> *) dcpse;
+        return dcpse_construct_shared<Dcpse_type, particles_type>::finalizeUpdateAsync(dcpse_temp, 1, wait);
+    }
+
+    /*! \brief Memory used by the operator in byte (see Dcpse::getMemoryUsage)
+     *
+     * \param parts particle set
+     */
+    template<typename particles_type>
+    size_t getMemoryUsage(particles_type &particles) {
+        auto dcpse_temp = (Dcpse_type<particles_type::dims, particles_type> *) dcpse;
+        return dcpse_temp->getMemoryUsage();
+    }
+
+    /*! \brief Remove the neighbours with a negligible weight and recompute the kernels (see Dcpse::pruneKernels)
+     *
+     * \param parts particle set
+     * \param threshold relative weight under which a neighbour is removed
+     *
+     * \return the number of weights removed on all the processors
+     */
+    template<typename particles_type>
+    size_t pruneKernels(particles_type &particles, typename particles_type::stype threshold) {
+        auto dcpse_temp = (Dcpse_type<particles_type::dims, particles_type> *) dcpse;
+        return dcpse_temp->pruneKernels(particles, threshold);
+    }
+
+    /*! \brief Materialise the operator as a sparse matrix (see Dcpse::getSparseMatrix)
+     *
+     * \param parts particle set
+     * \param M sparse matrix
      */
-    template<typename particles_type>
-    void load(particles_type &particles, const std::string &file) {
+    template<typename particles_type, typename SparseMatrix_type>
+    void getSparseMatrix(particles_type &particles, SparseMatrix_type &M) {
         auto dcpse_temp = (Dcpse_type<particles_type::dims, particles_type> *) dcpse;
-        dcpse_temp->load(file);
+        dcpse_temp->getSparseMatrix(M);
     }
-    /*! \brief Method for Updating the DCPSE Operator by recomputing DCPSE Kernels.
-     *
+
+    /*! \brief Apply the operator to prp1 and store the result in prp2, the ghost of prp1 is exchanged while
+     *         the interior particles are evaluated (see Dcpse::computeDifferentialOperatorOverlap)
      *
      * \param parts particle set
      */
-    template<typename particles_type>
-    void update(particles_type &particles) {
+    template<unsigned int prp1, unsigned int prp2, typename particles_type>
+    void computeOverlap(particles_type &particles) {
         auto dcpse_temp = (Dcpse_type<particles_type::dims, particles_type> *) dcpse;
-        dcpse_temp->initializeUpdate(particles);
-
+        dcpse_temp->template computeDifferentialOperatorOverlap<prp1, prp2>(particles);
     }
 };
 
 template<template<unsigned int, typename, typename...> class Dcpse_type = Dcpse>
-class Derivative_yyx_T {
+class Derivative_yyy_T {
 
     void *dcpse;
 
 public:
 
     template<typename particles_type>
-    Derivative_yyx_T(particles_type &parts, unsigned int ord, typename particles_type::stype rCut,
+    Derivative_yyy_T(particles_type &parts, unsigned int ord, typename particles_type::stype rCut,
                    double oversampling_factor = dcpse_oversampling_factor,
                    support_options opt = support_options::RADIUS) {
         Point<particles_type::dims, unsigned int> p;
         p.zero();
-        p.get(0) = 1;
-        p.get(1) = 2;
+        p.get(0) = 0;
+        p.get(1) = 3;
 
         dcpse = new Dcpse_type<particles_type::dims, particles_type>(parts, p, ord, rCut, oversampling_factor, opt);
     }
@@ -2227,80 +3709,75 @@ public:
         dcpse_temp->initializeUpdate(particles);
 
     }
-};
-
-template<template<unsigned int, typename, typename...> class Dcpse_type = Dcpse>
-class Derivative_yyy_T {
-
-    void *dcpse;
-
-public:
 
+    /*! \brief Rebuild the DCPSE Kernels in background, the current kernels are used until finalizeUpdateAsync
+     *
+     * The particles must not be mapped before the swap (see Dcpse::initializeGroupAsync)
+     *
+     * \param parts particle set
+     */
     template<typename particles_type>
-    Derivative_yyy_T(particles_type &parts, unsigned int ord, typename particles_type::stype rCut,
-                   double oversampling_factor = dcpse_oversampling_factor,
-                   support_options opt = support_options::RADIUS) {
-        Point<particles_type::dims, unsigned int> p;
-        p.zero();
-        p.get(0) = 0;
-        p.get(1) = 3;
-
-        dcpse = new Dcpse_type<particles_type::dims, particles_type>(parts, p, ord, rCut, oversampling_factor, opt);
-    }
-
-    template<typename operand_type>
-
-    vector_dist_expression_op<operand_type, Dcpse_type<operand_type::vtype::dims, typename operand_type::vtype>, VECT_DCPSE>
-    operator()(operand_type arg) {
-        typedef Dcpse_type<operand_type::vtype::dims, typename operand_type::vtype> dcpse_type;
-
-        return vector_dist_expression_op<operand_type, dcpse_type, VECT_DCPSE>(arg, *(dcpse_type *) dcpse);
+    void updateAsync(particles_type &particles) {
+        auto dcpse_temp = (Dcpse_type<particles_type::dims, particles_type> *) dcpse;
+        dcpse_construct_shared<Dcpse_type, particles_type>::updateAsync(dcpse_temp, 1, particles);
     }
 
+    /*! \brief Swap in the kernels rebuilt by updateAsync
+     *
+     * \param parts particle set
+     * \param wait wait for the rebuild if it is still running
+     *
+     * \return true if the new kernels are in use
+     */
     template<typename particles_type>
-    void checkMomenta(particles_type &particles) {
+    bool finalizeUpdateAsync(particles_type &particles, bool wait = false) {
         auto dcpse_temp = (Dcpse_type<particles_type::dims, particles_type> *) dcpse;
-        dcpse_temp->checkMomenta(particles);
-
+        return dcpse_construct_shared<Dcpse_type, particles_type>::finalizeUpdateAsync(dcpse_temp, 1, wait);
     }
 
-    template<unsigned int prp, typename particles_type>
-    void DrawKernel(particles_type &particles, int k) {
+    /*! \brief Memory used by the operator in byte (see Dcpse::getMemoryUsage)
+     *
+     * \param parts particle set
+     */
+    template<typename particles_type>
+    size_t getMemoryUsage(particles_type &particles) {
         auto dcpse_temp = (Dcpse_type<particles_type::dims, particles_type> *) dcpse;
-        dcpse_temp->template DrawKernel<prp>(particles, k);
-
+        return dcpse_temp->getMemoryUsage();
     }
 
-    /*! \brief Method for Saving the DCPSE Operator.
+    /*! \brief Remove the neighbours with a negligible weight and recompute the kernels (see Dcpse::pruneKernels)
      *
      * \param parts particle set
-     * \param file name for data to be saved.
+     * \param threshold relative weight under which a neighbour is removed
+     *
+     * \return the number of weights removed on all the processors
      */
     template<typename particles_type>
-    void save(particles_type &particles, const std::string &file) {
+    size_t pruneKernels(particles_type &particles, typename particles_type::stype threshold) {
         auto dcpse_temp = (Dcpse_type<particles_type::dims, particles_type> *) dcpse;
-        dcpse_temp->save(file);
+        return dcpse_temp->pruneKernels(particles, threshold);
     }
-    /*! \brief Method for Loading the DCPSE Operator.
+
+    /*! \brief Materialise the operator as a sparse matrix (see Dcpse::getSparseMatrix)
      *
      * \param parts particle set
-     * \param file name for data to be loaded from.
+     * \param M sparse matrix
      */
-    template<typename particles_type>
-    void load(particles_type &particles, const std::string &file) {
+    template<typename particles_type, typename SparseMatrix_type>
+    void getSparseMatrix(particles_type &particles, SparseMatrix_type &M) {
         auto dcpse_temp = (Dcpse_type<particles_type::dims, particles_type> *) dcpse;
-        dcpse_temp->load(file);
+        dcpse_temp->getSparseMatrix(M);
     }
-    /*! \brief Method for Updating the DCPSE Operator by recomputing DCPSE Kernels.
-     *
+
+    /*! \brief Apply the operator to prp1 and store the result in prp2, the ghost of prp1 is exchanged while
+     *         the interior particles are evaluated (see Dcpse::computeDifferentialOperatorOverlap)
      *
      * \param parts particle set
      */
-    template<typename particles_type>
-    void update(particles_type &particles) {
+    template<unsigned int prp1, unsigned int prp2, typename particles_type>
+    void computeOverlap(particles_type &particles) {
         auto dcpse_temp = (Dcpse_type<particles_type::dims, particles_type> *) dcpse;
-        dcpse_temp->initializeUpdate(particles);
-
+        dcpse_temp->template computeDifferentialOperatorOverlap<prp1, prp2>(particles);
     }
 };
 
@@ -2378,6 +3855,76 @@ public:
         dcpse_temp->initializeUpdate(particles);
 
     }
+
+    /*! \brief Rebuild the DCPSE Kernels in background, the current kernels are used until finalizeUpdateAsync
+     *
+     * The particles must not be mapped before the swap (see Dcpse::initializeGroupAsync)
+     *
+     * \param parts particle set
+     */
+    template<typename particles_type>
+    void updateAsync(particles_type &particles) {
+        auto dcpse_temp = (Dcpse_type<particles_type::dims, particles_type> *) dcpse;
+        dcpse_construct_shared<Dcpse_type, particles_type>::updateAsync(dcpse_temp, 1, particles);
+    }
+
+    /*! \brief Swap in the kernels rebuilt by updateAsync
+     *
+     * \param parts particle set
+     * \param wait wait for the rebuild if it is still running
+     *
+     * \return true if the new kernels are in use
+     */
+    template<typename particles_type>
+    bool finalizeUpdateAsync(particles_type &particles, bool wait = false) {
+        auto dcpse_temp = (Dcpse_type<particles_type::dims, particles_type> *) dcpse;
+        return dcpse_construct_shared<Dcpse_type, particles_type>::finalizeUpdateAsync(dcpse_temp, 1, wait);
+    }
+
+    /*! \brief Memory used by the operator in byte (see Dcpse::getMemoryUsage)
+     *
+     * \param parts particle set
+     */
+    template<typename particles_type>
+    size_t getMemoryUsage(particles_type &particles) {
+        auto dcpse_temp = (Dcpse_type<particles_type::dims, particles_type> *) dcpse;
+        return dcpse_temp->getMemoryUsage();
+    }
+
+    /*! \brief Remove the neighbours with a negligible weight and recompute the kernels (see Dcpse::pruneKernels)
+     *
+     * \param parts particle set
+     * \param threshold relative weight under which a neighbour is removed
+     *
+     * \return the number of weights removed on all the processors
+     */
+    template<typename particles_type>
+    size_t pruneKernels(particles_type &particles, typename particles_type::stype threshold) {
+        auto dcpse_temp = (Dcpse_type<particles_type::dims, particles_type> *) dcpse;
+        return dcpse_temp->pruneKernels(particles, threshold);
+    }
+
+    /*! \brief Materialise the operator as a sparse matrix (see Dcpse::getSparseMatrix)
+     *
+     * \param parts particle set
+     * \param M sparse matrix
+     */
+    template<typename particles_type, typename SparseMatrix_type>
+    void getSparseMatrix(particles_type &particles, SparseMatrix_type &M) {
+        auto dcpse_temp = (Dcpse_type<particles_type::dims, particles_type> *) dcpse;
+        dcpse_temp->getSparseMatrix(M);
+    }
+
+    /*! \brief Apply the operator to prp1 and store the result in prp2, the ghost of prp1 is exchanged while
+     *         the interior particles are evaluated (see Dcpse::computeDifferentialOperatorOverlap)
+     *
+     * \param parts particle set
+     */
+    template<unsigned int prp1, unsigned int prp2, typename particles_type>
+    void computeOverlap(particles_type &particles) {
+        auto dcpse_temp = (Dcpse_type<particles_type::dims, particles_type> *) dcpse;
+        dcpse_temp->template computeDifferentialOperatorOverlap<prp1, prp2>(particles);
+    }
 };
 
 
@@ -2454,6 +4001,76 @@ public:
         dcpse_temp->initializeUpdate(particles);
 
     }
+
+    /*! \brief Rebuild the DCPSE Kernels in background, the current kernels are used until finalizeUpdateAsync
+     *
+     * The particles must not be mapped before the swap (see Dcpse::initializeGroupAsync)
+     *
+     * \param parts particle set
+     */
+    template<typename particles_type>
+    void updateAsync(particles_type &particles) {
+        auto dcpse_temp = (Dcpse_type<particles_type::dims, particles_type> *) dcpse;
+        dcpse_construct_shared<Dcpse_type, particles_type>::updateAsync(dcpse_temp, 1, particles);
+    }
+
+    /*! \brief Swap in the kernels rebuilt by updateAsync
+     *
+     * \param parts particle set
+     * \param wait wait for the rebuild if it is still running
+     *
+     * \return true if the new kernels are in use
+     */
+    template<typename particles_type>
+    bool finalizeUpdateAsync(particles_type &particles, bool wait = false) {
+        auto dcpse_temp = (Dcpse_type<particles_type::dims, particles_type> *) dcpse;
+        return dcpse_construct_shared<Dcpse_type, particles_type>::finalizeUpdateAsync(dcpse_temp, 1, wait);
+    }
+
+    /*! \brief Memory used by the operator in byte (see Dcpse::getMemoryUsage)
+     *
+     * \param parts particle set
+     */
+    template<typename particles_type>
+    size_t getMemoryUsage(particles_type &particles) {
+        auto dcpse_temp = (Dcpse_type<particles_type::dims, particles_type> *) dcpse;
+        return dcpse_temp->getMemoryUsage();
+    }
+
+    /*! \brief Remove the neighbours with a negligible weight and recompute the kernels (see Dcpse::pruneKernels)
+     *
+     * \param parts particle set
+     * \param threshold relative weight under which a neighbour is removed
+     *
+     * \return the number of weights removed on all the processors
+     */
+    template<typename particles_type>
+    size_t pruneKernels(particles_type &particles, typename particles_type::stype threshold) {
+        auto dcpse_temp = (Dcpse_type<particles_type::dims, particles_type> *) dcpse;
+        return dcpse_temp->pruneKernels(particles, threshold);
+    }
+
+    /*! \brief Materialise the operator as a sparse matrix (see Dcpse::getSparseMatrix)
+     *
+     * \param parts particle set
+     * \param M sparse matrix
+     */
+    template<typename particles_type, typename SparseMatrix_type>
+    void getSparseMatrix(particles_type &particles, SparseMatrix_type &M) {
+        auto dcpse_temp = (Dcpse_type<particles_type::dims, particles_type> *) dcpse;
+        dcpse_temp->getSparseMatrix(M);
+    }
+
+    /*! \brief Apply the operator to prp1 and store the result in prp2, the ghost of prp1 is exchanged while
+     *         the interior particles are evaluated (see Dcpse::computeDifferentialOperatorOverlap)
+     *
+     * \param parts particle set
+     */
+    template<unsigned int prp1, unsigned int prp2, typename particles_type>
+    void computeOverlap(particles_type &particles) {
+        auto dcpse_temp = (Dcpse_type<particles_type::dims, particles_type> *) dcpse;
+        dcpse_temp->template computeDifferentialOperatorOverlap<prp1, prp2>(particles);
+    }
 };
 
 template<template<unsigned int, typename, typename...> class Dcpse_type = Dcpse>
@@ -2529,6 +4146,76 @@ public:
         dcpse_temp->initializeUpdate(particles);
 
     }
+
+    /*! \brief Rebuild the DCPSE Kernels in background, the current kernels are used until finalizeUpdateAsync
+     *
+     * The particles must not be mapped before the swap (see Dcpse::initializeGroupAsync)
+     *
+     * \param parts particle set
+     */
+    template<typename particles_type>
+    void updateAsync(particles_type &particles) {
+        auto dcpse_temp = (Dcpse_type<particles_type::dims, particles_type> *) dcpse;
+        dcpse_construct_shared<Dcpse_type, particles_type>::updateAsync(dcpse_temp, 1, particles);
+    }
+
+    /*! \brief Swap in the kernels rebuilt by updateAsync
+     *
+     * \param parts particle set
+     * \param wait wait for the rebuild if it is still running
+     *
+     * \return true if the new kernels are in use
+     */
+    template<typename particles_type>
+    bool finalizeUpdateAsync(particles_type &particles, bool wait = false) {
+        auto dcpse_temp = (Dcpse_type<particles_type::dims, particles_type> *) dcpse;
+        return dcpse_construct_shared<Dcpse_type, particles_type>::finalizeUpdateAsync(dcpse_temp, 1, wait);
+    }
+
+    /*! \brief Memory used by the operator in byte (see Dcpse::getMemoryUsage)
+     *
+     * \param parts particle set
+     */
+    template<typename particles_type>
+    size_t getMemoryUsage(particles_type &particles) {
+        auto dcpse_temp = (Dcpse_type<particles_type::dims, particles_type> *) dcpse;
+        return dcpse_temp->getMemoryUsage();
+    }
+
+    /*! \brief Remove the neighbours with a negligible weight and recompute the kernels (see Dcpse::pruneKernels)
+     *
+     * \param parts particle set
+     * \param threshold relative weight under which a neighbour is removed
+     *
+     * \return the number of weights removed on all the processors
+     */
+    template<typename particles_type>
+    size_t pruneKernels(particles_type &particles, typename particles_type::stype threshold) {
+        auto dcpse_temp = (Dcpse_type<particles_type::dims, particles_type> *) dcpse;
+        return dcpse_temp->pruneKernels(particles, threshold);
+    }
+
+    /*! \brief Materialise the operator as a sparse matrix (see Dcpse::getSparseMatrix)
+     *
+     * \param parts particle set
+     * \param M sparse matrix
+     */
+    template<typename particles_type, typename SparseMatrix_type>
+    void getSparseMatrix(particles_type &particles, SparseMatrix_type &M) {
+        auto dcpse_temp = (Dcpse_type<particles_type::dims, particles_type> *) dcpse;
+        dcpse_temp->getSparseMatrix(M);
+    }
+
+    /*! \brief Apply the operator to prp1 and store the result in prp2, the ghost of prp1 is exchanged while
+     *         the interior particles are evaluated (see Dcpse::computeDifferentialOperatorOverlap)
+     *
+     * \param parts particle set
+     */
+    template<unsigned int prp1, unsigned int prp2, typename particles_type>
+    void computeOverlap(particles_type &particles) {
+        auto dcpse_temp = (Dcpse_type<particles_type::dims, particles_type> *) dcpse;
+        dcpse_temp->template computeDifferentialOperatorOverlap<prp1, prp2>(particles);
+    }
 };
 
 
@@ -2599,6 +4286,76 @@ public:
         dcpse_temp->initializeUpdate(particles);
 
     }
+
+    /*! \brief Rebuild the DCPSE Kernels in background, the current kernels are used until finalizeUpdateAsync
+     *
+     * The particles must not be mapped before the swap (see Dcpse::initializeGroupAsync)
+     *
+     * \param parts particle set
+     */
+    template<typename particles_type>
+    void updateAsync(particles_type &particles) {
+        auto dcpse_temp = (Dcpse_type<particles_type::dims, particles_type> *) dcpse;
+        dcpse_construct_shared<Dcpse_type, particles_type>::updateAsync(dcpse_temp, 1, particles);
+    }
+
+    /*! \brief Swap in the kernels rebuilt by updateAsync
+     *
+     * \param parts particle set
+     * \param wait wait for the rebuild if it is still running
+     *
+     * \return true if the new kernels are in use
+     */
+    template<typename particles_type>
+    bool finalizeUpdateAsync(particles_type &particles, bool wait = false) {
+        auto dcpse_temp = (Dcpse_type<particles_type::dims, particles_type> *) dcpse;
+        return dcpse_construct_shared<Dcpse_type, particles_type>::finalizeUpdateAsync(dcpse_temp, 1, wait);
+    }
+
+    /*! \brief Memory used by the operator in byte (see Dcpse::getMemoryUsage)
+     *
+     * \param parts particle set
+     */
+    template<typename particles_type>
+    size_t getMemoryUsage(particles_type &particles) {
+        auto dcpse_temp = (Dcpse_type<particles_type::dims, particles_type> *) dcpse;
+        return dcpse_temp->getMemoryUsage();
+    }
+
+    /*! \brief Remove the neighbours with a negligible weight and recompute the kernels (see Dcpse::pruneKernels)
+     *
+     * \param parts particle set
+     * \param threshold relative weight under which a neighbour is removed
+     *
+     * \return the number of weights removed on all the processors
+     */
+    template<typename particles_type>
+    size_t pruneKernels(particles_type &particles, typename particles_type::stype threshold) {
+        auto dcpse_temp = (Dcpse_type<particles_type::dims, particles_type> *) dcpse;
+        return dcpse_temp->pruneKernels(particles, threshold);
+    }
+
+    /*! \brief Materialise the operator as a sparse matrix (see Dcpse::getSparseMatrix)
+     *
+     * \param parts particle set
+     * \param M sparse matrix
+     */
+    template<typename particles_type, typename SparseMatrix_type>
+    void getSparseMatrix(particles_type &particles, SparseMatrix_type &M) {
+        auto dcpse_temp = (Dcpse_type<particles_type::dims, particles_type> *) dcpse;
+        dcpse_temp->getSparseMatrix(M);
+    }
+
+    /*! \brief Apply the operator to prp1 and store the result in prp2, the ghost of prp1 is exchanged while
+     *         the interior particles are evaluated (see Dcpse::computeDifferentialOperatorOverlap)
+     *
+     * \param parts particle set
+     */
+    template<unsigned int prp1, unsigned int prp2, typename particles_type>
+    void computeOverlap(particles_type &particles) {
+        auto dcpse_temp = (Dcpse_type<particles_type::dims, particles_type> *) dcpse;
+        dcpse_temp->template computeDifferentialOperatorOverlap<prp1, prp2>(particles);
+    }
 };
 
 //typedef PPInterpolation_T<Dcpse> PPInterpolation;
@@ -36,6 +36,21 @@ public:
         dcpse = new SurfaceDcpse<particles_type::dims, particles_type>(parts, p, ord, rCut,nSpacing,value_t<NORMAL_ID>(), opt);
     }
 
+    /*! \brief Register the operator on a shared surface context, the kernels are computed by SurfaceDcpseContext::build
+     *
+     * \param parts particle set
+     * \param ctx context with the normal-extended particles and the support shared with the other surface operators
+     *
+     */
+    template<typename particles_type>
+    SurfaceDerivative_x(particles_type &parts, SurfaceDcpseContext<NORMAL_ID,particles_type> &ctx) {
+        Point<particles_type::dims, unsigned int> p;
+        p.zero();
+        p.get(0) = 1;
+
+        dcpse = ctx.addOperator(p);
+    }
+
     template<typename particles_type>
     void deallocate(particles_type &parts) {
         delete (Dcpse<particles_type::dims, particles_type> *) dcpse;
@@ -126,6 +141,21 @@ public:
         dcpse = new SurfaceDcpse<particles_type::dims, particles_type>(parts, p, ord, rCut,nSpacing,value_t<NORMAL_ID>(), opt);
     }
 
+    /*! \brief Register the operator on a shared surface context, the kernels are computed by SurfaceDcpseContext::build
+     *
+     * \param parts particle set
+     * \param ctx context with the normal-extended particles and the support shared with the other surface operators
+     *
+     */
+    template<typename particles_type>
+    SurfaceDerivative_y(particles_type &parts, SurfaceDcpseContext<NORMAL_ID,particles_type> &ctx) {
+        Point<particles_type::dims, unsigned int> p;
+        p.zero();
+        p.get(1) = 1;
+
+        dcpse = ctx.addOperator(p);
+    }
+
     template<typename particles_type>
     void deallocate(particles_type &parts) {
         delete (Dcpse<particles_type::dims, particles_type> *) dcpse;
@@ -217,6 +247,21 @@ public:
         dcpse = new SurfaceDcpse<particles_type::dims, particles_type>(parts, p, ord, rCut,nSpacing,value_t<NORMAL_ID>(), opt);
     }
 
+    /*! \brief Register the operator on a shared surface context, the kernels are computed by SurfaceDcpseContext::build
+     *
+     * \param parts particle set
+     * \param ctx context with the normal-extended particles and the support shared with the other surface operators
+     *
+     */
+    template<typename particles_type>
+    SurfaceDerivative_z(particles_type &parts, SurfaceDcpseContext<NORMAL_ID,particles_type> &ctx) {
+        Point<particles_type::dims, unsigned int> p;
+        p.zero();
+        p.get(2) = 1;
+
+        dcpse = ctx.addOperator(p);
+    }
+
     template<typename particles_type>
     void deallocate(particles_type &parts) {
         delete (Dcpse<particles_type::dims, particles_type> *) dcpse;
@@ -309,6 +354,23 @@ public:
         dcpse = new SurfaceDcpse<particles_type::dims, particles_type>(parts, p, ord, rCut,nSpacing,value_t<NORMAL_ID>(), opt);
     }
 
+    /*! \brief Register the operator on a shared surface context, the kernels are computed by SurfaceDcpseContext::build
+     *
+     * \param parts particle set
+     * \param ctx context with the normal-extended particles and the support shared with the other surface operators
+     *
+     */
+    template<typename particles_type>
+    Laplace_Beltrami(particles_type &parts, SurfaceDcpseContext<NORMAL_ID,particles_type> &ctx) {
+        Point<particles_type::dims, unsigned int> p;
+        p.zero();
+        p.get(0) = 2;
+        p.get(1) = 2;
+        p.get(2) = 2;
+
+        dcpse = ctx.addOperator(p);
+    }
+
     template<typename particles_type>
     void deallocate(particles_type &parts) {
         delete (Dcpse<particles_type::dims, particles_type> *) dcpse;
@@ -399,6 +461,21 @@ public:
         dcpse = new SurfaceDcpse<particles_type::dims, particles_type>(parts, p, ord, rCut,nSpacing,value_t<NORMAL_ID>(), opt);
     }
 
+    /*! \brief Register the operator on a shared surface context, the kernels are computed by SurfaceDcpseContext::build
+     *
+     * \param parts particle set
+     * \param ctx context with the normal-extended particles and the support shared with the other surface operators
+     *
+     */
+    template<typename particles_type>
+    SurfaceDerivative_xx(particles_type &parts, SurfaceDcpseContext<NORMAL_ID,particles_type> &ctx) {
+        Point<particles_type::dims, unsigned int> p;
+        p.zero();
+        p.get(0) = 2;
+
+        dcpse = ctx.addOperator(p);
+    }
+
     template<typename particles_type>
     void deallocate(particles_type &parts) {
         delete (Dcpse<particles_type::dims, particles_type> *) dcpse;
@@ -490,6 +567,21 @@ public:
         dcpse = new SurfaceDcpse<particles_type::dims, particles_type>(parts, p, ord, rCut,nSpacing,value_t<NORMAL_ID>(), opt);
     }
 
+    /*! \brief Register the operator on a shared surface context, the kernels are computed by SurfaceDcpseContext::build
+     *
+     * \param parts particle set
+     * \param ctx context with the normal-extended particles and the support shared with the other surface operators
+     *
+     */
+    template<typename particles_type>
+    SurfaceDerivative_yy(particles_type &parts, SurfaceDcpseContext<NORMAL_ID,particles_type> &ctx) {
+        Point<particles_type::dims, unsigned int> p;
+        p.zero();
+        p.get(1) = 2;
+
+        dcpse = ctx.addOperator(p);
+    }
+
     template<typename particles_type>
     void deallocate(particles_type &parts) {
         delete (Dcpse<particles_type::dims, particles_type> *) dcpse;
@@ -580,6 +672,21 @@ public:
         dcpse = new SurfaceDcpse<particles_type::dims, particles_type>(parts, p, ord, rCut,nSpacing,value_t<NORMAL_ID>(), opt);
     }
 
+    /*! \brief Register the operator on a shared surface context, the kernels are computed by SurfaceDcpseContext::build
+     *
+     * \param parts particle set
+     * \param ctx context with the normal-extended particles and the support shared with the other surface operators
+     *
+     */
+    template<typename particles_type>
+    SurfaceDerivative_zz(particles_type &parts, SurfaceDcpseContext<NORMAL_ID,particles_type> &ctx) {
+        Point<particles_type::dims, unsigned int> p;
+        p.zero();
+        p.get(2) = 2;
+
+        dcpse = ctx.addOperator(p);
+    }
+
     template<typename particles_type>
     void deallocate(particles_type &parts) {
         delete (Dcpse<particles_type::dims, particles_type> *) dcpse;
@@ -672,6 +779,22 @@ public:
         dcpse = new SurfaceDcpse<particles_type::dims, particles_type>(parts, p, ord, rCut,nSpacing,value_t<NORMAL_ID>(), opt);
     }
 
+    /*! \brief Register the operator on a shared surface context, the kernels are computed by SurfaceDcpseContext::build
+     *
+     * \param parts particle set
+     * \param ctx context with the normal-extended particles and the support shared with the other surface operators
+     *
+     */
+    template<typename particles_type>
+    SurfaceDerivative_xy(particles_type &parts, SurfaceDcpseContext<NORMAL_ID,particles_type> &ctx) {
+        Point<particles_type::dims, unsigned int> p;
+        p.zero();
+        p.get(0) = 1;
+        p.get(1) = 1;
+
+        dcpse = ctx.addOperator(p);
+    }
+
     template<typename particles_type>
     void deallocate(particles_type &parts) {
         delete (Dcpse<particles_type::dims, particles_type> *) dcpse;
@@ -764,6 +887,22 @@ public:
         dcpse = new SurfaceDcpse<particles_type::dims, particles_type>(parts, p, ord, rCut,nSpacing,value_t<NORMAL_ID>(), opt);
     }
 
+    /*! \brief Register the operator on a shared surface context, the kernels are computed by SurfaceDcpseContext::build
+     *
+     * \param parts particle set
+     * \param ctx context with the normal-extended particles and the support shared with the other surface operators
+     *
+     */
+    template<typename particles_type>
+    SurfaceDerivative_yz(particles_type &parts, SurfaceDcpseContext<NORMAL_ID,particles_type> &ctx) {
+        Point<particles_type::dims, unsigned int> p;
+        p.zero();
+        p.get(1) = 1;
+        p.get(2) = 1;
+
+        dcpse = ctx.addOperator(p);
+    }
+
     template<typename particles_type>
     void deallocate(particles_type &parts) {
         delete (Dcpse<particles_type::dims, particles_type> *) dcpse;
@@ -856,6 +995,22 @@ public:
         dcpse = new SurfaceDcpse<particles_type::dims, particles_type>(parts, p, ord, rCut,nSpacing,value_t<NORMAL_ID>(), opt);
     }
 
+    /*! \brief Register the operator on a shared surface context, the kernels are computed by SurfaceDcpseContext::build
+     *
+     * \param parts particle set
+     * \param ctx context with the normal-extended particles and the support shared with the other surface operators
+     *
+     */
+    template<typename particles_type>
+    SurfaceDerivative_xz(particles_type &parts, SurfaceDcpseContext<NORMAL_ID,particles_type> &ctx) {
+        Point<particles_type::dims, unsigned int> p;
+        p.zero();
+        p.get(0) = 1;
+        p.get(2) = 1;
+
+        dcpse = ctx.addOperator(p);
+    }
+
     template<typename particles_type>
     void deallocate(particles_type &parts) {
         delete (Dcpse<particles_type::dims, particles_type> *) dcpse;
@@ -943,6 +1098,19 @@ public:
         dcpse = new SurfaceDcpse<particles_type::dims, particles_type>(parts, p, ord, rCut,nSpacing,value_t<NORMAL_ID>(), opt);
     }
 
+    /*! \brief Register the operator on a shared surface context, the kernels are computed by SurfaceDcpseContext::build
+     *
+     * \param parts particle set
+     * \param ctx context with the normal-extended particles and the support shared with the other surface operators
+     * \param p signature of the operator
+     *
+     */
+    template<typename particles_type>
+    SurfaceDerivative_G(particles_type &parts, SurfaceDcpseContext<NORMAL_ID,particles_type> &ctx, const Point<particles_type::dims, unsigned int> &p) {
+
+        dcpse = ctx.addOperator(p);
+    }
+
     template<typename particles_type>
     void deallocate(particles_type &parts) {
         delete (Dcpse<particles_type::dims, particles_type> *) dcpse;
@@ -7,6 +7,7 @@
 #define OPENFPM_PDATA_EQNSSTRUCT_HPP
 
 #include "Solvers/umfpack_solver.hpp"
+#include "Solvers/mixed_precision_solver.hpp"
 #include "Solvers/petsc_solver.hpp"
 
 #ifdef HAVE_PETSC
@@ -655,6 +656,32 @@ struct equations2d1E {
     //! boundary at X and Y
     static constexpr bool boundary[]={NON_PERIODIC, NON_PERIODIC};
 
+//! Same as equations2d1E with the linear system in single precision, the solve moves half of the bytes
+struct equations2d1Ef {
+
+    //! dimensionaly of the equation ( 3D problem ...)
+    static const unsigned int dims=2;
+    //! number of fields in the system
+    static const unsigned int nvar=1;
+
+    //! boundary at X and Y
+    static constexpr bool boundary[]={NON_PERIODIC, NON_PERIODIC};
+
+    //! type of space float, double, ...
+    typedef double stype;
+
+    //! type of base particles
+    typedef vector_dist<dims, double, aggregate<double>> b_part;
+
+    //! type of SparseMatrix for the linear solver
+    typedef SparseMatrix<float, int, EIGEN_BASE> SparseMatrix_type;
+
+    //! type of Vector for the linear solver
+    typedef Vector<float> Vector_type;
+
+    typedef umfpack_solver<float> solver_type;
+};
+
     //! type of space float, double, ...
     typedef double stype;
 
@@ -848,6 +875,32 @@ struct equations3d1E {
     //! boundary at X and Y
     static constexpr bool boundary[]={NON_PERIODIC, NON_PERIODIC,NON_PERIODIC};
 
+//! Same as equations3d1E with the linear system in single precision, the solve moves half of the bytes
+struct equations3d1Ef {
+
+    //! dimensionaly of the equation ( 3D problem ...)
+    static const unsigned int dims=3;
+    //! number of fields in the system
+    static const unsigned int nvar=1;
+
+    //! boundary at X and Y
+    static constexpr bool boundary[]={NON_PERIODIC, NON_PERIODIC,NON_PERIODIC};
+
+    //! type of space float, double, ...
+    typedef double stype;
+
+    //! type of base particles
+    typedef vector_dist<dims, double, aggregate<double>> b_part;
+
+    //! type of SparseMatrix for the linear solver
+    typedef SparseMatrix<float, int, EIGEN_BASE> SparseMatrix_type;
+
+    //! type of Vector for the linear solver
+    typedef Vector<float> Vector_type;
+
+    typedef umfpack_solver<float> solver_type;
+};
+
     //! type of space float, double, ...
     typedef double stype;
 
@@ -26,6 +26,18 @@
 #include "Vector/vector_dist_subset.hpp"
 #include "DCPSE/DCPSE_op/EqnsStruct.hpp"
 #include "Decomposition/Distribution/SpaceDistribution.hpp"
+#include "OdeIntegrators/imex_dcpse.hpp"
+
+//! right hand side of impose_git, property 1 of the particles
+template<typename vector_type>
+struct impose_git_prop1_b
+{
+    vector_type & vd;
+
+    double get(size_t key) {
+        return vd.template getProp<1>(key);
+    }
+};
 
 BOOST_AUTO_TEST_SUITE(dcpse_op_suite_tests)
 
@@ -606,6 +618,427 @@ BOOST_AUTO_TEST_SUITE(dcpse_op_suite_tests)
     }
     ////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 
+    BOOST_AUTO_TEST_CASE(dcpse_poisson_Dirichlet_matrix_free) {
+        const size_t sz[2] = {41,41};
+        Box<2, double> box({0, 0}, {1, 1});
+        size_t bc[2] = {NON_PERIODIC, NON_PERIODIC};
+        double spacing = box.getHigh(0) / (sz[0] - 1);
+        Ghost<2, double> ghost(spacing * 3.1);
+        double rCut = 3.1 * spacing;
+
+        vector_dist<2, double, aggregate<double,double,double>> domain(0, box, bc, ghost);
+
+        auto it = domain.getGridIterator(sz);
+        while (it.isNext()) {
+            domain.add();
+            auto key = it.get();
+            domain.getLastPos()[0] = key.get(0) * it.getSpacing(0);
+            domain.getLastPos()[1] = key.get(1) * it.getSpacing(1);
+            ++it;
+        }
+        domain.map();
+        domain.ghost_get<0>();
+
+        Laplacian Lap(domain, 2, rCut, 1.9, support_options::RADIUS);
+
+        openfpm::vector<aggregate<int>> bulk;
+        openfpm::vector<aggregate<int>> boundary;
+
+        auto v = getV<0>(domain);
+        auto sol = getV<2>(domain);
+
+        auto it2 = domain.getDomainIterator();
+        while (it2.isNext()) {
+            auto p = it2.get();
+            Point<2, double> xp = domain.getPos(p);
+            domain.getProp<1>(p) = -2*M_PI*M_PI*sin(M_PI*xp.get(0))*sin(M_PI*xp.get(1));
+            bool isBoundary = false;
+            for (size_t k = 0; k < 2; k++)
+            {isBoundary |= xp.get(k) < spacing / 2.0 || xp.get(k) > box.getHigh(k) - spacing / 2.0;}
+
+            if (isBoundary) {
+                boundary.add();
+                boundary.last().get<0>() = p.getKey();
+                domain.getProp<1>(p) = 0.0;
+            } else {
+                bulk.add();
+                bulk.last().get<0>() = p.getKey();
+            }
+            ++it2;
+        }
+
+        petsc_solver<double> solverA;
+        solverA.setRestart(200);
+        solverA.setAbsTol(1e-12);
+        solverA.setRelTol(1e-10);
+
+        DCPSE_scheme<equations2d1,decltype(domain)> Solver(domain);
+        Solver.impose(Lap(v), bulk, prop_id<1>());
+        Solver.impose(v, boundary, prop_id<1>());
+        Solver.solve_with_solver(solverA, sol);
+
+        // same system, the assembled matrix is only the preconditioner. The multiplications write the
+        // iterates in the unknown v, that at the end contains the solution
+        petsc_solver<double> solverMF;
+        solverMF.setRestart(200);
+        solverMF.setAbsTol(1e-12);
+        solverMF.setRelTol(1e-10);
+
+        DCPSE_scheme<equations2d1,decltype(domain)> SolverMF(domain);
+        SolverMF.setMatrixFree(true);
+        SolverMF.impose(Lap(v), bulk, prop_id<1>());
+        SolverMF.impose(v, boundary, prop_id<1>());
+        SolverMF.solve_matrix_free(solverMF, &Solver.getA(options_solver::STANDARD), v);
+
+        double worst = 0.0;
+        auto it3 = domain.getDomainIterator();
+        while (it3.isNext()) {
+            auto p = it3.get();
+            worst = std::max(worst, fabs(domain.getProp<2>(p) - domain.getProp<0>(p)));
+            ++it3;
+        }
+
+        BOOST_REQUIRE(worst < 1e-6);
+
+        // same system imposed on the iterators of the subsets
+        petsc_solver<double> solverIt;
+        solverIt.setRestart(200);
+        solverIt.setAbsTol(1e-12);
+        solverIt.setRelTol(1e-10);
+
+        impose_git_prop1_b<decltype(domain)> rhs{domain};
+
+        DCPSE_scheme<equations2d1,decltype(domain)> SolverIt(domain);
+        SolverIt.setMatrixFree(true);
+        SolverIt.impose_git(Lap(v), rhs, 0, bulk.template getIteratorElements<0>());
+        SolverIt.impose_git(v, rhs, 0, boundary.template getIteratorElements<0>());
+        SolverIt.solve_matrix_free(solverIt, &Solver.getA(options_solver::STANDARD), v);
+
+        worst = 0.0;
+        auto it4 = domain.getDomainIterator();
+        while (it4.isNext()) {
+            auto p = it4.get();
+            worst = std::max(worst, fabs(domain.getProp<2>(p) - domain.getProp<0>(p)));
+            ++it4;
+        }
+
+        BOOST_REQUIRE(worst < 1e-6);
+    }
+
+    BOOST_AUTO_TEST_CASE(dcpse_poisson_Dirichlet_in_place) {
+        const size_t sz[2] = {41,41};
+        Box<2, double> box({0, 0}, {1, 1});
+        size_t bc[2] = {NON_PERIODIC, NON_PERIODIC};
+        double spacing = box.getHigh(0) / (sz[0] - 1);
+        Ghost<2, double> ghost(spacing * 3.1);
+        double rCut = 3.1 * spacing;
+
+        // one property, it is contiguous and the solution vector is created over it
+        vector_dist<2, double, aggregate<double>> domain(0, box, bc, ghost);
+
+        auto it = domain.getGridIterator(sz);
+        while (it.isNext()) {
+            domain.add();
+            auto key = it.get();
+            domain.getLastPos()[0] = key.get(0) * it.getSpacing(0);
+            domain.getLastPos()[1] = key.get(1) * it.getSpacing(1);
+            ++it;
+        }
+        domain.map();
+        domain.ghost_get<0>();
+
+        Laplacian Lap(domain, 2, rCut, 1.9, support_options::RADIUS);
+
+        openfpm::vector<aggregate<int>> bulk;
+        openfpm::vector<aggregate<int>> boundary;
+
+        auto v = getV<0>(domain);
+
+        auto it2 = domain.getDomainIterator();
+        while (it2.isNext()) {
+            auto p = it2.get();
+            Point<2, double> xp = domain.getPos(p);
+            bool isBoundary = false;
+            for (size_t k = 0; k < 2; k++)
+            {isBoundary |= xp.get(k) < spacing / 2.0 || xp.get(k) > box.getHigh(k) - spacing / 2.0;}
+
+            if (isBoundary) {
+                boundary.add();
+                boundary.last().get<0>() = p.getKey();
+            } else {
+                bulk.add();
+                bulk.last().get<0>() = p.getKey();
+            }
+            ++it2;
+        }
+
+        petsc_solver<double> solverA;
+        solverA.setAbsTol(1e-12);
+        solverA.setRelTol(1e-10);
+
+        DCPSE_scheme<equations2d1,decltype(domain)> Solver(domain);
+        Solver.impose(Lap(v), bulk, 1.0);
+        Solver.impose(v, boundary, 0.0);
+
+        Solver.solve_with_solver_in_place<0>(solverA);
+
+        openfpm::vector<double> inPlace;
+        auto it3 = domain.getDomainIterator();
+        while (it3.isNext()) {
+            inPlace.add(domain.getProp<0>(it3.get()));
+            ++it3;
+        }
+
+        Solver.solve_with_solver(solverA, v);
+
+        double worst = 0.0;
+        size_t k = 0;
+        auto it4 = domain.getDomainIterator();
+        while (it4.isNext()) {
+            worst = std::max(worst, fabs(domain.getProp<0>(it4.get()) - inPlace.get(k)));
+            k++;
+            ++it4;
+        }
+
+        BOOST_REQUIRE(worst < 1e-8);
+    }
+
+    BOOST_AUTO_TEST_CASE(dcpse_poisson_initial_guess_extrapolation) {
+        const size_t sz[2] = {41,41};
+        Box<2, double> box({0, 0}, {1, 1});
+        size_t bc[2] = {NON_PERIODIC, NON_PERIODIC};
+        double spacing = box.getHigh(0) / (sz[0] - 1);
+        Ghost<2, double> ghost(spacing * 3.1);
+        double rCut = 3.1 * spacing;
+
+        // unknown, right hand side, right hand side at t = 0, solution
+        vector_dist<2, double, aggregate<double,double,double,double>> domain(0, box, bc, ghost);
+
+        auto it = domain.getGridIterator(sz);
+        while (it.isNext()) {
+            domain.add();
+            auto key = it.get();
+            domain.getLastPos()[0] = key.get(0) * it.getSpacing(0);
+            domain.getLastPos()[1] = key.get(1) * it.getSpacing(1);
+            ++it;
+        }
+        domain.map();
+        domain.ghost_get<0>();
+
+        Laplacian Lap(domain, 2, rCut, 1.9, support_options::RADIUS);
+
+        openfpm::vector<aggregate<int>> bulk;
+        openfpm::vector<aggregate<int>> boundary;
+
+        auto v = getV<0>(domain);
+        auto sol = getV<3>(domain);
+
+        auto it2 = domain.getDomainIterator();
+        while (it2.isNext()) {
+            auto p = it2.get();
+            Point<2, double> xp = domain.getPos(p);
+            domain.getProp<2>(p) = -2*M_PI*M_PI*sin(M_PI*xp.get(0))*sin(M_PI*xp.get(1));
+            bool isBoundary = false;
+            for (size_t k = 0; k < 2; k++)
+            {isBoundary |= xp.get(k) < spacing / 2.0 || xp.get(k) > box.getHigh(k) - spacing / 2.0;}
+
+            if (isBoundary) {
+                boundary.add();
+                boundary.last().get<0>() = p.getKey();
+                domain.getProp<2>(p) = 0.0;
+            } else {
+                bulk.add();
+                bulk.last().get<0>() = p.getKey();
+            }
+            ++it2;
+        }
+
+        // k = 2 linear, k = 3 quadratic: the right hand side (and so the solution) is a polynomial
+        // of degree k-1 in t, the extrapolation of the previous solutions is already the solution
+        for (size_t k = 2; k <= 3; k++) {
+            auto g = [k](double t) {return (k == 2)?(1.0 + t):(1.0 + t + t*t);};
+
+            // coefficients of the extrapolation from the solutions at t = 0 ... k-1
+            openfpm::vector<double> c;
+            if (k == 2) {c.add(-1.0); c.add(2.0);}
+            else {c.add(1.0); c.add(-3.0); c.add(3.0);}
+
+            petsc_solver<double> solver;
+            solver.setAbsTol(1e-14);
+            solver.setRelTol(1e-11);
+
+            DCPSE_scheme<equations2d1,decltype(domain)> Solver(domain);
+            Solver.setInitialGuessExtrapolation(k);
+            Solver.impose(Lap(v), bulk, prop_id<1>());
+            Solver.impose(v, boundary, prop_id<1>());
+
+            openfpm::vector<openfpm::vector<double>> hist;
+
+            for (size_t t = 0; t <= k; t++) {
+                auto it3 = domain.getDomainIterator();
+                while (it3.isNext()) {
+                    auto p = it3.get();
+                    domain.getProp<1>(p) = g(t) * domain.getProp<2>(p);
+                    ++it3;
+                }
+
+                Solver.reset_b();
+                Solver.impose_b(bulk, prop_id<1>());
+                Solver.impose_b(boundary, prop_id<1>());
+
+                if (t < k) {
+                    Solver.solve_with_solver_extrapolated(solver, sol);
+
+                    hist.add();
+                    auto it4 = domain.getDomainIterator();
+                    while (it4.isNext()) {
+                        hist.last().add(domain.getProp<3>(it4.get()));
+                        ++it4;
+                    }
+                    continue;
+                }
+
+                solver.setRelTol(1e-6);
+
+                // same system from a zero initial guess
+                Solver.solve_with_solver(solver, sol);
+                size_t its_zero = solver.getMetrics().iterations;
+
+                Solver.solve_with_solver_extrapolated(solver, sol);
+                size_t its_extrapolated = solver.getMetrics().iterations;
+
+                // the guess already satisfy the tolerance, the solution returned is the guess
+                BOOST_REQUIRE(its_extrapolated == 0);
+                BOOST_REQUIRE(its_extrapolated < its_zero);
+
+                double worst = 0.0;
+                size_t i = 0;
+                auto it4 = domain.getDomainIterator();
+                while (it4.isNext()) {
+                    double guess = 0.0;
+                    for (size_t j = 0; j < k; j++)
+                    {guess += c.get(j) * hist.get(j).get(i);}
+
+                    worst = std::max(worst, fabs(domain.getProp<3>(it4.get()) - guess));
+                    i++;
+                    ++it4;
+                }
+
+                BOOST_REQUIRE(worst < 1e-12);
+            }
+        }
+    }
+
+    BOOST_AUTO_TEST_CASE(dcpse_block_assembly) {
+        const size_t sz[2] = {31,31};
+        Box<2, double> box({0, 0}, {1, 1});
+        size_t bc[2] = {NON_PERIODIC, NON_PERIODIC};
+        double spacing = box.getHigh(0) / (sz[0] - 1);
+        Ghost<2, double> ghost(spacing * 3.1);
+        double rCut = 3.1 * spacing;
+
+        vector_dist<2, double, aggregate<VectorS<2, double>,VectorS<2, double>,VectorS<2, double>>> domain(0, box, bc, ghost);
+
+        auto it = domain.getGridIterator(sz);
+        while (it.isNext()) {
+            domain.add();
+            auto key = it.get();
+            domain.getLastPos()[0] = key.get(0) * it.getSpacing(0);
+            domain.getLastPos()[1] = key.get(1) * it.getSpacing(1);
+            ++it;
+        }
+        domain.map();
+        domain.ghost_get<0>();
+
+        Laplacian Lap(domain, 2, rCut, 1.9, support_options::RADIUS);
+
+        openfpm::vector<aggregate<int>> bulk;
+        openfpm::vector<aggregate<int>> boundary;
+
+        auto v = getV<0>(domain);
+        auto RHS = getV<1>(domain);
+        auto sol = getV<2>(domain);
+
+        auto it2 = domain.getDomainIterator();
+        while (it2.isNext()) {
+            auto p = it2.get();
+            Point<2, double> xp = domain.getPos(p);
+            domain.getProp<1>(p)[0] = sin(M_PI*xp.get(0))*sin(M_PI*xp.get(1));
+            domain.getProp<1>(p)[1] = 1.0;
+            bool isBoundary = false;
+            for (size_t k = 0; k < 2; k++)
+            {isBoundary |= xp.get(k) < spacing / 2.0 || xp.get(k) > box.getHigh(k) - spacing / 2.0;}
+
+            if (isBoundary) {
+                boundary.add();
+                boundary.last().get<0>() = p.getKey();
+                domain.getProp<1>(p)[0] = 0.0;
+                domain.getProp<1>(p)[1] = 0.0;
+            } else {
+                bulk.add();
+                bulk.last().get<0>() = p.getKey();
+            }
+            ++it2;
+        }
+
+        eq_id vx,vy;
+        vx.setId(0);
+        vy.setId(1);
+
+        petsc_solver<double> solverM;
+        solverM.setSolver(KSPGMRES);
+        solverM.setPreconditioner(PCJACOBI);
+        solverM.setAbsTol(1e-12);
+        solverM.setRelTol(1e-12);
+
+        petsc_solver<double> solverB;
+        solverB.setSolver(KSPGMRES);
+        solverB.setPreconditioner(PCJACOBI);
+        solverB.setAbsTol(1e-12);
+        solverB.setRelTol(1e-12);
+
+        // the equation of v[0] (advection like block) change every step, the one of v[1] stay
+        DCPSE_scheme<equations2d2,decltype(domain)> SolverB(domain);
+        SolverB.setBlockAssembly(true);
+
+        SolverB.selectBlock("diffusion");
+        SolverB.impose(v[1] - 0.01*Lap(v[1]), bulk, RHS[1], vy);
+        SolverB.impose(v[1], boundary, RHS[1], vy);
+
+        for (int step = 0; step < 2; step++) {
+            double dt = 0.01 * (step + 1);
+
+            SolverB.reset_nodec();
+            SolverB.reset_block("advection");
+            SolverB.impose(v[0] - dt*Lap(v[0]) + 0.5*v[1], bulk, RHS[0], vx);
+            SolverB.impose(v[0], boundary, RHS[0], vx);
+            SolverB.impose_b(bulk, RHS[1], vy);
+            SolverB.impose_b(boundary, RHS[1], vy);
+            SolverB.solve_with_solver(solverB, v[0], v[1]);
+
+            DCPSE_scheme<equations2d2,decltype(domain)> SolverM(domain);
+            SolverM.impose(v[0] - dt*Lap(v[0]) + 0.5*v[1], bulk, RHS[0], vx);
+            SolverM.impose(v[0], boundary, RHS[0], vx);
+            SolverM.impose(v[1] - 0.01*Lap(v[1]), bulk, RHS[1], vy);
+            SolverM.impose(v[1], boundary, RHS[1], vy);
+            SolverM.solve_with_solver(solverM, sol[0], sol[1]);
+
+            double worst = 0.0;
+            auto it3 = domain.getDomainIterator();
+            while (it3.isNext()) {
+                auto p = it3.get();
+                for (size_t k = 0; k < 2; k++)
+                {worst = std::max(worst, fabs(domain.getProp<0>(p)[k] - domain.getProp<2>(p)[k]));}
+                ++it3;
+            }
+
+            BOOST_REQUIRE(worst < 1e-8);
+        }
+
+        // blocks (0,0) (0,1) (1,1) at the first step, only the two of the advection at the second
+        BOOST_REQUIRE_EQUAL(SolverB.getNBlockFills(), 5ul);
+    }
+
     BOOST_AUTO_TEST_CASE(dcpse_poisson_Periodic) {
         //https://fenicsproject.org/docs/dolfin/1.4.0/python/demo/documented/periodic/python/documentation.html
         //  int rank;
@@ -1391,6 +1824,95 @@ BOOST_AUTO_TEST_SUITE(dcpse_op_suite_tests)
     }
 
 
+    BOOST_AUTO_TEST_CASE(dcpse_imex_reaction_diffusion) {
+        const size_t sz[2] = {31, 31};
+        Box<2, double> box({0, 0}, {1.0, 1.0});
+        size_t bc[2] = {NON_PERIODIC, NON_PERIODIC};
+        double spacing = box.getHigh(0) / (sz[0] - 1);
+        Ghost<2, double> ghost(spacing * 3);
+        double rCut = 2.0 * spacing;
+
+        vector_dist<2, double, aggregate<double,double,double,double,double,double>> domain(0, box, bc, ghost);
+
+        auto it = domain.getGridIterator(sz);
+        while (it.isNext()) {
+            domain.add();
+
+            auto key = it.get();
+            double x = key.get(0) * it.getSpacing(0);
+            domain.getLastPos()[0] = x;
+            double y = key.get(1) * it.getSpacing(1);
+            domain.getLastPos()[1] = y;
+
+            ++it;
+        }
+
+        domain.map();
+        domain.ghost_get<0>();
+
+        Laplacian Lap(domain, 2, rCut, 2,support_options::N_PARTICLES);
+
+        openfpm::vector<aggregate<int>> bulk;
+        openfpm::vector<aggregate<int>> bnd;
+
+        Box<2, double> inner({box.getLow(0) + spacing / 2.0, box.getLow(1) + spacing / 2.0},
+                             {box.getHigh(0) - spacing / 2.0, box.getHigh(1) - spacing / 2.0});
+
+        auto it2 = domain.getDomainIterator();
+        while (it2.isNext()) {
+            auto p = it2.get();
+            Point<2, double> xp = domain.getPos(p);
+
+            domain.getProp<0>(p) = sin(M_PI*xp.get(0))*sin(M_PI*xp.get(1));
+
+            if (inner.isInside(xp) == true) {
+                bulk.add();
+                bulk.last().get<0>() = p.getKey();
+            } else {
+                bnd.add();
+                bnd.last().get<0>() = p.getKey();
+            }
+
+            ++it2;
+        }
+
+        DCPSE_scheme<equations2d1,decltype(domain)> Solver(domain);
+        petsc_solver<double> solver;
+        solver.setSolver(KSPGMRES);
+        solver.setPreconditioner(PCJACOBI);
+
+        auto u = getV<0>(domain);
+
+        // du/dt = u (explicit) + Lap(u) (implicit), u = 0 on the boundary
+        auto E = [&](auto e, double t) {e = u;};
+        auto A = [&](auto & S, double g_dt) {S.impose(u - g_dt*Lap(u), bulk, prop_id<1>()); S.impose(u, bnd, 0.0);};
+        auto B = [&](auto & S) {S.impose_b(bulk, prop_id<1>()); S.impose_b(bnd, 0.0);};
+
+        imex_ars222_dcpse<decltype(Solver),decltype(domain),0,1,2,3,4> imex(Solver,domain);
+
+        double t = 0.0;
+        double dt = 0.005;
+        for (int i = 0 ; i < 10 ; i++)
+        {
+            imex.do_step(solver,E,A,B,t,dt);
+            t += dt;
+        }
+
+        double decay = exp((1.0 - 2.0*M_PI*M_PI)*t);
+        double worst = 0.0;
+
+        for (int j = 0 ; j < bulk.size() ; j++)
+        {
+            auto p = bulk.get<0>(j);
+            Point<2, double> xp = domain.getPos(p);
+            double ana = decay*sin(M_PI*xp.get(0))*sin(M_PI*xp.get(1));
+
+            worst = std::max(worst,fabs(domain.getProp<0>(p) - ana));
+        }
+
+        BOOST_REQUIRE(worst < 1e-2*decay);
+    }
+
 BOOST_AUTO_TEST_SUITE_END()
 #endif
 #endif
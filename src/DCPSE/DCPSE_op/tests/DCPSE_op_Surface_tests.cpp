@@ -173,6 +173,80 @@ BOOST_AUTO_TEST_SUITE(dcpse_op_suite_tests)
         //Sparticles.write("Sparticles");
         //std::cout<<worst;
         BOOST_REQUIRE(worst < 0.03);
+}
+    BOOST_AUTO_TEST_CASE(dcpse_surface_circle_context) {
+        double boxP1{-1.5}, boxP2{1.5};
+        double boxSize{boxP2 - boxP1};
+        size_t n=512;
+        auto &v_cl=create_vcluster();
+        size_t sz[2] = {n,n};
+        double grid_spacing{boxSize/(sz[0]-1)};
+        double rCut{5.1 * grid_spacing};
+
+        Box<2,double> domain{{boxP1,boxP1},{boxP2,boxP2}};
+        size_t bc[2] = {NON_PERIODIC,NON_PERIODIC};
+        Ghost<2,double> ghost{rCut + grid_spacing/8.0};
+        vector_dist_ws<2, double, aggregate<double,double,double[2],double,double[2],double>> Sparticles(0, domain,bc,ghost);
+
+        const double pi{3.14159265358979323846};
+
+        double theta{0.0};
+        double dtheta{2*pi/double(n)};
+        if (v_cl.rank() == 0) {
+            for (int i = 0; i < n; ++i) {
+                Sparticles.add();
+                Sparticles.getLastPos()[0] = std::cos(theta);
+                Sparticles.getLastPos()[1] = std::sin(theta);
+                Sparticles.getLastProp<3>() = std::sin(theta);
+                Sparticles.getLastProp<2>()[0] = std::cos(theta);
+                Sparticles.getLastProp<2>()[1] = std::sin(theta);
+                Sparticles.getLastProp<1>() = -std::sin(theta);
+                Sparticles.getLastSubset(0);
+                theta += dtheta;
+            }
+        }
+        Sparticles.map();
+        Sparticles.ghost_get<0,3>();
+
+        size_t n_local = Sparticles.size_local();
+
+        // the operators of the context share the normal particles and the support
+        SurfaceDcpseContext<2,decltype(Sparticles)> ctx(Sparticles, 2, rCut, grid_spacing);
+        SurfaceDerivative_xx<2> SDxx(Sparticles, ctx);
+        SurfaceDerivative_yy<2> SDyy(Sparticles, ctx);
+        BOOST_REQUIRE_EQUAL(ctx.size(),2);
+        ctx.build();
+
+        BOOST_REQUIRE_EQUAL(Sparticles.size_local(),n_local);
+
+        SurfaceDerivative_xx<2> SDxx_s(Sparticles, 2, rCut,grid_spacing);
+        SurfaceDerivative_yy<2> SDyy_s(Sparticles, 2, rCut,grid_spacing);
+
+        auto INICONC = getV<3>(Sparticles);
+        auto CONC = getV<0>(Sparticles);
+        auto CONC_S = getV<5>(Sparticles);
+
+        CONC=SDxx(INICONC)+SDyy(INICONC);
+        CONC_S=SDxx_s(INICONC)+SDyy_s(INICONC);
+
+        auto it2 = Sparticles.getDomainIterator();
+        double worst = 0.0;
+        double diff = 0.0;
+        while (it2.isNext()) {
+            auto p = it2.get();
+            worst = std::max(worst,fabs(Sparticles.getProp<1>(p) - Sparticles.getProp<0>(p)));
+            diff = std::max(diff,fabs(Sparticles.getProp<5>(p) - Sparticles.getProp<0>(p)));
+            ++it2;
+        }
+        Sparticles.deleteGhost();
+
+        BOOST_REQUIRE(worst < 0.03);
+        BOOST_REQUIRE(diff < 1e-8);
+
+        SDxx.deallocate(Sparticles);
+        SDyy.deallocate(Sparticles);
+        SDxx_s.deallocate(Sparticles);
+        SDyy_s.deallocate(Sparticles);
 }
     BOOST_AUTO_TEST_CASE(dcpse_surface_solver_circle) {
         double boxP1{-1.5}, boxP2{1.5};
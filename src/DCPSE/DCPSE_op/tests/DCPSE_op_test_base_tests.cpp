@@ -24,6 +24,10 @@
 #include "Vector/vector_dist_subset.hpp"
 #include "DCPSE/DCPSE_op/EqnsStruct.hpp"
 #include "DCPSE/DcpseInterpolation.hpp"
+#include "DCPSE/DcpseFused.hpp"
+#include "DCPSE/DcpseAdvectionDiffusion.hpp"
+#include "DCPSE/DcpseComposed.hpp"
+#include "util/memory_report.hpp"
 
 BOOST_AUTO_TEST_SUITE(dcpse_op_suite_tests)
 BOOST_AUTO_TEST_CASE(dcpse_op_tests) {
@@ -96,6 +100,502 @@ BOOST_AUTO_TEST_CASE(dcpse_op_tests) {
 
     }
 
+    BOOST_AUTO_TEST_CASE(dcpse_op_soa_tests) {
+        size_t edgeSemiSize = 40;
+        const size_t sz[2] = {2 * edgeSemiSize, 2 * edgeSemiSize};
+        Box<2, double> box({0, 0}, {2 * M_PI, 2 * M_PI});
+        size_t bc[2] = {NON_PERIODIC, NON_PERIODIC};
+        double spacing[2];
+        spacing[0] = 2 * M_PI / (sz[0] - 1);
+        spacing[1] = 2 * M_PI / (sz[1] - 1);
+        Ghost<2, double> ghost(spacing[0] * 3.9);
+        double rCut = 3.9 * spacing[0];
+
+        // every property is a separate array
+        typedef vector_dist<2, double, aggregate<double, double, double, double>,
+                            CartDecomposition<2,double>, HeapMemory, memory_traits_inte> vector_type;
+        vector_type domain(0, box, bc, ghost);
+
+        auto it = domain.getGridIterator(sz);
+        while (it.isNext()) {
+            domain.add();
+            auto key = it.get();
+            domain.getLastPos()[0] = key.get(0) * spacing[0];
+            domain.getLastPos()[1] = key.get(1) * spacing[1];
+            domain.template getLastProp<0>() = sin(domain.getLastPos()[0]) + sin(domain.getLastPos()[1]);
+            domain.template getLastProp<2>() = 2*cos(domain.getLastPos()[0]) + cos(domain.getLastPos()[1]);
+            ++it;
+        }
+
+        domain.map();
+        domain.ghost_get<0>();
+
+        Derivative_x Dx(domain, 2, rCut);
+        Derivative_y Dy(domain, 2, rCut);
+        auto v = getV<1>(domain);
+        auto P = getV<0>(domain);
+
+        v = 2*Dx(P) + Dy(P);
+
+        // the same operator applied property to property
+        Point<2, unsigned int> p;
+        p.zero();
+        p.get(0) = 1;
+        Dcpse<2, vector_type> dcpse_x(domain, p, 2, rCut, dcpse_oversampling_factor, support_options::RADIUS);
+        dcpse_x.template computeDifferentialOperator<0,3>(domain);
+
+        auto it2 = domain.getDomainIterator();
+
+        double worst = 0.0;
+        double worst_dx = 0.0;
+
+        while (it2.isNext()) {
+            auto p = it2.get();
+
+            worst = std::max(worst,fabs(domain.getProp<1>(p) - domain.getProp<2>(p)));
+            worst_dx = std::max(worst_dx,fabs(domain.getProp<3>(p) - cos(domain.getPos(p)[0])));
+
+            ++it2;
+        }
+
+        domain.deleteGhost();
+        BOOST_REQUIRE(worst < 0.03);
+        BOOST_REQUIRE(worst_dx < 0.03);
+    }
+
+    BOOST_AUTO_TEST_CASE(dcpse_op_memory_usage_tests) {
+        size_t edgeSemiSize = 20;
+        const size_t sz[2] = {2 * edgeSemiSize, 2 * edgeSemiSize};
+        Box<2, double> box({0, 0}, {2 * M_PI, 2 * M_PI});
+        size_t bc[2] = {NON_PERIODIC, NON_PERIODIC};
+        double spacing[2];
+        spacing[0] = 2 * M_PI / (sz[0] - 1);
+        spacing[1] = 2 * M_PI / (sz[1] - 1);
+        Ghost<2, double> ghost(spacing[0] * 3.9);
+        double rCut = 3.9 * spacing[0];
+
+        vector_dist<2, double, aggregate<double, double>> domain(0, box, bc, ghost);
+
+        auto it = domain.getGridIterator(sz);
+        while (it.isNext()) {
+            domain.add();
+            auto key = it.get();
+            domain.getLastPos()[0] = key.get(0) * spacing[0];
+            domain.getLastPos()[1] = key.get(1) * spacing[1];
+            ++it;
+        }
+
+        domain.map();
+        domain.ghost_get<0>();
+
+        Point<2, unsigned int> p;
+        p.zero();
+        p.get(0) = 1;
+        Dcpse<2, decltype(domain)> dcpse_x(domain, p, 2, rCut, dcpse_oversampling_factor, support_options::RADIUS);
+
+        // at least the kernels, the supports and the two eps arrays
+        size_t lower = dcpse_x.getKernels().size() * sizeof(double) + dcpse_x.getLocalSupports().getMemoryUsage()
+                       + 2 * domain.size_local() * sizeof(double);
+        BOOST_REQUIRE(dcpse_x.getMemoryUsage() >= lower);
+
+        Derivative_x Dx(domain, 2, rCut);
+        Gradient Grad(domain, 2, rCut);
+        BOOST_REQUIRE_EQUAL(Dx.getMemoryUsage(domain), dcpse_x.getMemoryUsage());
+        BOOST_REQUIRE(Grad.getMemoryUsage(domain) >= 2 * lower);
+
+        memory_report rep;
+        rep.add("Dx", Dx.getMemoryUsage(domain));
+        rep.add("dcpse_x", dcpse_x);
+        rep.add("particles", particlesMemoryUsage(domain));
+        rep.reduce();
+
+        auto & v_cl = create_vcluster();
+        BOOST_REQUIRE_EQUAL(rep.size(), 3ul);
+        for (size_t i = 0; i < rep.size(); i++) {
+            BOOST_REQUIRE(rep.getMin(i) <= rep.getLocal(i));
+            BOOST_REQUIRE(rep.getMax(i) >= rep.getLocal(i));
+            BOOST_REQUIRE(rep.getSum(i) >= rep.getLocal(i));
+            BOOST_REQUIRE(rep.getSum(i) <= rep.getMax(i) * v_cl.size());
+        }
+
+        // the last entry is the total of the processors
+        BOOST_REQUIRE(rep.getMax(3) >= rep.getLocalTotal());
+
+        Dx.deallocate(domain);
+        Grad.deallocate(domain);
+    }
+
+    BOOST_AUTO_TEST_CASE(dcpse_op_fused_tests) {
+        size_t edgeSemiSize = 40;
+        const size_t sz[2] = {2 * edgeSemiSize, 2 * edgeSemiSize};
+        Box<2, double> box({0, 0}, {2 * M_PI, 2 * M_PI});
+        size_t bc[2] = {NON_PERIODIC, NON_PERIODIC};
+        double spacing[2];
+        spacing[0] = 2 * M_PI / (sz[0] - 1);
+        spacing[1] = 2 * M_PI / (sz[1] - 1);
+        Ghost<2, double> ghost(spacing[0] * 3.9);
+        double rCut = 3.9 * spacing[0];
+
+        typedef vector_dist<2, double, aggregate<double, double, double, double, double, double, double>> vector_type;
+        vector_type domain(0, box, bc, ghost);
+
+        auto it = domain.getGridIterator(sz);
+        while (it.isNext()) {
+            domain.add();
+            auto key = it.get();
+            domain.getLastPos()[0] = key.get(0) * spacing[0];
+            domain.getLastPos()[1] = key.get(1) * spacing[1];
+            domain.template getLastProp<0>() = sin(domain.getLastPos()[0]) + sin(domain.getLastPos()[1]);
+            ++it;
+        }
+
+        domain.map();
+        domain.ghost_get<0>();
+
+        Derivative_x Dx(domain, 2, rCut);
+        Derivative_y Dy(domain, 2, rCut);
+        Laplacian Lap(domain, 2, rCut);
+
+        DcpseFused<2,vector_type> fused(domain, 2, rCut);
+        fused.addOperator(0,Point<2,unsigned int>({1,0}));
+        fused.addOperator(1,Point<2,unsigned int>({0,1}));
+        fused.addOperator(2,Point<2,unsigned int>({2,0}));
+        fused.addOperator(2,Point<2,unsigned int>({0,2}));
+        fused.build();
+
+        auto P = getV<0>(domain);
+        auto dx = getV<4>(domain);
+        auto dy = getV<5>(domain);
+        auto lap = getV<6>(domain);
+
+        dx = Dx(P);
+        dy = Dy(P);
+        lap = Lap(P);
+
+        fused.compute<0,1,2,3>(domain);
+
+        double worst = 0.0;
+        auto it2 = domain.getDomainIterator();
+        while (it2.isNext()) {
+            auto p = it2.get();
+
+            worst = std::max(worst,fabs(domain.getProp<1>(p) - domain.getProp<4>(p)));
+            worst = std::max(worst,fabs(domain.getProp<2>(p) - domain.getProp<5>(p)));
+            worst = std::max(worst,fabs(domain.getProp<3>(p) - domain.getProp<6>(p)));
+
+            ++it2;
+        }
+
+        BOOST_REQUIRE(worst < 1e-8);
+    }
+
+    BOOST_AUTO_TEST_CASE(dcpse_op_advection_diffusion_tests) {
+        size_t edgeSemiSize = 40;
+        const size_t sz[2] = {2 * edgeSemiSize, 2 * edgeSemiSize};
+        Box<2, double> box({0, 0}, {2 * M_PI, 2 * M_PI});
+        size_t bc[2] = {NON_PERIODIC, NON_PERIODIC};
+        double spacing[2];
+        spacing[0] = 2 * M_PI / (sz[0] - 1);
+        spacing[1] = 2 * M_PI / (sz[1] - 1);
+        Ghost<2, double> ghost(spacing[0] * 3.9);
+        double rCut = 3.9 * spacing[0];
+
+        typedef vector_dist<2, double, aggregate<double, VectorS<2, double>, double, double>> vector_type;
+        vector_type domain(0, box, bc, ghost);
+
+        auto it = domain.getGridIterator(sz);
+        while (it.isNext()) {
+            domain.add();
+            auto key = it.get();
+            domain.getLastPos()[0] = key.get(0) * spacing[0];
+            domain.getLastPos()[1] = key.get(1) * spacing[1];
+            domain.template getLastProp<0>() = sin(domain.getLastPos()[0]) + sin(domain.getLastPos()[1]);
+            domain.template getLastProp<1>()[0] = cos(domain.getLastPos()[1]);
+            domain.template getLastProp<1>()[1] = sin(domain.getLastPos()[0]);
+            ++it;
+        }
+
+        domain.map();
+        domain.ghost_get<0,1>();
+
+        Advection Adv(domain, 2, rCut);
+        Laplacian Lap(domain, 2, rCut);
+
+        DcpseAdvectionDiffusion<2,vector_type> step(domain, Adv, Lap);
+        BOOST_REQUIRE(step.isSharedSupport());
+
+        double dt = 0.01, nu = 0.1;
+
+        auto P = getV<0>(domain);
+        auto v = getV<1>(domain);
+        auto ref = getV<3>(domain);
+
+        ref = P + dt * (nu * Lap(P) - Adv(v, P));
+
+        step.apply<0,1,2>(domain, dt, nu);
+
+        double worst = 0.0;
+        auto it2 = domain.getDomainIterator();
+        while (it2.isNext()) {
+            auto p = it2.get();
+
+            worst = std::max(worst,fabs(domain.getProp<2>(p) - domain.getProp<3>(p)));
+
+            ++it2;
+        }
+
+        BOOST_REQUIRE(worst < 1e-8);
+
+        // different supports, every operator sweeps its own
+        Laplacian LapS(domain, 2, 3.1 * spacing[0]);
+
+        DcpseAdvectionDiffusion<2,vector_type> stepS(domain, Adv, LapS);
+        BOOST_REQUIRE(stepS.isSharedSupport() == false);
+
+        ref = P + dt * (nu * LapS(P) - Adv(v, P));
+
+        stepS.apply<0,1,2>(domain, dt, nu);
+
+        worst = 0.0;
+        auto it3 = domain.getDomainIterator();
+        while (it3.isNext()) {
+            auto p = it3.get();
+
+            worst = std::max(worst,fabs(domain.getProp<2>(p) - domain.getProp<3>(p)));
+
+            ++it3;
+        }
+
+        BOOST_REQUIRE(worst < 1e-8);
+
+        Adv.deallocate(domain);
+        Lap.deallocate(domain);
+        LapS.deallocate(domain);
+    }
+
+    BOOST_AUTO_TEST_CASE(dcpse_op_float_kernels_tests) {
+        size_t edgeSemiSize = 40;
+        const size_t sz[2] = {2 * edgeSemiSize, 2 * edgeSemiSize};
+        Box<2, double> box({0, 0}, {2 * M_PI, 2 * M_PI});
+        size_t bc[2] = {NON_PERIODIC, NON_PERIODIC};
+        double spacing[2];
+        spacing[0] = 2 * M_PI / (sz[0] - 1);
+        spacing[1] = 2 * M_PI / (sz[1] - 1);
+        Ghost<2, double> ghost(spacing[0] * 3.9);
+        double rCut = 3.9 * spacing[0];
+
+        typedef vector_dist<2, double, aggregate<double, double, double, double, double>> vector_type;
+        vector_type domain(0, box, bc, ghost);
+
+        auto it = domain.getGridIterator(sz);
+        while (it.isNext()) {
+            domain.add();
+            auto key = it.get();
+            domain.getLastPos()[0] = key.get(0) * spacing[0];
+            domain.getLastPos()[1] = key.get(1) * spacing[1];
+            domain.template getLastProp<0>() = sin(domain.getLastPos()[0]) + sin(domain.getLastPos()[1]);
+            domain.template getLastProp<1>() = -sin(domain.getLastPos()[0]) - sin(domain.getLastPos()[1]);
+            ++it;
+        }
+
+        domain.map();
+        domain.ghost_get<0>();
+
+        Laplacian Lap(domain, 2, rCut);
+        Laplacian_T<Dcpse_float> LapF(domain, 2, rCut);
+
+        auto P = getV<0>(domain);
+        auto lap = getV<2>(domain);
+        auto lapF = getV<3>(domain);
+
+        lap = Lap(P);
+        lapF = LapF(P);
+
+        // Error against the analytical Laplacian in the interior
+        double worst = 0.0, worstF = 0.0;
+        auto it2 = domain.getDomainIterator();
+        while (it2.isNext()) {
+            auto p = it2.get();
+            Point<2, double> xp = domain.getPos(p);
+
+            if (xp[0] > 4 * spacing[0] && xp[0] < 2 * M_PI - 4 * spacing[0] &&
+                xp[1] > 4 * spacing[1] && xp[1] < 2 * M_PI - 4 * spacing[1]) {
+                worst = std::max(worst,fabs(domain.getProp<2>(p) - domain.getProp<1>(p)));
+                worstF = std::max(worstF,fabs(domain.getProp<3>(p) - domain.getProp<1>(p)));
+            }
+
+            ++it2;
+        }
+
+        // The float kernels must keep the discretization error of the double ones
+        BOOST_REQUIRE(worstF < 1.1 * worst + 1e-3);
+    }
+
+    BOOST_AUTO_TEST_CASE(dcpse_op_sparse_matrix_tests) {
+        // The Eigen backend assembles the matrix only on the master
+        if (create_vcluster().size() != 1) {
+            return;
+        }
+
+        size_t edgeSemiSize = 20;
+        const size_t sz[2] = {2 * edgeSemiSize, 2 * edgeSemiSize};
+        Box<2, double> box({0, 0}, {2 * M_PI, 2 * M_PI});
+        size_t bc[2] = {NON_PERIODIC, NON_PERIODIC};
+        double spacing[2];
+        spacing[0] = 2 * M_PI / (sz[0] - 1);
+        spacing[1] = 2 * M_PI / (sz[1] - 1);
+        Ghost<2, double> ghost(spacing[0] * 3.9);
+        double rCut = 3.9 * spacing[0];
+
+        typedef vector_dist<2, double, aggregate<double, double, double>> vector_type;
+        vector_type domain(0, box, bc, ghost);
+
+        auto it = domain.getGridIterator(sz);
+        while (it.isNext()) {
+            domain.add();
+            auto key = it.get();
+            domain.getLastPos()[0] = key.get(0) * spacing[0];
+            domain.getLastPos()[1] = key.get(1) * spacing[1];
+            domain.template getLastProp<0>() = sin(domain.getLastPos()[0]) + cos(domain.getLastPos()[1]);
+            ++it;
+        }
+
+        domain.map();
+        domain.ghost_get<0>();
+
+        Derivative_x Dx(domain, 2, rCut);
+        Laplacian Lap(domain, 2, rCut);
+
+        auto P = getV<0>(domain);
+        auto dx = getV<1>(domain);
+        auto lap = getV<2>(domain);
+        dx = Dx(P);
+        lap = Lap(P);
+
+        SparseMatrix<double, int, EIGEN_BASE> MDx;
+        SparseMatrix<double, int, EIGEN_BASE> MLap;
+        Dx.getSparseMatrix(domain, MDx);
+        Lap.getSparseMatrix(domain, MLap);
+
+        Eigen::VectorXd f(domain.size_local());
+        for (size_t i = 0; i < domain.size_local(); i++) {
+            f(i) = domain.getProp<0>(i);
+        }
+
+        Eigen::VectorXd dxM = MDx.getMat() * f;
+        Eigen::VectorXd lapM = MLap.getMat() * f;
+
+        for (size_t i = 0; i < domain.size_local(); i++) {
+            BOOST_REQUIRE_SMALL(dxM(i) - domain.getProp<1>(i), 1e-10);
+            BOOST_REQUIRE_SMALL(lapM(i) - domain.getProp<2>(i), 1e-10);
+        }
+    }
+
+    BOOST_AUTO_TEST_CASE(dcpse_op_composed_bilaplacian_tests) {
+        size_t edgeSemiSize = 20;
+        const size_t sz[2] = {2 * edgeSemiSize, 2 * edgeSemiSize};
+        Box<2, double> box({0, 0}, {2 * M_PI, 2 * M_PI});
+        size_t bc[2] = {NON_PERIODIC, NON_PERIODIC};
+        double spacing[2];
+        spacing[0] = 2 * M_PI / (sz[0] - 1);
+        spacing[1] = 2 * M_PI / (sz[1] - 1);
+        double rCut = 3.1 * spacing[0];
+        // The composed supports reach two times rCut
+        Ghost<2, double> ghost(2.0 * rCut + spacing[0]);
+
+        typedef vector_dist<2, double, aggregate<double, double, double>> vector_type;
+        vector_type domain(0, box, bc, ghost);
+
+        auto it = domain.getGridIterator(sz);
+        while (it.isNext()) {
+            domain.add();
+            auto key = it.get();
+            domain.getLastPos()[0] = key.get(0) * spacing[0];
+            domain.getLastPos()[1] = key.get(1) * spacing[1];
+            domain.template getLastProp<0>() = sin(domain.getLastPos()[0]) + sin(domain.getLastPos()[1]);
+            ++it;
+        }
+
+        domain.map();
+        domain.ghost_get<0>();
+
+        DcpseComposed<2, vector_type> bilap(domain, 2, rCut);
+        bilap.addProduct(Point<2, unsigned int>({2, 0}), Point<2, unsigned int>({2, 0}));
+        bilap.addProduct(Point<2, unsigned int>({2, 0}), Point<2, unsigned int>({0, 2}));
+        bilap.addProduct(Point<2, unsigned int>({0, 2}), Point<2, unsigned int>({2, 0}));
+        bilap.addProduct(Point<2, unsigned int>({0, 2}), Point<2, unsigned int>({0, 2}));
+        bilap.build();
+
+        bilap.compute<0, 1>(domain);
+
+        // Same operator applied in two sweeps
+        Laplacian Lap(domain, 2, rCut);
+        auto P = getV<0>(domain);
+        auto lap = getV<2>(domain);
+        lap = Lap(P);
+        domain.ghost_get<2>();
+        P = Lap(lap);
+
+        auto it2 = domain.getDomainIterator();
+        while (it2.isNext()) {
+            auto p = it2.get();
+            BOOST_REQUIRE_SMALL(domain.getProp<1>(p) - domain.getProp<0>(p), 1e-6);
+            ++it2;
+        }
+    }
+
+    BOOST_AUTO_TEST_CASE(dcpse_op_overlap_ghost_tests) {
+        size_t edgeSemiSize = 20;
+        const size_t sz[2] = {2 * edgeSemiSize, 2 * edgeSemiSize};
+        Box<2, double> box({0, 0}, {2 * M_PI, 2 * M_PI});
+        size_t bc[2] = {PERIODIC, PERIODIC};
+        double spacing[2];
+        spacing[0] = 2 * M_PI / sz[0];
+        spacing[1] = 2 * M_PI / sz[1];
+        Ghost<2, double> ghost(spacing[0] * 3.9);
+        double rCut = 3.9 * spacing[0];
+
+        typedef vector_dist<2, double, aggregate<double, double, double>> vector_type;
+        vector_type domain(0, box, bc, ghost);
+
+        auto it = domain.getGridIterator(sz);
+        while (it.isNext()) {
+            domain.add();
+            auto key = it.get();
+            domain.getLastPos()[0] = key.get(0) * spacing[0];
+            domain.getLastPos()[1] = key.get(1) * spacing[1];
+            domain.template getLastProp<0>() = 0.0;
+            ++it;
+        }
+
+        domain.map();
+        domain.ghost_get<0>();
+
+        Derivative_x Dx(domain, 2, rCut);
+
+        // The values change after the last ghost_get, the overlapped evaluation must exchange them
+        auto it2 = domain.getDomainIterator();
+        while (it2.isNext()) {
+            auto p = it2.get();
+            domain.getProp<0>(p) = sin(domain.getPos(p)[0]);
+            ++it2;
+        }
+
+        Dx.computeOverlap<0, 1>(domain);
+
+        domain.ghost_get<0>();
+        auto P = getV<0>(domain);
+        auto dx = getV<2>(domain);
+        dx = Dx(P);
+
+        auto it3 = domain.getDomainIterator();
+        while (it3.isNext()) {
+            auto p = it3.get();
+            BOOST_REQUIRE_SMALL(domain.getProp<1>(p) - domain.getProp<2>(p), 1e-10);
+            ++it3;
+        }
+    }
+
     BOOST_AUTO_TEST_CASE(dcpse_op_save_load) {
         size_t edgeSemiSize = 40;
         const size_t sz[2] = {2 * edgeSemiSize, 2 * edgeSemiSize};
@@ -299,6 +799,147 @@ BOOST_AUTO_TEST_CASE(dcpse_op_tests) {
         BOOST_REQUIRE(worst < 0.03);
     }
 
+    BOOST_AUTO_TEST_CASE(dcpse_op_tests_fa_multi) {
+        size_t edgeSemiSize = 40;
+        const size_t sz[2] = {2 * edgeSemiSize, 2 * edgeSemiSize};
+        Box<2, double> box({0, 0}, {2 * M_PI, 2 * M_PI});
+        size_t bc[2] = {NON_PERIODIC, NON_PERIODIC};
+        double spacing[2];
+        spacing[0] = 2 * M_PI / (sz[0] - 1);
+        spacing[1] = 2 * M_PI / (sz[1] - 1);
+        Ghost<2, double> ghost(spacing[0] * 3.9);
+        double rCut = 3.9 * spacing[0];
+
+        typedef vector_dist<2, double, aggregate<double, double, double, double, double>> vector_type;
+
+        vector_type domain(0, box,bc,ghost);
+
+        auto it = domain.getGridIterator(sz);
+        while (it.isNext()) {
+            domain.add();
+            auto key = it.get();
+            double x = key.get(0) * spacing[0];
+            double y = key.get(1) * spacing[1];
+            domain.getLastPos()[0] = x;
+            domain.getLastPos()[1] = y;
+            domain.template getLastProp<0>() = sin(x) + sin(y);
+            domain.template getLastProp<2>() = cos(x) + cos(y);
+            ++it;
+        }
+
+        domain.map();
+        domain.ghost_get<0,2>();
+
+        PPInterpolation<vector_type,vector_type> Fx(domain,domain, 2, rCut);
+
+        // both fields in one sweep, then the second one alone as reference
+        Fx.p2p<0,1,2,3>();
+        Fx.p2p<2,4>();
+
+        auto it2 = domain.getDomainIterator();
+        double worst = 0.0;
+        double diff = 0.0;
+        while (it2.isNext()) {
+            auto p = it2.get();
+            worst = std::max(worst,fabs(domain.getProp<1>(p) - domain.getProp<0>(p)));
+            worst = std::max(worst,fabs(domain.getProp<3>(p) - domain.getProp<2>(p)));
+            diff = std::max(diff,fabs(domain.getProp<3>(p) - domain.getProp<4>(p)));
+            ++it2;
+        }
+        domain.deleteGhost();
+        BOOST_REQUIRE(worst < 0.03);
+        BOOST_REQUIRE_EQUAL(diff,0.0);
+        Fx.deallocate();
+    }
+
+    BOOST_AUTO_TEST_CASE(dcpse_op_tests_context) {
+        size_t edgeSemiSize = 40;
+        const size_t sz[2] = {2 * edgeSemiSize, 2 * edgeSemiSize};
+        Box<2, double> box({0, 0}, {2 * M_PI, 2 * M_PI});
+        size_t bc[2] = {NON_PERIODIC, NON_PERIODIC};
+        double spacing[2];
+        spacing[0] = 2 * M_PI / (sz[0] - 1);
+        spacing[1] = 2 * M_PI / (sz[1] - 1);
+        Ghost<2, double> ghost(spacing[0] * 3.9);
+        double rCut = 3.9 * spacing[0];
+
+        typedef vector_dist<2, double, aggregate<double, double, double, double, double, VectorS<2, double>, VectorS<2, double>>> vector_type;
+
+        vector_type domain(0, box,bc,ghost);
+
+        auto it = domain.getGridIterator(sz);
+        while (it.isNext()) {
+            domain.add();
+            auto key = it.get();
+            double x = key.get(0) * spacing[0];
+            double y = key.get(1) * spacing[1];
+            domain.getLastPos()[0] = x;
+            domain.getLastPos()[1] = y;
+            domain.template getLastProp<0>() = sin(x) * sin(y);
+            ++it;
+        }
+
+        domain.map();
+        domain.ghost_get<0>();
+
+        // gradient, Laplacian and Hessian with one support and one factorization per differential order
+        DcpseContext<vector_type> ctx(domain, 2, rCut);
+        Gradient Grad(domain, ctx);
+        Laplacian Lap(domain, ctx);
+        Derivative_xy Dxy(domain, ctx);
+        BOOST_REQUIRE_EQUAL(ctx.size(),5);
+        ctx.build();
+
+        // the same operators constructed one by one
+        Derivative_x Dx_r(domain, 2, rCut);
+        Derivative_y Dy_r(domain, 2, rCut);
+        Derivative_xx Dxx_r(domain, 2, rCut);
+        Derivative_yy Dyy_r(domain, 2, rCut);
+        Derivative_xy Dxy_r(domain, 2, rCut);
+
+        auto P = getV<0>(domain);
+        auto L = getV<1>(domain);
+        auto L_r = getV<2>(domain);
+        auto H = getV<3>(domain);
+        auto H_r = getV<4>(domain);
+        auto G = getV<5>(domain);
+        auto G_r = getV<6>(domain);
+
+        L = Lap(P);
+        L_r = Dxx_r(P) + Dyy_r(P);
+        H = Dxy(P);
+        H_r = Dxy_r(P);
+        G = Grad(P);
+        G_r[0] = Dx_r(P);
+        G_r[1] = Dy_r(P);
+
+        auto it2 = domain.getDomainIterator();
+        double diff = 0.0;
+        while (it2.isNext()) {
+            auto p = it2.get();
+            diff = std::max(diff,fabs(domain.getProp<1>(p) - domain.getProp<2>(p)));
+            diff = std::max(diff,fabs(domain.getProp<3>(p) - domain.getProp<4>(p)));
+            diff = std::max(diff,fabs(domain.getProp<5>(p)[0] - domain.getProp<6>(p)[0]));
+            diff = std::max(diff,fabs(domain.getProp<5>(p)[1] - domain.getProp<6>(p)[1]));
+            ++it2;
+        }
+        BOOST_REQUIRE(diff < 1e-8);
+
+        // after a rebuild the kernels are the same
+        ctx.update();
+        H = Dxy(P);
+
+        diff = 0.0;
+        auto it3 = domain.getDomainIterator();
+        while (it3.isNext()) {
+            auto p = it3.get();
+            diff = std::max(diff,fabs(domain.getProp<3>(p) - domain.getProp<4>(p)));
+            ++it3;
+        }
+        domain.deleteGhost();
+        BOOST_REQUIRE(diff < 1e-8);
+    }
+
     BOOST_AUTO_TEST_CASE(dcpse_op_tests_mfa) {
         size_t edgeSemiSize = 40;
         const size_t sz[2] = {2 * edgeSemiSize, 2 * edgeSemiSize};
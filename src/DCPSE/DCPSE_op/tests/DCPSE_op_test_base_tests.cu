@@ -24,6 +24,8 @@
 #include "Vector/vector_dist_subset.hpp"
 #include "DCPSE/DCPSE_op/EqnsStruct.hpp"
 #include "DCPSE/DcpseInterpolation.hpp"
+#include "DCPSE/DcpseAdvectionDiffusion.hpp"
+#include "util/gpu_step_graph.hpp"
 
 BOOST_AUTO_TEST_SUITE(dcpse_op_suite_tests_cu)
 BOOST_AUTO_TEST_CASE(dcpse_op_tests) {
@@ -96,6 +98,63 @@ BOOST_AUTO_TEST_CASE(dcpse_op_tests) {
 
     }
 
+    BOOST_AUTO_TEST_CASE(dcpse_op_tests_nearest_gpu_support) {
+        size_t edgeSemiSize = 40;
+        const size_t sz[2] = {2 * edgeSemiSize, 2 * edgeSemiSize};
+        Box<2, double> box({0, 0}, {2 * M_PI, 2 * M_PI});
+        size_t bc[2] = {NON_PERIODIC, NON_PERIODIC};
+        double spacing[2];
+        spacing[0] = 2 * M_PI / (sz[0] - 1);
+        spacing[1] = 2 * M_PI / (sz[1] - 1);
+        Ghost<2, double> ghost(spacing[0] * 3.9);
+        // smaller than the supports, the cells are enlarged on the device until they contain the nearest particles
+        double rCut = 1.1 * spacing[0];
+
+        vector_dist_gpu<2, double, aggregate<double, double, double, VectorS<2, double>, VectorS<2, double>>> domain(0, box,
+                                                                                                                 bc,
+                                                                                                                 ghost);
+
+        auto it = domain.getGridIterator(sz);
+        while (it.isNext()) {
+            domain.add();
+            auto key = it.get();
+            mem_id k0 = key.get(0);
+            double x = k0 * spacing[0];
+            domain.getLastPos()[0] = x;
+            mem_id k1 = key.get(1);
+            double y = k1 * spacing[1];
+            domain.getLastPos()[1] = y;
+            domain.template getLastProp<0>() = sin(domain.getLastPos()[0]) + sin(domain.getLastPos()[1]);
+            domain.template getLastProp<2>() = 2*cos(domain.getLastPos()[0]) + cos(domain.getLastPos()[1]);
+            ++it;
+        }
+
+        domain.map();
+        domain.ghost_get<0>();
+        Derivative_x_gpu Dx(domain, 2, rCut, 1.9, support_options::N_PARTICLES);
+        Derivative_y_gpu Dy(domain, 2, rCut, 1.9, support_options::AT_LEAST_N_PARTICLES);
+        auto v = getV<1>(domain);
+        auto P = getV<0>(domain);
+
+        v = 2*Dx(P) + Dy(P);
+        auto it2 = domain.getDomainIterator();
+
+        double worst = 0.0;
+
+        while (it2.isNext()) {
+            auto p = it2.get();
+
+            if (fabs(domain.getProp<1>(p) - domain.getProp<2>(p)) > worst) {
+                worst = fabs(domain.getProp<1>(p) - domain.getProp<2>(p));
+            }
+
+            ++it2;
+        }
+
+        domain.deleteGhost();
+        BOOST_REQUIRE(worst < 0.03);
+    }
+
     BOOST_AUTO_TEST_CASE(dcpse_op_save_load) {
         size_t edgeSemiSize = 40;
         const size_t sz[2] = {2 * edgeSemiSize, 2 * edgeSemiSize};
@@ -984,6 +1043,302 @@ BOOST_AUTO_TEST_CASE(dcpse_op_tests) {
 
 
 
+    BOOST_AUTO_TEST_CASE(dcpse_op_gpu_warp_apply_3d) {
+        const size_t sz[3] = {33, 33, 33};
+        Box<3, double> box({0, 0, 0}, {1, 1, 1});
+        size_t bc[3] = {NON_PERIODIC, NON_PERIODIC, NON_PERIODIC};
+        double spacing = box.getHigh(0) / (sz[0] - 1);
+        Ghost<3, double> ghost(spacing * 3.1);
+        double rCut = 3.1 * spacing;
+
+        typedef vector_dist_gpu<3, double, aggregate<double, double, double, double>> vector_type;
+        vector_type Particles(0, box, bc, ghost);
+
+        auto it = Particles.getGridIterator(sz);
+        while (it.isNext()) {
+            Particles.add();
+            auto key = it.get();
+            for (size_t k = 0; k < 3; k++)
+                Particles.getLastPos()[k] = key.get(k) * it.getSpacing(k);
+            Particles.getLastProp<0>() = sin(Particles.getLastPos()[0]) + sin(Particles.getLastPos()[1]) + sin(Particles.getLastPos()[2]);
+            ++it;
+        }
+
+        Particles.map();
+        Particles.ghost_get<0>();
+        Particles.hostToDeviceProp<0>();
+
+        // The three operators of the 3D Laplacian
+        Dcpse_gpu<3, vector_type> Dxx(Particles, Point<3, unsigned int>({2, 0, 0}), 2, rCut, 1.9, support_options::RADIUS);
+        Dcpse_gpu<3, vector_type> Dyy(Particles, Dxx, Point<3, unsigned int>({0, 2, 0}), 2, rCut, 1.9, support_options::RADIUS);
+        Dcpse_gpu<3, vector_type> Dzz(Particles, Dxx, Point<3, unsigned int>({0, 0, 2}), 2, rCut, 1.9, support_options::RADIUS);
+        Dcpse_gpu<3, vector_type> * ops[3] = {&Dxx, &Dyy, &Dzz};
+
+        // the thread per particle kernel is the reference of the warp and interleaved kernels
+        double err = 0.0, errInterleaved = 0.0;
+        for (size_t d = 0; d < 3; d++) {
+            ops[d]->computeDifferentialOperatorGPU<0, 1>(Particles);
+            ops[d]->computeDifferentialOperatorWarpGPU<0, 2>(Particles);
+
+            // the first call builds the interleaved layout, the second use it
+            ops[d]->computeDifferentialOperatorInterleavedGPU<0, 3>(Particles);
+            ops[d]->computeDifferentialOperatorInterleavedGPU<0, 3>(Particles);
+
+            Particles.deviceToHostProp<1, 2, 3>();
+            auto it2 = Particles.getDomainIterator();
+            while (it2.isNext()) {
+                auto p = it2.get();
+                err = std::max(err, fabs(Particles.getProp<1>(p) - Particles.getProp<2>(p)));
+                errInterleaved = std::max(errInterleaved, fabs(Particles.getProp<1>(p) - Particles.getProp<3>(p)));
+                ++it2;
+            }
+        }
+
+        BOOST_REQUIRE(err < 1e-8);
+        BOOST_REQUIRE(errInterleaved < 1e-8);
+    }
+
+    BOOST_AUTO_TEST_CASE(dcpse_op_gpu_multi_device_construction) {
+        const size_t sz[2] = {81, 81};
+        Box<2, double> box({0, 0}, {1, 1});
+        size_t bc[2] = {NON_PERIODIC, NON_PERIODIC};
+        double spacing = box.getHigh(0) / (sz[0] - 1);
+        Ghost<2, double> ghost(spacing * 3.1);
+        double rCut = 3.1 * spacing;
+
+        typedef vector_dist_gpu<2, double, aggregate<double, double, double>> vector_type;
+        vector_type Particles(0, box, bc, ghost);
+
+        auto it = Particles.getGridIterator(sz);
+        while (it.isNext()) {
+            Particles.add();
+            auto key = it.get();
+            Particles.getLastPos()[0] = key.get(0) * it.getSpacing(0);
+            Particles.getLastPos()[1] = key.get(1) * it.getSpacing(1);
+            Particles.getLastProp<0>() = sin(Particles.getLastPos()[0]) * cos(Particles.getLastPos()[1]);
+            ++it;
+        }
+
+        Particles.map();
+        Particles.ghost_get<0>();
+        Particles.hostToDeviceProp<0>();
+
+        Dcpse_gpu<2, vector_type> Dx(Particles, Point<2, unsigned int>({1, 0}), 2, rCut, 1.9, support_options::RADIUS);
+        Dcpse_gpu<2, vector_type> DxMulti(Particles, Point<2, unsigned int>({1, 0}), 2, rCut, 1.9, support_options::RADIUS);
+
+        // every device of the node shares the construction, with one device the rows are still solved as one chunk
+        int nDev = 0;
+        cudaGetDeviceCount(&nDev);
+        std::vector<int> devs;
+        for (int d = 0; d < nDev; d++) devs.push_back(d);
+        DxMulti.setDevices(devs);
+        DxMulti.initializeUpdate(Particles);
+
+        Dx.computeDifferentialOperatorGPU<0, 1>(Particles);
+        DxMulti.computeDifferentialOperatorGPU<0, 2>(Particles);
+        Particles.deviceToHostProp<1, 2>();
+
+        double err = 0.0;
+        auto it2 = Particles.getDomainIterator();
+        while (it2.isNext()) {
+            auto p = it2.get();
+            err = std::max(err, fabs(Particles.getProp<1>(p) - Particles.getProp<2>(p)));
+            ++it2;
+        }
+
+        BOOST_REQUIRE(err < 1e-10);
+    }
+
+    BOOST_AUTO_TEST_CASE(dcpse_op_gpu_float_precision) {
+        const size_t sz[2] = {81, 81};
+        Box<2, double> box({0, 0}, {1, 1});
+        size_t bc[2] = {NON_PERIODIC, NON_PERIODIC};
+        double spacing = box.getHigh(0) / (sz[0] - 1);
+        Ghost<2, double> ghost(spacing * 3.1);
+        double rCut = 3.1 * spacing;
+
+        typedef vector_dist_gpu<2, double, aggregate<double, double, double, double>> vector_type;
+        vector_type Particles(0, box, bc, ghost);
+
+        auto it = Particles.getGridIterator(sz);
+        while (it.isNext()) {
+            Particles.add();
+            auto key = it.get();
+            Particles.getLastPos()[0] = key.get(0) * it.getSpacing(0);
+            Particles.getLastPos()[1] = key.get(1) * it.getSpacing(1);
+            Particles.getLastProp<0>() = sin(Particles.getLastPos()[0]) * cos(Particles.getLastPos()[1]);
+            ++it;
+        }
+
+        Particles.map();
+        Particles.ghost_get<0>();
+        Particles.hostToDeviceProp<0>();
+
+        // the double operators are the reference of the float ones
+        Point<2, unsigned int> sig[2] = {Point<2, unsigned int>({1, 0}), Point<2, unsigned int>({2, 0})};
+        for (size_t s = 0; s < 2; s++) {
+            Dcpse_gpu<2, vector_type> Dd(Particles, sig[s], 2, rCut, 1.9, support_options::RADIUS);
+            Dcpse_gpu_float<2, vector_type> Df(Particles, sig[s], 2, rCut, 1.9, support_options::RADIUS);
+            Dcpse_gpu_float_comp<2, vector_type> Dc(Particles, sig[s], 2, rCut, 1.9, support_options::RADIUS);
+
+            Dd.computeDifferentialOperatorGPU<0, 1>(Particles);
+            Df.computeDifferentialOperatorGPU<0, 2>(Particles);
+            Dc.computeDifferentialOperatorWarpGPU<0, 3>(Particles);
+            Particles.deviceToHostProp<1, 2, 3>();
+
+            double maxD = 0.0, errF = 0.0, errC = 0.0;
+            auto it2 = Particles.getDomainIterator();
+            while (it2.isNext()) {
+                auto p = it2.get();
+                maxD = std::max(maxD, fabs(Particles.getProp<1>(p)));
+                errF = std::max(errF, fabs(Particles.getProp<1>(p) - Particles.getProp<2>(p)));
+                errC = std::max(errC, fabs(Particles.getProp<1>(p) - Particles.getProp<3>(p)));
+                ++it2;
+            }
+
+            BOOST_REQUIRE(errF / maxD < 1e-3);
+            BOOST_REQUIRE(errC / maxD < 1e-3);
+        }
+    }
+
+    BOOST_AUTO_TEST_CASE(dcpse_op_gpu_step_graph) {
+        const size_t sz[2] = {65, 65};
+        Box<2, double> box({0, 0}, {1, 1});
+        size_t bc[2] = {NON_PERIODIC, NON_PERIODIC};
+        double spacing = box.getHigh(0) / (sz[0] - 1);
+        Ghost<2, double> ghost(spacing * 3.1);
+        double rCut = 3.1 * spacing;
+
+        typedef vector_dist_gpu<2, double, aggregate<double, double, double, double>> vector_type;
+        vector_type Particles(0, box, bc, ghost);
+
+        auto it = Particles.getGridIterator(sz);
+        while (it.isNext()) {
+            Particles.add();
+            auto key = it.get();
+            Particles.getLastPos()[0] = key.get(0) * it.getSpacing(0);
+            Particles.getLastPos()[1] = key.get(1) * it.getSpacing(1);
+            Particles.getLastProp<0>() = sin(Particles.getLastPos()[0]) * cos(Particles.getLastPos()[1]);
+            ++it;
+        }
+
+        Particles.map();
+        Particles.ghost_get<0>();
+        Particles.hostToDeviceProp<0>();
+
+        Dcpse_gpu<2, vector_type> Dx(Particles, Point<2, unsigned int>({1, 0}), 2, rCut, 1.9, support_options::RADIUS);
+        Dcpse_gpu<2, vector_type> Dy(Particles, Dx, Point<2, unsigned int>({0, 1}), 2, rCut, 1.9, support_options::RADIUS);
+
+        auto dFx = getV<1, comp_dev>(Particles);
+        auto dFy = getV<2, comp_dev>(Particles);
+        auto G = getV<3, comp_dev>(Particles);
+
+        gpu_step_graph step([&]() {
+            Dx.computeDifferentialOperatorGPU<0, 1>(Particles);
+            Dy.computeDifferentialOperatorGPU<0, 2>(Particles);
+            G = dFx + dFy;
+        });
+
+        // the replays give the result of the launches run one by one
+        for (size_t i = 0; i < 3; i++)
+            step.run();
+        step.synchronize();
+        cudaDeviceSynchronize();
+        Particles.deviceToHostProp<3>();
+
+        openfpm::vector<double> ref;
+        auto it2 = Particles.getDomainIterator();
+        while (it2.isNext()) {
+            ref.add(Particles.getProp<3>(it2.get()));
+            ++it2;
+        }
+
+        G = 0.0;
+        Dx.computeDifferentialOperatorGPU<0, 1>(Particles);
+        Dy.computeDifferentialOperatorGPU<0, 2>(Particles);
+        G = dFx + dFy;
+        cudaDeviceSynchronize();
+        Particles.deviceToHostProp<3>();
+
+        double err = 0.0;
+        size_t i = 0;
+        auto it3 = Particles.getDomainIterator();
+        while (it3.isNext()) {
+            err = std::max(err, fabs(ref.get(i) - Particles.getProp<3>(it3.get())));
+            ++i;
+            ++it3;
+        }
+
+        std::cout << "GPU step replayed from a graph: " << (step.isCaptured() ? "yes" : "no") << std::endl;
+        BOOST_REQUIRE(err < 1e-14);
+    }
+
+    BOOST_AUTO_TEST_CASE(dcpse_op_gpu_advection_diffusion) {
+        const size_t sz[2] = {81, 81};
+        Box<2, double> box({0, 0}, {2 * M_PI, 2 * M_PI});
+        size_t bc[2] = {NON_PERIODIC, NON_PERIODIC};
+        double spacing = box.getHigh(0) / (sz[0] - 1);
+        Ghost<2, double> ghost(spacing * 3.9);
+        double rCut = 3.9 * spacing;
+
+        typedef vector_dist_gpu<2, double, aggregate<double, VectorS<2, double>, double, double>> vector_type;
+        vector_type domain(0, box, bc, ghost);
+
+        auto it = domain.getGridIterator(sz);
+        while (it.isNext()) {
+            domain.add();
+            auto key = it.get();
+            domain.getLastPos()[0] = key.get(0) * it.getSpacing(0);
+            domain.getLastPos()[1] = key.get(1) * it.getSpacing(1);
+            domain.getLastProp<0>() = sin(domain.getLastPos()[0]) + sin(domain.getLastPos()[1]);
+            domain.getLastProp<1>()[0] = cos(domain.getLastPos()[1]);
+            domain.getLastProp<1>()[1] = sin(domain.getLastPos()[0]);
+            ++it;
+        }
+
+        domain.map();
+        domain.ghost_get<0,1>();
+        domain.hostToDeviceProp<0,1>();
+
+        Advection_gpu Adv(domain, 2, rCut);
+        Laplacian_gpu Lap(domain, 2, rCut);
+        Laplacian_gpu LapS(domain, 2, 3.1 * spacing);
+
+        double dt = 0.01, nu = 0.1;
+
+        auto P = getV<0>(domain);
+        auto v = getV<1>(domain);
+        auto ref = getV<3>(domain);
+
+        // shared support (one sweep) and different supports
+        for (size_t s = 0; s < 2; s++) {
+            Laplacian_gpu & L = (s == 0) ? Lap : LapS;
+
+            DcpseAdvectionDiffusion_gpu<2, vector_type> step(domain, Adv, L);
+            BOOST_REQUIRE(step.isSharedSupport() == (s == 0));
+
+            ref = P + dt * (nu * L(P) - Adv(v, P));
+
+            step.apply<0,1,2>(domain, dt, nu);
+            cudaDeviceSynchronize();
+            domain.deviceToHostProp<2>();
+
+            double worst = 0.0;
+            auto it2 = domain.getDomainIterator();
+            while (it2.isNext()) {
+                auto p = it2.get();
+                worst = std::max(worst, fabs(domain.getProp<2>(p) - domain.getProp<3>(p)));
+                ++it2;
+            }
+
+            BOOST_REQUIRE(worst < 1e-8);
+        }
+
+        Adv.deallocate(domain);
+        Lap.deallocate(domain);
+        LapS.deallocate(domain);
+    }
+
 BOOST_AUTO_TEST_SUITE_END()
 
 
@@ -14,8 +14,10 @@
 #include "Vandermonde.hpp"
 #include "DcpseDiagonalScalingMatrix.hpp"
 #include "DcpseRhs.hpp"
+#include "initialize/numerics_backends.hpp"
 
 #include <chrono>
+#include <memory>
 
 // CUDA
 #include <cuda.h>
@@ -24,14 +26,163 @@
 
 
 template<unsigned int dim, typename particles_type, typename T, typename monomialBasis_type, typename supportKey_type, typename localEps_type, typename calcKernels_type>
-__global__ void calcKernels_gpu(particles_type, monomialBasis_type, supportKey_type, supportKey_type, T**, localEps_type, size_t, calcKernels_type);
+__global__ void calcKernels_gpu(particles_type, monomialBasis_type, supportKey_type, supportKey_type, T**, localEps_type, size_t, size_t, calcKernels_type);
+
+template<typename T>
+__global__ void setBatchPointers_gpu(T**, T**, T*, T*, size_t, size_t);
+
+template<unsigned int fValuePos, unsigned int DfValuePos, bool compensated, typename particles_type, typename T>
+__global__ void computeDifferentialOperator_gpu(particles_type, const size_t*, const size_t*, const T*, const T*, T, size_t);
+
+template<unsigned int fValuePos, unsigned int DfValuePos, unsigned int subWarp, unsigned int blockSize, unsigned int stageSize, bool compensated, typename particles_type, typename T>
+__global__ void computeDifferentialOperatorWarp_gpu(particles_type, const size_t*, const size_t*, const T*, const T*, T, size_t, size_t);
+
+template<unsigned int fValuePos, unsigned int DfValuePos, unsigned int tileSize, bool compensated, typename particles_type, typename T>
+__global__ void computeDifferentialOperatorInterleaved_gpu(particles_type, const size_t*, const size_t*, const T*, const T*, T, size_t);
 
 template<unsigned int dim, typename T, typename particles_type, typename monomialBasis_type, typename supportKey_type, typename localEps_type, typename matrix_type>
 __global__ void assembleLocalMatrices_gpu( particles_type, Point<dim, unsigned int>, unsigned int, monomialBasis_type, supportKey_type, supportKey_type, supportKey_type,
-    T**, T**, localEps_type, localEps_type, matrix_type, size_t, size_t);
+    T**, T**, localEps_type, localEps_type, matrix_type, size_t, size_t, size_t);
+
+/*! \brief Device arrays of a Dcpse_gpu for the kernels that apply several operators together
+ *
+ * The support of the particle p is keys[kerOffsets[p]] ... keys[kerOffsets[p+1]-1], the kernel of the neighbour i is
+ * kernels[i] and the epsilon prefactor of p is epsInvPow[p]
+ *
+ */
+template<typename T>
+struct dcpse_gpu_rows
+{
+    const size_t * kerOffsets;
+    const size_t * keys;
+    const T * kernels;
+    const T * epsInvPow;
+};
+
+/*! \brief Device buffers used to solve the moment systems of a range of rows on one device
+ *
+ * \tparam T floating point type
+ *
+ */
+template<typename T>
+struct dcpse_gpu_work
+{
+    //! device of the buffers
+    int device;
+
+    //! stream of the construction on the device, 0 is the default stream
+    cudaStream_t stream = 0;
+
+    //! first row and number of rows solved on the device
+    size_t rowStart = 0;
+    size_t nRows = 0;
+
+    openfpm::vector_custd<T> BMat;
+    openfpm::vector_custd<T> AMat;
+    openfpm::vector_custd<T> bVec;
+    openfpm::vector_custd<T*> AMatPointers;
+    openfpm::vector_custd<T*> bVecPointers;
+    openfpm::vector_custd<int> infoArray;
+
+    cublasHandle_t cublas_handle;
+    bool cublasCreated = false;
+
+    dcpse_gpu_work(int device, bool ownStream)
+    :device(device)
+    {
+        if (ownStream == true)
+        {
+            cudaSetDevice(device);
+            cudaStreamCreate(&stream);
+        }
+    }
+
+    ~dcpse_gpu_work()
+    {
+        // the buffers are released after this body, on the device that owns them
+        cudaSetDevice(device);
+        if (cublasCreated == true)
+        {cublasDestroy_v2(cublas_handle);}
+        if (stream != 0)
+        {cudaStreamDestroy(stream);}
+    }
+};
 
+/*! \brief Sum of the terms of a DCPSE operator on one particle
+ *
+ * With compensated the rounding error of every addition is carried along (Kahan summation), so that a sum
+ * in float keeps the accuracy of the kernels when the support is large. It must not be compiled with
+ * -use_fast_math or other flags that reassociate floating point additions
+ *
+ */
+template<typename T, bool compensated>
+struct dcpse_sum_gpu
+{
+    T sum = 0;
+
+    __device__ __host__ inline void add(T x)
+    {sum += x;}
+
+    __device__ __host__ inline T value() const
+    {return sum;}
+};
+
+template<typename T>
+struct dcpse_sum_gpu<T,true>
+{
+    T sum = 0;
+    T c = 0;
 
-template<unsigned int dim, typename vector_type, class T = typename vector_type::stype>
+    __device__ __host__ inline void add(T x)
+    {
+        T y = x - c;
+        T t = sum + y;
+        c = (t - sum) - y;
+        sum = t;
+    }
+
+    __device__ __host__ inline T value() const
+    {return sum - c;}
+};
+
+/*! \brief Offset xp - xq in the precision T of the operator
+ *
+ * The difference is taken in the precision of the positions and only the (small) offset is rounded to T
+ *
+ */
+template<typename T, unsigned int dim, typename particles_type>
+__device__ inline Point<dim,T> supportOffset_gpu(particles_type & particles, size_t xp, size_t xq)
+{
+    Point<dim,T> off;
+    for (size_t j = 0; j < dim; ++j)
+        off.get(j) = (T)(particles.getPos(xp)[j] - particles.getPosOrig(xq)[j]);
+
+    return off;
+}
+
+//! x^n for the integer powers of the construction, without a pow in double for T=float
+template<typename T>
+__device__ __host__ inline T ipow_gpu(T x, unsigned int n)
+{
+    T res = 1;
+    for (unsigned int i = 0; i < n; ++i)
+        res *= x;
+
+    return res;
+}
+
+
+/*! \brief DCPSE operator constructed and applied on the device
+ *
+ * \tparam dim dimensionality
+ * \tparam vector_type particle set
+ * \tparam T precision of the moment systems, of the kernels and of the sums of computeDifferentialOperatorGPU.
+ *         It can be float with double particles (see Dcpse_gpu_float): the offsets are taken in the precision
+ *         of the positions and rounded to T, the results are written in the properties of the particles
+ * \tparam compensated the device application uses a compensated (Kahan) sum, see dcpse_sum_gpu
+ *
+ */
+template<unsigned int dim, typename vector_type, class T = typename vector_type::stype, bool compensated = false>
 class Dcpse_gpu {
     static_assert(std::is_floating_point<T>::value, "CUBLAS supports only float or double");
 
@@ -77,6 +228,24 @@ private:
 
     support_options opt;
 
+    // Device buffers of the construction, kept between updates so that they are reallocated only when they grow
+    openfpm::vector_custd<Monomial_gpu<dim>> basisGpu;
+    openfpm::vector_custd<size_t> supportSizeBuf;
+    openfpm::vector_custd<size_t> maxSupportBuf;
+
+    // device holding the particles and the results
+    int homeDevice = -1;
+
+    // devices sharing the construction of the kernels, one set of buffers for each of them
+    std::vector<int> devices;
+    std::vector<std::unique_ptr<dcpse_gpu_work<T>>> deviceWork;
+
+    // interleaved copy of the supports and of the kernels, see buildInterleavedLayout
+    static constexpr unsigned int tileSize = 32;
+    openfpm::vector_custd<size_t> tileOffsets;
+    openfpm::vector_custd<size_t> supportKeysIL;
+    openfpm::vector_custd<T> calcKernelsIL;
+
 public:
 #ifdef SE_CLASS1
     int getUpdateCtr() const
@@ -101,12 +270,13 @@ public:
             supportKeysTotalN(0),
             opt(opt)
     {
+        numerics_backends::ensure_device();
         particles.ghost_get_subset();
         initializeStaticSize(particles, convergenceOrder, rCut, supportSizeFactor);
     }
 
     Dcpse_gpu(vector_type &particles,
-          const Dcpse_gpu<dim, vector_type, T>& other,
+          const Dcpse_gpu<dim, vector_type, T, compensated>& other,
           Point<dim, unsigned int> differentialSignature,
           unsigned int convergenceOrder,
           T rCut,
@@ -124,10 +294,86 @@ public:
             supportKeysTotalN(other.supportKeysTotalN),
             isSharedSupport(true)
     {
+        numerics_backends::ensure_device();
         particles.ghost_get_subset();
         initializeStaticSize(particles, convergenceOrder, rCut, supportSizeFactor);
     }
 
+    ~Dcpse_gpu()
+    {
+        // the buffers of every device are released on their own device
+        int current;
+        cudaGetDevice(&current);
+        deviceWork.clear();
+        cudaSetDevice(current);
+    }
+
+    /*! \brief Share the construction of the kernels among several devices of this rank
+     *
+     * The rows of the operator are split in contiguous chunks, one for each device. Every device assembles
+     * and solves the moment systems of its chunk on its own stream, reading the positions and the supports
+     * on the device of the particles (the current device) through peer-to-peer access, and writes eps and
+     * the kernels there. The particles, the supports and the kernels stay on the current device, so the
+     * application of the operator and the ghost exchange are unchanged. Devices without peer access to the
+     * current device are skipped. The devices are used from the next initializeUpdate
+     *
+     * \param devs devices to use, the current device should be one of them
+     *
+     */
+    void setDevices(const std::vector<int> & devs)
+    {
+        cudaGetDevice(&homeDevice);
+
+        devices.clear();
+        deviceWork.clear();
+        for (size_t i = 0; i < devs.size(); i++) {
+            if (devs[i] != homeDevice) {
+                int canAccess = 0;
+                cudaDeviceCanAccessPeer(&canAccess, devs[i], homeDevice);
+                if (canAccess == 0) {
+                    std::cerr << __FILE__ << ":" << __LINE__ << " warning, device " << devs[i] << " cannot access device " << homeDevice << " peer-to-peer, it is not used" << std::endl;
+                    continue;
+                }
+
+                cudaSetDevice(devs[i]);
+                cudaError_t err = cudaDeviceEnablePeerAccess(homeDevice, 0);
+                if (err == cudaErrorPeerAccessAlreadyEnabled) {cudaGetLastError();}
+            }
+            devices.push_back(devs[i]);
+        }
+        cudaSetDevice(homeDevice);
+    }
+
+    //! Devices sharing the construction of the kernels (empty when only the current device is used)
+    const std::vector<int> & getDevices() const
+    {
+        return devices;
+    }
+
+    /*! \brief Memory used by the operator in byte
+     *
+     * Supports, kernels, eps arrays, interleaved layout and construction buffers. The buffers are mirrored, the
+     * same amount is allocated on the host and on the device
+     *
+     * \return the memory in byte
+     *
+     */
+    size_t getMemoryUsage() const
+    {
+        size_t mem = (supportRefs.size() + kerOffsets.size() + supportKeys1D.size() + subsetKeyPid.size()
+                      + supportSizeBuf.size() + maxSupportBuf.size() + tileOffsets.size() + supportKeysIL.size())*sizeof(size_t)
+                     + (localEps.size() + localEpsInvPow.size() + calcKernels.size() + calcKernelsIL.size())*sizeof(T)
+                     + basisGpu.size()*sizeof(Monomial_gpu<dim>);
+
+        for (size_t i = 0; i < deviceWork.size(); i++) {
+            const dcpse_gpu_work<T> & w = *deviceWork[i];
+            mem += (w.BMat.size() + w.AMat.size() + w.bVec.size())*sizeof(T)
+                   + (w.AMatPointers.size() + w.bVecPointers.size())*sizeof(T*) + w.infoArray.size()*sizeof(int);
+        }
+
+        return mem;
+    }
+
     template<unsigned int prp>
     void DrawKernel(vector_type &particles, int k)
     {
@@ -202,7 +448,7 @@ public:
             }
 
             size_t xpK = supportRefs.get(j);
-            Point<dim, T> xp = particles.getPos(xpK);
+            Point<dim, typename vector_type::stype> xp = particles.getPos(xpK);
 
             size_t kerOff = kerOffsets.get(xpK);
             size_t  supportKeysSize = kerOffsets.get(j+1)-kerOffsets.get(j);
@@ -211,8 +457,8 @@ public:
             for (int i = 0; i < supportKeysSize; i++)
             {
                 size_t xqK = supportKeys[i];
-                Point<dim, T> xq = particles.getPos(xqK);
-                Point<dim, T> normalizedArg = (xp - xq) / eps;
+                Point<dim, typename vector_type::stype> xq = particles.getPos(xqK);
+                Point<dim, typename vector_type::stype> normalizedArg = (xp - xq) / eps;
 
                 auto ker = calcKernels.get(kerOff+i);
 
@@ -292,6 +538,136 @@ public:
         }
     }
 
+    //! Device pointers to the supports, the kernels and the epsilon prefactors
+    dcpse_gpu_rows<T> getDeviceRows() {
+        dcpse_gpu_rows<T> rows;
+        rows.kerOffsets = (const size_t*) kerOffsets.toKernel().getPointer();
+        rows.keys = (const size_t*) supportKeys1D.toKernel().getPointer();
+        rows.kernels = (const T*) calcKernels.toKernel().getPointer();
+        rows.epsInvPow = (const T*) localEpsInvPow.toKernel().getPointer();
+        return rows;
+    }
+
+    //! True if other has the same supports (compared on the host copies)
+    bool hasSameSupport(const Dcpse_gpu & other) const {
+        if (kerOffsets.size() != other.kerOffsets.size() || supportKeys1D.size() != other.supportKeys1D.size())
+            return false;
+
+        for (size_t i = 0; i < kerOffsets.size(); i++) {
+            if (kerOffsets.get(i) != other.kerOffsets.get(i)) return false;
+        }
+        for (size_t i = 0; i < supportKeys1D.size(); i++) {
+            if (supportKeys1D.get(i) != other.supportKeys1D.get(i)) return false;
+        }
+        return true;
+    }
+
+    /*! \brief Like computeDifferentialOperator, evaluated on the device with one thread per particle
+     *
+     * fValuePos (local and ghost) must be on the device, DfValuePos is left on the device
+     *
+     */
+    template<unsigned int fValuePos, unsigned int DfValuePos>
+    void computeDifferentialOperatorGPU(vector_type &particles) {
+        size_t N = particles.size_local();
+        if (N == 0) return;
+
+        T sign = (differentialOrder % 2 == 0) ? -1 : 1;
+        size_t nBlocks = (N + 255) / 256;
+        computeDifferentialOperator_gpu<fValuePos,DfValuePos,compensated><<<nBlocks, 256>>>(particles.toKernel(),
+            (const size_t*) kerOffsets.toKernel().getPointer(), (const size_t*) supportKeys1D.toKernel().getPointer(),
+            (const T*) calcKernels.toKernel().getPointer(), (const T*) localEpsInvPow.toKernel().getPointer(), sign, N);
+    }
+
+    /*! \brief Like computeDifferentialOperatorGPU, subWarp threads cooperate on the support of one particle
+     *
+     * Every block stages in shared memory the values of fValuePos of a window of keys centred on its particles,
+     * the neighbours inside the window are read from shared memory and the others from global memory. With the
+     * particles sorted in space (see reorderParticlesForDcpse) most of the neighbours fall in the window
+     *
+     * \tparam subWarp threads per particle (power of 2, at most 32)
+     *
+     */
+    template<unsigned int fValuePos, unsigned int DfValuePos, unsigned int subWarp = 8>
+    void computeDifferentialOperatorWarpGPU(vector_type &particles) {
+        static_assert(subWarp != 0 && subWarp <= 32 && (subWarp & (subWarp - 1)) == 0, "subWarp must be a power of 2 not bigger than the warp");
+        constexpr unsigned int blockSize = 256;
+        constexpr unsigned int stageSize = 2048;
+
+        size_t N = particles.size_local();
+        if (N == 0) return;
+
+        T sign = (differentialOrder % 2 == 0) ? -1 : 1;
+        size_t nBlocks = (N + blockSize / subWarp - 1) / (blockSize / subWarp);
+        computeDifferentialOperatorWarp_gpu<fValuePos,DfValuePos,subWarp,blockSize,stageSize,compensated><<<nBlocks, blockSize>>>(particles.toKernel(),
+            (const size_t*) kerOffsets.toKernel().getPointer(), (const size_t*) supportKeys1D.toKernel().getPointer(),
+            (const T*) calcKernels.toKernel().getPointer(), (const T*) localEpsInvPow.toKernel().getPointer(), sign, N,
+            particles.size_local_with_ghost());
+    }
+
+    /*! \brief Copy the supports and the kernels in an interleaved layout
+     *
+     * The particles are grouped in tiles of 32 (one warp), the neighbour j of the particles of a tile are
+     * adjacent, and the supports of a tile are padded to the largest one in the tile with the particle itself
+     * and a zero kernel. The copy is built on the host, moved to the device, and kept until the next
+     * initializeUpdate or load. It costs the padding in memory on top of the 1D layout
+     *
+     */
+    void buildInterleavedLayout() {
+        size_t N = supportRefs.size();
+        size_t nTiles = (N + tileSize - 1) / tileSize;
+
+        tileOffsets.resize(nTiles + 1);
+        tileOffsets.get(0) = 0;
+        for (size_t b = 0; b < nTiles; b++) {
+            size_t maxSize = 0;
+            for (size_t p = b * tileSize; p < std::min((b + 1) * tileSize, N); p++)
+                maxSize = std::max(maxSize, kerOffsets.get(p+1) - kerOffsets.get(p));
+            tileOffsets.get(b+1) = tileOffsets.get(b) + maxSize * tileSize;
+        }
+
+        supportKeysIL.resize(tileOffsets.get(nTiles));
+        calcKernelsIL.resize(tileOffsets.get(nTiles));
+        for (size_t b = 0; b < nTiles; b++) {
+            size_t maxSize = (tileOffsets.get(b+1) - tileOffsets.get(b)) / tileSize;
+            for (size_t lane = 0; lane < tileSize; lane++) {
+                size_t p = b * tileSize + lane;
+                size_t kerOff = (p < N) ? kerOffsets.get(p) : 0;
+                size_t supportSize = (p < N) ? kerOffsets.get(p+1) - kerOff : 0;
+
+                for (size_t j = 0; j < maxSize; j++) {
+                    size_t k = tileOffsets.get(b) + j * tileSize + lane;
+                    supportKeysIL.get(k) = (j < supportSize) ? supportKeys1D.get(kerOff + j) : ((p < N) ? p : 0);
+                    calcKernelsIL.get(k) = (j < supportSize) ? calcKernels.get(kerOff + j) : 0;
+                }
+            }
+        }
+
+        tileOffsets.template hostToDevice();
+        supportKeysIL.template hostToDevice();
+        calcKernelsIL.template hostToDevice();
+    }
+
+    /*! \brief Like computeDifferentialOperatorGPU, on the interleaved layout (see buildInterleavedLayout)
+     *
+     * The threads of a warp read adjacent keys and kernels at every step of the loop on the support. The layout
+     * is built at the first call
+     *
+     */
+    template<unsigned int fValuePos, unsigned int DfValuePos>
+    void computeDifferentialOperatorInterleavedGPU(vector_type &particles) {
+        size_t N = particles.size_local();
+        if (N == 0) return;
+
+        if (tileOffsets.size() == 0) buildInterleavedLayout();
+
+        T sign = (differentialOrder % 2 == 0) ? -1 : 1;
+        size_t nBlocks = (N + 255) / 256;
+        computeDifferentialOperatorInterleaved_gpu<fValuePos,DfValuePos,tileSize,compensated><<<nBlocks, 256>>>(particles.toKernel(),
+            (const size_t*) tileOffsets.toKernel().getPointer(), (const size_t*) supportKeysIL.toKernel().getPointer(),
+            (const T*) calcKernelsIL.toKernel().getPointer(), (const T*) localEpsInvPow.toKernel().getPointer(), sign, N);
+    }
+
 
     /*! \brief Get the number of neighbours
      *
@@ -379,7 +755,6 @@ public:
 
         expr_type Dfxp = 0;
         size_t xpK = supportRefs.get(localKey);
-        Point<dim, T> xp = particles.getPos(xpK);
         expr_type fxp = sign * o1.value(key);
         size_t kerOff = kerOffsets.get(xpK);
 
@@ -436,8 +811,6 @@ public:
 
         expr_type Dfxp = 0;
         size_t xpK = supportRefs.get(localKey);
-
-        Point<dim, T> xp = particles.getPos(xpK);
         expr_type fxp = sign * o1.value(key)[i];
         size_t kerOff = kerOffsets.get(xpK);
         size_t  supportKeysSize = kerOffsets.get(localKey+1)-kerOffsets.get(localKey);
@@ -469,6 +842,7 @@ public:
         localEpsInvPow.clear();
         calcKernels.clear();
         subsetKeyPid.clear();
+        tileOffsets.clear();
 
         initializeStaticSize(particles, convergenceOrder, rCut, supportSizeFactor);
     }
@@ -564,6 +938,13 @@ public:
         Unpacker<decltype(localEpsInvPow),CudaMemory>::unpack(mem,localEpsInvPow,ps);
         Unpacker<decltype(calcKernels),CudaMemory>::unpack(mem,calcKernels,ps);
         Unpacker<decltype(subsetKeyPid),CudaMemory>::unpack(mem,subsetKeyPid,ps);
+        tileOffsets.clear();
+
+        // the device evaluation reads the kernels on the device
+        kerOffsets.template hostToDevice();
+        supportKeys1D.template hostToDevice();
+        calcKernels.template hostToDevice();
+        localEpsInvPow.template hostToDevice();
     }
 
 private:
@@ -589,7 +970,10 @@ private:
 std::chrono::high_resolution_clock::time_point t1 = std::chrono::high_resolution_clock::now();
         auto it = particles.getDomainIterator();
 
-        if (opt==support_options::RADIUS) {
+        // The positions are moved once, all the construction stages read them on the device
+        particles.hostToDevicePos();
+
+        if (SupportBuilderGPU<vector_type>::isSupported(opt)) {
             if (!isSharedSupport) {
                 while (it.isNext()) {
                     auto key_o = it.get(); subsetKeyPid.get(particles.getOriginKey(key_o).getKey()) = key_o.getKey();
@@ -597,8 +981,9 @@ std::chrono::high_resolution_clock::time_point t1 = std::chrono::high_resolution
                     ++it;
                 }
 
-                SupportBuilderGPU<vector_type> supportBuilder(particles, rCut);
-                supportBuilder.getSupport(supportRefs.size(), kerOffsets, supportKeys1D, maxSupportSize, supportKeysTotalN);
+                size_t requiredSupportSize = monomialBasis.size() * supportSizeFactor;
+                SupportBuilderGPU<vector_type> supportBuilder(particles, rCut, opt, requiredSupportSize);
+                supportBuilder.getSupportDevice(supportRefs.size(), kerOffsets, supportKeys1D, maxSupportSize, supportKeysTotalN, supportSizeBuf, maxSupportBuf);
             }
         } else {
             if (!isSharedSupport){
@@ -630,15 +1015,13 @@ std::chrono::high_resolution_clock::time_point t1 = std::chrono::high_resolution
                     for (size_t j = 0; j < tempSupportKeys.get(i).size(); ++j, ++offset)
                         supportKeys1D.get(offset) = tempSupportKeys.get(i).get(j);
             }
-
-            kerOffsets.hostToDevice(); supportKeys1D.hostToDevice();
         }
 
+        assembleLocalMatrices_t(rCut);
+
 std::chrono::high_resolution_clock::time_point t2 = std::chrono::high_resolution_clock::now();
 std::chrono::duration<double> time_span2 = std::chrono::duration_cast<std::chrono::duration<double>>(t2 - t1);
-std::cout << "Support building took " << time_span2.count() * 1000. << " milliseconds." << std::endl;
-
-        assembleLocalMatrices_t(rCut);
+std::cout << "DCPSE GPU construction took " << time_span2.count() * 1000. << " milliseconds." << std::endl;
     }
 
     // Cublas subroutine selector: float or double
@@ -652,103 +1035,134 @@ std::cout << "Support building took " << time_span2.count() * 1000. << " millise
     void assembleLocalMatrices_t(double rCut) {
         assembleLocalMatrices(cublasDgetrfBatched, cublasDtrsmBatched); }
 
+    /*! \brief Assemble and solve the moment systems and compute the kernels
+     *
+     * All the stages are launched on one stream without synchronisation in between: the support
+     * offsets, the batch pointers, eps and the solutions stay on the device. The results are copied to the
+     * host once at the end. The device buffers are members and are reused by initializeUpdate. When
+     * several devices are set with setDevices the rows are split among them and the devices run concurrently
+     *
+     */
     template<typename cublasLUDec_type, typename cublasTriangSolve_type>
     void assembleLocalMatrices(cublasLUDec_type cublasLUDecFunc, cublasTriangSolve_type cublasTriangSolveFunc) {
-        std::chrono::high_resolution_clock::time_point t3 = std::chrono::high_resolution_clock::now();
-
-        // move monomial basis to kernel
-        auto& basis = monomialBasis.getBasis();
-        openfpm::vector_custd<Monomial_gpu<dim>> basisTemp(basis.begin(), basis.end());
-        basisTemp.template hostToDevice();
-        MonomialBasis<dim, aggregate<Monomial_gpu<dim>>, openfpm::vector_custd_ker, memory_traits_inte> monomialBasisKernel(basisTemp.toKernel());
+        // the monomial basis does not change between updates
+        if (basisGpu.size() == 0) {
+            auto& basis = monomialBasis.getBasis();
+            basisGpu.resize(basis.size());
+            size_t i = 0;
+            for (auto m = basis.begin(); m != basis.end(); ++m, ++i) basisGpu.get(i) = *m;
+            basisGpu.template hostToDevice();
+        }
+        MonomialBasis<dim, aggregate<Monomial_gpu<dim>>, openfpm::vector_custd_ker, memory_traits_inte> monomialBasisKernel(basisGpu.toKernel());
 
         size_t numMatrices = supportRefs.size();
-        size_t monomialBasisSize = monomialBasis.size();
 
-        int numSMs, numSMsMult = 1;
-        cudaDeviceGetAttribute(&numSMs, cudaDevAttrMultiProcessorCount, 0);
-        size_t numThreads = numSMs*numSMsMult*256;
-        std::cout << "numThreads " << numThreads << " numMatrices " << numMatrices << std::endl;
-
-        // B is an intermediate matrix
-        openfpm::vector_custd<T> BMat(numThreads * maxSupportSize * monomialBasisSize);
-        // allocate device space for A, b
-        openfpm::vector_custd<T> AMat(numMatrices*monomialBasisSize*monomialBasisSize);
-        openfpm::vector_custd<T> bVec(numMatrices*monomialBasisSize);
+        localEps.resize(numMatrices);
+        localEpsInvPow.resize(numMatrices);
+        calcKernels.resize(supportKeysTotalN);
+        if (numMatrices == 0) return;
 
-        // create array of pointers to pass T** pointers to cublas subroutines
-        openfpm::vector_custd<T*> AMatPointers(numMatrices);
-        openfpm::vector_custd<T*> bVecPointers(numMatrices);
+        supportRefs.template hostToDevice();
+        if (opt != support_options::RADIUS || isSharedSupport) {
+            kerOffsets.template hostToDevice();
+            supportKeys1D.template hostToDevice();
+        }
 
-        auto AMatKernel = AMat.toKernel(); T* AMatKernelPointer = (T*) AMatKernel.getPointer();
-        for (size_t i = 0; i < numMatrices; i++) AMatPointers.get(i) = AMatKernelPointer + i*monomialBasisSize*monomialBasisSize;
+        if (homeDevice < 0) cudaGetDevice(&homeDevice);
 
-        auto bVecKernel = bVec.toKernel(); T* bVecKernelPointer = (T*) bVecKernel.getPointer();
-        for (size_t i = 0; i < numMatrices; i++) bVecPointers.get(i) = bVecKernelPointer + i*monomialBasisSize;
+        if (deviceWork.size() == 0) {
+            if (devices.size() <= 1)
+                deviceWork.emplace_back(new dcpse_gpu_work<T>(homeDevice, false));
+            else
+                for (size_t d = 0; d < devices.size(); d++)
+                    deviceWork.emplace_back(new dcpse_gpu_work<T>(devices[d], true));
+        }
 
-        std::chrono::high_resolution_clock::time_point t1 = std::chrono::high_resolution_clock::now();
-        std::chrono::duration<double> time_span0 = std::chrono::duration_cast<std::chrono::duration<double>>(t1 - t3);
-        std::cout << "Preallocation took " << time_span0.count() * 1000. << " milliseconds." << std::endl;
+        // the other devices read what the home device produced on the default stream
+        if (deviceWork.size() > 1) cudaDeviceSynchronize();
 
-        // assemble local matrices on GPU
-        std::chrono::high_resolution_clock::time_point t9 = std::chrono::high_resolution_clock::now();
-        particles.hostToDevicePos();
-        supportRefs.template hostToDevice();
-        AMatPointers.template hostToDevice();
-        bVecPointers.template hostToDevice();
+        size_t chunk = (numMatrices + deviceWork.size() - 1) / deviceWork.size();
+        for (size_t d = 0; d < deviceWork.size(); d++) {
+            dcpse_gpu_work<T> & w = *deviceWork[d];
+            w.rowStart = std::min(d*chunk, numMatrices);
+            w.nRows = std::min(chunk, numMatrices - w.rowStart);
+            if (w.nRows != 0) assembleRows(w, monomialBasisKernel, cublasLUDecFunc, cublasTriangSolveFunc);
+        }
 
-        auto AMatPointersKernel = AMatPointers.toKernel(); T** AMatPointersKernelPointer = (T**) AMatPointersKernel.getPointer();
-        auto bVecPointersKernel = bVecPointers.toKernel(); T** bVecPointersKernelPointer = (T**) bVecPointersKernel.getPointer();
+        for (size_t d = 0; d < deviceWork.size(); d++) {
+            dcpse_gpu_work<T> & w = *deviceWork[d];
+            if (w.nRows == 0) continue;
 
-        assembleLocalMatrices_gpu<<<numSMsMult*numSMs, 256>>>(particles.toKernel(), differentialSignature, differentialOrder, monomialBasisKernel, supportRefs.toKernel(), kerOffsets.toKernel(), supportKeys1D.toKernel(),
-            AMatPointersKernelPointer, bVecPointersKernelPointer, localEps.toKernel(), localEpsInvPow.toKernel(), BMat.toKernel(), numMatrices, maxSupportSize);
+            cudaSetDevice(w.device);
+            cudaStreamSynchronize(w.stream);
+            w.infoArray.template deviceToHost();
+            for (size_t i = 0; i < w.nRows; i++)
+                if (w.infoArray.get(i) != 0) fprintf(stderr, "Factorization of matrix %d Failed: Matrix may be singular\n", (int)(w.rowStart + i));
+        }
+        cudaSetDevice(homeDevice);
 
+        // the only synchronisation of the home device: the results are needed on the host
+        calcKernels.template deviceToHost();
         localEps.template deviceToHost();
         localEpsInvPow.template deviceToHost();
+        if (opt == support_options::RADIUS && !isSharedSupport) {
+            kerOffsets.template deviceToHost();
+            supportKeys1D.template deviceToHost();
+        }
+    }
 
-        std::chrono::high_resolution_clock::time_point t10 = std::chrono::high_resolution_clock::now();
-        std::chrono::duration<double> time_span3 = std::chrono::duration_cast<std::chrono::duration<double>>(t10 - t9);
-        std::cout << "assembleLocalMatrices_gpu took " << time_span3.count() * 1000. << " milliseconds." << std::endl;
+    /*! \brief Assemble, solve and compute the kernels of the rows [w.rowStart, w.rowStart+w.nRows) on the device of w
+     *
+     * Everything is launched on the stream of w, nothing is synchronised
+     *
+     */
+    template<typename monomialBasisKernel_type, typename cublasLUDec_type, typename cublasTriangSolve_type>
+    void assembleRows(dcpse_gpu_work<T> & w, monomialBasisKernel_type & monomialBasisKernel,
+                      cublasLUDec_type cublasLUDecFunc, cublasTriangSolve_type cublasTriangSolveFunc) {
+        cudaSetDevice(w.device);
 
-        //cublas lu solver
-        std::chrono::high_resolution_clock::time_point t7 = std::chrono::high_resolution_clock::now();
-        cublasHandle_t cublas_handle; cublasCreate_v2(&cublas_handle);
+        size_t monomialBasisSize = monomialBasis.size();
 
-        openfpm::vector_custd<int> infoArray(numMatrices); auto infoArrayKernel = infoArray.toKernel();
-        cublasLUDecFunc(cublas_handle, monomialBasisSize, AMatPointersKernelPointer, monomialBasisSize, NULL, (int*) infoArrayKernel.getPointer(), numMatrices);
-        cudaDeviceSynchronize();
+        int numSMs, numSMsMult = 1;
+        cudaDeviceGetAttribute(&numSMs, cudaDevAttrMultiProcessorCount, w.device);
+        size_t numThreads = numSMs*numSMsMult*256;
 
-        infoArray.template deviceToHost();
-        for (size_t i = 0; i < numMatrices; i++)
-            if (infoArray.get(i) != 0) fprintf(stderr, "Factorization of matrix %d Failed: Matrix may be singular\n", i);
+        // B is an intermediate matrix
+        w.BMat.resize(numThreads * maxSupportSize * monomialBasisSize);
+        w.AMat.resize(w.nRows*monomialBasisSize*monomialBasisSize);
+        w.bVec.resize(w.nRows*monomialBasisSize);
+        w.AMatPointers.resize(w.nRows);
+        w.bVecPointers.resize(w.nRows);
+        w.infoArray.resize(w.nRows);
+
+        // the arrays of pointers for the batched cublas subroutines are filled on the device
+        T* AMatKernelPointer = (T*) w.AMat.toKernel().getPointer();
+        T* bVecKernelPointer = (T*) w.bVec.toKernel().getPointer();
+        T** AMatPointersKernelPointer = (T**) w.AMatPointers.toKernel().getPointer();
+        T** bVecPointersKernelPointer = (T**) w.bVecPointers.toKernel().getPointer();
+
+        size_t nBlocks = (w.nRows + 255) / 256;
+        setBatchPointers_gpu<<<nBlocks, 256, 0, w.stream>>>(AMatPointersKernelPointer, bVecPointersKernelPointer, AMatKernelPointer, bVecKernelPointer, w.nRows, monomialBasisSize);
+
+        assembleLocalMatrices_gpu<<<numSMsMult*numSMs, 256, 0, w.stream>>>(particles.toKernel(), differentialSignature, differentialOrder, monomialBasisKernel, supportRefs.toKernel(), kerOffsets.toKernel(), supportKeys1D.toKernel(),
+            AMatPointersKernelPointer, bVecPointersKernelPointer, localEps.toKernel(), localEpsInvPow.toKernel(), w.BMat.toKernel(), w.rowStart, w.nRows, maxSupportSize);
+
+        // cublas lu solver, on the same stream of the kernels
+        if (w.cublasCreated == false) {
+            cublasCreate_v2(&w.cublas_handle);
+            w.cublasCreated = true;
+        }
+        cublasSetStream_v2(w.cublas_handle, w.stream);
 
-        const double alpha = 1.f;
-        cublasTriangSolveFunc(cublas_handle, CUBLAS_SIDE_LEFT, CUBLAS_FILL_MODE_LOWER, CUBLAS_OP_N, CUBLAS_DIAG_UNIT, monomialBasisSize, 1, &alpha, AMatPointersKernelPointer, monomialBasisSize, bVecPointersKernelPointer, monomialBasisSize, numMatrices);
-        cublasTriangSolveFunc(cublas_handle, CUBLAS_SIDE_LEFT, CUBLAS_FILL_MODE_UPPER, CUBLAS_OP_N, CUBLAS_DIAG_NON_UNIT, monomialBasisSize, 1, &alpha, AMatPointersKernelPointer, monomialBasisSize, bVecPointersKernelPointer, monomialBasisSize, numMatrices);
-        cudaDeviceSynchronize();
+        cublasLUDecFunc(w.cublas_handle, monomialBasisSize, AMatPointersKernelPointer, monomialBasisSize, NULL, (int*) w.infoArray.toKernel().getPointer(), w.nRows);
 
-        std::chrono::high_resolution_clock::time_point t8 = std::chrono::high_resolution_clock::now();
-        std::chrono::duration<double> time_span4 = std::chrono::duration_cast<std::chrono::duration<double>>(t8 - t7);
-        std::cout << "cublas took " << time_span4.count() * 1000. << " milliseconds." << std::endl;
+        const T alpha = 1.f;
+        cublasTriangSolveFunc(w.cublas_handle, CUBLAS_SIDE_LEFT, CUBLAS_FILL_MODE_LOWER, CUBLAS_OP_N, CUBLAS_DIAG_UNIT, monomialBasisSize, 1, &alpha, AMatPointersKernelPointer, monomialBasisSize, bVecPointersKernelPointer, monomialBasisSize, w.nRows);
+        cublasTriangSolveFunc(w.cublas_handle, CUBLAS_SIDE_LEFT, CUBLAS_FILL_MODE_UPPER, CUBLAS_OP_N, CUBLAS_DIAG_NON_UNIT, monomialBasisSize, 1, &alpha, AMatPointersKernelPointer, monomialBasisSize, bVecPointersKernelPointer, monomialBasisSize, w.nRows);
 
-        std::chrono::high_resolution_clock::time_point t5 = std::chrono::high_resolution_clock::now();
         // populate the calcKernels on GPU
-        calcKernels.resize(supportKeysTotalN);
-        localEps.template hostToDevice();
-        auto it2 = particles.getDomainIteratorGPU(512);
-        calcKernels_gpu<dim><<<it2.wthr,it2.thr>>>(particles.toKernel(), monomialBasisKernel, kerOffsets.toKernel(), supportKeys1D.toKernel(), bVecPointersKernelPointer, localEps.toKernel(), numMatrices, calcKernels.toKernel());
-        calcKernels.template deviceToHost();
-
-        std::chrono::high_resolution_clock::time_point t6 = std::chrono::high_resolution_clock::now();
-        std::chrono::duration<double> time_span5 = std::chrono::duration_cast<std::chrono::duration<double>>(t6 - t5);
-        std::cout << "calcKernels_gpu took " << time_span5.count() * 1000. << " milliseconds." << std::endl;
-
-        // free the resources
-        cublasDestroy_v2(cublas_handle);
-
-        std::chrono::high_resolution_clock::time_point t4 = std::chrono::high_resolution_clock::now();
-        std::chrono::duration<double> time_span = std::chrono::duration_cast<std::chrono::duration<double>>(t4 - t3);
-        std::cout << "Matrices inverse took " << time_span.count() * 1000. << " milliseconds." << std::endl;
+        size_t nBlocksK = (w.nRows + 511) / 512;
+        calcKernels_gpu<dim><<<nBlocksK, 512, 0, w.stream>>>(particles.toKernel(), monomialBasisKernel, kerOffsets.toKernel(), supportKeys1D.toKernel(), bVecPointersKernelPointer, localEps.toKernel(), w.rowStart, w.nRows, calcKernels.toKernel());
     }
 
     T computeKernel(Point<dim, T> x, EMatrix<T, Eigen::Dynamic, 1> & a) const {
@@ -807,23 +1221,34 @@ std::cout << "Support building took " << time_span2.count() * 1000. << " millise
 };
 
 
+template<typename T>
+__global__ void setBatchPointers_gpu(T** AMatPointers, T** bVecPointers, T* AMat, T* bVec, size_t numMatrices, size_t monomialBasisSize)
+{
+    size_t i = blockIdx.x * blockDim.x + threadIdx.x;
+    if (i >= numMatrices) return;
+
+    AMatPointers[i] = AMat + i*monomialBasisSize*monomialBasisSize;
+    bVecPointers[i] = bVec + i*monomialBasisSize;
+}
+
 template<unsigned int dim, typename T, typename particles_type, typename monomialBasis_type, typename supportKey_type, typename localEps_type, typename matrix_type>
 __global__ void assembleLocalMatrices_gpu(
         particles_type particles, Point<dim, unsigned int> differentialSignature, unsigned int differentialOrder, monomialBasis_type monomialBasis, 
         supportKey_type supportRefs, supportKey_type kerOffsets, supportKey_type supportKeys1D, T** h_A, T** h_b, localEps_type localEps, localEps_type localEpsInvPow,
-        matrix_type BMat, size_t numMatrices, size_t maxSupportSize)
+        matrix_type BMat, size_t rowStart, size_t numMatrices, size_t maxSupportSize)
     {
-    auto p_key = GET_PARTICLE(particles);
+    // t is the row inside the batch [rowStart, rowStart+numMatrices) solved by this device
+    size_t t = blockIdx.x * blockDim.x + threadIdx.x;
     size_t monomialBasisSize = monomialBasis.size();
-    size_t BStartPos = maxSupportSize * monomialBasisSize * p_key; T* B = &((T*)BMat.getPointer())[BStartPos];
+    size_t BStartPos = maxSupportSize * monomialBasisSize * t; T* B = &((T*)BMat.getPointer())[BStartPos];
     const auto& basisElements = monomialBasis.getElements();
     int rhsSign = (Monomial_gpu<dim>(differentialSignature).order() % 2 == 0) ? 1 : -1;
 
-    for (; 
-        p_key < numMatrices; 
-        p_key += blockDim.x * gridDim.x) 
+    for (;
+        t < numMatrices;
+        t += blockDim.x * gridDim.x)
     {
-        Point<dim, T> xa = particles.getPos(p_key);
+        size_t p_key = rowStart + t;
 
         size_t  supportKeysSize = kerOffsets.get(p_key+1)-kerOffsets.get(p_key);
         size_t* supportKeys = &((size_t*)supportKeys1D.getPointer())[kerOffsets.get(p_key)];
@@ -833,7 +1258,7 @@ __global__ void assembleLocalMatrices_gpu(
 
         T FACTOR = 2, avgNeighbourSpacing = 0;
         for (int i = 0 ; i < supportKeysSize; i++) {
-            Point<dim,T> off = xa; off -= particles.getPosOrig(supportKeys[i]);
+            Point<dim,T> off = supportOffset_gpu<T,dim>(particles, p_key, supportKeys[i]);
             for (size_t j = 0; j < dim; ++j)
                 avgNeighbourSpacing += fabs(off.value(j));
         }
@@ -844,43 +1269,44 @@ __global__ void assembleLocalMatrices_gpu(
     assert(eps != 0);
 
         localEps.get(p_key) = eps;
-        localEpsInvPow.get(p_key) = 1.0 / pow(eps,differentialOrder);
+        localEpsInvPow.get(p_key) = T(1) / ipow_gpu(eps,differentialOrder);
 
         // EMatrix<T, Eigen::Dynamic, Eigen::Dynamic> B = E * V;
         for (int i = 0; i < supportKeysSize; ++i)
             for (int j = 0; j < monomialBasisSize; ++j) {
-                Point<dim,T> off = xa; off -= particles.getPosOrig(supportKeys[i]);
+                Point<dim,T> off = supportOffset_gpu<T,dim>(particles, p_key, supportKeys[i]);
                 const Monomial_gpu<dim>& m = basisElements.get(j);
 
-                T V_ij = m.evaluate(off) / pow(eps, m.order());
-                T E_ii = exp(- norm2(off) / (2.0 * eps * eps));
+                T V_ij = m.evaluate(off) / ipow_gpu(eps, m.order());
+                T E_ii = exp(- norm2(off) / (T(2) * eps * eps));
                 B[i*monomialBasisSize+j] = E_ii * V_ij;
             }
 
-        T sum = 0.0;
+        T sum = 0;
         // EMatrix<T, Eigen::Dynamic, Eigen::Dynamic> A = B.transpose() * B;
         for (int i = 0; i < monomialBasisSize; ++i)
             for (int j = 0; j < monomialBasisSize; ++j) {
                 for (int k = 0; k < supportKeysSize; ++k)
                     sum += B[k*monomialBasisSize+i] * B[k*monomialBasisSize+j];
 
-                h_A[p_key][i*monomialBasisSize+j] = sum; sum = 0.0;
+                h_A[t][i*monomialBasisSize+j] = sum; sum = 0;
             }
 
         // Compute RHS vector b
         for (size_t i = 0; i < monomialBasisSize; ++i) {
             const Monomial_gpu<dim>& dm = basisElements.get(i).getDerivative(differentialSignature);
-            h_b[p_key][i] = rhsSign * dm.evaluate(Point<dim, T>(0));
+            h_b[t][i] = rhsSign * dm.evaluate(Point<dim, T>(0));
         }
     }
 }
 
 template<unsigned int dim, typename particles_type, typename T, typename monomialBasis_type, typename supportKey_type, typename localEps_type, typename calcKernels_type>
 __global__ void calcKernels_gpu(particles_type particles, monomialBasis_type monomialBasis, supportKey_type kerOffsets, supportKey_type supportKeys1D,
-        T** h_b, localEps_type localEps, size_t numMatrices, calcKernels_type calcKernels)
+        T** h_b, localEps_type localEps, size_t rowStart, size_t numMatrices, calcKernels_type calcKernels)
     {
-    auto p_key = GET_PARTICLE(particles);
-    Point<dim, T> xa = particles.getPos(p_key);
+    size_t t = blockIdx.x * blockDim.x + threadIdx.x;
+    if (t >= numMatrices) return;
+    size_t p_key = rowStart + t;
 
     size_t  monomialBasisSize = monomialBasis.size();
     const auto& basisElements = monomialBasis.getElements();
@@ -893,15 +1319,14 @@ __global__ void calcKernels_gpu(particles_type particles, monomialBasis_type mon
     for (size_t j = 0; j < supportKeysSize; ++j)
     {
         size_t xqK = supportKeys[j];
-        Point<dim, T> xq = particles.getPosOrig(xqK);
-        Point<dim, T> offNorm = (xa - xq) / eps;
+        Point<dim, T> offNorm = supportOffset_gpu<T,dim>(particles, p_key, xqK) / eps;
         T expFactor = exp(-norm2(offNorm));
 
         T res = 0;
         for (size_t i = 0; i < monomialBasisSize; ++i) {
             const Monomial_gpu<dim> &m = basisElements.get(i);
             T mbValue = m.evaluate(offNorm);
-            T coeff = h_b[p_key][i];
+            T coeff = h_b[t][i];
 
             res += coeff * mbValue * expFactor;
         }
@@ -909,6 +1334,92 @@ __global__ void calcKernels_gpu(particles_type particles, monomialBasis_type mon
     }
 }
 
+template<unsigned int fValuePos, unsigned int DfValuePos, bool compensated, typename particles_type, typename T>
+__global__ void computeDifferentialOperator_gpu(particles_type particles, const size_t* kerOffsets, const size_t* supportKeys1D,
+        const T* calcKernels, const T* localEpsInvPow, T sign, size_t N)
+{
+    size_t p = blockIdx.x * blockDim.x + threadIdx.x;
+    if (p >= N) return;
+
+    T fxp = sign * (T) particles.template getProp<fValuePos>(p);
+    dcpse_sum_gpu<T,compensated> Dfxp;
+    for (size_t i = kerOffsets[p]; i < kerOffsets[p+1]; ++i)
+        Dfxp.add(((T) particles.template getProp<fValuePos>(supportKeys1D[i]) + fxp) * calcKernels[i]);
+
+    particles.template getProp<DfValuePos>(p) = Dfxp.value() * localEpsInvPow[p];
+}
+
+template<unsigned int fValuePos, unsigned int DfValuePos, unsigned int tileSize, bool compensated, typename particles_type, typename T>
+__global__ void computeDifferentialOperatorInterleaved_gpu(particles_type particles, const size_t* tileOffsets, const size_t* supportKeysIL,
+        const T* calcKernelsIL, const T* localEpsInvPow, T sign, size_t N)
+{
+    size_t p = blockIdx.x * blockDim.x + threadIdx.x;
+    if (p >= N) return;
+
+    size_t tile = p / tileSize;
+    size_t lane = p % tileSize;
+
+    T fxp = sign * (T) particles.template getProp<fValuePos>(p);
+    dcpse_sum_gpu<T,compensated> Dfxp;
+    for (size_t i = tileOffsets[tile] + lane; i < tileOffsets[tile+1]; i += tileSize)
+        Dfxp.add(((T) particles.template getProp<fValuePos>(supportKeysIL[i]) + fxp) * calcKernelsIL[i]);
+
+    particles.template getProp<DfValuePos>(p) = Dfxp.value() * localEpsInvPow[p];
+}
+
+template<unsigned int fValuePos, unsigned int DfValuePos, unsigned int subWarp, unsigned int blockSize, unsigned int stageSize, bool compensated, typename particles_type, typename T>
+__global__ void computeDifferentialOperatorWarp_gpu(particles_type particles, const size_t* kerOffsets, const size_t* supportKeys1D,
+        const T* calcKernels, const T* localEpsInvPow, T sign, size_t N, size_t NWithGhost)
+{
+    __shared__ T stage[stageSize];
+
+    constexpr unsigned int partPerBlock = blockSize / subWarp;
+    size_t first = blockIdx.x * partPerBlock;
+
+    // window of keys centred on the particles of the block
+    size_t wStart = (first + partPerBlock / 2 > stageSize / 2) ? first + partPerBlock / 2 - stageSize / 2 : 0;
+    size_t wEnd = (wStart + stageSize < NWithGhost) ? wStart + stageSize : NWithGhost;
+
+    for (size_t i = threadIdx.x; i < wEnd - wStart; i += blockSize)
+        stage[i] = particles.template getProp<fValuePos>(wStart + i);
+    __syncthreads();
+
+    size_t p = first + threadIdx.x / subWarp;
+    unsigned int lane = threadIdx.x % subWarp;
+
+    dcpse_sum_gpu<T,compensated> sum;
+    if (p < N) {
+        T fxp = sign * ((p >= wStart && p < wEnd) ? stage[p - wStart] : (T) particles.template getProp<fValuePos>(p));
+
+        for (size_t i = kerOffsets[p] + lane; i < kerOffsets[p+1]; i += subWarp) {
+            size_t xqK = supportKeys1D[i];
+            T fxq = (xqK >= wStart && xqK < wEnd) ? stage[xqK - wStart] : (T) particles.template getProp<fValuePos>(xqK);
+            sum.add((fxq + fxp) * calcKernels[i]);
+        }
+    }
+
+    // every thread of the warp takes part in the reduction of the (compensated) partial sums
+    T Dfxp = sum.value();
+    for (unsigned int offset = subWarp / 2; offset > 0; offset /= 2)
+        Dfxp += __shfl_down_sync(0xffffffff, Dfxp, offset, subWarp);
+
+    if (lane == 0 && p < N)
+        particles.template getProp<DfValuePos>(p) = Dfxp * localEpsInvPow[p];
+}
+
+/*! \brief Dcpse_gpu assembled, solved and applied in float on double particles
+ *
+ * For devices with a low double throughput. It can be the Dcpse_type of the DCPSE_op operators,
+ * for example Derivative_x_T<Dcpse_gpu_float>
+ *
+ */
+template<unsigned int dim, typename vector_type>
+using Dcpse_gpu_float = Dcpse_gpu<dim, vector_type, float>;
+
+//! Like Dcpse_gpu_float, with a compensated sum in the device application
+template<unsigned int dim, typename vector_type>
+using Dcpse_gpu_float_comp = Dcpse_gpu<dim, vector_type, float, true>;
+
 #endif
 #endif //OPENFPM_PDATA_DCPSE_CUH
 
@@ -15,7 +15,18 @@
 #include "Vandermonde.hpp"
 #include "DcpseDiagonalScalingMatrix.hpp"
 #include "DcpseRhs.hpp"
+#include "util/trace_span.hpp"
+#include "util/numa_policy.hpp"
 #include "hash_map/hopscotch_map.h"
+#include <cstdint>
+#include <cstring>
+#include <map>
+#include <future>
+#include <memory>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
 
 template<unsigned int N> struct value_t {};
 
@@ -39,8 +50,115 @@ struct is_scalar<false> {
 	};
 };
 
+//! Tag of the Dcpse constructor used by DcpseContext (the kernels are computed later by Dcpse::initializeGroup)
+struct dcpse_group_deferred {};
 
-template<unsigned int dim, typename vector_type,typename vector_type2=vector_type>
+template<unsigned int prp, typename vector>
+class vector_dist_expression;
+
+/*! \brief Contiguous stream of a scalar property of the particles
+ *
+ * With a SoA layout (memory_traits_inte) every property is a separate array, the operators then read the property as
+ * a plain array that the compiler can vectorize, and every pass brings in cache only the properties it uses. With the
+ * AoS layout (memory_traits_lin) the properties of a particle are interleaved and there is no stream
+ *
+ * \tparam prp property
+ *
+ * \param particles particle set
+ *
+ * \return the property of the particle 0 if the property of the particle i is at i, nullptr otherwise
+ *
+ */
+template<unsigned int prp, typename vector_type>
+inline auto getPropStream(vector_type & particles) -> typename std::remove_reference<decltype(particles.template getProp<prp>(0))>::type *
+{
+	typedef typename std::remove_reference<decltype(particles.template getProp<prp>(0))>::type prop_type;
+
+	if (std::is_fundamental<prop_type>::value == false || particles.size_local_orig() < 2)
+	{return nullptr;}
+
+	prop_type * p0 = &particles.template getProp<prp>(0);
+	prop_type * p1 = &particles.template getProp<prp>(1);
+
+	return (p1 == p0 + 1)?p0:nullptr;
+}
+
+//! Sum over the support of a scalar expression, the expression is evaluated on every neighbour
+template<typename r_type, typename T, typename op_type, typename support_type, typename kernels_type>
+inline r_type dcpse_support_sum_expr(op_type & o1, const r_type & fxp, const support_type & support, const kernels_type & calcKernels, size_t kerOff)
+{
+	r_type Dfxp = 0;
+	for (int i = 0 ; i < support.size() ; i++)
+	{
+		size_t xqK = support.get(i);
+		r_type fxq = o1.value(vect_dist_key_dx(xqK));
+		Dfxp = Dfxp + (fxq + fxp) * (T)calcKernels.get(kerOff+i);
+	}
+
+	return Dfxp;
+}
+
+//! Check if a scalar property of the particles (not the position) can be read from its stream
+template<unsigned int prp, typename vector, bool is_prop>
+struct dcpse_prop_stream_impl : std::false_type {};
+
+//! Check if a scalar property of the particles (not the position) can be read from its stream
+template<unsigned int prp, typename vector>
+struct dcpse_prop_stream_impl<prp,vector,true>
+: std::integral_constant<bool,std::is_fundamental<typename std::remove_reference<decltype(std::declval<vector &>().template getProp<prp>(0))>::type>::value>
+{};
+
+//! Check if an expression is a scalar property of the particles
+template<typename op_type>
+struct dcpse_prop_stream : std::false_type {};
+
+//! Check if an expression is a scalar property of the particles
+template<unsigned int prp, typename vector>
+struct dcpse_prop_stream<vector_dist_expression<prp,vector>> : dcpse_prop_stream_impl<prp,vector,prp != POS_PROP> {};
+
+//! Sum over the support of a scalar expression
+template<typename op_type, bool stream = dcpse_prop_stream<typename std::remove_const<op_type>::type>::value>
+struct dcpse_support_sum
+{
+	template<typename r_type, typename T, typename support_type, typename kernels_type>
+	static inline r_type sum(op_type & o1, const r_type & fxp, const support_type & support, const kernels_type & calcKernels, size_t kerOff)
+	{
+		return dcpse_support_sum_expr<r_type,T>(o1,fxp,support,calcKernels,kerOff);
+	}
+};
+
+//! Sum over the support of a scalar property, read from its stream when the layout is SoA
+template<typename op_type>
+struct dcpse_support_sum<op_type,true>
+{
+	template<typename r_type, typename T, typename support_type, typename kernels_type>
+	static inline r_type sum(op_type & o1, const r_type & fxp, const support_type & support, const kernels_type & calcKernels, size_t kerOff)
+	{
+		typedef typename std::remove_const<op_type>::type::vtype vector;
+
+		auto f = getPropStream<std::remove_const<op_type>::type::prop>(const_cast<vector &>(o1.getVector()));
+
+		if (f == nullptr)
+		{return dcpse_support_sum_expr<r_type,T>(o1,fxp,support,calcKernels,kerOff);}
+
+		r_type Dfxp = 0;
+		for (int i = 0 ; i < support.size() ; i++)
+		{Dfxp = Dfxp + (f[support.get(i)] + fxp) * (T)calcKernels.get(kerOff+i);}
+
+		return Dfxp;
+	}
+};
+
+/*! \brief DCPSE operator
+ *
+ * \tparam dim dimensionality
+ * \tparam vector_type particles from which the operator is computed
+ * \tparam vector_type2 particles where the operator is evaluated
+ * \tparam kernel_type type used to store the kernel weights (for example float to halve the memory streamed
+ *         by every application), the moment systems are solved and the results accumulated with vector_type::stype
+ *
+ */
+template<unsigned int dim, typename vector_type,typename vector_type2=vector_type, typename kernel_type=typename vector_type::stype>
 class Dcpse {
 public:
 	typedef typename vector_type::stype T;
@@ -57,13 +175,36 @@ protected:
 	const MonomialBasis<dim> monomialBasis;
 
 	bool isSharedLocalSupport = false;
-	openfpm::vector<Support> localSupports; // Each MPI rank has just access to the local ones
+	SupportCSR localSupports; // Each MPI rank has just access to the local ones
 	openfpm::vector<T> localEps; // Each MPI rank has just access to the local ones
 	openfpm::vector<T> localEpsInvPow; // Each MPI rank has just access to the local ones
 
+	// The kernel of the neighbour j of the particle p is at getKernelOffset(p)+j
+	openfpm::vector<kernel_type> calcKernels;
+
+	// Offset in calcKernels of the kernel of each row when the lattice rows share one kernel (see latticeTOL),
+	// empty if every row has its own kernel at localSupports.getRowOffset(p)
 	openfpm::vector<size_t> kerOffsets;
-	openfpm::vector<T> calcKernels;
 	openfpm::vector<T> nSpacings;
+
+	// Positions of particlesTo (by row) and particlesFrom (by key) used to compute the kernels, see initializeUpdateIncremental
+	openfpm::vector<Point<dim,T>> buildPosTo;
+	openfpm::vector<Point<dim,T>> buildPosFrom;
+
+	// Rows with ghost neighbours, filled by computeDifferentialOperatorOverlap
+	openfpm::vector<size_t> overlapBoundaryRows;
+
+	// With isSubset the kernels are built only for the rows in subsetRows (ascending), the other rows have an empty support
+	bool isSubset = false;
+	openfpm::vector<size_t> subsetRows;
+
+	// With p-adaptivity (see initializeUpdateAdaptiveOrder) the rows with lowOrderRow set are built with
+	// lowConvergenceOrder, a smaller monomial basis and a smaller support
+	unsigned int lowConvergenceOrder = 0;
+	openfpm::vector<unsigned char> lowOrderRow;
+
+	// Estimate of the condition number of the moment matrix of each row, filled with CONDITION_ADAPTIVE
+	openfpm::vector<T> rowCondition;
 	vector_type & particlesFrom;
 	vector_type2 & particlesTo;
 	double rCut,supportSizeFactor=1;
@@ -71,6 +212,28 @@ protected:
 
 	support_options opt;
 
+	// Operators with the same support and monomial basis whose kernels are computed with the factorizations of this
+	// one, set only during initializeGroup
+	std::vector<Dcpse *> groupOps;
+
+	// Statistics of the last construction on this processor (sum of eps, sum, max and min of the minimum spacing
+	// in the support, number of solved rows), reduced only by printStatistics
+	T statEps=0,statSpacing=0,statMaxSpacing=0,statMinSpacing=std::numeric_limits<T>::max();
+	size_t statRows=0;
+
+	// Supports enlarged by CONDITION_ADAPTIVE and kernels recomputed by the last incremental update on this
+	// processor (statIncremental is true if the last update was incremental), reduced only by printStatistics
+	size_t statGrown=0,statRecomputed=0;
+	bool statIncremental=false;
+
+	// Operator rebuilt in background by initializeGroupAsync on a snapshot of the particles (the snapshot is owned by
+	// the build), swapped in by finalizeGroupAsync
+	std::shared_ptr<Dcpse> asyncOp;
+	std::shared_future<void> asyncBuild;
+#ifdef SE_CLASS1
+	int asyncMapCtr=0;
+#endif
+
 public:
 	// This works in this way:
 	// 1) User constructs this by giving a domain of points (where one of the properties is the value of our f),
@@ -81,6 +244,21 @@ public:
 	////c=HOverEpsilon. Note that the Eps value is computed by <h>/c (<h>=local average spacing for each particle and its support). This factor c is used in the Vandermonde.hpp.
 	double HOverEpsilon=0.9;
 
+	//! With CONDITION_ADAPTIVE the support of a particle is enlarged while the condition estimate of its moment matrix is above conditionTOL
+	double conditionTOL=1e7;
+	//! Growth of the support size at every enlargement
+	double supportGrowthFactor=1.5;
+	//! Maximum number of enlargements
+	unsigned int maxSupportGrowth=4;
+
+	//! When bigger than zero, the particles whose support is a translate of the support of another particle (all the
+	//! offsets equal within latticeTOL*rCut, like in the bulk of a DrawBox lattice) share one kernel. Ignored with CONDITION_ADAPTIVE
+	double latticeTOL=0;
+
+	//! Placement of the supports, the kernels and the local eps on the NUMA domains and huge pages, see numa_policy.
+	//! With first_touch the kernels are computed with the static partition the arrays are placed with
+	numa_policy numaPolicy;
+
 #ifdef SE_CLASS1
 	int getUpdateCtr() const
 	{
@@ -95,20 +273,23 @@ public:
 		  unsigned int convergenceOrder,
 		  T rCut,
 		  T supportSizeFactor = 1,                               //Maybe change this to epsilon/h or h/epsilon = c 0.9. Benchmark
-		  support_options opt = support_options::RADIUS)
+		  support_options opt = support_options::RADIUS,
+		  double latticeTOL = 0)
 		:particlesFrom(particles),
 		 particlesTo(particles),
 			differentialSignature(differentialSignature),
 			differentialOrder(Monomial<dim>(differentialSignature).order()),
 			monomialBasis(differentialSignature.asArray(), convergenceOrder),
-			opt(opt)
+			opt(opt),
+			latticeTOL(latticeTOL)
 	{
 		particles.ghost_get_subset();         // This communicates which ghost particles to be excluded from support
 		initializeStaticSize(particles, particles, convergenceOrder, rCut, supportSizeFactor);
 	}
 
+	template<typename kernel_type2>
 	Dcpse(vector_type &particles,
-		  const Dcpse<dim, vector_type>& other,
+		  const Dcpse<dim, vector_type, vector_type, kernel_type2>& other,
 		  Point<dim, unsigned int> differentialSignature,
 		  unsigned int convergenceOrder,
 		  T rCut,
@@ -118,8 +299,9 @@ public:
 			differentialSignature(differentialSignature),
 			differentialOrder(Monomial<dim>(differentialSignature).order()),
 			monomialBasis(differentialSignature.asArray(), convergenceOrder),
-			localSupports(other.localSupports),
-			isSharedLocalSupport(true)
+			localSupports(other.getLocalSupports()),
+			isSharedLocalSupport(true),
+			latticeTOL(other.latticeTOL)
 	{
 		particles.ghost_get_subset();
 		initializeStaticSize(particles, particles, convergenceOrder, rCut, supportSizeFactor);
@@ -130,17 +312,337 @@ public:
 		  unsigned int convergenceOrder,
 		  T rCut,
 		  T supportSizeFactor = 1,
-		  support_options opt = support_options::RADIUS)
+		  support_options opt = support_options::RADIUS,
+		  double latticeTOL = 0)
 			:particlesFrom(particlesFrom),particlesTo(particlesTo),
 			 differentialSignature(differentialSignature),
 			 differentialOrder(Monomial<dim>(differentialSignature).order()),
 			 monomialBasis(differentialSignature.asArray(), convergenceOrder),
-			 opt(opt)
+			 opt(opt),
+			 latticeTOL(latticeTOL)
 	{
 		particlesFrom.ghost_get_subset();
 		initializeStaticSize(particlesFrom,particlesTo,convergenceOrder, rCut, supportSizeFactor);
 	}
 
+	/*! \brief Construct the operator only on a subset of the particles
+	 *
+	 * Supports and kernels are built and stored only for the particles in subset (for example the boundary particles
+	 * passed to DCPSE_scheme::impose), the operator is zero on the others and it is applied only on the subset
+	 *
+	 * \param subset keys of the particles where the operator is constructed (first property of index_type)
+	 *
+	 */
+	template<typename index_type>
+	Dcpse(vector_type &particles,
+		  Point<dim, unsigned int> differentialSignature,
+		  unsigned int convergenceOrder,
+		  T rCut,
+		  const openfpm::vector<index_type> & subset,
+		  T supportSizeFactor = 1,
+		  support_options opt = support_options::RADIUS)
+		:particlesFrom(particles),
+		 particlesTo(particles),
+			differentialSignature(differentialSignature),
+			differentialOrder(Monomial<dim>(differentialSignature).order()),
+			monomialBasis(differentialSignature.asArray(), convergenceOrder),
+			opt(opt)
+	{
+		setSubset(subset);
+		particles.ghost_get_subset();
+		initializeStaticSize(particles, particles, convergenceOrder, rCut, supportSizeFactor);
+	}
+
+	//! Constructor of DcpseContext::addOperator, the kernels are computed by initializeGroup
+	Dcpse(vector_type &particles,
+		  Point<dim, unsigned int> differentialSignature,
+		  unsigned int convergenceOrder,
+		  T rCut,
+		  T supportSizeFactor,
+		  support_options opt,
+		  dcpse_group_deferred)
+		:particlesFrom(particles),
+		 particlesTo(particles),
+			differentialSignature(differentialSignature),
+			differentialOrder(Monomial<dim>(differentialSignature).order()),
+			monomialBasis(differentialSignature.asArray(), convergenceOrder),
+			rCut(rCut),
+			supportSizeFactor(supportSizeFactor),
+			convergenceOrder(convergenceOrder),
+			opt(opt)
+	{}
+
+	//! Constructor of the operators built on a part of the rows of another one (p-adaptivity), nothing is computed
+	Dcpse(vector_type &particlesFrom,vector_type2 &particlesTo,
+		  Point<dim, unsigned int> differentialSignature,
+		  unsigned int convergenceOrder,
+		  T rCut,
+		  T supportSizeFactor,
+		  support_options opt,
+		  dcpse_group_deferred)
+		:particlesFrom(particlesFrom),
+		 particlesTo(particlesTo),
+			differentialSignature(differentialSignature),
+			differentialOrder(Monomial<dim>(differentialSignature).order()),
+			monomialBasis(differentialSignature.asArray(), convergenceOrder),
+			rCut(rCut),
+			supportSizeFactor(supportSizeFactor),
+			convergenceOrder(convergenceOrder),
+			opt(opt)
+	{}
+
+	/*! \brief Compute the kernels of several operators on the same particles with one support and one factorization
+	 *
+	 * The operator with the biggest monomial basis builds the support, all the others share it. The moment matrix
+	 * A = B^T B and its QR factorization depend only on the support and on the monomial basis, so the operators with the
+	 * same basis (the same differential order, for example Dx, Dy and Dz, or Dxx, Dxy and Dyy) are solved together:
+	 * every particle factorizes A once and solves for the right-hand sides of all of them. The operators must have been
+	 * constructed on the same particles with the same convergence order, rCut and oversampling factor (for example
+	 * with the dcpse_group_deferred constructor). It can be called again after a map to rebuild all the operators.
+	 *
+	 * With CONDITION_ADAPTIVE the support of the operator with the biggest basis is enlarged where its moment matrix is ill-conditioned,
+	 * so it is solved alone and the other operators are solved on the enlarged support
+	 *
+	 * \param ops operators
+	 *
+	 */
+	static void initializeGroup(const std::vector<Dcpse *> & ops)
+	{
+		if (ops.size() == 0)
+		{return;}
+
+		for (size_t i = 1 ; i < ops.size() ; i++)
+		{
+			if (&ops[i]->particlesFrom != &ops[0]->particlesFrom || &ops[i]->particlesTo != &ops[0]->particlesTo)
+			{
+				std::cerr << __FILE__ << ":" << __LINE__ << " error the operators of a group must be constructed on the same particles" << std::endl;
+				return;
+			}
+		}
+
+		ops[0]->particlesFrom.ghost_get_subset();
+
+		initializeGroup_impl(ops);
+	}
+
+	/*! \brief Rebuild several operators in background, the current kernels stay in use until finalizeGroupAsync
+	 *
+	 * The particles are copied (on the calling thread, after the collective ghost_get_subset) and the new supports
+	 * and kernels are computed like initializeGroup on the copy by a worker thread, in a second set of buffers. The
+	 * operators can be applied in the meantime with the old kernels. finalizeGroupAsync swaps the new buffers in at
+	 * a step boundary. The keys of the new kernels are the keys of the copy, so the particles must not be mapped or
+	 * reordered before the swap (slowly moving particles rebuilt every N steps), the ghost can be refreshed with
+	 * SKIP_LABELLING. The worker computes the kernels with its own OpenMP team, which competes for the cores with the
+	 * time stepping. The worker does not communicate (CONDITION_ADAPTIVE included, its statistics stay local until
+	 * printStatistics), so MPI does not need MPI_THREAD_MULTIPLE. If a rebuild is still running it is finished and
+	 * swapped in first
+	 *
+	 * \code{.cpp}
+
+	   if (step % N == 0)
+	   {Dcpse<2,vector_type>::initializeGroupAsync(ops);}
+
+	   ... steps with the current kernels ...
+
+	   Dcpse<2,vector_type>::finalizeGroupAsync(ops);  // swap if ready, wait == true blocks until it is
+
+	 * \endcode
+	 *
+	 * \param ops operators constructed on the same particles (vector_type2 must be vector_type)
+	 *
+	 */
+	static void initializeGroupAsync(const std::vector<Dcpse *> & ops)
+	{
+		if (ops.size() == 0)
+		{return;}
+
+		finalizeGroupAsync(ops,true);
+
+		for (size_t i = 0 ; i < ops.size() ; i++)
+		{
+			if (&ops[i]->particlesFrom != &ops[0]->particlesFrom || (void *)&ops[i]->particlesTo != (void *)&ops[0]->particlesFrom)
+			{
+				std::cerr << __FILE__ << ":" << __LINE__ << " error the operators rebuilt in background must be constructed on the same particles" << std::endl;
+				return;
+			}
+		}
+
+		ops[0]->particlesFrom.ghost_get_subset();
+
+		auto snapshot = std::make_shared<vector_type>(ops[0]->particlesFrom);
+
+		std::vector<std::shared_ptr<Dcpse>> backs;
+		for (size_t i = 0 ; i < ops.size() ; i++)
+		{
+			Dcpse * op = ops[i];
+			std::shared_ptr<Dcpse> back = std::make_shared<Dcpse>(*snapshot,op->differentialSignature,op->convergenceOrder,
+			                                                      op->rCut,op->supportSizeFactor,op->opt,dcpse_group_deferred());
+			back->HOverEpsilon = op->HOverEpsilon;
+			back->conditionTOL = op->conditionTOL;
+			back->supportGrowthFactor = op->supportGrowthFactor;
+			back->maxSupportGrowth = op->maxSupportGrowth;
+			back->latticeTOL = op->latticeTOL;
+			back->numaPolicy = op->numaPolicy;
+			back->isSubset = op->isSubset;
+			back->subsetRows = op->subsetRows;
+			back->lowConvergenceOrder = op->lowConvergenceOrder;
+			back->lowOrderRow = op->lowOrderRow;
+
+			op->asyncOp = back;
+#ifdef SE_CLASS1
+			op->asyncMapCtr = op->particlesFrom.getMapCtr();
+#endif
+			backs.push_back(back);
+		}
+
+		std::shared_future<void> build = std::async(std::launch::async,[snapshot,backs]()
+		{
+			std::vector<Dcpse *> b;
+			for (size_t i = 0 ; i < backs.size() ; i++)
+			{b.push_back(backs[i].get());}
+
+			initializeGroup_impl(b);
+		}).share();
+
+		for (size_t i = 0 ; i < ops.size() ; i++)
+		{ops[i]->asyncBuild = build;}
+	}
+
+	/*! \brief Swap in the kernels rebuilt by initializeGroupAsync
+	 *
+	 * \param ops the operators passed to initializeGroupAsync
+	 * \param wait if the rebuild is still running wait for it, otherwise return false and keep the current kernels
+	 *
+	 * \return true if the new kernels have been swapped in
+	 *
+	 */
+	static bool finalizeGroupAsync(const std::vector<Dcpse *> & ops, bool wait = false)
+	{
+		if (ops.size() == 0 || ops[0]->isUpdateAsyncPending() == false)
+		{return false;}
+
+		if (wait == false && ops[0]->isUpdateAsyncReady() == false)
+		{return false;}
+
+		// rethrow the errors of the worker
+		ops[0]->asyncBuild.get();
+
+		for (size_t i = 0 ; i < ops.size() ; i++)
+		{
+			Dcpse * op = ops[i];
+			if (op->asyncOp == NULL)
+			{continue;}
+
+			op->swapKernels(*op->asyncOp);
+#ifdef SE_CLASS1
+			op->update_ctr = op->asyncMapCtr;
+#endif
+			op->asyncOp.reset();
+			op->asyncBuild = std::shared_future<void>();
+		}
+
+		return true;
+	}
+
+	//! True if a background rebuild has been started and not swapped in yet
+	bool isUpdateAsyncPending() const
+	{
+		return asyncBuild.valid();
+	}
+
+	//! True if the background rebuild is finished and finalizeUpdateAsync swaps without waiting
+	bool isUpdateAsyncReady() const
+	{
+		return asyncBuild.valid() && asyncBuild.wait_for(std::chrono::seconds(0)) == std::future_status::ready;
+	}
+
+protected:
+
+	//! Exchange the supports, the kernels and the build data with another operator
+	void swapKernels(Dcpse & other)
+	{
+		std::swap(isSharedLocalSupport,other.isSharedLocalSupport);
+		localSupports.swap(other.localSupports);
+		localEps.swap(other.localEps);
+		localEpsInvPow.swap(other.localEpsInvPow);
+		calcKernels.swap(other.calcKernels);
+		kerOffsets.swap(other.kerOffsets);
+		buildPosTo.swap(other.buildPosTo);
+		buildPosFrom.swap(other.buildPosFrom);
+		rowCondition.swap(other.rowCondition);
+		overlapBoundaryRows.clear();
+
+		setStatistics(other.statEps,other.statSpacing,other.statMaxSpacing,other.statMinSpacing,other.statRows);
+		statGrown = other.statGrown;
+		statRecomputed = other.statRecomputed;
+		statIncremental = other.statIncremental;
+	}
+
+	//! initializeGroup after ghost_get_subset, it does not communicate
+	static void initializeGroup_impl(const std::vector<Dcpse *> & ops)
+	{
+		// the operator with the biggest basis builds the support
+		Dcpse * leader = ops[0];
+		for (size_t i = 1 ; i < ops.size() ; i++)
+		{
+			if (ops[i]->monomialBasis.size() > leader->monomialBasis.size())
+			{leader = ops[i];}
+		}
+
+		for (size_t i = 0 ; i < ops.size() ; i++)
+		{
+#ifdef SE_CLASS1
+			ops[i]->update_ctr=ops[i]->particlesFrom.getMapCtr();
+#endif
+			ops[i]->isSharedLocalSupport = (ops[i] != leader);
+			ops[i]->localSupports.clear();
+			ops[i]->localEps.clear();
+			ops[i]->localEpsInvPow.clear();
+			ops[i]->calcKernels.clear();
+		}
+
+		std::vector<bool> done(ops.size(),false);
+
+		// leader first, the others copy its support
+		std::vector<Dcpse *> heads;
+		heads.push_back(leader);
+		for (size_t i = 0 ; i < ops.size() ; i++)
+		{
+			if (ops[i] != leader) {heads.push_back(ops[i]);}
+		}
+
+		for (size_t h = 0 ; h < heads.size() ; h++)
+		{
+			Dcpse * head = heads[h];
+			size_t ih = std::find(ops.begin(),ops.end(),head) - ops.begin();
+			if (done[ih] == true)
+			{continue;}
+			done[ih] = true;
+
+			head->groupOps.clear();
+			if (head != leader || head->opt != support_options::CONDITION_ADAPTIVE)
+			{
+				for (size_t i = 0 ; i < ops.size() ; i++)
+				{
+					if (done[i] == false && ops[i] != leader && ops[i]->monomialBasis == head->monomialBasis &&
+					    ops[i]->HOverEpsilon == head->HOverEpsilon)
+					{
+						head->groupOps.push_back(ops[i]);
+						done[i] = true;
+					}
+				}
+			}
+
+			if (head != leader)
+			{head->localSupports = leader->localSupports;}
+
+			head->initializeStaticSize(head->particlesFrom,head->particlesTo,head->convergenceOrder,head->rCut,head->supportSizeFactor);
+			head->groupOps.clear();
+		}
+	}
+
+public:
+
 	// Default constructor to call from SurfaceDcpse
 	// to initialize protected members
 	Dcpse(
@@ -160,27 +662,22 @@ public:
 	template<unsigned int prp>
 	void DrawKernel(vector_type &particles, int k)
 	{
-		Support support = localSupports.get(k);
-		size_t xpK = k;
-		size_t kerOff = kerOffsets.get(k);
-		auto & keys = support.getKeys();
-		for (int i = 0 ; i < keys.size() ; i++)
+		size_t kerOff = getKernelOffset(k);
+		size_t N = localSupports.getRowSize(k);
+		for (int i = 0 ; i < N ; i++)
 		{
-			size_t xqK = keys.get(i);
-			particles.template getProp<prp>(xqK) += calcKernels.get(kerOff+i);
+			size_t xqK = localSupports.getKey(k,i);
+			particles.template getProp<prp>(xqK) += (T)calcKernels.get(kerOff+i);
 		}
 	}
 
 	template<unsigned int prp>
 	void DrawKernelNN(vector_type &particles, int k)
 	{
-		Support support = localSupports.get(k);
-		size_t xpK = k;
-		size_t kerOff = kerOffsets.get(k);
-		auto & keys = support.getKeys();
-		for (int i = 0 ; i < keys.size() ; i++)
+		size_t N = localSupports.getRowSize(k);
+		for (int i = 0 ; i < N ; i++)
 		{
-			size_t xqK = keys.get(i);
+			size_t xqK = localSupports.getKey(k,i);
 			particles.template getProp<prp>(xqK) = 1.0;
 		}
 	}
@@ -188,68 +685,56 @@ public:
 	template<unsigned int prp>
 	void DrawKernel(vector_type &particles, int k, int i)
 	{
-
-		Support support = localSupports.get(k);
-		size_t xpK = k;
-		size_t kerOff = kerOffsets.get(k);
-		auto & keys = support.getKeys();
-		for (int i = 0 ; i < keys.size() ; i++)
+		size_t kerOff = getKernelOffset(k);
+		size_t N = localSupports.getRowSize(k);
+		for (int i = 0 ; i < N ; i++)
 		{
-			size_t xqK = keys.get(i);
-			particles.template getProp<prp>(xqK)[i] += calcKernels.get(kerOff+i);
+			size_t xqK = localSupports.getKey(k,i);
+			particles.template getProp<prp>(xqK)[i] += (T)calcKernels.get(kerOff+i);
 		}
 	}
 
 	/*
 	 * breif Particle to Particle Interpolation Evaluation
+	 *
+	 * The properties are given as pairs (from,to): p2p<0,1,2,3>() interpolate the property 0 of particlesFrom in the
+	 * property 1 of particlesTo and 2 in 3, reading the support and the kernels of every particle once
 	 */
-	template<unsigned int prp1,unsigned int prp2>
+	template<unsigned int prp1,unsigned int prp2, unsigned int ... prps>
 	void p2p()
 	{
-		typedef typename std::remove_reference<decltype(particlesTo.template getProp<prp2>(0))>::type T2;
+		static_assert(sizeof...(prps) % 2 == 0, "p2p require pairs of properties (from,to)");
 
-		auto it = particlesTo.getDomainIterator();
-		auto supportsIt = localSupports.begin();
-		auto epsItInvPow = localEpsInvPow.begin();
-		while (it.isNext()){
-			double epsInvPow = *epsItInvPow;
-			T2 Dfxp = 0;
-			Support support = *supportsIt;
-			size_t xpK = support.getReferencePointKey();
-			//Point<dim, typename vector_type::stype> xp = particlesTo.getPos(xpK);
-			//T fxp = sign * particlesTo.template getProp<fValuePos>(xpK);
-			size_t kerOff = kerOffsets.get(xpK);
-			auto & keys = support.getKeys();
-			for (int i = 0 ; i < keys.size() ; i++)
-			{
-				size_t xqK = keys.get(i);
-				T2 fxq = particlesFrom.template getProp<prp1>(xqK);
-				Dfxp += fxq * calcKernels.get(kerOff+i);
-			}
-			Dfxp = epsInvPow*Dfxp;
-			//
-			//T trueDfxp = particles.template getProp<2>(xpK);
-			// Store Dfxp in the right position
-			particlesTo.template getProp<prp2>(xpK) = Dfxp;
-			//
-			++it;
-			++supportsIt;
-			++epsItInvPow;
-		}
+		if (localSupports.is32bitKeys())
+		{p2p_impl<unsigned int,prp1,prp2,prps...>();}
+		else
+		{p2p_impl<size_t,prp1,prp2,prps...>();}
 	}
 
+	/*! \brief Version of the save format, written after the tag "DCPSESV"
+	 *
+	 * 1: SupportCSR supports and one kernel per support key (the kernel offsets are not stored). The files written
+	 * before it (per-particle supports and kernel offsets, no tag) are rejected by load
+	 *
+	 */
+	static const uint64_t saveVersion = 1;
+
 	/*! \brief Save the DCPSE computations
+	 *
+	 * The file starts with the tag "DCPSESV" and saveVersion, followed by the packed supports, epsilons and kernels
 	 *
 	 */
 	void save(const std::string &file){
 		auto & v_cl=create_vcluster();
 		size_t req = 0;
 
+		openfpm::vector<kernel_type> rowKernels;
+		const openfpm::vector<kernel_type> & ker = getRowKernels(rowKernels);
+
 		Packer<decltype(localSupports),HeapMemory>::packRequest(localSupports,req);
 		Packer<decltype(localEps),HeapMemory>::packRequest(localEps,req);
 		Packer<decltype(localEpsInvPow),HeapMemory>::packRequest(localEpsInvPow,req);
-		Packer<decltype(calcKernels),HeapMemory>::packRequest(calcKernels,req);
-		Packer<decltype(kerOffsets),HeapMemory>::packRequest(kerOffsets,req);
+		Packer<decltype(calcKernels),HeapMemory>::packRequest(ker,req);
 
 		// allocate the memory
 		HeapMemory pmem;
@@ -261,8 +746,7 @@ public:
 		Packer<decltype(localSupports),HeapMemory>::pack(mem,localSupports,sts);
 		Packer<decltype(localEps),HeapMemory>::pack(mem,localEps,sts);
 		Packer<decltype(localEpsInvPow),HeapMemory>::pack(mem,localEpsInvPow,sts);
-		Packer<decltype(calcKernels),HeapMemory>::pack(mem,calcKernels,sts);
-		Packer<decltype(kerOffsets),HeapMemory>::pack(mem,kerOffsets,sts);
+		Packer<decltype(calcKernels),HeapMemory>::pack(mem,ker,sts);
 
 		// Save into a binary file
 		std::ofstream dump (file+"_"+std::to_string(v_cl.rank()), std::ios::out | std::ios::binary);
@@ -270,12 +754,19 @@ public:
 		{   std::cerr << __FILE__ << ":" << __LINE__ <<" Unable to write since dump is open at rank "<<v_cl.rank()<<std::endl;
 			return;
 			}
+		char magic[8] = {};
+		memcpy(magic,"DCPSESV",8);
+		uint64_t version = saveVersion;
+		dump.write (magic, sizeof(magic));
+		dump.write ((const char *)&version, sizeof(version));
 		dump.write ((const char *)pmem.getPointer(), pmem.size());
 		return;
 	}
 
 	/*! \brief Load the DCPSE computations
 	 *
+	 * Only the files with the tag and the version of save are accepted, the files of the previous format are
+	 * rejected with an error and the operator is left untouched (rebuild it and save it again)
 	 *
 	 */
 	void load(const std::string & file)
@@ -299,6 +790,21 @@ public:
 		{//some message here maybe
 			return;}
 
+		char magic[8] = {};
+		uint64_t version = 0;
+		if (sz >= sizeof(magic) + sizeof(version))
+		{
+			input.read(magic, sizeof(magic));
+			input.read((char *)&version, sizeof(version));
+		}
+
+		if (memcmp(magic,"DCPSESV",8) != 0 || version != saveVersion)
+		{
+			std::cerr << __FILE__ << ":" << __LINE__ << " error, " << file << " has not been written by save with format version " << saveVersion << " (files of the previous format are not supported, rebuild the operator and save it again)" << std::endl;
+			return;
+		}
+		sz -= sizeof(magic) + sizeof(version);
+
 		// Create the HeapMemory and the ExtPreAlloc memory
 		size_t req = 0;
 		req += sz;
@@ -319,10 +825,81 @@ public:
 		Unpacker<decltype(localEps),HeapMemory>::unpack(mem,localEps,ps);
 		Unpacker<decltype(localEpsInvPow),HeapMemory>::unpack(mem,localEpsInvPow,ps);
 		Unpacker<decltype(calcKernels),HeapMemory>::unpack(mem,calcKernels,ps);
-		Unpacker<decltype(kerOffsets),HeapMemory>::unpack(mem,kerOffsets,ps);
+		kerOffsets.clear();
+
+		// The positions used to compute the loaded kernels are unknown, the next incremental update is a full update
+		buildPosTo.clear();
+		buildPosFrom.clear();
 		return;
 	}
 
+	/*! \brief Save the kernels in the DCPSE kernel cache format (one file per processor)
+	 *
+	 * The file has a fixed header (format version, dimension, operator, rCut, number of particles and a hash of the
+	 * positions) followed by raw sections aligned to 64 bytes: row offsets, support keys, epsilons and kernels.
+	 * It can be mapped in memory by loadKernelCache without unpacking.
+	 *
+	 * \param file file name (the rank is appended)
+	 *
+	 */
+	void saveKernelCache(const std::string & file)
+	{
+		auto & v_cl=create_vcluster();
+
+		dcpse_cache_header h;
+		fillCacheHeader(h);
+
+		size_t keyBytes = (localSupports.is32bitKeys())?sizeof(unsigned int):sizeof(size_t);
+		h.keyBytes = keyBytes;
+		h.nRows = localSupports.size();
+		h.nKeys = localSupports.getNKeys();
+
+		h.offRowOffsets = cacheAlign(sizeof(dcpse_cache_header));
+		h.offKeys = cacheAlign(h.offRowOffsets + (h.nRows+1)*sizeof(size_t));
+		h.offEps = cacheAlign(h.offKeys + h.nKeys*keyBytes);
+		h.offEpsInvPow = cacheAlign(h.offEps + h.nRows*sizeof(T));
+		h.offKernels = cacheAlign(h.offEpsInvPow + h.nRows*sizeof(T));
+		h.fileSize = h.offKernels + h.nKeys*sizeof(kernel_type);
+
+		std::ofstream dump (file+"_"+std::to_string(v_cl.rank()), std::ios::out | std::ios::binary);
+		if (dump.is_open() == false)
+		{
+			std::cerr << __FILE__ << ":" << __LINE__ <<" Unable to write the kernel cache at rank "<<v_cl.rank()<<std::endl;
+			return;
+		}
+
+		writeCacheSection(dump,0,&h,sizeof(dcpse_cache_header));
+		writeCacheSection(dump,h.offRowOffsets,localSupports.getRowOffsetsPointer(),(h.nRows+1)*sizeof(size_t));
+		writeCacheSection(dump,h.offKeys,localSupports.getKeysPointer(),h.nKeys*keyBytes);
+		writeCacheSection(dump,h.offEps,localEps.getPointer(),h.nRows*sizeof(T));
+		writeCacheSection(dump,h.offEpsInvPow,localEpsInvPow.getPointer(),h.nRows*sizeof(T));
+		openfpm::vector<kernel_type> rowKernels;
+		writeCacheSection(dump,h.offKernels,getRowKernels(rowKernels).getPointer(),h.nKeys*sizeof(kernel_type));
+	}
+
+	/*! \brief Load the kernels from a file written by saveKernelCache
+	 *
+	 * The file is mapped in memory and used only if the header matches this operator and the current particles
+	 * (same positions), otherwise the operator is left untouched. The result is the same on all the processors,
+	 * so on false the operator can be rebuilt with initializeUpdate.
+	 *
+	 * \param file file name (the rank is appended)
+	 *
+	 * \return true if the kernels has been loaded
+	 *
+	 */
+	bool loadKernelCache(const std::string & file)
+	{
+		auto & v_cl=create_vcluster();
+
+		size_t ok = loadKernelCacheLocal(file+"_"+std::to_string(v_cl.rank()));
+
+		v_cl.min(ok);
+		v_cl.execute();
+
+		return ok != 0;
+	}
+
 	void checkMomenta(vector_type &particles)
 	{
 		openfpm::vector<aggregate<double,double>> momenta;
@@ -338,25 +915,22 @@ public:
 		}
 
 		auto it = particles.getDomainIterator();
-		auto supportsIt = localSupports.begin();
-		auto epsIt = localEps.begin();
 		while (it.isNext())
 		{
-			double eps = *epsIt;
+			size_t xpK = particles.getOriginKey(it.get()).getKey();
+			double eps = localEps.get(xpK);
 
 			for (int i = 0 ; i < momenta.size() ; i++)
 			{
 				momenta_accu.template get<0>(i) =  0.0;
 			}
 
-			Support support = *supportsIt;
-			size_t xpK = support.getReferencePointKey();
-			Point<dim, T> xp = particles.getPos(support.getReferencePointKey());
-			size_t kerOff = kerOffsets.get(xpK);
-			auto & keys = support.getKeys();
-			for (int i = 0 ; i < keys.size() ; i++)
+			Point<dim, T> xp = particles.getPos(xpK);
+			size_t kerOff = getKernelOffset(xpK);
+			size_t NN = localSupports.getRowSize(xpK);
+			for (int i = 0 ; i < NN ; i++)
 			{
-				size_t xqK = keys.get(i);
+				size_t xqK = localSupports.getKey(xpK,i);
 				Point<dim, T> xq = particles.getPosOrig(xqK);
 				Point<dim, T> normalizedArg = (xp - xq) / eps;
 
@@ -391,8 +965,6 @@ public:
 
 			//
 			++it;
-			++supportsIt;
-			++epsIt;
 		}
 
 		for (size_t i = 0 ; i < momenta.size() ; i++)
@@ -411,52 +983,57 @@ public:
 	 */
 	template<unsigned int fValuePos, unsigned int DfValuePos>
 	void computeDifferentialOperator(vector_type &particles) {
-		char sign = 1;
-		if (differentialOrder % 2 == 0) {
-			sign = -1;
-		}
-
-		auto it = particles.getDomainIterator();
-		auto supportsIt = localSupports.begin();
-		auto epsItInvPow = localEpsInvPow.begin();
-		while (it.isNext()) {
-			double epsInvPow = *epsItInvPow;
-
-			T Dfxp = 0;
-			Support support = *supportsIt;
-			size_t xpK = support.getReferencePointKey();
-			//Point<dim, typename vector_type::stype> xp = particles.getPos(support.getReferencePointKey());
-			T fxp = sign * particles.template getProp<fValuePos>(xpK);
-			size_t kerOff = kerOffsets.get(xpK);
-			auto & keys = support.getKeys();
-			for (int i = 0 ; i < keys.size() ; i++)
-			{
-				size_t xqK = keys.get(i);
-				T fxq = particles.template getProp<fValuePos>(xqK);
+		NUMERICS_TRACE_SPAN("dcpse.apply");
 
-				Dfxp += (fxq + fxp) * calcKernels.get(kerOff+i);
-			}
-			Dfxp *= epsInvPow;
-			//
-			//T trueDfxp = particles.template getProp<2>(xpK);
-			// Store Dfxp in the right position
-			particles.template getProp<DfValuePos>(xpK) = Dfxp;
-			//
-			++it;
-			++supportsIt;
-			++epsItInvPow;
-		}
+		if (localSupports.is32bitKeys())
+		{computeDifferentialOperator_impl<unsigned int,fValuePos,DfValuePos>(particles);}
+		else
+		{computeDifferentialOperator_impl<size_t,fValuePos,DfValuePos>(particles);}
 	}
 
 
-	/*! \brief Get the number of neighbours
+	/*! \brief Like computeDifferentialOperator, the ghost of fValuePos is updated while the particles with
+	 *         only local neighbours are evaluated
 	 *
-	 * \return the number of neighbours
+	 * A non-blocking ghost_get of fValuePos is started (the ghost labelling of the last ghost_get is reused, so
+	 * the particles must not have moved since), then the interior particles are evaluated, and the ones with
+	 * ghost neighbours only after the ghost arrived. There is no need to call ghost_get before
+	 *
+	 * \tparam fValuePos property of the f values
+	 * \tparam DfValuePos property where to store Df
+	 *
+	 * \param particles particle set
+	 *
+	 */
+	template<unsigned int fValuePos, unsigned int DfValuePos>
+	void computeDifferentialOperatorOverlap(vector_type &particles) {
+		NUMERICS_TRACE_SPAN("dcpse.apply_overlap");
+
+		{
+			NUMERICS_TRACE_SPAN("dcpse.ghost_get");
+			particles.template Ighost_get<fValuePos>(SKIP_LABELLING);
+		}
+
+		if (localSupports.is32bitKeys())
+		{computeDifferentialOperatorOverlap_impl<unsigned int,fValuePos,DfValuePos>(particles);}
+		else
+		{computeDifferentialOperatorOverlap_impl<size_t,fValuePos,DfValuePos>(particles);}
+	}
+
+	/*! \brief Get the number of neighbours
+	 *
+	 * \return the number of neighbours
 	 *
 	 */
 	inline int getNumNN(const vect_dist_key_dx &key)
 	{
-		return localSupports.get(key.getKey()).size();
+		return localSupports.getRowSize(key.getKey());
+	}
+
+	//! Size of the monomial basis (the moment matrix of every particle has this size)
+	inline size_t getBasisSize() const
+	{
+		return monomialBasis.size();
 	}
 
 	/*! \brief Get the coefficent j (Neighbour) of the particle key
@@ -469,7 +1046,7 @@ public:
 	 */
 	inline T getCoeffNN(const vect_dist_key_dx &key, int j)
 	{
-		size_t base = kerOffsets.get(key.getKey());
+		size_t base = getKernelOffset(key.getKey());
 		return calcKernels.get(base + j);
 	}
 
@@ -480,9 +1057,312 @@ public:
  */
 	inline size_t getIndexNN(const vect_dist_key_dx &key, int j)
 	{
-		return localSupports.get(key.getKey()).getKeys().get(j);
+		return localSupports.getKey(key.getKey(),j);
+	}
+
+
+	/*! \brief Get the supports of all the local particles
+	 *
+	 * The supports are returned by reference, the neighbours of a particle can be accessed
+	 * without copy with getLocalSupports().template getSupport<key_type>(p)
+	 *
+	 * \return the compressed supports
+	 *
+	 */
+	inline const SupportCSR & getLocalSupports() const
+	{
+		return localSupports;
+	}
+
+	/*! \brief Get the kernel weights, the weight of the neighbour j of p is at getKernelOffset(p)+j
+	 *
+	 * \return the kernel weights
+	 *
+	 */
+	inline const openfpm::vector<kernel_type> & getKernels() const
+	{
+		return calcKernels;
+	}
+
+	/*! \brief Memory used by the operator in byte
+	 *
+	 * Supports, kernels, eps arrays and the bookkeeping of the updates, the particles are not counted
+	 *
+	 * \return the memory in byte
+	 *
+	 */
+	size_t getMemoryUsage() const
+	{
+		return localSupports.getMemoryUsage()
+		       + (localEps.size() + localEpsInvPow.size() + nSpacings.size() + rowCondition.size())*sizeof(T)
+		       + calcKernels.size()*sizeof(kernel_type)
+		       + (kerOffsets.size() + overlapBoundaryRows.size() + subsetRows.size())*sizeof(size_t)
+		       + (buildPosTo.size() + buildPosFrom.size())*sizeof(Point<dim,T>)
+		       + lowOrderRow.size();
+	}
+
+	/*! \brief Maximum distance, per direction, between a particle and the neighbours in its support
+	 *
+	 * A ghost with this extent contains all the neighbours used by the operator, so it can replace a conservative
+	 * ghost (for example rCut plus a margin). It is collective
+	 *
+	 * \return the maximum of |xq - xp| in every direction over all the supports of all the processors
+	 *
+	 */
+	Point<dim,T> getSupportExtent()
+	{
+		auto & v_cl=create_vcluster();
+
+		T extent[dim];
+		for (size_t d = 0 ; d < dim ; d++)
+		{extent[d] = 0;}
+
+		for (size_t p = 0 ; p < localSupports.size() ; p++)
+		{
+			if (localSupports.getRowSize(p) == 0) {continue;}
+
+			Point<dim,T> xp = particlesTo.getPosOrig(p);
+			for (size_t j = 0 ; j < localSupports.getRowSize(p) ; j++)
+			{
+				Point<dim,T> xq = particlesFrom.getPosOrig(localSupports.getKey(p,j));
+				for (size_t d = 0 ; d < dim ; d++)
+				{extent[d] = std::max(extent[d],(T)fabs(xq[d] - xp[d]));}
+			}
+		}
+
+		for (size_t d = 0 ; d < dim ; d++)
+		{v_cl.max(extent[d]);}
+		v_cl.execute();
+
+		Point<dim,T> ext;
+		for (size_t d = 0 ; d < dim ; d++)
+		{ext[d] = extent[d];}
+		return ext;
+	}
+
+	/*! \brief Offset in getKernels() of the kernel of the particle p
+	 *
+	 * It is getLocalSupports().getRowOffset(p), unless the lattice particles share their kernel (see latticeTOL)
+	 *
+	 * \param p particle
+	 *
+	 * \return the offset of the weight of the first neighbour
+	 *
+	 */
+	inline size_t getKernelOffset(size_t p) const
+	{
+		return (kerOffsets.size() == 0)?localSupports.getRowOffset(p):kerOffsets.get(p);
+	}
+
+	/*! \brief Print the statistics of the last construction of several operators with one batched reduction
+	 *
+	 * The construction keeps the statistics local to every processor, so building an operator does not synchronize
+	 * the processors. Here all the values of all the operators are queued and reduced with one execute, then
+	 * processor 0 prints one line per operator, with the supports enlarged by CONDITION_ADAPTIVE and the kernels
+	 * recomputed if the last update was incremental. It is collective.
+	 *
+	 * \param ops operators
+	 *
+	 */
+	static void printStatistics(const std::vector<Dcpse *> & ops)
+	{
+		auto & v_cl=create_vcluster();
+
+		std::vector<T> eps(ops.size()),spacing(ops.size()),maxSpacing(ops.size()),minSpacing(ops.size());
+		std::vector<size_t> rows(ops.size()),grown(ops.size()),recomputed(ops.size()),nTot(ops.size());
+		for (size_t i = 0 ; i < ops.size() ; i++)
+		{
+			eps[i] = ops[i]->statEps;
+			spacing[i] = ops[i]->statSpacing;
+			maxSpacing[i] = ops[i]->statMaxSpacing;
+			minSpacing[i] = ops[i]->statMinSpacing;
+			rows[i] = ops[i]->statRows;
+			grown[i] = ops[i]->statGrown;
+			recomputed[i] = ops[i]->statRecomputed;
+			nTot[i] = ops[i]->particlesTo.size_local();
+
+			v_cl.sum(eps[i]);
+			v_cl.sum(spacing[i]);
+			v_cl.max(maxSpacing[i]);
+			v_cl.min(minSpacing[i]);
+			v_cl.sum(rows[i]);
+			v_cl.sum(grown[i]);
+			v_cl.sum(recomputed[i]);
+			v_cl.sum(nTot[i]);
+		}
+		v_cl.execute();
+
+		if (v_cl.rank() != 0)
+		{return;}
+
+		for (size_t i = 0 ; i < ops.size() ; i++)
+		{
+			std::cout<<"DCPSE Operator Construction Complete. The global avg spacing in the support <h> is: "<<ops[i]->HOverEpsilon*eps[i]/(T(rows[i]))<<" (c="<<ops[i]->HOverEpsilon<<"). Avg:"<<spacing[i]/(T(rows[i]))<<" Range:["<<minSpacing[i]<<","<<maxSpacing[i]<<"]."<<std::endl;
+
+			if (ops[i]->opt == support_options::CONDITION_ADAPTIVE)
+			{std::cout<<"DCPSE adaptive support: "<<grown[i]<<" ill-conditioned supports enlarged."<<std::endl;}
+			if (ops[i]->statIncremental == true)
+			{std::cout<<"DCPSE Operator Incremental Update Complete. Recomputed "<<recomputed[i]<<" of "<<nTot[i]<<" kernels."<<std::endl;}
+		}
+	}
+
+	//! Print the statistics of the last construction of this operator, see printStatistics(ops). It is collective
+	void printStatistics()
+	{
+		printStatistics(std::vector<Dcpse *>(1,this));
+	}
+
+	/*! \brief Get the kernel weights with one weight per support key, the weight of the neighbour j of p is at getLocalSupports().getRowOffset(p)+j
+	 *
+	 * \param tmp storage for the weights of the shared lattice kernels replicated on every row
+	 *
+	 * \return getKernels() if no kernel is shared, tmp otherwise
+	 *
+	 */
+	const openfpm::vector<kernel_type> & getRowKernels(openfpm::vector<kernel_type> & tmp) const
+	{
+		if (kerOffsets.size() == 0)
+		{return calcKernels;}
+
+		tmp.resize(localSupports.getNKeys());
+		for (size_t p = 0 ; p < localSupports.size() ; p++)
+		{
+			size_t off = localSupports.getRowOffset(p);
+			for (size_t j = 0 ; j < localSupports.getRowSize(p) ; j++)
+			{tmp.get(off+j) = calcKernels.get(kerOffsets.get(p)+j);}
+		}
+
+		return tmp;
+	}
+
+	/*! \brief Compute the global row and column numbering used by getSparseMatrix
+	 *
+	 * The particles are numbered processor by processor in the same way of DCPSE_scheme. The ghost of
+	 * particlesFrom get the number of their owner, so they must be in the order produced by a ghost_get
+	 *
+	 * \param colIds global column of each local and ghost particle of particlesFrom (by key)
+	 * \param rowStart global row of the first local particle of particlesTo
+	 * \param nRows total number of rows
+	 * \param nCols total number of columns
+	 *
+	 */
+	void getGlobalIds(openfpm::vector<size_t> & colIds, size_t & rowStart, size_t & nRows, size_t & nCols)
+	{
+		auto & v_cl = create_vcluster();
+
+		openfpm::vector<size_t> nTo;
+		openfpm::vector<size_t> nFrom;
+		size_t szTo = particlesTo.size_local_orig();
+		size_t szFrom = particlesFrom.size_local_orig();
+		v_cl.allGather(szTo,nTo);
+		v_cl.allGather(szFrom,nFrom);
+		v_cl.execute();
+
+		rowStart = 0;
+		size_t colStart = 0;
+		nRows = 0;
+		nCols = 0;
+		for (size_t i = 0 ; i < nTo.size() ; i++)
+		{
+			if (i < v_cl.getProcessUnitID())
+			{
+				rowStart += nTo.get(i);
+				colStart += nFrom.get(i);
+			}
+			nRows += nTo.get(i);
+			nCols += nFrom.get(i);
+		}
+
+		// The ghost numbering is communicated with a particle set that has the same positions
+		vector_dist<dim,T,aggregate<size_t>> p_map(particlesFrom.getDecomposition(),0);
+		p_map.resize(szFrom);
+		for (size_t i = 0 ; i < szFrom ; i++)
+		{
+			p_map.getPos(i) = particlesFrom.getPosOrig(i);
+			p_map.template getProp<0>(i) = colStart + i;
+		}
+		p_map.template ghost_get<0>();
+
+		colIds.resize(p_map.size_local_with_ghost());
+		for (size_t i = 0 ; i < p_map.size_local_with_ghost() ; i++)
+		{colIds.get(i) = p_map.template getProp<0>(i);}
+	}
+
+	/*! \brief Add the coefficients of the row of the particle p
+	 *
+	 * The neighbours are added in the order of the support and the particle itself at the end
+	 * (when the operator is evaluated on the same set)
+	 *
+	 * \param trpl triplets
+	 * \param p particle (origin key in particlesTo)
+	 * \param colIds see getGlobalIds
+	 * \param rowStart see getGlobalIds
+	 * \param coeff multiplicative coefficient
+	 *
+	 */
+	template<typename triplet_type>
+	void addRowTriplets(openfpm::vector<triplet_type> & trpl, size_t p,
+						const openfpm::vector<size_t> & colIds, size_t rowStart, T coeff = 1.0)
+	{
+		size_t NN = localSupports.getRowSize(p);
+		if (NN == 0)
+		{return;}
+
+		size_t kerOff = getKernelOffset(p);
+		T prefactor = coeff * localEpsInvPow.get(p);
+		T diag = 0.0;
+
+		for (size_t j = 0 ; j < NN ; j++)
+		{
+			size_t xqK = localSupports.getKey(p,j);
+			if (xqK >= colIds.size())
+			{
+				std::cerr << __FILE__ << ":" << __LINE__ << " error, the neighbour " << xqK << " of the particle " << p << " has no global id, a ghost_get is missing" << std::endl;
+				continue;
+			}
+
+			T w = prefactor * (T)calcKernels.get(kerOff+j);
+			trpl.add();
+			trpl.last().row() = rowStart + p;
+			trpl.last().col() = colIds.get(xqK);
+			trpl.last().value() = w;
+			diag += getSign() * w;
+		}
+
+		// Between two different sets (p2p) the operator has no term on the particle itself
+		if ((void *)&particlesFrom != (void *)&particlesTo)
+		{return;}
+
+		trpl.add();
+		trpl.last().row() = rowStart + p;
+		trpl.last().col() = colIds.get(p);
+		trpl.last().value() = diag;
 	}
 
+	/*! \brief Materialise the operator as a sparse matrix
+	 *
+	 * Applying the matrix to the vector of the values of particlesFrom (numbered as in getGlobalIds) gives
+	 * the same result of computeDifferentialOperator (or of p2p when particlesFrom and particlesTo differ,
+	 * in that case the rows are the particles of particlesTo)
+	 *
+	 * \param M sparse matrix (Eigen or PETSc backend)
+	 * \param coeff multiplicative coefficient
+	 *
+	 */
+	template<typename SparseMatrix_type>
+	void getSparseMatrix(SparseMatrix_type & M, T coeff = 1.0)
+	{
+		openfpm::vector<size_t> colIds;
+		size_t rowStart, nRows, nCols;
+		getGlobalIds(colIds,rowStart,nRows,nCols);
+
+		M.resize(nRows,nCols,particlesTo.size_local_orig(),particlesFrom.size_local_orig());
+
+		auto & trpl = M.getMatrixTriplets();
+		trpl.clear();
+		for (size_t p = 0 ; p < localSupports.size() ; p++)
+		{addRowTriplets(trpl,p,colIds,rowStart,coeff);}
+	}
 
 	inline T getSign()
 	{
@@ -512,43 +1392,18 @@ public:
 									 op_type &o1) -> decltype(is_scalar<std::is_fundamental<decltype(o1.value(
 			key))>::value>::analyze(key, o1)) {
 
-		typedef decltype(is_scalar<std::is_fundamental<decltype(o1.value(key))>::value>::analyze(key, o1)) expr_type;
-
-		T sign = 1.0;
-		if (differentialOrder % 2 == 0) {
-			sign = -1;
-		}
-
-		double eps = localEps.get(key.getKey());
-		double epsInvPow = localEpsInvPow.get(key.getKey());
-
-		auto &particles = o1.getVector();
-
 #ifdef SE_CLASS1
+		auto &particles = o1.getVector();
 		if(particles.getMapCtr()!=this->getUpdateCtr())
 		{
 			std::cerr<<__FILE__<<":"<<__LINE__<<" Error: You forgot a DCPSE operator update after map."<<std::endl;
 		}
 #endif
 
-		expr_type Dfxp = 0;
-		Support support = localSupports.get(key.getKey());
-		size_t xpK = support.getReferencePointKey();
-		//Point<dim, T> xp = particles.getPos(xpK);
-		expr_type fxp = sign * o1.value(key);
-		size_t kerOff = kerOffsets.get(xpK);
-		auto & keys = support.getKeys();
-		for (int i = 0 ; i < keys.size() ; i++)
-		{
-			size_t xqK = keys.get(i);
-			expr_type fxq = o1.value(vect_dist_key_dx(xqK));
-			Dfxp = Dfxp + (fxq + fxp) * calcKernels.get(kerOff+i);
-		}
-		Dfxp = Dfxp * epsInvPow;
-		//
-		//T trueDfxp = particles.template getProp<2>(xpK);
-		// Store Dfxp in the right position
-		return Dfxp;
+		if (localSupports.is32bitKeys())
+		{return computeDifferentialOperatorSupport(key,o1,localSupports.template getSupport<unsigned int>(key.getKey()));}
+
+		return computeDifferentialOperatorSupport(key,o1,localSupports.template getSupport<size_t>(key.getKey()));
 	}
 
 	/**
@@ -566,44 +1421,18 @@ public:
 									 int i) -> typename decltype(is_scalar<std::is_fundamental<decltype(o1.value(
 			key))>::value>::analyze(key, o1))::coord_type {
 
-		typedef typename decltype(is_scalar<std::is_fundamental<decltype(o1.value(key))>::value>::analyze(key, o1))::coord_type expr_type;
-
-		//typedef typename decltype(o1.value(key))::blabla blabla;
-
-		T sign = 1.0;
-		if (differentialOrder % 2 == 0) {
-			sign = -1;
-		}
-
-		double eps = localEps.get(key.getKey());
-		double epsInvPow = localEpsInvPow.get(key.getKey());
-
-		auto &particles = o1.getVector();
 #ifdef SE_CLASS1
+		auto &particles = o1.getVector();
 		if(particles.getMapCtr()!=this->getUpdateCtr())
 		{
 			std::cerr<<__FILE__<<":"<<__LINE__<<" Error: You forgot a DCPSE operator update after map."<<std::endl;
 		}
 #endif
 
-		expr_type Dfxp = 0;
-		Support support = localSupports.get(key.getKey());
-		size_t xpK = support.getReferencePointKey();
-		//Point<dim, T> xp = particles.getPos(xpK);
-		expr_type fxp = sign * o1.value(key)[i];
-		size_t kerOff = kerOffsets.get(xpK);
-		auto & keys = support.getKeys();
-		for (int j = 0 ; j < keys.size() ; j++)
-		{
-			size_t xqK = keys.get(j);
-			expr_type fxq = o1.value(vect_dist_key_dx(xqK))[i];
-			Dfxp = Dfxp + (fxq + fxp) * calcKernels.get(kerOff+j);
-		}
-		Dfxp = Dfxp * epsInvPow;
-		//
-		//T trueDfxp = particles.template getProp<2>(xpK);
-		// Store Dfxp in the right position
-		return Dfxp;
+		if (localSupports.is32bitKeys())
+		{return computeDifferentialOperatorSupport(key,o1,i,localSupports.template getSupport<unsigned int>(key.getKey()));}
+
+		return computeDifferentialOperatorSupport(key,o1,i,localSupports.template getSupport<size_t>(key.getKey()));
 	}
 
 	void initializeUpdate(vector_type &particlesFrom,vector_type2 &particlesTo)
@@ -612,155 +1441,1646 @@ public:
 		update_ctr=particlesFrom.getMapCtr();
 #endif
 
+		// After a map the supports of the other operator are not valid anymore
+		isSharedLocalSupport = false;
 		localSupports.clear();
 		localEps.clear();
 		localEpsInvPow.clear();
 		calcKernels.clear();
-		kerOffsets.clear();
 		initializeStaticSize(particlesFrom,particlesTo, convergenceOrder, rCut, supportSizeFactor);
 	}
 
+	/*! \brief Rebuild the operator on a new subset of the particles (after a map the keys of the old subset are not valid)
+	 *
+	 * \param particles particle set
+	 * \param subset keys of the particles where the operator is constructed
+	 *
+	 */
+	template<typename index_type>
+	void initializeUpdate(vector_type &particles, const openfpm::vector<index_type> & subset)
+	{
+		setSubset(subset);
+		initializeUpdate(particles);
+	}
+
 	void initializeUpdate(vector_type &particles)
 	{
 #ifdef SE_CLASS1
 		update_ctr=particles.getMapCtr();
 #endif
 
+		// After a map the supports of the other operator are not valid anymore
+		isSharedLocalSupport = false;
 		localSupports.clear();
 		localEps.clear();
 		localEpsInvPow.clear();
 		calcKernels.clear();
-		kerOffsets.clear();
 
 		initializeStaticSize(particles,particles, convergenceOrder, rCut, supportSizeFactor);
 	}
 
-protected:
-	void initializeStaticSize(vector_type &particlesFrom,vector_type2 &particlesTo,
-							  unsigned int convergenceOrder,
-							  T rCut,
-							  T supportSizeFactor, T adaptiveSizeFactor = 1.0) {
-#ifdef SE_CLASS1
-		this->update_ctr=particlesFrom.getMapCtr();
-#endif
-		this->rCut=rCut;
-		this->supportSizeFactor=supportSizeFactor;
-		this->convergenceOrder=convergenceOrder;
+	/*! \brief Rebuild the operator with a lower convergence order where an indicator is small (p-adaptivity)
+	 *
+	 * The particles with the property prp below threshold (smooth regions) get the monomial basis of order lowOrder
+	 * and a support sized for it, the others keep convergenceOrder. With RADIUS and ADAPTIVE the radius of their
+	 * support is scaled by (size of the low basis / size of the basis)^(1/dim), with the other options the support has
+	 * supportSizeFactor times the size of the low basis. The application is unchanged, every row has its own support and
+	 * kernel, so both construction and application are cheaper in the smooth regions.
+	 *
+	 * The marks are by key: initializeUpdate keeps them (like the subset), after a map call this again. They are
+	 * ignored with CONDITION_ADAPTIVE, latticeTOL, a support shared with another operator and in a group of operators
+	 *
+	 * \tparam prp indicator property
+	 *
+	 * \param particles particle set
+	 * \param lowOrder convergence order of the particles with indicator below threshold
+	 * \param threshold threshold on the indicator
+	 *
+	 */
+	template<unsigned int prp>
+	void initializeUpdateAdaptiveOrder(vector_type &particles, unsigned int lowOrder, T threshold)
+	{
+		lowOrderRow.resize(particles.size_local_orig());
+		lowOrderRow.fill(0);
+
+		auto it = particles.getDomainIterator();
+		while (it.isNext())
+		{
+			auto p = it.get();
+			lowOrderRow.get(particles.getOriginKey(p).getKey()) = (particles.template getProp<prp>(p) < threshold);
+			++it;
+		}
+
+		lowConvergenceOrder = lowOrder;
+		initializeUpdate(particles);
+	}
+
+	/*! \brief p-adaptivity driven by a smoothness estimate of the field fValuePos, see initializeUpdateAdaptiveOrder
+	 *
+	 * An operator of order lowOrder is built on all the particles and compared with the full order one: where
+	 * |D f - D_low f| <= threshold * max |D f| (maximum over all the processors) the low order resolves the field and
+	 * the particle gets it. It is collective and the ghost of fValuePos must be up to date
+	 *
+	 * \param particles particle set
+	 * \param lowOrder convergence order of the smooth particles
+	 * \param threshold relative difference between the two orders under which a particle is smooth
+	 *
+	 */
+	template<unsigned int fValuePos>
+	void initializeUpdateSmoothOrder(vector_type &particles, unsigned int lowOrder, T threshold)
+	{
 		auto & v_cl=create_vcluster();
-		if(this->opt==LOAD){
-			if(v_cl.rank()==0)
-			{std::cout<<"Warning: Creating empty DC-PSE operator! Please use update or load to get kernels."<<std::endl;}
+
+		// the estimate compares with the full order operator
+		if (lowOrderRow.size() != 0)
+		{
+			lowOrderRow.clear();
+			initializeUpdate(particles);
+		}
+
+		Dcpse low(particles,particles,differentialSignature,lowOrder,rCut,supportSizeFactor,
+		          (opt == support_options::CONDITION_ADAPTIVE)?support_options::N_PARTICLES:opt,dcpse_group_deferred());
+		low.HOverEpsilon = HOverEpsilon;
+		low.isSubset = isSubset;
+		low.subsetRows = subsetRows;
+		low.initializeStaticSize(particles,particles,lowOrder,rCut,supportSizeFactor);
+
+		openfpm::vector<T> diff;
+		diff.resize(particles.size_local_orig());
+		diff.fill(0);
+		T scale = 0;
+
+		auto it = particles.getDomainIterator();
+		while (it.isNext())
+		{
+			size_t xpK = particles.getOriginKey(it.get()).getKey();
+			T Df = applyRow<fValuePos>(particles,xpK);
+			diff.get(xpK) = fabs(Df - low.template applyRow<fValuePos>(particles,xpK));
+			scale = std::max(scale,(T)fabs(Df));
+			++it;
+		}
+
+		v_cl.max(scale);
+		v_cl.execute();
+
+		lowOrderRow.resize(particles.size_local_orig());
+		for (size_t i = 0 ; i < lowOrderRow.size() ; i++)
+		{lowOrderRow.get(i) = (diff.get(i) <= threshold * scale);}
+
+		lowConvergenceOrder = lowOrder;
+		initializeUpdate(particles);
+	}
+
+	//! Number of local rows built with the low convergence order (see initializeUpdateAdaptiveOrder)
+	size_t getNLowOrderRows() const
+	{
+		if (isOrderAdaptive() == false)
+		{return 0;}
+
+		size_t n = 0;
+		for (size_t i = 0 ; i < lowOrderRow.size() ; i++)
+		{n += (lowOrderRow.get(i) != 0);}
+
+		return n;
+	}
+
+	/*! \brief Rebuild the operator in background, the current kernels stay in use until finalizeUpdateAsync
+	 *
+	 * See initializeGroupAsync
+	 *
+	 * \param particles particle set
+	 *
+	 */
+	void initializeUpdateAsync(vector_type &particles)
+	{
+		if (&particles != &particlesFrom)
+		{
+			std::cerr << __FILE__ << ":" << __LINE__ << " error the operator must be rebuilt on the particles it was constructed on" << std::endl;
 			return;
 		}
+
+		initializeGroupAsync(std::vector<Dcpse *>({this}));
+	}
+
+	/*! \brief Swap in the kernels rebuilt by initializeUpdateAsync
+	 *
+	 * \param wait if the rebuild is still running wait for it, otherwise return false and keep the current kernels
+	 *
+	 * \return true if the new kernels have been swapped in
+	 *
+	 */
+	bool finalizeUpdateAsync(bool wait = false)
+	{
+		return finalizeGroupAsync(std::vector<Dcpse *>({this}),wait);
+	}
+
+	/*! \brief Update the operator recomputing only the kernels of the particles whose support changed
+	 *
+	 * A particle is recomputed if it, or one of the particles in its support, moved more than threshold from
+	 * the position used to compute its kernel. After a map a key that now refers to another particle shows up as
+	 * a displacement, so those particles are recomputed too. Particles entering the support of a particle that is not
+	 * recomputed are not detected, so threshold must be small compared to the spacing (like the skin of a Verlet list).
+	 * The stored positions are refreshed only for the particles that moved more than threshold, so slow drifts accumulate
+	 * until they are detected.
+	 *
+	 * If the number of particles changed, the support is shared with another operator, the operator is built on a
+	 * subset or with p-adaptivity, the kernels are shared by the lattice rows (see latticeTOL), or the positions of the last
+	 * construction are not known (for example after load), it falls back to initializeUpdate on all processors.
+	 * Apart from that decision the update does not synchronize the processors, the number of recomputed kernels
+	 * is reported by printStatistics.
+	 *
+	 * \param particlesFrom particles from which the operator is computed
+	 * \param particlesTo particles where the operator is evaluated
+	 * \param threshold displacement that triggers the re-computation
+	 *
+	 * \return the number of kernels recomputed by this processor
+	 *
+	 */
+	size_t initializeUpdateIncremental(vector_type &particlesFrom,vector_type2 &particlesTo, T threshold)
+	{
+		auto & v_cl=create_vcluster();
+
+		size_t fullUpdate = (isSharedLocalSupport == true ||
+		                     isSubset == true ||
+		                     lowOrderRow.size() != 0 ||
+		                     kerOffsets.size() != 0 ||
+		                     opt == LOAD ||
+		                     buildPosTo.size() == 0 ||
+		                     buildPosTo.size() != localSupports.size() ||
+		                     localSupports.size() != particlesTo.size_local_orig());
+
+		// the full update is collective, all the processors must take the same path
+		v_cl.max(fullUpdate);
+		v_cl.execute();
+
+		if (fullUpdate != 0)
+		{
+			initializeUpdate(particlesFrom,particlesTo);
+			return particlesTo.size_local();
+		}
+
+#ifdef SE_CLASS1
+		update_ctr=particlesFrom.getMapCtr();
+#endif
+
+		if (localSupports.is32bitKeys())
+		{return initializeUpdateIncremental_impl<unsigned int>(particlesFrom,particlesTo,threshold);}
+
+		return initializeUpdateIncremental_impl<size_t>(particlesFrom,particlesTo,threshold);
+	}
+
+	/*! \brief Update the operator recomputing only the kernels of the particles whose support changed
+	 *
+	 * \param particles particle set
+	 * \param threshold displacement that triggers the re-computation
+	 *
+	 * \return the number of kernels recomputed by this processor
+	 *
+	 */
+	size_t initializeUpdateIncremental(vector_type &particles, T threshold)
+	{
+		return initializeUpdateIncremental(particles,particles,threshold);
+	}
+
+	/*! \brief Remove the neighbours with a negligible weight from the supports and recompute the kernels
+	 *
+	 * In every row the neighbours with |w| < threshold * max|w| are dropped and the kernel is solved again on the
+	 * reduced support, so the moment conditions still hold exactly (the weights are not just truncated). A row keeps
+	 * at least minSizeFactor times the size of the monomial basis neighbours (the largest weights), so the moment
+	 * matrix stays well posed. The supports and the kernels are compacted in place, the sparse matrices assembled
+	 * from the operator (getSparseMatrix, DCPSE_scheme) get the reduced number of non-zeros.
+	 *
+	 * It must be called after the construction, a later initializeUpdate (or a row rebuilt by
+	 * initializeUpdateIncremental) uses the full support again. Operators that share the support or the kernels
+	 * (built from another operator, in a DcpseContext group, or with latticeTOL) cannot be pruned. It is collective
+	 *
+	 * \param particlesFrom particles from which the operator is computed
+	 * \param particlesTo particles where the operator is evaluated
+	 * \param threshold relative weight under which a neighbour is removed (for example 1e-3)
+	 * \param minSizeFactor minimum support size in units of the monomial basis size
+	 *
+	 * \return the number of weights removed on all the processors
+	 *
+	 */
+	size_t pruneKernels(vector_type &particlesFrom,vector_type2 &particlesTo, T threshold, T minSizeFactor = 1.5)
+	{
+		if (isSharedLocalSupport == true || groupOps.size() != 0 || kerOffsets.size() != 0)
+		{
+			std::cerr << __FILE__ << ":" << __LINE__ << " error, the support or the kernels of this operator are shared, it cannot be pruned" << std::endl;
+			return 0;
+		}
+
+		auto & v_cl=create_vcluster();
+
+		size_t removed;
+		if (localSupports.is32bitKeys())
+		{removed = pruneKernels_impl<unsigned int>(particlesFrom,particlesTo,threshold,minSizeFactor);}
+		else
+		{removed = pruneKernels_impl<size_t>(particlesFrom,particlesTo,threshold,minSizeFactor);}
+
+		v_cl.sum(removed);
+		v_cl.execute();
+
+		return removed;
+	}
+
+	/*! \brief Remove the neighbours with a negligible weight from the supports and recompute the kernels
+	 *
+	 * \param particles particle set
+	 * \param threshold relative weight under which a neighbour is removed
+	 * \param minSizeFactor minimum support size in units of the monomial basis size
+	 *
+	 * \return the number of weights removed on all the processors
+	 *
+	 */
+	size_t pruneKernels(vector_type &particles, T threshold, T minSizeFactor = 1.5)
+	{
+		return pruneKernels(particles,particles,threshold,minSizeFactor);
+	}
+
+protected:
+
+	//! Header of the DCPSE kernel cache file
+	struct dcpse_cache_header
+	{
+		char magic[8];
+		uint64_t version;
+		uint64_t dim;
+		uint64_t sizeofT;
+		uint64_t sizeofKernel;
+		uint64_t keyBytes;
+		uint64_t signature[dim];
+		uint64_t convergenceOrder;
+		double rCut;
+		double supportSizeFactor;
+		double HOverEpsilon;
+		uint64_t nRows;
+		uint64_t nKeys;
+		uint64_t positionHash;
+		uint64_t offRowOffsets;
+		uint64_t offKeys;
+		uint64_t offEps;
+		uint64_t offEpsInvPow;
+		uint64_t offKernels;
+		uint64_t fileSize;
+	};
+
+	static size_t cacheAlign(size_t off)
+	{
+		return (off + 63) / 64 * 64;
+	}
+
+	static void writeCacheSection(std::ofstream & dump, size_t off, const void * data, size_t size)
+	{
+		size_t pos = dump.tellp();
+		for ( ; pos < off ; pos++)
+		{dump.put(0);}
+
+		if (size != 0)
+		{dump.write((const char *)data, size);}
+	}
+
+	//! FNV-1a hash of the positions of the particles
+	uint64_t positionHash()
+	{
+		uint64_t hash = 14695981039346656037ull;
+
+		auto hashPos = [&](const Point<dim,T> & p) {
+			for (size_t d = 0 ; d < dim ; d++)
+			{
+				T x = p.get(d);
+				const unsigned char * b = (const unsigned char *)&x;
+				for (size_t i = 0 ; i < sizeof(T) ; i++)
+				{
+					hash ^= b[i];
+					hash *= 1099511628211ull;
+				}
+			}
+		};
+
+		auto it = particlesTo.getDomainIterator();
+		while (it.isNext()) {
+			size_t xpK = particlesTo.getOriginKey(it.get()).getKey();
+			hashPos(particlesTo.getPosOrig(xpK));
+			++it;
+		}
+
+		auto it2 = particlesFrom.getDomainIterator();
+		while (it2.isNext()) {
+			size_t xqK = particlesFrom.getOriginKey(it2.get()).getKey();
+			hashPos(particlesFrom.getPosOrig(xqK));
+			++it2;
+		}
+
+		return hash;
+	}
+
+	//! Fill the part of the header that identifies the operator and the particles
+	void fillCacheHeader(dcpse_cache_header & h)
+	{
+		memset(&h,0,sizeof(dcpse_cache_header));
+		memcpy(h.magic,"DCPSEKC",8);
+		h.version = 1;
+		h.dim = dim;
+		h.sizeofT = sizeof(T);
+		h.sizeofKernel = sizeof(kernel_type);
+		for (size_t i = 0 ; i < dim ; i++)
+		{h.signature[i] = differentialSignature.get(i);}
+		h.convergenceOrder = convergenceOrder;
+		h.rCut = rCut;
+		h.supportSizeFactor = supportSizeFactor;
+		h.HOverEpsilon = HOverEpsilon;
+		h.positionHash = positionHash();
+	}
+
+	//! Load the kernel cache of this processor, return 1 on success
+	size_t loadKernelCacheLocal(const std::string & file)
+	{
+		dcpse_cache_header ref;
+		fillCacheHeader(ref);
+
+		int fd = open(file.c_str(), O_RDONLY);
+		if (fd == -1)
+		{return 0;}
+
+		struct stat st;
+		if (fstat(fd,&st) != 0 || (size_t)st.st_size < sizeof(dcpse_cache_header))
+		{
+			close(fd);
+			return 0;
+		}
+
+		void * ptr = mmap(NULL, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+		close(fd);
+		if (ptr == MAP_FAILED)
+		{return 0;}
+
+		const char * base = (const char *)ptr;
+		const dcpse_cache_header & h = *(const dcpse_cache_header *)base;
+
+		bool match = memcmp(h.magic,ref.magic,8) == 0 &&
+		             h.version == ref.version &&
+		             h.dim == ref.dim &&
+		             h.sizeofT == ref.sizeofT &&
+		             h.sizeofKernel == ref.sizeofKernel &&
+		             memcmp(h.signature,ref.signature,sizeof(ref.signature)) == 0 &&
+		             h.convergenceOrder == ref.convergenceOrder &&
+		             h.rCut == ref.rCut &&
+		             h.supportSizeFactor == ref.supportSizeFactor &&
+		             h.HOverEpsilon == ref.HOverEpsilon &&
+		             h.positionHash == ref.positionHash &&
+		             h.nRows == particlesTo.size_local_orig() &&
+		             h.fileSize == (size_t)st.st_size &&
+		             (h.keyBytes == sizeof(unsigned int) || h.keyBytes == sizeof(size_t));
+
+		if (match == false)
+		{
+			munmap(ptr,st.st_size);
+			return 0;
+		}
+
+		const size_t * offsets = (const size_t *)(base + h.offRowOffsets);
+		if (h.keyBytes == sizeof(unsigned int))
+		{localSupports.assign(h.nRows,offsets,(const unsigned int *)(base + h.offKeys));}
+		else
+		{localSupports.assign(h.nRows,offsets,(const size_t *)(base + h.offKeys));}
+
+		localEps.resize(h.nRows);
+		localEpsInvPow.resize(h.nRows);
+		calcKernels.resize(h.nKeys);
+		if (h.nRows != 0)
+		{
+			memcpy(&localEps.get(0),base + h.offEps,h.nRows*sizeof(T));
+			memcpy(&localEpsInvPow.get(0),base + h.offEpsInvPow,h.nRows*sizeof(T));
+		}
+		if (h.nKeys != 0)
+		{memcpy(&calcKernels.get(0),base + h.offKernels,h.nKeys*sizeof(kernel_type));}
+		kerOffsets.clear();
+
+		munmap(ptr,st.st_size);
+
+		isSharedLocalSupport = false;
+		storeBuildPositions(particlesFrom,particlesTo);
+
+#ifdef SE_CLASS1
+		update_ctr=particlesFrom.getMapCtr();
+#endif
+
+		return 1;
+	}
+
+	//! Store the positions used to compute all the kernels
+	void storeBuildPositions(vector_type &particlesFrom,vector_type2 &particlesTo)
+	{
+		buildPosTo.resize(localSupports.size());
+
+		size_t maxKey = 0;
+		auto it = particlesTo.getDomainIterator();
+		while (it.isNext()) {
+			size_t xpK = particlesTo.getOriginKey(it.get()).getKey();
+			buildPosTo.get(xpK) = particlesTo.getPosOrig(xpK);
+
+			for (size_t j = 0 ; j < localSupports.getRowSize(xpK) ; j++)
+			{maxKey = std::max(maxKey,localSupports.getKey(xpK,j));}
+			++it;
+		}
+
+		buildPosFrom.resize((localSupports.getNKeys() == 0)?0:maxKey+1);
+		for (size_t k = 0 ; k < buildPosFrom.size() ; k++)
+		{buildPosFrom.get(k) = particlesFrom.getPosOrig(k);}
+	}
+
+	template<typename key_type>
+	size_t initializeUpdateIncremental_impl(vector_type &particlesFrom,vector_type2 &particlesTo, T threshold)
+	{
+		statGrown=0;
+
+		T threshold2 = threshold*threshold;
+		size_t nFrom = particlesFrom.size_local_with_ghost();
+
+		// Find the rows to recompute
+		openfpm::vector<unsigned char> isDirty;
+		isDirty.resize(localSupports.size());
+		isDirty.fill(0);
+
+		auto it = particlesTo.getDomainIterator();
+		while (it.isNext()) {
+			size_t xpK = particlesTo.getOriginKey(it.get()).getKey();
+
+			Point<dim,T> dp = particlesTo.getPosOrig(xpK);
+			dp -= buildPosTo.get(xpK);
+
+			auto support = localSupports.template getSupport<key_type>(xpK);
+			bool dirty = (support.size() == 0 || norm2(dp) > threshold2);
+			for (size_t j = 0 ; j < support.size() && dirty == false ; j++)
+			{
+				size_t xqK = support.get(j);
+				if (xqK >= nFrom)
+				{
+					dirty = true;
+					break;
+				}
+
+				Point<dim,T> dq = particlesFrom.getPosOrig(xqK);
+				dq -= buildPosFrom.get(xqK);
+				dirty = norm2(dq) > threshold2;
+			}
+
+			isDirty.get(xpK) = dirty;
+			++it;
+		}
+
+		// Rebuild the supports of the dirty rows and keep the others
+		unsigned int requiredSupportSize = monomialBasis.size() * supportSizeFactor;
+		SupportBuilder<vector_type,vector_type2>
+				supportBuilder(particlesFrom,particlesTo, differentialSignature, rCut, differentialOrder == 0);
+
+		SupportCSR newSupports;
+		openfpm::vector<size_t> dirtyRows;
+		auto it2 = particlesTo.getDomainIterator();
+		while (it2.isNext()) {
+			size_t xpK = particlesTo.getOriginKey(it2.get()).getKey();
+
+			if (isDirty.get(xpK))
+			{
+				Support support = supportBuilder.getSupport(it2, requiredSupportSize,opt);
+				newSupports.addRow(xpK,support.getKeys());
+				dirtyRows.add(xpK);
+			}
+			else
+			{newSupports.addRow(xpK,localSupports.template getSupport<key_type>(xpK));}
+
+			++it2;
+		}
+		newSupports.finalize(particlesTo.size_local_orig());
+
+		// Move the kernels of the rows that are kept
+		openfpm::vector<kernel_type> newKernels;
+		newKernels.resize(newSupports.getNKeys());
+		for (size_t r = 0 ; r < newSupports.size() ; r++)
+		{
+			if (isDirty.get(r)) {continue;}
+
+			size_t oldOff = localSupports.getRowOffset(r);
+			size_t newOff = newSupports.getRowOffset(r);
+			for (size_t j = 0 ; j < newSupports.getRowSize(r) ; j++)
+			{newKernels.get(newOff+j) = calcKernels.get(oldOff+j);}
+		}
+
+		localSupports.swap(newSupports);
+		calcKernels.swap(newKernels);
+
+		for (size_t i = 0 ; i < dirtyRows.size() ; i++)
+		{localSupports.sortRow(dirtyRows.get(i));}
+
+		T avgSpacingGlobal=0,avgSpacingGlobal2=0,maxSpacingGlobal=0,minSpacingGlobal=std::numeric_limits<T>::max();
+		size_t Counter=0;
+
+		if (localSupports.is32bitKeys())
+		{computeKernels<unsigned int>(particlesFrom,particlesTo,dirtyRows,avgSpacingGlobal,avgSpacingGlobal2,maxSpacingGlobal,minSpacingGlobal,Counter);}
+		else
+		{computeKernels<size_t>(particlesFrom,particlesTo,dirtyRows,avgSpacingGlobal,avgSpacingGlobal2,maxSpacingGlobal,minSpacingGlobal,Counter);}
+
+		if (opt == support_options::CONDITION_ADAPTIVE)
+		{growIllConditionedSupports(particlesFrom,particlesTo,dirtyRows);}
+
+		// Refresh the positions of the recomputed rows and of the particles that moved more than threshold
+		for (size_t i = 0 ; i < dirtyRows.size() ; i++)
+		{buildPosTo.get(dirtyRows.get(i)) = particlesTo.getPosOrig(dirtyRows.get(i));}
+
+		size_t maxKey = 0;
+		for (size_t i = 0 ; i < dirtyRows.size() ; i++)
+		{
+			for (size_t j = 0 ; j < localSupports.getRowSize(dirtyRows.get(i)) ; j++)
+			{maxKey = std::max(maxKey,localSupports.getKey(dirtyRows.get(i),j));}
+		}
+
+		size_t nOld = buildPosFrom.size();
+		if (maxKey + 1 > nOld && dirtyRows.size() != 0)
+		{buildPosFrom.resize(maxKey + 1);}
+
+		for (size_t k = 0 ; k < buildPosFrom.size() && k < nFrom ; k++)
+		{
+			Point<dim,T> dq = particlesFrom.getPosOrig(k);
+			dq -= buildPosFrom.get(k);
+			if (k >= nOld || norm2(dq) > threshold2)
+			{buildPosFrom.get(k) = particlesFrom.getPosOrig(k);}
+		}
+
+		// reported by printStatistics, the update does not synchronize the processors
+		statRecomputed = dirtyRows.size();
+		statIncremental = true;
+
+		return dirtyRows.size();
+	}
+
+	/*! \brief Evaluate the operator for one particle on a scalar expression
+	 *
+	 * \param key particle
+	 * \param o1 source expression
+	 * \param support view on the support of the particle
+	 *
+	 */
+	template<typename op_type, typename support_type>
+	inline auto computeDifferentialOperatorSupport(const vect_dist_key_dx &key,
+									 op_type &o1, const support_type & support) -> decltype(is_scalar<std::is_fundamental<decltype(o1.value(
+			key))>::value>::analyze(key, o1)) {
+
+		typedef decltype(is_scalar<std::is_fundamental<decltype(o1.value(key))>::value>::analyze(key, o1)) expr_type;
+
+		T sign = 1.0;
+		if (differentialOrder % 2 == 0) {
+			sign = -1;
+		}
+
+		double epsInvPow = localEpsInvPow.get(key.getKey());
+
+		expr_type fxp = sign * o1.value(key);
+		size_t kerOff = getKernelOffset(key.getKey());
+		expr_type Dfxp = dcpse_support_sum<op_type>::template sum<expr_type,T>(o1,fxp,support,calcKernels,kerOff);
+		Dfxp = Dfxp * epsInvPow;
+		return Dfxp;
+	}
+
+	/*! \brief Evaluate the operator for one particle on the component i of a vector expression
+	 *
+	 * \param key particle
+	 * \param o1 source expression
+	 * \param i component
+	 * \param support view on the support of the particle
+	 *
+	 */
+	template<typename op_type, typename support_type>
+	inline auto computeDifferentialOperatorSupport(const vect_dist_key_dx &key,
+									 op_type &o1,
+									 int i, const support_type & support) -> typename decltype(is_scalar<std::is_fundamental<decltype(o1.value(
+			key))>::value>::analyze(key, o1))::coord_type {
+
+		typedef typename decltype(is_scalar<std::is_fundamental<decltype(o1.value(key))>::value>::analyze(key, o1))::coord_type expr_type;
+
+		T sign = 1.0;
+		if (differentialOrder % 2 == 0) {
+			sign = -1;
+		}
+
+		double epsInvPow = localEpsInvPow.get(key.getKey());
+
+		expr_type Dfxp = 0;
+		expr_type fxp = sign * o1.value(key)[i];
+		size_t kerOff = getKernelOffset(key.getKey());
+		for (int j = 0 ; j < support.size() ; j++)
+		{
+			size_t xqK = support.get(j);
+			expr_type fxq = o1.value(vect_dist_key_dx(xqK))[i];
+			Dfxp = Dfxp + (fxq + fxp) * (T)calcKernels.get(kerOff+j);
+		}
+		Dfxp = Dfxp * epsInvPow;
+		return Dfxp;
+	}
+
+	/*! \brief Apply the operator on one particle
+	 *
+	 * \param particles particle set
+	 * \param xpK particle
+	 * \param sign sign of the operator
+	 * \param f stream of the property fValuePos (getPropStream), nullptr to read it with getProp
+	 * \param df stream of the property DfValuePos (getPropStream), nullptr to write it with getProp
+	 *
+	 */
+	template<typename key_type, unsigned int fValuePos, unsigned int DfValuePos, typename f_type, typename df_type>
+	inline void computeDifferentialOperatorRow(vector_type &particles, size_t xpK, char sign, const f_type * f, df_type * df) {
+		double epsInvPow = localEpsInvPow.get(xpK);
+
+		T Dfxp = 0;
+		auto support = localSupports.template getSupport<key_type>(xpK);
+		size_t kerOff = getKernelOffset(xpK);
+
+		if (f != nullptr && df != nullptr)
+		{
+			T fxp = sign * f[xpK];
+			for (int i = 0 ; i < support.size() ; i++)
+			{Dfxp += (f[support.get(i)] + fxp) * (T)calcKernels.get(kerOff+i);}
+
+			df[xpK] = Dfxp * epsInvPow;
+			return;
+		}
+
+		T fxp = sign * particles.template getProp<fValuePos>(xpK);
+		for (int i = 0 ; i < support.size() ; i++)
+		{
+			size_t xqK = support.get(i);
+			T fxq = particles.template getProp<fValuePos>(xqK);
+
+			Dfxp += (fxq + fxp) * (T)calcKernels.get(kerOff+i);
+		}
+		Dfxp *= epsInvPow;
+		// Store Dfxp in the right position
+		particles.template getProp<DfValuePos>(xpK) = Dfxp;
+	}
+
+	template<typename key_type, unsigned int fValuePos, unsigned int DfValuePos>
+	void computeDifferentialOperator_impl(vector_type &particles) {
+		char sign = 1;
+		if (differentialOrder % 2 == 0) {
+			sign = -1;
+		}
+
+		// with a SoA layout the properties are read and written as plain arrays
+		auto f = getPropStream<fValuePos>(particles);
+		auto df = getPropStream<DfValuePos>(particles);
+
+		if (isSubset == true)
+		{
+			for (size_t i = 0 ; i < subsetRows.size() ; i++)
+			{computeDifferentialOperatorRow<key_type,fValuePos,DfValuePos>(particles,subsetRows.get(i),sign,f,df);}
+			return;
+		}
+
+		auto it = particles.getDomainIterator();
+		while (it.isNext()) {
+			size_t xpK = particles.getOriginKey(it.get()).getKey();
+			computeDifferentialOperatorRow<key_type,fValuePos,DfValuePos>(particles,xpK,sign,f,df);
+			++it;
+		}
+	}
+
+	template<typename key_type, unsigned int fValuePos, unsigned int DfValuePos>
+	void computeDifferentialOperatorOverlap_impl(vector_type &particles) {
+		char sign = 1;
+		if (differentialOrder % 2 == 0) {
+			sign = -1;
+		}
+
+		// Ghost keys come after the local ones
+		size_t nLocal = particles.size_local_orig();
+
+		// with a SoA layout the properties are read and written as plain arrays
+		auto f = getPropStream<fValuePos>(particles);
+		auto df = getPropStream<DfValuePos>(particles);
+
+		// While the ghost is in flight evaluate the particles with only local neighbours
+		overlapBoundaryRows.clear();
+		auto row = [&](size_t xpK)
+		{
+			auto support = localSupports.template getSupport<key_type>(xpK);
+
+			bool interior = true;
+			for (size_t i = 0 ; i < support.size() ; i++)
+			{interior &= (support.get(i) < nLocal);}
+
+			if (interior == true)
+			{computeDifferentialOperatorRow<key_type,fValuePos,DfValuePos>(particles,xpK,sign,f,df);}
+			else
+			{overlapBoundaryRows.add(xpK);}
+		};
+
+		if (isSubset == true)
+		{
+			for (size_t i = 0 ; i < subsetRows.size() ; i++)
+			{row(subsetRows.get(i));}
+		}
+		else
+		{
+			auto it = particles.getDomainIterator();
+			while (it.isNext()) {
+				row(particles.getOriginKey(it.get()).getKey());
+				++it;
+			}
+		}
+
+		particles.template ghost_wait<fValuePos>(SKIP_LABELLING);
+
+		// the ghost can have moved the properties
+		f = getPropStream<fValuePos>(particles);
+		df = getPropStream<DfValuePos>(particles);
+
+		for (size_t i = 0 ; i < overlapBoundaryRows.size() ; i++)
+		{computeDifferentialOperatorRow<key_type,fValuePos,DfValuePos>(particles,overlapBoundaryRows.get(i),sign,f,df);}
+	}
+
+	template<typename key_type, unsigned int prp1,unsigned int prp2, unsigned int ... prps>
+	void p2p_impl()
+	{
+		auto it = particlesTo.getDomainIterator();
+		while (it.isNext()){
+			size_t xpK = particlesTo.getOriginKey(it.get()).getKey();
+			double epsInvPow = localEpsInvPow.get(xpK);
+			auto support = localSupports.template getSupport<key_type>(xpK);
+			size_t kerOff = getKernelOffset(xpK);
+
+			p2p_row<prp1,prp2,prps...>(xpK,epsInvPow,support,kerOff);
+			++it;
+		}
+	}
+
+	//! Interpolation of the last pair of properties of a particle (end of the recursion)
+	template<typename support_type>
+	inline void p2p_row(size_t xpK, double epsInvPow, const support_type & support, size_t kerOff)
+	{}
+
+	//! Interpolation of the pairs of properties of one particle, the support is in cache after the first pair
+	template<unsigned int prp1, unsigned int prp2, unsigned int ... prps, typename support_type>
+	inline void p2p_row(size_t xpK, double epsInvPow, const support_type & support, size_t kerOff)
+	{
+		typedef typename std::remove_reference<decltype(particlesTo.template getProp<prp2>(0))>::type T2;
+
+		T2 Dfxp = 0;
+		for (int i = 0 ; i < support.size() ; i++)
+		{
+			size_t xqK = support.get(i);
+			T2 fxq = particlesFrom.template getProp<prp1>(xqK);
+			Dfxp += fxq * (T)calcKernels.get(kerOff+i);
+		}
+		Dfxp = epsInvPow*Dfxp;
+		// Store Dfxp in the right position
+		particlesTo.template getProp<prp2>(xpK) = Dfxp;
+
+		p2p_row<prps...>(xpK,epsInvPow,support,kerOff);
+	}
+
+	void initializeStaticSize(vector_type &particlesFrom,vector_type2 &particlesTo,
+							  unsigned int convergenceOrder,
+							  T rCut,
+							  T supportSizeFactor, T adaptiveSizeFactor = 1.0) {
+		NUMERICS_TRACE_SPAN("dcpse.build");
+		statGrown=0;
+		statRecomputed=0;
+		statIncremental=false;
+#ifdef SE_CLASS1
+		this->update_ctr=particlesFrom.getMapCtr();
+#endif
+		this->rCut=rCut;
+		this->supportSizeFactor=supportSizeFactor;
+		this->convergenceOrder=convergenceOrder;
+		auto & v_cl=create_vcluster();
+		if(this->opt==LOAD){
+			if(v_cl.rank()==0)
+			{std::cout<<"Warning: Creating empty DC-PSE operator! Please use update or load to get kernels."<<std::endl;}
+			return;
+		}
+		unsigned int requiredSupportSize = monomialBasis.size() * supportSizeFactor;
+		bool adaptiveOrder = isOrderAdaptive();
+
+		// Get the points in the support of the DCPSE kernel and store the support for reuse
+		if (!isSharedLocalSupport)
+		{
+			NUMERICS_TRACE_SPAN("dcpse.support");
+
+			SupportBuilder<vector_type,vector_type2>
+					supportBuilder(particlesFrom,particlesTo, differentialSignature, rCut, differentialOrder == 0);
+			supportBuilder.setAdapFac(adaptiveSizeFactor);
+
+			// the low order rows keep the oversampling of the basis with a smaller support
+			unsigned int requiredSupportSizeLow = requiredSupportSize;
+			std::unique_ptr<SupportBuilder<vector_type,vector_type2>> supportBuilderLow;
+			if (adaptiveOrder == true)
+			{
+				MonomialBasis<dim> lowBasis(differentialSignature.asArray(), lowConvergenceOrder);
+				requiredSupportSizeLow = lowBasis.size() * supportSizeFactor;
+				T rCutLow = rCut * std::pow((T)lowBasis.size() / monomialBasis.size(), (T)1.0 / dim);
+
+				supportBuilderLow.reset(new SupportBuilder<vector_type,vector_type2>(particlesFrom,particlesTo, differentialSignature, rCutLow, differentialOrder == 0));
+				supportBuilderLow->setAdapFac(adaptiveSizeFactor);
+			}
+
+			localSupports.clear();
+			if (isSubset == true)
+			{
+				for (size_t i = 0 ; i < subsetRows.size() ; i++)
+				{
+					vect_dist_key_dx key(subsetRows.get(i));
+					bool low = adaptiveOrder && lowOrderRow.get(key.getKey()) != 0;
+					Support support = (low == true)?supportBuilderLow->getSupport(key, key, requiredSupportSizeLow,opt)
+					                                :supportBuilder.getSupport(key, key, requiredSupportSize,opt);
+					localSupports.addRow(key.getKey(),support.getKeys());
+				}
+			}
+			else
+			{
+				auto it = particlesTo.getDomainIterator();
+				while (it.isNext()) {
+					auto key_o = particlesTo.getOriginKey(it.get());
+					bool low = adaptiveOrder && lowOrderRow.get(key_o.getKey()) != 0;
+					Support support = (low == true)?supportBuilderLow->getSupport(it, requiredSupportSizeLow,opt)
+					                                :supportBuilder.getSupport(it, requiredSupportSize,opt);
+					localSupports.addRow(key_o.getKey(),support.getKeys());
+					++it;
+				}
+			}
+			localSupports.finalize(particlesTo.size_local_orig());
+
+			// Ascending keys make the neighbour gathers in the operator application closer to sequential
+			localSupports.sortRows();
+			localSupports.place(numaPolicy);
+		}
+
+		openfpm::vector<size_t> rows;
+		if (isSubset == true)
+		{rows = subsetRows;}
+		else
+		{
+			auto it = particlesTo.getDomainIterator();
+			while (it.isNext()) {
+				rows.add(particlesTo.getOriginKey(it.get()).getKey());
+				++it;
+			}
+		}
+
+		// The rows that are a translate of a previous row reuse its kernel and are not solved
+		openfpm::vector<aggregate<size_t,size_t>> sharedRows;
+		kerOffsets.clear();
+		size_t nKernels = localSupports.getNKeys();
+		if (latticeTOL > 0 && opt != support_options::CONDITION_ADAPTIVE && adaptiveOrder == false)
+		{
+			if (localSupports.is32bitKeys())
+			{nKernels = detectLatticeRows<unsigned int>(particlesFrom,particlesTo,rows,sharedRows);}
+			else
+			{nKernels = detectLatticeRows<size_t>(particlesFrom,particlesTo,rows,sharedRows);}
+		}
+
+		localEps.resize(particlesTo.size_local_orig());
+		localEpsInvPow.resize(particlesTo.size_local_orig());
+		calcKernels.resize(nKernels);
+		placeKernels(*this);
+
+		// outside the subset the operator is zero
+		if (isSubset == true)
+		{
+			localEps.fill(0);
+			localEpsInvPow.fill(0);
+		}
+
+		for (size_t k = 0 ; k < groupOps.size() ; k++)
+		{
+			groupOps[k]->localSupports = localSupports;
+			groupOps[k]->kerOffsets = kerOffsets;
+			groupOps[k]->localEps.resize(particlesTo.size_local_orig());
+			groupOps[k]->localEpsInvPow.resize(particlesTo.size_local_orig());
+			groupOps[k]->calcKernels.resize(nKernels);
+			placeKernels(*groupOps[k]);
+		}
+
+		T avgSpacingGlobal=0,avgSpacingGlobal2=0,maxSpacingGlobal=0,minSpacingGlobal=std::numeric_limits<T>::max();
+		size_t Counter=0;
+
+		openfpm::vector<size_t> lowRows;
+		if (adaptiveOrder == true)
+		{splitLowOrderRows(rows,lowRows);}
+
+		if (localSupports.is32bitKeys())
+		{computeKernels<unsigned int>(particlesFrom,particlesTo,rows,avgSpacingGlobal,avgSpacingGlobal2,maxSpacingGlobal,minSpacingGlobal,Counter);}
+		else
+		{computeKernels<size_t>(particlesFrom,particlesTo,rows,avgSpacingGlobal,avgSpacingGlobal2,maxSpacingGlobal,minSpacingGlobal,Counter);}
+
+		if (lowRows.size() != 0)
+		{computeLowOrderKernels(particlesFrom,particlesTo,lowRows,avgSpacingGlobal,avgSpacingGlobal2,maxSpacingGlobal,minSpacingGlobal,Counter);}
+
+		if (opt == support_options::CONDITION_ADAPTIVE && !isSharedLocalSupport)
+		{growIllConditionedSupports(particlesFrom,particlesTo,rows);}
+
+		for (size_t i = 0 ; i < sharedRows.size() ; i++)
+		{
+			size_t xpK = sharedRows.template get<0>(i);
+			size_t src = sharedRows.template get<1>(i);
+
+			localEps.get(xpK) = localEps.get(src);
+			localEpsInvPow.get(xpK) = localEpsInvPow.get(src);
+			for (size_t k = 0 ; k < groupOps.size() ; k++)
+			{
+				groupOps[k]->localEps.get(xpK) = groupOps[k]->localEps.get(src);
+				groupOps[k]->localEpsInvPow.get(xpK) = groupOps[k]->localEpsInvPow.get(src);
+			}
+		}
+
+		storeBuildPositions(particlesFrom,particlesTo);
+
+		setStatistics(avgSpacingGlobal,avgSpacingGlobal2,maxSpacingGlobal,minSpacingGlobal,Counter);
+		for (size_t k = 0 ; k < groupOps.size() ; k++)
+		{
+			groupOps[k]->storeBuildPositions(particlesFrom,particlesTo);
+			groupOps[k]->setStatistics(avgSpacingGlobal,avgSpacingGlobal2,maxSpacingGlobal,minSpacingGlobal,Counter);
+		}
+	}
+
+	//! Store the keys of the subset where the operator is constructed, sorted and without duplicates
+	template<typename index_type>
+	void setSubset(const openfpm::vector<index_type> & subset)
+	{
+		isSubset = true;
+		subsetRows.resize(subset.size());
+		for (size_t i = 0 ; i < subset.size() ; i++)
+		{subsetRows.get(i) = subset.template get<0>(i);}
+
+		if (subsetRows.size() == 0)
+		{return;}
+
+		std::sort(&subsetRows.get(0),&subsetRows.get(0)+subsetRows.size());
+		size_t n = std::unique(&subsetRows.get(0),&subsetRows.get(0)+subsetRows.size()) - &subsetRows.get(0);
+		subsetRows.resize(n);
+	}
+
+	//! Store the local statistics of the last construction, see printStatistics
+	void setStatistics(T eps, T spacing, T maxSpacing, T minSpacing, size_t rows)
+	{
+		statEps = eps;
+		statSpacing = spacing;
+		statMaxSpacing = maxSpacing;
+		statMinSpacing = minSpacing;
+		statRows = rows;
+	}
+
+	//! True if the rows marked in lowOrderRow are built with lowConvergenceOrder, see initializeUpdateAdaptiveOrder
+	bool isOrderAdaptive() const
+	{
+		return lowConvergenceOrder != 0 && lowOrderRow.size() == particlesTo.size_local_orig() &&
+		       opt != support_options::CONDITION_ADAPTIVE && opt != support_options::LOAD &&
+		       groupOps.size() == 0 && isSharedLocalSupport == false;
+	}
+
+	/*! \brief Move the rows marked in lowOrderRow from rows to lowRows
+	 *
+	 * \param rows rows of the operator, on return the rows with the full order
+	 * \param lowRows on return the rows with the low order
+	 *
+	 */
+	void splitLowOrderRows(openfpm::vector<size_t> & rows, openfpm::vector<size_t> & lowRows)
+	{
+		openfpm::vector<size_t> highRows;
+		for (size_t r = 0 ; r < rows.size() ; r++)
+		{
+			if (lowOrderRow.get(rows.get(r)) != 0)
+			{lowRows.add(rows.get(r));}
+			else
+			{highRows.add(rows.get(r));}
+		}
+
+		rows.swap(highRows);
+	}
+
+	/*! \brief Solve the rows with the low convergence order
+	 *
+	 * An operator of order lowConvergenceOrder solves them on the supports and writes the kernels in place in the
+	 * buffers of this one (they are moved to it and back), the layout is the same for both orders
+	 *
+	 */
+	void computeLowOrderKernels(vector_type &particlesFrom,vector_type2 &particlesTo, const openfpm::vector<size_t> & lowRows,
+	                            T & avgSpacingGlobal, T & avgSpacingGlobal2, T & maxSpacingGlobal, T & minSpacingGlobal, size_t & Counter)
+	{
+		Dcpse low(particlesFrom,particlesTo,differentialSignature,lowConvergenceOrder,rCut,supportSizeFactor,opt,dcpse_group_deferred());
+		low.HOverEpsilon = HOverEpsilon;
+		low.numaPolicy = numaPolicy;
+
+		low.localSupports.swap(localSupports);
+		low.localEps.swap(localEps);
+		low.localEpsInvPow.swap(localEpsInvPow);
+		low.calcKernels.swap(calcKernels);
+
+		if (low.localSupports.is32bitKeys())
+		{low.template computeKernels<unsigned int>(particlesFrom,particlesTo,lowRows,avgSpacingGlobal,avgSpacingGlobal2,maxSpacingGlobal,minSpacingGlobal,Counter);}
+		else
+		{low.template computeKernels<size_t>(particlesFrom,particlesTo,lowRows,avgSpacingGlobal,avgSpacingGlobal2,maxSpacingGlobal,minSpacingGlobal,Counter);}
+
+		low.localSupports.swap(localSupports);
+		low.localEps.swap(localEps);
+		low.localEpsInvPow.swap(localEpsInvPow);
+		low.calcKernels.swap(calcKernels);
+	}
+
+	//! Value of the operator on the row xpK for the property fValuePos
+	template<unsigned int fValuePos>
+	T applyRow(vector_type &particles, size_t xpK)
+	{
+		T sign = getSign();
+		T fxp = sign * particles.template getProp<fValuePos>(xpK);
+		size_t kerOff = getKernelOffset(xpK);
+
+		T Dfxp = 0;
+		for (size_t j = 0 ; j < localSupports.getRowSize(xpK) ; j++)
+		{Dfxp += (particles.template getProp<fValuePos>(localSupports.getKey(xpK,j)) + fxp) * (T)calcKernels.get(kerOff+j);}
+
+		return Dfxp * localEpsInvPow.get(xpK);
+	}
+
+	/*! \brief Place the kernels and the local eps of an operator with numaPolicy
+	 *
+	 * The kernel of a row is at the row offset of its support, with shared kernels (kerOffsets not empty) the
+	 * kernels do not follow the rows and only the huge pages apply
+	 *
+	 * \param op operator (this or one of groupOps)
+	 *
+	 */
+	void placeKernels(Dcpse & op)
+	{
+		if (numaPolicy.active() == false)
+		{return;}
+
+		numa_place(op.localEps,numaPolicy);
+		numa_place(op.localEpsInvPow,numaPolicy);
+
+		if (kerOffsets.size() == 0)
+		{numa_place_rows(op.calcKernels,localSupports.size(),[&](size_t r){return localSupports.getRowOffset(r);},numaPolicy);}
+		else
+		{
+			numa_policy pages = numaPolicy;
+			pages.first_touch = false;
+			numa_place(op.calcKernels,pages);
+		}
+	}
+
+	/*! \brief Find the rows whose support is a translate of the support of a previous row and let them share its kernel
+	 *
+	 * The offsets xq - xp are quantized on a grid of spacing latticeTOL*rCut, the keys of every row are sorted by
+	 * quantized offset and two rows with the same quantized offsets (same order and same neighbours relative to xp)
+	 * share one kernel. On return rows contains only the rows to solve, kerOffsets the offset of the kernel of every row.
+	 * If no row is shared kerOffsets is left empty
+	 *
+	 * \param rows rows of the operator, on return the rows that own a kernel
+	 * \param sharedRows on return the pairs (row, row whose kernel it shares)
+	 *
+	 * \return the number of kernel weights to store
+	 *
+	 */
+	template<typename key_type>
+	size_t detectLatticeRows(vector_type &particlesFrom,vector_type2 &particlesTo, openfpm::vector<size_t> & rows,
+	                         openfpm::vector<aggregate<size_t,size_t>> & sharedRows)
+	{
+		T h = latticeTOL * rCut;
+
+		std::map<std::vector<long int>,size_t> lattice;
+		std::vector<long int> quantized;
+		openfpm::vector<size_t> ownRows;
+
+		kerOffsets.resize(localSupports.size());
+		kerOffsets.fill(0);
+		size_t nKernels = 0;
+
+		for (size_t r = 0 ; r < rows.size() ; r++)
+		{
+			size_t xpK = rows.get(r);
+			Point<dim,T> xp = particlesTo.getPosOrig(xpK);
+
+			auto offset = [&](size_t xqK, size_t d)
+			{return std::lround((particlesFrom.getPosOrig(xqK)[d] - xp[d]) / h);};
+
+			localSupports.sortRow(xpK,[&](size_t a, size_t b)
+			{
+				for (size_t d = 0 ; d < dim ; d++)
+				{
+					long int qa = offset(a,d);
+					long int qb = offset(b,d);
+					if (qa != qb) {return qa < qb;}
+				}
+				return a < b;
+			});
+
+			auto support = localSupports.template getSupport<key_type>(xpK);
+			quantized.resize(support.size()*dim);
+			for (size_t j = 0 ; j < support.size() ; j++)
+			{
+				for (size_t d = 0 ; d < dim ; d++)
+				{quantized[j*dim+d] = offset(support.get(j),d);}
+			}
+
+			auto f = lattice.find(quantized);
+			if (f == lattice.end())
+			{
+				lattice[quantized] = xpK;
+				kerOffsets.get(xpK) = nKernels;
+				nKernels += support.size();
+				ownRows.add(xpK);
+			}
+			else
+			{
+				kerOffsets.get(xpK) = kerOffsets.get(f->second);
+				sharedRows.add();
+				sharedRows.template get<0>(sharedRows.size()-1) = xpK;
+				sharedRows.template get<1>(sharedRows.size()-1) = f->second;
+			}
+		}
+
+		if (sharedRows.size() == 0)
+		{
+			kerOffsets.clear();
+			return localSupports.getNKeys();
+		}
+
+		rows.swap(ownRows);
+		return nKernels;
+	}
+
+	/*! \brief Solve the moment systems with the basis generated at compile time, if it is the one of this operator
+	 *
+	 * \tparam orderLimit order of the signature + convergence order
+	 * \tparam alphaMin minimum order of the monomials in the basis
+	 *
+	 * \return true if the basis matched
+	 *
+	 */
+	template<typename key_type, unsigned int orderLimit, unsigned int alphaMin>
+	bool computeKernels_static(vector_type &particlesFrom,vector_type2 &particlesTo, const openfpm::vector<size_t> & rows,
+						T & avgSpacingGlobal, T & avgSpacingGlobal2, T & maxSpacingGlobal, T & minSpacingGlobal, size_t & Counter)
+	{
+		typedef StaticMonomialBasisEvaluator<dim,T,orderLimit,alphaMin> evaluator_type;
+
+		if (evaluator_type::matches(monomialBasis) == false)
+		{return false;}
+
+		computeKernels_impl<key_type,evaluator_type::N,evaluator_type>(particlesFrom,particlesTo,rows,avgSpacingGlobal,avgSpacingGlobal2,maxSpacingGlobal,minSpacingGlobal,Counter);
+		return true;
+	}
+
+	/*! \brief Solve the moment system of each particle and fill calcKernels
+	 *
+	 * The first and second derivatives at convergence order 2 and 4 use a monomial basis generated at compile time
+	 * (the loops on the basis are unrolled). The moment matrix has always the size of the monomial basis, for the
+	 * other common basis sizes the system is solved with fixed-size Eigen matrices. The Vandermonde offsets and the
+	 * other workspaces are per thread, so there is no heap allocation per particle
+	 *
+	 * \tparam key_type type of the keys stored in localSupports
+	 *
+	 */
+	template<typename key_type>
+	void computeKernels(vector_type &particlesFrom,vector_type2 &particlesTo, const openfpm::vector<size_t> & rows,
+						T & avgSpacingGlobal, T & avgSpacingGlobal2, T & maxSpacingGlobal, T & minSpacingGlobal, size_t & Counter)
+	{
+		// Vandermonde, QR of the moment matrix and kernel assembly are done row by row in the same loop
+		NUMERICS_TRACE_SPAN("dcpse.kernels");
+
+		if (opt == support_options::CONDITION_ADAPTIVE)
+		{rowCondition.resize(particlesTo.size_local_orig());}
+
+		// Same limits of MonomialBasis::generateBasis
+		unsigned int orderLimit = differentialOrder + convergenceOrder;
+		unsigned int alphaMin = (differentialOrder == 0)?0:!(differentialOrder % 2);
+
+		bool done = false;
+		if (orderLimit == 3 && alphaMin == 0)
+		{done = computeKernels_static<key_type,3,0>(particlesFrom,particlesTo,rows,avgSpacingGlobal,avgSpacingGlobal2,maxSpacingGlobal,minSpacingGlobal,Counter);}
+		else if (orderLimit == 5 && alphaMin == 0)
+		{done = computeKernels_static<key_type,5,0>(particlesFrom,particlesTo,rows,avgSpacingGlobal,avgSpacingGlobal2,maxSpacingGlobal,minSpacingGlobal,Counter);}
+		else if (orderLimit == 4 && alphaMin == 1)
+		{done = computeKernels_static<key_type,4,1>(particlesFrom,particlesTo,rows,avgSpacingGlobal,avgSpacingGlobal2,maxSpacingGlobal,minSpacingGlobal,Counter);}
+		else if (orderLimit == 6 && alphaMin == 1)
+		{done = computeKernels_static<key_type,6,1>(particlesFrom,particlesTo,rows,avgSpacingGlobal,avgSpacingGlobal2,maxSpacingGlobal,minSpacingGlobal,Counter);}
+
+		if (done == true)
+		{return;}
+
+		switch (monomialBasis.size())
+		{
+		case 3:
+			computeKernels_impl<key_type,3>(particlesFrom,particlesTo,rows,avgSpacingGlobal,avgSpacingGlobal2,maxSpacingGlobal,minSpacingGlobal,Counter);
+			break;
+		case 4:
+			computeKernels_impl<key_type,4>(particlesFrom,particlesTo,rows,avgSpacingGlobal,avgSpacingGlobal2,maxSpacingGlobal,minSpacingGlobal,Counter);
+			break;
+		case 6:
+			computeKernels_impl<key_type,6>(particlesFrom,particlesTo,rows,avgSpacingGlobal,avgSpacingGlobal2,maxSpacingGlobal,minSpacingGlobal,Counter);
+			break;
+		case 10:
+			computeKernels_impl<key_type,10>(particlesFrom,particlesTo,rows,avgSpacingGlobal,avgSpacingGlobal2,maxSpacingGlobal,minSpacingGlobal,Counter);
+			break;
+		case 15:
+			computeKernels_impl<key_type,15>(particlesFrom,particlesTo,rows,avgSpacingGlobal,avgSpacingGlobal2,maxSpacingGlobal,minSpacingGlobal,Counter);
+			break;
+		case 20:
+			computeKernels_impl<key_type,20>(particlesFrom,particlesTo,rows,avgSpacingGlobal,avgSpacingGlobal2,maxSpacingGlobal,minSpacingGlobal,Counter);
+			break;
+		case 21:
+			computeKernels_impl<key_type,21>(particlesFrom,particlesTo,rows,avgSpacingGlobal,avgSpacingGlobal2,maxSpacingGlobal,minSpacingGlobal,Counter);
+			break;
+		case 35:
+			computeKernels_impl<key_type,35>(particlesFrom,particlesTo,rows,avgSpacingGlobal,avgSpacingGlobal2,maxSpacingGlobal,minSpacingGlobal,Counter);
+			break;
+		default:
+			computeKernels_impl<key_type,Eigen::Dynamic>(particlesFrom,particlesTo,rows,avgSpacingGlobal,avgSpacingGlobal2,maxSpacingGlobal,minSpacingGlobal,Counter);
+		}
+	}
+
+	/*! \brief Solve the moment system of each particle and fill calcKernels
+	 *
+	 * The particles are independent, every one writes its own slots of localEps, localEpsInvPow and
+	 * calcKernels (preallocated by the support rows), so the loop runs thread-parallel when OpenMP is enabled.
+	 * Every thread reuses its own workspace for the Vandermonde and the moment matrix.
+	 *
+	 * \tparam key_type type of the keys stored in localSupports
+	 * \tparam nb size of the monomial basis (Eigen::Dynamic if not known at compile time)
+	 * \tparam evaluator_type evaluator of the monomial basis
+	 *
+	 */
+	template<typename key_type, int nb, typename evaluator_type = MonomialBasisEvaluator<dim, T>>
+	void computeKernels_impl(vector_type &particlesFrom,vector_type2 &particlesTo, const openfpm::vector<size_t> & rows,
+						T & avgSpacingGlobal, T & avgSpacingGlobal2, T & maxSpacingGlobal, T & minSpacingGlobal, size_t & Counter)
+	{
+		typedef EMatrix<T, Eigen::Dynamic, nb> VMatrix;
+		typedef Eigen::Matrix<T, nb, nb> AMatrix;
+		typedef Eigen::Matrix<T, nb, 1> bVector;
+
+		size_t nBasis = monomialBasis.size();
+
+		size_t maxSupportSize = 0;
+		for (size_t r = 0 ; r < rows.size() ; r++)
+		{maxSupportSize = std::max(maxSupportSize,localSupports.getRowSize(rows.get(r)));}
+
+		// The RHS vector b depends only on the operator
+		DcpseRhs<dim> rhs(monomialBasis, differentialSignature);
+		bVector b(nBasis, 1);
+		rhs.template getVector<T>(b);
+
+		// The operators of the group share A, their right-hand sides are solved together
+		size_t nGroup = groupOps.size();
+		Eigen::Matrix<T, nb, Eigen::Dynamic> bGroup(nBasis, nGroup + 1);
+		if (nGroup != 0)
+		{
+			bGroup.col(0) = b;
+			for (size_t k = 0 ; k < nGroup ; k++)
+			{
+				DcpseRhs<dim> rhsK(groupOps[k]->monomialBasis, groupOps[k]->differentialSignature);
+				bVector bK(nBasis, 1);
+				rhsK.template getVector<T>(bK);
+				bGroup.col(k+1) = bK;
+			}
+		}
+
+		T avgSpacing = 0, avgSpacing2 = 0, maxSpacing = maxSpacingGlobal, minSpacing = minSpacingGlobal;
+		long int nRows = rows.size();
+
+		numa_set_schedule(numaPolicy);
+
+		#pragma omp parallel reduction(+:avgSpacing,avgSpacing2) reduction(max:maxSpacing) reduction(min:minSpacing)
+		{
+			VMatrix V(maxSupportSize, nBasis);
+			AMatrix A(nBasis, nBasis);
+			bVector a(nBasis, 1);
+			Eigen::Matrix<T, nb, Eigen::Dynamic> aGroup(nBasis, nGroup + 1);
+			openfpm::vector_std<T> ker;
+			ker.resize(maxSupportSize);
+			openfpm::vector_std<Point<dim, T>> offsetsBuffer;
+			DcpseDiagonalScalingMatrix<dim> diagonalScalingMatrix(monomialBasis);
+			evaluator_type basisEvaluator(monomialBasis);
+
+			#pragma omp for schedule(runtime)
+			for (long int r = 0 ; r < nRows ; r++) {
+				size_t xpK = rows.get(r);
+
+				auto support = localSupports.template getSupport<key_type>(xpK);
+				size_t N = support.size();
+
+				// Vandermonde matrix computation, the offsets are stored in the buffer of the thread
+				Vandermonde<dim, T, VMatrix>
+						vandermonde(support, monomialBasis,particlesFrom,particlesTo,offsetsBuffer,HOverEpsilon);
+				vandermonde.getMatrix(V, basisEvaluator);
+
+				T eps = vandermonde.getEps();
+				avgSpacing+=eps;
+				T tSpacing = vandermonde.getMinSpacing();
+				avgSpacing2+=tSpacing;
+				if(tSpacing>maxSpacing)
+				{
+					maxSpacing=tSpacing;
+				}
+				if(tSpacing<minSpacing)
+				{
+					minSpacing=tSpacing;
+				}
+
+				localEps.get(xpK) = eps;
+				localEpsInvPow.get(xpK) = 1.0 / openfpm::math::intpowlog(eps,differentialOrder);
+				// Compute the intermediate matrix B = E * V in place
+				diagonalScalingMatrix.scaleRows(V, support, eps, particlesFrom, particlesTo);
+				// Compute matrix A
+				A.noalias() = V.topRows(N).transpose() * V.topRows(N);
+
+				// ...solve the linear system...
+				auto qr = A.colPivHouseholderQr();
+				if (nGroup == 0)
+				{a = qr.solve(b);}
+				else
+				{
+					aGroup.noalias() = qr.solve(bGroup);
+					a = aGroup.col(0);
+				}
+
+				// With column pivoting the diagonal of R is decreasing in magnitude, the ratio of the extremes estimates cond(A)
+				if (opt == support_options::CONDITION_ADAPTIVE)
+				{
+					auto rDiag = qr.matrixQR().diagonal().cwiseAbs();
+					T rMin = rDiag.minCoeff();
+					rowCondition.get(xpK) = (rMin == 0)?std::numeric_limits<T>::max():rDiag.maxCoeff() / rMin;
+				}
+				// ...and store the solution for later reuse
+				size_t kerOff = getKernelOffset(xpK);
+
+				// The offsets xp - xq are normalized by eps
+				const auto & offsets = vandermonde.getOffsets();
+				basisEvaluator.evaluateCombination(&ker.get(0), offsets, 1.0 / eps, a);
+
+				for (size_t i = 0; i < N; ++i)
+				{
+					Point<dim, T> normalizedArg = offsets.get(i) / eps;
+					calcKernels.get(kerOff+i) = (kernel_type)(ker.get(i) * exp(-norm2(normalizedArg)));
+				}
+
+				for (size_t k = 0 ; k < nGroup ; k++)
+				{
+					Dcpse & op = *groupOps[k];
+
+					op.localEps.get(xpK) = eps;
+					op.localEpsInvPow.get(xpK) = 1.0 / openfpm::math::intpowlog(eps,op.differentialOrder);
+
+					a = aGroup.col(k+1);
+					basisEvaluator.evaluateCombination(&ker.get(0), offsets, 1.0 / eps, a);
+
+					for (size_t i = 0; i < N; ++i)
+					{
+						Point<dim, T> normalizedArg = offsets.get(i) / eps;
+						op.calcKernels.get(kerOff+i) = (kernel_type)(ker.get(i) * exp(-norm2(normalizedArg)));
+					}
+				}
+			}
+		}
+
+		avgSpacingGlobal += avgSpacing;
+		avgSpacingGlobal2 += avgSpacing2;
+		maxSpacingGlobal = maxSpacing;
+		minSpacingGlobal = minSpacing;
+		Counter += nRows;
+	}
+
+	/*! \brief Enlarge the supports of the rows with an ill-conditioned moment matrix and recompute their kernels
+	 *
+	 * Every round the rows with rowCondition above conditionTOL get supportGrowthFactor times more neighbours,
+	 * the other rows keep support and kernels. It stops when all the rows are well conditioned or after maxSupportGrowth rounds.
+	 * It is local to the processor, the number of enlarged supports is kept in statGrown
+	 *
+	 * \param rows rows of the operator
+	 *
+	 */
+	void growIllConditionedSupports(vector_type &particlesFrom,vector_type2 &particlesTo, const openfpm::vector<size_t> & rows)
+	{
+		openfpm::vector<unsigned int> targetSize;
+		targetSize.resize(localSupports.size());
+		targetSize.fill((unsigned int)(monomialBasis.size() * supportSizeFactor));
+
+		openfpm::vector<unsigned char> isBad;
+		isBad.resize(localSupports.size());
+
+		size_t nGrown = 0;
+		for (unsigned int g = 0 ; g < maxSupportGrowth ; g++)
+		{
+			isBad.fill(0);
+			openfpm::vector<size_t> badRows;
+			for (size_t r = 0 ; r < rows.size() ; r++)
+			{
+				size_t xpK = rows.get(r);
+				if (rowCondition.get(xpK) > conditionTOL)
+				{
+					isBad.get(xpK) = 1;
+					targetSize.get(xpK) = std::ceil(targetSize.get(xpK) * supportGrowthFactor);
+					badRows.add(xpK);
+				}
+			}
+
+			if (badRows.size() == 0)
+			{break;}
+			if (g == 0)
+			{nGrown = badRows.size();}
+
+			if (localSupports.is32bitKeys())
+			{regrowSupports<unsigned int>(particlesFrom,particlesTo,isBad,targetSize,badRows);}
+			else
+			{regrowSupports<size_t>(particlesFrom,particlesTo,isBad,targetSize,badRows);}
+		}
+
+		// reported by printStatistics, the construction does not synchronize the processors
+		statGrown = nGrown;
+	}
+
+	//! Rebuild the supports of the rows marked in isBad with targetSize neighbours and recompute their kernels
+	template<typename key_type>
+	void regrowSupports(vector_type &particlesFrom,vector_type2 &particlesTo, const openfpm::vector<unsigned char> & isBad,
+						const openfpm::vector<unsigned int> & targetSize, const openfpm::vector<size_t> & badRows)
+	{
 		SupportBuilder<vector_type,vector_type2>
 				supportBuilder(particlesFrom,particlesTo, differentialSignature, rCut, differentialOrder == 0);
-		unsigned int requiredSupportSize = monomialBasis.size() * supportSizeFactor;
-		supportBuilder.setAdapFac(adaptiveSizeFactor);
 
-		if (!isSharedLocalSupport)
-			localSupports.resize(particlesTo.size_local_orig());
-		localEps.resize(particlesTo.size_local_orig());
-		localEpsInvPow.resize(particlesTo.size_local_orig());
-		kerOffsets.resize(particlesTo.size_local_orig());
-		kerOffsets.fill(-1);
-		T avgSpacingGlobal=0,avgSpacingGlobal2=0,maxSpacingGlobal=0,minSpacingGlobal=std::numeric_limits<T>::max();
-		size_t Counter=0;
+		SupportCSR newSupports;
 		auto it = particlesTo.getDomainIterator();
 		while (it.isNext()) {
-			// Get the points in the support of the DCPSE kernel and store the support for reuse
-			auto key_o = particlesTo.getOriginKey(it.get());
+			size_t xpK = particlesTo.getOriginKey(it.get()).getKey();
+
+			if (isBad.get(xpK))
+			{
+				Support support = supportBuilder.getSupport(it, targetSize.get(xpK), opt);
+				newSupports.addRow(xpK,support.getKeys());
+			}
+			else
+			{newSupports.addRow(xpK,localSupports.template getSupport<key_type>(xpK));}
+
+			++it;
+		}
+		newSupports.finalize(particlesTo.size_local_orig());
+
+		// Move the kernels of the rows that are kept
+		openfpm::vector<kernel_type> newKernels;
+		newKernels.resize(newSupports.getNKeys());
+		for (size_t r = 0 ; r < newSupports.size() ; r++)
+		{
+			if (isBad.get(r)) {continue;}
+
+			size_t oldOff = localSupports.getRowOffset(r);
+			size_t newOff = newSupports.getRowOffset(r);
+			for (size_t j = 0 ; j < newSupports.getRowSize(r) ; j++)
+			{newKernels.get(newOff+j) = calcKernels.get(oldOff+j);}
+		}
+
+		localSupports.swap(newSupports);
+		calcKernels.swap(newKernels);
+
+		for (size_t i = 0 ; i < badRows.size() ; i++)
+		{localSupports.sortRow(badRows.get(i));}
+
+		T avgSpacingGlobal=0,avgSpacingGlobal2=0,maxSpacingGlobal=0,minSpacingGlobal=std::numeric_limits<T>::max();
+		size_t Counter=0;
 
-			if (!isSharedLocalSupport)
-				localSupports.get(key_o.getKey()) = supportBuilder.getSupport(it, requiredSupportSize,opt);
+		if (localSupports.is32bitKeys())
+		{computeKernels<unsigned int>(particlesFrom,particlesTo,badRows,avgSpacingGlobal,avgSpacingGlobal2,maxSpacingGlobal,minSpacingGlobal,Counter);}
+		else
+		{computeKernels<size_t>(particlesFrom,particlesTo,badRows,avgSpacingGlobal,avgSpacingGlobal2,maxSpacingGlobal,minSpacingGlobal,Counter);}
+	}
 
-			Support& support = localSupports.get(key_o.getKey());
+	//! Drop the negligible weights of every row, recompute the kernels of the reduced rows and return the number of weights removed
+	template<typename key_type>
+	size_t pruneKernels_impl(vector_type &particlesFrom,vector_type2 &particlesTo, T threshold, T minSizeFactor)
+	{
+		size_t minSize = std::ceil(monomialBasis.size() * minSizeFactor);
 
-			EMatrix<T, Eigen::Dynamic, Eigen::Dynamic> V(support.size(), monomialBasis.size());
+		SupportCSR newSupports;
+		openfpm::vector<size_t> prunedRows;
+		openfpm::vector<key_type> keep;
+		openfpm::vector<T> absW;
 
-			// Vandermonde matrix computation
-			Vandermonde<dim, T, EMatrix<T, Eigen::Dynamic, Eigen::Dynamic>>
-					vandermonde(support, monomialBasis,particlesFrom,particlesTo,HOverEpsilon);
-			vandermonde.getMatrix(V);
+		for (size_t r = 0 ; r < localSupports.size() ; r++)
+		{
+			auto support = localSupports.template getSupport<key_type>(r);
+			size_t N = support.size();
+			size_t off = localSupports.getRowOffset(r);
 
-			T eps = vandermonde.getEps();
-			avgSpacingGlobal+=eps;
-			T tSpacing = vandermonde.getMinSpacing();
-			avgSpacingGlobal2+=tSpacing;
-			if(tSpacing>maxSpacingGlobal)
+			if (N <= minSize)
 			{
-				maxSpacingGlobal=tSpacing;
+				newSupports.addRow(r,support);
+				continue;
 			}
-			if(tSpacing<minSpacingGlobal)
+
+			absW.resize(N);
+			T maxW = 0;
+			for (size_t j = 0 ; j < N ; j++)
 			{
-				minSpacingGlobal=tSpacing;
+				absW.get(j) = fabs((T)calcKernels.get(off+j));
+				maxW = std::max(maxW,absW.get(j));
 			}
 
-			localEps.get(key_o.getKey()) = eps;
-			localEpsInvPow.get(key_o.getKey()) = 1.0 / openfpm::math::intpowlog(eps,differentialOrder);
-			// Compute the diagonal matrix E
-			DcpseDiagonalScalingMatrix<dim> diagonalScalingMatrix(monomialBasis);
-			EMatrix<T, Eigen::Dynamic, Eigen::Dynamic> E(support.size(), support.size());
-			diagonalScalingMatrix.buildMatrix(E, support, eps, particlesFrom, particlesTo);
-			// Compute intermediate matrix B
-			EMatrix<T, Eigen::Dynamic, Eigen::Dynamic> B = E * V;
-			// Compute matrix A
-			EMatrix<T, Eigen::Dynamic, Eigen::Dynamic> A = B.transpose() * B;
-
-			// Compute RHS vector b
-			DcpseRhs<dim> rhs(monomialBasis, differentialSignature);
-			EMatrix<T, Eigen::Dynamic, 1> b(monomialBasis.size(), 1);
-			rhs.template getVector<T>(b);
-			// Get the vector where to store the coefficients...
-			EMatrix<T, Eigen::Dynamic, 1> a(monomialBasis.size(), 1);
-			// ...solve the linear system...
-			a = A.colPivHouseholderQr().solve(b);
-			// ...and store the solution for later reuse
-			kerOffsets.get(key_o.getKey()) = calcKernels.size();
-
-			Point<dim, T> xp = particlesTo.getPosOrig(key_o);
-
-			const auto& support_keys = support.getKeys();
-			size_t N = support_keys.size();
-			for (size_t i = 0; i < N; ++i)
+			// The cut is the smaller of threshold*max|w| and the minSize-th largest weight
+			T cut = threshold * maxW;
+			size_t nAbove = 0;
+			for (size_t j = 0 ; j < N ; j++)
+			{nAbove += (absW.get(j) >= cut);}
+
+			if (nAbove < minSize)
 			{
-				const auto& xqK = support_keys.get(i);
-				Point<dim, T> xq = particlesFrom.getPosOrig(xqK);
-				Point<dim, T> normalizedArg = (xp - xq) / eps;
-				calcKernels.add(computeKernel(normalizedArg, a));
+				openfpm::vector<T> sorted(absW);
+				std::nth_element(&sorted.get(0),&sorted.get(0) + (N - minSize),&sorted.get(0) + N);
+				cut = sorted.get(N - minSize);
 			}
-			//
-			++it;
-			++Counter;
+
+			// the keys stay in ascending order
+			keep.clear();
+			for (size_t j = 0 ; j < N ; j++)
+			{
+				if (absW.get(j) >= cut)
+				{keep.add(support.get(j));}
+			}
+
+			if (keep.size() < N)
+			{prunedRows.add(r);}
+
+			newSupports.addRow(r,keep);
 		}
+		newSupports.finalize(localSupports.size());
 
-		v_cl.sum(avgSpacingGlobal);
-		v_cl.sum(avgSpacingGlobal2);
-		v_cl.max(maxSpacingGlobal);
-		v_cl.min(minSpacingGlobal);
-		v_cl.sum(Counter);
-		v_cl.execute();
-		if(v_cl.rank()==0)
-		{std::cout<<"DCPSE Operator Construction Complete. The global avg spacing in the support <h> is: "<<HOverEpsilon*avgSpacingGlobal/(T(Counter))<<" (c="<<HOverEpsilon<<"). Avg:"<<avgSpacingGlobal2/(T(Counter))<<" Range:["<<minSpacingGlobal<<","<<maxSpacingGlobal<<"]."<<std::endl;}
-	}
+		size_t removed = localSupports.getNKeys() - newSupports.getNKeys();
+
+		localSupports.swap(newSupports);
+
+		openfpm::vector<kernel_type> newKernels;
+		newKernels.resize(localSupports.getNKeys());
 
-	T computeKernel(Point<dim, T> x, EMatrix<T, Eigen::Dynamic, 1> & a) const {
-		T res = 0;
-		unsigned int counter = 0;
-		T expFactor = exp(-norm2(x));
+		// Move the kernels of the rows that are kept
+		openfpm::vector<unsigned char> isPruned;
+		isPruned.resize(localSupports.size());
+		isPruned.fill(0);
+		for (size_t i = 0 ; i < prunedRows.size() ; i++)
+		{isPruned.get(prunedRows.get(i)) = 1;}
 
-		size_t N = monomialBasis.getElements().size();
-		for (size_t i = 0; i < N; ++i)
+		for (size_t r = 0 ; r < localSupports.size() ; r++)
 		{
-			const Monomial<dim> &m = monomialBasis.getElement(i);
+			if (isPruned.get(r)) {continue;}
 
-			T coeff = a(counter);
-			T mbValue = m.evaluate(x);
-			res += coeff * mbValue * expFactor;
-			++counter;
+			size_t oldOff = newSupports.getRowOffset(r);
+			size_t newOff = localSupports.getRowOffset(r);
+			for (size_t j = 0 ; j < localSupports.getRowSize(r) ; j++)
+			{newKernels.get(newOff+j) = calcKernels.get(oldOff+j);}
 		}
-		return res;
-	}
 
+		calcKernels.swap(newKernels);
+
+		T avgSpacingGlobal=0,avgSpacingGlobal2=0,maxSpacingGlobal=0,minSpacingGlobal=std::numeric_limits<T>::max();
+		size_t Counter=0;
+
+		computeKernels<key_type>(particlesFrom,particlesTo,prunedRows,avgSpacingGlobal,avgSpacingGlobal2,maxSpacingGlobal,minSpacingGlobal,Counter);
+
+		return removed;
+	}
 
 	T conditionNumber(const EMatrix<T, -1, -1> &V, T condTOL) const {
 		Eigen::JacobiSVD<Eigen::Matrix<T, Eigen::Dynamic, Eigen::Dynamic>> svd(V);
@@ -778,14 +3098,267 @@ protected:
 
 };
 
+/*! \brief DCPSE operator with the kernel weights stored in single precision
+ *
+ * It can be used as Dcpse_type of the DCPSE_op operators, for example Derivative_x_T<Dcpse_float>
+ *
+ */
+template<unsigned int dim, typename vector_type, typename ... Args>
+using Dcpse_float = Dcpse<dim,vector_type,vector_type,float>;
+
+/*! \brief Set of DCPSE operators on the same particles built together
+ *
+ * Constructed on a context, the operators (Derivative_x ... Derivative_zz, Gradient, Laplacian, Divergence, Advection,
+ * Curl2D) only register their signatures, build() then computes one support for all of them and one factorization of
+ * the moment matrix per particle and per monomial basis (see Dcpse::initializeGroup): the gradient, the Laplacian and
+ * the Hessian of a field cost three factorizations per particle instead of one per component. update() rebuild all
+ * the operators (for example after a map). The operators must live until build() or update() return, and they still
+ * own their kernels (deallocate).
+ *
+ * \code{.cpp}
+
+   DcpseContext<decltype(particles)> ctx(particles,2,rCut);
+
+   Gradient Grad(particles,ctx);
+   Laplacian Lap(particles,ctx);
+   Derivative_xx Dxx(particles,ctx);
+   Derivative_xy Dxy(particles,ctx);
+   Derivative_yy Dyy(particles,ctx);
+
+   ctx.build();
+
+ * \endcode
+ *
+ * \tparam vector_type particle set
+ *
+ */
+template<typename vector_type>
+class DcpseContext
+{
+	typedef typename vector_type::stype T;
+	typedef Dcpse<vector_type::dims,vector_type> dcpse_type;
+
+	//! particle set
+	vector_type & particles;
+
+	//! convergence order of the operators
+	unsigned int convergenceOrder;
+
+	//! cut-off radius of the support
+	T rCut;
+
+	//! multiplier of the minimum number of particles in the support
+	T supportSizeFactor;
+
+	//! support options
+	support_options opt;
+
+	//! registered operators
+	std::vector<dcpse_type *> ops;
+
+public:
+
+	/*! \brief Constructor
+	 *
+	 * \param particles particle set
+	 * \param ord order of convergence of the operators
+	 * \param rCut cut-off radius of the support
+	 * \param oversampling_factor multiplier to the minimum no. of particles required by the operators in support (the
+	 *        default is dcpse_oversampling_factor of the DCPSE_op operators)
+	 * \param opt support options
+	 *
+	 */
+	DcpseContext(vector_type & particles, unsigned int ord, T rCut, T oversampling_factor = 1.9, support_options opt = support_options::RADIUS)
+	:particles(particles),convergenceOrder(ord),rCut(rCut),supportSizeFactor(oversampling_factor),opt(opt)
+	{}
+
+	/*! \brief Register an operator, its kernels are computed by build()
+	 *
+	 * \param differentialSignature signature of the operator
+	 * \param mem memory where the operator is constructed (NULL allocate it with new)
+	 *
+	 * \return the operator, owned by the caller
+	 *
+	 */
+	dcpse_type * addOperator(const Point<vector_type::dims,unsigned int> & differentialSignature, void * mem = NULL)
+	{
+		dcpse_type * op;
+
+		if (mem == NULL)
+		{op = new dcpse_type(particles,differentialSignature,convergenceOrder,rCut,supportSizeFactor,opt,dcpse_group_deferred());}
+		else
+		{op = new(mem) dcpse_type(particles,differentialSignature,convergenceOrder,rCut,supportSizeFactor,opt,dcpse_group_deferred());}
+
+		ops.push_back(op);
+
+		return op;
+	}
+
+	//! number of registered operators
+	size_t size() const
+	{
+		return ops.size();
+	}
+
+	//! Compute the kernels of all the registered operators
+	void build()
+	{
+		dcpse_type::initializeGroup(ops);
+	}
+
+	//! Recompute the kernels of all the registered operators (for example after a map)
+	void update()
+	{
+		build();
+	}
+
+	//! Print the construction statistics of all the registered operators with one reduction. It is collective
+	void printStatistics()
+	{
+		dcpse_type::printStatistics(ops);
+	}
+};
+
+/*! \brief Sort the particles along a space filling curve before constructing the DCPSE operators
+ *
+ * Particles close in space become close in memory, so the supports touch fewer cache lines when the operators
+ * are applied. The particle keys change: call it before constructing the operators (or call update() on
+ * the existing ones). The ghost is refreshed with the positions only, the properties must be ghost_get again
+ *
+ * \param particles particle set
+ * \param m order of the curve
+ * \param opt type of the curve
+ *
+ */
+template<typename vector_type>
+void reorderParticlesForDcpse(vector_type & particles, int32_t m = 5, reorder_opt opt = reorder_opt::HILBERT)
+{
+	particles.reorder(m,opt);
+	particles.template ghost_get<>();
+}
+
+/*! \brief Computational cost model of the DCPSE operators for vector_dist::addComputationCosts
+ *
+ * The cost of a particle is the sum over the operators added of the construction, N*nb^2 for the moment matrix
+ * plus nb^3 for its factorization, and of nApply applications, N each (N support size of the particle, nb size of
+ * the monomial basis). Particles near the boundary or at a finer resolution, with bigger supports, weight more.
+ * The particles without a cost (not in any support row) count 1.
+ *
+ * \code
+ *
+ * DcpseCostModel md(10);     // 10 applications for every construction
+ * md.addOperator(Dx);
+ * md.addOperator(Lap);
+ * rebalanceForDcpse(particles,md);
+ * Dx.initializeUpdate(particles);
+ * Lap.initializeUpdate(particles);
+ *
+ * \endcode
+ *
+ */
+class DcpseCostModel
+{
+	//! cost of every particle (by key)
+	openfpm::vector<double> cost;
+
+	//! number of applications of the operators for each construction
+	double nApply;
+
+public:
+
+	DcpseCostModel(double nApply = 1)
+	:nApply(nApply)
+	{}
+
+	/*! \brief Add the cost of an operator, computed from its supports and its basis
+	 *
+	 * \param op operator (Dcpse or any type with getLocalSupports() and getBasisSize())
+	 *
+	 */
+	template<typename dcpse_type>
+	void addOperator(const dcpse_type & op)
+	{
+		const SupportCSR & sup = op.getLocalSupports();
+		double nb = op.getBasisSize();
+
+		size_t old = cost.size();
+		if (sup.size() > old)
+		{
+			cost.resize(sup.size());
+			for (size_t p = old ; p < cost.size() ; p++)
+			{cost.get(p) = 0;}
+		}
+
+		for (size_t p = 0 ; p < sup.size() ; p++)
+		{
+			double N = sup.getRowSize(p);
+			if (N == 0) {continue;}
+
+			cost.get(p) += N*nb*nb + nb*nb*nb + nApply*N;
+		}
+	}
+
+	//! Remove the costs of all the operators
+	void clear()
+	{
+		cost.clear();
+	}
+
+	//! Cost of the particle p
+	double getCost(size_t p) const
+	{
+		return (p < cost.size() && cost.get(p) > 0)?cost.get(p):1.0;
+	}
+
+	//! Add the cost of the particle p to the sub-sub-domain v
+	template<typename Decomposition, typename vector> inline void addComputation(Decomposition & dec, vector & vd, size_t v, size_t p)
+	{
+		dec.addComputationCost(v, (size_t)getCost(p));
+	}
+
+	//! The cost of a sub-sub-domain is the sum of the costs of its particles
+	template<typename Decomposition> inline void applyModel(Decomposition & dec, size_t v)
+	{
+	}
+
+	//! Tolerance on the load imbalance
+	double distributionTol()
+	{
+		return 1.01;
+	}
+};
+
+/*! \brief Redistribute the particles with the costs of the DCPSE operators
+ *
+ * The decomposition is rebalanced with the costs of md and the particles are mapped. The particle keys change,
+ * so the operators must be updated afterwards (initializeUpdate, or update() of a context)
+ *
+ * \param particles particle set
+ * \param md cost model
+ * \param ts number of steps since the last redecomposition (see CartDecomposition::redecompose)
+ *
+ */
+template<typename vector_type>
+void rebalanceForDcpse(vector_type & particles, const DcpseCostModel & md, size_t ts = 1)
+{
+	particles.addComputationCosts(md);
+	particles.getDecomposition().redecompose(ts);
+	particles.map();
+}
+
+template<unsigned int NORMAL_ID, typename vector_type> class SurfaceDcpseContext;
+
+//! Tag of the SurfaceDcpse constructor used by SurfaceDcpseContext (the kernels are computed later by the context)
+struct surface_dcpse_deferred {};
 
 template<unsigned int dim, typename vector_type,typename vector_type2=vector_type>
 class SurfaceDcpse : Dcpse<dim, vector_type, vector_type2> {
 public:
 	typedef typename vector_type::stype T;
 
+	template<unsigned int NORMAL_ID, typename vector_type_> friend class SurfaceDcpseContext;
+
 protected:
-	openfpm::vector<size_t> accKerOffsets;
 	openfpm::vector<T> accCalcKernels;
 	openfpm::vector<T> nSpacings;
 	double nSpacing, adaptiveSizeFactor;
@@ -823,31 +3396,32 @@ protected:
 	}
 
 	void accumulateAndDeleteNormalParticles(vector_type &particles)
+	{
+		accumulateNormalParticles();
+		particles.discardLocalAppend(initialParticleSize);
+	}
+
+	//! Merge the kernels of the normal particles into the kernels of the surface particles they come from
+	void accumulateNormalParticles()
 	{
 		accCalcKernels.clear();
-		accKerOffsets.clear();
-		accKerOffsets.resize(initialParticleSize);
-		accKerOffsets.fill(-1);
 
-		auto supportsIt = this->localSupports.begin();
+		SupportCSR accSupports;
 		tsl::hopscotch_map<size_t, size_t> nMap;
 		openfpm::vector_std<size_t> supportBuffer;
 
-		auto it = particles.getDomainIterator();
-		while(it.isNext()){
+		size_t nRows = std::min(this->localSupports.size(),initialParticleSize);
+		for (size_t xpK = 0 ; xpK < nRows ; xpK++)
+		{
 			supportBuffer.clear();
 			nMap.clear();
 
-			auto key=it.get();
-			Support support = *supportsIt;
-			size_t xpK = support.getReferencePointKey();
-			size_t kerOff = this->kerOffsets.get(xpK);
-			accKerOffsets.get(xpK)=accCalcKernels.size();
-			auto &keys = support.getKeys();
+			size_t kerOff = this->getKernelOffset(xpK);
+			size_t NN = this->localSupports.getRowSize(xpK);
 
-			for (int i = 0 ; i < keys.size() ; i++)
+			for (int i = 0 ; i < NN ; i++)
 			{
-				size_t xqK = keys.get(i);
+				size_t xqK = this->localSupports.getKey(xpK,i);
 				int difference = static_cast<int>(xqK) - static_cast<int>(initialParticleSize);
 				int real_particle;
 
@@ -870,21 +3444,41 @@ protected:
 				}
 			}
 
-			keys.swap(supportBuffer);
-			this->localSupports.get(xpK) = support;
-			++supportsIt;
-			++it;
+			accSupports.addRow(xpK,supportBuffer);
 		}
+		accSupports.finalize(initialParticleSize);
 
-		particles.discardLocalAppend(initialParticleSize);
 		this->localEps.resize(initialParticleSize);
 		this->localEpsInvPow.resize(initialParticleSize);
-		this->localSupports.resize(initialParticleSize);
+		this->localSupports.swap(accSupports);
 		this->calcKernels.swap(accCalcKernels);
-		this->kerOffsets.swap(accKerOffsets);
+		this->kerOffsets.clear();
+
+		// The merged kernels depend on the normal particles, an incremental update must rebuild everything
+		this->buildPosTo.clear();
+		this->buildPosFrom.clear();
 	}
 
 public:
+	//! Surface DCPSE Constructor of SurfaceDcpseContext::addOperator, the kernels are computed by SurfaceDcpseContext::build
+	SurfaceDcpse(
+		vector_type &particles,
+		Point<dim, unsigned int> differentialSignature,
+		unsigned int convergenceOrder,
+		T rCut,
+		T nSpacing,
+		support_options opt,
+		surface_dcpse_deferred)
+	:
+		Dcpse<dim, vector_type, vector_type2>(particles, differentialSignature, convergenceOrder, opt),
+		isSurfaceDerivative(true),
+		nSpacing(nSpacing),
+		nCount(floor(rCut/nSpacing))
+	{
+		this->rCut = rCut;
+		this->convergenceOrder = convergenceOrder;
+	}
+
 	//Surface DCPSE Constructor
 	template<unsigned int NORMAL_ID>
 	SurfaceDcpse(
@@ -951,6 +3545,172 @@ public:
 	}
 };
 
+
+/*! \brief Normal-extended particle cloud and support shared by several surface DCPSE operators
+ *
+ * Every SurfaceDcpse creates the normal particles, builds the support on the extended cloud and merges the kernels
+ * back on the surface particles. Constructed on a context, the surface operators (SurfaceDerivative_x ...
+ * SurfaceDerivative_G, Laplace_Beltrami) only register their signature, build() then creates the normal particles
+ * once, builds one support on the extended cloud, computes the kernels of every operator on it and removes the
+ * normal particles once. update() rebuild all the operators (for example after a map). The operators must live until
+ * build() or update() return, and they still own their kernels (deallocate).
+ *
+ * \code{.cpp}
+
+   SurfaceDcpseContext<NORMAL,decltype(particles)> ctx(particles,2,rCut,nSpacing);
+
+   SurfaceDerivative_x<NORMAL> Sdx(particles,ctx);
+   SurfaceDerivative_y<NORMAL> Sdy(particles,ctx);
+   Laplace_Beltrami<NORMAL> Sdlb(particles,ctx);
+
+   ctx.build();
+
+ * \endcode
+ *
+ * \tparam NORMAL_ID property with the normals of the surface
+ * \tparam vector_type particle set
+ *
+ */
+template<unsigned int NORMAL_ID, typename vector_type>
+class SurfaceDcpseContext
+{
+	typedef typename vector_type::stype T;
+	typedef SurfaceDcpse<vector_type::dims,vector_type> surface_type;
+
+	//! particle set
+	vector_type & particles;
+
+	//! convergence order of the operators
+	unsigned int convergenceOrder;
+
+	//! cut-off radius of the support
+	T rCut;
+
+	//! spacing of the normal particles
+	T nSpacing;
+
+	//! support options
+	support_options opt;
+
+	//! registered operators
+	std::vector<surface_type *> ops;
+
+public:
+
+	/*! \brief Constructor
+	 *
+	 * \param particles particle set
+	 * \param ord order of convergence of the operators
+	 * \param rCut cut-off radius of the support
+	 * \param nSpacing spacing of the normal particles
+	 * \param opt support options
+	 *
+	 */
+	SurfaceDcpseContext(vector_type & particles, unsigned int ord, T rCut, T nSpacing, support_options opt = support_options::RADIUS)
+	:particles(particles),convergenceOrder(ord),rCut(rCut),nSpacing(nSpacing),opt(opt)
+	{}
+
+	/*! \brief Register an operator, its kernels are computed by build()
+	 *
+	 * \param differentialSignature signature of the operator
+	 *
+	 * \return the operator (SurfaceDcpse), owned by the caller
+	 *
+	 */
+	void * addOperator(const Point<vector_type::dims,unsigned int> & differentialSignature)
+	{
+		surface_type * op = new surface_type(particles,differentialSignature,convergenceOrder,rCut,nSpacing,opt,surface_dcpse_deferred());
+		ops.push_back(op);
+
+		return op;
+	}
+
+	//! number of registered operators
+	size_t size() const
+	{
+		return ops.size();
+	}
+
+	//! Compute the kernels of all the registered operators on one normal-extended cloud
+	void build()
+	{
+		if (ops.size() == 0)
+			return;
+
+		particles.ghost_get_subset();
+
+		// the operator with the biggest basis define the support
+		surface_type * first = ops[0];
+		for (size_t i = 1 ; i < ops.size() ; i++)
+		{
+			if (ops[i]->monomialBasis.size() > first->monomialBasis.size())
+				first = ops[i];
+		}
+
+		double adaptiveSizeFactor = 1.0;
+
+		if (opt == support_options::ADAPTIVE)
+		{
+			adaptiveSizeFactor = nSpacing;
+
+			SupportBuilder<vector_type,vector_type> supportBuilder(particles,particles,first->differentialSignature,rCut,first->differentialOrder == 0);
+			supportBuilder.setAdapFac(nSpacing);
+
+			first->nSpacings.clear();
+			auto it = particles.getDomainAndGhostIterator();
+			while (it.isNext())
+			{
+				Support support = supportBuilder.getSupport(it, first->monomialBasis.size(), opt);
+				first->nSpacings.add(supportBuilder.getLastMinspacing());
+				++it;
+			}
+
+			first->nCount = (vector_type::dims == 2)?3:2;
+		}
+
+		// the normal particles are created once
+		first->template createNormalParticles<NORMAL_ID>(particles);
+
+		unsigned int requiredSupportSize = first->monomialBasis.size() * first->supportSizeFactor;
+
+		SupportCSR extSupports;
+		SupportBuilder<vector_type,vector_type> supportBuilder(particles,particles,first->differentialSignature,rCut,first->differentialOrder == 0);
+		supportBuilder.setAdapFac(adaptiveSizeFactor);
+
+		auto it = particles.getDomainIterator();
+		while (it.isNext())
+		{
+			auto key_o = particles.getOriginKey(it.get());
+			Support support = supportBuilder.getSupport(it, requiredSupportSize, opt);
+			extSupports.addRow(key_o.getKey(),support.getKeys());
+			++it;
+		}
+		extSupports.finalize(particles.size_local_orig());
+		extSupports.sortRows();
+
+		for (size_t i = 0 ; i < ops.size() ; i++)
+		{
+			surface_type & op = *ops[i];
+
+			op.nCount = first->nCount;
+			op.initialParticleSize = first->initialParticleSize;
+			op.localSupports = extSupports;
+			op.isSharedLocalSupport = true;
+
+			op.initializeStaticSize(particles,particles,convergenceOrder,rCut,op.supportSizeFactor,adaptiveSizeFactor);
+			op.accumulateNormalParticles();
+		}
+
+		particles.discardLocalAppend(first->initialParticleSize);
+	}
+
+	//! Recompute the kernels of all the registered operators (for example after a map)
+	void update()
+	{
+		build();
+	}
+};
+
 #endif
 #endif //OPENFPM_PDATA_DCPSE_HPP
 
@@ -0,0 +1,394 @@
+//
+// Fused explicit advection-diffusion step on the kernels of the DCPSE operators
+//
+
+#ifndef OPENFPM_PDATA_DCPSEADVECTIONDIFFUSION_HPP
+#define OPENFPM_PDATA_DCPSEADVECTIONDIFFUSION_HPP
+
+#ifdef HAVE_EIGEN
+
+#include "DCPSE/DCPSE_op/DCPSE_op.hpp"
+#include <cstring>
+
+/*! \brief Explicit advection-diffusion step phi_new = phi + dt * (nu * Lap(phi) - u . Grad(phi)) in one neighbour sweep
+ *
+ * The step reuses the kernels of an Advection (the first derivatives) and of a Laplacian (the second derivatives),
+ * nothing is recomputed. For every particle the components of the gradient and the Laplacian are accumulated together
+ * and the new value is written directly in the output property, without the intermediate properties and the four
+ * sweeps of phi_new = phi + dt*(nu*Lap(phi) - Adv(u,phi)). When all the operators have the same support (the same
+ * rCut with RADIUS, or all constructed on one DcpseContext) the value of every neighbour is read once for all of them,
+ * otherwise every operator sweeps its own support of the particle.
+ *
+ * The output must be another property than phi (the neighbours read the old values) and the ghost of phi must be up
+ * to date. After Adv.update and Lap.update call update()
+ *
+ * \code
+ *
+ * Advection Adv(particles,2,rCut);
+ * Laplacian Lap(particles,2,rCut);
+ * DcpseAdvectionDiffusion<2,vector_type> step(particles,Adv,Lap);
+ *
+ * particles.ghost_get<PHI>(SKIP_LABELLING);
+ * step.apply<PHI,VELOCITY,PHI_NEW>(particles,dt,nu);
+ *
+ * \endcode
+ *
+ * \tparam dim dimensionality
+ * \tparam vector_type particle set
+ * \tparam dcpse_type type of the operators
+ *
+ */
+template<unsigned int dim, typename vector_type, typename dcpse_type = Dcpse<dim,vector_type>>
+class DcpseAdvectionDiffusion
+{
+	typedef typename vector_type::stype T;
+	typedef typename std::remove_reference<decltype(std::declval<dcpse_type>().getKernels())>::type kernels_type;
+
+	//! first derivatives, one for each dimension
+	dcpse_type * grad;
+
+	//! second derivatives, one for each dimension
+	dcpse_type * lap;
+
+	//! all the operators have the support of grad[0]
+	bool sharedSupport = false;
+
+	//! True if the two supports have the same rows and keys
+	static bool sameSupport(const SupportCSR & a, const SupportCSR & b)
+	{
+		if (a.size() != b.size() || a.getNKeys() != b.getNKeys() || a.is32bitKeys() != b.is32bitKeys())
+		{return false;}
+
+		if (a.size() == 0)
+		{return true;}
+
+		size_t keySize = (a.is32bitKeys() == true)?sizeof(unsigned int):sizeof(size_t);
+
+		return memcmp(a.getRowOffsetsPointer(),b.getRowOffsetsPointer(),(a.size()+1)*sizeof(size_t)) == 0 &&
+		       (a.getNKeys() == 0 || memcmp(a.getKeysPointer(),b.getKeysPointer(),a.getNKeys()*keySize) == 0);
+	}
+
+	template<typename key_type, unsigned int prpPhi, unsigned int prpU, unsigned int prpOut>
+	void apply_shared(vector_type & particles, T dt, T nu)
+	{
+		const kernels_type * kg[dim];
+		const kernels_type * kl[dim];
+		for (size_t d = 0 ; d < dim ; d++)
+		{
+			kg[d] = &grad[d].getKernels();
+			kl[d] = &lap[d].getKernels();
+		}
+
+		auto it = particles.getDomainIterator();
+		while (it.isNext())
+		{
+			size_t xpK = particles.getOriginKey(it.get()).getKey();
+			vect_dist_key_dx key(xpK);
+
+			auto support = grad[0].getLocalSupports().template getSupport<key_type>(xpK);
+
+			size_t og[dim], ol[dim];
+			for (size_t d = 0 ; d < dim ; d++)
+			{
+				og[d] = grad[d].getKernelOffset(xpK);
+				ol[d] = lap[d].getKernelOffset(xpK);
+			}
+
+			T fxp = particles.template getProp<prpPhi>(xpK);
+
+			T g[dim], l[dim];
+			for (size_t d = 0 ; d < dim ; d++)
+			{g[d] = 0; l[d] = 0;}
+
+			// one read of the neighbour for all the operators
+			for (size_t j = 0 ; j < support.size() ; j++)
+			{
+				T fxq = particles.template getProp<prpPhi>(support.get(j));
+				for (size_t d = 0 ; d < dim ; d++)
+				{
+					g[d] += (fxq + fxp) * (T)kg[d]->get(og[d]+j);
+					l[d] += (fxq - fxp) * (T)kl[d]->get(ol[d]+j);
+				}
+			}
+
+			T adv = 0, diff = 0;
+			for (size_t d = 0 ; d < dim ; d++)
+			{
+				adv += particles.template getProp<prpU>(xpK)[d] * g[d] * grad[d].getEpsilonInvPrefactor(key);
+				diff += l[d] * lap[d].getEpsilonInvPrefactor(key);
+			}
+
+			particles.template getProp<prpOut>(xpK) = fxp + dt * (nu * diff - adv);
+
+			++it;
+		}
+	}
+
+	//! Sweep of the support of one operator on one particle, sign as in Dcpse::computeDifferentialOperator
+	template<typename key_type, unsigned int prpPhi>
+	static T sweep(vector_type & particles, dcpse_type & op, size_t xpK, T fxp)
+	{
+		auto support = op.getLocalSupports().template getSupport<key_type>(xpK);
+		const kernels_type & ker = op.getKernels();
+		size_t kerOff = op.getKernelOffset(xpK);
+
+		T Df = 0;
+		for (size_t j = 0 ; j < support.size() ; j++)
+		{Df += (particles.template getProp<prpPhi>(support.get(j)) + fxp) * (T)ker.get(kerOff+j);}
+
+		return Df * op.getEpsilonInvPrefactor(vect_dist_key_dx(xpK));
+	}
+
+	template<unsigned int prpPhi, unsigned int prpU, unsigned int prpOut>
+	void apply_split(vector_type & particles, T dt, T nu)
+	{
+		auto it = particles.getDomainIterator();
+		while (it.isNext())
+		{
+			size_t xpK = particles.getOriginKey(it.get()).getKey();
+
+			T fxp = particles.template getProp<prpPhi>(xpK);
+
+			T adv = 0, diff = 0;
+			for (size_t d = 0 ; d < dim ; d++)
+			{
+				T g, l;
+				if (grad[d].getLocalSupports().is32bitKeys())
+				{g = sweep<unsigned int,prpPhi>(particles,grad[d],xpK,fxp);}
+				else
+				{g = sweep<size_t,prpPhi>(particles,grad[d],xpK,fxp);}
+
+				if (lap[d].getLocalSupports().is32bitKeys())
+				{l = sweep<unsigned int,prpPhi>(particles,lap[d],xpK,-fxp);}
+				else
+				{l = sweep<size_t,prpPhi>(particles,lap[d],xpK,-fxp);}
+
+				adv += particles.template getProp<prpU>(xpK)[d] * g;
+				diff += l;
+			}
+
+			particles.template getProp<prpOut>(xpK) = fxp + dt * (nu * diff - adv);
+
+			++it;
+		}
+	}
+
+public:
+
+	/*! \brief Constructor
+	 *
+	 * \param grad operators of the first derivatives, one for each dimension
+	 * \param lap operators of the second derivatives, one for each dimension
+	 *
+	 */
+	DcpseAdvectionDiffusion(dcpse_type * grad, dcpse_type * lap)
+	:grad(grad),lap(lap)
+	{
+		update();
+	}
+
+	/*! \brief Constructor on the kernels of an Advection and a Laplacian
+	 *
+	 * \param particles particle set
+	 * \param adv advection operator
+	 * \param lap Laplacian
+	 *
+	 */
+	template<template<unsigned int, typename, typename...> class Dcpse_type>
+	DcpseAdvectionDiffusion(vector_type & particles, Advection_T<Dcpse_type> & adv, Laplacian_T<Dcpse_type> & lap)
+	:DcpseAdvectionDiffusion(adv.getDcpse(particles),lap.getDcpse(particles))
+	{}
+
+	//! Check again if the operators share the support, after they have been updated
+	void update()
+	{
+		sharedSupport = true;
+		for (size_t d = 0 ; d < dim ; d++)
+		{
+			sharedSupport &= (d == 0 || sameSupport(grad[0].getLocalSupports(),grad[d].getLocalSupports()));
+			sharedSupport &= sameSupport(grad[0].getLocalSupports(),lap[d].getLocalSupports());
+		}
+	}
+
+	//! True if the step reads the neighbours once for all the operators
+	bool isSharedSupport() const
+	{
+		return sharedSupport;
+	}
+
+	/*! \brief Explicit step prpOut = prpPhi + dt * (nu * Lap(prpPhi) - prpU . Grad(prpPhi))
+	 *
+	 * \tparam prpPhi advected and diffused field
+	 * \tparam prpU velocity (vector property)
+	 * \tparam prpOut new value of the field
+	 *
+	 * \param particles particle set
+	 * \param dt time step
+	 * \param nu diffusion coefficient
+	 *
+	 */
+	template<unsigned int prpPhi, unsigned int prpU, unsigned int prpOut>
+	void apply(vector_type & particles, T dt, T nu)
+	{
+		static_assert(prpPhi != prpOut, "the step reads the old values of the neighbours, the output must be another property");
+
+		if (sharedSupport == false)
+		{apply_split<prpPhi,prpU,prpOut>(particles,dt,nu);}
+		else if (grad[0].getLocalSupports().is32bitKeys())
+		{apply_shared<unsigned int,prpPhi,prpU,prpOut>(particles,dt,nu);}
+		else
+		{apply_shared<size_t,prpPhi,prpU,prpOut>(particles,dt,nu);}
+	}
+};
+
+#if defined(__NVCC__)
+
+//! Operators of DcpseAdvectionDiffusion_gpu passed by value to the device
+template<unsigned int dim, typename T>
+struct adv_diff_gpu_ops
+{
+	dcpse_gpu_rows<T> grad[dim];
+	dcpse_gpu_rows<T> lap[dim];
+};
+
+template<unsigned int dim, unsigned int prpPhi, unsigned int prpU, unsigned int prpOut, bool shared, typename particles_type, typename T>
+__global__ void advectionDiffusionStep_gpu(particles_type particles, adv_diff_gpu_ops<dim,T> ops, T dt, T nu, size_t N)
+{
+	size_t p = blockIdx.x * blockDim.x + threadIdx.x;
+	if (p >= N) return;
+
+	T fxp = (T) particles.template getProp<prpPhi>(p);
+
+	T g[dim], l[dim];
+	for (unsigned int d = 0; d < dim; d++)
+	{g[d] = 0; l[d] = 0;}
+
+	if (shared == true)
+	{
+		for (size_t i = ops.grad[0].kerOffsets[p]; i < ops.grad[0].kerOffsets[p+1]; i++)
+		{
+			T fxq = (T) particles.template getProp<prpPhi>(ops.grad[0].keys[i]);
+			for (unsigned int d = 0; d < dim; d++)
+			{
+				g[d] += (fxq + fxp) * ops.grad[d].kernels[i];
+				l[d] += (fxq - fxp) * ops.lap[d].kernels[i];
+			}
+		}
+	}
+	else
+	{
+		for (unsigned int d = 0; d < dim; d++)
+		{
+			for (size_t i = ops.grad[d].kerOffsets[p]; i < ops.grad[d].kerOffsets[p+1]; i++)
+			{g[d] += ((T) particles.template getProp<prpPhi>(ops.grad[d].keys[i]) + fxp) * ops.grad[d].kernels[i];}
+
+			for (size_t i = ops.lap[d].kerOffsets[p]; i < ops.lap[d].kerOffsets[p+1]; i++)
+			{l[d] += ((T) particles.template getProp<prpPhi>(ops.lap[d].keys[i]) - fxp) * ops.lap[d].kernels[i];}
+		}
+	}
+
+	T adv = 0, diff = 0;
+	for (unsigned int d = 0; d < dim; d++)
+	{
+		adv += (T) particles.template getProp<prpU>(p)[d] * g[d] * ops.grad[d].epsInvPow[p];
+		diff += l[d] * ops.lap[d].epsInvPow[p];
+	}
+
+	particles.template getProp<prpOut>(p) = fxp + dt * (nu * diff - adv);
+}
+
+/*! \brief DcpseAdvectionDiffusion on the device, with the kernels of Dcpse_gpu operators
+ *
+ * One thread per particle. phi (local and ghost) and the velocity must be on the device, the output is left on the
+ * device
+ *
+ * \code
+ *
+ * Advection_gpu Adv(particles,2,rCut);
+ * Laplacian_gpu Lap(particles,2,rCut);
+ * DcpseAdvectionDiffusion_gpu<2,vector_type> step(particles,Adv,Lap);
+ *
+ * step.apply<PHI,VELOCITY,PHI_NEW>(particles,dt,nu);
+ *
+ * \endcode
+ *
+ */
+template<unsigned int dim, typename vector_type, typename dcpse_type = Dcpse_gpu<dim,vector_type>>
+class DcpseAdvectionDiffusion_gpu
+{
+	typedef typename std::remove_pointer<decltype(std::declval<dcpse_type>().getDeviceRows().kernels)>::type T_const;
+	typedef typename std::remove_const<T_const>::type T;
+
+	//! first derivatives, one for each dimension
+	dcpse_type * grad;
+
+	//! second derivatives, one for each dimension
+	dcpse_type * lap;
+
+	//! all the operators have the support of grad[0]
+	bool sharedSupport = false;
+
+public:
+
+	DcpseAdvectionDiffusion_gpu(dcpse_type * grad, dcpse_type * lap)
+	:grad(grad),lap(lap)
+	{
+		update();
+	}
+
+	template<template<unsigned int, typename, typename...> class Dcpse_type>
+	DcpseAdvectionDiffusion_gpu(vector_type & particles, Advection_T<Dcpse_type> & adv, Laplacian_T<Dcpse_type> & lap)
+	:DcpseAdvectionDiffusion_gpu(adv.getDcpse(particles),lap.getDcpse(particles))
+	{}
+
+	//! Check again if the operators share the support, after they have been updated
+	void update()
+	{
+		sharedSupport = true;
+		for (size_t d = 0 ; d < dim ; d++)
+		{
+			sharedSupport &= (d == 0 || grad[0].hasSameSupport(grad[d]));
+			sharedSupport &= grad[0].hasSameSupport(lap[d]);
+		}
+	}
+
+	//! True if the step reads the neighbours once for all the operators
+	bool isSharedSupport() const
+	{
+		return sharedSupport;
+	}
+
+	/*! \brief Explicit step prpOut = prpPhi + dt * (nu * Lap(prpPhi) - prpU . Grad(prpPhi)) on the device
+	 *
+	 * \param particles particle set
+	 * \param dt time step
+	 * \param nu diffusion coefficient
+	 *
+	 */
+	template<unsigned int prpPhi, unsigned int prpU, unsigned int prpOut>
+	void apply(vector_type & particles, T dt, T nu)
+	{
+		static_assert(prpPhi != prpOut, "the step reads the old values of the neighbours, the output must be another property");
+
+		size_t N = particles.size_local();
+		if (N == 0) return;
+
+		adv_diff_gpu_ops<dim,T> ops;
+		for (size_t d = 0 ; d < dim ; d++)
+		{
+			ops.grad[d] = grad[d].getDeviceRows();
+			ops.lap[d] = lap[d].getDeviceRows();
+		}
+
+		size_t nBlocks = (N + 255) / 256;
+		if (sharedSupport == true)
+		{advectionDiffusionStep_gpu<dim,prpPhi,prpU,prpOut,true><<<nBlocks, 256>>>(particles.toKernel(),ops,dt,nu,N);}
+		else
+		{advectionDiffusionStep_gpu<dim,prpPhi,prpU,prpOut,false><<<nBlocks, 256>>>(particles.toKernel(),ops,dt,nu,N);}
+	}
+};
+
+#endif
+
+#endif
+#endif //OPENFPM_PDATA_DCPSEADVECTIONDIFFUSION_HPP
@@ -0,0 +1,441 @@
+//
+// Precomputed composition of DCPSE operators (for example the bilaplacian L∘L)
+//
+
+#ifndef OPENFPM_PDATA_DCPSECOMPOSED_HPP
+#define OPENFPM_PDATA_DCPSECOMPOSED_HPP
+
+#ifdef HAVE_EIGEN
+
+#include "DCPSE/Dcpse.hpp"
+#include <algorithm>
+#include <unordered_map>
+
+/*! \brief Sum of products of DCPSE operators stored as one kernel set
+ *
+ * The output is sum_t coeff_t * A_t(B_t(f)), where A_t and B_t are DCPSE operators. The products are
+ * computed once in build(): the row of a particle contains its neighbours up to two supports away, with the
+ * weights of the composed operator, so every application is one sweep without an intermediate property.
+ *
+ * The rows of the inner operators of the ghost particles are requested to the processors that own them.
+ * The ghost must be at least two times rCut, so that every column of a composed row is a local or ghost particle
+ *
+ * \code
+ *
+ * DcpseComposed<2,vector_type> bilap(particles,2,rCut);
+ * bilap.addProduct(Point<2,unsigned int>({2,0}),Point<2,unsigned int>({2,0}));
+ * bilap.addProduct(Point<2,unsigned int>({2,0}),Point<2,unsigned int>({0,2}),2.0);
+ * bilap.addProduct(Point<2,unsigned int>({0,2}),Point<2,unsigned int>({0,2}));
+ * bilap.build();
+ *
+ * particles.ghost_get<0>();
+ * bilap.compute<0,1>(particles);   // f in property 0, the bilaplacian of f in property 1
+ *
+ * \endcode
+ *
+ * \tparam dim dimensionality
+ * \tparam vector_type particle set
+ *
+ */
+template<unsigned int dim, typename vector_type>
+class DcpseComposed
+{
+	typedef typename vector_type::stype T;
+	typedef Dcpse<dim,vector_type> dcpse_type;
+
+	//! One product outer(inner(f))
+	struct composed_term
+	{
+		unsigned int outer;
+		unsigned int inner;
+		T coeff;
+	};
+
+	//! Entry of an operator row with global numbering (see Dcpse::addRowTriplets)
+	struct row_entry
+	{
+		long int i;
+		long int j;
+		T val;
+
+		long int & row() {return i;}
+		long int & col() {return j;}
+		T & value() {return val;}
+	};
+
+	//! particle set
+	vector_type & particles;
+
+	//! signatures of the operators to construct
+	std::vector<Point<dim,unsigned int>> signatures;
+
+	//! products to sum
+	std::vector<composed_term> terms;
+
+	unsigned int convergenceOrder;
+	T rCut;
+	T supportSizeFactor;
+	support_options opt;
+
+	//! composed supports, the particle itself is one of the keys
+	SupportCSR localSupports;
+
+	//! weight of the key j of p is at localSupports.getRowOffset(p)+j
+	openfpm::vector<T> weights;
+
+	//! Index of the operator with the given signature, it is added if missing
+	unsigned int getOperatorId(const Point<dim,unsigned int> & signature)
+	{
+		for (size_t i = 0 ; i < signatures.size() ; i++)
+		{
+			bool eq = true;
+			for (size_t k = 0 ; k < dim ; k++)
+			{eq &= (signatures[i].get(k) == signature.get(k));}
+
+			if (eq == true)
+			{return i;}
+		}
+
+		signatures.push_back(signature);
+		return signatures.size() - 1;
+	}
+
+	/*! \brief Get from the owners the rows of the inner operators of the ghost particles in the supports
+	 *
+	 * \param ops operators
+	 * \param colIds global id of the local and ghost particles
+	 * \param rowStart global id of the first local particle
+	 * \param remoteIdx received rows, (global row, operator, global column) for each entry
+	 * \param remoteVal value of each received entry
+	 * \param remoteRows range of remoteIdx entries for each received global row
+	 *
+	 */
+	void exchangeInnerRows(std::vector<dcpse_type *> & ops,
+						   openfpm::vector<size_t> & colIds,
+						   size_t rowStart,
+						   openfpm::vector<size_t> & remoteIdx,
+						   openfpm::vector<T> & remoteVal,
+						   std::unordered_map<size_t,std::pair<size_t,size_t>> & remoteRows)
+	{
+		auto & v_cl = create_vcluster();
+
+		size_t nLocal = particles.size_local_orig();
+		openfpm::vector<size_t> nPart;
+		v_cl.allGather(nLocal,nPart);
+		v_cl.execute();
+
+		openfpm::vector<size_t> start;
+		start.resize(nPart.size()+1);
+		start.get(0) = 0;
+		for (size_t i = 0 ; i < nPart.size() ; i++)
+		{start.get(i+1) = start.get(i) + nPart.get(i);}
+
+		// Ghost particles in the supports of the outer operators, by owner
+		std::vector<bool> needed(colIds.size(),false);
+		for (size_t t = 0 ; t < terms.size() ; t++)
+		{
+			const SupportCSR & sup = ops[terms[t].outer]->getLocalSupports();
+			for (size_t p = 0 ; p < sup.size() ; p++)
+			{
+				for (size_t j = 0 ; j < sup.getRowSize(p) ; j++)
+				{
+					size_t k = sup.getKey(p,j);
+					if (k >= nLocal && k < colIds.size())
+					{needed[k] = true;}
+				}
+			}
+		}
+
+		openfpm::vector<openfpm::vector<size_t>> req(v_cl.size());
+		for (size_t k = nLocal ; k < colIds.size() ; k++)
+		{
+			if (needed[k] == false) {continue;}
+
+			size_t gid = colIds.get(k);
+			size_t owner = std::upper_bound(&start.get(0),&start.get(0)+start.size(),gid) - &start.get(0) - 1;
+			req.get(owner).add(gid);
+		}
+
+		openfpm::vector<openfpm::vector<size_t>> reqSend;
+		openfpm::vector<size_t> prcSend;
+		for (size_t i = 0 ; i < req.size() ; i++)
+		{
+			if (req.get(i).size() == 0) {continue;}
+			reqSend.add(req.get(i));
+			prcSend.add(i);
+		}
+
+		openfpm::vector<size_t> reqRecv;
+		openfpm::vector<size_t> prcRecv;
+		openfpm::vector<size_t> szRecv;
+		v_cl.SSendRecv(reqSend,reqRecv,prcSend,prcRecv,szRecv);
+
+		std::vector<bool> isInner(ops.size(),false);
+		for (size_t t = 0 ; t < terms.size() ; t++)
+		{isInner[terms[t].inner] = true;}
+
+		// Answer with the rows of all the inner operators
+		openfpm::vector<openfpm::vector<size_t>> repIdx;
+		openfpm::vector<openfpm::vector<T>> repVal;
+		openfpm::vector<size_t> prcRep;
+		openfpm::vector<row_entry> tmp;
+
+		size_t r = 0;
+		for (size_t i = 0 ; i < prcRecv.size() ; i++)
+		{
+			repIdx.add();
+			repVal.add();
+			prcRep.add(prcRecv.get(i));
+
+			for (size_t j = 0 ; j < szRecv.get(i) ; j++, r++)
+			{
+				size_t gid = reqRecv.get(r);
+				size_t q = gid - rowStart;
+
+				for (size_t op = 0 ; op < ops.size() ; op++)
+				{
+					if (isInner[op] == false) {continue;}
+
+					tmp.clear();
+					ops[op]->addRowTriplets(tmp,q,colIds,rowStart);
+					for (size_t e = 0 ; e < tmp.size() ; e++)
+					{
+						repIdx.last().add(gid);
+						repIdx.last().add(op);
+						repIdx.last().add(tmp.get(e).col());
+						repVal.last().add(tmp.get(e).value());
+					}
+				}
+			}
+		}
+
+		openfpm::vector<size_t> prcRecv2;
+		openfpm::vector<size_t> szRecv2;
+		v_cl.SSendRecv(repIdx,remoteIdx,prcRep,prcRecv2,szRecv2);
+		prcRecv2.clear();
+		szRecv2.clear();
+		v_cl.SSendRecv(repVal,remoteVal,prcRep,prcRecv2,szRecv2);
+
+		// The entries of one row are contiguous
+		remoteRows.clear();
+		for (size_t e = 0 ; e < remoteVal.size() ; e++)
+		{
+			size_t gid = remoteIdx.get(3*e);
+			auto f = remoteRows.find(gid);
+			if (f == remoteRows.end())
+			{remoteRows[gid] = std::pair<size_t,size_t>(e,e+1);}
+			else
+			{f->second.second = e+1;}
+		}
+	}
+
+	template<typename key_type, unsigned int prp, unsigned int prpOut>
+	void compute_impl(vector_type & particles)
+	{
+		auto it = particles.getDomainIterator();
+		while (it.isNext())
+		{
+			size_t xpK = particles.getOriginKey(it.get()).getKey();
+
+			auto support = localSupports.template getSupport<key_type>(xpK);
+			size_t off = localSupports.getRowOffset(xpK);
+
+			T acc = 0.0;
+			for (size_t j = 0 ; j < support.size() ; j++)
+			{acc += weights.get(off+j) * particles.template getProp<prp>(support.get(j));}
+
+			particles.template getProp<prpOut>(xpK) = acc;
+
+			++it;
+		}
+	}
+
+public:
+
+	/*! \brief Constructor
+	 *
+	 * \param particles particle set
+	 * \param convergenceOrder order of convergence of the operators
+	 * \param rCut cut-off radius for the support of every single operator
+	 * \param supportSizeFactor oversampling factor
+	 * \param opt support options
+	 *
+	 */
+	DcpseComposed(vector_type & particles,
+				  unsigned int convergenceOrder,
+				  T rCut,
+				  T supportSizeFactor = 1,
+				  support_options opt = support_options::RADIUS)
+	:particles(particles),convergenceOrder(convergenceOrder),rCut(rCut),supportSizeFactor(supportSizeFactor),opt(opt)
+	{}
+
+	/*! \brief Add coeff * outer(inner(f)) to the composed operator
+	 *
+	 * \param outer differential signature of the operator applied last
+	 * \param inner differential signature of the operator applied first
+	 * \param coeff multiplicative coefficient of the product
+	 *
+	 */
+	void addProduct(const Point<dim,unsigned int> & outer, const Point<dim,unsigned int> & inner, T coeff = 1.0)
+	{
+		composed_term t;
+		t.outer = getOperatorId(outer);
+		t.inner = getOperatorId(inner);
+		t.coeff = coeff;
+		terms.push_back(t);
+	}
+
+	/*! \brief Construct the operators and compute the composed kernels
+	 *
+	 */
+	void build()
+	{
+		localSupports.clear();
+		weights.clear();
+
+		if (terms.size() == 0)
+		{return;}
+
+		std::vector<dcpse_type *> ops(signatures.size(),NULL);
+		for (size_t i = 0 ; i < signatures.size() ; i++)
+		{ops[i] = new dcpse_type(particles, signatures[i], convergenceOrder, rCut, supportSizeFactor, opt);}
+
+		openfpm::vector<size_t> colIds;
+		size_t rowStart, nRows, nCols;
+		ops[0]->getGlobalIds(colIds,rowStart,nRows,nCols);
+
+		openfpm::vector<size_t> remoteIdx;
+		openfpm::vector<T> remoteVal;
+		std::unordered_map<size_t,std::pair<size_t,size_t>> remoteRows;
+		exchangeInnerRows(ops,colIds,rowStart,remoteIdx,remoteVal,remoteRows);
+
+		// global id -> local or ghost key
+		std::unordered_map<size_t,size_t> keyOf;
+		for (size_t k = 0 ; k < colIds.size() ; k++)
+		{keyOf.insert(std::pair<size_t,size_t>(colIds.get(k),k));}
+
+		size_t nLocal = particles.size_local_orig();
+		openfpm::vector<row_entry> rowA;
+		openfpm::vector<row_entry> rowB;
+		std::unordered_map<size_t,T> acc;
+		openfpm::vector<size_t> keys;
+		openfpm::vector<T> rowW;
+		size_t nMissing = 0;
+
+		for (size_t p = 0 ; p < nLocal ; p++)
+		{
+			acc.clear();
+
+			for (size_t t = 0 ; t < terms.size() ; t++)
+			{
+				rowA.clear();
+				ops[terms[t].outer]->addRowTriplets(rowA,p,colIds,rowStart,terms[t].coeff);
+
+				for (size_t i = 0 ; i < rowA.size() ; i++)
+				{
+					size_t gq = rowA.get(i).col();
+					T a = rowA.get(i).value();
+
+					if (gq >= rowStart && gq < rowStart + nLocal)
+					{
+						rowB.clear();
+						ops[terms[t].inner]->addRowTriplets(rowB,gq - rowStart,colIds,rowStart);
+						for (size_t j = 0 ; j < rowB.size() ; j++)
+						{acc[rowB.get(j).col()] += a * rowB.get(j).value();}
+					}
+					else
+					{
+						auto f = remoteRows.find(gq);
+						if (f == remoteRows.end()) {continue;}
+
+						for (size_t e = f->second.first ; e < f->second.second ; e++)
+						{
+							if (remoteIdx.get(3*e+1) != terms[t].inner) {continue;}
+							acc[remoteIdx.get(3*e+2)] += a * remoteVal.get(e);
+						}
+					}
+				}
+			}
+
+			keys.clear();
+			for (auto & c : acc)
+			{
+				auto f = keyOf.find(c.first);
+				if (f == keyOf.end())
+				{
+					nMissing++;
+					continue;
+				}
+				keys.add(f->second);
+			}
+
+			// Ascending keys, like the supports of Dcpse
+			if (keys.size() != 0)
+			{std::sort(&keys.get(0),&keys.get(0)+keys.size());}
+
+			size_t off = weights.size();
+			weights.resize(off + keys.size());
+			for (size_t j = 0 ; j < keys.size() ; j++)
+			{weights.get(off+j) = acc[colIds.get(keys.get(j))];}
+
+			localSupports.addRow(p,keys);
+		}
+		localSupports.finalize(nLocal);
+
+		if (nMissing != 0)
+		{
+			std::cerr << __FILE__ << ":" << __LINE__ << " error, " << nMissing << " entries of the composed operator are outside the ghost, the ghost must be at least 2*rCut" << std::endl;
+		}
+
+		for (size_t i = 0 ; i < ops.size() ; i++)
+		{delete ops[i];}
+	}
+
+	/*! \brief Rebuild the composed operator after the particles moved
+	 *
+	 */
+	void update()
+	{
+		build();
+	}
+
+	/*! \brief Get the composed supports, the weight of the key j of p is at getLocalSupports().getRowOffset(p)+j
+	 *
+	 * \return the composed supports
+	 *
+	 */
+	const SupportCSR & getLocalSupports() const
+	{
+		return localSupports;
+	}
+
+	/*! \brief Get the weights of the composed operator
+	 *
+	 * \return the weights
+	 *
+	 */
+	const openfpm::vector<T> & getWeights() const
+	{
+		return weights;
+	}
+
+	/*! \brief Apply the composed operator to the property prp (the ghost of prp must be up to date)
+	 *
+	 * \tparam prp input property
+	 * \tparam prpOut output property
+	 *
+	 * \param particles particle set
+	 *
+	 */
+	template<unsigned int prp, unsigned int prpOut>
+	void compute(vector_type & particles)
+	{
+		if (localSupports.is32bitKeys())
+		{compute_impl<unsigned int,prp,prpOut>(particles);}
+		else
+		{compute_impl<size_t,prp,prpOut>(particles);}
+	}
+};
+
+#endif
+#endif //OPENFPM_PDATA_DCPSECOMPOSED_HPP
@@ -19,8 +19,8 @@ private:
 public:
     DcpseDiagonalScalingMatrix(const monomialBasis_type &monomialBasis) : monomialBasis(monomialBasis) {}
 
-    template <typename T, typename MatrixType, typename vector_type, typename vector_type2>
-    void buildMatrix(MatrixType &M, Support support, T eps, vector_type & particlesFrom , vector_type2 & particlesTo)
+    template <typename T, typename MatrixType, typename vector_type, typename vector_type2, typename support_type>
+    void buildMatrix(MatrixType &M, const support_type & support, T eps, vector_type & particlesFrom , vector_type2 & particlesTo)
     {
         // Check that all the dimension constraints are met
         assert(support.size() >= monomialBasis.size());
@@ -43,6 +43,32 @@ public:
         }
     }
 
+    /*! \brief Multiply the rows of M by the diagonal of E, it is equivalent to M = E * M without building E
+     *
+     * \param M matrix to scale (at least support.size() rows)
+     * \param support support of the particle
+     * \param eps epsilon of the particle
+     *
+     */
+    template <typename T, typename MatrixType, typename vector_type, typename vector_type2, typename support_type>
+    void scaleRows(MatrixType &M, const support_type & support, T eps, vector_type & particlesFrom , vector_type2 & particlesTo)
+    {
+        assert(M.rows() >= support.size());
+
+        Point<dim,typename vector_type::stype> ref_p = particlesTo.getPosOrig(support.getReferencePointKey());
+
+        const auto& support_keys = support.getKeys();
+        size_t N = support_keys.size();
+        for (size_t i = 0; i < N; ++i)
+        {
+            const auto& pt = support_keys.get(i);
+            Point<dim,typename vector_type::stype> p = ref_p;
+            p -= particlesFrom.getPosOrig(pt);
+
+            M.row(i) *= exp(- norm2(p) / (2.0 * eps * eps));
+        }
+    }
+
     template <typename T, typename vector_type, typename vector_type2>
     __host__ __device__ void buildMatrix(T* M, size_t supportRefKey, size_t supportKeysSize, const size_t* supportKeys, T eps, vector_type & particlesFrom, vector_type2 & particlesTo)
     {
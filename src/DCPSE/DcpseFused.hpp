@@ -0,0 +1,242 @@
+//
+// Fused evaluation of several DCPSE operators that share the same support
+//
+
+#ifndef OPENFPM_PDATA_DCPSEFUSED_HPP
+#define OPENFPM_PDATA_DCPSEFUSED_HPP
+
+#ifdef HAVE_EIGEN
+
+#include "DCPSE/Dcpse.hpp"
+
+/*! \brief Evaluate several DCPSE operators on the same field in one neighbour sweep
+ *
+ * Every output is a linear combination of DCPSE operators (for example the Laplacian is
+ * Dxx + Dyy + Dzz). All the operators are constructed on one shared support (using the
+ * shared-support constructor of Dcpse), the kernels are then merged into one interleaved weight array
+ * with the epsilon prefactor already applied. compute() reads every neighbour value once and
+ * accumulates all the outputs in one pass.
+ *
+ * \code
+ *
+ * DcpseFused<3,vector_type> fused(particles,2,rCut);
+ * fused.addOperator(0,Point<3,unsigned int>({1,0,0}));   // output 0 = Dx
+ * fused.addOperator(1,Point<3,unsigned int>({0,1,0}));   // output 1 = Dy
+ * fused.addOperator(2,Point<3,unsigned int>({0,0,1}));   // output 2 = Dz
+ * fused.addOperator(3,Point<3,unsigned int>({2,0,0}));   // output 3 = Laplacian
+ * fused.addOperator(3,Point<3,unsigned int>({0,2,0}));
+ * fused.addOperator(3,Point<3,unsigned int>({0,0,2}));
+ * fused.build();
+ *
+ * fused.compute<0,1,2,3,4>(particles);   // f in property 0, Dx,Dy,Dz,Lap in 1,2,3,4
+ *
+ * \endcode
+ *
+ * \tparam dim dimensionality
+ * \tparam vector_type particle set
+ *
+ */
+template<unsigned int dim, typename vector_type>
+class DcpseFused
+{
+	typedef typename vector_type::stype T;
+	typedef Dcpse<dim,vector_type> dcpse_type;
+
+	//! One operator contributing to one output
+	struct fused_term
+	{
+		unsigned int out;
+		Point<dim,unsigned int> signature;
+		T coeff;
+	};
+
+	//! particle set
+	vector_type & particles;
+
+	//! operators to merge
+	std::vector<fused_term> terms;
+
+	//! number of outputs
+	unsigned int nOut = 0;
+
+	unsigned int convergenceOrder;
+	T rCut;
+	T supportSizeFactor;
+	support_options opt;
+
+	//! shared support
+	SupportCSR localSupports;
+
+	//! weight of the output o for the neighbour j of p is at (localSupports.getRowOffset(p)+j)*nOut + o
+	openfpm::vector<T> weights;
+
+	//! weight of the output o for the particle p itself is at p*nOut + o
+	openfpm::vector<T> diagWeights;
+
+	template<typename key_type, unsigned int prp, unsigned int ... prpOut>
+	void compute_impl(vector_type & particles)
+	{
+		constexpr unsigned int N = sizeof...(prpOut);
+		T acc[N];
+
+		auto it = particles.getDomainIterator();
+		while (it.isNext())
+		{
+			size_t xpK = particles.getOriginKey(it.get()).getKey();
+
+			auto support = localSupports.template getSupport<key_type>(xpK);
+			size_t kerOff = localSupports.getRowOffset(xpK);
+
+			T fxp = particles.template getProp<prp>(xpK);
+			const T * dw = &diagWeights.get(xpK*N);
+			for (unsigned int o = 0 ; o < N ; o++)
+			{acc[o] = dw[o] * fxp;}
+
+			for (size_t j = 0 ; j < support.size() ; j++)
+			{
+				T fxq = particles.template getProp<prp>(support.get(j));
+				const T * w = &weights.get((kerOff+j)*N);
+				for (unsigned int o = 0 ; o < N ; o++)
+				{acc[o] += w[o] * fxq;}
+			}
+
+			unsigned int o = 0;
+			int dummy[] = {0, (particles.template getProp<prpOut>(xpK) = acc[o++], 0)...};
+			(void)dummy;
+
+			++it;
+		}
+	}
+
+public:
+
+	/*! \brief Constructor
+	 *
+	 * \param particles particle set
+	 * \param convergenceOrder order of convergence of the operators
+	 * \param rCut cut-off radius for the support
+	 * \param supportSizeFactor oversampling factor
+	 * \param opt support options
+	 *
+	 */
+	DcpseFused(vector_type & particles,
+			   unsigned int convergenceOrder,
+			   T rCut,
+			   T supportSizeFactor = 1,
+			   support_options opt = support_options::RADIUS)
+	:particles(particles),convergenceOrder(convergenceOrder),rCut(rCut),supportSizeFactor(supportSizeFactor),opt(opt)
+	{}
+
+	/*! \brief Add the operator with the given signature to the output out
+	 *
+	 * \param out output index (the position in the output property list of compute)
+	 * \param signature differential signature of the operator
+	 * \param coeff multiplicative coefficient of the operator in the output
+	 *
+	 */
+	void addOperator(unsigned int out, const Point<dim,unsigned int> & signature, T coeff = 1.0)
+	{
+		fused_term t;
+		t.out = out;
+		t.signature = signature;
+		t.coeff = coeff;
+		terms.push_back(t);
+
+		if (out + 1 > nOut)
+		{nOut = out + 1;}
+	}
+
+	//! Number of outputs
+	unsigned int getNOutputs() const
+	{
+		return nOut;
+	}
+
+	/*! \brief Construct all the operators on one shared support and merge their kernels
+	 *
+	 */
+	void build()
+	{
+		if (terms.size() == 0)
+		{return;}
+
+		// The operators are built as a group: one support for all of them and one factorization per basis
+		std::vector<dcpse_type *> ops(terms.size(),NULL);
+		for (size_t i = 0 ; i < terms.size() ; i++)
+		{ops[i] = new dcpse_type(particles, terms[i].signature, convergenceOrder, rCut, supportSizeFactor, opt, dcpse_group_deferred());}
+
+		dcpse_type::initializeGroup(ops);
+
+		localSupports = ops[0]->getLocalSupports();
+
+		weights.resize(localSupports.getNKeys()*nOut);
+		weights.fill(0);
+		diagWeights.resize(localSupports.size()*nOut);
+		diagWeights.fill(0);
+
+		for (size_t i = 0 ; i < terms.size() ; i++)
+		{
+			// same convention of Dcpse::computeDifferentialOperator
+			T sign = (Monomial<dim>(terms[i].signature).order() % 2 == 0)?-1.0:1.0;
+			const auto & ker = ops[i]->getKernels();
+			unsigned int out = terms[i].out;
+
+			for (size_t p = 0 ; p < localSupports.size() ; p++)
+			{
+				size_t NN = localSupports.getRowSize(p);
+				if (NN == 0) {continue;}
+
+				size_t kerOff = localSupports.getRowOffset(p);
+				size_t opOff = ops[i]->getKernelOffset(p);
+				T prefactor = terms[i].coeff * ops[i]->getEpsilonInvPrefactor(vect_dist_key_dx(p));
+
+				for (size_t j = 0 ; j < NN ; j++)
+				{
+					T w = prefactor * ker.get(opOff+j);
+					weights.get((kerOff+j)*nOut + out) += w;
+					diagWeights.get(p*nOut + out) += sign * w;
+				}
+			}
+		}
+
+		for (size_t i = 0 ; i < ops.size() ; i++)
+		{delete ops[i];}
+	}
+
+	/*! \brief Rebuild the operators after the particles moved
+	 *
+	 */
+	void update()
+	{
+		localSupports.clear();
+		weights.clear();
+		diagWeights.clear();
+		build();
+	}
+
+	/*! \brief Apply all the outputs to the property prp in one sweep
+	 *
+	 * \tparam prp input property
+	 * \tparam prpOut one output property for each output added with addOperator
+	 *
+	 * \param particles particle set
+	 *
+	 */
+	template<unsigned int prp, unsigned int ... prpOut>
+	void compute(vector_type & particles)
+	{
+		if (sizeof...(prpOut) != nOut)
+		{
+			std::cerr << __FILE__ << ":" << __LINE__ << " error, the number of output properties (" << sizeof...(prpOut) << ") does not match the number of outputs (" << nOut << ")" << std::endl;
+			return;
+		}
+
+		if (localSupports.is32bitKeys())
+		{compute_impl<unsigned int,prp,prpOut...>(particles);}
+		else
+		{compute_impl<size_t,prp,prpOut...>(particles);}
+	}
+};
+
+#endif
+#endif //OPENFPM_PDATA_DCPSEFUSED_HPP
@@ -0,0 +1,234 @@
+//
+// Ghost exchange restricted to the ghost particles used by DCPSE supports
+//
+
+#ifndef OPENFPM_PDATA_DCPSEGHOST_HPP
+#define OPENFPM_PDATA_DCPSEGHOST_HPP
+
+#ifdef HAVE_EIGEN
+
+#include "DCPSE/Dcpse.hpp"
+#include <algorithm>
+#include <unordered_map>
+
+/*! \brief Fill only the ghost particles that appear in the supports of some DCPSE operators
+ *
+ * A ghost_get sends all the particles within the ghost width, while an operator reads only the ghost particles
+ * in its supports. build() collects those particles and tells their owners which of their particles they have
+ * to send; ghost_get then sends only the requested properties of the requested particles, and writes them in the
+ * ghost slots of the last full ghost_get (like a ghost_get with SKIP_LABELLING, the positions and the ghost
+ * structure must not have changed). The other ghost particles keep their old values.
+ *
+ * \code
+ *
+ * particles.ghost_get<0>();
+ * Dcpse<2,vector_type> Dx(particles,Point<2,unsigned int>({1,0}),2,rCut);
+ * Dcpse<2,vector_type> Dy(particles,Point<2,unsigned int>({0,1}),2,rCut);
+ *
+ * DcpseGhostExchange<2,vector_type> gx(particles);
+ * gx.addSupport(Dx.getLocalSupports());
+ * gx.addSupport(Dy.getLocalSupports());
+ * gx.build();
+ *
+ * // at every time step
+ * gx.ghost_get<0>();
+ * Dx.computeDifferentialOperator<0,1>(particles);
+ *
+ * \endcode
+ *
+ * The properties are copied by assignment, so they must be scalars or fixed-size types like VectorS
+ *
+ * \tparam dim dimensionality
+ * \tparam vector_type particle set
+ *
+ */
+template<unsigned int dim, typename vector_type>
+class DcpseGhostExchange
+{
+	typedef typename vector_type::stype T;
+
+	//! particle set
+	vector_type & particles;
+
+	//! ghost keys in the supports, set by addSupport
+	std::vector<bool> needed;
+
+	//! processors served and, for each one, the local keys to send
+	openfpm::vector<size_t> prcServe;
+	openfpm::vector<openfpm::vector<size_t>> sendKeys;
+
+	//! for each processor that sends, the ghost keys it fills (in the order of the message)
+	std::unordered_map<size_t,openfpm::vector<size_t>> recvKeys;
+
+	//! periodic images of local particles, (ghost key, local key)
+	openfpm::vector<aggregate<size_t,size_t>> selfCopies;
+
+	//! number of ghost particles filled by ghost_get
+	size_t nNeeded = 0;
+
+	template<unsigned int prp>
+	void ghost_get_prp()
+	{
+		auto & v_cl = create_vcluster();
+
+		typedef typename boost::mpl::at<typename vector_type::value_type::type,boost::mpl::int_<prp>>::type prop_type;
+
+		openfpm::vector<openfpm::vector<prop_type>> send;
+		for (size_t i = 0 ; i < prcServe.size() ; i++)
+		{
+			send.add();
+			const openfpm::vector<size_t> & keys = sendKeys.get(i);
+			send.last().resize(keys.size());
+			for (size_t j = 0 ; j < keys.size() ; j++)
+			{send.last().get(j) = particles.template getProp<prp>(keys.get(j));}
+		}
+
+		openfpm::vector<prop_type> recv;
+		openfpm::vector<size_t> prcRecv;
+		openfpm::vector<size_t> szRecv;
+		v_cl.SSendRecv(send,recv,prcServe,prcRecv,szRecv);
+
+		size_t off = 0;
+		for (size_t i = 0 ; i < prcRecv.size() ; i++)
+		{
+			const openfpm::vector<size_t> & keys = recvKeys[prcRecv.get(i)];
+			for (size_t j = 0 ; j < szRecv.get(i) && j < keys.size() ; j++)
+			{particles.template getProp<prp>(keys.get(j)) = recv.get(off+j);}
+			off += szRecv.get(i);
+		}
+
+		for (size_t i = 0 ; i < selfCopies.size() ; i++)
+		{particles.template getProp<prp>(selfCopies.template get<0>(i)) = particles.template getProp<prp>(selfCopies.template get<1>(i));}
+	}
+
+public:
+
+	DcpseGhostExchange(vector_type & particles)
+	:particles(particles)
+	{}
+
+	/*! \brief Add the ghost particles in the supports of an operator (for example Dcpse::getLocalSupports())
+	 *
+	 * \param sup supports, the keys are local or ghost keys of the particle set
+	 *
+	 */
+	void addSupport(const SupportCSR & sup)
+	{
+		size_t nLocal = particles.size_local_orig();
+		size_t nGhost = particles.size_local_with_ghost();
+		needed.resize(nGhost,false);
+
+		for (size_t p = 0 ; p < sup.size() ; p++)
+		{
+			for (size_t j = 0 ; j < sup.getRowSize(p) ; j++)
+			{
+				size_t k = sup.getKey(p,j);
+				if (k >= nLocal && k < nGhost)
+				{needed[k] = true;}
+			}
+		}
+	}
+
+	/*! \brief Find the owners of the ghost particles in the supports and send them the requests
+	 *
+	 * It is collective, and it must be called again after a map or a full ghost_get that changes the ghost
+	 *
+	 */
+	void build()
+	{
+		auto & v_cl = create_vcluster();
+
+		size_t nLocal = particles.size_local_orig();
+		openfpm::vector<size_t> nPart;
+		v_cl.allGather(nLocal,nPart);
+		v_cl.execute();
+
+		openfpm::vector<size_t> start;
+		start.resize(nPart.size()+1);
+		start.get(0) = 0;
+		for (size_t i = 0 ; i < nPart.size() ; i++)
+		{start.get(i+1) = start.get(i) + nPart.get(i);}
+		size_t myStart = start.get(v_cl.getProcessUnitID());
+
+		// The global id of the ghost particles is communicated with a particle set that has the same positions
+		vector_dist<dim,T,aggregate<size_t>> p_map(particles.getDecomposition(),0);
+		p_map.resize(nLocal);
+		for (size_t i = 0 ; i < nLocal ; i++)
+		{
+			p_map.getPos(i) = particles.getPosOrig(i);
+			p_map.template getProp<0>(i) = myStart + i;
+		}
+		p_map.template ghost_get<0>();
+
+		recvKeys.clear();
+		selfCopies.clear();
+		nNeeded = 0;
+
+		openfpm::vector<openfpm::vector<size_t>> req(v_cl.size());
+		for (size_t k = nLocal ; k < needed.size() && k < p_map.size_local_with_ghost() ; k++)
+		{
+			if (needed[k] == false) {continue;}
+			nNeeded++;
+
+			size_t gid = p_map.template getProp<0>(k);
+			size_t owner = std::upper_bound(&start.get(0),&start.get(0)+start.size(),gid) - &start.get(0) - 1;
+
+			if (owner == v_cl.getProcessUnitID())
+			{
+				selfCopies.add();
+				selfCopies.template get<0>(selfCopies.size()-1) = k;
+				selfCopies.template get<1>(selfCopies.size()-1) = gid - myStart;
+				continue;
+			}
+
+			req.get(owner).add(gid);
+			recvKeys[owner].add(k);
+		}
+
+		openfpm::vector<openfpm::vector<size_t>> reqSend;
+		openfpm::vector<size_t> prcSend;
+		for (size_t i = 0 ; i < req.size() ; i++)
+		{
+			if (req.get(i).size() == 0) {continue;}
+			reqSend.add(req.get(i));
+			prcSend.add(i);
+		}
+
+		openfpm::vector<size_t> reqRecv;
+		openfpm::vector<size_t> prcRecv;
+		openfpm::vector<size_t> szRecv;
+		v_cl.SSendRecv(reqSend,reqRecv,prcSend,prcRecv,szRecv);
+
+		prcServe.clear();
+		sendKeys.clear();
+		size_t r = 0;
+		for (size_t i = 0 ; i < prcRecv.size() ; i++)
+		{
+			prcServe.add(prcRecv.get(i));
+			sendKeys.add();
+			for (size_t j = 0 ; j < szRecv.get(i) ; j++, r++)
+			{sendKeys.last().add(reqRecv.get(r) - myStart);}
+		}
+	}
+
+	/*! \brief Send the properties prp of the ghost particles in the supports
+	 *
+	 * It is collective
+	 *
+	 */
+	template<unsigned int ... prp>
+	void ghost_get()
+	{
+		int dummy[] = {0, (ghost_get_prp<prp>(), 0)...};
+		(void)dummy;
+	}
+
+	//! Number of ghost particles filled by ghost_get on this processor
+	size_t getNGhostNeeded() const
+	{
+		return nNeeded;
+	}
+};
+
+#endif
+#endif //OPENFPM_PDATA_DCPSEGHOST_HPP
@@ -6,6 +6,42 @@
 #define OPENFPM_PDATA_DCPSEINTERPOLATION_HPP
 #include "DCPSE/Dcpse.hpp"
 
+#ifdef __NVCC__
+
+//! Interpolation of the last pair of properties of a particle on the device (end of the recursion)
+template<typename T, typename from_type, typename to_type>
+__device__ inline void pp_interpolation_row_gpu(from_type & from, to_type & to, unsigned int p, const size_t * keys,
+                                                const T * ker, size_t start, size_t stop, T epsInvPow)
+{}
+
+//! Interpolation of the pairs of properties of one particle on the device
+template<unsigned int prp1, unsigned int prp2, unsigned int ... prps, typename T, typename from_type, typename to_type>
+__device__ inline void pp_interpolation_row_gpu(from_type & from, to_type & to, unsigned int p, const size_t * keys,
+                                                const T * ker, size_t start, size_t stop, T epsInvPow)
+{
+    typedef typename std::remove_reference<decltype(to.template getProp<prp2>(p))>::type T2;
+
+    T2 Dfxp = 0;
+    for (size_t i = start ; i < stop ; i++)
+    {Dfxp += from.template getProp<prp1>(keys[i]) * ker[i];}
+
+    to.template getProp<prp2>(p) = epsInvPow*Dfxp;
+
+    pp_interpolation_row_gpu<prps...>(from,to,p,keys,ker,start,stop,epsInvPow);
+}
+
+//! Particle to particle interpolation on the device, one thread per particle of particlesTo
+template<unsigned int ... prps, typename T, typename from_type, typename to_type>
+__global__ void pp_interpolation_gpu(from_type from, to_type to, const size_t * offsets, const size_t * keys,
+                                     const T * ker, const T * epsInvPow)
+{
+    auto p = GET_PARTICLE(to);
+
+    pp_interpolation_row_gpu<prps...>(from,to,p,keys,ker,offsets[p],offsets[p+1],epsInvPow[p]);
+}
+
+#endif
+
 /*! \brief Class for Creating the DCPSE Operator For the function approximation objects and computes DCPSE Kernels.
  *
  *
@@ -27,6 +63,17 @@ class PPInterpolation
     particlesFrom_type & particlesFrom;
     particlesTo_type & particlesTo;
 
+#ifdef __NVCC__
+    //! supports and kernels on the device for p2p_gpu
+    openfpm::vector_custd<size_t> d_offsets;
+    openfpm::vector_custd<size_t> d_keys;
+    openfpm::vector_custd<typename particlesFrom_type::stype> d_ker;
+    openfpm::vector_custd<typename particlesFrom_type::stype> d_eps;
+
+    //! the device copy match the kernels
+    bool deviceValid = false;
+#endif
+
 public:
     /*! \brief Constructor for Creating the DCPSE Operator Dx and objects and computes DCPSE Kernels.
      *
@@ -61,13 +108,80 @@ public:
         return vector_dist_expression_op<operand_type, dcpse_type, VECT_DCPSE>(arg, *(dcpse_type *) dcpse);
     }*/
 
-   template<unsigned int prp1,unsigned int prp2>
+   /*! \brief Interpolate pairs of properties (from,to) from particlesFrom to particlesTo
+    *
+    * p2p<0,1,2,3>() interpolate the property 0 in 1 and 2 in 3 in one sweep over the supports
+    *
+    */
+   template<unsigned int prp1,unsigned int prp2, unsigned int ... prps>
    void p2p() {
        auto dcpse_temp = (Dcpse<particlesFrom_type::dims, particlesFrom_type, particlesTo_type>*) dcpse;
-       dcpse_temp->template p2p<prp1,prp2>();
+       dcpse_temp->template p2p<prp1,prp2,prps...>();
 
    }
 
+#ifdef __NVCC__
+
+   /*! \brief Interpolate pairs of properties (from,to) from particlesFrom to particlesTo on the device
+    *
+    * The supports and the kernels are copied on the device at the first call (and after update), the properties
+    * prp1 ... of particlesFrom (with the ghost) must be on the device, the results are left on the device
+    *
+    */
+   template<unsigned int prp1,unsigned int prp2, unsigned int ... prps>
+   void p2p_gpu() {
+       static_assert(sizeof...(prps) % 2 == 0, "p2p_gpu require pairs of properties (from,to)");
+
+       typedef typename particlesFrom_type::stype T;
+
+       if (deviceValid == false)
+       {
+           auto dcpse_temp = (Dcpse<particlesFrom_type::dims, particlesFrom_type, particlesTo_type>*) dcpse;
+           const SupportCSR & sup = dcpse_temp->getLocalSupports();
+           const auto & ker = dcpse_temp->getKernels();
+
+           size_t N = particlesTo.size_local();
+
+           d_offsets.resize(N+1);
+           d_keys.resize(sup.getNKeys());
+           d_ker.resize(sup.getNKeys());
+           d_eps.resize(N);
+
+           for (size_t p = 0 ; p <= N ; p++)
+           {d_offsets.get(p) = (p < N)?sup.getRowOffset(p):sup.getNKeys();}
+
+           for (size_t p = 0 ; p < N ; p++)
+           {
+               vect_dist_key_dx key;
+               key.setKey(p);
+               d_eps.get(p) = dcpse_temp->getEpsilonInvPrefactor(key);
+
+               for (size_t j = 0 ; j < sup.getRowSize(p) ; j++)
+               {
+                   d_keys.get(sup.getRowOffset(p) + j) = sup.getKey(p,j);
+                   d_ker.get(sup.getRowOffset(p) + j) = ker.get(dcpse_temp->getKernelOffset(p) + j);
+               }
+           }
+
+           d_offsets.template hostToDevice<0>();
+           d_keys.template hostToDevice<0>();
+           d_ker.template hostToDevice<0>();
+           d_eps.template hostToDevice<0>();
+
+           deviceValid = true;
+       }
+
+       if (particlesTo.size_local() == 0)
+       {return;}
+
+       auto ite = particlesTo.getDomainIteratorGPU(256);
+       CUDA_LAUNCH((pp_interpolation_gpu<prp1,prp2,prps...>),ite,particlesFrom.toKernel(),particlesTo.toKernel(),
+                   (const size_t *)d_offsets.template getDeviceBuffer<0>(),(const size_t *)d_keys.template getDeviceBuffer<0>(),
+                   (const T *)d_ker.template getDeviceBuffer<0>(),(const T *)d_eps.template getDeviceBuffer<0>());
+   }
+
+#endif
+
     // template<unsigned int prp, typename particles_type>
     // void DrawKernel(particles_type &particles, int k) {
     //     auto dcpse_temp = (Dcpse_type<particlesFrom_type::dims, particlesFrom_type, particlesTo_type> *) dcpse;
@@ -97,6 +211,9 @@ public:
     void update() {
         auto dcpse_temp = (Dcpse<particlesFrom_type::dims, particlesFrom_type, particlesTo_type> *) dcpse;
         dcpse_temp->initializeUpdate(particlesFrom,particlesTo);
+#ifdef __NVCC__
+        deviceValid = false;
+#endif
 
     }
 
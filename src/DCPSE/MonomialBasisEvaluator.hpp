@@ -0,0 +1,460 @@
+//
+// Evaluation of all the monomials of a basis on blocks of points
+//
+
+#ifndef OPENFPM_PDATA_MONOMIALBASISEVALUATOR_HPP
+#define OPENFPM_PDATA_MONOMIALBASISEVALUATOR_HPP
+
+#include "MonomialBasis.hpp"
+
+/*! \brief Evaluate all the monomials of a basis on many points
+ *
+ * Monomial::evaluate computes the powers of the coordinates for every monomial. This class
+ * computes the power tables x_d^0 ... x_d^p once for a block of points and builds every monomial
+ * from the tables. The inner loops run over the points of the block, so they can be vectorized by the compiler.
+ *
+ * \tparam dim dimensionality
+ * \tparam T type of the coordinates
+ *
+ */
+template<unsigned int dim, typename T>
+class MonomialBasisEvaluator
+{
+public:
+
+	//! Maximum exponent handled with the power tables (above it the evaluation falls back to Monomial::evaluate)
+	static const unsigned int maxExponent = 15;
+
+	//! Number of points evaluated together
+	static const unsigned int blockSize = 8;
+
+private:
+
+	//! number of monomials
+	size_t nBasis = 0;
+
+	//! largest exponent in the basis
+	unsigned int maxExp = 0;
+
+	//! exponent of the dimension d of the monomial m is at m*dim+d
+	openfpm::vector_std<unsigned int> exps;
+
+	//! order of every monomial
+	openfpm::vector_std<unsigned int> orders;
+
+	//! scalar coefficient of every monomial
+	openfpm::vector_std<T> scalars;
+
+	//! Evaluate the monomial m on x without power tables
+	inline T evaluateDirect(size_t m, const Point<dim,T> & x) const
+	{
+		T res = scalars.get(m);
+		for (unsigned int d = 0 ; d < dim ; d++)
+		{res *= openfpm::math::intpowlog(x.get(d), exps.get(m*dim+d));}
+		return res;
+	}
+
+	/*! \brief Compute the power tables of a block of points
+	 *
+	 * \param pw power tables pw[d][k][i] = x_i(d)^k
+	 * \param x points
+	 * \param i0 first point of the block
+	 * \param nb number of points in the block
+	 * \param scale every coordinate is multiplied by scale
+	 *
+	 */
+	inline void powerTables(T (& pw)[dim][maxExponent+1][blockSize], const openfpm::vector_std<Point<dim,T>> & x, size_t i0, size_t nb, T scale) const
+	{
+		for (unsigned int d = 0 ; d < dim ; d++)
+		{
+			// the points after nb are padding
+			T xd[blockSize];
+			for (size_t i = 0 ; i < blockSize ; i++)
+			{xd[i] = (i < nb)?x.get(i0+i).get(d) * scale:0.0;}
+
+			for (size_t i = 0 ; i < blockSize ; i++)
+			{pw[d][0][i] = 1.0;}
+
+			for (unsigned int k = 1 ; k <= maxExp ; k++)
+			{
+				for (size_t i = 0 ; i < blockSize ; i++)
+				{pw[d][k][i] = pw[d][k-1][i] * xd[i];}
+			}
+		}
+	}
+
+public:
+
+	MonomialBasisEvaluator() {}
+
+	/*! \brief Constructor
+	 *
+	 * \param basis monomial basis
+	 *
+	 */
+	template<typename basis_type>
+	explicit MonomialBasisEvaluator(const basis_type & basis)
+	{
+		nBasis = basis.size();
+		exps.resize(nBasis*dim);
+		orders.resize(nBasis);
+		scalars.resize(nBasis);
+
+		for (size_t m = 0 ; m < nBasis ; m++)
+		{
+			const Monomial<dim> & mono = basis.getElement(m);
+			for (unsigned int d = 0 ; d < dim ; d++)
+			{
+				exps.get(m*dim+d) = mono.getExponent(d);
+				maxExp = std::max(maxExp,mono.getExponent(d));
+			}
+			orders.get(m) = mono.order();
+			scalars.get(m) = mono.getScalar();
+		}
+	}
+
+	//! Number of monomials
+	inline size_t size() const
+	{
+		return nBasis;
+	}
+
+	/*! \brief Fill the Vandermonde rows of the points x, M(i,m) = m(x_i) / eps^order(m)
+	 *
+	 * \param M matrix with at least x.size() rows and size() columns
+	 * \param x points
+	 * \param eps scaling
+	 *
+	 */
+	template<typename MatrixType>
+	void buildRows(MatrixType & M, const openfpm::vector_std<Point<dim,T>> & x, T eps) const
+	{
+		size_t n = x.size();
+
+		if (maxExp > maxExponent)
+		{
+			for (size_t i = 0 ; i < n ; i++)
+			{
+				for (size_t m = 0 ; m < nBasis ; m++)
+				{M(i,m) = evaluateDirect(m,x.get(i)) / openfpm::math::intpowlog(eps,orders.get(m));}
+			}
+			return;
+		}
+
+		// The monomial evaluated on x/eps is m(x)/eps^order(m)
+		T invEps = 1.0 / eps;
+
+		T pw[dim][maxExponent+1][blockSize];
+		for (size_t i0 = 0 ; i0 < n ; i0 += blockSize)
+		{
+			size_t nb = std::min((size_t)blockSize, n - i0);
+			powerTables(pw,x,i0,nb,invEps);
+
+			for (size_t m = 0 ; m < nBasis ; m++)
+			{
+				T val[blockSize];
+				for (size_t i = 0 ; i < blockSize ; i++)
+				{val[i] = scalars.get(m);}
+
+				for (unsigned int d = 0 ; d < dim ; d++)
+				{
+					unsigned int e = exps.get(m*dim+d);
+					for (size_t i = 0 ; i < blockSize ; i++)
+					{val[i] *= pw[d][e][i];}
+				}
+
+				for (size_t i = 0 ; i < nb ; i++)
+				{M(i0+i,m) = val[i];}
+			}
+		}
+	}
+
+	/*! \brief Evaluate the combination sum_m a(m) m(x_i * scale) on every point
+	 *
+	 * \param out output, one value for every point
+	 * \param x points
+	 * \param scale every coordinate is multiplied by scale
+	 * \param a coefficients of the monomials
+	 *
+	 */
+	template<typename coeff_type>
+	void evaluateCombination(T * out, const openfpm::vector_std<Point<dim,T>> & x, T scale, const coeff_type & a) const
+	{
+		size_t n = x.size();
+
+		if (maxExp > maxExponent)
+		{
+			for (size_t i = 0 ; i < n ; i++)
+			{
+				Point<dim,T> xs = x.get(i) * scale;
+				out[i] = 0;
+				for (size_t m = 0 ; m < nBasis ; m++)
+				{out[i] += a(m) * evaluateDirect(m,xs);}
+			}
+			return;
+		}
+
+		T pw[dim][maxExponent+1][blockSize];
+		for (size_t i0 = 0 ; i0 < n ; i0 += blockSize)
+		{
+			size_t nb = std::min((size_t)blockSize, n - i0);
+			powerTables(pw,x,i0,nb,scale);
+
+			T res[blockSize];
+			for (size_t i = 0 ; i < blockSize ; i++)
+			{res[i] = 0;}
+
+			for (size_t m = 0 ; m < nBasis ; m++)
+			{
+				T val[blockSize];
+				T am = a(m) * scalars.get(m);
+				for (size_t i = 0 ; i < blockSize ; i++)
+				{val[i] = am;}
+
+				for (unsigned int d = 0 ; d < dim ; d++)
+				{
+					unsigned int e = exps.get(m*dim+d);
+					for (size_t i = 0 ; i < blockSize ; i++)
+					{val[i] *= pw[d][e][i];}
+				}
+
+				for (size_t i = 0 ; i < blockSize ; i++)
+				{res[i] += val[i];}
+			}
+
+			for (size_t i = 0 ; i < nb ; i++)
+			{out[i0+i] = res[i];}
+		}
+	}
+};
+
+//! Number of exponents alpha in [0,orderLimit)^dim with alphaMin <= |alpha| < orderLimit (the DCPSE basis, see MonomialBasis::generateBasis)
+template<unsigned int dim>
+constexpr unsigned int static_basis_size(unsigned int orderLimit, unsigned int alphaMin)
+{
+	unsigned int tot = 1;
+	for (unsigned int d = 0 ; d < dim ; d++)
+	{tot *= orderLimit;}
+
+	unsigned int n = 0;
+	for (unsigned int c = 0 ; c < tot ; c++)
+	{
+		unsigned int s = 0;
+		unsigned int r = c;
+		for (unsigned int d = 0 ; d < dim ; d++)
+		{
+			s += r % orderLimit;
+			r /= orderLimit;
+		}
+
+		if (s >= alphaMin && s < orderLimit)
+		{n++;}
+	}
+
+	return n;
+}
+
+//! Exponents of a basis generated at compile time
+template<unsigned int dim, unsigned int N>
+struct static_basis_table
+{
+	unsigned int e[N][dim];
+};
+
+//! Generate the exponents of the DCPSE basis in the same order of MonomialBasis::generateBasis (first dimension fastest)
+template<unsigned int dim, unsigned int N>
+constexpr static_basis_table<dim,N> static_basis_generate(unsigned int orderLimit, unsigned int alphaMin)
+{
+	static_basis_table<dim,N> t{};
+
+	unsigned int tot = 1;
+	for (unsigned int d = 0 ; d < dim ; d++)
+	{tot *= orderLimit;}
+
+	unsigned int n = 0;
+	for (unsigned int c = 0 ; c < tot ; c++)
+	{
+		unsigned int s = 0;
+		unsigned int r = c;
+		for (unsigned int d = 0 ; d < dim ; d++)
+		{
+			s += r % orderLimit;
+			r /= orderLimit;
+		}
+
+		if (s >= alphaMin && s < orderLimit)
+		{
+			r = c;
+			for (unsigned int d = 0 ; d < dim ; d++)
+			{
+				t.e[n][d] = r % orderLimit;
+				r /= orderLimit;
+			}
+			n++;
+		}
+	}
+
+	return t;
+}
+
+/*! \brief Evaluator of a DCPSE monomial basis known at compile time
+ *
+ * Same interface of MonomialBasisEvaluator, but the number of monomials and their exponents are compile-time
+ * constants, so the loops over the basis and the dimensions can be fully unrolled. Before using it check with
+ * matches() that the runtime basis is the same.
+ *
+ * \tparam dim dimensionality
+ * \tparam T type of the coordinates
+ * \tparam orderLimit the basis contains the monomials with order < orderLimit
+ * \tparam alphaMin ... and order >= alphaMin
+ *
+ */
+template<unsigned int dim, typename T, unsigned int orderLimit, unsigned int alphaMin>
+class StaticMonomialBasisEvaluator
+{
+public:
+
+	//! number of monomials
+	static constexpr unsigned int N = static_basis_size<dim>(orderLimit,alphaMin);
+
+	//! Number of points evaluated together
+	static const unsigned int blockSize = 8;
+
+private:
+
+	//! exponents
+	static constexpr static_basis_table<dim,N> table = static_basis_generate<dim,N>(orderLimit,alphaMin);
+
+	inline void powerTables(T (& pw)[dim][orderLimit][blockSize], const openfpm::vector_std<Point<dim,T>> & x, size_t i0, size_t nb, T scale) const
+	{
+		for (unsigned int d = 0 ; d < dim ; d++)
+		{
+			// the points after nb are padding
+			T xd[blockSize];
+			for (size_t i = 0 ; i < blockSize ; i++)
+			{xd[i] = (i < nb)?x.get(i0+i).get(d) * scale:0.0;}
+
+			for (size_t i = 0 ; i < blockSize ; i++)
+			{pw[d][0][i] = 1.0;}
+
+			for (unsigned int k = 1 ; k < orderLimit ; k++)
+			{
+				for (size_t i = 0 ; i < blockSize ; i++)
+				{pw[d][k][i] = pw[d][k-1][i] * xd[i];}
+			}
+		}
+	}
+
+public:
+
+	StaticMonomialBasisEvaluator() {}
+
+	//! The basis is known at compile time, the argument is only for compatibility with MonomialBasisEvaluator
+	template<typename basis_type>
+	explicit StaticMonomialBasisEvaluator(const basis_type & basis) {}
+
+	//! Number of monomials
+	inline size_t size() const
+	{
+		return N;
+	}
+
+	/*! \brief Check that the runtime basis is the one generated at compile time
+	 *
+	 * \param basis monomial basis
+	 *
+	 */
+	template<typename basis_type>
+	static bool matches(const basis_type & basis)
+	{
+		if (basis.size() != N)
+		{return false;}
+
+		for (size_t m = 0 ; m < N ; m++)
+		{
+			const Monomial<dim> & mono = basis.getElement(m);
+			if (mono.getScalar() != 1)
+			{return false;}
+
+			for (unsigned int d = 0 ; d < dim ; d++)
+			{
+				if (mono.getExponent(d) != table.e[m][d])
+				{return false;}
+			}
+		}
+
+		return true;
+	}
+
+	//! See MonomialBasisEvaluator::buildRows
+	template<typename MatrixType>
+	void buildRows(MatrixType & M, const openfpm::vector_std<Point<dim,T>> & x, T eps) const
+	{
+		size_t n = x.size();
+		T invEps = 1.0 / eps;
+
+		T pw[dim][orderLimit][blockSize];
+		for (size_t i0 = 0 ; i0 < n ; i0 += blockSize)
+		{
+			size_t nb = std::min((size_t)blockSize, n - i0);
+			powerTables(pw,x,i0,nb,invEps);
+
+			for (unsigned int m = 0 ; m < N ; m++)
+			{
+				T val[blockSize];
+				for (size_t i = 0 ; i < blockSize ; i++)
+				{val[i] = pw[0][table.e[m][0]][i];}
+
+				for (unsigned int d = 1 ; d < dim ; d++)
+				{
+					for (size_t i = 0 ; i < blockSize ; i++)
+					{val[i] *= pw[d][table.e[m][d]][i];}
+				}
+
+				for (size_t i = 0 ; i < nb ; i++)
+				{M(i0+i,m) = val[i];}
+			}
+		}
+	}
+
+	//! See MonomialBasisEvaluator::evaluateCombination
+	template<typename coeff_type>
+	void evaluateCombination(T * out, const openfpm::vector_std<Point<dim,T>> & x, T scale, const coeff_type & a) const
+	{
+		size_t n = x.size();
+
+		T pw[dim][orderLimit][blockSize];
+		for (size_t i0 = 0 ; i0 < n ; i0 += blockSize)
+		{
+			size_t nb = std::min((size_t)blockSize, n - i0);
+			powerTables(pw,x,i0,nb,scale);
+
+			T res[blockSize];
+			for (size_t i = 0 ; i < blockSize ; i++)
+			{res[i] = 0;}
+
+			for (unsigned int m = 0 ; m < N ; m++)
+			{
+				T am = a(m);
+				for (size_t i = 0 ; i < blockSize ; i++)
+				{
+					T val = am;
+					for (unsigned int d = 0 ; d < dim ; d++)
+					{val *= pw[d][table.e[m][d]][i];}
+					res[i] += val;
+				}
+			}
+
+			for (size_t i = 0 ; i < nb ; i++)
+			{out[i0+i] = res[i];}
+		}
+	}
+};
+
+template<unsigned int dim, typename T, unsigned int orderLimit, unsigned int alphaMin>
+constexpr unsigned int StaticMonomialBasisEvaluator<dim,T,orderLimit,alphaMin>::N;
+
+template<unsigned int dim, typename T, unsigned int orderLimit, unsigned int alphaMin>
+constexpr static_basis_table<dim,StaticMonomialBasisEvaluator<dim,T,orderLimit,alphaMin>::N> StaticMonomialBasisEvaluator<dim,T,orderLimit,alphaMin>::table;
+
+#endif //OPENFPM_PDATA_MONOMIALBASISEVALUATOR_HPP
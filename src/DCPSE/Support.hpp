@@ -7,6 +7,8 @@
 
 #include <Space/Shape/Point.hpp>
 #include <Vector/vector_dist.hpp>
+#include <algorithm>
+#include "util/numa_policy.hpp"
 
 class Support
 {
@@ -34,12 +36,19 @@ public:
               keys(keys.begin(), keys.end())
               {}
 
+    //! Take the keys without copying them
+    Support(const size_t &referencePoint, openfpm::vector_std<size_t> &&keys)
+            :referencePointKey(referencePoint)
+    {
+        this->keys.swap(keys);
+    }
+
     Support(const Support &other)
     : referencePointKey(other.referencePointKey),
       keys(other.keys)
      {}
 
-    size_t size()
+    size_t size() const
     {
         return keys.size();
     }
@@ -89,5 +98,400 @@ public:
 
 };
 
+/*! \brief Non-owning view on the support of one particle
+ *
+ * It exposes the same interface of Support (size, getReferencePointKey, getKeys().get(i))
+ * on top of a contiguous array of keys, so that the Vandermonde and the scaling matrix
+ * builders can be used without copying the keys
+ *
+ * \tparam key_type type used to store the neighbour keys
+ *
+ */
+template<typename key_type>
+class SupportView
+{
+    //! reference particle
+    size_t referencePointKey;
+
+    //! pointer to the first neighbour key
+    const key_type * keys;
+
+    //! number of neighbours
+    size_t nKeys;
+
+public:
+
+    SupportView(size_t referencePointKey, const key_type * keys, size_t nKeys)
+    :referencePointKey(referencePointKey),keys(keys),nKeys(nKeys)
+    {}
+
+    inline size_t size() const
+    {
+        return nKeys;
+    }
+
+    inline size_t getReferencePointKey() const
+    {
+        return referencePointKey;
+    }
+
+    inline size_t get(size_t i) const
+    {
+        return keys[i];
+    }
+
+    inline const key_type * getPointer() const
+    {
+        return keys;
+    }
+
+    //! The view is its own key container
+    inline const SupportView<key_type> & getKeys() const
+    {
+        return *this;
+    }
+};
+
+/*! \brief Compressed (CSR-like) storage of the supports of a set of particles
+ *
+ * All the neighbour keys are stored in one contiguous array, the neighbours of the particle (row) r
+ * are in [rowOffsets(r),rowOffsets(r+1)). The keys are stored as 32-bit integers as long as they fit,
+ * the storage is promoted to 64-bit keys the first time a bigger key is added.
+ *
+ * Rows must be added in increasing order, rows that are never added are empty
+ *
+ */
+class SupportCSR
+{
+    //! offset of the first key of each row (number of rows + 1)
+    openfpm::vector<size_t> rowOffsets;
+
+    //! neighbour keys when stored with 32-bit
+    openfpm::vector<unsigned int> keys32;
+
+    //! neighbour keys when stored with 64-bit
+    openfpm::vector<size_t> keys64;
+
+    //! true if the keys are stored in keys32
+    bool is32 = true;
+
+    //! next row that can be added
+    size_t nextRow = 0;
+
+    //! Promote the keys from 32 to 64 bit
+    void promote()
+    {
+        keys64.resize(keys32.size());
+        for (size_t i = 0 ; i < keys32.size() ; i++)
+        {keys64.get(i) = keys32.get(i);}
+
+        openfpm::vector<unsigned int> empty;
+        keys32.swap(empty);
+        is32 = false;
+    }
+
+    inline const unsigned int * keysPointer(const unsigned int *) const
+    {
+        return (const unsigned int *)keys32.getPointer();
+    }
+
+    inline const size_t * keysPointer(const size_t *) const
+    {
+        return (const size_t *)keys64.getPointer();
+    }
+
+public:
+
+    //! Remove all the rows
+    void clear()
+    {
+        rowOffsets.clear();
+        keys32.clear();
+        keys64.clear();
+        is32 = true;
+        nextRow = 0;
+    }
+
+    /*! \brief Add the support of one row
+     *
+     * \param row row to add (must be bigger than any row already added)
+     * \param keys container of keys (with size() and get(i))
+     *
+     */
+    template<typename keys_type>
+    void addRow(size_t row, const keys_type & keys)
+    {
+        if (row < nextRow)
+        {
+            std::cerr << __FILE__ << ":" << __LINE__ << " error, rows must be added in increasing order. Row: " << row << " expected >= " << nextRow << std::endl;
+            return;
+        }
+
+        size_t nk = getNKeys();
+        rowOffsets.resize(row+1);
+        for (size_t r = nextRow ; r <= row ; r++)
+        {rowOffsets.get(r) = nk;}
+
+        if (is32 == true)
+        {
+            for (size_t i = 0 ; i < keys.size() ; i++)
+            {
+                if (keys.get(i) > std::numeric_limits<unsigned int>::max())
+                {
+                    promote();
+                    break;
+                }
+            }
+        }
+
+        if (is32 == true)
+        {
+            keys32.resize(nk + keys.size());
+            for (size_t i = 0 ; i < keys.size() ; i++)
+            {keys32.get(nk+i) = keys.get(i);}
+        }
+        else
+        {
+            keys64.resize(nk + keys.size());
+            for (size_t i = 0 ; i < keys.size() ; i++)
+            {keys64.get(nk+i) = keys.get(i);}
+        }
+
+        nextRow = row + 1;
+    }
+
+    /*! \brief Close the structure, any row not added up to nRows is empty
+     *
+     * \param nRows total number of rows
+     *
+     */
+    void finalize(size_t nRows)
+    {
+        if (nRows < nextRow)
+        {nRows = nextRow;}
+
+        size_t nk = getNKeys();
+        rowOffsets.resize(nRows+1);
+        for (size_t r = nextRow ; r <= nRows ; r++)
+        {rowOffsets.get(r) = nk;}
+
+        nextRow = nRows;
+    }
+
+    //! Number of rows
+    inline size_t size() const
+    {
+        return (rowOffsets.size() == 0)?0:rowOffsets.size() - 1;
+    }
+
+    //! Total number of keys stored
+    inline size_t getNKeys() const
+    {
+        return (is32 == true)?keys32.size():keys64.size();
+    }
+
+    //! Return true if the keys are stored as 32-bit integers
+    inline bool is32bitKeys() const
+    {
+        return is32;
+    }
+
+    //! Offset of the first key of the row r
+    inline size_t getRowOffset(size_t r) const
+    {
+        return rowOffsets.get(r);
+    }
+
+    //! Number of keys in the row r
+    inline size_t getRowSize(size_t r) const
+    {
+        return rowOffsets.get(r+1) - rowOffsets.get(r);
+    }
+
+    //! Return the key j of the row r
+    inline size_t getKey(size_t r, size_t j) const
+    {
+        return (is32 == true)?keys32.get(rowOffsets.get(r)+j):keys64.get(rowOffsets.get(r)+j);
+    }
+
+    /*! \brief Return a view on the row r
+     *
+     * \tparam key_type must be unsigned int when is32bitKeys() is true, size_t otherwise
+     *
+     */
+    template<typename key_type>
+    inline SupportView<key_type> getSupport(size_t r) const
+    {
+        size_t off = rowOffsets.get(r);
+        return SupportView<key_type>(r,keysPointer((const key_type *)NULL)+off,rowOffsets.get(r+1)-off);
+    }
+
+    /*! \brief Sort the keys of the row r in ascending order
+     *
+     * Any data stored by key position (like the DCPSE kernels) must be computed after sorting
+     *
+     */
+    void sortRow(size_t r)
+    {
+        size_t off = rowOffsets.get(r);
+        size_t n = rowOffsets.get(r+1) - off;
+        if (n < 2)
+        {return;}
+
+        if (is32 == true)
+        {std::sort(&keys32.get(off),&keys32.get(off)+n);}
+        else
+        {std::sort(&keys64.get(off),&keys64.get(off)+n);}
+    }
+
+    /*! \brief Sort the keys of the row r with the comparator cmp
+     *
+     * \param r row
+     * \param cmp strict weak ordering on the keys of the row (cmp(a,b) true if a goes before b)
+     *
+     */
+    template<typename cmp_type>
+    void sortRow(size_t r, cmp_type cmp)
+    {
+        size_t off = rowOffsets.get(r);
+        size_t n = rowOffsets.get(r+1) - off;
+        if (n < 2)
+        {return;}
+
+        if (is32 == true)
+        {std::sort(&keys32.get(off),&keys32.get(off)+n,[&](unsigned int a, unsigned int b){return cmp((size_t)a,(size_t)b);});}
+        else
+        {std::sort(&keys64.get(off),&keys64.get(off)+n,cmp);}
+    }
+
+    //! Sort the keys of every row in ascending order, see sortRow
+    void sortRows()
+    {
+        for (size_t r = 0 ; r < size() ; r++)
+        {sortRow(r);}
+    }
+
+    /*! \brief Move the rows in new memory placed by the policy, see numa_policy
+     *
+     * \param pol policy
+     *
+     */
+    void place(const numa_policy & pol)
+    {
+        if (size() == 0)
+        {return;}
+
+        auto off = [&](size_t r){return rowOffsets.get(r);};
+
+        if (is32 == true)
+        {numa_place_rows(keys32,size(),off,pol);}
+        else
+        {numa_place_rows(keys64,size(),off,pol);}
+
+        numa_place_rows(rowOffsets,size(),[&](size_t r){return (r == size())?rowOffsets.size():r;},pol);
+    }
+
+    //! Pointer to the row offsets (size()+1 entries)
+    inline const size_t * getRowOffsetsPointer() const
+    {
+        return (const size_t *)rowOffsets.getPointer();
+    }
+
+    //! Pointer to the keys (unsigned int if is32bitKeys(), size_t otherwise)
+    inline const void * getKeysPointer() const
+    {
+        return (is32 == true)?(const void *)keys32.getPointer():(const void *)keys64.getPointer();
+    }
+
+    /*! \brief Fill the structure from raw arrays
+     *
+     * \tparam key_type unsigned int or size_t
+     *
+     * \param nRows number of rows
+     * \param offsets row offsets (nRows+1 entries)
+     * \param keys keys (offsets[nRows] entries)
+     *
+     */
+    template<typename key_type>
+    void assign(size_t nRows, const size_t * offsets, const key_type * keys)
+    {
+        clear();
+
+        rowOffsets.resize(nRows+1);
+        for (size_t r = 0 ; r <= nRows ; r++)
+        {rowOffsets.get(r) = offsets[r];}
+
+        size_t nk = offsets[nRows];
+        is32 = std::is_same<key_type,unsigned int>::value;
+        if (is32 == true)
+        {
+            keys32.resize(nk);
+            for (size_t i = 0 ; i < nk ; i++)
+            {keys32.get(i) = keys[i];}
+        }
+        else
+        {
+            keys64.resize(nk);
+            for (size_t i = 0 ; i < nk ; i++)
+            {keys64.get(i) = keys[i];}
+        }
+
+        nextRow = nRows;
+    }
+
+    //! Memory used in byte
+    size_t getMemoryUsage() const
+    {
+        return rowOffsets.size()*sizeof(size_t) + keys32.size()*sizeof(unsigned int) + keys64.size()*sizeof(size_t);
+    }
+
+    void swap(SupportCSR & other)
+    {
+        rowOffsets.swap(other.rowOffsets);
+        keys32.swap(other.keys32);
+        keys64.swap(other.keys64);
+        std::swap(is32,other.is32);
+        std::swap(nextRow,other.nextRow);
+    }
+
+    static bool pack()
+    {
+        return true;
+    }
+
+    static bool packRequest()
+    {
+        return true;
+    }
+
+    template<int ... prp> inline void packRequest(size_t & req) const
+    {
+        req += sizeof(size_t);
+        Packer<decltype(rowOffsets),HeapMemory>::packRequest(rowOffsets,req);
+        Packer<decltype(keys32),HeapMemory>::packRequest(keys32,req);
+        Packer<decltype(keys64),HeapMemory>::packRequest(keys64,req);
+    }
+
+    template<int ... prp> inline void pack(ExtPreAlloc<HeapMemory> & mem, Pack_stat & sts) const
+    {
+        size_t flag = is32;
+        Packer<size_t,HeapMemory>::pack(mem,flag,sts);
+        Packer<decltype(rowOffsets),HeapMemory>::pack(mem,rowOffsets,sts);
+        Packer<decltype(keys32),HeapMemory>::pack(mem,keys32,sts);
+        Packer<decltype(keys64),HeapMemory>::pack(mem,keys64,sts);
+    }
+
+    template<unsigned int ... prp, typename MemType> inline void unpack(ExtPreAlloc<MemType> & mem, Unpack_stat & ps)
+    {
+        size_t flag;
+        Unpacker<size_t,MemType>::unpack(mem,flag,ps);
+        Unpacker<decltype(rowOffsets),MemType>::unpack(mem,rowOffsets,ps);
+        Unpacker<decltype(keys32),MemType>::unpack(mem,keys32,ps);
+        Unpacker<decltype(keys64),MemType>::unpack(mem,keys64,ps);
+        is32 = (flag != 0);
+        nextRow = size();
+    }
+};
+
 
 #endif //OPENFPM_PDATA_SUPPORT_HPP
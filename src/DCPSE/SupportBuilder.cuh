@@ -10,17 +10,33 @@
 #include "Support.hpp"
 #include <utility>
 #include "SupportBuilder.hpp"
+#include "util/cuda/scan_ofp.cuh"
+#include "util/cuda/reduce_ofp.cuh"
 
 
-template<unsigned int dim, typename T, typename particles_type, typename CellList_type, typename supportSize_type>
+//! Radius of the support equal for all the particles, same interface of a device vector of radii
+template<typename T>
+struct support_radius_const
+{
+	T r;
+
+	__device__ __host__ inline T get(size_t p) const
+	{
+		return r;
+	}
+};
+
+
+template<unsigned int dim, typename T, typename particles_type, typename CellList_type, typename supportSize_type, typename radius_type>
 __global__ void gatherSupportSize_gpu(
 	particles_type particles,
 	CellList_type cellList,
 	supportSize_type supportSize,
-	T rCut)
+	radius_type radius)
 {
 	auto p = GET_PARTICLE(particles);
 	Point<dim, T> pos = particles.getPos(p);
+	T rCut = radius.get(p);
 
 	size_t N = 0;
 	auto Np = cellList.getNNIteratorBox(cellList.getCell(pos));
@@ -36,18 +52,18 @@ __global__ void gatherSupportSize_gpu(
 }
 
 
-template<unsigned int dim, typename T, typename particles_type, typename CellList_type, typename supportKey_type>
+template<unsigned int dim, typename T, typename particles_type, typename CellList_type, typename supportKey_type, typename radius_type>
 __global__ void assembleSupport_gpu(
 	particles_type particles,
 	CellList_type cellList,
 	supportKey_type supportSize,
 	supportKey_type supportKeys1D,
-	T rCut)
+	radius_type radius)
 {
 	auto p = GET_PARTICLE(particles);
 	Point<dim, T> pos = particles.getPos(p);
+	T rCut = radius.get(p);
 
-	size_t  supportKeysSize = supportSize.get(p+1)-supportSize.get(p);
 	size_t* supportKeys = &((size_t*)supportKeys1D.getPointer())[supportSize.get(p)];
 
 	size_t N = 0;
@@ -62,51 +78,330 @@ __global__ void assembleSupport_gpu(
 }
 
 
+/*! \brief Radius of the ADAPTIVE support of every particle: adaptiveSizeFactor times the distance of the nearest
+ *         neighbour in the cells around it (same rule of SupportBuilder::selectSupport)
+ *
+ */
+template<unsigned int dim, typename T, typename particles_type, typename CellList_type, typename radius_type>
+__global__ void adaptiveRadius_gpu(
+	particles_type particles,
+	CellList_type cellList,
+	radius_type radius,
+	T adaptiveSizeFactor)
+{
+	auto p = GET_PARTICLE(particles);
+	Point<dim, T> pos = particles.getPos(p);
+
+	T minSpacing = std::numeric_limits<T>::max();
+	auto Np = cellList.getNNIteratorBox(cellList.getCell(pos));
+	while (Np.isNext())
+	{
+		auto q = Np.get(); ++Np;
+
+		if (p == q) continue;
+		T d = pos.distance(particles.getPosOrig(q));
+		if (d != 0 && d < minSpacing) minSpacing = d;
+	}
+
+	radius.get(p) = adaptiveSizeFactor * minSpacing;
+}
+
+
+/*! \brief One step of the ring expansion of the nearest neighbour supports
+ *
+ * The cells of the cell list are at least s wide, so the particles closer than s are all in the box of cells around
+ * the particle. A particle that has at least n of them gets its level (the n nearest are in this box) and its support
+ * size, the others are counted in pending and retried with bigger cells. At the last level the box is taken as it is
+ *
+ */
+template<unsigned int dim, typename T, typename particles_type, typename CellList_type, typename supportSize_type, typename level_type, typename pending_type>
+__global__ void countNearest_gpu(
+	particles_type particles,
+	CellList_type cellList,
+	supportSize_type supportSize,
+	level_type level,
+	pending_type pending,
+	T s,
+	size_t n,
+	int lvl,
+	bool last)
+{
+	auto p = GET_PARTICLE(particles);
+	if (level.get(p) >= 0) return;
+
+	Point<dim, T> pos = particles.getPos(p);
+
+	size_t nWithin = 0, nBox = 0;
+	auto Np = cellList.getNNIteratorBox(cellList.getCell(pos));
+	while (Np.isNext())
+	{
+		auto q = Np.get(); ++Np;
+
+		if (p == q) continue;
+		++nBox;
+		if (pos.distance(particles.getPosOrig(q)) < s) ++nWithin;
+	}
+
+	if (nWithin >= n || last == true)
+	{
+		level.get(p) = lvl;
+		supportSize.get(p) = (nBox < n)?nBox:n;
+	}
+	else
+	{atomicAdd(&pending.get(0), 1u);}
+}
+
+
+/*! \brief Select the n nearest neighbours of the particles of one level (k-selection on the device)
+ *
+ * The support is filled in increasing (distance, key) order, every step takes the smallest candidate after the last
+ * selected one, so no per-particle candidate buffer is needed
+ *
+ */
+template<unsigned int dim, typename T, typename particles_type, typename CellList_type, typename supportKey_type, typename level_type>
+__global__ void selectNearest_gpu(
+	particles_type particles,
+	CellList_type cellList,
+	supportKey_type supportOffsets,
+	supportKey_type supportKeys1D,
+	level_type level,
+	int lvl)
+{
+	auto p = GET_PARTICLE(particles);
+	if (level.get(p) != lvl) return;
+
+	Point<dim, T> pos = particles.getPos(p);
+
+	size_t n = supportOffsets.get(p+1) - supportOffsets.get(p);
+	size_t* supportKeys = &((size_t*)supportKeys1D.getPointer())[supportOffsets.get(p)];
+
+	T lastDist = -1;
+	size_t lastKey = 0;
+	for (size_t k = 0 ; k < n ; k++)
+	{
+		T bestDist = std::numeric_limits<T>::max();
+		size_t bestKey = std::numeric_limits<size_t>::max();
+
+		auto Np = cellList.getNNIteratorBox(cellList.getCell(pos));
+		while (Np.isNext())
+		{
+			size_t q = Np.get(); ++Np;
+
+			if (p == q) continue;
+			T d = pos.distance(particles.getPosOrig(q));
+
+			if (d < lastDist || (d == lastDist && q <= lastKey)) continue;
+			if (d < bestDist || (d == bestDist && q < bestKey))
+			{
+				bestDist = d;
+				bestKey = q;
+			}
+		}
+
+		supportKeys[k] = bestKey;
+		lastDist = bestDist;
+		lastKey = bestKey;
+	}
+}
+
+
 template<typename vector_type>
 class SupportBuilderGPU
 {
 private:
+	typedef typename vector_type::stype T;
+
 	vector_type &domain;
-	typename vector_type::stype rCut;
+	T rCut;
+
+	//! support options, RADIUS and ADAPTIVE select by distance, the others the requiredSize nearest
+	support_options opt;
+	size_t requiredSize;
+	T adaptiveSizeFactor = 1;
+
+	//! Maximum number of ring expansions (the cells double at every one) of the nearest neighbour supports
+	int maxLevels = 8;
+
+	//! Support sizes of the particles within radius (one for all or one per particle)
+	template<typename radius_type>
+	void gatherRadius(size_t N, openfpm::vector_custd<size_t>& supportSize, radius_type radius)
+	{
+		auto it = domain.getDomainIteratorGPU(512);
+		auto NN = domain.getCellListGPU(rCut);
+		domain.updateCellListGPU(NN);
+
+		gatherSupportSize_gpu<vector_type::dims,T><<<it.wthr,it.thr>>>(domain.toKernel(), NN.toKernel(), supportSize.toKernel(), radius);
+	}
+
+	//! Support sizes of the nearest neighbour supports, the level of every particle is left in supportLevel
+	void gatherNearest(size_t N, openfpm::vector_custd<size_t>& supportSize)
+	{
+		auto it = domain.getDomainIteratorGPU(512);
+
+		supportLevel.resize(N);
+		cudaMemsetAsync((int *)supportLevel.template getDeviceBuffer<0>(), 0xff, N*sizeof(int));
+		pending.resize(1);
+
+		T s = rCut;
+		for (int lvl = 0 ; lvl < maxLevels ; lvl++, s *= 2)
+		{
+			auto NN = domain.getCellListGPU(s);
+			domain.updateCellListGPU(NN);
+
+			cudaMemsetAsync((unsigned int *)pending.template getDeviceBuffer<0>(), 0, sizeof(unsigned int));
+			countNearest_gpu<vector_type::dims,T><<<it.wthr,it.thr>>>(domain.toKernel(), NN.toKernel(), supportSize.toKernel(),
+			                 supportLevel.toKernel(), pending.toKernel(), s, requiredSize, lvl, lvl == maxLevels - 1);
+
+			pending.template deviceToHost<0>();
+			nLevels = lvl + 1;
+			if (pending.get(0) == 0)
+			{break;}
+		}
+	}
+
+	//! Fill the keys of the nearest neighbour supports, one pass per level with the cell list of that level
+	void assembleNearest(openfpm::vector_custd<size_t>& kerOffsets, openfpm::vector_custd<size_t>& supportKeys1D)
+	{
+		auto it = domain.getDomainIteratorGPU(512);
+
+		T s = rCut;
+		for (int lvl = 0 ; lvl < nLevels ; lvl++, s *= 2)
+		{
+			auto NN = domain.getCellListGPU(s);
+			domain.updateCellListGPU(NN);
+
+			selectNearest_gpu<vector_type::dims,T><<<it.wthr,it.thr>>>(domain.toKernel(), NN.toKernel(), kerOffsets.toKernel(),
+			                  supportKeys1D.toKernel(), supportLevel.toKernel(), lvl);
+		}
+	}
+
+	//! work buffers of the ADAPTIVE and nearest neighbour supports
+	openfpm::vector_custd<T> radiusBuf;
+	openfpm::vector_custd<int> supportLevel;
+	openfpm::vector_custd<unsigned int> pending;
+	int nLevels = 0;
 
 public:
-	SupportBuilderGPU(vector_type &domain, typename vector_type::stype rCut)
-		: domain(domain), rCut(rCut) {}
+	SupportBuilderGPU(vector_type &domain, typename vector_type::stype rCut,
+	                  support_options opt = support_options::RADIUS, size_t requiredSize = 0)
+		: domain(domain), rCut(rCut), opt(opt), requiredSize(requiredSize) {}
 
-	void getSupport(
+	//! Factor of the minimum spacing giving the ADAPTIVE support radius (see SupportBuilder::setAdapFac)
+	void setAdapFac(T fac)
+	{
+		adaptiveSizeFactor = fac;
+	}
+
+	//! Return true if the support option is built on the device
+	static bool isSupported(support_options opt)
+	{
+		return opt == support_options::RADIUS || opt == support_options::ADAPTIVE ||
+		       opt == support_options::N_PARTICLES || opt == support_options::AT_LEAST_N_PARTICLES;
+	}
+
+	/*! \brief Build the supports on the device
+	 *
+	 * The offsets are the prefix sum of the support sizes computed on the device. Only the total number of keys
+	 * and the maximum support size are read back, they are needed to size the buffers. The positions must be
+	 * already on the device and the keys are left on the device
+	 *
+	 * RADIUS takes the neighbours closer than rCut, ADAPTIVE the neighbours closer than adaptiveSizeFactor times the
+	 * nearest neighbour distance (both within the cells around the particle, like on the host). N_PARTICLES and
+	 * AT_LEAST_N_PARTICLES take the requiredSize nearest, sorted by distance: the cells are doubled until the
+	 * requiredSize nearest of every particle are in the cells around it (one counter per particle), then each
+	 * particle selects them with a k-selection on the device
+	 *
+	 * \param N number of particles
+	 * \param kerOffsets offset of the support of each particle (N+1 entries)
+	 * \param supportKeys1D keys of all the supports
+	 * \param maxSupport maximum support size
+	 * \param supportKeysTotalN total number of keys
+	 * \param supportSize work buffer, reused between calls
+	 * \param maxSupportBuf work buffer, reused between calls
+	 *
+	 */
+	void getSupportDevice(
 		size_t N,
 		openfpm::vector_custd<size_t>& kerOffsets,
 		openfpm::vector_custd<size_t>& supportKeys1D,
 		size_t& maxSupport,
-		size_t& supportKeysTotalN)
+		size_t& supportKeysTotalN,
+		openfpm::vector_custd<size_t>& supportSize,
+		openfpm::vector_custd<size_t>& maxSupportBuf)
 	{
-		domain.hostToDevicePos();
-		auto it = domain.getDomainIteratorGPU(512);
-		typedef CellList<vector_type::dims, typename vector_type::stype, Mem_fast<CudaMemory>, shift<vector_type::dims, typename vector_type::stype>> params;
-		auto NN = domain.getCellListGPU(rCut);
-		domain.updateCellListGPU(NN);
-
-		// +1 to allow getting size from cumulative sum: "size[i+1] - size[i]"
+		supportKeysTotalN = 0; maxSupport = 0;
 		kerOffsets.resize(N+1);
-		gatherSupportSize_gpu<vector_type::dims><<<it.wthr,it.thr>>>(domain.toKernel(), NN.toKernel(), kerOffsets.toKernel(), rCut);
-		kerOffsets.template deviceToHost();
+		if (N == 0) {
+			kerOffsets.get(0) = 0;
+			kerOffsets.template hostToDevice<0>();
+			supportKeys1D.resize(0);
+			return;
+		}
 
-		supportKeysTotalN = 0; maxSupport = 0;
+		auto & v_cl = create_vcluster<CudaMemory>();
+
+		// the last entry is zero, so the exclusive scan leaves the total in kerOffsets[N]
+		supportSize.resize(N+1);
+		cudaMemsetAsync((size_t *)supportSize.template getDeviceBuffer<0>() + N, 0, sizeof(size_t));
 
-		for (size_t i = 0; i < N; ++i) {
-			size_t sz = kerOffsets.get(i);
-			kerOffsets.get(i) = supportKeysTotalN;
-			supportKeysTotalN += sz;
-			if (maxSupport < sz) maxSupport = sz;
+		if (opt == support_options::RADIUS)
+		{gatherRadius(N,supportSize,support_radius_const<T>{rCut});}
+		else if (opt == support_options::ADAPTIVE)
+		{
+			auto it = domain.getDomainIteratorGPU(512);
+			auto NN = domain.getCellListGPU(rCut);
+			domain.updateCellListGPU(NN);
+
+			radiusBuf.resize(N);
+			adaptiveRadius_gpu<vector_type::dims,T><<<it.wthr,it.thr>>>(domain.toKernel(), NN.toKernel(), radiusBuf.toKernel(), adaptiveSizeFactor);
+			gatherRadius(N,supportSize,radiusBuf.toKernel());
 		}
-		kerOffsets.get(N) = supportKeysTotalN;
+		else
+		{gatherNearest(N,supportSize);}
+
+		openfpm::scan((size_t *)supportSize.template getDeviceBuffer<0>(), N+1, (size_t *)kerOffsets.template getDeviceBuffer<0>(), v_cl.getGpuContext());
+
+		maxSupportBuf.resize(1);
+		openfpm::reduce((size_t *)supportSize.template getDeviceBuffer<0>(), N, (size_t *)maxSupportBuf.template getDeviceBuffer<0>(), gpu::maximum_t<size_t>(), v_cl.getGpuContext());
+
+		kerOffsets.template deviceToHost<0>(N,N);
+		maxSupportBuf.template deviceToHost<0>();
+		supportKeysTotalN = kerOffsets.get(N);
+		maxSupport = maxSupportBuf.get(0);
 
 		supportKeys1D.resize(supportKeysTotalN);
-		kerOffsets.template hostToDevice();
-		assembleSupport_gpu<vector_type::dims><<<it.wthr,it.thr>>>(domain.toKernel(), NN.toKernel(), kerOffsets.toKernel(), supportKeys1D.toKernel(), rCut);
-		supportKeys1D.template deviceToHost();
+
+		if (opt == support_options::RADIUS || opt == support_options::ADAPTIVE)
+		{
+			auto it = domain.getDomainIteratorGPU(512);
+			auto NN = domain.getCellListGPU(rCut);
+			domain.updateCellListGPU(NN);
+
+			if (opt == support_options::RADIUS)
+			{assembleSupport_gpu<vector_type::dims,T><<<it.wthr,it.thr>>>(domain.toKernel(), NN.toKernel(), kerOffsets.toKernel(), supportKeys1D.toKernel(), support_radius_const<T>{rCut});}
+			else
+			{assembleSupport_gpu<vector_type::dims,T><<<it.wthr,it.thr>>>(domain.toKernel(), NN.toKernel(), kerOffsets.toKernel(), supportKeys1D.toKernel(), radiusBuf.toKernel());}
+		}
+		else
+		{assembleNearest(kerOffsets,supportKeys1D);}
 	}
-};
 
+	void getSupport(
+		size_t N,
+		openfpm::vector_custd<size_t>& kerOffsets,
+		openfpm::vector_custd<size_t>& supportKeys1D,
+		size_t& maxSupport,
+		size_t& supportKeysTotalN)
+	{
+		openfpm::vector_custd<size_t> supportSize;
+		openfpm::vector_custd<size_t> maxSupportBuf;
+
+		domain.hostToDevicePos();
+		getSupportDevice(N, kerOffsets, supportKeys1D, maxSupport, supportKeysTotalN, supportSize, maxSupportBuf);
+
+		kerOffsets.template deviceToHost<0>();
+		supportKeys1D.template deviceToHost<0>();
+	}
+};
 
 #endif //OPENFPM_PDATA_SUPPORTBUILDER_CUH
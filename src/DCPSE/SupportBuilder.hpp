@@ -12,7 +12,9 @@
 #include <Space/Shape/Point.hpp>
 #include <Vector/vector_dist.hpp>
 #include "Support.hpp"
+#include "CellNeighbourSearch.hpp"
 #include <utility>
+#include <list>
 
 enum support_options
 {
@@ -20,20 +22,151 @@ enum support_options
     RADIUS,
     LOAD,
     ADAPTIVE,
-    AT_LEAST_N_PARTICLES
+    AT_LEAST_N_PARTICLES,
+    //! N_PARTICLES, then the supports of the particles with an ill-conditioned moment matrix are enlarged
+    CONDITION_ADAPTIVE
 };
 
 
+/*! \brief Cache of the cell lists used to build the DCPSE supports
+ *
+ * While an object of this class is alive, every SupportBuilder on the same particle set reuses the cell list
+ * built for the same rCut instead of building a new one. All the operators constructed (or updated) in one time step
+ * share the same spatial index. The particles must not move while the cache is alive (or call clear() after they moved).
+ *
+ * \code
+ *
+ * {
+ *   SupportCellListCache<vector_type> cache(particles);
+ *
+ *   Derivative_x Dx(particles,2,rCut);
+ *   Derivative_y Dy(particles,2,rCut);
+ *   Laplacian Lap(particles,2,rCut);
+ * }
+ *
+ * \endcode
+ *
+ * \tparam vector_type particle set
+ *
+ */
+template<typename vector_type>
+class SupportCellListCache
+{
+public:
+
+    typedef decltype(std::declval<vector_type>().getCellList(0.0)) cell_list_type;
+
+private:
+
+    struct entry
+    {
+        typename vector_type::stype rCut;
+        cell_list_type cl;
+    };
+
+    //! particle set
+    vector_type & particles;
+
+    //! cached cell lists (std::list to keep the references valid)
+    std::list<entry> cellLists;
+
+    //! cache active before this one
+    SupportCellListCache<vector_type> * previous;
+
+    static SupportCellListCache<vector_type> *& active()
+    {
+        // per thread, the operators rebuilt in background (Dcpse::initializeGroupAsync) do not see the caches of the main thread
+        static thread_local SupportCellListCache<vector_type> * act = NULL;
+        return act;
+    }
+
+public:
+
+    SupportCellListCache(vector_type & particles)
+    :particles(particles),previous(active())
+    {
+        active() = this;
+    }
+
+    SupportCellListCache(const SupportCellListCache<vector_type> &) = delete;
+    SupportCellListCache<vector_type> & operator=(const SupportCellListCache<vector_type> &) = delete;
+
+    ~SupportCellListCache()
+    {
+        active() = previous;
+    }
+
+    /*! \brief Get the cell list for rCut, it is built only the first time
+     *
+     * \param rCut cut-off radius
+     *
+     */
+    cell_list_type & getCellList(typename vector_type::stype rCut)
+    {
+        for (auto & e : cellLists)
+        {
+            if (e.rCut == rCut)
+            {return e.cl;}
+        }
+
+        cellLists.emplace_back();
+        cellLists.back().rCut = rCut;
+        cellLists.back().cl = particles.getCellList(rCut);
+        return cellLists.back().cl;
+    }
+
+    //! Drop all the cell lists (for example after the particles moved)
+    void clear()
+    {
+        cellLists.clear();
+    }
+
+    //! Number of cell lists in the cache
+    size_t size() const
+    {
+        return cellLists.size();
+    }
+
+    /*! \brief Find the cell list of an active cache on the particle set
+     *
+     * \return the cell list, NULL if there is no active cache on this particle set
+     *
+     */
+    static cell_list_type * find(vector_type & particles, typename vector_type::stype rCut)
+    {
+        for (SupportCellListCache<vector_type> * c = active() ; c != NULL ; c = c->previous)
+        {
+            if (&c->particles == &particles)
+            {return &c->getCellList(rCut);}
+        }
+
+        return NULL;
+    }
+};
+
 template<typename vector_type,typename vector_type2>
 class SupportBuilder {
 private:
+    typedef typename vector_type::stype T;
+
+    typedef typename SupportCellListCache<vector_type>::cell_list_type cell_list_type;
+
     vector_type &domainFrom;
     vector_type2 &domainTo;
-    decltype(std::declval<vector_type>().getCellList(0.0)) cellList;
+
+    //! cell list built by this object, if not given or cached
+    cell_list_type ownCellList;
+    cell_list_type &cellList;
     const Point<vector_type::dims, unsigned int> differentialSignature;
     typename vector_type::stype rCut, MinSpacing, adaptiveSizeFactor=1;
     bool is_interpolation;
 
+    //! Neighbour search on cellList (stencils and candidates reused across the calls)
+    CellNeighbourSearch<vector_type, cell_list_type> search;
+
+    //! Half width in cells of the cube covering rCut, used for RADIUS and ADAPTIVE
+    int radiusCells;
+
 public:
 
     SupportBuilder(vector_type &domainFrom, vector_type2 &domainTo,
@@ -42,9 +175,30 @@ public:
                    bool is_interpolation)
             : domainFrom(domainFrom),
               domainTo(domainTo),
+              cellList(selectCellList(domainFrom, rCut)),
+              differentialSignature(differentialSignature),
+              rCut(rCut), is_interpolation(is_interpolation),
+              search(domainFrom, cellList) {
+        radiusCells = search.getCubeHalfWidth(rCut);
+    }
+
+    /*! \brief Construct the support builder on an existing cell list of domainFrom
+     *
+     * \param cl cell list (any cell size can be used)
+     *
+     */
+    SupportBuilder(vector_type &domainFrom, vector_type2 &domainTo,
+                   const Point<vector_type::dims, unsigned int> differentialSignature,
+                   typename vector_type::stype rCut,
+                   bool is_interpolation,
+                   cell_list_type &cl)
+            : domainFrom(domainFrom),
+              domainTo(domainTo),
+              cellList(cl),
               differentialSignature(differentialSignature),
-              rCut(rCut), is_interpolation(is_interpolation) {
-        cellList = domainFrom.getCellList(rCut);
+              rCut(rCut), is_interpolation(is_interpolation),
+              search(domainFrom, cellList) {
+        radiusCells = search.getCubeHalfWidth(rCut);
     }
 
     SupportBuilder(vector_type &domainFrom, vector_type2 &domainTo,
@@ -55,32 +209,38 @@ public:
 
     template<typename iterator_type>
     Support getSupport(iterator_type itPoint, unsigned int requiredSize, support_options opt) {
-        // Get spatial position from point iterator
-        vect_dist_key_dx p = itPoint.get();
-        vect_dist_key_dx pOrig = itPoint.getOrig();
-        Point<vector_type::dims, typename vector_type::stype> pos = domainTo.getPos(p.getKey());
-
-        // Get cell containing current point and add it to the set of cell keys
-        grid_key_dx<vector_type::dims> curCellKey = cellList.getCellGrid(
-                pos); // Here get the key of the cell where the current point is
-        std::set<grid_key_dx<vector_type::dims>> supportCells;
-        supportCells.insert(curCellKey);
+        return getSupport(itPoint.get(), itPoint.getOrig(), requiredSize, opt);
+    }
 
-        // Make sure to consider a set of cells providing enough points for the support
-        enlargeSetOfCellsUntilSize(supportCells, requiredSize + 1,
-                                   opt); // NOTE: this +1 is because we then remove the point itself
+    /*! \brief Get the support of one particle of domainTo
+     *
+     * \param p key of the particle
+     * \param pOrig origin key of the particle (p for a vector_dist)
+     * \param requiredSize minimum number of particles in the support
+     * \param opt support options
+     *
+     */
+    Support getSupport(vect_dist_key_dx p, vect_dist_key_dx pOrig, unsigned int requiredSize, support_options opt) {
+        // Get spatial position of the point
+        Point<vector_type::dims, typename vector_type::stype> pos = domainTo.getPos(p.getKey());
 
-        // Now return all the points from the support into a vector
+        size_t exclude = (is_interpolation == false)?pOrig.getKey():search.no_exclude;
 
-        std::vector<size_t> supportKeys = getPointsInSetOfCells(supportCells, p, pOrig, requiredSize, opt);
+        search.clear();
 
-        if (is_interpolation == false) {
-            auto p_o = domainFrom.getOriginKey(p.getKey());
-            std::remove(supportKeys.begin(), supportKeys.end(), p_o.getKey());
+        if (opt == support_options::RADIUS || opt == support_options::ADAPTIVE) {
+            search.addCube(pos, radiusCells, exclude);
+        } else {
+            // Add rings of cells until they contain enough points. NOTE: this +1 is because we then remove the point itself
+            // Why 5*requiredSize? Becasue it can help with adaptive resolutions.
+            search.addRings(pos, 5.0 * (requiredSize + 1), exclude);
         }
 
+        openfpm::vector_std<size_t> supportKeys;
+        selectSupport(supportKeys, requiredSize, opt);
+
         auto p_o = domainTo.getOriginKey(p.getKey());
-        return Support(p_o.getKey(), openfpm::vector_std<size_t>(supportKeys.begin(), supportKeys.end()));
+        return Support(p_o.getKey(), std::move(supportKeys));
     }
 
     typename vector_type::stype getLastMinspacing() {
@@ -93,147 +253,39 @@ public:
 
 private:
 
-    size_t getCellLinId(const grid_key_dx<vector_type::dims> &cellKey) {
-        mem_id id = cellList.getGrid().LinId(cellKey);
-        return static_cast<size_t>(id);
-    }
-
-    size_t getNumElementsInCell(const grid_key_dx<vector_type::dims> &cellKey) {
-        const size_t curCellId = getCellLinId(cellKey);
-        size_t numElements = cellList.getNelements(curCellId);
-        return numElements;
-    }
-
-    size_t getNumElementsInSetOfCells(const std::set<grid_key_dx<vector_type::dims>> &set) {
-        size_t tot = 0;
-        for (const auto cell: set) {
-            tot += getNumElementsInCell(cell);
+    //! Take the cell list from an active SupportCellListCache, or build one
+    cell_list_type & selectCellList(vector_type &domainFrom, T rCut) {
+        cell_list_type * cached = SupportCellListCache<vector_type>::find(domainFrom, rCut);
+        if (cached != NULL) {
+            return *cached;
         }
-        return tot;
-    }
 
-    void enlargeSetOfCellsUntilSize(std::set<grid_key_dx<vector_type::dims>> &set, unsigned int requiredSize,
-                                    support_options opt) {
-        if (opt == support_options::RADIUS || opt == support_options::ADAPTIVE) {
-            auto cell = *set.begin();
-            grid_key_dx<vector_type::dims> middle;
-            int n = std::ceil(rCut / cellList.getCellBox().getHigh(0));
-            size_t sz[vector_type::dims];
-            for (int i = 0; i < vector_type::dims; i++) {
-                sz[i] = 2 * n + 1;
-                middle.set_d(i, n);
-            }
-            grid_sm<vector_type::dims, void> g(sz);
-            grid_key_dx_iterator<vector_type::dims> g_k(g);
-            while (g_k.isNext()) {
-                auto key = g_k.get();
-                key = cell + key - middle;
-                if (isCellKeyInBounds(key)) {
-                    set.insert(key);
-                }
-                ++g_k;
-            }
-        } else {
-            while (getNumElementsInSetOfCells(set) <
-                   5.0 * requiredSize) //Why 5*requiredSize? Becasue it can help with adaptive resolutions.
-            {
-                auto tmpSet = set;
-                for (const auto el: tmpSet) {
-                    for (unsigned int i = 0; i < vector_type::dims; ++i) {
-                        const auto pOneEl = el.move(i, +1);
-                        const auto mOneEl = el.move(i, -1);
-                        if (isCellKeyInBounds(pOneEl)) {
-                            set.insert(pOneEl);
-                        }
-                        if (isCellKeyInBounds(mOneEl)) {
-                            set.insert(mOneEl);
-                        }
-                    }
-                }
-
-            }
-        }
+        ownCellList = domainFrom.getCellList(rCut);
+        return ownCellList;
     }
 
-    std::vector<size_t> getPointsInSetOfCells(std::set<grid_key_dx<vector_type::dims>> set,
-                                              vect_dist_key_dx &p,
-                                              vect_dist_key_dx &pOrig,
-                                              size_t requiredSupportSize,
-                                              support_options opt) {
-        struct reord {
-            typename vector_type::stype dist;
-            size_t offset;
-
-            bool operator<(const reord &p) const { return this->dist < p.dist; }
-        };
-
-        openfpm::vector<reord> rp;
-        std::vector<size_t> points;
-        Point<vector_type::dims, typename vector_type::stype> xp = domainTo.getPos(p);
-        for (const auto cellKey: set) {
-            const size_t cellLinId = getCellLinId(cellKey);
-            const size_t elemsInCell = getNumElementsInCell(cellKey);
-            for (size_t k = 0; k < elemsInCell; ++k) {
-                size_t el = cellList.get(cellLinId, k);
-
-                if (pOrig.getKey() == el && is_interpolation == false) { continue; }
-
-                Point<vector_type::dims, typename vector_type::stype> xq = domainFrom.getPosOrig(el);
-                //points.push_back(el);
-
-                reord pr;
-
-                pr.dist = xp.distance(xq);
-                pr.offset = el;
-                rp.add(pr);
-            }
-        }
-
+    //! Select the support from the candidates
+    void selectSupport(openfpm::vector_std<size_t> &points, size_t requiredSupportSize, support_options opt) {
         if (opt == support_options::RADIUS) {
-            for (int i = 0; i < rp.size(); i++) {
-                if (rp.get(i).dist < rCut) {
-                    points.push_back(rp.get(i).offset);
-                }
-            }
+            search.selectRadius(points, rCut);
         }
         else if(opt == support_options::ADAPTIVE) {
+            auto & candidates = search.getCandidates();
             MinSpacing = std::numeric_limits<double>::max();
-            for (int i = 0; i < rp.size(); i++) {
-                if (MinSpacing > rp.get(i).dist && rp.get(i).dist != 0) {
-                    MinSpacing = rp.get(i).dist;
+            for (size_t i = 0; i < candidates.size(); i++) {
+                if (MinSpacing > candidates.get(i).dist && candidates.get(i).dist != 0) {
+                    MinSpacing = candidates.get(i).dist;
                 }
             }
 #ifdef SE_CLASS1
         assert(MinSpacing !=0 && "You have multiple particles on the same position.");
 #endif
-            for (int i = 0; i < rp.size(); i++) {
-                if (rp.get(i).dist < adaptiveSizeFactor * MinSpacing) {
-                    points.push_back(rp.get(i).offset);
-                }
-            }
+            search.selectRadius(points, adaptiveSizeFactor * MinSpacing);
         }
         else {
-            rp.sort();
-            for (int i = 0; i < requiredSupportSize; i++) {
-                    points.push_back(rp.get(i).offset);
-                }
-            }
-
-        //MinSpacing=MinSpacing/requiredSupportSize
-        return points;
-    }
-
-    bool isCellKeyInBounds(grid_key_dx<vector_type::dims> key)
-    {
-        const size_t *cellGridSize = cellList.getGrid().getSize();
-        for (size_t i = 0; i < vector_type::dims; ++i)
-        {
-            if (key.value(i) < 0 || key.value(i) >= cellGridSize[i])
-            {
-                return false;
-            }
+            // Only the requiredSupportSize nearest are needed, sorted by distance
+            search.selectNearest(points, requiredSupportSize);
         }
-        return true;
     }
 };
 
@@ -7,6 +7,7 @@
 
 #include "MonomialBasis.hpp"
 #include "VandermondeRowBuilder.hpp"
+#include "MonomialBasisEvaluator.hpp"
 #include "Support.hpp"
 
 template<unsigned int dim, typename T, typename MatrixType>
@@ -14,8 +15,9 @@ class Vandermonde
 {
 private:
     const Point<dim, T> point;
-    openfpm::vector_std<Point<dim, T>> offsets;
-    const MonomialBasis<dim> monomialBasis;
+    openfpm::vector_std<Point<dim, T>> ownOffsets;
+    openfpm::vector_std<Point<dim, T>> & offsets;
+    const MonomialBasis<dim> & monomialBasis;
     T eps,HOverEpsilon,minSpacing;
 
 public:
@@ -23,34 +25,67 @@ public:
                 const MonomialBasis<dim> &monomialBasis);*/
 
     template<typename vector_type,
-             typename vector_type2>
-    Vandermonde(const Support &support,
+             typename vector_type2,
+             typename support_type>
+    Vandermonde(const support_type &support,
                 const MonomialBasis<dim> &monomialBasis,
                 const vector_type & particlesFrom,
                 const vector_type2 & particlesTo,T HOverEpsilon=0.5)    //0.5 for the test
     : point(particlesTo.getPosOrig(support.getReferencePointKey())),
-                  monomialBasis(monomialBasis),HOverEpsilon(HOverEpsilon)
+                  offsets(ownOffsets),monomialBasis(monomialBasis),HOverEpsilon(HOverEpsilon)
     {
         initialize(support,particlesFrom,particlesTo);
     }
 
+    /*! \brief Construct the Vandermonde of a support storing the offsets in an external buffer
+     *
+     * The buffer is cleared and refilled, reusing it across the particles avoids an allocation per particle
+     *
+     * \param offsetsBuffer buffer for the offsets, it must live as long as this object
+     *
+     */
+    template<typename vector_type,
+             typename vector_type2,
+             typename support_type>
+    Vandermonde(const support_type &support,
+                const MonomialBasis<dim> &monomialBasis,
+                const vector_type & particlesFrom,
+                const vector_type2 & particlesTo,
+                openfpm::vector_std<Point<dim, T>> & offsetsBuffer,
+                T HOverEpsilon=0.5)
+    : point(particlesTo.getPosOrig(support.getReferencePointKey())),
+                  offsets(offsetsBuffer),monomialBasis(monomialBasis),HOverEpsilon(HOverEpsilon)
+    {
+        offsets.clear();
+        initialize(support,particlesFrom,particlesTo);
+    }
+
 
     MatrixType &getMatrix(MatrixType &M)
     {
-        // Build the Vandermonde matrix, row-by-row
-        VandermondeRowBuilder<dim, T> vrb(monomialBasis);
-        unsigned int row = 0;
+        MonomialBasisEvaluator<dim, T> evaluator(monomialBasis);
+        return getMatrix(M, evaluator);
+    }
 
-        size_t N = offsets.size();
-        for (size_t i = 0; i < N; ++i)
-        {
-            const auto& offset = offsets.get(i);
-            vrb.buildRow(M, row, offset, eps);
-            ++row;
-        }
+    /*! \brief Build the Vandermonde matrix with an evaluator of the monomial basis
+     *
+     * \param M output matrix (at least one row for every offset)
+     * \param evaluator evaluator constructed on the same monomial basis (MonomialBasisEvaluator or StaticMonomialBasisEvaluator)
+     *
+     */
+    template<typename evaluator_type>
+    MatrixType &getMatrix(MatrixType &M, const evaluator_type &evaluator)
+    {
+        evaluator.buildRows(M, offsets, eps);
         return M;
     }
 
+    //! Offsets of the support points from the reference point
+    const openfpm::vector_std<Point<dim, T>> &getOffsets() const
+    {
+        return offsets;
+    }
+
     T getEps()
     {
         return eps;
@@ -93,8 +128,8 @@ private:
         return absSum;
     }
 
-    template<typename vector_type, typename vector_type2>
-    void initialize(const Support &sup, const vector_type & particlesFrom, vector_type2 &particlesTo)
+    template<typename vector_type, typename vector_type2, typename support_type>
+    void initialize(const support_type &sup, const vector_type & particlesFrom, vector_type2 &particlesTo)
     {
     	auto & keys = sup.getKeys();
 
@@ -8,6 +8,7 @@
 #include <boost/test/tools/floating_point_comparison.hpp>
 #include <Vector/vector_dist.hpp>
 #include <DCPSE/Dcpse.hpp>
+#include <DCPSE/DcpseGhost.hpp>
 
 template<typename T>
 void check_small_or_close(T value, T expected, T tolerance)
@@ -425,6 +426,1028 @@ BOOST_AUTO_TEST_SUITE(Dcpse_tests)
         BOOST_REQUIRE(check);
     }
 
+    // The heap allocations of the application are counted by the benchmarks (allocs_per_rep of dcpse.apply_dx)
+    BOOST_AUTO_TEST_CASE(Dcpse_2D_apply_support_view_test)
+    {
+        int rank;
+        MPI_Comm_rank(MPI_COMM_WORLD, &rank);
+
+        size_t edgeSemiSize = 20;
+        const size_t sz[2] = {2 * edgeSemiSize, 2 * edgeSemiSize};
+        Box<2, double> box({0, 0}, {2 * M_PI, 2 * M_PI});
+        size_t bc[2] = {NON_PERIODIC, NON_PERIODIC};
+        double spacing[2];
+        spacing[0] = 1.0 / (sz[0] - 1);
+        spacing[1] = 1.0 / (sz[1] - 1);
+        Ghost<2, double> ghost(0.1);
+
+        double rCut = 2 * spacing[0];
+
+        vector_dist<2, double, aggregate<double, double, double>> domain(0, box, bc, ghost);
+
+        if (rank == 0)
+        {
+            auto it = domain.getGridIterator(sz);
+            while (it.isNext())
+            {
+                domain.add();
+                auto key = it.get();
+                double x = key.get(0) * spacing[0];
+                domain.getLastPos()[0] = x;
+                double y = key.get(1) * spacing[1];
+                domain.getLastPos()[1] = y;
+                domain.template getLastProp<0>() = sin(x);
+                domain.template getLastProp<2>() = cos(x);
+
+                ++it;
+            }
+        }
+        domain.map();
+        domain.ghost_get();
+
+        Dcpse<2, vector_dist<2, double, aggregate<double, double, double>> > dcpse(domain, Point<2, unsigned int>({1, 0}), 2, rCut,2,support_options::N_PARTICLES);
+
+        dcpse.template computeDifferentialOperator<0, 1>(domain);
+
+        // Access the support of every particle through the views
+        size_t nn = 0;
+        auto & sup = dcpse.getLocalSupports();
+        auto itP = domain.getDomainIterator();
+        while (itP.isNext())
+        {
+            auto p = itP.get();
+            if (sup.is32bitKeys())
+            {nn += sup.template getSupport<unsigned int>(p.getKey()).size();}
+            else
+            {nn += sup.template getSupport<size_t>(p.getKey()).size();}
+            ++itP;
+        }
+
+        BOOST_REQUIRE_EQUAL(nn,sup.getNKeys());
+    }
+
+    BOOST_AUTO_TEST_CASE(Dcpse_2D_incremental_update_test)
+    {
+        int rank;
+        MPI_Comm_rank(MPI_COMM_WORLD, &rank);
+
+        size_t edgeSemiSize = 20;
+        const size_t sz[2] = {2 * edgeSemiSize, 2 * edgeSemiSize};
+        Box<2, double> box({0, 0}, {2 * M_PI, 2 * M_PI});
+        size_t bc[2] = {NON_PERIODIC, NON_PERIODIC};
+        double spacing[2];
+        spacing[0] = 1.0 / (sz[0] - 1);
+        spacing[1] = 1.0 / (sz[1] - 1);
+        Ghost<2, double> ghost(0.1);
+
+        double rCut = 2.5 * spacing[0];
+
+        vector_dist<2, double, aggregate<double, double, double>> domain(0, box, bc, ghost);
+
+        if (rank == 0)
+        {
+            auto it = domain.getGridIterator(sz);
+            while (it.isNext())
+            {
+                domain.add();
+                auto key = it.get();
+                double x = key.get(0) * spacing[0];
+                domain.getLastPos()[0] = x;
+                double y = key.get(1) * spacing[1];
+                domain.getLastPos()[1] = y;
+                domain.template getLastProp<0>() = sin(x) + cos(y);
+
+                ++it;
+            }
+        }
+        domain.map();
+        domain.ghost_get<0>();
+
+        Dcpse<2, vector_dist<2, double, aggregate<double, double, double>> > dcpse(domain, Point<2, unsigned int>({1, 0}), 2, rCut);
+
+        // Move few particles without changing their order
+        auto itM = domain.getDomainIterator();
+        while (itM.isNext())
+        {
+            auto p = itM.get();
+            if (p.getKey() % 50 == 0)
+            {domain.getPos(p)[0] += 0.01 * spacing[0];}
+            ++itM;
+        }
+        domain.ghost_get<0>();
+
+        size_t nRecomputed = dcpse.initializeUpdateIncremental(domain, 0.001 * spacing[0]);
+
+        if (domain.size_local() != 0)
+        {
+            BOOST_REQUIRE(nRecomputed > 0);
+            BOOST_REQUIRE(nRecomputed < domain.size_local());
+        }
+
+        // Nothing moved, nothing to recompute
+        BOOST_REQUIRE_EQUAL(dcpse.initializeUpdateIncremental(domain, 0.001 * spacing[0]),0);
+
+        Dcpse<2, vector_dist<2, double, aggregate<double, double, double>> > dcpseFull(domain, Point<2, unsigned int>({1, 0}), 2, rCut);
+
+        dcpse.template computeDifferentialOperator<0, 1>(domain);
+        dcpseFull.template computeDifferentialOperator<0, 2>(domain);
+
+        auto itC = domain.getDomainIterator();
+        while (itC.isNext())
+        {
+            auto p = itC.get();
+            BOOST_REQUIRE_CLOSE(domain.template getProp<1>(p) + 1.0, domain.template getProp<2>(p) + 1.0, 1e-8);
+            ++itC;
+        }
+    }
+
+    BOOST_AUTO_TEST_CASE(Dcpse_2D_prune_test)
+    {
+        int rank;
+        MPI_Comm_rank(MPI_COMM_WORLD, &rank);
+
+        const size_t sz[2] = {40, 40};
+        Box<2, double> box({0, 0}, {1, 1});
+        size_t bc[2] = {NON_PERIODIC, NON_PERIODIC};
+        double spacing = 1.0 / (sz[0] - 1);
+        Ghost<2, double> ghost(0.1);
+
+        double rCut = 3.1 * spacing;
+
+        typedef vector_dist<2, double, aggregate<double, double, double>> vector_type;
+        vector_type domain(0, box, bc, ghost);
+
+        if (rank == 0)
+        {
+            auto it = domain.getGridIterator(sz);
+            while (it.isNext())
+            {
+                domain.add();
+                auto key = it.get();
+                double x = key.get(0) * spacing;
+                domain.getLastPos()[0] = x;
+                double y = key.get(1) * spacing;
+                domain.getLastPos()[1] = y;
+                domain.template getLastProp<0>() = 1.0 + 2.0*x + 3.0*y + x*y;
+
+                ++it;
+            }
+        }
+        domain.map();
+        domain.ghost_get<0>();
+
+        Dcpse<2, vector_type> dcpse(domain, Point<2, unsigned int>({1, 0}), 2, rCut);
+
+        size_t nnz = dcpse.getLocalSupports().getNKeys();
+        auto & v_cl = create_vcluster();
+        v_cl.sum(nnz);
+        v_cl.execute();
+
+        size_t removed = dcpse.pruneKernels(domain, 1e-2);
+
+        size_t nnzPruned = dcpse.getLocalSupports().getNKeys();
+        v_cl.sum(nnzPruned);
+        v_cl.execute();
+
+        BOOST_REQUIRE(removed > 0);
+        BOOST_REQUIRE_EQUAL(nnz - removed, nnzPruned);
+        BOOST_REQUIRE_EQUAL(dcpse.getKernels().size(), dcpse.getLocalSupports().getNKeys());
+
+        // the moment conditions hold on the reduced supports, the derivative of a second order polynomial is exact
+        dcpse.template computeDifferentialOperator<0, 1>(domain);
+
+        auto itC = domain.getDomainIterator();
+        while (itC.isNext())
+        {
+            auto p = itC.get();
+            double y = domain.getPos(p)[1];
+            BOOST_REQUIRE_CLOSE(domain.template getProp<1>(p), 2.0 + y, 1e-6);
+            BOOST_REQUIRE(dcpse.getLocalSupports().getRowSize(p.getKey()) >= 9);
+            ++itC;
+        }
+    }
+
+    BOOST_AUTO_TEST_CASE(Dcpse_2D_reorder_test)
+    {
+        int rank;
+        MPI_Comm_rank(MPI_COMM_WORLD, &rank);
+
+        const size_t sz[2] = {40, 40};
+        Box<2, double> box({0, 0}, {1, 1});
+        size_t bc[2] = {NON_PERIODIC, NON_PERIODIC};
+        double spacing = 1.0 / (sz[0] - 1);
+        Ghost<2, double> ghost(0.1);
+
+        double rCut = 2.5 * spacing;
+
+        typedef vector_dist<2, double, aggregate<double, double, double>> vector_type;
+        vector_type domain(0, box, bc, ghost);
+
+        if (rank == 0)
+        {
+            // Add the particles in reverse order of the grid
+            auto it = domain.getGridIterator(sz);
+            size_t n = 0;
+            while (it.isNext())
+            {
+                n++;
+                ++it;
+            }
+            for (size_t i = 0; i < n; i++)
+            {
+                size_t k = n - 1 - i;
+                domain.add();
+                double x = (k % sz[0]) * spacing;
+                double y = (k / sz[0]) * spacing;
+                domain.getLastPos()[0] = x;
+                domain.getLastPos()[1] = y;
+                domain.template getLastProp<0>() = sin(x) + cos(y);
+            }
+        }
+        domain.map();
+        domain.ghost_get<0>();
+
+        Dcpse<2, vector_type> dcpse(domain, Point<2, unsigned int>({1, 0}), 2, rCut);
+        dcpse.template computeDifferentialOperator<0, 1>(domain);
+
+        reorderParticlesForDcpse(domain);
+        domain.ghost_get<0>();
+
+        Dcpse<2, vector_type> dcpseR(domain, Point<2, unsigned int>({1, 0}), 2, rCut);
+        dcpseR.template computeDifferentialOperator<0, 2>(domain);
+
+        auto itC = domain.getDomainIterator();
+        while (itC.isNext())
+        {
+            auto p = itC.get();
+
+            for (int j = 1; j < dcpseR.getNumNN(p); j++)
+            {BOOST_REQUIRE(dcpseR.getIndexNN(p, j - 1) < dcpseR.getIndexNN(p, j));}
+
+            BOOST_REQUIRE_CLOSE(domain.template getProp<1>(p) + 1.0, domain.template getProp<2>(p) + 1.0, 1e-8);
+            ++itC;
+        }
+    }
+
+    BOOST_AUTO_TEST_CASE(Dcpse_2D_condition_adaptive_test)
+    {
+        int rank;
+        MPI_Comm_rank(MPI_COMM_WORLD, &rank);
+
+        size_t edgeSemiSize = 20;
+        const size_t sz[2] = {2 * edgeSemiSize, 2 * edgeSemiSize};
+        Box<2, double> box({0, 0}, {2 * M_PI, 2 * M_PI});
+        size_t bc[2] = {NON_PERIODIC, NON_PERIODIC};
+        double spacing[2];
+        spacing[0] = 1.0 / (sz[0] - 1);
+        spacing[1] = 1.0 / (sz[1] - 1);
+        Ghost<2, double> ghost(0.1);
+
+        double rCut = 2 * spacing[0];
+
+        typedef vector_dist<2, double, aggregate<double, double, double>> vector_type;
+        vector_type domain(0, box, bc, ghost);
+
+        if (rank == 0)
+        {
+            auto it = domain.getGridIterator(sz);
+            while (it.isNext())
+            {
+                domain.add();
+                auto key = it.get();
+                double x = key.get(0) * spacing[0];
+                double y = key.get(1) * spacing[1];
+                domain.getLastPos()[0] = x;
+                domain.getLastPos()[1] = y;
+                domain.template getLastProp<0>() = sin(x);
+                domain.template getLastProp<2>() = cos(x);
+                ++it;
+            }
+        }
+        domain.map();
+        domain.ghost_get();
+
+        // Start from a support only slightly bigger than the basis, the ill-conditioned ones are enlarged
+        Dcpse<2, vector_type> dcpse(domain, Point<2, unsigned int>({1, 0}), 2, rCut, 1.2, support_options::CONDITION_ADAPTIVE);
+        dcpse.template computeDifferentialOperator<0, 1>(domain);
+
+        const double avgSpacing = spacing[0] + spacing[1];
+        const double TOL = 2 * avgSpacing * avgSpacing;
+        size_t minSize = std::numeric_limits<size_t>::max(), maxSize = 0;
+        auto itVal = domain.getDomainIterator();
+        while (itVal.isNext())
+        {
+            auto key = itVal.get();
+            minSize = std::min(minSize, (size_t)dcpse.getNumNN(key));
+            maxSize = std::max(maxSize, (size_t)dcpse.getNumNN(key));
+
+            BOOST_REQUIRE(fabs(domain.template getProp<1>(key) - domain.template getProp<2>(key)) < TOL);
+            ++itVal;
+        }
+
+        // the supports are never shrunk and never grow more than maxSupportGrowth times
+        if (maxSize != 0)
+        {BOOST_REQUIRE(maxSize <= std::ceil(minSize * std::pow(dcpse.supportGrowthFactor, dcpse.maxSupportGrowth)) + dcpse.maxSupportGrowth);}
+    }
+
+    BOOST_AUTO_TEST_CASE(Dcpse_2D_kernel_cache_test)
+    {
+        int rank;
+        MPI_Comm_rank(MPI_COMM_WORLD, &rank);
+
+        size_t edgeSemiSize = 20;
+        const size_t sz[2] = {2 * edgeSemiSize, 2 * edgeSemiSize};
+        Box<2, double> box({0, 0}, {2 * M_PI, 2 * M_PI});
+        size_t bc[2] = {NON_PERIODIC, NON_PERIODIC};
+        double spacing[2];
+        spacing[0] = 1.0 / (sz[0] - 1);
+        spacing[1] = 1.0 / (sz[1] - 1);
+        Ghost<2, double> ghost(0.1);
+
+        double rCut = 2.5 * spacing[0];
+
+        typedef vector_dist<2, double, aggregate<double, double, double>> vector_type;
+        vector_type domain(0, box, bc, ghost);
+
+        if (rank == 0)
+        {
+            auto it = domain.getGridIterator(sz);
+            while (it.isNext())
+            {
+                domain.add();
+                auto key = it.get();
+                double x = key.get(0) * spacing[0];
+                domain.getLastPos()[0] = x;
+                double y = key.get(1) * spacing[1];
+                domain.getLastPos()[1] = y;
+                domain.template getLastProp<0>() = sin(x) * cos(y);
+
+                ++it;
+            }
+        }
+        domain.map();
+        domain.ghost_get<0>();
+
+        Dcpse<2, vector_type> dcpse(domain, Point<2, unsigned int>({0, 1}), 2, rCut);
+        dcpse.template computeDifferentialOperator<0, 1>(domain);
+        dcpse.saveKernelCache("dcpse_kernel_cache");
+
+        // an empty operator filled from the cache
+        Dcpse<2, vector_type> dcpseLoad(domain, Point<2, unsigned int>({0, 1}), 2, rCut, 1, support_options::LOAD);
+        BOOST_REQUIRE_EQUAL(dcpseLoad.loadKernelCache("dcpse_kernel_cache"), true);
+        dcpseLoad.template computeDifferentialOperator<0, 2>(domain);
+
+        auto itC = domain.getDomainIterator();
+        while (itC.isNext())
+        {
+            auto p = itC.get();
+            BOOST_REQUIRE_EQUAL(domain.template getProp<1>(p), domain.template getProp<2>(p));
+            ++itC;
+        }
+
+        // another operator does not match
+        Dcpse<2, vector_type> dcpseOther(domain, Point<2, unsigned int>({1, 0}), 2, rCut, 1, support_options::LOAD);
+        BOOST_REQUIRE_EQUAL(dcpseOther.loadKernelCache("dcpse_kernel_cache"), false);
+
+        // save and load with the format tag
+        dcpse.save("dcpse_save");
+        Dcpse<2, vector_type> dcpseSaved(domain, Point<2, unsigned int>({0, 1}), 2, rCut, 1, support_options::LOAD);
+        dcpseSaved.load("dcpse_save");
+        BOOST_REQUIRE_EQUAL(dcpseSaved.getKernels().size(), dcpse.getLocalSupports().getNKeys());
+        dcpseSaved.template computeDifferentialOperator<0, 2>(domain);
+
+        auto itS = domain.getDomainIterator();
+        while (itS.isNext())
+        {
+            auto p = itS.get();
+            BOOST_REQUIRE_EQUAL(domain.template getProp<1>(p), domain.template getProp<2>(p));
+            ++itS;
+        }
+
+        // a file without the tag (previous format) is rejected and the operator left empty
+        {
+            std::ofstream old("dcpse_save_old_" + std::to_string(rank), std::ios::out | std::ios::binary);
+            size_t nSupports = domain.size_local();
+            old.write((const char *)&nSupports, sizeof(nSupports));
+            old.write((const char *)&nSupports, sizeof(nSupports));
+        }
+        Dcpse<2, vector_type> dcpseOld(domain, Point<2, unsigned int>({0, 1}), 2, rCut, 1, support_options::LOAD);
+        dcpseOld.load("dcpse_save_old");
+        BOOST_REQUIRE_EQUAL(dcpseOld.getKernels().size(), 0);
+
+        // the geometry changed
+        if (domain.size_local() != 0)
+        {
+            auto p = domain.getDomainIterator().get();
+            domain.getPos(p)[0] += 0.1 * spacing[0];
+        }
+        BOOST_REQUIRE_EQUAL(dcpseLoad.loadKernelCache("dcpse_kernel_cache"), false);
+    }
+
+    BOOST_AUTO_TEST_CASE(Dcpse_2D_lattice_test)
+    {
+        int rank;
+        MPI_Comm_rank(MPI_COMM_WORLD, &rank);
+
+        size_t edgeSemiSize = 20;
+        const size_t sz[2] = {2 * edgeSemiSize, 2 * edgeSemiSize};
+        Box<2, double> box({0, 0}, {2 * M_PI, 2 * M_PI});
+        size_t bc[2] = {NON_PERIODIC, NON_PERIODIC};
+        double spacing[2];
+        spacing[0] = 1.0 / (sz[0] - 1);
+        spacing[1] = 1.0 / (sz[1] - 1);
+        Ghost<2, double> ghost(0.1);
+
+        double rCut = 2.5 * spacing[0];
+
+        typedef vector_dist<2, double, aggregate<double, double, double>> vector_type;
+        vector_type domain(0, box, bc, ghost);
+
+        if (rank == 0)
+        {
+            auto it = domain.getGridIterator(sz);
+            while (it.isNext())
+            {
+                domain.add();
+                auto key = it.get();
+                double x = key.get(0) * spacing[0];
+                domain.getLastPos()[0] = x;
+                double y = key.get(1) * spacing[1];
+                domain.getLastPos()[1] = y;
+                domain.template getLastProp<0>() = sin(x) * cos(y);
+
+                ++it;
+            }
+        }
+        domain.map();
+        domain.ghost_get<0>();
+
+        // the bulk of the lattice shares a handful of kernels
+        Dcpse<2, vector_type> dcpse(domain, Point<2, unsigned int>({1, 1}), 2, rCut, 1, support_options::RADIUS, 1e-6);
+        Dcpse<2, vector_type> dcpseFull(domain, Point<2, unsigned int>({1, 1}), 2, rCut);
+        BOOST_REQUIRE(dcpse.getKernels().size() <= dcpseFull.getKernels().size());
+        if (domain.size_local() > 100)
+        {BOOST_REQUIRE(dcpse.getKernels().size() < dcpseFull.getKernels().size() / 4);}
+
+        dcpse.template computeDifferentialOperator<0, 1>(domain);
+        dcpseFull.template computeDifferentialOperator<0, 2>(domain);
+
+        auto itC = domain.getDomainIterator();
+        while (itC.isNext())
+        {
+            auto p = itC.get();
+            BOOST_REQUIRE_CLOSE(domain.template getProp<1>(p) + 1.0, domain.template getProp<2>(p) + 1.0, 1e-6);
+            ++itC;
+        }
+    }
+
+    BOOST_AUTO_TEST_CASE(Dcpse_2D_numa_policy_test)
+    {
+        int rank;
+        MPI_Comm_rank(MPI_COMM_WORLD, &rank);
+
+        size_t edgeSemiSize = 20;
+        const size_t sz[2] = {2 * edgeSemiSize, 2 * edgeSemiSize};
+        Box<2, double> box({0, 0}, {2 * M_PI, 2 * M_PI});
+        size_t bc[2] = {NON_PERIODIC, NON_PERIODIC};
+        double spacing[2];
+        spacing[0] = 1.0 / (sz[0] - 1);
+        spacing[1] = 1.0 / (sz[1] - 1);
+        Ghost<2, double> ghost(0.1);
+
+        double rCut = 2.5 * spacing[0];
+
+        typedef vector_dist<2, double, aggregate<double, double, double>> vector_type;
+        vector_type domain(0, box, bc, ghost);
+
+        if (rank == 0)
+        {
+            auto it = domain.getGridIterator(sz);
+            while (it.isNext())
+            {
+                domain.add();
+                auto key = it.get();
+                double x = key.get(0) * spacing[0];
+                domain.getLastPos()[0] = x;
+                double y = key.get(1) * spacing[1];
+                domain.getLastPos()[1] = y;
+                domain.template getLastProp<0>() = sin(x) * cos(y);
+
+                ++it;
+            }
+        }
+        domain.map();
+        domain.ghost_get<0>();
+
+        Dcpse<2, vector_type> dcpse(domain, Point<2, unsigned int>({1, 1}), 2, rCut);
+        dcpse.template computeDifferentialOperator<0, 1>(domain);
+
+        // the placed arrays hold the same operator
+        dcpse.numaPolicy.first_touch = true;
+        dcpse.numaPolicy.pages = numa_huge_pages::TRANSPARENT;
+        dcpse.numaPolicy.chunk = 16;
+        dcpse.initializeUpdate(domain);
+        dcpse.template computeDifferentialOperator<0, 2>(domain);
+
+        auto itC = domain.getDomainIterator();
+        while (itC.isNext())
+        {
+            auto p = itC.get();
+            BOOST_REQUIRE_EQUAL(domain.template getProp<1>(p), domain.template getProp<2>(p));
+            ++itC;
+        }
+    }
+
+    BOOST_AUTO_TEST_CASE(Dcpse_2D_async_update_test)
+    {
+        int rank;
+        MPI_Comm_rank(MPI_COMM_WORLD, &rank);
+
+        size_t edgeSemiSize = 20;
+        const size_t sz[2] = {2 * edgeSemiSize, 2 * edgeSemiSize};
+        Box<2, double> box({0, 0}, {2 * M_PI, 2 * M_PI});
+        size_t bc[2] = {NON_PERIODIC, NON_PERIODIC};
+        double spacing[2];
+        spacing[0] = 1.0 / (sz[0] - 1);
+        spacing[1] = 1.0 / (sz[1] - 1);
+        Ghost<2, double> ghost(0.1);
+
+        double rCut = 2.5 * spacing[0];
+
+        typedef vector_dist<2, double, aggregate<double, double, double>> vector_type;
+        vector_type domain(0, box, bc, ghost);
+
+        if (rank == 0)
+        {
+            auto it = domain.getGridIterator(sz);
+            while (it.isNext())
+            {
+                domain.add();
+                auto key = it.get();
+                double x = key.get(0) * spacing[0];
+                domain.getLastPos()[0] = x;
+                double y = key.get(1) * spacing[1];
+                domain.getLastPos()[1] = y;
+
+                ++it;
+            }
+        }
+        domain.map();
+
+        Dcpse<2, vector_type> dcpse(domain, Point<2, unsigned int>({1, 0}), 2, rCut);
+
+        // small displacement, no map
+        auto itP = domain.getDomainIterator();
+        while (itP.isNext())
+        {
+            auto p = itP.get();
+            domain.getPos(p)[0] += 0.01 * spacing[0] * sin(domain.getPos(p)[1]);
+            double x = domain.getPos(p)[0];
+            double y = domain.getPos(p)[1];
+            domain.template getProp<0>(p) = sin(x) * cos(y);
+            ++itP;
+        }
+        domain.ghost_get<0>();
+
+        dcpse.initializeUpdateAsync(domain);
+        BOOST_REQUIRE(dcpse.isUpdateAsyncPending());
+
+        // the old kernels are still in use
+        dcpse.template computeDifferentialOperator<0, 1>(domain);
+
+        BOOST_REQUIRE(dcpse.finalizeUpdateAsync(true));
+        BOOST_REQUIRE(dcpse.isUpdateAsyncPending() == false);
+        dcpse.template computeDifferentialOperator<0, 1>(domain);
+
+        Dcpse<2, vector_type> dcpseSync(domain, Point<2, unsigned int>({1, 0}), 2, rCut);
+        dcpseSync.template computeDifferentialOperator<0, 2>(domain);
+
+        auto itC = domain.getDomainIterator();
+        while (itC.isNext())
+        {
+            auto p = itC.get();
+            BOOST_REQUIRE_EQUAL(domain.template getProp<1>(p), domain.template getProp<2>(p));
+            ++itC;
+        }
+
+        // CONDITION_ADAPTIVE grows the supports on the worker, the worker must not communicate while the main
+        // thread does
+        Dcpse<2, vector_type> dcpseAd(domain, Point<2, unsigned int>({1, 0}), 2, rCut, 1.2, support_options::CONDITION_ADAPTIVE);
+
+        auto itQ = domain.getDomainIterator();
+        while (itQ.isNext())
+        {
+            auto p = itQ.get();
+            domain.getPos(p)[1] += 0.01 * spacing[1] * sin(domain.getPos(p)[0]);
+            double x = domain.getPos(p)[0];
+            double y = domain.getPos(p)[1];
+            domain.template getProp<0>(p) = sin(x) * cos(y);
+            ++itQ;
+        }
+        domain.ghost_get<0>();
+
+        dcpseAd.initializeUpdateAsync(domain);
+        BOOST_REQUIRE(dcpseAd.isUpdateAsyncPending());
+
+        auto & v_cl = create_vcluster();
+        size_t nLocal = domain.size_local();
+        v_cl.sum(nLocal);
+        v_cl.execute();
+        BOOST_REQUIRE_EQUAL(nLocal, sz[0] * sz[1]);
+
+        BOOST_REQUIRE(dcpseAd.finalizeUpdateAsync(true));
+        dcpseAd.template computeDifferentialOperator<0, 1>(domain);
+
+        Dcpse<2, vector_type> dcpseAdSync(domain, Point<2, unsigned int>({1, 0}), 2, rCut, 1.2, support_options::CONDITION_ADAPTIVE);
+        dcpseAdSync.template computeDifferentialOperator<0, 2>(domain);
+
+        auto itD = domain.getDomainIterator();
+        while (itD.isNext())
+        {
+            auto p = itD.get();
+            BOOST_REQUIRE_EQUAL(dcpseAd.getNumNN(p), dcpseAdSync.getNumNN(p));
+            BOOST_REQUIRE_EQUAL(domain.template getProp<1>(p), domain.template getProp<2>(p));
+            ++itD;
+        }
+
+        dcpseAd.printStatistics();
+    }
+
+    BOOST_AUTO_TEST_CASE(Dcpse_2D_adaptive_order_test)
+    {
+        int rank;
+        MPI_Comm_rank(MPI_COMM_WORLD, &rank);
+
+        size_t edgeSemiSize = 20;
+        const size_t sz[2] = {2 * edgeSemiSize, 2 * edgeSemiSize};
+        Box<2, double> box({0, 0}, {2 * M_PI, 2 * M_PI});
+        size_t bc[2] = {NON_PERIODIC, NON_PERIODIC};
+        double spacing[2];
+        spacing[0] = 1.0 / (sz[0] - 1);
+        spacing[1] = 1.0 / (sz[1] - 1);
+        Ghost<2, double> ghost(0.1);
+
+        double rCut = 2 * spacing[0];
+
+        typedef vector_dist<2, double, aggregate<double, double, double>> vector_type;
+        vector_type domain(0, box, bc, ghost);
+
+        if (rank == 0)
+        {
+            auto it = domain.getGridIterator(sz);
+            while (it.isNext())
+            {
+                domain.add();
+                auto key = it.get();
+                double x = key.get(0) * spacing[0];
+                domain.getLastPos()[0] = x;
+                double y = key.get(1) * spacing[1];
+                domain.getLastPos()[1] = y;
+                domain.template getLastProp<0>() = sin(x);
+                // the indicator asks the full order only for x >= 0.5
+                domain.template getLastProp<1>() = x;
+                domain.template getLastProp<2>() = cos(x);
+
+                ++it;
+            }
+        }
+        domain.map();
+        domain.ghost_get();
+
+        Dcpse<2, vector_type> dcpse(domain, Point<2, unsigned int>({1, 0}), 4, rCut, 2, support_options::N_PARTICLES);
+        size_t nKernels = dcpse.getKernels().size();
+
+        dcpse.template initializeUpdateAdaptiveOrder<1>(domain, 2, 0.5);
+
+        auto & v_cl = create_vcluster();
+
+        size_t nLow = dcpse.getNLowOrderRows();
+        BOOST_REQUIRE(nLow <= domain.size_local());
+
+        size_t nLowTot = nLow, nKernelsTot = nKernels, nKernelsAdTot = dcpse.getKernels().size();
+        v_cl.sum(nLowTot);
+        v_cl.sum(nKernelsTot);
+        v_cl.sum(nKernelsAdTot);
+        v_cl.execute();
+
+        // half of the particles have x < 0.5
+        BOOST_REQUIRE(nLowTot > 0);
+        BOOST_REQUIRE(nLowTot < sz[0] * sz[1]);
+        BOOST_REQUIRE(nKernelsAdTot < nKernelsTot);
+
+        // smaller supports on the low order rows
+        auto itS = domain.getDomainIterator();
+        size_t maxLow = 0, minHigh = std::numeric_limits<size_t>::max();
+        while (itS.isNext())
+        {
+            auto p = itS.get();
+            size_t n = dcpse.getLocalSupports().getRowSize(p.getKey());
+            if (domain.getPos(p)[0] < 0.5)
+            {maxLow = std::max(maxLow,n);}
+            else
+            {minHigh = std::min(minHigh,n);}
+            ++itS;
+        }
+        v_cl.max(maxLow);
+        v_cl.min(minHigh);
+        v_cl.execute();
+
+        BOOST_REQUIRE(maxLow != 0);
+        BOOST_REQUIRE(minHigh != std::numeric_limits<size_t>::max());
+        BOOST_REQUIRE(maxLow < minHigh);
+
+        dcpse.template computeDifferentialOperator<0, 1>(domain);
+
+        const double avgSpacing = spacing[0] + spacing[1];
+        const double TOL = 2 * avgSpacing * avgSpacing;
+        auto itVal = domain.getDomainIterator();
+        while (itVal.isNext())
+        {
+            auto key = itVal.get();
+            BOOST_REQUIRE_SMALL(domain.template getProp<1>(key) - domain.template getProp<2>(key), TOL);
+            ++itVal;
+        }
+    }
+
+    BOOST_AUTO_TEST_CASE(Dcpse_2D_smooth_order_test)
+    {
+        int rank;
+        MPI_Comm_rank(MPI_COMM_WORLD, &rank);
+
+        size_t edgeSemiSize = 20;
+        const size_t sz[2] = {2 * edgeSemiSize, 2 * edgeSemiSize};
+        Box<2, double> box({0, 0}, {2 * M_PI, 2 * M_PI});
+        size_t bc[2] = {NON_PERIODIC, NON_PERIODIC};
+        double spacing[2];
+        spacing[0] = 1.0 / (sz[0] - 1);
+        spacing[1] = 1.0 / (sz[1] - 1);
+        Ghost<2, double> ghost(0.1);
+
+        double rCut = 2 * spacing[0];
+
+        typedef vector_dist<2, double, aggregate<double, double, double>> vector_type;
+        vector_type domain(0, box, bc, ghost);
+
+        if (rank == 0)
+        {
+            auto it = domain.getGridIterator(sz);
+            while (it.isNext())
+            {
+                domain.add();
+                auto key = it.get();
+                double x = key.get(0) * spacing[0];
+                domain.getLastPos()[0] = x;
+                double y = key.get(1) * spacing[1];
+                domain.getLastPos()[1] = y;
+                // the low order reproduces the quadratic exactly, not the oscillation for x >= 0.5
+                domain.template getLastProp<0>() = x * x + ((x >= 0.5)?0.05 * sin(60.0 * x):0.0);
+                domain.template getLastProp<2>() = 2.0 * x;
+
+                ++it;
+            }
+        }
+        domain.map();
+        domain.ghost_get();
+
+        Dcpse<2, vector_type> dcpse(domain, Point<2, unsigned int>({1, 0}), 4, rCut, 2, support_options::N_PARTICLES);
+
+        openfpm::vector<size_t> fullSize;
+        fullSize.resize(domain.size_local());
+        for (size_t i = 0 ; i < domain.size_local() ; i++)
+        {fullSize.get(i) = dcpse.getLocalSupports().getRowSize(i);}
+
+        dcpse.template initializeUpdateSmoothOrder<0>(domain, 2, 1e-4);
+
+        auto & v_cl = create_vcluster();
+
+        size_t nLowTot = dcpse.getNLowOrderRows();
+        v_cl.sum(nLowTot);
+        v_cl.execute();
+
+        BOOST_REQUIRE(nLowTot > 0);
+        BOOST_REQUIRE(nLowTot < sz[0] * sz[1]);
+
+        // far from the oscillation the rows are low order, with a smaller support and still exact on the quadratic
+        dcpse.template computeDifferentialOperator<0, 1>(domain);
+
+        auto itS = domain.getDomainIterator();
+        while (itS.isNext())
+        {
+            auto p = itS.get();
+            if (domain.getPos(p)[0] < 0.4)
+            {
+                BOOST_REQUIRE(dcpse.getLocalSupports().getRowSize(p.getKey()) < fullSize.get(p.getKey()));
+                BOOST_REQUIRE_SMALL(domain.template getProp<1>(p) - domain.template getProp<2>(p), 1e-6);
+            }
+            ++itS;
+        }
+    }
+
+    BOOST_AUTO_TEST_CASE(Dcpse_2D_subset_test)
+    {
+        int rank;
+        MPI_Comm_rank(MPI_COMM_WORLD, &rank);
+
+        size_t edgeSemiSize = 20;
+        const size_t sz[2] = {2 * edgeSemiSize, 2 * edgeSemiSize};
+        Box<2, double> box({0, 0}, {2 * M_PI, 2 * M_PI});
+        size_t bc[2] = {NON_PERIODIC, NON_PERIODIC};
+        double spacing[2];
+        spacing[0] = 1.0 / (sz[0] - 1);
+        spacing[1] = 1.0 / (sz[1] - 1);
+        Ghost<2, double> ghost(0.1);
+
+        double rCut = 2.5 * spacing[0];
+
+        typedef vector_dist<2, double, aggregate<double, double, double>> vector_type;
+        vector_type domain(0, box, bc, ghost);
+
+        if (rank == 0)
+        {
+            auto it = domain.getGridIterator(sz);
+            while (it.isNext())
+            {
+                domain.add();
+                auto key = it.get();
+                double x = key.get(0) * spacing[0];
+                domain.getLastPos()[0] = x;
+                double y = key.get(1) * spacing[1];
+                domain.getLastPos()[1] = y;
+                domain.template getLastProp<0>() = sin(x) * cos(y);
+
+                ++it;
+            }
+        }
+        domain.map();
+        domain.ghost_get<0>();
+
+        // the particles of the left boundary
+        openfpm::vector<aggregate<int>> boundary;
+        auto itB = domain.getDomainIterator();
+        while (itB.isNext())
+        {
+            auto p = itB.get();
+            if (domain.getPos(p)[0] < 0.5 * spacing[0])
+            {
+                boundary.add();
+                boundary.last().get<0>() = p.getKey();
+            }
+            domain.template getProp<1>(p) = 0.0;
+            domain.template getProp<2>(p) = 0.0;
+            ++itB;
+        }
+
+        Dcpse<2, vector_type> dcpse(domain, Point<2, unsigned int>({1, 0}), 2, rCut, boundary);
+        Dcpse<2, vector_type> dcpseFull(domain, Point<2, unsigned int>({1, 0}), 2, rCut);
+        BOOST_REQUIRE(dcpse.getKernels().size() <= dcpseFull.getKernels().size());
+        if (domain.size_local() != 0 && boundary.size() < domain.size_local())
+        {BOOST_REQUIRE(dcpse.getKernels().size() < dcpseFull.getKernels().size());}
+
+        dcpse.template computeDifferentialOperator<0, 1>(domain);
+        dcpseFull.template computeDifferentialOperator<0, 2>(domain);
+
+        for (size_t i = 0 ; i < boundary.size() ; i++)
+        {
+            size_t p = boundary.get<0>(i);
+            BOOST_REQUIRE_EQUAL(domain.template getProp<1>(p), domain.template getProp<2>(p));
+            domain.template getProp<1>(p) = 0.0;
+        }
+
+        // outside the subset nothing is written
+        auto itC = domain.getDomainIterator();
+        while (itC.isNext())
+        {
+            auto p = itC.get();
+            BOOST_REQUIRE_EQUAL(domain.template getProp<1>(p), 0.0);
+            ++itC;
+        }
+    }
+
+    BOOST_AUTO_TEST_CASE(Dcpse_2D_support_ghost_test)
+    {
+        size_t edgeSemiSize = 20;
+        const size_t sz[2] = {2 * edgeSemiSize, 2 * edgeSemiSize};
+        Box<2, double> box({0, 0}, {1, 1});
+        size_t bc[2] = {PERIODIC, PERIODIC};
+        double spacing[2];
+        spacing[0] = 1.0 / sz[0];
+        spacing[1] = 1.0 / sz[1];
+
+        double rCut = 2.5 * spacing[0];
+
+        // a conservative ghost
+        Ghost<2, double> ghost(2.0 * rCut);
+
+        typedef vector_dist<2, double, aggregate<double, double, double>> vector_type;
+        vector_type domain(0, box, bc, ghost);
+
+        auto it = domain.getGridIterator(sz);
+        while (it.isNext())
+        {
+            domain.add();
+            auto key = it.get();
+            double x = key.get(0) * spacing[0];
+            domain.getLastPos()[0] = x;
+            double y = key.get(1) * spacing[1];
+            domain.getLastPos()[1] = y;
+            domain.template getLastProp<0>() = sin(2 * M_PI * x) * cos(2 * M_PI * y);
+
+            ++it;
+        }
+        domain.map();
+        domain.ghost_get<0>();
+
+        Dcpse<2, vector_type> dcpse(domain, Point<2, unsigned int>({1, 0}), 2, rCut);
+
+        // the supports reach at most rCut
+        Point<2, double> ext = dcpse.getSupportExtent();
+        BOOST_REQUIRE(ext[0] > 0.5 * spacing[0]);
+        BOOST_REQUIRE(ext[0] <= rCut + 1e-12);
+        BOOST_REQUIRE(ext[1] <= rCut + 1e-12);
+
+        dcpse.template computeDifferentialOperator<0, 1>(domain);
+
+        DcpseGhostExchange<2, vector_type> gx(domain);
+        gx.addSupport(dcpse.getLocalSupports());
+        gx.build();
+        BOOST_REQUIRE(gx.getNGhostNeeded() <= domain.size_local_with_ghost() - domain.size_local());
+
+        // scramble the ghost and refill only the part in the supports
+        for (size_t k = domain.size_local() ; k < domain.size_local_with_ghost() ; k++)
+        {domain.template getProp<0>(k) = 1e10;}
+        gx.ghost_get<0>();
+
+        dcpse.template computeDifferentialOperator<0, 2>(domain);
+
+        auto itC = domain.getDomainIterator();
+        while (itC.isNext())
+        {
+            auto p = itC.get();
+            BOOST_REQUIRE_EQUAL(domain.template getProp<1>(p), domain.template getProp<2>(p));
+            ++itC;
+        }
+    }
+
+    BOOST_AUTO_TEST_CASE(Dcpse_2D_cost_model_test)
+    {
+        int rank;
+        MPI_Comm_rank(MPI_COMM_WORLD, &rank);
+
+        size_t edgeSemiSize = 20;
+        const size_t sz[2] = {2 * edgeSemiSize, 2 * edgeSemiSize};
+        Box<2, double> box({0, 0}, {1, 1});
+        size_t bc[2] = {NON_PERIODIC, NON_PERIODIC};
+        double spacing[2];
+        spacing[0] = 1.0 / (sz[0] - 1);
+        spacing[1] = 1.0 / (sz[1] - 1);
+        Ghost<2, double> ghost(0.1);
+
+        double rCut = 3.1 * spacing[0];
+
+        typedef vector_dist<2, double, aggregate<double, double, double>> vector_type;
+        vector_type domain(0, box, bc, ghost);
+
+        if (rank == 0)
+        {
+            auto it = domain.getGridIterator(sz);
+            while (it.isNext())
+            {
+                domain.add();
+                auto key = it.get();
+                domain.getLastPos()[0] = key.get(0) * spacing[0];
+                domain.getLastPos()[1] = key.get(1) * spacing[1];
+                ++it;
+            }
+        }
+        domain.map();
+        domain.ghost_get<0>();
+
+        Dcpse<2, vector_type> dx(domain, Point<2, unsigned int>({1, 0}), 2, rCut);
+        Dcpse<2, vector_type> dxx(domain, Point<2, unsigned int>({2, 0}), 2, rCut);
+
+        DcpseCostModel md(10);
+        md.addOperator(dx);
+
+        DcpseCostModel md2(10);
+        md2.addOperator(dx);
+        md2.addOperator(dxx);
+
+        auto itC = domain.getDomainIterator();
+        while (itC.isNext())
+        {
+            auto p = itC.get();
+            double N = dx.getNumNN(p);
+            double nb = dx.getBasisSize();
+            if (N != 0)
+            {BOOST_REQUIRE_CLOSE(md.getCost(p.getKey()), N*nb*nb + nb*nb*nb + 10*N, 1e-10);}
+            BOOST_REQUIRE(md2.getCost(p.getKey()) >= md.getCost(p.getKey()));
+            ++itC;
+        }
+
+        // the model plugs in the decomposition costs
+        domain.addComputationCosts(md2);
+    }
+
 #endif // HAVE_EIGEN
 
 BOOST_AUTO_TEST_SUITE_END()
@@ -7,6 +7,7 @@
 #include <boost/test/unit_test.hpp>
 #include <Space/Shape/Point.hpp>
 #include <DCPSE/MonomialBasis.hpp>
+#include <DCPSE/MonomialBasisEvaluator.hpp>
 
 BOOST_AUTO_TEST_SUITE(MonomialBasis_tests)
 
@@ -168,4 +169,99 @@ BOOST_AUTO_TEST_SUITE(MonomialBasis_tests)
         }
     }
 
+    BOOST_AUTO_TEST_CASE(MonomialBasisEvaluator_3D_test)
+    {
+        struct dense
+        {
+            size_t nc;
+            std::vector<double> v;
+            double & operator()(size_t i, size_t j) {return v[i*nc+j];}
+            double operator()(size_t j) const {return v[j];}
+        };
+
+        MonomialBasis<3> mb({1, 1, 0}, 4);
+
+        // 13 points, so the last block is partial
+        openfpm::vector_std<Point<3, double>> x;
+        for (size_t i = 0; i < 13; ++i)
+        {
+            x.add(Point<3, double>({0.1 * i - 0.5, 0.3 * sin(1.0 * i), 0.2 * cos(2.0 * i)}));
+        }
+
+        double eps = 0.7;
+        MonomialBasisEvaluator<3, double> ev(mb);
+        BOOST_REQUIRE_EQUAL(ev.size(), mb.size());
+
+        dense M;
+        M.nc = mb.size();
+        M.v.resize(x.size() * mb.size());
+        ev.buildRows(M, x, eps);
+
+        dense a;
+        a.nc = 1;
+        for (size_t m = 0; m < mb.size(); ++m)
+        {a.v.push_back(1.0 + 0.1 * m);}
+
+        std::vector<double> comb(x.size());
+        ev.evaluateCombination(comb.data(), x, 1.0 / eps, a);
+
+        for (size_t i = 0; i < x.size(); ++i)
+        {
+            double ref = 0.0;
+            for (size_t m = 0; m < mb.size(); ++m)
+            {
+                const Monomial<3> & mono = mb.getElement(m);
+                double v = mono.evaluate(x.get(i)) / openfpm::math::intpowlog(eps, mono.order());
+                BOOST_REQUIRE_CLOSE(M(i, m) + 1.0, v + 1.0, 1e-10);
+
+                Point<3, double> xs = x.get(i) / eps;
+                ref += a(m) * mono.evaluate(xs);
+            }
+            BOOST_REQUIRE_CLOSE(comb[i] + 1.0, ref + 1.0, 1e-10);
+        }
+    }
+
+    BOOST_AUTO_TEST_CASE(StaticMonomialBasisEvaluator_test)
+    {
+        struct dense
+        {
+            size_t nc;
+            std::vector<double> v;
+            double & operator()(size_t i, size_t j) {return v[i*nc+j];}
+        };
+
+        // The compile time bases are the ones of MonomialBasis
+        BOOST_REQUIRE((StaticMonomialBasisEvaluator<2, double, 3, 0>::matches(MonomialBasis<2>({1, 0}, 2))));
+        BOOST_REQUIRE((StaticMonomialBasisEvaluator<2, double, 4, 1>::matches(MonomialBasis<2>({2, 0}, 2))));
+        BOOST_REQUIRE((StaticMonomialBasisEvaluator<2, double, 6, 1>::matches(MonomialBasis<2>({1, 1}, 4))));
+        BOOST_REQUIRE((StaticMonomialBasisEvaluator<3, double, 5, 0>::matches(MonomialBasis<3>({0, 0, 1}, 4))));
+        BOOST_REQUIRE((StaticMonomialBasisEvaluator<3, double, 4, 1>::matches(MonomialBasis<3>({0, 2, 0}, 2))));
+        BOOST_REQUIRE(!(StaticMonomialBasisEvaluator<3, double, 4, 1>::matches(MonomialBasis<3>({0, 1, 0}, 2))));
+
+        MonomialBasis<3> mb({1, 1, 0}, 4);
+        typedef StaticMonomialBasisEvaluator<3, double, 6, 1> static_ev;
+        BOOST_REQUIRE(static_ev::matches(mb));
+
+        openfpm::vector_std<Point<3, double>> x;
+        for (size_t i = 0; i < 11; ++i)
+        {
+            x.add(Point<3, double>({0.1 * i - 0.5, 0.3 * sin(1.0 * i), 0.2 * cos(2.0 * i)}));
+        }
+
+        dense M1, M2;
+        M1.nc = M2.nc = mb.size();
+        M1.v.resize(x.size() * mb.size());
+        M2.v.resize(x.size() * mb.size());
+
+        MonomialBasisEvaluator<3, double> ev(mb);
+        static_ev sev(mb);
+        ev.buildRows(M1, x, 0.7);
+        sev.buildRows(M2, x, 0.7);
+
+        for (size_t i = 0; i < M1.v.size(); ++i)
+        {
+            BOOST_REQUIRE_CLOSE(M1.v[i] + 1.0, M2.v[i] + 1.0, 1e-10);
+        }
+    }
+
 BOOST_AUTO_TEST_SUITE_END()
\ No newline at end of file
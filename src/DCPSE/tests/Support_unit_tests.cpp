@@ -116,6 +116,274 @@ BOOST_AUTO_TEST_SUITE(Support_tests)
         BOOST_REQUIRE_GE(supportPoints.size(), 20);
     }
 
+    BOOST_AUTO_TEST_CASE(SupportBuilder_2D_nearest_and_radius_test)
+    {
+        size_t sz[2] = {30, 30};
+        Box<2, double> box({0.0, 0.0}, {1.0, 1.0});
+        size_t bc[2] = {NON_PERIODIC, NON_PERIODIC};
+        double spacing = 1.0 / (sz[0] - 1);
+        Ghost<2, double> ghost(0.1);
+
+        typedef vector_dist<2, double, aggregate<double>> vector_dist_type;
+        vector_dist_type domain(0, box, bc, ghost);
+
+        // slightly perturbed grid, so that distances are not degenerate
+        auto it = domain.getGridIterator(sz);
+        size_t counter = 0;
+        while (it.isNext())
+        {
+            domain.add();
+            auto key = it.get();
+            domain.getLastPos()[0] = key.get(0) * spacing + 0.1 * spacing * sin(3.0 * counter);
+            domain.getLastPos()[1] = key.get(1) * spacing + 0.1 * spacing * cos(5.0 * counter);
+            ++counter;
+            ++it;
+        }
+
+        double rCut = 2.5 * spacing;
+        SupportBuilder<vector_dist_type,vector_dist_type> supportBuilder(domain, domain, {1,0}, rCut, false);
+
+        auto itPoint = domain.getDomainIterator();
+        while (itPoint.isNext())
+        {
+            auto p = itPoint.get();
+            Point<2, double> xp = domain.getPos(p);
+
+            // brute force
+            std::vector<double> dist;
+            size_t nInRadius = 0;
+            for (size_t q = 0; q < domain.size_local(); q++)
+            {
+                if (q == p.getKey()) {continue;}
+                double d = xp.distance(Point<2, double>(domain.getPos(q)));
+                dist.push_back(d);
+                if (d < rCut) {nInRadius++;}
+            }
+            std::sort(dist.begin(), dist.end());
+
+            auto supN = supportBuilder.getSupport(itPoint, 12, support_options::N_PARTICLES);
+            BOOST_REQUIRE_EQUAL(supN.size(), 12);
+
+            double prev = 0.0;
+            for (size_t i = 0; i < supN.size(); i++)
+            {
+                double d = xp.distance(Point<2, double>(domain.getPos(supN.getKeys().get(i))));
+                BOOST_REQUIRE_CLOSE(d + 1.0, dist[i] + 1.0, 1e-10);
+                BOOST_REQUIRE(d >= prev);
+                prev = d;
+            }
+
+            auto supR = supportBuilder.getSupport(itPoint, 12, support_options::RADIUS);
+            BOOST_REQUIRE_EQUAL(supR.size(), nInRadius);
+
+            ++itPoint;
+        }
+    }
+
+    BOOST_AUTO_TEST_CASE(SupportBuilder_cell_list_cache_test)
+    {
+        size_t sz[2] = {20, 20};
+        Box<2, double> box({0.0, 0.0}, {1.0, 1.0});
+        size_t bc[2] = {NON_PERIODIC, NON_PERIODIC};
+        double spacing = 1.0 / (sz[0] - 1);
+        Ghost<2, double> ghost(0.1);
+
+        typedef vector_dist<2, double, aggregate<double>> vector_dist_type;
+        vector_dist_type domain(0, box, bc, ghost);
+
+        auto it = domain.getGridIterator(sz);
+        while (it.isNext())
+        {
+            domain.add();
+            auto key = it.get();
+            domain.getLastPos()[0] = key.get(0) * spacing;
+            domain.getLastPos()[1] = key.get(1) * spacing;
+            ++it;
+        }
+
+        double rCut = 2.1 * spacing;
+        SupportBuilder<vector_dist_type,vector_dist_type> sbRef(domain, domain, {1,0}, rCut, false);
+
+        {
+            SupportCellListCache<vector_dist_type> cache(domain);
+
+            SupportBuilder<vector_dist_type,vector_dist_type> sb1(domain, domain, {1,0}, rCut, false);
+            SupportBuilder<vector_dist_type,vector_dist_type> sb2(domain, domain, {0,1}, rCut, false);
+            BOOST_REQUIRE_EQUAL(cache.size(), 1);
+
+            SupportBuilder<vector_dist_type,vector_dist_type> sb3(domain, domain, {0,1}, 2.0 * rCut, false);
+            BOOST_REQUIRE_EQUAL(cache.size(), 2);
+
+            auto itPoint = domain.getDomainIterator();
+            while (itPoint.isNext())
+            {
+                auto sRef = sbRef.getSupport(itPoint, 6, support_options::RADIUS);
+                auto s1 = sb1.getSupport(itPoint, 6, support_options::RADIUS);
+                auto s2 = sb2.getSupport(itPoint, 6, support_options::RADIUS);
+
+                BOOST_REQUIRE_EQUAL(s1.size(), sRef.size());
+                BOOST_REQUIRE_EQUAL(s2.size(), sRef.size());
+                for (size_t i = 0; i < sRef.size(); i++)
+                {
+                    BOOST_REQUIRE_EQUAL(s1.getKeys().get(i), sRef.getKeys().get(i));
+                    BOOST_REQUIRE_EQUAL(s2.getKeys().get(i), sRef.getKeys().get(i));
+                }
+
+                ++itPoint;
+            }
+        }
 
+        // the cache is not active anymore
+        BOOST_REQUIRE(SupportCellListCache<vector_dist_type>::find(domain, rCut) == NULL);
+    }
+
+    BOOST_AUTO_TEST_CASE(SupportBuilder_anisotropic_cells_radius_test)
+    {
+        // narrow domain, the cells of the cell list are larger along x than along y
+        Box<2, double> box({0.0, 0.0}, {0.12, 1.0});
+        size_t bc[2] = {NON_PERIODIC, NON_PERIODIC};
+        Ghost<2, double> ghost(0.1);
+
+        typedef vector_dist<2, double, aggregate<double>> vector_dist_type;
+        vector_dist_type domain(0, box, bc, ghost);
+
+        for (size_t i = 0; i < 400; i++)
+        {
+            domain.add();
+            domain.getLastPos()[0] = 0.12 * (double)rand() / RAND_MAX;
+            domain.getLastPos()[1] = (double)rand() / RAND_MAX;
+        }
+
+        // rCut spans more cells along y than along x
+        double rCut = 0.12;
+        auto cl = domain.getCellList(0.05);
+        SupportBuilder<vector_dist_type,vector_dist_type> supportBuilder(domain, domain, {1,0}, rCut, false, cl);
+
+        auto itPoint = domain.getDomainIterator();
+        while (itPoint.isNext())
+        {
+            auto p = itPoint.get();
+            Point<2, double> xp = domain.getPos(p);
+
+            size_t nInRadius = 0;
+            for (size_t q = 0; q < domain.size_local(); q++)
+            {
+                if (q != p.getKey() && xp.distance(Point<2, double>(domain.getPos(q))) < rCut) {nInRadius++;}
+            }
+
+            auto supR = supportBuilder.getSupport(itPoint, 1, support_options::RADIUS);
+            BOOST_REQUIRE_EQUAL(supR.size(), nInRadius);
+
+            ++itPoint;
+        }
+    }
+
+    BOOST_AUTO_TEST_CASE(CellNeighbourSearch_non_uniform_test)
+    {
+        Box<2, double> box({0.0, 0.0}, {1.0, 1.0});
+        size_t bc[2] = {NON_PERIODIC, NON_PERIODIC};
+        Ghost<2, double> ghost(0.1);
+
+        typedef vector_dist<2, double, aggregate<double>> vector_dist_type;
+        vector_dist_type domain(0, box, bc, ghost);
+
+        // particles clustered around the origin
+        for (size_t i = 0; i < 600; i++)
+        {
+            domain.add();
+            double r = 0.99 * pow((double)rand() / RAND_MAX, 3.0);
+            double t = 0.5 * M_PI * (double)rand() / RAND_MAX;
+            domain.getLastPos()[0] = r * cos(t);
+            domain.getLastPos()[1] = r * sin(t);
+        }
+
+        auto cl = domain.getCellList(0.05);
+        CellNeighbourSearch<vector_dist_type, decltype(cl)> search(domain, cl);
+
+        double r = 0.1;
+        openfpm::vector_std<size_t> keys;
+        for (size_t p = 0; p < domain.size_local(); p++)
+        {
+            Point<2, double> xp = domain.getPos(p);
+
+            size_t nInRadius = 0;
+            for (size_t q = 0; q < domain.size_local(); q++)
+            {
+                if (q != p && xp.distance(Point<2, double>(domain.getPos(q))) < r) {nInRadius++;}
+            }
+
+            // radius search on the cube covering r
+            keys.clear();
+            search.clear();
+            search.addCube(xp, 2, p);
+            search.selectRadius(keys, r);
+            BOOST_REQUIRE_EQUAL(keys.size(), nInRadius);
+
+            // the shells grow until they contain enough particles, also far from the cluster
+            keys.clear();
+            search.clear();
+            search.addShells(xp, 11, p);
+            BOOST_REQUIRE(search.getCandidates().size() >= 10);
+            search.selectNearest(keys, 10);
+            BOOST_REQUIRE_EQUAL(keys.size(), 10);
+
+            double prev = 0.0;
+            for (size_t i = 0; i < keys.size(); i++)
+            {
+                double d = xp.distance(Point<2, double>(domain.getPos(keys.get(i))));
+                BOOST_REQUIRE(d >= prev);
+                prev = d;
+            }
+        }
+    }
+
+    BOOST_AUTO_TEST_CASE(SupportCSR_rows_and_promotion_test)
+    {
+        SupportCSR sup;
+
+        openfpm::vector_std<size_t> keys;
+        keys.add(3);
+        keys.add(1);
+        keys.add(7);
+        sup.addRow(0,keys);
+
+        // row 1 is skipped and must be empty
+        keys.clear();
+        keys.add(5);
+        sup.addRow(2,keys);
+        sup.finalize(4);
+
+        BOOST_REQUIRE_EQUAL(sup.size(),4);
+        BOOST_REQUIRE_EQUAL(sup.getNKeys(),4);
+        BOOST_REQUIRE_EQUAL(sup.is32bitKeys(),true);
+        BOOST_REQUIRE_EQUAL(sup.getRowSize(0),3);
+        BOOST_REQUIRE_EQUAL(sup.getRowSize(1),0);
+        BOOST_REQUIRE_EQUAL(sup.getRowSize(2),1);
+        BOOST_REQUIRE_EQUAL(sup.getRowSize(3),0);
+        BOOST_REQUIRE_EQUAL(sup.getRowOffset(2),3);
+        BOOST_REQUIRE_EQUAL(sup.getKey(0,2),7);
+        BOOST_REQUIRE_EQUAL(sup.getKey(2,0),5);
+
+        auto view = sup.getSupport<unsigned int>(0);
+        BOOST_REQUIRE_EQUAL(view.size(),3);
+        BOOST_REQUIRE_EQUAL(view.getReferencePointKey(),0);
+        BOOST_REQUIRE_EQUAL(view.getKeys().get(1),1);
+
+        // A key that does not fit 32 bit promote the storage
+        SupportCSR sup64;
+        keys.clear();
+        keys.add(2);
+        sup64.addRow(0,keys);
+        keys.clear();
+        keys.add((size_t)std::numeric_limits<unsigned int>::max() + 10);
+        keys.add(4);
+        sup64.addRow(1,keys);
+        sup64.finalize(2);
+
+        BOOST_REQUIRE_EQUAL(sup64.is32bitKeys(),false);
+        BOOST_REQUIRE_EQUAL(sup64.getKey(0,0),2);
+        BOOST_REQUIRE_EQUAL(sup64.getKey(1,0),(size_t)std::numeric_limits<unsigned int>::max() + 10);
+        BOOST_REQUIRE_EQUAL(sup64.getSupport<size_t>(1).get(1),4);
+    }
 
 BOOST_AUTO_TEST_SUITE_END()
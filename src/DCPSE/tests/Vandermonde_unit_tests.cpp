@@ -8,6 +8,7 @@
 #include <DCPSE/MonomialBasis.hpp>
 #include <DCPSE/VandermondeRowBuilder.hpp>
 #include <DCPSE/Vandermonde.hpp>
+#include <DCPSE/DcpseDiagonalScalingMatrix.hpp>
 #include "DMatrix/EMatrix.hpp"
 
 BOOST_AUTO_TEST_SUITE(Vandermonde_tests)
@@ -254,6 +255,47 @@ BOOST_AUTO_TEST_SUITE(Vandermonde_tests)
         }
     }
 
+    BOOST_AUTO_TEST_CASE(Vandermonde_FixedSize_ScaleRows_test)
+    {
+        MonomialBasis<2> mb({1, 0}, 2);
+
+        vector_dist<2,double,aggregate<double>> parts;
+
+        double pos[8][2] = {{1,1},{2,2},{0,0},{2,0},{0,2},{1,2},{1,0},{2,1}};
+        for (size_t i = 0; i < 8; ++i)
+        {
+            parts.add();
+            parts.getLastPos()[0]=pos[i][0];
+            parts.getLastPos()[1]=pos[i][1];
+        }
+
+        const std::vector<size_t> keys({1,2,3,4,5,6,7});
+        Support s(0,keys);
+
+        // Reference: dynamic V and dense E
+        EMatrix<double, Eigen::Dynamic, Eigen::Dynamic> V(keys.size(), mb.size());
+        EMatrix<double, Eigen::Dynamic, Eigen::Dynamic> E(keys.size(), keys.size());
+        Vandermonde<2, double, EMatrix<double, Eigen::Dynamic, Eigen::Dynamic>> vandermonde(s, mb, parts,parts);
+        vandermonde.getMatrix(V);
+        DcpseDiagonalScalingMatrix<2> diagonalScalingMatrix(mb);
+        diagonalScalingMatrix.buildMatrix(E, s, vandermonde.getEps(), parts, parts);
+        EMatrix<double, Eigen::Dynamic, Eigen::Dynamic> B = E * V;
+
+        // Fixed number of columns, more rows than the support and scaling in place
+        EMatrix<double, Eigen::Dynamic, 6> Vf(keys.size() + 3, mb.size());
+        Vandermonde<2, double, EMatrix<double, Eigen::Dynamic, 6>> vandermondeF(s, mb, parts,parts);
+        vandermondeF.getMatrix(Vf);
+        diagonalScalingMatrix.scaleRows(Vf, s, vandermondeF.getEps(), parts, parts);
+
+        for (int i = 0; i < keys.size(); ++i)
+        {
+            for (int j = 0; j < mb.size(); ++j)
+            {
+                BOOST_REQUIRE_CLOSE(Vf(i, j) + 1.0, B(i, j) + 1.0, 1e-10);
+            }
+        }
+    }
+
 #endif // HAVE_EIGEN
 
 BOOST_AUTO_TEST_SUITE_END()
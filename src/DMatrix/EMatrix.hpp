@@ -96,6 +96,12 @@ public:
 
 	EIGEN_DENSE_PUBLIC_INTERFACE(EMatrix)
 
+	//! The size of the matrix is known at compile time, it is serialized without rows and columns
+	static constexpr bool is_fixed_size = (_Rows != Eigen::Dynamic && _Cols != Eigen::Dynamic);
+
+	//! Bytes of the header with the number of rows and columns (none for fixed size matrices)
+	static constexpr size_t header_size = (is_fixed_size == true)?0:2*sizeof(size_t);
+
 	/*! \brief It calculate the number of byte required to serialize the object
 	 *
 	 * \tparam prp list of properties
@@ -106,11 +112,14 @@ public:
 	template<int ... prp> inline void packRequest(size_t & req) const
 	{
 		// Memory required to serialize the Matrix
-		req += sizeof(_Scalar)*this->rows()*this->cols() + 2*sizeof(_Scalar);
+		req += header_size + sizeof(_Scalar)*this->rows()*this->cols();
 	}
 
 
 	/*! \brief pack a vector selecting the properties to pack
+	 *
+	 * The header and the coefficients are written with one request, the coefficients with one memcpy from the
+	 * Eigen buffer
 	 *
 	 * \param mem preallocated memory where to pack the vector
 	 * \param sts pack-stat info
@@ -118,15 +127,19 @@ public:
 	 */
 	template<int ... prp> inline void pack(ExtPreAlloc<HeapMemory> & mem, Pack_stat & sts) const
 	{
-		//Pack the number of rows and colums
-		Packer<size_t, HeapMemory>::pack(mem,this->rows(),sts);
-		Packer<size_t, HeapMemory>::pack(mem,this->cols(),sts);
+		size_t n = sizeof(_Scalar)*this->rows()*this->cols();
 
-		mem.allocate(sizeof(_Scalar)*this->rows()*this->cols());
-		void * dst = mem.getPointer();
-		void * src = (void *)this->data();
+		mem.allocate(header_size + n);
+		char * dst = (char *)mem.getPointer();
 
-		memcpy(dst,src,sizeof(_Scalar)*this->rows()*this->cols());
+		//Pack the number of rows and colums
+		if (is_fixed_size == false)
+		{
+			size_t rc[2] = {(size_t)this->rows(),(size_t)this->cols()};
+			memcpy(dst,rc,header_size);
+		}
+
+		memcpy(dst + header_size,(void *)this->data(),n);
 		sts.incReq();
 	}
 
@@ -137,21 +150,22 @@ public:
 	 */
 	template<int ... prp> inline void unpack(ExtPreAlloc<HeapMemory> & mem, Unpack_stat & ps)
 	{
-		size_t row;
-		size_t col;
+		const char * src = (const char *)mem.getPointerOffset(ps.getOffset());
 
-		//Pack the number of rows and colums
-		Unpacker<size_t, HeapMemory>::unpack(mem,row,ps);
-		Unpacker<size_t, HeapMemory>::unpack(mem,col,ps);
+		//Unpack the number of rows and colums
+		if (is_fixed_size == false)
+		{
+			size_t rc[2];
+			memcpy(rc,src,header_size);
 
-		this->resize(row,col);
+			this->resize(rc[0],rc[1]);
+		}
 
-		void * dst = this->data();
-		void * src = mem.getPointerOffset(ps.getOffset());
+		size_t n = sizeof(_Scalar)*this->rows()*this->cols();
 
-		memcpy(dst,src,sizeof(_Scalar)*row*col);
+		memcpy((void *)this->data(),src + header_size,n);
 
-		ps.addOffset(sizeof(_Scalar)*row*col);
+		ps.addOffset(header_size + n);
 	}
 
 	////// wrap all eigen operator
@@ -79,7 +79,8 @@ BOOST_AUTO_TEST_CASE( EMatrix_test_use)
 	ExtPreAlloc<HeapMemory> & mem = *(new ExtPreAlloc<HeapMemory>(pr,pmem));
 	mem.incRef();
 
-	BOOST_REQUIRE_EQUAL(pr,3*3*sizeof(double) + 2*sizeof(size_t));
+	// fixed size, no header
+	BOOST_REQUIRE_EQUAL(pr,3*3*sizeof(double));
 
 	Pack_stat sts;
 	em.pack(mem,sts);
@@ -102,6 +103,52 @@ BOOST_AUTO_TEST_CASE( EMatrix_test_use)
 	}
 }
 
+BOOST_AUTO_TEST_CASE( EMatrix_test_pack_sequence)
+{
+	// a dynamic float matrix and a fixed size matrix packed one after the other
+	EMatrixXf ef(3,2);
+	EMatrix2d ed;
+
+	for (size_t i = 0 ; i < 3 ; i++)
+	{
+		for (size_t j = 0 ; j < 2 ; j++)
+		{ef(i,j) = i*2+j;}
+	}
+
+	ed << 1.0, 2.0, 3.0, 4.0;
+
+	size_t pr = 0;
+	ef.packRequest(pr);
+	ed.packRequest(pr);
+
+	BOOST_REQUIRE_EQUAL(pr,3*2*sizeof(float) + 2*sizeof(size_t) + 4*sizeof(double));
+
+	HeapMemory pmem;
+	pmem.allocate(pr);
+	ExtPreAlloc<HeapMemory> & mem = *(new ExtPreAlloc<HeapMemory>(pr,pmem));
+	mem.incRef();
+
+	Pack_stat sts;
+	ef.pack(mem,sts);
+	ed.pack(mem,sts);
+
+	EMatrixXf uf;
+	EMatrix2d ud;
+
+	Unpack_stat ps;
+	uf.unpack(mem,ps);
+	ud.unpack(mem,ps);
+
+	BOOST_REQUIRE_EQUAL(ps.getOffset(),pr);
+	BOOST_REQUIRE_EQUAL(uf.rows(),3);
+	BOOST_REQUIRE_EQUAL(uf.cols(),2);
+	BOOST_REQUIRE(uf == ef);
+	BOOST_REQUIRE(ud == ed);
+
+	mem.decRef();
+	delete &mem;
+}
+
 BOOST_AUTO_TEST_SUITE_END()
 
 
@@ -11,6 +11,127 @@
 #include "PointIterator.hpp"
 #include "PointIteratorSkin.hpp"
 #include "Vector/vector_dist.hpp"
+#include <vector>
+#include <cmath>
+
+#ifdef __NVCC__
+#include "util/cuda/scan_ofp.cuh"
+#endif
+
+//! Number of points of a virtual grid counted and filled by one thread in DrawParticles::FillBox/FillSkin
+#define DRAW_PARTICLES_CHUNK 65536
+
+/*! \brief Box of points of the virtual grid of DrawParticles owned by one local sub-domain
+ *
+ * The points are numbered with the first coordinate running fastest
+ *
+ */
+template<unsigned int dim, typename T>
+struct draw_particles_lattice
+{
+	//! first point of the box on the virtual grid
+	long int lo[dim];
+
+	//! number of points of the box in every direction
+	size_t ext[dim];
+
+	//! low corner of the domain
+	T low[dim];
+
+	//! spacing of the virtual grid
+	T sp[dim];
+
+	//! number of points of the box
+	__device__ __host__ inline size_t size() const
+	{
+		size_t n = 1;
+		for (size_t i = 0 ; i < dim ; i++)
+			n *= ext[i];
+
+		return n;
+	}
+
+	//! position of the point idx
+	__device__ __host__ inline void getPoint(size_t idx, T (& x)[dim]) const
+	{
+		for (size_t i = 0 ; i < dim ; i++)
+		{
+			x[i] = (lo[i] + (long int)(idx % ext[i])) * sp[i] + low[i];
+			idx /= ext[i];
+		}
+	}
+};
+
+//! Filter of DrawParticles::FillBox, every point is kept
+template<unsigned int dim, typename T>
+struct draw_particles_keep_all
+{
+	__device__ __host__ inline bool operator()(const T (& x)[dim]) const
+	{
+		return true;
+	}
+};
+
+//! Filter of DrawParticles::FillSkin, the points inside one of the boxes A are removed
+template<unsigned int dim, typename T>
+struct draw_particles_skin_filter
+{
+	//! low and high corner of every box A (2*dim values for every box)
+	const T * boxA;
+
+	//! number of boxes A
+	unsigned int nA;
+
+	__device__ __host__ inline bool operator()(const T (& x)[dim]) const
+	{
+		for (unsigned int b = 0 ; b < nA ; b++)
+		{
+			bool inside = true;
+			for (unsigned int i = 0 ; i < dim ; i++)
+				inside &= (x[i] >= boxA[2*dim*b + i] && x[i] <= boxA[2*dim*b + dim + i]);
+
+			if (inside == true)
+				return false;
+		}
+
+		return true;
+	}
+};
+
+#ifdef __NVCC__
+
+//! Flag the points of a box of the virtual grid that pass the filter
+template<unsigned int dim, typename T, typename filter_type>
+__global__ void draw_particles_count_gpu(draw_particles_lattice<dim,T> lat, filter_type filter, unsigned int * flag)
+{
+	size_t i = blockIdx.x * blockDim.x + threadIdx.x;
+	if (i >= lat.size()) return;
+
+	T x[dim];
+	lat.getPoint(i,x);
+
+	flag[i] = filter(x);
+}
+
+//! Write the positions of the points of a box of the virtual grid that pass the filter
+template<unsigned int dim, typename T, typename vector_type, typename filter_type>
+__global__ void draw_particles_fill_gpu(vector_type vd, draw_particles_lattice<dim,T> lat, filter_type filter,
+                                        const unsigned int * off, unsigned int start)
+{
+	size_t i = blockIdx.x * blockDim.x + threadIdx.x;
+	if (i >= lat.size()) return;
+
+	T x[dim];
+	lat.getPoint(i,x);
+
+	if (filter(x) == false) return;
+
+	unsigned int p = start + off[i];
+	for (unsigned int j = 0 ; j < dim ; j++)
+		vd.getPos(p)[j] = x[j];
+}
+
+#endif
 
 /*! \brief A class to draw/create particles based on simple shaped
  *
@@ -21,6 +142,224 @@
  */
 class DrawParticles
 {
+	/*! \brief Boxes of points of the virtual grid inside sub (closed) and owned by the local sub-domains
+	 *
+	 * A point on the border between two sub-domains is owned by the sub-domain where it is at the low side, the
+	 * points on the high border of the domain are owned by the last sub-domain, so every point is created once
+	 *
+	 */
+	template<unsigned int dim, typename T, typename vd_type>
+	static void getLocalLattices(vd_type & vd,
+	                             size_t (& sz)[dim],
+	                             const Box<dim,T> & sub,
+	                             openfpm::vector<draw_particles_lattice<dim,T>> & lat)
+	{
+		const auto & dom = vd.getDecomposition().getDomain();
+		auto & subs = vd.getDecomposition().getSubDomains();
+
+		draw_particles_lattice<dim,T> l;
+		long int start[dim];
+		long int stop[dim];
+
+		for (size_t i = 0 ; i < dim ; i++)
+		{
+			l.low[i] = dom.getLow(i);
+			l.sp[i] = (dom.getHigh(i) - dom.getLow(i)) / (sz[i] - 1);
+
+			start[i] = std::ceil( (sub.getLow(i) - dom.getLow(i)) / l.sp[i]);
+			stop[i] = std::floor( (sub.getHigh(i) - dom.getLow(i)) / l.sp[i]);
+
+			start[i] = (start[i] < 0)?0:start[i];
+			stop[i] = (stop[i] > (long int)sz[i] - 1)?(long int)sz[i] - 1:stop[i];
+		}
+
+		lat.clear();
+
+		for (size_t s = 0 ; s < subs.size() ; s++)
+		{
+			bool empty = false;
+
+			for (size_t i = 0 ; i < dim ; i++)
+			{
+				T sl = subs.get(s).getLow(i);
+				T sh = subs.get(s).getHigh(i);
+
+				long int lo = std::ceil( (sl - dom.getLow(i)) / l.sp[i]);
+				long int hi = (sh >= dom.getHigh(i) - 1e-6*l.sp[i])?(long int)std::floor( (sh - dom.getLow(i)) / l.sp[i]):
+				                                                    (long int)std::ceil( (sh - dom.getLow(i)) / l.sp[i]) - 1;
+
+				lo = (lo < start[i])?start[i]:lo;
+				hi = (hi > stop[i])?stop[i]:hi;
+
+				if (hi < lo)
+				{
+					empty = true;
+					break;
+				}
+
+				l.lo[i] = lo;
+				l.ext[i] = hi - lo + 1;
+			}
+
+			if (empty == false)
+				lat.add(l);
+		}
+	}
+
+	/*! \brief Create the particles on the points of the boxes that pass the filter
+	 *
+	 * The points are counted in chunks (in parallel with OpenMP), the vector is resized once and every chunk
+	 * write its particles from the prefix sum of the counts (in parallel)
+	 *
+	 * \return the number of particles created
+	 *
+	 */
+	template<unsigned int dim, typename T, typename vd_type, typename filter_type>
+	static size_t fill(vd_type & vd, openfpm::vector<draw_particles_lattice<dim,T>> & lat, const filter_type & filter)
+	{
+		struct chunk
+		{
+			size_t box;
+			size_t start;
+			size_t stop;
+			size_t off;
+		};
+
+		std::vector<chunk> chunks;
+
+		for (size_t b = 0 ; b < lat.size() ; b++)
+		{
+			size_t n = lat.get(b).size();
+			for (size_t s = 0 ; s < n ; s += DRAW_PARTICLES_CHUNK)
+				chunks.push_back(chunk{b,s,(s + DRAW_PARTICLES_CHUNK < n)?s + DRAW_PARTICLES_CHUNK:n,0});
+		}
+
+		long int nc = chunks.size();
+
+#ifdef _OPENMP
+		#pragma omp parallel for schedule(dynamic,1)
+#endif
+		for (long int c = 0 ; c < nc ; c++)
+		{
+			const draw_particles_lattice<dim,T> & l = lat.get(chunks[c].box);
+			T x[dim];
+
+			size_t cnt = 0;
+			for (size_t i = chunks[c].start ; i < chunks[c].stop ; i++)
+			{
+				l.getPoint(i,x);
+				cnt += filter(x);
+			}
+
+			chunks[c].off = cnt;
+		}
+
+		size_t tot = 0;
+		for (long int c = 0 ; c < nc ; c++)
+		{
+			size_t cnt = chunks[c].off;
+			chunks[c].off = tot;
+			tot += cnt;
+		}
+
+		size_t first = vd.size_local();
+		vd.resizeAtEnd(first + tot);
+
+#ifdef _OPENMP
+		#pragma omp parallel for schedule(dynamic,1)
+#endif
+		for (long int c = 0 ; c < nc ; c++)
+		{
+			const draw_particles_lattice<dim,T> & l = lat.get(chunks[c].box);
+			T x[dim];
+
+			vect_dist_key_dx key;
+			size_t p = first + chunks[c].off;
+
+			for (size_t i = chunks[c].start ; i < chunks[c].stop ; i++)
+			{
+				l.getPoint(i,x);
+				if (filter(x) == false)
+					continue;
+
+				key.setKey(p);
+				for (size_t j = 0 ; j < dim ; j++)
+					vd.getPos(key)[j] = x[j];
+
+				p++;
+			}
+		}
+
+		return tot;
+	}
+
+	//! Pack the boxes A as low and high corners for draw_particles_skin_filter
+	template<unsigned int dim, typename T>
+	static void packBoxA(openfpm::vector<Box<dim,T>> & sub_A, openfpm::vector<T> & boxA)
+	{
+		boxA.resize(2*dim*sub_A.size());
+
+		for (size_t b = 0 ; b < sub_A.size() ; b++)
+		{
+			for (size_t i = 0 ; i < dim ; i++)
+			{
+				boxA.get(2*dim*b + i) = sub_A.get(b).getLow(i);
+				boxA.get(2*dim*b + dim + i) = sub_A.get(b).getHigh(i);
+			}
+		}
+	}
+
+#ifdef __NVCC__
+
+	//! Create the particles on the points of the boxes that pass the filter, the positions are written on the device
+	template<unsigned int dim, typename T, typename vd_type, typename filter_type>
+	static size_t fill_gpu(vd_type & vd, openfpm::vector<draw_particles_lattice<dim,T>> & lat, const filter_type & filter)
+	{
+		auto & v_cl = create_vcluster<CudaMemory>();
+
+		openfpm::vector<openfpm::vector_custd<unsigned int>> flag(lat.size());
+		openfpm::vector<openfpm::vector_custd<unsigned int>> off(lat.size());
+		openfpm::vector<size_t> box_off(lat.size());
+
+		size_t tot = 0;
+
+		for (size_t b = 0 ; b < lat.size() ; b++)
+		{
+			size_t n = lat.get(b).size();
+
+			flag.get(b).resize(n+1);
+			off.get(b).resize(n+1);
+
+			// the last entry is zero, so the exclusive scan leaves the count in off[n]
+			cudaMemsetAsync((unsigned int *)flag.get(b).template getDeviceBuffer<0>(),0,(n+1)*sizeof(unsigned int));
+
+			auto ite = flag.get(b).getGPUIterator();
+			CUDA_LAUNCH((draw_particles_count_gpu<dim,T,filter_type>),ite,lat.get(b),filter,(unsigned int *)flag.get(b).template getDeviceBuffer<0>());
+
+			openfpm::scan((unsigned int *)flag.get(b).template getDeviceBuffer<0>(), n+1,
+			              (unsigned int *)off.get(b).template getDeviceBuffer<0>(), v_cl.getGpuContext());
+
+			off.get(b).template deviceToHost<0>(n,n);
+
+			box_off.get(b) = tot;
+			tot += off.get(b).get(n);
+		}
+
+		size_t first = vd.size_local();
+		vd.resizeAtEnd(first + tot);
+
+		for (size_t b = 0 ; b < lat.size() ; b++)
+		{
+			auto ite = flag.get(b).getGPUIterator();
+			CUDA_LAUNCH((draw_particles_fill_gpu<dim,T>),ite,vd.toKernel(),lat.get(b),filter,
+			            (const unsigned int *)off.get(b).template getDeviceBuffer<0>(),(unsigned int)(first + box_off.get(b)));
+		}
+
+		return tot;
+	}
+
+#endif
+
 public:
 
 	/*! \brief Draw particles in a box B excluding the area of a second box A (B - A)
@@ -128,6 +467,126 @@ public:
 		return PointIterator<dim,T,typename vd_type::Decomposition_type>(vd.getDecomposition(),sz,vd.getDecomposition().getDomain(),sub);
 	}
 
+	/*! \brief Create the particles of DrawBox directly in vd
+	 *
+	 * It create the same points of DrawBox without iterating: every processor compute the points owned by its
+	 * sub-domains, resize vd once and fill the positions in parallel (OpenMP). The particles are added at the end of the
+	 * local particles, from the index vd.size_local() before the call, the properties are not initialized. As with add()
+	 * the ghost is invalidated.
+	 *
+	 * \snippet Draw/DrawParticles_unit_tests.hpp FillBox_example
+	 *
+	 * \param vd particles where we are creating the particles
+	 * \param sz indicate the grid size of the virtual grid.
+	 * \param domain Domain where the virtual grid is defined (Must match the domain of vd)
+	 * \param sub box contained in domain where the particles are created
+	 *
+	 * \return the number of particles created on this processor
+	 *
+	 */
+	template<unsigned int dim, typename T, typename vd_type> static size_t
+	FillBox(vd_type & vd,
+	        size_t (& sz)[dim],
+	        Box<dim,T> & domain,
+	        Box<dim,T> & sub)
+	{
+		openfpm::vector<draw_particles_lattice<dim,T>> lat;
+		getLocalLattices(vd,sz,sub,lat);
+
+		return fill(vd,lat,draw_particles_keep_all<dim,T>());
+	}
+
+	/*! \brief Create the particles of DrawSkin directly in vd
+	 *
+	 * Same as FillBox for the points in B that are not inside any of the boxes A
+	 *
+	 * \param vd particles where we are creating the particles
+	 * \param sz indicate the grid size of the virtual grid.
+	 * \param domain Domain where the virtual grid is defined (Must match the domain of vd)
+	 * \param sub_A array of boxes where the particles are not created
+	 * \param sub_B box contained in domain where the particles are created
+	 *
+	 * \return the number of particles created on this processor
+	 *
+	 */
+	template<unsigned int dim, typename T, typename vd_type> static size_t
+	FillSkin(vd_type & vd,
+	         size_t (& sz)[dim],
+	         Box<dim,T> & domain,
+	         openfpm::vector<Box<dim,T>> & sub_A,
+	         Box<dim,T> & sub_B)
+	{
+		openfpm::vector<draw_particles_lattice<dim,T>> lat;
+		getLocalLattices(vd,sz,sub_B,lat);
+
+		openfpm::vector<T> boxA;
+		packBoxA(sub_A,boxA);
+
+		draw_particles_skin_filter<dim,T> filter;
+		filter.boxA = (boxA.size() != 0)?&boxA.get(0):NULL;
+		filter.nA = sub_A.size();
+
+		return fill(vd,lat,filter);
+	}
+
+#ifdef __NVCC__
+
+	/*! \brief Create the particles of DrawBox directly in vd, on the device
+	 *
+	 * As FillBox, but the points are counted and the positions written by CUDA kernels: only the number of points of
+	 * every box is copied to the host. The positions on the host are not updated, call vd.map(RUN_ON_DEVICE) (or
+	 * deviceToHostPos) after the call.
+	 *
+	 * \return the number of particles created on this processor
+	 *
+	 */
+	template<unsigned int dim, typename T, typename vd_type> static size_t
+	FillBoxGPU(vd_type & vd,
+	           size_t (& sz)[dim],
+	           Box<dim,T> & domain,
+	           Box<dim,T> & sub)
+	{
+		openfpm::vector<draw_particles_lattice<dim,T>> lat;
+		getLocalLattices(vd,sz,sub,lat);
+
+		return fill_gpu(vd,lat,draw_particles_keep_all<dim,T>());
+	}
+
+	/*! \brief Create the particles of DrawSkin directly in vd, on the device
+	 *
+	 * As FillSkin with the kernels of FillBoxGPU
+	 *
+	 * \return the number of particles created on this processor
+	 *
+	 */
+	template<unsigned int dim, typename T, typename vd_type> static size_t
+	FillSkinGPU(vd_type & vd,
+	            size_t (& sz)[dim],
+	            Box<dim,T> & domain,
+	            openfpm::vector<Box<dim,T>> & sub_A,
+	            Box<dim,T> & sub_B)
+	{
+		openfpm::vector<draw_particles_lattice<dim,T>> lat;
+		getLocalLattices(vd,sz,sub_B,lat);
+
+		openfpm::vector<T> boxA;
+		packBoxA(sub_A,boxA);
+
+		openfpm::vector_custd<T> boxA_dev;
+		boxA_dev.resize(boxA.size());
+		for (size_t i = 0 ; i < boxA.size() ; i++)
+			boxA_dev.get(i) = boxA.get(i);
+		boxA_dev.template hostToDevice<0>();
+
+		draw_particles_skin_filter<dim,T> filter;
+		filter.boxA = (const T *)boxA_dev.template getDeviceBuffer<0>();
+		filter.nA = sub_A.size();
+
+		return fill_gpu(vd,lat,filter);
+	}
+
+#endif
+
 };
 
 
@@ -123,6 +123,102 @@ BOOST_AUTO_TEST_CASE(point_iterator_skin)
 	BOOST_REQUIRE_EQUAL(good,true);
 }
 
+BOOST_AUTO_TEST_CASE(fill_box_and_skin)
+{
+	size_t sz[] = {23,27,20};
+
+	Box<3,double> domain({-1.2,0.5,-0.6},{1.0,3.1,1.3});
+	Box<3,double> sub_domain({-0.15,0.75,0.15},{1.05,1.15,1.05});
+
+	size_t sz_sub[] = {12,4,9};
+
+	// Boundary conditions
+	size_t bc[3]={NON_PERIODIC,NON_PERIODIC,NON_PERIODIC};
+
+	// ghost, big enough to contain the interaction radius
+	Ghost<3,double> ghost(0.01);
+
+	vector_dist<3,double,aggregate<double>> vd(0,domain,bc,ghost);
+
+	//! [FillBox_example]
+
+	size_t n = DrawParticles::FillBox(vd,sz,domain,sub_domain);
+
+	//! [FillBox_example]
+
+	BOOST_REQUIRE_EQUAL(n,vd.size_local());
+
+	// every particle is on the grid of DrawBox and inside this processor
+	bool good = true;
+	auto it = vd.getDomainIterator();
+	while (it.isNext())
+	{
+		auto p = it.get();
+
+		Point<3,double> xp = vd.getPos(p);
+		good &= sub_domain.isInside(xp);
+
+		for (size_t i = 0 ; i < 3 ; i++)
+		{
+			double k = (xp.get(i) - domain.getLow(i)) / (domain.getHigh(i) - domain.getLow(i)) * (sz[i] - 1);
+			good &= fabs(k - std::round(k)) < 1e-8;
+		}
+
+		++it;
+	}
+
+	size_t cnt = vd.size_local();
+	vd.map();
+
+	Vcluster<> & v_cl = create_vcluster();
+
+	size_t cnt_map = vd.size_local();
+
+	v_cl.sum(cnt);
+	v_cl.sum(cnt_map);
+	v_cl.execute();
+
+	BOOST_REQUIRE_EQUAL(good,true);
+	BOOST_REQUIRE_EQUAL(cnt,sz_sub[0]*sz_sub[1]*sz_sub[2]);
+	BOOST_REQUIRE_EQUAL(cnt_map,cnt);
+
+	// the skin is the same set of DrawSkin
+	Box<3,double> sub_domainA({-0.15,0.75,0.15},{1.05,1.15,1.05});
+	Box<3,double> sub_domainB({-0.25,0.65,0.05},{0.95,1.05,1.05});
+
+	openfpm::vector<Box<3,double>> sub_A;
+	sub_A.add(sub_domainA);
+
+	vector_dist<3,double,aggregate<double>> vd2(0,domain,bc,ghost);
+
+	size_t cnt_skin = DrawParticles::FillSkin(vd2,sz,domain,sub_A,sub_domainB);
+
+	auto p = DrawParticles::DrawSkin(vd2,sz,domain,sub_domainA,sub_domainB);
+
+	size_t cnt_it = 0;
+	while (p.isNext())
+	{
+		cnt_it++;
+		++p;
+	}
+
+	for (size_t i = 0 ; i < vd2.size_local() ; i++)
+	{
+		vect_dist_key_dx key;
+		key.setKey(i);
+
+		Point<3,double> xp = vd2.getPos(key);
+		good &= sub_domainB.isInside(xp) && !sub_domainA.isInside(xp);
+	}
+
+	v_cl.sum(cnt_skin);
+	v_cl.sum(cnt_it);
+	v_cl.execute();
+
+	BOOST_REQUIRE_EQUAL(good,true);
+	BOOST_REQUIRE_EQUAL(cnt_skin,cnt_it);
+}
+
 BOOST_AUTO_TEST_SUITE_END()
 
 #endif /* OPENFPM_NUMERICS_SRC_DRAW_DRAWPARTICLES_UNIT_TESTS_HPP_ */
@@ -14,6 +14,7 @@
 #include "Grid/comb.hpp"
 #include "FiniteDifference/util/common.hpp"
 #include "util/util_num.hpp"
+#include "FiniteDifference/util/stencil_table.hpp"
 
 /*! \brief Average
  *
@@ -103,6 +104,32 @@ class Avg<d,arg,Sys_eqs,CENTRAL>
 		kmap.getKeyRef().set_d(d,old_val);
 	}
 
+	/*! \brief Add the entries of the average to the flattened stencil
+	 *
+	 * \param off offset from the row point
+	 * \param spacing grid spacing
+	 * \param tab stencil table
+	 * \param coeff coefficient
+	 *
+	 */
+	inline static void stencil(grid_key_dx<Sys_eqs::dims> & off,
+			                   typename Sys_eqs::stype (& spacing )[Sys_eqs::dims],
+							   fd_stencil_table<Sys_eqs::dims,typename Sys_eqs::stype> & tab,
+							   typename Sys_eqs::stype coeff)
+	{
+		if (is_grid_staggered<Sys_eqs>::value())
+		{
+			Avg<d,arg,Sys_eqs,BACKWARD>::stencil(off,spacing,tab,coeff);
+			return;
+		}
+
+		off.set_d(d,off.get(d) + 1);
+		arg::stencil(off,spacing,tab,coeff/2);
+		off.set_d(d,off.get(d) - 2);
+		arg::stencil(off,spacing,tab,coeff/2);
+		off.set_d(d,off.get(d) + 1);
+	}
+
 
 	/*! \brief Calculate the position where the average is calculated
 	 *
@@ -177,6 +204,25 @@ class Avg<d,arg,Sys_eqs,FORWARD>
 		arg::value(g_map,kmap,gs,spacing,cols,coeff/2);
 	}
 
+	/*! \brief Add the entries of the average to the flattened stencil
+	 *
+	 * \param off offset from the row point
+	 * \param spacing grid spacing
+	 * \param tab stencil table
+	 * \param coeff coefficient
+	 *
+	 */
+	inline static void stencil(grid_key_dx<Sys_eqs::dims> & off,
+			                   typename Sys_eqs::stype (& spacing )[Sys_eqs::dims],
+							   fd_stencil_table<Sys_eqs::dims,typename Sys_eqs::stype> & tab,
+							   typename Sys_eqs::stype coeff)
+	{
+		off.set_d(d,off.get(d) + 1);
+		arg::stencil(off,spacing,tab,coeff/2);
+		off.set_d(d,off.get(d) - 1);
+		arg::stencil(off,spacing,tab,coeff/2);
+	}
+
 
 	/*! \brief Calculate the position in the cell where the average is calculated
 	 *
@@ -236,6 +282,25 @@ class Avg<d,arg,Sys_eqs,BACKWARD>
 		arg::value(g_map,kmap,gs,spacing,cols,coeff/2);
 	}
 
+	/*! \brief Add the entries of the average to the flattened stencil
+	 *
+	 * \param off offset from the row point
+	 * \param spacing grid spacing
+	 * \param tab stencil table
+	 * \param coeff coefficient
+	 *
+	 */
+	inline static void stencil(grid_key_dx<Sys_eqs::dims> & off,
+			                   typename Sys_eqs::stype (& spacing )[Sys_eqs::dims],
+							   fd_stencil_table<Sys_eqs::dims,typename Sys_eqs::stype> & tab,
+							   typename Sys_eqs::stype coeff)
+	{
+		off.set_d(d,off.get(d) - 1);
+		arg::stencil(off,spacing,tab,coeff/2);
+		off.set_d(d,off.get(d) + 1);
+		arg::stencil(off,spacing,tab,coeff/2);
+	}
+
 
 	/*! \brief Calculate the position in the cell where the average is calculated
 	 *
@@ -253,4 +318,14 @@ class Avg<d,arg,Sys_eqs,BACKWARD>
 	}
 };
 
+//! The CENTRAL, FORWARD and BACKWARD average can be flattened if their argument can
+template<unsigned int d, typename arg, typename Sys_eqs>
+struct is_stencil_expr<Avg<d,arg,Sys_eqs,CENTRAL>>: is_stencil_expr<arg> {};
+
+template<unsigned int d, typename arg, typename Sys_eqs>
+struct is_stencil_expr<Avg<d,arg,Sys_eqs,FORWARD>>: is_stencil_expr<arg> {};
+
+template<unsigned int d, typename arg, typename Sys_eqs>
+struct is_stencil_expr<Avg<d,arg,Sys_eqs,BACKWARD>>: is_stencil_expr<arg> {};
+
 #endif /* OPENFPM_NUMERICS_SRC_FINITEDIFFERENCE_AVERAGE_HPP_ */
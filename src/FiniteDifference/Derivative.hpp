@@ -16,6 +16,7 @@
 #include "util/util_num.hpp"
 #include <unordered_map>
 #include "FD_util_include.hpp"
+#include "FiniteDifference/util/stencil_table.hpp"
 
 /*! \brief Derivative second order on h (spacing)
  *
@@ -121,6 +122,32 @@ class D<d,arg,Sys_eqs,CENTRAL>
 		kmap.getKeyRef().set_d(d,old_val);
 	}
 
+	/*! \brief Add the entries of the derivative to the flattened stencil
+	 *
+	 * \param off offset from the row point
+	 * \param spacing grid spacing
+	 * \param tab stencil table
+	 * \param coeff coefficient
+	 *
+	 */
+	inline static void stencil(grid_key_dx<Sys_eqs::dims> & off,
+			                   typename Sys_eqs::stype (& spacing )[Sys_eqs::dims],
+							   fd_stencil_table<Sys_eqs::dims,typename Sys_eqs::stype> & tab,
+							   typename Sys_eqs::stype coeff)
+	{
+		if (is_grid_staggered<Sys_eqs>::value())
+		{
+			D<d,arg,Sys_eqs,BACKWARD>::stencil(off,spacing,tab,coeff);
+			return;
+		}
+
+		off.set_d(d,off.get(d) + 1);
+		arg::stencil(off,spacing,tab,coeff/spacing[d]/2.0);
+		off.set_d(d,off.get(d) - 2);
+		arg::stencil(off,spacing,tab,-coeff/spacing[d]/2.0);
+		off.set_d(d,off.get(d) + 1);
+	}
+
 
 	/*! \brief Calculate the position where the derivative is calculated
 	 *
@@ -360,6 +387,25 @@ class D<d,arg,Sys_eqs,FORWARD>
 		arg::value(g_map,kmap,gs,spacing,cols,-coeff/spacing[d]);
 	}
 
+	/*! \brief Add the entries of the derivative to the flattened stencil
+	 *
+	 * \param off offset from the row point
+	 * \param spacing grid spacing
+	 * \param tab stencil table
+	 * \param coeff coefficient
+	 *
+	 */
+	inline static void stencil(grid_key_dx<Sys_eqs::dims> & off,
+			                   typename Sys_eqs::stype (& spacing )[Sys_eqs::dims],
+							   fd_stencil_table<Sys_eqs::dims,typename Sys_eqs::stype> & tab,
+							   typename Sys_eqs::stype coeff)
+	{
+		off.set_d(d,off.get(d) + 1);
+		arg::stencil(off,spacing,tab,coeff/spacing[d]);
+		off.set_d(d,off.get(d) - 1);
+		arg::stencil(off,spacing,tab,-coeff/spacing[d]);
+	}
+
 
 	/*! \brief Calculate the position where the derivative is calculated
 	 *
@@ -427,6 +473,25 @@ class D<d,arg,Sys_eqs,BACKWARD>
 		arg::value(g_map,kmap,gs,spacing,cols,coeff/spacing[d]);
 	}
 
+	/*! \brief Add the entries of the derivative to the flattened stencil
+	 *
+	 * \param off offset from the row point
+	 * \param spacing grid spacing
+	 * \param tab stencil table
+	 * \param coeff coefficient
+	 *
+	 */
+	inline static void stencil(grid_key_dx<Sys_eqs::dims> & off,
+			                   typename Sys_eqs::stype (& spacing )[Sys_eqs::dims],
+							   fd_stencil_table<Sys_eqs::dims,typename Sys_eqs::stype> & tab,
+							   typename Sys_eqs::stype coeff)
+	{
+		off.set_d(d,off.get(d) - 1);
+		arg::stencil(off,spacing,tab,-coeff/spacing[d]);
+		off.set_d(d,off.get(d) + 1);
+		arg::stencil(off,spacing,tab,coeff/spacing[d]);
+	}
+
 
 	/*! \brief Calculate the position where the derivative is calculated
 	 *
@@ -446,4 +511,14 @@ class D<d,arg,Sys_eqs,BACKWARD>
 	}
 };
 
+//! The CENTRAL, FORWARD and BACKWARD derivatives can be flattened if their argument can
+template<unsigned int d, typename arg, typename Sys_eqs>
+struct is_stencil_expr<D<d,arg,Sys_eqs,CENTRAL>>: is_stencil_expr<arg> {};
+
+template<unsigned int d, typename arg, typename Sys_eqs>
+struct is_stencil_expr<D<d,arg,Sys_eqs,FORWARD>>: is_stencil_expr<arg> {};
+
+template<unsigned int d, typename arg, typename Sys_eqs>
+struct is_stencil_expr<D<d,arg,Sys_eqs,BACKWARD>>: is_stencil_expr<arg> {};
+
 #endif /* OPENFPM_NUMERICS_SRC_FINITEDIFFERENCE_DERIVATIVE_HPP_ */
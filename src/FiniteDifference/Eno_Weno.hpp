@@ -10,9 +10,10 @@
 #ifndef __ENO_WENO_HPP__
 #define __ENO_WENO_HPP__
 
+#include <cmath>
 #include "Grid/grid_dist_id.hpp"
 
-static double adjustWeights(double v1, double v2, double v3, double v4, double v5)
+__device__ __host__ static inline double adjustWeights(double v1, double v2, double v3, double v4, double v5)
 {
 	double phix1, phix2, phix3;
 	double s1, s2, s3;
@@ -151,5 +152,249 @@ double ENO_3_Minus(grid_type & grid, key_type key, size_t x)
 	return (q1x + q2x + q3x);
 }
 
-#endif
+/*! \brief WENO 5 derivative of one side, from its five differences v1 ... v5
+ *
+ * Same as adjustWeights, but the second differences dd1 = v1 - 2 v2 + v3, dd2 = v2 - 2 v3 + v4 and
+ * dd3 = v3 - 2 v4 + v5 of the smoothness indicators are given: the plus and the minus side share two of them
+ *
+ * \tparam wenoz use the WENO-Z weights (Borges et al. 2008) instead of the classic (Jiang-Shu) ones
+ *
+ */
+template<bool wenoz>
+__device__ __host__ static inline double WENO_5_side(double v1, double v2, double v3, double v4, double v5,
+                                                     double dd1, double dd2, double dd3)
+{
+	// Eqs. (3.25), (3.26), (3.27)
+	double phix1 = (v1 / 3.0) - (7.0 * v2 / 6.0) + (11.0 * v3 / 6.0);
+	double phix2 = -(v2 / 6.0) + (5.0 * v3 / 6.0) + (v4 / 3.0);
+	double phix3 = (v3 / 3.0) + (5.0 * v4 / 6.0) - (v5 / 6.0);
+
+	// Eqs. (3.32), (3.33), (3.34)
+	double s1 = (13.0 / 12.0) * dd1 * dd1 + 0.25 * (v1 - 4*v2 + 3*v3) * (v1 - 4*v2 + 3*v3);
+	double s2 = (13.0 / 12.0) * dd2 * dd2 + 0.25 * (v2 - v4) * (v2 - v4);
+	double s3 = (13.0 / 12.0) * dd3 * dd3 + 0.25 * (3*v3 - 4*v4 + v5) * (3*v3 - 4*v4 + v5);
+
+	double a1, a2, a3;
+
+	if (wenoz == true)
+	{
+		// the global smoothness indicator tau5 = |s1 - s3| raise the weights of the smooth sub-stencils
+		double eps = 1e-40;
+		double tau5 = fabs(s1 - s3);
+		double r1 = tau5 / (s1 + eps);
+		double r2 = tau5 / (s2 + eps);
+		double r3 = tau5 / (s3 + eps);
+
+		a1 = 0.1 * (1.0 + r1*r1);
+		a2 = 0.6 * (1.0 + r2*r2);
+		a3 = 0.3 * (1.0 + r3*r3);
+	}
+	else
+	{
+		// Eqs. (3.35), (3.36), (3.37)
+		double eps = 1e-6;
+		a1 = 0.1 / ((s1 + eps)*(s1 + eps));
+		a2 = 0.6 / ((s2 + eps)*(s2 + eps));
+		a3 = 0.3 / ((s3 + eps)*(s3 + eps));
+	}
+
+	// Eqs. (3.39), (3.40), (3.41)
+	double w1 = a1 / (a1 + a2 + a3);
+	double w2 = a2 / (a1 + a2 + a3);
+	double w3 = a3 / (a1 + a2 + a3);
+
+	// Eq. (3.28)
+	return (w1 * phix1 + w2 * phix2 + w3 * phix3);
+}
+
+/*! \brief WENO 5 plus and minus derivatives of one point
+ *
+ * The six differences and the four second differences of the 7 point window are computed once and shared by the
+ * two sides
+ *
+ * \tparam wenoz use the WENO-Z weights instead of the classic ones
+ *
+ * \param p values around the point, p[0] is the point and p[-3] ... p[3] must be valid
+ * \param h grid spacing
+ * \param dplus output WENO 5 plus derivative
+ * \param dminus output WENO 5 minus derivative
+ *
+ */
+template<typename T, bool wenoz = false>
+__device__ __host__ inline void WENO_5_point(const T * p, double h, T & dplus, T & dminus)
+{
+	double coeff = 1.0 / h;
+
+	double c1 = (p[-2] - p[-3]) * coeff;
+	double c2 = (p[-1] - p[-2]) * coeff;
+	double c3 = (p[0] - p[-1]) * coeff;
+	double c4 = (p[1] - p[0]) * coeff;
+	double c5 = (p[2] - p[1]) * coeff;
+	double c6 = (p[3] - p[2]) * coeff;
+
+	double dd123 = c1 - 2*c2 + c3;
+	double dd234 = c2 - 2*c3 + c4;
+	double dd345 = c3 - 2*c4 + c5;
+	double dd456 = c4 - 2*c5 + c6;
+
+	dplus = WENO_5_side<wenoz>(c6, c5, c4, c3, c2, dd456, dd345, dd234);
+	dminus = WENO_5_side<wenoz>(c1, c2, c3, c4, c5, dd123, dd234, dd345);
+}
+
+/*! \brief ENO 3 plus and minus derivatives of one point
+ *
+ * Same as ENO_3_Plus and ENO_3_Minus, the stencil choices are done with selections instead of branches, so that
+ * loops over the points can be vectorized
+ *
+ * \param p values around the point, p[0] is the point and p[-3] ... p[3] must be valid
+ * \param h grid spacing
+ * \param dplus output ENO 3 plus derivative
+ * \param dminus output ENO 3 minus derivative
+ *
+ */
+template<typename T>
+__device__ __host__ inline void ENO_3_point(const T * p, double h, T & dplus, T & dminus)
+{
+	double coeff = 1.0 / h;
+
+	// second differences centered in i-1, i, i+1
+	double d2im1x = (p[0] - 2*p[-1] + p[-2]) * 0.5 * coeff * coeff;
+	double d2ix = (p[1] - 2*p[0] + p[-1]) * 0.5 * coeff * coeff;
+	double d2ip1x = (p[2] - 2*p[1] + p[0]) * 0.5 * coeff * coeff;
+
+	// third differences centered in i-3/2, i-1/2, i+1/2, i+3/2
+	double d3m3hx = (p[0] - 3*p[-1] + 3*p[-2] - p[-3]) * coeff * coeff * coeff / 6.0;
+	double d3m1hx = (p[1] - 3*p[0] + 3*p[-1] - p[-2]) * coeff * coeff * coeff / 6.0;
+	double d3p1hx = (p[2] - 3*p[1] + 3*p[0] - p[-1]) * coeff * coeff * coeff / 6.0;
+	double d3p3hx = (p[3] - 3*p[2] + 3*p[1] - p[0]) * coeff * coeff * coeff / 6.0;
 
+	// plus
+	bool left = fabs(d2ix) <= fabs(d2ip1x);
+	double q2x = (left)?(-d2ix * h):(-d2ip1x * h);
+	double q3x_l = (fabs(d3m1hx) <= fabs(d3p1hx))?d3m1hx:d3p1hx;
+	double q3x_r = (fabs(d3p1hx) <= fabs(d3p3hx))?d3p1hx:d3p3hx;
+	double q3x = (left)?(-q3x_l * h * h):(q3x_r * 2 * h * h);
+
+	dplus = (p[1] - p[0]) * coeff + q2x + q3x;
+
+	// minus
+	left = fabs(d2im1x) <= fabs(d2ix);
+	q2x = (left)?(d2im1x * h):(d2ix * h);
+	q3x_l = (fabs(d3m3hx) <= fabs(d3m1hx))?d3m3hx:d3m1hx;
+	q3x_r = (fabs(d3m1hx) <= fabs(d3p1hx))?d3m1hx:d3p1hx;
+	q3x = (left)?(q3x_l * 2 * h * h):(-q3x_r * h * h);
+
+	dminus = (p[0] - p[-1]) * coeff + q2x + q3x;
+}
+
+/*! \brief Forward and backward first order differences of one point
+ *
+ * \param p values around the point, p[0] is the point and p[-1] ... p[1] must be valid
+ * \param h grid spacing
+ * \param dplus output forward difference
+ * \param dminus output backward difference
+ *
+ */
+template<typename T>
+__device__ __host__ inline void FD_1_point(const T * p, double h, T & dplus, T & dminus)
+{
+	dplus = (p[1] - p[0]) / h;
+	dminus = (p[0] - p[-1]) / h;
+}
+
+/*! \brief WENO 5 plus and minus derivatives of all the points of a line
+ *
+ * Same as WENO_5_Plus and WENO_5_Minus, but the values of the field along the line are already gathered in a
+ * contiguous buffer, so that the loop over the points has no grid access and can be vectorized
+ *
+ * \tparam wenoz use the WENO-Z weights instead of the classic ones
+ *
+ * \param phi values of the line, phi[3] is the first point and 3 neighbors are required on each side (n+6 values)
+ * \param n number of points
+ * \param h grid spacing in the direction of the line
+ * \param dplus output WENO 5 plus derivatives (n values)
+ * \param dminus output WENO 5 minus derivatives (n values)
+ *
+ */
+template<typename T, bool wenoz = false>
+void WENO_5_line(const T * phi, size_t n, double h, T * dplus, T * dminus)
+{
+	#pragma omp simd
+	for (size_t i = 0 ; i < n ; i++)
+	{WENO_5_point<T,wenoz>(phi + i + 3, h, dplus[i], dminus[i]);}
+}
+
+/*! \brief ENO 3 plus and minus derivatives of all the points of a line
+ *
+ * \param phi values of the line, phi[3] is the first point and 3 neighbors are required on each side (n+6 values)
+ * \param n number of points
+ * \param h grid spacing in the direction of the line
+ * \param dplus output ENO 3 plus derivatives (n values)
+ * \param dminus output ENO 3 minus derivatives (n values)
+ *
+ */
+template<typename T>
+void ENO_3_line(const T * phi, size_t n, double h, T * dplus, T * dminus)
+{
+	#pragma omp simd
+	for (size_t i = 0 ; i < n ; i++)
+	{ENO_3_point(phi + i + 3, h, dplus[i], dminus[i]);}
+}
+
+/*! \brief Forward and backward first order differences of all the points of a line
+ *
+ * \param phi values of the line, phi[3] is the first point and 3 neighbors are required on each side (n+6 values)
+ * \param n number of points
+ * \param h grid spacing in the direction of the line
+ * \param dplus output forward differences (n values)
+ * \param dminus output backward differences (n values)
+ *
+ */
+template<typename T>
+void FD_1_line(const T * phi, size_t n, double h, T * dplus, T * dminus)
+{
+	#pragma omp simd
+	for (size_t i = 0 ; i < n ; i++)
+	{FD_1_point(phi + i + 3, h, dplus[i], dminus[i]);}
+}
+
+/*! \brief Gather the 7 values around key in direction x
+ *
+ * \param p output, p[3] is the value in key
+ *
+ */
+template<size_t Field, typename grid_type, typename key_type, typename T>
+inline void gather_7_point(grid_type & grid, key_type key, size_t x, T (& p)[7])
+{
+	for (int k = -3 ; k <= 3 ; k++)
+	{p[k+3] = grid.template get<Field>(key.move(x,k));}
+}
+
+/*! \brief WENO 5 plus and minus derivatives in key, the same as WENO_5_Plus and WENO_5_Minus, but the grid
+ * values, the differences and the shared parts of the smoothness indicators are evaluated once
+ *
+ * \tparam wenoz use the WENO-Z weights instead of the classic ones
+ *
+ */
+template<size_t Field, bool wenoz = false, typename grid_type, typename key_type, typename T>
+void WENO_5_PlusMinus(grid_type & grid, key_type key, size_t x, T & dplus, T & dminus)
+{
+	T p[7];
+	gather_7_point<Field>(grid,key,x,p);
+
+	WENO_5_point<T,wenoz>(p + 3, grid.spacing(x), dplus, dminus);
+}
+
+/*! \brief ENO 3 plus and minus derivatives in key, the grid values are read once
+ *
+ */
+template<size_t Field, typename grid_type, typename key_type, typename T>
+void ENO_3_PlusMinus(grid_type & grid, key_type key, size_t x, T & dplus, T & dminus)
+{
+	T p[7];
+	gather_7_point<Field>(grid,key,x,p);
+
+	ENO_3_point(p + 3, grid.spacing(x), dplus, dminus);
+}
+
+#endif
@@ -18,6 +18,8 @@
 #include "Grid/grid_dist_id.hpp"
 #include "Vector/Vector_util.hpp"
 #include "Grid/staggered_dist_grid.hpp"
+#include "util/trace_span.hpp"
+#include "util/memory_report.hpp"
 
 
 /*! \brief Finite Differences
@@ -231,6 +233,9 @@ private:
 	//! processor
 	size_t s_pnt;
 
+	//! flattened stencil of the expression being imposed
+	fd_stencil_table<Sys_eqs::dims,typename Sys_eqs::stype> stencil_tab;
+
 	/*! \brief Equation id + space position
 	 *
 	 */
@@ -273,6 +278,120 @@ private:
 		return ke;
 	}
 
+	/*! \brief Flatten the expression in the stencil table
+	 *
+	 * \return true, the rows are stamped from the table
+	 *
+	 */
+	template<typename T> bool flatten_stencil(std::true_type)
+	{
+		stencil_tab.clear();
+
+		grid_key_dx<Sys_eqs::dims> off;
+		off.zero();
+		T::stencil(off,spacing,stencil_tab,1.0);
+
+		return true;
+	}
+
+	/*! \brief The expression depend on the position of the row (one-sided derivatives at the boundary)
+	 *
+	 * \return false, the rows are calculated walking the expression
+	 *
+	 */
+	template<typename T> bool flatten_stencil(std::false_type)
+	{
+		return false;
+	}
+
+	/*! \brief Add the row of the point key to the triplets
+	 *
+	 * \param trpl triplets
+	 * \param key point (in g_map)
+	 * \param id equation id
+	 * \param gs grid info of the mapping grid
+	 * \param cols buffer for the non-zero colums
+	 * \param use_tab stamp the row from the stencil table (see flatten_stencil)
+	 *
+	 */
+	template<typename T, typename key_type, typename cols_type>
+	void fill_row(openfpm::vector<triplet> & trpl,
+			      key_type & key,
+				  long int id,
+				  const grid_sm<Sys_eqs::dims,void> & gs,
+				  cols_type & cols,
+				  bool use_tab)
+	{
+		long int row_id = g_map.template get<0>(key)*Sys_eqs::nvar + id;
+
+		// indicate if the diagonal has been set
+		bool is_diag = false;
+
+		if (use_tab == true)
+		{
+			size_t start = trpl.size();
+
+			for (size_t i = 0 ; i < stencil_tab.size() ; i++)
+			{
+				auto & e = stencil_tab.e[i];
+
+				key_type kc = key;
+				for (size_t j = 0 ; j < Sys_eqs::dims ; j++)
+				{kc.getKeyRef().set_d(j,kc.getKeyRef().get(j) + e.off.get(j));}
+
+				long int col = g_map.template get<0>(kc)*Sys_eqs::nvar + e.var;
+
+				// on a periodic grid smaller than the stencil two offsets land on the same point
+				size_t k = start;
+				for ( ; k < trpl.size() ; k++)
+				{
+					if (trpl.get(k).col() == col)
+					{break;}
+				}
+
+				if (k != trpl.size())
+				{
+					trpl.get(k).value() += e.coeff;
+					continue;
+				}
+
+				trpl.add();
+				trpl.last().row() = row_id;
+				trpl.last().col() = col;
+				trpl.last().value() = e.coeff;
+
+				if (row_id == col)
+				{is_diag = true;}
+			}
+		}
+		else
+		{
+			// Calculate the non-zero colums
+			T::value(g_map,key,gs,spacing,cols,1.0);
+
+			// create the triplet
+			for ( auto it = cols.begin(); it != cols.end(); ++it )
+			{
+				trpl.add();
+				trpl.last().row() = row_id;
+				trpl.last().col() = it->first;
+				trpl.last().value() = it->second;
+
+				if (trpl.last().row() == trpl.last().col())
+				{is_diag = true;}
+			}
+		}
+
+		// If does not have a diagonal entry put it to zero
+		if (is_diag == false)
+		{
+			trpl.add();
+			trpl.last().row() = row_id;
+			trpl.last().col() = row_id;
+			trpl.last().value() = 0.0;
+		}
+	}
+
 	/*! \brief calculate the mapping grid size with padding
 	 *
 	 * \param sz original grid size
@@ -497,11 +616,16 @@ private:
 									 long int id ,
 									 const iterator & it_d)
 	{
+		NUMERICS_TRACE_SPAN("fd_scheme.impose");
+
 		openfpm::vector<triplet> & trpl = A.getMatrixTriplets();
 
 		auto it = it_d;
 		grid_sm<Sys_eqs::dims,void> gs = g_map.getGridInfoVoid();
 
+		// expressions made only of offsets are flattened once and stamped on every row
+		bool use_tab = flatten_stencil<T>(std::integral_constant<bool,is_stencil_expr<T>::value>());
+
 		std::unordered_map<long int,typename Sys_eqs::stype> cols;
 
 		// iterate all the grid points
@@ -514,33 +638,7 @@ private:
 			for (size_t i = 0 ; i < Sys_eqs::dims ; i++)
 				key.getKeyRef().set_d(i,key.getKeyRef().get(i) + pd.getLow(i));
 
-			// Calculate the non-zero colums
-			T::value(g_map,key,gs,spacing,cols,1.0);
-
-			// indicate if the diagonal has been set
-			bool is_diag = false;
-
-			// create the triplet
-			for ( auto it = cols.begin(); it != cols.end(); ++it )
-			{
-				trpl.add();
-				trpl.last().row() = g_map.template get<0>(key)*Sys_eqs::nvar + id;
-				trpl.last().col() = it->first;
-				trpl.last().value() = it->second;
-
-				if (trpl.last().row() == trpl.last().col())
-				{is_diag = true;}
-
-			}
-
-			// If does not have a diagonal entry put it to zero
-			if (is_diag == false)
-			{
-				trpl.add();
-				trpl.last().row() = g_map.template get<0>(key)*Sys_eqs::nvar + id;
-				trpl.last().col() = g_map.template get<0>(key)*Sys_eqs::nvar + id;
-				trpl.last().value() = 0.0;
-			}
+			fill_row<T>(trpl,key,id,gs,cols,use_tab);
 
 			b(g_map.template get<0>(key)*Sys_eqs::nvar + id) = num.get(key);
 
@@ -600,6 +698,7 @@ private:
 		}
 
 		// sync the ghost
+		NUMERICS_TRACE_SPAN("fd_scheme.ghost_get");
 		g_map.template ghost_get<0>();
 	}
 
@@ -855,10 +954,15 @@ public:
 									 long int id ,
 									 iterator & it)
 	{
+		NUMERICS_TRACE_SPAN("fd_scheme.impose");
+
 		openfpm::vector<triplet> & trpl = A.getMatrixTriplets();
 
 		grid_sm<Sys_eqs::dims,void> gs = g_map.getGridInfoVoid();
 
+		// expressions made only of offsets are flattened once and stamped on every row
+		bool use_tab = flatten_stencil<T>(std::integral_constant<bool,is_stencil_expr<T>::value>());
+
 		std::unordered_map<long int,float> cols;
 
 		// iterate all the grid points
@@ -867,34 +971,7 @@ public:
 			// get the position
 			auto key = it.get();
 
-			// Calculate the non-zero colums
-			T::value(g_map,key,gs,spacing,cols,1.0);
-
-			// indicate if the diagonal has been set
-			bool is_diag = false;
-
-			// create the triplet
-			for ( auto it = cols.begin(); it != cols.end(); ++it )
-			{
-				trpl.add();
-				trpl.last().row() = g_map.template get<0>(key)*Sys_eqs::nvar + id;
-				trpl.last().col() = it->first;
-				trpl.last().value() = it->second;
-
-				if (trpl.last().row() == trpl.last().col())
-					is_diag = true;
-
-//				std::cout << "(" << trpl.last().row() << "," << trpl.last().col() << "," << trpl.last().value() << ")" << "\n";
-			}
-
-			// If does not have a diagonal entry put it to zero
-			if (is_diag == false)
-			{
-				trpl.add();
-				trpl.last().row() = g_map.template get<0>(key)*Sys_eqs::nvar + id;
-				trpl.last().col() = g_map.template get<0>(key)*Sys_eqs::nvar + id;
-				trpl.last().value() = 0.0;
-			}
+			fill_row<T>(trpl,key,id,gs,cols,use_tab);
 
 			b(g_map.template get<0>(key)*Sys_eqs::nvar + id) = num.get(key);
 
@@ -932,6 +1009,8 @@ public:
 									 const iterator & it_d,
 									 bool skip_first = false)
 	{
+		NUMERICS_TRACE_SPAN("fd_scheme.impose");
+
 		openfpm::vector<triplet> & trpl = A.getMatrixTriplets();
 
 		auto start = it_d.getStart();
@@ -946,6 +1025,9 @@ public:
 
 		grid_sm<Sys_eqs::dims,void> gs = g_map.getGridInfoVoid();
 
+		// expressions made only of offsets are flattened once and stamped on every row
+		bool use_tab = flatten_stencil<T>(std::integral_constant<bool,is_stencil_expr<T>::value>());
+
 		std::unordered_map<long int,float> cols;
 
 		// iterate all the grid points
@@ -955,34 +1037,7 @@ public:
 			auto key = it.get();
 			auto keyg = itg.get();
 
-			// Calculate the non-zero colums
-			T::value(g_map,keyg,gs,spacing,cols,1.0);
-
-			// indicate if the diagonal has been set
-			bool is_diag = false;
-
-			// create the triplet
-			for ( auto it = cols.begin(); it != cols.end(); ++it )
-			{
-				trpl.add();
-				trpl.last().row() = g_map.template get<0>(keyg)*Sys_eqs::nvar + id;
-				trpl.last().col() = it->first;
-				trpl.last().value() = it->second;
-
-				if (trpl.last().row() == trpl.last().col())
-					is_diag = true;
-
-//				std::cout << "(" << trpl.last().row() << "," << trpl.last().col() << "," << trpl.last().value() << ")" << "\n";
-			}
-
-			// If does not have a diagonal entry put it to zero
-			if (is_diag == false)
-			{
-				trpl.add();
-				trpl.last().row() = g_map.template get<0>(keyg)*Sys_eqs::nvar + id;
-				trpl.last().col() = g_map.template get<0>(keyg)*Sys_eqs::nvar + id;
-				trpl.last().value() = 0.0;
-			}
+			fill_row<T>(trpl,keyg,id,gs,cols,use_tab);
 
 			b(g_map.template get<0>(keyg)*Sys_eqs::nvar + id) = num.get(key);
 
@@ -1035,6 +1090,8 @@ public:
 	 */
 	typename Sys_eqs::SparseMatrix_type & getA()
 	{
+		NUMERICS_TRACE_SPAN("fd_scheme.fill");
+
 #ifdef SE_CLASS1
 		consistency();
 #endif
@@ -1060,6 +1117,18 @@ public:
 		return b;
 	}
 
+	/*! \brief Memory used by the scheme in byte on this processor
+	 *
+	 * Matrix (triplets and assembled storage), b and the row map grid
+	 *
+	 * \return the memory in byte
+	 *
+	 */
+	size_t getMemoryUsage()
+	{
+		return A.getMemoryUsage() + b.getMemoryUsage() + pnt.size()*sizeof(size_t) + gridMemoryUsage(g_map);
+	}
+
 	/*! \brief Copy the vector into the grid
 	 *
 	 * ## Copy the solution into the grid
@@ -1078,6 +1147,8 @@ public:
 	template<unsigned int ... pos, typename Vct, typename Grid_dst>
 	void copy(Vct & v,const long int (& start)[Sys_eqs_typ::dims], const long int (& stop)[Sys_eqs_typ::dims], Grid_dst & g_dst)
 	{
+		NUMERICS_TRACE_SPAN("fd_scheme.copy");
+
 		if (is_grid_staggered<Sys_eqs>::value())
 		{
 			if (g_dst.is_staggered() == true)
@@ -1115,7 +1186,10 @@ public:
 				copy_staggered<Vct,decltype(stg),pos...>(v,stg,sr,st);
 
 				// sync the ghost and interpolate to the normal grid
-				stg.template ghost_get<pos...>();
+				{
+					NUMERICS_TRACE_SPAN("fd_scheme.ghost_get");
+					stg.template ghost_get<pos...>();
+				}
 				stg.template to_normal<Grid_dst,pos...>(g_dst,this->getPadding(),start,stop);
 			}
 		}
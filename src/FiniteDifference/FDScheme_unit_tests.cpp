@@ -583,6 +583,51 @@ BOOST_AUTO_TEST_CASE( sum_periodic)
 	//! [minus example]
 }
 
+BOOST_AUTO_TEST_CASE( stencil_table_flatten)
+{
+	// grid size
+	size_t sz[2]={16,16};
+
+	// spacing
+	float spacing[2] = {0.5,0.3};
+
+	// grid_sm
+	grid_sm<2,void> ginfo(sz);
+
+	// grid_dist_testing
+	grid_dist_testing<2> g_map(sz);
+
+	grid_dist_key_dx<2> key55(0,grid_key_dx<2>(5,5));
+
+	typedef sum<Lap<Field<V,sys_pp>,sys_pp>,minus<D<x,Field<V,sys_pp>,sys_pp>,sys_pp>,Field<V,sys_pp>,sys_pp> expr;
+
+	BOOST_REQUIRE_EQUAL(is_stencil_expr<expr>::value,true);
+	BOOST_REQUIRE_EQUAL((is_stencil_expr<D<x,Field<V,sys_pp>,sys_pp,CENTRAL_B_ONE_SIDE>>::value),false);
+
+	// the columns at the center are merged: Lap and the Field
+	fd_stencil_table<2,float> tab;
+	grid_key_dx<2> off;
+	off.zero();
+	expr::stencil(off,spacing,tab,1);
+
+	BOOST_REQUIRE_EQUAL(tab.size(),5ul);
+
+	// same row from the expression
+	std::unordered_map<long int,float> cols;
+	expr::value(g_map,key55,ginfo,spacing,cols,1);
+
+	BOOST_REQUIRE_EQUAL(cols.size(),tab.size());
+
+	for (size_t i = 0 ; i < tab.size() ; i++)
+	{
+		grid_dist_key_dx<2> kc = key55;
+		for (size_t j = 0 ; j < 2 ; j++)
+		{kc.getKeyRef().set_d(j,kc.getKeyRef().get(j) + tab.e[i].off.get(j));}
+
+		BOOST_REQUIRE_CLOSE(cols[g_map.get<0>(kc)*sys_pp::nvar + tab.e[i].var],tab.e[i].coeff,0.001);
+	}
+}
+
 //////////////// Position ////////////////////
 
 BOOST_AUTO_TEST_CASE( fd_test_use_staggered_position)
@@ -9,6 +9,7 @@
 #define FDSOLVER_HPP_
 
 #include <functional>
+#include <algorithm>
 
 #include "Matrix/SparseMatrix.hpp"
 #include "Vector/Vector.hpp"
@@ -20,6 +21,35 @@
 #include "Vector/Vector_util.hpp"
 #include "Grid/staggered_dist_grid.hpp"
 #include "util/eq_solve_common.hpp"
+#include "util/row_map.hpp"
+#include "Solvers/petsc_solver.hpp"
+#include "hash_map/hopscotch_map.h"
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
+/*! \brief Give the grid of the system to the solvers that use it (like gmg_solver, with setGridMap)
+ *
+ * The other solvers receive only the matrix
+ *
+ */
+template<typename solver_type, typename Sfinae = void>
+struct fd_solver_set_grid
+{
+	template<typename g_map_type>
+	static void set(solver_type & solver, g_map_type & g_map, size_t nvar)
+	{}
+};
+
+template<typename solver_type>
+struct fd_solver_set_grid<solver_type,decltype(std::declval<solver_type &>().setGridMap(std::declval<int &>(),0), void())>
+{
+	template<typename g_map_type>
+	static void set(solver_type & solver, g_map_type & g_map, size_t nvar)
+	{
+		solver.setGridMap(g_map,nvar);
+	}
+};
 
 /*! \brief Finite Differences
  *
@@ -244,6 +274,56 @@ private:
         }
     };
 
+    //! Maximum offset from the reference point that a compiled stencil can reach on each direction
+    static constexpr long int stencil_probe_radius = 8;
+
+    /*! \brief Replace the map g_map when value_nz is evaluated to compile the stencil of an operator
+     *
+     * Instead of the global id of a grid point it return a code of the offset of the point from
+     * a reference point, in this way the columns produced by value_nz on the reference point give
+     * directly the stencil of the operator
+     *
+     */
+    struct stencil_probe
+    {
+    	//! reference point
+    	grid_key_dx<Sys_eqs::dims> ref;
+
+    	//! set if the operator reach a point out of the probe box
+    	mutable bool out = false;
+
+    	template<unsigned int p> long int getProp(const grid_dist_key_dx<Sys_eqs::dims> & key) const
+    	{
+    		long int code = 0;
+    		long int stride = 1;
+
+    		for (int i = 0 ; i < Sys_eqs::dims ; i++)
+    		{
+    			long int off = key.getKeyRef().get(i) - ref.get(i);
+    			if (off < -stencil_probe_radius || off > stencil_probe_radius)
+    			{out = true;}
+
+    			code += (off + stencil_probe_radius) * stride;
+    			stride *= 2*stencil_probe_radius + 1;
+    		}
+
+    		return code;
+    	}
+    };
+
+    //! One non zero of a compiled stencil
+    struct stencil_entry
+    {
+    	//! offset of the point from the row point (shift included)
+    	grid_key_dx<Sys_eqs::dims> off;
+
+    	//! variable of the column
+    	long int var;
+
+    	//! coefficient
+    	typename Sys_eqs::stype coeff;
+    };
+
     //! our base grid
     grid_type & grid;
 
@@ -262,8 +342,11 @@ private:
 	//! Get the grid spacing
 	typename Sys_eqs::stype spacing[Sys_eqs::dims];
 
+	//! numbering of the grid points, possibly shared with the other schemes on the same grid
+	std::shared_ptr<row_map_data<g_map_type>> rmap;
+
 	//! mapping grid
-	g_map_type g_map;
+	g_map_type & g_map;
 
 	//! row of the matrix
 	size_t row;
@@ -274,6 +357,18 @@ private:
     //! solver options
     options_solver opt;
 
+    //! if true the operators are imposed stamping a stencil compiled once per impose
+    bool stencil_assembly = false;
+
+    //! compiled stencil of the operator currently imposed
+    std::vector<stencil_entry> stencil;
+
+    //! matrix free mode, the operators are not assembled
+    bool matrix_free = false;
+
+    //! in matrix free mode, every imposed operator writes its rows of y = A x in the local part of y
+    std::vector<std::function<void(typename Sys_eqs::stype *)>> mf_rows;
+
     //! Total number of points
     size_t tot;
 
@@ -580,6 +675,120 @@ private:
 
     }
 
+    /*! \brief Compile the stencil of an operator
+     *
+     * value_nz is evaluated once on the point key (shifted by shift) with a probe map, the columns
+     * are converted into offsets from the point, the variable and the coefficient
+     *
+     * \param op operator
+     * \param c_where position where the operator is imposed
+     * \param key reference point
+     * \param shift staggered shift
+     *
+     * \return false if the operator reach points too far to be compiled
+     *
+     */
+    template<typename T, typename cmb, typename Key> bool compile_stencil(const T & op,
+                                                                         cmb &c_where,
+                                                                         Key key,
+                                                                         grid_key_dx<Sys_eqs::dims> &shift)
+    {
+        stencil_probe probe;
+        tsl::hopscotch_map<long int,typename Sys_eqs::stype> cols;
+
+        key.getKeyRef() += shift;
+        probe.ref = key.getKeyRef();
+        op.template value_nz<Sys_eqs>(probe,key,gs,spacing,cols,1.0,0,c_where);
+
+        if (probe.out == true)
+        {return false;}
+
+        stencil.clear();
+        for (auto it = cols.begin() ; it != cols.end() ; ++it)
+        {
+            stencil_entry e;
+            long int code = it->first / Sys_eqs::nvar;
+            e.var = it->first % Sys_eqs::nvar;
+            e.coeff = it->second;
+
+            for (int i = 0 ; i < Sys_eqs::dims ; i++)
+            {
+                e.off.set_d(i,code % (2*stencil_probe_radius + 1) - stencil_probe_radius + shift.get(i));
+                code /= 2*stencil_probe_radius + 1;
+            }
+
+            stencil.push_back(e);
+        }
+
+        // deterministic column order inside the row
+        std::sort(stencil.begin(),stencil.end(),[](const stencil_entry & a, const stencil_entry & b)
+        {
+            for (int i = Sys_eqs::dims-1 ; i >= 0 ; i--)
+            {
+                if (a.off.get(i) != b.off.get(i))
+                {return a.off.get(i) < b.off.get(i);}
+            }
+            return a.var < b.var;
+        });
+
+        return true;
+    }
+
+    /*! \brief Add the row of the point key stamping the compiled stencil
+     *
+     * \param trpl triplets
+     * \param id equation id
+     * \param key point
+     *
+     */
+    template<typename trp, typename Key> void impose_git_stencil_it(trp &trpl, long int &id, Key &key)
+    {
+        long int row_id = g_map.template get<0>(key)*Sys_eqs::nvar + id;
+        size_t row_start = trpl.size();
+
+        bool is_diag = false;
+
+        for (size_t i = 0 ; i < stencil.size() ; i++)
+        {
+            const stencil_entry & e = stencil[i];
+
+            Key kc = key;
+            kc.getKeyRef() += e.off;
+            long int col = g_map.template get<0>(kc)*Sys_eqs::nvar + e.var;
+
+            // on small periodic grids two offsets can hit the same point
+            size_t j = row_start;
+            for ( ; j < trpl.size() ; j++)
+            {
+                if (trpl.get(j).col() == col)
+                {break;}
+            }
+
+            if (j != trpl.size())
+            {
+                trpl.get(j).value() += e.coeff;
+                continue;
+            }
+
+            trpl.add();
+            trpl.last().row() = row_id;
+            trpl.last().col() = col;
+            trpl.last().value() = e.coeff;
+
+            if (row_id == col)
+                is_diag = true;
+        }
+
+        // If does not have a diagonal entry put it to zero
+        if (is_diag == false)
+        {
+            trpl.add();
+            trpl.last().row() = row_id;
+            trpl.last().col() = row_id;
+            trpl.last().value() = 0.0;
+        }
+    }
+
 	/*! \brief Impose an operator
 	 *
 	 * This function impose an operator on a particular grid region to produce the system
@@ -601,6 +810,12 @@ private:
 									 const iterator & it_d,
 									 comb<Sys_eqs::dims> c_where)
 	{
+		if (matrix_free == true)
+		{
+			impose_git_matrix_free(op,num,id,it_d,c_where);
+			return;
+		}
+
 		openfpm::vector<triplet> & trpl = A.getMatrixTriplets();
 
 		grid_key_dx<Sys_eqs::dims> shift;
@@ -615,109 +830,274 @@ private:
 		}
 
 		iterator it(it_d,false);
-		grid_sm<Sys_eqs::dims,void> gs = g_map.getGridInfoVoid();
-
-		std::unordered_map<long int,typename Sys_eqs::stype> cols;
-
-		grid_key_dx<Sys_eqs::dims> zero;
-		zero.zero();
 
-		if (num.isConstant() == false)
+		bool use_stencil = false;
+		if (stencil_assembly == true && it.isNext())
 		{
-			auto it_num = grid.getSubDomainIterator(it.getStart(),it.getStop());
-                // iterate all the grid points
-            while (it.isNext())
-            {
-                // get the position
-                auto key = it.get();
-                auto key_num=it_num.get();
+			use_stencil = compile_stencil(op,c_where,it.get(),shift);
 
-                impose_git_it(op,cols,trpl,id,it,c_where,key,shift);
+			if (use_stencil == false)
+			{std::cerr << __FILE__ << ":" << __LINE__ << " warning, the operator extends more than " << stencil_probe_radius << " points, it is imposed without stencil assembly" << std::endl;}
+		}
 
-                b(g_map.template get<0>(key)*Sys_eqs::nvar + id) = num.get(key_num);
+		// Collect the points, they come patch by patch of the local grids so contiguous
+		// ranges assigned to the threads cover contiguous pieces of the local patches
+		typedef grid_dist_key_dx<Sys_eqs::dims> key_type;
+		std::vector<key_type> keys;
+		std::vector<key_type> keys_num;
 
-				cols.clear();
+		bool constant_num = num.isConstant();
 
-				// if SE_CLASS1 is defined check the position
-	#ifdef SE_CLASS1
-	//			T::position(key,gs,s_pos);
-	#endif
+		if (constant_num == false)
+		{
+			auto it_num = grid.getSubDomainIterator(it.getStart(),it.getStop());
+			while (it.isNext())
+			{
+				keys.push_back(it.get());
+				keys_num.push_back(it_num.get());
 
-				++row;
-				++row_b;
 				++it;
 				++it_num;
 			}
 		}
 		else
 		{
-            // iterate all the grid points
-            while (it.isNext())
-            {
-                // get the position
-                auto key = it.get();
-			    // iterate all the grid points
-		        impose_git_it(op,cols,trpl,id,it,c_where,key,shift);
+			while (it.isNext())
+			{
+				keys.push_back(it.get());
+				++it;
+			}
+		}
+
+		long int n = keys.size();
+		size_t trplStart = trpl.size();
+
+		int maxThreads = 1;
+#ifdef _OPENMP
+		maxThreads = omp_get_max_threads();
+#endif
+
+		std::vector<openfpm::vector<triplet>> localTrpl(maxThreads);
+		std::vector<size_t> threadStart(maxThreads + 1, 0);
+		std::vector<typename Sys_eqs::stype> rhs(n);
+
+		#pragma omp parallel
+		{
+			int t = 0, nt = 1;
+#ifdef _OPENMP
+			t = omp_get_thread_num();
+			nt = omp_get_num_threads();
+#endif
+			openfpm::vector<triplet> & lt = localTrpl[t];
+			tsl::hopscotch_map<long int,typename Sys_eqs::stype> cols;
+
+			// contiguous ranges keep the triplets in the order of the iterator
+			long int chunk = (n + nt - 1) / nt;
+			long int iStart = std::min(n, t * chunk);
+			long int iEnd = std::min(n, iStart + chunk);
+
+			for (long int i = iStart ; i < iEnd ; i++)
+			{
+				key_type key = keys[i];
+
+				if (use_stencil == true)
+				{impose_git_stencil_it(lt,id,key);}
+				else
+				{impose_git_it(op,cols,lt,id,it,c_where,key,shift);}
 
-				b(g_map.template get<0>(key)*Sys_eqs::nvar + id) = num.get(key);
+				if (constant_num == false)
+				{rhs[i] = num.get(keys_num[i]);}
+				else
+				{rhs[i] = num.get(key);}
 
 				cols.clear();
+			}
+			threadStart[t + 1] = lt.size();
 
-				// if SE_CLASS1 is defined check the position
-	#ifdef SE_CLASS1
-	//			T::position(key,gs,s_pos);
-	#endif
-				++row;
-				++row_b;
-				++it;
+			#pragma omp barrier
+			#pragma omp single
+			{
+				for (int k = 0 ; k < nt ; k++)
+				{threadStart[k + 1] += threadStart[k];}
+				trpl.resize(trplStart + threadStart[nt]);
 			}
+
+			for (size_t j = 0 ; j < lt.size() ; j++)
+			{trpl.get(trplStart + threadStart[t] + j) = lt.get(j);}
 		}
+
+		// the vector b is not thread safe
+		for (long int i = 0 ; i < n ; i++)
+		{b(g_map.template get<0>(keys[i])*Sys_eqs::nvar + id) = rhs[i];}
+
+		row += n;
+		row_b += n;
 	}
 
-	/*! \brief Construct the gmap structure
+	/*! \brief Keep the operator for the matrix free multiplication and fill the right hand side
+	 *
+	 * \param op Operator to impose (A term)
+	 * \param num right hand side of the term (b term)
+	 * \param id Equation id in the system that we are imposing
+	 * \param it_d iterator that define where you want to impose
+	 * \param c_where position where the operator is imposed
 	 *
 	 */
-	void construct_gmap()
+	template<typename T, typename bop, typename iterator> void impose_git_matrix_free(const T & op ,
+			                         bop num,
+			                         long int id ,
+									 const iterator & it_d,
+									 comb<Sys_eqs::dims> c_where)
 	{
-		tot = g_map.getGridInfoVoid().size();
+		grid_key_dx<Sys_eqs::dims> shift;
+		shift.zero();
+		for (int i = 0 ; i < Sys_eqs::dims ; i++)
+		{
+			if (c_where[i] == 1)
+			{
+				shift.set_d(i,1);
+				c_where.c[i] = -1;
+			}
+		}
+
+		iterator it(it_d,false);
+
+		// the operator is evaluated on the grid of the unknowns, its keys run with the ones of g_map
+		typedef grid_dist_key_dx<Sys_eqs::dims> key_type;
+		std::vector<key_type> keys;
+		std::vector<long int> rows;
+
+		long int rowOffset = s_pnt * Sys_eqs::nvar;
+		bool constant_num = num.isConstant();
+
+		auto it_g = grid.getSubDomainIterator(it.getStart(),it.getStop());
+		while (it.isNext())
+		{
+			auto key = it.get();
+			key_type gkey = it_g.get();
+
+			long int r = g_map.template get<0>(key)*Sys_eqs::nvar + id;
+			b(r) = (constant_num == true)?num.get(key):num.get(gkey);
+
+			gkey.getKeyRef() += shift;
+			keys.push_back(gkey);
+			rows.push_back(r - rowOffset);
+
+			++it;
+			++it_g;
+		}
+
+		mf_rows.push_back([op, keys, rows, c_where](typename Sys_eqs::stype * y) {
+			#pragma omp parallel for
+			for (long int i = 0 ; i < (long int)keys.size() ; i++)
+			{
+				// value moves the key on the stencil points
+				key_type k = keys[i];
+				comb<Sys_eqs::dims> cw = c_where;
+				y[rows[i]] = op.value(k,cw);
+			}
+		});
+
+		row += keys.size();
+		row_b += keys.size();
+	}
+
+	/*! \brief Number the points of the map
+	 *
+	 * \param d map to number
+	 *
+	 */
+	static void number_gmap(row_map_data<g_map_type> & d)
+	{
+		d.tot = d.map.getGridInfoVoid().size();
 
 		Vcluster<> & v_cl = create_vcluster();
 
 		// Calculate the size of the local domain
-		size_t sz = g_map.getLocalDomainSize();
+		size_t sz = d.map.getLocalDomainSize();
 
 		// Get the total size of the local grids on each processors
-		v_cl.allGather(sz,pnt);
+		v_cl.allGather(sz,d.pnt);
 		v_cl.execute();
-		s_pnt = 0;
+		d.s_pnt = 0;
 
 		// calculate the starting point for this processor
 		for (size_t i = 0 ; i < v_cl.getProcessUnitID() ; i++)
-			s_pnt += pnt.get(i);
-
-		// resize b if needed
-		b.resize(Sys_eqs::nvar * g_map.size(),Sys_eqs::nvar * sz);
-
-		// Calculate the starting point
+			d.s_pnt += d.pnt.get(i);
 
 		// Counter
 		size_t cnt = 0;
 
 		// Create the re-mapping grid
-		auto it = g_map.getDomainIterator();
+		auto it = d.map.getDomainIterator();
 
 		while (it.isNext())
 		{
 			auto key = it.get();
 
-			g_map.template get<0>(key) = cnt + s_pnt;
+			d.map.template get<0>(key) = cnt + d.s_pnt;
 
 			++cnt;
 			++it;
 		}
 
 		// sync the ghost
-		g_map.template ghost_get<0>();
+		d.map.template ghost_get<0>();
+	}
+
+	/*! \brief Create the map of the grid b_g, or take the one in rm if it was built with the same grid and stencil
+	 *
+	 * \param rm shared row map (NULL to build a private one)
+	 * \param b_g grid
+	 * \param stencil maximum extension of the stencil
+	 * \param pd padding
+	 *
+	 */
+	static std::shared_ptr<row_map_data<g_map_type>> make_gmap(row_map<g_map_type> * rm,
+	                                                            grid_type & b_g,
+	                                                            const Ghost<Sys_eqs::dims,long int> & stencil,
+	                                                            const Padding<Sys_eqs::dims> & pd)
+	{
+		std::vector<long int> ext;
+		for (size_t i = 0 ; i < Sys_eqs::dims ; i++)
+		{
+			ext.push_back(stencil.getLow(i));
+			ext.push_back(stencil.getHigh(i));
+			ext.push_back(pd.getLow(i));
+			ext.push_back(pd.getHigh(i));
+		}
+
+		// grid_dist_id has no map counter, the numbering is kept until rm.invalidate()
+		if (rm != NULL)
+		{
+			std::shared_ptr<row_map_data<g_map_type>> d = rm->find(&b_g,0,ext);
+			if (d) {return d;}
+		}
+
+		std::shared_ptr<row_map_data<g_map_type>> d = std::make_shared<row_map_data<g_map_type>>(b_g,stencil,pd);
+		number_gmap(*d);
+		d->geom = &b_g;
+		d->ext = ext;
+
+		if (rm != NULL) {rm->set(d);}
+
+		return d;
+	}
+
+	/*! \brief Construct the gmap structure
+	 *
+	 */
+	void construct_gmap()
+	{
+		tot = rmap->tot;
+		pnt = rmap->pnt;
+		s_pnt = rmap->s_pnt;
+
+		// resize b if needed
+		b.resize(Sys_eqs::nvar * g_map.size(),Sys_eqs::nvar * g_map.getLocalDomainSize());
+
+		// the rows of b are the ones of the local points
+		b.setLocalRows(true);
 	}
 
 	/*! \initialize the object FD_scheme
@@ -784,6 +1164,122 @@ private:
         }
     }
 
+#ifdef HAVE_PETSC
+
+    /*! \brief Copy the component comp of a PETSc solution, reading its local array instead of the row values
+     *
+     * \param x solution
+     * \param exp where to store the result
+     * \param comp component
+     *
+     */
+    template<typename expr_type>
+    void copy_impl(Vector<double,PETSC_BASE> & x, expr_type exp, unsigned int comp)
+    {
+    	comb<Sys_eqs::dims> c_where;
+    	c_where.mone();
+        auto & grid = exp.getGrid();
+
+        const Vec & x_ = x.getVecNoSet();
+        const PetscScalar * xa;
+        PETSC_SAFE_CALL(VecGetArrayRead(x_,&xa));
+
+        auto it = grid.getDomainIterator();
+        grid_key_dx<Sys_eqs::dims> start;
+        grid_key_dx<Sys_eqs::dims> stop;
+
+        for (int i = 0 ; i < Sys_eqs::dims ; i++)
+        {
+        	start.set_d(i,0);
+        	stop.set_d(i,grid.size(i)-1);
+        }
+        auto it_map = g_map.getSubDomainIterator(start,stop);
+
+        while (it.isNext())
+        {
+            auto p = it.get();
+            auto gp = it_map.get();
+
+            // the rows of this processor start from s_pnt
+            size_t pn = g_map.template get<0>(gp) - s_pnt;
+            exp.value_ref(p,c_where) = xa[pn*Sys_eqs::nvar + comp];
+
+            ++it;
+            ++it_map;
+        }
+
+        PETSC_SAFE_CALL(VecRestoreArrayRead(x_,&xa));
+    }
+
+    //! Copy the local part xa of a solution vector in the expressions (matrix free mode)
+    template<typename expr_type>
+    void copy_local_impl(const typename Sys_eqs::stype * xa, expr_type exp, unsigned int comp)
+    {
+    	comb<Sys_eqs::dims> c_where;
+    	c_where.mone();
+        auto & grid = exp.getGrid();
+
+        auto it = grid.getDomainIterator();
+        grid_key_dx<Sys_eqs::dims> start;
+        grid_key_dx<Sys_eqs::dims> stop;
+
+        for (int i = 0 ; i < Sys_eqs::dims ; i++)
+        {
+        	start.set_d(i,0);
+        	stop.set_d(i,grid.size(i)-1);
+        }
+        auto it_map = g_map.getSubDomainIterator(start,stop);
+
+        while (it.isNext())
+        {
+            auto p = it.get();
+            auto gp = it_map.get();
+
+            size_t pn = g_map.template get<0>(gp) - s_pnt;
+            exp.value_ref(p,c_where) = xa[pn*Sys_eqs::nvar + comp];
+
+            ++it;
+            ++it_map;
+        }
+    }
+
+    template<typename exp1, typename ... othersExp>
+    void copy_local_nested(const typename Sys_eqs::stype * xa, unsigned int & comp, exp1 exp, othersExp ... exps)
+    {
+        copy_local_impl(xa,exp,comp);
+        comp++;
+
+        copy_local_nested(xa,comp,exps ...);
+    }
+
+    template<typename exp1>
+    void copy_local_nested(const typename Sys_eqs::stype * xa, unsigned int & comp, exp1 exp)
+    {
+        copy_local_impl(xa,exp,comp);
+        comp++;
+    }
+
+    //! Multiplication of the matrix free operator, the context is the function computing y = A x on the local parts
+    static PetscErrorCode mf_mult(Mat A_, Vec x_, Vec y_)
+    {
+        std::function<void(const PetscScalar *, PetscScalar *)> * mult;
+        PetscFunctionBeginUser;
+        PETSC_SAFE_CALL(MatShellGetContext(A_,(void **)&mult));
+
+        const PetscScalar * xa;
+        PetscScalar * ya;
+        PETSC_SAFE_CALL(VecGetArrayRead(x_,&xa));
+        PETSC_SAFE_CALL(VecGetArray(y_,&ya));
+
+        (*mult)(xa,ya);
+
+        PETSC_SAFE_CALL(VecRestoreArray(y_,&ya));
+        PETSC_SAFE_CALL(VecRestoreArrayRead(x_,&xa));
+        PetscFunctionReturn(0);
+    }
+
+#endif
+
     template<typename solType, typename exp1, typename ... othersExp>
     void copy_nested(solType & x, unsigned int & comp, exp1 exp, othersExp ... exps)
     {
@@ -804,6 +1300,53 @@ private:
 
 public:
 
+	/*! \brief Impose the operators stamping a compiled stencil
+	 *
+	 * When active, every impose evaluate the operator only on the first point of the region,
+	 * the non zero pattern is flattened into a table of (offset,variable,coefficient) and every
+	 * row is produced stamping the table, without any hashing of columns.
+	 *
+	 * \warning valid only for operators with coefficients that does not depend on the position,
+	 *          operators multiplied by a field or one-side derivatives that switch near the boundary
+	 *          must be imposed with this option off
+	 *
+	 * \param stencil_assembly true to activate it
+	 *
+	 */
+	void setStencilAssembly(bool stencil_assembly)
+	{
+		this->stencil_assembly = stencil_assembly;
+	}
+
+	/*! \brief Matrix free mode
+	 *
+	 * The operators imposed after this call are not assembled: they are kept and evaluated on the grid at every
+	 * multiplication of solve_matrix_free, a sweep of the stencil instead of a SpMV that read 27-125 non zeros
+	 * per row for high order 3D stencils. The right hand side is filled as usual. Only options_solver::STANDARD
+	 * is supported
+	 *
+	 * \param mf true to activate the matrix free mode
+	 *
+	 */
+	void setMatrixFree(bool mf)
+	{
+		matrix_free = mf;
+	}
+
+	/*! \brief Store the matrix in blocks of size Sys_eqs::nvar
+	 *
+	 * The unknowns of a grid point are interleaved (row = g_map*nvar + id), with the PETSc backend the matrix
+	 * become BAIJ (or SBAIJ when symmetric), one dense nvar x nvar block for every couple of points. It must be
+	 * called before imposing the operators
+	 *
+	 * \param symmetric the system is symmetric and only the upper triangular blocks are stored
+	 *
+	 */
+	void setBlockMatrix(bool symmetric = false)
+	{
+		A.setBlockSize(Sys_eqs::nvar,symmetric);
+	}
+
 	/*! \brief set the staggered position for each property
 	 *
 	 * \param sp vector containing the staggered position for each property
@@ -867,7 +1410,26 @@ public:
 	FD_scheme(const Ghost<Sys_eqs::dims,long int> & stencil,
 			 grid_type & b_g,
 			 options_solver opt = options_solver::STANDARD)
-	:grid(b_g),pd({0,0,0},{0,0,0}),gs(b_g.getGridInfoVoid()),g_map(b_g,stencil,pd),row(0),row_b(0),opt(opt)
+	:grid(b_g),pd({0,0,0},{0,0,0}),gs(b_g.getGridInfoVoid()),rmap(make_gmap(NULL,b_g,stencil,pd)),g_map(rmap->map),row(0),row_b(0),opt(opt)
+	{
+		Initialize(b_g.getDomain());
+	}
+
+	/*! \brief Constructor that reuse the numbering of the grid points of the previous schemes on b_g
+	 *
+	 * The numbering is built by the first scheme and stored in rm, the next schemes with the same grid and
+	 * stencil take it without communications. Call rm.invalidate() if the grid is redecomposed
+	 *
+	 * \param rm shared row map
+	 * \param stencil maximum extension of the stencil on each directions
+	 * \param b_g object grid that will store the solution
+	 *
+	 */
+	FD_scheme(row_map<g_map_type> & rm,
+			 const Ghost<Sys_eqs::dims,long int> & stencil,
+			 grid_type & b_g,
+			 options_solver opt = options_solver::STANDARD)
+	:grid(b_g),pd({0,0,0},{0,0,0}),gs(b_g.getGridInfoVoid()),rmap(make_gmap(&rm,b_g,stencil,pd)),g_map(rmap->map),row(0),row_b(0),opt(opt)
 	{
 		Initialize(b_g.getDomain());
 	}
@@ -886,7 +1448,7 @@ public:
 			 const Ghost<Sys_eqs::dims,long int> & stencil,
 			 grid_type & b_g,
 			 options_solver opt = options_solver::STANDARD)
-	:grid(b_g),pd(pd),gs(b_g.getGridInfoVoid()),g_map(b_g,stencil,pd),row(0),row_b(0),opt(opt)
+	:grid(b_g),pd(pd),gs(b_g.getGridInfoVoid()),rmap(make_gmap(NULL,b_g,stencil,pd)),g_map(rmap->map),row(0),row_b(0),opt(opt)
         {
 		Initialize(b_g.getDomain());
 	}
@@ -1179,7 +1741,10 @@ public:
 	 *
 	 */
 	void new_A()
-	{row = 0;}
+	{
+		row = 0;
+		mf_rows.clear();
+	}
 
 
 	//! type of the sparse matrix
@@ -1306,6 +1871,16 @@ public:
 	 *
 	 */
 	template<unsigned int ... pos, typename Vct, typename Grid_dst> void copy(Vct & v,const long int (& start)[Sys_eqs_typ::dims], const long int (& stop)[Sys_eqs_typ::dims], Grid_dst & g_dst)
+	{
+		copy_src<pos...>(v,start,stop,g_dst);
+	}
+
+	/*! \brief Copy the solution from v (a Vector or a local_vector_view) into the grid
+	 *
+	 * \see copy
+	 *
+	 */
+	template<unsigned int ... pos, typename Vct, typename Grid_dst> void copy_src(Vct & v,const long int (& start)[Sys_eqs_typ::dims], const long int (& stop)[Sys_eqs_typ::dims], Grid_dst & g_dst)
 	{
 		if (is_grid_staggered<Sys_eqs>::value())
 		{
@@ -1340,6 +1915,36 @@ public:
 		}
 	}
 
+#ifdef HAVE_PETSC
+
+	/*! \brief Copy a PETSc solution into the grid
+	 *
+	 * The elements are read from the local array of the PETSc vector (as returned by the solver) instead of
+	 * searching each of them in the row values of the Vector
+	 *
+	 * \tparam pos target properties
+	 *
+	 * \param v Vector that contain the solution of the system
+	 * \param start point
+	 * \param stop point
+	 * \param g_dst Destination grid
+	 *
+	 */
+	template<unsigned int ... pos, typename Grid_dst> void copy(Vector<double,PETSC_BASE> & v,const long int (& start)[Sys_eqs_typ::dims], const long int (& stop)[Sys_eqs_typ::dims], Grid_dst & g_dst)
+	{
+		const PetscScalar * xa;
+		PETSC_SAFE_CALL(VecGetArrayRead(v.getVecNoSet(),&xa));
+
+		// the rows of this processor start from s_pnt
+		local_vector_view<PetscScalar> lv(xa,s_pnt*Sys_eqs::nvar);
+
+		copy_src<pos...>(lv,start,stop,g_dst);
+
+		PETSC_SAFE_CALL(VecRestoreArrayRead(v.getVecNoSet(),&xa));
+	}
+
+#endif
+
     /*! \brief Solve an equation
      *
      *  \warning exp must be a scalar type
@@ -1356,6 +1961,8 @@ public:
                    " properties " << std::endl;};
         typename Sys_eqs::solver_type solver;
 //        umfpack_solver<double> solver;
+        fd_solver_set_grid<typename std::remove_reference<decltype(solver)>::type>::set(solver,g_map,Sys_eqs::nvar);
+        solver_set_field_layout<typename std::remove_reference<decltype(solver)>::type>::set(solver,Sys_eqs::nvar);
         auto x = solver.solve(getA(opt),getB(opt));
 
         unsigned int comp = 0;
@@ -1379,12 +1986,121 @@ public:
     													dimensionality, I am expecting " << Sys_eqs::nvar <<
     													" properties " << std::endl;};
 #endif
+        fd_solver_set_grid<typename std::remove_reference<decltype(solver)>::type>::set(solver,g_map,Sys_eqs::nvar);
+        solver_set_field_layout<typename std::remove_reference<decltype(solver)>::type>::set(solver,Sys_eqs::nvar);
         auto x = solver.solve(getA(opt),getB(opt));
 
         unsigned int comp = 0;
         copy_nested(x,comp,exps ...);
     }
 
+#ifdef HAVE_PETSC
+
+    /*! \brief Solve an equation with a PETSc solver
+     *
+     * The solution is not copied in the row values of a Vector (Vector::update), the grid is filled from the
+     * local array of the PETSc vector
+     *
+     *  \warning exp must be a scalar type
+     *
+     * \param exp where to store the result
+     *
+     */
+    template<typename ... expr_type>
+    void solve_with_solver(petsc_solver<double> & solver, expr_type ... exps)
+    {
+#ifdef SE_CLASS1
+
+        if (sizeof...(exps) != Sys_eqs::nvar)
+    	{std::cerr << __FILE__ << ":" << __LINE__ << " Error the number of properties you gave does not match the solution in\
+    													dimensionality, I am expecting " << Sys_eqs::nvar <<
+    													" properties " << std::endl;};
+#endif
+        auto & A = getA(opt);
+
+        PetscInt row;
+        PetscInt col;
+        PetscInt row_loc;
+        PetscInt col_loc;
+        PETSC_SAFE_CALL(MatGetSize(A.getMat(),&row,&col));
+        PETSC_SAFE_CALL(MatGetLocalSize(A.getMat(),&row_loc,&col_loc));
+
+        Vector<double,PETSC_BASE> x(row,row_loc);
+        solver_set_field_layout<typename std::remove_reference<decltype(solver)>::type>::set(solver,Sys_eqs::nvar);
+        solver.solve_no_update(A,x,getB(opt));
+
+        unsigned int comp = 0;
+        copy_nested(x,comp,exps ...);
+    }
+
+    /*! \brief Solve the system imposed in matrix free mode
+     *
+     * The matrix is a PETSc MatShell. Every multiplication copies x in the unknowns, gets their ghosts and
+     * evaluates the imposed operators on the grid. The preconditioner is built on P, for example the assembled
+     * matrix of a low order discretization of the same system, without P no preconditioner is used
+     *
+     *  \warning exp must be a scalar type
+     *
+     * \param solver petsc solver
+     * \param P preconditioning matrix (can be NULL)
+     * \param exp the unknowns the operators were imposed on, one for each variable, they contain the solution at the end
+     *
+     */
+    template<typename ... expr_type>
+    void solve_matrix_free(petsc_solver<double> & solver, SparseMatrix<double,int,PETSC_BASE> * P, expr_type ... exps)
+    {
+        if (sizeof...(exps) != Sys_eqs::nvar)
+        {
+            std::cerr << __FILE__ << ":" << __LINE__ << " Error the number of properties you gave does not match the solution in\
+    													dimensionality, I am expecting " << Sys_eqs::nvar <<
+                   " properties " << std::endl;
+            return;
+        }
+        if (opt != options_solver::STANDARD)
+        {
+            std::cerr << __FILE__ << ":" << __LINE__ << " Error the matrix free mode supports only options_solver::STANDARD" << std::endl;
+            return;
+        }
+
+        PetscInt nLoc = g_map.getLocalDomainSize() * Sys_eqs::nvar;
+        PetscInt nGlob = tot * Sys_eqs::nvar;
+
+        std::function<void(const PetscScalar *, PetscScalar *)> mult = [&](const PetscScalar * xa, PetscScalar * ya)
+        {
+            unsigned int comp = 0;
+            copy_local_nested(xa,comp,exps ...);
+            grid.template ghost_get<expr_type::prop ...>();
+
+            std::fill(ya,ya + nLoc,0.0);
+            for (size_t i = 0 ; i < mf_rows.size() ; i++)
+            {mf_rows[i](ya);}
+        };
+
+        Mat A_;
+        PETSC_SAFE_CALL(MatCreateShell(PETSC_COMM_WORLD,nLoc,nLoc,nGlob,nGlob,&mult,&A_));
+        PETSC_SAFE_CALL(MatShellSetOperation(A_,MATOP_MULT,(void (*)(void)) mf_mult));
+
+        KSP ksp = solver.getKSP();
+        PETSC_SAFE_CALL(KSPSetOperators(ksp,A_,(P != NULL)?P->getMat():A_));
+        PETSC_SAFE_CALL(KSPSetFromOptions(ksp));
+        if (P == NULL)
+        {
+            PC pc;
+            PETSC_SAFE_CALL(KSPGetPC(ksp,&pc));
+            PETSC_SAFE_CALL(PCSetType(pc,PCNONE));
+        }
+
+        Vector<double,PETSC_BASE> x(nGlob,nLoc);
+        PETSC_SAFE_CALL(KSPSolve(ksp,getB(opt).getVec(),x.getVecNoSet()));
+
+        PETSC_SAFE_CALL(MatDestroy(&A_));
+
+        unsigned int comp = 0;
+        copy_nested(x,comp,exps ...);
+    }
+
+#endif
+
     template<typename SolverType, typename ... expr_type>
     void solve_with_constant_nullspace_solver(SolverType & solver, expr_type ... exps)
     {
@@ -1395,6 +2111,8 @@ public:
     													dimensionality, I am expecting " << Sys_eqs::nvar <<
                    " properties " << std::endl;};
 #endif
+        fd_solver_set_grid<typename std::remove_reference<decltype(solver)>::type>::set(solver,g_map,Sys_eqs::nvar);
+        solver_set_field_layout<typename std::remove_reference<decltype(solver)>::type>::set(solver,Sys_eqs::nvar);
         auto x = solver.with_constant_nullspace_solve(getA(opt),getB(opt));
 
         unsigned int comp = 0;
@@ -1416,6 +2134,8 @@ public:
     													dimensionality, I am expecting " << Sys_eqs::nvar <<
                    " properties " << std::endl;};
 
+        fd_solver_set_grid<typename std::remove_reference<decltype(solver)>::type>::set(solver,g_map,Sys_eqs::nvar);
+        solver_set_field_layout<typename std::remove_reference<decltype(solver)>::type>::set(solver,Sys_eqs::nvar);
         auto x = solver.try_solve(getA(opt),getB(opt));
 
         unsigned int comp = 0;
@@ -8,6 +8,8 @@
 #include "FD_Solver.hpp"
 #include "Solvers/petsc_solver.hpp"
 #include "Solvers/umfpack_solver.hpp"
+#include "Solvers/gmg_solver.hpp"
+#include "Solvers/fft_poisson_solver.hpp"
 #include "FD_expressions.hpp"
 #include "FD_op.hpp"
 #include "Grid/staggered_dist_grid.hpp"
@@ -122,6 +124,348 @@ BOOST_AUTO_TEST_CASE(solver_check_diagonal)
         //domain.write("FDSOLVER_Lap_test");
     }
 
+    //! Poisson 2D solved with the geometric multigrid
+    struct equations2d1_gmg {
+        static const unsigned int dims=2;
+        static const unsigned int nvar=1;
+        static const bool boundary[];
+        typedef double stype;
+        typedef grid_dist_id<dims, double, aggregate<double,double,double>> b_part;
+        typedef SparseMatrix<double, int, PETSC_BASE> SparseMatrix_type;
+        typedef Vector<double, PETSC_BASE> Vector_type;
+        typedef gmg_solver<double> solver_type;
+    };
+
+    const bool equations2d1_gmg::boundary[] = {NON_PERIODIC,NON_PERIODIC};
+
+    BOOST_AUTO_TEST_CASE(solver_Lap_gmg)
+    {
+        const size_t sz[2] = {129,129};
+        Box<2, double> box({0, 0}, {1, 1});
+        periodicity<2> bc = {NON_PERIODIC, NON_PERIODIC};
+        Ghost<2,long int> ghost(1);
+
+        grid_dist_id<2, double, aggregate<double,double,double>> domain(sz, box, ghost, bc);
+
+        auto it = domain.getDomainIterator();
+        while (it.isNext())
+        {
+            auto key = it.get();
+            auto gkey = it.getGKey(key);
+            double x = gkey.get(0) * domain.spacing(0);
+            double y = gkey.get(1) * domain.spacing(1);
+            domain.get<0>(key) = sin(M_PI*x)*sin(M_PI*y);
+            domain.get<1>(key) = -2*M_PI*M_PI*sin(M_PI*x)*sin(M_PI*y);
+            ++it;
+        }
+
+        domain.ghost_get<0>();
+        auto v =  FD::getV<0>(domain);
+        auto sol= FD::getV<2>(domain);
+
+        FD_scheme<equations2d1_gmg,decltype(domain)> Solver(ghost,domain);
+        FD::Lap Lap;
+        FD::LInfError LInfError;
+
+        Solver.impose(Lap(v),{1,1},{127,127}, prop_id<1>());
+        Solver.impose(v,{0,0},{128,0}, prop_id<0>());
+        Solver.impose(v,{0,1},{0,127}, prop_id<0>());
+        Solver.impose(v,{0,128},{128,128}, prop_id<0>());
+        Solver.impose(v,{128,1},{128,127}, prop_id<0>());
+
+        gmg_solver<double> gmg;
+        gmg.setTolerance(1e-10);
+        Solver.solve_with_solver(gmg,sol);
+
+        // 129 -> 65 -> 33 -> 17 -> 9 -> 5
+        BOOST_REQUIRE_EQUAL(gmg.getNLevels(),6ul);
+        BOOST_REQUIRE(gmg.getIterations() < 30);
+
+        auto linferror = LInfError(v, sol);
+        BOOST_REQUIRE(linferror < 1e-3);
+
+        // as Sys_eqs::solver_type
+        Solver.solve(sol);
+        linferror = LInfError(v, sol);
+        BOOST_REQUIRE(linferror < 1e-3);
+    }
+
+#ifdef HAVE_FFTW
+
+    BOOST_AUTO_TEST_CASE(solver_Lap_fft_periodic)
+    {
+        const size_t sz[2] = {128,128};
+        Box<2, double> box({0, 0}, {1, 1});
+        periodicity<2> bc = {PERIODIC, PERIODIC};
+        Ghost<2,long int> ghost(1);
+
+        grid_dist_id<2, double, aggregate<double,double,double>> domain(sz, box, ghost, bc);
+
+        auto it = domain.getDomainIterator();
+        while (it.isNext())
+        {
+            auto key = it.get();
+            auto gkey = it.getGKey(key);
+            double x = gkey.get(0) * domain.spacing(0);
+            double y = gkey.get(1) * domain.spacing(1);
+            domain.get<0>(key) = sin(2*M_PI*x)*sin(2*M_PI*y);
+            domain.get<1>(key) = -8*M_PI*M_PI*sin(2*M_PI*x)*sin(2*M_PI*y);
+            ++it;
+        }
+
+        auto v =  FD::getV<0>(domain);
+        auto sol= FD::getV<2>(domain);
+        FD::LInfError LInfError;
+
+        // second order, same solution as FD_scheme with Lap
+        fft_poisson_solver<decltype(domain)> fft(domain);
+        fft.solve<2,1>();
+
+        auto linferror = LInfError(v, sol);
+        BOOST_REQUIRE(linferror < 1e-3);
+
+        // spectral symbol, Helmholtz
+        auto it2 = domain.getDomainIterator();
+        while (it2.isNext())
+        {
+            auto key = it2.get();
+            domain.get<1>(key) = (-8*M_PI*M_PI - 4.0)*domain.get<0>(key);
+            ++it2;
+        }
+
+        fft_poisson_solver<decltype(domain)> fft_spectral(domain,FFT_LAPLACIAN_SPECTRAL);
+        fft_spectral.solve<2,1>(4.0);
+
+        linferror = LInfError(v, sol);
+        BOOST_REQUIRE(linferror < 1e-10);
+    }
+
+#endif
+
+    BOOST_AUTO_TEST_CASE(solver_Lap_shared_row_map)
+    {
+        const size_t sz[2] = {42,42};
+        Box<2, double> box({0, 0}, {1, 1});
+        periodicity<2> bc = {NON_PERIODIC, NON_PERIODIC};
+        Ghost<2,long int> ghost(1);
+
+        grid_dist_id<2, double, aggregate<double,double,double>> domain(sz, box, ghost, bc);
+
+        auto it = domain.getDomainIterator();
+        while (it.isNext())
+        {
+            auto key = it.get();
+            auto gkey = it.getGKey(key);
+            double x = gkey.get(0) * domain.spacing(0);
+            double y = gkey.get(1) * domain.spacing(1);
+            domain.get<0>(key) = sin(M_PI*x)*sin(M_PI*y);
+            domain.get<1>(key) = -2*M_PI*M_PI*sin(M_PI*x)*sin(M_PI*y);
+            ++it;
+        }
+
+        domain.ghost_get<0>();
+        auto v =  FD::getV<0>(domain);
+        auto sol= FD::getV<2>(domain);
+        FD::Lap Lap;
+        FD::LInfError LInfError;
+
+        typedef FD_scheme<equations2d1,decltype(domain)> scheme_type;
+        row_map<scheme_type::g_map_type> rm;
+
+        scheme_type Solver1(rm,ghost,domain);
+        scheme_type Solver2(rm,ghost,domain);
+        BOOST_REQUIRE_EQUAL(rm.getNReuse(),1ul);
+        BOOST_REQUIRE(&Solver1.getMap() == &Solver2.getMap());
+
+        // another stencil need another numbering
+        scheme_type Solver3(rm,Ghost<2,long int>(2),domain);
+        BOOST_REQUIRE_EQUAL(rm.getNReuse(),1ul);
+
+        Solver2.impose(Lap(v),{1,1},{40,40}, prop_id<1>());
+        Solver2.impose(v,{0,0},{41,0}, prop_id<0>());
+        Solver2.impose(v,{0,1},{0,40}, prop_id<0>());
+        Solver2.impose(v,{0,41},{41,41}, prop_id<0>());
+        Solver2.impose(v,{41,1},{41,40}, prop_id<0>());
+        Solver2.solve(sol);
+
+        auto linferror = LInfError(v, sol);
+        BOOST_REQUIRE(linferror < 1e-3);
+    }
+
+    BOOST_AUTO_TEST_CASE(solver_Lap_stencil_assembly)
+    {
+        const size_t sz[2] = {42,42};
+        Box<2, double> box({0, 0}, {1, 1});
+        periodicity<2> bc = {NON_PERIODIC, NON_PERIODIC};
+        Ghost<2,long int> ghost(1);
+
+        grid_dist_id<2, double, aggregate<double,double,double>> domain(sz, box, ghost, bc);
+
+        auto v =  FD::getV<0>(domain);
+        FD::Derivative_x Dx;
+        FD::Lap Lap;
+
+        FD_scheme<equations2d1,decltype(domain)> Solver_hash(ghost,domain);
+        FD_scheme<equations2d1,decltype(domain)> Solver_stencil(ghost,domain);
+        Solver_stencil.setStencilAssembly(true);
+
+        Solver_hash.impose(Lap(v) + 0.5*Dx(v),{1,1},{40,40}, prop_id<1>());
+        Solver_hash.impose(v,{0,0},{41,0}, prop_id<0>());
+        Solver_hash.impose(v,{0,1},{0,40}, prop_id<0>());
+        Solver_hash.impose(v,{0,41},{41,41}, prop_id<0>());
+        Solver_hash.impose(v,{41,1},{41,40}, prop_id<0>());
+
+        Solver_stencil.impose(Lap(v) + 0.5*Dx(v),{1,1},{40,40}, prop_id<1>());
+        Solver_stencil.impose(v,{0,0},{41,0}, prop_id<0>());
+        Solver_stencil.impose(v,{0,1},{0,40}, prop_id<0>());
+        Solver_stencil.impose(v,{0,41},{41,41}, prop_id<0>());
+        Solver_stencil.impose(v,{41,1},{41,40}, prop_id<0>());
+
+        auto & t_hash = Solver_hash.getA().getMatrixTriplets();
+        auto & t_stencil = Solver_stencil.getA().getMatrixTriplets();
+
+        BOOST_REQUIRE_EQUAL(t_hash.size(),t_stencil.size());
+
+        std::map<std::pair<long int,long int>,double> m_hash;
+        for (size_t i = 0 ; i < t_hash.size() ; i++)
+        {m_hash[std::make_pair((long int)t_hash.get(i).row(),(long int)t_hash.get(i).col())] += t_hash.get(i).value();}
+
+        std::map<std::pair<long int,long int>,double> m_stencil;
+        for (size_t i = 0 ; i < t_stencil.size() ; i++)
+        {m_stencil[std::make_pair((long int)t_stencil.get(i).row(),(long int)t_stencil.get(i).col())] += t_stencil.get(i).value();}
+
+        BOOST_REQUIRE_EQUAL(m_hash.size(),m_stencil.size());
+
+        auto it_s = m_stencil.begin();
+        for (auto it_h = m_hash.begin() ; it_h != m_hash.end() ; ++it_h, ++it_s)
+        {
+            BOOST_REQUIRE(it_h->first == it_s->first);
+            BOOST_REQUIRE_CLOSE(it_h->second,it_s->second,1e-10);
+        }
+    }
+
+    BOOST_AUTO_TEST_CASE(solver_Lap_matrix_free)
+    {
+        const size_t sz[2] = {42,42};
+        Box<2, double> box({0, 0}, {1, 1});
+        periodicity<2> bc = {NON_PERIODIC, NON_PERIODIC};
+        Ghost<2,long int> ghost(1);
+
+        grid_dist_id<2, double, aggregate<double,double,double>> domain(sz, box, ghost, bc);
+
+        auto it = domain.getDomainIterator();
+        while (it.isNext())
+        {
+            auto key = it.get();
+            auto gkey = it.getGKey(key);
+            double x = gkey.get(0) * domain.spacing(0);
+            double y = gkey.get(1) * domain.spacing(1);
+            domain.get<0>(key) = sin(M_PI*x)*sin(M_PI*y);
+            domain.get<1>(key) = -2*M_PI*M_PI*sin(M_PI*x)*sin(M_PI*y);
+            domain.get<2>(key) = 0.0;
+            ++it;
+        }
+
+        domain.ghost_get<0>();
+        auto v =  FD::getV<0>(domain);
+        auto sol= FD::getV<2>(domain);
+        FD::Lap Lap;
+        FD::LInfError LInfError;
+
+        // assembled system, used only to build the preconditioner
+        FD_scheme<equations2d1,decltype(domain)> SolverP(ghost,domain);
+        SolverP.impose(Lap(sol),{1,1},{40,40}, prop_id<1>());
+        SolverP.impose(sol,{0,0},{41,0}, prop_id<0>());
+        SolverP.impose(sol,{0,1},{0,40}, prop_id<0>());
+        SolverP.impose(sol,{0,41},{41,41}, prop_id<0>());
+        SolverP.impose(sol,{41,1},{41,40}, prop_id<0>());
+
+        FD_scheme<equations2d1,decltype(domain)> Solver(ghost,domain);
+        Solver.setMatrixFree(true);
+        Solver.impose(Lap(sol),{1,1},{40,40}, prop_id<1>());
+        Solver.impose(sol,{0,0},{41,0}, prop_id<0>());
+        Solver.impose(sol,{0,1},{0,40}, prop_id<0>());
+        Solver.impose(sol,{0,41},{41,41}, prop_id<0>());
+        Solver.impose(sol,{41,1},{41,40}, prop_id<0>());
+
+        petsc_solver<double> pet_sol;
+        pet_sol.setSolver(KSPGMRES);
+        pet_sol.setPreconditioner(PCJACOBI);
+        pet_sol.setRelTol(1e-10);
+        Solver.solve_matrix_free(pet_sol,&SolverP.getA(),sol);
+
+        auto linferror = LInfError(v, sol);
+        BOOST_REQUIRE(linferror < 1e-3);
+    }
+
+    BOOST_AUTO_TEST_CASE(solver_Lap_copy_petsc)
+    {
+        const size_t sz[2] = {42,42};
+        Box<2, double> box({0, 0}, {1, 1});
+        periodicity<2> bc = {NON_PERIODIC, NON_PERIODIC};
+        Ghost<2,long int> ghost(1);
+
+        grid_dist_id<2, double, aggregate<double,double,double>> domain(sz, box, ghost, bc);
+        grid_dist_id<2, double, aggregate<double>> g_copy(domain.getDecomposition(), sz, ghost);
+
+        auto it = domain.getDomainIterator();
+        while (it.isNext())
+        {
+            auto key = it.get();
+            auto gkey = it.getGKey(key);
+            double x = gkey.get(0) * domain.spacing(0);
+            double y = gkey.get(1) * domain.spacing(1);
+            domain.get<0>(key) = sin(M_PI*x)*sin(M_PI*y);
+            domain.get<1>(key) = -2*M_PI*M_PI*sin(M_PI*x)*sin(M_PI*y);
+            domain.get<2>(key) = 0.0;
+            ++it;
+        }
+
+        domain.ghost_get<0>();
+        auto sol= FD::getV<2>(domain);
+        FD::Lap Lap;
+
+        FD_scheme<equations2d1,decltype(domain)> Solver(ghost,domain);
+        Solver.impose(Lap(sol),{1,1},{40,40}, prop_id<1>());
+        Solver.impose(sol,{0,0},{41,0}, prop_id<0>());
+        Solver.impose(sol,{0,1},{0,40}, prop_id<0>());
+        Solver.impose(sol,{0,41},{41,41}, prop_id<0>());
+        Solver.impose(sol,{41,1},{41,40}, prop_id<0>());
+
+        petsc_solver<double> pet_sol;
+        pet_sol.setSolver(KSPGMRES);
+        pet_sol.setPreconditioner(PCJACOBI);
+        pet_sol.setRelTol(1e-10);
+        auto x = pet_sol.solve(Solver.getA(),Solver.getB());
+
+        // copied from the local array of the PETSc vector
+        Solver.copy<0>(x,g_copy);
+
+        auto & g_map = Solver.getMap();
+        auto it2 = g_copy.getDomainIterator();
+        auto it_map = g_map.getDomainIterator();
+
+        double worst_copy = 0.0;
+        double worst = 0.0;
+        while (it2.isNext())
+        {
+            auto p = it2.get();
+            auto pm = it_map.get();
+
+            double diff = fabs(g_copy.get<0>(p) - x(g_map.template get<0>(pm)*equations2d1::nvar));
+            worst_copy = (diff > worst_copy)?diff:worst_copy;
+
+            diff = fabs(g_copy.get<0>(p) - domain.get<0>(p));
+            worst = (diff > worst)?diff:worst;
+
+            ++it2;
+            ++it_map;
+        }
+
+        BOOST_REQUIRE_EQUAL(worst_copy,0.0);
+        BOOST_REQUIRE(worst < 1e-3);
+    }
+
     BOOST_AUTO_TEST_CASE(solver_Lap_stag)
     {
         const size_t sz[2] = {82,82};
@@ -21,7 +21,7 @@ namespace FD
 	template<bool cond, typename exp1, typename exp2>
 	struct first_or_second
 	{
-		static auto getGrid(const exp1 & o1, const exp2 & o2) -> decltype(o2.getGrid())
+		__device__ __host__ static auto getGrid(const exp1 & o1, const exp2 & o2) -> decltype(o2.getGrid())
 		{
 			return o2.getGrid();
 		}
@@ -30,7 +30,7 @@ namespace FD
 	template<typename exp1, typename exp2>
 	struct first_or_second<true,exp1,exp2>
 	{
-		static auto getGrid(const exp1 & o1, const exp2 & o2) -> decltype(o1.getGrid())
+		__device__ __host__ static auto getGrid(const exp1 & o1, const exp2 & o2) -> decltype(o1.getGrid())
 		{
 			return o1.getGrid();
 		}
@@ -503,6 +503,109 @@ namespace FD
 		}
 	};
 
+	//! default edge of the tiles of the tiled expression evaluation, in the directions 1 ... dims-1
+	constexpr size_t fd_default_tile = 16;
+
+	/*! \brief Evaluate an expression on every domain point of the local grids, tile by tile
+	 *
+	 * The domain box of every local grid is divided in tiles of lines: along the direction 0 (contiguous in
+	 * memory) a tile cover the full box, in the other directions tile points. The whole expression tree is
+	 * evaluated on a tile before moving to the next one, so the neighbors read by the stencils of all the terms
+	 * (the lines at +-1,+-2 in the other directions) are still in cache when reused by the next lines
+	 *
+	 * \tparam prp property to fill
+	 *
+	 * \param g grid
+	 * \param g_exp expression
+	 * \param s_pos position in the cell
+	 * \param tile edge of the tiles in the directions 1 ... dims-1
+	 *
+	 */
+	template<unsigned int prp, typename grid, typename expr_type>
+	void fd_assign_tiled(grid & g, const expr_type & g_exp, comb<grid::dims> & s_pos, size_t tile)
+	{
+		const unsigned int dim = grid::dims;
+
+		if (tile == 0)	{tile = 1;}
+
+		auto & patches = g.getLocalGridsInfo();
+
+		for (size_t i = 0 ; i < patches.size() ; i++)
+		{
+			auto & Dbox = patches.get(i).Dbox;
+
+			long int lo[dim];
+			long int hi[dim];
+			long int n_tile[dim];
+
+			bool empty = false;
+			for (unsigned int d = 0 ; d < dim ; d++)
+			{
+				lo[d] = Dbox.getLow(d);
+				hi[d] = Dbox.getHigh(d);
+
+				if (hi[d] < lo[d])	{empty = true;}
+
+				n_tile[d] = (d == 0)?1:(hi[d] - lo[d] + tile) / tile;
+			}
+
+			if (empty == true)	{continue;}
+
+			// iterate the tiles
+			long int t[dim];
+			for (unsigned int d = 0 ; d < dim ; d++)	{t[d] = 0;}
+
+			while (t[dim-1] < n_tile[dim-1])
+			{
+				long int t_lo[dim];
+				long int t_hi[dim];
+
+				t_lo[0] = lo[0];
+				t_hi[0] = hi[0];
+				for (unsigned int d = 1 ; d < dim ; d++)
+				{
+					t_lo[d] = lo[d] + t[d]*tile;
+					t_hi[d] = std::min(hi[d],(long int)(t_lo[d] + tile - 1));
+				}
+
+				// iterate the points of the tile, direction 0 inner
+				grid_key_dx<dim> k;
+				for (unsigned int d = 0 ; d < dim ; d++)	{k.set_d(d,t_lo[d]);}
+
+				while (k.get(dim-1) <= t_hi[dim-1])
+				{
+					grid_dist_key_dx<dim> key(i,k);
+
+					for (long int x = t_lo[0] ; x <= t_hi[0] ; x++)
+					{
+						key.getKeyRef().set_d(0,x);
+						g.template getProp<prp>(key) = g_exp.value(key,s_pos);
+					}
+
+					// next line
+					unsigned int d = 1;
+					for ( ; d < dim ; d++)
+					{
+						k.set_d(d,k.get(d) + 1);
+						if (k.get(d) <= t_hi[d] || d == dim-1)	{break;}
+						k.set_d(d,t_lo[d]);
+					}
+
+					if (dim == 1)	{break;}
+				}
+
+				// next tile
+				unsigned int d = 0;
+				for ( ; d < dim ; d++)
+				{
+					t[d]++;
+					if (t[d] < n_tile[d] || d == dim-1)	{break;}
+					t[d] = 0;
+				}
+			}
+		}
+	}
+
 	template<unsigned int prp, typename grid, unsigned int impl>
 	class grid_dist_expression
 	{};
@@ -541,6 +644,19 @@ namespace FD
 		:g(g)
 		{}
 
+		/*! \brief Convert the expression to be evaluated in a kernel on one local grid
+		 *
+		 * \param gk view of the local grid (grid_dist_patch_ker)
+		 *
+		 * \return the expression on the local grid
+		 *
+		 */
+		template<typename ker_type>
+		inline grid_dist_expression<prp,ker_type,NORM_EXPRESSION> toKernel(const ker_type & gk) const
+		{
+			return grid_dist_expression<prp,ker_type,NORM_EXPRESSION>(gk);
+		}
+
 		/*! \brief Return the grid on which is acting
 		 *
 		 * It return the grid used in getVExpr, to get this object
@@ -679,6 +795,29 @@ namespace FD
 			return g;
 		}
 
+		/*! \brief Fill the grid property with the evaluated expression, tile by tile
+		 *
+		 * Same result of operator= when the expression does not read the property it writes (in that case the
+		 * result depend on the order of evaluation), see fd_assign_tiled
+		 *
+		 * \param g_exp expression to evaluate
+		 * \param tile edge of the tiles in the directions 1 ... dims-1
+		 *
+		 * \return the internal grid
+		 *
+		 */
+		template<typename exp1, typename exp2, typename op> grid & assign_tiled(const grid_dist_expression_op<exp1,exp2,op> & g_exp, size_t tile = fd_default_tile)
+		{
+			g_exp.init();
+
+			comb<grid::dims> s_pos;
+			s_pos.mone();
+
+			fd_assign_tiled<prp>(g,g_exp,s_pos,tile);
+
+			return g;
+		}
+
 		/*! \brief Fill the grid property with the double
 		 *
 		 * \param d value to fill
@@ -975,6 +1114,170 @@ namespace FD
 
 	};
 
+	/*! \brief View of one local grid (patch) of a distributed grid, to evaluate the expressions in a kernel
+	 *
+	 * It replaces the distributed grid in the expressions converted with toKernel: the properties are read from the
+	 * local grid with the local part of the key, spacing, position of the patch and boundary conditions are copied
+	 * from the distributed grid
+	 *
+	 * \tparam dim dimensionality
+	 * \tparam grid_ker_type kernel view of the local grid
+	 * \tparam value_type_ properties of the grid
+	 *
+	 */
+	template<unsigned int dim, typename grid_ker_type, typename value_type_>
+	struct grid_dist_patch_ker
+	{
+		//! dimensionality
+		static const unsigned int dims = dim;
+
+		//! properties of the grid
+		typedef value_type_ value_type;
+
+		//! local grid
+		mutable grid_ker_type lg;
+
+		//! grid spacing
+		double h[dim];
+
+		//! global key of the point (0,...,0) of the local grid
+		int origin[dim];
+
+		//! size of the distributed grid
+		int sz[dim];
+
+		//! periodic directions
+		bool periodic[dim];
+
+		//! the grid is staggered
+		bool stag;
+
+		//! property prp of the point k of the local grid
+		template<unsigned int p>
+		__device__ __host__ inline auto getProp(const grid_dist_key_dx<dim> & k) const -> decltype(lg.template get<p>(k.getKey()))
+		{
+			return lg.template get<p>(k.getKey());
+		}
+
+		//! grid spacing in the direction d
+		__device__ __host__ inline double spacing(unsigned int d) const
+		{
+			return h[d];
+		}
+
+		//! true if the grid is staggered
+		__device__ __host__ inline bool is_staggered() const
+		{
+			return stag;
+		}
+	};
+
+	//! Component of a property of a local grid view
+	template<unsigned int nc>
+	struct grid_dist_patch_comp
+	{};
+
+	template<>
+	struct grid_dist_patch_comp<1>
+	{
+		template<typename T>
+		__device__ __host__ static inline auto get(T && v, const int (& comp)[1]) -> decltype(v[comp[0]])
+		{
+			return v[comp[0]];
+		}
+	};
+
+	template<>
+	struct grid_dist_patch_comp<2>
+	{
+		template<typename T>
+		__device__ __host__ static inline auto get(T && v, const int (& comp)[2]) -> decltype(v[comp[0]][comp[1]])
+		{
+			return v[comp[0]][comp[1]];
+		}
+	};
+
+	template<>
+	struct grid_dist_patch_comp<3>
+	{
+		template<typename T>
+		__device__ __host__ static inline auto get(T && v, const int (& comp)[3]) -> decltype(v[comp[0]][comp[1]][comp[2]])
+		{
+			return v[comp[0]][comp[1]][comp[2]];
+		}
+	};
+
+	/*! \brief Grid property operand of an expression evaluated in a kernel on one local grid
+	 *
+	 * Created by toKernel, the view of the local grid is stored by value so the expression can be copied in a kernel
+	 *
+	 * \tparam prp property involved
+	 *
+	 */
+	template<unsigned int prp, unsigned int dim, typename grid_ker_type, typename value_type_>
+	class grid_dist_expression<prp,grid_dist_patch_ker<dim,grid_ker_type,value_type_>,NORM_EXPRESSION>
+	{
+		typedef grid_dist_patch_ker<dim,grid_ker_type,value_type_> grid;
+
+		//! view of the local grid
+		grid g;
+
+	public:
+
+		//! The type of the internal grid
+		typedef grid gtype;
+
+		//! Property id of the point
+		static const unsigned int prop = prp;
+
+		//! constructor from the view of a local grid
+		grid_dist_expression(const grid & g)
+		:g(g)
+		{}
+
+		//! Return the view of the local grid
+		__device__ __host__ grid & getGrid()
+		{
+			return g;
+		}
+
+		//! Return the view of the local grid
+		__device__ __host__ const grid & getGrid() const
+		{
+			return g;
+		}
+
+		//! nothing to initialize
+		inline void init() const
+		{}
+
+		/*! \brief Evaluate the expression
+		 *
+		 * \param k where to evaluate the expression
+		 *
+		 * \return the property at k
+		 *
+		 */
+		__device__ __host__ inline auto value(const grid_dist_key_dx<dim> & k, comb<dim> & c_where) const -> decltype(g.template getProp<prp>(k))
+		{
+			return g.template getProp<prp>(k);
+		}
+
+		/*! \brief Evaluate a component of the expression
+		 *
+		 * \param k where to evaluate the expression
+		 * \param comp component
+		 *
+		 * \return the component of the property at k
+		 *
+		 */
+		template<unsigned int nc>
+		__device__ __host__ inline auto value(const grid_dist_key_dx<dim> & k, comb<dim> & c_where, const int (& comp)[nc]) const -> decltype(grid_dist_patch_comp<nc>::get(g.template getProp<prp>(k),comp))
+		{
+			return grid_dist_patch_comp<nc>::get(g.template getProp<prp>(k),comp);
+		}
+	};
+
 	/*! \brief Main class that encapsulate a double constant
 	 *
 	 * \param prp no meaning
@@ -993,6 +1296,13 @@ namespace FD
 		:d(d)
 		{}
 
+		//! the constant is evaluated in a kernel as it is
+		template<typename ker_type>
+		inline grid_dist_expression<dim,double,NORM_EXPRESSION> toKernel(const ker_type & gk) const
+		{
+			return *this;
+		}
+
 		/*! \brief This function must be called before value
 		 *
 		 * it initialize the expression if needed
@@ -1010,7 +1320,7 @@ namespace FD
 		 * \return the constant value
 		 *
 		 */
-		inline double value(const grid_dist_key_dx<dim> & k, comb<dim> & c_where) const
+		__device__ __host__ inline double value(const grid_dist_key_dx<dim> & k, comb<dim> & c_where) const
 		{
 			return d;
 		}
@@ -1034,6 +1344,13 @@ namespace FD
 		:d(d)
 		{}
 
+		//! the constant is evaluated in a kernel as it is
+		template<typename ker_type>
+		inline grid_dist_expression<dim,double,STAG_EXPRESSION> toKernel(const ker_type & gk) const
+		{
+			return *this;
+		}
+
 		/*! \brief This function must be called before value
 		 *
 		 * it initialize the expression if needed
@@ -1051,7 +1368,7 @@ namespace FD
 		 * \return the constant value
 		 *
 		 */
-		inline double value(const grid_dist_key_dx<dim> & k, comb<dim> & c_where) const
+		__device__ __host__ inline double value(const grid_dist_key_dx<dim> & k, comb<dim> & c_where) const
 		{
 			return d;
 		}
@@ -1078,6 +1395,13 @@ namespace FD
 		:d(d)
 		{}
 
+		//! the constant is evaluated in a kernel as it is
+		template<typename ker_type>
+		inline grid_dist_expression<dim,float,impl> toKernel(const ker_type & gk) const
+		{
+			return *this;
+		}
+
 		/*! \brief This function must be called before value
 		 *
 		 * it initialize the expression if needed
@@ -1095,7 +1419,7 @@ namespace FD
 		 * \return the constant value set in the constructor
 		 *
 		 */
-		inline float value(const grid_dist_key_dx<dim> & k) const
+		__device__ __host__ inline float value(const grid_dist_key_dx<dim> & k) const
 		{
 			return d;
 		}
@@ -1121,6 +1445,19 @@ namespace FD
 				:o1(o1),o2(o2)
 		{}
 
+		/*! \brief Convert the expression to be evaluated in a kernel on one local grid
+		 *
+		 * \param gk view of the local grid (grid_dist_patch_ker)
+		 *
+		 * \return the expression on the local grid
+		 *
+		 */
+		template<typename ker_type>
+		inline auto toKernel(const ker_type & gk) const -> grid_dist_expression_op<decltype(o1.toKernel(gk)),decltype(o2.toKernel(gk)),sum>
+		{
+			return grid_dist_expression_op<decltype(o1.toKernel(gk)),decltype(o2.toKernel(gk)),sum>(o1.toKernel(gk),o2.toKernel(gk));
+		}
+
 		/*! \brief This function must be called before value
 		*
 		* it initialize the expression if needed
@@ -1139,7 +1476,7 @@ namespace FD
 		 * \return the result of the expression
 		 *
 		 */
-		inline auto value(grid_dist_key_dx<gtype::dims> & key, comb<gtype::dims> & c_where) const -> typename std::remove_reference<decltype(o1.value(key,c_where))>::type
+		__device__ __host__ inline auto value(grid_dist_key_dx<gtype::dims> & key, comb<gtype::dims> & c_where) const -> typename std::remove_reference<decltype(o1.value(key,c_where))>::type
 		{
 			typename std::remove_reference<decltype(o1.value(key,c_where))>::type val;
 
@@ -1153,7 +1490,7 @@ namespace FD
 		 * \return the grid
 		 *
 		 */
-		gtype & getGrid()
+		__device__ __host__ gtype & getGrid()
 		{
 			return o1.getGrid();
 		}
@@ -1165,7 +1502,7 @@ namespace FD
 		* \return the grid
 		*
 		*/
-		const gtype & getGrid() const
+		__device__ __host__ const gtype & getGrid() const
 		{
 			return o1.getGrid();
 		}
@@ -1206,6 +1543,19 @@ namespace FD
 				:o1(o1),o2(o2)
 		{}
 
+		/*! \brief Convert the expression to be evaluated in a kernel on one local grid
+		 *
+		 * \param gk view of the local grid (grid_dist_patch_ker)
+		 *
+		 * \return the expression on the local grid
+		 *
+		 */
+		template<typename ker_type>
+		inline auto toKernel(const ker_type & gk) const -> grid_dist_expression_op<decltype(o1.toKernel(gk)),decltype(o2.toKernel(gk)),sub>
+		{
+			return grid_dist_expression_op<decltype(o1.toKernel(gk)),decltype(o2.toKernel(gk)),sub>(o1.toKernel(gk),o2.toKernel(gk));
+		}
+
 		/*! \brief This function must be called before value
 		*
 		* it initialize the expression if needed
@@ -1224,7 +1574,7 @@ namespace FD
 		 * \return the result of the expression
 		 *
 		 */
-		inline auto value(grid_dist_key_dx<gtype::dims> & key, comb<gtype::dims> & c_where) const -> typename std::remove_reference<decltype(o1.value(key,c_where))>::type
+		__device__ __host__ inline auto value(grid_dist_key_dx<gtype::dims> & key, comb<gtype::dims> & c_where) const -> typename std::remove_reference<decltype(o1.value(key,c_where))>::type
 		{
 			typename std::remove_reference<decltype(o1.value(key,c_where))>::type val;
 
@@ -1238,7 +1588,7 @@ namespace FD
 		 * \return the grid
 		 *
 		 */
-		gtype & getGrid()
+		__device__ __host__ gtype & getGrid()
 		{
 			return o1.getGrid();
 		}
@@ -1250,7 +1600,7 @@ namespace FD
 		* \return the grid
 		*
 		*/
-		const gtype & getGrid() const
+		__device__ __host__ const gtype & getGrid() const
 		{
 			return o1.getGrid();
 		}
@@ -1287,6 +1637,19 @@ namespace FD
                 :o1(o1)
         {}
 
+        /*! \brief Convert the expression to be evaluated in a kernel on one local grid
+         *
+         * \param gk view of the local grid (grid_dist_patch_ker)
+         *
+         * \return the expression on the local grid
+         *
+         */
+        template<typename ker_type>
+        inline auto toKernel(const ker_type & gk) const -> grid_dist_expression_op<decltype(o1.toKernel(gk)),void,subuni>
+        {
+            return grid_dist_expression_op<decltype(o1.toKernel(gk)),void,subuni>(o1.toKernel(gk));
+        }
+
         /*! \brief This function must be called before value
         *
         * it initialize the expression if needed
@@ -1304,7 +1667,7 @@ namespace FD
          * \return the result of the expression
          *
          */
-        inline auto value(grid_dist_key_dx<gtype::dims> & key, comb<gtype::dims> & c_where) const -> typename std::remove_reference<decltype(o1.value(key,c_where))>::type
+        __device__ __host__ inline auto value(grid_dist_key_dx<gtype::dims> & key, comb<gtype::dims> & c_where) const -> typename std::remove_reference<decltype(o1.value(key,c_where))>::type
         {
             typename std::remove_reference<decltype(o1.value(key,c_where))>::type val;
 
@@ -1318,7 +1681,7 @@ namespace FD
          * \return the grid
          *
          */
-        gtype & getGrid()
+        __device__ __host__ gtype & getGrid()
         {
             return o1.getGrid();
         }
@@ -1330,7 +1693,7 @@ namespace FD
         * \return the grid
         *
         */
-        const gtype & getGrid() const
+        __device__ __host__ const gtype & getGrid() const
         {
             return o1.getGrid();
         }
@@ -1369,6 +1732,19 @@ namespace FD
 				:o1(o1),o2(o2)
 		{}
 
+		/*! \brief Convert the expression to be evaluated in a kernel on one local grid
+		 *
+		 * \param gk view of the local grid (grid_dist_patch_ker)
+		 *
+		 * \return the expression on the local grid
+		 *
+		 */
+		template<typename ker_type>
+		inline auto toKernel(const ker_type & gk) const -> grid_dist_expression_op<decltype(o1.toKernel(gk)),decltype(o2.toKernel(gk)),mul>
+		{
+			return grid_dist_expression_op<decltype(o1.toKernel(gk)),decltype(o2.toKernel(gk)),mul>(o1.toKernel(gk),o2.toKernel(gk));
+		}
+
 		/*! \brief This function must be called before value
 		*
 		* it initialize the expression if needed
@@ -1387,7 +1763,7 @@ namespace FD
 		 * \return the result of the expression
 		 *
 		 */
-		inline auto value(grid_dist_key_dx<gtype::dims> & key, comb<gtype::dims> & c_where) const -> typename std::remove_reference<decltype(o1.value(key,c_where))>::type
+		__device__ __host__ inline auto value(grid_dist_key_dx<gtype::dims> & key, comb<gtype::dims> & c_where) const -> typename std::remove_reference<decltype(o1.value(key,c_where))>::type
 		{
 			typename std::remove_reference<decltype(o1.value(key,c_where))>::type val;
 
@@ -1401,7 +1777,7 @@ namespace FD
 		 * \return the grid
 		 *
 		 */
-		auto getGrid() -> decltype(first_or_second<has_getGrid<exp1>::value,exp1,exp2>::getGrid(o1,o2))
+		__device__ __host__ auto getGrid() -> decltype(first_or_second<has_getGrid<exp1>::value,exp1,exp2>::getGrid(o1,o2))
 		{
 			return first_or_second<has_getGrid<exp1>::value,exp1,exp2>::getGrid(o1,o2);
 		}
@@ -1413,7 +1789,7 @@ namespace FD
 		* \return the grid
 		*
 		*/
-		auto getGrid() const -> decltype(first_or_second<has_getGrid<exp1>::value,exp1,exp2>::getGrid(o1,o2))
+		__device__ __host__ auto getGrid() const -> decltype(first_or_second<has_getGrid<exp1>::value,exp1,exp2>::getGrid(o1,o2))
 		{
 			return first_or_second<has_getGrid<exp1>::value,exp1,exp2>::getGrid(o1,o2);
 		}
@@ -1483,7 +1859,7 @@ namespace FD
 	struct get_grid_dist_expression_op<1,false>
 	{
 		template<typename exp_type>
-		static int get(exp_type & o1, grid_dist_key_dx<exp_type::gtype::dims> & key, comb<exp_type::gtype::dims> & c_where, const int (& comp)[1])
+		__device__ __host__ static int get(exp_type & o1, grid_dist_key_dx<exp_type::gtype::dims> & key, comb<exp_type::gtype::dims> & c_where, const int (& comp)[1])
 		{
 			printf("ERROR: Slicer, the expression is incorrect, please check it\n");
 			return 0;
@@ -1513,7 +1889,7 @@ namespace FD
 	struct get_grid_dist_expression_op<1,true>
 	{
 		template<typename exp_type>
-		static auto get(exp_type & o1, grid_dist_key_dx<exp_type::gtype::dims> & key, comb<exp_type::gtype::dims> & c_where, const int (& comp)[1]) -> decltype(o1.value(key,c_where,comp) )
+		__device__ __host__ static auto get(exp_type & o1, grid_dist_key_dx<exp_type::gtype::dims> & key, comb<exp_type::gtype::dims> & c_where, const int (& comp)[1]) -> decltype(o1.value(key,c_where,comp) )
 		{
 			return o1.value(key,c_where,comp);
 		}
@@ -1541,7 +1917,7 @@ namespace FD
 	struct get_grid_dist_expression_op<2,false>
 	{
 		template<typename exp_type>
-		static auto get(exp_type & o1, grid_dist_key_dx<exp_type::gtype::dims> & key, comb<exp_type::gtype::dims> & c_where, const int (& comp)[2]) -> decltype(o1.value(key,c_where,comp) )
+		__device__ __host__ static auto get(exp_type & o1, grid_dist_key_dx<exp_type::gtype::dims> & key, comb<exp_type::gtype::dims> & c_where, const int (& comp)[2]) -> decltype(o1.value(key,c_where,comp) )
 		{
 			printf("ERROR: Slicer, the expression is incorrect, please check it\n");
 			return o1.value(key,c_where,comp);
@@ -1573,7 +1949,7 @@ namespace FD
 	struct get_grid_dist_expression_op<2,true>
 	{
 		template<typename exp_type>
-		static auto get(exp_type & o1, grid_dist_key_dx<exp_type::gtype::dims> & key, comb<exp_type::gtype::dims> & c_where, const int (& comp)[2]) -> decltype(o1.value(key,c_where,comp) )
+		__device__ __host__ static auto get(exp_type & o1, grid_dist_key_dx<exp_type::gtype::dims> & key, comb<exp_type::gtype::dims> & c_where, const int (& comp)[2]) -> decltype(o1.value(key,c_where,comp) )
 		{
 			return o1.value(key,c_where,comp);
 		}
@@ -1601,7 +1977,7 @@ namespace FD
 	struct get_grid_dist_expression_op<3,true>
 	{
 		template<typename exp_type>
-		static auto get(exp_type & o1, grid_dist_key_dx<exp_type::gtype::dims> & key, comb<exp_type::gtype::dims> & c_where, const int (& comp)[3]) -> decltype(o1.value(key,c_where,comp) )
+		__device__ __host__ static auto get(exp_type & o1, grid_dist_key_dx<exp_type::gtype::dims> & key, comb<exp_type::gtype::dims> & c_where, const int (& comp)[3]) -> decltype(o1.value(key,c_where,comp) )
 		{
 			return o1.value(key,c_where,comp);
 		}
@@ -1664,6 +2040,23 @@ namespace FD
 			{this->comp[i] = comp[i];}
 		}
 
+		/*! \brief Convert the expression to be evaluated in a kernel on one local grid
+		 *
+		 * \param gk view of the local grid (grid_dist_patch_ker)
+		 *
+		 * \return the expression on the local grid
+		 *
+		 */
+		template<typename ker_type>
+		inline auto toKernel(const ker_type & gk) const -> grid_dist_expression_op<decltype(o1.toKernel(gk)),boost::mpl::int_<n>,g_comp>
+		{
+			int c[n];
+			for (int i = 0 ; i < n ; i++)
+			{c[i] = comp[i];}
+
+			return grid_dist_expression_op<decltype(o1.toKernel(gk)),boost::mpl::int_<n>,g_comp>(o1.toKernel(gk),c,var_id);
+		}
+
 	    /*! \brief Return the vector on which is acting
 	    *
 	    * It return the vector used in getVExpr, to get this object
@@ -1671,7 +2064,7 @@ namespace FD
 	    * \return the vector
 	    *
 	    */
-	    const gtype & getGrid() const
+	    __device__ __host__ const gtype & getGrid() const
 	    {
 	        return o1.getGrid();
 	    }
@@ -1683,7 +2076,7 @@ namespace FD
 	    * \return the vector
 	    *
 	    */
-	    gtype & getGrid()
+	    __device__ __host__ gtype & getGrid()
 	    {
 	        return o1.getGrid();
 	    }
@@ -1707,7 +2100,7 @@ namespace FD
 		 *
 		 *
 		 */
-		inline auto value(grid_dist_key_dx<gtype::dims> & key, comb<gtype::dims> & c_where) const -> decltype(get_grid_dist_expression_op<n,n == rank_gen<property_act>::type::value>::get(o1,key,c_where,comp))
+		__device__ __host__ inline auto value(grid_dist_key_dx<gtype::dims> & key, comb<gtype::dims> & c_where) const -> decltype(get_grid_dist_expression_op<n,n == rank_gen<property_act>::type::value>::get(o1,key,c_where,comp))
 		{
 			return get_grid_dist_expression_op<n,n == rank_gen<property_act>::type::value>::get(o1,key,c_where,comp);
 		}
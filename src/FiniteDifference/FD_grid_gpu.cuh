@@ -0,0 +1,444 @@
+//
+// Upwind and central gradients on GPU grids
+//
+/**
+ * @file FD_grid_gpu.cuh
+ *
+ * @brief Device versions of #get_upwind_gradient() and #get_central_FD_grid() for grid_dist_id with GPU local grids
+ *
+ * @details The property is read and written on the device copy of the local grids, one kernel is launched for every
+ * local grid (patch). The stencils are the same of the CPU versions (#WENO_5_point(), #ENO_3_point(), #FD_1_point()),
+ * so CPU and GPU give the same gradient. The ghost is exchanged on the device (RUN_ON_DEVICE).
+ * #fd_assign_gpu() evaluates the FD grid expressions (FD_op.hpp) in the same way, one fused kernel per local grid.
+ */
+#ifndef OPENFPM_NUMERICS_SRC_FINITEDIFFERENCE_FD_GRID_GPU_CUH
+#define OPENFPM_NUMERICS_SRC_FINITEDIFFERENCE_FD_GRID_GPU_CUH
+
+#if defined(__NVCC__)
+
+#include "Grid/grid_dist_id.hpp"
+#include "FD_simple.hpp"
+#include "Upwind_gradient.hpp"
+#include "FD_op.hpp"
+
+/**@brief Get the key of the current thread in the iterator range
+ *
+ * @param ite GPU iterator of the patch.
+ * @param key Output key of the grid node.
+ * @return false if the thread is outside of the range.
+ */
+template<unsigned int dim>
+__device__ inline bool fd_gpu_key(const ite_gpu<dim> & ite, grid_key_dx<dim,int> & key)
+{
+	key.set_d(0, threadIdx.x + blockIdx.x * blockDim.x + ite.start.get(0));
+	if (dim > 1) {key.set_d(1, threadIdx.y + blockIdx.y * blockDim.y + ite.start.get(1));}
+	if (dim > 2) {key.set_d(2, threadIdx.z + blockIdx.z * blockDim.z + ite.start.get(2));}
+
+	for (unsigned int d = 0 ; d < dim ; d++)
+	{
+		if (key.get(d) > ite.stop.get(d))	{return false;}
+	}
+
+	return true;
+}
+
+/**@brief Gather the 7 values around a node in direction d, clamped to the allocated local grid
+ *
+ * @param g Local grid (kernel view).
+ * @param key Key of the node.
+ * @param d Direction.
+ * @param gd_hi Last allocated node of the local grid (ghost included).
+ * @param p Output values, p[3] is the node.
+ */
+template<unsigned int Field, unsigned int dim, typename grid_type, typename T>
+__device__ inline void fd_gpu_gather(grid_type & g, const grid_key_dx<dim,int> & key, unsigned int d,
+                                     const grid_key_dx<dim,int> & gd_hi, T (& p)[7])
+{
+	grid_key_dx<dim,int> k = key;
+	for (int m = 0 ; m < 7 ; m++)
+	{
+		int x = key.get(d) - 3 + m;
+		x = (x < 0)?0:x;
+		x = (x > gd_hi.get(d))?gd_hi.get(d):x;
+		k.set_d(d,x);
+		p[m] = g.template get<Field>(k);
+	}
+}
+
+/**@brief Kernel computing the upwind gradient on the domain nodes of one patch
+ *
+ * @param g Local grid (kernel view).
+ * @param ite GPU iterator over the domain of the patch.
+ * @param gd_hi Last allocated node of the local grid (ghost included).
+ * @param origin Global key of the node (0,...,0) of the local grid.
+ * @param sz Global grid size.
+ * @param h Grid spacing.
+ * @param one_sided_BC If true, use one-sided kernel for boundary-nodes.
+ * @param order Order of accuracy: 1, 3, 5 or #WENO_Z_5.
+ */
+template<unsigned int dim, unsigned int Field, unsigned int Gradient, typename grid_type>
+__global__ void upwind_gradient_gpu_ker(grid_type g, ite_gpu<dim> ite, grid_key_dx<dim,int> gd_hi,
+                                        grid_key_dx<dim,int> origin, grid_key_dx<dim,int> sz, Point<dim,double> h,
+                                        bool one_sided_BC, int order)
+{
+	typedef typename std::decay<decltype(g.template get<Field>(grid_key_dx<dim,int>()))>::type field_type;
+
+	grid_key_dx<dim,int> key;
+	if (fd_gpu_key(ite,key) == false)	{return;}
+
+	for (unsigned int d = 0 ; d < dim ; d++)
+	{
+		field_type p_[7];
+		fd_gpu_gather<Field>(g,key,d,gd_hi,p_);
+		const field_type * p = p_ + 3;
+
+		// same as get_sign_velocity in FD_upwind
+		int sign = (field_type(0) < p[0]) - (p[0] < field_type(0));
+
+		field_type dplus_1, dminus_1, dplus, dminus;
+		FD_1_point(p, h.get(d), dplus_1, dminus_1);
+
+		dplus = dplus_1;
+		dminus = dminus_1;
+		if (order == 3)	{ENO_3_point(p, h.get(d), dplus, dminus);}
+		else if (order == 5)	{WENO_5_point(p, h.get(d), dplus, dminus);}
+		else if (order == WENO_Z_5)	{WENO_5_point<field_type,true>(p, h.get(d), dplus, dminus);}
+
+		int gk = key.get(d) + origin.get(d);
+		int N = sz.get(d);
+
+		field_type grad;
+		if (one_sided_BC == false || (gk > 2 && gk < N - 3))
+		{grad = upwinding(dplus, dminus, sign);}
+		else if (gk > 0 && gk < N - 1)
+		{grad = upwinding(dplus_1, dminus_1, sign);}
+		else if (gk == 0)
+		{grad = dplus_1;}
+		else
+		{grad = dminus_1;}
+
+		g.template get<Gradient>(key)[d] = grad;
+	}
+}
+
+/**@brief Kernel computing the central finite difference on the domain nodes of one patch
+ *
+ * @param g Local grid (kernel view).
+ * @param ite GPU iterator over the domain of the patch.
+ * @param origin Global key of the node (0,...,0) of the local grid.
+ * @param sz Global grid size.
+ * @param h Grid spacing.
+ * @param one_sided_BC If true, stencil becoming 1st order one sided at the grid boundary.
+ */
+template<unsigned int dim, unsigned int Field, unsigned int Gradient, typename grid_type>
+__global__ void central_FD_gpu_ker(grid_type g, ite_gpu<dim> ite, grid_key_dx<dim,int> origin,
+                                   grid_key_dx<dim,int> sz, Point<dim,double> h, bool one_sided_BC)
+{
+	grid_key_dx<dim,int> key;
+	if (fd_gpu_key(ite,key) == false)	{return;}
+
+	for (unsigned int d = 0 ; d < dim ; d++)
+	{
+		int gk = key.get(d) + origin.get(d);
+		int N = sz.get(d);
+
+		grid_key_dx<dim,int> kp = key;
+		grid_key_dx<dim,int> km = key;
+		kp.set_d(d,key.get(d) + 1);
+		km.set_d(d,key.get(d) - 1);
+
+		if (one_sided_BC == false || (gk > 0 && gk < N - 1))
+		{g.template get<Gradient>(key)[d] = (g.template get<Field>(kp) - g.template get<Field>(km)) / (2 * h.get(d));}
+		else if (gk == 0)
+		{g.template get<Gradient>(key)[d] = (g.template get<Field>(kp) - g.template get<Field>(key)) / h.get(d);}
+		else
+		{g.template get<Gradient>(key)[d] = (g.template get<Field>(key) - g.template get<Field>(km)) / h.get(d);}
+	}
+}
+
+/**@brief Launch a kernel on the domain of every patch of a GPU grid
+ *
+ * @param grid GPU grid.
+ * @param launch Functor called with (local grid, GPU iterator, patch info) for every not empty patch.
+ */
+template <typename gridtype, typename launch_type>
+void fd_gpu_for_each_patch(gridtype & grid, launch_type launch)
+{
+	const unsigned int dim = gridtype::dims;
+	auto & patches = grid.getLocalGridsInfo();
+
+	for (size_t i = 0 ; i < patches.size() ; i++)
+	{
+		auto & Dbox = patches.get(i).Dbox;
+
+		grid_key_dx<dim,long int> start;
+		grid_key_dx<dim,long int> stop;
+		bool empty = false;
+		for (unsigned int d = 0 ; d < dim ; d++)
+		{
+			start.set_d(d,Dbox.getLow(d));
+			stop.set_d(d,Dbox.getHigh(d));
+			if (Dbox.getHigh(d) < Dbox.getLow(d))	{empty = true;}
+		}
+		if (empty == true)	{continue;}
+
+		auto & lg = grid.get_loc_grid(i);
+		auto ite = lg.getGPUIterator(start,stop);
+
+		launch(lg,ite,patches.get(i));
+	}
+}
+
+/**@brief Computes the upwind gradient with order of accuracy 1, 3 or 5 on a GPU grid.
+ *
+ * @details Same as #get_upwind_gradient(), but the property Field_in is read from the device and the gradient is
+ * written on the device, one kernel launch per local grid. The sign is taken from Field_in as in #FD_upwind().
+ *
+ * @tparam Field_in Size_t index of property for which the gradient should be computed.
+ * @tparam Velocity Size_t index of property that contains the velocity field.
+ * @tparam Gradient_out Size_t index of property where the upwind gradient result should be stored.
+ * @tparam gridtype Type of input grid (GPU local grids).
+ * @param grid Grid, on which the gradient should be computed.
+ * @param order Order of accuracy of the difference scheme. Can be 1, 3, 5 or #WENO_Z_5.
+ * @param one_sided_BC Bool variable, if true, use one-sided kernel for boundary-nodes.
+ */
+template <size_t Field_in, size_t Velocity, size_t Gradient_out, typename gridtype>
+void get_upwind_gradient_gpu(gridtype & grid, size_t order=5, const bool one_sided_BC=true)
+{
+	const unsigned int dim = gridtype::dims;
+	static_assert(dim <= 3, "get_upwind_gradient_gpu is implemented up to 3D");
+
+	if (order != 1 && order != 3 && order != 5 && order != WENO_Z_5)
+	{
+		auto &v_cl = create_vcluster();
+		if (v_cl.rank() == 0) std::cout << "Order of accuracy chosen not valid. Using default order 1." << std::endl;
+		order = 1;
+	}
+
+	if (!one_sided_BC && !ghost_width_is_sufficient(grid, (order > 1) ? 3 : 1))
+	{
+		std::cerr << __FILE__ << ":" << __LINE__ << " Error: Ghost layer not big enough. Either run with "
+		             "one_sided_BC=true or create a larger ghost layer" << std::endl;
+		return;
+	}
+
+	grid.template ghost_get<Field_in>(RUN_ON_DEVICE);
+	grid.template ghost_get<Velocity>(RUN_ON_DEVICE);
+
+	grid_key_dx<dim,int> sz;
+	Point<dim,double> h;
+	for (unsigned int d = 0 ; d < dim ; d++)
+	{
+		sz.set_d(d,grid.size(d));
+		h.get(d) = grid.getSpacing()[d];
+	}
+
+	fd_gpu_for_each_patch(grid,[&](auto & lg, auto & ite, auto & patch)
+	{
+		grid_key_dx<dim,int> gd_hi;
+		grid_key_dx<dim,int> origin;
+		for (unsigned int d = 0 ; d < dim ; d++)
+		{
+			gd_hi.set_d(d,patch.GDbox.getHigh(d));
+			origin.set_d(d,patch.origin[d]);
+		}
+
+		CUDA_LAUNCH((upwind_gradient_gpu_ker<dim,Field_in,Gradient_out>),ite,lg.toKernel(),ite,gd_hi,origin,sz,h,
+		            one_sided_BC,(int)order);
+	});
+}
+
+/**@brief Computes the central finite difference of a scalar field on a GPU grid.
+ *
+ * @details Same as #get_central_FD_grid(), one kernel launch per local grid.
+ *
+ * @tparam Field Size_t index of input property for which the gradient should be computed (scalar field).
+ * @tparam Gradient Size_t index of output property (vector field).
+ * @tparam gridtype Type of input grid (GPU local grids).
+ * @param grid Grid, on which the gradient should be computed.
+ * @param one_sided_BC Boolian. If true, stencil becoming 1st order one sided at the grid boundary (fwd/bwd FD).
+ */
+template <size_t Field, size_t Gradient, typename gridtype>
+void get_central_FD_grid_gpu(gridtype & grid, const bool one_sided_BC)
+{
+	const unsigned int dim = gridtype::dims;
+	static_assert(dim <= 3, "get_central_FD_grid_gpu is implemented up to 3D");
+
+	grid.template ghost_get<Field>(RUN_ON_DEVICE | KEEP_PROPERTIES);
+
+	grid_key_dx<dim,int> sz;
+	Point<dim,double> h;
+	for (unsigned int d = 0 ; d < dim ; d++)
+	{
+		sz.set_d(d,grid.size(d));
+		h.get(d) = grid.getSpacing()[d];
+	}
+
+	fd_gpu_for_each_patch(grid,[&](auto & lg, auto & ite, auto & patch)
+	{
+		grid_key_dx<dim,int> origin;
+		for (unsigned int d = 0 ; d < dim ; d++)	{origin.set_d(d,patch.origin[d]);}
+
+		CUDA_LAUNCH((central_FD_gpu_ker<dim,Field,Gradient>),ite,lg.toKernel(),ite,origin,sz,h,one_sided_BC);
+	});
+}
+
+/**@brief Mark the properties of an FD expression read with a stencil (under a derivative)
+ *
+ * @details Only these properties need the ghost before evaluating the expression. Constants and the not
+ * specialized operands read nothing.
+ */
+template<typename expr_type>
+struct fd_gpu_ghost_props
+{
+	static void mark(bool * gp, bool stencil)
+	{}
+};
+
+template<unsigned int prp, typename grid>
+struct fd_gpu_ghost_props<FD::grid_dist_expression<prp,grid,FD::NORM_EXPRESSION>>
+{
+	static void mark(bool * gp, bool stencil)
+	{
+		if (stencil == true)	{gp[prp] = true;}
+	}
+};
+
+template<unsigned int dim>
+struct fd_gpu_ghost_props<FD::grid_dist_expression<dim,double,FD::NORM_EXPRESSION>>
+{
+	static void mark(bool * gp, bool stencil)
+	{}
+};
+
+template<unsigned int dim>
+struct fd_gpu_ghost_props<FD::grid_dist_expression<dim,float,FD::NORM_EXPRESSION>>
+{
+	static void mark(bool * gp, bool stencil)
+	{}
+};
+
+template<typename exp1, typename exp2, typename op>
+struct fd_gpu_ghost_props<FD::grid_dist_expression_op<exp1,exp2,op>>
+{
+	static void mark(bool * gp, bool stencil)
+	{
+		fd_gpu_ghost_props<exp1>::mark(gp,stencil);
+		fd_gpu_ghost_props<exp2>::mark(gp,stencil);
+	}
+};
+
+template<typename exp1, unsigned int dir, unsigned int ord_d, unsigned int ord, unsigned int impl>
+struct fd_gpu_ghost_props<FD::grid_dist_expression_op<exp1,void,FD::GRID_DERIVATIVE<dir,ord_d,ord,impl>>>
+{
+	static void mark(bool * gp, bool stencil)
+	{
+		fd_gpu_ghost_props<exp1>::mark(gp,true);
+	}
+};
+
+/**@brief Exchange on the device the ghost of the marked properties
+ *
+ * @tparam gridtype Type of the grid (GPU local grids).
+ */
+template<typename gridtype>
+struct fd_gpu_ghost_get
+{
+	//! grid
+	gridtype & grid;
+
+	//! properties that need the ghost
+	const bool * gp;
+
+	fd_gpu_ghost_get(gridtype & grid, const bool * gp)
+	:grid(grid),gp(gp)
+	{}
+
+	template<typename T>
+	inline void operator()(T & t) const
+	{
+		if (gp[T::value] == true)
+		{grid.template ghost_get<T::value>(RUN_ON_DEVICE | KEEP_PROPERTIES);}
+	}
+};
+
+/**@brief Kernel evaluating an FD expression on the domain nodes of one patch
+ *
+ * @param g Local grid (kernel view).
+ * @param ite GPU iterator over the domain of the patch.
+ * @param expr Expression converted with toKernel on the patch.
+ */
+template<unsigned int prp, unsigned int dim, typename grid_type, typename expr_type>
+__global__ void fd_assign_gpu_ker(grid_type g, ite_gpu<dim> ite, expr_type expr)
+{
+	grid_key_dx<dim,int> key;
+	if (fd_gpu_key(ite,key) == false)	{return;}
+
+	grid_dist_key_dx<dim> k;
+	comb<dim> c_where;
+	for (unsigned int d = 0 ; d < dim ; d++)
+	{
+		k.getKeyRef().set_d(d,key.get(d));
+		c_where.c[d] = 0;
+	}
+
+	g.template get<prp>(key) = expr.value(k,c_where);
+}
+
+/**@brief Evaluates an FD grid expression on a GPU grid, lhs = e.
+ *
+ * @details Device version of the assignment of the FD expressions (FD::getV, FD::Derivative_x, ...): the whole
+ * expression is evaluated in one kernel per local grid, without temporaries. The properties read under a derivative
+ * get the ghost on the device before the launch, the others are read on the domain only. The properties must be on
+ * the device, the result is left on the device. Staggered grids are not supported.
+ *
+ * @param lhs Property to fill (FD::getV<prp>(grid)).
+ * @param e Expression to evaluate.
+ */
+template <unsigned int prp, typename gridtype, typename expr_type>
+void fd_assign_gpu(FD::grid_dist_expression<prp,gridtype,FD::NORM_EXPRESSION> lhs, const expr_type & e)
+{
+	const unsigned int dim = gridtype::dims;
+	typedef typename gridtype::value_type value_type;
+	typedef decltype(lhs.getGrid().get_loc_grid(0).toKernel()) grid_ker_type;
+
+	gridtype & grid = lhs.getGrid();
+
+	if (grid.is_staggered() == true)
+	{
+		std::cerr << __FILE__ << ":" << __LINE__ << " error, fd_assign_gpu does not support staggered grids" << std::endl;
+		return;
+	}
+
+	bool gp[value_type::max_prop];
+	for (size_t i = 0 ; i < value_type::max_prop ; i++)	{gp[i] = false;}
+	fd_gpu_ghost_props<expr_type>::mark(gp,false);
+
+	fd_gpu_ghost_get<gridtype> gg(grid,gp);
+	boost::mpl::for_each_ref<boost::mpl::range_c<int,0,value_type::max_prop>>(gg);
+
+	e.init();
+
+	FD::grid_dist_patch_ker<dim,grid_ker_type,value_type> gk;
+	gk.stag = false;
+	for (unsigned int d = 0 ; d < dim ; d++)
+	{
+		gk.h[d] = grid.spacing(d);
+		gk.sz[d] = grid.size(d);
+		gk.periodic[d] = grid.getDecomposition().periodicity()[d];
+	}
+
+	fd_gpu_for_each_patch(grid,[&](auto & lg, auto & ite, auto & patch)
+	{
+		gk.lg = lg.toKernel();
+		for (unsigned int d = 0 ; d < dim ; d++)	{gk.origin[d] = patch.origin[d];}
+
+		auto e_ker = e.toKernel(gk);
+
+		CUDA_LAUNCH((fd_assign_gpu_ker<prp,dim>),ite,lg.toKernel(),ite,e_ker);
+	});
+}
+
+#endif
+
+#endif //OPENFPM_NUMERICS_SRC_FINITEDIFFERENCE_FD_GRID_GPU_CUH
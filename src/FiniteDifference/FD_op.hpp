@@ -35,7 +35,7 @@ namespace FD
     struct Derivative_impl<dir,1,2,CENTRAL>
     {
         template<typename rtype,typename expr_type>
-        static inline rtype calculate(expr_type & o1, grid_dist_key_dx<expr_type::gtype::dims> & key,comb<expr_type::gtype::dims> & c_where)
+        __device__ __host__ static inline rtype calculate(expr_type & o1, grid_dist_key_dx<expr_type::gtype::dims> & key,comb<expr_type::gtype::dims> & c_where)
         {
             // x0, dx are defined in proper dir є(x, y, z)
             auto dx = o1.getGrid().spacing(dir);
@@ -78,7 +78,7 @@ namespace FD
     struct Derivative_impl<dir,1,2,CENTRAL_STAG>
     {
         template<typename rtype,typename expr_type>
-        static inline rtype calculate(expr_type & o1, grid_dist_key_dx<expr_type::gtype::dims> & key,comb<expr_type::gtype::dims> & c_where)
+        __device__ __host__ static inline rtype calculate(expr_type & o1, grid_dist_key_dx<expr_type::gtype::dims> & key,comb<expr_type::gtype::dims> & c_where)
         {
         	rtype ret;
             // x0, dx are defined in proper dir є(x, y, z)
@@ -160,7 +160,7 @@ namespace FD
     struct Derivative_impl<dir,2,2,CENTRAL>
     {
         template<typename rtype,typename expr_type>
-        static inline rtype calculate(expr_type & o1, grid_dist_key_dx<expr_type::gtype::dims> & key, comb<expr_type::gtype::dims> & c_where)
+        __device__ __host__ static inline rtype calculate(expr_type & o1, grid_dist_key_dx<expr_type::gtype::dims> & key, comb<expr_type::gtype::dims> & c_where)
         {
             // x0, dx are defined in proper dir є(x, y, z)
             auto dx = o1.getGrid().spacing(dir);
@@ -231,11 +231,39 @@ namespace FD
         return one_side_direction::OS_CENTRAL;
     }
 
+    /*! \brief One sided derivatives at the non periodic boundaries, for the expressions evaluated on a local grid
+     *
+     * \param g view of the local grid
+     * \param dir direction of the derivative
+     * \param key point of the local grid
+     *
+     */
+    template<unsigned int dim, typename grid_ker_type, typename value_type, typename key_type>
+    __device__ __host__ one_side_direction use_one_side(const grid_dist_patch_ker<dim,grid_ker_type,value_type> & g, unsigned int dir, key_type & key)
+    {
+        if (g.periodic[dir] == true)
+        {
+            return one_side_direction::OS_CENTRAL;
+        }
+
+        int keyg = g.origin[dir] + key.getKeyRef().get(dir);
+        if (keyg == 0)
+        {
+            return one_side_direction::OS_FORWARD;
+        }
+        else if (keyg == g.sz[dir] - 1)
+        {
+            return one_side_direction::OS_BACKWARD;
+        }
+
+        return one_side_direction::OS_CENTRAL;
+    }
+
     template<unsigned int dir>
     struct Derivative_impl<dir,1,2,CENTRAL_ONE_SIDE_FORWARD>
     {
         template<typename rtype,typename expr_type>
-        static inline rtype calculate(expr_type & o1, grid_dist_key_dx<expr_type::gtype::dims> & key, comb<expr_type::gtype::dims> & c_where)
+        __device__ __host__ static inline rtype calculate(expr_type & o1, grid_dist_key_dx<expr_type::gtype::dims> & key, comb<expr_type::gtype::dims> & c_where)
         {
             // x0, dx are defined in proper dir є(x, y, z)
             auto dx = o1.getGrid().spacing(dir);
@@ -280,11 +308,11 @@ namespace FD
     struct Derivative_impl<dir,1,2,CENTRAL_STAG_ONE_SIDE_FORWARD>
     {
         template<typename rtype,typename expr_type>
-        static inline rtype calculate(expr_type & o1, grid_dist_key_dx<expr_type::gtype::dims> & key, comb<expr_type::gtype::dims> & c_where)
+        __device__ __host__ static inline rtype calculate(expr_type & o1, grid_dist_key_dx<expr_type::gtype::dims> & key, comb<expr_type::gtype::dims> & c_where)
         {
-
+#ifndef __CUDA_ARCH__
         	std::cout << __FILE__ << ":" << __LINE__ << " error we do not have implemented yet one sided staggered grid" << std::endl;
-
+#endif
             return 0.0;
         }
 
@@ -307,7 +335,7 @@ namespace FD
     struct Derivative_impl<dir,2,2,CENTRAL_ONE_SIDE_FORWARD>
     {
         template<typename rtype,typename expr_type>
-        static inline rtype calculate(expr_type & o1, grid_dist_key_dx<expr_type::gtype::dims> & key, comb<expr_type::gtype::dims> & c_where)
+        __device__ __host__ static inline rtype calculate(expr_type & o1, grid_dist_key_dx<expr_type::gtype::dims> & key, comb<expr_type::gtype::dims> & c_where)
         {
             // x0, dx are defined in proper dir є(x, y, z)
             auto dx = o1.getGrid().spacing(dir);
@@ -361,7 +389,7 @@ namespace FD
     struct Derivative_impl<dir,1,2,CENTRAL_ONE_SIDE_BACKWARD>
     {
         template<typename rtype,typename expr_type>
-        static inline rtype calculate(expr_type & o1, grid_dist_key_dx<expr_type::gtype::dims> & key, comb<expr_type::gtype::dims> & c_where)
+        __device__ __host__ static inline rtype calculate(expr_type & o1, grid_dist_key_dx<expr_type::gtype::dims> & key, comb<expr_type::gtype::dims> & c_where)
         {
             // x0, dx are defined in proper dir є(x, y, z)
             auto dx = o1.getGrid().spacing(dir);
@@ -406,11 +434,11 @@ namespace FD
     struct Derivative_impl<dir,1,2,CENTRAL_STAG_ONE_SIDE_BACKWARD>
     {
         template<typename rtype,typename expr_type>
-        static inline rtype calculate(expr_type & o1, grid_dist_key_dx<expr_type::gtype::dims> & key, comb<expr_type::gtype::dims> & c_where)
+        __device__ __host__ static inline rtype calculate(expr_type & o1, grid_dist_key_dx<expr_type::gtype::dims> & key, comb<expr_type::gtype::dims> & c_where)
         {
-
+#ifndef __CUDA_ARCH__
         	std::cout << __FILE__ << ":" << __LINE__ << " error we do not have implemented yet one sided staggered grid" << std::endl;
-
+#endif
             return 0.0;
         }
 
@@ -433,7 +461,7 @@ namespace FD
     struct Derivative_impl<dir,2,2,CENTRAL_ONE_SIDE_BACKWARD>
     {
         template<typename rtype,typename expr_type>
-        static inline rtype calculate(expr_type & o1, grid_dist_key_dx<expr_type::gtype::dims> & key, comb<expr_type::gtype::dims> & c_where)
+        __device__ __host__ static inline rtype calculate(expr_type & o1, grid_dist_key_dx<expr_type::gtype::dims> & key, comb<expr_type::gtype::dims> & c_where)
         {
             // x0, dx are defined in proper dir є(x, y, z)
             auto dx = o1.getGrid().spacing(dir);
@@ -504,6 +532,19 @@ namespace FD
                 :o1(o1)
         {}
 
+        /*! \brief Convert the expression to be evaluated in a kernel on one local grid
+         *
+         * \param gk view of the local grid (grid_dist_patch_ker)
+         *
+         * \return the expression on the local grid
+         *
+         */
+        template<typename ker_type>
+        inline auto toKernel(const ker_type & gk) const -> grid_dist_expression_op<decltype(o1.toKernel(gk)),void,GRID_DERIVATIVE<dir,ord_d,ord,impl> >
+        {
+            return grid_dist_expression_op<decltype(o1.toKernel(gk)),void,GRID_DERIVATIVE<dir,ord_d,ord,impl> >(o1.toKernel(gk));
+        }
+
         /*! \brief This function must be called before value
         *
         * it initialize the expression if needed
@@ -521,7 +562,7 @@ namespace FD
          * \return the result of the expression
          *
          */
-        inline auto value(grid_dist_key_dx<gtype::dims> & key, comb<gtype::dims> & c_where) const -> typename std::remove_reference<decltype(o1.value(key,c_where))>::type
+        __device__ __host__ inline auto value(grid_dist_key_dx<gtype::dims> & key, comb<gtype::dims> & c_where) const -> typename std::remove_reference<decltype(o1.value(key,c_where))>::type
         {
             typedef typename std::remove_reference<decltype(o1.value(key,c_where))>::type r_type;
 
@@ -583,7 +624,7 @@ namespace FD
          * \return the vector
          *
          */
-        gtype & getGrid()
+        __device__ __host__ gtype & getGrid()
         {
             return o1.getGrid();
         }
@@ -595,7 +636,7 @@ namespace FD
         * \return the vector
         *
         */
-        const gtype & getGrid() const
+        __device__ __host__ const gtype & getGrid() const
         {
             return o1.getGrid();
         }
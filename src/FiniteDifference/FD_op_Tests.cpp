@@ -513,4 +513,54 @@ BOOST_AUTO_TEST_SUITE(fd_op_suite_tests)
     }
 
 
+    BOOST_AUTO_TEST_CASE(fd_op_tests_tiled) {
+        const size_t sz[3] = {41, 37, 23};
+        Box<3, double> box({0, 0, 0}, {2 * M_PI, 2 * M_PI, 2 * M_PI});
+        periodicity<3> bc({PERIODIC, PERIODIC, PERIODIC});
+        Ghost<3, long int> ghost(1);
+
+        grid_dist_id<3, double, aggregate<double, double, double>> domain(sz, box,ghost,bc);
+
+        auto it = domain.getDomainIterator();
+        while (it.isNext())
+        {
+            auto key_l = it.get();
+            auto key = it.getGKey(key_l);
+            double x = key.get(0) * domain.spacing(0);
+            double y = key.get(1) * domain.spacing(1);
+            double z = key.get(2) * domain.spacing(2);
+
+            domain.template getProp<0>(key_l) = sin(x) + sin(y) * cos(z);
+
+            ++it;
+        }
+
+        domain.ghost_get<0>();
+
+        FD::Derivative_x Dx;
+        FD::Derivative<2,1,2,FD::CENTRAL> Dz;
+        FD::Lap L;
+
+        auto v = FD::getV<1>(domain);
+        auto w = FD::getV<2>(domain);
+        auto P = FD::getV<0>(domain);
+
+        // laplacian plus advection, point by point and tile by tile (tiles not dividing the grid)
+        v = L(P) + 0.5*Dx(P) + 2.0*Dz(P);
+        w.assign_tiled(L(P) + 0.5*Dx(P) + 2.0*Dz(P), 5);
+
+        auto it2 = domain.getDomainIterator();
+
+        bool match = true;
+        while (it2.isNext()) {
+            auto p = it2.get();
+
+            match &= (domain.getProp<1>(p) == domain.getProp<2>(p));
+
+            ++it2;
+        }
+
+        BOOST_REQUIRE_EQUAL(match, true);
+    }
+
 BOOST_AUTO_TEST_SUITE_END()
@@ -110,6 +110,31 @@ public:
 			arg::value(g_map,kmap,gs,spacing,cols, - 2.0 * coeff/spacing[i]/spacing[i]);
 		}
 	}
+
+	/*! \brief Add the entries of the Laplacian to the flattened stencil
+	 *
+	 * \param off offset from the row point
+	 * \param spacing grid spacing
+	 * \param tab stencil table
+	 * \param coeff coefficient
+	 *
+	 */
+	inline static void stencil(grid_key_dx<Sys_eqs::dims> & off,
+			                   typename Sys_eqs::stype (& spacing )[Sys_eqs::dims],
+							   fd_stencil_table<Sys_eqs::dims,typename Sys_eqs::stype> & tab,
+							   typename Sys_eqs::stype coeff)
+	{
+		for (size_t i = 0 ; i < Sys_eqs::dims ; i++)
+		{
+			off.set_d(i,off.get(i) + 1);
+			arg::stencil(off,spacing,tab,coeff/spacing[i]/spacing[i]);
+			off.set_d(i,off.get(i) - 2);
+			arg::stencil(off,spacing,tab,coeff/spacing[i]/spacing[i]);
+			off.set_d(i,off.get(i) + 1);
+
+			arg::stencil(off,spacing,tab, - 2.0 * coeff/spacing[i]/spacing[i]);
+		}
+	}
 };
 
 
@@ -170,6 +195,38 @@ public:
 			arg::value(g_map,kmap,gs,spacing,cols, - 2.0 * coeff/spacing[i]/spacing[i]/4.0);
 		}
 	}
+
+	/*! \brief Add the entries of the Laplacian to the flattened stencil
+	 *
+	 * \param off offset from the row point
+	 * \param spacing grid spacing
+	 * \param tab stencil table
+	 * \param coeff coefficient
+	 *
+	 */
+	inline static void stencil(grid_key_dx<Sys_eqs::dims> & off,
+			                   typename Sys_eqs::stype (& spacing )[Sys_eqs::dims],
+							   fd_stencil_table<Sys_eqs::dims,typename Sys_eqs::stype> & tab,
+							   typename Sys_eqs::stype coeff)
+	{
+		for (size_t i = 0 ; i < Sys_eqs::dims ; i++)
+		{
+			off.set_d(i,off.get(i) + 2);
+			arg::stencil(off,spacing,tab,coeff/spacing[i]/spacing[i]/4.0);
+			off.set_d(i,off.get(i) - 4);
+			arg::stencil(off,spacing,tab,coeff/spacing[i]/spacing[i]/4.0);
+			off.set_d(i,off.get(i) + 2);
+
+			arg::stencil(off,spacing,tab, - 2.0 * coeff/spacing[i]/spacing[i]/4.0);
+		}
+	}
 };
 
+//! The CENTRAL and CENTRAL_SYM Laplacian can be flattened if their argument can
+template<typename arg, typename Sys_eqs>
+struct is_stencil_expr<Lap<arg,Sys_eqs,CENTRAL>>: is_stencil_expr<arg> {};
+
+template<typename arg, typename Sys_eqs>
+struct is_stencil_expr<Lap<arg,Sys_eqs,CENTRAL_SYM>>: is_stencil_expr<arg> {};
+
 #endif /* OPENFPM_NUMERICS_SRC_FINITEDIFFERENCE_LAPLACIAN_HPP_ */
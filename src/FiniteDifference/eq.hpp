@@ -16,6 +16,7 @@
 
 #include "util/util_num.hpp"
 #include "Matrix/SparseMatrix.hpp"
+#include "FiniteDifference/util/stencil_table.hpp"
 
 /*! \brief Equation
  *
@@ -94,6 +95,19 @@ public:
 		cols[g_map.template get<0>(kmap)*Sys_eqs::nvar + f] += coeff;
 	}
 
+	/*! \brief add the entry of the field to the flattened stencil
+	 *
+	 * \param off offset from the row point
+	 * \param spacing grid spacing
+	 * \param tab stencil table
+	 * \param coeff coefficient
+	 *
+	 */
+	static void stencil(grid_key_dx<Sys_eqs::dims> & off, typename Sys_eqs::stype (& spacing )[Sys_eqs::dims], fd_stencil_table<Sys_eqs::dims,typename Sys_eqs::stype> & tab, typename Sys_eqs::stype coeff)
+	{
+		tab.add(off,f,coeff);
+	}
+
 	/*! \brief
 	 *
 	 *
@@ -104,6 +118,10 @@ public:
 	}
 };
 
+//! A field can be flattened
+template<unsigned int f, typename Sys_eqs>
+struct is_stencil_expr<Field<f,Sys_eqs>>: std::true_type {};
+
 class ConstField
 {
 
@@ -11,6 +11,7 @@
 #include <typeinfo>
 #include "util/util_debug.hpp"
 #include "util/util_num.hpp"
+#include "FiniteDifference/util/stencil_table.hpp"
 
 #define HAS_VAL 1
 #define HAS_POS_VAL 2
@@ -155,6 +156,27 @@ struct mul
 		last_m::value(g_map,kmap,gs,spacing,cols,mfv.coeff);
 	}
 
+	/*! \brief Add the entries of the last expression to the flattened stencil, with the constant fields folded
+	 *  in the coefficient
+	 *
+	 * \param off offset from the row point
+	 * \param spacing grid spacing
+	 * \param tab stencil table
+	 * \param coeff coefficient
+	 *
+	 */
+	inline static void stencil(grid_key_dx<Sys_eqs::dims> & off,
+			                   typename Sys_eqs::stype (& spacing )[Sys_eqs::dims],
+							   fd_stencil_table<Sys_eqs::dims,typename Sys_eqs::stype> & tab,
+							   typename Sys_eqs::stype coeff)
+	{
+		coeff *= const_coeff<0>(std::integral_constant<bool,(v_sz::value > 2)>());
+
+		typedef typename boost::mpl::at< v_expr ,boost::mpl::int_<v_sz::value-2> >::type last_m;
+
+		last_m::stencil(off,spacing,tab,coeff);
+	}
+
 	/*! \brief Calculate the position in the cell where the mul operator is performed
 	 *
 	 * it just return the position of the staggered property in the last expression
@@ -170,7 +192,35 @@ struct mul
 	{
 		return boost::mpl::at<v_expr, boost::mpl::int_<v_sz::type::value - 2> >::type::position(pos,gs,s_pos);
 	}
+
+private:
+
+	//! product of the constant fields from i
+	template<int i>
+	inline static typename Sys_eqs::stype const_coeff(std::true_type)
+	{
+		typedef typename boost::mpl::at<v_expr, boost::mpl::int_<i> >::type cfield;
+
+		return has_val<is_const_field<cfield>::value * 1,cfield>::call_val() * const_coeff<i+1>(std::integral_constant<bool,(i+3 < v_sz::value)>());
+	}
+
+	//! no more constant fields
+	template<int i>
+	inline static typename Sys_eqs::stype const_coeff(std::false_type)
+	{
+		return 1.0;
+	}
 };
 
 
+//! A mul can be flattened if the first operands are constant fields and the last expression can
+template<typename ... expr>
+struct is_stencil_expr<mul<expr...>>
+{
+	typedef boost::mpl::vector<expr...> v_expr;
+
+	static const bool value = is_const_field_range<v_expr,0,sizeof...(expr)-2>::value &&
+			                  is_stencil_expr<typename boost::mpl::at<v_expr,boost::mpl::int_<sizeof...(expr)-2>>::type>::value;
+};
+
 #endif /* OPENFPM_NUMERICS_SRC_FINITEDIFFERENCE_MUL_HPP_ */
@@ -12,6 +12,7 @@
 	#include "config.h"
 	#include <unordered_map>
 	#include "util/for_each_ref.hpp"
+#include "FiniteDifference/util/stencil_table.hpp"
 
 	/*! \brief sum functor value
 	 *
@@ -128,6 +129,45 @@ struct sum
 		boost::mpl::for_each_ref< boost::mpl::range_c<int,0,v_sz::type::value - 1> >(sm);
 	}
 
+	/*! \brief Add the entries of all the operands to the flattened stencil
+	 *
+	 * \param off offset from the row point
+	 * \param spacing grid spacing
+	 * \param tab stencil table
+	 * \param coeff coefficient in front of the sum
+	 *
+	 */
+	inline static void stencil(grid_key_dx<Sys_eqs::dims> & off,
+			                   typename Sys_eqs::stype (& spacing )[Sys_eqs::dims],
+							   fd_stencil_table<Sys_eqs::dims,typename Sys_eqs::stype> & tab,
+							   typename Sys_eqs::stype coeff)
+	{
+		stencil_operand<0>(off,spacing,tab,coeff,std::integral_constant<bool,(v_sz::type::value > 1)>());
+	}
+
+private:
+
+	//! add the entries of the operand i and of the ones after it
+	template<int i>
+	inline static void stencil_operand(grid_key_dx<Sys_eqs::dims> & off,
+			                           typename Sys_eqs::stype (& spacing )[Sys_eqs::dims],
+									   fd_stencil_table<Sys_eqs::dims,typename Sys_eqs::stype> & tab,
+									   typename Sys_eqs::stype coeff,
+									   std::true_type)
+	{
+		boost::mpl::at<v_expr, boost::mpl::int_<i> >::type::stencil(off,spacing,tab,coeff);
+		stencil_operand<i+1>(off,spacing,tab,coeff,std::integral_constant<bool,(i+2 < v_sz::type::value)>());
+	}
+
+	//! no more operands
+	template<int i>
+	inline static void stencil_operand(grid_key_dx<Sys_eqs::dims> & off,
+			                           typename Sys_eqs::stype (& spacing )[Sys_eqs::dims],
+									   fd_stencil_table<Sys_eqs::dims,typename Sys_eqs::stype> & tab,
+									   typename Sys_eqs::stype coeff,
+									   std::false_type)
+	{}
+
 
 };
 
@@ -164,7 +204,34 @@ struct minus
 		arg::value(g_map,kmap,gs,spacing,cols,-coeff);
 	}
 
+	/*! \brief Add the entries of the argument with the opposite sign to the flattened stencil
+	 *
+	 * \param off offset from the row point
+	 * \param spacing grid spacing
+	 * \param tab stencil table
+	 * \param coeff coefficient
+	 *
+	 */
+	inline static void stencil(grid_key_dx<Sys_eqs::dims> & off,
+			                   typename Sys_eqs::stype (& spacing )[Sys_eqs::dims],
+							   fd_stencil_table<Sys_eqs::dims,typename Sys_eqs::stype> & tab,
+							   typename Sys_eqs::stype coeff)
+	{
+		arg::stencil(off,spacing,tab,-coeff);
+	}
+
 
 };
 
+//! A sum can be flattened if all its operands can
+template<typename ... expr>
+struct is_stencil_expr<sum<expr...>>
+{
+	static const bool value = is_stencil_expr_range<boost::mpl::vector<expr...>,0,sizeof...(expr)-1>::value;
+};
+
+//! A minus can be flattened if its argument can
+template<typename arg, typename Sys_eqs>
+struct is_stencil_expr<minus<arg,Sys_eqs>>: is_stencil_expr<arg> {};
+
 #endif /* OPENFPM_NUMERICS_SRC_FINITEDIFFERENCE_SUM_HPP_ */
@@ -176,6 +176,84 @@ BOOST_AUTO_TEST_SUITE(EnoWenoTestSuite)
 		}
 	}
 	
+	BOOST_AUTO_TEST_CASE(Weno_Z_1D_1stDerivative_test)
+	{
+		int count = 0;
+		for (size_t N = 32; N <= 128; N *= 2)
+		{
+			const size_t grid_dim = 1;
+			const size_t sz[grid_dim] = {N};
+			const double box_lower = -1.0;
+			const double box_upper = 1.0;
+			Box<grid_dim, double> box({box_lower}, {box_upper});
+			Ghost<grid_dim, long int> ghost(3);
+			typedef aggregate<double, Point<grid_dim, double>, Point<grid_dim, double>, Point<grid_dim, double>, double, double> props;
+			typedef grid_dist_id<grid_dim, double, props> grid_in_type;
+			grid_in_type g_dist(sz, box, ghost);
+			
+			g_dist.setPropNames({"f_gaussian", "df_gaussian", "WENO_Z_plus", "WENO_Z_minus", "Error_plus", "Error_minus"});
+			
+			double mu = 0.5 * (box_upper - abs(box_lower));
+			double sigma = 0.3 * (box_upper - box_lower);
+			
+			auto gdom = g_dist.getDomainGhostIterator();
+			while (gdom.isNext())
+			{
+				auto key = gdom.get();
+				Point<grid_dim, double> p = g_dist.getPos(key);
+				// Initialize grid and ghost with gaussian function
+				g_dist.getProp<f_gaussian>(key)  = gaussian(p, mu, sigma);
+				++gdom;
+			}
+			
+			double max_diff = 0.0;
+			auto dom = g_dist.getDomainIterator();
+			while (dom.isNext())
+			{
+				auto key = dom.get();
+				Point<grid_dim, double> p = g_dist.getPos(key);
+				for (int d = 0; d < grid_dim; d++)
+				{
+					// Analytical solution
+					g_dist.getProp<df_gaussian>(key)[d] = hermite_polynomial(p.get(d), sigma, 1) * g_dist.getProp<f_gaussian>(key);
+					// WENO-Z plus and minus at once
+					double dplus, dminus;
+					WENO_5_PlusMinus<f_gaussian,true>(g_dist, key, d, dplus, dminus);
+					g_dist.getProp<ENO_plus>(key)[d]  = dplus;
+					g_dist.getProp<ENO_minus>(key)[d] = dminus;
+					
+					// the combined classic WENO must give the same as the separate plus and minus
+					WENO_5_PlusMinus<f_gaussian>(g_dist, key, d, dplus, dminus);
+					max_diff = std::max(max_diff, fabs(dplus - WENO_5_Plus<f_gaussian>(g_dist, key, d)));
+					max_diff = std::max(max_diff, fabs(dminus - WENO_5_Minus<f_gaussian>(g_dist, key, d)));
+				}
+				
+				++dom;
+			}
+			BOOST_CHECK_MESSAGE(max_diff <= 1e-10, "Checking combined WENO plus and minus");
+			
+			// Get the error between analytical and numerical solution
+			get_relative_error<df_gaussian, ENO_plus, Error_plus>(g_dist);
+			get_relative_error<df_gaussian, ENO_minus, Error_minus>(g_dist);
+			
+			// WENO-Z is at least as accurate as the classic WENO on a smooth function
+			{
+				LNorms<double> lNorms;
+				lNorms.get_l_norms_grid<Error_plus>(g_dist);
+				BOOST_CHECK_MESSAGE(lNorms.l2   < l2_norms_WENO[count] + 0.000001, "Checking L2-norm WENO-Z");
+				BOOST_CHECK_MESSAGE(lNorms.linf < linf_norms_WENO[count] + 0.000001, "Checking Linf-norm WENO-Z");
+			}
+			
+			{
+				LNorms<double> lNorms;
+				lNorms.get_l_norms_grid<Error_minus>(g_dist);
+				BOOST_CHECK_MESSAGE(lNorms.l2   < l2_norms_WENO[count] + 0.000001, "Checking L2-norm WENO-Z");
+				BOOST_CHECK_MESSAGE(lNorms.linf < linf_norms_WENO[count] + 0.000001, "Checking Linf-norm WENO-Z");
+			}
+			count++;
+		}
+	}
+	
 	BOOST_AUTO_TEST_CASE(Eno_3D_test)
 	{
 		int count = 0;
@@ -0,0 +1,137 @@
+//
+// Tests of the GPU upwind and central gradients
+//
+
+#define BOOST_TEST_DYN_LINK
+#include <boost/test/unit_test.hpp>
+
+// Include header files for testing
+#include "Gaussian.hpp"
+#include "FiniteDifference/FD_grid_gpu.cuh"
+#include "level_set/redistancing_Sussman/HelpFunctions.hpp"
+
+BOOST_AUTO_TEST_SUITE(FDGridGpuTestSuite)
+	const size_t F_GAUSSIAN = 0;
+	const size_t VELOCITY   = 1;
+	const size_t dF_CPU     = 2;
+	const size_t dF_GPU     = 3;
+	
+	BOOST_AUTO_TEST_CASE(Upwind_gradient_gpu_3D_test)
+	{
+		const size_t grid_dim  = 3;
+		const double box_lower = -1.0;
+		const double box_upper = 1.0;
+		Box<grid_dim, double> box({box_lower, box_lower, box_lower}, {box_upper, box_upper, box_upper});
+		Ghost<grid_dim, long int> ghost(3);
+		typedef aggregate<double, int, Point<grid_dim, double>, Point<grid_dim, double>> props;
+		typedef grid_dist_id<grid_dim, double, props, CartDecomposition<grid_dim, double, CudaMemory,
+		memory_traits_inte>, CudaMemory, grid_gpu<grid_dim, props>> grid_in_type;
+		
+		double mu = 0.5 * (box_upper - abs(box_lower));
+		double sigma = 0.3 * (box_upper - box_lower);
+		
+		const size_t sz[grid_dim] = {32, 32, 32};
+		grid_in_type g_dist(sz, box, ghost);
+		
+		auto gdom = g_dist.getDomainGhostIterator();
+		while (gdom.isNext())
+		{
+			auto key = gdom.get();
+			Point<grid_dim, double> p = g_dist.getPos(key);
+			g_dist.getProp<F_GAUSSIAN>(key) = gaussian(p, mu, sigma) - 0.5;
+			g_dist.getProp<VELOCITY>(key) = sgn(g_dist.getProp<F_GAUSSIAN>(key));
+			++gdom;
+		}
+		g_dist.template hostToDevice<F_GAUSSIAN, VELOCITY>();
+		
+		for (size_t order = 1; order <= 5; order += 2)
+		{
+			get_upwind_gradient<F_GAUSSIAN, VELOCITY, dF_CPU>(g_dist, order, true);
+			get_upwind_gradient_gpu<F_GAUSSIAN, VELOCITY, dF_GPU>(g_dist, order, true);
+			g_dist.template deviceToHost<dF_GPU>();
+			
+			double max_diff = 0.0;
+			auto dom = g_dist.getDomainIterator();
+			while (dom.isNext())
+			{
+				auto key = dom.get();
+				for (size_t d = 0; d < grid_dim; d++)
+				{
+					double diff = fabs(g_dist.getProp<dF_CPU>(key)[d] - g_dist.getProp<dF_GPU>(key)[d]);
+					if (diff > max_diff) max_diff = diff;
+				}
+				++dom;
+			}
+			
+			BOOST_CHECK_MESSAGE(max_diff <= 1e-10, "Checking GPU upwind gradient order " + std::to_string(order));
+		}
+		
+		get_central_FD_grid<F_GAUSSIAN, dF_CPU>(g_dist, true);
+		get_central_FD_grid_gpu<F_GAUSSIAN, dF_GPU>(g_dist, true);
+		g_dist.template deviceToHost<dF_GPU>();
+		
+		double max_diff = 0.0;
+		auto dom = g_dist.getDomainIterator();
+		while (dom.isNext())
+		{
+			auto key = dom.get();
+			for (size_t d = 0; d < grid_dim; d++)
+			{
+				double diff = fabs(g_dist.getProp<dF_CPU>(key)[d] - g_dist.getProp<dF_GPU>(key)[d]);
+				if (diff > max_diff) max_diff = diff;
+			}
+			++dom;
+		}
+		
+		BOOST_CHECK_MESSAGE(max_diff <= 1e-12, "Checking GPU central finite difference");
+	}
+	
+	BOOST_AUTO_TEST_CASE(FD_expression_gpu_2D_test)
+	{
+		const size_t grid_dim = 2;
+		Box<grid_dim, double> box({0, 0}, {2 * M_PI, 2 * M_PI});
+		periodicity<grid_dim> bc({NON_PERIODIC, NON_PERIODIC});
+		Ghost<grid_dim, long int> ghost(1);
+		typedef aggregate<double, double, double> props;
+		typedef grid_dist_id<grid_dim, double, props, CartDecomposition<grid_dim, double, CudaMemory,
+		memory_traits_inte>, CudaMemory, grid_gpu<grid_dim, props>> grid_in_type;
+		
+		const size_t sz[grid_dim] = {81, 81};
+		grid_in_type g_dist(sz, box, ghost, bc);
+		
+		auto dom = g_dist.getDomainIterator();
+		while (dom.isNext())
+		{
+			auto key = dom.get();
+			Point<grid_dim, double> p = g_dist.getPos(key);
+			g_dist.getProp<0>(key) = sin(p.get(0)) + sin(p.get(1));
+			++dom;
+		}
+		g_dist.template hostToDevice<0>();
+		g_dist.ghost_get<0>();
+		
+		FD::Derivative_x Dx;
+		FD::Derivative_y Dy;
+		
+		auto P = FD::getV<0>(g_dist);
+		auto v_cpu = FD::getV<1>(g_dist);
+		auto v_gpu = FD::getV<2>(g_dist);
+		
+		// one sided derivatives on the boundary, the ghost of P is exchanged on the device
+		v_cpu = Dx(P) + Dy(P) + P + 5;
+		fd_assign_gpu(v_gpu, Dx(P) + Dy(P) + P + 5);
+		g_dist.template deviceToHost<2>();
+		
+		double max_diff = 0.0;
+		auto dom2 = g_dist.getDomainIterator();
+		while (dom2.isNext())
+		{
+			auto key = dom2.get();
+			double diff = fabs(g_dist.getProp<1>(key) - g_dist.getProp<2>(key));
+			if (diff > max_diff) max_diff = diff;
+			++dom2;
+		}
+		
+		BOOST_CHECK_MESSAGE(max_diff <= 1e-12, "Checking GPU FD expression");
+	}
+BOOST_AUTO_TEST_SUITE_END()
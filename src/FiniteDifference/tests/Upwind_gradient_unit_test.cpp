@@ -380,4 +380,58 @@ BOOST_AUTO_TEST_SUITE(UpwindGradientTestSuite)
 			}
 		}
 	}
+	BOOST_AUTO_TEST_CASE(Upwind_gradient_lines_3D_test)
+	{
+		const size_t grid_dim  = 3;
+		const double box_lower = -1.0;
+		const double box_upper = 1.0;
+		Box<grid_dim, double> box({box_lower, box_lower, box_lower}, {box_upper, box_upper, box_upper});
+		Ghost<grid_dim, long int> ghost(3);
+		typedef aggregate<double, int, Point<grid_dim, double>, Point<grid_dim, double>> props;
+		typedef grid_dist_id<grid_dim, double, props> grid_in_type;
+		
+		const size_t F = 0, V = 1, dF_KEY = 2, dF_LINES = 3;
+		
+		double mu = 0.5 * (box_upper - abs(box_lower));
+		double sigma = 0.3 * (box_upper - box_lower);
+		
+		const size_t sz[grid_dim] = {24, 19, 21};
+		grid_in_type g_dist(sz, box, ghost);
+		
+		auto gdom = g_dist.getDomainGhostIterator();
+		while (gdom.isNext())
+		{
+			auto key = gdom.get();
+			Point<grid_dim, double> p = g_dist.getPos(key);
+			g_dist.getProp<F>(key) = gaussian(p, mu, sigma) - 0.5;
+			g_dist.getProp<V>(key) = sgn(g_dist.getProp<F>(key));
+			++gdom;
+		}
+		
+		for (int one_sided = 0; one_sided <= 1; one_sided++)
+		{
+			for (size_t order : {(size_t)1, (size_t)3, (size_t)5, WENO_Z_5})
+			{
+				// per node and line by line evaluation must give the same gradient
+				upwind_gradient<F, V, dF_KEY>(g_dist, one_sided, order);
+				upwind_gradient_lines<F, V, dF_LINES>(g_dist, one_sided, order);
+				
+				double max_diff = 0.0;
+				auto dom = g_dist.getDomainIterator();
+				while (dom.isNext())
+				{
+					auto key = dom.get();
+					for (size_t d = 0; d < grid_dim; d++)
+					{
+						double diff = fabs(g_dist.getProp<dF_KEY>(key)[d] - g_dist.getProp<dF_LINES>(key)[d]);
+						if (diff > max_diff) max_diff = diff;
+					}
+					++dom;
+				}
+				
+				BOOST_CHECK_MESSAGE(max_diff <= 1e-10, "Checking line-wise upwind gradient order " + std::to_string
+				(order) + " one sided BC " + std::to_string(one_sided));
+			}
+		}
+	}
 BOOST_AUTO_TEST_SUITE_END()
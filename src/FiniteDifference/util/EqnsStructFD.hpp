@@ -6,6 +6,7 @@
 #define OPENFPM_PDATA_EQNSSTRUCT_HPP
 
 #include "Solvers/umfpack_solver.hpp"
+#include "Solvers/mixed_precision_solver.hpp"
 #include "Solvers/petsc_solver.hpp"
 
 //! Specify the general characteristic of system to solve
@@ -266,6 +267,33 @@ struct equations2d1E {
 };
 const bool equations2d1E::boundary[]={NON_PERIODIC,NON_PERIODIC};
 
+//! Same as equations2d1E with the linear system in single precision, the solve moves half of the bytes
+struct equations2d1Ef {
+
+    //! dimensionaly of the equation ( 3D problem ...)
+    static const unsigned int dims=2;
+    //! number of fields in the system
+    static const unsigned int nvar=1;
+
+    //! boundary at X and Y
+    static const bool boundary[];
+
+    //! type of space float, double, ...
+    typedef double stype;
+
+    //! type of base particles
+    typedef grid_dist_id<dims, double, aggregate<double>> b_part;
+
+    //! type of SparseMatrix for the linear solver
+    typedef SparseMatrix<float, int, EIGEN_BASE> SparseMatrix_type;
+
+    //! type of Vector for the linear solver
+    typedef Vector<float> Vector_type;
+
+    typedef umfpack_solver<float> solver_type;
+};
+const bool equations2d1Ef::boundary[]={NON_PERIODIC,NON_PERIODIC};
+
 struct equations2d2E {
     //! dimensionaly of the equation ( 3D problem ...)
     static const unsigned int dims = 2;
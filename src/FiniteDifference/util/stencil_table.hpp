@@ -0,0 +1,131 @@
+/*
+ * stencil_table.hpp
+ *
+ *  Flattened stencil of the legacy FDScheme expressions
+ */
+
+#ifndef OPENFPM_NUMERICS_SRC_FINITEDIFFERENCE_UTIL_STENCIL_TABLE_HPP_
+#define OPENFPM_NUMERICS_SRC_FINITEDIFFERENCE_UTIL_STENCIL_TABLE_HPP_
+
+#include <vector>
+#include <type_traits>
+#include <boost/mpl/at.hpp>
+#include <boost/mpl/int.hpp>
+#include "Grid/grid_key.hpp"
+#include "util/util_num.hpp"
+
+/*! \brief One entry of a flattened stencil: the column at offset off of the variable var has coefficient coeff
+ *
+ * \tparam dim dimensionality
+ * \tparam T type of the coefficients
+ *
+ */
+template<unsigned int dim, typename T>
+struct fd_stencil_entry
+{
+	//! offset from the row point
+	grid_key_dx<dim> off;
+
+	//! variable in the system
+	unsigned int var;
+
+	//! coefficient
+	T coeff;
+};
+
+/*! \brief Stencil of an expression, the same for all the rows it is imposed on
+ *
+ * It is filled by the static stencil() function of the expressions (Field, sum, minus, mul, D, Lap, Avg):
+ * the expression tree is walked once, the offsets of the nested operators are composed, the constant fields
+ * of mul folded in the coefficients and the entries on the same column merged. FDScheme then stamps the
+ * table on every row instead of walking the expression at every point.
+ *
+ * \tparam dim dimensionality
+ * \tparam T type of the coefficients
+ *
+ */
+template<unsigned int dim, typename T>
+struct fd_stencil_table
+{
+	//! merged entries
+	std::vector<fd_stencil_entry<dim,T>> e;
+
+	/*! \brief Add a contribution, merging it with an entry on the same column
+	 *
+	 * \param off offset from the row point
+	 * \param var variable
+	 * \param coeff coefficient
+	 *
+	 */
+	void add(const grid_key_dx<dim> & off, unsigned int var, T coeff)
+	{
+		for (size_t i = 0 ; i < e.size() ; i++)
+		{
+			if (e[i].var == var && e[i].off == off)
+			{
+				e[i].coeff += coeff;
+				return;
+			}
+		}
+
+		e.push_back({off,var,coeff});
+	}
+
+	//! number of entries
+	size_t size() const
+	{
+		return e.size();
+	}
+
+	//! Remove all the entries
+	void clear()
+	{
+		e.clear();
+	}
+};
+
+/*! \brief Check if an expression can be flattened in a fd_stencil_table
+ *
+ * An expression can be flattened when its columns depend only on the offsets from the row point (and not
+ * on the position of the row, like the one-sided derivatives near the boundary). The operators that can
+ * are marked with a specialization next to their definition
+ *
+ */
+template<typename T, typename Sfinae = void>
+struct is_stencil_expr: std::false_type {};
+
+/*! \brief Check that the elements [i,j) of the boost::mpl::vector v_expr can be flattened
+ *
+ */
+template<typename v_expr, int i, int j>
+struct is_stencil_expr_range
+{
+	static const bool value = is_stencil_expr<typename boost::mpl::at<v_expr,boost::mpl::int_<i>>::type>::value &&
+			                  is_stencil_expr_range<v_expr,i+1,j>::value;
+};
+
+//! Empty range
+template<typename v_expr, int i>
+struct is_stencil_expr_range<v_expr,i,i>
+{
+	static const bool value = true;
+};
+
+/*! \brief Check that the elements [i,j) of the boost::mpl::vector v_expr are constant fields
+ *
+ */
+template<typename v_expr, int i, int j>
+struct is_const_field_range
+{
+	static const bool value = is_const_field<typename boost::mpl::at<v_expr,boost::mpl::int_<i>>::type>::value &&
+			                  is_const_field_range<v_expr,i+1,j>::value;
+};
+
+//! Empty range
+template<typename v_expr, int i>
+struct is_const_field_range<v_expr,i,i>
+{
+	static const bool value = true;
+};
+
+#endif /* OPENFPM_NUMERICS_SRC_FINITEDIFFERENCE_UTIL_STENCIL_TABLE_HPP_ */
@@ -10,10 +10,63 @@
 
 #include "Vector/map_vector.hpp"
 #include <boost/mpl/int.hpp>
+#include <algorithm>
 #include "VCluster/VCluster.hpp"
+#include <fstream>
+#include <cstring>
+#include <cstdint>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+#ifdef _OPENMP
+#include <omp.h>
+#endif
 
 #define EIGEN_TRIPLET 1
 
+//! version of the binary format of saveBinary
+#define SPARSE_MATRIX_BINARY_VERSION 1
+
+/*! \brief Header of the binary format of SparseMatrix::saveBinary
+ *
+ * It is followed by the compressed arrays outer (outer_size + 1 indexes), inner (nnz indexes) and values
+ * (nnz values), every array start at a multiple of 8 bytes
+ *
+ */
+struct sparse_matrix_binary_header
+{
+	//! "OFPMSPM" and a terminator
+	char magic[8];
+
+	//! SPARSE_MATRIX_BINARY_VERSION
+	uint32_t version;
+
+	//! 0 compressed colums (CSC), 1 compressed rows (CSR)
+	uint32_t row_major;
+
+	//! size in bytes of an index
+	uint32_t index_size;
+
+	//! size in bytes of a value
+	uint32_t value_size;
+
+	//! number of rows
+	uint64_t rows;
+
+	//! number of colums
+	uint64_t cols;
+
+	//! number of non zeros
+	uint64_t nnz;
+};
+
+//! round n up to a multiple of 8 bytes
+inline size_t sparse_matrix_binary_align(size_t n)
+{
+	return (n + 7) / 8 * 8;
+}
+
 /*! \brief It store one non-zero element in the sparse matrix
  *
  * Given a row, and a column, store a value
@@ -93,6 +146,62 @@ private:
 	//! indicate if the matrix has been created
 	bool m_created = false;
 
+	//! keep the non-zero pattern of the previous fill, only the values are overwritten
+	bool reuse_pattern = false;
+
+	//! position in the compressed storage of every triplet of the last fill (empty if it has to be built)
+	openfpm::vector<size_t> pattern_pos;
+
+	//! row major copy of the matrix used by the explicit product
+	Eigen::SparseMatrix<T,Eigen::RowMajor,id_t> mat_rm;
+
+	//! indicate if mat_rm is up to date with mat
+	bool rm_created = false;
+
+	/*! \brief Build the matrix from the triplets t
+	 *
+	 * With reuse_pattern, if the triplets match the stored pattern the values are accumulated directly in the
+	 * compressed storage, otherwise the matrix is built from the triplets and the pattern is stored
+	 *
+	 */
+	void setFromTriplets(openfpm::vector<triplet_type> & t)
+	{
+		if (reuse_pattern == true && pattern_pos.size() != 0 && pattern_pos.size() == t.size())
+		{
+			bool match = true;
+			for (size_t i = 0 ; i < t.size() && match ; i++)
+			{
+				size_t pos = pattern_pos.get(i);
+				id_t c = t.get(i).col();
+				match = (size_t)mat.outerIndexPtr()[c] <= pos && pos < (size_t)mat.outerIndexPtr()[c+1] &&
+						mat.innerIndexPtr()[pos] == t.get(i).row();
+			}
+
+			if (match == true)
+			{
+				std::fill(mat.valuePtr(),mat.valuePtr()+mat.nonZeros(),T(0));
+				for (size_t i = 0 ; i < t.size() ; i++)
+				{mat.valuePtr()[pattern_pos.get(i)] += t.get(i).value();}
+				return;
+			}
+		}
+
+		mat.setFromTriplets(t.begin(),t.end());
+
+		if (reuse_pattern == true)
+		{
+			// the matrix is column major and compressed, the rows of a column are sorted
+			pattern_pos.resize(t.size());
+			for (size_t i = 0 ; i < t.size() ; i++)
+			{
+				id_t c = t.get(i).col();
+				const id_t * first = mat.innerIndexPtr() + mat.outerIndexPtr()[c];
+				const id_t * last = mat.innerIndexPtr() + mat.outerIndexPtr()[c+1];
+				pattern_pos.get(i) = std::lower_bound(first,last,t.get(i).row()) - mat.innerIndexPtr();
+			}
+		}
+	}
+
 	/*! \brief Assemble the matrix
 	 *
 	 *
@@ -108,12 +217,68 @@ private:
 			collect();
 			// only master assemble the Matrix
 			if (vcl.getProcessUnitID() == 0)
-				mat.setFromTriplets(trpl_recv.begin(),trpl_recv.end());
+				setFromTriplets(trpl_recv);
 		}
 		else
-			mat.setFromTriplets(trpl.begin(),trpl.end());
+			setFromTriplets(trpl);
 
 		m_created = true;
+		rm_created = false;
+	}
+
+	/*! \brief Map the file of saveBinary and copy it in the matrix
+	 *
+	 * \param file filename
+	 *
+	 * \return false if the file cannot be read or it is not compatible with this matrix
+	 *
+	 */
+	bool loadBinaryMaster(const std::string & file)
+	{
+		int fd = open(file.c_str(),O_RDONLY);
+		if (fd == -1)
+		{return false;}
+
+		struct stat st;
+		if (fstat(fd,&st) != 0 || (size_t)st.st_size < sizeof(sparse_matrix_binary_header))
+		{
+			close(fd);
+			return false;
+		}
+
+		size_t sz = st.st_size;
+		void * ptr = mmap(NULL,sz,PROT_READ,MAP_PRIVATE,fd,0);
+		close(fd);
+
+		if (ptr == MAP_FAILED)
+		{return false;}
+
+		const sparse_matrix_binary_header & h = *(const sparse_matrix_binary_header *)ptr;
+
+		size_t sz_outer = (h.cols + 1) * sizeof(id_t);
+		size_t sz_inner = h.nnz * sizeof(id_t);
+		size_t off_inner = sizeof(h) + sparse_matrix_binary_align(sz_outer);
+		size_t off_val = off_inner + sparse_matrix_binary_align(sz_inner);
+
+		if (strncmp(h.magic,"OFPMSPM",sizeof(h.magic)) != 0 || h.version != SPARSE_MATRIX_BINARY_VERSION ||
+			h.row_major != 0 || h.index_size != sizeof(id_t) || h.value_size != sizeof(T) ||
+			sz < off_val + h.nnz * sizeof(T))
+		{
+			std::cerr << __FILE__ << ":" << __LINE__ << " error, " << file << " is not a binary matrix of this type (version " << SPARSE_MATRIX_BINARY_VERSION << ")" << std::endl;
+			munmap(ptr,sz);
+			return false;
+		}
+
+		const char * base = (const char *)ptr;
+		Eigen::Map<const Eigen::SparseMatrix<T,0,id_t>> m(h.rows,h.cols,h.nnz,
+		                                                   (const id_t *)(base + sizeof(h)),
+		                                                   (const id_t *)(base + off_inner),
+		                                                   (const T *)(base + off_val));
+		mat = m;
+
+		munmap(ptr,sz);
+
+		return true;
 	}
 
 	/*! \brief Here we collect the full matrix on master
@@ -163,6 +328,58 @@ public:
 		m_created = false; return this->trpl;
 	}
 
+	/*! \brief Memory used by the matrix in byte on this processor
+	 *
+	 * Triplets, compressed storage (column and row major copies) and the pattern of the fills
+	 *
+	 * \return the memory in byte
+	 *
+	 */
+	size_t getMemoryUsage() const
+	{
+		return (trpl.size() + trpl_recv.size())*sizeof(triplet_type) + pattern_pos.size()*sizeof(size_t)
+		       + mat.nonZeros()*(sizeof(T) + sizeof(id_t)) + (mat.outerSize() + 1)*sizeof(id_t)
+		       + mat_rm.nonZeros()*(sizeof(T) + sizeof(id_t)) + (mat_rm.outerSize() + 1)*sizeof(id_t);
+	}
+
+	/*! \brief Keep the non-zero pattern between fills
+	 *
+	 * When active, a fill with the same triplet locations of the previous fill (as produced by imposing the same
+	 * operators again) only overwrites the values in the compressed storage, without sorting the triplets again.
+	 * If the locations changed the matrix is rebuilt
+	 *
+	 * \param reuse true to keep the pattern
+	 *
+	 */
+	void reusePattern(bool reuse)
+	{
+		reuse_pattern = reuse;
+		pattern_pos.clear();
+	}
+
+	/*! \brief Block storage
+	 *
+	 * Eigen has no block sparse format, the call is accepted for compatibility with the PETSc backend and ignored
+	 *
+	 * \param bs block size
+	 * \param symmetric store only the upper triangular blocks
+	 *
+	 */
+	void setBlockSize(size_t bs, bool symmetric = false)
+	{
+	}
+
+	/*! \brief Device storage
+	 *
+	 * The Eigen backend is host only, the call is accepted for compatibility with the PETSc backend and ignored
+	 *
+	 * \param dev true to store the matrix on the device
+	 *
+	 */
+	void setDevice(bool dev)
+	{
+	}
+
 	/*! \brief Get the Eigen Matrix object
 	 *
 	 * \return the Eigen Matrix
@@ -188,6 +405,76 @@ public:
 		return mat;
 	}
 
+	/*! \brief Explicit product y = alpha*A*x + beta*y
+	 *
+	 * The rows are distributed across the OpenMP threads on a row major copy of the matrix, built
+	 * once after every assembly, so every thread write only its own entries of y. It does not use any
+	 * solver, and it is intended to apply assembled operators explicitly (for example in a time stepping)
+	 *
+	 * \warning like the rest of the Eigen backend the matrix exist only on the master processor
+	 *
+	 * \param x vector to multiply
+	 * \param y result
+	 * \param alpha coefficient of the product
+	 * \param beta coefficient of the previous y (when 0 y is not read)
+	 *
+	 */
+	void spmv(const Eigen::Matrix<T, Eigen::Dynamic, 1> & x, Eigen::Matrix<T, Eigen::Dynamic, 1> & y, T alpha = 1.0, T beta = 0.0)
+	{
+		if (m_created == false) assemble();
+
+		if (rm_created == false)
+		{
+			mat_rm = mat;
+			mat_rm.makeCompressed();
+			rm_created = true;
+		}
+
+		if (x.size() != mat_rm.cols())
+		{
+			std::cerr << __FILE__ << ":" << __LINE__ << " error, the vector has " << x.size() << " elements, the matrix " << mat_rm.cols() << " colums" << std::endl;
+			return;
+		}
+
+		if (y.size() != mat_rm.rows())
+		{y.resize(mat_rm.rows()); beta = 0.0;}
+
+		const id_t * outer = mat_rm.outerIndexPtr();
+		const id_t * inner = mat_rm.innerIndexPtr();
+		const T * val = mat_rm.valuePtr();
+		const T * xp = x.data();
+		T * yp = y.data();
+		long int nr = mat_rm.rows();
+
+		#pragma omp parallel for schedule(static)
+		for (long int r = 0 ; r < nr ; r++)
+		{
+			T acc = 0.0;
+			for (id_t k = outer[r] ; k < outer[r+1] ; k++)
+			{acc += val[k] * xp[inner[k]];}
+
+			yp[r] = (beta == 0.0)?alpha*acc:alpha*acc + beta*yp[r];
+		}
+	}
+
+	/*! \brief Explicit product y = alpha*A*x + beta*y
+	 *
+	 * \see spmv on Eigen vectors
+	 *
+	 * \param x vector to multiply
+	 * \param y result
+	 * \param alpha coefficient of the product
+	 * \param beta coefficient of the previous y
+	 *
+	 */
+	template<typename Vct>
+	void spmv(const Vct & x, Vct & y, T alpha = 1.0, T beta = 0.0)
+	{
+		auto & yv = y.getVec();
+		spmv(x.getVec(),yv,alpha,beta);
+		y = yv;
+	}
+
 	/*! \brief Resize the Sparse Matrix
 	 *
 	 * \param row number for row
@@ -196,7 +483,10 @@ public:
 	 */
 	void resize(size_t row, size_t col,size_t l_row, size_t l_col)
 	{
-		m_created = false; mat.resize(row,col);
+		if (reuse_pattern == true && (size_t)mat.rows() == row && (size_t)mat.cols() == col)
+		{m_created = false; return;}
+
+		m_created = false; mat.resize(row,col); pattern_pos.clear();
 	}
 
 	/*! \brief Get the row i and the colum j of the Matrix
@@ -283,6 +573,89 @@ public:
 	 	return true;
 	}
 
+	/*! \brief Save the assembled matrix in a binary compressed format
+	 *
+	 * Unlike save it store the compressed matrix (sparse_matrix_binary_header followed by the CSC arrays), so
+	 * loadBinary does not sort the triplets again. The matrix is assembled on the master, that is the only one
+	 * that write the file, but it must be called by all the processors
+	 *
+	 * \param file filename
+	 *
+	 * \return true if succed
+	 *
+	 */
+	bool saveBinary(const std::string & file)
+	{
+		Vcluster<> & vcl = create_vcluster();
+
+		getMat();
+
+		if (vcl.getProcessUnitID() != 0)
+		{return true;}
+
+		mat.makeCompressed();
+
+		sparse_matrix_binary_header h;
+		memset(&h,0,sizeof(h));
+		strncpy(h.magic,"OFPMSPM",sizeof(h.magic));
+		h.version = SPARSE_MATRIX_BINARY_VERSION;
+		h.row_major = 0;
+		h.index_size = sizeof(id_t);
+		h.value_size = sizeof(T);
+		h.rows = mat.rows();
+		h.cols = mat.cols();
+		h.nnz = mat.nonZeros();
+
+		std::ofstream dump(file, std::ios::out | std::ios::binary);
+		if (dump.is_open() == false)
+			return false;
+
+		const char pad[8] = {0,0,0,0,0,0,0,0};
+		size_t sz_outer = (h.cols + 1) * sizeof(id_t);
+		size_t sz_inner = h.nnz * sizeof(id_t);
+
+		dump.write((const char *)&h,sizeof(h));
+		dump.write((const char *)mat.outerIndexPtr(),sz_outer);
+		dump.write(pad,sparse_matrix_binary_align(sz_outer) - sz_outer);
+		dump.write((const char *)mat.innerIndexPtr(),sz_inner);
+		dump.write(pad,sparse_matrix_binary_align(sz_inner) - sz_inner);
+		dump.write((const char *)mat.valuePtr(),h.nnz * sizeof(T));
+
+		return dump.good();
+	}
+
+	/*! \brief Load a matrix saved with saveBinary
+	 *
+	 * The file is mapped in memory (mmap) and the compressed arrays are copied in the matrix, the triplets are not
+	 * read. Like the assembly the matrix is loaded only on the master, it must be called by all the processors.
+	 * The matrix is assembled, setting new triplets (getMatrixTriplets) replace it
+	 *
+	 * \param file filename
+	 *
+	 * \return true if succed
+	 *
+	 */
+	bool loadBinary(const std::string & file)
+	{
+		Vcluster<> & vcl = create_vcluster();
+
+		trpl.clear();
+		pattern_pos.clear();
+		m_created = true;
+		rm_created = false;
+
+		// the result of the master is given to all the processors
+		size_t ret = 1;
+
+		if (vcl.getProcessUnitID() == 0)
+		{ret = (loadBinaryMaster(file) == true)?1:0;}
+
+		vcl.min(ret);
+		vcl.execute();
+
+		return ret == 1;
+	}
+
 	/*! \brief Get the value from triplet
 	 *
 	 * \warning It is extremly slow because it do a full search across the triplets elements
@@ -14,6 +14,8 @@
 #include <petscmat.h>
 #include "VTKWriter/VTKWriter.hpp"
 #include "CSVWriter/CSVWriter.hpp"
+#include <algorithm>
+#include <vector>
 
 #define PETSC_BASE 2
 
@@ -139,12 +141,116 @@ private:
 	//! PETSC o_nnz
 	mutable openfpm::vector<PetscInt> o_nnz;
 
+	//! keep the preallocation and the non-zero pattern of the previous fill, only the values are overwritten
+	bool reuse_pattern = false;
+
+	//! number of triplets of the last fill with a new preallocation (0 if the matrix has never been preallocated)
+	size_t pattern_nnz = 0;
+
+	//! size of the blocks (1 means scalar AIJ storage)
+	PetscInt block_size = 1;
+
+	//! if true only the upper triangular blocks are stored (SBAIJ)
+	bool block_sym = false;
+
+	//! the matrix is stored on the GPU (AIJCUSPARSE or AIJHIPSPARSE)
+	bool on_device = false;
+
+	/*! \brief Count the non-zero blocks of every local block row and preallocate a BAIJ/SBAIJ Matrix
+	 *
+	 * The type is chosen by all the processors together (MatSetType is collective): if the rows of one processor
+	 * cannot be divided in blocks (for example the Lagrange multiplier row on the last processor) all the
+	 * processors keep AIJ
+	 *
+	 * \return false if the local rows of one of the processors cannot be divided in blocks
+	 *
+	 */
+	bool preallocate_block()
+	{
+		int divisible = (l_row % block_size == 0 && start_row % block_size == 0);
+		int all_divisible = divisible;
+		MPI_Allreduce(&divisible,&all_divisible,1,MPI_INT,MPI_LAND,PetscObjectComm((PetscObject)mat));
+
+		if (all_divisible == 0)
+		{
+			if (divisible == 0)
+			{std::cerr << __FILE__ << ":" << __LINE__ << " warning, the local rows (" << l_row << ") are not a multiple of the block size (" << block_size << "), the matrix is stored as AIJ" << std::endl;}
+			return false;
+		}
+
+		PETSC_SAFE_CALL(MatSetType(mat,(block_sym == true)?MATSBAIJ:MATBAIJ));
+		PETSC_SAFE_CALL(MatSetBlockSize(mat,block_size));
+
+		size_t l_brow = l_row / block_size;
+		size_t start_brow = start_row / block_size;
+
+		d_nnz.resize(l_brow);
+		o_nnz.resize(l_brow);
+
+		d_nnz.fill(0);
+		o_nnz.fill(0);
+
+		// distinct block colums of every block row
+		std::vector<std::vector<PetscInt>> bcols(l_brow);
+		for (size_t i = 0 ; i < trpl.size() ; i++)
+		{
+			PetscInt brow = trpl.get(i).row() / block_size;
+			PetscInt bcol = trpl.get(i).col() / block_size;
+
+			// SBAIJ store only the upper triangular part
+			if (block_sym == true && bcol < brow)	{continue;}
+
+			bcols[brow - start_brow].push_back(bcol);
+		}
+
+		for (size_t i = 0 ; i < l_brow ; i++)
+		{
+			std::sort(bcols[i].begin(),bcols[i].end());
+			auto last = std::unique(bcols[i].begin(),bcols[i].end());
+
+			for (auto it = bcols[i].begin() ; it != last ; ++it)
+			{
+				if ((size_t)*it >= start_brow && (size_t)*it < start_brow + l_brow)
+					d_nnz.get(i)++;
+				else
+					o_nnz.get(i)++;
+			}
+		}
+
+		PETSC_SAFE_CALL(MatXAIJSetPreallocation(mat,block_size,static_cast<const PetscInt*>(d_nnz.getPointer()),
+												static_cast<const PetscInt*>(o_nnz.getPointer()),NULL,NULL));
+
+		if (block_sym == true)
+		{PETSC_SAFE_CALL(MatSetOption(mat,MAT_IGNORE_LOWER_TRIANGULAR,PETSC_TRUE));}
+
+		return true;
+	}
+
 	/*! \brief Fill the petsc Matrix
 	 *
 	 *
 	 */
 	void fill_petsc()
 	{
+		// same pattern: the preallocation and the structure built by the previous assembly are kept
+		if (reuse_pattern == true && pattern_nnz != 0 && pattern_nnz == trpl.size())
+		{
+			set_values_petsc();
+			return;
+		}
+
+		if (block_size > 1 && preallocate_block() == true)
+		{
+			// a refill that would add a location is an error, instead of a silent reallocation
+			if (reuse_pattern == true)
+			{PETSC_SAFE_CALL(MatSetOption(mat,MAT_NEW_NONZERO_LOCATION_ERR,PETSC_TRUE));}
+
+			set_values_petsc();
+
+			pattern_nnz = trpl.size();
+			return;
+		}
+
 		d_nnz.resize(l_row);
 		o_nnz.resize(l_row);
 
@@ -174,8 +280,23 @@ private:
 		PETSC_SAFE_CALL(MatMPIAIJSetPreallocation(mat,0,static_cast<const PetscInt*>(d_nnz.getPointer()),0,
 														static_cast<const PetscInt*>(o_nnz.getPointer())));
 
+		// a refill that would add a location is an error, instead of a silent reallocation
+		if (reuse_pattern == true)
+		{PETSC_SAFE_CALL(MatSetOption(mat,MAT_NEW_NONZERO_LOCATION_ERR,PETSC_TRUE));}
+
+		set_values_petsc();
+
+		pattern_nnz = trpl.size();
+	}
+
+	/*! \brief Insert the triplets in the preallocated petsc Matrix and assemble it
+	 *
+	 *
+	 */
+	void set_values_petsc()
+	{
 		// Counter i is zero
-		i = 0;
+		size_t i = 0;
 
 		// Set the Matrix from triplet
 		while (i < trpl.size())
@@ -221,6 +342,7 @@ public:
 	SparseMatrix(size_t N1, size_t N2, size_t n_row_local)
 	:g_row(N1),g_col(N2),l_row(n_row_local),l_col(n_row_local)
 	{
+		numerics_backends::ensure_petsc();
 		PETSC_SAFE_CALL(MatCreate(PETSC_COMM_WORLD,&mat));
 		PETSC_SAFE_CALL(MatSetType(mat,MATMPIAIJ));
         PETSC_SAFE_CALL(MatSetFromOptions(mat));
@@ -245,6 +367,7 @@ public:
 	SparseMatrix()
 	:g_row(0),g_col(0),l_row(0l),l_col(0),start_row(0)
 	{
+		numerics_backends::ensure_petsc();
 		PETSC_SAFE_CALL(MatCreate(PETSC_COMM_WORLD,&mat));
         PETSC_SAFE_CALL(MatSetType(mat,MATMPIAIJ));
         PETSC_SAFE_CALL(MatSetFromOptions(mat));
@@ -272,6 +395,225 @@ public:
 		return this->trpl;
 	}
 
+	/*! \brief Memory used by the matrix in byte on this processor
+	 *
+	 * Triplets, the staging buffers of the fill and the local part of the PETSc matrix (MatGetInfo)
+	 *
+	 * \return the memory in byte
+	 *
+	 */
+	size_t getMemoryUsage() const
+	{
+		size_t mem = trpl.size()*sizeof(triplet_type) + vals.size()*sizeof(PetscScalar)
+		             + (cols.size() + d_nnz.size() + o_nnz.size())*sizeof(PetscInt);
+
+		if (m_created == true)
+		{
+			MatInfo info;
+			if (MatGetInfo(mat,MAT_LOCAL,&info) == 0)
+			{mem += (size_t)info.memory;}
+		}
+
+		return mem;
+	}
+
+	/*! \brief Keep the non-zero pattern between fills
+	 *
+	 * When active, a fill with the same number of triplets of the previous fill (in the same order of rows and
+	 * columns, as produced by imposing the same operators again) only overwrites the values: the preallocation,
+	 * the non-zero structure and the communication pattern built by the previous assembly are reused. Inserting
+	 * a location outside of the pattern is a PETSc error
+	 *
+	 * \param reuse true to keep the pattern
+	 *
+	 */
+	void reusePattern(bool reuse)
+	{
+		reuse_pattern = reuse;
+	}
+
+	/*! \brief Store the Matrix on the GPU
+	 *
+	 * The matrix become MATAIJCUSPARSE (PETSc configured with CUDA) or MATAIJHIPSPARSE (PETSc configured with HIP),
+	 * the SpMV and the preconditioners that support it run on the device, the vectors of the solve must be
+	 * device vectors too (Vector::setDevice). Must be called before the Matrix is filled
+	 *
+	 * \param dev true to store the matrix on the device
+	 *
+	 */
+	void setDevice(bool dev)
+	{
+		if (pattern_nnz != 0 || m_created == true)
+		{
+			std::cerr << __FILE__ << ":" << __LINE__ << " error, the device storage must be set before the matrix is filled" << std::endl;
+			return;
+		}
+
+#if defined(PETSC_HAVE_CUDA)
+		PETSC_SAFE_CALL(MatSetType(mat,(dev == true)?MATAIJCUSPARSE:MATMPIAIJ));
+#elif defined(PETSC_HAVE_HIP)
+		PETSC_SAFE_CALL(MatSetType(mat,(dev == true)?MATAIJHIPSPARSE:MATMPIAIJ));
+#else
+		if (dev == true)
+		{
+			std::cerr << __FILE__ << ":" << __LINE__ << " warning, PETSc has been configured without CUDA or HIP, the matrix stay on the host" << std::endl;
+			return;
+		}
+#endif
+
+		on_device = dev;
+	}
+
+	/*! \brief Return true if the matrix is stored on the device
+	 *
+	 * \return true if the matrix is on the device
+	 *
+	 */
+	bool isOnDevice() const
+	{
+		return on_device;
+	}
+
+#if PETSC_VERSION_GE(3,15,0)
+
+	/*! \brief Fill the Matrix from coordinate (COO) triplets in the PETSc arrays
+	 *
+	 * Unlike getMatrixTriplets the triplets are not copied in the openfpm buffer, rows and colums are global and
+	 * they can be in any order (duplicated entries are summed). For a device matrix (setDevice) the values can be a
+	 * device pointer (and with PETSc 3.17 or newer also the indices), so triplets computed in a kernel go to the
+	 * matrix without host staging. Calling it again with the same n, rows and colums only update the values
+	 *
+	 * \param n number of local triplets
+	 * \param rows row of every triplet
+	 * \param cols colum of every triplet
+	 * \param vals value of every triplet
+	 * \param same_pattern the rows and colums are the same of the previous call
+	 *
+	 */
+	void fillCOO(size_t n, PetscInt * rows, PetscInt * cols, const PetscScalar * vals, bool same_pattern = false)
+	{
+		if (same_pattern == false || pattern_nnz != n)
+		{
+			PETSC_SAFE_CALL(MatSetPreallocationCOO(mat,n,rows,cols));
+			pattern_nnz = n;
+		}
+
+		PETSC_SAFE_CALL(MatSetValuesCOO(mat,vals,INSERT_VALUES));
+
+		m_created = true;
+	}
+
+#endif
+
+	/*! \brief Store the Matrix in blocks of size bs (PETSc BAIJ, or SBAIJ if symmetric)
+	 *
+	 * For systems with several unknowns per point interleaved as row = point*nvar + component, with bs = nvar every
+	 * point-point coupling is one dense block: the index storage is divided by bs and SpMV and point-block
+	 * preconditioners (PCPBJACOBI, block ILU, AMG with block size) work on the blocks. With symmetric only the
+	 * upper triangular blocks are kept, the lower triplets are ignored. Must be called before the Matrix is filled
+	 *
+	 * \param bs block size (1 for the standard AIJ storage)
+	 * \param symmetric store only the upper triangular blocks
+	 *
+	 */
+	void setBlockSize(size_t bs, bool symmetric = false)
+	{
+		if (pattern_nnz != 0 || m_created == true)
+		{
+			std::cerr << __FILE__ << ":" << __LINE__ << " error, the block size must be set before the matrix is filled" << std::endl;
+			return;
+		}
+
+		block_size = bs;
+		block_sym = symmetric;
+	}
+
+	/*! \brief Fill the Matrix directly from the local rows in CSR format, without triplets
+	 *
+	 * The preallocation and the insertion are done by PETSc in one call (MatMPIAIJSetPreallocationCSR),
+	 * the arrays are copied, so they can be released after the call. The Matrix must have been
+	 * sized before (constructor or resize)
+	 *
+	 * \param row_ptr offsets of the local rows, l_row+1 entries starting from 0
+	 * \param col_ind global colums of every entry, sorted inside each row
+	 * \param val values of every entry
+	 *
+	 */
+	void fillCSR(const PetscInt * row_ptr, const PetscInt * col_ind, const PetscScalar * val)
+	{
+		trpl.clear();
+
+		PETSC_SAFE_CALL(MatMPIAIJSetPreallocationCSR(mat,row_ptr,col_ind,val));
+
+		// the matrix is already assembled by MatMPIAIJSetPreallocationCSR
+		pattern_nnz = 0;
+		m_created = true;
+	}
+
+	/*! \brief Prepare the Matrix to receive the local rows in blocks with addRowBlock
+	 *
+	 * \param d_nnz for each local row the number of non zero in the colums of this processor
+	 * \param o_nnz for each local row the number of non zero in the colums of the other processors
+	 *
+	 */
+	void beginRowBlocks(const openfpm::vector<PetscInt> & d_nnz, const openfpm::vector<PetscInt> & o_nnz)
+	{
+		if (d_nnz.size() != l_row || o_nnz.size() != l_row)
+		{
+			std::cerr << __FILE__ << ":" << __LINE__ << " error, d_nnz and o_nnz must have one entry for each local row (" << l_row << ")" << std::endl;
+			return;
+		}
+
+		trpl.clear();
+
+		PETSC_SAFE_CALL(MatMPIAIJSetPreallocation(mat,0,static_cast<const PetscInt*>(d_nnz.getPointer()),0,
+														static_cast<const PetscInt*>(o_nnz.getPointer())));
+
+		pattern_nnz = 0;
+		m_created = false;
+	}
+
+	/*! \brief Insert a block of consecutive rows in CSR format
+	 *
+	 * Only the block is held in memory by the caller, the rows are copied into the preallocated Matrix
+	 *
+	 * \param first_row global id of the first row of the block (it must be a local row)
+	 * \param n_rows number of rows in the block
+	 * \param row_ptr offsets of the rows inside the block, n_rows+1 entries starting from 0
+	 * \param col_ind global colums of every entry of the block
+	 * \param val values of every entry of the block
+	 *
+	 */
+	void addRowBlock(PetscInt first_row, PetscInt n_rows, const PetscInt * row_ptr, const PetscInt * col_ind, const PetscScalar * val)
+	{
+		for (PetscInt r = 0 ; r < n_rows ; r++)
+		{
+			PetscInt row = first_row + r;
+			PETSC_SAFE_CALL(MatSetValues(mat,1,&row,row_ptr[r+1] - row_ptr[r],&col_ind[row_ptr[r]],&val[row_ptr[r]],INSERT_VALUES));
+		}
+	}
+
+	/*! \brief Assemble the Matrix after all the row blocks has been added
+	 *
+	 */
+	void endRowBlocks()
+	{
+		PETSC_SAFE_CALL(MatAssemblyBegin(mat,MAT_FINAL_ASSEMBLY));
+		PETSC_SAFE_CALL(MatAssemblyEnd(mat,MAT_FINAL_ASSEMBLY));
+
+		m_created = true;
+	}
+
+	/*! \brief Starting global row of this processor
+	 *
+	 * \return the first local row
+	 *
+	 */
+	size_t getStartRow() const
+	{
+		return start_row;
+	}
+
 	/*! \brief Get the Patsc Matrix object
 	 *
 	 * \return the Eigen Matrix
@@ -372,6 +714,85 @@ public:
 		return 0;
 	}
 
+	/*! \brief Save the assembled matrix with the PETSc binary viewer
+	 *
+	 * Every processor write its rows in the same file (MPI-IO when PETSc has it), the file can be loaded with
+	 * loadBinary on a different number of processors. It is collective
+	 *
+	 * \param file filename
+	 *
+	 * \return true if succed
+	 *
+	 */
+	bool saveBinary(const std::string & file)
+	{
+		getMat();
+
+		PetscViewer viewer;
+		if (PetscViewerBinaryOpen(PETSC_COMM_WORLD,file.c_str(),FILE_MODE_WRITE,&viewer) != 0)
+		{return false;}
+
+		PetscErrorCode err = MatView(mat,viewer);
+		PETSC_SAFE_CALL(PetscViewerDestroy(&viewer));
+
+		return err == 0;
+	}
+
+	/*! \brief Load a matrix saved with saveBinary
+	 *
+	 * If the sizes are set (constructor or resize) the local rows are the ones given, otherwise PETSc distribute
+	 * the rows. The matrix is assembled and the triplets are not read: setting new triplets replace it. The
+	 * storage type (block, device) is the one set before the call. It is collective
+	 *
+	 * \param file filename
+	 *
+	 * \return true if succed
+	 *
+	 */
+	bool loadBinary(const std::string & file)
+	{
+		// MatLoad need a matrix that has not been filled
+		if (m_created == true || pattern_nnz != 0)
+		{
+			MatType type;
+			PETSC_SAFE_CALL(MatGetType(mat,&type));
+			std::string type_s(type);
+
+			PETSC_SAFE_CALL(MatDestroy(&mat));
+			PETSC_SAFE_CALL(MatCreate(PETSC_COMM_WORLD,&mat));
+			PETSC_SAFE_CALL(MatSetType(mat,type_s.c_str()));
+			if (g_row != 0)
+			{PETSC_SAFE_CALL(MatSetSizes(mat,l_row,l_col,g_row,g_col));}
+		}
+
+		PetscViewer viewer;
+		if (PetscViewerBinaryOpen(PETSC_COMM_WORLD,file.c_str(),FILE_MODE_READ,&viewer) != 0)
+		{return false;}
+
+		PetscErrorCode err = MatLoad(mat,viewer);
+		PETSC_SAFE_CALL(PetscViewerDestroy(&viewer));
+
+		if (err != 0)
+		{return false;}
+
+		PetscInt gr, gc, lr, lc, low, high;
+		PETSC_SAFE_CALL(MatGetSize(mat,&gr,&gc));
+		PETSC_SAFE_CALL(MatGetLocalSize(mat,&lr,&lc));
+		PETSC_SAFE_CALL(MatGetOwnershipRange(mat,&low,&high));
+
+		g_row = gr;
+		g_col = gc;
+		l_row = lr;
+		l_col = lc;
+		start_row = low;
+
+		trpl.clear();
+		pattern_nnz = 0;
+		m_created = true;
+
+		return true;
+	}
+
 	/*! \brief Return the state of matrix
 	 *
 	 * Returns a bool flag that indicated whether the matrix
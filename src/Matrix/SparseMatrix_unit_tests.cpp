@@ -14,6 +14,8 @@
 #include "Matrix/SparseMatrix.hpp"
 #include "Vector/Vector.hpp"
 #include "Solvers/umfpack_solver.hpp"
+#include "Solvers/mixed_precision_solver.hpp"
+#include "Solvers/eigen_iterative_solver.hpp"
 #include "Solvers/petsc_solver.hpp"
 
 #ifdef HAVE_PETSC
@@ -176,8 +178,416 @@ BOOST_AUTO_TEST_CASE(sparse_matrix_eigen_parallel)
 #endif
 }
 
+BOOST_AUTO_TEST_CASE(sparse_matrix_eigen_spmv)
+{
+#if defined(HAVE_EIGEN)
+
+	Vcluster<> & vcl = create_vcluster();
+
+	if (vcl.getProcessingUnits() != 1)
+		return;
+
+	// 5 point laplacian on a 300x300 grid
+	const int n = 300;
+	const int N = n*n;
+
+	SparseMatrix<double,int> sm(N,N);
+
+	typedef SparseMatrix<double,int>::triplet_type triplet;
+
+	auto & triplets = sm.getMatrixTriplets();
+	for (int i = 0 ; i < n ; i++)
+	{
+		for (int j = 0 ; j < n ; j++)
+		{
+			int r = i*n + j;
+			triplets.add(triplet(r,r,-4.0));
+			if (i > 0) {triplets.add(triplet(r,r-n,1.0));}
+			if (i < n-1) {triplets.add(triplet(r,r+n,1.0));}
+			if (j > 0) {triplets.add(triplet(r,r-1,1.0));}
+			if (j < n-1) {triplets.add(triplet(r,r+1,1.0));}
+		}
+	}
+
+	Vector<double> x(N);
+	Vector<double> y(N);
+	Vector<double> y_ref(N);
+
+	auto & xv = x.getVec();
+	auto & yv = y.getVec();
+	auto & yv_ref = y_ref.getVec();
+
+	for (int i = 0 ; i < N ; i++)
+	{xv(i) = sin(0.001*i); yv(i) = 1.0;}
+
+	yv_ref = 0.5 * (sm.getMat() * xv) + 2.0 * yv;
+
+	sm.spmv(x,y,0.5,2.0);
+
+	for (int i = 0 ; i < N ; i++)
+	{BOOST_REQUIRE_SMALL(yv(i) - yv_ref(i),1e-12);}
+
+	// y = y + 0.25*x, then y = 2*y
+	y.axpy(0.25,x);
+	y.scale(2.0);
+
+	for (int i = 0 ; i < N ; i++)
+	{BOOST_REQUIRE_SMALL(yv(i) - 2.0*(yv_ref(i) + 0.25*xv(i)),1e-12);}
+
+#endif
+}
+
+BOOST_AUTO_TEST_CASE(sparse_matrix_eigen_binary_save_load)
+{
+#if defined(HAVE_EIGEN)
+
+	Vcluster<> & vcl = create_vcluster();
+
+	if (vcl.getProcessingUnits() != 1)
+		return;
+
+	const int n = 50;
+	const int N = n*n;
+
+	SparseMatrix<double,int> sm(N,N);
+
+	typedef SparseMatrix<double,int>::triplet_type triplet;
+
+	auto & triplets = sm.getMatrixTriplets();
+	for (int i = 0 ; i < n ; i++)
+	{
+		for (int j = 0 ; j < n ; j++)
+		{
+			int r = i*n + j;
+			triplets.add(triplet(r,r,-4.0 + 0.001*r));
+			if (i > 0) {triplets.add(triplet(r,r-n,1.0));}
+			if (j < n-1) {triplets.add(triplet(r,r+1,0.5));}
+		}
+	}
+
+	BOOST_REQUIRE_EQUAL(sm.saveBinary("sparse_matrix_binary.bin"),true);
+
+	SparseMatrix<double,int> sm2;
+	BOOST_REQUIRE_EQUAL(sm2.loadBinary("sparse_matrix_binary.bin"),true);
+
+	auto & m1 = sm.getMat();
+	auto & m2 = sm2.getMat();
+
+	BOOST_REQUIRE_EQUAL(m1.rows(),m2.rows());
+	BOOST_REQUIRE_EQUAL(m1.cols(),m2.cols());
+	BOOST_REQUIRE_EQUAL(m1.nonZeros(),m2.nonZeros());
+
+	for (int i = 0 ; i < N ; i += 37)
+	{
+		BOOST_REQUIRE_EQUAL(sm(i,i),sm2(i,i));
+		if (i+1 < N) {BOOST_REQUIRE_EQUAL(sm(i,i+1),sm2(i,i+1));}
+	}
+
+	// a matrix with another index type is refused
+	SparseMatrix<double,long int> sm3;
+	BOOST_REQUIRE_EQUAL(sm3.loadBinary("sparse_matrix_binary.bin"),false);
+
+#endif
+}
+
+BOOST_AUTO_TEST_CASE(sparse_matrix_eigen_umfpack_multiple_rhs)
+{
+#if defined(HAVE_EIGEN) && defined(HAVE_SUITESPARSE)
+
+	Vcluster<> & vcl = create_vcluster();
+
+	if (vcl.getProcessingUnits() != 1)
+		return;
+
+	const int N = 100;
+	const int nrhs = 4;
+
+	SparseMatrix<double,int> sm(N,N);
+	std::vector<Vector<double>> b(nrhs);
+
+	typedef SparseMatrix<double,int>::triplet_type triplet;
+
+	auto & triplets = sm.getMatrixTriplets();
+	for (int i = 0 ; i < N ; i++)
+	{
+		if (i > 0) {triplets.add(triplet(i,i-1,-1.0));}
+		triplets.add(triplet(i,i,2.5));
+		if (i < N-1) {triplets.add(triplet(i,i+1,-1.0));}
+
+		for (int j = 0 ; j < nrhs ; j++)
+		{b[j].insert(i,cos(0.05*i*(j+1)));}
+	}
+
+	for (int j = 0 ; j < nrhs ; j++)
+	{b[j].resize(N,N);}
+
+	umfpack_solver<double> solver;
+	auto x = solver.solve(sm,b);
+
+	BOOST_REQUIRE_EQUAL(x.size(),(size_t)nrhs);
+
+	for (int j = 0 ; j < nrhs ; j++)
+	{
+		auto x1 = solver.solve(sm,b[j]);
+
+		for (int i = 0 ; i < N ; i++)
+		{BOOST_REQUIRE_SMALL(x[j](i) - x1(i),1e-10);}
+	}
+
+#endif
+}
+
+BOOST_AUTO_TEST_CASE(sparse_matrix_eigen_umfpack_factorization_cache)
+{
+#if defined(HAVE_EIGEN) && defined(HAVE_SUITESPARSE)
+
+	Vcluster<> & vcl = create_vcluster();
+
+	if (vcl.getProcessingUnits() != 1)
+		return;
+
+	const int N = 100;
+
+	SparseMatrix<double,int> sm(N,N);
+	Vector<double> b(N);
+
+	typedef SparseMatrix<double,int>::triplet_type triplet;
+
+	umfpack_solver<double> solver;
+
+	for (int step = 1 ; step <= 3 ; step++)
+	{
+		auto & triplets = sm.getMatrixTriplets();
+		triplets.clear();
+
+		// the values change only at the step 3
+		double d = (step == 3)?3.0:2.5;
+		for (int i = 0 ; i < N ; i++)
+		{
+			if (i > 0) {triplets.add(triplet(i,i-1,-1.0));}
+			triplets.add(triplet(i,i,d));
+			if (i < N-1) {triplets.add(triplet(i,i+1,-1.0));}
+
+			if (step == 1) {b.insert(i,1.0);}
+		}
+
+		auto x = solver.solve(sm,b);
+
+		// check one interior row
+		BOOST_REQUIRE_SMALL(-x(49) + d*x(50) - x(51) - 1.0,1e-10);
+	}
+
+	BOOST_REQUIRE_EQUAL(solver.getNAnalyze(),1ul);
+	BOOST_REQUIRE_EQUAL(solver.getNFactorize(),2ul);
+
+#endif
+}
+
+BOOST_AUTO_TEST_CASE(sparse_matrix_eigen_float)
+{
+#if defined(HAVE_EIGEN)
+
+	Vcluster<> & vcl = create_vcluster();
+
+	if (vcl.getProcessingUnits() != 1)
+		return;
+
+	const int N = 100;
+
+	SparseMatrix<float,int> sm(N,N);
+	Vector<float> b(N);
+
+	typedef SparseMatrix<float,int>::triplet_type triplet;
+
+	umfpack_solver<float> solver;
+
+	for (int step = 1 ; step <= 2 ; step++)
+	{
+		auto & triplets = sm.getMatrixTriplets();
+		triplets.clear();
+
+		for (int i = 0 ; i < N ; i++)
+		{
+			if (i > 0) {triplets.add(triplet(i,i-1,-1.0f));}
+			triplets.add(triplet(i,i,2.5f));
+			if (i < N-1) {triplets.add(triplet(i,i+1,-1.0f));}
+
+			if (step == 1) {b.insert(i,1.0f);}
+		}
+
+		auto x = solver.solve(sm,b);
+
+		// check one interior row in single precision
+		BOOST_REQUIRE_SMALL(-x(49) + 2.5f*x(50) - x(51) - 1.0f,1e-5f);
+	}
+
+	// same matrix, the factorization is reused
+	BOOST_REQUIRE_EQUAL(solver.getNAnalyze(),1ul);
+	BOOST_REQUIRE_EQUAL(solver.getNFactorize(),1ul);
+
+#endif
+}
+
+BOOST_AUTO_TEST_CASE(sparse_matrix_eigen_mixed_precision)
+{
+#if defined(HAVE_EIGEN)
+
+	Vcluster<> & vcl = create_vcluster();
+
+	if (vcl.getProcessingUnits() != 1)
+		return;
+
+	const int N = 200;
+
+	SparseMatrix<double,int> sm(N,N);
+	Vector<double> b(N);
+
+	typedef SparseMatrix<double,int>::triplet_type triplet;
+
+	// diffusion like matrix
+	auto & triplets = sm.getMatrixTriplets();
+	for (int i = 0 ; i < N ; i++)
+	{
+		if (i > 0) {triplets.add(triplet(i,i-1,-1.0));}
+		triplets.add(triplet(i,i,2.1));
+		if (i < N-1) {triplets.add(triplet(i,i+1,-1.0));}
+
+		b.insert(i,1.0 + 0.001*i);
+	}
+
+	mixed_precision_solver<double> solver;
+	solver.setTolerance(1e-12);
+
+	auto x = solver.solve(sm,b);
+
+	// the single precision factorization with the refinement is enough
+	BOOST_REQUIRE_EQUAL(solver.isFallBack(),false);
+	BOOST_REQUIRE(solver.getIterations() >= 1);
+	BOOST_REQUIRE(solver.getResidual() <= 1e-12);
+
+	BOOST_REQUIRE_SMALL(-x(99) + 2.1*x(100) - x(101) - (1.0 + 0.1),1e-10);
+
+#endif
+}
+
+BOOST_AUTO_TEST_CASE(sparse_matrix_eigen_iterative)
+{
+#if defined(HAVE_EIGEN)
+
+	Vcluster<> & vcl = create_vcluster();
+
+	if (vcl.getProcessingUnits() != 1)
+		return;
+
+	const int N = 200;
+
+	SparseMatrix<double,int> sm(N,N);
+	Vector<double> b(N);
+
+	typedef SparseMatrix<double,int>::triplet_type triplet;
+
+	// diffusion like matrix, symmetric positive definite
+	auto & triplets = sm.getMatrixTriplets();
+	for (int i = 0 ; i < N ; i++)
+	{
+		if (i > 0) {triplets.add(triplet(i,i-1,-1.0));}
+		triplets.add(triplet(i,i,2.1));
+		if (i < N-1) {triplets.add(triplet(i,i+1,-1.0));}
+
+		b.insert(i,1.0 + 0.001*i);
+	}
+
+	eigen_krylov ksp[2] = {eigen_krylov::CG,eigen_krylov::BICGSTAB};
+	eigen_pc pc[2] = {eigen_pc::JACOBI,eigen_pc::ILUT};
+
+	for (size_t i = 0 ; i < 2 ; i++)
+	{
+		for (size_t j = 0 ; j < 2 ; j++)
+		{
+			eigen_iterative_solver<double> solver;
+			solver.setSolver(ksp[i]);
+			solver.setPreconditioner(pc[j]);
+			solver.setTolerance(1e-12);
+
+			auto x = solver.solve(sm,b);
+
+			BOOST_REQUIRE_EQUAL(solver.getMetrics().converged,true);
+			BOOST_REQUIRE(solver.getIterations() >= 1);
+			BOOST_REQUIRE(solver.getResidual() <= 1e-12);
+
+			BOOST_REQUIRE_SMALL(-x(99) + 2.1*x(100) - x(101) - (1.0 + 0.1),1e-9);
+		}
+	}
+
+	// without dropping, the ILUT of the 1D diffusion is the exact LU
+	eigen_iterative_solver<double> solver;
+	solver.setPreconditioner(eigen_pc::ILUT);
+	solver.setPreconditionerILUT(0.0,10);
+	solver.solve(sm,b);
+
+	BOOST_REQUIRE(solver.getIterations() <= 2);
+
+#endif
+}
+
 #ifdef HAVE_PETSC
 
+BOOST_AUTO_TEST_CASE(sparse_matrix_eigen_reuse_pattern)
+{
+#if defined(HAVE_EIGEN)
+
+	Vcluster<> & vcl = create_vcluster();
+
+	if (vcl.getProcessingUnits() != 1)
+		return;
+
+	const int N = 50;
+
+	SparseMatrix<double,int> sm(N,N);
+	sm.reusePattern(true);
+
+	typedef SparseMatrix<double,int>::triplet_type triplet;
+
+	for (int step = 1 ; step <= 3 ; step++)
+	{
+		auto & triplets = sm.getMatrixTriplets();
+		triplets.clear();
+
+		// same pattern, the coefficients change with the step, (0,0) appears twice
+		for (int i = 0 ; i < N ; i++)
+		{
+			if (i > 0) {triplets.add(triplet(i,i-1,step));}
+			triplets.add(triplet(i,i,-2.0*step));
+			if (i < N-1) {triplets.add(triplet(i,i+1,step));}
+		}
+		triplets.add(triplet(0,0,0.5*step));
+
+		auto & mat = sm.getMat();
+
+		BOOST_REQUIRE_EQUAL(mat.nonZeros(),3*N-2);
+		BOOST_REQUIRE_CLOSE(mat.coeff(0,0),-1.5*step,1e-12);
+		BOOST_REQUIRE_CLOSE(mat.coeff(10,10),-2.0*step,1e-12);
+		BOOST_REQUIRE_CLOSE(mat.coeff(10,11),1.0*step,1e-12);
+		BOOST_REQUIRE_CLOSE(mat.coeff(11,10),1.0*step,1e-12);
+	}
+
+	// a different pattern rebuilds the matrix
+	auto & triplets = sm.getMatrixTriplets();
+	triplets.clear();
+	for (int i = 0 ; i < N ; i++)
+	{triplets.add(triplet(i,i,1.0));}
+	triplets.add(triplet(0,N-1,2.0));
+	for (int i = 0 ; i < 2*N-3 ; i++)
+	{triplets.add(triplet(N-1,N-1,0.0));}
+
+	auto & mat = sm.getMat();
+	BOOST_REQUIRE_EQUAL(mat.nonZeros(),N+1);
+	BOOST_REQUIRE_CLOSE(mat.coeff(0,N-1),2.0,1e-12);
+	BOOST_REQUIRE_CLOSE(mat.coeff(N-1,N-1),1.0,1e-12);
+
+#endif
+}
+
 BOOST_AUTO_TEST_CASE(sparse_matrix_eigen_petsc)
 {
 	Vcluster<> & vcl = create_vcluster();
@@ -422,6 +832,267 @@ BOOST_AUTO_TEST_CASE(sparse_matrix_eigen_petsc_solve)
 	solver.solve(sm,v);
 }
 
+BOOST_AUTO_TEST_CASE(sparse_matrix_petsc_csr_fill)
+{
+	Vcluster<> & vcl = create_vcluster();
+
+	const int loc = 50;
+	const int N = loc*vcl.getProcessingUnits();
+	const int start = loc*vcl.getProcessUnitID();
+
+	typedef SparseMatrix<double,int,PETSC_BASE>::triplet_type triplet;
+
+	SparseMatrix<double,int,PETSC_BASE> sm_trpl(N,N,loc);
+	SparseMatrix<double,int,PETSC_BASE> sm_csr(N,N,loc);
+	SparseMatrix<double,int,PETSC_BASE> sm_blk(N,N,loc);
+
+	auto & triplets = sm_trpl.getMatrixTriplets();
+
+	openfpm::vector<PetscInt> row_ptr;
+	openfpm::vector<PetscInt> col_ind;
+	openfpm::vector<PetscScalar> val;
+	openfpm::vector<PetscInt> d_nnz;
+	openfpm::vector<PetscInt> o_nnz;
+
+	row_ptr.add(0);
+	for (int i = start ; i < start + loc ; i++)
+	{
+		PetscInt d = 0, o = 0;
+		for (int j = i-1 ; j <= i+1 ; j++)
+		{
+			if (j < 0 || j >= N)	{continue;}
+
+			double value = (i == j)?-2.0:1.0 + 0.01*i;
+			triplets.add(triplet(i,j,value));
+			col_ind.add(j);
+			val.add(value);
+
+			if (j >= start && j < start + loc)	{d++;}
+			else	{o++;}
+		}
+		row_ptr.add(col_ind.size());
+		d_nnz.add(d);
+		o_nnz.add(o);
+	}
+
+	sm_trpl.getMat();
+	sm_csr.fillCSR(&row_ptr.get(0),&col_ind.get(0),&val.get(0));
+
+	// two blocks of rows
+	openfpm::vector<PetscInt> row_ptr2;
+	for (int i = loc/2 ; i <= loc ; i++)
+	{row_ptr2.add(row_ptr.get(i) - row_ptr.get(loc/2));}
+
+	sm_blk.beginRowBlocks(d_nnz,o_nnz);
+	sm_blk.addRowBlock(start,loc/2,&row_ptr.get(0),&col_ind.get(0),&val.get(0));
+	sm_blk.addRowBlock(start+loc/2,loc-loc/2,&row_ptr2.get(0),&col_ind.get(row_ptr.get(loc/2)),&val.get(row_ptr.get(loc/2)));
+	sm_blk.endRowBlocks();
+
+	BOOST_REQUIRE_EQUAL(sm_csr.isMatrixFilled(),true);
+	BOOST_REQUIRE_EQUAL(sm_blk.isMatrixFilled(),true);
+
+	for (int i = start ; i < start + loc ; i++)
+	{
+		for (int j = std::max(0,i-2) ; j <= std::min(N-1,i+2) ; j++)
+		{
+			BOOST_REQUIRE_EQUAL(sm_trpl(i,j),sm_csr(i,j));
+			BOOST_REQUIRE_EQUAL(sm_trpl(i,j),sm_blk(i,j));
+		}
+	}
+}
+
+#if PETSC_VERSION_GE(3,15,0)
+
+BOOST_AUTO_TEST_CASE(sparse_matrix_petsc_coo_fill)
+{
+	Vcluster<> & vcl = create_vcluster();
+
+	const int loc = 50;
+	const int N = loc*vcl.getProcessingUnits();
+	const int start = loc*vcl.getProcessUnitID();
+
+	typedef SparseMatrix<double,int,PETSC_BASE>::triplet_type triplet;
+
+	SparseMatrix<double,int,PETSC_BASE> sm_trpl(N,N,loc);
+	SparseMatrix<double,int,PETSC_BASE> sm_coo(N,N,loc);
+
+	// on a host only PETSc it stay AIJ
+	sm_coo.setDevice(true);
+
+	auto & triplets = sm_trpl.getMatrixTriplets();
+
+	openfpm::vector<PetscInt> rows;
+	openfpm::vector<PetscInt> cols;
+	openfpm::vector<PetscScalar> vals;
+
+	// the rows inverted to check that the order does not matter
+	for (int i = start + loc - 1 ; i >= start ; i--)
+	{
+		for (int j = i-1 ; j <= i+1 ; j++)
+		{
+			if (j < 0 || j >= N)	{continue;}
+
+			double value = (i == j)?-2.0:1.0 + 0.01*i;
+			triplets.add(triplet(i,j,value));
+			rows.add(i);
+			cols.add(j);
+			vals.add(value);
+		}
+	}
+
+	sm_trpl.getMat();
+
+	sm_coo.fillCOO(rows.size(),&rows.get(0),&cols.get(0),&vals.get(0));
+	BOOST_REQUIRE_EQUAL(sm_coo.isMatrixFilled(),true);
+
+	for (int i = start ; i < start + loc ; i++)
+	{
+		for (int j = std::max(0,i-2) ; j <= std::min(N-1,i+2) ; j++)
+		{BOOST_REQUIRE_EQUAL(sm_trpl(i,j),sm_coo(i,j));}
+	}
+
+	// values only
+	for (size_t k = 0 ; k < vals.size() ; k++)
+	{vals.get(k) *= 2.0;}
+	sm_coo.fillCOO(rows.size(),&rows.get(0),&cols.get(0),&vals.get(0),true);
+
+	for (int i = start ; i < start + loc ; i++)
+	{BOOST_REQUIRE_EQUAL(2.0*sm_trpl(i,i),sm_coo(i,i));}
+}
+
+#endif
+
+BOOST_AUTO_TEST_CASE(sparse_matrix_petsc_binary_save_load)
+{
+	Vcluster<> & vcl = create_vcluster();
+
+	const int loc = 30;
+	const int N = loc*vcl.getProcessingUnits();
+	const int start = loc*vcl.getProcessUnitID();
+
+	typedef SparseMatrix<double,int,PETSC_BASE>::triplet_type triplet;
+
+	SparseMatrix<double,int,PETSC_BASE> sm(N,N,loc);
+
+	auto & t = sm.getMatrixTriplets();
+	for (int r = start ; r < start + loc ; r++)
+	{
+		if (r > 0) {t.add(triplet(r,r-1,1.0));}
+		t.add(triplet(r,r,-2.0 - 0.01*r));
+		if (r < N-1) {t.add(triplet(r,r+1,1.0));}
+	}
+
+	BOOST_REQUIRE_EQUAL(sm.saveBinary("sparse_matrix_petsc.bin"),true);
+
+	// without sizes PETSc distribute the rows
+	SparseMatrix<double,int,PETSC_BASE> sm2;
+	BOOST_REQUIRE_EQUAL(sm2.loadBinary("sparse_matrix_petsc.bin"),true);
+
+	PetscBool eq;
+	PETSC_SAFE_CALL(MatEqual(sm.getMat(),sm2.getMat(),&eq));
+	BOOST_REQUIRE(eq == PETSC_TRUE);
+}
+
+BOOST_AUTO_TEST_CASE(sparse_matrix_petsc_block)
+{
+	Vcluster<> & vcl = create_vcluster();
+
+	const int nvar = 2;
+	const int loc = 20;
+	const int N = nvar*loc*vcl.getProcessingUnits();
+	const int start = nvar*loc*vcl.getProcessUnitID();
+
+	typedef SparseMatrix<double,int,PETSC_BASE>::triplet_type triplet;
+
+	SparseMatrix<double,int,PETSC_BASE> sm_aij(N,N,nvar*loc);
+	SparseMatrix<double,int,PETSC_BASE> sm_baij(N,N,nvar*loc);
+	sm_baij.setBlockSize(nvar);
+
+	auto & t_aij = sm_aij.getMatrixTriplets();
+	auto & t_baij = sm_baij.getMatrixTriplets();
+
+	// two coupled components per point, every point coupled with its neighbours
+	for (int p = start/nvar ; p < (start + nvar*loc)/nvar ; p++)
+	{
+		for (int c = 0 ; c < nvar ; c++)
+		{
+			int r = p*nvar + c;
+			for (int q = p-1 ; q <= p+1 ; q++)
+			{
+				if (q < 0 || q >= N/nvar)	{continue;}
+
+				for (int c2 = 0 ; c2 < nvar ; c2++)
+				{
+					double value = (q == p && c == c2)?-4.0:0.1*(c2+1) + 0.01*r;
+					t_aij.add(triplet(r,q*nvar+c2,value));
+					t_baij.add(triplet(r,q*nvar+c2,value));
+				}
+			}
+		}
+	}
+
+	PetscInt bs;
+	PETSC_SAFE_CALL(MatGetBlockSize(sm_baij.getMat(),&bs));
+	BOOST_REQUIRE_EQUAL(bs,nvar);
+
+	sm_aij.getMat();
+
+	for (int i = start ; i < start + nvar*loc ; i++)
+	{
+		for (int j = std::max(0,i-2*nvar) ; j <= std::min(N-1,i+2*nvar) ; j++)
+		{BOOST_REQUIRE_EQUAL(sm_aij(i,j),sm_baij(i,j));}
+	}
+}
+
+BOOST_AUTO_TEST_CASE(sparse_matrix_petsc_block_lagrange)
+{
+	Vcluster<> & vcl = create_vcluster();
+
+	const int nvar = 2;
+	const int loc = 20;
+	const bool last = (vcl.getProcessUnitID() == vcl.getProcessingUnits() - 1);
+
+	// like DCPSE_scheme with LAGRANGE_MULTIPLIER, the last processor has one more row
+	const int N = nvar*loc*vcl.getProcessingUnits() + 1;
+	const int start = nvar*loc*vcl.getProcessUnitID();
+	const int l_row = nvar*loc + ((last == true)?1:0);
+
+	typedef SparseMatrix<double,int,PETSC_BASE>::triplet_type triplet;
+
+	SparseMatrix<double,int,PETSC_BASE> sm_aij(N,N,l_row);
+	SparseMatrix<double,int,PETSC_BASE> sm_block(N,N,l_row);
+	sm_block.setBlockSize(nvar);
+
+	auto & t_aij = sm_aij.getMatrixTriplets();
+	auto & t_block = sm_block.getMatrixTriplets();
+
+	for (int r = start ; r < start + nvar*loc ; r++)
+	{
+		if (r > 0) {t_aij.add(triplet(r,r-1,1.0)); t_block.add(triplet(r,r-1,1.0));}
+		t_aij.add(triplet(r,r,-2.0 - 0.01*r)); t_block.add(triplet(r,r,-2.0 - 0.01*r));
+		t_aij.add(triplet(r,r+1,1.0)); t_block.add(triplet(r,r+1,1.0));
+	}
+
+	if (last == true)
+	{
+		for (int c = start ; c < N ; c++)
+		{t_aij.add(triplet(N-1,c,1.0)); t_block.add(triplet(N-1,c,1.0));}
+	}
+
+	// the rows of the last processor break the blocks, all the processors must keep AIJ (a mix of types hangs)
+	PetscInt bs;
+	PETSC_SAFE_CALL(MatGetBlockSize(sm_block.getMat(),&bs));
+	BOOST_REQUIRE_EQUAL(bs,1);
+
+	sm_aij.getMat();
+
+	for (int i = start ; i < start + l_row ; i++)
+	{
+		for (int j = std::max(0,i-1) ; j <= std::min(N-1,i+1) ; j++)
+		{BOOST_REQUIRE_EQUAL(sm_aij(i,j),sm_block(i,j));}
+	}
+}
+
 #endif
 
 BOOST_AUTO_TEST_SUITE_END()
@@ -31,6 +31,11 @@ namespace boost{
 #include "Operators/Vector/vector_dist_operators.hpp"
 #include "FiniteDifference/FD_expressions.hpp"
 #include "OdeIntegrators/vector_algebra_ofp.hpp"
+#include "OdeIntegrators/state_type_ofp_view.hpp"
+#include "OdeIntegrators/native_steppers_ofp.hpp"
+#include "OdeIntegrators/multirate_ofp.hpp"
+#include "OdeIntegrators/parareal_ofp.hpp"
+#include "OdeIntegrators/checkpoint_ofp.hpp"
 
 #ifdef __NVCC__
 #include "OdeIntegrators/vector_algebra_ofp_gpu.hpp"
@@ -116,6 +121,16 @@ struct state_type_1d_ofp{
     {
         data.get<0>().resize(n);
     }
+
+    //! Reserve the memory for n particles in all the properties (the stage buffers of the steppers copy this capacity)
+    void reserve(size_t n)
+    {
+        data.get<0>().getVector().reserve(n);
+    }
+
+    //! Number of particles that can be stored without reallocating
+    size_t capacity()
+    { return data.get<0>().getVector().capacity(); }
 };
 
 /*! \brief A 2d Odeint and Openfpm compatible structure.
@@ -141,6 +156,17 @@ struct state_type_2d_ofp{
         data.get<0>().resize(n);
         data.get<1>().resize(n);
     }
+
+    //! Reserve the memory for n particles in all the properties (the stage buffers of the steppers copy this capacity)
+    void reserve(size_t n)
+    {
+        data.get<0>().getVector().reserve(n);
+        data.get<1>().getVector().reserve(n);
+    }
+
+    //! Number of particles that can be stored without reallocating
+    size_t capacity()
+    { return data.get<0>().getVector().capacity(); }
 };
 
 /*! \brief A 3d Odeint and Openfpm compatible structure.
@@ -167,6 +193,18 @@ struct state_type_3d_ofp{
         data.get<1>().resize(n);
         data.get<2>().resize(n);
     }
+
+    //! Reserve the memory for n particles in all the properties (the stage buffers of the steppers copy this capacity)
+    void reserve(size_t n)
+    {
+        data.get<0>().getVector().reserve(n);
+        data.get<1>().getVector().reserve(n);
+        data.get<2>().getVector().reserve(n);
+    }
+
+    //! Number of particles that can be stored without reallocating
+    size_t capacity()
+    { return data.get<0>().getVector().capacity(); }
 };
 
 /*! \brief A 4d Odeint and Openfpm compatible structure.
@@ -194,6 +232,19 @@ struct state_type_4d_ofp{
         data.get<2>().resize(n);
         data.get<3>().resize(n);
     }
+
+    //! Reserve the memory for n particles in all the properties (the stage buffers of the steppers copy this capacity)
+    void reserve(size_t n)
+    {
+        data.get<0>().getVector().reserve(n);
+        data.get<1>().getVector().reserve(n);
+        data.get<2>().getVector().reserve(n);
+        data.get<3>().getVector().reserve(n);
+    }
+
+    //! Number of particles that can be stored without reallocating
+    size_t capacity()
+    { return data.get<0>().getVector().capacity(); }
 };
 
 /*! \brief A 5d Odeint and Openfpm compatible structure.
@@ -223,6 +274,20 @@ struct state_type_5d_ofp{
         data.get<4>().resize(n);
 
     }
+
+    //! Reserve the memory for n particles in all the properties (the stage buffers of the steppers copy this capacity)
+    void reserve(size_t n)
+    {
+        data.get<0>().getVector().reserve(n);
+        data.get<1>().getVector().reserve(n);
+        data.get<2>().getVector().reserve(n);
+        data.get<3>().getVector().reserve(n);
+        data.get<4>().getVector().reserve(n);
+    }
+
+    //! Number of particles that can be stored without reallocating
+    size_t capacity()
+    { return data.get<0>().getVector().capacity(); }
 };
 
 template<int counter, typename state_type, typename ... list>
@@ -268,6 +333,44 @@ namespace boost {
 
             // FOR particles
 
+            /*! \brief Resize a stage buffer of a stepper on the particle state
+             *
+             * The buffer is resized as the state, and it reserve the capacity of the state. Because openfpm vectors
+             * never release memory when they shrink, the stage buffers stay allocated at the high-water mark of the
+             * state: if the state is reserved for the maximum number of particles the steppers do not allocate when the
+             * number of particles change after a map()
+             *
+             */
+            template<typename state_ofp>
+            struct resize_impl_ofp
+            {
+                static void resize(state_ofp &x1, const state_ofp &x2)
+                {
+                    // capacity does not modify the state
+                    size_t cap = const_cast<state_ofp &>(x2).capacity();
+
+                    if (x1.capacity() < cap)
+                    {x1.reserve(cap);}
+
+                    x1.resize(x2.size());
+                }
+            };
+
+            template<>
+            struct resize_impl<state_type_1d_ofp,state_type_1d_ofp> : public resize_impl_ofp<state_type_1d_ofp> {};
+
+            template<>
+            struct resize_impl<state_type_2d_ofp,state_type_2d_ofp> : public resize_impl_ofp<state_type_2d_ofp> {};
+
+            template<>
+            struct resize_impl<state_type_3d_ofp,state_type_3d_ofp> : public resize_impl_ofp<state_type_3d_ofp> {};
+
+            template<>
+            struct resize_impl<state_type_4d_ofp,state_type_4d_ofp> : public resize_impl_ofp<state_type_4d_ofp> {};
+
+            template<>
+            struct resize_impl<state_type_5d_ofp,state_type_5d_ofp> : public resize_impl_ofp<state_type_5d_ofp> {};
+
             template<>
             struct is_resizeable<state_type_1d_ofp> {
             typedef boost::true_type type;
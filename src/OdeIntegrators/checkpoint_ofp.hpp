@@ -0,0 +1,443 @@
+//
+// Asynchronous checkpoints of the openfpm states and of the steppers
+//
+
+#ifndef OPENFPM_NUMERICS_CHECKPOINT_OFP_HPP
+#define OPENFPM_NUMERICS_CHECKPOINT_OFP_HPP
+
+#include <string>
+#include <thread>
+#include <vector>
+#include <mpi.h>
+#include <hdf5.h>
+#include "OdeIntegrators/state_pack_ofp.hpp"
+#include "OdeIntegrators/native_steppers_ofp.hpp"
+
+/*! \brief Internal state of a stepper that is carried from one step to the next
+ *
+ * The steppers that restart every step from the state only (runge_kutta4, euler, lsrk_2n_ofp, ...) have no internals.
+ * A stepper that keep data across the steps specialize this structure, so that a restart from a checkpoint continue
+ * exactly as the run that wrote it
+ *
+ */
+template<typename stepper_type>
+struct stepper_internals_ofp
+{
+    //! copy the internals of the stepper in buf
+    template<typename state_type>
+    static void save(stepper_type & stepper, state_type & x, std::vector<double> & buf)
+    {
+        buf.clear();
+    }
+
+    //! restore the internals of the stepper from buf
+    template<typename state_type>
+    static void load(stepper_type & stepper, state_type & x, const std::vector<double> & buf)
+    {}
+};
+
+//! rk_bs32_ofp keep the last stage of the previous step (FSAL)
+template<typename state_type_, typename algebra>
+struct stepper_internals_ofp<rk_bs32_ofp<state_type_,algebra>>
+{
+    //! the first value is 1 if the last stage is valid, followed by the last stage
+    template<typename state_type>
+    static void save(rk_bs32_ofp<state_type_,algebra> & stepper, state_type & x, std::vector<double> & buf)
+    {
+        bool valid = stepper.fsalValid() && stepper.getFsal().size() == x.size();
+
+        buf.resize(1);
+        buf[0] = (valid == true)?1.0:0.0;
+
+        if (valid == true)
+        {
+            buf.resize(1 + countStateOfp(stepper.getFsal()));
+            state_pack_ofp<state_type_>::pack(stepper.getFsal(),buf.data() + 1);
+        }
+    }
+
+    //! restore the last stage
+    template<typename state_type>
+    static void load(rk_bs32_ofp<state_type_,algebra> & stepper, state_type & x, const std::vector<double> & buf)
+    {
+        stepper.fsalValid() = buf.size() != 0 && buf[0] == 1.0;
+
+        if (stepper.fsalValid() == true)
+        {
+            stepper.getFsal().resize(x.size());
+            state_pack_ofp<state_type_>::unpack(buf.data() + 1,stepper.getFsal());
+        }
+    }
+};
+
+//! Stepper without internals, for the checkpoints of a state only
+struct no_stepper_ofp
+{};
+
+/*! \brief Asynchronous checkpoint of a state and of its stepper
+ *
+ * snapshot() copy the local part of the state and the internals of the stepper in a staging buffer and return, the
+ * buffer is written in an HDF5 file (parallel HDF5, one dataset for the state and one for the stepper, every processor
+ * write its part) by a background thread while the integration continue. There are two staging buffers: a snapshot
+ * is copied while the previous one is still written, and it wait for the previous write only before starting its own.
+ * The background thread use its own communicator, it require MPI_THREAD_MULTIPLE; if MPI does not provide it the
+ * snapshots are written synchronously.
+ *
+ * The file contain the time, the time step, the state and the internals of the stepper: a run loaded with load() on the
+ * same number of processors and with the same decomposition continue bit by bit as the run that saved it. The
+ * particles (positions and the properties that are not in the state) are saved with vector_dist::save
+ *
+ * \code{.cpp}
+
+   async_checkpoint_ofp<state_type_ofp_view<2>> chk;
+
+   while (t < tf)
+   {
+       bs32.try_step(rhs,x,t,dt);
+
+       if (++n % 100 == 0)
+       {chk.snapshot("chk_" + std::to_string(n/100) + ".h5",x,bs32,t,dt);}
+   }
+
+   chk.wait();
+
+ * \endcode
+ *
+ * \tparam state_type state (state_type_1d_ofp ... state_type_5d_ofp, state_type_ofp_view)
+ *
+ */
+template<typename state_type>
+class async_checkpoint_ofp
+{
+    //! data of a snapshot
+    struct staging
+    {
+        //! file to write
+        std::string filename;
+
+        //! local part of the state
+        std::vector<double> x;
+
+        //! local internals of the stepper
+        std::vector<double> s;
+
+        //! time
+        double t;
+
+        //! time step
+        double dt;
+    };
+
+    //! communicator of the background writes
+    MPI_Comm io_comm;
+
+    //! true if the writes run in the background
+    bool async;
+
+    //! staging buffers
+    staging stg[2];
+
+    //! staging buffer of the next snapshot
+    int cur = 0;
+
+    //! thread writing the previous snapshot
+    std::thread writer;
+
+    /*! \brief Write the local part v of the dataset name, the processors write their part one after the other
+     *
+     * \param file HDF5 file
+     * \param name dataset
+     * \param v local part
+     *
+     */
+    void write_dataset(hid_t file, const char * name, const std::vector<double> & v)
+    {
+        unsigned long long n = v.size();
+        unsigned long long off = 0;
+        unsigned long long tot = 0;
+
+        int rank;
+        MPI_Comm_rank(io_comm,&rank);
+        MPI_Exscan(&n,&off,1,MPI_UNSIGNED_LONG_LONG,MPI_SUM,io_comm);
+        MPI_Allreduce(&n,&tot,1,MPI_UNSIGNED_LONG_LONG,MPI_SUM,io_comm);
+        if (rank == 0) {off = 0;}
+
+        hsize_t gsz = tot;
+        hsize_t h_off = off;
+        hsize_t h_n = n;
+        hsize_t m_n = (n == 0)?1:n;
+
+        hid_t fspace = H5Screate_simple(1,&gsz,NULL);
+        hid_t mspace = H5Screate_simple(1,&m_n,NULL);
+        hid_t ds = H5Dcreate(file,name,H5T_NATIVE_DOUBLE,fspace,H5P_DEFAULT,H5P_DEFAULT,H5P_DEFAULT);
+
+        if (n == 0)
+        {
+            H5Sselect_none(fspace);
+            H5Sselect_none(mspace);
+        }
+        else
+        {H5Sselect_hyperslab(fspace,H5S_SELECT_SET,&h_off,NULL,&h_n,NULL);}
+
+        hid_t xfer = H5Pcreate(H5P_DATASET_XFER);
+        H5Pset_dxpl_mpio(xfer,H5FD_MPIO_COLLECTIVE);
+        H5Dwrite(ds,H5T_NATIVE_DOUBLE,mspace,fspace,xfer,v.data());
+
+        H5Pclose(xfer);
+        H5Dclose(ds);
+        H5Sclose(mspace);
+        H5Sclose(fspace);
+    }
+
+    /*! \brief Read the local part v of the dataset name
+     *
+     * \param file HDF5 file
+     * \param name dataset
+     * \param v local part, resized to the size the processor wrote
+     *
+     */
+    void read_dataset(hid_t file, const char * name, std::vector<double> & v)
+    {
+        int rank;
+        MPI_Comm_rank(io_comm,&rank);
+
+        // sizes of the local parts
+        std::string name_sz = std::string(name) + "_size";
+        std::vector<double> sz(1);
+        read_part(file,name_sz.c_str(),rank,1,sz);
+
+        unsigned long long n = (unsigned long long)sz[0];
+        unsigned long long off = 0;
+        MPI_Exscan(&n,&off,1,MPI_UNSIGNED_LONG_LONG,MPI_SUM,io_comm);
+        if (rank == 0) {off = 0;}
+
+        read_part(file,name,off,n,v);
+    }
+
+    //! Read n values of the dataset name from off
+    void read_part(hid_t file, const char * name, unsigned long long off, unsigned long long n, std::vector<double> & v)
+    {
+        v.resize(n);
+
+        hsize_t h_off = off;
+        hsize_t h_n = n;
+        hsize_t m_n = (n == 0)?1:n;
+
+        hid_t ds = H5Dopen(file,name,H5P_DEFAULT);
+        hid_t fspace = H5Dget_space(ds);
+        hid_t mspace = H5Screate_simple(1,&m_n,NULL);
+
+        if (n == 0)
+        {
+            H5Sselect_none(fspace);
+            H5Sselect_none(mspace);
+        }
+        else
+        {H5Sselect_hyperslab(fspace,H5S_SELECT_SET,&h_off,NULL,&h_n,NULL);}
+
+        hid_t xfer = H5Pcreate(H5P_DATASET_XFER);
+        H5Pset_dxpl_mpio(xfer,H5FD_MPIO_COLLECTIVE);
+        H5Dread(ds,H5T_NATIVE_DOUBLE,mspace,fspace,xfer,v.data());
+
+        H5Pclose(xfer);
+        H5Sclose(mspace);
+        H5Sclose(fspace);
+        H5Dclose(ds);
+    }
+
+    //! Write a scalar attribute of the file
+    void write_attribute(hid_t file, const char * name, double val)
+    {
+        hid_t space = H5Screate(H5S_SCALAR);
+        hid_t attr = H5Acreate(file,name,H5T_NATIVE_DOUBLE,space,H5P_DEFAULT,H5P_DEFAULT);
+        H5Awrite(attr,H5T_NATIVE_DOUBLE,&val);
+        H5Aclose(attr);
+        H5Sclose(space);
+    }
+
+    //! Read a scalar attribute of the file
+    double read_attribute(hid_t file, const char * name)
+    {
+        double val = 0.0;
+        hid_t attr = H5Aopen(file,name,H5P_DEFAULT);
+        H5Aread(attr,H5T_NATIVE_DOUBLE,&val);
+        H5Aclose(attr);
+
+        return val;
+    }
+
+    //! Write a staging buffer in its file
+    void write(staging & st)
+    {
+        hid_t fapl = H5Pcreate(H5P_FILE_ACCESS);
+        H5Pset_fapl_mpio(fapl,io_comm,MPI_INFO_NULL);
+        hid_t file = H5Fcreate(st.filename.c_str(),H5F_ACC_TRUNC,H5P_DEFAULT,fapl);
+        H5Pclose(fapl);
+
+        if (file < 0)
+        {
+            std::cerr << __FILE__ << ":" << __LINE__ << " error cannot create the checkpoint " << st.filename << std::endl;
+            return;
+        }
+
+        write_attribute(file,"time",st.t);
+        write_attribute(file,"dt",st.dt);
+
+        std::vector<double> sz(1);
+        sz[0] = st.x.size();
+        write_dataset(file,"state_size",sz);
+        write_dataset(file,"state",st.x);
+
+        sz[0] = st.s.size();
+        write_dataset(file,"stepper_size",sz);
+        write_dataset(file,"stepper",st.s);
+
+        H5Fclose(file);
+    }
+
+public:
+
+    async_checkpoint_ofp()
+    {
+        MPI_Comm_dup(MPI_COMM_WORLD,&io_comm);
+
+        int provided;
+        MPI_Query_thread(&provided);
+        async = (provided == MPI_THREAD_MULTIPLE);
+    }
+
+    ~async_checkpoint_ofp()
+    {
+        wait();
+        MPI_Comm_free(&io_comm);
+    }
+
+    //! true if the snapshots are written in the background
+    bool isAsync()
+    {
+        return async;
+    }
+
+    //! Wait that the last snapshot is written
+    void wait()
+    {
+        if (writer.joinable() == true)
+        {writer.join();}
+    }
+
+    /*! \brief Take a snapshot of the state and of the stepper and write it in the background
+     *
+     * The state can be modified as soon as the function return. All the processors must call it
+     *
+     * \param filename HDF5 file
+     * \param x state
+     * \param stepper stepper integrating the state
+     * \param t time
+     * \param dt time step
+     *
+     */
+    template<typename stepper_type>
+    void snapshot(const std::string & filename, state_type & x, stepper_type & stepper, double t, double dt)
+    {
+        staging & st = stg[cur];
+
+        st.filename = filename;
+        st.t = t;
+        st.dt = dt;
+        packStateOfp(x,st.x);
+        stepper_internals_ofp<stepper_type>::save(stepper,x,st.s);
+
+        // the other staging buffer is free when its write is done
+        wait();
+
+        if (async == true)
+        {writer = std::thread(&async_checkpoint_ofp<state_type>::write,this,std::ref(st));}
+        else
+        {write(st);}
+
+        cur = 1 - cur;
+    }
+
+    /*! \brief Take a snapshot of the state only (stepper without internals)
+     *
+     * \param filename HDF5 file
+     * \param x state
+     * \param t time
+     * \param dt time step
+     *
+     */
+    void snapshot(const std::string & filename, state_type & x, double t, double dt)
+    {
+        no_stepper_ofp stepper;
+        snapshot(filename,x,stepper,t,dt);
+    }
+
+    /*! \brief Restart from a checkpoint
+     *
+     * The state must have the local size it had when it has been saved (same number of processors and same
+     * decomposition, for example the particles reloaded with vector_dist::load and the view created again)
+     *
+     * \param filename HDF5 file
+     * \param x state
+     * \param stepper stepper integrating the state
+     * \param t time
+     * \param dt time step
+     *
+     * \return false if the checkpoint cannot be read or does not match the state
+     *
+     */
+    template<typename stepper_type>
+    bool load(const std::string & filename, state_type & x, stepper_type & stepper, double & t, double & dt)
+    {
+        wait();
+
+        hid_t fapl = H5Pcreate(H5P_FILE_ACCESS);
+        H5Pset_fapl_mpio(fapl,io_comm,MPI_INFO_NULL);
+        hid_t file = H5Fopen(filename.c_str(),H5F_ACC_RDONLY,fapl);
+        H5Pclose(fapl);
+
+        if (file < 0)
+        {
+            std::cerr << __FILE__ << ":" << __LINE__ << " error cannot open the checkpoint " << filename << std::endl;
+            return false;
+        }
+
+        staging & st = stg[cur];
+
+        t = read_attribute(file,"time");
+        dt = read_attribute(file,"dt");
+        read_dataset(file,"state",st.x);
+        read_dataset(file,"stepper",st.s);
+
+        H5Fclose(file);
+
+        if (st.x.size() != countStateOfp(x))
+        {
+            std::cerr << __FILE__ << ":" << __LINE__ << " error the checkpoint " << filename << " has " << st.x.size() << " local values, the state " << countStateOfp(x) << std::endl;
+            return false;
+        }
+
+        unpackStateOfp(st.x,x);
+        stepper_internals_ofp<stepper_type>::load(stepper,x,st.s);
+
+        return true;
+    }
+
+    /*! \brief Restart the state only from a checkpoint
+     *
+     * \param filename HDF5 file
+     * \param x state
+     * \param t time
+     * \param dt time step
+     *
+     * \return false if the checkpoint cannot be read or does not match the state
+     *
+     */
+    bool load(const std::string & filename, state_type & x, double & t, double & dt)
+    {
+        no_stepper_ofp stepper;
+        return load(filename,x,stepper,t,dt);
+    }
+};
+
+#endif //OPENFPM_NUMERICS_CHECKPOINT_OFP_HPP
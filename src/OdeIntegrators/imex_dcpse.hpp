@@ -0,0 +1,167 @@
+//
+// IMEX Runge-Kutta driver: explicit DCPSE operators and implicit DCPSE_scheme solves
+//
+
+#ifndef OPENFPM_NUMERICS_IMEX_DCPSE_HPP
+#define OPENFPM_NUMERICS_IMEX_DCPSE_HPP
+
+#include <cmath>
+#include "Operators/Vector/vector_dist_operators.hpp"
+
+/*! \brief IMEX Runge-Kutta ARS(2,2,2) integration of du/dt = E(u,t) + L u with DCPSE operators
+ *
+ * E is the explicit part (for example the advection or a reaction term, evaluated with DCPSE operators), L a linear
+ * operator treated implicitly (for example the diffusion) with a DCPSE_scheme. The scheme is the second order,
+ * L-stable scheme of Ascher, Ruuth and Spiteri (Appl. Numer. Math. 25, 1997): the two implicit stages have the same
+ * diagonal coefficient gamma = 1 - 1/sqrt(2), so every stage solve the same system
+ *
+ * (1 - gamma*dt*L) U = b
+ *
+ * The matrix is assembled (and the preconditioner built) only when dt change, every stage only update b and solve
+ * with the previous operator (solve_with_solver_successive). The stages live in properties of the particles:
+ *
+ * - prp_u: unknown u, it contain the solution and the stages
+ * - prp_b: right-hand side of the implicit stages
+ * - prp_un, prp_e1, prp_e2: u at the beginning of the step and the explicit terms of the two first stages
+ *
+ * The step need three functions
+ *
+ * - explicit_rhs(e,t): write E(u,t) in e (a getV expression), u is the property prp_u (call ghost_get before
+ *   applying a DCPSE operator)
+ * - impose_A(Solver,g_dt): impose the rows of the system with the right-hand side prp_b, for example
+ *   Solver.impose(u - g_dt*Lap(u),bulk,prop_id<prp_b>()), and the boundary conditions
+ * - impose_b(Solver): impose only the right-hand side (Solver.impose_b on the same subsets, in the same order),
+ *   Solver.reset_b() is called before
+ *
+ * \code{.cpp}
+
+   imex_ars222_dcpse<decltype(Solver),decltype(vd),0,1,2,3,4> imex(Solver,vd);
+
+   auto E = [&](auto e, double t) {vd.template ghost_get<0>(); e = -c*Dx(u);};
+   auto A = [&](auto & S, double g_dt) {S.impose(u - g_dt*Lap(u),bulk,prop_id<1>()); S.impose(u,bnd,0.0);};
+   auto B = [&](auto & S) {S.impose_b(bulk,prop_id<1>()); S.impose_b(bnd,0.0);};
+
+   while (t < tf)
+   {
+       imex.do_step(solver,E,A,B,t,dt);
+       t += dt;
+   }
+
+ * \endcode
+ *
+ * \tparam scheme_type DCPSE_scheme of the implicit part
+ * \tparam particles_type particle set (vector_dist)
+ *
+ */
+template<typename scheme_type, typename particles_type, unsigned int prp_u, unsigned int prp_b,
+         unsigned int prp_un, unsigned int prp_e1, unsigned int prp_e2>
+class imex_ars222_dcpse
+{
+    //! implicit system
+    scheme_type & Solver;
+
+    //! particles
+    particles_type & vd;
+
+    //! dt of the assembled matrix (negative if the matrix has not been assembled)
+    double dt_assembled = -1.0;
+
+    //! diagonal coefficient of the implicit stages
+    static double gamma()
+    { return 1.0 - 1.0/std::sqrt(2.0); }
+
+    //! explicit coefficient of the first stage in the last stage
+    static double delta()
+    { return 1.0 - 1.0/(2.0*gamma()); }
+
+    /*! \brief Solve (1 - gamma*dt*L) u = b
+     *
+     * \param solver linear solver
+     * \param impose_A function that impose the rows of the system
+     * \param impose_b function that impose the right-hand side
+     * \param dt time step
+     *
+     */
+    template<typename solver_type, typename impose_A_type, typename impose_b_type>
+    void stage_solve(solver_type & solver, impose_A_type & impose_A, impose_b_type & impose_b, double dt)
+    {
+        auto u = getV<prp_u>(vd);
+
+        if (dt_assembled != dt)
+        {
+            Solver.reset_nodec();
+            impose_A(Solver,gamma()*dt);
+
+            // full solve, it set the matrix and build the preconditioner
+            Solver.solve_with_solver(solver,u);
+            dt_assembled = dt;
+            return;
+        }
+
+        Solver.reset_b();
+        impose_b(Solver);
+        Solver.solve_with_solver_successive(solver,u);
+    }
+
+public:
+
+    /*! \brief Constructor
+     *
+     * \param Solver implicit system, reset and imposed by the driver at every change of dt
+     * \param vd particles
+     *
+     */
+    imex_ars222_dcpse(scheme_type & Solver, particles_type & vd)
+    :Solver(Solver),vd(vd)
+    {}
+
+    //! order of the scheme
+    unsigned short order() const
+    { return 2; }
+
+    //! Force the assembly of the matrix on the next step (for example after the particles moved)
+    void invalidate()
+    { dt_assembled = -1.0; }
+
+    /*! \brief Do one step
+     *
+     * \param solver linear solver (petsc_solver), it keep the operator and the preconditioner between the stages
+     * \param explicit_rhs explicit part, explicit_rhs(e,t)
+     * \param impose_A impose the implicit system, impose_A(Solver,gamma*dt)
+     * \param impose_b impose the right-hand side of the implicit system, impose_b(Solver)
+     * \param t time
+     * \param dt time step
+     *
+     */
+    template<typename solver_type, typename explicit_type, typename impose_A_type, typename impose_b_type>
+    void do_step(solver_type & solver, explicit_type explicit_rhs, impose_A_type impose_A, impose_b_type impose_b,
+                 double t, double dt)
+    {
+        auto u = getV<prp_u>(vd);
+        auto b = getV<prp_b>(vd);
+        auto un = getV<prp_un>(vd);
+        auto e1 = getV<prp_e1>(vd);
+        auto e2 = getV<prp_e2>(vd);
+
+        double g = gamma();
+        double d = delta();
+
+        un = u;
+
+        // first stage, explicit
+        explicit_rhs(e1,t);
+
+        // second stage, (1 - g*dt*L) U2 = u_n + g*dt*E1
+        b = un + (g*dt)*e1;
+        stage_solve(solver,impose_A,impose_b,dt);
+        explicit_rhs(e2,t + g*dt);
+
+        // third stage, L U2 = (U2 - b2)/(g*dt) so L is never applied explicitly
+        b = un + (d*dt)*e1 + ((1.0 - d)*dt)*e2 + ((1.0 - g)/g)*(u - b);
+        stage_solve(solver,impose_A,impose_b,dt);
+
+        // the scheme is stiffly accurate, the last stage is the solution
+    }
+};
+
+#endif //OPENFPM_NUMERICS_IMEX_DCPSE_HPP
@@ -0,0 +1,145 @@
+//
+// Multi-rate (sub-cycling) integration of several groups of states
+//
+
+#ifndef OPENFPM_NUMERICS_MULTIRATE_OFP_HPP
+#define OPENFPM_NUMERICS_MULTIRATE_OFP_HPP
+
+#include <cmath>
+
+/*! \brief Group of a multi-rate integration
+ *
+ * A state with its stepper and its right-hand side. In every macro step of size dt the group does substeps steps of
+ * size dt/substeps
+ *
+ * \tparam stepper_type odeint stepper (stepper_tag, do_step(system,x,t,dt)), for example runge_kutta4 or lsrk_2n_ofp
+ * \tparam system_type right-hand side, system(x,dxdt,t)
+ * \tparam state_type state of the group (state_type_1d_ofp ... state_type_5d_ofp, state_type_ofpm_impl, state_type_ofp_view)
+ *
+ */
+template<typename stepper_type, typename system_type, typename state_type>
+struct multirate_group_ofp
+{
+    //! stepper of the group
+    stepper_type & stepper;
+
+    //! right-hand side of the group
+    system_type system;
+
+    //! state of the group
+    state_type & x;
+
+    //! number of steps of the group in a macro step
+    unsigned int substeps;
+
+    /*! \brief Advance the group of one macro step
+     *
+     * \param t time at the beginning of the macro step
+     * \param dt macro step
+     *
+     */
+    void advance(double t, double dt)
+    {
+        double h = dt / substeps;
+
+        for (unsigned int i = 0 ; i < substeps ; i++)
+        {stepper.do_step(system,x,t + i*h,h);}
+    }
+};
+
+/*! \brief Create a group for integrate_multirate
+ *
+ * \param stepper stepper of the group (it keep its stage buffers across the macro steps)
+ * \param system right-hand side of the group
+ * \param x state of the group
+ * \param substeps number of steps of the group in a macro step (1 for the slow groups)
+ *
+ * \return the group
+ *
+ */
+template<typename stepper_type, typename system_type, typename state_type>
+multirate_group_ofp<stepper_type,system_type,state_type> getMultirateGroup(stepper_type & stepper, system_type system,
+                                                                           state_type & x, unsigned int substeps)
+{
+    if (substeps == 0)
+    {
+        std::cerr << __FILE__ << ":" << __LINE__ << " error the number of sub-steps of a group must be at least 1" << std::endl;
+        substeps = 1;
+    }
+
+    return multirate_group_ofp<stepper_type,system_type,state_type>{stepper,system,x,substeps};
+}
+
+//! Advance all the groups of one macro step (end of the recursion)
+inline void multirate_advance(double t, double dt)
+{}
+
+//! Advance all the groups of one macro step, in the order they are given
+template<typename group, typename ... groups>
+inline void multirate_advance(double t, double dt, group & g, groups & ... gs)
+{
+    g.advance(t,dt);
+    multirate_advance(t,dt,gs ...);
+}
+
+/*! \brief Multi-rate integration of several groups of states
+ *
+ * Every group advance with its own time step: in a macro step dt a group with n sub-steps does n steps of dt/n, so
+ * only the stiff (or fast) part of the problem pays the small time step. The groups are advanced one after the other in
+ * the order they are given, and a group see the other groups at the last time they have been advanced (the coupling
+ * is first order in dt, as a Lie splitting). Giving the slow groups first, the fast groups sub-cycle with the slow
+ * state already at the end of the macro step.
+ *
+ * After every macro step sync(t) is called with the time reached by all the groups: it is the synchronization point
+ * where the groups can exchange data (for example ghost_get, or the copy of the state of a vector_dist_subset back
+ * to the full particle set)
+ *
+ * \code{.cpp}
+
+   lsrk_2n_ofp<state_type_ofp_view<1>,vector_space_algebra_ofp_view> lsrk_bulk, lsrk_bnd;
+
+   auto bulk = getMultirateGroup(lsrk_bulk,rhs_bulk,x_bulk,1);
+   auto bnd = getMultirateGroup(lsrk_bnd,rhs_bnd,x_bnd,20);
+
+   integrate_multirate([&](double t){vd.ghost_get<0>();},0.0,1.0,0.01,bulk,bnd);
+
+ * \endcode
+ *
+ * \param sync function called after every macro step, sync(t)
+ * \param t0 initial time
+ * \param t1 final time
+ * \param dt macro step (the last macro step is shortened to reach t1)
+ * \param gs groups, created with getMultirateGroup
+ *
+ * \return the number of macro steps
+ *
+ */
+template<typename sync_type, typename ... groups>
+size_t integrate_multirate(sync_type sync, double t0, double t1, double dt, groups ... gs)
+{
+    if (dt <= 0.0)
+    {
+        std::cerr << __FILE__ << ":" << __LINE__ << " error the macro step must be positive" << std::endl;
+        return 0;
+    }
+
+    size_t n_steps = 0;
+    double t = t0;
+
+    // the last step is shortened only if it is not a rounding of dt
+    while (t1 - t > 1e-12*dt)
+    {
+        double h = (t + dt > t1)?(t1 - t):dt;
+
+        multirate_advance(t,h,gs ...);
+
+        n_steps++;
+        t = (t + dt > t1)?t1:t0 + n_steps*dt;
+
+        sync(t);
+    }
+
+    return n_steps;
+}
+
+#endif //OPENFPM_NUMERICS_MULTIRATE_OFP_HPP
@@ -0,0 +1,389 @@
+//
+// Native low-storage and adaptive Runge-Kutta steppers for the openfpm states
+//
+
+#ifndef OPENFPM_NUMERICS_NATIVE_STEPPERS_OFP_HPP
+#define OPENFPM_NUMERICS_NATIVE_STEPPERS_OFP_HPP
+
+#include <cmath>
+#include <algorithm>
+
+/*! \brief Williamson 3-stage, third order 2N-storage scheme
+ *
+ * J.H. Williamson, Low-storage Runge-Kutta schemes, J. Comput. Phys. 35 (1980)
+ *
+ */
+struct lsrk_williamson3
+{
+    static const unsigned int stages = 3;
+    static const unsigned int order = 3;
+
+    static double A(unsigned int i)
+    {
+        static const double a[stages] = {0.0, -5.0/9.0, -153.0/128.0};
+        return a[i];
+    }
+
+    static double B(unsigned int i)
+    {
+        static const double b[stages] = {1.0/3.0, 15.0/16.0, 8.0/15.0};
+        return b[i];
+    }
+
+    static double C(unsigned int i)
+    {
+        static const double c[stages] = {0.0, 1.0/3.0, 3.0/4.0};
+        return c[i];
+    }
+};
+
+/*! \brief Carpenter-Kennedy 5-stage, fourth order 2N-storage scheme RK4(3)5[2N]
+ *
+ * M.H. Carpenter, C.A. Kennedy, Fourth-order 2N-storage Runge-Kutta schemes, NASA TM 109112 (1994)
+ *
+ */
+struct lsrk_carpenter_kennedy4
+{
+    static const unsigned int stages = 5;
+    static const unsigned int order = 4;
+
+    static double A(unsigned int i)
+    {
+        static const double a[stages] = {0.0,
+                                         -567301805773.0/1357537059087.0,
+                                         -2404267990393.0/2016746695238.0,
+                                         -3550918686646.0/2091501179385.0,
+                                         -1275806237668.0/842570457699.0};
+        return a[i];
+    }
+
+    static double B(unsigned int i)
+    {
+        static const double b[stages] = {1432997174477.0/9575080441755.0,
+                                         5161836677717.0/13612068292357.0,
+                                         1720146321549.0/2090206949498.0,
+                                         3134564353537.0/4481467310338.0,
+                                         2277821191437.0/14882151754819.0};
+        return b[i];
+    }
+
+    static double C(unsigned int i)
+    {
+        static const double c[stages] = {0.0,
+                                         1432997174477.0/9575080441755.0,
+                                         2526269341429.0/6820363962896.0,
+                                         2006345519317.0/3224310063776.0,
+                                         2802321613138.0/2924317926251.0};
+        return c[i];
+    }
+};
+
+//! First stage of a 2N-storage scheme: dq = dt*f, x += B*dq
+struct lsrk_first_stage_op
+{
+    double dt;
+    double b;
+
+    template<typename T1, typename T2, typename T3>
+    __device__ __host__ inline void operator()(T1 &x, T2 &dq, const T3 &f) const
+    {
+        dq = dt*f;
+        x += b*dq;
+    }
+};
+
+//! Stage of a 2N-storage scheme: dq = A*dq + dt*f, x += B*dq
+struct lsrk_stage_op
+{
+    double a;
+    double dt;
+    double b;
+
+    template<typename T1, typename T2, typename T3>
+    __device__ __host__ inline void operator()(T1 &x, T2 &dq, const T3 &f) const
+    {
+        dq = a*dq + dt*f;
+        x += b*dq;
+    }
+};
+
+/*! \brief 2N-storage low-storage Runge-Kutta stepper
+ *
+ * Beside the state it use only two registers (the stage increment and the right-hand side), independently of the
+ * number of stages, and every stage update is a single pass over the memory. As an odeint stepper (stepper_tag) it can
+ * be used with integrate_const. The algebra must provide for_each3 (vector_space_algebra_ofp,
+ * vector_space_algebra_ofp_fused, vector_space_algebra_ofp_view or vector_space_algebra_ofp_gpu, where every stage is
+ * one kernel and there is no synchronization with the host)
+ *
+ * \code{.cpp}
+
+   lsrk_2n_ofp<state_type_3d_ofp,boost::numeric::odeint::vector_space_algebra_ofp_fused> lsrk;
+
+   while (t < tf)
+   {
+       lsrk.do_step(rhs,x0,t,dt);
+       t += dt;
+   }
+
+ * \endcode
+ *
+ * \tparam state_type_ state type (state_type_1d_ofp ... state_type_5d_ofp, state_type_ofp_view)
+ * \tparam algebra algebra of the state
+ * \tparam scheme coefficients of the scheme (lsrk_williamson3 or lsrk_carpenter_kennedy4)
+ *
+ */
+template<typename state_type_, typename algebra, typename scheme = lsrk_carpenter_kennedy4>
+class lsrk_2n_ofp
+{
+public:
+
+    typedef state_type_ state_type;
+    typedef state_type_ deriv_type;
+    typedef double value_type;
+    typedef double time_type;
+    typedef unsigned short order_type;
+    typedef boost::numeric::odeint::stepper_tag stepper_category;
+
+    //! order of the scheme
+    order_type order() const
+    { return scheme::order; }
+
+    /*! \brief Do one step of the integration
+     *
+     * \param system right-hand side, system(x,dxdt,t)
+     * \param x state, updated in place
+     * \param t time
+     * \param dt time step
+     *
+     */
+    template<typename System>
+    void do_step(System system, state_type &x, time_type t, time_type dt)
+    {
+        if (dq.size() != x.size())
+        {
+            dq.resize(x.size());
+            dxdt.resize(x.size());
+        }
+
+        system(x,dxdt,t);
+
+        lsrk_first_stage_op op0;
+        op0.dt = dt;
+        op0.b = scheme::B(0);
+        algebra::for_each3(x,dq,dxdt,op0);
+
+        for (unsigned int i = 1 ; i < scheme::stages ; i++)
+        {
+            system(x,dxdt,t + scheme::C(i)*dt);
+
+            lsrk_stage_op op;
+            op.a = scheme::A(i);
+            op.dt = dt;
+            op.b = scheme::B(i);
+            algebra::for_each3(x,dq,dxdt,op);
+        }
+    }
+
+private:
+
+    //! stage increment
+    state_type dq;
+
+    //! right-hand side
+    deriv_type dxdt;
+};
+
+//! Stage of the Bogacki-Shampine scheme: x_out = x + a1*k1 + a2*k2 + a3*k3 (the coefficients include dt)
+struct rk_bs32_stage_op
+{
+    double a1;
+    double a2;
+    double a3;
+
+    template<typename T1, typename T2, typename T3, typename T4, typename T5>
+    __device__ __host__ inline void operator()(T1 &x_out, const T2 &x, const T3 &k1, const T4 &k2, const T5 &k3) const
+    {
+        x_out = x + a1*k1 + a2*k2 + a3*k3;
+    }
+};
+
+//! Scaled error of the embedded solution, |dt*sum e_i*k_i| / (atol + rtol*max(|x|,|x_new|))
+struct rk_bs32_error_op
+{
+    double dt;
+    double atol;
+    double rtol;
+
+    template<typename T1, typename T2, typename T3, typename T4, typename T5, typename T6>
+    __device__ __host__ inline double operator()(const T1 &x_new, const T2 &x, const T3 &k1, const T4 &k2, const T5 &k3, const T6 &k4) const
+    {
+        double err = dt*((2.0/9.0 - 7.0/24.0)*k1 + (1.0/3.0 - 1.0/4.0)*k2 + (4.0/9.0 - 1.0/3.0)*k3 - 1.0/8.0*k4);
+        double ax = fabs((double)x);
+        double ax_new = fabs((double)x_new);
+        double sc = atol + rtol*((ax > ax_new)?ax:ax_new);
+
+        return fabs(err) / sc;
+    }
+};
+
+//! x = x_new
+struct rk_copy_op
+{
+    template<typename T1, typename T2>
+    __device__ __host__ inline void operator()(T1 &x, const T2 &x_new) const
+    {
+        x = x_new;
+    }
+};
+
+/*! \brief Adaptive Bogacki-Shampine 3(2) stepper with fused error norm
+ *
+ * The third order solution is advanced and the second order embedded solution is used for the error. The error
+ * is never stored: its normalized maximum is reduced (also across processors) in the same pass that read the stages.
+ * The last stage is reused as the first of the next step (FSAL). As an odeint controlled stepper
+ * (controlled_stepper_tag) it can be used with integrate_adaptive. The algebra must provide for_each2, for_each5 and
+ * for_each_max (vector_space_algebra_ofp_fused, vector_space_algebra_ofp_view or vector_space_algebra_ofp_gpu). With
+ * the GPU algebra every stage is one kernel, the error is reduced on the device and only its maximum (the
+ * accept/reject decision) is copied back to the host
+ *
+ * \code{.cpp}
+
+   rk_bs32_ofp<state_type_ofp_view<2>,boost::numeric::odeint::vector_space_algebra_ofp_view> rk(1e-6,1e-6);
+   integrate_adaptive(rk,rhs,x,t,tf,dt);
+
+ * \endcode
+ *
+ * \tparam state_type_ state type
+ * \tparam algebra algebra of the state
+ *
+ */
+template<typename state_type_, typename algebra>
+class rk_bs32_ofp
+{
+public:
+
+    typedef state_type_ state_type;
+    typedef state_type_ deriv_type;
+    typedef double value_type;
+    typedef double time_type;
+    typedef unsigned short order_type;
+    typedef boost::numeric::odeint::controlled_stepper_tag stepper_category;
+
+    /*! \brief Constructor
+     *
+     * \param atol absolute tolerance
+     * \param rtol relative tolerance
+     *
+     */
+    rk_bs32_ofp(double atol = 1e-6, double rtol = 1e-6)
+    :atol(atol),rtol(rtol)
+    {}
+
+    //! order of the scheme
+    order_type order() const
+    { return 3; }
+
+    //! Forget the last stage of the previous step (for example when the state has been changed outside the stepper)
+    void reset()
+    { fsal_valid = false; }
+
+    //! normalized error of the last try_step
+    double last_error() const
+    { return err; }
+
+    //! Last stage of the previous step, the first stage of the next step if fsalValid() (saved by the checkpoints)
+    deriv_type & getFsal()
+    { return k1; }
+
+    //! k1 contain the last stage of the previous step
+    bool & fsalValid()
+    { return fsal_valid; }
+
+    /*! \brief Try one step
+     *
+     * \param system right-hand side, system(x,dxdt,t)
+     * \param x state, updated if the step is accepted
+     * \param t time, advanced if the step is accepted
+     * \param dt time step, updated with the suggested time step
+     *
+     * \return success if the step has been accepted, fail otherwise
+     *
+     */
+    template<typename System>
+    boost::numeric::odeint::controlled_step_result try_step(System system, state_type &x, time_type &t, time_type &dt)
+    {
+        if (k4.size() != x.size())
+        {
+            // k1 can have been restored from a checkpoint
+            bool fsal_keep = fsal_valid && k1.size() == x.size();
+
+            k1.resize(x.size());
+            k2.resize(x.size());
+            k3.resize(x.size());
+            k4.resize(x.size());
+            x_new.resize(x.size());
+            fsal_valid = fsal_keep;
+        }
+
+        if (fsal_valid == false)
+        {system(x,k1,t);}
+
+        rk_bs32_stage_op op;
+
+        op.a1 = 0.5*dt; op.a2 = 0.0; op.a3 = 0.0;
+        algebra::for_each5(x_new,x,k1,k2,k3,op);
+        system(x_new,k2,t + 0.5*dt);
+
+        op.a1 = 0.0; op.a2 = 0.75*dt;
+        algebra::for_each5(x_new,x,k1,k2,k3,op);
+        system(x_new,k3,t + 0.75*dt);
+
+        op.a1 = 2.0/9.0*dt; op.a2 = 1.0/3.0*dt; op.a3 = 4.0/9.0*dt;
+        algebra::for_each5(x_new,x,k1,k2,k3,op);
+        system(x_new,k4,t + dt);
+
+        rk_bs32_error_op e_op;
+        e_op.dt = dt;
+        e_op.atol = atol;
+        e_op.rtol = rtol;
+        err = algebra::for_each_max(e_op,x_new,x,k1,k2,k3,k4);
+
+        if (err > 1.0)
+        {
+            dt *= std::max(0.9*std::pow(err,-1.0/3.0),0.2);
+            fsal_valid = true;
+            return boost::numeric::odeint::fail;
+        }
+
+        algebra::for_each2(x,x_new,rk_copy_op());
+        algebra::for_each2(k1,k4,rk_copy_op());
+        fsal_valid = true;
+
+        t += dt;
+        dt *= (err == 0.0)?5.0:std::min(0.9*std::pow(err,-1.0/3.0),5.0);
+
+        return boost::numeric::odeint::success;
+    }
+
+private:
+
+    //! absolute tolerance
+    double atol;
+
+    //! relative tolerance
+    double rtol;
+
+    //! normalized error of the last step
+    double err = 0.0;
+
+    //! k1 contain the last stage of the previous step
+    bool fsal_valid = false;
+
+    //! stages
+    deriv_type k1, k2, k3, k4;
+
+    //! third order solution
+    state_type x_new;
+};
+
+#endif //OPENFPM_NUMERICS_NATIVE_STEPPERS_OFP_HPP
@@ -0,0 +1,233 @@
+//
+// Parareal (parallel-in-time) integration of the openfpm states
+//
+
+#ifndef OPENFPM_NUMERICS_PARAREAL_OFP_HPP
+#define OPENFPM_NUMERICS_PARAREAL_OFP_HPP
+
+#include <cmath>
+#include <vector>
+#include <mpi.h>
+#include "VCluster/VCluster.hpp"
+#include "OdeIntegrators/state_pack_ofp.hpp"
+
+/*! \brief Parareal driver
+ *
+ * The time interval is split in as many slices as the processors of the time communicator, and every processor of
+ * the time communicator integrate one slice. The coarse propagator G (coarse stepper with the coarse time step) is
+ * cheap and serial across the slices, the fine propagator F (fine stepper with the fine time step) is the expensive
+ * one and all the slices run it at the same time. Every iteration the state at the beginning of slice n+1 is corrected
+ *
+ * U_{n+1}^{k+1} = G(U_n^{k+1}) + F(U_n^k) - G(U_n^k)
+ *
+ * After k iterations the first k slices are exactly the serial fine solution, so at most one iteration per slice is
+ * needed, and the iterations stop before when the largest correction is smaller than the tolerance.
+ *
+ * The states of the slices are exchanged as the values of the local part of the state (packStateOfp). The processors
+ * with the same rank in the spatial groups of different slices must hold the same local part of the state (for example
+ * MPI_Comm_split of the processors in spatial groups with the same decomposition, or a state replicated on all the
+ * processors). The right-hand side is called by the processors of one slice at the same time, any communication it
+ * does must stay in the spatial group of the slice.
+ *
+ * \code{.cpp}
+
+   boost::numeric::odeint::euler<state_type_1d_ofp,double,state_type_1d_ofp,double,vector_space_algebra_ofp> coarse;
+   boost::numeric::odeint::runge_kutta4<state_type_1d_ofp,double,state_type_1d_ofp,double,vector_space_algebra_ofp> fine;
+
+   parareal_ofp<state_type_1d_ofp> pr(MPI_COMM_WORLD);
+   size_t n_iter = pr.integrate(coarse,0.1,fine,0.001,rhs,x,0.0,10.0,1e-10);
+
+ * \endcode
+ *
+ * \tparam state_type state (state_type_1d_ofp ... state_type_5d_ofp, state_type_ofp_view)
+ *
+ */
+template<typename state_type>
+class parareal_ofp
+{
+    //! communicator across the time slices
+    MPI_Comm time_comm;
+
+    //! slice of this processor
+    int slice;
+
+    //! number of slices
+    int n_slices;
+
+    //! state at the beginning of the slice
+    std::vector<double> u_start;
+
+    //! coarse propagation of the state at the beginning of the slice (previous iteration)
+    std::vector<double> g_old;
+
+    //! coarse propagation of the state at the beginning of the slice (current iteration)
+    std::vector<double> g_new;
+
+    //! fine propagation of the state at the beginning of the slice
+    std::vector<double> f_sol;
+
+    //! state at the end of the slice
+    std::vector<double> u_end;
+
+    /*! \brief Propagate the state from t to t + T with steps of dt (the last one is shortened)
+     *
+     * \return the number of steps
+     *
+     */
+    template<typename stepper_type, typename system_type>
+    size_t propagate(stepper_type & stepper, system_type & system, state_type & x, double t, double T, double dt)
+    {
+        size_t n_steps = 0;
+        double t_end = t + T;
+
+        while (t_end - t > 1e-12*dt)
+        {
+            double h = (t + dt > t_end)?(t_end - t):dt;
+            stepper.do_step(system,x,t,h);
+            t += h;
+            n_steps++;
+        }
+
+        return n_steps;
+    }
+
+    //! Receive the state at the beginning of the slice from the previous slice
+    void recv_start()
+    {
+        MPI_Status status;
+        MPI_Recv(u_start.data(),u_start.size(),MPI_DOUBLE,slice-1,0,time_comm,&status);
+
+        int cnt;
+        MPI_Get_count(&status,MPI_DOUBLE,&cnt);
+
+        if ((size_t)cnt != u_start.size())
+        {
+            std::cerr << __FILE__ << ":" << __LINE__ << " error the slices " << slice-1 << " and " << slice << " have a different local state size " << cnt << " != " << u_start.size() << std::endl;
+        }
+    }
+
+    //! Send the state at the end of the slice to the next slice
+    void send_end()
+    {
+        if (slice + 1 < n_slices)
+        {MPI_Send(u_end.data(),u_end.size(),MPI_DOUBLE,slice+1,0,time_comm);}
+    }
+
+public:
+
+    /*! \brief Constructor
+     *
+     * \param time_comm communicator across the time slices, the rank is the slice of the processor
+     *
+     */
+    parareal_ofp(MPI_Comm time_comm)
+    :time_comm(time_comm)
+    {
+        MPI_Comm_rank(time_comm,&slice);
+        MPI_Comm_size(time_comm,&n_slices);
+    }
+
+    //! slice integrated by this processor
+    int getSlice()
+    {
+        return slice;
+    }
+
+    //! number of slices
+    int getNSlices()
+    {
+        return n_slices;
+    }
+
+    /*! \brief Integrate from t0 to t1
+     *
+     * \param coarse coarse stepper (do_step(system,x,t,dt))
+     * \param dt_coarse time step of the coarse stepper
+     * \param fine fine stepper (do_step(system,x,t,dt))
+     * \param dt_fine time step of the fine stepper
+     * \param system right-hand side, system(x,dxdt,t)
+     * \param x in: state at t0 (it is read on the slice 0), out: state at t1 on all the slices
+     * \param t0 initial time
+     * \param t1 final time
+     * \param tol the iterations stop when the largest correction of a slice is smaller
+     * \param max_iter maximum number of iterations (0 means one per slice, that is the serial fine solution)
+     *
+     * \return the number of iterations
+     *
+     */
+    template<typename coarse_stepper_type, typename fine_stepper_type, typename system_type>
+    size_t integrate(coarse_stepper_type & coarse, double dt_coarse,
+                     fine_stepper_type & fine, double dt_fine,
+                     system_type system, state_type & x,
+                     double t0, double t1, double tol, size_t max_iter = 0)
+    {
+        if (dt_coarse <= 0.0 || dt_fine <= 0.0)
+        {
+            std::cerr << __FILE__ << ":" << __LINE__ << " error the time steps must be positive" << std::endl;
+            return 0;
+        }
+
+        double T = (t1 - t0) / n_slices;
+        double ts = t0 + slice*T;
+
+        if (max_iter == 0 || max_iter > (size_t)n_slices)
+        {max_iter = n_slices;}
+
+        packStateOfp(x,u_start);
+
+        // coarse prediction, serial across the slices
+        if (slice != 0)
+        {recv_start();}
+
+        unpackStateOfp(u_start,x);
+        propagate(coarse,system,x,ts,T,dt_coarse);
+        packStateOfp(x,g_old);
+        u_end = g_old;
+        send_end();
+
+        size_t k = 0;
+        while (k < max_iter)
+        {
+            // fine propagation, parallel across the slices
+            unpackStateOfp(u_start,x);
+            propagate(fine,system,x,ts,T,dt_fine);
+            packStateOfp(x,f_sol);
+
+            k++;
+
+            // correction, serial across the slices. The slices before k already have the fine solution
+            if (slice != 0)
+            {recv_start();}
+
+            unpackStateOfp(u_start,x);
+            propagate(coarse,system,x,ts,T,dt_coarse);
+            packStateOfp(x,g_new);
+
+            double err = 0.0;
+            for (size_t i = 0 ; i < u_end.size() ; i++)
+            {
+                double u = g_new[i] + f_sol[i] - g_old[i];
+                err = std::max(err,fabs(u - u_end[i]));
+                u_end[i] = u;
+            }
+
+            g_old.swap(g_new);
+            send_end();
+
+            auto & v_cl = create_vcluster();
+            v_cl.max(err);
+            v_cl.execute();
+
+            if (err < tol)
+            {break;}
+        }
+
+        // the state at t1 is the one at the end of the last slice
+        MPI_Bcast(u_end.data(),u_end.size(),MPI_DOUBLE,n_slices-1,time_comm);
+        unpackStateOfp(u_end,x);
+
+        return k;
+    }
+};
+
+#endif //OPENFPM_NUMERICS_PARAREAL_OFP_HPP
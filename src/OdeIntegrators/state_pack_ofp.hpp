@@ -0,0 +1,148 @@
+//
+// Copy of the local values of the openfpm states in contiguous buffers
+//
+
+#ifndef OPENFPM_NUMERICS_STATE_PACK_OFP_HPP
+#define OPENFPM_NUMERICS_STATE_PACK_OFP_HPP
+
+#include <vector>
+#include "OdeIntegrators/state_type_ofp_view.hpp"
+
+//! Copy the values of every property of a state_type_*_ofp in a buffer (or the buffer in the state if unpack)
+template<typename state_type, bool unpack>
+struct state_pack_prop_ofp
+{
+    state_type & x;
+    double * buf;
+    size_t & cnt;
+
+    state_pack_prop_ofp(state_type & x, double * buf, size_t & cnt)
+    :x(x),buf(buf),cnt(cnt)
+    {}
+
+    template<typename T>
+    inline void operator()(T& t) const
+    {
+        auto & v = x.data.template get<T::value>().getVector();
+
+        for (size_t i = 0 ; i < v.size() ; i++)
+        {
+            if (unpack == true)
+            {v.template get<0>(i) = buf[cnt + i];}
+            else if (buf != nullptr)
+            {buf[cnt + i] = v.template get<0>(i);}
+        }
+
+        cnt += v.size();
+    }
+};
+
+/*! \brief Copy of the local values of a state in a contiguous buffer
+ *
+ * The values of a state_type_1d_ofp ... state_type_5d_ofp are stored property after property
+ *
+ */
+template<typename state_type>
+struct state_pack_ofp
+{
+    //! number of values
+    static size_t count(state_type & x)
+    {
+        size_t cnt = 0;
+        state_pack_prop_ofp<state_type,false> cp(x,nullptr,cnt);
+        boost::mpl::for_each_ref<boost::mpl::range_c<int,0,decltype(x.data)::max_prop>>(cp);
+
+        return cnt;
+    }
+
+    //! copy the values in buf
+    static void pack(state_type & x, double * buf)
+    {
+        size_t cnt = 0;
+        state_pack_prop_ofp<state_type,false> cp(x,buf,cnt);
+        boost::mpl::for_each_ref<boost::mpl::range_c<int,0,decltype(x.data)::max_prop>>(cp);
+    }
+
+    //! copy buf in the values
+    static void unpack(const double * buf, state_type & x)
+    {
+        size_t cnt = 0;
+        state_pack_prop_ofp<state_type,true> cp(x,const_cast<double *>(buf),cnt);
+        boost::mpl::for_each_ref<boost::mpl::range_c<int,0,decltype(x.data)::max_prop>>(cp);
+    }
+};
+
+/*! \brief Copy of the local values of a state_type_ofp_view in a contiguous buffer
+ *
+ * The values are stored component after component
+ *
+ */
+template<unsigned int n_comp, typename T>
+struct state_pack_ofp<state_type_ofp_view<n_comp,T>>
+{
+    //! number of values
+    static size_t count(state_type_ofp_view<n_comp,T> & x)
+    {
+        return n_comp*x.size();
+    }
+
+    //! copy the values in buf
+    static void pack(state_type_ofp_view<n_comp,T> & x, double * buf)
+    {
+        for (unsigned int c = 0 ; c < n_comp ; c++)
+        {
+            for (size_t i = 0 ; i < x.size() ; i++)
+            {buf[c*x.size() + i] = x.get(c,i);}
+        }
+    }
+
+    //! copy buf in the values
+    static void unpack(const double * buf, state_type_ofp_view<n_comp,T> & x)
+    {
+        for (unsigned int c = 0 ; c < n_comp ; c++)
+        {
+            for (size_t i = 0 ; i < x.size() ; i++)
+            {x.get(c,i) = buf[c*x.size() + i];}
+        }
+    }
+};
+
+/*! \brief Number of local values of a state (all the properties)
+ *
+ * \param x state (state_type_1d_ofp ... state_type_5d_ofp, state_type_ofp_view)
+ *
+ * \return the number of values
+ *
+ */
+template<typename state_type>
+size_t countStateOfp(state_type & x)
+{
+    return state_pack_ofp<state_type>::count(x);
+}
+
+/*! \brief Copy the local values of a state in a buffer
+ *
+ * \param x state (state_type_1d_ofp ... state_type_5d_ofp, state_type_ofp_view)
+ * \param buf buffer, resized to the number of values
+ *
+ */
+template<typename state_type>
+void packStateOfp(state_type & x, std::vector<double> & buf)
+{
+    buf.resize(countStateOfp(x));
+    state_pack_ofp<state_type>::pack(x,buf.data());
+}
+
+/*! \brief Copy a buffer in the local values of a state, the state must have the size of the packed one
+ *
+ * \param buf buffer
+ * \param x state (state_type_1d_ofp ... state_type_5d_ofp, state_type_ofp_view)
+ *
+ */
+template<typename state_type>
+void unpackStateOfp(const std::vector<double> & buf, state_type & x)
+{
+    state_pack_ofp<state_type>::unpack(buf.data(),x);
+}
+
+#endif //OPENFPM_NUMERICS_STATE_PACK_OFP_HPP
@@ -0,0 +1,367 @@
+//
+// Odeint state viewing the properties of a vector_dist in place
+//
+
+#ifndef OPENFPM_NUMERICS_STATE_TYPE_OFP_VIEW_HPP
+#define OPENFPM_NUMERICS_STATE_TYPE_OFP_VIEW_HPP
+
+#include <vector>
+#include <cmath>
+#include <iostream>
+
+/*! \brief An Odeint state that is a view over properties of a vector_dist (no copy of the state)
+ *
+ * A state created with getStateView<prp...>(vd) reads and writes directly the properties prp... of the particles, the
+ * time integration happen in place in the particle storage. The states created by the steppers (stage buffers) own
+ * their storage. The component c of the particle i is get(c,i).
+ *
+ * \code{.cpp}
+
+   auto x = getStateView<0,1>(Particles);
+
+   boost::numeric::odeint::runge_kutta4< state_type_ofp_view<2>,double,state_type_ofp_view<2>,double,boost::numeric::odeint::vector_space_algebra_ofp_view> rk4;
+   rk4.do_step(rhs,x,t,dt);
+
+ * \endcode
+ *
+ * The view store the address of the properties, after a map() (or any operation that reallocate the particles) the
+ * view must be created again. The properties must have type T
+ *
+ * \tparam n_comp number of properties (components of the state)
+ * \tparam T type of the properties
+ *
+ */
+template<unsigned int n_comp, typename T = double>
+struct state_type_ofp_view
+{
+    typedef size_t size_type;
+    typedef size_t index_type;
+    typedef int is_state_vector;
+
+    //! address of the property of the first particle for every component
+    char * base[n_comp];
+
+    //! distance in byte between the properties of two consecutive particles
+    size_t stride[n_comp];
+
+    //! number of particles
+    size_t n = 0;
+
+    //! true if the state is a view over the particles
+    bool is_view = false;
+
+    //! storage of the state when it is not a view
+    std::vector<T> buffer;
+
+    state_type_ofp_view()
+    {
+        for (unsigned int c = 0 ; c < n_comp ; c++)
+        {
+            base[c] = nullptr;
+            stride[c] = sizeof(T);
+        }
+    }
+
+    //! Copy, the copy own its storage
+    state_type_ofp_view(const state_type_ofp_view<n_comp,T> & s)
+    :state_type_ofp_view()
+    {
+        this->operator=(s);
+    }
+
+    /*! \brief Copy the values of the state
+     *
+     * A view keep viewing the particles (the number of particles must match), an owning state is resized
+     *
+     */
+    state_type_ofp_view<n_comp,T> & operator=(const state_type_ofp_view<n_comp,T> & s)
+    {
+        if (this == &s) {return *this;}
+
+        resize(s.size());
+
+        for (unsigned int c = 0 ; c < n_comp ; c++)
+        {
+            for (size_t i = 0 ; i < n ; i++)
+            {get(c,i) = s.get(c,i);}
+        }
+
+        return *this;
+    }
+
+    //! Number of particles
+    size_t size() const
+    { return n; }
+
+    /*! \brief Resize an owning state, a view cannot be resized
+     *
+     * \param n_new number of particles
+     *
+     */
+    void resize(size_t n_new)
+    {
+        if (is_view == true)
+        {
+            if (n_new != n)
+            {
+                std::cerr << __FILE__ << ":" << __LINE__ << " Error: a state viewing the particles cannot be resized (" <<
+                          n << " particles to " << n_new << "), create again the view after map()" << std::endl;
+            }
+            return;
+        }
+
+        n = n_new;
+        buffer.resize(n_comp*n);
+
+        for (unsigned int c = 0 ; c < n_comp ; c++)
+        {
+            base[c] = (n != 0)?(char *)&buffer[c*n]:nullptr;
+            stride[c] = sizeof(T);
+        }
+    }
+
+    //! Component c of the particle i
+    inline T & get(unsigned int c, size_t i)
+    { return *(T *)(base[c] + i*stride[c]); }
+
+    //! Component c of the particle i
+    inline const T & get(unsigned int c, size_t i) const
+    { return *(const T *)(base[c] + i*stride[c]); }
+
+    /*! \brief View the property prp of the local particles of vd as the component c
+     *
+     * \param c component
+     * \param vd particles
+     *
+     */
+    template<unsigned int prp, typename vector_type> void bind(unsigned int c, vector_type & vd)
+    {
+        is_view = true;
+        n = vd.size_local();
+        buffer.clear();
+
+        if (n == 0)
+        {
+            base[c] = nullptr;
+            stride[c] = sizeof(T);
+            return;
+        }
+
+        T & p0 = vd.template getProp<prp>(0);
+        base[c] = (char *)&p0;
+        stride[c] = (n > 1)?(size_t)((char *)&vd.template getProp<prp>(1) - (char *)&p0):sizeof(T);
+    }
+};
+
+//! Bind the properties to the components of the view
+template<typename state_type, typename vector_type, unsigned int ... prp>
+struct state_view_bind;
+
+template<typename state_type, typename vector_type>
+struct state_view_bind<state_type,vector_type>
+{
+    static void bind(state_type & s, vector_type & vd, unsigned int c)
+    {}
+};
+
+template<typename state_type, typename vector_type, unsigned int prp, unsigned int ... prps>
+struct state_view_bind<state_type,vector_type,prp,prps...>
+{
+    static void bind(state_type & s, vector_type & vd, unsigned int c)
+    {
+        s.template bind<prp>(c,vd);
+        state_view_bind<state_type,vector_type,prps...>::bind(s,vd,c+1);
+    }
+};
+
+/*! \brief Create a state viewing the properties prp... of the local particles of vd
+ *
+ * \tparam prp properties of the particles (components of the state)
+ *
+ * \param vd particles
+ *
+ * \return the state
+ *
+ */
+template<unsigned int ... prp, typename vector_type>
+state_type_ofp_view<sizeof...(prp)> getStateView(vector_type & vd)
+{
+    state_type_ofp_view<sizeof...(prp)> s;
+    state_view_bind<state_type_ofp_view<sizeof...(prp)>,vector_type,prp...>::bind(s,vd,0);
+
+    return s;
+}
+
+namespace boost {
+    namespace numeric {
+        namespace odeint {
+
+            template<unsigned int n_comp, typename T>
+            struct is_resizeable<state_type_ofp_view<n_comp,T>> {
+                typedef boost::true_type type;
+                static const bool value = type::value;
+            };
+
+            template<unsigned int n_comp, typename T>
+            struct vector_space_norm_inf<state_type_ofp_view<n_comp,T>>
+            {
+                typedef T result_type;
+            };
+
+            /*! \brief Algebra for state_type_ofp_view, it works in place on the particle storage
+             *
+             * The particles are split across the OpenMP threads, for every particle all the components are processed
+             *
+             */
+            struct vector_space_algebra_ofp_view
+            {
+                template< class Op , class S1 , class ... S >
+                static void for_each_view( Op &op , S1 &s1 , S & ... s )
+                {
+                    resize_as(s1,s...);
+
+                    long int n = s1.size();
+
+                    #pragma omp parallel for firstprivate(op) schedule(static)
+                    for (long int i = 0 ; i < n ; i++)
+                    {
+                        for (unsigned int c = 0 ; c < comp<S1>::value ; c++)
+                        {op(s1.get(c,i),s.get(c,i)...);}
+                    }
+                }
+
+                template< class S1 , class Op >
+                static void for_each1( S1 &s1 , Op op )
+                { for_each_view(op,s1); }
+
+                template< class S1 , class S2 , class Op >
+                static void for_each2( S1 &s1 , S2 &s2 , Op op )
+                { for_each_view(op,s1,s2); }
+
+                template< class S1 , class S2 , class S3 , class Op >
+                static void for_each3( S1 &s1 , S2 &s2 , S3 &s3 , Op op )
+                { for_each_view(op,s1,s2,s3); }
+
+                template< class S1 , class S2 , class S3 , class S4 , class Op >
+                static void for_each4( S1 &s1 , S2 &s2 , S3 &s3 , S4 &s4 , Op op )
+                { for_each_view(op,s1,s2,s3,s4); }
+
+                template< class S1 , class S2 , class S3 , class S4 , class S5 , class Op >
+                static void for_each5( S1 &s1 , S2 &s2 , S3 &s3 , S4 &s4 , S5 &s5 , Op op )
+                { for_each_view(op,s1,s2,s3,s4,s5); }
+
+                template< class S1 , class S2 , class S3 , class S4 , class S5 , class S6 , class Op >
+                static void for_each6( S1 &s1 , S2 &s2 , S3 &s3 , S4 &s4 , S5 &s5 , S6 &s6 , Op op )
+                { for_each_view(op,s1,s2,s3,s4,s5,s6); }
+
+                template< class S1 , class S2 , class S3 , class S4 , class S5 , class S6 , class S7 , class Op >
+                static void for_each7( S1 &s1 , S2 &s2 , S3 &s3 , S4 &s4 , S5 &s5 , S6 &s6 , S7 &s7 , Op op )
+                { for_each_view(op,s1,s2,s3,s4,s5,s6,s7); }
+
+                template< class S1 , class S2 , class S3 , class S4 , class S5 , class S6 , class S7 , class S8 , class Op >
+                static void for_each8( S1 &s1 , S2 &s2 , S3 &s3 , S4 &s4 , S5 &s5 , S6 &s6 , S7 &s7 , S8 &s8 , Op op )
+                { for_each_view(op,s1,s2,s3,s4,s5,s6,s7,s8); }
+
+                template< class S1 , class S2 , class S3 , class S4 , class S5 , class S6 , class S7 , class S8 , class S9 , class Op >
+                static void for_each9( S1 &s1 , S2 &s2 , S3 &s3 , S4 &s4 , S5 &s5 , S6 &s6 , S7 &s7 , S8 &s8 , S9 &s9 , Op op )
+                { for_each_view(op,s1,s2,s3,s4,s5,s6,s7,s8,s9); }
+
+                template< class S1 , class S2 , class S3 , class S4 , class S5 , class S6 , class S7 , class S8 , class S9 , class S10 , class Op >
+                static void for_each10( S1 &s1 , S2 &s2 , S3 &s3 , S4 &s4 , S5 &s5 , S6 &s6 , S7 &s7 , S8 &s8 , S9 &s9 , S10 &s10 , Op op )
+                { for_each_view(op,s1,s2,s3,s4,s5,s6,s7,s8,s9,s10); }
+
+                template< class S1 , class S2 , class S3 , class S4 , class S5 , class S6 , class S7 , class S8 , class S9 , class S10 , class S11 , class Op >
+                static void for_each11( S1 &s1 , S2 &s2 , S3 &s3 , S4 &s4 , S5 &s5 , S6 &s6 , S7 &s7 , S8 &s8 , S9 &s9 , S10 &s10 , S11 &s11 , Op op )
+                { for_each_view(op,s1,s2,s3,s4,s5,s6,s7,s8,s9,s10,s11); }
+
+                template< class S1 , class S2 , class S3 , class S4 , class S5 , class S6 , class S7 , class S8 , class S9 , class S10 , class S11 , class S12 , class Op >
+                static void for_each12( S1 &s1 , S2 &s2 , S3 &s3 , S4 &s4 , S5 &s5 , S6 &s6 , S7 &s7 , S8 &s8 , S9 &s9 , S10 &s10 , S11 &s11 , S12 &s12 , Op op )
+                { for_each_view(op,s1,s2,s3,s4,s5,s6,s7,s8,s9,s10,s11,s12); }
+
+                template< class S1 , class S2 , class S3 , class S4 , class S5 , class S6 , class S7 , class S8 , class S9 , class S10 , class S11 , class S12 , class S13 , class Op >
+                static void for_each13( S1 &s1 , S2 &s2 , S3 &s3 , S4 &s4 , S5 &s5 , S6 &s6 , S7 &s7 , S8 &s8 , S9 &s9 , S10 &s10 , S11 &s11 , S12 &s12 , S13 &s13 , Op op )
+                { for_each_view(op,s1,s2,s3,s4,s5,s6,s7,s8,s9,s10,s11,s12,s13); }
+
+                template< class S1 , class S2 , class S3 , class S4 , class S5 , class S6 , class S7 , class S8 , class S9 , class S10 , class S11 , class S12 , class S13 , class S14 , class Op >
+                static void for_each14( S1 &s1 , S2 &s2 , S3 &s3 , S4 &s4 , S5 &s5 , S6 &s6 , S7 &s7 , S8 &s8 , S9 &s9 , S10 &s10 , S11 &s11 , S12 &s12 , S13 &s13 , S14 &s14 , Op op )
+                { for_each_view(op,s1,s2,s3,s4,s5,s6,s7,s8,s9,s10,s11,s12,s13,s14); }
+
+                template< class S1 , class S2 , class S3 , class S4 , class S5 , class S6 , class S7 , class S8 , class S9 , class S10 , class S11 , class S12 , class S13 , class S14 , class S15 , class Op >
+                static void for_each15( S1 &s1 , S2 &s2 , S3 &s3 , S4 &s4 , S5 &s5 , S6 &s6 , S7 &s7 , S8 &s8 , S9 &s9 , S10 &s10 , S11 &s11 , S12 &s12 , S13 &s13 , S14 &s14 , S15 &s15 , Op op )
+                { for_each_view(op,s1,s2,s3,s4,s5,s6,s7,s8,s9,s10,s11,s12,s13,s14,s15); }
+
+                /*! \brief Maximum of op over all the particles and all the components of the states (and all the processors)
+                 *
+                 * Used by the native steppers to compute an error norm in the same pass of a stage update
+                 *
+                 */
+                template< class Op , class S1 , class ... S >
+                static double for_each_max( Op op , S1 &s1 , S & ... s )
+                {
+                    double m = 0.0;
+                    long int n = s1.size();
+
+                    #pragma omp parallel for firstprivate(op) reduction(max:m) schedule(static)
+                    for (long int i = 0 ; i < n ; i++)
+                    {
+                        for (unsigned int c = 0 ; c < comp<S1>::value ; c++)
+                        {
+                            double v = op(s1.get(c,i),s.get(c,i)...);
+                            m = (v > m)?v:m;
+                        }
+                    }
+
+                    auto &v_cl = create_vcluster();
+                    v_cl.max(m);
+                    v_cl.execute();
+                    return m;
+                }
+
+                template< class S >
+                static typename boost::numeric::odeint::vector_space_norm_inf< S >::result_type norm_inf( const S &s )
+                {
+                    typename boost::numeric::odeint::vector_space_norm_inf< S >::result_type n=0;
+                    long int n_p = s.size();
+
+                    #pragma omp parallel for reduction(max:n) schedule(static)
+                    for (long int i = 0 ; i < n_p ; i++)
+                    {
+                        for (unsigned int c = 0 ; c < comp<S>::value ; c++)
+                        {n = (std::fabs(s.get(c,i)) > n)?std::fabs(s.get(c,i)):n;}
+                    }
+
+                    auto &v_cl = create_vcluster();
+                    v_cl.max(n);
+                    v_cl.execute();
+                    return n;
+                }
+
+            private:
+
+                //! number of components of a view state
+                template<typename S> struct comp;
+
+                template<unsigned int n_comp, typename T>
+                struct comp<state_type_ofp_view<n_comp,T>>
+                {
+                    static const unsigned int value = n_comp;
+                };
+
+                template< class S1 >
+                static void resize_as( S1 &s1 )
+                {}
+
+                //! s1 is resized as s2 (as vector_space_algebra_ofp)
+                template< class S1 , class S2 , class ... S >
+                static void resize_as( S1 &s1 , S2 &s2 , S & ... s )
+                {
+                    if (s1.size() != s2.size())
+                    {s1.resize(s2.size());}
+                }
+            };
+
+        } // odeint
+    } // numeric
+} // boost
+
+#endif //OPENFPM_NUMERICS_STATE_TYPE_OFP_VIEW_HPP
@@ -84,6 +84,11 @@ void Exponential_struct_ofp2( const state_type_3d_ofp &x , state_type_3d_ofp &dx
 }
 
 
+void Exponential_1d_ofp( const state_type_1d_ofp &x , state_type_1d_ofp &dxdt , const double t )
+{
+    dxdt.data.get<0>() = x.data.get<0>();
+}
+
 void Exponential( const state_type &x , state_type &dxdt , const double t )
 {
     //timer tt;
@@ -303,6 +308,383 @@ BOOST_AUTO_TEST_CASE(odeint_base_test_STRUCT_ofp)
 }
 
 
+BOOST_AUTO_TEST_CASE(odeint_base_test_fused_algebra)
+{
+    size_t edgeSemiSize = 40;
+    const size_t sz[2] = {edgeSemiSize,edgeSemiSize };
+    Box<2, double> box({ 0, 0 }, { 1.0, 1.0 });
+    size_t bc[2] = { NON_PERIODIC, NON_PERIODIC };
+    double spacing[2];
+    spacing[0] = 1.0 / (sz[0] - 1);
+    spacing[1] = 1.0 / (sz[1] - 1);
+    double rCut = 3.9 * spacing[0];
+    Ghost<2, double> ghost(rCut);
+
+    vector_dist<2, double, aggregate<double,double,double,double,double,double>> Particles(0, box, bc, ghost);
+
+    auto it = Particles.getGridIterator(sz);
+    while (it.isNext())
+    {
+        Particles.add();
+        auto key = it.get();
+        double xp0 = key.get(0) * spacing[0];
+        double yp0 = key.get(1) * spacing[1];
+        Particles.getLastPos()[0] = xp0;
+        Particles.getLastPos()[1] = yp0;
+        Particles.getLastProp<0>() = xp0*yp0;
+        Particles.getLastProp<2>() = xp0+yp0;
+        ++it;
+    }
+    Particles.map();
+
+    auto Init1 = getV<0>(Particles);
+    auto Init2 = getV<2>(Particles);
+
+    state_type_3d_ofp x0,x1;
+    x0.data.get<0>()=Init1;
+    x0.data.get<1>()=Init2;
+    x0.data.get<2>()=Init1;
+    x1.data.get<0>()=Init1;
+    x1.data.get<1>()=Init2;
+    x1.data.get<2>()=Init1;
+
+    double t=0,tf=0.4;
+    const double dt=0.1;
+
+    // the fused algebra must give the same result of vector_space_algebra_ofp
+    boost::numeric::odeint::runge_kutta4< state_type_3d_ofp, double,state_type_3d_ofp,double,boost::numeric::odeint::vector_space_algebra_ofp> rk4;
+    boost::numeric::odeint::runge_kutta4< state_type_3d_ofp, double,state_type_3d_ofp,double,boost::numeric::odeint::vector_space_algebra_ofp_fused> rk4_fused;
+    while (t<tf)
+    {
+        rk4.do_step(Exponential_struct_ofp2,x0,t,dt);
+        rk4_fused.do_step(Exponential_struct_ofp2,x1,t,dt);
+        t+=dt;
+    }
+
+    for (size_t i = 0 ; i < x0.data.get<0>().getVector().size() ; i++)
+    {
+        BOOST_REQUIRE_EQUAL(x0.data.get<0>().getVector().get<0>(i),x1.data.get<0>().getVector().get<0>(i));
+        BOOST_REQUIRE_EQUAL(x0.data.get<1>().getVector().get<0>(i),x1.data.get<1>().getVector().get<0>(i));
+        BOOST_REQUIRE_EQUAL(x0.data.get<2>().getVector().get<0>(i),x1.data.get<2>().getVector().get<0>(i));
+    }
+
+    BOOST_REQUIRE_EQUAL(boost::numeric::odeint::vector_space_algebra_ofp::norm_inf(x0),boost::numeric::odeint::vector_space_algebra_ofp_fused::norm_inf(x1));
+}
+
+BOOST_AUTO_TEST_CASE(odeint_base_test_stage_capacity)
+{
+    state_type_2d_ofp x0;
+    x0.reserve(1000);
+    x0.resize(600);
+
+    // a stage buffer get the capacity of the state
+    state_type_2d_ofp k1;
+    boost::numeric::odeint::resize_impl<state_type_2d_ofp,state_type_2d_ofp>::resize(k1,x0);
+
+    BOOST_REQUIRE_EQUAL(k1.size(),600);
+    BOOST_REQUIRE(k1.capacity() >= 1000);
+    BOOST_REQUIRE(k1.data.get<1>().getVector().capacity() >= 1000);
+
+    // the number of particles change (map), the stage buffer keep its memory
+    double * mem = &k1.data.get<0>().getVector().get<0>(0);
+
+    x0.resize(900);
+    boost::numeric::odeint::resize_impl<state_type_2d_ofp,state_type_2d_ofp>::resize(k1,x0);
+    BOOST_REQUIRE_EQUAL(k1.size(),900);
+    BOOST_REQUIRE(mem == &k1.data.get<0>().getVector().get<0>(0));
+
+    x0.resize(300);
+    boost::numeric::odeint::resize_impl<state_type_2d_ofp,state_type_2d_ofp>::resize(k1,x0);
+    BOOST_REQUIRE_EQUAL(k1.size(),300);
+    BOOST_REQUIRE(mem == &k1.data.get<0>().getVector().get<0>(0));
+}
+
+void Exponential_view( const state_type_ofp_view<2> &x , state_type_ofp_view<2> &dxdt , const double t )
+{
+    for (size_t i = 0 ; i < x.size() ; i++)
+    {
+        dxdt.get(0,i) = x.get(0,i);
+        dxdt.get(1,i) = 2.0*x.get(1,i);
+    }
+}
+
+BOOST_AUTO_TEST_CASE(odeint_base_test_state_view)
+{
+    size_t edgeSemiSize = 40;
+    const size_t sz[2] = {edgeSemiSize,edgeSemiSize };
+    Box<2, double> box({ 0, 0 }, { 1.0, 1.0 });
+    size_t bc[2] = { NON_PERIODIC, NON_PERIODIC };
+    double spacing[2];
+    spacing[0] = 1.0 / (sz[0] - 1);
+    spacing[1] = 1.0 / (sz[1] - 1);
+    double rCut = 3.9 * spacing[0];
+    Ghost<2, double> ghost(rCut);
+
+    vector_dist<2, double, aggregate<double,double,double,double,double,double>> Particles(0, box, bc, ghost);
+
+    auto it = Particles.getGridIterator(sz);
+    while (it.isNext())
+    {
+        Particles.add();
+        auto key = it.get();
+        double xp0 = key.get(0) * spacing[0];
+        double yp0 = key.get(1) * spacing[1];
+        Particles.getLastPos()[0] = xp0;
+        Particles.getLastPos()[1] = yp0;
+        Particles.getLastProp<0>() = xp0*yp0;
+        Particles.getLastProp<1>() = xp0*yp0*exp(0.4);
+        Particles.getLastProp<2>() = xp0*yp0;
+        Particles.getLastProp<3>() = xp0*yp0*exp(0.8);
+        ++it;
+    }
+    Particles.map();
+
+    // the state is the properties 0 and 2 of the particles, integrated in place
+    auto x0 = getStateView<0,2>(Particles);
+
+    double t=0,tf=0.4;
+    const double dt=0.01;
+
+    boost::numeric::odeint::runge_kutta4< state_type_ofp_view<2>,double,state_type_ofp_view<2>,double,boost::numeric::odeint::vector_space_algebra_ofp_view> rk4;
+    while (t<tf-dt/2)
+    {
+        rk4.do_step(Exponential_view,x0,t,dt);
+        t+=dt;
+    }
+
+    auto it2 = Particles.getDomainIterator();
+    double worst = 0.0;
+    while (it2.isNext()) {
+        auto p = it2.get();
+        worst = std::max(worst,fabs(Particles.getProp<1>(p) - Particles.getProp<0>(p)));
+        worst = std::max(worst,fabs(Particles.getProp<3>(p) - Particles.getProp<2>(p)));
+        ++it2;
+    }
+
+    BOOST_REQUIRE(worst < 1e-6);
+}
+
+BOOST_AUTO_TEST_CASE(odeint_base_test_native_steppers)
+{
+    size_t edgeSemiSize = 40;
+    const size_t sz[2] = {edgeSemiSize,edgeSemiSize };
+    Box<2, double> box({ 0, 0 }, { 1.0, 1.0 });
+    size_t bc[2] = { NON_PERIODIC, NON_PERIODIC };
+    double spacing[2];
+    spacing[0] = 1.0 / (sz[0] - 1);
+    spacing[1] = 1.0 / (sz[1] - 1);
+    double rCut = 3.9 * spacing[0];
+    Ghost<2, double> ghost(rCut);
+
+    vector_dist<2, double, aggregate<double,double,double,double,double,double>> Particles(0, box, bc, ghost);
+
+    auto it = Particles.getGridIterator(sz);
+    while (it.isNext())
+    {
+        Particles.add();
+        auto key = it.get();
+        double xp0 = key.get(0) * spacing[0];
+        double yp0 = key.get(1) * spacing[1];
+        Particles.getLastPos()[0] = xp0;
+        Particles.getLastPos()[1] = yp0;
+        Particles.getLastProp<0>() = xp0*yp0;
+        Particles.getLastProp<1>() = xp0*yp0*exp(0.4);
+        Particles.getLastProp<2>() = xp0*yp0;
+        Particles.getLastProp<3>() = xp0*yp0*exp(0.8);
+        Particles.getLastProp<4>() = xp0*yp0;
+        Particles.getLastProp<5>() = xp0*yp0;
+        ++it;
+    }
+    Particles.map();
+
+    typedef boost::numeric::odeint::vector_space_algebra_ofp_view algebra;
+
+    // 2N-storage fourth order
+    auto x0 = getStateView<0,2>(Particles);
+    lsrk_2n_ofp<state_type_ofp_view<2>,algebra> lsrk;
+    integrate_const(lsrk,Exponential_view,x0,0.0,0.4,0.01);
+
+    // adaptive with fused error norm
+    auto x1 = getStateView<4,5>(Particles);
+    rk_bs32_ofp<state_type_ofp_view<2>,algebra> bs32(1e-9,1e-9);
+    integrate_adaptive(bs32,Exponential_view,x1,0.0,0.4,0.01);
+
+    auto it2 = Particles.getDomainIterator();
+    double worst = 0.0;
+    double worst_bs = 0.0;
+    while (it2.isNext()) {
+        auto p = it2.get();
+        worst = std::max(worst,fabs(Particles.getProp<1>(p) - Particles.getProp<0>(p)));
+        worst = std::max(worst,fabs(Particles.getProp<3>(p) - Particles.getProp<2>(p)));
+        worst_bs = std::max(worst_bs,fabs(Particles.getProp<1>(p) - Particles.getProp<4>(p)));
+        worst_bs = std::max(worst_bs,fabs(Particles.getProp<3>(p) - Particles.getProp<5>(p)));
+        ++it2;
+    }
+
+    BOOST_REQUIRE(worst < 1e-8);
+    BOOST_REQUIRE(worst_bs < 1e-6);
+}
+
+BOOST_AUTO_TEST_CASE(odeint_base_test_checkpoint)
+{
+    size_t edgeSemiSize = 20;
+    const size_t sz[2] = {edgeSemiSize,edgeSemiSize };
+    Box<2, double> box({ 0, 0 }, { 1.0, 1.0 });
+    size_t bc[2] = { NON_PERIODIC, NON_PERIODIC };
+    double spacing[2];
+    spacing[0] = 1.0 / (sz[0] - 1);
+    spacing[1] = 1.0 / (sz[1] - 1);
+    Ghost<2, double> ghost(3.9 * spacing[0]);
+
+    vector_dist<2, double, aggregate<double,double>> Particles(0, box, bc, ghost);
+
+    auto it = Particles.getGridIterator(sz);
+    while (it.isNext())
+    {
+        Particles.add();
+        auto key = it.get();
+        double xp0 = key.get(0) * spacing[0];
+        double yp0 = key.get(1) * spacing[1];
+        Particles.getLastPos()[0] = xp0;
+        Particles.getLastPos()[1] = yp0;
+        Particles.getLastProp<0>() = xp0*yp0;
+        Particles.getLastProp<1>() = xp0 + yp0;
+        ++it;
+    }
+    Particles.map();
+
+    typedef boost::numeric::odeint::vector_space_algebra_ofp_view algebra;
+
+    auto x = getStateView<0,1>(Particles);
+    rk_bs32_ofp<state_type_ofp_view<2>,algebra> bs32(1e-9,1e-9);
+    async_checkpoint_ofp<state_type_ofp_view<2>> chk;
+
+    double t = 0.0;
+    double dt = 0.01;
+    for (size_t i = 0 ; i < 10 ; i++)
+    {bs32.try_step(Exponential_view,x,t,dt);}
+
+    chk.snapshot("test_checkpoint_ofp.h5",x,bs32,t,dt);
+
+    for (size_t i = 0 ; i < 10 ; i++)
+    {bs32.try_step(Exponential_view,x,t,dt);}
+
+    state_type_ofp_view<2> x_ref = x;
+    double t_ref = t;
+
+    // restart with a new stepper, the state is overwritten by the checkpoint
+    rk_bs32_ofp<state_type_ofp_view<2>,algebra> bs32_r(1e-9,1e-9);
+    BOOST_REQUIRE(chk.load("test_checkpoint_ofp.h5",x,bs32_r,t,dt) == true);
+
+    for (size_t i = 0 ; i < 10 ; i++)
+    {bs32_r.try_step(Exponential_view,x,t,dt);}
+
+    BOOST_REQUIRE_EQUAL(t,t_ref);
+
+    bool match = true;
+    for (unsigned int c = 0 ; c < 2 ; c++)
+    {
+        for (size_t i = 0 ; i < x.size() ; i++)
+        {match &= (x.get(c,i) == x_ref.get(c,i));}
+    }
+
+    BOOST_REQUIRE(match == true);
+}
+
+BOOST_AUTO_TEST_CASE(odeint_base_test_multirate)
+{
+    size_t edgeSemiSize = 40;
+    const size_t sz[2] = {edgeSemiSize,edgeSemiSize };
+    Box<2, double> box({ 0, 0 }, { 1.0, 1.0 });
+    size_t bc[2] = { NON_PERIODIC, NON_PERIODIC };
+    double spacing[2];
+    spacing[0] = 1.0 / (sz[0] - 1);
+    spacing[1] = 1.0 / (sz[1] - 1);
+    double rCut = 3.9 * spacing[0];
+    Ghost<2, double> ghost(rCut);
+
+    vector_dist<2, double, aggregate<double,double,double,double,double,double>> Particles(0, box, bc, ghost);
+
+    auto it = Particles.getGridIterator(sz);
+    while (it.isNext())
+    {
+        Particles.add();
+        auto key = it.get();
+        double xp0 = key.get(0) * spacing[0];
+        double yp0 = key.get(1) * spacing[1];
+        Particles.getLastPos()[0] = xp0;
+        Particles.getLastPos()[1] = yp0;
+        Particles.getLastProp<0>() = xp0*yp0;
+        Particles.getLastProp<1>() = xp0*yp0*exp(0.4);
+        Particles.getLastProp<2>() = xp0*yp0;
+        Particles.getLastProp<3>() = xp0*yp0*exp(0.8);
+        Particles.getLastProp<4>() = xp0*yp0;
+        Particles.getLastProp<5>() = xp0*yp0;
+        ++it;
+    }
+    Particles.map();
+
+    typedef boost::numeric::odeint::vector_space_algebra_ofp_view algebra;
+
+    // slow group with the macro step, fast group sub-cycled 10 times
+    auto x_slow = getStateView<0,2>(Particles);
+    auto x_fast = getStateView<4,5>(Particles);
+    lsrk_2n_ofp<state_type_ofp_view<2>,algebra> lsrk_slow;
+    lsrk_2n_ofp<state_type_ofp_view<2>,algebra> lsrk_fast;
+
+    auto slow = getMultirateGroup(lsrk_slow,Exponential_view,x_slow,1);
+    auto fast = getMultirateGroup(lsrk_fast,Exponential_view,x_fast,10);
+
+    size_t n_sync = 0;
+    double t_sync = 0.0;
+    size_t n_steps = integrate_multirate([&](double t){n_sync++; t_sync = t;},0.0,0.4,0.01,slow,fast);
+
+    BOOST_REQUIRE_EQUAL(n_steps,40ul);
+    BOOST_REQUIRE_EQUAL(n_sync,40ul);
+    BOOST_REQUIRE_CLOSE(t_sync,0.4,1e-10);
+
+    auto it2 = Particles.getDomainIterator();
+    double worst_slow = 0.0;
+    double worst_fast = 0.0;
+    while (it2.isNext()) {
+        auto p = it2.get();
+        worst_slow = std::max(worst_slow,fabs(Particles.getProp<1>(p) - Particles.getProp<0>(p)));
+        worst_slow = std::max(worst_slow,fabs(Particles.getProp<3>(p) - Particles.getProp<2>(p)));
+        worst_fast = std::max(worst_fast,fabs(Particles.getProp<1>(p) - Particles.getProp<4>(p)));
+        worst_fast = std::max(worst_fast,fabs(Particles.getProp<3>(p) - Particles.getProp<5>(p)));
+        ++it2;
+    }
+
+    BOOST_REQUIRE(worst_slow < 1e-8);
+    BOOST_REQUIRE(worst_fast < worst_slow);
+}
+
+BOOST_AUTO_TEST_CASE(odeint_base_test_parareal)
+{
+    // the state is replicated, every processor is a time slice
+    state_type_1d_ofp x;
+    x.data.get<0>().resize(10);
+    for (size_t i = 0 ; i < 10 ; i++)
+    {x.data.get<0>().getVector().get<0>(i) = i + 1.0;}
+
+    typedef boost::numeric::odeint::vector_space_algebra_ofp algebra;
+
+    boost::numeric::odeint::euler<state_type_1d_ofp,double,state_type_1d_ofp,double,algebra> coarse;
+    boost::numeric::odeint::runge_kutta4<state_type_1d_ofp,double,state_type_1d_ofp,double,algebra> fine;
+
+    parareal_ofp<state_type_1d_ofp> pr(MPI_COMM_WORLD);
+    size_t n_iter = pr.integrate(coarse,0.05,fine,0.001,Exponential_1d_ofp,x,0.0,1.0,1e-12);
+
+    BOOST_REQUIRE(n_iter >= 1);
+    BOOST_REQUIRE(n_iter <= create_vcluster().size());
+
+    double worst = 0.0;
+    for (size_t i = 0 ; i < 10 ; i++)
+    {worst = std::max(worst,fabs(x.data.get<0>().getVector().get<0>(i) - (i + 1.0)*exp(1.0)));}
+
+    BOOST_REQUIRE(worst < 1e-8);
+}
+
 BOOST_AUTO_TEST_CASE(odeint_base_test2)
 {
     size_t edgeSemiSize = 40;
@@ -104,5 +104,69 @@ BOOST_AUTO_TEST_CASE(odeint_base_test_gpu)
         std::cout<<worst<<std::endl;
         BOOST_REQUIRE(worst < 1e-6);
         }
+BOOST_AUTO_TEST_CASE(odeint_native_steppers_gpu)
+        {
+        size_t edgeSemiSize = 512;
+        const size_t sz[2] = {edgeSemiSize,edgeSemiSize };
+        Box<2, double> box({ 0, 0 }, { 1.0, 1.0 });
+        size_t bc[2] = { NON_PERIODIC, NON_PERIODIC };
+        double spacing[2];
+        spacing[0] = 1.0 / (sz[0] - 1);
+        spacing[1] = 1.0 / (sz[1] - 1);
+        double rCut = 3.9 * spacing[0];
+        Ghost<2, double> ghost(rCut);
+
+        vector_dist_gpu<2, double, aggregate<double, double,double,double>> Particles(0, box, bc, ghost);
+
+        auto it = Particles.getGridIterator(sz);
+        while (it.isNext())
+        {
+            Particles.add();
+            auto key = it.get();
+            double xp0 = key.get(0) * spacing[0];
+            double yp0 = key.get(1) * spacing[1];
+            Particles.getLastPos()[0] = xp0;
+            Particles.getLastPos()[1] = yp0;
+            Particles.getLastProp<0>() = xp0*yp0*exp(-5);
+            Particles.getLastProp<1>() = xp0*yp0*exp(5);
+            ++it;
+        }
+
+        Particles.map();
+        Particles.hostToDeviceProp<0,1,2,3>();
+        auto Init = getV<0,comp_dev>(Particles);
+        auto OdeSol = getV<2,comp_dev>(Particles);
+        auto OdeSolBS = getV<3,comp_dev>(Particles);
+
+        double t0=-5,tf=5;
+        const double dt=0.01;
+
+        // 2N-storage stepper, one kernel per stage
+        state_type x0;
+        x0.data.get<0>()=Init;
+        lsrk_2n_ofp<state_type,boost::numeric::odeint::vector_space_algebra_ofp_gpu> lsrk;
+        boost::numeric::odeint::integrate_const(lsrk,ExponentialGPU,x0,t0,tf,dt);
+        OdeSol=x0.data.get<0>();
+
+        // adaptive stepper, the error norm is reduced on the device
+        state_type x1;
+        x1.data.get<0>()=Init;
+        rk_bs32_ofp<state_type,boost::numeric::odeint::vector_space_algebra_ofp_gpu> bs32(1e-9,1e-9);
+        boost::numeric::odeint::integrate_adaptive(bs32,ExponentialGPU,x1,t0,tf,dt);
+        OdeSolBS=x1.data.get<0>();
+
+        Particles.deviceToHostProp<0,1,2,3>();
+        auto it2 = Particles.getDomainIterator();
+        double worst = 0.0;
+        double worst_bs = 0.0;
+        while (it2.isNext()) {
+            auto p = it2.get();
+            worst = std::max(worst,fabs(Particles.getProp<1>(p) - Particles.getProp<2>(p)));
+            worst_bs = std::max(worst_bs,fabs(Particles.getProp<1>(p) - Particles.getProp<3>(p)));
+            ++it2;
+        }
+        BOOST_REQUIRE(worst < 1e-6);
+        BOOST_REQUIRE(worst_bs < 1e-5);
+        }
 BOOST_AUTO_TEST_SUITE_END()
 #endif
\ No newline at end of file
@@ -5,6 +5,9 @@
 #ifndef OPENFPM_PDATA_VECTOR_ALGEBRA_OFP_HPP
 #define OPENFPM_PDATA_VECTOR_ALGEBRA_OFP_HPP
 
+#include <tuple>
+#include <utility>
+
 namespace boost {
     namespace numeric {
         namespace odeint {
@@ -580,6 +583,10 @@ namespace boost {
             template<typename T>
             inline void operator()(T& t) const
             {
+                // keep the capacity of v2, so v1 does not reallocate when the number of particles change
+                if (v1.data.template get<T::value>().getVector().capacity() < v2.data.template get<T::value>().getVector().capacity())
+                {v1.data.template get<T::value>().getVector().reserve(v2.data.template get<T::value>().getVector().capacity());}
+
                 v1.data.template get<T::value>().getVector().resize(v2.data.template get<T::value>().getVector().size());
             }
         };
@@ -930,6 +937,316 @@ namespace boost {
 
 
 
+
+        /*! \brief Apply an odeint operation on a property of all the states, property by property on contiguous arrays
+         *
+         * Every property of a state is a separate contiguous vector (the state is a structure of arrays), so the
+         * particles are the inner loop. The loop over the particles is split across the threads and vectorized
+         *
+         */
+        template<typename Op, typename ... S>
+        struct for_each_prop_fused
+        {
+            //! operation
+            Op &op;
+
+            //! states
+            std::tuple<S & ...> s;
+
+            //! number of particles
+            long int n;
+
+            inline for_each_prop_fused(Op &op, long int n, S & ... s)
+            :op(op),s(s...),n(n)
+            {};
+
+            //! It apply the operation on the property T::value of all the particles
+            template<typename T>
+            inline void operator()(T& t) const
+            {
+                apply<T::value>(std::index_sequence_for<S...>());
+            }
+
+        private:
+
+            template<unsigned int prp, size_t ... I>
+            inline void apply(std::index_sequence<I...>) const
+            {
+                if (n == 0) {return;}
+
+                apply_ptr(&std::get<I>(s).data.template get<prp>().getVector().template get<0>(0)...);
+            }
+
+            template<typename ... ptr_type>
+            inline void apply_ptr(ptr_type ... ptr) const
+            {
+                Op op_t = op;
+                long int n_p = n;
+
+                #pragma omp parallel for simd firstprivate(op_t) schedule(static)
+                for (long int i = 0 ; i < n_p ; i++)
+                {op_t(ptr[i]...);}
+            }
+        };
+
+        /*! \brief Maximum over all the particles of an operation on a property of the states
+         *
+         * Same loop of for_each_prop_fused, op return a value for every particle and the maximum is reduced across the
+         * threads
+         *
+         */
+        template<typename Op, typename ... S>
+        struct for_each_prop_max
+        {
+            //! operation
+            Op &op;
+
+            //! states
+            std::tuple<S & ...> s;
+
+            //! number of particles
+            long int n;
+
+            //! maximum
+            double &m;
+
+            inline for_each_prop_max(Op &op, long int n, double &m, S & ... s)
+            :op(op),s(s...),n(n),m(m)
+            {};
+
+            //! It apply the operation on the property T::value of all the particles
+            template<typename T>
+            inline void operator()(T& t) const
+            {
+                apply<T::value>(std::index_sequence_for<S...>());
+            }
+
+        private:
+
+            template<unsigned int prp, size_t ... I>
+            inline void apply(std::index_sequence<I...>) const
+            {
+                if (n == 0) {return;}
+
+                apply_ptr(&std::get<I>(s).data.template get<prp>().getVector().template get<0>(0)...);
+            }
+
+            template<typename ... ptr_type>
+            inline void apply_ptr(ptr_type ... ptr) const
+            {
+                Op op_t = op;
+                long int n_p = n;
+                double m_t = m;
+
+                #pragma omp parallel for simd firstprivate(op_t) reduction(max:m_t) schedule(static)
+                for (long int i = 0 ; i < n_p ; i++)
+                {
+                    double v = op_t(ptr[i]...);
+                    m_t = (v > m_t)?v:m_t;
+                }
+
+                m = m_t;
+            }
+        };
+
+        /*! \brief Fused algebra for the openfpm particle states (state_type_1d_ofp ... state_type_5d_ofp)
+         *
+         * Same interface of vector_space_algebra_ofp. Instead of visiting every particle and, for every particle, all the
+         * properties, every property is processed in a single pass on its contiguous array, with the particles split
+         * across the OpenMP threads and vectorized
+         *
+         * \code{.cpp}
+
+           boost::numeric::odeint::runge_kutta4< state_type_3d_ofp,double,state_type_3d_ofp,double,boost::numeric::odeint::vector_space_algebra_ofp_fused> rk4;
+
+         * \endcode
+         *
+         */
+        struct vector_space_algebra_ofp_fused
+        {
+            /*! \brief Apply op on all the properties of all the particles of the states
+             *
+             * s1 is resized as s2 (as vector_space_algebra_ofp)
+             *
+             */
+            template< class Op , class S1 , class ... S >
+            static void for_each_fused( Op &op , S1 &s1 , S & ... s )
+            {
+                resize_as(s1,s...);
+
+                long int n = s1.data.template get<0>().getVector().size();
+
+                for_each_prop_fused<Op,S1,S...> cp(op,n,s1,s...);
+                boost::mpl::for_each_ref<boost::mpl::range_c<int,0,decltype(s1.data)::max_prop>>(cp);
+            }
+
+            template< class S1 , class Op >
+            static void for_each1( S1 &s1 , Op op )
+            {
+                for_each_fused(op,s1);
+            }
+
+            template< class S1 , class S2 , class Op >
+            static void for_each2( S1 &s1 , S2 &s2 , Op op )
+            {
+                for_each_fused(op,s1,s2);
+            }
+
+            template< class S1 , class S2 , class S3 , class Op >
+            static void for_each3( S1 &s1 , S2 &s2 , S3 &s3 , Op op )
+            {
+                for_each_fused(op,s1,s2,s3);
+            }
+
+            template< class S1 , class S2 , class S3 , class S4 , class Op >
+            static void for_each4( S1 &s1 , S2 &s2 , S3 &s3 , S4 &s4 , Op op )
+            {
+                for_each_fused(op,s1,s2,s3,s4);
+            }
+
+            template< class S1 , class S2 , class S3 , class S4 , class S5 , class Op >
+            static void for_each5( S1 &s1 , S2 &s2 , S3 &s3 , S4 &s4 , S5 &s5 , Op op )
+            {
+                for_each_fused(op,s1,s2,s3,s4,s5);
+            }
+
+            template< class S1 , class S2 , class S3 , class S4 , class S5 , class S6 , class Op >
+            static void for_each6( S1 &s1 , S2 &s2 , S3 &s3 , S4 &s4 , S5 &s5 , S6 &s6 , Op op )
+            {
+                for_each_fused(op,s1,s2,s3,s4,s5,s6);
+            }
+
+            template< class S1 , class S2 , class S3 , class S4 , class S5 , class S6 , class S7 , class Op >
+            static void for_each7( S1 &s1 , S2 &s2 , S3 &s3 , S4 &s4 , S5 &s5 , S6 &s6 , S7 &s7 , Op op )
+            {
+                for_each_fused(op,s1,s2,s3,s4,s5,s6,s7);
+            }
+
+            template< class S1 , class S2 , class S3 , class S4 , class S5 , class S6 , class S7 , class S8 , class Op >
+            static void for_each8( S1 &s1 , S2 &s2 , S3 &s3 , S4 &s4 , S5 &s5 , S6 &s6 , S7 &s7 , S8 &s8 , Op op )
+            {
+                for_each_fused(op,s1,s2,s3,s4,s5,s6,s7,s8);
+            }
+
+            template< class S1 , class S2 , class S3 , class S4 , class S5 , class S6 , class S7 , class S8 , class S9 , class Op >
+            static void for_each9( S1 &s1 , S2 &s2 , S3 &s3 , S4 &s4 , S5 &s5 , S6 &s6 , S7 &s7 , S8 &s8 , S9 &s9 , Op op )
+            {
+                for_each_fused(op,s1,s2,s3,s4,s5,s6,s7,s8,s9);
+            }
+
+            template< class S1 , class S2 , class S3 , class S4 , class S5 , class S6 , class S7 , class S8 , class S9 , class S10 , class Op >
+            static void for_each10( S1 &s1 , S2 &s2 , S3 &s3 , S4 &s4 , S5 &s5 , S6 &s6 , S7 &s7 , S8 &s8 , S9 &s9 , S10 &s10 , Op op )
+            {
+                for_each_fused(op,s1,s2,s3,s4,s5,s6,s7,s8,s9,s10);
+            }
+
+            template< class S1 , class S2 , class S3 , class S4 , class S5 , class S6 , class S7 , class S8 , class S9 , class S10 , class S11 , class Op >
+            static void for_each11( S1 &s1 , S2 &s2 , S3 &s3 , S4 &s4 , S5 &s5 , S6 &s6 , S7 &s7 , S8 &s8 , S9 &s9 , S10 &s10 , S11 &s11 , Op op )
+            {
+                for_each_fused(op,s1,s2,s3,s4,s5,s6,s7,s8,s9,s10,s11);
+            }
+
+            template< class S1 , class S2 , class S3 , class S4 , class S5 , class S6 , class S7 , class S8 , class S9 , class S10 , class S11 , class S12 , class Op >
+            static void for_each12( S1 &s1 , S2 &s2 , S3 &s3 , S4 &s4 , S5 &s5 , S6 &s6 , S7 &s7 , S8 &s8 , S9 &s9 , S10 &s10 , S11 &s11 , S12 &s12 , Op op )
+            {
+                for_each_fused(op,s1,s2,s3,s4,s5,s6,s7,s8,s9,s10,s11,s12);
+            }
+
+            template< class S1 , class S2 , class S3 , class S4 , class S5 , class S6 , class S7 , class S8 , class S9 , class S10 , class S11 , class S12 , class S13 , class Op >
+            static void for_each13( S1 &s1 , S2 &s2 , S3 &s3 , S4 &s4 , S5 &s5 , S6 &s6 , S7 &s7 , S8 &s8 , S9 &s9 , S10 &s10 , S11 &s11 , S12 &s12 , S13 &s13 , Op op )
+            {
+                for_each_fused(op,s1,s2,s3,s4,s5,s6,s7,s8,s9,s10,s11,s12,s13);
+            }
+
+            template< class S1 , class S2 , class S3 , class S4 , class S5 , class S6 , class S7 , class S8 , class S9 , class S10 , class S11 , class S12 , class S13 , class S14 , class Op >
+            static void for_each14( S1 &s1 , S2 &s2 , S3 &s3 , S4 &s4 , S5 &s5 , S6 &s6 , S7 &s7 , S8 &s8 , S9 &s9 , S10 &s10 , S11 &s11 , S12 &s12 , S13 &s13 , S14 &s14 , Op op )
+            {
+                for_each_fused(op,s1,s2,s3,s4,s5,s6,s7,s8,s9,s10,s11,s12,s13,s14);
+            }
+
+            template< class S1 , class S2 , class S3 , class S4 , class S5 , class S6 , class S7 , class S8 , class S9 , class S10 , class S11 , class S12 , class S13 , class S14 , class S15 , class Op >
+            static void for_each15( S1 &s1 , S2 &s2 , S3 &s3 , S4 &s4 , S5 &s5 , S6 &s6 , S7 &s7 , S8 &s8 , S9 &s9 , S10 &s10 , S11 &s11 , S12 &s12 , S13 &s13 , S14 &s14 , S15 &s15 , Op op )
+            {
+                for_each_fused(op,s1,s2,s3,s4,s5,s6,s7,s8,s9,s10,s11,s12,s13,s14,s15);
+            }
+
+            /*! \brief Maximum of op over all the particles and all the properties of the states (and all the processors)
+             *
+             * Used by the native steppers to compute an error norm in the same pass of a stage update
+             *
+             */
+            template< class Op , class S1 , class ... S >
+            static double for_each_max( Op op , S1 &s1 , S & ... s )
+            {
+                double m = 0.0;
+                long int n = s1.data.template get<0>().getVector().size();
+
+                for_each_prop_max<Op,S1,S...> cp(op,n,m,s1,s...);
+                boost::mpl::for_each_ref<boost::mpl::range_c<int,0,decltype(s1.data)::max_prop>>(cp);
+
+                auto &v_cl = create_vcluster();
+                v_cl.max(m);
+                v_cl.execute();
+                return m;
+            }
+
+            template< class S >
+            static typename boost::numeric::odeint::vector_space_norm_inf< S >::result_type norm_inf( const S &s )
+            {
+                typename boost::numeric::odeint::vector_space_norm_inf< S >::result_type n=0;
+
+                norm_prop<S,typename boost::numeric::odeint::vector_space_norm_inf< S >::result_type> cp(s,n);
+                boost::mpl::for_each_ref<boost::mpl::range_c<int,0,decltype(s.data)::max_prop>>(cp);
+
+                auto &v_cl = create_vcluster();
+                v_cl.max(n);
+                v_cl.execute();
+                return n;
+            }
+
+        private:
+
+            template< class S1 >
+            static void resize_as( S1 &s1 )
+            {}
+
+            template< class S1 , class S2 , class ... S >
+            static void resize_as( S1 &s1 , S2 &s2 , S & ... s )
+            {
+                for_each_prop_resize<S1,S2> the_resize(s1,s2);
+                boost::mpl::for_each_ref<boost::mpl::range_c<int,0,decltype(s1.data)::max_prop>>(the_resize);
+            }
+
+            //! Maximum of the absolute values of a property, reduced across the threads
+            template<typename vector_type,typename norm_result_type>
+            struct norm_prop
+            {
+                const vector_type &v;
+                norm_result_type &n;
+
+                inline norm_prop(const vector_type &v,norm_result_type &n)
+                :v(v),n(n)
+                {};
+
+                template<typename T>
+                inline void operator()(T& t) const
+                {
+                    long int n_p = v.data.template get<T::value>().getVector().size();
+                    if (n_p == 0) {return;}
+
+                    const auto * ptr = &v.data.template get<T::value>().getVector().template get<0>(0);
+                    norm_result_type n_t = n;
+
+                    #pragma omp parallel for simd reduction(max:n_t) schedule(static)
+                    for (long int i = 0 ; i < n_p ; i++)
+                    {n_t = (fabs(ptr[i]) > n_t)?fabs(ptr[i]):n_t;}
+
+                    n = n_t;
+                }
+            };
+        };
+
+
     } // odeint
 } // numeric
 } // boost
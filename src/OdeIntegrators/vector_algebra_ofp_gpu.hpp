@@ -5,6 +5,8 @@
 #ifndef OPENFPM_PDATA_VECTOR_ALGEBRA_OFP_GPU_HPP
 #define OPENFPM_PDATA_VECTOR_ALGEBRA_OFP_GPU_HPP
 
+#include "util/device_pool.hpp"
+
 namespace boost {
     namespace numeric {
         namespace odeint {
@@ -190,6 +192,48 @@ namespace boost {
                 boost::mpl::for_each_ref<boost::mpl::range_c<int,0,decltype( s1.data)::max_prop>>(cp);
             }
 
+            //! It store in m the maximum of op over all the properties of the particle p
+            template<typename S1,typename S2,typename S3,typename S4,typename S5,typename S6,typename index_type,typename op_type>
+            struct for_each_prop_max6
+            {
+                S1 &v1;
+                S2 &v2;
+                S3 &v3;
+                S4 &v4;
+                S5 &v5;
+                S6 &v6;
+
+                index_type &p;
+                op_type &op;
+                double &m;
+
+                __device__ __host__ inline for_each_prop_max6(S1 &v1,S2 &v2,S3 &v3,S4 &v4,S5 &v5,S6 &v6,index_type &p,op_type &op,double &m)
+                        :v1(v1),v2(v2),v3(v3),v4(v4),v5(v5),v6(v6),p(p),op(op),m(m)
+                {};
+
+                template<typename T>
+                __device__ __host__ inline void operator()(T& t) const
+                {
+                    double v = op(v1.data.template get<T::value>().getVector().template get<0>(p),v2.data.template get<T::value>().getVector().template get<0>(p),v3.data.template get<T::value>().getVector().template get<0>(p),v4.data.template get<T::value>().getVector().template get<0>(p),v5.data.template get<T::value>().getVector().template get<0>(p),v6.data.template get<T::value>().getVector().template get<0>(p));
+                    m = (v > m)?v:m;
+                }
+            };
+
+            //! Maximum of op over the properties of every particle, stored in out (reduced afterwards on the device)
+            template<typename S1,typename S2,typename S3,typename S4,typename S5,typename S6, typename Op, typename out_type>
+            __global__ void for_each_max6_ker(S1 s1,S2 s2,S3 s3,S4 s4,S5 s5,S6 s6, Op op, out_type out)
+            {
+                unsigned int p = threadIdx.x + blockIdx.x * blockDim.x;
+
+                if (p >= s1.data.template get<0>().size())	{return;}
+
+                double m = 0.0;
+                for_each_prop_max6<S1,S2,S3,S4,S5,S6,unsigned int,Op> cp(s1,s2,s3,s4,s5,s6,p,op,m);
+                boost::mpl::for_each_ref<boost::mpl::range_c<int,0,decltype( s1.data)::max_prop>>(cp);
+
+                out[p] = m;
+            }
+
         struct vector_space_algebra_ofp_gpu
         {
 
@@ -367,6 +411,40 @@ namespace boost {
 
 
 
+           /*! \brief Maximum of op over all the particles and all the properties of the states (and all the processors)
+            *
+            * The values are reduced on the device, only the maximum (one value) is copied back to the host. Used by
+            * rk_bs32_ofp for the error norm, computed in the same kernel that read the stages
+            *
+            */
+            template< class Op , class S1 , class S2 , class S3 , class S4 , class S5 , class S6 >
+            static double for_each_max( Op op , S1 &s1 , S2 &s2 , S3 &s3 , S4 &s4 , S5 &s5 , S6 &s6 )
+            {
+                size_t n = s1.data.template get<0>().getVector().size();
+                double m = 0.0;
+
+                if (n != 0)
+                {
+                    // the n errors and their maximum, from the device pool
+                    device_pool & pool = device_pool::instance();
+                    double * err = (double *)pool.allocate((n+1)*sizeof(double));
+
+                    auto it=s1.data.template get<0>().getVector().getGPUIterator();
+                    CUDA_LAUNCH((for_each_max6_ker),it,s1.toKernel(),s2.toKernel(),s3.toKernel(),s4.toKernel(),s5.toKernel(),s6.toKernel(),op,err);
+
+                    auto & v_cl = create_vcluster<CudaMemory>();
+                    openfpm::reduce(err, n, err + n, gpu::maximum_t<double>(), v_cl.getGpuContext());
+
+                    cudaMemcpy(&m,err + n,sizeof(double),cudaMemcpyDeviceToHost);
+                    pool.release(err);
+                }
+
+                auto &v_cl = create_vcluster();
+                v_cl.max(m);
+                v_cl.execute();
+                return m;
+            }
+
            template<typename vector_type,typename index_type,typename norm_result_type>
            struct for_each_norm
            {
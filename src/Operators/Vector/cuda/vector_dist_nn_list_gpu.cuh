@@ -0,0 +1,242 @@
+/*
+ * vector_dist_nn_list_gpu.cuh
+ *
+ * Neighbor lists on the device for the apply kernel expressions
+ */
+
+#ifndef VECTOR_DIST_NN_LIST_GPU_CUH_
+#define VECTOR_DIST_NN_LIST_GPU_CUH_
+
+#ifdef __NVCC__
+
+#include "util/cuda/scan_ofp.cuh"
+
+/*! \brief Iterator over the neighbors of a particle in a vector_dist_nn_list_gpu
+ *
+ */
+struct vector_dist_nn_list_gpu_iterator
+{
+	//! neighbors of all the particles
+	const unsigned int * nn;
+
+	//! current neighbor
+	unsigned int i;
+
+	//! end of the neighbors of the particle
+	unsigned int stop;
+
+	//! Check if there are other neighbors
+	__device__ __host__ inline bool isNext() const
+	{
+		return i < stop;
+	}
+
+	//! Get the neighbor
+	__device__ __host__ inline unsigned int get() const
+	{
+		return nn[i];
+	}
+
+	//! Go to the next neighbor
+	__device__ __host__ inline vector_dist_nn_list_gpu_iterator & operator++()
+	{
+		i++;
+		return *this;
+	}
+};
+
+/*! \brief Kernel view of vector_dist_nn_list_gpu
+ *
+ */
+struct vector_dist_nn_list_gpu_ker
+{
+	//! it is the kernel version of a neighborhood structure, the expressions keep it mutable
+	typedef int yes_is_gpu_ker_celllist;
+
+	//! offset of the neighbors of every particle (N+1 entries)
+	const unsigned int * offsets;
+
+	//! neighbors of all the particles
+	const unsigned int * nn;
+
+	//! Number of neighbors of the particle p
+	__device__ __host__ inline unsigned int getNNPart(unsigned int p) const
+	{
+		return offsets[p+1] - offsets[p];
+	}
+
+	//! Iterator over the neighbors of the particle p
+	__device__ __host__ inline vector_dist_nn_list_gpu_iterator getNNIterator(unsigned int p) const
+	{
+		return vector_dist_nn_list_gpu_iterator{nn,offsets[p],offsets[p+1]};
+	}
+};
+
+//! Count the neighbors of every particle
+template<typename particles_type, typename cl_type, typename T>
+__global__ void nn_list_count_gpu(particles_type particles, cl_type cl, unsigned int * n_nn, T r_cut2)
+{
+	auto p = GET_PARTICLE(particles);
+
+	Point<particles_type::dims,typename particles_type::stype> xp = particles.getPos(p);
+
+	unsigned int n = 0;
+	auto Np = cl.getNNIteratorBox(cl.getCell(xp));
+	while (Np.isNext())
+	{
+		auto q = Np.get();
+		++Np;
+
+		if (p == q) continue;
+		if (r_cut2 < 0 || xp.distance2(particles.getPosOrig(q)) < r_cut2) n++;
+	}
+
+	n_nn[p] = n;
+}
+
+//! Fill the neighbors of every particle
+template<typename particles_type, typename cl_type, typename T>
+__global__ void nn_list_fill_gpu(particles_type particles, cl_type cl, const unsigned int * offsets, unsigned int * nn, T r_cut2)
+{
+	auto p = GET_PARTICLE(particles);
+
+	Point<particles_type::dims,typename particles_type::stype> xp = particles.getPos(p);
+
+	unsigned int n = offsets[p];
+	auto Np = cl.getNNIteratorBox(cl.getCell(xp));
+	while (Np.isNext())
+	{
+		auto q = Np.get();
+		++Np;
+
+		if (p == q) continue;
+		if (r_cut2 < 0 || xp.distance2(particles.getPosOrig(q)) < r_cut2) nn[n++] = q;
+	}
+}
+
+/*! \brief List of the neighbors of the particles on the device
+ *
+ * The Cell-list is visited once and the neighbors of every particle are stored contiguously (the offsets are the
+ * prefix sum of the number of neighbors, computed on the device). Within a time step, when the particles do not
+ * move, the same list can be passed to applyKernel_in, applyKernel_in_gen and applyKernel_in_sim any number of times:
+ * every application read only the neighbors inside the cut-off and no longer scan the neighbor cells. The
+ * neighbors of a particle are stored in the order of the cells of the GPU Cell-list, so threads of contiguous
+ * particles read neighbors close in memory.
+ *
+ * \code{.cpp}
+
+   auto cl = vd.getCellListGPU(r_cut);
+   vd.updateCellListGPU(cl);
+
+   vector_dist_nn_list_gpu nn;
+   nn.build(vd,cl,r_cut);
+
+   vA = applyKernel_in_gen(vVC * vVB,vd,nn,ker);
+   vB = applyKernel_in_gen(vVC,vd,nn,ker);
+
+ * \endcode
+ *
+ */
+class vector_dist_nn_list_gpu
+{
+	//! offset of the neighbors of every particle
+	openfpm::vector_custd<unsigned int> offsets;
+
+	//! neighbors of all the particles
+	openfpm::vector_custd<unsigned int> nn;
+
+	//! number of neighbors of every particle (work buffer)
+	openfpm::vector_custd<unsigned int> n_nn;
+
+	//! total number of neighbors
+	size_t n_tot = 0;
+
+public:
+
+	//! it is a neighborhood structure on the device, the expressions use toKernel()
+	typedef int yes_is_gpu_celllist;
+
+	/*! \brief Build the list
+	 *
+	 * The positions and the Cell-list must be on the device (updateCellListGPU). Only the total number of neighbors
+	 * is copied to the host, to size the list
+	 *
+	 * \param vd particles
+	 * \param cl GPU Cell-list
+	 * \param r_cut cut-off radius, with a negative value all the particles of the neighbor cells are kept (the same
+	 *        neighborhood of the Cell-list)
+	 *
+	 */
+	template<typename vector_type, typename cl_type>
+	void build(vector_type & vd, cl_type & cl, typename vector_type::stype r_cut)
+	{
+		size_t N = vd.size_local();
+
+		auto & v_cl = create_vcluster<CudaMemory>();
+
+		offsets.resize(N+1);
+		n_nn.resize(N+1);
+		n_tot = 0;
+
+		// the last entry is zero, so the exclusive scan leaves the total in offsets[N]
+		cudaMemsetAsync((unsigned int *)n_nn.template getDeviceBuffer<0>(),0,(N+1)*sizeof(unsigned int));
+
+		typename vector_type::stype r_cut2 = (r_cut < 0)?-1:r_cut*r_cut;
+
+		if (N != 0)
+		{
+			auto ite = vd.getDomainIteratorGPU(256);
+			CUDA_LAUNCH((nn_list_count_gpu),ite,vd.toKernel(),cl.toKernel(),(unsigned int *)n_nn.template getDeviceBuffer<0>(),r_cut2);
+		}
+
+		openfpm::scan((unsigned int *)n_nn.template getDeviceBuffer<0>(), N+1, (unsigned int *)offsets.template getDeviceBuffer<0>(), v_cl.getGpuContext());
+
+		offsets.template deviceToHost<0>(N,N);
+		n_tot = offsets.get(N);
+
+		nn.resize(n_tot);
+
+		if (N != 0)
+		{
+			auto ite = vd.getDomainIteratorGPU(256);
+			CUDA_LAUNCH((nn_list_fill_gpu),ite,vd.toKernel(),cl.toKernel(),(const unsigned int *)offsets.template getDeviceBuffer<0>(),
+			            (unsigned int *)nn.template getDeviceBuffer<0>(),r_cut2);
+		}
+	}
+
+	//! total number of neighbors stored
+	size_t size() const
+	{
+		return n_tot;
+	}
+
+	//! Kernel view of the list
+	vector_dist_nn_list_gpu_ker toKernel()
+	{
+		return vector_dist_nn_list_gpu_ker{(const unsigned int *)offsets.template getDeviceBuffer<0>(),
+		                                   (const unsigned int *)nn.template getDeviceBuffer<0>()};
+	}
+
+	//! Copy the list on the host (for checking)
+	void deviceToHost()
+	{
+		offsets.template deviceToHost<0>();
+		nn.template deviceToHost<0>();
+	}
+
+	//! Number of neighbors of the particle p (after deviceToHost)
+	unsigned int getNNPart(size_t p) const
+	{
+		return offsets.get(p+1) - offsets.get(p);
+	}
+
+	//! Neighbor j of the particle p (after deviceToHost)
+	unsigned int get(size_t p, size_t j) const
+	{
+		return nn.get(offsets.get(p) + j);
+	}
+};
+
+#endif
+
+#endif /* VECTOR_DIST_NN_LIST_GPU_CUH_ */
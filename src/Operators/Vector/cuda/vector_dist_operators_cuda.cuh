@@ -443,25 +443,72 @@ struct get_vector_dist_expression_op<3,true>
 
 /////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 
+/*! \brief Loop over the local particles of a vector on the host
+ *
+ * With OpenMP the local particles are split in static chunks among the threads (the expressions only read the
+ * other particles, every particle is written by one thread). Subsets are iterated sequentially with their iterator
+ *
+ * \tparam is_subset true if the vector is a vector_dist_subset
+ *
+ */
+template<bool is_subset>
+struct vector_dist_op_host_loop
+{
+	//! minimum number of particles to start the threads
+	static const size_t omp_threshold = 4096;
+
+	template<typename vector, typename functor>
+	static void run(vector & v, functor f)
+	{
+		long int n = v.size_local();
+
+#ifdef _OPENMP
+		#pragma omp parallel for schedule(static) if (n >= (long int)omp_threshold)
+#endif
+		for (long int i = 0 ; i < n ; i++)
+		{
+			vect_dist_key_dx key(i);
+
+			f(key,v.getOriginKey(key));
+		}
+	}
+};
+
+template<>
+struct vector_dist_op_host_loop<true>
+{
+	template<typename vector, typename functor>
+	static void run(vector & v, functor f)
+	{
+		auto it = v.getDomainIterator();
+
+		while (it.isNext())
+		{
+			auto key = it.get();
+
+			f(key,v.getOriginKey(key));
+
+			++it;
+		}
+	}
+};
+
 template<unsigned int prp>
 struct vector_dist_op_compute_op<prp,comp_host>
 {
+	//! host loop of the vector
+	template<typename vector>
+	using host_loop = vector_dist_op_host_loop<std::remove_reference<vector>::type::is_it_a_subset::value>;
+
 	template<typename vector, typename expr>
 	static void compute_expr(vector & v,expr & v_exp)
 	{
 		v_exp.init();
 
-        auto it = v.getDomainIterator();
-
-        while (it.isNext())
-        {
-                auto key = it.get();
-                auto key_orig = v.getOriginKey(key);
-
-                pos_or_propL<vector,prp>::value(v,key) = v_exp.value(key_orig);
-
-                ++it;
-		}
+		host_loop<vector>::run(v,[&](const vect_dist_key_dx & key, const vect_dist_key_dx & key_orig)
+		{
+			pos_or_propL<vector,prp>::value(v,key) = v_exp.value(key_orig);
+		});
 	}
 
 	template<unsigned int n, typename vector, typename expr>
@@ -477,34 +524,19 @@ struct vector_dist_op_compute_op<prp,comp_host>
         SubsetSelector_impl<std::remove_reference<decltype(v)>::type::is_it_a_subset::value>::check(v2,v);
 #endif
 
-		auto it = v.getDomainIterator();
-
-		while (it.isNext())
+		host_loop<vector>::run(v,[&](const vect_dist_key_dx & key, const vect_dist_key_dx & key_orig)
 		{
-			auto key = it.get();
-			auto key_orig = v.getOriginKey(key);
-
 			get_vector_dist_expression_op<n,n == rank_gen<property_act>::type::value>::template assign<prp>(v_exp,v,key,key_orig,comp);
-
-			++it;
-		}
+		});
 	}
 
 	template<typename vector>
 	static void compute_const(vector & v,double d)
 	{
-        auto it = v.getDomainIterator();
-
-        while (it.isNext())
-        {
-                auto key = it.get();
-                auto key_orig = v.getOriginKey(key);
-
-                pos_or_propL<vector,prp>::value(v,key) = d;
-
-                ++it;
-
-		}
+		host_loop<vector>::run(v,[&](const vect_dist_key_dx & key, const vect_dist_key_dx & key_orig)
+		{
+			pos_or_propL<vector,prp>::value(v,key) = d;
+		});
 	}
 };
 
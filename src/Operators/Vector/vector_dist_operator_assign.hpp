@@ -8,6 +8,9 @@
 #ifndef OPENFPM_NUMERICS_SRC_OPERATORS_VECTOR_VECTOR_DIST_OPERATOR_ASSIGN_HPP_
 #define OPENFPM_NUMERICS_SRC_OPERATORS_VECTOR_VECTOR_DIST_OPERATOR_ASSIGN_HPP_
 
+#include <limits>
+#include <cmath>
+
 //! Construct a vector expression from a type T that is already an expression
 //! it does nothing
 template<typename T>
@@ -42,255 +45,213 @@ struct construct_expression<float>
 	}
 };
 
-template<typename prp1, typename expr1, typename prp2, typename expr2> void assign(prp1 & p1, const expr1 & v_e1, prp2 & p2, const expr2 & v_e2)
-{
-	auto v_exp1 = construct_expression<expr1>::construct(v_e1);
-	auto v_exp2 = construct_expression<expr2>::construct(v_e2);
-
-	v_exp1.init();
-	v_exp2.init();
+//! reduction of assign, sum of the values
+#define ASSIGN_RED_SUM 0
+//! reduction of assign, maximum of the values
+#define ASSIGN_RED_MAX 1
+//! reduction of assign, maximum of the absolute values
+#define ASSIGN_RED_NORM_INF 2
+//! reduction of assign, sum of the squares of the values
+#define ASSIGN_RED_SUM2 3
 
-	auto it = p1.getVector().getDomainIterator();
-
-	while (it.isNext())
-	{
-		auto key = it.get();
+/*! \brief Target of assign that reduce the values of an expression in a scalar (instead of writing a property)
+ *
+ * As rsum and norm_inf the reduction is local on the processor
+ *
+ * \tparam T type of the scalar
+ * \tparam red_op reduction (ASSIGN_RED_SUM, ASSIGN_RED_MAX, ASSIGN_RED_NORM_INF, ASSIGN_RED_SUM2)
+ *
+ */
+template<typename T, unsigned int red_op>
+struct assign_reduction
+{
+	//! result of the reduction
+	T & val;
+};
 
-		pos_or_propL<typename prp1::vtype,prp1::prop>::value(p1.getVector(),key) = v_exp1.value(key);
-		pos_or_propL<typename prp2::vtype,prp2::prop>::value(p2.getVector(),key) = v_exp2.value(key);
+//! assign target, sum of the values of the expression in val
+template<typename T> inline assign_reduction<T,ASSIGN_RED_SUM> sum_to(T & val)
+{
+	return assign_reduction<T,ASSIGN_RED_SUM>{val};
+}
 
-		++it;
-	}
+//! assign target, maximum of the values of the expression in val
+template<typename T> inline assign_reduction<T,ASSIGN_RED_MAX> max_to(T & val)
+{
+	return assign_reduction<T,ASSIGN_RED_MAX>{val};
 }
 
-template<typename prp1, typename expr1, typename prp2, typename expr2, typename prp3, typename expr3> void assign(prp1 & p1, const expr1 & v_e1, prp2 & p2, const expr2 & v_e2, prp3 & p3, const expr3 & v_e3)
+//! assign target, maximum of the absolute values of the expression in val
+template<typename T> inline assign_reduction<T,ASSIGN_RED_NORM_INF> norm_inf_to(T & val)
 {
-	auto v_exp1 = construct_expression<expr1>::construct(v_e1);
-	auto v_exp2 = construct_expression<expr2>::construct(v_e2);
-	auto v_exp3 = construct_expression<expr3>::construct(v_e3);
+	return assign_reduction<T,ASSIGN_RED_NORM_INF>{val};
+}
 
-	v_exp1.init();
-	v_exp2.init();
-	v_exp3.init();
+//! assign target, sum of the squares of the values of the expression in val
+template<typename T> inline assign_reduction<T,ASSIGN_RED_SUM2> sum2_to(T & val)
+{
+	return assign_reduction<T,ASSIGN_RED_SUM2>{val};
+}
 
-	auto it = p1.getVector().getDomainIterator();
+/*! \brief Write the value of an expression on a target of assign (a property or the position)
+ *
+ * \tparam prp target
+ *
+ */
+template<typename prp>
+struct assign_target
+{
+	//! nothing to initialize for a property
+	static inline void init(prp & p)
+	{}
 
-	while (it.isNext())
+	//! write the property of the particle key
+	template<typename key_type, typename val_type> static inline void set(prp & p, const key_type & key, val_type && v)
 	{
-		auto key = it.get();
-
-		pos_or_propL<typename prp1::vtype,prp1::prop>::value(p1.getVector(),key) = v_exp1.value(key);
-		pos_or_propL<typename prp2::vtype,prp2::prop>::value(p2.getVector(),key) = v_exp2.value(key);
-		pos_or_propL<typename prp3::vtype,prp3::prop>::value(p3.getVector(),key) = v_exp3.value(key);
-
-		++it;
+		pos_or_propL<typename prp::vtype,prp::prop>::value(p.getVector(),key) = v;
 	}
-}
+};
 
-template<typename prp1, typename expr1,
-		 typename prp2, typename expr2,
-		 typename prp3, typename expr3,
-		 typename prp4, typename expr4>
-void assign(prp1 & p1, const expr1 & v_e1,
-			prp2 & p2, const expr2 & v_e2,
-			prp3 & p3, const expr3 & v_e3,
-			prp4 & p4, const expr4 & v_e4)
+//! Accumulate the value of an expression on a reduction target (sum)
+template<typename T>
+struct assign_target<assign_reduction<T,ASSIGN_RED_SUM>>
 {
-	auto v_exp1 = construct_expression<expr1>::construct(v_e1);
-	auto v_exp2 = construct_expression<expr2>::construct(v_e2);
-	auto v_exp3 = construct_expression<expr3>::construct(v_e3);
-	auto v_exp4 = construct_expression<expr4>::construct(v_e4);
+	static inline void init(assign_reduction<T,ASSIGN_RED_SUM> & r)
+	{r.val = 0;}
 
-	v_exp1.init();
-	v_exp2.init();
-	v_exp3.init();
-	v_exp4.init();
+	template<typename key_type, typename val_type> static inline void set(assign_reduction<T,ASSIGN_RED_SUM> & r, const key_type & key, val_type && v)
+	{r.val += v;}
+};
 
-	auto it = p1.getVector().getDomainIterator();
+//! Accumulate the value of an expression on a reduction target (max)
+template<typename T>
+struct assign_target<assign_reduction<T,ASSIGN_RED_MAX>>
+{
+	static inline void init(assign_reduction<T,ASSIGN_RED_MAX> & r)
+	{r.val = std::numeric_limits<T>::lowest();}
 
-	while (it.isNext())
+	template<typename key_type, typename val_type> static inline void set(assign_reduction<T,ASSIGN_RED_MAX> & r, const key_type & key, val_type && v)
 	{
-		auto key = it.get();
-
-		pos_or_propL<typename prp1::vtype,prp1::prop>::value(p1.getVector(),key) = v_exp1.value(key);
-		pos_or_propL<typename prp2::vtype,prp2::prop>::value(p2.getVector(),key) = v_exp2.value(key);
-		pos_or_propL<typename prp3::vtype,prp3::prop>::value(p3.getVector(),key) = v_exp3.value(key);
-		pos_or_propL<typename prp4::vtype,prp4::prop>::value(p4.getVector(),key) = v_exp4.value(key);
-
-		++it;
+		if (v > r.val)	{r.val = v;}
 	}
-}
-
+};
 
-template<typename prp1, typename expr1,
-		 typename prp2, typename expr2,
-		 typename prp3, typename expr3,
-		 typename prp4, typename expr4,
-		 typename prp5, typename expr5>
-void assign(prp1 & p1, const expr1 & v_e1,
-			prp2 & p2, const expr2 & v_e2,
-			prp3 & p3, const expr3 & v_e3,
-			prp4 & p4, const expr4 & v_e4,
-			prp5 & p5, const expr5 & v_e5)
+//! Accumulate the value of an expression on a reduction target (max of the absolute value)
+template<typename T>
+struct assign_target<assign_reduction<T,ASSIGN_RED_NORM_INF>>
 {
-	auto v_exp1 = construct_expression<expr1>::construct(v_e1);
-	auto v_exp2 = construct_expression<expr2>::construct(v_e2);
-	auto v_exp3 = construct_expression<expr3>::construct(v_e3);
-	auto v_exp4 = construct_expression<expr4>::construct(v_e4);
-	auto v_exp5 = construct_expression<expr5>::construct(v_e5);
-
-	v_exp1.init();
-	v_exp2.init();
-	v_exp3.init();
-	v_exp4.init();
-	v_exp5.init();
-
-	auto it = p1.getVector().getDomainIterator();
+	static inline void init(assign_reduction<T,ASSIGN_RED_NORM_INF> & r)
+	{r.val = 0;}
 
-	while (it.isNext())
+	template<typename key_type, typename val_type> static inline void set(assign_reduction<T,ASSIGN_RED_NORM_INF> & r, const key_type & key, val_type && v)
 	{
-		auto key = it.get();
+		if (fabs(v) > r.val)	{r.val = fabs(v);}
+	}
+};
 
-		pos_or_propL<typename prp1::vtype,prp1::prop>::value(p1.getVector(),key) = v_exp1.value(key);
-		pos_or_propL<typename prp2::vtype,prp2::prop>::value(p2.getVector(),key) = v_exp2.value(key);
-		pos_or_propL<typename prp3::vtype,prp3::prop>::value(p3.getVector(),key) = v_exp3.value(key);
-		pos_or_propL<typename prp4::vtype,prp4::prop>::value(p4.getVector(),key) = v_exp4.value(key);
-		pos_or_propL<typename prp5::vtype,prp5::prop>::value(p5.getVector(),key) = v_exp5.value(key);
+//! Accumulate the value of an expression on a reduction target (sum of the squares)
+template<typename T>
+struct assign_target<assign_reduction<T,ASSIGN_RED_SUM2>>
+{
+	static inline void init(assign_reduction<T,ASSIGN_RED_SUM2> & r)
+	{r.val = 0;}
 
-		++it;
-	}
-}
+	template<typename key_type, typename val_type> static inline void set(assign_reduction<T,ASSIGN_RED_SUM2> & r, const key_type & key, val_type && v)
+	{r.val += v*v;}
+};
+
+/*! \brief List of target/expression pairs of assign
+ *
+ * Every pair keep the target and the expression (constants are converted into expressions), all the pairs are
+ * evaluated on a particle before moving to the next one
+ *
+ */
+template<typename ... pairs>
+struct assign_list;
 
-template<typename prp1, typename expr1,
-		 typename prp2, typename expr2,
-		 typename prp3, typename expr3,
-		 typename prp4, typename expr4,
-		 typename prp5, typename expr5,
-		 typename prp6, typename expr6>
-void assign(prp1 & p1, const expr1 & v_e1,
-			prp2 & p2, const expr2 & v_e2,
-			prp3 & p3, const expr3 & v_e3,
-			prp4 & p4, const expr4 & v_e4,
-			prp5 & p5, const expr5 & v_e5,
-			prp6 & p6, const expr6 & v_e6)
+template<typename prp1, typename expr1, typename ... pairs>
+struct assign_list<prp1,expr1,pairs ...>
 {
-	auto v_exp1 = construct_expression<expr1>::construct(v_e1);
-	auto v_exp2 = construct_expression<expr2>::construct(v_e2);
-	auto v_exp3 = construct_expression<expr3>::construct(v_e3);
-	auto v_exp4 = construct_expression<expr4>::construct(v_e4);
-	auto v_exp5 = construct_expression<expr5>::construct(v_e5);
-	auto v_exp6 = construct_expression<expr6>::construct(v_e6);
-
-	v_exp1.init();
-	v_exp2.init();
-	v_exp3.init();
-	v_exp4.init();
-	v_exp5.init();
-	v_exp6.init();
+	//! target
+	prp1 p1;
 
-	auto it = p1.getVector().getDomainIterator();
+	//! expression
+	typename std::decay<decltype(construct_expression<expr1>::construct(std::declval<expr1>()))>::type v_exp1;
 
-	while (it.isNext())
-	{
-		auto key = it.get();
+	//! the other pairs
+	assign_list<pairs ...> next;
 
-		pos_or_propL<typename prp1::vtype,prp1::prop>::value(p1.getVector(),key) = v_exp1.value(key);
-		pos_or_propL<typename prp2::vtype,prp2::prop>::value(p2.getVector(),key) = v_exp2.value(key);
-		pos_or_propL<typename prp3::vtype,prp3::prop>::value(p3.getVector(),key) = v_exp3.value(key);
-		pos_or_propL<typename prp4::vtype,prp4::prop>::value(p4.getVector(),key) = v_exp4.value(key);
-		pos_or_propL<typename prp5::vtype,prp5::prop>::value(p5.getVector(),key) = v_exp5.value(key);
-		pos_or_propL<typename prp6::vtype,prp6::prop>::value(p6.getVector(),key) = v_exp6.value(key);
+	//! constructor
+	template<typename ... args_type>
+	assign_list(const prp1 & p1, const expr1 & v_e1, args_type && ... args)
+	:p1(p1),v_exp1(construct_expression<expr1>::construct(v_e1)),next(args ...)
+	{}
 
-		++it;
+	//! initialize the expressions (and the reductions)
+	inline void init()
+	{
+		v_exp1.init();
+		assign_target<prp1>::init(p1);
+		next.init();
 	}
-}
-
 
+	//! evaluate all the expressions on the particle key
+	template<typename key_type> inline void set(const key_type & key)
+	{
+		assign_target<prp1>::set(p1,key,v_exp1.value(key));
+		next.set(key);
+	}
+};
 
-template<typename prp1, typename expr1,
-		 typename prp2, typename expr2,
-		 typename prp3, typename expr3,
-		 typename prp4, typename expr4,
-		 typename prp5, typename expr5,
-		 typename prp6, typename expr6,
-		 typename prp7, typename expr7>
-void assign(prp1 & p1, const expr1 & v_e1,
-			prp2 & p2, const expr2 & v_e2,
-			prp3 & p3, const expr3 & v_e3,
-			prp4 & p4, const expr4 & v_e4,
-			prp5 & p5, const expr5 & v_e5,
-			prp6 & p6, const expr6 & v_e6,
-			prp7 & p7, const expr7 & v_e7)
+//! end of the list
+template<>
+struct assign_list<>
 {
-	auto v_exp1 = construct_expression<expr1>::construct(v_e1);
-	auto v_exp2 = construct_expression<expr2>::construct(v_e2);
-	auto v_exp3 = construct_expression<expr3>::construct(v_e3);
-	auto v_exp4 = construct_expression<expr4>::construct(v_e4);
-	auto v_exp5 = construct_expression<expr5>::construct(v_e5);
-	auto v_exp6 = construct_expression<expr6>::construct(v_e6);
-	auto v_exp7 = construct_expression<expr7>::construct(v_e7);
-
-	v_exp1.init();
-	v_exp2.init();
-	v_exp3.init();
-	v_exp4.init();
-	v_exp5.init();
-	v_exp6.init();
-	v_exp7.init();
+	//! constructor
+	assign_list()
+	{}
 
-	auto it = p1.getVector().getDomainIterator();
+	//! end of the list
+	inline void init()
+	{}
 
-	while (it.isNext())
-	{
-		auto key = it.get();
+	//! end of the list
+	template<typename key_type> inline void set(const key_type & key)
+	{}
+};
 
-		pos_or_propL<typename prp1::vtype,prp1::prop>::value(p1.getVector(),key) = v_exp1.value(key);
-		pos_or_propL<typename prp2::vtype,prp2::prop>::value(p2.getVector(),key) = v_exp2.value(key);
-		pos_or_propL<typename prp3::vtype,prp3::prop>::value(p3.getVector(),key) = v_exp3.value(key);
-		pos_or_propL<typename prp4::vtype,prp4::prop>::value(p4.getVector(),key) = v_exp4.value(key);
-		pos_or_propL<typename prp5::vtype,prp5::prop>::value(p5.getVector(),key) = v_exp5.value(key);
-		pos_or_propL<typename prp6::vtype,prp6::prop>::value(p6.getVector(),key) = v_exp6.value(key);
-		pos_or_propL<typename prp7::vtype,prp7::prop>::value(p7.getVector(),key) = v_exp7.value(key);
+/*! \brief Assign several expressions in one loop over the particles
+ *
+ * The arguments are pairs target, expression. A target is a property (or the position) of a vector, or a
+ * reduction of the expression in a scalar (sum_to, max_to, norm_inf_to, sum2_to). Every expression can contain
+ * any term that can be evaluated on a particle, DCPSE operators included. The properties are read and written only
+ * once, in one pass, instead of one pass for every assignment
+ *
+ * \code{.cpp}
 
-		++it;
-	}
-}
+   double res;
 
+   // v = v + dt*Lap(u), w = 2*v, res = max|Lap(u)|
+   assign(v, v + dt*Lap(u),
+          w, 2.0*v,
+          norm_inf_to(res), Lap(u));
 
-template<typename prp1, typename expr1,
-		 typename prp2, typename expr2,
-		 typename prp3, typename expr3,
-		 typename prp4, typename expr4,
-		 typename prp5, typename expr5,
-		 typename prp6, typename expr6,
-		 typename prp7, typename expr7,
-		 typename prp8, typename expr8>
-void assign(prp1 & p1, const expr1 & v_e1,
-			prp2 & p2, const expr2 & v_e2,
-			prp3 & p3, const expr3 & v_e3,
-			prp4 & p4, const expr4 & v_e4,
-			prp5 & p5, const expr5 & v_e5,
-			prp6 & p6, const expr6 & v_e6,
-			prp7 & p7, const expr7 & v_e7,
-			prp8 & p8, const expr8 & v_e8)
+ * \endcode
+ *
+ * \warning The pairs are evaluated in order on every particle before the next particle, an expression that read the
+ *          neighborhood (DCPSE operators) must not read a property written by the same assign
+ *
+ * \note The loop is on the domain of the vector of the first target, that must be a property
+ *
+ */
+template<typename prp1, typename expr1, typename ... args_type>
+void assign(prp1 & p1, const expr1 & v_e1, args_type && ... args)
 {
-	auto v_exp1 = construct_expression<expr1>::construct(v_e1);
-	auto v_exp2 = construct_expression<expr2>::construct(v_e2);
-	auto v_exp3 = construct_expression<expr3>::construct(v_e3);
-	auto v_exp4 = construct_expression<expr4>::construct(v_e4);
-	auto v_exp5 = construct_expression<expr5>::construct(v_e5);
-	auto v_exp6 = construct_expression<expr6>::construct(v_e6);
-	auto v_exp7 = construct_expression<expr7>::construct(v_e7);
-	auto v_exp8 = construct_expression<expr8>::construct(v_e8);
-
-	v_exp1.init();
-	v_exp2.init();
-	v_exp3.init();
-	v_exp4.init();
-	v_exp5.init();
-	v_exp6.init();
-	v_exp7.init();
-	v_exp8.init();
+	static_assert(sizeof...(args) % 2 == 0,"assign require pairs target, expression");
+
+	assign_list<prp1,expr1,typename std::decay<args_type>::type ...> al(p1,v_e1,args ...);
+
+	al.init();
 
 	auto it = p1.getVector().getDomainIterator();
 
@@ -298,14 +259,7 @@ void assign(prp1 & p1, const expr1 & v_e1,
 	{
 		auto key = it.get();
 
-		pos_or_propL<typename prp1::vtype,prp1::prop>::value(p1.getVector(),key) = v_exp1.value(key);
-		pos_or_propL<typename prp2::vtype,prp2::prop>::value(p2.getVector(),key) = v_exp2.value(key);
-		pos_or_propL<typename prp3::vtype,prp3::prop>::value(p3.getVector(),key) = v_exp3.value(key);
-		pos_or_propL<typename prp4::vtype,prp4::prop>::value(p4.getVector(),key) = v_exp4.value(key);
-		pos_or_propL<typename prp5::vtype,prp5::prop>::value(p5.getVector(),key) = v_exp5.value(key);
-		pos_or_propL<typename prp6::vtype,prp6::prop>::value(p6.getVector(),key) = v_exp6.value(key);
-		pos_or_propL<typename prp7::vtype,prp7::prop>::value(p7.getVector(),key) = v_exp7.value(key);
-		pos_or_propL<typename prp8::vtype,prp8::prop>::value(p8.getVector(),key) = v_exp8.value(key);
+		al.set(key);
 
 		++it;
 	}
@@ -12,6 +12,7 @@
 #include "Vector/vector_dist_subset.hpp"
 #include "lib/pdata.hpp"
 #include "cuda/vector_dist_operators_cuda.cuh"
+#include "vector_dist_operators_pool.hpp"
 
 #define PROP_CUSTOM (unsigned int)-2
 
@@ -69,6 +70,10 @@
 #define VECT_SUM_REDUCE 93
 #define VECT_COMP 94
 #define VECT_NORM_INF 95
+#define VECT_MAX_REDUCE 96
+#define VECT_MIN_REDUCE 97
+#define VECT_NORM2_REDUCE 98
+#define VECT_CACHE 99
 
 
 #define VECT_DCPSE 100
@@ -1252,20 +1257,60 @@ public:
     ////////////////////////////////////
 
     vector_dist_expression_impl()
-    {}
+    {
+        texp_pool<vector>::get().acquire(v);
+    }
 
     template<unsigned int prp2, typename vector2>
     vector_dist_expression_impl(const vector_dist_expression<prp2,vector2> & v_exp)
     {
+        texp_pool<vector>::get().acquire(v);
         this->operator=(v_exp);
     };
 
     template<typename exp1, typename exp2, unsigned int op>
     vector_dist_expression_impl(const vector_dist_expression_op<exp1,exp2,op> & v_exp)
     {
+        texp_pool<vector>::get().acquire(v);
         this->operator=(v_exp);
     }
 
+    //! the copies (the operands of the expressions store their copy) also take their buffer from the pool
+    vector_dist_expression_impl(const vector_dist_expression_impl<vector_type> & v_exp)
+    :var_id(v_exp.var_id)
+    {
+        texp_pool<vector>::get().acquire(v);
+        v = v_exp.v;
+    }
+
+    vector_dist_expression_impl(vector_dist_expression_impl<vector_type> && v_exp)
+    :var_id(v_exp.var_id)
+    {
+        v.swap(v_exp.v);
+    }
+
+    vector_dist_expression_impl<vector_type> & operator=(const vector_dist_expression_impl<vector_type> & v_exp)
+    {
+        v = v_exp.v;
+        var_id = v_exp.var_id;
+
+        return *this;
+    }
+
+    vector_dist_expression_impl<vector_type> & operator=(vector_dist_expression_impl<vector_type> && v_exp)
+    {
+        v.swap(v_exp.v);
+        var_id = v_exp.var_id;
+
+        return *this;
+    }
+
+    //! give back the buffer to the pool
+    ~vector_dist_expression_impl()
+    {
+        texp_pool<vector>::get().release(v);
+    }
+
     /*! \brief get the NN object
      *
      * \return the NN object
@@ -2794,6 +2839,7 @@ operator/(const vector_dist_expression_op<exp1,exp2,op1> & va, const vector_dist
 }
 
 #include "vector_dist_operators_apply_kernel.hpp"
+#include "cuda/vector_dist_nn_list_gpu.cuh"
 #include "vector_dist_operators_functions.hpp"
 #include "vector_dist_operators_extensions.hpp"
 #include "Operators/Vector/vector_dist_operator_assign.hpp"
@@ -77,6 +77,62 @@ struct set_zero<Point<dim,T>>
 	}
 };
 
+/*! \brief is_nn_list check if the neighborhood structure is a list of neighbors (Verlet-list) or a Cell-list
+ *
+ * return true if T has getNNPart (VerletList, vector_dist_nn_list_gpu)
+ *
+ */
+template<typename ObjType, typename Sfinae = void>
+struct is_nn_list: std::false_type {};
+
+template<typename ObjType>
+struct is_nn_list<ObjType, typename Void<decltype(std::declval<ObjType>().getNNPart(0))>::type> : std::true_type
+{};
+
+/*! \brief Get the neighborhood iterator of a particle from a Cell-list
+ *
+ * \tparam NN_type Cell-list or Verlet-list
+ *
+ */
+template<typename NN_type, bool is_list = is_nn_list<NN_type>::value>
+struct apply_kernel_nn
+{
+	/*! \brief Get the neighborhood iterator
+	 *
+	 * \param cl Cell-list
+	 * \param p position of the particle
+	 * \param key particle
+	 *
+	 * \return the iterator over the particles in the neighborhood cells
+	 *
+	 */
+	template<unsigned int dim, typename St>
+	__device__ __host__ static inline auto get(NN_type & cl, const Point<dim,St> & p, const vect_dist_key_dx & key) -> decltype(cl.getNNIteratorBox(cl.getCell(p)))
+	{
+		return cl.getNNIteratorBox(cl.getCell(p));
+	}
+};
+
+//! Get the neighborhood iterator of a particle from a list of neighbors (built once and reused)
+template<typename NN_type>
+struct apply_kernel_nn<NN_type,true>
+{
+	/*! \brief Get the neighborhood iterator
+	 *
+	 * \param cl Verlet-list
+	 * \param p position of the particle
+	 * \param key particle
+	 *
+	 * \return the iterator over the neighbors of the particle
+	 *
+	 */
+	template<unsigned int dim, typename St>
+	__device__ __host__ static inline auto get(NN_type & cl, const Point<dim,St> & p, const vect_dist_key_dx & key) -> decltype(cl.getNNIterator(key.getKey()))
+	{
+		return cl.getNNIterator(key.getKey());
+	}
+};
+
 /*! \brief Apply the kernel to particle differently that is a number or is an expression
  *
  *
@@ -107,7 +163,7 @@ struct apply_kernel_is_number_or_expression
 	    rtype prp_p = v_exp.value(key);
 
 	    // Get the neighborhood of the particle
-	    auto NN = cl.getNNIteratorBox(cl.getCell(p));
+	    auto NN = apply_kernel_nn<NN_type>::get(cl,p,key);
 	    while(NN.isNext())
 	    {
 			auto nnp = NN.get();
@@ -163,7 +219,7 @@ struct apply_kernel_is_number_or_expression_sim
 	    Point<vector::dims,typename vector::stype> p = vd.getPos(key);
 
 	    // Get the neighborhood of the particle
-	    auto NN = cl.getNNIteratorBox(cl.getCell(p));
+	    auto NN = apply_kernel_nn<NN_type>::get(cl,p,key);
 	    while(NN.isNext())
 	    {
 			auto nnp = NN.get();
@@ -218,7 +274,7 @@ struct apply_kernel_is_number_or_expression_gen
 	    Point<vector::dims,typename vector::stype> p = vd.getPos(key);
 
 	    // Get the neighborhood of the particle
-	    auto NN = cl.getNNIteratorBox(cl.getCell(p));
+	    auto NN = apply_kernel_nn<NN_type>::get(cl,p,key);
 	    while(NN.isNext())
 	    {
 			auto nnp = NN.get();
@@ -871,4 +927,276 @@ applyKernel_in_sim(vector_type & vd, NN & cl, Kernel & ker)
 	return exp_sum;
 }
 
+///////////////////////////////////// Symmetric apply kernel ////////
+////////////////////////////////////////////////////////////////////////
+
+//! The contribution of a pair to the particle q is equal to the contribution to the particle p, W(q,p) = W(p,q)
+#define APPLYKER_PAIR_SYMMETRIC 1
+
+//! The contribution of a pair to the particle q is the opposite of the contribution to p, W(q,p) = -W(p,q)
+#define APPLYKER_PAIR_ANTISYMMETRIC 2
+
+/*! \brief Interaction of a pair for applyKernel_in_sym, the kernel is called as in VECT_APPLYKER_IN
+ *
+ * \tparam vector type of the particle set
+ * \tparam exp expression
+ * \tparam Kernel kernel
+ *
+ */
+template<typename vector, typename exp, typename Kernel>
+struct apply_kernel_pair_in
+{
+	//! Get the return type of applying the kernel to a pair
+	typedef typename std::remove_reference<typename apply_kernel_rtype<decltype(std::declval<const exp>().value(vect_dist_key_dx()))>::rtype>::type rtype;
+
+	//! particle set
+	const vector & vd;
+
+	//! expression
+	const exp & v_exp;
+
+	//! kernel
+	Kernel & lker;
+
+	/*! \brief Contribution of the particle q to the particle p
+	 *
+	 * \param key_p particle p
+	 * \param key_q particle q
+	 *
+	 * \return W(p,q)
+	 *
+	 */
+	inline rtype value(const vect_dist_key_dx & key_p, const vect_dist_key_dx & key_q)
+	{
+		Point<vector::dims,typename vector::stype> p = vd.getPos(key_p);
+		Point<vector::dims,typename vector::stype> q = vd.getPos(key_q);
+
+		return lker.value(p,q,v_exp.value(key_p),v_exp.value(key_q));
+	}
+};
+
+/*! \brief Interaction of a pair for applyKernel_in_gen_sym, the kernel is called as in VECT_APPLYKER_IN_GEN
+ *
+ * \tparam vector type of the particle set
+ * \tparam exp expression
+ * \tparam Kernel kernel
+ *
+ */
+template<typename vector, typename exp, typename Kernel>
+struct apply_kernel_pair_in_gen
+{
+	//! Get the return type of applying the kernel to a pair
+	typedef typename std::remove_reference<typename apply_kernel_rtype<decltype(std::declval<const exp>().value(vect_dist_key_dx()))>::rtype>::type rtype;
+
+	//! particle set
+	const vector & vd;
+
+	//! expression
+	const exp & v_exp;
+
+	//! kernel
+	Kernel & lker;
+
+	/*! \brief Contribution of the particle q to the particle p
+	 *
+	 * \param key_p particle p
+	 * \param key_q particle q
+	 *
+	 * \return W(p,q)
+	 *
+	 */
+	inline rtype value(const vect_dist_key_dx & key_p, const vect_dist_key_dx & key_q)
+	{
+		return lker.value(key_p.getKey(),key_q.getKey(),v_exp.value(key_p),v_exp.value(key_q),vd);
+	}
+};
+
+/*! \brief Interaction of a pair for applyKernel_in_sim_sym, the kernel is called as in VECT_APPLYKER_IN_SIM
+ *
+ * \tparam vector type of the particle set
+ * \tparam Kernel kernel
+ *
+ */
+template<typename vector, typename Kernel>
+struct apply_kernel_pair_in_sim
+{
+	//! Get the return type of applying the kernel to a pair
+	typedef typename std::remove_reference<decltype(std::declval<Kernel>().value(Point<vector::dims,typename vector::stype>(),
+	                                                                            Point<vector::dims,typename vector::stype>()))>::type rtype;
+
+	//! particle set
+	const vector & vd;
+
+	//! kernel
+	Kernel & lker;
+
+	/*! \brief Contribution of the particle q to the particle p
+	 *
+	 * \param key_p particle p
+	 * \param key_q particle q
+	 *
+	 * \return W(p,q)
+	 *
+	 */
+	inline rtype value(const vect_dist_key_dx & key_p, const vect_dist_key_dx & key_q)
+	{
+		Point<vector::dims,typename vector::stype> p = vd.getPos(key_p);
+		Point<vector::dims,typename vector::stype> q = vd.getPos(key_q);
+
+		return lker.value(p,q);
+	}
+};
+
+/*! \brief Apply a kernel computing every pair only once
+ *
+ * Every pair (p,q) of the symmetric cell-list is visited once: W(p,q) is added to p and W(q,p) (given by the
+ * symmetry of the kernel) to q. When q is a ghost particle its contribution is sent back to the owner with a
+ * ghost_put, so every particle receive the same sum it would receive iterating its full neighborhood
+ *
+ * \tparam prp property where to store the result
+ *
+ * \param vd particle set
+ * \param cl symmetric Cell-list (vd.getCellListSym)
+ * \param pk interaction of a pair
+ * \param pair APPLYKER_PAIR_SYMMETRIC or APPLYKER_PAIR_ANTISYMMETRIC
+ *
+ */
+template<unsigned int prp, typename vector, typename NN_type, typename pair_type>
+void apply_kernel_sym_impl(vector & vd, NN_type & cl, pair_type pk, int pair)
+{
+	typedef typename pair_type::rtype rtype;
+
+	if (pair != APPLYKER_PAIR_SYMMETRIC && pair != APPLYKER_PAIR_ANTISYMMETRIC)
+	{
+		std::cerr << __FILE__ << ":" << __LINE__ << " error the symmetry of the pair must be APPLYKER_PAIR_SYMMETRIC or APPLYKER_PAIR_ANTISYMMETRIC" << std::endl;
+		return;
+	}
+
+	// accumulator for the real and the ghost particles
+	openfpm::vector<rtype> acc;
+	acc.resize(vd.size_local_with_ghost());
+
+	for (size_t i = 0 ; i < acc.size() ; i++)
+	{acc.get(i) = set_zero<rtype>::create();}
+
+	auto it = vd.getDomainIterator();
+
+	while (it.isNext())
+	{
+		auto key = it.get();
+
+		// position of particle p
+		Point<vector::dims,typename vector::stype> p = vd.getPos(key);
+
+		// Get the half neighborhood of the particle
+		auto NN = cl.getNNIteratorBoxSym(cl.getCell(p),key.getKey(),vd.getPosVector());
+		while (NN.isNext())
+		{
+			auto nnp = NN.get();
+
+			// exclude itself
+			if (nnp != key.getKey())
+			{
+				vect_dist_key_dx nnp_k;
+				nnp_k.setKey(nnp);
+
+				rtype w = pk.value(key,nnp_k);
+
+				acc.get(key.getKey()) += w;
+
+				if (pair == APPLYKER_PAIR_SYMMETRIC)
+				{acc.get(nnp) += w;}
+				else
+				{acc.get(nnp) -= w;}
+			}
+
+			++NN;
+		}
+
+		++it;
+	}
+
+	auto it2 = vd.getDomainAndGhostIterator();
+
+	while (it2.isNext())
+	{
+		auto key = it2.get();
+
+		pos_or_propL<vector,prp>::value(vd,key) = acc.get(key.getKey());
+
+		++it2;
+	}
+
+	// send the contributions of the ghost particles to their owners
+	vd.template ghost_put<add_,prp>();
+}
+
+/*! \brief Apply a kernel as applyKernel_in, computing every pair only once (Newton's third law)
+ *
+ * The result is written in the property prp of the particles. The kernel must be symmetric or antisymmetric
+ * under the exchange of p and q, for example W(p,q) = (f_q - f_p) Lap_PSE(p,q) of a PSE diffusion is antisymmetric:
+ * the kernel is evaluated half of the times of applyKernel_in. The properties used by the expression must be
+ * updated on the ghost (ghost_get) before the call. The reduction (VECT_APPLYKER_REDUCE) is rsum(getV<prp>(vd))
+ *
+ * \code{.cpp}
+
+   auto cl = vd.getCellListSym(r_cut);
+   vd.ghost_get<0>();
+
+   applyKernel_in_sym<1>(getV<0>(vd),vd,cl,pse_ker,APPLYKER_PAIR_ANTISYMMETRIC);
+
+ * \endcode
+ *
+ * \tparam prp property where to store the result
+ *
+ * \param va expression (evaluated on the real and the ghost particles)
+ * \param vd particle set
+ * \param cl symmetric Cell-list (vd.getCellListSym)
+ * \param ker kernel, ker.value(p,q,va(p),va(q))
+ * \param pair APPLYKER_PAIR_SYMMETRIC or APPLYKER_PAIR_ANTISYMMETRIC
+ *
+ */
+template<unsigned int prp, typename exp, typename NN, typename Kernel, typename vector_type>
+inline void applyKernel_in_sym(const exp & va, vector_type & vd, NN & cl, Kernel & ker, int pair)
+{
+	apply_kernel_sym_impl<prp>(vd,cl,apply_kernel_pair_in<vector_type,exp,Kernel>{vd,va,ker},pair);
+}
+
+/*! \brief Apply a kernel as applyKernel_in_gen, computing every pair only once (Newton's third law)
+ *
+ * See applyKernel_in_sym
+ *
+ * \tparam prp property where to store the result
+ *
+ * \param va expression (evaluated on the real and the ghost particles)
+ * \param vd particle set
+ * \param cl symmetric Cell-list (vd.getCellListSym)
+ * \param ker kernel, ker.value(p,q,va(p),va(q),vd) with p and q the particle indexes
+ * \param pair APPLYKER_PAIR_SYMMETRIC or APPLYKER_PAIR_ANTISYMMETRIC
+ *
+ */
+template<unsigned int prp, typename exp, typename NN, typename Kernel, typename vector_type>
+inline void applyKernel_in_gen_sym(const exp & va, vector_type & vd, NN & cl, Kernel & ker, int pair)
+{
+	apply_kernel_sym_impl<prp>(vd,cl,apply_kernel_pair_in_gen<vector_type,exp,Kernel>{vd,va,ker},pair);
+}
+
+/*! \brief Apply a kernel as applyKernel_in_sim, computing every pair only once (Newton's third law)
+ *
+ * See applyKernel_in_sym
+ *
+ * \tparam prp property where to store the result
+ *
+ * \param vd particle set
+ * \param cl symmetric Cell-list (vd.getCellListSym)
+ * \param ker kernel, ker.value(p,q)
+ * \param pair APPLYKER_PAIR_SYMMETRIC or APPLYKER_PAIR_ANTISYMMETRIC
+ *
+ */
+template<unsigned int prp, typename NN, typename Kernel, typename vector_type>
+inline void applyKernel_in_sim_sym(vector_type & vd, NN & cl, Kernel & ker, int pair)
+{
+	apply_kernel_sym_impl<prp>(vd,cl,apply_kernel_pair_in_sim<vector_type,Kernel>{vd,ker},pair);
+}
+
 #endif /* OPENFPM_NUMERICS_SRC_OPERATORS_VECTOR_VECTOR_DIST_OPERATORS_APPLY_KERNEL_HPP_ */
@@ -33,6 +33,140 @@ BOOST_AUTO_TEST_CASE( vector_dist_operators_apply_kernel_test )
 	check_all_apply_ker<comp_host>::check(vd);
 }
 
+BOOST_AUTO_TEST_CASE( vector_dist_operators_apply_kernel_sym_test )
+{
+	if (create_vcluster().getProcessingUnits() > 3)
+		return;
+
+	Box<3,float> box({0.0,0.0,0.0},{1.0,1.0,1.0});
+
+	// Boundary conditions
+	size_t bc[3]={PERIODIC,PERIODIC,PERIODIC};
+
+	// ghost
+	Ghost<3,float> ghost(0.05);
+
+	vector_dist<3,float,aggregate<float,float,float,VectorS<3,float>,VectorS<3,float>,VectorS<3,float>,float>> vd(512,box,bc,ghost);
+
+	fill_values<comp_host>(vd);
+
+	vd.map();
+	vd.template ghost_get<0,1,2,3,4,5,6>();
+
+	auto vA = getV<A>(vd);
+	auto vB = getV<B>(vd);
+	auto vVB = getV<VB>(vd);
+	auto vVC = getV<VC>(vd);
+
+	auto cl = vd.getCellList(0.05);
+	auto cl_sym = vd.getCellListSym(0.05);
+
+	exp_kernel ker(0.2);
+
+	// the exponential kernel is symmetric, every pair is computed once
+	vA = applyKernel_in(vVC * vVB + norm(vVB),vd,cl,ker);
+	applyKernel_in_sym<TA>(vVC * vVB + norm(vVB),vd,cl_sym,ker,APPLYKER_PAIR_SYMMETRIC);
+
+	vB = applyKernel_in_gen(vVC * vVB + norm(vVB),vd,cl,ker);
+
+	bool ret = true;
+	auto it = vd.getDomainIterator();
+	while (it.isNext())
+	{
+		auto p = it.get();
+
+		float ref = vd.template getProp<A>(p);
+		ret &= fabs(vd.template getProp<TA>(p) - ref) <= 1e-4*(1.0 + fabs(ref));
+		ret &= fabs(vd.template getProp<B>(p) - ref) <= 1e-4*(1.0 + fabs(ref));
+
+		++it;
+	}
+
+	applyKernel_in_gen_sym<TA>(vVC * vVB + norm(vVB),vd,cl_sym,ker,APPLYKER_PAIR_SYMMETRIC);
+
+	auto it2 = vd.getDomainIterator();
+	while (it2.isNext())
+	{
+		auto p = it2.get();
+
+		float ref = vd.template getProp<A>(p);
+		ret &= fabs(vd.template getProp<TA>(p) - ref) <= 1e-4*(1.0 + fabs(ref));
+
+		++it2;
+	}
+
+	BOOST_REQUIRE_EQUAL(ret,true);
+}
+
+BOOST_AUTO_TEST_CASE( vector_dist_operators_apply_kernel_verlet_test )
+{
+	if (create_vcluster().getProcessingUnits() > 3)
+		return;
+
+	Box<3,float> box({0.0,0.0,0.0},{1.0,1.0,1.0});
+
+	// Boundary conditions
+	size_t bc[3]={PERIODIC,PERIODIC,PERIODIC};
+
+	// ghost
+	Ghost<3,float> ghost(0.1);
+
+	vector_dist<3,float,aggregate<float,float,float,VectorS<3,float>,VectorS<3,float>,VectorS<3,float>,float>> vd(512,box,bc,ghost);
+
+	fill_values<comp_host>(vd);
+
+	vd.map();
+	vd.template ghost_get<0,1,2,3,4,5,6>();
+
+	auto vA = getV<A>(vd);
+	auto vB = getV<B>(vd);
+	auto vVB = getV<VB>(vd);
+	auto vVC = getV<VC>(vd);
+
+	// the list is built once and used by all the applications
+	auto vl = vd.getVerletList(0.1);
+
+	exp_kernel ker(0.2);
+
+	vA = applyKernel_in(vVC * vVB + norm(vVB),vd,vl,ker);
+	vB = applyKernel_in_gen(vVC * vVB + norm(vVB),vd,vl,ker);
+
+	bool ret = true;
+	auto it = vd.getDomainIterator();
+	while (it.isNext())
+	{
+		auto p = it.get();
+
+		Point<3,float> xp = vd.getPos(p);
+		float prp_p = vd.template getProp<VC>(p) * vd.template getProp<VB>(p) + norm(vd.template getProp<VB>(p));
+
+		float ref = 0.0;
+
+		auto NN = vl.getNNIterator(p.getKey());
+		while (NN.isNext())
+		{
+			auto q = NN.get();
+
+			if (q != p.getKey())
+			{
+				Point<3,float> xq = vd.getPos(q);
+				float prp_q = vd.template getProp<VC>(q) * vd.template getProp<VB>(q) + norm(vd.template getProp<VB>(q));
+
+				ref += ker.value(xp,xq,prp_p,prp_q);
+			}
+
+			++NN;
+		}
+
+		ret &= fabs(vd.template getProp<A>(p) - ref) <= 1e-4*(1.0 + fabs(ref));
+		ret &= fabs(vd.template getProp<B>(p) - ref) <= 1e-4*(1.0 + fabs(ref));
+
+		++it;
+	}
+
+	BOOST_REQUIRE_EQUAL(ret,true);
+}
+
 BOOST_AUTO_TEST_SUITE_END()
 
 
@@ -52,5 +52,62 @@ BOOST_AUTO_TEST_CASE( vector_dist_operators_apply_kernel_gpu_test )
 	check_all_apply_ker<comp_dev>::check(vd);
 }
 
+BOOST_AUTO_TEST_CASE( vector_dist_operators_apply_kernel_nn_list_gpu_test )
+{
+	if (create_vcluster().getProcessingUnits() > 3)
+		return;
+
+	Box<3,float> box({0.0,0.0,0.0},{1.0,1.0,1.0});
+
+	// Boundary conditions
+	size_t bc[3]={PERIODIC,PERIODIC,PERIODIC};
+
+	// ghost
+	Ghost<3,float> ghost(0.05);
+
+	vector_dist_gpu<3,float,aggregate<float,float,float,VectorS<3,float>,VectorS<3,float>,VectorS<3,float>,float>> vd(512,box,bc,ghost);
+
+	auto vA = getV<A,comp_dev>(vd);
+	auto vB = getV<B,comp_dev>(vd);
+	auto vTA = getV<TA,comp_dev>(vd);
+	auto vVB = getV<VB,comp_dev>(vd);
+	auto vVC = getV<VC,comp_dev>(vd);
+
+	fill_values<comp_dev>(vd);
+
+	vd.map(RUN_ON_DEVICE);
+	vd.template ghost_get<0,1,2,3,4,5,6>(RUN_ON_DEVICE);
+
+	auto cl = vd.template getCellListGPU(0.05);
+	vd.updateCellListGPU(cl);
+
+	// with a negative cut-off the list contain the same neighborhood of the Cell-list
+	vector_dist_nn_list_gpu nn;
+	nn.build(vd,cl,-1.0);
+
+	exp_kernel ker(0.2);
+
+	vA = applyKernel_in_gen(vVC * vVB + norm(vVB),vd,cl,ker);
+	vB = applyKernel_in_gen(vVC * vVB + norm(vVB),vd,nn,ker);
+	vTA = applyKernel_in(vVC * vVB + norm(vVB),vd,nn,ker);
+
+	vd.template deviceToHostProp<A,B,TA>();
+
+	bool ret = true;
+	auto it = vd.getDomainIterator();
+	while (it.isNext())
+	{
+		auto p = it.get();
+
+		float ref = vd.template getProp<A>(p);
+		ret &= fabs(vd.template getProp<B>(p) - ref) <= 1e-4*(1.0 + fabs(ref));
+		ret &= fabs(vd.template getProp<TA>(p) - ref) <= 1e-4*(1.0 + fabs(ref));
+
+		++it;
+	}
+
+	BOOST_REQUIRE_EQUAL(ret,true);
+}
+
 BOOST_AUTO_TEST_SUITE_END()
 
@@ -12,6 +12,13 @@
 #include "cuda/vector_dist_operators_cuda.cuh"
 #endif
 
+#include <limits>
+#include <vector>
+#include <memory>
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
 
 /*! A macro to define single value function specialization that apply the function component-wise
  *
@@ -265,12 +272,43 @@ CREATE_VDIST_ARG2_FUNC(pmul,pmul,VECT_PMUL)
 
 ////////// Special function reduce /////////////////////////
 
+#ifdef __NVCC__
+
+//! device functor of a reduction
+template<unsigned int red_op, typename T>
+struct vector_reduce_gpu_op
+{
+	typedef gpu::plus_t<T> type;
+};
+
+//! device functor of a max reduction (norm_inf reduce the max and the min)
+template<typename T>
+struct vector_reduce_gpu_op<VECT_MAX_REDUCE,T>
+{
+	typedef gpu::maximum_t<T> type;
+};
+
+//! device functor of a min reduction
+template<typename T>
+struct vector_reduce_gpu_op<VECT_MIN_REDUCE,T>
+{
+	typedef gpu::minimum_t<T> type;
+};
+
+template<typename T>
+struct vector_reduce_gpu_op<VECT_NORM_INF,T>
+{
+	typedef gpu::maximum_t<T> type;
+};
+
+#endif
+
 template<typename val_type, bool is_scalar = is_Point<val_type>::type::value>
 struct point_scalar_process
 {
 	typedef aggregate<val_type> type;
 
-	template<typename vector_type, typename expression>
+	template<unsigned int red_op, typename vector_type, typename expression>
 	static void process(val_type & val, vector_type & ve, expression & o1)
 	{
 #ifdef __NVCC__
@@ -282,11 +320,23 @@ struct point_scalar_process
 
 		auto & v_cl = create_vcluster<CudaMemory>();
 
-		openfpm::reduce((val_type *)ve.template getDeviceBuffer<0>(), ve.size(), (val_type *)(exp_tmp2[0].getDevicePointer()), gpu::plus_t<val_type>(), v_cl.getGpuContext());
+		openfpm::reduce((val_type *)ve.template getDeviceBuffer<0>(), ve.size(), (val_type *)(exp_tmp2[0].getDevicePointer()), typename vector_reduce_gpu_op<red_op,val_type>::type(), v_cl.getGpuContext());
 
 		exp_tmp2[0].deviceToHost();
 
 		val = *(val_type *)(exp_tmp2[0].getPointer());
+
+		if (red_op == VECT_NORM_INF)
+		{
+			// the biggest absolute value is the max or the min
+			openfpm::reduce((val_type *)ve.template getDeviceBuffer<0>(), ve.size(), (val_type *)(exp_tmp2[0].getDevicePointer()), gpu::minimum_t<val_type>(), v_cl.getGpuContext());
+
+			exp_tmp2[0].deviceToHost();
+
+			val_type val_min = *(val_type *)(exp_tmp2[0].getPointer());
+
+			val = (fabs(val_min) > fabs(val))?fabs(val_min):fabs(val);
+		}
 #else
 		std::cout << __FILE__ << ":" << __LINE__ << " error: to make expression work on GPU the file must be compiled on GPU" << std::endl;
 #endif
@@ -298,7 +348,8 @@ struct point_scalar_process<val_type,true>
 {
 	typedef val_type type;
 
-	template<typename vector_type, typename expression>
+	//! for Point only the sum is supported (component-wise)
+	template<unsigned int red_op, typename vector_type, typename expression>
 	static void process(val_type & val, vector_type & ve, expression & o1)
 	{
 #ifdef __NVCC__
@@ -338,10 +389,139 @@ struct point_scalar_process<val_type,true>
 };
 
 
+/*! \brief Identity and combination of the reductions
+ *
+ * \tparam red_op reduction (VECT_SUM_REDUCE, VECT_MAX_REDUCE, VECT_MIN_REDUCE, VECT_NORM_INF)
+ *
+ */
+template<unsigned int red_op>
+struct vector_reduce_op
+{
+	template<typename T> static inline void identity(T & v)
+	{v = 0;}
+
+	template<typename T, typename S> static inline void combine(T & v, const S & s)
+	{v += s;}
+
+	//! merge two partial reductions
+	template<typename T> static inline void merge(T & v, const T & s)
+	{v += s;}
+};
+
+template<>
+struct vector_reduce_op<VECT_MAX_REDUCE>
+{
+	template<typename T> static inline void identity(T & v)
+	{v = std::numeric_limits<T>::lowest();}
+
+	template<typename T, typename S> static inline void combine(T & v, const S & s)
+	{if (s > v) {v = s;}}
+
+	template<typename T> static inline void merge(T & v, const T & s)
+	{combine(v,s);}
+};
+
+template<>
+struct vector_reduce_op<VECT_MIN_REDUCE>
+{
+	template<typename T> static inline void identity(T & v)
+	{v = std::numeric_limits<T>::max();}
+
+	template<typename T, typename S> static inline void combine(T & v, const S & s)
+	{if (s < v) {v = s;}}
+
+	template<typename T> static inline void merge(T & v, const T & s)
+	{combine(v,s);}
+};
+
+template<>
+struct vector_reduce_op<VECT_NORM_INF>
+{
+	template<typename T> static inline void identity(T & v)
+	{v = 0;}
+
+	template<typename T, typename S> static inline void combine(T & v, const S & s)
+	{if (fabs(s) > v) {v = fabs(s);}}
+
+	//! the partial reductions are already absolute values
+	template<typename T> static inline void merge(T & v, const T & s)
+	{if (s > v) {v = s;}}
+};
+
+//! the reduction can be done with an indexed loop over the local particles (vector_dist, not a subset)
+template<typename vtype, typename Sfinae = void>
+struct vector_reduce_indexed: std::false_type {};
+
+template<typename vtype>
+struct vector_reduce_indexed<vtype, typename Void<typename vtype::is_it_a_subset>::type>
+: std::integral_constant<bool,vtype::is_it_a_subset::value == false> {};
+
+/*! \brief Local reduction on the host
+ *
+ * With OpenMP the local particles are split in static chunks, every thread reduce its chunk and the partial
+ * results are combined in thread order
+ *
+ */
+template<bool indexed>
+struct vector_reduce_host
+{
+	template<unsigned int red_op, typename o1_type, typename val_type>
+	static void red(const o1_type & o1, val_type & val)
+	{
+		const auto & orig_v = o1.getVector();
+
+		vector_reduce_op<red_op>::identity(val);
+
+		auto it = orig_v.getDomainIterator();
+
+		while (it.isNext())
+		{
+			auto key = it.get();
+
+			vector_reduce_op<red_op>::combine(val,o1.value(key));
+
+			++it;
+		}
+	}
+};
+
+template<>
+struct vector_reduce_host<true>
+{
+	template<unsigned int red_op, typename o1_type, typename val_type>
+	static void red(const o1_type & o1, val_type & val)
+	{
+		const auto & orig_v = o1.getVector();
+		long int n = orig_v.size_local();
+
+		vector_reduce_op<red_op>::identity(val);
+
+#ifdef _OPENMP
+		std::vector<val_type> part(omp_get_max_threads());
+
+		#pragma omp parallel
+		{
+			int t = omp_get_thread_num();
+			vector_reduce_op<red_op>::identity(part[t]);
+
+			#pragma omp for schedule(static)
+			for (long int i = 0 ; i < n ; i++)
+			{vector_reduce_op<red_op>::combine(part[t],o1.value(vect_dist_key_dx(i)));}
+		}
+
+		for (size_t t = 0 ; t < part.size() ; t++)
+		{vector_reduce_op<red_op>::merge(val,part[t]);}
+#else
+		for (long int i = 0 ; i < n ; i++)
+		{vector_reduce_op<red_op>::combine(val,o1.value(vect_dist_key_dx(i)));}
+#endif
+	}
+};
+
 template<bool is_device>
 struct vector_reduce_selector
 {
-	template<typename o1_type, typename val_type>
+	template<unsigned int red_op, typename o1_type, typename val_type>
 	static void red(o1_type & o1, val_type & val)
 	{
 
@@ -362,7 +542,7 @@ struct vector_reduce_selector
 			ve.setMemory(exp_tmp);
 			ve.resize(orig_v.size_local());
 
-			point_scalar_process<val_type>::process(val,ve,o1);
+			point_scalar_process<val_type>::template process<red_op>(val,ve,o1);
 #else
 			std::cout << __FILE__ << ":" << __LINE__ << " error, to use expression on GPU you must compile with nvcc compiler " << std::endl;
 #endif
@@ -372,37 +552,31 @@ struct vector_reduce_selector
 template<>
 struct vector_reduce_selector<false>
 {
-	template<typename o1_type, typename val_type>
+	template<unsigned int red_op, typename o1_type, typename val_type>
 	static void red(o1_type & o1, val_type & val)
 	{
-			const auto & orig_v = o1.getVector();
-
 			o1.init();
 
-			val = 0.0;
-
-			auto it = orig_v.getDomainIterator();
+			typedef typename std::remove_const<typename std::remove_reference<decltype(o1.getVector())>::type>::type vtype;
 
-			while (it.isNext())
-			{
-				auto key = it.get();
-
-				val += o1.value(key);
-
-				++it;
-			}
+			vector_reduce_host<vector_reduce_indexed<vtype>::value>::template red<red_op>(o1,val);
 	}
 };
 
-/*! \brief expression that encapsulate a vector reduction expression
+/*! \brief expression that encapsulate a reduction of an expression over the local particles
+ *
+ * The reduction is calculated in init (in parallel, on the host with OpenMP or on the device) and the expression
+ * return the reduced value on every particle. The reduction is local on the processor, global_reduce do the
+ * reduction across processors
  *
  * \tparam exp1 expression 1
- * \tparam vector_type type of vector on which the expression is acting
+ * \tparam red_op reduction
  *
  */
-template <typename exp1>
-class vector_dist_expression_op<exp1,void,VECT_SUM_REDUCE>
+template <typename exp1, unsigned int red_op>
+class vector_dist_reduce_expression
 {
+protected:
 
 	//! expression on which apply the reduction
 	const exp1 o1;
@@ -425,15 +599,15 @@ public:
 	typedef typename nn_type_result<typename exp1::NN_type,void>::type NN_type;
 
 	//! constructor from an epxression exp1 and a vector vd
-	vector_dist_expression_op(const exp1 & o1)
+	vector_dist_reduce_expression(const exp1 & o1)
 	:o1(o1),val(0)
 	{}
 
-	//! sum reduction require initialization where we calculate the reduction
+	//! reduction require initialization where we calculate the reduction
 	// this produce a cache for the calculated value
 	inline void init() const
 	{
-		vector_reduce_selector<exp1::is_ker::value>::red(o1,val);
+		vector_reduce_selector<exp1::is_ker::value>::template red<red_op>(o1,val);
 	}
 
 	/*! \brief get the NN object
@@ -454,35 +628,110 @@ public:
 	}
 
 	//! it return the result of the expression (precalculated before)
-	template<typename r_type= typename std::remove_reference<rtype>::type > 
+	template<typename r_type= typename std::remove_reference<rtype>::type >
 	__device__ __host__ inline r_type value(const vect_dist_key_dx & key) const
 	{
 		return val;
 	}
 
-        /*! \brief Return the vector on which is acting
-        *
-        * It return the vector used in getVExpr, to get this object
-        *
-        * \return the vector
-        *
-        */
-        vtype & getVector()
-        {
-                return o1.getVector();
-        }
-
-        /*! \brief Return the vector on which is acting
-        *
-        * It return the vector used in getVExpr, to get this object
-        *
-        * \return the vector
-        *
-        */
-        const vtype & getVector() const
-        {
-                return o1.getVector();
-        }	
+	//! it return the local reduction (precalculated before), used also for ODEINT
+	template<typename r_type= typename std::remove_reference<rtype>::type > inline r_type getReduction() const
+	{
+		return val;
+	}
+
+	/*! \brief Return the vector on which is acting
+	*
+	* It return the vector used in getVExpr, to get this object
+	*
+	* \return the vector
+	*
+	*/
+	vtype & getVector()
+	{
+		return o1.getVector();
+	}
+
+	/*! \brief Return the vector on which is acting
+	*
+	* It return the vector used in getVExpr, to get this object
+	*
+	* \return the vector
+	*
+	*/
+	const vtype & getVector() const
+	{
+		return o1.getVector();
+	}
+};
+
+//! expression that encapsulate a sum reduction
+template <typename exp1>
+class vector_dist_expression_op<exp1,void,VECT_SUM_REDUCE> : public vector_dist_reduce_expression<exp1,VECT_SUM_REDUCE>
+{
+public:
+
+	//! constructor from an epxression exp1
+	vector_dist_expression_op(const exp1 & o1)
+	:vector_dist_reduce_expression<exp1,VECT_SUM_REDUCE>(o1)
+	{}
+};
+
+//! expression that encapsulate a max reduction
+template <typename exp1>
+class vector_dist_expression_op<exp1,void,VECT_MAX_REDUCE> : public vector_dist_reduce_expression<exp1,VECT_MAX_REDUCE>
+{
+public:
+
+	//! constructor from an epxression exp1
+	vector_dist_expression_op(const exp1 & o1)
+	:vector_dist_reduce_expression<exp1,VECT_MAX_REDUCE>(o1)
+	{}
+};
+
+//! expression that encapsulate a min reduction
+template <typename exp1>
+class vector_dist_expression_op<exp1,void,VECT_MIN_REDUCE> : public vector_dist_reduce_expression<exp1,VECT_MIN_REDUCE>
+{
+public:
+
+	//! constructor from an epxression exp1
+	vector_dist_expression_op(const exp1 & o1)
+	:vector_dist_reduce_expression<exp1,VECT_MIN_REDUCE>(o1)
+	{}
+};
+
+/*! \brief expression that encapsulate the L2 norm of an expression, sqrt of the sum of the squares
+ *
+ * exp1 is the square of the expression (built by rnorm2), the local reduction is the sum of the squares
+ *
+ */
+template <typename exp1>
+class vector_dist_expression_op<exp1,void,VECT_NORM2_REDUCE> : public vector_dist_reduce_expression<exp1,VECT_SUM_REDUCE>
+{
+	//! base
+	typedef vector_dist_reduce_expression<exp1,VECT_SUM_REDUCE> base;
+
+public:
+
+	//! constructor from an epxression exp1
+	vector_dist_expression_op(const exp1 & o1)
+	:base(o1)
+	{}
+
+	//! it return the result of the expression
+	inline typename std::remove_reference<typename base::rtype>::type get()
+	{
+		base::init();
+		return value(vect_dist_key_dx());
+	}
+
+	//! it return the norm (precalculated before)
+	template<typename r_type= typename std::remove_reference<typename base::rtype>::type >
+	__device__ __host__ inline r_type value(const vect_dist_key_dx & key) const
+	{
+		return sqrt(base::val);
+	}
 };
 
 //! Reduce function (it generate an expression)
@@ -505,6 +754,64 @@ rsum(const vector_dist_expression<prp1,v1> & va)
 	return exp_sum;
 }
 
+//! Max reduction (it generate an expression)
+template<typename exp1, typename exp2_, unsigned int op1>
+inline vector_dist_expression_op<vector_dist_expression_op<exp1,exp2_,op1>,void,VECT_MAX_REDUCE>
+rmax(const vector_dist_expression_op<exp1,exp2_,op1> & va)
+{
+	vector_dist_expression_op<vector_dist_expression_op<exp1,exp2_,op1>,void,VECT_MAX_REDUCE> exp_max(va);
+
+	return exp_max;
+}
+
+//! Max reduction (It generate an expression)
+template<unsigned int prp1, typename v1>
+inline vector_dist_expression_op<vector_dist_expression<prp1,v1>,void,VECT_MAX_REDUCE>
+rmax(const vector_dist_expression<prp1,v1> & va)
+{
+	vector_dist_expression_op<vector_dist_expression<prp1,v1>,void,VECT_MAX_REDUCE> exp_max(va);
+
+	return exp_max;
+}
+
+//! Min reduction (it generate an expression)
+template<typename exp1, typename exp2_, unsigned int op1>
+inline vector_dist_expression_op<vector_dist_expression_op<exp1,exp2_,op1>,void,VECT_MIN_REDUCE>
+rmin(const vector_dist_expression_op<exp1,exp2_,op1> & va)
+{
+	vector_dist_expression_op<vector_dist_expression_op<exp1,exp2_,op1>,void,VECT_MIN_REDUCE> exp_min(va);
+
+	return exp_min;
+}
+
+//! Min reduction (It generate an expression)
+template<unsigned int prp1, typename v1>
+inline vector_dist_expression_op<vector_dist_expression<prp1,v1>,void,VECT_MIN_REDUCE>
+rmin(const vector_dist_expression<prp1,v1> & va)
+{
+	vector_dist_expression_op<vector_dist_expression<prp1,v1>,void,VECT_MIN_REDUCE> exp_min(va);
+
+	return exp_min;
+}
+
+//! L2 norm reduction of a scalar expression, sqrt of the sum of the squares (it generate an expression)
+template<typename exp1, typename exp2_, unsigned int op1>
+inline auto rnorm2(const vector_dist_expression_op<exp1,exp2_,op1> & va) -> vector_dist_expression_op<decltype(va*va),void,VECT_NORM2_REDUCE>
+{
+	vector_dist_expression_op<decltype(va*va),void,VECT_NORM2_REDUCE> exp_n2(va*va);
+
+	return exp_n2;
+}
+
+//! L2 norm reduction of a scalar property, sqrt of the sum of the squares (it generate an expression)
+template<unsigned int prp1, typename v1>
+inline auto rnorm2(const vector_dist_expression<prp1,v1> & va) -> vector_dist_expression_op<decltype(va*va),void,VECT_NORM2_REDUCE>
+{
+	vector_dist_expression_op<decltype(va*va),void,VECT_NORM2_REDUCE> exp_n2(va*va);
+
+	return exp_n2;
+}
+
 namespace openfpm
 {
 	/*! \brief General distance formula
@@ -521,161 +828,327 @@ namespace openfpm
 /*! \brief expression that encapsulate a vector Norm INF expression
  *
  * \tparam exp1 expression 1
- * \tparam vector_type type of vector on which the expression is acting
  *
  */
 template <typename exp1>
-class vector_dist_expression_op<exp1,void,VECT_NORM_INF>
+class vector_dist_expression_op<exp1,void,VECT_NORM_INF> : public vector_dist_reduce_expression<exp1,VECT_NORM_INF>
 {
+public:
 
-    //! expression on which apply the reduction
-    const exp1 o1;
+	//! constructor from an epxression exp1
+	vector_dist_expression_op(const exp1 & o1)
+	:vector_dist_reduce_expression<exp1,VECT_NORM_INF>(o1)
+	{}
+};
 
-    //! return type of this expression
-    typedef typename apply_kernel_rtype<decltype(o1.value(vect_dist_key_dx()))>::rtype rtype;
+//! Reduce function (it generate an expression)
+template<typename exp1, typename exp2_, unsigned int op1>
+inline vector_dist_expression_op<vector_dist_expression_op<exp1,exp2_,op1>,void,VECT_NORM_INF>
+norm_inf(const vector_dist_expression_op<exp1,exp2_,op1> & va)
+{
+    vector_dist_expression_op<vector_dist_expression_op<exp1,exp2_,op1>,void,VECT_NORM_INF> exp_sum(va);
 
-    //! return type of the calculated value (without reference)
-    mutable typename std::remove_reference<rtype>::type val;
+    return exp_sum;
+}
 
-public:
+//! Reduce function (It generate an expression)
+template<unsigned int prp1, typename v1>
+inline vector_dist_expression_op<vector_dist_expression<prp1,v1>,void,VECT_NORM_INF>
+norm_inf(const vector_dist_expression<prp1,v1> & va)
+{
+    vector_dist_expression_op<vector_dist_expression<prp1,v1>,void,VECT_NORM_INF> exp_sum(va);
 
-    //! Indicate if it is an in kernel expression
-    typedef typename exp1::is_ker is_ker;
+    return exp_sum;
+}
 
-    //! return the vector type on which this expression operate
-    typedef typename vector_result<typename exp1::vtype,void>::type vtype;
+/*! \brief Reduction across processors of a reduction expression
+ *
+ * local calculate the local reduction, push queue the collective (it is executed by Vcluster::execute) and
+ * finalize complete the result
+ *
+ */
+template<typename red_type>
+struct global_reduce_impl
+{};
 
-    //! NN_type
-    typedef typename nn_type_result<typename exp1::NN_type,void>::type NN_type;
+template<typename exp1>
+struct global_reduce_impl<vector_dist_expression_op<exp1,void,VECT_SUM_REDUCE>>
+{
+	template<typename T, typename red_type> static void local(T & out, const red_type & r)
+	{r.init(); out = r.getReduction();}
 
-    //! constructor from an epxression exp1 and a vector vd
-    vector_dist_expression_op(const exp1 & o1)
-            :o1(o1),val(0)
-    {}
+	template<typename T> static void push(T & out)
+	{create_vcluster().sum(out);}
 
-    //! sum reduction require initialization where we calculate the reduction
-    // this produce a cache for the calculated value
-    inline void init() const
-    {
-        if (exp1::is_ker::value == true)
-        {
+	template<typename T> static void finalize(T & out)
+	{}
+};
 
-#ifdef __NVCC__
-            typedef decltype(val) val_type;
+template<typename exp1>
+struct global_reduce_impl<vector_dist_expression_op<exp1,void,VECT_MAX_REDUCE>>
+{
+	template<typename T, typename red_type> static void local(T & out, const red_type & r)
+	{r.init(); out = r.getReduction();}
 
-			// we have to do it on GPU
+	template<typename T> static void push(T & out)
+	{create_vcluster().max(out);}
 
-			openfpm::vector<typename point_scalar_process<val_type>::type,
-							CudaMemory,
-							memory_traits_inte,
-							openfpm::grow_policy_identity> ve;
+	template<typename T> static void finalize(T & out)
+	{}
+};
 
-			auto & orig_v = o1.getVector();
+template<typename exp1>
+struct global_reduce_impl<vector_dist_expression_op<exp1,void,VECT_MIN_REDUCE>>
+{
+	//! the min is the max of the opposite
+	template<typename T, typename red_type> static void local(T & out, const red_type & r)
+	{r.init(); out = -r.getReduction();}
 
-			if (exp_tmp.ref() == 0)
-			{exp_tmp.incRef();}
+	template<typename T> static void push(T & out)
+	{create_vcluster().max(out);}
 
-			ve.setMemory(exp_tmp);
-			ve.resize(orig_v.size_local());
+	template<typename T> static void finalize(T & out)
+	{out = -out;}
+};
 
-			point_scalar_process<val_type>::process(val,ve,o1);
-#else
-            std::cout << __FILE__ << ":" << __LINE__ << " error, to use expression on GPU you must compile with nvcc compiler " << std::endl;
+template<typename exp1>
+struct global_reduce_impl<vector_dist_expression_op<exp1,void,VECT_NORM_INF>>
+{
+	template<typename T, typename red_type> static void local(T & out, const red_type & r)
+	{r.init(); out = r.getReduction();}
+
+	template<typename T> static void push(T & out)
+	{create_vcluster().max(out);}
+
+	template<typename T> static void finalize(T & out)
+	{}
+};
+
+template<typename exp1>
+struct global_reduce_impl<vector_dist_expression_op<exp1,void,VECT_NORM2_REDUCE>>
+{
+	//! the sum of the squares is reduced, the square root is taken at the end
+	template<typename T, typename red_type> static void local(T & out, const red_type & r)
+	{r.init(); out = r.getReduction();}
+
+	template<typename T> static void push(T & out)
+	{create_vcluster().sum(out);}
+
+	template<typename T> static void finalize(T & out)
+	{out = sqrt(out);}
+};
+
+//! calculate the local reductions and queue the collectives (end of the recursion)
+inline void global_reduce_push()
+{}
+
+//! calculate the local reductions and queue the collectives
+template<typename T, typename red_type, typename ... args_type>
+inline void global_reduce_push(T & out, const red_type & r, args_type && ... args)
+{
+	global_reduce_impl<red_type>::local(out,r);
+	global_reduce_impl<red_type>::push(out);
+
+	global_reduce_push(args ...);
+}
+
+//! complete the reductions (end of the recursion)
+inline void global_reduce_finalize()
+{}
+
+//! complete the reductions
+template<typename T, typename red_type, typename ... args_type>
+inline void global_reduce_finalize(T & out, const red_type & r, args_type && ... args)
+{
+	global_reduce_impl<red_type>::finalize(out);
+
+	global_reduce_finalize(args ...);
+}
+
+/*! \brief Global reductions of several expressions with one synchronization
+ *
+ * The arguments are pairs result, reduction expression (rsum, rmax, rmin, norm_inf, rnorm2 of scalar
+ * expressions). Every local reduction is calculated in parallel (OpenMP on the host, on the device for GPU vectors),
+ * then all the collectives are queued and completed with a single Vcluster::execute
+ *
+ * \code{.cpp}
+
+   double mass, err_inf, err_l2, u_max;
+
+   global_reduce(mass, rsum(rho),
+                 err_inf, norm_inf(u - u_ana),
+                 err_l2, rnorm2(u - u_ana),
+                 u_max, rmax(u));
+
+   double dt = cfl * h / u_max;
+
+ * \endcode
+ *
+ */
+template<typename ... args_type>
+void global_reduce(args_type && ... args)
+{
+	static_assert(sizeof...(args) % 2 == 0,"global_reduce require pairs result, reduction expression");
+
+	global_reduce_push(args ...);
+
+	create_vcluster().execute();
+
+	global_reduce_finalize(args ...);
+}
+
+/*! \brief Expression evaluated once per particle and reused where it appears in the tree
+ *
+ * The copies of the expression (every place where it is used) share a cache with the last particle evaluated and
+ * its value, one for every OpenMP thread. The assignment evaluate all the tree on one particle before moving to the next
+ * one, so the sub-expression is evaluated only the first time it is met on the particle. init() (called at the
+ * beginning of every assignment) invalidate the cache. Only for host expressions
+ *
+ * \tparam exp1 expression to cache
+ *
+ */
+template <typename exp1>
+class vector_dist_expression_op<exp1,void,VECT_CACHE>
+{
+	//! type of the value
+	typedef typename std::remove_const<typename std::remove_reference<decltype(std::declval<const exp1 &>().value(vect_dist_key_dx(0)))>::type>::type r_type;
+
+	//! last particle evaluated by a thread and its value
+	struct cache_slot
+	{
+		//! particle
+		size_t key;
+
+		//! value of the expression on the particle
+		r_type val;
+
+		//! the slots of two threads are not on the same cache line
+		char pad[64];
+	};
+
+	//! expression
+	const exp1 o1;
+
+	//! cache of every thread, shared by all the copies of the expression
+	std::shared_ptr<std::vector<cache_slot>> slots;
+
+public:
+
+	//! Indicate if it is an in kernel expression
+	typedef typename exp1::is_ker is_ker;
+
+	//! return the vector type on which this expression operate
+	typedef typename vector_result<typename exp1::vtype,void>::type vtype;
+
+	//! NN_type
+	typedef typename nn_type_result<typename exp1::NN_type,void>::type NN_type;
+
+	//! constructor from an expression
+	vector_dist_expression_op(const exp1 & o1)
+	:o1(o1),slots(new std::vector<cache_slot>())
+	{}
+
+	/*! \brief get the NN object
+	 *
+	 * \return the NN object
+	 *
+	 */
+	inline NN_type * getNN() const
+	{
+		return nn_type_result<typename exp1::NN_type,void>::getNN(o1);
+	}
+
+	/*! \brief Return the vector on which is acting
+	 *
+	 * \return the vector
+	 *
+	 */
+	const vtype & getVector() const
+	{
+		return o1.getVector();
+	}
+
+	//! initialize the expression tree and invalidate the cache
+	inline void init() const
+	{
+		o1.init();
+
+		size_t n_th = 1;
+#ifdef _OPENMP
+		n_th = omp_get_max_threads();
 #endif
-        }
-        else
-        {
-            const auto & orig_v = o1.getVector();
-
-            o1.init();
-
-            val = 0.0;
-
-            auto it = orig_v.getDomainIterator();
-
-            while (it.isNext())
-            {
-                auto key = it.get();
-                if(fabs(o1.value(key))>val) {
-                    val = fabs(o1.value(key));
-                }
-                ++it;
-            }
-        }
-    }
-
-    /*! \brief get the NN object
-     *
-     * \return the NN object
-     *
-     */
-    inline NN_type * getNN() const
-    {
-        return nn_type_result<typename exp1::NN_type,void>::getNN(o1);
-    }
-
-    //! it return the result of the expression
-    inline typename std::remove_reference<rtype>::type get()
-    {
-        init();
-        return value(vect_dist_key_dx());
-    }
-
-    //! it return the result of the expression (precalculated before)
-    template<typename r_type= typename std::remove_reference<rtype>::type > inline r_type value(const vect_dist_key_dx & key) const
-    {
-        return val;
-    }
-
-    //! it return the result of the expression for ODEINT
-    template<typename r_type= typename std::remove_reference<rtype>::type > inline r_type getReduction() const
-    {
-        return val;
-    }
-
-    /*! \brief Return the vector on which is acting
-    *
-    * It return the vector used in getVExpr, to get this object
-    *
-    * \return the vector
-    *
-    */
-    vtype & getVector()
-    {
-        return o1.getVector();
-    }
-
-    /*! \brief Return the vector on which is acting
-    *
-    * It return the vector used in getVExpr, to get this object
-    *
-    * \return the vector
-    *
-    */
-    const vtype & getVector() const
-    {
-        return o1.getVector();
-    }
+
+		slots->resize(n_th);
+
+		for (size_t i = 0 ; i < slots->size() ; i++)
+		{(*slots)[i].key = (size_t)-1;}
+	}
+
+	//! return the result of the expression, evaluated only the first time on the particle
+	inline r_type value(const vect_dist_key_dx & key) const
+	{
+		size_t th = 0;
+#ifdef _OPENMP
+		th = omp_get_thread_num();
+#endif
+
+		cache_slot & s = (*slots)[th];
+
+		if (s.key != key.getKey())
+		{
+			s.val = o1.value(key);
+			s.key = key.getKey();
+		}
+
+		return s.val;
+	}
+
+	template<typename Sys_eqs, typename pmap_type, typename unordered_map_type, typename coeff_type>
+	inline void value_nz(pmap_type & p_map, const vect_dist_key_dx & key, unordered_map_type & cols, coeff_type & coeff, unsigned int comp) const
+	{
+		o1.template value_nz<Sys_eqs>(p_map,key,cols,coeff,comp);
+	}
 };
 
-//! Reduce function (it generate an expression)
-template<typename exp1, typename exp2_, unsigned int op1>
-inline vector_dist_expression_op<vector_dist_expression_op<exp1,exp2_,op1>,void,VECT_NORM_INF>
-norm_inf(const vector_dist_expression_op<exp1,exp2_,op1> & va)
+/*! \brief Evaluate an expression once per particle where it appears several times in an assignment
+ *
+ * \code{.cpp}
+
+   auto dx_phi = cache(Dx(phi));
+   auto dy_phi = cache(Dy(phi));
+
+   grad2 = dx_phi*dx_phi + dy_phi*dy_phi;
+
+ * \endcode
+ *
+ * \param va expression to cache
+ *
+ * \return an object that encapsulate the expression
+ *
+ */
+template<typename exp1, typename exp2, unsigned int op1>
+inline vector_dist_expression_op<vector_dist_expression_op<exp1,exp2,op1>,void,VECT_CACHE>
+cache(const vector_dist_expression_op<exp1,exp2,op1> & va)
 {
-    vector_dist_expression_op<vector_dist_expression_op<exp1,exp2_,op1>,void,VECT_NORM_INF> exp_sum(va);
+	vector_dist_expression_op<vector_dist_expression_op<exp1,exp2,op1>,void,VECT_CACHE> exp_c(va);
 
-    return exp_sum;
+	return exp_c;
 }
 
-//! Reduce function (It generate an expression)
-template<unsigned int prp1, typename v1>
-inline vector_dist_expression_op<vector_dist_expression<prp1,v1>,void,VECT_NORM_INF>
-norm_inf(const vector_dist_expression<prp1,v1> & va)
+/*! \brief Evaluate an expression once per particle where it appears several times in an assignment
+ *
+ * \param va expression to cache
+ *
+ * \return an object that encapsulate the expression
+ *
+ */
+template<unsigned int p1, typename v1>
+inline vector_dist_expression_op<vector_dist_expression<p1,v1>,void,VECT_CACHE>
+cache(const vector_dist_expression<p1,v1> & va)
 {
-    vector_dist_expression_op<vector_dist_expression<prp1,v1>,void,VECT_NORM_INF> exp_sum(va);
+	vector_dist_expression_op<vector_dist_expression<p1,v1>,void,VECT_CACHE> exp_c(va);
 
-    return exp_sum;
+	return exp_c;
 }
 
 #endif /* OPENFPM_NUMERICS_SRC_OPERATORS_VECTOR_VECTOR_DIST_OPERATORS_FUNCTIONS_HPP_ */
@@ -0,0 +1,208 @@
+/*
+ * vector_dist_operators_pool.hpp
+ *
+ *  Pool of buffers for the temporal expressions (texp_v, texp_v_gpu)
+ */
+
+#ifndef OPENFPM_NUMERICS_SRC_OPERATORS_VECTOR_VECTOR_DIST_OPERATORS_POOL_HPP_
+#define OPENFPM_NUMERICS_SRC_OPERATORS_VECTOR_VECTOR_DIST_OPERATORS_POOL_HPP_
+
+#include <vector>
+
+/*! \brief Pool of buffers for the temporal expressions with internal vector of type vector
+ *
+ * A temporal expression takes its buffer from the pool when it is created and gives it back when it is destroyed,
+ * the buffers keep their memory, so the temporaries of an RHS evaluated every time step are allocated only the
+ * first time. The pool is used only inside a texp_pool_scope, outside the temporaries allocate their own memory
+ * as usual.
+ *
+ * \tparam vector internal vector of the temporal expression
+ *
+ */
+template<typename vector>
+class texp_pool
+{
+	//! buffers, the first n_free are free
+	std::vector<vector> buffers;
+
+	//! number of free buffers
+	size_t n_free = 0;
+
+	//! capacity given to the buffers
+	size_t n_reserve = 0;
+
+	//! number of active scopes
+	size_t n_scopes = 0;
+
+public:
+
+	//! The pool of this type of vector
+	static texp_pool<vector> & get()
+	{
+		static texp_pool<vector> pool;
+
+		return pool;
+	}
+
+	//! Return true if the pool is used
+	bool isActive() const
+	{
+		return n_scopes != 0;
+	}
+
+	//! Start a scope
+	void open()
+	{
+		n_scopes++;
+	}
+
+	//! End a scope
+	void close()
+	{
+		n_scopes--;
+	}
+
+	/*! \brief Set the capacity of the buffers, it never decrease
+	 *
+	 * \param n number of elements
+	 *
+	 */
+	void reserve(size_t n)
+	{
+		if (n <= n_reserve)
+		{return;}
+
+		n_reserve = n;
+
+		for (size_t i = 0 ; i < n_free ; i++)
+		{buffers[i].reserve(n_reserve);}
+	}
+
+	//! capacity given to the buffers
+	size_t getReserve() const
+	{
+		return n_reserve;
+	}
+
+	//! number of buffers in the pool (free or in use)
+	size_t size() const
+	{
+		return buffers.size();
+	}
+
+	//! number of free buffers
+	size_t n_free_buffers() const
+	{
+		return n_free;
+	}
+
+	/*! \brief Give a buffer to v (v must be empty)
+	 *
+	 * \param v vector of the temporal expression
+	 *
+	 */
+	void acquire(vector & v)
+	{
+		if (isActive() == false)
+		{return;}
+
+		if (n_free != 0)
+		{
+			n_free--;
+			v.swap(buffers[n_free]);
+		}
+
+		if (v.capacity() < n_reserve)
+		{v.reserve(n_reserve);}
+	}
+
+	/*! \brief Take back the buffer of v
+	 *
+	 * \param v vector of the temporal expression
+	 *
+	 */
+	void release(vector & v)
+	{
+		if (isActive() == false || v.capacity() == 0)
+		{return;}
+
+		if (n_free == buffers.size())
+		{buffers.emplace_back();}
+
+		v.resize(0);
+		buffers[n_free].swap(v);
+		n_free++;
+	}
+
+	//! Free the memory of the free buffers
+	void clear()
+	{
+		buffers.erase(buffers.begin(),buffers.begin() + n_free);
+		n_free = 0;
+	}
+};
+
+/*! \brief Scope where the temporal expressions with internal vector of type vector use the pool
+ *
+ * The buffers have at least the capacity of the local particles plus the ghost of the particle set, so after a
+ * map() the temporaries are reallocated only if the number of particles exceeds the largest seen.
+ *
+ * \code{.cpp}
+
+   for (size_t i = 0 ; i < n_steps ; i++)
+   {
+       vd.map();
+       vd.ghost_get<0>();
+
+       texp_pool_scope<openfpm::vector<aggregate<double>>> scope(vd);
+
+       texp_v<double> tmp = v1 + v2;
+       v3 = tmp*tmp;
+   }
+
+ * \endcode
+ *
+ * \tparam vector internal vector of the temporal expressions (texp_v<T>::vtype)
+ *
+ */
+template<typename vector>
+class texp_pool_scope
+{
+public:
+
+	//! Start a scope without changing the capacity of the buffers
+	texp_pool_scope()
+	{
+		texp_pool<vector>::get().open();
+	}
+
+	/*! \brief Start a scope
+	 *
+	 * \param vd particle set
+	 *
+	 */
+	template<typename vector_dist_type>
+	texp_pool_scope(vector_dist_type & vd)
+	{
+		texp_pool<vector>::get().open();
+		update(vd);
+	}
+
+	/*! \brief Adjust the capacity of the buffers to the particle set (after a map())
+	 *
+	 * \param vd particle set
+	 *
+	 */
+	template<typename vector_dist_type>
+	void update(vector_dist_type & vd)
+	{
+		texp_pool<vector>::get().reserve(vd.size_local_with_ghost());
+	}
+
+	~texp_pool_scope()
+	{
+		texp_pool<vector>::get().close();
+	}
+};
+
+#endif /* OPENFPM_NUMERICS_SRC_OPERATORS_VECTOR_VECTOR_DIST_OPERATORS_POOL_HPP_ */
@@ -216,6 +216,333 @@ BOOST_AUTO_TEST_CASE( vector_dist_operators_assign_test )
 		   v_pos,v_pos);
 }
 
+BOOST_AUTO_TEST_CASE( vector_dist_operators_host_threads_test )
+{
+	Box<3,float> box({0.0,0.0,0.0},{1.0,1.0,1.0});
+
+	// Boundary conditions
+	size_t bc[3]={PERIODIC,PERIODIC,PERIODIC};
+
+	// ghost
+	Ghost<3,float> ghost(0.05);
+
+	// enough particles to use the threads
+	vector_dist<3,float,aggregate<float,float,float,float,float,float,float,float>> vd(40000,box,bc,ghost);
+
+	auto it = vd.getDomainIterator();
+	while (it.isNext())
+	{
+		auto p = it.get();
+
+		vd.getPos(p)[0] = (float)rand() / (float)RAND_MAX;
+		vd.getPos(p)[1] = (float)rand() / (float)RAND_MAX;
+		vd.getPos(p)[2] = (float)rand() / (float)RAND_MAX;
+
+		vd.template getProp<0>(p) = p.getKey();
+
+		++it;
+	}
+
+	auto v1 = getV<0>(vd);
+	auto v2 = getV<1>(vd);
+	auto v3 = getV<2>(vd);
+	auto v_pos = getV<POS_PROP>(vd);
+
+	v2 = 3.0;
+	v3 = 2.0*v1 + v2 + v_pos[0];
+
+	auto it2 = vd.getDomainIterator();
+	bool ret = true;
+	while (it2.isNext())
+	{
+		auto p = it2.get();
+
+		ret &= vd.template getProp<1>(p) == 3.0f;
+		ret &= fabs(vd.template getProp<2>(p) - (2.0f*p.getKey() + 3.0f + vd.getPos(p)[0])) <= 1e-6*(2.0f*p.getKey() + 4.0f);
+
+		++it2;
+	}
+
+	BOOST_REQUIRE_EQUAL(ret,true);
+}
+
+BOOST_AUTO_TEST_CASE( vector_dist_operators_cache_test )
+{
+	Box<3,float> box({0.0,0.0,0.0},{1.0,1.0,1.0});
+
+	// Boundary conditions
+	size_t bc[3]={PERIODIC,PERIODIC,PERIODIC};
+
+	// ghost
+	Ghost<3,float> ghost(0.05);
+
+	// enough particles to use the threads
+	vector_dist<3,float,aggregate<float,float,float,float>> vd(40000,box,bc,ghost);
+
+	auto it = vd.getDomainIterator();
+	while (it.isNext())
+	{
+		auto p = it.get();
+
+		vd.getPos(p)[0] = (float)rand() / (float)RAND_MAX;
+		vd.getPos(p)[1] = (float)rand() / (float)RAND_MAX;
+		vd.getPos(p)[2] = (float)rand() / (float)RAND_MAX;
+
+		vd.template getProp<0>(p) = (float)rand() / (float)RAND_MAX;
+		vd.template getProp<1>(p) = (float)rand() / (float)RAND_MAX;
+
+		++it;
+	}
+
+	auto v1 = getV<0>(vd);
+	auto v2 = getV<1>(vd);
+	auto v3 = getV<2>(vd);
+	auto v4 = getV<3>(vd);
+
+	auto c = cache(v1 + v2);
+	auto c2 = cache(c*c);
+
+	v3 = c2 + c*v1 - c;
+	v4 = (v1 + v2)*(v1 + v2) + (v1 + v2)*v1 - (v1 + v2);
+
+	bool ret = true;
+	auto it2 = vd.getDomainIterator();
+	while (it2.isNext())
+	{
+		auto p = it2.get();
+
+		ret &= vd.template getProp<2>(p) == vd.template getProp<3>(p);
+
+		++it2;
+	}
+
+	BOOST_REQUIRE_EQUAL(ret,true);
+
+	// the cache is invalidated by the next assignment
+	v1 = 2.0*v1;
+	v3 = c*c;
+	v4 = (v1 + v2)*(v1 + v2);
+
+	auto it3 = vd.getDomainIterator();
+	while (it3.isNext())
+	{
+		auto p = it3.get();
+
+		ret &= vd.template getProp<2>(p) == vd.template getProp<3>(p);
+
+		++it3;
+	}
+
+	BOOST_REQUIRE_EQUAL(ret,true);
+}
+
+BOOST_AUTO_TEST_CASE( vector_dist_operators_pool_test )
+{
+	Box<3,float> box({0.0,0.0,0.0},{1.0,1.0,1.0});
+
+	// Boundary conditions
+	size_t bc[3]={PERIODIC,PERIODIC,PERIODIC};
+
+	// ghost
+	Ghost<3,float> ghost(0.05);
+
+	vector_dist<3,float,aggregate<float,float,float,float>> vd(4096,box,bc,ghost);
+
+	auto it = vd.getDomainIterator();
+	while (it.isNext())
+	{
+		auto p = it.get();
+
+		vd.getPos(p)[0] = (float)rand() / (float)RAND_MAX;
+		vd.getPos(p)[1] = (float)rand() / (float)RAND_MAX;
+		vd.getPos(p)[2] = (float)rand() / (float)RAND_MAX;
+
+		vd.template getProp<0>(p) = (float)rand() / (float)RAND_MAX;
+		vd.template getProp<1>(p) = (float)rand() / (float)RAND_MAX;
+
+		++it;
+	}
+
+	vd.map();
+	vd.ghost_get<0,1>();
+
+	auto v1 = getV<0>(vd);
+	auto v2 = getV<1>(vd);
+	auto v3 = getV<2>(vd);
+	auto v4 = getV<3>(vd);
+
+	typedef texp_v<float>::vtype vtype;
+	auto & pool = texp_pool<vtype>::get();
+
+	size_t n_buffers = 0;
+
+	for (size_t i = 0 ; i < 4 ; i++)
+	{
+		{
+			texp_pool_scope<vtype> scope(vd);
+
+			// the operands of tmp*tmp are copies of tmp, they also use the pool
+			texp_v<float> tmp = v1 + v2;
+			v3 = tmp*tmp;
+
+			BOOST_REQUIRE(tmp.getVector().capacity() >= vd.size_local_with_ghost());
+		}
+
+		// from the second step no buffer is added, the temporaries reuse the ones of the first step
+		if (i == 0)
+		{n_buffers = pool.size();}
+		else
+		{BOOST_REQUIRE_EQUAL(pool.size(),n_buffers);}
+	}
+
+	BOOST_REQUIRE(n_buffers != 0);
+	BOOST_REQUIRE_EQUAL(pool.n_free_buffers(),n_buffers);
+
+	v4 = (v1 + v2)*(v1 + v2);
+
+	bool ret = true;
+	auto it2 = vd.getDomainIterator();
+	while (it2.isNext())
+	{
+		auto p = it2.get();
+
+		ret &= vd.template getProp<2>(p) == vd.template getProp<3>(p);
+
+		++it2;
+	}
+
+	BOOST_REQUIRE_EQUAL(ret,true);
+
+	pool.clear();
+	BOOST_REQUIRE_EQUAL(pool.size(),0ul);
+}
+
+BOOST_AUTO_TEST_CASE( vector_dist_operators_global_reduce_test )
+{
+	Box<3,float> box({0.0,0.0,0.0},{1.0,1.0,1.0});
+
+	// Boundary conditions
+	size_t bc[3]={PERIODIC,PERIODIC,PERIODIC};
+
+	// ghost
+	Ghost<3,float> ghost(0.05);
+
+	vector_dist<3,double,aggregate<double,double>> vd(20000,box,bc,ghost);
+
+	auto & v_cl = create_vcluster();
+
+	double sum = 0.0;
+	double sum2 = 0.0;
+	double mx = -std::numeric_limits<double>::max();
+	double mn = std::numeric_limits<double>::max();
+	double ninf = 0.0;
+
+	auto it = vd.getDomainIterator();
+	while (it.isNext())
+	{
+		auto p = it.get();
+
+		vd.getPos(p)[0] = (double)rand() / (double)RAND_MAX;
+		vd.getPos(p)[1] = (double)rand() / (double)RAND_MAX;
+		vd.getPos(p)[2] = (double)rand() / (double)RAND_MAX;
+
+		double val = sin(0.01*(p.getKey() + 1000*v_cl.rank()));
+		vd.template getProp<0>(p) = val;
+		vd.template getProp<1>(p) = 2.0;
+
+		sum += val;
+		sum2 += val*val;
+		mx = std::max(mx,val);
+		mn = std::min(mn,val);
+		ninf = std::max(ninf,fabs(val));
+
+		++it;
+	}
+
+	v_cl.sum(sum);
+	v_cl.sum(sum2);
+	v_cl.max(mx);
+	v_cl.max(ninf);
+	mn = -mn;
+	v_cl.max(mn);
+	v_cl.execute();
+	mn = -mn;
+
+	auto v1 = getV<0>(vd);
+	auto v2 = getV<1>(vd);
+
+	double g_sum, g_mx, g_mn, g_ninf, g_n2, g_sum_exp;
+
+	global_reduce(g_sum,rsum(v1),
+	              g_mx,rmax(v1),
+	              g_mn,rmin(v1),
+	              g_ninf,norm_inf(v1),
+	              g_n2,rnorm2(v1),
+	              g_sum_exp,rsum(v1*v2));
+
+	BOOST_REQUIRE_CLOSE(g_sum,sum,1e-8);
+	BOOST_REQUIRE_CLOSE(g_sum_exp,2.0*sum,1e-8);
+	BOOST_REQUIRE_EQUAL(g_mx,mx);
+	BOOST_REQUIRE_EQUAL(g_mn,mn);
+	BOOST_REQUIRE_EQUAL(g_ninf,ninf);
+	BOOST_REQUIRE_CLOSE(g_n2,sqrt(sum2),1e-8);
+}
+
+BOOST_AUTO_TEST_CASE( vector_dist_operators_assign_fused_test )
+{
+	if (create_vcluster().getProcessingUnits() > 3)
+		return;
+
+	Box<3,float> box({0.0,0.0,0.0},{1.0,1.0,1.0});
+
+	// Boundary conditions
+	size_t bc[3]={PERIODIC,PERIODIC,PERIODIC};
+
+	// ghost
+	Ghost<3,float> ghost(0.05);
+
+	vector_dist<3,float,aggregate<float,float,float,float,float,float,float,float>> vd(100,box,bc,ghost);
+
+	auto v1 = getV<0>(vd);
+	auto v2 = getV<1>(vd);
+	auto v3 = getV<2>(vd);
+	auto v4 = getV<3>(vd);
+	auto v5 = getV<4>(vd);
+	auto v6 = getV<5>(vd);
+	auto v7 = getV<6>(vd);
+	auto v8 = getV<7>(vd);
+
+	reset(vd);
+
+	float sum = 0.0;
+	float sum2 = 0.0;
+	float mx = 0.0;
+	float ninf = 0.0;
+
+	// more than 8 pairs, the later expressions read the properties written by the previous ones
+	assign(v1,0.0,
+		   v2,1.0,
+		   v3,2.0*v2,
+		   v4,v3 + v2,
+		   v5,4.0,
+		   v6,v5 + v2,
+		   v7,6.0,
+		   v8,v7 + v2,
+		   sum_to(sum),v8,
+		   sum2_to(sum2),v8,
+		   max_to(mx),-v8,
+		   norm_inf_to(ninf),-v8);
+
+	check(vd,8);
+
+	float n = vd.size_local();
+
+	BOOST_REQUIRE_CLOSE(sum,7.0f*n,1e-3);
+	BOOST_REQUIRE_CLOSE(sum2,49.0f*n,1e-3);
+	BOOST_REQUIRE_EQUAL(mx,-7.0f);
+	BOOST_REQUIRE_EQUAL(ninf,7.0f);
+}
+
 BOOST_AUTO_TEST_SUITE_END()
 
 
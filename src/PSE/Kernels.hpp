@@ -9,10 +9,15 @@
 #define OPENFPM_NUMERICS_SRC_PSE_KERNELS_HPP_
 
 #include <boost/math/constants/constants.hpp>
+#include <vector>
+#include <limits>
 
 // Gaussian kernel
 #define KER_GAUSSIAN 1
 
+// Gaussian kernel tabulated in r^2
+#define KER_GAUSSIAN_TAB 2
+
 /*! \brief Implementation of the Laplacian kernels for PSE
  *
  * \tparam dim Dimension
@@ -375,4 +380,488 @@ struct Lap_PSE<1,T,8,KER_GAUSSIAN>
 	}
 };
 
+/*! \brief Polynomial of the Gaussian Laplacian PSE kernels
+ *
+ * The kernel is eta(z) = pi^(-dim/2) exp(-s) P(s) with s = |z|^2, the coefficients of P satisfy the moment
+ * conditions of the Laplacian up to the order ord (J.D. Eldredge, A. Leonard, T. Colonius, J. Comput. Phys. 180 (2002)).
+ * For dim = 1 they are the same of Lap_PSE<1,T,ord,KER_GAUSSIAN>
+ *
+ * \tparam dim Dimension
+ * \tparam ord order of approximation (2,4,6,8)
+ *
+ */
+template<unsigned int dim, unsigned int ord>
+struct lap_pse_gaussian_poly;
+
+template<>
+struct lap_pse_gaussian_poly<1,2>
+{
+	//! P(s)
+	template<typename T> static inline T P(T s)
+	{return T(4.0);}
+
+	//! dP/ds
+	template<typename T> static inline T dP(T s)
+	{return T(0.0);}
+};
+
+template<>
+struct lap_pse_gaussian_poly<1,4>
+{
+	//! P(s)
+	template<typename T> static inline T P(T s)
+	{return T(10.0) + s*(T(-4.0));}
+
+	//! dP/ds
+	template<typename T> static inline T dP(T s)
+	{return T(-4.0);}
+};
+
+template<>
+struct lap_pse_gaussian_poly<1,6>
+{
+	//! P(s)
+	template<typename T> static inline T P(T s)
+	{return T(35.0)/T(2.0) + s*(T(-14.0) + s*(T(2.0)));}
+
+	//! dP/ds
+	template<typename T> static inline T dP(T s)
+	{return T(-14.0) + s*(T(4.0));}
+};
+
+template<>
+struct lap_pse_gaussian_poly<1,8>
+{
+	//! P(s)
+	template<typename T> static inline T P(T s)
+	{return T(105.0)/T(4.0) + s*(T(-63.0)/T(2.0) + s*(T(9.0) + s*(T(-2.0)/T(3.0))));}
+
+	//! dP/ds
+	template<typename T> static inline T dP(T s)
+	{return T(-63.0)/T(2.0) + s*(T(18.0) + s*(T(-2.0)));}
+};
+
+template<>
+struct lap_pse_gaussian_poly<2,2>
+{
+	//! P(s)
+	template<typename T> static inline T P(T s)
+	{return T(4.0);}
+
+	//! dP/ds
+	template<typename T> static inline T dP(T s)
+	{return T(0.0);}
+};
+
+template<>
+struct lap_pse_gaussian_poly<2,4>
+{
+	//! P(s)
+	template<typename T> static inline T P(T s)
+	{return T(12.0) + s*(T(-4.0));}
+
+	//! dP/ds
+	template<typename T> static inline T dP(T s)
+	{return T(-4.0);}
+};
+
+template<>
+struct lap_pse_gaussian_poly<2,6>
+{
+	//! P(s)
+	template<typename T> static inline T P(T s)
+	{return T(24.0) + s*(T(-16.0) + s*(T(2.0)));}
+
+	//! dP/ds
+	template<typename T> static inline T dP(T s)
+	{return T(-16.0) + s*(T(4.0));}
+};
+
+template<>
+struct lap_pse_gaussian_poly<2,8>
+{
+	//! P(s)
+	template<typename T> static inline T P(T s)
+	{return T(40.0) + s*(T(-40.0) + s*(T(10.0) + s*(T(-2.0)/T(3.0))));}
+
+	//! dP/ds
+	template<typename T> static inline T dP(T s)
+	{return T(-40.0) + s*(T(20.0) + s*(T(-2.0)));}
+};
+
+template<>
+struct lap_pse_gaussian_poly<3,2>
+{
+	//! P(s)
+	template<typename T> static inline T P(T s)
+	{return T(4.0);}
+
+	//! dP/ds
+	template<typename T> static inline T dP(T s)
+	{return T(0.0);}
+};
+
+template<>
+struct lap_pse_gaussian_poly<3,4>
+{
+	//! P(s)
+	template<typename T> static inline T P(T s)
+	{return T(14.0) + s*(T(-4.0));}
+
+	//! dP/ds
+	template<typename T> static inline T dP(T s)
+	{return T(-4.0);}
+};
+
+template<>
+struct lap_pse_gaussian_poly<3,6>
+{
+	//! P(s)
+	template<typename T> static inline T P(T s)
+	{return T(63.0)/T(2.0) + s*(T(-18.0) + s*(T(2.0)));}
+
+	//! dP/ds
+	template<typename T> static inline T dP(T s)
+	{return T(-18.0) + s*(T(4.0));}
+};
+
+template<>
+struct lap_pse_gaussian_poly<3,8>
+{
+	//! P(s)
+	template<typename T> static inline T P(T s)
+	{return T(231.0)/T(4.0) + s*(T(-99.0)/T(2.0) + s*(T(11.0) + s*(T(-2.0)/T(3.0))));}
+
+	//! dP/ds
+	template<typename T> static inline T dP(T s)
+	{return T(-99.0)/T(2.0) + s*(T(22.0) + s*(T(-2.0)));}
+};
+
+//! Squared distance of two points
+template<unsigned int dim, typename T>
+inline T lap_pse_dist2(const T (&x)[dim], const T (&y)[dim])
+{
+	T r2 = 0.0;
+	for (size_t i = 0 ; i < dim ; i++)
+		r2 += (x[i] - y[i]) * (x[i] - y[i]);
+	return r2;
+}
+
+//! Squared distance of two points
+template<unsigned int dim, typename T>
+inline T lap_pse_dist2(const T (&x)[dim], const Point<dim,T> & y)
+{
+	T r2 = 0.0;
+	for (size_t i = 0 ; i < dim ; i++)
+		r2 += (x[i] - y.get(i)) * (x[i] - y.get(i));
+	return r2;
+}
+
+//! Squared distance of two points
+template<unsigned int dim, typename T>
+inline T lap_pse_dist2(const Point<dim,T> & x, const T (&y)[dim])
+{
+	return lap_pse_dist2<dim,T>(y,x);
+}
+
+//! Squared distance of two points
+template<unsigned int dim, typename T>
+inline T lap_pse_dist2(const Point<dim,T> & x, const Point<dim,T> & y)
+{
+	T r2 = 0.0;
+	for (size_t i = 0 ; i < dim ; i++)
+		r2 += (x.get(i) - y.get(i)) * (x.get(i) - y.get(i));
+	return r2;
+}
+
+/*! \brief Gaussian Laplacian PSE kernel in dim dimensions
+ *
+ * The kernel is eta_eps(x-y) = eps^(-dim) eta((x-y)/eps) with eta given by lap_pse_gaussian_poly. The kernel depend
+ * only on r^2, value_r2 avoid the square root, the version on an array of r^2 evaluate all the neighborhood of a
+ * particle in one vectorizable loop
+ *
+ * \tparam dim Dimension
+ * \tparam T type
+ * \tparam ord order of approximation (2,4,6,8)
+ *
+ */
+template<unsigned int dim, typename T, unsigned int ord>
+struct Lap_PSE_gaussian
+{
+	T epsilon;
+
+	//! 1/eps^2
+	T inv_eps2;
+
+	//! eps^(-dim) pi^(-dim/2)
+	T fac;
+
+	inline Lap_PSE_gaussian(T epsilon)
+	:epsilon(epsilon),inv_eps2(T(1.0)/epsilon/epsilon),fac(1.0)
+	{
+		for (size_t i = 0 ; i < dim ; i++)
+			fac /= epsilon*boost::math::constants::root_pi<T>();
+	}
+
+	/*! \brief Value of the kernel from the squared distance
+	 *
+	 * \param r2 squared distance |x-y|^2
+	 *
+	 */
+	inline T value_r2(T r2) const
+	{
+		T s = r2*inv_eps2;
+		return fac * exp(-s) * lap_pse_gaussian_poly<dim,ord>::P(s);
+	}
+
+	/*! \brief Value of the kernel for several neighborhood
+	 *
+	 * \param r2 squared distances
+	 * \param ker values of the kernel
+	 * \param n number of the neighborhood
+	 *
+	 */
+	inline void value_r2(const T * r2, T * ker, size_t n) const
+	{
+#ifdef _OPENMP
+		#pragma omp simd
+#endif
+		for (size_t i = 0 ; i < n ; i++)
+		{
+			T s = r2[i]*inv_eps2;
+			ker[i] = fac * exp(-s) * lap_pse_gaussian_poly<dim,ord>::P(s);
+		}
+	}
+
+	/*! \brief From a kernel centered in x, it give the value of the kernel in y
+	 *
+	 * \param x center of the kernel
+	 * \param y where we calculate the kernel
+	 *
+	 */
+	inline T value(T (&x)[dim], T (&y)[dim])
+	{
+		return value_r2(lap_pse_dist2<dim,T>(x,y));
+	}
+
+	/*! \brief From a kernel centered in x, it give the value of the kernel in y
+	 *
+	 * \param x center of the kernel
+	 * \param y where we calculate the kernel
+	 *
+	 */
+	inline T value(T (&x)[dim], const Point<dim,T> & y)
+	{
+		return value_r2(lap_pse_dist2<dim,T>(x,y));
+	}
+
+	/*! \brief From a kernel centered in x, it give the value of the kernel in y
+	 *
+	 * \param x center of the kernel
+	 * \param y where we calculate the kernel
+	 *
+	 */
+	inline T value(const Point<dim,T> & x, T (&y)[dim])
+	{
+		return value_r2(lap_pse_dist2<dim,T>(x,y));
+	}
+
+	/*! \brief From a kernel centered in x, it give the value of the kernel in y
+	 *
+	 * \param x center of the kernel
+	 * \param y where we calculate the kernel
+	 *
+	 */
+	inline T value(const Point<dim,T> & x, const Point<dim,T> & y)
+	{
+		return value_r2(lap_pse_dist2<dim,T>(x,y));
+	}
+};
+
+//! Gaussian Laplacian PSE kernel in 2D, orders 2,4,6,8
+template<typename T, unsigned int ord>
+struct Lap_PSE<2,T,ord,KER_GAUSSIAN>: public Lap_PSE_gaussian<2,T,ord>
+{
+	inline Lap_PSE(T epsilon)
+	:Lap_PSE_gaussian<2,T,ord>(epsilon)
+	{}
+};
+
+//! Gaussian Laplacian PSE kernel in 3D, orders 2,4,6,8
+template<typename T, unsigned int ord>
+struct Lap_PSE<3,T,ord,KER_GAUSSIAN>: public Lap_PSE_gaussian<3,T,ord>
+{
+	inline Lap_PSE(T epsilon)
+	:Lap_PSE_gaussian<3,T,ord>(epsilon)
+	{}
+};
+
+/*! \brief Gaussian Laplacian PSE kernel tabulated in r^2
+ *
+ * exp(-s) P(s) is interpolated with a cubic Hermite polynomial on a uniform grid in s = r^2/eps^2, so the evaluation
+ * need neither exp nor sqrt: an index, a lookup and a Horner evaluation of degree 3. The kernel is zero for
+ * s >= s_max. With the default table (s_max = 36, r = 6 eps, 4096 intervals) the relative error with respect to
+ * KER_GAUSSIAN is below 1e-8
+ *
+ * \code{.cpp}
+
+   Lap_PSE<3,double,4,KER_GAUSSIAN_TAB> lker(eps);
+
+   // r2 of all the neighborhood of a particle
+   lker.value_r2(r2.data(),ker.data(),r2.size());
+
+ * \endcode
+ *
+ * \tparam dim Dimension
+ * \tparam T type
+ * \tparam ord order of approximation (2,4,6,8)
+ *
+ */
+template<unsigned int dim, typename T, unsigned int ord>
+struct Lap_PSE<dim,T,ord,KER_GAUSSIAN_TAB>
+{
+	T epsilon;
+
+	//! 1/eps^2
+	T inv_eps2;
+
+	//! eps^(-dim) pi^(-dim/2)
+	T fac;
+
+	//! s where the kernel is cut
+	T s_max;
+
+	//! 1/ds of the table
+	T inv_ds;
+
+	//! coefficients of the cubic polynomial in every interval
+	std::vector<T> tab;
+
+	/*! \brief Constructor
+	 *
+	 * \param epsilon size of the kernel
+	 * \param s_max cut of the kernel in r^2/eps^2
+	 * \param n_tab number of intervals of the table
+	 *
+	 */
+	Lap_PSE(T epsilon, T s_max = 36.0, size_t n_tab = 4096)
+	:epsilon(epsilon),inv_eps2(T(1.0)/epsilon/epsilon),fac(1.0),s_max(s_max),inv_ds(n_tab/s_max)
+	{
+		for (size_t i = 0 ; i < dim ; i++)
+			fac /= epsilon*boost::math::constants::root_pi<T>();
+
+		T ds = s_max / n_tab;
+		tab.resize(4*n_tab);
+
+		for (size_t i = 0 ; i < n_tab ; i++)
+		{
+			T s0 = i*ds;
+			T s1 = (i+1)*ds;
+
+			T g0 = exp(-s0)*lap_pse_gaussian_poly<dim,ord>::P(s0);
+			T g1 = exp(-s1)*lap_pse_gaussian_poly<dim,ord>::P(s1);
+
+			// derivatives in t = (s - s0)/ds
+			T d0 = ds*exp(-s0)*(lap_pse_gaussian_poly<dim,ord>::dP(s0) - lap_pse_gaussian_poly<dim,ord>::P(s0));
+			T d1 = ds*exp(-s1)*(lap_pse_gaussian_poly<dim,ord>::dP(s1) - lap_pse_gaussian_poly<dim,ord>::P(s1));
+
+			tab[4*i] = fac*g0;
+			tab[4*i+1] = fac*d0;
+			tab[4*i+2] = fac*(T(3.0)*(g1 - g0) - T(2.0)*d0 - d1);
+			tab[4*i+3] = fac*(T(2.0)*(g0 - g1) + d0 + d1);
+		}
+	}
+
+	/*! \brief Value of the kernel from the squared distance
+	 *
+	 * \param r2 squared distance |x-y|^2
+	 *
+	 */
+	inline T value_r2(T r2) const
+	{
+		T s = r2*inv_eps2;
+		if (s >= s_max)
+			return 0.0;
+
+		T u = s*inv_ds;
+		size_t i = (size_t)u;
+		T t = u - i;
+
+		const T * c = &tab[4*i];
+		return c[0] + t*(c[1] + t*(c[2] + t*c[3]));
+	}
+
+	/*! \brief Value of the kernel for several neighborhood
+	 *
+	 * \param r2 squared distances
+	 * \param ker values of the kernel
+	 * \param n number of the neighborhood
+	 *
+	 */
+	inline void value_r2(const T * r2, T * ker, size_t n) const
+	{
+		const T * c = tab.data();
+		T s_cut = s_max*(T(1.0) - std::numeric_limits<T>::epsilon());
+
+#ifdef _OPENMP
+		#pragma omp simd
+#endif
+		for (size_t k = 0 ; k < n ; k++)
+		{
+			T s = r2[k]*inv_eps2;
+			bool in = s < s_max;
+			T u = ((in)?s:s_cut)*inv_ds;
+			size_t i = (size_t)u;
+			T t = u - i;
+
+			T v = c[4*i] + t*(c[4*i+1] + t*(c[4*i+2] + t*c[4*i+3]));
+			ker[k] = (in)?v:T(0.0);
+		}
+	}
+
+	/*! \brief From a kernel centered in x, it give the value of the kernel in y
+	 *
+	 * \param x center of the kernel
+	 * \param y where we calculate the kernel
+	 *
+	 */
+	inline T value(T (&x)[dim], T (&y)[dim])
+	{
+		return value_r2(lap_pse_dist2<dim,T>(x,y));
+	}
+
+	/*! \brief From a kernel centered in x, it give the value of the kernel in y
+	 *
+	 * \param x center of the kernel
+	 * \param y where we calculate the kernel
+	 *
+	 */
+	inline T value(T (&x)[dim], const Point<dim,T> & y)
+	{
+		return value_r2(lap_pse_dist2<dim,T>(x,y));
+	}
+
+	/*! \brief From a kernel centered in x, it give the value of the kernel in y
+	 *
+	 * \param x center of the kernel
+	 * \param y where we calculate the kernel
+	 *
+	 */
+	inline T value(const Point<dim,T> & x, T (&y)[dim])
+	{
+		return value_r2(lap_pse_dist2<dim,T>(x,y));
+	}
+
+	/*! \brief From a kernel centered in x, it give the value of the kernel in y
+	 *
+	 * \param x center of the kernel
+	 * \param y where we calculate the kernel
+	 *
+	 */
+	inline T value(const Point<dim,T> & x, const Point<dim,T> & y)
+	{
+		return value_r2(lap_pse_dist2<dim,T>(x,y));
+	}
+};
+
 #endif /* OPENFPM_NUMERICS_SRC_PSE_KERNELS_HPP_ */
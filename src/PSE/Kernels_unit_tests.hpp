@@ -125,6 +125,97 @@ BOOST_AUTO_TEST_CASE( pse_ker )
 }
 */
 
+/*! \brief Error of the PSE laplacian of sin(x)sin(y)... in one point, integrating on a lattice of spacing eps/2
+ *
+ * \tparam dim Dimension
+ * \tparam Kernel Laplacian kernel
+ *
+ * \param eps size of the kernel
+ *
+ * \return the absolute error
+ *
+ */
+template<unsigned int dim, typename Kernel> double PSE_lattice_error(double eps)
+{
+	Kernel lker(eps);
+
+	double h = eps / 2.0;
+	const long int R = 14;
+
+	Point<dim,double> x;
+	double fx = 1.0;
+	for (size_t i = 0 ; i < dim ; i++)
+	{
+		x.get(i) = 0.3 + 0.1*i;
+		fx *= sin(x.get(i));
+	}
+
+	size_t n = 1;
+	double V = 1.0;
+	for (size_t i = 0 ; i < dim ; i++)
+	{
+		n *= 2*R+1;
+		V *= h;
+	}
+
+	double pse = 0.0;
+	for (size_t c = 0 ; c < n ; c++)
+	{
+		size_t cc = c;
+		Point<dim,double> y;
+		double fy = 1.0;
+		for (size_t i = 0 ; i < dim ; i++)
+		{
+			y.get(i) = x.get(i) + ((long int)(cc % (2*R+1)) - R)*h;
+			cc /= 2*R+1;
+			fy *= sin(y.get(i));
+		}
+
+		pse += 1.0/eps/eps * V * (fy - fx) * lker.value(x,y);
+	}
+
+	return fabs(pse + dim*fx);
+}
+
+BOOST_AUTO_TEST_CASE( pse_ker_nd )
+{
+	// halving eps the error must decrease as eps^ord
+	double e2 = PSE_lattice_error<2,Lap_PSE<2,double,2>>(0.1) / PSE_lattice_error<2,Lap_PSE<2,double,2>>(0.05);
+	double e4 = PSE_lattice_error<2,Lap_PSE<2,double,4>>(0.1) / PSE_lattice_error<2,Lap_PSE<2,double,4>>(0.05);
+	double e6 = PSE_lattice_error<3,Lap_PSE<3,double,6>>(0.2) / PSE_lattice_error<3,Lap_PSE<3,double,6>>(0.1);
+
+	BOOST_REQUIRE_CLOSE(e2,4.0,10.0);
+	BOOST_REQUIRE_CLOSE(e4,16.0,10.0);
+	BOOST_REQUIRE(e6 > 48.0);
+
+	double e8 = PSE_lattice_error<3,Lap_PSE<3,double,8>>(0.1);
+	BOOST_REQUIRE(e8 < 1e-10);
+
+	// the tabulated kernel must give the same values
+	Lap_PSE<3,double,8> lker(0.1);
+	Lap_PSE<3,double,8,KER_GAUSSIAN_TAB> lker_tab(0.1);
+
+	std::vector<double> r2(1000);
+	std::vector<double> ker(1000);
+	for (size_t i = 0 ; i < r2.size() ; i++)
+		r2[i] = i*0.0004;
+
+	lker_tab.value_r2(r2.data(),ker.data(),r2.size());
+
+	double err = 0.0;
+	double ker_max = 0.0;
+	for (size_t i = 0 ; i < r2.size() ; i++)
+	{
+		err = std::max(err,fabs(ker[i] - lker.value_r2(r2[i])));
+		ker_max = std::max(ker_max,fabs(lker.value_r2(r2[i])));
+
+		BOOST_REQUIRE_EQUAL(ker[i],lker_tab.value_r2(r2[i]));
+	}
+
+	BOOST_REQUIRE(err < 1e-8*ker_max);
+	BOOST_REQUIRE_EQUAL(lker_tab.value_r2(0.5),0.0);
+}
+
 BOOST_AUTO_TEST_SUITE_END()
 
 #endif /* OPENFPM_NUMERICS_SRC_PSE_KERNELS_UNIT_TESTS_HPP_ */
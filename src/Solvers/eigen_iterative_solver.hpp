@@ -0,0 +1,435 @@
+/*
+ * eigen_iterative_solver.hpp
+ *
+ *  Shared memory Krylov solvers of Eigen for the EIGEN_BASE matrices
+ */
+
+#ifndef OPENFPM_NUMERICS_SRC_SOLVERS_EIGEN_ITERATIVE_SOLVER_HPP_
+#define OPENFPM_NUMERICS_SRC_SOLVERS_EIGEN_ITERATIVE_SOLVER_HPP_
+
+#include "Solvers/umfpack_solver.hpp"
+
+//! Krylov method of eigen_iterative_solver
+enum class eigen_krylov
+{
+	//! conjugate gradient (symmetric positive definite matrices)
+	CG,
+
+	//! stabilized bi-conjugate gradient (general matrices)
+	BICGSTAB
+};
+
+//! Preconditioner of eigen_iterative_solver
+enum class eigen_pc
+{
+	//! inverse of the diagonal
+	JACOBI,
+
+	//! incomplete LU with threshold
+	ILUT
+};
+
+#if defined(HAVE_EIGEN)
+
+/////// Compiled with EIGEN support
+
+#include "Vector/Vector.hpp"
+#include "Solvers/solver_metrics.hpp"
+#include <Eigen/IterativeLinearSolvers>
+
+template<typename T>
+class eigen_iterative_solver
+{
+public:
+
+	template<unsigned int impl, typename id_type> static Vector<T> solve(const SparseMatrix<T,id_type,impl> & A, const Vector<T> & b)
+	{
+		std::cerr << __FILE__ << ":" << __LINE__ << " Error eigen_iterative_solver only support double precision, and int ad id type" << "\n";
+	}
+};
+
+/*! \brief Iterative solver of Eigen (CG or BiCGSTAB, Jacobi or ILUT preconditioner) for SparseMatrix and Vector EIGEN_BASE
+ *
+ * It is the iterative alternative to umfpack_solver when PETSc is not available, for problems too large for a
+ * direct factorization. The matrix is copied in row major order, in this way the matrix vector products of CG and
+ * BiCGSTAB run in parallel with the OpenMP threads of Eigen (Eigen::setNbThreads or OMP_NUM_THREADS). The
+ * preconditioner is computed again only if the matrix changes. It can be used as Sys_eqs::solver_type or with
+ * solve_with_solver
+ *
+ * \code{.cpp}
+
+   eigen_iterative_solver<double> solver;
+   solver.setSolver(eigen_krylov::BICGSTAB);
+   solver.setPreconditioner(eigen_pc::ILUT);
+   solver.setTolerance(1e-10);
+
+   Solver.solve_with_solver(solver,sol);
+
+ * \endcode
+ *
+ *  \warning like umfpack it is not a parallel solver across processors, the system is collected and solved on processor 0
+ *
+ */
+template<>
+class eigen_iterative_solver<double>
+{
+	//! row major matrix, the products are parallel with OpenMP
+	typedef Eigen::SparseMatrix<double,Eigen::RowMajor,int> mat_type;
+
+	//! vector type
+	typedef Eigen::Matrix<double, Eigen::Dynamic, 1> vec_type;
+
+	//! solvers
+	Eigen::ConjugateGradient<mat_type,Eigen::Lower|Eigen::Upper,Eigen::DiagonalPreconditioner<double>> cg_jacobi;
+	Eigen::ConjugateGradient<mat_type,Eigen::Lower|Eigen::Upper,Eigen::IncompleteLUT<double,int>> cg_ilut;
+	Eigen::BiCGSTAB<mat_type,Eigen::DiagonalPreconditioner<double>> bicgstab_jacobi;
+	Eigen::BiCGSTAB<mat_type,Eigen::IncompleteLUT<double,int>> bicgstab_ilut;
+
+	//! matrix of the last preconditioner
+	mat_type mat;
+
+	//! the preconditioner of the selected solver has been computed on mat
+	bool computed = false;
+
+	//! Krylov method
+	eigen_krylov ksp = eigen_krylov::BICGSTAB;
+
+	//! preconditioner
+	eigen_pc pc = eigen_pc::JACOBI;
+
+	//! relative tolerance on ||b - A x||_2 / ||b||_2
+	double tol = 1e-8;
+
+	//! maximum number of iterations (0 is the default of Eigen, twice the number of rows)
+	size_t max_it = 0;
+
+	//! ILUT drop tolerance
+	double droptol = 1e-4;
+
+	//! ILUT fill factor
+	int fillfactor = 10;
+
+	//! use the previous solution as initial guess
+	bool reuse_x = false;
+
+	//! previous solution
+	vec_type x_prev;
+
+	//! metrics of the last solve
+	solver_metrics metrics;
+
+	//! file where the metrics of every solve are appended (empty for none)
+	std::string metrics_sink;
+
+	//! Set the ILUT parameters
+	static void set_pc(Eigen::IncompleteLUT<double,int> & p, double droptol, int fillfactor)
+	{
+		p.setDroptol(droptol);
+		p.setFillfactor(fillfactor);
+	}
+
+	//! Jacobi has no parameters
+	static void set_pc(Eigen::DiagonalPreconditioner<double> & p, double droptol, int fillfactor)
+	{}
+
+	/*! \brief Compute the preconditioner (if the matrix changed) and solve
+	 *
+	 * \param s solver
+	 * \param m matrix
+	 * \param b right hand side
+	 * \param x solution (initial guess if reuse_x)
+	 *
+	 * \return true if the solver converged
+	 *
+	 */
+	template<typename solver_type>
+	bool run(solver_type & s, const Eigen::SparseMatrix<double,0,int> & m, const vec_type & b, vec_type & x)
+	{
+		timer t_pc;
+		t_pc.start();
+
+		bool same = computed == true && m.rows() == mat.rows() && m.cols() == mat.cols() && m.nonZeros() == mat.nonZeros();
+
+		if (same == true)
+		{
+			mat_type mr = m;
+			same = std::equal(mr.outerIndexPtr(),mr.outerIndexPtr()+mr.outerSize()+1,mat.outerIndexPtr()) &&
+				   std::equal(mr.innerIndexPtr(),mr.innerIndexPtr()+mr.nonZeros(),mat.innerIndexPtr()) &&
+				   std::equal(mr.valuePtr(),mr.valuePtr()+mr.nonZeros(),mat.valuePtr());
+		}
+
+		if (same == false)
+		{
+			mat = m;
+			mat.makeCompressed();
+
+			set_pc(s.preconditioner(),droptol,fillfactor);
+			s.compute(mat);
+			computed = (s.info() == Eigen::Success);
+		}
+
+		t_pc.stop();
+		metrics.pc_setup_time = t_pc.getwct();
+
+		if (computed == false)
+		{return false;}
+
+		s.setTolerance(tol);
+		if (max_it != 0)	{s.setMaxIterations(max_it);}
+
+		timer t_solve;
+		t_solve.start();
+
+		if (reuse_x == true && x_prev.size() == b.size())
+		{x = s.solveWithGuess(b,x_prev);}
+		else
+		{x = s.solve(b);}
+
+		t_solve.stop();
+		metrics.solve_time = t_solve.getwct();
+
+		metrics.iterations = s.iterations();
+		metrics.residual = s.error();
+		metrics.converged = (s.info() == Eigen::Success);
+
+		return metrics.converged;
+	}
+
+public:
+
+	/*! \brief Set the Krylov method
+	 *
+	 * \param ksp eigen_krylov::CG or eigen_krylov::BICGSTAB
+	 *
+	 */
+	void setSolver(eigen_krylov ksp)
+	{
+		this->ksp = ksp;
+		computed = false;
+	}
+
+	/*! \brief Set the preconditioner
+	 *
+	 * \param pc eigen_pc::JACOBI or eigen_pc::ILUT
+	 *
+	 */
+	void setPreconditioner(eigen_pc pc)
+	{
+		this->pc = pc;
+		computed = false;
+	}
+
+	/*! \brief Set the parameters of the ILUT preconditioner
+	 *
+	 * \param droptol entries smaller than droptol times the norm of the row are dropped
+	 * \param fillfactor maximum fill of every row, relative to the non zero of the row of A
+	 *
+	 */
+	void setPreconditionerILUT(double droptol, int fillfactor)
+	{
+		this->droptol = droptol;
+		this->fillfactor = fillfactor;
+		computed = false;
+	}
+
+	/*! \brief Set the relative tolerance
+	 *
+	 * \param tol tolerance on ||b - A x||_2 / ||b||_2
+	 *
+	 */
+	void setTolerance(double tol)
+	{
+		this->tol = tol;
+	}
+
+	/*! \brief Set the maximum number of iterations
+	 *
+	 * \param max_it maximum number of iterations
+	 *
+	 */
+	void setMaxIterations(size_t max_it)
+	{
+		this->max_it = max_it;
+	}
+
+	/*! \brief Start from the solution of the previous solve (time dependent problems)
+	 *
+	 * \param reuse true to use the previous solution as initial guess
+	 *
+	 */
+	void setInitialGuessReuse(bool reuse)
+	{
+		reuse_x = reuse;
+	}
+
+	/*! \brief Number of iterations of the last solve
+	 *
+	 * \return the number of iterations
+	 *
+	 */
+	size_t getIterations()
+	{
+		return metrics.iterations;
+	}
+
+	/*! \brief Relative residual of the last solve
+	 *
+	 * \return the estimated ||b - A x||_2 / ||b||_2
+	 *
+	 */
+	double getResidual()
+	{
+		return metrics.residual;
+	}
+
+	/*! \brief Return the metrics of the last solve
+	 *
+	 * \return the metrics
+	 *
+	 */
+	solver_metrics & getMetrics()
+	{
+		return metrics;
+	}
+
+	/*! \brief Append the metrics of every solve to a file
+	 *
+	 * The file is written by processor 0, with extension .json one JSON object per line, otherwise CSV
+	 *
+	 * \param file file name (empty to disable)
+	 *
+	 */
+	void setMetricsSink(const std::string & file)
+	{
+		metrics_sink = file;
+	}
+
+	/*! \brief Here we solve the system
+	 *
+	 * \param A sparse matrix
+	 * \param b vector
+	 * \param opt options
+	 *
+	 * \return the solution
+	 *
+	 */
+	Vector<double,EIGEN_BASE> try_solve(SparseMatrix<double,int,EIGEN_BASE> & A, const Vector<double,EIGEN_BASE> & b, size_t opt = UMFPACK_NONE)
+	{
+		return solve(A,b,opt);
+	}
+
+	/*! \brief Here we solve the system
+	 *
+	 *  \warning it is not a parallel solver across processors, the system is solved on processor 0
+	 *
+	 * \param A sparse matrix
+	 * \param b vector
+	 * \param opt options
+	 *
+	 * \return the solution
+	 *
+	 */
+	Vector<double,EIGEN_BASE> solve(SparseMatrix<double,int,EIGEN_BASE> & A, const Vector<double,EIGEN_BASE> & b, size_t opt = UMFPACK_NONE)
+	{
+		Vcluster<> & vcl = create_vcluster();
+
+		Vector<double> x;
+
+		metrics.reset_solve();
+
+		timer t_fill;
+		t_fill.start();
+
+		// Collect the matrix on master
+		const Eigen::SparseMatrix<double,0,int> & mat_A = A.getMat();
+
+		t_fill.stop();
+		metrics.fill_time = t_fill.getwct();
+
+		// Collect the vector on master
+		auto b_ei = b.getVec();
+
+		// Copy b into x, this also copy the information on how to scatter back the information on x
+		x = b;
+
+		if (vcl.getProcessUnitID() == 0)
+		{
+			vec_type x_ei;
+			bool ok;
+
+			if (ksp == eigen_krylov::CG)
+			{ok = (pc == eigen_pc::JACOBI)?run(cg_jacobi,mat_A,b_ei,x_ei):run(cg_ilut,mat_A,b_ei,x_ei);}
+			else
+			{ok = (pc == eigen_pc::JACOBI)?run(bicgstab_jacobi,mat_A,b_ei,x_ei):run(bicgstab_ilut,mat_A,b_ei,x_ei);}
+
+			if (computed == false)
+			{
+				// the preconditioner failed
+				std::cout << __FILE__ << ":" << __LINE__ << " solver failed, the preconditioner cannot be computed" << "\n";
+
+				metrics.converged = false;
+
+				x.scatter();
+
+				return x;
+			}
+
+			if (ok == false)
+			{std::cout << __FILE__ << ":" << __LINE__ << " solver did not converge, iterations: " << metrics.iterations << " residual: " << metrics.residual << "\n";}
+
+			if (opt & SOLVER_PRINT_RESIDUAL_NORM_INFINITY)
+			{
+				std::cout << "Infinity norm: " << (mat_A * x_ei - b_ei).lpNorm<Eigen::Infinity>() << " iterations: " << metrics.iterations << "\n";
+			}
+
+			metrics.rows = mat.rows();
+			metrics.nnz = mat.nonZeros();
+
+			// products with A and with the preconditioner (two per iteration for BiCGSTAB) and the vector updates
+			double n_prod = (ksp == eigen_krylov::CG)?1.0:2.0;
+			double nnz_pc = (pc == eigen_pc::JACOBI)?(double)metrics.rows:(double)fillfactor*metrics.nnz;
+			metrics.flops = metrics.iterations * n_prod * (2.0 * metrics.nnz + 2.0 * nnz_pc + 6.0 * metrics.rows);
+			metrics.bytes = metrics.iterations * n_prod * ((metrics.nnz + nnz_pc) * (sizeof(double) + sizeof(int)) + 6.0 * metrics.rows * sizeof(double));
+
+			if (metrics_sink.size() != 0)
+			{metrics.append(metrics_sink);}
+
+			if (reuse_x == true)
+			{x_prev = x_ei;}
+
+			x = x_ei;
+		}
+
+		// Vector is only on master, scatter back the information
+		x.scatter();
+
+		return x;
+	}
+};
+
+#else
+
+/////// Compiled without EIGEN support
+
+#include "Vector/Vector.hpp"
+
+//! stub when library compiled without eigen
+template<typename T>
+class eigen_iterative_solver
+{
+public:
+
+	//! stub solve
+	template<unsigned int impl, typename id_type> static Vector<T> solve(SparseMatrix<T,id_type,impl> & A, const Vector<T> & b, size_t opt = UMFPACK_NONE)
+	{
+		std::cerr << __FILE__ << ":" << __LINE__ << " Error in order to use eigen_iterative_solver you must compile OpenFPM with linear algebra support" << "\n";
+
+		Vector<T> x;
+
+		return x;
+	}
+};
+
+#endif
+
+#endif /* OPENFPM_NUMERICS_SRC_SOLVERS_EIGEN_ITERATIVE_SOLVER_HPP_ */
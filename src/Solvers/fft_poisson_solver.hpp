@@ -0,0 +1,334 @@
+/*
+ * fft_poisson_solver.hpp
+ *
+ *  Direct Poisson/Helmholtz solver on periodic distributed grids with FFTW-MPI
+ */
+
+#ifndef OPENFPM_NUMERICS_SRC_SOLVERS_FFT_POISSON_SOLVER_HPP_
+#define OPENFPM_NUMERICS_SRC_SOLVERS_FFT_POISSON_SOLVER_HPP_
+
+#include "config.h"
+
+#ifdef HAVE_FFTW
+
+#include "Grid/grid_dist_id.hpp"
+#include <fftw3-mpi.h>
+#include <algorithm>
+#include <unordered_map>
+#include <cmath>
+
+//! Symbol of the Laplacian used by fft_poisson_solver
+enum fft_laplacian
+{
+	//! eigenvalues of the second order central FD Laplacian, the solution is the one of FD_scheme
+	FFT_LAPLACIAN_FD2,
+	//! exact symbol -|k|^2, spectral accuracy (PSE, vortex methods)
+	FFT_LAPLACIAN_SPECTRAL
+};
+
+/*! \brief Direct solver of Lap(u) - kappa u = f on a periodic grid_dist_id
+ *
+ * The right hand side is redistributed from the decomposition of the grid to slabs along the last direction,
+ * transformed with FFTW-MPI, divided by the symbol of the operator and transformed back, the solution is written
+ * in the grid. The cost is O(N log N) and does not depend on the conditioning, unlike the Krylov solvers of
+ * FD_scheme. With kappa = 0 (Poisson) the mean of the right hand side is removed and the solution has zero mean.
+ *
+ * \code
+ *
+ * fft_poisson_solver<decltype(domain)> fft(domain);
+ *
+ * // Lap(prop 2) = prop 1
+ * fft.solve<2,1>();
+ *
+ * // Lap(prop 2) - 4 prop 2 = prop 1
+ * fft.solve<2,1>(4.0);
+ *
+ * \endcode
+ *
+ * The grid must be periodic in every direction. The redistribution is computed in the constructor, it must be
+ * constructed again if the grid is redecomposed.
+ *
+ * \tparam grid_type grid_dist_id
+ *
+ */
+template<typename grid_type>
+class fft_poisson_solver
+{
+	static const unsigned int dims = grid_type::dims;
+	static_assert(dims >= 2,"fft_poisson_solver needs at least 2 dimensions");
+
+	//! grid
+	grid_type & grid;
+
+	//! size of the transform, the FFTW direction i is the direction dims-1-i of the grid
+	ptrdiff_t n[dims];
+
+	//! local slab before (along the FFTW direction 0) and after the transform (along the direction 1)
+	ptrdiff_t local_n0, local_0_start, local_n1, local_1_start;
+
+	//! symbol of the Laplacian
+	fft_laplacian lap = FFT_LAPLACIAN_FD2;
+
+	fftw_complex * data = NULL;
+	fftw_plan fwd;
+	fftw_plan bwd;
+
+	//! processors that own the slabs of the local points, and for each one the local points sent
+	openfpm::vector<size_t> prcSend;
+	std::vector<std::vector<grid_dist_key_dx<dims>>> sendKeys;
+
+	//! for each processor that sends, the positions in the slab of its points (in the order of the message)
+	std::unordered_map<size_t,openfpm::vector<size_t>> recvIdx;
+
+	//! local points in the local slab, (grid key, position in the slab)
+	std::vector<std::pair<grid_dist_key_dx<dims>,size_t>> selfKeys;
+
+	//! build the redistribution between the grid and the slabs
+	void build()
+	{
+		auto & v_cl = create_vcluster();
+
+		openfpm::vector<size_t> starts;
+		openfpm::vector<size_t> sizes;
+		size_t my_start = local_0_start;
+		size_t my_size = local_n0;
+		v_cl.allGather(my_start,starts);
+		v_cl.allGather(my_size,sizes);
+		v_cl.execute();
+
+		openfpm::vector<openfpm::vector<size_t>> idx(v_cl.size());
+		std::vector<std::vector<grid_dist_key_dx<dims>>> keys(v_cl.size());
+
+		auto it = grid.getDomainIterator();
+		while (it.isNext())
+		{
+			auto key = it.get();
+			auto gkey = it.getGKey(key);
+
+			size_t c0 = gkey.get(dims-1);
+			// some processors can have an empty slab, their start is not meaningful
+			size_t owner = 0;
+			while (sizes.get(owner) == 0 || c0 < starts.get(owner) || c0 >= starts.get(owner) + sizes.get(owner))
+			{owner++;}
+
+			size_t lin = c0 - starts.get(owner);
+			for (size_t i = 1 ; i < dims ; i++)
+			{lin = lin * n[i] + gkey.get(dims-1-i);}
+
+			if (owner == v_cl.getProcessUnitID())
+			{selfKeys.push_back(std::make_pair(key,lin));}
+			else
+			{
+				idx.get(owner).add(lin);
+				keys[owner].push_back(key);
+			}
+
+			++it;
+		}
+
+		openfpm::vector<openfpm::vector<size_t>> idxSend;
+		for (size_t i = 0 ; i < idx.size() ; i++)
+		{
+			if (idx.get(i).size() == 0) {continue;}
+			idxSend.add(idx.get(i));
+			prcSend.add(i);
+			sendKeys.push_back(keys[i]);
+		}
+
+		openfpm::vector<size_t> idxRecv;
+		openfpm::vector<size_t> prcRecv;
+		openfpm::vector<size_t> szRecv;
+		v_cl.SSendRecv(idxSend,idxRecv,prcSend,prcRecv,szRecv);
+
+		size_t off = 0;
+		for (size_t i = 0 ; i < prcRecv.size() ; i++)
+		{
+			openfpm::vector<size_t> & r = recvIdx[prcRecv.get(i)];
+			for (size_t j = 0 ; j < szRecv.get(i) ; j++)
+			{r.add(idxRecv.get(off+j));}
+			off += szRecv.get(i);
+		}
+	}
+
+	//! Symbol of the Laplacian for the wave number k of the FFTW direction i
+	double symbol(ptrdiff_t k, size_t i)
+	{
+		size_t d = dims-1-i;
+		double h = grid.spacing(d);
+
+		if (lap == FFT_LAPLACIAN_FD2)
+		{return (2.0*cos(2.0*M_PI*k/n[i]) - 2.0) / (h*h);}
+
+		double kk = (k <= n[i]/2) ? k : k - n[i];
+		kk = 2.0*M_PI*kk / (n[i]*h);
+		return -kk*kk;
+	}
+
+public:
+
+	/*! \brief Constructor
+	 *
+	 * \param grid periodic grid of the problem
+	 * \param lap symbol of the Laplacian
+	 *
+	 */
+	fft_poisson_solver(grid_type & grid, fft_laplacian lap = FFT_LAPLACIAN_FD2)
+	:grid(grid),lap(lap)
+	{
+		static bool fftw_mpi_initialized = false;
+		if (fftw_mpi_initialized == false)
+		{
+			fftw_mpi_init();
+			fftw_mpi_initialized = true;
+		}
+
+		for (size_t d = 0 ; d < dims ; d++)
+		{
+			if (grid.getDecomposition().periodicity(d) != PERIODIC)
+			{std::cerr << __FILE__ << ":" << __LINE__ << " Error fft_poisson_solver needs a periodic grid, direction " << d << " is not periodic" << std::endl;}
+		}
+
+		for (size_t i = 0 ; i < dims ; i++)
+		{n[i] = grid.size(dims-1-i);}
+
+		ptrdiff_t alloc_local = fftw_mpi_local_size_transposed(dims,n,MPI_COMM_WORLD,&local_n0,&local_0_start,&local_n1,&local_1_start);
+		data = fftw_alloc_complex(alloc_local);
+
+		// the transform is left transposed, the first two directions are swapped in between
+		fwd = fftw_mpi_plan_dft(dims,n,data,data,MPI_COMM_WORLD,FFTW_FORWARD,FFTW_MEASURE | FFTW_MPI_TRANSPOSED_OUT);
+		bwd = fftw_mpi_plan_dft(dims,n,data,data,MPI_COMM_WORLD,FFTW_BACKWARD,FFTW_MEASURE | FFTW_MPI_TRANSPOSED_IN);
+
+		build();
+	}
+
+	~fft_poisson_solver()
+	{
+		fftw_destroy_plan(fwd);
+		fftw_destroy_plan(bwd);
+		fftw_free(data);
+	}
+
+	/*! \brief Solve Lap(u) - kappa u = f
+	 *
+	 * It is collective
+	 *
+	 * \tparam prp_x property where to store the solution u
+	 * \tparam prp_b property of the right hand side f
+	 *
+	 * \param kappa coefficient of the Helmholtz term (0 for Poisson)
+	 *
+	 */
+	template<unsigned int prp_x, unsigned int prp_b>
+	void solve(double kappa = 0.0)
+	{
+		auto & v_cl = create_vcluster();
+
+		size_t local_size = local_n0;
+		for (size_t i = 1 ; i < dims ; i++)
+		{local_size *= n[i];}
+
+		// grid to slabs
+		openfpm::vector<openfpm::vector<double>> send(prcSend.size());
+		for (size_t i = 0 ; i < prcSend.size() ; i++)
+		{
+			send.get(i).resize(sendKeys[i].size());
+			for (size_t j = 0 ; j < sendKeys[i].size() ; j++)
+			{send.get(i).get(j) = grid.template get<prp_b>(sendKeys[i][j]);}
+		}
+
+		openfpm::vector<double> recv;
+		openfpm::vector<size_t> prcRecv;
+		openfpm::vector<size_t> szRecv;
+		v_cl.SSendRecv(send,recv,prcSend,prcRecv,szRecv);
+
+		for (size_t i = 0 ; i < local_size ; i++)
+		{data[i][0] = 0.0; data[i][1] = 0.0;}
+
+		size_t off = 0;
+		for (size_t i = 0 ; i < prcRecv.size() ; i++)
+		{
+			const openfpm::vector<size_t> & r = recvIdx[prcRecv.get(i)];
+			for (size_t j = 0 ; j < szRecv.get(i) ; j++)
+			{data[r.get(j)][0] = recv.get(off+j);}
+			off += szRecv.get(i);
+		}
+
+		for (size_t i = 0 ; i < selfKeys.size() ; i++)
+		{data[selfKeys[i].second][0] = grid.template get<prp_b>(selfKeys[i].first);}
+
+		fftw_execute(fwd);
+
+		// divide by the symbol, the layout is (k1 local, k0, k2, ...)
+		double norm = 1.0;
+		for (size_t i = 0 ; i < dims ; i++)
+		{norm *= n[i];}
+
+		size_t inner = 1;
+		for (size_t i = 2 ; i < dims ; i++)
+		{inner *= n[i];}
+
+		for (ptrdiff_t j1 = 0 ; j1 < local_n1 ; j1++)
+		{
+			double s1 = symbol(local_1_start + j1,1);
+
+			for (ptrdiff_t k0 = 0 ; k0 < n[0] ; k0++)
+			{
+				double s01 = s1 + symbol(k0,0);
+
+				for (size_t r = 0 ; r < inner ; r++)
+				{
+					double s = s01;
+					size_t rr = r;
+					for (size_t i = dims-1 ; i >= 2 ; i--)
+					{
+						s += symbol(rr % n[i],i);
+						rr /= n[i];
+					}
+
+					size_t p = (j1*n[0] + k0)*inner + r;
+					double den = (s - kappa) * norm;
+					if (den == 0.0)
+					{data[p][0] = 0.0; data[p][1] = 0.0;}
+					else
+					{data[p][0] /= den; data[p][1] /= den;}
+				}
+			}
+		}
+
+		fftw_execute(bwd);
+
+		// slabs to grid, in the order of the requests
+		openfpm::vector<openfpm::vector<double>> back;
+		openfpm::vector<size_t> prcBack;
+		for (size_t i = 0 ; i < prcRecv.size() ; i++)
+		{
+			const openfpm::vector<size_t> & r = recvIdx[prcRecv.get(i)];
+			back.add();
+			back.last().resize(r.size());
+			for (size_t j = 0 ; j < r.size() ; j++)
+			{back.last().get(j) = data[r.get(j)][0];}
+			prcBack.add(prcRecv.get(i));
+		}
+
+		openfpm::vector<double> recvBack;
+		openfpm::vector<size_t> prcRecvBack;
+		openfpm::vector<size_t> szRecvBack;
+		v_cl.SSendRecv(back,recvBack,prcBack,prcRecvBack,szRecvBack);
+
+		off = 0;
+		for (size_t i = 0 ; i < prcRecvBack.size() ; i++)
+		{
+			size_t s = std::find(&prcSend.get(0),&prcSend.get(0)+prcSend.size(),prcRecvBack.get(i)) - &prcSend.get(0);
+			for (size_t j = 0 ; j < szRecvBack.get(i) ; j++)
+			{grid.template get<prp_x>(sendKeys[s][j]) = recvBack.get(off+j);}
+			off += szRecvBack.get(i);
+		}
+
+		for (size_t i = 0 ; i < selfKeys.size() ; i++)
+		{grid.template get<prp_x>(selfKeys[i].first) = data[selfKeys[i].second][0];}
+	}
+};
+
+#endif
+
+#endif /* OPENFPM_NUMERICS_SRC_SOLVERS_FFT_POISSON_SOLVER_HPP_ */
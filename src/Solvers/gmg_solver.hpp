@@ -0,0 +1,483 @@
+/*
+ * gmg_solver.hpp
+ *
+ *  Geometric multigrid for the systems assembled by FD_scheme on distributed Cartesian grids
+ */
+
+#ifndef OPENFPM_NUMERICS_SRC_SOLVERS_GMG_SOLVER_HPP_
+#define OPENFPM_NUMERICS_SRC_SOLVERS_GMG_SOLVER_HPP_
+
+#include "config.h"
+
+#ifdef HAVE_PETSC
+
+#include "Vector/Vector.hpp"
+#include "Matrix/SparseMatrix.hpp"
+#include <petscksp.h>
+#include <petscao.h>
+#include <vector>
+
+template<typename T>
+class gmg_solver
+{
+public:
+
+	template<typename id_type> Vector<T,PETSC_BASE> solve(SparseMatrix<T,id_type,PETSC_BASE> & A, const Vector<T,PETSC_BASE> & b)
+	{
+		std::cerr << __FILE__ << ":" << __LINE__ << " Error gmg_solver only support double precision" << "\n";
+	}
+};
+
+/*! \brief Geometric multigrid solver for the systems of FD_scheme
+ *
+ * The levels are built from the Cartesian grid of the FD_scheme (given with setGridMap, FD_scheme::solve does it
+ * when the solver is Sys_eqs::solver_type or is passed to solve_with_solver): every level keeps the points of
+ * the finer one with even coordinates in all the directions, the interpolation is (bi/tri)linear and the coarse
+ * operators are the Galerkin products P^T A P. A coarse point is owned by the processor of the fine point at the
+ * same position, so building the levels needs no exchange of the grid. The levels are coarsened until one
+ * direction would go under setMinCoarseSize points.
+ *
+ * The V-cycle smooths with setSmoothingSteps Richardson/SOR iterations on the assembled operators. On the coarsest
+ * level the system is agglomerated (PCTELESCOPE) on size/setCoarseReduction processors and solved with LU, by default
+ * on one processor. The cycle preconditions a GMRES (setSolver to change it, for example KSPCG for symmetric
+ * systems). The PETSc options with prefix gmg_ are read, so the cycle can be tuned from the command line.
+ *
+ * The unknowns of the grid points are interleaved (row = point*nvar + component), every component is interpolated
+ * on its own. Staggered unknowns are interpolated as if they were at the grid points.
+ *
+ */
+template<>
+class gmg_solver<double>
+{
+	//! Krylov solver preconditioned with the cycle
+	KSP ksp;
+	bool ksp_created = false;
+
+	//! interpolation from the level i+1 to the level i (the level 0 is the grid of the FD_scheme)
+	std::vector<Mat> interp;
+
+	//! points of the grid in every direction and periodicity
+	std::vector<size_t> sz;
+	std::vector<bool> periodic;
+
+	//! unknowns for every grid point
+	size_t nvar = 1;
+
+	//! global coordinates of the local points of the grid, dimension by dimension, and their index
+	std::vector<long int> coords;
+	std::vector<PetscInt> ids;
+
+	//! the levels are built for these rows
+	PetscInt n_rows = -1;
+
+	//! parameters
+	size_t min_coarse = 5;
+	size_t max_levels = 20;
+	size_t smooth_it = 2;
+	size_t coarse_reduction = 0;
+	double rtol = 1e-8;
+	double atol = 1e-50;
+	size_t max_it = 500;
+	KSPType ksp_type = KSPGMRES;
+
+	//! last solve
+	PetscInt n_it = 0;
+	PetscReal res = 0.0;
+
+	void destroy_levels()
+	{
+		for (size_t i = 0 ; i < interp.size() ; i++)
+		{PETSC_SAFE_CALL(MatDestroy(&interp[i]));}
+		interp.clear();
+
+		if (ksp_created == true)
+		{
+			PETSC_SAFE_CALL(KSPDestroy(&ksp));
+			ksp_created = false;
+		}
+	}
+
+	/*! \brief Build the interpolation of the next coarse level
+	 *
+	 * \param l_sz points of the current level
+	 * \param l_coords coordinates of the local points of the current level (in units of the level), replaced by the coarse ones
+	 * \param l_ids index of the local points of the current level, replaced by the coarse ones
+	 *
+	 * \return false if the level cannot be coarsened
+	 *
+	 */
+	bool coarsen(std::vector<size_t> & l_sz, std::vector<long int> & l_coords, std::vector<PetscInt> & l_ids)
+	{
+		size_t dim = l_sz.size();
+
+		std::vector<size_t> c_sz(dim);
+		for (size_t d = 0 ; d < dim ; d++)
+		{
+			if (periodic[d] == true)
+			{
+				if (l_sz[d] % 2 != 0) {return false;}
+				c_sz[d] = l_sz[d] / 2;
+			}
+			else
+			{c_sz[d] = (l_sz[d] + 1) / 2;}
+
+			if (c_sz[d] < min_coarse) {return false;}
+		}
+
+		// the coarse points are the local points with even coordinates
+		size_t n_local = l_ids.size();
+		std::vector<long int> c_coords;
+		std::vector<PetscInt> c_nat;
+		for (size_t i = 0 ; i < n_local ; i++)
+		{
+			bool even = true;
+			for (size_t d = 0 ; d < dim ; d++)
+			{even &= (l_coords[i*dim+d] % 2 == 0);}
+			if (even == false) {continue;}
+
+			PetscInt nat = 0;
+			PetscInt stride = 1;
+			for (size_t d = 0 ; d < dim ; d++)
+			{
+				c_coords.push_back(l_coords[i*dim+d] / 2);
+				nat += (l_coords[i*dim+d] / 2) * stride;
+				stride *= c_sz[d];
+			}
+			c_nat.push_back(nat);
+		}
+
+		PetscInt n_coarse = c_nat.size();
+		PetscInt c_start = 0;
+		MPI_Exscan(&n_coarse,&c_start,1,MPIU_INT,MPI_SUM,PETSC_COMM_WORLD);
+		PetscMPIInt rank;
+		MPI_Comm_rank(PETSC_COMM_WORLD,&rank);
+		if (rank == 0) {c_start = 0;}
+
+		std::vector<PetscInt> c_ids(n_coarse);
+		for (PetscInt i = 0 ; i < n_coarse ; i++)
+		{c_ids[i] = c_start + i;}
+
+		// natural (lexicographic) index of the coarse points to their index
+		AO ao;
+		PETSC_SAFE_CALL(AOCreateBasic(PETSC_COMM_WORLD,n_coarse,c_nat.data(),c_ids.data(),&ao));
+
+		// linear interpolation, tensor product of the directions
+		size_t n_corner = 1 << dim;
+		std::vector<PetscInt> cols(n_local * n_corner);
+		std::vector<PetscScalar> w(n_local * n_corner);
+		for (size_t i = 0 ; i < n_local ; i++)
+		{
+			for (size_t c = 0 ; c < n_corner ; c++)
+			{
+				PetscInt nat = 0;
+				PetscInt stride = 1;
+				double wc = 1.0;
+				for (size_t d = 0 ; d < dim ; d++)
+				{
+					long int x = l_coords[i*dim+d];
+					long int xc;
+					bool up = (c >> d) & 1;
+
+					if (x % 2 == 0)
+					{
+						xc = x / 2;
+						wc *= (up == true) ? 0.0 : 1.0;
+					}
+					else
+					{
+						xc = (up == true) ? (x + 1) / 2 : (x - 1) / 2;
+						if (periodic[d] == true)
+						{
+							xc = xc % (long int)c_sz[d];
+							wc *= 0.5;
+						}
+						else if ((x + 1) / 2 >= (long int)c_sz[d])
+						{
+							// last point of an even sized direction, only the left neighbour
+							xc = (x - 1) / 2;
+							wc *= (up == true) ? 0.0 : 1.0;
+						}
+						else
+						{wc *= 0.5;}
+					}
+
+					nat += xc * stride;
+					stride *= c_sz[d];
+				}
+
+				cols[i*n_corner+c] = nat;
+				w[i*n_corner+c] = wc;
+			}
+		}
+
+		PETSC_SAFE_CALL(AOApplicationToPetsc(ao,cols.size(),cols.data()));
+		PETSC_SAFE_CALL(AODestroy(&ao));
+
+		Mat P;
+		PETSC_SAFE_CALL(MatCreateAIJ(PETSC_COMM_WORLD,n_local*nvar,n_coarse*nvar,PETSC_DETERMINE,PETSC_DETERMINE,
+				n_corner,NULL,n_corner,NULL,&P));
+
+		for (size_t i = 0 ; i < n_local ; i++)
+		{
+			for (size_t c = 0 ; c < n_corner ; c++)
+			{
+				if (w[i*n_corner+c] == 0.0) {continue;}
+
+				for (size_t v = 0 ; v < nvar ; v++)
+				{
+					PetscInt row = l_ids[i]*nvar + v;
+					PetscInt col = cols[i*n_corner+c]*nvar + v;
+					PETSC_SAFE_CALL(MatSetValues(P,1,&row,1,&col,&w[i*n_corner+c],ADD_VALUES));
+				}
+			}
+		}
+
+		PETSC_SAFE_CALL(MatAssemblyBegin(P,MAT_FINAL_ASSEMBLY));
+		PETSC_SAFE_CALL(MatAssemblyEnd(P,MAT_FINAL_ASSEMBLY));
+		interp.push_back(P);
+
+		l_sz = c_sz;
+		l_coords.swap(c_coords);
+		l_ids.swap(c_ids);
+
+		return true;
+	}
+
+	//! Build the levels and the cycle for a matrix with rows rows
+	void build(Mat & A_)
+	{
+		destroy_levels();
+
+		std::vector<size_t> l_sz = sz;
+		std::vector<long int> l_coords = coords;
+		std::vector<PetscInt> l_ids = ids;
+
+		while (interp.size() + 1 < max_levels && coarsen(l_sz,l_coords,l_ids) == true) {}
+
+		PETSC_SAFE_CALL(KSPCreate(PETSC_COMM_WORLD,&ksp));
+		ksp_created = true;
+		PETSC_SAFE_CALL(KSPSetOptionsPrefix(ksp,"gmg_"));
+		PETSC_SAFE_CALL(KSPSetType(ksp,ksp_type));
+		PETSC_SAFE_CALL(KSPSetOperators(ksp,A_,A_));
+		PETSC_SAFE_CALL(KSPSetTolerances(ksp,rtol,atol,PETSC_DEFAULT,max_it));
+
+		PC pc;
+		PETSC_SAFE_CALL(KSPGetPC(ksp,&pc));
+		PETSC_SAFE_CALL(PCSetType(pc,PCMG));
+
+		PetscInt n_levels = interp.size() + 1;
+		PETSC_SAFE_CALL(PCMGSetLevels(pc,n_levels,NULL));
+		PETSC_SAFE_CALL(PCMGSetType(pc,PC_MG_MULTIPLICATIVE));
+		PETSC_SAFE_CALL(PCMGSetCycleType(pc,PC_MG_CYCLE_V));
+		PETSC_SAFE_CALL(PCMGSetGalerkin(pc,PC_MG_GALERKIN_BOTH));
+
+		// PETSc numbers the levels from the coarsest
+		for (size_t i = 0 ; i < interp.size() ; i++)
+		{PETSC_SAFE_CALL(PCMGSetInterpolation(pc,n_levels - 1 - i,interp[i]));}
+
+		for (PetscInt l = 1 ; l < n_levels ; l++)
+		{
+			KSP smoother;
+			PC pc_s;
+			PETSC_SAFE_CALL(PCMGGetSmoother(pc,l,&smoother));
+			PETSC_SAFE_CALL(KSPSetType(smoother,KSPRICHARDSON));
+			PETSC_SAFE_CALL(KSPGetPC(smoother,&pc_s));
+			PETSC_SAFE_CALL(PCSetType(pc_s,PCSOR));
+		}
+		PETSC_SAFE_CALL(PCMGSetNumberSmooth(pc,smooth_it));
+
+		// coarsest level agglomerated on fewer processors and solved directly
+		PetscMPIInt size;
+		MPI_Comm_size(PETSC_COMM_WORLD,&size);
+
+		KSP coarse;
+		PC pc_c;
+		PETSC_SAFE_CALL(PCMGGetCoarseSolve(pc,&coarse));
+		PETSC_SAFE_CALL(KSPSetType(coarse,KSPPREONLY));
+		PETSC_SAFE_CALL(KSPGetPC(coarse,&pc_c));
+		if (size == 1)
+		{PETSC_SAFE_CALL(PCSetType(pc_c,PCLU));}
+		else
+		{
+			PetscInt red = (coarse_reduction == 0 || coarse_reduction > (size_t)size) ? size : coarse_reduction;
+			PETSC_SAFE_CALL(PCSetType(pc_c,PCTELESCOPE));
+			PETSC_SAFE_CALL(PCTelescopeSetReductionFactor(pc_c,red));
+			PETSC_SAFE_CALL(PetscOptionsSetValue(NULL,"-gmg_mg_coarse_telescope_ksp_type","preonly"));
+			PETSC_SAFE_CALL(PetscOptionsSetValue(NULL,"-gmg_mg_coarse_telescope_pc_type",(red == size) ? "lu" : "redundant"));
+		}
+
+		PETSC_SAFE_CALL(KSPSetFromOptions(ksp));
+	}
+
+public:
+
+	~gmg_solver()
+	{
+		destroy_levels();
+	}
+
+	/*! \brief Set the grid of the system, the grid points are the unknowns of the finest level
+	 *
+	 * \param g_map map from the grid points to their index in the system (FD_scheme::getMap())
+	 * \param nvar unknowns for every grid point
+	 *
+	 */
+	template<typename g_map_type> void setGridMap(g_map_type & g_map, size_t nvar)
+	{
+		const unsigned int dim = g_map_type::dims;
+
+		this->nvar = nvar;
+		sz.resize(dim);
+		periodic.resize(dim);
+		for (size_t d = 0 ; d < dim ; d++)
+		{
+			sz[d] = g_map.size(d);
+			periodic[d] = (g_map.getDecomposition().periodicity(d) == PERIODIC);
+		}
+
+		coords.clear();
+		ids.clear();
+
+		auto it = g_map.getDomainIterator();
+		while (it.isNext())
+		{
+			auto key = it.get();
+			auto gkey = g_map.getGKey(key);
+
+			for (size_t d = 0 ; d < dim ; d++)
+			{coords.push_back(gkey.get(d));}
+			ids.push_back(g_map.template get<0>(key));
+
+			++it;
+		}
+
+		// the levels are rebuilt at the next solve
+		n_rows = -1;
+	}
+
+	//! Minimum number of points of a direction on the coarsest level
+	void setMinCoarseSize(size_t min_coarse)
+	{
+		this->min_coarse = min_coarse;
+		n_rows = -1;
+	}
+
+	//! Maximum number of levels (the finest included)
+	void setMaxLevels(size_t max_levels)
+	{
+		this->max_levels = max_levels;
+		n_rows = -1;
+	}
+
+	//! Pre and post smoothing steps on every level
+	void setSmoothingSteps(size_t smooth_it)
+	{
+		this->smooth_it = smooth_it;
+		n_rows = -1;
+	}
+
+	/*! \brief Agglomerate the coarsest level on size/reduction processors
+	 *
+	 * \param reduction reduction factor, 0 (default) gather the coarsest level on one processor
+	 *
+	 */
+	void setCoarseReduction(size_t reduction)
+	{
+		coarse_reduction = reduction;
+		n_rows = -1;
+	}
+
+	//! Krylov method preconditioned by the cycle (default KSPGMRES)
+	void setSolver(KSPType type)
+	{
+		ksp_type = type;
+		n_rows = -1;
+	}
+
+	//! Relative and absolute tolerance
+	void setTolerance(double rtol, double atol = 1e-50)
+	{
+		this->rtol = rtol;
+		this->atol = atol;
+		n_rows = -1;
+	}
+
+	//! Maximum number of iterations of the Krylov method
+	void setMaxIterations(size_t max_it)
+	{
+		this->max_it = max_it;
+		n_rows = -1;
+	}
+
+	//! Number of levels of the last solve, the finest included
+	size_t getNLevels()
+	{
+		return interp.size() + 1;
+	}
+
+	//! Iterations of the last solve
+	size_t getIterations()
+	{
+		return n_it;
+	}
+
+	//! Norm of the residual of the last solve
+	double getResidualNorm()
+	{
+		return res;
+	}
+
+	/*! \brief Solve the system A x = b
+	 *
+	 * The levels are built at the first solve and reused while the size of the system does not change; the
+	 * Galerkin operators are recomputed from A at every solve
+	 *
+	 * \param A sparse matrix
+	 * \param b right hand side
+	 *
+	 * \return the solution
+	 *
+	 */
+	Vector<double,PETSC_BASE> solve(SparseMatrix<double,int,PETSC_BASE> & A, const Vector<double,PETSC_BASE> & b)
+	{
+		Mat & A_ = A.getMat();
+		const Vec & b_ = b.getVec();
+
+		PetscInt row;
+		PetscInt col;
+		PetscInt row_loc;
+		PetscInt col_loc;
+		PETSC_SAFE_CALL(MatGetSize(A_,&row,&col));
+		PETSC_SAFE_CALL(MatGetLocalSize(A_,&row_loc,&col_loc));
+
+		Vector<double,PETSC_BASE> x(row,row_loc);
+		Vec & x_ = x.getVec();
+
+		if ((size_t)row_loc != ids.size() * nvar)
+		{
+			std::cerr << __FILE__ << ":" << __LINE__ << " Error the system has " << row_loc << " local rows, the grid set with setGridMap "
+					  << ids.size() * nvar << " unknowns (a Lagrange multiplier row is not supported)" << std::endl;
+			return x;
+		}
+
+		if (n_rows != row || ksp_created == false)
+		{
+			build(A_);
+			n_rows = row;
+		}
+		else
+		{PETSC_SAFE_CALL(KSPSetOperators(ksp,A_,A_));}
+
+		PETSC_SAFE_CALL(KSPSolve(ksp,b_,x_));
+		PETSC_SAFE_CALL(KSPGetIterationNumber(ksp,&n_it));
+		PETSC_SAFE_CALL(KSPGetResidualNorm(ksp,&res));
+
+		x.update();
+
+		return x;
+	}
+};
+
+#endif
+
+#endif /* OPENFPM_NUMERICS_SRC_SOLVERS_GMG_SOLVER_HPP_ */
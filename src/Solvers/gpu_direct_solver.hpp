@@ -0,0 +1,678 @@
+/*
+ * gpu_direct_solver.hpp
+ *
+ * Sparse direct solver on the GPU (cuDSS) with the interface of umfpack_solver
+ */
+
+#ifndef OPENFPM_NUMERICS_SRC_SOLVERS_GPU_DIRECT_SOLVER_HPP_
+#define OPENFPM_NUMERICS_SRC_SOLVERS_GPU_DIRECT_SOLVER_HPP_
+
+#include "Solvers/umfpack_solver.hpp"
+
+#if defined(HAVE_EIGEN) && defined(HAVE_CUDSS) && defined(__NVCC__)
+
+/////// Compiled with EIGEN and cuDSS support
+
+#include "Vector/Vector.hpp"
+#include "Solvers/solver_metrics.hpp"
+#include "initialize/numerics_backends.hpp"
+#include "util/device_pool.hpp"
+#include <cudss.h>
+#include <thrust/device_ptr.h>
+#include <thrust/equal.h>
+#include <thrust/sort.h>
+#include <thrust/reduce.h>
+#include <thrust/binary_search.h>
+#include <thrust/iterator/zip_iterator.h>
+#include <thrust/iterator/counting_iterator.h>
+#include <vector>
+
+#define CUDSS_SAFE_CALL(call) {\
+	cudssStatus_t err = (call);\
+	if (err != CUDSS_STATUS_SUCCESS) {\
+		std::cerr << __FILE__ << ":" << __LINE__ << " cuDSS error " << (int)err << std::endl;\
+	}\
+}
+
+//! Device buffer of the gpu_direct_solver (grows, never shrinks), allocated from the device_pool
+template<typename T>
+using gpu_direct_buffer = device_pool_buffer<T>;
+
+template<typename T>
+class gpu_direct_solver
+{
+public:
+
+	template<unsigned int impl, typename id_type> static Vector<T> solve(const SparseMatrix<T,id_type,impl> & A, const Vector<T> & b)
+	{
+		std::cerr << __FILE__ << ":" << __LINE__ << " Error gpu_direct_solver only support double precision, and int as id type" << std::endl;
+		return Vector<T>();
+	}
+};
+
+/*! \brief Sparse LU on the GPU with cuDSS
+ *
+ * It has the interface of umfpack_solver (the schemes can use it as solver_type with SparseMatrix<double,int,EIGEN_BASE>):
+ * the system is collected on processor 0, factorized and solved on its device and the solution is scattered back.
+ * The matrix is kept on the device in CSR, if the next matrix has the same pattern the symbolic analysis (reordering
+ * and symbolic factorization) is reused and only the numeric factorization is done again, if it has also the same
+ * values the factorization is reused too.
+ *
+ * Matrices already on the device can be given directly in CSR (solve_csr_device) or as triplets (solve_triplets_device)
+ *
+ * \warning like umfpack_solver it is not a parallel solver, the factorization is done by processor 0
+ *
+ */
+template<>
+class gpu_direct_solver<double>
+{
+	cudssHandle_t handle = NULL;
+	cudssConfig_t config = NULL;
+	cudssData_t data = NULL;
+
+	//! matrix factorized (on the buffers rowOff, cols and vals)
+	cudssMatrix_t mat = NULL;
+
+	//! CSR of the factorized matrix
+	gpu_direct_buffer<int> rowOff;
+	gpu_direct_buffer<int> cols;
+	gpu_direct_buffer<double> vals;
+
+	//! input of the host and triplet paths
+	gpu_direct_buffer<int> inRowOff;
+	gpu_direct_buffer<int> inRows;
+	gpu_direct_buffer<int> inCols;
+	gpu_direct_buffer<double> inVals;
+
+	//! right hand sides and solutions
+	gpu_direct_buffer<double> d_b;
+	gpu_direct_buffer<double> d_x;
+
+	//! size and non zero of the factorized matrix
+	int n = 0;
+	int nnz = 0;
+
+	//! true if data contain a symbolic analysis of the pattern of the matrix
+	bool analyzed = false;
+
+	//! true if data contain a numeric factorization of the matrix
+	bool factorized = false;
+
+	//! number of symbolic analysis done
+	size_t n_analyze = 0;
+
+	//! number of numeric factorization done
+	size_t n_factorize = 0;
+
+	//! metrics of the last solve
+	solver_metrics metrics;
+
+	//! file where the metrics of every solve are appended (empty for none)
+	std::string metrics_sink;
+
+	//! Create the cuDSS objects at the first use
+	void init()
+	{
+		if (handle != NULL)
+		{return;}
+
+		numerics_backends::ensure_device();
+
+		CUDSS_SAFE_CALL(cudssCreate(&handle));
+		CUDSS_SAFE_CALL(cudssConfigCreate(&config));
+		CUDSS_SAFE_CALL(cudssDataCreate(handle,&data));
+	}
+
+	/*! \brief Run a phase of cuDSS on the factorized matrix
+	 *
+	 * \param phase phase
+	 * \param x solutions (n x nrhs column major, device)
+	 * \param b right hand sides (n x nrhs column major, device)
+	 * \param nrhs number of right hand sides
+	 *
+	 * \return true if the phase succeeded
+	 *
+	 */
+	bool execute(cudssPhase_t phase, double * x, double * b, int nrhs)
+	{
+		cudssMatrix_t mx, mb;
+		CUDSS_SAFE_CALL(cudssMatrixCreateDn(&mx,n,nrhs,n,x,CUDA_R_64F,CUDSS_LAYOUT_COL_MAJOR));
+		CUDSS_SAFE_CALL(cudssMatrixCreateDn(&mb,n,nrhs,n,b,CUDA_R_64F,CUDSS_LAYOUT_COL_MAJOR));
+
+		cudssStatus_t err = cudssExecute(handle,phase,config,data,mat,mx,mb);
+
+		CUDSS_SAFE_CALL(cudssMatrixDestroy(mx));
+		CUDSS_SAFE_CALL(cudssMatrixDestroy(mb));
+
+		if (phase == CUDSS_PHASE_FACTORIZATION || phase == CUDSS_PHASE_REFACTORIZATION)
+		{
+			// a singular pivot is reported in the info of the factorization
+			int info = 0;
+			size_t written = 0;
+			cudssDataGet(handle,data,CUDSS_DATA_INFO,&info,sizeof(int),&written);
+			if (info != 0)
+			{err = CUDSS_STATUS_EXECUTION_FAILED;}
+		}
+
+		return err == CUDSS_STATUS_SUCCESS;
+	}
+
+	/*! \brief Factorize the CSR matrix on the device reusing what is possible from the previous factorization
+	 *
+	 * \param nr number of rows
+	 * \param nz number of non zero
+	 * \param d_rowOff row offsets (nr+1, device)
+	 * \param d_cols column of every non zero (device)
+	 * \param d_vals values (device)
+	 *
+	 * \return true if the matrix is factorized
+	 *
+	 */
+	bool factorize_cached(int nr, int nz, const int * d_rowOff, const int * d_cols, const double * d_vals)
+	{
+		init();
+
+		bool same_pattern = analyzed == true && nr == n && nz == nnz &&
+		                    thrust::equal(thrust::device_ptr<const int>(d_rowOff),thrust::device_ptr<const int>(d_rowOff)+nr+1,thrust::device_ptr<int>(rowOff.get())) &&
+		                    thrust::equal(thrust::device_ptr<const int>(d_cols),thrust::device_ptr<const int>(d_cols)+nz,thrust::device_ptr<int>(cols.get()));
+
+		if (same_pattern == true && factorized == true &&
+		    thrust::equal(thrust::device_ptr<const double>(d_vals),thrust::device_ptr<const double>(d_vals)+nz,thrust::device_ptr<double>(vals.get())))
+		{return true;}
+
+		if (same_pattern == false)
+		{
+			if (mat != NULL)
+			{CUDSS_SAFE_CALL(cudssMatrixDestroy(mat));}
+
+			// the symbolic analysis of another pattern is not valid anymore
+			if (analyzed == true)
+			{
+				CUDSS_SAFE_CALL(cudssDataDestroy(handle,data));
+				CUDSS_SAFE_CALL(cudssDataCreate(handle,&data));
+			}
+
+			n = nr;
+			nnz = nz;
+			rowOff.resize(nr+1);
+			cols.resize(nz);
+			vals.resize(nz);
+			cudaMemcpy(rowOff.get(),d_rowOff,(nr+1)*sizeof(int),cudaMemcpyDeviceToDevice);
+			cudaMemcpy(cols.get(),d_cols,nz*sizeof(int),cudaMemcpyDeviceToDevice);
+
+			CUDSS_SAFE_CALL(cudssMatrixCreateCsr(&mat,n,n,nnz,rowOff.get(),NULL,cols.get(),vals.get(),
+			                                     CUDA_R_32I,CUDA_R_64F,CUDSS_MTYPE_GENERAL,CUDSS_MVIEW_FULL,CUDSS_BASE_ZERO));
+		}
+
+		cudaMemcpy(vals.get(),d_vals,nz*sizeof(double),cudaMemcpyDeviceToDevice);
+
+		d_b.resize(n);
+		d_x.resize(n);
+
+		bool refactorize = (same_pattern == true);
+
+		if (same_pattern == false)
+		{
+			analyzed = execute(CUDSS_PHASE_ANALYSIS,d_x.get(),d_b.get(),1);
+			n_analyze++;
+
+			if (analyzed == false)
+			{
+				factorized = false;
+				return false;
+			}
+		}
+
+		factorized = execute((refactorize == true)?CUDSS_PHASE_REFACTORIZATION:CUDSS_PHASE_FACTORIZATION,d_x.get(),d_b.get(),1);
+		n_factorize++;
+
+		return factorized;
+	}
+
+	//! Copy a compressed Eigen matrix on the device in CSR (in the input buffers)
+	void upload(const Eigen::SparseMatrix<double,Eigen::RowMajor,int> & csr)
+	{
+		int nr = csr.rows();
+		int nz = csr.nonZeros();
+
+		inRowOff.resize(nr+1);
+		inCols.resize(nz);
+		inVals.resize(nz);
+		cudaMemcpy(inRowOff.get(),csr.outerIndexPtr(),(nr+1)*sizeof(int),cudaMemcpyHostToDevice);
+		cudaMemcpy(inCols.get(),csr.innerIndexPtr(),nz*sizeof(int),cudaMemcpyHostToDevice);
+		cudaMemcpy(inVals.get(),csr.valuePtr(),nz*sizeof(double),cudaMemcpyHostToDevice);
+	}
+
+	//! Fill the metrics of a solve of nrhs right hand sides with the factors
+	void solve_metrics(int nrhs)
+	{
+		int64_t lu_nnz = 0;
+		size_t written = 0;
+		cudssDataGet(handle,data,CUDSS_DATA_LU_NNZ,&lu_nnz,sizeof(int64_t),&written);
+
+		double nnz_lu = (lu_nnz > nnz)?(double)lu_nnz:(double)nnz;
+
+		metrics.iterations = 1;
+		metrics.rows = n;
+		metrics.nnz = nnz;
+
+		// forward and backward substitution on the factors for every right hand side
+		metrics.flops = 4.0 * nnz_lu * nrhs;
+		metrics.bytes = nnz_lu * (sizeof(double) + sizeof(int)) + 3.0 * n * nrhs * sizeof(double);
+	}
+
+	//! Free the cuDSS objects
+	void destroy()
+	{
+		if (handle == NULL)
+		{return;}
+
+		if (mat != NULL)
+		{CUDSS_SAFE_CALL(cudssMatrixDestroy(mat));}
+		CUDSS_SAFE_CALL(cudssDataDestroy(handle,data));
+		CUDSS_SAFE_CALL(cudssConfigDestroy(config));
+		CUDSS_SAFE_CALL(cudssDestroy(handle));
+
+		mat = NULL;
+		handle = NULL;
+	}
+
+public:
+
+	gpu_direct_solver() {}
+
+	//! the factorization is owned by the solver
+	gpu_direct_solver(const gpu_direct_solver &) = delete;
+	gpu_direct_solver & operator=(const gpu_direct_solver &) = delete;
+
+	~gpu_direct_solver()
+	{
+		destroy();
+	}
+
+	/*! \brief Return the metrics of the last solve
+	 *
+	 * The preconditioner set-up time is the time of the analysis and factorization (0 if cached), the solve time
+	 * is the time of the triangular solves, flops and bytes are estimated from the non zero of the factors
+	 *
+	 * \return the metrics
+	 *
+	 */
+	solver_metrics & getMetrics()
+	{
+		return metrics;
+	}
+
+	/*! \brief Append the metrics of every solve to a file
+	 *
+	 * The file is written by processor 0, with extension .json one JSON object per line, otherwise CSV
+	 *
+	 * \param file file name (empty to disable)
+	 *
+	 */
+	void setMetricsSink(const std::string & file)
+	{
+		metrics_sink = file;
+	}
+
+	/*! \brief Number of symbolic analysis done by the solver
+	 *
+	 * \return the number of analysis
+	 *
+	 */
+	size_t getNAnalyze()
+	{
+		return n_analyze;
+	}
+
+	/*! \brief Number of numeric factorization done by the solver
+	 *
+	 * \return the number of factorizations
+	 *
+	 */
+	size_t getNFactorize()
+	{
+		return n_factorize;
+	}
+
+	/*! \brief Solve a system given in CSR on the device
+	 *
+	 * The pointers are not kept, the matrix is copied in the solver. It runs on the processor that calls it
+	 *
+	 * \param nr number of rows
+	 * \param nz number of non zero
+	 * \param d_rowOff row offsets (nr+1, device)
+	 * \param d_cols column of every non zero, sorted in every row (device)
+	 * \param d_vals values (device)
+	 * \param b right hand sides (nr x nrhs column major, device)
+	 * \param x solutions (nr x nrhs column major, device)
+	 * \param nrhs number of right hand sides
+	 *
+	 * \return true if the system is solved
+	 *
+	 */
+	bool solve_csr_device(int nr, int nz, const int * d_rowOff, const int * d_cols, const double * d_vals,
+	                      const double * b, double * x, int nrhs = 1)
+	{
+		metrics.reset_solve();
+
+		timer t_fact;
+		t_fact.start();
+
+		bool ok = factorize_cached(nr,nz,d_rowOff,d_cols,d_vals);
+		cudaDeviceSynchronize();
+
+		t_fact.stop();
+		metrics.pc_setup_time = t_fact.getwct();
+
+		if (ok == false)
+		{
+			std::cout << __FILE__ << ":" << __LINE__ << " solver failed" << "\n";
+			metrics.converged = false;
+			return false;
+		}
+
+		timer t_solve;
+		t_solve.start();
+
+		ok = execute(CUDSS_PHASE_SOLVE,x,const_cast<double *>(b),nrhs);
+		cudaDeviceSynchronize();
+
+		t_solve.stop();
+		metrics.solve_time = t_solve.getwct();
+		metrics.converged = ok;
+
+		solve_metrics(nrhs);
+
+		return ok;
+	}
+
+	/*! \brief Solve a system given as triplets on the device
+	 *
+	 * The triplets are sorted by row and column on the device and the duplicated entries are summed (as
+	 * SparseMatrix does when it is filled from the triplets), then it solves as solve_csr_device
+	 *
+	 * \param nr number of rows
+	 * \param nt number of triplets
+	 * \param d_rows row of every triplet (device)
+	 * \param d_cols column of every triplet (device)
+	 * \param d_vals value of every triplet (device)
+	 * \param b right hand sides (nr x nrhs column major, device)
+	 * \param x solutions (nr x nrhs column major, device)
+	 * \param nrhs number of right hand sides
+	 *
+	 * \return true if the system is solved
+	 *
+	 */
+	bool solve_triplets_device(int nr, int nt, const int * d_rows, const int * d_cols, const double * d_vals,
+	                           const double * b, double * x, int nrhs = 1)
+	{
+		timer t_fill;
+		t_fill.start();
+
+		gpu_direct_buffer<int> sRows, sCols;
+		gpu_direct_buffer<double> sVals;
+		sRows.resize(nt);
+		sCols.resize(nt);
+		sVals.resize(nt);
+		cudaMemcpy(sRows.get(),d_rows,nt*sizeof(int),cudaMemcpyDeviceToDevice);
+		cudaMemcpy(sCols.get(),d_cols,nt*sizeof(int),cudaMemcpyDeviceToDevice);
+		cudaMemcpy(sVals.get(),d_vals,nt*sizeof(double),cudaMemcpyDeviceToDevice);
+
+		thrust::device_ptr<int> r(sRows.get()), c(sCols.get());
+		thrust::device_ptr<double> v(sVals.get());
+
+		auto keys = thrust::make_zip_iterator(thrust::make_tuple(r,c));
+		thrust::sort_by_key(keys,keys+nt,v);
+
+		inRows.resize(nt);
+		inCols.resize(nt);
+		inVals.resize(nt);
+		thrust::device_ptr<int> ur(inRows.get()), uc(inCols.get());
+		thrust::device_ptr<double> uv(inVals.get());
+
+		auto ukeys = thrust::make_zip_iterator(thrust::make_tuple(ur,uc));
+		auto end = thrust::reduce_by_key(keys,keys+nt,v,ukeys,uv);
+		int nz = end.second - uv;
+
+		// row offsets: first entry of every row in the sorted rows
+		inRowOff.resize(nr+1);
+		thrust::lower_bound(ur,ur+nz,thrust::counting_iterator<int>(0),thrust::counting_iterator<int>(nr+1),
+		                    thrust::device_ptr<int>(inRowOff.get()));
+
+		t_fill.stop();
+
+		bool ok = solve_csr_device(nr,nz,inRowOff.get(),inCols.get(),inVals.get(),b,x,nrhs);
+		metrics.fill_time = t_fill.getwct();
+
+		return ok;
+	}
+
+	/*! \brief Here we factorize the matrix on the device and solve the system
+	 *
+	 *  \warning it is not a parallel solver, the system is collected and solved on processor 0
+	 *
+	 */
+	Vector<double,EIGEN_BASE> try_solve(SparseMatrix<double,int,EIGEN_BASE> & A, const Vector<double,EIGEN_BASE> & b, size_t opt = UMFPACK_NONE)
+	{
+		return solve(A,b,opt);
+	}
+
+	/*! \brief Here we factorize the matrix on the device and solve the system
+	 *
+	 *  \warning it is not a parallel solver, the system is collected and solved on processor 0
+	 *
+	 * \param A sparse matrix
+	 * \param b right hand side
+	 * \param opt options (SOLVER_PRINT_RESIDUAL_NORM_INFINITY)
+	 *
+	 * \return the solution
+	 *
+	 */
+	Vector<double,EIGEN_BASE> solve(SparseMatrix<double,int,EIGEN_BASE> & A, const Vector<double,EIGEN_BASE> & b, size_t opt = UMFPACK_NONE)
+	{
+		std::vector<Vector<double,EIGEN_BASE>> vb(1);
+		vb[0] = b;
+
+		return solve(A,vb,opt)[0];
+	}
+
+	/*! \brief Factorize the matrix once and solve the system for several right hand sides
+	 *
+	 * The right hand sides are packed in the colums of one dense matrix on the device and solved together
+	 *
+	 *  \warning it is not a parallel solver, the system is collected and solved on processor 0
+	 *
+	 * \param A sparse matrix
+	 * \param b right hand sides
+	 * \param opt options (SOLVER_PRINT_RESIDUAL_NORM_INFINITY)
+	 *
+	 * \return one solution for each right hand side
+	 *
+	 */
+	std::vector<Vector<double,EIGEN_BASE>> solve(SparseMatrix<double,int,EIGEN_BASE> & A, const std::vector<Vector<double,EIGEN_BASE>> & b, size_t opt = UMFPACK_NONE)
+	{
+		Vcluster<> & vcl = create_vcluster();
+
+		std::vector<Vector<double,EIGEN_BASE>> x(b.size());
+
+		if (b.size() == 0)
+		{return x;}
+
+		timer t_fill;
+		t_fill.start();
+
+		// Collect the matrix on master
+		const Eigen::SparseMatrix<double,0,int> & mat_A = A.getMat();
+
+		Eigen::Matrix<double, Eigen::Dynamic, Eigen::Dynamic> B;
+
+		for (size_t j = 0 ; j < b.size() ; j++)
+		{
+			// Collect the vector on master
+			const Eigen::Matrix<double, Eigen::Dynamic, 1> & b_ei = b[j].getVec();
+
+			if (vcl.getProcessUnitID() == 0)
+			{
+				if (j == 0) {B.resize(b_ei.size(),b.size());}
+				B.col(j) = b_ei;
+			}
+
+			// Copy b into x, this also copy the information on how to scatter back the information on x
+			x[j] = b[j];
+		}
+
+		if (vcl.getProcessUnitID() == 0)
+		{
+			Eigen::SparseMatrix<double,Eigen::RowMajor,int> csr = mat_A;
+			csr.makeCompressed();
+
+			t_fill.stop();
+
+			int nr = csr.rows();
+			int nrhs = b.size();
+
+			gpu_direct_buffer<double> bb, xx;
+			bb.resize(nr*nrhs);
+			xx.resize(nr*nrhs);
+			cudaMemcpy(bb.get(),B.data(),nr*nrhs*sizeof(double),cudaMemcpyHostToDevice);
+
+			upload(csr);
+
+			bool ok = solve_csr_device(nr,csr.nonZeros(),inRowOff.get(),inCols.get(),inVals.get(),bb.get(),xx.get(),nrhs);
+			metrics.fill_time = t_fill.getwct();
+
+			if (ok == false)
+			{
+				for (size_t j = 0 ; j < x.size() ; j++)
+				{x[j].scatter();}
+
+				return x;
+			}
+
+			Eigen::Matrix<double, Eigen::Dynamic, Eigen::Dynamic> X(nr,nrhs);
+			cudaMemcpy(X.data(),xx.get(),nr*nrhs*sizeof(double),cudaMemcpyDeviceToHost);
+
+			Eigen::Matrix<double, Eigen::Dynamic, Eigen::Dynamic> res = csr * X - B;
+			metrics.residual = res.lpNorm<Eigen::Infinity>();
+
+			if (opt & SOLVER_PRINT_RESIDUAL_NORM_INFINITY)
+			{std::cout << "Infinity norm: " << metrics.residual << "\n";}
+
+			if (metrics_sink.size() != 0)
+			{metrics.append(metrics_sink);}
+
+			for (size_t j = 0 ; j < x.size() ; j++)
+			{
+				Eigen::Matrix<double, Eigen::Dynamic, 1> x_ei = X.col(j);
+				x[j] = x_ei;
+			}
+		}
+
+		// Vectors are only on master, scatter back the information
+		for (size_t j = 0 ; j < x.size() ; j++)
+		{x[j].scatter();}
+
+		return x;
+	}
+
+	/*! \brief Solve with the last factorization
+	 *
+	 *  \warning it is not a parallel solver, the system is collected and solved on processor 0
+	 *
+	 * \param b right hand side
+	 * \param opt options
+	 *
+	 * \return the solution
+	 *
+	 */
+	Vector<double,EIGEN_BASE> solve(const Vector<double,EIGEN_BASE> & b, size_t opt = UMFPACK_NONE)
+	{
+		Vcluster<> & vcl = create_vcluster();
+
+		Vector<double> x;
+
+		// Collect the vector on master
+		auto b_ei = b.getVec();
+
+		// Copy b into x, this also copy the information on how to scatter back the information on x
+		x = b;
+
+		if (vcl.getProcessUnitID() == 0)
+		{
+			if (factorized == false || (int)b_ei.size() != n)
+			{
+				std::cerr << __FILE__ << ":" << __LINE__ << " error, no factorization of a matrix of this size" << std::endl;
+				x.scatter();
+				return x;
+			}
+
+			Eigen::Matrix<double, Eigen::Dynamic, 1> x_ei(n);
+
+			cudaMemcpy(d_b.get(),b_ei.data(),n*sizeof(double),cudaMemcpyHostToDevice);
+			execute(CUDSS_PHASE_SOLVE,d_x.get(),d_b.get(),1);
+			cudaMemcpy(x_ei.data(),d_x.get(),n*sizeof(double),cudaMemcpyDeviceToHost);
+
+			if (opt & SOLVER_PRINT_RESIDUAL_NORM_INFINITY)
+			{
+				std::cout << "gpu_direct_solver: unsupported you have to pass the matrix for the option SOLVER_PRINT_RESIDUAL_NORM_INFINITY "  << "\n";
+			}
+
+			x = x_ei;
+		}
+
+		// Vector is only on master, scatter back the information
+		x.scatter();
+
+		return x;
+	}
+};
+
+#else
+
+/////// Compiled without cuDSS support
+
+#include "Vector/Vector.hpp"
+
+//! stub when library compiled without cuDSS
+template<typename T>
+class gpu_direct_solver
+{
+public:
+
+	//! stub solve
+	template<unsigned int impl, typename id_type> static Vector<T> solve(const SparseMatrix<T,id_type,impl> & A, const Vector<T,impl> & b)
+	{
+		std::cerr << __FILE__ << ":" << __LINE__ << " Error gpu_direct_solver only support double precision" << std::endl;
+		return Vector<T>();
+	}
+};
+
+//! stub when library compiled without cuDSS
+template<>
+class gpu_direct_solver<double>
+{
+
+public:
+
+	//! stub solve
+	template<unsigned int impl, typename id_type> static Vector<double> solve(SparseMatrix<double,id_type,impl> & A, const Vector<double> & b, size_t opt = UMFPACK_NONE)
+	{
+		std::cerr << __FILE__ << ":" << __LINE__ << " Error in order to use gpu_direct_solver you must compile OpenFPM with CUDA and cuDSS" << std::endl;
+
+		Vector<double> x;
+
+		return x;
+	}
+
+	//! stub solve
+	static Vector<double,EIGEN_BASE> try_solve(SparseMatrix<double,int,EIGEN_BASE> & A, const Vector<double,EIGEN_BASE> & b, size_t opt = UMFPACK_NONE)
+	{
+		std::cerr << __FILE__ << ":" << __LINE__ << " Error in order to use gpu_direct_solver you must compile OpenFPM with CUDA and cuDSS" << std::endl;
+		return Vector<double,EIGEN_BASE>();
+	}
+};
+
+#endif
+
+#endif /* OPENFPM_NUMERICS_SRC_SOLVERS_GPU_DIRECT_SOLVER_HPP_ */
@@ -0,0 +1,124 @@
+/*
+ * gpu_direct_solver_unit_tests.cu
+ *
+ * Tests of the cuDSS direct solver
+ */
+
+#include "config.h"
+
+#define BOOST_TEST_DYN_LINK
+#include <boost/test/unit_test.hpp>
+
+#include "Matrix/SparseMatrix.hpp"
+#include "Vector/Vector.hpp"
+#include "Solvers/gpu_direct_solver.hpp"
+
+BOOST_AUTO_TEST_SUITE( gpu_direct_solver_test_suite )
+
+BOOST_AUTO_TEST_CASE(gpu_direct_solver_factorization_cache)
+{
+#if defined(HAVE_EIGEN) && defined(HAVE_CUDSS) && defined(HAVE_SUITESPARSE)
+
+	Vcluster<> & vcl = create_vcluster();
+
+	if (vcl.getProcessingUnits() != 1)
+		return;
+
+	const int N = 100;
+
+	SparseMatrix<double,int> sm(N,N);
+	Vector<double> b(N);
+
+	typedef SparseMatrix<double,int>::triplet_type triplet;
+
+	gpu_direct_solver<double> solver;
+	umfpack_solver<double> ref;
+
+	for (int step = 1 ; step <= 3 ; step++)
+	{
+		auto & triplets = sm.getMatrixTriplets();
+		triplets.clear();
+
+		// the values change only at the step 3
+		double d = (step == 3)?3.0:2.5;
+
+		for (int i = 0 ; i < N ; i++)
+		{
+			if (i > 0) {triplets.add(triplet(i,i-1,-1.0));}
+			triplets.add(triplet(i,i,d));
+			if (i < N-1) {triplets.add(triplet(i,i+1,-1.2));}
+
+			if (step == 1) {b.insert(i,cos(0.05*i));}
+		}
+
+		auto x = solver.solve(sm,b);
+		auto x_ref = ref.solve(sm,b);
+
+		for (int i = 0 ; i < N ; i++)
+		{BOOST_REQUIRE_SMALL(x(i) - x_ref(i),1e-10);}
+	}
+
+	// one analysis, a new factorization only when the values change
+	BOOST_REQUIRE_EQUAL(solver.getNAnalyze(),1ul);
+	BOOST_REQUIRE_EQUAL(solver.getNFactorize(),2ul);
+	BOOST_REQUIRE(solver.getMetrics().residual < 1e-10);
+
+#endif
+}
+
+BOOST_AUTO_TEST_CASE(gpu_direct_solver_device_triplets)
+{
+#if defined(HAVE_EIGEN) && defined(HAVE_CUDSS)
+
+	const int N = 64;
+
+	// unsorted triplets with the diagonal split in two entries
+	std::vector<int> r, c;
+	std::vector<double> v, b(N,1.0);
+	for (int i = N-1 ; i >= 0 ; i--)
+	{
+		if (i < N-1) {r.push_back(i); c.push_back(i+1); v.push_back(-1.0);}
+		r.push_back(i); c.push_back(i); v.push_back(1.0);
+		if (i > 0) {r.push_back(i); c.push_back(i-1); v.push_back(-1.0);}
+		r.push_back(i); c.push_back(i); v.push_back(2.0);
+	}
+
+	int nt = r.size();
+	int *d_r, *d_c;
+	double *d_v, *d_b, *d_x;
+	cudaMalloc((void **)&d_r,nt*sizeof(int));
+	cudaMalloc((void **)&d_c,nt*sizeof(int));
+	cudaMalloc((void **)&d_v,nt*sizeof(double));
+	cudaMalloc((void **)&d_b,N*sizeof(double));
+	cudaMalloc((void **)&d_x,N*sizeof(double));
+	cudaMemcpy(d_r,r.data(),nt*sizeof(int),cudaMemcpyHostToDevice);
+	cudaMemcpy(d_c,c.data(),nt*sizeof(int),cudaMemcpyHostToDevice);
+	cudaMemcpy(d_v,v.data(),nt*sizeof(double),cudaMemcpyHostToDevice);
+	cudaMemcpy(d_b,b.data(),N*sizeof(double),cudaMemcpyHostToDevice);
+
+	gpu_direct_solver<double> solver;
+	BOOST_REQUIRE(solver.solve_triplets_device(N,nt,d_r,d_c,d_v,d_b,d_x));
+	BOOST_REQUIRE_EQUAL(solver.getMetrics().nnz,(size_t)(3*N-2));
+
+	std::vector<double> x(N);
+	cudaMemcpy(x.data(),d_x,N*sizeof(double),cudaMemcpyDeviceToHost);
+
+	// residual of the tridiagonal system (3 on the diagonal)
+	for (int i = 0 ; i < N ; i++)
+	{
+		double ax = 3.0*x[i];
+		if (i > 0) {ax -= x[i-1];}
+		if (i < N-1) {ax -= x[i+1];}
+		BOOST_REQUIRE_SMALL(ax - b[i],1e-10);
+	}
+
+	cudaFree(d_r);
+	cudaFree(d_c);
+	cudaFree(d_v);
+	cudaFree(d_b);
+	cudaFree(d_x);
+
+#endif
+}
+
+BOOST_AUTO_TEST_SUITE_END()
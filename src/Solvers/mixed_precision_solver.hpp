@@ -0,0 +1,277 @@
+/*
+ * mixed_precision_solver.hpp
+ *
+ *  Mixed precision direct solver with iterative refinement in double precision
+ */
+
+#ifndef OPENFPM_NUMERICS_SRC_SOLVERS_MIXED_PRECISION_SOLVER_HPP_
+#define OPENFPM_NUMERICS_SRC_SOLVERS_MIXED_PRECISION_SOLVER_HPP_
+
+#include "Solvers/umfpack_solver.hpp"
+
+#if defined(HAVE_EIGEN)
+
+/////// Compiled with EIGEN support
+
+#include "Vector/Vector.hpp"
+#include <Eigen/SparseLU>
+
+template<typename T>
+class mixed_precision_solver
+{
+public:
+
+	template<unsigned int impl, typename id_type> static Vector<T> solve(const SparseMatrix<T,id_type,impl> & A, const Vector<T> & b)
+	{
+		std::cerr << __FILE__ << ":" << __LINE__ << " Error mixed_precision_solver only support double precision, and int ad id type" << "\n";
+	}
+};
+
+/*! \brief Direct solver factorizing in single precision with iterative refinement in double precision
+ *
+ * The matrix is copied in single precision and factorized with a sparse LU, the factorization has half of the
+ * memory and memory traffic of the double one. The solution is then refined in double precision
+ *
+ * r = b - A x (double), solve LU d = r (single), x = x + d
+ *
+ * until the relative residual ||r||_inf / ||b||_inf is below the tolerance. For well conditioned systems (like
+ * diffusion) few refinement steps give the accuracy of the double precision solve. If the refinement stagnates
+ * (the matrix is too ill conditioned for single precision) the solver fall back to a double precision factorization.
+ * It can be used as Sys_eqs::solver_type or with solve_with_solver
+ *
+ *  \warning like umfpack it is not a parallel solver, the system is collected and solved on processor 0
+ *
+ */
+template<>
+class mixed_precision_solver<double>
+{
+	//! single precision factorization
+	Eigen::SparseLU<Eigen::SparseMatrix<float,0,int>> solver_f;
+
+	//! double precision factorization (fall back)
+	Eigen::SparseLU<Eigen::SparseMatrix<double,0,int>> solver_d;
+
+	//! single precision copy of the matrix
+	Eigen::SparseMatrix<float,0,int> mat_f;
+
+	//! relative tolerance of the refinement
+	double tol = 1e-10;
+
+	//! maximum number of refinement steps
+	size_t max_it = 20;
+
+	//! refinement steps done by the last solve
+	size_t n_it = 0;
+
+	//! the last solve used the double precision factorization
+	bool fall_back = false;
+
+	//! relative residual of the last solve
+	double res = 0.0;
+
+	/*! \brief Refine the solution x of the system mat x = b
+	 *
+	 * \param mat double precision matrix
+	 * \param b right hand side
+	 * \param x solution
+	 *
+	 * \return true if the tolerance has been reached
+	 *
+	 */
+	bool refine(const Eigen::SparseMatrix<double,0,int> & mat,
+				const Eigen::Matrix<double, Eigen::Dynamic, 1> & b,
+				Eigen::Matrix<double, Eigen::Dynamic, 1> & x)
+	{
+		double b_norm = b.lpNorm<Eigen::Infinity>();
+		if (b_norm == 0.0)	{b_norm = 1.0;}
+
+		Eigen::Matrix<float, Eigen::Dynamic, 1> r_f = b.cast<float>();
+		Eigen::Matrix<float, Eigen::Dynamic, 1> d_f = solver_f.solve(r_f);
+		x = d_f.cast<double>();
+
+		Eigen::Matrix<double, Eigen::Dynamic, 1> r = b - mat * x;
+		res = r.lpNorm<Eigen::Infinity>() / b_norm;
+
+		for (n_it = 0 ; n_it < max_it && res > tol ; n_it++)
+		{
+			double res_old = res;
+
+			r_f = r.cast<float>();
+			d_f = solver_f.solve(r_f);
+			x += d_f.cast<double>();
+
+			r = b - mat * x;
+			res = r.lpNorm<Eigen::Infinity>() / b_norm;
+
+			// stagnation, single precision is not enough
+			if (res > 0.5 * res_old)
+			{return res <= tol;}
+		}
+
+		return res <= tol;
+	}
+
+public:
+
+	/*! \brief Set the relative tolerance of the refinement
+	 *
+	 * \param tol tolerance on ||b - A x||_inf / ||b||_inf
+	 *
+	 */
+	void setTolerance(double tol)
+	{
+		this->tol = tol;
+	}
+
+	/*! \brief Set the maximum number of refinement steps
+	 *
+	 * \param max_it maximum number of steps
+	 *
+	 */
+	void setMaxIterations(size_t max_it)
+	{
+		this->max_it = max_it;
+	}
+
+	/*! \brief Number of refinement steps of the last solve
+	 *
+	 * \return the number of steps
+	 *
+	 */
+	size_t getIterations()
+	{
+		return n_it;
+	}
+
+	/*! \brief Relative residual of the last solve
+	 *
+	 * \return the relative residual ||b - A x||_inf / ||b||_inf
+	 *
+	 */
+	double getResidual()
+	{
+		return res;
+	}
+
+	/*! \brief Return true if the last solve fall back to a double precision factorization
+	 *
+	 * \return true if the double precision factorization has been used
+	 *
+	 */
+	bool isFallBack()
+	{
+		return fall_back;
+	}
+
+	/*! \brief Here we invert the matrix and solve the system
+	 *
+	 * \param A sparse matrix
+	 * \param b vector
+	 * \param opt options
+	 *
+	 * \return the solution
+	 *
+	 */
+	Vector<double,EIGEN_BASE> try_solve(SparseMatrix<double,int,EIGEN_BASE> & A, const Vector<double,EIGEN_BASE> & b, size_t opt = UMFPACK_NONE)
+	{
+		return solve(A,b,opt);
+	}
+
+	/*! \brief Here we invert the matrix and solve the system
+	 *
+	 *  \warning it is not a parallel solver, the system is solved on processor 0
+	 *
+	 * \param A sparse matrix
+	 * \param b vector
+	 * \param opt options
+	 *
+	 * \return the solution
+	 *
+	 */
+	Vector<double,EIGEN_BASE> solve(SparseMatrix<double,int,EIGEN_BASE> & A, const Vector<double,EIGEN_BASE> & b, size_t opt = UMFPACK_NONE)
+	{
+		Vcluster<> & vcl = create_vcluster();
+
+		Vector<double> x;
+
+		// Collect the matrix on master
+		const Eigen::SparseMatrix<double,0,int> & mat_A = A.getMat();
+
+		// Collect the vector on master
+		auto b_ei = b.getVec();
+
+		// Copy b into x, this also copy the information on how to scatter back the information on x
+		x = b;
+
+		if (vcl.getProcessUnitID() == 0)
+		{
+			Eigen::Matrix<double, Eigen::Dynamic, 1> x_ei;
+
+			mat_f = mat_A.cast<float>();
+			mat_f.makeCompressed();
+
+			solver_f.compute(mat_f);
+
+			fall_back = (solver_f.info() != Eigen::Success) || refine(mat_A,b_ei,x_ei) == false;
+
+			if (fall_back == true)
+			{
+				solver_d.compute(mat_A);
+
+				if(solver_d.info()!=Eigen::Success)
+				{
+					// Linear solver failed
+					std::cout << __FILE__ << ":" << __LINE__ << " solver failed" << "\n";
+
+					x.scatter();
+
+					return x;
+				}
+
+				x_ei = solver_d.solve(b_ei);
+
+				double b_norm = b_ei.lpNorm<Eigen::Infinity>();
+				res = (mat_A * x_ei - b_ei).lpNorm<Eigen::Infinity>() / ((b_norm == 0.0)?1.0:b_norm);
+			}
+
+			if (opt & SOLVER_PRINT_RESIDUAL_NORM_INFINITY)
+			{
+				std::cout << "Infinity norm: " << (mat_A * x_ei - b_ei).lpNorm<Eigen::Infinity>() << " refinement steps: " << n_it << ((fall_back == true)?" (double precision fall back)":"") << "\n";
+			}
+
+			x = x_ei;
+		}
+
+		// Vector is only on master, scatter back the information
+		x.scatter();
+
+		return x;
+	}
+};
+
+#else
+
+/////// Compiled without EIGEN support
+
+#include "Vector/Vector.hpp"
+
+//! stub when library compiled without eigen
+template<typename T>
+class mixed_precision_solver
+{
+public:
+
+	//! stub solve
+	template<unsigned int impl, typename id_type> static Vector<T> solve(SparseMatrix<T,id_type,impl> & A, const Vector<T> & b, size_t opt = UMFPACK_NONE)
+	{
+		std::cerr << __FILE__ << ":" << __LINE__ << " Error in order to use mixed_precision_solver you must compile OpenFPM with linear algebra support" << "\n";
+
+		Vector<T> x;
+
+		return x;
+	}
+};
+
+#endif
+
+#endif /* OPENFPM_NUMERICS_SRC_SOLVERS_MIXED_PRECISION_SOLVER_HPP_ */
@@ -9,6 +9,7 @@
 #define OPENFPM_NUMERICS_SRC_SOLVERS_PETSC_SOLVER_HPP_
 
 #include "config.h"
+#include <utility>
 
 #ifdef HAVE_PETSC
 
@@ -18,8 +19,14 @@
 #include "Plot/GoogleChart.hpp"
 #include "Matrix/SparseMatrix.hpp"
 #include "Vector/Vector.hpp"
+#include "Solvers/solver_metrics.hpp"
+#include "initialize/numerics_backends.hpp"
 #include <sstream>
 #include <iomanip>
+#include <vector>
+#include <fstream>
+#include <limits>
+#include <cmath>
 
 template <typename T>
 std::string to_string_with_precision(const T a_value, const int n = 6)
@@ -35,6 +42,8 @@ std::string to_string_with_precision(const T a_value, const int n = 6)
 #define REL_ALL 3
 
 #define PCHYPRE_BOOMERAMG "petsc_boomeramg"
+#define PCASM_BOOMERAMG "petsc_asm_boomeramg"
+#define PCASM_LU "petsc_asm_lu"
 
 enum AMG_type
 {
@@ -44,6 +53,57 @@ enum AMG_type
 	TRILINOS_ML
 };
 
+/*! \brief When the preconditioner is rebuilt across solves
+ *
+ * PC_REBUILD: set up again at every solve (default)
+ * PC_REUSE_SAME_OPERATOR: rebuilt only when the matrix object or its values changed
+ * PC_LAG: rebuilt only every N solves (or when the matrix object changed), even if the values changed
+ * PC_REUSE_HIERARCHY: like PC_REUSE_SAME_OPERATOR, but a multigrid preconditioner keep its hierarchy
+ *                     (coarsening and interpolation) and only the numerical part is refreshed
+ *
+ */
+enum pc_reuse_policy
+{
+	PC_REBUILD,
+	PC_REUSE_SAME_OPERATOR,
+	PC_LAG,
+	PC_REUSE_HIERARCHY
+};
+
+/*! \brief What the monitor of the benchmarks (try_solve) computes at every iteration
+ *
+ * MONITOR_TRUE_RESIDUAL: build the true residual and compute its infinity norm, two more reductions per iteration
+ * MONITOR_NO_SYNC: record the norm the Krylov solver already computed (for the pipelined solvers the norm
+ *                  of the lagged residual), no communication is added
+ *
+ */
+enum petsc_monitor_mode
+{
+	MONITOR_TRUE_RESIDUAL,
+	MONITOR_NO_SYNC
+};
+
+/*! \brief Field split preconditioners for systems with several variables per point (see setPreconditionerFieldSplit)
+ *
+ * FIELDSPLIT_ADDITIVE: block Jacobi on the fields
+ * FIELDSPLIT_MULTIPLICATIVE: block Gauss-Seidel on the fields
+ * FIELDSPLIT_SCHUR_SIMPLE: block factorization with the Schur complement of the second field approximated by
+ *                          A11 - A10 diag(A00)^-1 A01 (SIMPLE)
+ * FIELDSPLIT_SCHUR_LSC: block factorization with the least squares commutator approximation of the inverse Schur complement
+ * FIELDSPLIT_SCHUR_MASS: block factorization with the Schur complement preconditioned by a pressure mass matrix
+ *                        (setFieldSplitSchurMatrix) or by a scaled identity (setFieldSplitMassScale)
+ *
+ */
+enum fieldsplit_type
+{
+	FIELDSPLIT_NONE,
+	FIELDSPLIT_ADDITIVE,
+	FIELDSPLIT_MULTIPLICATIVE,
+	FIELDSPLIT_SCHUR_SIMPLE,
+	FIELDSPLIT_SCHUR_LSC,
+	FIELDSPLIT_SCHUR_MASS
+};
+
 
 /*! \brief In case T does not match the PETSC precision compilation create a
  *         stub structure
@@ -135,6 +195,9 @@ class petsc_solver<double>
 	//! indicate if the preconditioner is set
 	bool is_preconditioner_set = false;
 
+	//! ordering of the local rows applied to the system before the solve (empty for none)
+	std::string reorder_type;
+
 	//! KSP Maximum number of iterations
 	PetscInt maxits;
 
@@ -157,6 +220,557 @@ class petsc_solver<double>
 	//! Block size
 	int block_sz = 0;
 
+	//! the AMG is the solver of the subdomains of an additive Schwarz preconditioner
+	bool amg_sub = false;
+
+	/*! \brief Name of a BoomerAMG option, prefixed with -sub_ when the AMG solves the ASM subdomains
+	 *
+	 * \param opt option without prefix (for example "max_levels")
+	 *
+	 * \return the option name
+	 *
+	 */
+	std::string amg_option(const char * opt)
+	{
+		return std::string((amg_sub == true)?"-sub_pc_hypre_boomeramg_":"-pc_hypre_boomeramg_") + opt;
+	}
+
+	//! what the monitor of the benchmarks computes
+	petsc_monitor_mode mon_mode = MONITOR_TRUE_RESIDUAL;
+
+	//! policy to rebuild the preconditioner
+	pc_reuse_policy pc_policy = PC_REBUILD;
+
+	//! with PC_LAG the preconditioner is rebuilt every pc_lag solves
+	int pc_lag = 1;
+
+	//! number of solves since the last preconditioner set-up
+	int pc_n_solves = 0;
+
+	//! matrix used for the last preconditioner set-up
+	Mat pc_mat = NULL;
+
+	//! state of the matrix at the last solve
+	PetscObjectState pc_mat_state = 0;
+
+	//! matrix and state of the matrix at the last preconditioner set-up done by PETSc
+	Mat pc_setup_mat = NULL;
+	PetscObjectState pc_setup_state = 0;
+
+	//! number of preconditioner set-up done
+	size_t pc_n_setup = 0;
+
+	//! metrics of the last solve
+	solver_metrics metrics;
+
+	//! file where the metrics of every solve are appended (empty for none)
+	std::string metrics_sink;
+
+	//! record the residual norm of every iteration in the metrics
+	bool record_history = false;
+
+	//! buffer of the residual history
+	std::vector<PetscReal> res_hist;
+
+	/*! \brief Fill the matrix from its triplets (if needed) recording the fill time in the metrics
+	 *
+	 * \param A matrix
+	 *
+	 * \return the PETSc matrix
+	 *
+	 */
+	Mat & fill_timed(SparseMatrix<double,int,PETSC_BASE> & A)
+	{
+		timer t;
+		t.start();
+		Mat & A_ = A.getMat();
+		t.stop();
+
+		metrics.fill_time = t.getwct();
+
+		return A_;
+	}
+
+	/*! \brief Set-up and solve recording the metrics
+	 *
+	 * The preconditioner set-up is done explicitly with KSPSetUp to time it apart from the iterations
+	 *
+	 * \param A_ Matrix
+	 * \param b_ right hand side
+	 * \param x_ solution
+	 *
+	 */
+	void solve_metered(const Mat & A_, const Vec & b_, Vec & x_)
+	{
+		if (record_history == true)
+		{
+			res_hist.resize(maxits + 1);
+			PETSC_SAFE_CALL(KSPSetResidualHistory(ksp,res_hist.data(),res_hist.size(),PETSC_TRUE));
+		}
+
+		PetscLogDouble f_start;
+		PetscLogDouble f_stop;
+		PETSC_SAFE_CALL(PetscGetFlops(&f_start));
+
+		timer t_setup;
+		t_setup.start();
+		PETSC_SAFE_CALL(KSPSetUp(ksp));
+		t_setup.stop();
+
+		timer t_solve;
+		t_solve.start();
+		PETSC_SAFE_CALL(KSPSolve(ksp,b_,x_));
+		t_solve.stop();
+
+		PETSC_SAFE_CALL(PetscGetFlops(&f_stop));
+
+		PetscInt its;
+		PetscReal rnorm;
+		KSPConvergedReason reason;
+		PETSC_SAFE_CALL(KSPGetIterationNumber(ksp,&its));
+		PETSC_SAFE_CALL(KSPGetResidualNorm(ksp,&rnorm));
+		PETSC_SAFE_CALL(KSPGetConvergedReason(ksp,&reason));
+
+		// only local queries, the values are reduced when they are read (solver_metrics::reduce)
+		PetscInt row;
+		PetscInt col;
+		PetscInt l_row;
+		PetscInt l_col;
+		MatInfo info;
+		PETSC_SAFE_CALL(MatGetSize(A_,&row,&col));
+		PETSC_SAFE_CALL(MatGetLocalSize(A_,&l_row,&l_col));
+		PETSC_SAFE_CALL(MatGetInfo(A_,MAT_LOCAL,&info));
+
+		metrics.pc_setup_time = t_setup.getwct();
+		metrics.solve_time = t_solve.getwct();
+		metrics.iterations = its;
+		metrics.converged = (reason > 0);
+		metrics.residual = rnorm;
+		metrics.rows = row;
+		metrics.nnz = info.nz_used;
+		metrics.flops = f_stop - f_start;
+
+		// every iteration stream the matrix once and few vectors (estimate)
+		metrics.bytes = (double)its * (metrics.nnz * (sizeof(PetscScalar) + sizeof(PetscInt)) +
+												l_row * (sizeof(PetscInt) + 4 * sizeof(PetscScalar)));
+		metrics.local = true;
+
+		metrics.residual_history.clear();
+		if (record_history == true)
+		{
+			const PetscReal * hist;
+			PetscInt na;
+			PETSC_SAFE_CALL(KSPGetResidualHistory(ksp,&hist,&na));
+			metrics.residual_history.assign(hist,hist + na);
+		}
+
+		if (metrics_sink.size() != 0)
+		{
+			metrics.reduce();
+
+			if (create_vcluster().getProcessUnitID() == 0)
+			{metrics.append(metrics_sink);}
+		}
+	}
+
+	//! field split preconditioner (FIELDSPLIT_NONE for none)
+	fieldsplit_type fs_type = FIELDSPLIT_NONE;
+
+	//! variables of every field (empty for all the variables but the last in the first field, the last in the second)
+	std::vector<std::vector<unsigned int>> fs_fields;
+
+	//! number of variables interleaved in the rows (row = point*nvar + variable)
+	unsigned int fs_nvar = 0;
+
+	//! index sets of the fields given to the preconditioner
+	std::vector<IS> fs_is;
+
+	//! preconditioning matrix of the Schur complement with FIELDSPLIT_SCHUR_MASS
+	Mat fs_schur_pre = NULL;
+
+	//! fs_schur_pre is the scaled identity created here
+	bool fs_schur_pre_owned = false;
+
+	//! scale of the identity that replaces the mass matrix
+	PetscScalar fs_mass_scale = 1.0;
+
+	//! Set a PETSc option if the user did not set it
+	static void set_default_option(const std::string & name, const char * value)
+	{
+		PetscBool set;
+		PETSC_SAFE_CALL(PetscOptionsHasName(NULL,NULL,name.c_str(),&set));
+		if (set == PETSC_FALSE)
+		{PETSC_SAFE_CALL(PetscOptionsSetValue(NULL,name.c_str(),value));}
+	}
+
+	/*! \brief Give the index sets of the fields to PCFIELDSPLIT (at the first set-up)
+	 *
+	 * The variable of the global row r is r % fs_nvar, every field gets the local rows of its variables. The
+	 * fields are solved with one AMG cycle, the Schur complement with the preconditioner of the preset. Every
+	 * default can be changed with the options -fieldsplit_<field>_ (fields are numbered from 0)
+	 *
+	 * \param A_ matrix of the system
+	 *
+	 */
+	void setup_fieldsplit(const Mat & A_)
+	{
+		if (fs_type == FIELDSPLIT_NONE || fs_is.size() != 0)
+		{return;}
+
+		if (fs_nvar < 2)
+		{
+			std::cerr << __FILE__ << ":" << __LINE__ << " error, the field split needs the number of variables of the system (setFieldSplitLayout)" << std::endl;
+			return;
+		}
+
+		std::vector<std::vector<unsigned int>> fields = fs_fields;
+		if (fields.size() == 0)
+		{
+			fields.resize(2);
+			for (unsigned int v = 0 ; v + 1 < fs_nvar ; v++)
+			{fields[0].push_back(v);}
+			fields[1].push_back(fs_nvar - 1);
+		}
+
+		bool schur = (fs_type == FIELDSPLIT_SCHUR_SIMPLE || fs_type == FIELDSPLIT_SCHUR_LSC || fs_type == FIELDSPLIT_SCHUR_MASS);
+		if (schur == true && fields.size() != 2)
+		{
+			std::cerr << __FILE__ << ":" << __LINE__ << " error, the Schur complement field split needs two fields" << std::endl;
+			return;
+		}
+
+		std::vector<int> field_of(fs_nvar,-1);
+		for (size_t f = 0 ; f < fields.size() ; f++)
+		{
+			for (size_t i = 0 ; i < fields[f].size() ; i++)
+			{
+				if (fields[f][i] < fs_nvar)
+				{field_of[fields[f][i]] = f;}
+			}
+		}
+
+		for (unsigned int v = 0 ; v < fs_nvar ; v++)
+		{
+			if (field_of[v] == -1)
+			{
+				std::cerr << __FILE__ << ":" << __LINE__ << " error, the variable " << v << " is not in any field" << std::endl;
+				return;
+			}
+		}
+
+		PetscInt rstart;
+		PetscInt rend;
+		PETSC_SAFE_CALL(MatGetOwnershipRange(A_,&rstart,&rend));
+
+		std::vector<std::vector<PetscInt>> rows(fields.size());
+		for (PetscInt r = rstart ; r < rend ; r++)
+		{rows[field_of[r % fs_nvar]].push_back(r);}
+
+		PC pc;
+		PETSC_SAFE_CALL(KSPGetPC(ksp,&pc));
+		PETSC_SAFE_CALL(PCSetType(pc,PCFIELDSPLIT));
+
+		fs_is.resize(fields.size());
+		for (size_t f = 0 ; f < fields.size() ; f++)
+		{
+			PETSC_SAFE_CALL(ISCreateGeneral(PETSC_COMM_WORLD,rows[f].size(),rows[f].data(),PETSC_COPY_VALUES,&fs_is[f]));
+			PETSC_SAFE_CALL(PCFieldSplitSetIS(pc,std::to_string(f).c_str(),fs_is[f]));
+		}
+
+#ifdef PETSC_HAVE_HYPRE
+		const char * amg = PCHYPRE;
+#else
+		const char * amg = PCGAMG;
+#endif
+
+		// every field is solved with one AMG cycle
+		for (size_t f = 0 ; f < fields.size() ; f++)
+		{
+			std::string prefix = "-fieldsplit_" + std::to_string(f) + "_";
+			set_default_option(prefix + "ksp_type",KSPPREONLY);
+			if (schur == false || f == 0)
+			{set_default_option(prefix + "pc_type",amg);}
+		}
+
+		if (fs_type == FIELDSPLIT_ADDITIVE)
+		{PETSC_SAFE_CALL(PCFieldSplitSetType(pc,PC_COMPOSITE_ADDITIVE));}
+		else if (fs_type == FIELDSPLIT_MULTIPLICATIVE)
+		{PETSC_SAFE_CALL(PCFieldSplitSetType(pc,PC_COMPOSITE_MULTIPLICATIVE));}
+		else
+		{
+			PETSC_SAFE_CALL(PCFieldSplitSetType(pc,PC_COMPOSITE_SCHUR));
+			PETSC_SAFE_CALL(PCFieldSplitSetSchurFactType(pc,PC_FIELDSPLIT_SCHUR_FACT_FULL));
+
+			if (fs_type == FIELDSPLIT_SCHUR_SIMPLE)
+			{
+				PETSC_SAFE_CALL(PCFieldSplitSetSchurPre(pc,PC_FIELDSPLIT_SCHUR_PRE_SELFP,NULL));
+				set_default_option("-fieldsplit_1_pc_type",amg);
+			}
+			else if (fs_type == FIELDSPLIT_SCHUR_LSC)
+			{
+				PETSC_SAFE_CALL(PCFieldSplitSetSchurPre(pc,PC_FIELDSPLIT_SCHUR_PRE_SELF,NULL));
+				set_default_option("-fieldsplit_1_pc_type",PCLSC);
+				set_default_option("-fieldsplit_1_lsc_pc_type",amg);
+			}
+			else
+			{
+				if (fs_schur_pre == NULL)
+				{
+					PetscInt np = rows[1].size();
+					PetscInt NP = np;
+					auto & v_cl = create_vcluster();
+					v_cl.sum(NP);
+					v_cl.execute();
+
+					PETSC_SAFE_CALL(MatCreateConstantDiagonal(PETSC_COMM_WORLD,np,np,NP,NP,fs_mass_scale,&fs_schur_pre));
+					fs_schur_pre_owned = true;
+				}
+
+				PETSC_SAFE_CALL(PCFieldSplitSetSchurPre(pc,PC_FIELDSPLIT_SCHUR_PRE_USER,fs_schur_pre));
+				set_default_option("-fieldsplit_1_pc_type",PCJACOBI);
+			}
+		}
+
+		PETSC_SAFE_CALL(PCSetFromOptions(pc));
+	}
+
+	//! nullspace attached to the matrices solved with a nullspace (built once)
+	MatNullSpace nsp = NULL;
+
+	//! global size of the vectors of nsp
+	PetscInt nsp_size = 0;
+
+	//! nsp is the constant nullspace built by with_constant_nullspace_solve
+	bool nsp_constant = false;
+
+	/*! \brief Attach the nullspace to the matrix
+	 *
+	 * The nullspace is set as nullspace and transpose nullspace of A_, so the KSP remove it from the solution and
+	 * the inconsistent part of the right hand side
+	 *
+	 * \param A_ Matrix
+	 *
+	 */
+	void attach_nullspace(Mat & A_)
+	{
+		PETSC_SAFE_CALL(MatSetNullSpace(A_,nsp));
+		PETSC_SAFE_CALL(MatSetTransposeNullSpace(A_,nsp));
+	}
+
+	/*! \brief Solve with the nullspace nsp attached to the matrix
+	 *
+	 * \param A sparse matrix
+	 * \param b vector
+	 *
+	 * \return the solution
+	 *
+	 */
+	Vector<double,PETSC_BASE> solve_nsp(SparseMatrix<double,int,PETSC_BASE> & A, const Vector<double,PETSC_BASE> & b)
+	{
+		Mat & A_ = A.getMat();
+		const Vec & b_ = b.getVec();
+
+		PetscInt row;
+		PetscInt col;
+		PetscInt row_loc;
+		PetscInt col_loc;
+
+		PETSC_SAFE_CALL(KSPSetInitialGuessNonzero(ksp,PETSC_FALSE));
+		PETSC_SAFE_CALL(MatGetSize(A_,&row,&col));
+		PETSC_SAFE_CALL(MatGetLocalSize(A_,&row_loc,&col_loc));
+
+		Vector<double,PETSC_BASE> x(row,row_loc);
+		Vec & x_ = x.getVec();
+
+		attach_nullspace(A_);
+
+		pre_solve_impl(A_,b_,x_);
+		solve_simple(A_,b_,x_);
+
+		x.update();
+
+		return x;
+	}
+
+	//! file where the tuner store the best configuration for each matrix
+	std::string tune_file = "petsc_solver_tuning.txt";
+
+	//! iterations of a tuning probe
+	PetscInt tune_probe_it = 20;
+
+	/*! \brief Run a short solve with one Krylov solver and preconditioner and estimate the time to converge
+	 *
+	 * The probe run on its own KSP for tune_probe_it iterations at most, from the decay of the residual
+	 * is extrapolated the number of iterations needed to reach the relative tolerance. The preconditioner
+	 * setup (KSPSetUp) is timed apart and counted once, only the iteration time is extrapolated
+	 *
+	 * \param A_ Matrix
+	 * \param b_ right hand side
+	 * \param ksp_type Krylov solver
+	 * \param pc_type preconditioner
+	 * \param rtol relative tolerance to reach
+	 *
+	 * \return estimated time to converge in seconds (infinity if the residual does not decrease)
+	 *
+	 */
+	double tune_probe(const Mat & A_, const Vec & b_, const std::string & ksp_type, const std::string & pc_type, PetscReal rtol)
+	{
+		KSP kp;
+		PC pc;
+		Vec x_;
+
+		PETSC_SAFE_CALL(KSPCreate(PETSC_COMM_WORLD,&kp));
+		PETSC_SAFE_CALL(KSPSetOperators(kp,A_,A_));
+		PETSC_SAFE_CALL(KSPSetType(kp,ksp_type.c_str()));
+		PETSC_SAFE_CALL(KSPGetPC(kp,&pc));
+		PETSC_SAFE_CALL(PCSetType(pc,pc_type.c_str()));
+		PETSC_SAFE_CALL(KSPSetNormType(kp,KSP_NORM_UNPRECONDITIONED));
+		PETSC_SAFE_CALL(KSPSetTolerances(kp,rtol,PETSC_DEFAULT,PETSC_DEFAULT,tune_probe_it));
+		PETSC_SAFE_CALL(VecDuplicate(b_,&x_));
+		PETSC_SAFE_CALL(VecSet(x_,0.0));
+
+		PetscReal r0;
+		PETSC_SAFE_CALL(VecNorm(b_,NORM_2,&r0));
+
+		timer t_setup;
+		t_setup.start();
+		PETSC_SAFE_CALL(KSPSetUp(kp));
+		t_setup.stop();
+
+		timer t_solve;
+		t_solve.start();
+		PETSC_SAFE_CALL(KSPSolve(kp,b_,x_));
+		t_solve.stop();
+
+		PetscInt its;
+		PetscReal rk;
+		KSPConvergedReason reason;
+		PETSC_SAFE_CALL(KSPGetIterationNumber(kp,&its));
+		PETSC_SAFE_CALL(KSPGetResidualNorm(kp,&rk));
+		PETSC_SAFE_CALL(KSPGetConvergedReason(kp,&reason));
+
+		PETSC_SAFE_CALL(VecDestroy(&x_));
+		PETSC_SAFE_CALL(KSPDestroy(&kp));
+
+		// the slowest processor decide
+		double setup = t_setup.getwct();
+		double solve = t_solve.getwct();
+		auto & v_cl = create_vcluster();
+		v_cl.max(setup);
+		v_cl.max(solve);
+		v_cl.execute();
+
+		if (reason > 0)
+		{return setup + solve;}
+
+		if ((reason != KSP_DIVERGED_ITS) || its == 0 || r0 == 0.0 || rk >= r0)
+		{return std::numeric_limits<double>::infinity();}
+
+		// linear extrapolation of the log residual decay
+		double needed = its * std::log(rtol) / std::log(rk / r0);
+
+		return setup + solve / its * needed;
+	}
+
+	/*! \brief Key that identify a matrix in the tuning file
+	 *
+	 * \param A_ Matrix
+	 *
+	 * \return the key (global rows, global colums, global non zero)
+	 *
+	 */
+	std::string tune_key(const Mat & A_)
+	{
+		PetscInt row;
+		PetscInt col;
+		MatInfo info;
+
+		PETSC_SAFE_CALL(MatGetSize(A_,&row,&col));
+		PETSC_SAFE_CALL(MatGetInfo(A_,MAT_GLOBAL_SUM,&info));
+
+		return std::to_string(row) + " " + std::to_string(col) + " " + std::to_string((size_t)info.nz_used);
+	}
+
+	/*! \brief Search the configuration for the matrix key in the tuning file
+	 *
+	 * Only the processor 0 read the file, the choice is broadcasted so that all the processors
+	 * use the same solver even if they see a different copy of the file (or none)
+	 *
+	 * \param key matrix key
+	 * \param ksp_type found Krylov solver
+	 * \param pc_type found preconditioner
+	 *
+	 * \return true if found
+	 *
+	 */
+	bool tune_load(const std::string & key, std::string & ksp_type, std::string & pc_type)
+	{
+		auto & v_cl = create_vcluster();
+
+		// "ksp pc" on processor 0, empty if not found
+		std::string choice;
+
+		if (v_cl.getProcessUnitID() == 0)
+		{
+			std::ifstream in(tune_file);
+			std::string line;
+
+			// the last entry for a key win
+			while (in.is_open() && std::getline(in,line))
+			{
+				std::istringstream ss(line);
+				std::string r,c,nz,kt,pt;
+				if (!(ss >> r >> c >> nz >> kt >> pt))
+				{continue;}
+
+				if (r + " " + c + " " + nz == key)
+				{choice = kt + " " + pt;}
+			}
+		}
+
+		int len = choice.size();
+		MPI_Bcast(&len,1,MPI_INT,0,PETSC_COMM_WORLD);
+
+		if (len == 0)
+		{return false;}
+
+		choice.resize(len);
+		MPI_Bcast(&choice[0],len,MPI_CHAR,0,PETSC_COMM_WORLD);
+
+		std::istringstream ss(choice);
+		ss >> ksp_type >> pc_type;
+
+		return true;
+	}
+
+	/*! \brief Decide, following the reuse policy, if the preconditioner must be rebuilt for a solve with A_
+	 *
+	 * \param A_ matrix of the solve
+	 *
+	 * \return true if the preconditioner must be rebuilt
+	 *
+	 */
+	bool pc_must_rebuild(const Mat & A_)
+	{
+		PetscObjectState state;
+		PETSC_SAFE_CALL(PetscObjectStateGet((PetscObject)A_,&state));
+
+		bool rebuild = true;
+
+		if (pc_mat == A_)
+		{
+			if (pc_policy == PC_LAG)
+			{rebuild = (pc_n_solves >= pc_lag);}
+			else if (pc_policy == PC_REUSE_SAME_OPERATOR || pc_policy == PC_REUSE_HIERARCHY)
+			{rebuild = (state != pc_mat_state);}
+		}
+
+		pc_mat = A_;
+		pc_mat_state = state;
+
+		return rebuild;
+	}
+
 	/*! \brief Calculate the residual error at time t for one method
 	 *
 	 * \param t time
@@ -345,14 +959,22 @@ class petsc_solver<double>
 		itError erri;
 		erri.it = it;
 
-		Mat A;
-		Vec Br,v,w;
-
-		PETSC_SAFE_CALL(KSPGetOperators(ksp,&A,NULL));
-		PETSC_SAFE_CALL(MatCreateVecs(A,&w,&v));
-		PETSC_SAFE_CALL(KSPBuildResidual(ksp,v,w,&Br));
-		PETSC_SAFE_CALL(KSPBuildResidual(ksp,v,w,&Br));
-		PETSC_SAFE_CALL(VecNorm(Br,NORM_INFINITY,&erri.err_norm));
+		if (pts->mon_mode == MONITOR_NO_SYNC)
+		{
+			erri.err_norm = res;
+		}
+		else
+		{
+			Mat A;
+			Vec Br,v,w;
+
+			PETSC_SAFE_CALL(KSPGetOperators(ksp,&A,NULL));
+			PETSC_SAFE_CALL(MatCreateVecs(A,&w,&v));
+			PETSC_SAFE_CALL(KSPBuildResidual(ksp,v,w,&Br));
+			PETSC_SAFE_CALL(VecNorm(Br,NORM_INFINITY,&erri.err_norm));
+			PETSC_SAFE_CALL(VecDestroy(&v));
+			PETSC_SAFE_CALL(VecDestroy(&w));
+		}
 		itError err_fill;
 
 		size_t old_size = pts->bench.last().res.size();
@@ -411,7 +1033,12 @@ class petsc_solver<double>
 			KSPType typ;
 			KSPGetType(ksp,&typ);
 
-			std::cout << "Method: " << typ << " " << " pre-conditoner: " << PCJACOBI << "  iterations: " << err.its << std::endl;
+			PC pc;
+			PCType pc_typ;
+			KSPGetPC(ksp,&pc);
+			PCGetType(pc,&pc_typ);
+
+			std::cout << "Method: " << typ << " " << " pre-conditoner: " << pc_typ << "  iterations: " << err.its << std::endl;
 			std::cout << "Norm of error: " << err.err_norm << "   Norm infinity: " << err.err_inf << std::endl;
 		}
 	}
@@ -466,6 +1093,26 @@ class petsc_solver<double>
 		{
 			return std::string("GCR (Generalized Conjugate Residual)");
 		}
+		else if (solv == std::string(KSPPIPEFGMRES))
+		{
+			return std::string("PIPEFGMRES(M) (Pipelined Flexible Generalized Minimal Residual method)");
+		}
+		else if (solv == std::string(KSPPIPECG))
+		{
+			return std::string("PIPECG (Pipelined Conjugate Gradient)");
+		}
+		else if (solv == std::string(KSPPIPELCG))
+		{
+			return std::string("PIPELCG(L) (Deep pipelined Conjugate Gradient with L pipeline depth)");
+		}
+		else if (solv == std::string(KSPGROPPCG))
+		{
+			return std::string("GROPPCG (Conjugate Gradient with two non-blocking reductions)");
+		}
+		else if (solv == std::string(KSPPIPEBCGS))
+		{
+			return std::string("PIPEBCGS (Pipelined Stabilized version of BiConjugate Gradient Squared)");
+		}
 
 		return std::string("UNKNOWN");
 	}
@@ -554,9 +1201,27 @@ class petsc_solver<double>
 					copy_if_better(bench.last().err.err_inf,x_,best_res,best_sol);
 				}
 			}
+			else if (solvs.get(i) == std::string(KSPPIPELCG))
+			{
+				// we try the pipeline depth from 1 to 4
+				for (size_t j = 1 ; j <= 4 ; j++)
+				{
+					new_bench(solvs.get(i));
+
+					if (v_cl.getProcessUnitID() == 0)
+						std::cout << "L = " << j << std::endl;
+					bench.last().smethod += std::string("(") + std::to_string(j) + std::string(")");
+					setPipelineDepth(j);
+					bench_solve_simple(A_,b_,x_,bench.last());
+
+					copy_if_better(bench.last().err.err_inf,x_,best_res,best_sol);
+				}
+			}
 			else if (solvs.get(i) == std::string(KSPGMRES) ||
 					 solvs.get(i) == std::string(std::string(KSPFGMRES)) ||
-					 solvs.get(i) == std::string(std::string(KSPLGMRES)) )
+					 solvs.get(i) == std::string(std::string(KSPLGMRES)) ||
+					 solvs.get(i) == std::string(std::string(KSPPGMRES)) ||
+					 solvs.get(i) == std::string(std::string(KSPPIPEFGMRES)) )
 			{
 				// we try from 2 to 6 as search direction
 				for (size_t j = 50 ; j < 300 ; j += 50)
@@ -652,16 +1317,156 @@ class petsc_solver<double>
 		PETSC_SAFE_CALL(MatGetSize(A_,&row,&col));
 		PETSC_SAFE_CALL(MatGetLocalSize(A_,&row_loc,&col_loc));
 
+		if (reorder_type.size() != 0)
+		{
+			solve_reordered(A_,b_,x_);
+			return;
+		}
+
+		set_operators(A_);
+
+		// Solve the system
+		solve_metered(A_,b_,x_);
+	}
+
+	/*! \brief Solve the system with the local rows reordered
+	 *
+	 * The ordering of the diagonal block of every processor p is computed with MatGetOrdering, the system
+	 * solved is B y = c with B(k,l) = A(p[k],p[l]) and c[k] = b[p[k]], then x[p[k]] = y[k]. The rows stay on
+	 * their processor, so b and x are permuted locally
+	 *
+	 * \param A_ Matrix
+	 * \param b_ right hand side
+	 * \param x_ solution (and initial guess)
+	 *
+	 */
+	void solve_reordered(const Mat & A_, const Vec & b_, Vec & x_)
+	{
+		PetscInt low;
+		PetscInt high;
+		PETSC_SAFE_CALL(MatGetOwnershipRange(A_,&low,&high));
+		PetscInt n = high - low;
+
+		Mat Ad;
+		IS rperm;
+		IS cperm;
+		PETSC_SAFE_CALL(MatGetDiagonalBlock(A_,&Ad));
+		PETSC_SAFE_CALL(MatGetOrdering(Ad,reorder_type.c_str(),&rperm,&cperm));
+
+		const PetscInt * p;
+		PETSC_SAFE_CALL(ISGetIndices(rperm,&p));
+
+		std::vector<PetscInt> perm(p,p+n);
+		std::vector<PetscInt> gperm(n);
+		for (PetscInt k = 0 ; k < n ; k++)
+		{gperm[k] = low + perm[k];}
+
+		PETSC_SAFE_CALL(ISRestoreIndices(rperm,&p));
+		PETSC_SAFE_CALL(ISDestroy(&rperm));
+		PETSC_SAFE_CALL(ISDestroy(&cperm));
+
+		IS is;
+		PETSC_SAFE_CALL(ISCreateGeneral(PETSC_COMM_WORLD,n,gperm.data(),PETSC_COPY_VALUES,&is));
+		PETSC_SAFE_CALL(ISSetPermutation(is));
+
+		Mat B;
+		PETSC_SAFE_CALL(MatPermute(A_,is,is,&B));
+		PETSC_SAFE_CALL(ISDestroy(&is));
+
+		Vec c;
+		Vec y;
+		PETSC_SAFE_CALL(VecDuplicate(b_,&c));
+		PETSC_SAFE_CALL(VecDuplicate(x_,&y));
+
+		const PetscScalar * ba;
+		const PetscScalar * xa;
+		PetscScalar * ca;
+		PetscScalar * ya;
+		PETSC_SAFE_CALL(VecGetArrayRead(b_,&ba));
+		PETSC_SAFE_CALL(VecGetArrayRead(x_,&xa));
+		PETSC_SAFE_CALL(VecGetArray(c,&ca));
+		PETSC_SAFE_CALL(VecGetArray(y,&ya));
+		for (PetscInt k = 0 ; k < n ; k++)
+		{
+			ca[k] = ba[perm[k]];
+			ya[k] = xa[perm[k]];
+		}
+		PETSC_SAFE_CALL(VecRestoreArray(y,&ya));
+		PETSC_SAFE_CALL(VecRestoreArray(c,&ca));
+		PETSC_SAFE_CALL(VecRestoreArrayRead(x_,&xa));
+		PETSC_SAFE_CALL(VecRestoreArrayRead(b_,&ba));
+
+		set_operators(B);
+		solve_metered(B,c,y);
+
+		PetscScalar * xw;
+		PETSC_SAFE_CALL(VecGetArrayRead(y,&xa));
+		PETSC_SAFE_CALL(VecGetArray(x_,&xw));
+		for (PetscInt k = 0 ; k < n ; k++)
+		{xw[perm[k]] = xa[k];}
+		PETSC_SAFE_CALL(VecRestoreArray(x_,&xw));
+		PETSC_SAFE_CALL(VecRestoreArrayRead(y,&xa));
+
+		PETSC_SAFE_CALL(VecDestroy(&c));
+		PETSC_SAFE_CALL(VecDestroy(&y));
+		PETSC_SAFE_CALL(MatDestroy(&B));
+	}
+
+	/*! \brief Set the matrix of the Krylov solver, following the preconditioner reuse policy
+	 *
+	 * \param A_ SparseMatrix
+	 *
+	 */
+	void set_operators(const Mat & A_)
+	{
+		if (pc_policy != PC_REBUILD)
+		{
+			bool first = (pc_mat == NULL);
+			bool rebuild = pc_must_rebuild(A_);
+
+			PETSC_SAFE_CALL(KSPSetReusePreconditioner(ksp,(rebuild == true)?PETSC_FALSE:PETSC_TRUE));
+			PETSC_SAFE_CALL(KSPSetOperators(ksp,A_,A_));
+
+			// options are read only at the first solve, reading them again would reset the preconditioner
+			if (first == true)
+			{
+				PETSC_SAFE_CALL(KSPSetFromOptions(ksp));
+				setup_fieldsplit(A_);
+
+				if (pc_policy == PC_REUSE_HIERARCHY)
+				{
+					PC pc;
+					PETSC_SAFE_CALL(KSPGetPC(ksp,&pc));
+					PETSC_SAFE_CALL(PCGAMGSetReuseInterpolation(pc,PETSC_TRUE));
+				}
+			}
+
+			if (rebuild == true)
+			{
+				pc_n_solves = 0;
+
+				// PCSetUp skip the set-up when the matrix did not change since the previous one,
+				// only the set-up really done are counted
+				if (pc_setup_mat != A_ || pc_setup_state != pc_mat_state)
+				{
+					pc_setup_mat = A_;
+					pc_setup_state = pc_mat_state;
+					pc_n_setup++;
+				}
+			}
+			pc_n_solves++;
+
+			return;
+		}
+
 		// We set the Matrix operators
     PETSC_SAFE_CALL(KSPSetOperators(ksp,A_,A_));
 
     // if we are on on best solve set-up a monitor function
 
     PETSC_SAFE_CALL(KSPSetFromOptions(ksp));
+    setup_fieldsplit(A_);
     //PETSC_SAFE_CALL(KSPSetUp(ksp));
-
-		// Solve the system
-		PETSC_SAFE_CALL(KSPSolve(ksp,b_,x_));
 	}
 
 	/*! \brief solve simple use a Krylov solver + Simple selected Parallel Pre-conditioner
@@ -672,8 +1477,14 @@ class petsc_solver<double>
 	 */
 	void solve_simple(const Vec & b_, Vec & x_)
 	{
+		Mat A_;
+		PETSC_SAFE_CALL(KSPGetOperators(ksp,&A_,NULL));
+
+		// no fill, the matrix is the one of the previous solve
+		metrics.fill_time = 0.0;
+
 		// Solve the system
-		PETSC_SAFE_CALL(KSPSolve(ksp,b_,x_));
+		solve_metered(A_,b_,x_);
 	}
 
 	/*! \brief Calculate statistic on the error solution
@@ -800,12 +1611,22 @@ public:
 
 	~petsc_solver()
 	{
+		if (nsp != NULL)
+		{PETSC_SAFE_CALL(MatNullSpaceDestroy(&nsp));}
+
+		for (size_t f = 0 ; f < fs_is.size() ; f++)
+		{PETSC_SAFE_CALL(ISDestroy(&fs_is[f]));}
+
+		if (fs_schur_pre_owned == true)
+		{PETSC_SAFE_CALL(MatDestroy(&fs_schur_pre));}
+
 		PETSC_SAFE_CALL(KSPDestroy(&ksp));
 	}
 
 	petsc_solver()
 	:maxits(300),tmp(0)
 	{
+		numerics_backends::ensure_petsc();
 		initKSP();
 
 		// Add the solvers
@@ -877,6 +1698,28 @@ public:
 		solvs.add(solver);
 	}
 
+	/*! \brief Add the pipelined solvers to the solvers tested by try_solve
+	 *
+	 * PIPECG, PIPELCG and GROPPCG require a symmetric positive definite system (and preconditioner),
+	 * set spd to false to add only PGMRES, PIPEFGMRES and PIPEBCGS
+	 *
+	 * \param spd the system is symmetric positive definite
+	 *
+	 */
+	void addPipelinedTestSolvers(bool spd = false)
+	{
+		solvs.add(std::string(KSPPGMRES));
+		solvs.add(std::string(KSPPIPEFGMRES));
+		solvs.add(std::string(KSPPIPEBCGS));
+
+		if (spd == true)
+		{
+			solvs.add(std::string(KSPPIPECG));
+			solvs.add(std::string(KSPPIPELCG));
+			solvs.add(std::string(KSPGROPPCG));
+		}
+	}
+
 	/*! \brief Remove a test solver
 	 *
 	 * The try solve function use the most robust solvers in PETSC, if you want to remove
@@ -905,7 +1748,7 @@ public:
 	void log_monitor()
 	{
 		PETSC_SAFE_CALL(PetscOptionsSetValue(NULL,"-ksp_monitor",0));
-		PETSC_SAFE_CALL(PetscOptionsSetValue(NULL,"-pc_hypre_boomeramg_print_statistics","2"));
+		PETSC_SAFE_CALL(PetscOptionsSetValue(NULL,amg_option("print_statistics").c_str(),"2"));
 	}
 
 	/*! \brief Set the Petsc solver
@@ -920,6 +1763,61 @@ public:
 		PetscOptionsSetValue(NULL,"-ksp_type",type);
 	}
 
+	/*! \brief Hide the latency of the global reductions of the Krylov solver
+	 *
+	 * With many processors the cost of an iteration is the latency of the allreduce of the inner products
+	 * and of the norm, not the SpMV. The pipelined solvers (setSolver with KSPPIPECG, KSPPIPELCG, KSPGROPPCG,
+	 * KSPPGMRES, KSPPIPEFGMRES, KSPPIPEBCGS) do one non-blocking reduction per iteration and overlap it with
+	 * the SpMV and the preconditioner (PETSc must use an MPI-3 library). With latency hiding:
+	 *
+	 * * the residual norm of CG and BiCGStab is lagged by one iteration and reduced together with the inner
+	 *   products (-ksp_lag_norm), the classic solvers lose one reduction per iteration
+	 * * the monitor of the benchmarks (try_solve) records the norm computed by the solver (MONITOR_NO_SYNC)
+	 *   instead of building the true residual
+	 *
+	 * The pipelined solvers are less stable than the classic ones, the residual can stagnate at a higher
+	 * value. recordResidualHistory does not add communication and can be used with both.
+	 *
+	 * \param hide true to enable
+	 *
+	 */
+	void setLatencyHiding(bool hide)
+	{
+		if (hide == true)
+		{
+			PETSC_SAFE_CALL(PetscOptionsSetValue(NULL,"-ksp_lag_norm",NULL));
+			mon_mode = MONITOR_NO_SYNC;
+		}
+		else
+		{
+			PETSC_SAFE_CALL(PetscOptionsClearValue(NULL,"-ksp_lag_norm"));
+			mon_mode = MONITOR_TRUE_RESIDUAL;
+		}
+	}
+
+	/*! \brief Set what the monitor of the benchmarks (try_solve) computes at every iteration
+	 *
+	 * \param mode MONITOR_TRUE_RESIDUAL (default) or MONITOR_NO_SYNC
+	 *
+	 */
+	void setMonitorMode(petsc_monitor_mode mode)
+	{
+		mon_mode = mode;
+	}
+
+	/*! \brief Set the depth of the pipeline of KSPPIPELCG
+	 *
+	 * With depth L the reduction of an iteration is overlapped with the next L SpMV and preconditioner
+	 * applications. Bigger L hides more latency, but the solver is less stable. The default is 1
+	 *
+	 * \param l pipeline depth
+	 *
+	 */
+	void setPipelineDepth(PetscInt l)
+	{
+		PETSC_SAFE_CALL(PetscOptionsSetValue(NULL,"-ksp_pipelcg_pipel",std::to_string(l).c_str()));
+	}
+
 	/*! \brief Set the relative tolerance as stop criteria
 	 *
 	 * \see PETSC manual KSPSetTolerances for an explanation
@@ -1039,6 +1937,15 @@ public:
 	 * * Coarsening method setPreconditionerAMG_coarsen
 	 * * interpolation schemes setPreconditionerAMG_interp
 	 *
+	 * ## Additive Schwarz with subdomain solvers ##
+	 *
+	 * PCASM_BOOMERAMG: additive Schwarz across the processors, every subdomain (the rows of a processor plus
+	 * the overlap) is solved with one BoomerAMG cycle (GAMG if PETSc has no hypre). The AMG does not communicate,
+	 * so it does not stagnate with many processors like a global BoomerAMG on strongly anisotropic systems, the
+	 * coupling between the processors is given by the overlap (setPreconditionerASM_overlap) and the Krylov
+	 * solver. The setPreconditionerAMG_* functions set the AMG of the subdomains.
+	 *
+	 * PCASM_LU: the same with an exact LU factorization of the subdomains
 	 *
 	 * \param type of the preconditioner
 	 *
@@ -1046,8 +1953,31 @@ public:
 	void setPreconditioner(PCType type)
 	{
 		is_preconditioner_set = true;
+		amg_sub = false;
 
-		if (std::string(type) == PCHYPRE_BOOMERAMG)
+		if (std::string(type) == PCASM_BOOMERAMG)
+		{
+			PETSC_SAFE_CALL(PetscOptionsSetValue(NULL,"-pc_type",PCASM));
+			PETSC_SAFE_CALL(PetscOptionsSetValue(NULL,"-sub_ksp_type",KSPPREONLY));
+#ifdef PETSC_HAVE_HYPRE
+			PETSC_SAFE_CALL(PetscOptionsSetValue(NULL,"-sub_pc_type",PCHYPRE));
+			PETSC_SAFE_CALL(PetscOptionsSetValue(NULL,"-sub_pc_hypre_type","boomeramg"));
+			amg_sub = true;
+			atype = HYPRE_AMG;
+#else
+			PETSC_SAFE_CALL(PetscOptionsSetValue(NULL,"-sub_pc_type",PCGAMG));
+			atype = PETSC_AMG;
+#endif
+		}
+		else if (std::string(type) == PCASM_LU)
+		{
+			PETSC_SAFE_CALL(PetscOptionsSetValue(NULL,"-pc_type",PCASM));
+			PETSC_SAFE_CALL(PetscOptionsSetValue(NULL,"-sub_ksp_type",KSPPREONLY));
+			PETSC_SAFE_CALL(PetscOptionsSetValue(NULL,"-sub_pc_type",PCLU));
+			PETSC_SAFE_CALL(PetscOptionsSetValue(NULL,"-sub_pc_factor_shift_type","NONZERO"));
+			atype = NONE_AMG;
+		}
+		else if (std::string(type) == PCHYPRE_BOOMERAMG)
 		{
 			PC pc;
 
@@ -1056,17 +1986,167 @@ public:
 
 			PETSC_SAFE_CALL(PetscOptionsSetValue(NULL,"-pc_type",PCHYPRE));
 
-		    PETSC_SAFE_CALL(PCFactorSetShiftType(pc, MAT_SHIFT_NONZERO));
-		    PETSC_SAFE_CALL(PCFactorSetShiftAmount(pc, PETSC_DECIDE));
-#ifdef PETSC_HAVE_HYPRE
-		    PETSC_SAFE_CALL(PCHYPRESetType(pc, "boomeramg"));
-#endif
-		    atype = HYPRE_AMG;
-		}
-		else
-		{
-			PETSC_SAFE_CALL(PetscOptionsSetValue(NULL,"-pc_type",type));
-		}
+		    PETSC_SAFE_CALL(PCFactorSetShiftType(pc, MAT_SHIFT_NONZERO));
+		    PETSC_SAFE_CALL(PCFactorSetShiftAmount(pc, PETSC_DECIDE));
+#ifdef PETSC_HAVE_HYPRE
+		    PETSC_SAFE_CALL(PCHYPRESetType(pc, "boomeramg"));
+#endif
+		    atype = HYPRE_AMG;
+		}
+		else
+		{
+			PETSC_SAFE_CALL(PetscOptionsSetValue(NULL,"-pc_type",type));
+		}
+	}
+
+	/*! \brief Use a field split preconditioner (PCFIELDSPLIT) on the variables of the system
+	 *
+	 * The rows of DCPSE_scheme and FD_scheme interleave the variables (row = point*nvar + variable), the schemes
+	 * give nvar to the solver at every solve (with another matrix use setFieldSplitLayout), so the index sets of
+	 * the fields are built from the row numbers. For Stokes with fields {u,v} and {p} the Schur presets give an
+	 * iteration count independent of the resolution, use them with a flexible Krylov solver (KSPFGMRES) since the
+	 * inner solves are inexact.
+	 *
+	 * The index sets are built at the first solve, a matrix with another distribution of the rows needs a new solver.
+	 * It cannot be used with setReordering
+	 *
+	 * \param type field split type
+	 * \param fields variables of every field, by default all the variables but the last in the first field and the
+	 *        last (for example the pressure) in the second
+	 *
+	 */
+	void setPreconditionerFieldSplit(fieldsplit_type type, const std::vector<std::vector<unsigned int>> & fields = std::vector<std::vector<unsigned int>>())
+	{
+		is_preconditioner_set = true;
+		amg_sub = false;
+		atype = NONE_AMG;
+
+		fs_type = type;
+		fs_fields = fields;
+
+		PETSC_SAFE_CALL(PetscOptionsSetValue(NULL,"-pc_type",PCFIELDSPLIT));
+	}
+
+	/*! \brief Number of variables interleaved in the rows of the system (row = point*nvar + variable)
+	 *
+	 * Set by DCPSE_scheme and FD_scheme before every solve
+	 *
+	 * \param nvar number of variables
+	 *
+	 */
+	void setFieldSplitLayout(unsigned int nvar)
+	{
+		fs_nvar = nvar;
+	}
+
+	/*! \brief Preconditioning matrix of the Schur complement for FIELDSPLIT_SCHUR_MASS
+	 *
+	 * For Stokes a pressure mass matrix divided by the viscosity, with the rows of the second field in the
+	 * order of the system. The matrix must live until the solver is destroyed
+	 *
+	 * \param Mp matrix
+	 *
+	 */
+	void setFieldSplitSchurMatrix(SparseMatrix<double,int,PETSC_BASE> & Mp)
+	{
+		fs_schur_pre = Mp.getMat();
+		fs_schur_pre_owned = false;
+	}
+
+	/*! \brief Scale of the identity used as mass matrix with FIELDSPLIT_SCHUR_MASS if no matrix is given
+	 *
+	 * On a uniform discretization the lumped pressure mass matrix is the cell volume times the identity, for
+	 * Stokes use volume / viscosity
+	 *
+	 * \param scale scale
+	 *
+	 */
+	void setFieldSplitMassScale(PetscScalar scale)
+	{
+		fs_mass_scale = scale;
+	}
+
+	/*! \brief Set the overlap of the additive Schwarz preconditioner (PCASM, PCASM_BOOMERAMG, PCASM_LU)
+	 *
+	 * The subdomain of a processor is extended by overlap layers of the matrix graph. More overlap gives
+	 * fewer Krylov iterations, but bigger subdomains and more communication at the set-up. The default
+	 * is 1
+	 *
+	 * \param overlap number of layers
+	 *
+	 */
+	void setPreconditionerASM_overlap(int overlap)
+	{
+		PETSC_SAFE_CALL(PetscOptionsSetValue(NULL,"-pc_asm_overlap",std::to_string(overlap).c_str()));
+	}
+
+	/*! \brief Reorder the local rows of the system before the solve
+	 *
+	 * The rows of FD_scheme and DCPSE_scheme follow g_map/p_map, for particles this order is close to random.
+	 * With an ordering (MATORDERINGRCM to reduce the bandwidth, MATORDERINGND for nested dissection, MATORDERINGQMD,
+	 * MATORDERING1WD) the rows of every processor are permuted inside the processor, the same permutation is
+	 * applied to the colums, to b and back to x. The ILU/ICC/LU of the local blocks (PCBJACOBI, PCASM) and the
+	 * SpMV then work on the reordered matrix. The permuted matrix is built at every solve.
+	 *
+	 * Only the factorization of a sequential PCILU/PCLU can also be reordered without permuting the system with
+	 * setPetscOption("-pc_factor_mat_ordering_type","rcm") (or "-sub_pc_factor_mat_ordering_type" for the blocks)
+	 *
+	 * \param type ordering (NULL or "" to disable)
+	 *
+	 */
+	void setReordering(MatOrderingType type)
+	{
+		reorder_type = (type == NULL)?std::string():std::string(type);
+	}
+
+	/*! \brief Keep the preconditioner between solves with a matrix that changed
+	 *
+	 * When the matrix is refilled with new values (for example with SparseMatrix::reusePattern) the
+	 * preconditioner built for the first matrix is reused instead of being rebuilt at every solve.
+	 * The Krylov iterations still use the new matrix
+	 *
+	 * \param reuse true to reuse the preconditioner
+	 *
+	 */
+	void setReusePreconditioner(bool reuse)
+	{
+		PETSC_SAFE_CALL(KSPSetReusePreconditioner(ksp,(reuse == true)?PETSC_TRUE:PETSC_FALSE));
+	}
+
+	/*! \brief Set when the preconditioner is rebuilt across solves
+	 *
+	 * For a sequence of solves with the same matrix (for example a pressure Poisson step solved at every
+	 * time step) the preconditioner set-up can be the dominant cost. With PC_REUSE_SAME_OPERATOR it is
+	 * done again only if the matrix changed (PETSc state of the Mat), with PC_LAG every lag solves
+	 * even if the values changed, with PC_REUSE_HIERARCHY a PCGAMG preconditioner keep coarsening and
+	 * interpolation and recompute only the Galerkin products when the matrix changed.
+	 * The policy apply to the solve functions that take the matrix. With PC_REBUILD (default) the
+	 * behaviour is the one of setReusePreconditioner
+	 *
+	 * \param policy reuse policy
+	 * \param lag with PC_LAG number of solves between two set-up
+	 *
+	 */
+	void setPreconditionerReuse(pc_reuse_policy policy, int lag = 1)
+	{
+		pc_policy = policy;
+		pc_lag = (lag < 1)?1:lag;
+		pc_n_solves = 0;
+		pc_n_setup = 0;
+		pc_mat = NULL;
+	}
+
+	/*! \brief Number of preconditioner set-up done with the current reuse policy
+	 *
+	 * A rebuild requested by the policy on a matrix that did not change since the previous set-up is
+	 * skipped by PETSc and it is not counted
+	 *
+	 * \return the number of set-up
+	 *
+	 */
+	size_t getNPreconditionerSetup()
+	{
+		return pc_n_setup;
 	}
 
 	/*! \brief Set the number of levels for the algebraic-multigrid preconditioner
@@ -1081,7 +2161,7 @@ public:
 	{
 		if (atype == HYPRE_AMG)
 		{
-			PETSC_SAFE_CALL(PetscOptionsSetValue(NULL,"-pc_hypre_boomeramg_max_levels",std::to_string(nl).c_str()));
+			PETSC_SAFE_CALL(PetscOptionsSetValue(NULL,amg_option("max_levels").c_str(),std::to_string(nl).c_str()));
 		}
 		else
 		{
@@ -1098,7 +2178,7 @@ public:
 	{
 		if (atype == HYPRE_AMG)
 		{
-			PETSC_SAFE_CALL(PetscOptionsSetValue(NULL,"-pc_hypre_boomeramg_max_iter",std::to_string(nit).c_str()));
+			PETSC_SAFE_CALL(PetscOptionsSetValue(NULL,amg_option("max_iter").c_str(),std::to_string(nit).c_str()));
 		}
 		else
 		{
@@ -1131,11 +2211,11 @@ public:
 		if (atype == HYPRE_AMG)
 		{
 			if (k == REL_ALL)
-			{PETSC_SAFE_CALL(PetscOptionsSetValue(NULL,"-pc_hypre_boomeramg_relax_type_all",type.c_str()));}
+			{PETSC_SAFE_CALL(PetscOptionsSetValue(NULL,amg_option("relax_type_all").c_str(),type.c_str()));}
 			else if (k == REL_UP)
-			{PETSC_SAFE_CALL(PetscOptionsSetValue(NULL,"-pc_hypre_boomeramg_relax_type_up",type.c_str()));}
+			{PETSC_SAFE_CALL(PetscOptionsSetValue(NULL,amg_option("relax_type_up").c_str(),type.c_str()));}
 			else if (k == REL_DOWN)
-			{PETSC_SAFE_CALL(PetscOptionsSetValue(NULL,"-pc_hypre_boomeramg_relax_type_down",type.c_str()));}
+			{PETSC_SAFE_CALL(PetscOptionsSetValue(NULL,amg_option("relax_type_down").c_str(),type.c_str()));}
 		}
 		else
 		{
@@ -1163,16 +2243,16 @@ public:
 	{
 		if (atype == HYPRE_AMG)
 		{
-			PETSC_SAFE_CALL(PetscOptionsSetValue(NULL,"-pc_hypre_boomeramg_cycle_type",cycle_type.c_str()));
+			PETSC_SAFE_CALL(PetscOptionsSetValue(NULL,amg_option("cycle_type").c_str(),cycle_type.c_str()));
 
 			if (sweep_dw != -1)
-			{PETSC_SAFE_CALL(PetscOptionsSetValue(NULL,"-pc_hypre_boomeramg_grid_sweeps_down",std::to_string(sweep_up).c_str()));}
+			{PETSC_SAFE_CALL(PetscOptionsSetValue(NULL,amg_option("grid_sweeps_down").c_str(),std::to_string(sweep_up).c_str()));}
 
 			if (sweep_up != -1)
-			{PETSC_SAFE_CALL(PetscOptionsSetValue(NULL,"-pc_hypre_boomeramg_grid_sweeps_up",std::to_string(sweep_dw).c_str()));}
+			{PETSC_SAFE_CALL(PetscOptionsSetValue(NULL,amg_option("grid_sweeps_up").c_str(),std::to_string(sweep_dw).c_str()));}
 
 			if (sweep_crs != -1)
-			{PETSC_SAFE_CALL(PetscOptionsSetValue(NULL,"-pc_hypre_boomeramg_grid_sweeps_coarse",std::to_string(sweep_crs).c_str()));}
+			{PETSC_SAFE_CALL(PetscOptionsSetValue(NULL,amg_option("grid_sweeps_coarse").c_str(),std::to_string(sweep_crs).c_str()));}
 		}
 		else
 		{
@@ -1194,7 +2274,7 @@ public:
 	{
 		if (atype == HYPRE_AMG)
 		{
-			PETSC_SAFE_CALL(PetscOptionsSetValue(NULL,"-pc_hypre_boomeramg_coarsen_type",type.c_str()));
+			PETSC_SAFE_CALL(PetscOptionsSetValue(NULL,amg_option("coarsen_type").c_str(),type.c_str()));
 		}
 		else
 		{
@@ -1216,7 +2296,7 @@ public:
 	{
 		if (atype == HYPRE_AMG)
 		{
-			PETSC_SAFE_CALL(PetscOptionsSetValue(NULL,"-pc_hypre_boomeramg_interp_type",type.c_str()));
+			PETSC_SAFE_CALL(PetscOptionsSetValue(NULL,amg_option("interp_type").c_str(),type.c_str()));
 		}
 		else
 		{
@@ -1245,7 +2325,7 @@ public:
 	{
 		if (atype == HYPRE_AMG)
 		{
-			PETSC_SAFE_CALL(PetscOptionsSetValue(NULL,"-pc_hypre_boomeramg_nodal_coarsen",std::to_string(norm).c_str()));
+			PETSC_SAFE_CALL(PetscOptionsSetValue(NULL,amg_option("nodal_coarsen").c_str(),std::to_string(norm).c_str()));
 		}
 		else
 		{
@@ -1262,7 +2342,7 @@ public:
 	{
 		if (atype == HYPRE_AMG)
 		{
-			PETSC_SAFE_CALL(PetscOptionsSetValue(NULL,"-pc_hypre_boomeramg_eu_level",std::to_string(k).c_str()));
+			PETSC_SAFE_CALL(PetscOptionsSetValue(NULL,amg_option("eu_level").c_str(),std::to_string(k).c_str()));
 		}
 		else
 		{
@@ -1305,7 +2385,7 @@ public:
 	 */
 	Vector<double,PETSC_BASE> solve(SparseMatrix<double,int,PETSC_BASE> & A, const Vector<double,PETSC_BASE> & b, bool initial_guess = false)
 	{
-		Mat & A_ = A.getMat();
+		Mat & A_ = fill_timed(A);
 		const Vec & b_ = b.getVec();
 
 		// We set the size of x according to the Matrix A
@@ -1340,7 +2420,7 @@ public:
      */
     Vector<double,PETSC_BASE> solve(SparseMatrix<double,int,PETSC_BASE> & A, Vector<double,PETSC_BASE> & x, const Vector<double,PETSC_BASE> & b)
     {
-        Mat & A_ = A.getMat();
+        Mat & A_ = fill_timed(A);
         const Vec & b_ = b.getVec();
         Vec & x_ = x.getVec();
 
@@ -1369,6 +2449,142 @@ public:
         return true;*/
     }
 
+    /*! \brief Solve the system leaving the solution in the PETSc vector of x
+     *
+     * Unlike solve the solution is not copied in the row values of x (Vector::update is not called), for device
+     * vectors (Vector::setDevice) it stay on the GPU and can be read with VecCUDAGetArrayRead / VecHIPGetArrayRead
+     *
+     * \param A sparse matrix
+     * \param x solution, it must have the local and global size of the matrix rows
+     * \param b vector
+     *
+     */
+    void solve_no_update(SparseMatrix<double,int,PETSC_BASE> & A, Vector<double,PETSC_BASE> & x, const Vector<double,PETSC_BASE> & b)
+    {
+        solve_no_update(A,x.getVec(),b);
+    }
+
+    /*! \brief Solve the system in a PETSc vector created by the caller
+     *
+     * x_ can be created with VecCreateMPIWithArray over the memory of a property, the solution is then written
+     * directly there
+     *
+     * \param A sparse matrix
+     * \param x_ solution, it must have the local and global size of the matrix rows
+     * \param b vector
+     *
+     */
+    void solve_no_update(SparseMatrix<double,int,PETSC_BASE> & A, Vec & x_, const Vector<double,PETSC_BASE> & b)
+    {
+        Mat & A_ = fill_timed(A);
+        const Vec & b_ = b.getVec();
+
+        PETSC_SAFE_CALL(KSPSetInitialGuessNonzero(ksp,PETSC_FALSE));
+
+        pre_solve_impl(A_,b_,x_);
+        solve_simple(A_,b_,x_);
+    }
+
+    /*! \brief Solve the system with a matrix already assembled by the caller (a MatNest of blocks for example)
+     *
+     * \param A_ PETSc matrix
+     * \param x_ solution, it must have the local and global size of the matrix rows
+     * \param b vector
+     *
+     */
+    void solve_no_update(const Mat & A_, Vec & x_, const Vector<double,PETSC_BASE> & b)
+    {
+        const Vec & b_ = b.getVec();
+
+        metrics.fill_time = 0.0;
+        PETSC_SAFE_CALL(KSPSetInitialGuessNonzero(ksp,PETSC_FALSE));
+
+        pre_solve_impl(A_,b_,x_);
+        solve_simple(A_,b_,x_);
+    }
+
+    /*! \brief Solve the system with several right hand sides and the same matrix
+     *
+     * The preconditioner is set-up once for all the right hand sides. With PETSc 3.14 or newer the right hand
+     * sides are packed in a dense matrix and solved together with KSPMatSolve (block Krylov methods like
+     * KSPHPDDM use one block SpMV for all the vectors, the others loop internally), with older versions
+     * they are solved one after the other with the same set-up
+     *
+     * \param A sparse matrix
+     * \param b right hand sides
+     *
+     * \return one solution for each right hand side
+     *
+     */
+    std::vector<Vector<double,PETSC_BASE>> solve(SparseMatrix<double,int,PETSC_BASE> & A, const std::vector<Vector<double,PETSC_BASE>> & b)
+    {
+        std::vector<Vector<double,PETSC_BASE>> x;
+
+        if (b.size() == 0)
+        {return x;}
+
+        Mat & A_ = A.getMat();
+
+        PetscInt row;
+        PetscInt col;
+        PetscInt row_loc;
+        PetscInt col_loc;
+
+        PETSC_SAFE_CALL(KSPSetInitialGuessNonzero(ksp,PETSC_FALSE));
+        PETSC_SAFE_CALL(MatGetSize(A_,&row,&col));
+        PETSC_SAFE_CALL(MatGetLocalSize(A_,&row_loc,&col_loc));
+
+        // the vectors are constructed in place, a copy of Vector does not carry the PETSc sizes
+        x.resize(b.size());
+        for (size_t i = 0 ; i < b.size() ; i++)
+        {x[i].resize(row,row_loc);}
+
+        pre_solve_impl(A_,b[0].getVec(),x[0].getVec());
+        set_operators(A_);
+
+#if PETSC_VERSION_GE(3,14,0)
+
+        PetscInt nrhs = b.size();
+
+        Mat B;
+        Mat X;
+        PETSC_SAFE_CALL(MatCreateDense(PETSC_COMM_WORLD,row_loc,PETSC_DECIDE,row,nrhs,NULL,&B));
+        PETSC_SAFE_CALL(MatCreateDense(PETSC_COMM_WORLD,row_loc,PETSC_DECIDE,row,nrhs,NULL,&X));
+
+        for (PetscInt j = 0 ; j < nrhs ; j++)
+        {
+            Vec c;
+            PETSC_SAFE_CALL(MatDenseGetColumnVecWrite(B,j,&c));
+            PETSC_SAFE_CALL(VecCopy(b[j].getVec(),c));
+            PETSC_SAFE_CALL(MatDenseRestoreColumnVecWrite(B,j,&c));
+        }
+
+        PETSC_SAFE_CALL(KSPMatSolve(ksp,B,X));
+
+        for (PetscInt j = 0 ; j < nrhs ; j++)
+        {
+            Vec c;
+            PETSC_SAFE_CALL(MatDenseGetColumnVecRead(X,j,&c));
+            PETSC_SAFE_CALL(VecCopy(c,x[j].getVec()));
+            PETSC_SAFE_CALL(MatDenseRestoreColumnVecRead(X,j,&c));
+        }
+
+        PETSC_SAFE_CALL(MatDestroy(&B));
+        PETSC_SAFE_CALL(MatDestroy(&X));
+
+#else
+
+        for (size_t j = 0 ; j < b.size() ; j++)
+        {PETSC_SAFE_CALL(KSPSolve(ksp,b[j].getVec(),x[j].getVec()));}
+
+#endif
+
+        for (size_t j = 0 ; j < x.size() ; j++)
+        {x[j].update();}
+
+        return x;
+    }
+
     /*! \brief Here we invert the matrix and solve the system with previous operator
      *
      * \param A sparse matrix
@@ -1527,6 +2743,207 @@ public:
 #endif
     }
 
+    /*! \brief Set the nullspace of the systems solved with nullspace_solve
+     *
+     * The vectors are copied and orthonormalized once, the nullspace is kept and attached to the matrix at every
+     * nullspace_solve until it is set again or reset with resetNullSpace (for example when the geometry change)
+     *
+     * \param vecs vectors that span the nullspace
+     * \param has_constant the constant vector is part of the nullspace (it must not be in vecs)
+     *
+     */
+    void setNullSpace(const std::vector<Vector<double,PETSC_BASE>> & vecs, bool has_constant = false)
+    {
+        resetNullSpace();
+
+        std::vector<Vec> nvec(vecs.size());
+        for (size_t i = 0 ; i < vecs.size() ; i++)
+        {
+            PETSC_SAFE_CALL(VecDuplicate(vecs[i].getVec(),&nvec[i]));
+            PETSC_SAFE_CALL(VecCopy(vecs[i].getVec(),nvec[i]));
+
+            // Gram-Schmidt against the constant and the previous vectors
+            if (has_constant == true)
+            {
+                PetscScalar sum;
+                PetscInt n;
+                PETSC_SAFE_CALL(VecSum(nvec[i],&sum));
+                PETSC_SAFE_CALL(VecGetSize(nvec[i],&n));
+                PETSC_SAFE_CALL(VecShift(nvec[i],-sum/n));
+            }
+
+            for (size_t j = 0 ; j < i ; j++)
+            {
+                PetscScalar dot;
+                PETSC_SAFE_CALL(VecDot(nvec[i],nvec[j],&dot));
+                PETSC_SAFE_CALL(VecAXPY(nvec[i],-dot,nvec[j]));
+            }
+
+            PETSC_SAFE_CALL(VecNormalize(nvec[i],NULL));
+        }
+
+        PETSC_SAFE_CALL(MatNullSpaceCreate(PETSC_COMM_WORLD,(has_constant == true)?PETSC_TRUE:PETSC_FALSE,nvec.size(),nvec.data(),&nsp));
+
+        // the nullspace keep its own reference
+        for (size_t i = 0 ; i < nvec.size() ; i++)
+        {PETSC_SAFE_CALL(VecDestroy(&nvec[i]));}
+
+        if (vecs.size() != 0)
+        {PETSC_SAFE_CALL(VecGetSize(vecs[0].getVec(),&nsp_size));}
+        else
+        {nsp_size = 0;}
+
+        nsp_constant = false;
+    }
+
+    /*! \brief Destroy the nullspace, the next solve with a nullspace build it again
+     *
+     */
+    void resetNullSpace()
+    {
+        if (nsp != NULL)
+        {PETSC_SAFE_CALL(MatNullSpaceDestroy(&nsp));}
+
+        nsp = NULL;
+        nsp_size = 0;
+        nsp_constant = false;
+    }
+
+    /*! \brief Solve a singular system with a constant nullspace (pure Neumann boundary conditions)
+     *
+     * The constant nullspace is created at the first call and reused by the following ones while the size of the
+     * system does not change, so time dependent solves on the same geometry do not build it again
+     *
+     * \param A sparse matrix
+     * \param b vector
+     *
+     * \return the solution (with zero mean)
+     *
+     */
+    Vector<double,PETSC_BASE> with_constant_nullspace_solve(SparseMatrix<double,int,PETSC_BASE> & A, const Vector<double,PETSC_BASE> & b)
+    {
+        Mat & A_ = fill_timed(A);
+
+        PetscInt row;
+        PetscInt col;
+        PETSC_SAFE_CALL(MatGetSize(A_,&row,&col));
+
+        if (nsp == NULL || nsp_constant == false || nsp_size != row)
+        {
+            resetNullSpace();
+
+            PETSC_SAFE_CALL(MatNullSpaceCreate(PETSC_COMM_WORLD,PETSC_TRUE,0,NULL,&nsp));
+            nsp_size = row;
+            nsp_constant = true;
+        }
+
+        return solve_nsp(A,b);
+    }
+
+    /*! \brief Solve a singular system with the nullspace set with setNullSpace
+     *
+     * \param A sparse matrix
+     * \param b vector
+     *
+     * \return the solution
+     *
+     */
+    Vector<double,PETSC_BASE> nullspace_solve(SparseMatrix<double,int,PETSC_BASE> & A, const Vector<double,PETSC_BASE> & b)
+    {
+        Mat & A_ = fill_timed(A);
+
+        PetscInt row;
+        PetscInt col;
+        PETSC_SAFE_CALL(MatGetSize(A_,&row,&col));
+
+        if (nsp == NULL || nsp_constant == true || (nsp_size != 0 && nsp_size != row))
+        {
+            std::cerr << __FILE__ << ":" << __LINE__ << " error, the nullspace has not been set or it does not match the size of the matrix, use setNullSpace" << std::endl;
+            return solve(A,b);
+        }
+
+        return solve_nsp(A,b);
+    }
+
+    /*! \brief Return the nullspace used by the solves with a nullspace
+     *
+     * \return the nullspace (NULL if not built)
+     *
+     */
+    MatNullSpace getNullSpace()
+    {
+        return nsp;
+    }
+
+    /*! \brief Recycle a deflation space between the solves (GCRO-DR)
+     *
+     * The Krylov solver become HPDDM GCRO-DR, it keep k approximate eigenvectors from every solve and deflate
+     * them in the next one. For sequences of systems with slowly changing matrices (time dependent problems) it
+     * reduce the number of iterations. It requires PETSc with HPDDM
+     *
+     * \param k dimension of the recycled space (0 to disable)
+     *
+     */
+    void setRecycling(PetscInt k)
+    {
+#ifdef PETSC_HAVE_HPDDM
+        if (k > 0)
+        {
+            setSolver(KSPHPDDM);
+            PETSC_SAFE_CALL(PetscOptionsSetValue(NULL,"-ksp_hpddm_type","gcrodr"));
+            PETSC_SAFE_CALL(PetscOptionsSetValue(NULL,"-ksp_hpddm_recycle",std::to_string(k).c_str()));
+        }
+        else
+        {PETSC_SAFE_CALL(PetscOptionsClearValue(NULL,"-ksp_hpddm_recycle"));}
+#else
+        std::cerr << __FILE__ << ":" << __LINE__ << " warning, recycling require PETSc compiled with HPDDM, ignored" << std::endl;
+#endif
+    }
+
+	/*! \brief Return the metrics of the last solve
+	 *
+	 * Fill, preconditioner set-up and solve times, iterations, final residual, non zero and the estimated
+	 * bytes and flops (PETSc flop counter) of the last solve. The solve keeps the values of this processor, the
+	 * first call after a solve reduces them, so it is collective
+	 *
+	 * \return the metrics
+	 *
+	 */
+	solver_metrics & getMetrics()
+	{
+		metrics.reduce();
+
+		return metrics;
+	}
+
+	//! Metrics of the last solve with the values of this processor, without communication
+	solver_metrics & getMetricsLocal()
+	{
+		return metrics;
+	}
+
+	/*! \brief Append the metrics of every solve to a file
+	 *
+	 * The file is written by processor 0, with extension .json one JSON object per line, otherwise CSV
+	 *
+	 * \param file file name (empty to disable)
+	 *
+	 */
+	void setMetricsSink(const std::string & file)
+	{
+		metrics_sink = file;
+	}
+
+	/*! \brief Record the residual norm of every iteration in the metrics
+	 *
+	 * \param record true to record
+	 *
+	 */
+	void recordResidualHistory(bool record)
+	{
+		record_history = record;
+	}
+
 	/*! \brief Return the KSP solver
 	 *
 	 * In case you want to do fine tuning of the KSP solver before
@@ -1670,8 +3087,130 @@ public:
 
 		return x;
 	}
+
+	/*! \brief Set the file where tune store and search the best configuration
+	 *
+	 * \param file tuning file
+	 *
+	 */
+	void setTuningFile(const std::string & file)
+	{
+		tune_file = file;
+	}
+
+	/*! \brief Set the number of iterations of every tuning probe
+	 *
+	 * \param its iterations
+	 *
+	 */
+	void setTuningProbeIterations(PetscInt its)
+	{
+		tune_probe_it = its;
+	}
+
+	/*! \brief Select the Krylov solver and preconditioner for the matrix A
+	 *
+	 * If the tuning file contain a configuration for a matrix with the same size and number of non zero it is
+	 * used directly. Otherwise every Krylov solver in the test list is combined with the preconditioners
+	 * available and run for a few iterations only (setTuningProbeIterations), the time to reach the relative
+	 * tolerance is extrapolated from the decay of the residual and the fastest configuration is selected and
+	 * appended to the tuning file. The following solve use the selected configuration
+	 *
+	 * \param A matrix
+	 * \param b a representative right hand side
+	 *
+	 * \return true if a configuration has been selected
+	 *
+	 */
+	bool tune(SparseMatrix<double,int,PETSC_BASE> & A, const Vector<double,PETSC_BASE> & b)
+	{
+		Mat & A_ = A.getMat();
+		const Vec & b_ = b.getVec();
+
+		auto & v_cl = create_vcluster();
+
+		std::string key = tune_key(A_);
+		std::string best_ksp;
+		std::string best_pc;
+
+		if (tune_load(key,best_ksp,best_pc) == false)
+		{
+			PetscReal rtol;
+			PETSC_SAFE_CALL(KSPGetTolerances(ksp,&rtol,NULL,NULL,NULL));
+
+			openfpm::vector<std::string> pcs;
+			pcs.add(std::string(PCJACOBI));
+			pcs.add(std::string(PCBJACOBI));
+			pcs.add(std::string(PCGAMG));
+#ifdef PETSC_HAVE_HYPRE
+			pcs.add(std::string(PCHYPRE));
+#endif
+
+			double best_t = std::numeric_limits<double>::infinity();
+
+			for (size_t i = 0 ; i < solvs.size() ; i++)
+			{
+				for (size_t j = 0 ; j < pcs.size() ; j++)
+				{
+					double t = tune_probe(A_,b_,solvs.get(i),pcs.get(j),rtol);
+
+					if (t < best_t)
+					{
+						best_t = t;
+						best_ksp = solvs.get(i);
+						best_pc = pcs.get(j);
+					}
+				}
+			}
+
+			if (best_t == std::numeric_limits<double>::infinity())
+			{
+				if (v_cl.getProcessUnitID() == 0)
+				{std::cerr << __FILE__ << ":" << __LINE__ << " warning, no configuration reduced the residual, the solver is unchanged" << std::endl;}
+				return false;
+			}
+
+			if (v_cl.getProcessUnitID() == 0)
+			{
+				std::ofstream out(tune_file,std::ios::app);
+				out << key << " " << best_ksp << " " << best_pc << std::endl;
+			}
+		}
+
+		setSolver(best_ksp.c_str());
+		PETSC_SAFE_CALL(PetscOptionsSetValue(NULL,"-pc_type",best_pc.c_str()));
+		is_preconditioner_set = true;
+
+		// read the new options at the next solve
+		PETSC_SAFE_CALL(KSPSetType(ksp,best_ksp.c_str()));
+		pc_n_setup = 0;
+		pc_mat = NULL;
+		pc_setup_mat = NULL;
+
+		return true;
+	}
 };
 
 #endif
 
+/*! \brief Give the number of variables interleaved in the rows to the solvers that use it (like petsc_solver with
+ *         setFieldSplitLayout), the other solvers receive only the matrix
+ *
+ */
+template<typename solver_type, typename Sfinae = void>
+struct solver_set_field_layout
+{
+	static void set(solver_type & solver, unsigned int nvar)
+	{}
+};
+
+template<typename solver_type>
+struct solver_set_field_layout<solver_type,decltype(std::declval<solver_type &>().setFieldSplitLayout(0u), void())>
+{
+	static void set(solver_type & solver, unsigned int nvar)
+	{
+		solver.setFieldSplitLayout(nvar);
+	}
+};
+
 #endif /* OPENFPM_NUMERICS_SRC_SOLVERS_PETSC_SOLVER_HPP_ */
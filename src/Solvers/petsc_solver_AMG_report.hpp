@@ -31,6 +31,9 @@ struct AMG_time_err_coars
 	//! residual norm
 	double residual;
 
+	//! iterations of the Krylov solver
+	size_t its;
+
 	//! assign a score to the solver
 	double score;
 };
@@ -56,9 +59,15 @@ class petsc_AMG_report
 	//! It contain the performance of several AMG methods sweep configuration
 	openfpm::vector<AMG_time_err_coars> perf_amg_sweep_asym;
 
+	//! It contain the performance of the additive Schwarz preconditioners compared with the global AMG
+	openfpm::vector<AMG_time_err_coars> perf_asm;
+
 	//! List of methods
 	openfpm::vector<std::string> method;
 
+	//! List of the additive Schwarz configurations tested
+	openfpm::vector<std::string> asm_method;
+
 	//! List of tested cycles
 	openfpm::vector<size_t> v_cycle_tested_sym;
 
@@ -108,6 +117,7 @@ class petsc_AMG_report
 		tmp.time_setup = time1 - time2;
 		tmp.time_solve = time2;
 		tmp.residual = serr.err_inf;
+		tmp.its = serr.its;
 
 		perf_amg.add(tmp);
 
@@ -187,6 +197,104 @@ class petsc_AMG_report
 
 	}
 
+	/*! \brief Compare the global BoomerAMG with additive Schwarz and AMG (or LU) on the subdomains
+	 *
+	 * The system is solved with GMRES to a relative tolerance, so the iterations show how the preconditioners
+	 * scale with the number of processors
+	 *
+	 * \param A matrix to invert
+	 * \param b right-hand-side
+	 *
+	 */
+	void test_asm(SparseMatrix<double,int,PETSC_BASE> & A, const Vector<double,PETSC_BASE> & b)
+	{
+		Vcluster<> & v_cl = create_vcluster();
+
+		// Global AMG as reference
+		{
+			petsc_solver<double> solver;
+			solver.setSolver(KSPGMRES);
+			solver.setRelTol(1e-8);
+			solver.setMaxIter(1000);
+			solver.setPreconditioner(PCHYPRE_BOOMERAMG);
+			solver.setPreconditionerAMG_maxit(1);
+
+			A.getMatrixTriplets();
+			if (v_cl.getProcessUnitID() == 0)	{std::cout << "Benchmarking global BoomerAMG" << std::endl;}
+			benchmark(A,b,solver,perf_asm);
+			asm_method.add("BoomerAMG");
+		}
+
+		for (int overlap = 0 ; overlap <= 2 ; overlap++)
+		{
+			petsc_solver<double> solver;
+			solver.setSolver(KSPGMRES);
+			solver.setRelTol(1e-8);
+			solver.setMaxIter(1000);
+			solver.setPreconditioner(PCASM_BOOMERAMG);
+			solver.setPreconditionerASM_overlap(overlap);
+			solver.setPreconditionerAMG_maxit(1);
+
+			A.getMatrixTriplets();
+			if (v_cl.getProcessUnitID() == 0)	{std::cout << "Benchmarking ASM+AMG overlap " << overlap << std::endl;}
+			benchmark(A,b,solver,perf_asm);
+			asm_method.add("ASM+AMG overlap " + std::to_string(overlap));
+		}
+
+		{
+			petsc_solver<double> solver;
+			solver.setSolver(KSPGMRES);
+			solver.setRelTol(1e-8);
+			solver.setMaxIter(1000);
+			solver.setPreconditioner(PCASM_LU);
+			solver.setPreconditionerASM_overlap(1);
+
+			A.getMatrixTriplets();
+			if (v_cl.getProcessUnitID() == 0)	{std::cout << "Benchmarking ASM+LU overlap 1" << std::endl;}
+			benchmark(A,b,solver,perf_asm);
+			asm_method.add("ASM+LU overlap 1");
+		}
+
+		// the options of the subdomains must not leak in the next solvers
+		PETSC_SAFE_CALL(PetscOptionsClearValue(NULL,"-pc_asm_overlap"));
+		PETSC_SAFE_CALL(PetscOptionsClearValue(NULL,"-sub_ksp_type"));
+		PETSC_SAFE_CALL(PetscOptionsClearValue(NULL,"-sub_pc_type"));
+	}
+
+	/*! \brief Write the report for the additive Schwarz preconditioners
+	 *
+	 * \param cg Google chart
+	 *
+	 */
+	void write_report_asm(GoogleChart & cg)
+	{
+		openfpm::vector<std::string> x;
+		openfpm::vector<openfpm::vector<double>> y;
+		openfpm::vector<std::string> yn;
+
+		for (size_t i = 0 ; i < perf_asm.size() ; i++)
+			x.add(asm_method.get(i));
+
+		yn.add("Norm infinity");
+		yn.add("time to setup");
+		yn.add("time to solve");
+		yn.add("iterations");
+
+		for (size_t i = 0 ; i < perf_asm.size() ; i++)
+			y.add({perf_asm.get(i).residual,perf_asm.get(i).time_setup,perf_asm.get(i).time_solve,(double)perf_asm.get(i).its});
+
+		GCoptions options;
+
+		options.title = std::string("Global BoomerAMG against additive Schwarz with AMG or LU on the subdomains (GMRES, relative tolerance 1e-8)");
+		options.yAxis = std::string("Error/time/iterations");
+		options.xAxis = std::string("Method");
+		options.stype = std::string("bars");
+		options.more = std::string("vAxis: {scaleType: 'log'}");
+
+		cg.addHTML("<h2>Additive Schwarz</h2>");
+		cg.AddHistGraph(x,y,yn,options);
+	}
+
 	/*! \brief Score the solver
 	 *
 	 * \param t_solve time to solve
@@ -470,6 +578,8 @@ class petsc_AMG_report
 
 		write_report_cycle_asym(cg,coars);
 
+		write_report_asm(cg);
+
 		cg.write("gc_AMG_preconditioners.html");
 	}
 
@@ -585,6 +695,8 @@ public:
 
 		test_cycle_asym(A,b,sweep_optimal,coa_methods);
 
+		test_asm(A,b);
+
 		write_report(coa_methods);
 	}
 };
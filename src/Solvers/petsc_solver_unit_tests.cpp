@@ -131,6 +131,483 @@ BOOST_AUTO_TEST_CASE( laplacian_3D_int_zero_mg )
 	BOOST_REQUIRE_EQUAL(check,true);
 }
 
+BOOST_AUTO_TEST_CASE( petsc_solver_preconditioner_reuse )
+{
+	Vcluster<> & v_cl = create_vcluster();
+
+	const int loc = 100;
+	const int N = loc*v_cl.getProcessingUnits();
+	const int start = loc*v_cl.getProcessUnitID();
+
+	typedef SparseMatrix<double,int,PETSC_BASE>::triplet_type triplet;
+
+	SparseMatrix<double,int,PETSC_BASE> sm(N,N,loc);
+	Vector<double,PETSC_BASE> b(N,loc);
+
+	auto & triplets = sm.getMatrixTriplets();
+	for (int i = start ; i < start + loc ; i++)
+	{
+		if (i > 0) {triplets.add(triplet(i,i-1,-1.0));}
+		triplets.add(triplet(i,i,2.5));
+		if (i < N-1) {triplets.add(triplet(i,i+1,-1.0));}
+
+		b.insert(i,1.0);
+	}
+
+	// refill the matrix with the same pattern and a new diagonal
+	sm.reusePattern(true);
+	auto refill = [&](double diag)
+	{
+		auto & tr = sm.getMatrixTriplets();
+		for (size_t k = 0 ; k < tr.size() ; k++)
+		{
+			if (tr.get(k).row() == tr.get(k).col())
+			{tr.get(k).value() = diag;}
+		}
+	};
+
+	petsc_solver<double> solver;
+	solver.setSolver(KSPGMRES);
+	solver.setPreconditioner(PCJACOBI);
+
+	// same operator: one set-up, then one more when the values change
+	solver.setPreconditionerReuse(PC_REUSE_SAME_OPERATOR);
+	for (int k = 0 ; k < 5 ; k++)
+	{solver.solve(sm,b);}
+	BOOST_REQUIRE_EQUAL(solver.getNPreconditionerSetup(),1ul);
+
+	refill(2.6);
+	for (int k = 0 ; k < 3 ; k++)
+	{solver.solve(sm,b);}
+	BOOST_REQUIRE_EQUAL(solver.getNPreconditionerSetup(),2ul);
+
+	// lag 2 with values changing at every solve: set-up at the solves 1,3,5
+	solver.setPreconditionerReuse(PC_LAG,2);
+	for (int k = 0 ; k < 5 ; k++)
+	{
+		refill(2.5 + 0.1*k);
+		solver.solve(sm,b);
+	}
+	BOOST_REQUIRE_EQUAL(solver.getNPreconditionerSetup(),3ul);
+
+	// lag 1 on a matrix that does not change: the rebuilds are requested but PETSc skip them
+	solver.setPreconditionerReuse(PC_LAG,1);
+	for (int k = 0 ; k < 3 ; k++)
+	{solver.solve(sm,b);}
+	BOOST_REQUIRE_EQUAL(solver.getNPreconditionerSetup(),0ul);
+
+	// the solution is still correct
+	auto x = solver.solve(sm,b);
+	auto err = solver.get_residual_error(sm,x,b);
+	BOOST_REQUIRE(err.err_inf < 1e-4);
+}
+
+BOOST_AUTO_TEST_CASE( petsc_solver_multiple_rhs )
+{
+	Vcluster<> & v_cl = create_vcluster();
+
+	const int loc = 100;
+	const int N = loc*v_cl.getProcessingUnits();
+	const int start = loc*v_cl.getProcessUnitID();
+	const int nrhs = 3;
+
+	typedef SparseMatrix<double,int,PETSC_BASE>::triplet_type triplet;
+
+	SparseMatrix<double,int,PETSC_BASE> sm(N,N,loc);
+	std::vector<Vector<double,PETSC_BASE>> b(nrhs);
+	for (int j = 0 ; j < nrhs ; j++)
+	{b[j].resize(N,loc);}
+
+	auto & triplets = sm.getMatrixTriplets();
+	for (int i = start ; i < start + loc ; i++)
+	{
+		if (i > 0) {triplets.add(triplet(i,i-1,-1.0));}
+		triplets.add(triplet(i,i,2.5));
+		if (i < N-1) {triplets.add(triplet(i,i+1,-1.0));}
+
+		for (int j = 0 ; j < nrhs ; j++)
+		{b[j].insert(i,sin(0.1*i*(j+1)));}
+	}
+
+	petsc_solver<double> solver;
+	solver.setSolver(KSPGMRES);
+	solver.setPreconditioner(PCJACOBI);
+	solver.setRelTol(1e-10);
+
+	auto x = solver.solve(sm,b);
+
+	BOOST_REQUIRE_EQUAL(x.size(),(size_t)nrhs);
+
+	for (int j = 0 ; j < nrhs ; j++)
+	{
+		auto err = solver.get_residual_error(sm,x[j],b[j]);
+		BOOST_REQUIRE(err.err_inf < 1e-6);
+	}
+}
+
+BOOST_AUTO_TEST_CASE( petsc_solver_tune )
+{
+	Vcluster<> & v_cl = create_vcluster();
+
+	const int loc = 100;
+	const int N = loc*v_cl.getProcessingUnits();
+	const int start = loc*v_cl.getProcessUnitID();
+
+	typedef SparseMatrix<double,int,PETSC_BASE>::triplet_type triplet;
+
+	SparseMatrix<double,int,PETSC_BASE> sm(N,N,loc);
+	Vector<double,PETSC_BASE> b(N,loc);
+
+	auto & triplets = sm.getMatrixTriplets();
+	for (int i = start ; i < start + loc ; i++)
+	{
+		if (i > 0) {triplets.add(triplet(i,i-1,-1.0));}
+		triplets.add(triplet(i,i,2.5));
+		if (i < N-1) {triplets.add(triplet(i,i+1,-1.0));}
+
+		b.insert(i,1.0);
+	}
+
+	std::string file = "petsc_solver_tune_test.txt";
+	if (v_cl.getProcessUnitID() == 0)
+	{std::remove(file.c_str());}
+	v_cl.barrier();
+
+	petsc_solver<double> solver;
+	solver.setTuningFile(file);
+
+	// probe and store
+	BOOST_REQUIRE_EQUAL(solver.tune(sm,b),true);
+	v_cl.barrier();
+
+	// the second one read from the file
+	petsc_solver<double> solver2;
+	solver2.setTuningFile(file);
+	BOOST_REQUIRE_EQUAL(solver2.tune(sm,b),true);
+
+	// the tuned solver converge
+	auto x = solver2.solve(sm,b);
+	auto err = solver2.get_residual_error(sm,x,b);
+	BOOST_REQUIRE(err.err_inf < 1e-4);
+}
+
+BOOST_AUTO_TEST_CASE( petsc_solver_constant_nullspace )
+{
+	Vcluster<> & v_cl = create_vcluster();
+
+	const int loc = 100;
+	const int N = loc*v_cl.getProcessingUnits();
+	const int start = loc*v_cl.getProcessUnitID();
+
+	typedef SparseMatrix<double,int,PETSC_BASE>::triplet_type triplet;
+
+	SparseMatrix<double,int,PETSC_BASE> sm(N,N,loc);
+	Vector<double,PETSC_BASE> b(N,loc);
+
+	// 1D laplacian with Neumann boundary, singular with constant nullspace
+	auto & triplets = sm.getMatrixTriplets();
+	for (int i = start ; i < start + loc ; i++)
+	{
+		double d = 0.0;
+		if (i > 0) {triplets.add(triplet(i,i-1,-1.0)); d += 1.0;}
+		if (i < N-1) {triplets.add(triplet(i,i+1,-1.0)); d += 1.0;}
+		triplets.add(triplet(i,i,d));
+
+		// zero mean right hand side
+		b.insert(i,(i < N/2)?1.0:-1.0);
+	}
+
+	petsc_solver<double> solver;
+	solver.setSolver(KSPGMRES);
+	solver.setPreconditioner(PCJACOBI);
+	solver.setMaxIter(2000);
+
+	auto x = solver.with_constant_nullspace_solve(sm,b);
+	MatNullSpace nsp = solver.getNullSpace();
+	BOOST_REQUIRE(nsp != NULL);
+
+	// the nullspace is reused
+	x = solver.with_constant_nullspace_solve(sm,b);
+	BOOST_REQUIRE(nsp == solver.getNullSpace());
+
+	auto err = solver.get_residual_error(sm,x,b);
+	BOOST_REQUIRE(err.err_inf < 1e-4);
+
+	// the solution has zero mean
+	double sum = 0.0;
+	for (int i = start ; i < start + loc ; i++)
+	{sum += x(i);}
+	v_cl.sum(sum);
+	v_cl.execute();
+
+	BOOST_REQUIRE_SMALL(sum / N,1e-6);
+}
+
+BOOST_AUTO_TEST_CASE( petsc_solver_metrics )
+{
+	Vcluster<> & v_cl = create_vcluster();
+
+	const int loc = 100;
+	const int N = loc*v_cl.getProcessingUnits();
+	const int start = loc*v_cl.getProcessUnitID();
+
+	typedef SparseMatrix<double,int,PETSC_BASE>::triplet_type triplet;
+
+	SparseMatrix<double,int,PETSC_BASE> sm(N,N,loc);
+	Vector<double,PETSC_BASE> b(N,loc);
+
+	auto & triplets = sm.getMatrixTriplets();
+	for (int i = start ; i < start + loc ; i++)
+	{
+		if (i > 0) {triplets.add(triplet(i,i-1,-1.0));}
+		triplets.add(triplet(i,i,2.5));
+		if (i < N-1) {triplets.add(triplet(i,i+1,-1.0));}
+
+		b.insert(i,1.0);
+	}
+
+	std::string file = "petsc_solver_metrics_test.csv";
+	if (v_cl.getProcessUnitID() == 0)
+	{std::remove(file.c_str());}
+
+	petsc_solver<double> solver;
+	solver.setSolver(KSPGMRES);
+	solver.setPreconditioner(PCJACOBI);
+	solver.recordResidualHistory(true);
+	solver.setMetricsSink(file);
+
+	solver.solve(sm,b);
+	solver.solve(sm,b);
+
+	auto & m = solver.getMetrics();
+
+	BOOST_REQUIRE_EQUAL(m.converged,true);
+	BOOST_REQUIRE(m.iterations > 0);
+	BOOST_REQUIRE_EQUAL(m.rows,(size_t)N);
+	BOOST_REQUIRE_EQUAL(m.nnz,(size_t)(3*N-2));
+	BOOST_REQUIRE_EQUAL(m.residual_history.size(),m.iterations+1);
+	BOOST_REQUIRE(m.residual_history.back() < m.residual_history.front());
+	BOOST_REQUIRE(m.bytes > 0.0);
+
+	// header and two solves
+	if (v_cl.getProcessUnitID() == 0)
+	{
+		std::ifstream in(file);
+		std::string line;
+		size_t n_lines = 0;
+		while (std::getline(in,line))	{n_lines++;}
+
+		BOOST_REQUIRE_EQUAL(n_lines,3ul);
+	}
+}
+
+BOOST_AUTO_TEST_CASE( petsc_solver_reordering )
+{
+	Vcluster<> & v_cl = create_vcluster();
+
+	// 2D laplacian with the local points numbered in a scrambled order
+	const int n = 20;
+	const int loc = n*n;
+	const int N = loc*v_cl.getProcessingUnits();
+	const int start = loc*v_cl.getProcessUnitID();
+
+	std::vector<int> id(loc);
+	for (int i = 0 ; i < loc ; i++)	{id[i] = (i*37) % loc;}
+
+	typedef SparseMatrix<double,int,PETSC_BASE>::triplet_type triplet;
+
+	SparseMatrix<double,int,PETSC_BASE> sm(N,N,loc);
+	Vector<double,PETSC_BASE> b(N,loc);
+
+	auto & triplets = sm.getMatrixTriplets();
+	for (int r = 0 ; r < loc ; r++)
+	{
+		// the row r is the point id[r]
+		int i = id[r] / n;
+		int j = id[r] % n;
+
+		std::vector<std::pair<int,double>> row;
+		row.push_back(std::make_pair(r,4.5));
+		for (int r2 = 0 ; r2 < loc ; r2++)
+		{
+			int i2 = id[r2] / n;
+			int j2 = id[r2] % n;
+			if (abs(i2-i) + abs(j2-j) == 1)	{row.push_back(std::make_pair(r2,-1.0));}
+		}
+
+		std::sort(row.begin(),row.end());
+		for (size_t k = 0 ; k < row.size() ; k++)
+		{triplets.add(triplet(start + r,start + row[k].first,row[k].second));}
+
+		b.insert(start + r,1.0 + 0.01*id[r]);
+	}
+
+	petsc_solver<double> solver;
+	solver.setSolver(KSPGMRES);
+	solver.setPreconditioner(PCBJACOBI);
+	solver.setAbsTol(1e-12);
+	solver.setRelTol(1e-12);
+
+	auto x = solver.solve(sm,b);
+
+	petsc_solver<double> solver_rcm;
+	solver_rcm.setSolver(KSPGMRES);
+	solver_rcm.setPreconditioner(PCBJACOBI);
+	solver_rcm.setAbsTol(1e-12);
+	solver_rcm.setRelTol(1e-12);
+	solver_rcm.setReordering(MATORDERINGRCM);
+
+	auto x_rcm = solver_rcm.solve(sm,b);
+
+	for (int r = start ; r < start + loc ; r++)
+	{BOOST_REQUIRE_CLOSE(x(r),x_rcm(r),1e-6);}
+}
+
+BOOST_AUTO_TEST_CASE( petsc_solver_asm_subdomain )
+{
+	Vcluster<> & v_cl = create_vcluster();
+
+	const int loc = 200;
+	const int N = loc*v_cl.getProcessingUnits();
+	const int start = loc*v_cl.getProcessUnitID();
+
+	typedef SparseMatrix<double,int,PETSC_BASE>::triplet_type triplet;
+
+	SparseMatrix<double,int,PETSC_BASE> sm(N,N,loc);
+	Vector<double,PETSC_BASE> b(N,loc);
+
+	auto & triplets = sm.getMatrixTriplets();
+	for (int i = start ; i < start + loc ; i++)
+	{
+		if (i > 0) {triplets.add(triplet(i,i-1,-1.0));}
+		triplets.add(triplet(i,i,2.01));
+		if (i < N-1) {triplets.add(triplet(i,i+1,-1.0));}
+
+		b.insert(i,1.0);
+	}
+
+	PCType pcs[] = {PCASM_LU,PCASM_BOOMERAMG};
+
+	for (size_t k = 0 ; k < 2 ; k++)
+	{
+		petsc_solver<double> solver;
+		solver.setSolver(KSPGMRES);
+		solver.setPreconditioner(pcs[k]);
+		solver.setPreconditionerASM_overlap(2);
+		solver.setRelTol(1e-10);
+
+		auto x = solver.solve(sm,b);
+		auto & m = solver.getMetrics();
+
+		BOOST_REQUIRE_EQUAL(m.converged,true);
+
+		solError err = solver.get_residual_error(sm,x,b);
+		BOOST_REQUIRE(err.err_inf < 1e-6);
+	}
+}
+
+BOOST_AUTO_TEST_CASE( petsc_solver_pipelined )
+{
+	Vcluster<> & v_cl = create_vcluster();
+
+	const int loc = 100;
+	const int N = loc*v_cl.getProcessingUnits();
+	const int start = loc*v_cl.getProcessUnitID();
+
+	typedef SparseMatrix<double,int,PETSC_BASE>::triplet_type triplet;
+
+	SparseMatrix<double,int,PETSC_BASE> sm(N,N,loc);
+	Vector<double,PETSC_BASE> b(N,loc);
+
+	auto & triplets = sm.getMatrixTriplets();
+	for (int i = start ; i < start + loc ; i++)
+	{
+		if (i > 0) {triplets.add(triplet(i,i-1,-1.0));}
+		triplets.add(triplet(i,i,2.5));
+		if (i < N-1) {triplets.add(triplet(i,i+1,-1.0));}
+
+		b.insert(i,1.0);
+	}
+
+	KSPType ksps[] = {KSPPIPECG,KSPPGMRES,KSPCG};
+
+	for (size_t k = 0 ; k < 3 ; k++)
+	{
+		petsc_solver<double> solver;
+		solver.setSolver(ksps[k]);
+		solver.setPreconditioner(PCJACOBI);
+		solver.setLatencyHiding(true);
+		solver.setRelTol(1e-10);
+		solver.recordResidualHistory(true);
+
+		auto x = solver.solve(sm,b);
+		auto & m = solver.getMetrics();
+
+		BOOST_REQUIRE_EQUAL(m.converged,true);
+		BOOST_REQUIRE(m.residual_history.size() > 1);
+
+		solError err = solver.get_residual_error(sm,x,b);
+		BOOST_REQUIRE(err.err_inf < 1e-6);
+
+		solver.setLatencyHiding(false);
+	}
+}
+
+BOOST_AUTO_TEST_CASE( petsc_solver_fieldsplit )
+{
+	Vcluster<> & v_cl = create_vcluster();
+
+	// 1D stabilized Stokes, velocity and pressure interleaved: row 2i is u_i, row 2i+1 is p_i
+	const int loc = 100;
+	const int M = loc*v_cl.getProcessingUnits();
+	const int start = loc*v_cl.getProcessUnitID();
+
+	typedef SparseMatrix<double,int,PETSC_BASE>::triplet_type triplet;
+
+	SparseMatrix<double,int,PETSC_BASE> sm(2*M,2*M,2*loc);
+	Vector<double,PETSC_BASE> b(2*M,2*loc);
+
+	auto & triplets = sm.getMatrixTriplets();
+	for (int i = start ; i < start + loc ; i++)
+	{
+		if (i > 0) {triplets.add(triplet(2*i,2*(i-1),-1.0));}
+		triplets.add(triplet(2*i,2*i,2.0));
+		if (i < M-1) {triplets.add(triplet(2*i,2*(i+1),-1.0));}
+
+		triplets.add(triplet(2*i,2*i+1,-1.0));
+		if (i < M-1) {triplets.add(triplet(2*i,2*(i+1)+1,1.0));}
+
+		triplets.add(triplet(2*i+1,2*i,1.0));
+		if (i > 0) {triplets.add(triplet(2*i+1,2*(i-1),-1.0));}
+		triplets.add(triplet(2*i+1,2*i+1,-0.01));
+
+		b.insert(2*i,sin(0.1*i));
+		b.insert(2*i+1,0.0);
+	}
+
+	fieldsplit_type types[] = {FIELDSPLIT_ADDITIVE,FIELDSPLIT_SCHUR_SIMPLE,FIELDSPLIT_SCHUR_MASS};
+
+	for (size_t k = 0 ; k < 3 ; k++)
+	{
+		petsc_solver<double> solver;
+		solver.setSolver(KSPFGMRES);
+		solver.setPreconditionerFieldSplit(types[k]);
+		solver.setFieldSplitLayout(2);
+		solver.setRelTol(1e-10);
+
+		auto x = solver.solve(sm,b);
+		auto & m = solver.getMetrics();
+
+		BOOST_REQUIRE_EQUAL(m.converged,true);
+
+		solError err = solver.get_residual_error(sm,x,b);
+		BOOST_REQUIRE(err.err_inf < 1e-6);
+	}
+
+	// the field split options stay in the PETSc database
+	PETSC_SAFE_CALL(PetscOptionsClearValue(NULL,"-pc_type"));
+}
+
 BOOST_AUTO_TEST_SUITE_END()
 
 #endif
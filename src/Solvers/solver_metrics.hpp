@@ -0,0 +1,246 @@
+/*
+ * solver_metrics.hpp
+ *
+ *  Timers and counters of a linear solve
+ */
+
+#ifndef OPENFPM_NUMERICS_SRC_SOLVERS_SOLVER_METRICS_HPP_
+#define OPENFPM_NUMERICS_SRC_SOLVERS_SOLVER_METRICS_HPP_
+
+#include <vector>
+#include <string>
+#include <fstream>
+#include <iostream>
+#include <iomanip>
+#include <type_traits>
+#include <utility>
+#include "VCluster/VCluster.hpp"
+
+/*! \brief Metrics of the last linear solve
+ *
+ * Filled by the solvers (petsc_solver, umfpack_solver) at every solve and by the schemes (DCPSE_scheme, FD_scheme)
+ * for the assembly. Times are wall clock seconds (maximum over the processors for the parallel solvers), bytes and
+ * flops are estimates of the solve phase. The parallel solvers store the values of their processor (local is true),
+ * they are reduced only when they are read (reduce), so a solve does not add reductions
+ *
+ */
+struct solver_metrics
+{
+	//! time to impose the operators (triplets construction)
+	double assembly_time = 0.0;
+
+	//! time to fill the solver matrix from the triplets
+	double fill_time = 0.0;
+
+	//! time of the preconditioner set-up (or of the factorization for direct solvers)
+	double pc_setup_time = 0.0;
+
+	//! time of the iterations (or of the triangular solves for direct solvers)
+	double solve_time = 0.0;
+
+	//! number of iterations
+	size_t iterations = 0;
+
+	//! the solver converged
+	bool converged = true;
+
+	//! final residual norm
+	double residual = 0.0;
+
+	//! residual norm at every iteration (if recorded)
+	std::vector<double> residual_history;
+
+	//! global number of rows
+	size_t rows = 0;
+
+	//! global number of non zero
+	size_t nnz = 0;
+
+	//! estimated bytes moved by the solve
+	double bytes = 0.0;
+
+	//! floating point operations of the solve (counted by the library or estimated)
+	double flops = 0.0;
+
+	//! the times, non zero, bytes and flops are the ones of this processor, see reduce
+	bool local = false;
+
+	/*! \brief Make the values of this processor global: maximum of the times, sum of non zero, bytes and flops
+	 *
+	 * It is collective if the values are local, otherwise it does nothing
+	 *
+	 */
+	void reduce()
+	{
+		if (local == false)
+		{return;}
+
+		auto & v_cl = create_vcluster();
+		v_cl.max(fill_time);
+		v_cl.max(pc_setup_time);
+		v_cl.max(solve_time);
+		v_cl.sum(nnz);
+		v_cl.sum(bytes);
+		v_cl.sum(flops);
+		v_cl.execute();
+
+		local = false;
+	}
+
+	//! Reset all the metrics but the assembly time, set by the scheme before the solve
+	void reset_solve()
+	{
+		fill_time = 0.0;
+		pc_setup_time = 0.0;
+		solve_time = 0.0;
+		iterations = 0;
+		converged = true;
+		residual = 0.0;
+		residual_history.clear();
+		rows = 0;
+		nnz = 0;
+		bytes = 0.0;
+		flops = 0.0;
+		local = false;
+	}
+
+	/*! \brief Write the metrics as one JSON object
+	 *
+	 * \param out stream
+	 *
+	 */
+	void write_json(std::ostream & out) const
+	{
+		out << std::setprecision(9)
+			<< "{\"assembly_time\":" << assembly_time
+			<< ",\"fill_time\":" << fill_time
+			<< ",\"pc_setup_time\":" << pc_setup_time
+			<< ",\"solve_time\":" << solve_time
+			<< ",\"iterations\":" << iterations
+			<< ",\"converged\":" << ((converged == true)?"true":"false")
+			<< ",\"residual\":" << residual
+			<< ",\"rows\":" << rows
+			<< ",\"nnz\":" << nnz
+			<< ",\"bytes\":" << bytes
+			<< ",\"flops\":" << flops
+			<< ",\"residual_history\":[";
+
+		for (size_t i = 0 ; i < residual_history.size() ; i++)
+		{out << ((i == 0)?"":",") << residual_history[i];}
+
+		out << "]}";
+	}
+
+	/*! \brief Write the header of the CSV format
+	 *
+	 * \param out stream
+	 *
+	 */
+	static void write_csv_header(std::ostream & out)
+	{
+		out << "assembly_time,fill_time,pc_setup_time,solve_time,iterations,converged,residual,rows,nnz,bytes,flops" << std::endl;
+	}
+
+	/*! \brief Write the metrics as one CSV line (without the residual history)
+	 *
+	 * \param out stream
+	 *
+	 */
+	void write_csv(std::ostream & out) const
+	{
+		out << std::setprecision(9)
+			<< assembly_time << "," << fill_time << "," << pc_setup_time << "," << solve_time << ","
+			<< iterations << "," << converged << "," << residual << "," << rows << "," << nnz << ","
+			<< bytes << "," << flops << std::endl;
+	}
+
+	/*! \brief Append the metrics to a file
+	 *
+	 * Files ending with .json get one JSON object per line, the others one CSV line (the header is written when
+	 * the file is created)
+	 *
+	 * \param file file name
+	 *
+	 */
+	void append(const std::string & file) const
+	{
+		bool json = file.size() >= 5 && file.compare(file.size() - 5,5,".json") == 0;
+
+		bool exist;
+		{
+			std::ifstream in(file);
+			exist = in.good();
+		}
+
+		std::ofstream out(file,std::ios::app);
+		if (out.is_open() == false)
+		{
+			std::cerr << __FILE__ << ":" << __LINE__ << " error, cannot open the metrics file " << file << std::endl;
+			return;
+		}
+
+		if (json == true)
+		{
+			write_json(out);
+			out << std::endl;
+		}
+		else
+		{
+			if (exist == false)
+			{write_csv_header(out);}
+
+			write_csv(out);
+		}
+	}
+};
+
+/*! \brief Access the metrics of a solver, for solvers without getMetrics it does nothing
+ *
+ * \tparam solver_type solver
+ *
+ */
+template<typename solver_type, typename Sfinae = void>
+struct solver_metrics_access
+{
+	//! Set the assembly time in the solver metrics
+	static void set_assembly_time(solver_type & solver, double t)
+	{}
+
+	//! Copy the solver metrics in m, return false if the solver has no metrics
+	static bool get(solver_type & solver, solver_metrics & m)
+	{
+		return false;
+	}
+};
+
+template<typename solver_type>
+struct solver_metrics_access<solver_type,typename std::enable_if<std::is_same<decltype(std::declval<solver_type &>().getMetrics()),solver_metrics &>::value>::type>
+{
+	//! Metrics without reduction, for the solvers that keep them local (getMetricsLocal)
+	template<typename S>
+	static auto raw(S & solver, int) -> decltype(solver.getMetricsLocal())
+	{
+		return solver.getMetricsLocal();
+	}
+
+	template<typename S>
+	static solver_metrics & raw(S & solver, long)
+	{
+		return solver.getMetrics();
+	}
+
+	//! Set the assembly time in the solver metrics
+	static void set_assembly_time(solver_type & solver, double t)
+	{
+		raw(solver,0).assembly_time = t;
+	}
+
+	//! Copy the solver metrics in m (still local if the solver keep them local, see solver_metrics::reduce)
+	static bool get(solver_type & solver, solver_metrics & m)
+	{
+		m = raw(solver,0);
+		return true;
+	}
+};
+
+#endif /* OPENFPM_NUMERICS_SRC_SOLVERS_SOLVER_METRICS_HPP_ */
@@ -21,7 +21,10 @@
 /////// Compiled with EIGEN support
 
 #include "Vector/Vector.hpp"
+#include "Solvers/solver_metrics.hpp"
 #include "Eigen/UmfPackSupport"
+#include <vector>
+#include <algorithm>
 #include <Eigen/SparseLU>
 
 
@@ -50,8 +53,122 @@ class umfpack_solver<double>
 
 	Eigen::SparseMatrix<double,0,int> mat_ei;
 
+	//! true if solver contain a symbolic analysis of the pattern of mat_ei
+	bool analyzed = false;
+
+	//! true if solver contain a numeric factorization of mat_ei
+	bool factorized = false;
+
+	//! number of symbolic analysis done
+	size_t n_analyze = 0;
+
+	//! number of numeric factorization done
+	size_t n_factorize = 0;
+
+	//! metrics of the last solve
+	solver_metrics metrics;
+
+	//! file where the metrics of every solve are appended (empty for none)
+	std::string metrics_sink;
+
+	/*! \brief Factorize the matrix m reusing what is possible from the previous factorization
+	 *
+	 * If m has the same pattern of the previous matrix the symbolic analysis is skipped, if it has also the
+	 * same values the factorization is skipped
+	 *
+	 * \param m matrix to factorize
+	 *
+	 */
+	void factorize_cached(const Eigen::SparseMatrix<double,0,int> & m)
+	{
+		bool same_pattern = analyzed == true && m.isCompressed() &&
+						    m.rows() == mat_ei.rows() && m.cols() == mat_ei.cols() && m.nonZeros() == mat_ei.nonZeros() &&
+							std::equal(m.outerIndexPtr(),m.outerIndexPtr()+m.outerSize()+1,mat_ei.outerIndexPtr()) &&
+							std::equal(m.innerIndexPtr(),m.innerIndexPtr()+m.nonZeros(),mat_ei.innerIndexPtr());
+
+		if (same_pattern == true && factorized == true && solver.info() == Eigen::Success &&
+			std::equal(m.valuePtr(),m.valuePtr()+m.nonZeros(),mat_ei.valuePtr()))
+		{return;}
+
+		mat_ei = m;
+		mat_ei.makeCompressed();
+
+		if (same_pattern == false)
+		{
+			solver.analyzePattern(mat_ei);
+			analyzed = (solver.info() == Eigen::Success);
+			n_analyze++;
+		}
+
+		solver.factorize(mat_ei);
+		factorized = (solver.info() == Eigen::Success);
+		n_factorize++;
+	}
+
 public:
 
+	/*! \brief Return the metrics of the last solve
+	 *
+	 * The preconditioner set-up time is the time of the analysis and factorization (0 if cached), the solve time
+	 * is the time of the triangular solves, flops and bytes are estimated from the non zero of the factors
+	 *
+	 * \return the metrics
+	 *
+	 */
+	solver_metrics & getMetrics()
+	{
+		return metrics;
+	}
+
+	/*! \brief Fill-reducing ordering of the factorization
+	 *
+	 * UMFPACK_ORDERING_AMD (default of UMFPACK for most matrices), UMFPACK_ORDERING_METIS (nested dissection, if
+	 * SuiteSparse has METIS), UMFPACK_ORDERING_CHOLMOD, UMFPACK_ORDERING_BEST (tries several and keep the best)
+	 * or UMFPACK_ORDERING_NONE. UMFPACK permutes the matrix internally and solves in the original ordering, so A,
+	 * b and x are not touched. The next solve does the symbolic analysis again
+	 *
+	 * \param ordering UMFPACK ordering
+	 *
+	 */
+	void setOrdering(int ordering)
+	{
+		solver.umfpackControl()(UMFPACK_ORDERING) = ordering;
+		analyzed = false;
+		factorized = false;
+	}
+
+	/*! \brief Append the metrics of every solve to a file
+	 *
+	 * The file is written by processor 0, with extension .json one JSON object per line, otherwise CSV
+	 *
+	 * \param file file name (empty to disable)
+	 *
+	 */
+	void setMetricsSink(const std::string & file)
+	{
+		metrics_sink = file;
+	}
+
+	/*! \brief Number of symbolic analysis done by the solver
+	 *
+	 * \return the number of analysis
+	 *
+	 */
+	size_t getNAnalyze()
+	{
+		return n_analyze;
+	}
+
+	/*! \brief Number of numeric factorization done by the solver
+	 *
+	 * \return the number of factorizations
+	 *
+	 */
+	size_t getNFactorize()
+	{
+		return n_factorize;
+	}
+
 	/*! \brief Here we invert the matrix and solve the system
 	 *
 	 *  \warning umfpack is not a parallel solver, this function work only with one processor
@@ -81,8 +198,16 @@ public:
 
 		Vector<double> x;
 
+		metrics.reset_solve();
+
+		timer t_fill;
+		t_fill.start();
+
 		// Collect the matrix on master
-		mat_ei = A.getMat();
+		const Eigen::SparseMatrix<double,0,int> & mat_A = A.getMat();
+
+		t_fill.stop();
+		metrics.fill_time = t_fill.getwct();
 
 		Eigen::Matrix<double, Eigen::Dynamic, 1> x_ei;
 
@@ -94,20 +219,33 @@ public:
 
 		if (vcl.getProcessUnitID() == 0)
 		{
-			solver.compute(mat_ei);
+			timer t_fact;
+			t_fact.start();
+
+			factorize_cached(mat_A);
+
+			t_fact.stop();
+			metrics.pc_setup_time = t_fact.getwct();
 
 			if(solver.info()!=Eigen::Success)
 			{
 				// Linear solver failed
 				std::cout << __FILE__ << ":" << __LINE__ << " solver failed" << "\n";
 
+				metrics.converged = false;
+
 				x.scatter();
 
 				return x;
 			}
 
+			timer t_solve;
+			t_solve.start();
+
 			x_ei = solver.solve(b_ei);
 
+			t_solve.stop();
+
 			//if (opt & SOLVER_PRINT_RESIDUAL_NORM_INFINITY)
 			//{
 				Eigen::Matrix<double, Eigen::Dynamic, 1> res;
@@ -116,6 +254,20 @@ public:
 				std::cout << "Infinity norm: " << res.lpNorm<Eigen::Infinity>() << "\n";
 			//}
 
+			metrics.solve_time = t_solve.getwct();
+			metrics.iterations = 1;
+			metrics.residual = res.lpNorm<Eigen::Infinity>();
+			metrics.rows = mat_ei.rows();
+			metrics.nnz = mat_ei.nonZeros();
+
+			// forward and backward substitution on the factors (the LU has at least the non zero of A)
+			double nnz_lu = (double)metrics.nnz;
+			metrics.flops = 4.0 * nnz_lu;
+			metrics.bytes = nnz_lu * (sizeof(double) + sizeof(int)) + 3.0 * metrics.rows * sizeof(double);
+
+			if (metrics_sink.size() != 0)
+			{metrics.append(metrics_sink);}
+
 			if (opt & SOLVER_PRINT_DETERMINANT)
 			{
 				std::cout << " Determinant: " << solver.determinant() << "\n";
@@ -135,6 +287,91 @@ public:
 		return x;
 	}
 
+	/*! \brief Factorize the matrix once and solve the system for several right hand sides
+	 *
+	 * The right hand sides are packed in the colums of one dense matrix and solved together with the same
+	 * numeric factorization
+	 *
+	 *  \warning umfpack is not a parallel solver, this function work only with one processor
+	 *
+	 * \param A sparse matrix
+	 * \param b right hand sides
+	 * \param opt options
+	 *
+	 * \return one solution for each right hand side
+	 *
+	 */
+	std::vector<Vector<double,EIGEN_BASE>> solve(SparseMatrix<double,int,EIGEN_BASE> & A, const std::vector<Vector<double,EIGEN_BASE>> & b, size_t opt = UMFPACK_NONE)
+	{
+		Vcluster<> & vcl = create_vcluster();
+
+		std::vector<Vector<double,EIGEN_BASE>> x(b.size());
+
+		if (b.size() == 0)
+		{return x;}
+
+		// Collect the matrix on master
+		const Eigen::SparseMatrix<double,0,int> & mat_A = A.getMat();
+
+		Eigen::Matrix<double, Eigen::Dynamic, Eigen::Dynamic> B;
+
+		for (size_t j = 0 ; j < b.size() ; j++)
+		{
+			// Collect the vector on master
+			const Eigen::Matrix<double, Eigen::Dynamic, 1> & b_ei = b[j].getVec();
+
+			if (vcl.getProcessUnitID() == 0)
+			{
+				if (j == 0) {B.resize(b_ei.size(),b.size());}
+				B.col(j) = b_ei;
+			}
+
+			// Copy b into x, this also copy the information on how to scatter back the information on x
+			x[j] = b[j];
+		}
+
+		if (vcl.getProcessUnitID() == 0)
+		{
+			factorize_cached(mat_A);
+
+			if(solver.info()!=Eigen::Success)
+			{
+				// Linear solver failed
+				std::cout << __FILE__ << ":" << __LINE__ << " solver failed" << "\n";
+
+				for (size_t j = 0 ; j < x.size() ; j++)
+				{x[j].scatter();}
+
+				return x;
+			}
+
+			Eigen::Matrix<double, Eigen::Dynamic, Eigen::Dynamic> X = solver.solve(B);
+
+			if (opt & SOLVER_PRINT_RESIDUAL_NORM_INFINITY)
+			{
+				Eigen::Matrix<double, Eigen::Dynamic, Eigen::Dynamic> res = mat_ei * X - B;
+				std::cout << "Infinity norm: " << res.lpNorm<Eigen::Infinity>() << "\n";
+			}
+
+			if (opt & SOLVER_PRINT_DETERMINANT)
+			{
+				std::cout << " Determinant: " << solver.determinant() << "\n";
+			}
+
+			for (size_t j = 0 ; j < x.size() ; j++)
+			{
+				Eigen::Matrix<double, Eigen::Dynamic, 1> x_ei = X.col(j);
+				x[j] = x_ei;
+			}
+		}
+
+		// Vectors are only on master, scatter back the information
+		for (size_t j = 0 ; j < x.size() ; j++)
+		{x[j].scatter();}
+
+		return x;
+	}
+
 	/*! \brief Here we invert the matrix and solve the system
 	 *
 	 *  \warning umfpack is not a parallel solver, this function work only with one processor
@@ -182,6 +419,239 @@ public:
 	}
 };
 
+
+/*! \brief Single precision direct solver with the interface of umfpack_solver
+ *
+ * UMFPACK has only a double precision version, the float systems are factorized with the sparse LU of Eigen. Matrix,
+ * factors and vectors are in single precision, so the factorization and the triangular solves move half of the
+ * bytes of the double solve. The symbolic analysis and the factorization are cached as in umfpack_solver<double>.
+ * It is the solver_type of the float EIGEN_BASE systems and the inner solver for mixed precision refinement
+ *
+ *  \warning like umfpack it is not a parallel solver, the system is collected and solved on processor 0
+ *
+ */
+template<>
+class umfpack_solver<float>
+{
+	//! single precision factorization
+	Eigen::SparseLU<Eigen::SparseMatrix<float,0,int> > solver;
+
+	//! factorized matrix
+	Eigen::SparseMatrix<float,0,int> mat_ei;
+
+	//! true if solver contain a symbolic analysis of the pattern of mat_ei
+	bool analyzed = false;
+
+	//! true if solver contain a numeric factorization of mat_ei
+	bool factorized = false;
+
+	//! number of symbolic analysis done
+	size_t n_analyze = 0;
+
+	//! number of numeric factorization done
+	size_t n_factorize = 0;
+
+	//! metrics of the last solve
+	solver_metrics metrics;
+
+	//! file where the metrics of every solve are appended (empty for none)
+	std::string metrics_sink;
+
+	/*! \brief Factorize the matrix m reusing what is possible from the previous factorization
+	 *
+	 * \param m matrix to factorize
+	 *
+	 */
+	void factorize_cached(const Eigen::SparseMatrix<float,0,int> & m)
+	{
+		bool same_pattern = analyzed == true && m.isCompressed() &&
+						    m.rows() == mat_ei.rows() && m.cols() == mat_ei.cols() && m.nonZeros() == mat_ei.nonZeros() &&
+							std::equal(m.outerIndexPtr(),m.outerIndexPtr()+m.outerSize()+1,mat_ei.outerIndexPtr()) &&
+							std::equal(m.innerIndexPtr(),m.innerIndexPtr()+m.nonZeros(),mat_ei.innerIndexPtr());
+
+		if (same_pattern == true && factorized == true && solver.info() == Eigen::Success &&
+			std::equal(m.valuePtr(),m.valuePtr()+m.nonZeros(),mat_ei.valuePtr()))
+		{return;}
+
+		mat_ei = m;
+		mat_ei.makeCompressed();
+
+		if (same_pattern == false)
+		{
+			solver.analyzePattern(mat_ei);
+			analyzed = true;
+			n_analyze++;
+		}
+
+		solver.factorize(mat_ei);
+		factorized = (solver.info() == Eigen::Success);
+		n_factorize++;
+	}
+
+public:
+
+	//! Return the metrics of the last solve
+	solver_metrics & getMetrics()
+	{
+		return metrics;
+	}
+
+	/*! \brief Append the metrics of every solve to a file
+	 *
+	 * \param file file name (empty to disable)
+	 *
+	 */
+	void setMetricsSink(const std::string & file)
+	{
+		metrics_sink = file;
+	}
+
+	//! Number of symbolic analysis done by the solver
+	size_t getNAnalyze()
+	{
+		return n_analyze;
+	}
+
+	//! Number of numeric factorization done by the solver
+	size_t getNFactorize()
+	{
+		return n_factorize;
+	}
+
+	//! Same as solve
+	Vector<float,EIGEN_BASE> try_solve(SparseMatrix<float,int,EIGEN_BASE> & A, const Vector<float,EIGEN_BASE> & b, size_t opt = UMFPACK_NONE)
+	{
+		return solve(A,b,opt);
+	}
+
+	/*! \brief Here we invert the matrix and solve the system
+	 *
+	 *  \warning it is not a parallel solver, this function work only with one processor
+	 *
+	 * \param A matrix
+	 * \param b right hand side
+	 * \param opt options
+	 *
+	 * \return the solution
+	 *
+	 */
+	Vector<float,EIGEN_BASE> solve(SparseMatrix<float,int,EIGEN_BASE> & A, const Vector<float,EIGEN_BASE> & b, size_t opt = UMFPACK_NONE)
+	{
+		Vcluster<> & vcl = create_vcluster();
+
+		Vector<float> x;
+
+		metrics.reset_solve();
+
+		timer t_fill;
+		t_fill.start();
+
+		// Collect the matrix on master
+		const Eigen::SparseMatrix<float,0,int> & mat_A = A.getMat();
+
+		t_fill.stop();
+		metrics.fill_time = t_fill.getwct();
+
+		// Collect the vector on master
+		auto b_ei = b.getVec();
+
+		// Copy b into x, this also copy the information on how to scatter back the information on x
+		x = b;
+
+		if (vcl.getProcessUnitID() == 0)
+		{
+			timer t_fact;
+			t_fact.start();
+
+			factorize_cached(mat_A);
+
+			t_fact.stop();
+			metrics.pc_setup_time = t_fact.getwct();
+
+			if(solver.info()!=Eigen::Success)
+			{
+				// Linear solver failed
+				std::cout << __FILE__ << ":" << __LINE__ << " solver failed" << "\n";
+
+				metrics.converged = false;
+
+				x.scatter();
+
+				return x;
+			}
+
+			timer t_solve;
+			t_solve.start();
+
+			Eigen::Matrix<float, Eigen::Dynamic, 1> x_ei = solver.solve(b_ei);
+
+			t_solve.stop();
+
+			Eigen::Matrix<float, Eigen::Dynamic, 1> res = mat_ei * x_ei - b_ei;
+
+			if (opt & SOLVER_PRINT_RESIDUAL_NORM_INFINITY)
+			{std::cout << "Infinity norm: " << res.lpNorm<Eigen::Infinity>() << "\n";}
+
+			metrics.solve_time = t_solve.getwct();
+			metrics.iterations = 1;
+			metrics.residual = res.lpNorm<Eigen::Infinity>();
+			metrics.rows = mat_ei.rows();
+			metrics.nnz = mat_ei.nonZeros();
+
+			double nnz_lu = (double)metrics.nnz;
+			metrics.flops = 4.0 * nnz_lu;
+			metrics.bytes = nnz_lu * (sizeof(float) + sizeof(int)) + 3.0 * metrics.rows * sizeof(float);
+
+			if (metrics_sink.size() != 0)
+			{metrics.append(metrics_sink);}
+
+			if (opt & SOLVER_PRINT_DETERMINANT)
+			{
+				std::cout << " Determinant: " << solver.determinant() << "\n";
+			}
+
+			x = x_ei;
+		}
+
+		// Vector is only on master, scatter back the information
+		x.scatter();
+
+		return x;
+	}
+
+	/*! \brief Solve with the last factorization
+	 *
+	 * \param b right hand side
+	 * \param opt options
+	 *
+	 * \return the solution
+	 *
+	 */
+	Vector<float,EIGEN_BASE> solve(const Vector<float,EIGEN_BASE> & b, size_t opt = UMFPACK_NONE)
+	{
+		Vcluster<> & vcl = create_vcluster();
+
+		Vector<float> x;
+
+		// Collect the vector on master
+		auto b_ei = b.getVec();
+
+		// Copy b into x, this also copy the information on how to scatter back the information on x
+		x = b;
+
+		if (vcl.getProcessUnitID() == 0)
+		{
+			Eigen::Matrix<float, Eigen::Dynamic, 1> x_ei = solver.solve(b_ei);
+			x = x_ei;
+		}
+
+		// Vector is only on master, scatter back the information
+		x.scatter();
+
+		return x;
+	}
+};
+
 #else
 
 /////// Compiled without EIGEN support
@@ -175,6 +175,13 @@ public:
 	 *
 	 */
 	int & getVec() {std::cerr << __FILE__ << ":" << __LINE__ << " Error in order to use this class you must compile OpenFPM with linear algebra support" << std::endl; return stub_i;}
+
+	/*! \brief stub getMemoryUsage
+	 *
+	 * \return 0
+	 *
+	 */
+	size_t getMemoryUsage() const {return 0;}
 };
 
 #ifdef HAVE_EIGEN
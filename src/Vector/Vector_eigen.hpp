@@ -17,6 +17,9 @@
 #include <boost/mpl/vector_c.hpp>
 #include <unordered_map>
 #include "Vector_util.hpp"
+#ifdef _OPENMP
+#include <omp.h>
+#endif
 
 #define EIGEN_RVAL 1
 
@@ -329,6 +332,89 @@ public:
 		return v;
 	}
 
+	/*! \brief Memory used by the vector in byte on this processor (the hash map of the rows is not counted)
+	 *
+	 * \return the memory in byte
+	 *
+	 */
+	size_t getMemoryUsage() const
+	{
+		return v.size()*sizeof(T) + (row_val.size() + row_val_recv.size())*sizeof(rval<T,EIGEN_RVAL>)
+		       + (prc.size() + sz.size())*sizeof(size_t);
+	}
+
+	/*! \brief this = this + alpha*x
+	 *
+	 * The kernel run with OpenMP on the Eigen storage, elements inserted with insert are kept consistent
+	 *
+	 * \param alpha coefficient
+	 * \param x vector to add
+	 *
+	 */
+	void axpy(T alpha, const Vector<T> & x)
+	{
+		const Eigen::Matrix<T, Eigen::Dynamic, 1> & xv = x.getVec();
+		Eigen::Matrix<T, Eigen::Dynamic, 1> & yv = getVec();
+
+		if (xv.size() != yv.size())
+		{
+			std::cerr << __FILE__ << ":" << __LINE__ << " error, the vectors have different sizes " << xv.size() << " != " << yv.size() << std::endl;
+			return;
+		}
+
+		const T * xp = xv.data();
+		T * yp = yv.data();
+		long int n = yv.size();
+
+		#pragma omp parallel for schedule(static)
+		for (long int i = 0 ; i < n ; i++)
+		{yp[i] += alpha * xp[i];}
+
+		this->operator=(yv);
+	}
+
+	/*! \brief this = alpha*this
+	 *
+	 * \param alpha coefficient
+	 *
+	 */
+	void scale(T alpha)
+	{
+		Eigen::Matrix<T, Eigen::Dynamic, 1> & yv = getVec();
+
+		T * yp = yv.data();
+		long int n = yv.size();
+
+		#pragma omp parallel for schedule(static)
+		for (long int i = 0 ; i < n ; i++)
+		{yp[i] *= alpha;}
+
+		this->operator=(yv);
+	}
+
+	/*! \brief Device storage
+	 *
+	 * The Eigen backend is host only, the call is accepted for compatibility with the PETSc backend and ignored
+	 *
+	 * \param dev true to store the vector on the device
+	 *
+	 */
+	void setDevice(bool dev)
+	{
+	}
+
+	/*! \brief Local rows
+	 *
+	 * The Eigen backend gathers the row values in scatter, the call is accepted for compatibility with the
+	 * PETSc backend and ignored
+	 *
+	 * \param lr true if the rows are local
+	 *
+	 */
+	void setLocalRows(bool lr)
+	{
+	}
+
 	/*! \brief Scatter the vector information to the other processors
 	 *
 	 * Eigen does not have a real parallel vector, so in order to work we have to scatter
@@ -409,7 +495,10 @@ public:
 	 */
 	Vector<T> & operator=(Eigen::Matrix<T, Eigen::Dynamic, 1> & v)
 	{
-		for (size_t i = 0 ; i < row_val.size() ; i++)
+		long int n = row_val.size();
+
+		#pragma omp parallel for schedule(static)
+		for (long int i = 0 ; i < n ; i++)
 			row_val.get(i).value() = v(row_val.get(i).row());
 
 		return *this;
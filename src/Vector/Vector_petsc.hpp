@@ -117,6 +117,12 @@ class Vector<T,PETSC_BASE>
 	//! Mutable vector
 	mutable Vec v;
 
+	//! the vector is stored on the GPU (VECCUDA or VECHIP)
+	bool on_device = false;
+
+	//! all the row values are owned by this processor, they are written in the local array
+	bool local_rows = false;
+
 	//! Mutable row value vector
 	mutable openfpm::vector<rval<PetscScalar,PETSC_RVAL>,HeapMemory, memory_traits_inte > row_val;
 
@@ -126,6 +132,23 @@ class Vector<T,PETSC_BASE>
 	//! invalid
 	T invalid;
 
+	/*! \brief PETSc type of the vector
+	 *
+	 * \return VECMPI, or the device type if the vector is on the device
+	 *
+	 */
+	VecType vec_type() const
+	{
+#if defined(PETSC_HAVE_CUDA)
+		if (on_device == true)
+		{return VECCUDA;}
+#elif defined(PETSC_HAVE_HIP)
+		if (on_device == true)
+		{return VECHIP;}
+#endif
+		return VECMPI;
+	}
+
 	/*! \brief Set the Eigen internal vector
 	 *
 	 *
@@ -133,7 +156,32 @@ class Vector<T,PETSC_BASE>
 	void setPetsc() const
 	{
 		if (v_created == false)
-		{PETSC_SAFE_CALL(VecSetType(v,VECMPI));}
+		{PETSC_SAFE_CALL(VecSetType(v,vec_type()));}
+
+		v_created = true;
+
+		if (local_rows == true)
+		{
+			// no stash and no communication, the values are written in the local array
+			if (row_val.size() == 0) {return;}
+
+			PetscInt low;
+			PetscInt high;
+			PetscScalar * a;
+			PETSC_SAFE_CALL(VecGetOwnershipRange(v,&low,&high));
+			PETSC_SAFE_CALL(VecGetArray(v,&a));
+
+			const PetscInt * rows = &row_val.template get<row_id>(0);
+			const PetscScalar * vals = &row_val.template get<val_id>(0);
+			long int n = row_val.size();
+
+			#pragma omp parallel for
+			for (long int i = 0 ; i < n ; i++)
+			{a[rows[i] - low] = vals[i];}
+
+			PETSC_SAFE_CALL(VecRestoreArray(v,&a));
+			return;
+		}
 
 		// set the vector
 
@@ -142,8 +190,32 @@ class Vector<T,PETSC_BASE>
 
 		PETSC_SAFE_CALL(VecAssemblyBegin(v));
 		PETSC_SAFE_CALL(VecAssemblyEnd(v));
+	}
 
-		v_created = true;
+	/*! \brief Write n values in the local part of the vector, from the local position start
+	 *
+	 * \param start first local position
+	 * \param val values
+	 * \param n number of values
+	 *
+	 */
+	void setLocalImpl(size_t start, const T * val, size_t n)
+	{
+		// the row values set before are inserted first, the bulk values overwrite them
+		setPetsc();
+		row_val.clear();
+		map.clear();
+
+		if (n == 0) {return;}
+
+		PetscScalar * a;
+		PETSC_SAFE_CALL(VecGetArray(v,&a));
+
+		#pragma omp parallel for
+		for (long int i = 0 ; i < (long int)n ; i++)
+		{a[start + i] = val[i];}
+
+		PETSC_SAFE_CALL(VecRestoreArray(v,&a));
 	}
 
 public:
@@ -189,6 +261,8 @@ public:
 	Vector(size_t n, size_t n_row_local)
 	:n_row_local(n_row_local),v(NULL),invalid(0)
 	{
+		numerics_backends::ensure_petsc();
+
 		// Create the vector
 		PETSC_SAFE_CALL(VecCreate(PETSC_COMM_WORLD,&v));
 
@@ -201,6 +275,8 @@ public:
 	Vector()
 	:n_row(0),n_row_local(0),invalid(0)
 	{
+		numerics_backends::ensure_petsc();
+
 		// Create the vector
 		PETSC_SAFE_CALL(VecCreate(PETSC_COMM_WORLD,&v));
 	}
@@ -338,6 +414,34 @@ public:
 		return v;
 	}
 
+	/*! \brief Memory used by the vector in byte on this processor (the hash map of the rows is not counted)
+	 *
+	 * \return the memory in byte
+	 *
+	 */
+	size_t getMemoryUsage() const
+	{
+		size_t mem = row_val.size()*sizeof(rval<PetscScalar,PETSC_RVAL>);
+
+		if (v_created == true)
+		{mem += n_row_local*sizeof(PetscScalar);}
+
+		return mem;
+	}
+
+	/*! \brief Get the PETSC Vector object without inserting the values set with insert or operator()
+	 *
+	 * For vectors filled by PETSc (a solution), the local part can be read with VecGetArrayRead without
+	 * Vector::update
+	 *
+	 * \return the PETSC Vector
+	 *
+	 */
+	const Vec & getVecNoSet() const
+	{
+		return v;
+	}
+
 	/*! \brief Update the Vector with the PETSC object
 	 *
 	 */
@@ -401,6 +505,86 @@ public:
 		return *this;
 	}
 
+	/*! \brief Store the vector on the GPU
+	 *
+	 * The vector become VECCUDA (PETSc configured with CUDA) or VECHIP (PETSc configured with HIP), to use with
+	 * a device matrix (SparseMatrix::setDevice). Must be called before the vector is used
+	 *
+	 * \param dev true to store the vector on the device
+	 *
+	 */
+	void setDevice(bool dev)
+	{
+#if !defined(PETSC_HAVE_CUDA) && !defined(PETSC_HAVE_HIP)
+		if (dev == true)
+		{
+			std::cerr << __FILE__ << ":" << __LINE__ << " warning, PETSc has been configured without CUDA or HIP, the vector stay on the host" << std::endl;
+			return;
+		}
+#endif
+
+		on_device = dev;
+
+		if (v_created == true)
+		{PETSC_SAFE_CALL(VecSetType(v,vec_type()));}
+	}
+
+	/*! \brief All the rows set with insert or operator() are owned by this processor
+	 *
+	 * The row values are then written directly in the local array of the PETSc vector (VecGetArray) instead of
+	 * VecSetValues and the assembly, there is no stash and no communication. With the same rows set again at
+	 * every time step (operator() on existing rows only change the values) the update is a parallel copy
+	 *
+	 * \param lr true if the rows are local
+	 *
+	 */
+	void setLocalRows(bool lr)
+	{
+		local_rows = lr;
+	}
+
+	/*! \brief Set the whole local part of the vector
+	 *
+	 * The values are written in the local array of the PETSc vector, the rows set before with insert or
+	 * operator() are inserted first and then dropped. The values are only in the PETSc vector, they are not
+	 * copied by operator= and not read by operator() before Vector::update
+	 *
+	 * \param val local values, one for each local row
+	 *
+	 */
+	void setLocal(const T * val)
+	{
+		setLocalImpl(0,val,n_row_local);
+	}
+
+	/*! \brief Set a contiguous range of the local rows
+	 *
+	 * \see setLocal
+	 *
+	 * \param start first global row, it must be owned by this processor with the next n-1
+	 * \param val values
+	 * \param n number of values
+	 *
+	 */
+	void setLocal(size_t start, const T * val, size_t n)
+	{
+		if (v_created == false)
+		{PETSC_SAFE_CALL(VecSetType(v,vec_type()));}
+		v_created = true;
+
+		PetscInt low;
+		PetscInt high;
+		PETSC_SAFE_CALL(VecGetOwnershipRange(v,&low,&high));
+
+		if ((PetscInt)start < low || (PetscInt)(start + n) > high)
+		{
+			std::cerr << __FILE__ << ":" << __LINE__ << " Error the rows " << start << " - " << start + n << " are not in the local range " << low << " - " << high << std::endl;
+			return;
+		}
+
+		setLocalImpl(start - low,val,n);
+	}
+
 	/*! \brief Set to zero all the entries
 	 *
 	 *
@@ -408,7 +592,7 @@ public:
 	void setZero()
 	{
 		if (v_created == false)
-		{PETSC_SAFE_CALL(VecSetType(v,VECMPI));}
+		{PETSC_SAFE_CALL(VecSetType(v,vec_type()));}
 
 		v_created = true;
 	}
@@ -268,6 +268,52 @@ BOOST_AUTO_TEST_CASE(vector_petsc_parallel)
 
 }
 
+BOOST_AUTO_TEST_CASE(vector_petsc_local_bulk)
+{
+	Vcluster<> & vcl = create_vcluster();
+
+	size_t nl = 4;
+	size_t start = 4*vcl.getProcessUnitID();
+
+	// local rows written in the local array
+	Vector<double,PETSC_BASE> v(4*vcl.getProcessingUnits(),nl);
+	v.setLocalRows(true);
+
+	for (size_t i = 0 ; i < nl ; i++)
+	{v.insert(start + i,start + i);}
+
+	auto & vp = v.getVec();
+
+	const PetscScalar * a;
+	VecGetArrayRead(vp,&a);
+	for (size_t i = 0 ; i < nl ; i++)
+	{BOOST_REQUIRE_EQUAL(a[i],start + i);}
+	VecRestoreArrayRead(vp,&a);
+
+	// only the values change
+	for (size_t i = 0 ; i < nl ; i++)
+	{v(start + i) = 2.0*(start + i);}
+
+	VecGetArrayRead(v.getVec(),&a);
+	for (size_t i = 0 ; i < nl ; i++)
+	{BOOST_REQUIRE_EQUAL(a[i],2.0*(start + i));}
+	VecRestoreArrayRead(v.getVec(),&a);
+
+	// bulk set of the whole local part and of a range
+	double val[4] = {1.0,2.0,3.0,4.0};
+	Vector<double,PETSC_BASE> w(4*vcl.getProcessingUnits(),nl);
+	w.setLocal(val);
+
+	double val2[2] = {-1.0,-2.0};
+	w.setLocal(start + 1,val2,2);
+
+	w.update();
+	BOOST_REQUIRE_EQUAL(w(start),1.0);
+	BOOST_REQUIRE_EQUAL(w(start+1),-1.0);
+	BOOST_REQUIRE_EQUAL(w(start+2),-2.0);
+	BOOST_REQUIRE_EQUAL(w(start+3),4.0);
+}
+
 #endif
 
 BOOST_AUTO_TEST_SUITE_END()
@@ -12,6 +12,40 @@
 #include "Space/Shape/HyperCube.hpp"
 #include "util/mul_array_extents.hpp"
 
+/*! \brief Read-only view of the local rows of a distributed vector, addressed with the global row id
+ *
+ * The rows of a processor are contiguous, the global row i is at xa[i - start]. It is used as source of
+ * copy_ele in place of the Vector, that search every element in its global to local map
+ *
+ * \tparam T type of the elements
+ *
+ */
+template<typename T>
+struct local_vector_view
+{
+	//! local rows
+	const T * xa;
+
+	//! global id of the first local row
+	size_t start;
+
+	/*! \brief Constructor
+	 *
+	 * \param xa local rows
+	 * \param start global id of the first local row
+	 *
+	 */
+	local_vector_view(const T * xa, size_t start)
+	:xa(xa),start(start)
+	{}
+
+	//! Element with global row id i (it must be local)
+	inline const T & operator()(size_t i) const
+	{
+		return xa[i - start];
+	}
+};
+
 /*!	\brief Copy scalar elements
  *
  * \tparam copy_type Type that should be copied
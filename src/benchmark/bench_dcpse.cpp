@@ -0,0 +1,98 @@
+/*
+ * bench_dcpse.cpp
+ *
+ * Micro-benchmarks of the construction and of the application of the DCPSE operators
+ */
+
+#include "config.h"
+#ifdef HAVE_EIGEN
+
+#include "bench_util.hpp"
+#include "DCPSE/DCPSE_op/DCPSE_op.hpp"
+#include "Operators/Vector/vector_dist_operators.hpp"
+
+/*! \brief Fill a particle set with a regular lattice of n points per side in the unit box
+ *
+ * \param vd particles
+ * \param n points per side
+ *
+ */
+template<unsigned int dim, typename vector_type>
+static void bench_dcpse_lattice(vector_type & vd, size_t n)
+{
+	size_t sz[dim];
+	for (size_t i = 0 ; i < dim ; i++)
+	{sz[i] = n;}
+
+	double h = 1.0 / (n - 1);
+
+	auto it = vd.getGridIterator(sz);
+	while (it.isNext())
+	{
+		auto key = it.get();
+
+		vd.add();
+		for (size_t i = 0 ; i < dim ; i++)
+		{vd.getLastPos()[i] = key.get(i) * h;}
+
+		vd.template getLastProp<0>() = sin(2.0*M_PI*vd.getLastPos()[0]);
+
+		++it;
+	}
+
+	vd.map();
+	vd.template ghost_get<0>();
+}
+
+//! Construct and apply Dx and the Laplacian on a lattice of n^dim particles
+template<unsigned int dim>
+static void bench_dcpse_dim(bench_context & ctx, size_t n)
+{
+	std::string d = "_" + std::to_string(dim) + "d";
+
+	if (ctx.selected({"construct_dx" + d,"construct_lap" + d,"apply_dx" + d,"apply_lap" + d}) == false)
+	{return;}
+
+	double h = 1.0 / (n - 1);
+	double rCut = 3.1 * h;
+
+	Box<dim,double> box;
+	size_t bc[dim];
+	for (size_t i = 0 ; i < dim ; i++)
+	{
+		box.setLow(i,0.0);
+		box.setHigh(i,1.0);
+		bc[i] = NON_PERIODIC;
+	}
+	Ghost<dim,double> ghost(rCut);
+
+	vector_dist<dim,double,aggregate<double,double>> vd(0,box,bc,ghost);
+	bench_dcpse_lattice<dim>(vd,n);
+
+	size_t N = vd.size_local();
+	create_vcluster().sum(N);
+	create_vcluster().execute();
+
+	auto P = getV<0>(vd);
+	auto v = getV<1>(vd);
+
+	ctx.measure("construct_dx" + d,dim,N,[&]{Derivative_x Dx(vd,2,rCut);});
+	ctx.measure("construct_lap" + d,dim,N,[&]{Laplacian Lap(vd,2,rCut);});
+
+	Derivative_x Dx(vd,2,rCut);
+	Laplacian Lap(vd,2,rCut);
+
+	ctx.measure("apply_dx" + d,dim,N,[&]{v = Dx(P);});
+	ctx.measure("apply_lap" + d,dim,N,[&]{v = Lap(P);});
+}
+
+static bench_register reg_dcpse("dcpse",[](bench_context & ctx)
+{
+	for (auto n : ctx.sizes({64,128,256}))
+	{bench_dcpse_dim<2>(ctx,n);}
+
+	for (auto n : ctx.sizes({16,32,48}))
+	{bench_dcpse_dim<3>(ctx,n);}
+});
+
+#endif
@@ -0,0 +1,90 @@
+/*
+ * bench_dcpse_gpu.cu
+ *
+ * Micro-benchmarks of the application of the DCPSE operators on GPU
+ */
+
+#include "config.h"
+#if defined(HAVE_EIGEN) && defined(__NVCC__)
+
+#include "bench_util.hpp"
+#include "DCPSE/DCPSE_op/DCPSE_op.hpp"
+
+/*! \brief Apply the three operators of the 3D Laplacian on a lattice of n^3 particles
+ *
+ * One thread per particle, one warp per particle and one thread per particle on the interleaved kernels
+ *
+ */
+static void bench_dcpse_gpu_lap_3d(bench_context & ctx, size_t n)
+{
+	if (ctx.selected({"lap_apply_thread_3d","lap_apply_warp_3d","lap_apply_interleaved_3d"}) == false)
+	{return;}
+
+	double h = 1.0 / (n - 1);
+	double rCut = 3.1 * h;
+
+	Box<3,double> box({0.0,0.0,0.0},{1.0,1.0,1.0});
+	size_t bc[3] = {NON_PERIODIC,NON_PERIODIC,NON_PERIODIC};
+	Ghost<3,double> ghost(rCut);
+
+	typedef vector_dist_gpu<3,double,aggregate<double,double>> vector_type;
+	vector_type vd(0,box,bc,ghost);
+
+	size_t sz[3] = {n,n,n};
+	auto it = vd.getGridIterator(sz);
+	while (it.isNext())
+	{
+		auto key = it.get();
+
+		vd.add();
+		for (size_t i = 0 ; i < 3 ; i++)
+		{vd.getLastPos()[i] = key.get(i) * h;}
+
+		vd.template getLastProp<0>() = sin(vd.getLastPos()[0]) + sin(vd.getLastPos()[1]) + sin(vd.getLastPos()[2]);
+
+		++it;
+	}
+
+	vd.map();
+	vd.template ghost_get<0>();
+	vd.template hostToDeviceProp<0>();
+
+	size_t N = vd.size_local();
+	create_vcluster().sum(N);
+	create_vcluster().execute();
+
+	Dcpse_gpu<3,vector_type> Dxx(vd,Point<3,unsigned int>({2,0,0}),2,rCut,1.9,support_options::RADIUS);
+	Dcpse_gpu<3,vector_type> Dyy(vd,Dxx,Point<3,unsigned int>({0,2,0}),2,rCut,1.9,support_options::RADIUS);
+	Dcpse_gpu<3,vector_type> Dzz(vd,Dxx,Point<3,unsigned int>({0,0,2}),2,rCut,1.9,support_options::RADIUS);
+	Dcpse_gpu<3,vector_type> * ops[3] = {&Dxx,&Dyy,&Dzz};
+
+	ctx.measure("lap_apply_thread_3d",3,N,[&]
+	{
+		for (size_t d = 0 ; d < 3 ; d++)
+		{ops[d]->template computeDifferentialOperatorGPU<0,1>(vd);}
+		cudaDeviceSynchronize();
+	});
+
+	ctx.measure("lap_apply_warp_3d",3,N,[&]
+	{
+		for (size_t d = 0 ; d < 3 ; d++)
+		{ops[d]->template computeDifferentialOperatorWarpGPU<0,1>(vd);}
+		cudaDeviceSynchronize();
+	});
+
+	// the warm-up of measure build the interleaved layout
+	ctx.measure("lap_apply_interleaved_3d",3,N,[&]
+	{
+		for (size_t d = 0 ; d < 3 ; d++)
+		{ops[d]->template computeDifferentialOperatorInterleavedGPU<0,1>(vd);}
+		cudaDeviceSynchronize();
+	});
+}
+
+static bench_register reg_dcpse_gpu("dcpse_gpu",[](bench_context & ctx)
+{
+	for (auto n : ctx.sizes({33,65,97}))
+	{bench_dcpse_gpu_lap_3d(ctx,n);}
+});
+
+#endif
@@ -0,0 +1,106 @@
+/*
+ * bench_fd.cpp
+ *
+ * Micro-benchmarks of the assembly of the finite difference systems
+ */
+
+#include "config.h"
+#if defined(HAVE_EIGEN) && defined(HAVE_PETSC)
+
+#include "bench_util.hpp"
+#include "FiniteDifference/FD_Solver.hpp"
+#include "FiniteDifference/FD_expressions.hpp"
+#include "FiniteDifference/FD_op.hpp"
+#include "FiniteDifference/util/EqnsStructFD.hpp"
+
+//! Equations of the assembly in dim dimensions
+template<unsigned int dim> struct bench_fd_eq;
+template<> struct bench_fd_eq<2> {typedef equations2d1 type;};
+template<> struct bench_fd_eq<3> {typedef equations3d1 type;};
+
+/*! \brief Assemble the Poisson system with Dirichlet boundary on a grid of n^dim points
+ *
+ * The interior rows are assembled with the hash and with the stencil assembly, the boundary rows are common
+ *
+ */
+template<unsigned int dim>
+static void bench_fd_dim(bench_context & ctx, size_t n)
+{
+	std::string d = "_" + std::to_string(dim) + "d";
+
+	if (ctx.selected({"assemble_lap" + d,"assemble_lap_stencil" + d}) == false)
+	{return;}
+
+	size_t sz[dim];
+	Box<dim,double> box;
+	periodicity<dim> bc;
+	for (size_t i = 0 ; i < dim ; i++)
+	{
+		sz[i] = n;
+		box.setLow(i,0.0);
+		box.setHigh(i,1.0);
+		bc.bc[i] = NON_PERIODIC;
+	}
+	Ghost<dim,long int> ghost(1);
+
+	grid_dist_id<dim,double,aggregate<double,double>> domain(sz,box,ghost,bc);
+
+	auto v = FD::getV<0>(domain);
+	FD::Lap Lap;
+
+	size_t N = 1;
+	for (size_t i = 0 ; i < dim ; i++)
+	{N *= n;}
+
+	// interior and faces of the box
+	grid_key_dx<dim> bulk_lo, bulk_hi;
+	for (size_t i = 0 ; i < dim ; i++)
+	{
+		bulk_lo.set_d(i,1);
+		bulk_hi.set_d(i,n - 2);
+	}
+
+	auto assemble = [&](bool stencil)
+	{
+		typedef typename bench_fd_eq<dim>::type eq;
+
+		FD_scheme<eq,decltype(domain)> Solver(ghost,domain);
+		Solver.setStencilAssembly(stencil);
+
+		Solver.impose(Lap(v),bulk_lo,bulk_hi,prop_id<1>());
+
+		for (size_t i = 0 ; i < dim ; i++)
+		{
+			// the edges already imposed by a previous face are skipped
+			grid_key_dx<dim> lo, hi;
+			for (size_t j = 0 ; j < dim ; j++)
+			{
+				lo.set_d(j,(j < i)?1:0);
+				hi.set_d(j,(j < i)?n-2:n-1);
+			}
+
+			hi.set_d(i,0);
+			Solver.impose(v,lo,hi,prop_id<0>());
+
+			lo.set_d(i,n-1);
+			hi.set_d(i,n-1);
+			Solver.impose(v,lo,hi,prop_id<0>());
+		}
+
+		return Solver.getA().getMatrixTriplets().size();
+	};
+
+	ctx.measure("assemble_lap" + d,dim,N,[&]{assemble(false);});
+	ctx.measure("assemble_lap_stencil" + d,dim,N,[&]{assemble(true);});
+}
+
+static bench_register reg_fd("fd",[](bench_context & ctx)
+{
+	for (auto n : ctx.sizes({64,128,256}))
+	{bench_fd_dim<2>(ctx,n);}
+
+	for (auto n : ctx.sizes({16,32,48}))
+	{bench_fd_dim<3>(ctx,n);}
+});
+
+#endif
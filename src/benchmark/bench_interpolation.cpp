@@ -0,0 +1,99 @@
+/*
+ * bench_interpolation.cpp
+ *
+ * Micro-benchmarks of the particle to mesh and mesh to particle interpolation
+ */
+
+#include "config.h"
+
+#include "bench_util.hpp"
+#include "interpolation/interpolation.hpp"
+#include "interpolation/mp4_kernel.hpp"
+#include "Vector/vector_dist.hpp"
+#include "Grid/grid_dist_id.hpp"
+
+/*! \brief p2m and m2p with the mp4 kernel, 4 particles per cell of a grid of n^dim points
+ *
+ */
+template<unsigned int dim>
+static void bench_interpolation_dim(bench_context & ctx, size_t n)
+{
+	std::string d = "_" + std::to_string(dim) + "d";
+
+	if (ctx.selected({"p2m_mp4" + d,"m2p_mp4" + d}) == false)
+	{return;}
+
+	Box<dim,double> domain;
+	size_t sz[dim];
+	size_t bc[dim];
+	for (size_t i = 0 ; i < dim ; i++)
+	{
+		domain.setLow(i,0.0);
+		domain.setHigh(i,1.0);
+		sz[i] = n;
+		bc[i] = PERIODIC;
+	}
+
+	Ghost<dim,long int> gg(3);
+	Ghost<dim,double> gv(0.01);
+
+	size_t N = 4;
+	for (size_t i = 0 ; i < dim ; i++)
+	{N *= n;}
+
+	auto & v_cl = create_vcluster();
+
+	vector_dist<dim,double,aggregate<double>> vd(N / v_cl.size(),domain,bc,gv);
+	grid_dist_id<dim,double,aggregate<double>> gd(vd.getDecomposition(),sz,gg);
+
+	// always the same particles, the runs can be compared
+	srand(v_cl.rank() + 1);
+
+	auto it = vd.getDomainIterator();
+	while (it.isNext())
+	{
+		auto p = it.get();
+
+		for (size_t i = 0 ; i < dim ; i++)
+		{vd.getPos(p)[i] = (double)rand()/RAND_MAX;}
+
+		vd.template getProp<0>(p) = 1.0;
+
+		++it;
+	}
+
+	vd.map();
+
+	interpolate<decltype(vd),decltype(gd),mp4_kernel<double>> inte(vd,gd);
+
+	ctx.measure("p2m_mp4" + d,dim,N,[&]{
+		auto it = gd.getDomainGhostIterator();
+		while (it.isNext())
+		{
+			gd.template get<0>(it.get()) = 0.0;
+			++it;
+		}
+
+		inte.template p2m<0,0>(vd,gd);
+	});
+
+	ctx.measure("m2p_mp4" + d,dim,N,[&]{
+		auto it = vd.getDomainIterator();
+		while (it.isNext())
+		{
+			vd.template getProp<0>(it.get()) = 0.0;
+			++it;
+		}
+
+		inte.template m2p<0,0>(gd,vd);
+	});
+}
+
+static bench_register reg_interpolation("interpolation",[](bench_context & ctx)
+{
+	for (auto n : ctx.sizes({64,128,256}))
+	{bench_interpolation_dim<2>(ctx,n);}
+
+	for (auto n : ctx.sizes({16,32,64}))
+	{bench_interpolation_dim<3>(ctx,n);}
+});
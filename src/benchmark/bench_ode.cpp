@@ -0,0 +1,92 @@
+/*
+ * bench_ode.cpp
+ *
+ * Micro-benchmarks of the algebra of the time steppers on the particle states
+ */
+
+#include "config.h"
+
+#include "bench_util.hpp"
+#include "Vector/vector_dist.hpp"
+#include "OdeIntegrators/OdeIntegrators.hpp"
+
+//! Right-hand side that only touch the memory, the cost of a step is the cost of the algebra
+static void bench_ode_rhs(const state_type_3d_ofp &x, state_type_3d_ofp &dxdt, const double t)
+{
+	dxdt.data.get<0>() = x.data.get<0>();
+	dxdt.data.get<1>() = -1.0*x.data.get<1>();
+	dxdt.data.get<2>() = x.data.get<2>();
+}
+
+/*! \brief One step of rk4 (standard and fused algebra) and of the 2N-storage scheme on n particles with three states
+ *
+ */
+template<unsigned int dim>
+static void bench_ode_dim(bench_context & ctx, size_t n)
+{
+	std::string d = "_" + std::to_string(dim) + "d";
+
+	if (ctx.selected({"rk4_step" + d,"rk4_step_fused" + d,"lsrk_2n_step_fused" + d}) == false)
+	{return;}
+
+	Box<dim,double> box;
+	size_t bc[dim];
+	for (size_t i = 0 ; i < dim ; i++)
+	{
+		box.setLow(i,0.0);
+		box.setHigh(i,1.0);
+		bc[i] = NON_PERIODIC;
+	}
+	Ghost<dim,double> ghost(0.0);
+
+	auto & v_cl = create_vcluster();
+
+	typedef vector_dist<dim,double,aggregate<double,double,double>> vector_type;
+	vector_type vd(n / v_cl.size(),box,bc,ghost);
+
+	auto it = vd.getDomainIterator();
+	while (it.isNext())
+	{
+		auto p = it.get();
+
+		for (size_t i = 0 ; i < dim ; i++)
+		{vd.getPos(p)[i] = (double)rand()/RAND_MAX;}
+
+		vd.template getProp<0>(p) = 1.0;
+		vd.template getProp<1>(p) = 2.0;
+		vd.template getProp<2>(p) = 3.0;
+
+		++it;
+	}
+
+	vd.map();
+
+	size_t N = vd.size_local();
+	v_cl.sum(N);
+	v_cl.execute();
+
+	state_type_3d_ofp x0;
+	x0.data.get<0>() = getV<0>(vd);
+	x0.data.get<1>() = getV<1>(vd);
+	x0.data.get<2>() = getV<2>(vd);
+
+	// small dt, the state stays bounded for any number of repetitions
+	const double dt = 1e-6;
+
+	boost::numeric::odeint::runge_kutta4<state_type_3d_ofp,double,state_type_3d_ofp,double,boost::numeric::odeint::vector_space_algebra_ofp> rk4;
+	boost::numeric::odeint::runge_kutta4<state_type_3d_ofp,double,state_type_3d_ofp,double,boost::numeric::odeint::vector_space_algebra_ofp_fused> rk4_fused;
+	lsrk_2n_ofp<state_type_3d_ofp,boost::numeric::odeint::vector_space_algebra_ofp_fused> lsrk;
+
+	ctx.measure("rk4_step" + d,dim,N,[&]{rk4.do_step(bench_ode_rhs,x0,0.0,dt);});
+	ctx.measure("rk4_step_fused" + d,dim,N,[&]{rk4_fused.do_step(bench_ode_rhs,x0,0.0,dt);});
+	ctx.measure("lsrk_2n_step_fused" + d,dim,N,[&]{lsrk.do_step(bench_ode_rhs,x0,0.0,dt);});
+}
+
+static bench_register reg_ode("ode",[](bench_context & ctx)
+{
+	for (auto n : ctx.sizes({1 << 16,1 << 20,1 << 22}))
+	{
+		bench_ode_dim<2>(ctx,n);
+		bench_ode_dim<3>(ctx,n);
+	}
+});
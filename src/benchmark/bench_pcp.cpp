@@ -0,0 +1,122 @@
+/*
+ * bench_pcp.cpp
+ *
+ * Micro-benchmarks of the particle closest point redistancing
+ */
+
+#include "config.h"
+
+#include "bench_util.hpp"
+#include "Vector/vector_dist.hpp"
+#include "Draw/DrawParticles.hpp"
+#include "level_set/particle_cp/particle_cp.hpp"
+
+//! Number of coefficients of a polynomial of degree p in dim dimensions (lp degree one)
+constexpr unsigned int bench_pcp_num_coeffs(unsigned int dim, unsigned int p)
+{
+	return (dim == 0 || p == 0)?1:bench_pcp_num_coeffs(dim - 1,p) + bench_pcp_num_coeffs(dim,p - 1);
+}
+
+/*! \brief Redistancing of a level-set of a sphere (not a distance) on n^dim particles of a lattice
+ *
+ * The redistancing is measured with the per particle and with the batched Newton iterations
+ *
+ */
+template<unsigned int dim>
+static void bench_pcp_dim(bench_context & ctx, size_t n)
+{
+	std::string d = "_" + std::to_string(dim) + "d";
+
+	if (ctx.selected({"redistancing" + d,"redistancing_batched" + d}) == false)
+	{return;}
+
+	constexpr int poly_order = 4;
+	constexpr int sdf = 0;
+	constexpr int cp = 1;
+	constexpr int normal = 2;
+	constexpr int curvature = 3;
+
+	const double H = 2.0 / n;
+	const double bandwidth = 12.0*H;
+	const double radius = 0.5;
+
+	Box<dim,double> domain;
+	size_t sz[dim];
+	size_t bc[dim];
+	for (size_t i = 0 ; i < dim ; i++)
+	{
+		domain.setLow(i,-1.0);
+		domain.setHigh(i,1.0);
+		sz[i] = n;
+		bc[i] = NON_PERIODIC;
+	}
+	Ghost<dim,double> g(bandwidth);
+
+	typedef vector_dist<dim,double,aggregate<double,Point<dim,double>,Point<dim,double>,double>> particles;
+	particles vd(0,domain,bc,g,DEC_GRAN(512));
+
+	auto it = DrawParticles::DrawBox(vd,sz,domain,domain);
+	while (it.isNext())
+	{
+		vd.add();
+		for (size_t i = 0 ; i < dim ; i++)
+		{vd.getLastPos()[i] = it.get().get(i);}
+
+		++it;
+	}
+
+	vd.map();
+
+	// level-set with the right zero but not a distance
+	auto reset = [&]
+	{
+		auto it = vd.getDomainIterator();
+		while (it.isNext())
+		{
+			auto p = it.get();
+
+			double r2 = 0.0;
+			for (size_t i = 0 ; i < dim ; i++)
+			{r2 += vd.getPos(p)[i]*vd.getPos(p)[i];}
+
+			vd.template getProp<sdf>(p) = (r2 - radius*radius) / (2.0*radius);
+
+			++it;
+		}
+	};
+
+	size_t N = vd.size_local();
+	create_vcluster().sum(N);
+	create_vcluster().execute();
+
+	auto run = [&](int batched)
+	{
+		Redist_options rdistoptions;
+		rdistoptions.minter_poly_degree = poly_order;
+		rdistoptions.H = H;
+		rdistoptions.r_cutoff_factor = 2.4;
+		rdistoptions.sampling_radius = 0.75*bandwidth;
+		rdistoptions.tolerance = 1e-13;
+		rdistoptions.write_cp = 1;
+		rdistoptions.compute_normals = 1;
+		rdistoptions.compute_curvatures = 1;
+		rdistoptions.batched_newton = batched;
+
+		reset();
+
+		particle_cp_redistancing<particles,sdf,cp,normal,curvature,bench_pcp_num_coeffs(dim,poly_order)> pcprdist(vd,rdistoptions);
+		pcprdist.run_redistancing();
+	};
+
+	ctx.measure("redistancing" + d,dim,N,[&]{run(0);});
+	ctx.measure("redistancing_batched" + d,dim,N,[&]{run(1);});
+}
+
+static bench_register reg_pcp("pcp",[](bench_context & ctx)
+{
+	for (auto n : ctx.sizes({128,256}))
+	{bench_pcp_dim<2>(ctx,n);}
+
+	for (auto n : ctx.sizes({32,64}))
+	{bench_pcp_dim<3>(ctx,n);}
+});
@@ -0,0 +1,66 @@
+/*
+ * bench_sparse.cpp
+ *
+ * Micro-benchmarks of the sparse matrix vector product of the Eigen back-end
+ */
+
+#include "config.h"
+#if defined(HAVE_EIGEN)
+
+#include "bench_util.hpp"
+#include "Matrix/SparseMatrix.hpp"
+#include "Vector/Vector.hpp"
+
+/*! \brief Product of the 5 point Laplacian on a n x n grid with a vector, serial Eigen product and SparseMatrix::spmv
+ *
+ * Every processor multiply its own copy of the matrix
+ *
+ */
+static void bench_spmv_2d(bench_context & ctx, size_t n)
+{
+	if (ctx.selected({"spmv_eigen_2d","spmv_2d"}) == false)
+	{return;}
+
+	const int N = n*n;
+
+	SparseMatrix<double,int> sm(N,N);
+
+	typedef SparseMatrix<double,int>::triplet_type triplet;
+
+	auto & triplets = sm.getMatrixTriplets();
+	for (int i = 0 ; i < (int)n ; i++)
+	{
+		for (int j = 0 ; j < (int)n ; j++)
+		{
+			int r = i*n + j;
+			triplets.add(triplet(r,r,-4.0));
+			if (i > 0) {triplets.add(triplet(r,r-n,1.0));}
+			if (i < (int)n-1) {triplets.add(triplet(r,r+n,1.0));}
+			if (j > 0) {triplets.add(triplet(r,r-1,1.0));}
+			if (j < (int)n-1) {triplets.add(triplet(r,r+1,1.0));}
+		}
+	}
+
+	Vector<double> x(N);
+	Vector<double> y(N);
+
+	auto & xv = x.getVec();
+	auto & yv = y.getVec();
+
+	for (int i = 0 ; i < N ; i++)
+	{xv(i) = sin(0.001*i); yv(i) = 1.0;}
+
+	// assemble the matrix outside the timed region
+	sm.getMat();
+
+	ctx.measure("spmv_eigen_2d",2,N,[&]{yv = sm.getMat() * xv;});
+	ctx.measure("spmv_2d",2,N,[&]{sm.spmv(xv,yv);});
+}
+
+static bench_register reg_sparse("sparse",[](bench_context & ctx)
+{
+	for (auto n : ctx.sizes({128,300,512}))
+	{bench_spmv_2d(ctx,n);}
+});
+
+#endif
@@ -0,0 +1,89 @@
+/*
+ * bench_sussman.cpp
+ *
+ * Micro-benchmarks of the Sussman redistancing iterations
+ */
+
+#include "config.h"
+
+#include "bench_util.hpp"
+#include "level_set/redistancing_Sussman/RedistancingSussman.hpp"
+#include "Draw/DrawDisk.hpp"
+#include "Draw/DrawSphere.hpp"
+
+//! Indicator function of a disk or of a sphere of radius r centered in the box
+template<unsigned int dim> struct bench_sussman_init;
+
+template<> struct bench_sussman_init<2>
+{
+	template<typename grid_type>
+	static void init(grid_type & g, double r)
+	{init_grid_with_disk<0>(g,r,0.0,0.0);}
+};
+
+template<> struct bench_sussman_init<3>
+{
+	template<typename grid_type>
+	static void init(grid_type & g, double r)
+	{init_grid_with_sphere<0>(g,r,0.0,0.0,0.0);}
+};
+
+/*! \brief A fixed number of Sussman iterations on a grid of n^dim points, on the full grid and on the narrow band
+ *
+ */
+template<unsigned int dim>
+static void bench_sussman_dim(bench_context & ctx, size_t n, size_t n_iter)
+{
+	std::string d = "_" + std::to_string(dim) + "d";
+
+	if (ctx.selected({"iterations" + d,"iterations_narrow_band" + d}) == false)
+	{return;}
+
+	size_t sz[dim];
+	Box<dim,double> box;
+	for (size_t i = 0 ; i < dim ; i++)
+	{
+		sz[i] = n;
+		box.setLow(i,-2.0);
+		box.setHigh(i,2.0);
+	}
+	Ghost<dim,long int> ghost(0);
+
+	typedef grid_dist_id<dim,double,aggregate<double,double>> grid_in_type;
+	grid_in_type g_dist(sz,box,ghost);
+
+	bench_sussman_init<dim>::init(g_dist,1.0);
+
+	size_t N = 1;
+	for (size_t i = 0 ; i < dim ; i++)
+	{N *= n;}
+
+	auto run = [&](bool narrow_band)
+	{
+		Redist_options<double> redist_options;
+		redist_options.min_iter = n_iter;
+		redist_options.max_iter = n_iter;
+		redist_options.convTolChange.check = false;
+		redist_options.convTolResidual.check = false;
+		redist_options.interval_check_convergence = n_iter;
+		redist_options.width_NB_in_grid_points = 4;
+		redist_options.print_current_iterChangeResidual = false;
+		redist_options.print_steadyState_iter = false;
+		redist_options.narrow_band_iterations = narrow_band;
+
+		RedistancingSussman<grid_in_type,double> redist_obj(g_dist,redist_options);
+		redist_obj.template run_redistancing<0,1>();
+	};
+
+	ctx.measure("iterations" + d,dim,N,[&]{run(false);});
+	ctx.measure("iterations_narrow_band" + d,dim,N,[&]{run(true);});
+}
+
+static bench_register reg_sussman("sussman",[](bench_context & ctx)
+{
+	for (auto n : ctx.sizes({128,256,512}))
+	{bench_sussman_dim<2>(ctx,n,100);}
+
+	for (auto n : ctx.sizes({32,64,96}))
+	{bench_sussman_dim<3>(ctx,n,100);}
+});
@@ -0,0 +1,297 @@
+/*
+ * bench_util.hpp
+ *
+ * Timing harness of the numerics micro-benchmarks
+ */
+
+#ifndef OPENFPM_NUMERICS_SRC_BENCHMARK_BENCH_UTIL_HPP_
+#define OPENFPM_NUMERICS_SRC_BENCHMARK_BENCH_UTIL_HPP_
+
+#include <atomic>
+#include <chrono>
+#include <functional>
+#include <vector>
+#include <string>
+#include <algorithm>
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include "VCluster/VCluster.hpp"
+
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
+class bench_context;
+
+//! Heap allocations of the benchmark executable while a bench_alloc_scope is alive (operator new is in main.cpp)
+extern std::atomic<size_t> bench_n_alloc;
+
+//! Number of bench_alloc_scope alive
+extern std::atomic<int> bench_alloc_scopes;
+
+/*! \brief Count the heap allocations of all the threads while it is alive
+ *
+ * measure count the allocations of the timed repetitions of every kernel with it, for example the application of
+ * the DCPSE operators must not allocate
+ *
+ */
+class bench_alloc_scope
+{
+	//! allocations when the scope started
+	size_t start;
+
+public:
+
+	bench_alloc_scope()
+	{
+		bench_alloc_scopes++;
+		start = bench_n_alloc.load();
+	}
+
+	~bench_alloc_scope()
+	{
+		bench_alloc_scopes--;
+	}
+
+	//! Allocations since the scope started
+	size_t count() const
+	{
+		return bench_n_alloc.load() - start;
+	}
+};
+
+/*! \brief A registered benchmark
+ *
+ */
+struct bench_entry
+{
+	//! name of the benchmark (prefix of all its measures)
+	std::string name;
+
+	//! body, it call bench_context::measure for every kernel and size
+	std::function<void(bench_context &)> f;
+};
+
+//! List of the registered benchmarks
+inline std::vector<bench_entry> & getBenchRegistry()
+{
+	static std::vector<bench_entry> reg;
+
+	return reg;
+}
+
+/*! \brief Register a benchmark at static initialization
+ *
+ * \code{.cpp}
+
+   static bench_register reg_dcpse("dcpse",[](bench_context & ctx){...});
+
+ * \endcode
+ *
+ */
+struct bench_register
+{
+	bench_register(const std::string & name, std::function<void(bench_context &)> f)
+	{
+		getBenchRegistry().push_back(bench_entry{name,f});
+	}
+};
+
+/*! \brief Options and output of a run of the benchmarks
+ *
+ * Every measure run the kernel once to warm-up (caches, first touch, lazy allocations) and then reps times, every
+ * repetition is delimited by two barriers and its time is the maximum across the processors. One JSON object per
+ * line is written for every measure, with the minimum, the median and the mean of the repetitions and the heap
+ * allocations per repetition (maximum across the processors)
+ *
+ */
+class bench_context
+{
+	//! only the measures that contain this string are run (empty run all)
+	std::string filter;
+
+	//! name of the running benchmark
+	std::string prefix;
+
+	//! number of timed repetitions
+	size_t reps = 10;
+
+	//! run only the smallest size of every benchmark
+	bool quick = false;
+
+	//! output file (empty write on the standard output)
+	std::string out_file;
+
+	//! output
+	std::ofstream out;
+
+	//! number of measures written
+	size_t n_measures = 0;
+
+	//! Get the output stream
+	std::ostream & stream()
+	{
+		if (out.is_open())
+		{return out;}
+
+		return std::cout;
+	}
+
+public:
+
+	/*! \brief Parse the command line
+	 *
+	 * --filter <str> --reps <n> --quick --out <file>
+	 *
+	 */
+	bench_context(int argc, char* argv[])
+	{
+		for (int i = 1 ; i < argc ; i++)
+		{
+			std::string a(argv[i]);
+
+			if (a == "--filter" && i + 1 < argc)
+			{filter = argv[++i];}
+			else if (a == "--reps" && i + 1 < argc)
+			{reps = std::max(1l,atol(argv[++i]));}
+			else if (a == "--out" && i + 1 < argc)
+			{out_file = argv[++i];}
+			else if (a == "--quick")
+			{quick = true;}
+			else
+			{std::cerr << __FILE__ << ":" << __LINE__ << " warning unknown option " << a << std::endl;}
+		}
+
+		auto & v_cl = create_vcluster();
+
+		if (v_cl.rank() == 0 && out_file.size() != 0)
+		{
+			out.open(out_file);
+
+			if (out.is_open() == false)
+			{std::cerr << __FILE__ << ":" << __LINE__ << " error cannot open " << out_file << ", writing on the standard output" << std::endl;}
+		}
+	}
+
+	//! Select the sizes to run, all the sizes or only the first one with --quick
+	std::vector<size_t> sizes(std::initializer_list<size_t> sz) const
+	{
+		std::vector<size_t> s(sz);
+
+		if (quick && s.size() > 1)
+		{s.resize(1);}
+
+		return s;
+	}
+
+	//! Check if a measure must be run
+	bool selected(const std::string & name) const
+	{
+		return filter.size() == 0 || (prefix + "." + name).find(filter) != std::string::npos;
+	}
+
+	//! Check if at least one of the measures must be run (to skip the set-up of the unselected ones)
+	bool selected(std::initializer_list<std::string> names) const
+	{
+		for (auto & n : names)
+		{
+			if (selected(n)) {return true;}
+		}
+
+		return false;
+	}
+
+	/*! \brief Time a kernel
+	 *
+	 * \param name name of the measure (the name of the benchmark is added as prefix)
+	 * \param dim dimensionality of the problem
+	 * \param n size of the problem (for example the number of particles or grid points)
+	 * \param f kernel to time, it must be re-entrant (every repetition restart from a valid state)
+	 *
+	 */
+	template<typename kernel_type>
+	void measure(const std::string & name, size_t dim, size_t n, kernel_type f)
+	{
+		if (selected(name) == false)
+		{return;}
+
+		auto & v_cl = create_vcluster();
+
+		f();
+
+		std::vector<double> t(reps);
+		size_t allocs = 0;
+
+		for (size_t r = 0 ; r < reps ; r++)
+		{
+			v_cl.barrier();
+
+			auto start = std::chrono::steady_clock::now();
+			auto stop = start;
+			{
+				bench_alloc_scope scope;
+
+				f();
+				stop = std::chrono::steady_clock::now();
+
+				allocs += scope.count();
+			}
+
+			v_cl.barrier();
+
+			double tr = std::chrono::duration<double>(stop - start).count();
+			v_cl.max(tr);
+			v_cl.execute();
+
+			t[r] = tr;
+		}
+
+		v_cl.max(allocs);
+		v_cl.execute();
+
+		std::vector<double> ts(t);
+		std::sort(ts.begin(),ts.end());
+
+		double mean = 0.0;
+		for (size_t r = 0 ; r < reps ; r++)
+		{mean += t[r];}
+		mean /= reps;
+
+		int n_threads = 1;
+#ifdef _OPENMP
+		n_threads = omp_get_max_threads();
+#endif
+
+		if (v_cl.rank() == 0)
+		{
+			std::stringstream ss;
+			ss.precision(9);
+
+			ss << "{\"name\":\"" << prefix << "." << name << "\",\"dim\":" << dim << ",\"n\":" << n
+			   << ",\"procs\":" << v_cl.size() << ",\"threads\":" << n_threads << ",\"reps\":" << reps
+			   << ",\"min_s\":" << ts[0] << ",\"median_s\":" << ts[reps/2] << ",\"mean_s\":" << mean
+			   << ",\"allocs_per_rep\":" << (double)allocs / reps << "}";
+
+			stream() << ss.str() << std::endl;
+		}
+
+		n_measures++;
+	}
+
+	//! Run all the registered benchmarks
+	size_t run()
+	{
+		auto & reg = getBenchRegistry();
+
+		for (size_t i = 0 ; i < reg.size() ; i++)
+		{
+			prefix = reg[i].name;
+			reg[i].f(*this);
+		}
+
+		return n_measures;
+	}
+};
+
+#endif /* OPENFPM_NUMERICS_SRC_BENCHMARK_BENCH_UTIL_HPP_ */
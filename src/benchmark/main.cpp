@@ -0,0 +1,59 @@
+/*
+ * main.cpp
+ *
+ * Entry point of the numerics micro-benchmarks
+ *
+ * mpirun -np 4 ./numerics_bench --filter dcpse.apply --reps 20 --out bench.jsonl
+ *
+ * every measure is written as one JSON object per line (see bench_context)
+ */
+
+#include "config.h"
+#include "bench_util.hpp"
+#include <cstdlib>
+#include <new>
+
+std::atomic<size_t> bench_n_alloc(0);
+std::atomic<int> bench_alloc_scopes(0);
+
+// Replaced for the whole benchmark executable, it counts only while a bench_alloc_scope is alive
+void * operator new(size_t sz)
+{
+	if (bench_alloc_scopes.load(std::memory_order_relaxed) != 0)
+	{bench_n_alloc.fetch_add(1,std::memory_order_relaxed);}
+
+	void * ptr = malloc(sz);
+	if (ptr == NULL)
+	{throw std::bad_alloc();}
+
+	return ptr;
+}
+
+void operator delete(void * ptr) noexcept
+{
+	free(ptr);
+}
+
+void operator delete(void * ptr, size_t) noexcept
+{
+	free(ptr);
+}
+
+int main(int argc, char* argv[])
+{
+	openfpm_init(&argc,&argv);
+
+	size_t n_measures;
+
+	{
+		bench_context ctx(argc,argv);
+		n_measures = ctx.run();
+	}
+
+	if (create_vcluster().rank() == 0 && n_measures == 0)
+	{std::cerr << __FILE__ << ":" << __LINE__ << " warning no benchmark selected" << std::endl;}
+
+	openfpm_finalize();
+
+	return 0;
+}
@@ -0,0 +1,105 @@
+/*
+ * scaling_dcpse_poisson.cpp
+ *
+ * Scaling of a DCPSE Poisson solve with Dirichlet boundary on a lattice of particles
+ */
+
+#include "config.h"
+#if defined(HAVE_EIGEN) && defined(HAVE_PETSC)
+
+#include "scaling_util.hpp"
+#include "DCPSE/DCPSE_op/DCPSE_op.hpp"
+#include "DCPSE/DCPSE_op/DCPSE_Solver.hpp"
+#include "DCPSE/DCPSE_op/EqnsStruct.hpp"
+#include "Operators/Vector/vector_dist_operators.hpp"
+#include "Solvers/petsc_solver.hpp"
+
+/*! \brief Lap(u) = -2 pi^2 sin(pi x) sin(pi y) in the unit square, u = 0 on the boundary
+ *
+ * Stages: construction of the Laplacian, imposition of the equations, solution with GMRES + BoomerAMG
+ *
+ */
+static scaling_register reg_dcpse_poisson("dcpse_poisson",[](scaling_context & ctx)
+{
+	size_t n = ctx.side(2,65536);
+	const size_t sz[2] = {n,n};
+
+	Box<2,double> box({0.0,0.0},{1.0,1.0});
+	size_t bc[2] = {NON_PERIODIC,NON_PERIODIC};
+	double spacing = 1.0 / (n - 1);
+	double rCut = 3.1 * spacing;
+	Ghost<2,double> ghost(rCut);
+
+	vector_dist<2,double,aggregate<double,double>> domain(0,box,bc,ghost);
+
+	auto it = domain.getGridIterator(sz);
+	while (it.isNext())
+	{
+		auto key = it.get();
+
+		domain.add();
+		domain.getLastPos()[0] = key.get(0) * spacing;
+		domain.getLastPos()[1] = key.get(1) * spacing;
+
+		++it;
+	}
+
+	{
+		trace_span s("scaling.comm");
+		domain.map();
+		domain.ghost_get<0>();
+	}
+
+	openfpm::vector<aggregate<int>> bulk;
+	openfpm::vector<aggregate<int>> boundary;
+
+	Box<2,double> inner({spacing / 2.0,spacing / 2.0},{1.0 - spacing / 2.0,1.0 - spacing / 2.0});
+
+	auto it2 = domain.getDomainIterator();
+	while (it2.isNext())
+	{
+		auto p = it2.get();
+		Point<2,double> xp = domain.getPos(p);
+
+		if (inner.isInside(xp) == true)
+		{
+			bulk.add();
+			bulk.last().get<0>() = p.getKey();
+			domain.getProp<1>(p) = -2.0*M_PI*M_PI*sin(M_PI*xp.get(0))*sin(M_PI*xp.get(1));
+		}
+		else
+		{
+			boundary.add();
+			boundary.last().get<0>() = p.getKey();
+			domain.getProp<1>(p) = 0.0;
+		}
+
+		++it2;
+	}
+
+	auto u = getV<0>(domain);
+
+	ctx.stage("operators",2,n*n,[&]{Laplacian Lap(domain,2,rCut,1.9,support_options::RADIUS);});
+
+	Laplacian Lap(domain,2,rCut,1.9,support_options::RADIUS);
+
+	ctx.stage("impose",2,n*n,[&]{
+		DCPSE_scheme<equations2d1,decltype(domain)> Solver(domain);
+		Solver.impose(Lap(u),bulk,prop_id<1>());
+		Solver.impose(u,boundary,prop_id<1>());
+	});
+
+	DCPSE_scheme<equations2d1,decltype(domain)> Solver(domain);
+	Solver.impose(Lap(u),bulk,prop_id<1>());
+	Solver.impose(u,boundary,prop_id<1>());
+
+	petsc_solver<double> solver;
+	solver.setSolver(KSPGMRES);
+	solver.setPreconditioner(PCHYPRE_BOOMERAMG);
+	solver.setRelTol(1e-8);
+
+	// the warm-up solve assembles the matrix, the timed solves reuse it
+	ctx.stage("solve",2,n*n,[&]{Solver.solve_with_solver(solver,u);});
+});
+
+#endif
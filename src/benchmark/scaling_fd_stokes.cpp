@@ -0,0 +1,155 @@
+/*
+ * scaling_fd_stokes.cpp
+ *
+ * Scaling of the Stokes solve of the lid driven cavity on a staggered grid with FD_scheme and petsc_solver
+ */
+
+#include "config.h"
+#if defined(HAVE_EIGEN) && defined(HAVE_PETSC)
+
+#include "scaling_util.hpp"
+#include "FiniteDifference/FD_Solver.hpp"
+#include "FiniteDifference/FD_expressions.hpp"
+#include "FiniteDifference/FD_op.hpp"
+#include "Grid/staggered_dist_grid.hpp"
+#include "Solvers/petsc_solver.hpp"
+
+//! Stokes system with velocity and pressure on a 2D staggered grid, solved with PETSc
+struct scaling_stokes_eq
+{
+	//! dimensionality of the equation
+	static const unsigned int dims = 2;
+
+	//! v_x, v_y, P
+	static const unsigned int nvar = 3;
+
+	//! boundary at X and Y
+	static const bool boundary[];
+
+	//! type of space
+	typedef double stype;
+
+	//! velocity, pressure, velocity of the lid
+	typedef staggered_grid_dist<2,double,aggregate<double[2],double,double>> b_grid;
+
+	//! type of SparseMatrix for the linear solver
+	typedef SparseMatrix<double,int,PETSC_BASE> SparseMatrix_type;
+
+	//! type of Vector for the linear solver
+	typedef Vector<double,PETSC_BASE> Vector_type;
+
+	typedef petsc_solver<double> solver_type;
+};
+
+const bool scaling_stokes_eq::boundary[] = {NON_PERIODIC,NON_PERIODIC};
+
+/*! \brief Lid driven cavity, nu Lap(v) - grad(P) = 0, div(v) = 0, v_y = 1 on the right wall
+ *
+ * Stages: imposition of the equations, solution. The saddle point system is solved with unpreconditioned GMRES
+ * for a fixed number of iterations, so every run does the same work
+ *
+ */
+static scaling_register reg_fd_stokes("fd_stokes",[](scaling_context & ctx)
+{
+	size_t n = ctx.side(2,65536);
+	long int sz[2] = {(long int)n,(long int)n};
+	size_t szu[2] = {n,n};
+
+	Box<2,double> domain({0.0,0.0},{1.0,1.0});
+	Ghost<2,long int> g(1);
+	Padding<2> pd({1,1},{0,0});
+
+	staggered_grid_dist<2,double,aggregate<double[2],double,double>> g_dist(szu,domain,g);
+
+	openfpm::vector<comb<2>> cmb_v;
+	cmb_v.add({0,-1});
+	cmb_v.add({-1,0});
+
+	g_dist.setDefaultStagPosition();
+	g_dist.setStagPosition<0>(cmb_v);
+
+	auto it = g_dist.getDomainIterator();
+	while (it.isNext())
+	{
+		auto key = it.get();
+		g_dist.getProp<2>(key) = (it.getGKey(key).get(0) == sz[0] - 1)?1.0:0.0;
+
+		++it;
+	}
+
+	Ghost<2,long int> stencil_max(1);
+
+	auto v = FD::getV_stag<0>(g_dist);
+	auto P = FD::getV_stag<1>(g_dist);
+
+	v.setVarId(0);
+	P.setVarId(2);
+
+	FD::Derivative_x_stag Dx;
+	FD::Derivative_y_stag Dy;
+	FD::Lap Lap;
+
+	auto Stokes_vx = Lap(v[0]) - Dx(P);
+	auto Stokes_vy = Lap(v[1]) - Dy(P);
+	auto incompressibility = Dx(v[0]) + Dy(v[1]);
+
+	eq_id ic,vx,vy;
+	ic.setId(2);
+	vx.setId(0);
+	vy.setId(1);
+
+	comb<2> left_cell({0,-1});
+	comb<2> bottom_cell({-1,0});
+	comb<2> corner_right({-1,1});
+	comb<2> corner_dw({-1,-1});
+	comb<2> corner_up({1,-1});
+
+	auto impose = [&](FD_scheme<scaling_stokes_eq,decltype(g_dist)> & fd)
+	{
+		fd.impose(incompressibility,{0,0},{sz[0]-2,sz[1]-2},0.0,ic,true);
+		fd.impose(P,{0,0},{0,0},0.0,ic);
+
+		fd.impose(Stokes_vx,{1,0},{sz[0]-2,sz[1]-2},0.0,vx,left_cell);
+		fd.impose(Stokes_vy,{0,1},{sz[0]-2,sz[1]-2},0.0,vy,bottom_cell);
+
+		// walls
+		fd.impose(v[0],{0,0},{0,sz[1]-2},0.0,vx,left_cell);
+		fd.impose(v[1],{-1,0},{-1,sz[1]-1},0.0,vy,corner_right);
+		fd.impose(v[0],{sz[0]-1,0},{sz[0]-1,sz[1]-2},0.0,vx,left_cell);
+		fd.impose(v[1],{sz[0]-1,0},{sz[0]-1,sz[1]-1},prop_id<2>(),vy,corner_dw);
+		fd.impose(v[0],{0,-1},{sz[0]-1,-1},0.0,vx,corner_up);
+		fd.impose(v[1],{0,0},{sz[0]-2,0},0.0,vy,bottom_cell);
+		fd.impose(v[0],{0,sz[1]-1},{sz[0]-1,sz[1]-1},0.0,vx,corner_dw);
+		fd.impose(v[1],{0,sz[1]-1},{sz[0]-2,sz[1]-1},0.0,vy,bottom_cell);
+
+		// padding
+		fd.impose(P,{-1,-1},{sz[0]-1,-1},0.0,ic);
+		fd.impose(P,{-1,sz[1]-1},{sz[0]-1,sz[1]-1},0.0,ic);
+		fd.impose(P,{-1,0},{-1,sz[1]-2},0.0,ic);
+		fd.impose(P,{sz[0]-1,0},{sz[0]-1,sz[1]-2},0.0,ic);
+		fd.impose(v[0],{-1,-1},{-1,sz[1]-1},0.0,vx,left_cell);
+		fd.impose(v[1],{-1,-1},{sz[0]-1,-1},0.0,vy,bottom_cell);
+	};
+
+	ctx.stage("impose",2,n*n,[&]{
+		FD_scheme<scaling_stokes_eq,decltype(g_dist)> fd(pd,stencil_max,g_dist);
+		impose(fd);
+	});
+
+	FD_scheme<scaling_stokes_eq,decltype(g_dist)> fd(pd,stencil_max,g_dist);
+	impose(fd);
+
+	petsc_solver<double> solver;
+	solver.setSolver(KSPGMRES);
+	solver.setPreconditioner(PCNONE);
+	solver.setRelTol(1e-14);
+	solver.setMaxIter(200);
+
+	// the warm-up solve assembles the matrix, the timed solves reuse it
+	ctx.stage("solve",2,n*n,[&]{
+		trace_span s("scaling.solver");
+		fd.solve_with_solver(solver,v[0],v[1],P);
+	});
+});
+
+#endif
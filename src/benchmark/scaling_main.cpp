@@ -0,0 +1,34 @@
+/*
+ * scaling_main.cpp
+ *
+ * Entry point of the scaling benchmarks of the numerics pipelines
+ *
+ * weak scaling with 65536 points per processor, appended to the records of the previous runs
+ *
+ * for n in 1 2 4 8 16 ; do mpirun -np $n ./numerics_scaling --mode weak --points 65536 --label v5.0 --out scaling.jsonl ; done
+ *
+ * every stage is written as one JSON object per line with its time split in compute, communication and solver
+ * (see scaling_context)
+ */
+
+#include "config.h"
+#include "scaling_util.hpp"
+
+int main(int argc, char* argv[])
+{
+	openfpm_init(&argc,&argv);
+
+	size_t n_stages;
+
+	{
+		scaling_context ctx(argc,argv);
+		n_stages = ctx.run();
+	}
+
+	if (create_vcluster().rank() == 0 && n_stages == 0)
+	{std::cerr << __FILE__ << ":" << __LINE__ << " warning no scaling case selected" << std::endl;}
+
+	openfpm_finalize();
+
+	return 0;
+}
@@ -0,0 +1,120 @@
+/*
+ * scaling_remesh.cpp
+ *
+ * Scaling of the particle to mesh and mesh to particle interpolation of a remeshing step
+ */
+
+#include "config.h"
+
+#include "scaling_util.hpp"
+#include "interpolation/interpolation.hpp"
+#include "interpolation/mp4_kernel.hpp"
+#include "Vector/vector_dist.hpp"
+#include "Grid/grid_dist_id.hpp"
+
+/*! \brief Remeshing with the mp4 kernel, 4 particles per cell of a periodic grid
+ *
+ * Stages: p2m with the ghost_put of the grid, m2p with the ghost_get of the grid, a full step where the particles
+ * move, are redistributed with map() and are interpolated to the grid and back
+ *
+ */
+static scaling_register reg_remesh("remesh",[](scaling_context & ctx)
+{
+	size_t n = ctx.side(3,32768);
+
+	Box<3,double> domain({0.0,0.0,0.0},{1.0,1.0,1.0});
+	size_t sz[3] = {n,n,n};
+	size_t bc[3] = {PERIODIC,PERIODIC,PERIODIC};
+
+	Ghost<3,long int> gg(3);
+	Ghost<3,double> gv(0.01);
+
+	size_t N = 4*n*n*n;
+
+	auto & v_cl = create_vcluster();
+
+	vector_dist<3,double,aggregate<double>> vd(N / v_cl.size(),domain,bc,gv);
+	grid_dist_id<3,double,aggregate<double>> gd(vd.getDecomposition(),sz,gg);
+
+	// always the same particles, the runs can be compared
+	srand(v_cl.rank() + 1);
+
+	auto it = vd.getDomainIterator();
+	while (it.isNext())
+	{
+		auto p = it.get();
+
+		for (size_t i = 0 ; i < 3 ; i++)
+		{vd.getPos(p)[i] = (double)rand()/RAND_MAX;}
+
+		vd.template getProp<0>(p) = 1.0;
+
+		++it;
+	}
+
+	{
+		trace_span s("scaling.comm");
+		vd.map();
+	}
+
+	auto p2m = [&]()
+	{
+		auto it = gd.getDomainGhostIterator();
+		while (it.isNext())
+		{
+			gd.template get<0>(it.get()) = 0.0;
+			++it;
+		}
+
+		interpolate<decltype(vd),decltype(gd),mp4_kernel<double>> inte(vd,gd);
+		inte.template p2m<0,0>(vd,gd);
+
+		trace_span s("scaling.comm");
+		gd.template ghost_put<add_,0>();
+	};
+
+	auto m2p = [&]()
+	{
+		{
+			trace_span s("scaling.comm");
+			gd.template ghost_get<0>();
+		}
+
+		auto it = vd.getDomainIterator();
+		while (it.isNext())
+		{
+			vd.template getProp<0>(it.get()) = 0.0;
+			++it;
+		}
+
+		interpolate<decltype(vd),decltype(gd),mp4_kernel<double>> inte(vd,gd);
+		inte.template m2p<0,0>(gd,vd);
+	};
+
+	ctx.stage("p2m",3,N,p2m);
+	ctx.stage("m2p",3,N,m2p);
+
+	// a displacement of half a cell, the particles stay in the box with the periodic map()
+	double dx = 0.5 / n;
+
+	ctx.stage("step",3,N,[&]{
+		auto it = vd.getDomainIterator();
+		while (it.isNext())
+		{
+			auto p = it.get();
+
+			for (size_t i = 0 ; i < 3 ; i++)
+			{vd.getPos(p)[i] += dx;}
+
+			++it;
+		}
+
+		{
+			trace_span s("scaling.comm");
+			vd.map();
+		}
+
+		p2m();
+		m2p();
+	});
+});
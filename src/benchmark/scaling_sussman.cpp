@@ -0,0 +1,48 @@
+/*
+ * scaling_sussman.cpp
+ *
+ * Scaling of the Sussman redistancing of a sphere
+ */
+
+#include "config.h"
+
+#include "scaling_util.hpp"
+#include "level_set/redistancing_Sussman/RedistancingSussman.hpp"
+#include "Draw/DrawSphere.hpp"
+
+/*! \brief 100 Sussman iterations from the indicator function of a sphere, on the full grid and on the narrow band
+ *
+ */
+static scaling_register reg_sussman("sussman",[](scaling_context & ctx)
+{
+	size_t n = ctx.side(3,262144);
+	size_t sz[3] = {n,n,n};
+
+	Box<3,double> box({-2.0,-2.0,-2.0},{2.0,2.0,2.0});
+	Ghost<3,long int> ghost(0);
+
+	typedef grid_dist_id<3,double,aggregate<double,double>> grid_in_type;
+	grid_in_type g_dist(sz,box,ghost);
+
+	init_grid_with_sphere<0>(g_dist,1.0,0.0,0.0,0.0);
+
+	auto run = [&](bool narrow_band)
+	{
+		Redist_options<double> redist_options;
+		redist_options.min_iter = 100;
+		redist_options.max_iter = 100;
+		redist_options.convTolChange.check = false;
+		redist_options.convTolResidual.check = false;
+		redist_options.interval_check_convergence = 100;
+		redist_options.width_NB_in_grid_points = 4;
+		redist_options.print_current_iterChangeResidual = false;
+		redist_options.print_steadyState_iter = false;
+		redist_options.narrow_band_iterations = narrow_band;
+
+		RedistancingSussman<grid_in_type,double> redist_obj(g_dist,redist_options);
+		redist_obj.template run_redistancing<0,1>();
+	};
+
+	ctx.stage("redistancing",3,n*n*n,[&]{run(false);});
+	ctx.stage("redistancing_narrow_band",3,n*n*n,[&]{run(true);});
+});
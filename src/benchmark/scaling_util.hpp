@@ -0,0 +1,349 @@
+/*
+ * scaling_util.hpp
+ *
+ * Harness of the weak and strong scaling benchmarks of the numerics pipelines
+ */
+
+#ifndef OPENFPM_NUMERICS_SRC_BENCHMARK_SCALING_UTIL_HPP_
+#define OPENFPM_NUMERICS_SRC_BENCHMARK_SCALING_UTIL_HPP_
+
+#include <chrono>
+#include <cmath>
+#include <cstring>
+#include <functional>
+#include <vector>
+#include <string>
+#include <algorithm>
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include "VCluster/VCluster.hpp"
+#include "util/trace_span.hpp"
+
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
+class scaling_context;
+
+/*! \brief A registered scaling case
+ *
+ */
+struct scaling_entry
+{
+	//! name of the case (prefix of all its stages)
+	std::string name;
+
+	//! body, it call scaling_context::stage for every stage of the pipeline
+	std::function<void(scaling_context &)> f;
+};
+
+//! List of the registered scaling cases
+inline std::vector<scaling_entry> & getScalingRegistry()
+{
+	static std::vector<scaling_entry> reg;
+
+	return reg;
+}
+
+/*! \brief Register a scaling case at static initialization
+ *
+ * \code{.cpp}
+
+   static scaling_register reg_remesh("remesh",[](scaling_context & ctx){...});
+
+ * \endcode
+ *
+ */
+struct scaling_register
+{
+	scaling_register(const std::string & name, std::function<void(scaling_context &)> f)
+	{
+		getScalingRegistry().push_back(scaling_entry{name,f});
+	}
+};
+
+/*! \brief Options and output of a scaling run
+ *
+ * In weak scaling the size given is per processor, in strong scaling it is the total size. Every stage is run once
+ * to warm-up and then reps times, between two barriers. The time of a repetition is split with the trace spans
+ * (util/trace_span.hpp, the executable is compiled with OPENFPM_NUMERICS_TRACE) in
+ *
+ * * communication: the spans *.ghost_get of the library and the scaling.comm spans of the cases (map, ghost_put)
+ * * solver: the spans *.solve of the library and the scaling.solver spans of the cases, without the communication
+ *   inside them
+ * * compute: the rest
+ *
+ * Every phase is reduced with the maximum and the minimum across the processors and averaged over the
+ * repetitions, one JSON object per line is written for every stage
+ *
+ */
+class scaling_context
+{
+	//! only the cases in this comma separated list are run (empty run all)
+	std::string cases;
+
+	//! weak or strong scaling
+	bool weak = true;
+
+	//! size of the problem per processor (weak) or total (strong), 0 use the default of the case
+	size_t points = 0;
+
+	//! number of timed repetitions
+	size_t reps = 5;
+
+	//! label of the run (for example the release), written in every record
+	std::string label;
+
+	//! output file (empty write on the standard output)
+	std::string out_file;
+
+	//! output
+	std::ofstream out;
+
+	//! name of the running case
+	std::string prefix;
+
+	//! number of stages written
+	size_t n_stages = 0;
+
+	//! Get the output stream
+	std::ostream & stream()
+	{
+		if (out.is_open())
+		{return out;}
+
+		return std::cout;
+	}
+
+	//! Check if name ends with suffix
+	static bool ends_with(const char * name, const char * suffix)
+	{
+		size_t ln = strlen(name);
+		size_t ls = strlen(suffix);
+
+		return ln >= ls && strcmp(name + ln - ls,suffix) == 0;
+	}
+
+	//! Check if a span is communication
+	static bool is_comm(const char * name)
+	{
+		return ends_with(name,".ghost_get") || strcmp(name,"scaling.comm") == 0;
+	}
+
+	//! Check if a span is a linear solve
+	static bool is_solver(const char * name)
+	{
+		return ends_with(name,".solve") || strcmp(name,"scaling.solver") == 0;
+	}
+
+	/*! \brief Time in communication and in the solver of the spans recorded on this processor
+	 *
+	 * \param comm time in communication
+	 * \param solver time in the solvers (without the communication inside them)
+	 *
+	 */
+	static void phases(double & comm, double & solver)
+	{
+		comm = 0.0;
+		solver = 0.0;
+
+		numerics_trace::get().for_each_thread([&](const trace_thread_buffer & buf)
+		{
+			std::vector<const trace_event *> sol;
+			for (size_t i = 0 ; i < buf.events.size() ; i++)
+			{
+				if (is_solver(buf.events[i].name))
+				{
+					sol.push_back(&buf.events[i]);
+					solver += (buf.events[i].end - buf.events[i].start) * 1e-9;
+				}
+			}
+
+			for (size_t i = 0 ; i < buf.events.size() ; i++)
+			{
+				const trace_event & e = buf.events[i];
+
+				if (is_comm(e.name) == false)
+				{continue;}
+
+				double t = (e.end - e.start) * 1e-9;
+				comm += t;
+
+				for (size_t j = 0 ; j < sol.size() ; j++)
+				{
+					if (e.start >= sol[j]->start && e.end <= sol[j]->end)
+					{
+						solver -= t;
+						break;
+					}
+				}
+			}
+		});
+	}
+
+public:
+
+	/*! \brief Parse the command line
+	 *
+	 * --cases <c1,c2> --mode weak|strong --points <n> --reps <n> --label <str> --out <file>
+	 *
+	 */
+	scaling_context(int argc, char* argv[])
+	{
+		for (int i = 1 ; i < argc ; i++)
+		{
+			std::string a(argv[i]);
+
+			if (a == "--cases" && i + 1 < argc)
+			{cases = argv[++i];}
+			else if (a == "--mode" && i + 1 < argc)
+			{weak = std::string(argv[++i]) != "strong";}
+			else if (a == "--points" && i + 1 < argc)
+			{points = atol(argv[++i]);}
+			else if (a == "--reps" && i + 1 < argc)
+			{reps = std::max(1l,atol(argv[++i]));}
+			else if (a == "--label" && i + 1 < argc)
+			{label = argv[++i];}
+			else if (a == "--out" && i + 1 < argc)
+			{out_file = argv[++i];}
+			else
+			{std::cerr << __FILE__ << ":" << __LINE__ << " warning unknown option " << a << std::endl;}
+		}
+
+		auto & v_cl = create_vcluster();
+
+		if (v_cl.rank() == 0 && out_file.size() != 0)
+		{
+			out.open(out_file,std::ios_base::app);
+
+			if (out.is_open() == false)
+			{std::cerr << __FILE__ << ":" << __LINE__ << " error cannot open " << out_file << ", writing on the standard output" << std::endl;}
+		}
+	}
+
+	//! Check if a case must be run
+	bool selected(const std::string & name) const
+	{
+		if (cases.size() == 0)
+		{return true;}
+
+		std::stringstream ss(cases);
+		std::string c;
+		while (std::getline(ss,c,','))
+		{
+			if (c == name) {return true;}
+		}
+
+		return false;
+	}
+
+	/*! \brief Points per side of a problem of dimensionality dim
+	 *
+	 * \param dim dimensionality
+	 * \param def_points default size of the case (per processor in weak scaling, total in strong)
+	 *
+	 * \return the points per side, at least 8
+	 *
+	 */
+	size_t side(size_t dim, size_t def_points) const
+	{
+		double n = (points != 0)?points:def_points;
+
+		if (weak == true)
+		{n *= create_vcluster().size();}
+
+		return std::max(8l,std::lround(std::pow(n,1.0/dim)));
+	}
+
+	/*! \brief Time a stage of the pipeline
+	 *
+	 * \param name name of the stage (the name of the case is added as prefix)
+	 * \param dim dimensionality of the problem
+	 * \param n total size of the problem
+	 * \param f stage to time, it must be re-entrant
+	 *
+	 */
+	template<typename stage_type>
+	void stage(const std::string & name, size_t dim, size_t n, stage_type f)
+	{
+		auto & v_cl = create_vcluster();
+
+		f();
+
+		// wall, compute, communication, solver: maximum and minimum across the processors
+		double t_max[4] = {0.0,0.0,0.0,0.0};
+		double t_min[4] = {0.0,0.0,0.0,0.0};
+
+		for (size_t r = 0 ; r < reps ; r++)
+		{
+			numerics_trace::get().reset();
+
+			auto start = std::chrono::steady_clock::now();
+			f();
+			auto stop = std::chrono::steady_clock::now();
+
+			double t[4];
+			t[0] = std::chrono::duration<double>(stop - start).count();
+			phases(t[2],t[3]);
+			t[1] = std::max(0.0,t[0] - t[2] - t[3]);
+
+			double tm[4];
+			for (size_t i = 0 ; i < 4 ; i++)
+			{
+				tm[i] = t[i];
+				v_cl.max(t[i]);
+				v_cl.min(tm[i]);
+			}
+			v_cl.execute();
+
+			for (size_t i = 0 ; i < 4 ; i++)
+			{
+				t_max[i] += t[i] / reps;
+				t_min[i] += tm[i] / reps;
+			}
+		}
+
+		numerics_trace::get().reset();
+
+		int n_threads = 1;
+#ifdef _OPENMP
+		n_threads = omp_get_max_threads();
+#endif
+
+		if (v_cl.rank() == 0)
+		{
+			std::stringstream ss;
+			ss.precision(9);
+
+			ss << "{\"name\":\"" << prefix << "." << name << "\",\"label\":\"" << label << "\",\"mode\":\"" << (weak?"weak":"strong")
+			   << "\",\"dim\":" << dim << ",\"n\":" << n << ",\"n_per_proc\":" << n / v_cl.size()
+			   << ",\"procs\":" << v_cl.size() << ",\"threads\":" << n_threads << ",\"reps\":" << reps
+			   << ",\"wall_s\":" << t_max[0] << ",\"compute_s\":" << t_max[1] << ",\"comm_s\":" << t_max[2] << ",\"solver_s\":" << t_max[3]
+			   << ",\"wall_min_s\":" << t_min[0] << ",\"compute_min_s\":" << t_min[1] << ",\"comm_min_s\":" << t_min[2] << ",\"solver_min_s\":" << t_min[3] << "}";
+
+			stream() << ss.str() << std::endl;
+		}
+
+		n_stages++;
+	}
+
+	//! Run all the selected cases
+	size_t run()
+	{
+		auto & reg = getScalingRegistry();
+
+		for (size_t i = 0 ; i < reg.size() ; i++)
+		{
+			if (selected(reg[i].name) == false)
+			{continue;}
+
+			prefix = reg[i].name;
+			reg[i].f(*this);
+		}
+
+		return n_stages;
+	}
+};
+
+#endif /* OPENFPM_NUMERICS_SRC_BENCHMARK_SCALING_UTIL_HPP_ */
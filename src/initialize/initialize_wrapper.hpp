@@ -8,6 +8,8 @@
 #ifndef INITIALIZE_VCL_HPP_
 #define INITIALIZE_VCL_HPP_
 
+#include "numerics_backends.hpp"
+
 /*! \brief If openfpm has to work on GPU we have to be sure openfpm_init is called on a file compiled with NVCC
  *
  * There are two implementation initialize.cpp and initialize.cu. In configuration stage the second implementation is chosen
@@ -15,6 +17,18 @@
  *
  */
 void openfpm_init_wrapper(int * argc, char *** argv);
+
+/*! \brief Initialize openfpm choosing when the numerics bring up PETSc and the devices
+ *
+ * With numerics_init_mode::LAZY PETSc and the device context are initialized at their first use or by
+ * numerics_prewarm(), runs that never use a PETSc solver or a GPU operator do not pay for them
+ *
+ * \param argc number of arguments of the command line
+ * \param argv arguments of the command line
+ * \param mode initialization mode of PETSc and of the devices
+ *
+ */
+void openfpm_init_wrapper(int * argc, char *** argv, numerics_init_mode mode);
 void openfpm_finalize_wrapper();
 
 #endif /* INITIALIZE_VCL_HPP_ */
@@ -5,11 +5,23 @@
 
 void openfpm_init_wrapper(int * argc, char *** argv)
 {
+	openfpm_init_wrapper(argc,argv,numerics_init_mode::EAGER);
+}
+
+void openfpm_init_wrapper(int * argc, char *** argv, numerics_init_mode mode)
+{
+	numerics_backends::setMode(mode,argc,argv);
+
 	openfpm_init(argc,argv);
+
+	if (mode == numerics_init_mode::EAGER)
+	{numerics_backends::prewarm();}
 }
 
 void openfpm_finalize_wrapper()
 {
+	numerics_backends::finalize();
+
 	openfpm_finalize();
 }
 
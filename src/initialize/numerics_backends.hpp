@@ -0,0 +1,155 @@
+/*
+ * numerics_backends.hpp
+ *
+ * Initialization of PETSc and of the devices at the first use
+ */
+
+#ifndef OPENFPM_NUMERICS_SRC_INITIALIZE_NUMERICS_BACKENDS_HPP_
+#define OPENFPM_NUMERICS_SRC_INITIALIZE_NUMERICS_BACKENDS_HPP_
+
+#include "config.h"
+#include <mpi.h>
+
+#ifdef HAVE_PETSC
+#include <petscsys.h>
+#endif
+
+#if defined(CUDA_GPU) && defined(__NVCC__)
+#include <cuda_runtime.h>
+#endif
+
+//! When the numerics bring up PETSc and the devices
+enum class numerics_init_mode
+{
+	//! in openfpm_init_wrapper
+	EAGER,
+
+	//! at the first petsc_solver, SparseMatrix or Vector with PETSC_BASE, Dcpse_gpu, or at numerics_prewarm()
+	LAZY
+};
+
+/*! \brief PETSc and device contexts of the numerics
+ *
+ * Every object that needs PETSc or a device calls ensure_petsc() or ensure_device() when it is created, so the
+ * numerics do not depend on an eager initialization in openfpm_init. Both calls do nothing if the backend is
+ * already initialized (by openfpm_init or by a previous call). PETSc is initialized with the command line given to
+ * openfpm_init_wrapper and, if it is initialized here, it is finalized by openfpm_finalize_wrapper
+ *
+ * \warning ensure_petsc() is collective on MPI_COMM_WORLD the first time it initializes PETSc, with LAZY all the
+ *          processors must create their first PETSc object together (as they already do, PETSc objects are
+ *          created collectively) or call numerics_prewarm()
+ *
+ */
+class numerics_backends
+{
+	//! state of the backends
+	struct backends_state
+	{
+		//! initialization mode
+		numerics_init_mode mode = numerics_init_mode::EAGER;
+
+		//! command line given to openfpm_init_wrapper
+		int * argc = NULL;
+		char *** argv = NULL;
+
+		//! PETSc has been initialized here
+		bool petsc_owned = false;
+
+		//! the device context has been created
+		bool device_ready = false;
+	};
+
+	static backends_state & state()
+	{
+		static backends_state s;
+
+		return s;
+	}
+
+public:
+
+	/*! \brief Set the initialization mode (called by openfpm_init_wrapper)
+	 *
+	 * \param mode initialization mode
+	 * \param argc number of arguments of the command line
+	 * \param argv arguments of the command line
+	 *
+	 */
+	static void setMode(numerics_init_mode mode, int * argc, char *** argv)
+	{
+		state().mode = mode;
+		state().argc = argc;
+		state().argv = argv;
+	}
+
+	//! Get the initialization mode
+	static numerics_init_mode getMode()
+	{
+		return state().mode;
+	}
+
+	//! Initialize PETSc if it is not initialized
+	static void ensure_petsc()
+	{
+#ifdef HAVE_PETSC
+		PetscBool init;
+		PetscInitialized(&init);
+
+		if (init == PETSC_TRUE)
+		{return;}
+
+		if (state().argc != NULL)
+		{PetscInitialize(state().argc,state().argv,NULL,NULL);}
+		else
+		{PetscInitializeNoArguments();}
+
+		state().petsc_owned = true;
+#endif
+	}
+
+	//! Create the context of the device of this processor if it is not created
+	static void ensure_device()
+	{
+#if defined(CUDA_GPU) && defined(__NVCC__)
+		if (state().device_ready == true)
+		{return;}
+
+		// the device is the one selected by openfpm_init, the first runtime call creates its context
+		cudaFree(0);
+
+		state().device_ready = true;
+#endif
+	}
+
+	//! Initialize all the backends
+	static void prewarm()
+	{
+		ensure_petsc();
+		ensure_device();
+	}
+
+	//! Finalize the backends initialized here (before MPI is finalized)
+	static void finalize()
+	{
+#ifdef HAVE_PETSC
+		if (state().petsc_owned == true)
+		{
+			PetscFinalize();
+			state().petsc_owned = false;
+		}
+#endif
+	}
+};
+
+/*! \brief Initialize PETSc and the device context now
+ *
+ * With numerics_init_mode::LAZY the first solver or GPU operator pays the initialization, call it after
+ * openfpm_init_wrapper to keep it out of the timed regions. It is collective
+ *
+ */
+inline void numerics_prewarm()
+{
+	numerics_backends::prewarm();
+}
+
+#endif /* OPENFPM_NUMERICS_SRC_INITIALIZE_NUMERICS_BACKENDS_HPP_ */
@@ -12,6 +12,11 @@
 #include "NN/CellList/CellList.hpp"
 #include "Grid/grid_dist_key.hpp"
 #include "Vector/vector_dist_key.hpp"
+#include "util/trace_span.hpp"
+
+#ifdef _OPENMP
+#include <omp.h>
+#endif
 
 #define INTERPOLATION_ERROR_OBJECT std::runtime_error("Runtime interpolation error");
 
@@ -169,6 +174,137 @@ struct inte_template<np,prp_g,prp_v,inte_m2p>
 	}
 };
 
+/*! \brief Pair of properties for p2m_multi, the property prp_v of the particles is interpolated on prp_g of the grid
+ *
+ * \tparam prp_v property of the vector
+ * \tparam prp_g property of the grid
+ *
+ */
+template<unsigned int prp_v_, unsigned int prp_g_>
+struct p2m_prp
+{
+	//! property of the vector
+	static const unsigned int prp_v = prp_v_;
+
+	//! property of the grid
+	static const unsigned int prp_g = prp_g_;
+};
+
+/*! \brief Pair of properties for m2p_multi, the property prp_g of the grid is interpolated on prp_v of the particles
+ *
+ * \tparam prp_g property of the grid
+ * \tparam prp_v property of the vector
+ *
+ */
+template<unsigned int prp_g_, unsigned int prp_v_>
+struct m2p_prp
+{
+	//! property of the vector
+	static const unsigned int prp_v = prp_v_;
+
+	//! property of the grid
+	static const unsigned int prp_g = prp_g_;
+};
+
+/*! \brief Apply the interpolation of one stencil point to several pairs of properties
+ *
+ * \tparam np number of kernel points in one direction
+ * \tparam m2p_or_p2m M2P or P2M
+ * \tparam prps pairs of properties (p2m_prp or m2p_prp)
+ *
+ */
+template<unsigned int np, unsigned int m2p_or_p2m, typename ... prps>
+struct inte_template_multi
+{
+	//! No more properties
+	template<unsigned int np_a_int, typename grid, typename vector, typename iterator> inline static void value(grid & gd,
+																	  vector & vd,
+																	  const grid_dist_lin_dx & k_dist,
+																	  iterator & key_p,
+																	  typename vector::stype (& a_int)[np_a_int],
+																	  const size_t & key)
+	{}
+};
+
+/*! \brief Apply the interpolation of one stencil point to several pairs of properties
+ *
+ * \tparam np number of kernel points in one direction
+ * \tparam m2p_or_p2m M2P or P2M
+ * \tparam prp first pair of properties
+ * \tparam prps other pairs of properties
+ *
+ */
+template<unsigned int np, unsigned int m2p_or_p2m, typename prp, typename ... prps>
+struct inte_template_multi<np,m2p_or_p2m,prp,prps...>
+{
+	/*! \brief Evaluate the interpolation for all the pairs of properties
+	 *
+	 * \param gd grid for interpolation
+	 * \param vd vector for interpolation
+	 * \param k_dist grid key grid point for interpolation
+	 * \param key_p particle for interpolation
+	 * \param a_int interpolation coefficients pre-calculated
+	 * \param key indicate which pre-calculated coefficient we have to use
+	 *
+	 */
+	template<unsigned int np_a_int, typename grid, typename vector, typename iterator> inline static void value(grid & gd,
+																	  vector & vd,
+																	  const grid_dist_lin_dx & k_dist,
+																	  iterator & key_p,
+																	  typename vector::stype (& a_int)[np_a_int],
+																	  const size_t & key)
+	{
+		inte_template<np,prp::prp_g,prp::prp_v,m2p_or_p2m>::value(gd,vd,k_dist,key_p,a_int,key);
+		inte_template_multi<np,m2p_or_p2m,prps...>::value(gd,vd,k_dist,key_p,a_int,key);
+	}
+};
+
+/*! \brief Evaluate the 1D kernel on all the points of the stencil
+ *
+ * Kernels that provide value_all(x,a) evaluate all the weights without branches, for the others
+ * value(x,j) is called for every point of the stencil
+ *
+ * \tparam kernel interpolation kernel
+ * \tparam T type of the calculations
+ *
+ */
+template<typename kernel, typename T, typename Sfinae = void>
+struct kernel_weights
+{
+	/*! \brief Evaluate the kernel weights
+	 *
+	 * \param x distance of the stencil points from the particle (in grid units)
+	 * \param a weights
+	 *
+	 */
+	__device__ __host__ static inline void value(const T (& x)[kernel::np], T (& a)[kernel::np])
+	{
+		for (size_t j = 0 ; j < kernel::np ; j++)
+		{a[j] = kernel::value(x[j],j);}
+	}
+};
+
+/*! \brief Evaluate the 1D kernel on all the points of the stencil (branch-free kernels)
+ *
+ * \tparam kernel interpolation kernel
+ * \tparam T type of the calculations
+ *
+ */
+template<typename kernel, typename T>
+struct kernel_weights<kernel,T,typename std::enable_if<std::is_same<decltype(kernel::value_all(std::declval<const T (&)[kernel::np]>(),std::declval<T (&)[kernel::np]>())),void>::value>::type>
+{
+	/*! \brief Evaluate the kernel weights
+	 *
+	 * \param x distance of the stencil points from the particle (in grid units)
+	 * \param a weights
+	 *
+	 */
+	__device__ __host__ static inline void value(const T (& x)[kernel::np], T (& a)[kernel::np])
+	{
+		kernel::value_all(x,a);
+	}
+};
+
 /*! \brief Calculate aint
  *
  * This class store
@@ -371,6 +507,53 @@ inline size_t getSub(Point<vector::dims,typename vector::stype> & p,
 	return best_sub;
 }
 
+/*! \brief Initialize the cell list that converts a particle position into the sub-domain of the grid (see getSub)
+ *
+ * \param geo_cell cell list to initialize
+ * \param gd grid
+ *
+ */
+template<typename vector, typename grid>
+inline void initGeoCell(CellList<vector::dims,typename vector::stype,Mem_fast<>,shift<vector::dims,typename vector::stype>> & geo_cell,
+		                grid & gd)
+{
+	// get the processor bounding box in grid units
+	Box<vector::dims,typename vector::stype> bb = gd.getDecomposition().getProcessorBounds();
+	Box<vector::dims,typename vector::stype> bunit = gd.getDecomposition().getCellDecomposer().getCellBox();
+
+	size_t div[vector::dims];
+
+	for (size_t i = 0 ; i < vector::dims ; i++)
+		div[i] = (bb.getHigh(i) - bb.getLow(i)) / bunit.getHigh(i);
+
+	geo_cell.Initialize(bb,div);
+
+	// Now draw the domain into the cell list
+
+	auto & dec = gd.getDecomposition();
+
+	for (size_t i = 0 ; i < dec.getNSubDomain() ; i++)
+	{
+		const Box<vector::dims,typename vector::stype> & bx = dec.getSubDomain(i);
+
+		// get the cells this box span
+		const grid_key_dx<vector::dims> p1 = geo_cell.getCellGrid(bx.getP1());
+		const grid_key_dx<vector::dims> p2 = geo_cell.getCellGrid(bx.getP2());
+
+		// Get the grid and the sub-iterator
+		auto & gi = geo_cell.getGrid();
+		grid_key_dx_iterator_sub<vector::dims> g_sub(gi,p1,p2);
+
+		// add the box-id to the cell list
+		while (g_sub.isNext())
+		{
+			auto key = g_sub.get();
+			geo_cell.addCell(gi.LinId(key),i);
+			++g_sub;
+		}
+	}
+}
+
 /*! \brief calculate the interpolation for one point
  *
  * \tparam vector of particles
@@ -422,6 +605,169 @@ struct inte_calc_impl
 																	 size_t (& sz)[vector::dims],
 																	 const CellList<vector::dims,typename vector::stype,Mem_fast<>,shift<vector::dims,typename vector::stype>> & geo_cell,
 																	 openfpm::vector<agg_arr<openfpm::math::pow(kernel::np,vector::dims)>> & offsets)
+	{
+		size_t lin_base;
+		size_t sub = locate(key_p,vd,domain,ip,gd,dx,xp,x,geo_cell,lin_base);
+
+		for (size_t i = 0 ; i < vector::dims ; i++)
+		{kernel_weights<kernel,arr_type>::value(x[i],a[i]);}
+
+		calculate_aint<vector::dims,vector,kernel::np>::value(sz,a_int,a);
+
+		accumulate<inte_template<kernel::np,prp_g,prp_v,m2p_or_p2m>>(key_p,vd,gd,sub,lin_base,a_int,offsets);
+	}
+
+	/*! \brief M2P or P2M for a block of particles
+	 *
+	 * The particles are first located on the grid, then the kernel weights of all the particles are evaluated
+	 * and finally the interpolation is accumulated. The phases have independent iterations over the particles
+	 * of the block, and the particles are accumulated in the same order as inte_calc (the result is the same)
+	 *
+	 * \tparam inte_op operation on a stencil point (inte_template or inte_template_multi)
+	 * \tparam block maximum number of particles in the block
+	 *
+	 * \param keys particles of the block
+	 * \param n number of particles in the block
+	 * \param vd vector of particles
+	 * \param domain simulation domain
+	 * \param gd interpolation grid
+	 * \param dx inverse of the spacing on each direction
+	 * \param sz grid size
+	 * \param geo_cell cell list to convert particle position into sub-domain id
+	 * \param offsets array where are stored the linearized offset of the
+	 *        kernel stencil for each local grid (sub-domain)
+	 *
+	 */
+	template<typename inte_op, unsigned int np_a_int, unsigned int block, typename grid>
+	static inline void inte_calc_block(const vect_dist_key_dx (& keys)[block],
+									   size_t n,
+									   vector & vd,
+									   const Box<vector::dims,typename vector::stype> & domain,
+									   grid & gd,
+									   const typename vector::stype (& dx)[vector::dims],
+									   size_t (& sz)[vector::dims],
+									   const CellList<vector::dims,typename vector::stype,Mem_fast<>,shift<vector::dims,typename vector::stype>> & geo_cell,
+									   openfpm::vector<agg_arr<openfpm::math::pow(kernel::np,vector::dims)>> & offsets)
+	{
+		int ip[vector::dims][kernel::np];
+		arr_type xp[vector::dims];
+		arr_type x[block][vector::dims][kernel::np];
+		arr_type a[block][vector::dims][kernel::np];
+		arr_type a_int[np_a_int];
+
+		size_t sub[block];
+		size_t lin_base[block];
+
+		for (size_t b = 0 ; b < n ; b++)
+		{sub[b] = locate(keys[b],vd,domain,ip,gd,dx,xp,x[b],geo_cell,lin_base[b]);}
+
+		for (size_t b = 0 ; b < n ; b++)
+		{
+			for (size_t i = 0 ; i < vector::dims ; i++)
+			{kernel_weights<kernel,arr_type>::value(x[b][i],a[b][i]);}
+		}
+
+		for (size_t b = 0 ; b < n ; b++)
+		{
+			calculate_aint<vector::dims,vector,kernel::np>::value(sz,a_int,a[b]);
+
+			accumulate<inte_op>(keys[b],vd,gd,sub[b],lin_base[b],a_int,offsets);
+		}
+	}
+
+	/*! \brief Calculate the stencil of a particle (sub-domain, first stencil point and coefficients) without interpolating
+	 *
+	 * \param key_p particle
+	 * \param vd vector of particles
+	 * \param domain simulation domain
+	 * \param gd interpolation grid
+	 * \param dx inverse of the spacing on each direction
+	 * \param sz grid size
+	 * \param geo_cell cell list to convert particle position into sub-domain id
+	 * \param sub sub-domain of the particle
+	 * \param lin_base linearized position of the first stencil point in the local grid
+	 * \param a_int coefficients on the stencil points
+	 *
+	 */
+	template<unsigned int np_a_int, typename grid>
+	static inline void inte_stencil(const vect_dist_key_dx & key_p,
+									vector & vd,
+									const Box<vector::dims,typename vector::stype> & domain,
+									grid & gd,
+									const typename vector::stype (& dx)[vector::dims],
+									size_t (& sz)[vector::dims],
+									const CellList<vector::dims,typename vector::stype,Mem_fast<>,shift<vector::dims,typename vector::stype>> & geo_cell,
+									size_t & sub,
+									size_t & lin_base,
+									typename vector::stype (& a_int)[np_a_int])
+	{
+		int ip[vector::dims][kernel::np];
+		arr_type xp[vector::dims];
+		arr_type x[vector::dims][kernel::np];
+		arr_type a[vector::dims][kernel::np];
+
+		sub = locate(key_p,vd,domain,ip,gd,dx,xp,x,geo_cell,lin_base);
+
+		for (size_t i = 0 ; i < vector::dims ; i++)
+		{kernel_weights<kernel,arr_type>::value(x[i],a[i]);}
+
+		calculate_aint<vector::dims,vector,kernel::np>::value(sz,a_int,a);
+	}
+
+	/*! \brief M2P or P2M of a particle with a stencil calculated by inte_stencil
+	 *
+	 * \tparam inte_op operation on a stencil point (inte_template or inte_template_multi)
+	 *
+	 * \param key_p particle
+	 * \param vd vector of particles
+	 * \param gd interpolation grid
+	 * \param sub sub-domain of the particle
+	 * \param lin_base linearized position of the first stencil point in the local grid
+	 * \param a_int coefficients on the stencil points
+	 * \param offsets linearized offset of the kernel stencil for each local grid
+	 *
+	 */
+	template<typename inte_op, unsigned int np_a_int, typename grid>
+	static inline void inte_calc_stencil(const vect_dist_key_dx & key_p,
+										 vector & vd,
+										 grid & gd,
+										 size_t sub,
+										 size_t lin_base,
+										 typename vector::stype (& a_int)[np_a_int],
+										 openfpm::vector<agg_arr<openfpm::math::pow(kernel::np,vector::dims)>> & offsets)
+	{
+		accumulate<inte_op>(key_p,vd,gd,sub,lin_base,a_int,offsets);
+	}
+
+private:
+
+	/*! \brief Find the sub-domain and the stencil of a particle
+	 *
+	 * \param key_p particle
+	 * \param vd vector of particles
+	 * \param domain simulation domain
+	 * \param ip index of the grid on each direction (1D) used for interpolation
+	 * \param gd interpolation grid
+	 * \param dx inverse of the spacing on each direction
+	 * \param xp position of the particle relative to the first stencil point (grid units)
+	 * \param x distance of the stencil points from the particle on each direction (grid units)
+	 * \param geo_cell cell list to convert particle position into sub-domain id
+	 * \param lin_base linearized position of the first stencil point in the local grid
+	 *
+	 * \return the sub-domain
+	 *
+	 */
+	template<typename grid>
+	static inline size_t locate(const vect_dist_key_dx & key_p,
+								vector & vd,
+								const Box<vector::dims,typename vector::stype> & domain,
+								int (& ip)[vector::dims][kernel::np],
+								grid & gd,
+								const typename vector::stype (& dx)[vector::dims],
+								typename vector::stype (& xp)[vector::dims],
+								typename vector::stype (& x)[vector::dims][kernel::np],
+								const CellList<vector::dims,typename vector::stype,Mem_fast<>,shift<vector::dims,typename vector::stype>> & geo_cell,
+								size_t & lin_base)
 	{
 		Point<vector::dims,typename vector::stype> p = vd.getPos(key_p);
 
@@ -462,30 +808,41 @@ struct inte_calc_impl
 			{x[i][j] = - xp[i] + typename vector::stype((long int)j - (long int)kernel::np/2 + 1);}
 		}
 
-		for (size_t j = 0 ; j < kernel::np ; j++)
-		{
-			for (size_t i = 0 ; i < vector::dims ; i++)
-			{a[i][j] = kernel::value(x[i][j],j);}
-		}
+		lin_base = gd.get_loc_grid(sub).getGrid().LinId(base);
 
-		calculate_aint<vector::dims,vector,kernel::np>::value(sz,a_int,a);
+		return sub;
+	}
 
+	/*! \brief Accumulate the interpolation of one particle on the stencil
+	 *
+	 * \param key_p particle
+	 * \param vd vector of particles
+	 * \param gd interpolation grid
+	 * \param sub sub-domain of the particle
+	 * \param lin_base linearized position of the first stencil point in the local grid
+	 * \param a_int coefficients on the stencil points
+	 * \param offsets linearized offset of the kernel stencil for each local grid
+	 *
+	 */
+	template<typename inte_op, unsigned int np_a_int, typename grid>
+	static inline void accumulate(const vect_dist_key_dx & key_p,
+								  vector & vd,
+								  grid & gd,
+								  size_t sub,
+								  size_t lin_base,
+								  typename vector::stype (& a_int)[np_a_int],
+								  openfpm::vector<agg_arr<openfpm::math::pow(kernel::np,vector::dims)>> & offsets)
+	{
 		grid_dist_lin_dx k_dist_lin;
 		k_dist_lin.setSub(sub);
 
-		size_t k = 0;
-		auto & gs_info = gd.get_loc_grid(sub).getGrid();
+		const size_t (& off)[openfpm::math::pow(kernel::np,vector::dims)] = offsets.get(sub).ele;
 
-		size_t lin_base = gs_info.LinId(base);
-
-		for (size_t i = 0 ; i < openfpm::math::pow(kernel::np,vector::dims) ; i++)
+		for (size_t k = 0 ; k < openfpm::math::pow(kernel::np,vector::dims) ; k++)
 		{
-			size_t lin = offsets.get(sub).ele[k] + lin_base;
-			k_dist_lin.getKeyRef() = lin;
-
-			inte_template<kernel::np,prp_g,prp_v,m2p_or_p2m>::value(gd,vd,k_dist_lin,key_p,a_int,k);
+			k_dist_lin.getKeyRef() = off[k] + lin_base;
 
-			k++;
+			inte_op::value(gd,vd,k_dist_lin,key_p,a_int,k);
 		}
 	}
 };
@@ -552,6 +909,269 @@ class interpolate
 	//! Simulation domain
 	Box<vector::dims,typename vector::stype> domain;
 
+	//! number of particles interpolated together by p2m and m2p
+	static constexpr size_t inte_block = 8;
+
+	//! particles sorted by slab (parallel p2m), the particles of slab s are in [slab_start(s), slab_start(s+1))
+	openfpm::vector<size_t> slab_part;
+	openfpm::vector<size_t> slab_start;
+
+	//! Stencil of a particle (see cache_stencil)
+	struct stencil_cache
+	{
+		//! sub-domain
+		size_t sub;
+
+		//! linearized position of the first stencil point in the local grid
+		size_t lin_base;
+
+		//! coefficients on the stencil points
+		arr_type a_int[openfpm::math::pow(kernel::np,vector::dims)];
+	};
+
+	//! cached stencil of every particle
+	openfpm::vector<stencil_cache> stencils;
+
+	//! true if the stencils have been calculated
+	bool stencils_valid = false;
+
+	//! map counter of the particles when the stencils have been calculated
+	size_t stencils_map_ctr = 0;
+
+	/*! \brief Interpolate a particle with its cached stencil
+	 *
+	 * \tparam inte_op operation on a stencil point
+	 *
+	 * \param i particle
+	 * \param vd particle set
+	 * \param gd grid
+	 *
+	 */
+	template<typename inte_op> inline void inte_cached(size_t i, vector & vd, grid & gd)
+	{
+		stencil_cache & st = stencils.get(i);
+
+		inte_calc_impl<vector,kernel>::template inte_calc_stencil<inte_op>(vect_dist_key_dx(i),vd,gd,st.sub,st.lin_base,st.a_int,offsets);
+	}
+
+	/*! \brief Sort the particles by slabs of kernel::np grid points along the first dimension
+	 *
+	 * The stencils of two particles in slabs s and s+2 never overlap, so the even slabs (and then the odd slabs)
+	 * can be interpolated concurrently
+	 *
+	 * \param vd particle set
+	 *
+	 * \return the number of slabs
+	 *
+	 */
+	size_t bin_particles_in_slabs(vector & vd)
+	{
+		size_t n_part = vd.size_local();
+
+		size_t n_slabs = (size_t)((domain.getHigh(0) - domain.getLow(0))*dx[0]) / kernel::np + 2;
+
+		slab_start.resize(n_slabs+1);
+		slab_part.resize(n_part);
+
+		for (size_t s = 0 ; s < slab_start.size() ; s++)
+		{slab_start.get(s) = 0;}
+
+		openfpm::vector<size_t> slab_of(n_part);
+		for (size_t i = 0 ; i < n_part ; i++)
+		{
+			long int ip = (long int)((vd.getPos(i)[0] - domain.getLow(0))*dx[0]);
+			long int sl = ip / (long int)kernel::np;
+			sl = (sl < 0)?0:sl;
+			sl = (sl >= (long int)n_slabs)?n_slabs-1:sl;
+
+			slab_of.get(i) = sl;
+			slab_start.get(sl+1)++;
+		}
+
+		for (size_t s = 0 ; s < n_slabs ; s++)
+		{slab_start.get(s+1) += slab_start.get(s);}
+
+		openfpm::vector<size_t> fill(n_slabs);
+		for (size_t s = 0 ; s < n_slabs ; s++)
+		{fill.get(s) = slab_start.get(s);}
+
+		for (size_t i = 0 ; i < n_part ; i++)
+		{
+			slab_part.get(fill.get(slab_of.get(i))) = i;
+			fill.get(slab_of.get(i))++;
+		}
+
+		return n_slabs;
+	}
+
+	/*! \brief Interpolate particles to mesh with several threads
+	 *
+	 * The particles are binned in slabs, the even and then the odd slabs are processed in parallel (two colours),
+	 * so threads never scatter on the same grid points
+	 *
+	 * \tparam inte_op p2m operation on a stencil point
+	 *
+	 * \param vd particle set
+	 * \param gd grid
+	 * \param cached use the cached stencils
+	 *
+	 */
+	template<typename inte_op> void p2m_parallel(vector & vd, grid & gd, bool cached)
+	{
+		long int n_slabs = bin_particles_in_slabs(vd);
+
+		for (long int colour = 0 ; colour < 2 ; colour++)
+		{
+			#pragma omp parallel for schedule(dynamic)
+			for (long int s = colour ; s < n_slabs ; s += 2)
+			{
+				if (cached == true)
+				{
+					for (size_t i = slab_start.get(s) ; i < slab_start.get(s+1) ; i++)
+					{inte_cached<inte_op>(slab_part.get(i),vd,gd);}
+
+					continue;
+				}
+
+				vect_dist_key_dx keys[inte_block];
+				size_t n = 0;
+
+				for (size_t i = slab_start.get(s) ; i < slab_start.get(s+1) ; i++)
+				{
+					keys[n] = vect_dist_key_dx(slab_part.get(i));
+					n++;
+
+					if (n == inte_block)
+					{
+						inte_calc_impl<vector,kernel>::template inte_calc_block<inte_op,openfpm::math::pow(kernel::np,vector::dims)>(keys,n,vd,domain,gd,dx,sz,geo_cell,offsets);
+						n = 0;
+					}
+				}
+
+				inte_calc_impl<vector,kernel>::template inte_calc_block<inte_op,openfpm::math::pow(kernel::np,vector::dims)>(keys,n,vd,domain,gd,dx,sz,geo_cell,offsets);
+			}
+		}
+	}
+
+	/*! \brief Interpolate particles to mesh applying inte_op on every stencil point
+	 *
+	 * \tparam inte_op p2m operation on a stencil point (inte_template or inte_template_multi)
+	 *
+	 * \param vd particle set
+	 * \param gd grid or mesh
+	 *
+	 */
+	template<typename inte_op> void p2m_op(vector & vd, grid & gd)
+	{
+		NUMERICS_TRACE_SPAN("interpolate.p2m");
+
+#ifdef SE_CLASS1
+
+		if (!vd.getDecomposition().is_equal_ng(gd.getDecomposition()) )
+		{
+			std::cerr << __FILE__ << ":" << __LINE__ << " Error: the distribution of the vector of particles" <<
+					" and the grid is different. In order to interpolate the two data structure must have the" <<
+					" same decomposition (interpolate_dec in interpolation_dec.hpp does not)" << std::endl;
+
+			ACTION_ON_ERROR(INTERPOLATION_ERROR_OBJECT)
+		}
+
+#endif
+
+		bool cached = is_stencil_cached(vd);
+
+#ifdef _OPENMP
+		if (omp_get_max_threads() > 1)
+		{
+			p2m_parallel<inte_op>(vd,gd,cached);
+			return;
+		}
+#endif
+
+		if (cached == true)
+		{
+			for (size_t i = 0 ; i < vd.size_local() ; i++)
+			{inte_cached<inte_op>(i,vd,gd);}
+
+			return;
+		}
+
+		vect_dist_key_dx keys[inte_block];
+		size_t n = 0;
+
+		auto it = vd.getDomainIterator();
+
+		while (it.isNext() == true)
+		{
+			keys[n] = it.get();
+			n++;
+
+			if (n == inte_block)
+			{
+				inte_calc_impl<vector,kernel>::template inte_calc_block<inte_op,openfpm::math::pow(kernel::np,vector::dims)>(keys,n,vd,domain,gd,dx,sz,geo_cell,offsets);
+				n = 0;
+			}
+
+			++it;
+		}
+
+		inte_calc_impl<vector,kernel>::template inte_calc_block<inte_op,openfpm::math::pow(kernel::np,vector::dims)>(keys,n,vd,domain,gd,dx,sz,geo_cell,offsets);
+	}
+
+	/*! \brief Interpolate mesh to particle applying inte_op on every stencil point
+	 *
+	 * \tparam inte_op m2p operation on a stencil point (inte_template or inte_template_multi)
+	 *
+	 * \param gd grid or mesh
+	 * \param vd particle set
+	 *
+	 */
+	template<typename inte_op> void m2p_op(grid & gd, vector & vd)
+	{
+		NUMERICS_TRACE_SPAN("interpolate.m2p");
+
+#ifdef SE_CLASS1
+
+		if (!vd.getDecomposition().is_equal_ng(gd.getDecomposition()) )
+		{
+			std::cerr << __FILE__ << ":" << __LINE__ << " Error: the distribution of the vector of particles" <<
+					" and the grid is different. In order to interpolate the two data structure must have the" <<
+					" same decomposition (interpolate_dec in interpolation_dec.hpp does not)" << std::endl;
+
+			ACTION_ON_ERROR(INTERPOLATION_ERROR_OBJECT)
+		}
+
+#endif
+
+		// every particle gather from the grid, the blocks of particles are independent
+		long int n_part = vd.size_local();
+		long int n_blocks = (n_part + inte_block - 1) / inte_block;
+
+		if (is_stencil_cached(vd) == true)
+		{
+			#pragma omp parallel for schedule(static)
+			for (long int i = 0 ; i < n_part ; i++)
+			{inte_cached<inte_op>(i,vd,gd);}
+
+			return;
+		}
+
+		#pragma omp parallel for schedule(static)
+		for (long int blk = 0 ; blk < n_blocks ; blk++)
+		{
+			vect_dist_key_dx keys[inte_block];
+			size_t n = 0;
+
+			for (long int i = blk*inte_block ; i < n_part && i < (blk+1)*(long int)inte_block ; i++)
+			{
+				keys[n] = vect_dist_key_dx(i);
+				n++;
+			}
+
+			inte_calc_impl<vector,kernel>::template inte_calc_block<inte_op,openfpm::math::pow(kernel::np,vector::dims)>(keys,n,vd,domain,gd,dx,sz,geo_cell,offsets);
+		}
+	}
+
 	/*! \brief It calculate the interpolation stencil offsets
 	 *
 	 * \param offsets array where to store the linearized offset of the
@@ -600,41 +1220,7 @@ public:
 	interpolate(vector & vd, grid & gd)
 	:vd(vd),gd(gd)
 	{
-		// get the processor bounding box in grid units
-		Box<vector::dims,typename vector::stype> bb = gd.getDecomposition().getProcessorBounds();
-		Box<vector::dims,typename vector::stype> bunit = gd.getDecomposition().getCellDecomposer().getCellBox();
-
-		size_t div[vector::dims];
-
-		for (size_t i = 0 ; i < vector::dims ; i++)
-			div[i] = (bb.getHigh(i) - bb.getLow(i)) / bunit.getHigh(i);
-
-		geo_cell.Initialize(bb,div);
-
-		// Now draw the domain into the cell list
-
-		auto & dec = gd.getDecomposition();
-
-		for (size_t i = 0 ; i < dec.getNSubDomain() ; i++)
-		{
-			const Box<vector::dims,typename vector::stype> & bx = dec.getSubDomain(i);
-
-			// get the cells this box span
-			const grid_key_dx<vector::dims> p1 = geo_cell.getCellGrid(bx.getP1());
-			const grid_key_dx<vector::dims> p2 = geo_cell.getCellGrid(bx.getP2());
-
-			// Get the grid and the sub-iterator
-			auto & gi = geo_cell.getGrid();
-			grid_key_dx_iterator_sub<vector::dims> g_sub(gi,p1,p2);
-
-			// add the box-id to the cell list
-			while (g_sub.isNext())
-			{
-				auto key = g_sub.get();
-				geo_cell.addCell(gi.LinId(key),i);
-				++g_sub;
-			}
-		}
+		initGeoCell<vector>(geo_cell,gd);
 
 		for (size_t i = 0 ; i < vector::dims ; i++)
 		{sz[i] = kernel::np;}
@@ -649,50 +1235,104 @@ public:
 		domain = vd.getDecomposition().getDomain();
 	};
 
-	/*! \brief Interpolate particles to mesh
+	/*! \brief Calculate and store the interpolation stencil of every particle
 	 *
-	 * Most of the time the particle set and the mesh are the same
-	 * as the one used in the constructor. They also can be different
-	 * as soon as they have the same decomposition
+	 * The following p2m and m2p on the whole particle set reuse the sub-domain, the position on the grid
+	 * and the kernel weights of every particle, until the particles are redistributed with map() or
+	 * invalidate_stencil() is called. If the particles are moved without a map, invalidate_stencil() must be
+	 * called explicitly
+	 *
+	 * \code{.cpp}
+
+	   inte.cache_stencil(vd);
+
+	   // multi-stage time integration with static particles
+	   for (size_t stage = 0 ; stage < 4 ; stage++)
+	   {
+	       inte.template m2p<0,0>(gd,vd);
+	       ...
+	       inte.template p2m<1,1>(vd,gd);
+	   }
+
+	 * \endcode
 	 *
-	 * \param gd grid or mesh
 	 * \param vd particle set
 	 *
 	 */
-	template<unsigned int prp_v, unsigned int prp_g> void p2m(vector & vd, grid & gd)
+	void cache_stencil(vector & vd)
 	{
-#ifdef SE_CLASS1
+		long int n_part = vd.size_local();
+		stencils.resize(n_part);
 
-		if (!vd.getDecomposition().is_equal_ng(gd.getDecomposition()) )
+		#pragma omp parallel for schedule(static)
+		for (long int i = 0 ; i < n_part ; i++)
 		{
-			std::cerr << __FILE__ << ":" << __LINE__ << " Error: the distribution of the vector of particles" <<
-					" and the grid is different. In order to interpolate the two data structure must have the" <<
-					" same decomposition" << std::endl;
+			stencil_cache & st = stencils.get(i);
 
-			ACTION_ON_ERROR(INTERPOLATION_ERROR_OBJECT)
+			inte_calc_impl<vector,kernel>::template inte_stencil(vect_dist_key_dx(i),vd,domain,gd,dx,sz,geo_cell,st.sub,st.lin_base,st.a_int);
 		}
 
-#endif
+		stencils_valid = true;
+		stencils_map_ctr = vd.getMapCtr();
+	}
 
-		// point position
-		typename vector::stype xp[vector::dims];
+	//! Discard the cached stencils, the following interpolations calculate the stencils again
+	void invalidate_stencil()
+	{
+		stencils_valid = false;
+		stencils.clear();
+	}
 
-		int ip[vector::dims][kernel::np];
-		typename vector::stype x[vector::dims][kernel::np];
-		typename vector::stype a[vector::dims][kernel::np];
+	/*! \brief Check if the cached stencils can be used for the particle set
+	 *
+	 * \param vd particle set
+	 *
+	 * \return true if the stencils are cached and no map() has been called on vd since cache_stencil
+	 *
+	 */
+	bool is_stencil_cached(vector & vd)
+	{
+		return stencils_valid == true && stencils_map_ctr == vd.getMapCtr() && stencils.size() == vd.size_local();
+	}
 
-		typename vector::stype a_int[openfpm::math::pow(kernel::np,vector::dims)];
+	/*! \brief Interpolate particles to mesh
+	 *
+	 * Most of the time the particle set and the mesh are the same
+	 * as the one used in the constructor. They also can be different
+	 * as soon as they have the same decomposition
+	 *
+	 * \param gd grid or mesh
+	 * \param vd particle set
+	 *
+	 */
+	template<unsigned int prp_v, unsigned int prp_g> void p2m(vector & vd, grid & gd)
+	{
+		p2m_op<inte_template<kernel::np,prp_g,prp_v,inte_p2m>>(vd,gd);
+	}
 
-		auto it = vd.getDomainIterator();
+	/*! \brief Interpolate several properties of the particles to the mesh in one pass
+	 *
+	 * The position of every particle is located and the kernel weights are calculated once for all the
+	 * pairs of properties
+	 *
+	 * \code{.cpp}
 
-		while (it.isNext() == true)
-		{
-			auto key_p = it.get();
+	   interpolate<vector_type,grid_type,mp4_kernel<float>> inte(vd,gd);
 
-			inte_calc_impl<vector,kernel>::template inte_calc<prp_g,prp_v,inte_p2m,openfpm::math::pow(kernel::np,vector::dims)>(key_p,vd,domain,ip,gd,dx,xp,a_int,a,x,sz,geo_cell,offsets);
+	   // same as inte.template p2m<0,0>(vd,gd); inte.template p2m<1,1>(vd,gd);
+	   inte.template p2m_multi<p2m_prp<0,0>,p2m_prp<1,1>>(vd,gd);
 
-			++it;
-		}
+	 * \endcode
+	 *
+	 * \tparam prps pairs of properties p2m_prp<prp_v,prp_g>
+	 *
+	 * \param vd particle set
+	 * \param gd grid or mesh
+	 *
+	 */
+	template<typename ... prps> void p2m_multi(vector & vd, grid & gd)
+	{
+		p2m_op<inte_template_multi<kernel::np,inte_p2m,prps...>>(vd,gd);
 	}
 
 	/*! \brief Interpolate mesh to particle
@@ -707,40 +1347,23 @@ public:
 	 */
 	template<unsigned int prp_g, unsigned int prp_v> void m2p(grid & gd, vector & vd)
 	{
-#ifdef SE_CLASS1
-
-		if (!vd.getDecomposition().is_equal_ng(gd.getDecomposition()) )
-		{
-			std::cerr << __FILE__ << ":" << __LINE__ << " Error: the distribution of the vector of particles" <<
-					" and the grid is different. In order to interpolate the two data structure must have the" <<
-					" same decomposition" << std::endl;
-
-			ACTION_ON_ERROR(INTERPOLATION_ERROR_OBJECT)
-		}
-
-#endif
-
-		// point position
-		typename vector::stype xp[vector::dims];
-
-		int ip[vector::dims][kernel::np];
-		typename vector::stype x[vector::dims][kernel::np];
-		typename vector::stype a[vector::dims][kernel::np];
-
-		//		grid_cpu<vector::dims,aggregate<typename vector::stype>> a_int(sz);
-		//		a_int.setMemory();
-		typename vector::stype a_int[openfpm::math::pow(kernel::np,vector::dims)];
-
-		auto it = vd.getDomainIterator();
-
-		while (it.isNext() == true)
-		{
-			auto key_p = it.get();
-
-			inte_calc_impl<vector,kernel>::template inte_calc<prp_g,prp_v,inte_m2p,openfpm::math::pow(kernel::np,vector::dims)>(key_p,vd,domain,ip,gd,dx,xp,a_int,a,x,sz,geo_cell,offsets);
+		m2p_op<inte_template<kernel::np,prp_g,prp_v,inte_m2p>>(gd,vd);
+	}
 
-			++it;
-		}
+	/*! \brief Interpolate several properties of the mesh to the particles in one pass
+	 *
+	 * The position of every particle is located and the kernel weights are calculated once for all the
+	 * pairs of properties
+	 *
+	 * \tparam prps pairs of properties m2p_prp<prp_g,prp_v>
+	 *
+	 * \param gd grid or mesh
+	 * \param vd particle set
+	 *
+	 */
+	template<typename ... prps> void m2p_multi(grid & gd, vector & vd)
+	{
+		m2p_op<inte_template_multi<kernel::np,inte_m2p,prps...>>(gd,vd);
 	}
 
 
@@ -763,7 +1386,7 @@ public:
 		{
 			std::cerr << __FILE__ << ":" << __LINE__ << " Error: the distribution of the vector of particles" <<
 					" and the grid is different. In order to interpolate the two data structure must have the" <<
-					" same decomposition" << std::endl;
+					" same decomposition (interpolate_dec in interpolation_dec.hpp does not)" << std::endl;
 
 			ACTION_ON_ERROR(INTERPOLATION_ERROR_OBJECT)
 		}
@@ -802,7 +1425,7 @@ public:
 		{
 			std::cerr << __FILE__ << ":" << __LINE__ << " Error: the distribution of the vector of particles" <<
 					" and the grid is different. In order to interpolate the two data structure must have the" <<
-					" same decomposition" << std::endl;
+					" same decomposition (interpolate_dec in interpolation_dec.hpp does not)" << std::endl;
 
 			ACTION_ON_ERROR(INTERPOLATION_ERROR_OBJECT)
 		}
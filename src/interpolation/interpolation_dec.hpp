@@ -0,0 +1,217 @@
+/*
+ * interpolation_dec.hpp
+ *
+ *  Interpolation between a particle set and a grid with different decompositions
+ */
+
+#ifndef OPENFPM_NUMERICS_SRC_INTERPOLATION_INTERPOLATION_DEC_HPP_
+#define OPENFPM_NUMERICS_SRC_INTERPOLATION_INTERPOLATION_DEC_HPP_
+
+#include "interpolation.hpp"
+#include "Vector/vector_dist.hpp"
+#include "Grid/grid_dist_id.hpp"
+
+/*! \brief Add a property at the end of an aggregate
+ *
+ * \tparam agg aggregate
+ * \tparam T type of the property to add
+ *
+ */
+template<typename agg, typename T>
+struct inte_append_prop;
+
+//! Add a property at the end of an aggregate
+template<typename ... prp, typename T>
+struct inte_append_prop<aggregate<prp...>,T>
+{
+	//! aggregate with the property added
+	typedef aggregate<prp...,T> type;
+};
+
+/*! \brief Copy the properties prp of the particle i of src into the particle j of dst
+ *
+ * The two vectors must have the same types for the properties prp
+ *
+ */
+template<unsigned int ... prp, typename vector_src, typename vector_dst>
+inline void inte_copy_props(vector_src & src, size_t i, vector_dst & dst, size_t j)
+{
+	int dummy[] = {0, (meta_copy<typename boost::mpl::at<typename vector_src::value_type::type,boost::mpl::int_<prp>>::type>::meta_copy_(src.template getProp<prp>(i),dst.template getProp<prp>(j)),0)...};
+	(void)dummy;
+}
+
+/*! \brief Interpolation between a particle set and a grid that do not have the same decomposition
+ *
+ * interpolate requires the same decomposition for the particles and the grid. Here the particles are copied
+ * in a particle set with the decomposition of the grid and redistributed with map(): only the particles that
+ * are not in the domain of their processor on the grid decomposition are sent, the others stay on the processor.
+ * p2m interpolates the copied particles on the grid. m2p interpolates the grid on the copied particles and sends
+ * back the values with a map() on the decomposition of the particles, every value is then written in its
+ * particle from its local index.
+ *
+ * \code{.cpp}
+
+   // the grid has its own decomposition
+   grid_dist_id<2,double,aggregate<double>> gd(sz,domain,gg,bc);
+
+   interpolate_dec<decltype(vd),decltype(gd),mp4_kernel<double>> inte(vd,gd);
+
+   inte.template p2m<0,0>(vd,gd);
+   gd.template ghost_put<add_,0>();
+
+ * \endcode
+ *
+ * \tparam vector type of vector for interpolation
+ * \tparam grid type of grid for interpolation
+ * \tparam interpolation kernel
+ *
+ */
+template<typename vector, typename grid, typename kernel>
+class interpolate_dec
+{
+	//! Decomposition of the grid
+	typedef typename std::remove_const<typename std::remove_reference<decltype(std::declval<grid &>().getDecomposition())>::type>::type grid_dec_type;
+
+	//! Decomposition of the particles
+	typedef typename std::remove_const<typename std::remove_reference<decltype(std::declval<vector &>().getDecomposition())>::type>::type vector_dec_type;
+
+	//! property with the local index of the particle in the original particle set
+	static constexpr unsigned int prp_id = vector::value_type::max_prop;
+
+	//! properties of the copies, the ones of the particles and the local index
+	typedef typename inte_append_prop<typename vector::value_type,size_t>::type prop_copy;
+
+	//! Copies of the particles on the decomposition of the grid
+	typedef vector_dist<vector::dims,typename vector::stype,prop_copy,grid_dec_type> vector_g_type;
+
+	//! Copies of the particles on the decomposition of the particles
+	typedef vector_dist<vector::dims,typename vector::stype,prop_copy,vector_dec_type> vector_v_type;
+
+	//! Copies of the particles on the decomposition of the grid
+	vector_g_type vd_g;
+
+	//! Copies of the particles sent back to the decomposition of the particles (m2p)
+	vector_v_type vd_v;
+
+	//! interpolation between the copies and the grid (same decomposition)
+	interpolate<vector_g_type,grid,kernel> inte;
+
+	/*! \brief Copy the particles with the properties prp on the decomposition of the grid
+	 *
+	 * \param vd particle set
+	 *
+	 */
+	template<unsigned int ... prp> void to_grid_dec(vector & vd)
+	{
+		vd_g.clear();
+
+		for (size_t i = 0 ; i < vd.size_local() ; i++)
+		{
+			vd_g.add();
+
+			for (size_t k = 0 ; k < vector::dims ; k++)
+			{vd_g.getLastPos()[k] = vd.getPos(i)[k];}
+
+			vd_g.template getLastProp<prp_id>() = i;
+			inte_copy_props<prp...>(vd,i,vd_g,vd_g.size_local() - 1);
+		}
+
+		vd_g.map();
+	}
+
+	/*! \brief Send back the properties prp of the copies and write them in the particles
+	 *
+	 * \param vd particle set
+	 *
+	 */
+	template<unsigned int ... prp> void to_vector_dec(vector & vd)
+	{
+		vd_v.clear();
+
+		for (size_t i = 0 ; i < vd_g.size_local() ; i++)
+		{
+			vd_v.add();
+
+			for (size_t k = 0 ; k < vector::dims ; k++)
+			{vd_v.getLastPos()[k] = vd_g.getPos(i)[k];}
+
+			vd_v.template getLastProp<prp_id>() = vd_g.template getProp<prp_id>(i);
+			inte_copy_props<prp...>(vd_g,i,vd_v,vd_v.size_local() - 1);
+		}
+
+		vd_v.map();
+
+		for (size_t i = 0 ; i < vd_v.size_local() ; i++)
+		{inte_copy_props<prp...>(vd_v,i,vd,vd_v.template getProp<prp_id>(i));}
+	}
+
+public:
+
+	/*! \brief construct an interpolation object between a grid and a vector
+	 *
+	 * \param vd interpolation vector
+	 * \param gd interpolation grid
+	 *
+	 */
+	interpolate_dec(vector & vd, grid & gd)
+	:vd_g(gd.getDecomposition(),0),vd_v(vd.getDecomposition(),0),inte(vd_g,gd)
+	{}
+
+	/*! \brief Interpolate particles to mesh
+	 *
+	 * \param vd particle set
+	 * \param gd grid or mesh
+	 *
+	 */
+	template<unsigned int prp_v, unsigned int prp_g> void p2m(vector & vd, grid & gd)
+	{
+		to_grid_dec<prp_v>(vd);
+		inte.template p2m<prp_v,prp_g>(vd_g,gd);
+	}
+
+	/*! \brief Interpolate several properties of the particles to the mesh in one pass
+	 *
+	 * \tparam prps pairs of properties p2m_prp<prp_v,prp_g>
+	 *
+	 * \param vd particle set
+	 * \param gd grid or mesh
+	 *
+	 */
+	template<typename ... prps> void p2m_multi(vector & vd, grid & gd)
+	{
+		to_grid_dec<prps::prp_v...>(vd);
+		inte.template p2m_multi<prps...>(vd_g,gd);
+	}
+
+	/*! \brief Interpolate mesh to particle
+	 *
+	 * As for interpolate the values are added to the property of the particles
+	 *
+	 * \param gd grid or mesh
+	 * \param vd particle set
+	 *
+	 */
+	template<unsigned int prp_g, unsigned int prp_v> void m2p(grid & gd, vector & vd)
+	{
+		to_grid_dec<prp_v>(vd);
+		inte.template m2p<prp_g,prp_v>(gd,vd_g);
+		to_vector_dec<prp_v>(vd);
+	}
+
+	/*! \brief Interpolate several properties of the mesh to the particles in one pass
+	 *
+	 * \tparam prps pairs of properties m2p_prp<prp_g,prp_v>
+	 *
+	 * \param gd grid or mesh
+	 * \param vd particle set
+	 *
+	 */
+	template<typename ... prps> void m2p_multi(grid & gd, vector & vd)
+	{
+		to_grid_dec<prps::prp_v...>(vd);
+		inte.template m2p_multi<prps...>(gd,vd_g);
+		to_vector_dec<prps::prp_v...>(vd);
+	}
+};
+
+#endif /* OPENFPM_NUMERICS_SRC_INTERPOLATION_INTERPOLATION_DEC_HPP_ */
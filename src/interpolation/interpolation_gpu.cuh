@@ -0,0 +1,307 @@
+/*
+ * interpolation_gpu.cuh
+ *
+ *  Particle to mesh (p2m) and mesh to particle (m2p) interpolation on the device
+ */
+
+#ifndef OPENFPM_NUMERICS_SRC_INTERPOLATION_INTERPOLATION_GPU_CUH_
+#define OPENFPM_NUMERICS_SRC_INTERPOLATION_INTERPOLATION_GPU_CUH_
+
+#if defined(__NVCC__)
+
+#include "interpolation.hpp"
+#include "Vector/vector_dist.hpp"
+#include "Grid/grid_dist_id.hpp"
+
+/*! \brief Accumulate coeff * src on the device for several property types
+ *
+ * p2m use atomics (several particles scatter on the same grid point), m2p a plain accumulation (every particle
+ * gather on its own property)
+ *
+ * \tparam T type of the property
+ *
+ */
+template<typename T>
+struct mul_inte_gpu
+{
+	template<typename r_type, typename c_type, typename s_type>
+	__device__ static inline void p2m(r_type && result, const c_type & coeff, s_type && src)
+	{
+		atomicAdd(&result, coeff * src);
+	}
+
+	template<typename r_type, typename c_type, typename s_type>
+	__device__ static inline void m2p(r_type && result, const c_type & coeff, s_type && src)
+	{
+		result += coeff * src;
+	}
+};
+
+/*! \brief Accumulate coeff * src on the device for vector properties
+ *
+ * \tparam T type of the components
+ * \tparam N1 number of components
+ *
+ */
+template<typename T, unsigned int N1>
+struct mul_inte_gpu<T[N1]>
+{
+	template<typename r_type, typename c_type, typename s_type>
+	__device__ static inline void p2m(r_type && result, const c_type & coeff, s_type && src)
+	{
+		for (unsigned int i = 0 ; i < N1 ; i++)
+		{atomicAdd(&result[i], coeff * src[i]);}
+	}
+
+	template<typename r_type, typename c_type, typename s_type>
+	__device__ static inline void m2p(r_type && result, const c_type & coeff, s_type && src)
+	{
+		for (unsigned int i = 0 ; i < N1 ; i++)
+		{result[i] += coeff * src[i];}
+	}
+};
+
+/*! \brief Find the sub-domain of every particle (as getSub, the closest sub-domain if the particle is in none)
+ *
+ * \param vd particles (kernel view)
+ * \param boxes sub-domains, low and high corner
+ * \param n_sub number of sub-domains
+ * \param part_sub sub-domain of every particle
+ *
+ */
+template<unsigned int dim, typename T, typename vector_type, typename boxes_type, typename sub_type>
+__global__ void inte_gpu_sub_ker(vector_type vd, boxes_type boxes, int n_sub, sub_type part_sub)
+{
+	auto p = GET_PARTICLE(vd);
+
+	int best_sub = 0;
+	T best_tot_dx = -1.0;
+
+	for (int s = 0 ; s < n_sub ; s++)
+	{
+		T tot_dx = 0.0;
+		bool inside = true;
+
+		for (unsigned int d = 0 ; d < dim ; d++)
+		{
+			T x = vd.getPos(p)[d];
+			T low = boxes.template get<0>(s)[d];
+			T high = boxes.template get<1>(s)[d];
+
+			if (low > x)
+			{tot_dx += 2*(low - x); inside = false;}
+			else if (high <= x)
+			{tot_dx += 2*(x - high); inside = false;}
+		}
+
+		if (inside == true)
+		{
+			best_sub = s;
+			break;
+		}
+
+		if (best_tot_dx < 0.0 || tot_dx < best_tot_dx)
+		{
+			best_tot_dx = tot_dx;
+			best_sub = s;
+		}
+	}
+
+	part_sub.template get<0>(p) = best_sub;
+}
+
+/*! \brief Interpolate the particles of one sub-domain, one thread per particle
+ *
+ * \tparam m2p_or_p2m inte_m2p (gather) or inte_p2m (atomic scatter)
+ *
+ * \param vd particles (kernel view)
+ * \param g local grid of the sub-domain (kernel view)
+ * \param part_sub sub-domain of every particle
+ * \param sub sub-domain to interpolate
+ * \param origin origin of the local grid in the global grid
+ * \param low low corner of the simulation domain
+ * \param dx inverse of the grid spacing
+ *
+ */
+template<unsigned int dim, unsigned int prp_g, unsigned int prp_v, unsigned int m2p_or_p2m, typename kernel, typename T,
+         typename prop_type, typename vector_type, typename grid_type, typename sub_type>
+__global__ void inte_gpu_ker(vector_type vd, grid_type g, sub_type part_sub, int sub, grid_key_dx<dim,int> origin,
+                             Point<dim,T> low, Point<dim,T> dx)
+{
+	auto p = GET_PARTICLE(vd);
+
+	if (part_sub.template get<0>(p) != sub)	{return;}
+
+	T x[dim][kernel::np];
+	T a[dim][kernel::np];
+	grid_key_dx<dim,int> base;
+
+	// same stencil and weights of inte_calc_impl
+	for (unsigned int d = 0 ; d < dim ; d++)
+	{
+		T x0 = (vd.getPos(p)[d] - low.get(d))*dx.get(d);
+		int ip = (int)x0;
+		T xp = x0 - ip;
+
+		base.set_d(d,ip - origin.get(d) - (int)kernel::np/2 + 1);
+
+		for (int j = 0 ; j < kernel::np ; j++)
+		{x[d][j] = - xp + T(j - (int)kernel::np/2 + 1);}
+
+		kernel_weights<kernel,T>::value(x[d],a[d]);
+	}
+
+	for (unsigned int k = 0 ; k < openfpm::math::pow(kernel::np,dim) ; k++)
+	{
+		grid_key_dx<dim,int> key;
+		T w = 1;
+		unsigned int r = k;
+
+		for (unsigned int d = 0 ; d < dim ; d++)
+		{
+			unsigned int j = r % kernel::np;
+			r /= kernel::np;
+
+			key.set_d(d,base.get(d) + j);
+			w *= a[d][j];
+		}
+
+		if (m2p_or_p2m == inte_p2m)
+		{mul_inte_gpu<prop_type>::p2m(g.template get<prp_g>(key),w,vd.template getProp<prp_v>(p));}
+		else
+		{mul_inte_gpu<prop_type>::m2p(vd.template getProp<prp_v>(p),w,g.template get<prp_g>(key));}
+	}
+}
+
+/*! \brief Interpolation particle to mesh (p2m) and mesh to particle (m2p) on the device
+ *
+ * Same interface and same stencils of interpolate, the properties are read and written on the device copy of the
+ * particles and of the local grids. m2p is a gather (one thread per particle), p2m scatter with atomic additions.
+ * The kernel must be usable on the device (mp4_kernel and z_kernel)
+ *
+ * \tparam vector type of vector for interpolation (GPU vector_dist)
+ * \tparam grid type of grid for interpolation (grid_dist_id with GPU local grids)
+ * \tparam kernel interpolation kernel
+ *
+ */
+template<typename vector, typename grid, typename kernel>
+class interpolate_gpu
+{
+	//! Type of the calculations
+	typedef typename vector::stype T;
+
+	//! dimensionality
+	static const unsigned int dims = vector::dims;
+
+	//! particles
+	vector & vd;
+
+	//! grid
+	grid & gd;
+
+	//! sub-domains of the decomposition (low and high corner)
+	openfpm::vector_gpu<aggregate<T[dims],T[dims]>> sub_boxes;
+
+	//! sub-domain of every particle
+	openfpm::vector_gpu<aggregate<int>> part_sub;
+
+	//! low corner of the simulation domain
+	Point<dims,T> low;
+
+	//! inverse of the grid spacing
+	Point<dims,T> dx;
+
+	/*! \brief Interpolate, one kernel launch per sub-domain
+	 *
+	 * \param vd particle set
+	 * \param gd grid
+	 *
+	 */
+	template<unsigned int prp_g, unsigned int prp_v, unsigned int m2p_or_p2m> void run(vector & vd, grid & gd)
+	{
+		if (vd.size_local() == 0)	{return;}
+
+		typedef typename boost::mpl::at<typename grid::value_type::type,boost::mpl::int_<prp_g>>::type prop_type;
+
+		part_sub.resize(vd.size_local());
+
+		auto ite = vd.getDomainIteratorGPU();
+		CUDA_LAUNCH((inte_gpu_sub_ker<dims,T>),ite,vd.toKernel(),sub_boxes.toKernel(),(int)sub_boxes.size(),part_sub.toKernel());
+
+		auto & patches = gd.getLocalGridsInfo();
+
+		for (size_t i = 0 ; i < patches.size() ; i++)
+		{
+			grid_key_dx<dims,int> origin;
+			for (unsigned int d = 0 ; d < dims ; d++)	{origin.set_d(d,patches.get(i).origin[d]);}
+
+			CUDA_LAUNCH((inte_gpu_ker<dims,prp_g,prp_v,m2p_or_p2m,kernel,T,prop_type>),ite,vd.toKernel(),gd.get_loc_grid(i).toKernel(),
+			            part_sub.toKernel(),(int)i,origin,low,dx);
+		}
+	}
+
+public:
+
+	/*! \brief construct an interpolation object between a GPU grid and a GPU vector
+	 *
+	 * \param vd interpolation vector
+	 * \param gd interpolation grid
+	 *
+	 */
+	interpolate_gpu(vector & vd, grid & gd)
+	:vd(vd),gd(gd)
+	{
+		auto & dec = gd.getDecomposition();
+
+		sub_boxes.resize(dec.getNSubDomain());
+		for (size_t i = 0 ; i < dec.getNSubDomain() ; i++)
+		{
+			const Box<dims,T> & bx = dec.getSubDomain(i);
+
+			for (unsigned int d = 0 ; d < dims ; d++)
+			{
+				sub_boxes.template get<0>(i)[d] = bx.getLow(d);
+				sub_boxes.template get<1>(i)[d] = bx.getHigh(d);
+			}
+		}
+		sub_boxes.template hostToDevice<0,1>();
+
+		Box<dims,T> domain = vd.getDecomposition().getDomain();
+
+		for (unsigned int d = 0 ; d < dims ; d++)
+		{
+			low.get(d) = domain.getLow(d);
+			dx.get(d) = 1.0/gd.spacing(d);
+		}
+	}
+
+	/*! \brief Interpolate particles to mesh on the device
+	 *
+	 * The grid points are accumulated (the grid must be reset before), a ghost_put is needed as for interpolate
+	 *
+	 * \param vd particle set
+	 * \param gd grid or mesh
+	 *
+	 */
+	template<unsigned int prp_v, unsigned int prp_g> void p2m(vector & vd, grid & gd)
+	{
+		run<prp_g,prp_v,inte_p2m>(vd,gd);
+	}
+
+	/*! \brief Interpolate mesh to particle on the device
+	 *
+	 * The particle properties are accumulated (they must be reset before), the grid ghost must be updated before
+	 *
+	 * \param gd grid or mesh
+	 * \param vd particle set
+	 *
+	 */
+	template<unsigned int prp_g, unsigned int prp_v> void m2p(grid & gd, vector & vd)
+	{
+		run<prp_g,prp_v,inte_m2p>(vd,gd);
+	}
+};
+
+#endif
+
+#endif /* OPENFPM_NUMERICS_SRC_INTERPOLATION_INTERPOLATION_GPU_CUH_ */
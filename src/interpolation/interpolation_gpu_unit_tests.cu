@@ -0,0 +1,91 @@
+//
+// Tests of the device p2m and m2p
+//
+
+#define BOOST_TEST_DYN_LINK
+#include <boost/test/unit_test.hpp>
+
+#include "interpolation/mp4_kernel.hpp"
+#include "interpolation/interpolation_gpu.cuh"
+
+BOOST_AUTO_TEST_SUITE( interpolation_gpu_test )
+
+BOOST_AUTO_TEST_CASE( interpolation_gpu_p2m_m2p_2D )
+{
+	Box<2,double> domain({0.0,0.0},{1.0,1.0});
+	size_t sz[2] = {64,64};
+
+	Ghost<2,long int> gg(3);
+	Ghost<2,double> gv(0.01);
+
+	size_t bc_v[2] = {PERIODIC,PERIODIC};
+
+	typedef vector_dist_gpu<2,double,aggregate<double,double,double>> vector_type;
+	typedef aggregate<double,double> g_props;
+	typedef grid_dist_id<2,double,g_props,CartDecomposition<2,double,CudaMemory,memory_traits_inte>,CudaMemory,grid_gpu<2,g_props>> grid_type;
+
+	vector_type vd(4096,domain,bc_v,gv);
+	grid_type gd(vd.getDecomposition(),sz,gg);
+
+	auto it = vd.getDomainIterator();
+	while (it.isNext())
+	{
+		auto p = it.get();
+
+		vd.getPos(p)[0] = (double)rand()/RAND_MAX;
+		vd.getPos(p)[1] = (double)rand()/RAND_MAX;
+
+		vd.getProp<0>(p) = (double)rand()/RAND_MAX;
+		vd.getProp<1>(p) = 0.0;
+		vd.getProp<2>(p) = 0.0;
+
+		++it;
+	}
+
+	vd.map();
+
+	auto it2 = gd.getDomainGhostIterator();
+	while (it2.isNext())
+	{
+		auto key = it2.get();
+		gd.get<0>(key) = 0.0;
+		gd.get<1>(key) = 0.0;
+		++it2;
+	}
+
+	vd.hostToDeviceProp<0,1,2>();
+	vd.hostToDevicePos();
+	gd.template hostToDevice<0,1>();
+
+	interpolate<vector_type,grid_type,mp4_kernel<double>> inte(vd,gd);
+	interpolate_gpu<vector_type,grid_type,mp4_kernel<double>> inte_gpu(vd,gd);
+
+	// p2m on the host in property 0, on the device in property 1
+	inte.p2m<0,0>(vd,gd);
+	inte_gpu.p2m<0,1>(vd,gd);
+	gd.template deviceToHost<1>();
+
+	auto it3 = gd.getDomainGhostIterator();
+	while (it3.isNext())
+	{
+		auto key = it3.get();
+		BOOST_REQUIRE_SMALL(gd.get<0>(key) - gd.get<1>(key), 1e-12);
+		++it3;
+	}
+
+	// m2p of the interpolated field, on the host in property 1, on the device in property 2
+	gd.template hostToDevice<0>();
+	inte.m2p<0,1>(gd,vd);
+	inte_gpu.m2p<0,2>(gd,vd);
+	vd.deviceToHostProp<2>();
+
+	auto it4 = vd.getDomainIterator();
+	while (it4.isNext())
+	{
+		auto p = it4.get();
+		BOOST_REQUIRE_SMALL(vd.getProp<1>(p) - vd.getProp<2>(p), 1e-12);
+		++it4;
+	}
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,229 @@
+/*
+ * interpolation_sparse.hpp
+ *
+ *  Interpolation between a particle set and a sparse grid (sgrid_dist_id)
+ */
+
+#ifndef OPENFPM_NUMERICS_SRC_INTERPOLATION_INTERPOLATION_SPARSE_HPP_
+#define OPENFPM_NUMERICS_SRC_INTERPOLATION_INTERPOLATION_SPARSE_HPP_
+
+#include "interpolation.hpp"
+#include "Vector/vector_dist.hpp"
+#include "Grid/grid_dist_id.hpp"
+
+//! Particle filter of interpolate_sparse that accepts all the particles
+struct inte_all_particles
+{
+	//! accept the particle
+	template<typename vector> inline bool operator()(vector & vd, const vect_dist_key_dx & p) const
+	{
+		return true;
+	}
+};
+
+/*! \brief Interpolation between a particle set and a sparse grid
+ *
+ * p2m inserts the stencil points of the particles in the sparse grid, so only the chunks around the particles are
+ * allocated. m2p reads the sparse grid, the points that have not been inserted have the background value. A filter
+ * selects the particles to interpolate, for example the ones close to an interface, the other particles are skipped
+ * (not located). The particle set and the sparse grid must have the same decomposition, as for interpolate.
+ *
+ * \code{.cpp}
+
+   sgrid_dist_id<2,double,aggregate<double>> sg(vd.getDecomposition(),sz,gg);
+
+   interpolate_sparse<decltype(vd),decltype(sg),mp4_kernel<double>> inte(vd,sg);
+
+   // only the particles in a band of width 0.1 around the zero level set of the property 0
+   auto band = [](decltype(vd) & vd, const vect_dist_key_dx & p){return fabs(vd.template getProp<0>(p)) < 0.1;};
+
+   inte.template p2m<1,0>(vd,sg,band);
+   sg.template ghost_put<add_,0>();
+
+ * \endcode
+ *
+ * \tparam vector type of vector for interpolation
+ * \tparam sgrid type of sparse grid for interpolation
+ * \tparam interpolation kernel
+ *
+ */
+template<typename vector, typename sgrid, typename kernel>
+class interpolate_sparse
+{
+	//! Type of the calculations
+	typedef typename vector::stype arr_type;
+
+	//! number of points of the stencil
+	static constexpr unsigned int np_a_int = openfpm::math::pow(kernel::np,vector::dims);
+
+	//! Cell list used to convert particles position to sub-domain
+	CellList<vector::dims,typename vector::stype,Mem_fast<>,shift<vector::dims,typename vector::stype>> geo_cell;
+
+	//! offset of the stencil points from the first one, in the order of the coefficients
+	grid_key_dx<vector::dims> stencil[np_a_int];
+
+	//! kernel size
+	size_t sz[vector::dims];
+
+	//! inverse of the grid spacing
+	typename vector::stype dx[vector::dims];
+
+	//! Simulation domain
+	Box<vector::dims,typename vector::stype> domain;
+
+	/*! \brief Find the sub-domain, the first stencil point and the coefficients of a particle
+	 *
+	 * \param key_p particle
+	 * \param vd particle set
+	 * \param gd sparse grid
+	 * \param base first stencil point in the local grid
+	 * \param a_int coefficients on the stencil points
+	 *
+	 * \return the sub-domain
+	 *
+	 */
+	size_t locate(const vect_dist_key_dx & key_p, vector & vd, sgrid & gd, grid_key_dx<vector::dims> & base, arr_type (& a_int)[np_a_int])
+	{
+		Point<vector::dims,typename vector::stype> p = vd.getPos(key_p);
+
+		size_t sub = getSub<vector>(p,geo_cell,gd);
+
+		arr_type x[vector::dims][kernel::np];
+		arr_type a[vector::dims][kernel::np];
+
+		for (size_t i = 0 ; i < vector::dims ; i++)
+		{
+			arr_type x0 = (p.get(i)-domain.getLow(i))*dx[i];
+			int ip = (int)x0;
+
+			base.set_d(i,ip - gd.getLocalGridsInfo().get(sub).origin.get(i) - (long int)kernel::np/2 + 1);
+
+			for (long int j = 0 ; j < kernel::np ; j++)
+			{x[i][j] = - (x0 - ip) + arr_type(j - (long int)kernel::np/2 + 1);}
+
+			kernel_weights<kernel,arr_type>::value(x[i],a[i]);
+		}
+
+		calculate_aint<vector::dims,vector,kernel::np>::value(sz,a_int,a);
+
+		return sub;
+	}
+
+public:
+
+	/*! \brief construct an interpolation object between a sparse grid and a vector
+	 *
+	 * \param vd interpolation vector
+	 * \param gd interpolation sparse grid
+	 *
+	 */
+	interpolate_sparse(vector & vd, sgrid & gd)
+	{
+		initGeoCell<vector>(geo_cell,gd);
+
+		for (size_t i = 0 ; i < vector::dims ; i++)
+		{sz[i] = kernel::np;}
+
+		grid_sm<vector::dims,void> gs(sz);
+		grid_key_dx_iterator<vector::dims> kit(gs);
+
+		size_t k = 0;
+		while (kit.isNext())
+		{
+			stencil[k] = kit.get();
+			++k;
+			++kit;
+		}
+
+		for (size_t i = 0 ; i < vector::dims ; i++)
+		{dx[i] = 1.0/gd.spacing(i);}
+
+		domain = vd.getDecomposition().getDomain();
+	}
+
+	/*! \brief Interpolate particles to the sparse grid, the stencil points are inserted
+	 *
+	 * The ghost contributions must be added with ghost_put<add_,prp_g>
+	 *
+	 * \tparam prp_v property of the particles
+	 * \tparam prp_g property of the sparse grid
+	 *
+	 * \param vd particle set
+	 * \param gd sparse grid
+	 * \param filter functor (vd,p) returning true for the particles to interpolate
+	 *
+	 */
+	template<unsigned int prp_v, unsigned int prp_g, typename filter_type = inte_all_particles>
+	void p2m(vector & vd, sgrid & gd, filter_type filter = filter_type())
+	{
+		NUMERICS_TRACE_SPAN("interpolate_sparse.p2m");
+
+		grid_key_dx<vector::dims> base;
+		arr_type a_int[np_a_int];
+
+		auto it = vd.getDomainIterator();
+
+		while (it.isNext())
+		{
+			auto p = it.get();
+
+			if (filter(vd,p) == true)
+			{
+				size_t sub = locate(p,vd,gd,base,a_int);
+
+				for (size_t k = 0 ; k < np_a_int ; k++)
+				{
+					grid_dist_key_dx<vector::dims> key(sub,base + stencil[k]);
+
+					mul_inte<typename std::remove_const<typename std::remove_reference<decltype(gd.template insert<prp_g>(key))>::type>::type>::value(gd.template insert<prp_g>(key),a_int[k],vd.template getProp<prp_v>(p));
+				}
+			}
+
+			++it;
+		}
+	}
+
+	/*! \brief Interpolate the sparse grid to the particles
+	 *
+	 * The ghost of the sparse grid must be updated with ghost_get<prp_g>, the values are added to the
+	 * property of the particles
+	 *
+	 * \tparam prp_g property of the sparse grid
+	 * \tparam prp_v property of the particles
+	 *
+	 * \param gd sparse grid
+	 * \param vd particle set
+	 * \param filter functor (vd,p) returning true for the particles to interpolate
+	 *
+	 */
+	template<unsigned int prp_g, unsigned int prp_v, typename filter_type = inte_all_particles>
+	void m2p(sgrid & gd, vector & vd, filter_type filter = filter_type())
+	{
+		NUMERICS_TRACE_SPAN("interpolate_sparse.m2p");
+
+		long int n_part = vd.size_local();
+
+		#pragma omp parallel for schedule(static)
+		for (long int i = 0 ; i < n_part ; i++)
+		{
+			vect_dist_key_dx p(i);
+
+			if (filter(vd,p) == false)
+			{continue;}
+
+			grid_key_dx<vector::dims> base;
+			arr_type a_int[np_a_int];
+
+			size_t sub = locate(p,vd,gd,base,a_int);
+
+			for (size_t k = 0 ; k < np_a_int ; k++)
+			{
+				grid_dist_key_dx<vector::dims> key(sub,base + stencil[k]);
+
+				mul_inte<typename std::remove_const<typename std::remove_reference<decltype(gd.template get<prp_g>(key))>::type>::type>::value(vd.template getProp<prp_v>(p),a_int[k],gd.template get<prp_g>(key));
+			}
+		}
+	}
+};
+
+#endif /* OPENFPM_NUMERICS_SRC_INTERPOLATION_INTERPOLATION_SPARSE_HPP_ */
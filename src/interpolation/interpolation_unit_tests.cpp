@@ -15,6 +15,9 @@
 #include "interpolation/lambda_kernel.hpp"
 #include "interpolation/z_spline.hpp"
 #include "interpolation.hpp"
+#include "interpolation/remesh.hpp"
+#include "interpolation/interpolation_dec.hpp"
+#include "interpolation/interpolation_sparse.hpp"
 #include <boost/math/special_functions/pow.hpp>
 #include <Vector/vector_dist.hpp>
 #include <Operators/Vector/vector_dist_operators.hpp>
@@ -992,6 +995,578 @@ BOOST_AUTO_TEST_CASE( int_kernel_test_double)
 }
 
 /*
+template<typename kernel> void check_kernel_weights()
+{
+	double x[kernel::np];
+	double a[kernel::np];
+
+	for (size_t t = 0 ; t < 100 ; t++)
+	{
+		double xp = t / 100.0;
+
+		for (long int j = 0 ; j < kernel::np ; j++)
+		{x[j] = - xp + double(j - (long int)kernel::np/2 + 1);}
+
+		kernel_weights<kernel,double>::value(x,a);
+
+		for (size_t j = 0 ; j < kernel::np ; j++)
+		{BOOST_REQUIRE_EQUAL(a[j],kernel::value(x[j],j));}
+	}
+}
+
+BOOST_AUTO_TEST_CASE( interpolation_p2m_threads_test_2D )
+{
+#ifdef _OPENMP
+	Box<2,double> domain({0.0,0.0},{1.0,1.0});
+	size_t sz[2] = {64,64};
+
+	Ghost<2,long int> gg(3);
+	Ghost<2,double> gv(0.01);
+
+	size_t bc_v[2] = {PERIODIC,PERIODIC};
+
+	vector_dist<2,double,aggregate<double>> vd(4096,domain,bc_v,gv);
+	grid_dist_id<2,double,aggregate<double,double>> gd(vd.getDecomposition(),sz,gg);
+
+	auto it = vd.getDomainIterator();
+
+	while (it.isNext())
+	{
+		auto p = it.get();
+
+		vd.getPos(p)[0] = (double)rand()/RAND_MAX;
+		vd.getPos(p)[1] = (double)rand()/RAND_MAX;
+
+		vd.getProp<0>(p) = (double)rand()/RAND_MAX;
+
+		++it;
+	}
+
+	vd.map();
+
+	auto it2 = gd.getDomainGhostIterator();
+	while (it2.isNext())
+	{
+		auto key = it2.get();
+		gd.get<0>(key) = 0.0;
+		gd.get<1>(key) = 0.0;
+		++it2;
+	}
+
+	interpolate<decltype(vd),decltype(gd),mp4_kernel<double>> inte(vd,gd);
+
+	// the parallel p2m (binned in slabs) must give the same result of the serial one
+	int n_threads = omp_get_max_threads();
+	omp_set_num_threads(4);
+	inte.p2m<0,0>(vd,gd);
+	omp_set_num_threads(1);
+	inte.p2m<0,1>(vd,gd);
+	omp_set_num_threads(n_threads);
+
+	auto it3 = gd.getDomainGhostIterator();
+	while (it3.isNext())
+	{
+		auto key = it3.get();
+		BOOST_REQUIRE_SMALL(gd.get<0>(key) - gd.get<1>(key), 1e-12);
+		++it3;
+	}
+#endif
+}
+
+BOOST_AUTO_TEST_CASE( interpolation_multi_test_2D )
+{
+	Box<2,double> domain({0.0,0.0},{1.0,1.0});
+	size_t sz[2] = {64,64};
+
+	Ghost<2,long int> gg(3);
+	Ghost<2,double> gv(0.01);
+
+	size_t bc_v[2] = {PERIODIC,PERIODIC};
+
+	vector_dist<2,double,aggregate<double,double[2],double,double[2]>> vd(4096,domain,bc_v,gv);
+	grid_dist_id<2,double,aggregate<double,double[2],double,double[2]>> gd(vd.getDecomposition(),sz,gg);
+
+	auto it = vd.getDomainIterator();
+
+	while (it.isNext())
+	{
+		auto p = it.get();
+
+		vd.getPos(p)[0] = (double)rand()/RAND_MAX;
+		vd.getPos(p)[1] = (double)rand()/RAND_MAX;
+
+		vd.getProp<0>(p) = (double)rand()/RAND_MAX;
+		vd.getProp<1>(p)[0] = (double)rand()/RAND_MAX;
+		vd.getProp<1>(p)[1] = (double)rand()/RAND_MAX;
+
+		++it;
+	}
+
+	vd.map();
+
+	auto it2 = gd.getDomainGhostIterator();
+	while (it2.isNext())
+	{
+		auto key = it2.get();
+		gd.get<0>(key) = 0.0;
+		gd.get<1>(key)[0] = 0.0;
+		gd.get<1>(key)[1] = 0.0;
+		gd.get<2>(key) = 0.0;
+		gd.get<3>(key)[0] = 0.0;
+		gd.get<3>(key)[1] = 0.0;
+		++it2;
+	}
+
+	interpolate<decltype(vd),decltype(gd),mp4_kernel<double>> inte(vd,gd);
+
+	// one pass on two pairs of properties must give the same result of two p2m
+	inte.p2m_multi<p2m_prp<0,0>,p2m_prp<1,1>>(vd,gd);
+	inte.p2m<0,2>(vd,gd);
+	inte.p2m<1,3>(vd,gd);
+
+	auto it3 = gd.getDomainGhostIterator();
+	while (it3.isNext())
+	{
+		auto key = it3.get();
+		BOOST_REQUIRE_EQUAL(gd.get<0>(key),gd.get<2>(key));
+		BOOST_REQUIRE_EQUAL(gd.get<1>(key)[0],gd.get<3>(key)[0]);
+		BOOST_REQUIRE_EQUAL(gd.get<1>(key)[1],gd.get<3>(key)[1]);
+		++it3;
+	}
+
+	auto it4 = vd.getDomainIterator();
+	while (it4.isNext())
+	{
+		auto p = it4.get();
+		vd.getProp<0>(p) = 0.0;
+		vd.getProp<1>(p)[0] = 0.0;
+		vd.getProp<1>(p)[1] = 0.0;
+		vd.getProp<2>(p) = 0.0;
+		vd.getProp<3>(p)[0] = 0.0;
+		vd.getProp<3>(p)[1] = 0.0;
+		++it4;
+	}
+
+	inte.m2p_multi<m2p_prp<0,0>,m2p_prp<1,1>>(gd,vd);
+	inte.m2p<0,2>(gd,vd);
+	inte.m2p<1,3>(gd,vd);
+
+	auto it5 = vd.getDomainIterator();
+	while (it5.isNext())
+	{
+		auto p = it5.get();
+		BOOST_REQUIRE_EQUAL(vd.getProp<0>(p),vd.getProp<2>(p));
+		BOOST_REQUIRE_EQUAL(vd.getProp<1>(p)[0],vd.getProp<3>(p)[0]);
+		BOOST_REQUIRE_EQUAL(vd.getProp<1>(p)[1],vd.getProp<3>(p)[1]);
+		++it5;
+	}
+}
+
+BOOST_AUTO_TEST_CASE( interpolation_dec_test_2D )
+{
+	Box<2,double> domain({0.0,0.0},{1.0,1.0});
+	size_t sz[2] = {64,64};
+
+	Ghost<2,long int> gg(3);
+	Ghost<2,double> gv(0.01);
+
+	size_t bc_v[2] = {PERIODIC,PERIODIC};
+	periodicity<2> bc_g = {PERIODIC,PERIODIC};
+
+	vector_dist<2,double,aggregate<double,double>> vd(4096,domain,bc_v,gv);
+
+	// gd_v has the decomposition of the particles, gd its own decomposition
+	grid_dist_id<2,double,aggregate<double>> gd_v(vd.getDecomposition(),sz,gg);
+	grid_dist_id<2,double,aggregate<double>> gd(sz,domain,gg,bc_g);
+
+	auto it = vd.getDomainIterator();
+
+	while (it.isNext())
+	{
+		auto p = it.get();
+
+		vd.getPos(p)[0] = (double)rand()/RAND_MAX;
+		vd.getPos(p)[1] = (double)rand()/RAND_MAX;
+
+		vd.getProp<0>(p) = (double)rand()/RAND_MAX;
+		vd.getProp<1>(p) = 0.0;
+
+		++it;
+	}
+
+	vd.map();
+
+	auto it_z = gd_v.getDomainGhostIterator();
+	while (it_z.isNext())
+	{
+		gd_v.get<0>(it_z.get()) = 0.0;
+		++it_z;
+	}
+
+	auto it_z2 = gd.getDomainGhostIterator();
+	while (it_z2.isNext())
+	{
+		gd.get<0>(it_z2.get()) = 0.0;
+		++it_z2;
+	}
+
+	interpolate<decltype(vd),decltype(gd_v),mp4_kernel<double>> inte_v(vd,gd_v);
+	interpolate_dec<decltype(vd),decltype(gd),mp4_kernel<double>> inte(vd,gd);
+
+	inte_v.p2m<0,0>(vd,gd_v);
+	inte.p2m<0,0>(vd,gd);
+	gd_v.ghost_put<add_,0>();
+	gd.ghost_put<add_,0>();
+
+	auto & v_cl = create_vcluster();
+
+	double mg_v[2];
+	double mg[2];
+
+	momenta_grid_domain<decltype(gd_v),0>(gd_v,mg_v);
+	momenta_grid_domain<decltype(gd),0>(gd,mg);
+
+	v_cl.sum(mg_v[0]);
+	v_cl.sum(mg_v[1]);
+	v_cl.sum(mg[0]);
+	v_cl.sum(mg[1]);
+	v_cl.execute();
+
+	BOOST_REQUIRE_CLOSE(mg[0],mg_v[0],0.001);
+	BOOST_REQUIRE_CLOSE(mg[1],mg_v[1],0.001);
+
+	momenta_grid_domain<decltype(gd_v),1>(gd_v,mg_v);
+	momenta_grid_domain<decltype(gd),1>(gd,mg);
+
+	v_cl.sum(mg_v[0]);
+	v_cl.sum(mg_v[1]);
+	v_cl.sum(mg[0]);
+	v_cl.sum(mg[1]);
+	v_cl.execute();
+
+	BOOST_REQUIRE_CLOSE(mg[0],mg_v[0],0.001);
+	BOOST_REQUIRE_CLOSE(mg[1],mg_v[1],0.001);
+
+	// the same field on the two grids
+	auto it2 = gd_v.getDomainIterator();
+	while (it2.isNext())
+	{
+		auto key = it2.get();
+		auto key_g = gd_v.getGKey(key);
+		gd_v.get<0>(key) = sin(2.0*M_PI*key_g.get(0)*gd_v.spacing(0))*cos(2.0*M_PI*key_g.get(1)*gd_v.spacing(1));
+		++it2;
+	}
+
+	auto it3 = gd.getDomainIterator();
+	while (it3.isNext())
+	{
+		auto key = it3.get();
+		auto key_g = gd.getGKey(key);
+		gd.get<0>(key) = sin(2.0*M_PI*key_g.get(0)*gd.spacing(0))*cos(2.0*M_PI*key_g.get(1)*gd.spacing(1));
+		++it3;
+	}
+
+	gd_v.ghost_get<0>();
+	gd.ghost_get<0>();
+
+	auto it4 = vd.getDomainIterator();
+	while (it4.isNext())
+	{
+		auto p = it4.get();
+		vd.getProp<0>(p) = 0.0;
+		vd.getProp<1>(p) = 0.0;
+		++it4;
+	}
+
+	inte_v.m2p<0,0>(gd_v,vd);
+	inte.m2p<0,1>(gd,vd);
+
+	auto it5 = vd.getDomainIterator();
+	while (it5.isNext())
+	{
+		auto p = it5.get();
+		BOOST_REQUIRE_SMALL(vd.getProp<0>(p) - vd.getProp<1>(p),1e-12);
+		++it5;
+	}
+}
+
+BOOST_AUTO_TEST_CASE( interpolation_sparse_test_2D )
+{
+	Box<2,double> domain({0.0,0.0},{1.0,1.0});
+	size_t sz[2] = {64,64};
+
+	Ghost<2,long int> gg(3);
+	Ghost<2,double> gv(0.01);
+
+	size_t bc_v[2] = {PERIODIC,PERIODIC};
+
+	vector_dist<2,double,aggregate<double,double,double>> vd(4096,domain,bc_v,gv);
+	grid_dist_id<2,double,aggregate<double>> gd(vd.getDecomposition(),sz,gg);
+	sgrid_dist_id<2,double,aggregate<double>> sg(vd.getDecomposition(),sz,gg);
+
+	// only the particles in the band 0.4 < x < 0.6 are interpolated
+	auto band = [](decltype(vd) & vd, const vect_dist_key_dx & p){return fabs(vd.getPos(p)[0] - 0.5) < 0.1;};
+
+	auto it = vd.getDomainIterator();
+
+	while (it.isNext())
+	{
+		auto p = it.get();
+
+		vd.getPos(p)[0] = (double)rand()/RAND_MAX;
+		vd.getPos(p)[1] = (double)rand()/RAND_MAX;
+
+		++it;
+	}
+
+	vd.map();
+
+	// the dense interpolation of the property 1 is the one of the band particles
+	auto it2 = vd.getDomainIterator();
+	while (it2.isNext())
+	{
+		auto p = it2.get();
+
+		vd.getProp<0>(p) = (double)rand()/RAND_MAX;
+		vd.getProp<1>(p) = (band(vd,p) == true)?vd.getProp<0>(p):0.0;
+
+		++it2;
+	}
+
+	auto it3 = gd.getDomainGhostIterator();
+	while (it3.isNext())
+	{
+		gd.get<0>(it3.get()) = 0.0;
+		++it3;
+	}
+
+	interpolate<decltype(vd),decltype(gd),mp4_kernel<double>> inte(vd,gd);
+	interpolate_sparse<decltype(vd),decltype(sg),mp4_kernel<double>> inte_s(vd,sg);
+
+	inte.p2m<1,0>(vd,gd);
+	inte_s.p2m<0,0>(vd,sg,band);
+	gd.ghost_put<add_,0>();
+	sg.ghost_put<add_,0>();
+
+	double sum = 0.0;
+	double sum_s = 0.0;
+	size_t n_s = 0;
+
+	auto it4 = gd.getDomainIterator();
+	while (it4.isNext())
+	{
+		sum += gd.get<0>(it4.get());
+		++it4;
+	}
+
+	auto it5 = sg.getDomainIterator();
+	while (it5.isNext())
+	{
+		sum_s += sg.get<0>(it5.get());
+		n_s++;
+		++it5;
+	}
+
+	auto & v_cl = create_vcluster();
+	v_cl.sum(sum);
+	v_cl.sum(sum_s);
+	v_cl.sum(n_s);
+	v_cl.execute();
+
+	BOOST_REQUIRE_CLOSE(sum,sum_s,0.001);
+
+	// only the band (and the kernel support around it) is stored
+	BOOST_REQUIRE(n_s < 64*64/2);
+
+	// the stencils of the band particles are all in the sparse grid, m2p gives the dense result
+	gd.ghost_get<0>();
+	sg.ghost_get<0>();
+
+	auto it6 = vd.getDomainIterator();
+	while (it6.isNext())
+	{
+		auto p = it6.get();
+		vd.getProp<1>(p) = 0.0;
+		vd.getProp<2>(p) = 0.0;
+		++it6;
+	}
+
+	inte.m2p<0,1>(gd,vd);
+	inte_s.m2p<0,2>(sg,vd,band);
+
+	auto it7 = vd.getDomainIterator();
+	while (it7.isNext())
+	{
+		auto p = it7.get();
+
+		if (band(vd,p) == true)
+		{BOOST_REQUIRE_SMALL(vd.getProp<1>(p) - vd.getProp<2>(p),1e-12);}
+
+		++it7;
+	}
+}
+
+BOOST_AUTO_TEST_CASE( interpolation_remesh_test_2D )
+{
+	Box<2,double> domain({0.0,0.0},{1.0,1.0});
+	size_t sz[2] = {64,64};
+
+	Ghost<2,long int> gg(3);
+	Ghost<2,double> gv(0.01);
+
+	size_t bc_v[2] = {PERIODIC,PERIODIC};
+
+	vector_dist<2,double,aggregate<double>> vd(4096,domain,bc_v,gv);
+	grid_dist_id<2,double,aggregate<double>> gd(vd.getDecomposition(),sz,gg);
+
+	// particles only in the lower half of the domain
+	auto it = vd.getDomainIterator();
+
+	while (it.isNext())
+	{
+		auto p = it.get();
+
+		vd.getPos(p)[0] = (double)rand()/RAND_MAX;
+		vd.getPos(p)[1] = 0.1 + 0.3*(double)rand()/RAND_MAX;
+
+		vd.getProp<0>(p) = 1.0;
+
+		++it;
+	}
+
+	vd.map();
+
+	auto & v_cl = create_vcluster();
+
+	double mass = 0.0;
+	auto it2 = vd.getDomainIterator();
+	while (it2.isNext())
+	{
+		mass += vd.getProp<0>(it2.get());
+		++it2;
+	}
+
+	remesh<decltype(vd),decltype(gd),mp4_kernel<double>> rm(vd,gd);
+	size_t n = rm.run<0,0>(vd,gd,1e-10);
+
+	BOOST_REQUIRE_EQUAL(n,vd.size_local());
+
+	// the mass is conserved, the particles are on the grid nodes and there are no particles in the empty part
+	double mass_r = 0.0;
+	bool on_nodes = true;
+	auto it3 = vd.getDomainIterator();
+	while (it3.isNext())
+	{
+		auto p = it3.get();
+
+		mass_r += vd.getProp<0>(p);
+
+		for (size_t i = 0 ; i < 2 ; i++)
+		{
+			double x = vd.getPos(p)[i] / gd.spacing(i);
+			on_nodes &= std::fabs(x - std::round(x)) < 1e-8;
+		}
+
+		on_nodes &= vd.getPos(p)[1] < 0.5;
+
+		++it3;
+	}
+
+	v_cl.sum(mass);
+	v_cl.sum(mass_r);
+	v_cl.execute();
+
+	BOOST_REQUIRE(on_nodes);
+	BOOST_REQUIRE_CLOSE(mass,mass_r,1e-8);
+}
+
+BOOST_AUTO_TEST_CASE( interpolation_cached_stencil_test_2D )
+{
+	Box<2,double> domain({0.0,0.0},{1.0,1.0});
+	size_t sz[2] = {64,64};
+
+	Ghost<2,long int> gg(3);
+	Ghost<2,double> gv(0.01);
+
+	size_t bc_v[2] = {PERIODIC,PERIODIC};
+
+	vector_dist<2,double,aggregate<double,double,double>> vd(4096,domain,bc_v,gv);
+	grid_dist_id<2,double,aggregate<double,double>> gd(vd.getDecomposition(),sz,gg);
+
+	auto it = vd.getDomainIterator();
+
+	while (it.isNext())
+	{
+		auto p = it.get();
+
+		vd.getPos(p)[0] = (double)rand()/RAND_MAX;
+		vd.getPos(p)[1] = (double)rand()/RAND_MAX;
+
+		vd.getProp<0>(p) = (double)rand()/RAND_MAX;
+		vd.getProp<1>(p) = 0.0;
+		vd.getProp<2>(p) = 0.0;
+
+		++it;
+	}
+
+	vd.map();
+
+	auto it2 = gd.getDomainGhostIterator();
+	while (it2.isNext())
+	{
+		auto key = it2.get();
+		gd.get<0>(key) = 0.0;
+		gd.get<1>(key) = 0.0;
+		++it2;
+	}
+
+	interpolate<decltype(vd),decltype(gd),mp4_kernel<double>> inte(vd,gd);
+
+	// the cached stencils give the same result of the stencils calculated on the fly
+	inte.p2m<0,0>(vd,gd);
+	inte.m2p<0,1>(gd,vd);
+
+	inte.cache_stencil(vd);
+	BOOST_REQUIRE(inte.is_stencil_cached(vd));
+
+	inte.p2m<0,1>(vd,gd);
+	inte.m2p<1,2>(gd,vd);
+
+	auto it3 = gd.getDomainGhostIterator();
+	while (it3.isNext())
+	{
+		auto key = it3.get();
+		BOOST_REQUIRE_EQUAL(gd.get<0>(key),gd.get<1>(key));
+		++it3;
+	}
+
+	auto it4 = vd.getDomainIterator();
+	while (it4.isNext())
+	{
+		auto p = it4.get();
+		BOOST_REQUIRE_EQUAL(vd.getProp<1>(p),vd.getProp<2>(p));
+		++it4;
+	}
+
+	// a map invalidate the stencils
+	vd.map();
+	BOOST_REQUIRE(inte.is_stencil_cached(vd) == false);
+
+	inte.cache_stencil(vd);
+	inte.invalidate_stencil();
+	BOOST_REQUIRE(inte.is_stencil_cached(vd) == false);
+}
+
+BOOST_AUTO_TEST_CASE( int_kernel_weights_test )
+{
+	// the branch-free evaluation must give exactly the same weights
+	check_kernel_weights<mp4_kernel<double>>();
+	check_kernel_weights<z_kernel<double,1>>();
+	check_kernel_weights<z_kernel<double,3>>();
+	check_kernel_weights<z_kernel<double,4>>();
+	check_kernel_weights<lambda4_4kernel<double>>();
+}
+
 BOOST_AUTO_TEST_CASE(InterpolationConvergenceP2M)
 {
         size_t res;
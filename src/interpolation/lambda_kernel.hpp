@@ -42,6 +42,17 @@ public:
             return horner(c3, x) / 24.0;
         return 0.0;
     }
+
+    //! Evaluate the kernel on all the points of the stencil without branches
+    static inline void value_all(const st (& x)[np], st (& a)[np])
+    {
+        a[0] = horner(c3, -x[0]) / 24.0;
+        a[1] = horner(c2, -x[1]) / 24.0;
+        a[2] = horner(c1, -x[2]) / 12.0;
+        a[3] = horner(c1, x[3]) / 12.0;
+        a[4] = horner(c2, x[4]) / 24.0;
+        a[5] = horner(c3, x[5]) / 24.0;
+    }
 };
 
 
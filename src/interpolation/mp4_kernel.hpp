@@ -9,6 +9,7 @@
 #define OPENFPM_NUMERICS_SRC_INTERPOLATION_MP4_KERNEL_HPP_
 
 #include <iostream>
+#include "util/cuda_util.hpp"
 
 template<typename st>
 class mp4_kernel
@@ -17,7 +18,7 @@ public:
 
 	static const int np = 4;
 
-	static inline st value(st x, size_t i)
+	__device__ __host__ static inline st value(st x, size_t i)
 	{
 		if (i == 0)
 			return st(2.0) + (st(-4.0)+(st(2.5)-st(0.5)*-x)*-x)*-x;
@@ -29,6 +30,15 @@ public:
 			return st(2.0) + (st(-4.0)+(st(2.5)-st(0.5)*x)*x)*x;
 		return 0.0;
 	}
+
+	//! Evaluate the kernel on all the points of the stencil without branches
+	__device__ __host__ static inline void value_all(const st (& x)[np], st (& a)[np])
+	{
+		a[0] = st(2.0) + (st(-4.0)+(st(2.5)-st(0.5)*-x[0])*-x[0])*-x[0];
+		a[1] = st(1.0) + (st(-2.5)+st(1.5)*-x[1])*x[1]*x[1];
+		a[2] = st(1.0) + (st(-2.5)+st(1.5)*x[2])*x[2]*x[2];
+		a[3] = st(2.0) + (st(-4.0)+(st(2.5)-st(0.5)*x[3])*x[3])*x[3];
+	}
 };
 
 #endif /* OPENFPM_NUMERICS_SRC_INTERPOLATION_MP4_KERNEL_HPP_ */
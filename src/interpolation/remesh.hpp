@@ -0,0 +1,184 @@
+/*
+ * remesh.hpp
+ *
+ *  Remeshing of a particle set: p2m on a grid and re-creation of the particles on the grid nodes
+ */
+
+#ifndef OPENFPM_NUMERICS_SRC_INTERPOLATION_REMESH_HPP_
+#define OPENFPM_NUMERICS_SRC_INTERPOLATION_REMESH_HPP_
+
+#include "interpolation.hpp"
+#include "Vector/vector_dist.hpp"
+#include "Grid/grid_dist_id.hpp"
+#include <cmath>
+
+/*! \brief Reset, magnitude and copy of a property for the remeshing
+ *
+ * \tparam T type of the property
+ *
+ */
+template<typename T>
+struct remesh_prop
+{
+	//! set the property to zero
+	template<typename r_type> static inline void zero(r_type && r)
+	{
+		r = 0;
+	}
+
+	//! magnitude of the property
+	template<typename r_type> static inline double magnitude(r_type && r)
+	{
+		return std::fabs(r);
+	}
+
+	//! copy the property of the grid node on the particle
+	template<typename d_type, typename s_type> static inline void copy(d_type && dst, s_type && src)
+	{
+		dst = src;
+	}
+};
+
+/*! \brief Reset, magnitude (sum of the absolute values of the components) and copy of a vector property
+ *
+ * \tparam T type of the components
+ * \tparam N1 number of components
+ *
+ */
+template<typename T, unsigned int N1>
+struct remesh_prop<T[N1]>
+{
+	//! set the property to zero
+	template<typename r_type> static inline void zero(r_type && r)
+	{
+		for (unsigned int i = 0 ; i < N1 ; i++)
+		{r[i] = 0;}
+	}
+
+	//! magnitude of the property
+	template<typename r_type> static inline double magnitude(r_type && r)
+	{
+		double m = 0.0;
+		for (unsigned int i = 0 ; i < N1 ; i++)
+		{m += std::fabs(r[i]);}
+
+		return m;
+	}
+
+	//! copy the property of the grid node on the particle
+	template<typename d_type, typename s_type> static inline void copy(d_type && dst, s_type && src)
+	{
+		for (unsigned int i = 0 ; i < N1 ; i++)
+		{dst[i] = src[i];}
+	}
+};
+
+/*! \brief Remeshing of a particle set on a grid
+ *
+ * A property of the particles is interpolated on the grid (p2m followed by ghost_put), then the particles are
+ * replaced by one particle on every grid node where the interpolated value is bigger than a threshold. The
+ * particles are written in place in the existing storage (resize, no add), and because the grid use the
+ * decomposition of the particles every new particle is already on the right processor (no map is needed).
+ *
+ * Only the remeshed property and the positions are set on the new particles, the ghost of the particles must
+ * be updated with ghost_get
+ *
+ * \code{.cpp}
+
+   remesh<vector_type,grid_type,mp4_kernel<double>> rm(vd,gd);
+
+   // p2m of the property 0 of vd on the property 0 of gd, and particles re-created on the nodes with |value| > 1e-6
+   rm.template run<0,0>(vd,gd,1e-6);
+   vd.template ghost_get<0>();
+
+ * \endcode
+ *
+ * \tparam vector type of vector (vector_dist)
+ * \tparam grid type of grid (grid_dist_id with the decomposition of the vector)
+ * \tparam kernel interpolation kernel
+ *
+ */
+template<typename vector, typename grid, typename kernel>
+class remesh
+{
+	//! key of the grid nodes
+	typedef typename std::remove_const<typename std::remove_reference<decltype(std::declval<grid &>().getDomainIterator().get())>::type>::type key_type;
+
+	//! interpolation
+	interpolate<vector,grid,kernel> inte;
+
+	//! grid nodes where the particles are created (reused across the remeshing)
+	openfpm::vector<key_type> nodes;
+
+public:
+
+	/*! \brief Constructor
+	 *
+	 * \param vd particle set
+	 * \param gd grid used for the remeshing, it must have the decomposition of vd
+	 *
+	 */
+	remesh(vector & vd, grid & gd)
+	:inte(vd,gd)
+	{}
+
+	/*! \brief Remesh the particles
+	 *
+	 * \tparam prp_v property of the particles to remesh
+	 * \tparam prp_g property of the grid used for the interpolation (overwritten)
+	 *
+	 * \param vd particle set
+	 * \param gd grid
+	 * \param threshold grid nodes with a value smaller or equal (in magnitude) are skipped
+	 *
+	 * \return the number of local particles after the remeshing
+	 *
+	 */
+	template<unsigned int prp_v, unsigned int prp_g> size_t run(vector & vd, grid & gd, double threshold = 0.0)
+	{
+		typedef typename boost::mpl::at<typename grid::value_type::type,boost::mpl::int_<prp_g>>::type prop_type;
+
+		auto it = gd.getDomainGhostIterator();
+		while (it.isNext())
+		{
+			auto key = it.get();
+			remesh_prop<prop_type>::zero(gd.template get<prp_g>(key));
+			++it;
+		}
+
+		inte.template p2m<prp_v,prp_g>(vd,gd);
+		gd.template ghost_put<add_,prp_g>();
+
+		nodes.clear();
+
+		auto it2 = gd.getDomainIterator();
+		while (it2.isNext())
+		{
+			auto key = it2.get();
+
+			if (remesh_prop<prop_type>::magnitude(gd.template get<prp_g>(key)) > threshold)
+			{nodes.add(key);}
+
+			++it2;
+		}
+
+		vd.resize(nodes.size());
+
+		long int n_nodes = nodes.size();
+
+		#pragma omp parallel for schedule(static)
+		for (long int i = 0 ; i < n_nodes ; i++)
+		{
+			auto p = gd.getPos(nodes.get(i));
+
+			for (unsigned int d = 0 ; d < vector::dims ; d++)
+			{vd.getPos(i)[d] = p.get(d);}
+
+			remesh_prop<prop_type>::copy(vd.template getProp<prp_v>(i),gd.template get<prp_g>(nodes.get(i)));
+		}
+
+		return nodes.size();
+	}
+};
+
+#endif /* OPENFPM_NUMERICS_SRC_INTERPOLATION_REMESH_HPP_ */
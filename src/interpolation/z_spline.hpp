@@ -31,7 +31,7 @@ public:
 
 	static const int np = 2;
 
-	static inline st value(st x, size_t i)
+	__device__ __host__ static inline st value(st x, size_t i)
 	{
 		if (i == 0)
 			return x + 1;
@@ -39,6 +39,13 @@ public:
 			return 1-x;
 		return 0.0;
 	}
+
+	//! Evaluate the kernel on all the points of the stencil without branches
+	__device__ __host__ static inline void value_all(const st (& x)[np], st (& a)[np])
+	{
+		a[0] = x[0] + 1;
+		a[1] = 1-x[1];
+	}
 };
 
 template<typename st>
@@ -54,7 +61,7 @@ public:
 
 	static const int np = 6;
 
-	static inline st value(st x, size_t i)
+	__device__ __host__ static inline st value(st x, size_t i)
 	{
 		if (i == 0)
 			return 18.0 + ( 38.25 + (31.875 + ( 313.0/24.0 + (2.625 + 5.0/24.0*x)*x)*x)*x)*x;
@@ -71,6 +78,17 @@ public:
 
 		return 0.0;
 	}
+
+	//! Evaluate the kernel on all the points of the stencil without branches
+	__device__ __host__ static inline void value_all(const st (& x)[np], st (& a)[np])
+	{
+		a[0] = 18.0 + ( 38.25 + (31.875 + ( 313.0/24.0 + (2.625 + 5.0/24.0*x[0])*x[0])*x[0])*x[0])*x[0];
+		a[1] = -4.0 + (-18.75 + (-30.625 + (-545.0/24.0 + ( -7.875 - 25.0/24.0*x[1])*x[1])*x[1])*x[1])*x[1];
+		a[2] = 1.0 + (-1.25 +(35.0/12.0 +(5.25 + 25.0/12.0*x[2])*x[2])*x[2])*x[2]*x[2];
+		a[3] = 1.0 + (-1.25 +(-35.0/12.0 +(5.25 - 25.0/12.0*x[3])*x[3])*x[3])*x[3]*x[3];
+		a[4] = -4.0 + (18.75 + (-30.625 + (545.0/24.0 + ( -7.875 + 25.0/24.0*x[4])*x[4])*x[4])*x[4])*x[4];
+		a[5] = 18.0 + (-38.25 + (31.875 + (-313.0/24.0 + (2.625 - 5.0/24.0*x[5])*x[5])*x[5])*x[5])*x[5];
+	}
 };
 
 template<typename st>
@@ -80,7 +98,7 @@ public:
 
 	static const int np = 8;
 
-	static inline st value(st x, size_t i)
+	__device__ __host__ static inline st value(st x, size_t i)
 	{
 		if (i == 0)
 			return 726.4 + ( 1491.2 + (58786.0/45.0 + ( 633.0 + (26383.0/144.0 + (22807.0/720.0 + (727.0/240.0 + 89.0/720.0*x)*x)*x)*x)*x)*x)*x;
@@ -101,6 +119,19 @@ public:
 
 		return 0.0;
 	}
+
+	//! Evaluate the kernel on all the points of the stencil without branches
+	__device__ __host__ static inline void value_all(const st (& x)[np], st (& a)[np])
+	{
+		a[0] = 726.4 + ( 1491.2 + (58786.0/45.0 + ( 633.0 + (26383.0/144.0 + (22807.0/720.0 + (727.0/240.0 + 89.0/720.0*x[0])*x[0])*x[0])*x[0])*x[0])*x[0])*x[0];
+		a[1] = -440 +( -1297.45 + ( -117131/72.0 + ( -1123.5 + ( -66437.0/144.0 + ( -81109.0/720.0 + ( -727.0/48.0 - 623.0/720.0*x[1])*x[1])*x[1])*x[1])*x[1])*x[1])*x[1];
+		a[2] = 27.6 + (8617.0/60.0 +(321.825 +(395.5 +( 284.8125 + (119.7875 +(27.2625 + 623.0/240.0*x[2])*x[2])*x[2])*x[2])*x[2])*x[2])*x[2];
+		a[3] = 1.0 + (( -49.0/36.0 + (( -959.0/144.0 + ( -2569.0/144.0 + ( -727.0/48.0 - 623.0/144.0*x[3])*x[3])*x[3])*x[3])*x[3])*x[3])*x[3];
+		a[4] = 1.0 + (( -49.0/36.0 + (( -959.0/144.0 + ( 2569.0/144.0 + ( -727.0/48.0 + 623.0/144.0*x[4])*x[4])*x[4])*x[4])*x[4])*x[4])*x[4];
+		a[5] = 27.6 + (-8617.0/60.0 +(321.825 +(-395.5 +( 284.8125 + (-119.7875 +(27.2625 - 623.0/240.0*x[5])*x[5])*x[5])*x[5])*x[5])*x[5])*x[5];
+		a[6] = -440 +( 1297.45 + ( -117131/72.0 + ( 1123.5 + ( -66437.0/144.0 + ( 81109.0/720.0 + ( -727.0/48.0 + 623.0/720.0*x[6])*x[6])*x[6])*x[6])*x[6])*x[6])*x[6];
+		a[7] = 726.4 + ( -1491.2 + (58786.0/45.0 + ( -633.0 + (26383.0/144.0 + (-22807.0/720.0 + (727.0/240.0 - 89.0/720.0*x[7])*x[7])*x[7])*x[7])*x[7])*x[7])*x[7];
+	}
 };
 
 #endif /* OPENFPM_NUMERICS_SRC_INTERPOLATION_Z_SPLINE_HPP_ */
@@ -17,6 +17,8 @@
 #ifndef __CLOSEST_POINT_HPP__
 #define __CLOSEST_POINT_HPP__
 
+#include <vector>
+#include <memory>
 #include "Grid/grid_dist_key.hpp"
 #include "algoim_hocp.hpp"
 
@@ -194,244 +196,631 @@ struct AlgoimWrapper<wrapping_field,grid_type,wrapping_field_type[N1][N2][N3]>
 };
 
 
-/**@brief Computes the closest point coordinate for each grid point within nb_gamma from interface.
+/**@brief Lower and upper corner of a local grid patch in global grid coordinates.
  *
- * @tparam phi_field Property id on grid for the level set SDF (input)
- * @tparam cp_field Property id on grid for storing closest point coordinates (output)
- * @tparam poly_order Type of stencil interpolation (Taylor poly orders between 2 to 5 and Tri/bicubic through -1 is supported)
  * @tparam grid_type Type of the grid container
  *
- * @param gd The distributed grid containing at least level set SDF field and placeholder for closest point coordinates
- * @param nb_gamma The width of the narrow band within which closest point estimation is to be done
- * 
+ * @param gd The distributed grid
+ * @param i Local patch id
+ * @param p_lo Lower corner (output)
+ * @param p_hi Upper corner (output)
  */
-template<size_t phi_field, size_t cp_field, int poly_order, typename grid_type>
-void estimateClosestPoint(grid_type &gd, const double nb_gamma)
+template<typename grid_type>
+void getPatchBounds(grid_type &gd, const int i, grid_key_dx<grid_type::dims> &p_lo, grid_key_dx<grid_type::dims> &p_hi)
 {
-    const unsigned int dim = grid_type::dims;
-    // Update the phi field in ghosts
-    gd.template ghost_get<phi_field>(KEEP_PROPERTIES);
-
-    // Stencil polynomial type
-    using Poly = typename Algoim::StencilPoly<dim, poly_order>::T_Poly;
-
-    // Grid spacing along each dimension
-    blitz::TinyVector<double,dim> dx;
-    for(int d = 0; d < dim; ++d)
-        dx(d) = gd.spacing(d);
-
     auto &patches = gd.getLocalGridsInfo();
+    for(int d = 0; d < grid_type::dims; ++d)
+    {
+        p_lo.set_d(d, patches.get(i).Dbox.getLow(d) + patches.get(i).origin[d]);
+        p_hi.set_d(d, patches.get(i).Dbox.getHigh(d) + patches.get(i).origin[d]);
+    }
+}
 
-    grid_key_dx<dim> p_lo;
-    grid_key_dx<dim> p_hi;
+/**@brief Collects the keys of the grid points within nb_gamma from interface, such that they can be processed
+ *        in parallel independently of the patch they belong to.
+ *
+ * @tparam phi_field Property id on grid for the level set SDF
+ * @tparam grid_type Type of the grid container
+ *
+ * @param gd The distributed grid
+ * @param nb_gamma The width of the narrow band
+ * @param keys Keys of the narrow band points (output)
+ */
+template<size_t phi_field, typename grid_type, typename key_type>
+void getNarrowBandKeys(grid_type &gd, const double nb_gamma, std::vector<key_type> &keys)
+{
+    keys.clear();
+    auto it = gd.getDomainIterator();
+    while(it.isNext())
+    {
+        auto key = it.get();
+        if(std::abs(gd.template get<phi_field>(key)) < nb_gamma)
+            keys.push_back(key);
+        ++it;
+    }
+}
 
-    for(int i = 0; i < patches.size();i++)
+/**@brief Algoim structures needed to compute the closest points in one grid patch.
+ *
+ * @tparam dim Dimensionality of the grid
+ * @tparam Poly Stencil polynomial type
+ */
+template<unsigned int dim, typename Poly>
+struct ClosestPointPatch
+{
+    //! Cells containing the interface with their interpolating polynomials
+    std::vector<Algoim::detail::CellPoly<dim,Poly>> cells;
+    //! Points sampled on the interface
+    std::vector<blitz::TinyVector<double,dim>> points;
+    //! Cell of each sampled point
+    std::vector<int> pointcells;
+    //! KDTree of the sampled points
+    std::unique_ptr<Algoim::KDTree<double,dim>> kdtree;
+    //! Closest point computation engine
+    std::unique_ptr<Algoim::ComputeHighOrderCP<dim,Poly>> hocp;
+
+    /**@brief Builds the cell polynomials, the sampled points, the KDTree and the closest point engine of a patch.
+     *
+     * @tparam phi_field Property id on grid for the level set SDF
+     * @tparam grid_type Type of the grid container
+     *
+     * @param gd The distributed grid, with phi_field updated in the ghost
+     * @param i Local patch id
+     * @param nb_gamma The width of the narrow band within which closest point estimation is to be done
+     */
+    template<size_t phi_field, typename grid_type>
+    void build(grid_type &gd, const int i, const double nb_gamma)
     {
+        blitz::TinyVector<double,dim> dx;
         for(int d = 0; d < dim; ++d)
-        {
-            p_lo.set_d(d, patches.get(i).Dbox.getLow(d) + patches.get(i).origin[d]);
-            p_hi.set_d(d, patches.get(i).Dbox.getHigh(d) + patches.get(i).origin[d]);
-        }
+            dx(d) = gd.spacing(d);
+
+        grid_key_dx<dim> p_lo;
+        grid_key_dx<dim> p_hi;
+        getPatchBounds(gd, i, p_lo, p_hi);
 
         AlgoimWrapper<phi_field, grid_type> phiwrap(gd, i);
 
         // Find all cells containing the interface and construct the high-order polynomials
-        std::vector<Algoim::detail::CellPoly<dim,Poly>> cells;
-
         blitz::TinyVector<int,dim> ext;
 
         for(int d = 0; d < dim; ++d)
             ext(d) = static_cast<int>(p_hi.get(d) - p_lo.get(d) + 1 + 2*algoim_padding);
 
+        cells.clear();
+        points.clear();
+        pointcells.clear();
         Algoim::detail::createCellPolynomials(ext, phiwrap, dx, false, cells);
 
-        std::vector<blitz::TinyVector<double,dim>> points;
-        std::vector<int> pointcells;
         Algoim::detail::samplePolynomials<dim,Poly>(cells, 2, dx, 0.0, points, pointcells);
 
-        Algoim::KDTree<double,dim> kdtree(points);
+        kdtree.reset(new Algoim::KDTree<double,dim>(points));
 
         // In order to ensure that CP is estimated for all points in the narrowband, we add a buffer to the distance check.
         double nb_gamma_plus_dx = nb_gamma + gd.spacing(0);
         // Pass everything to the closest point computation engine
-        Algoim::ComputeHighOrderCP<dim,Poly> hocp(nb_gamma_plus_dx < std::numeric_limits<double>::max() ? nb_gamma_plus_dx*nb_gamma_plus_dx : std::numeric_limits<double>::max(), // squared bandradius
+        hocp.reset(new Algoim::ComputeHighOrderCP<dim,Poly>(nb_gamma_plus_dx < std::numeric_limits<double>::max() ? nb_gamma_plus_dx*nb_gamma_plus_dx : std::numeric_limits<double>::max(), // squared bandradius
                                         0.5*blitz::max(dx), // amount that each polynomial overlaps / size of the bounding ball in Newton's method
                                         Algoim::sqr(std::max(1.0e-14, std::pow(blitz::max(dx), Poly::order))), // tolerance to determine convergence
-                                        cells, kdtree, points, pointcells, dx, 0.0);
+                                        cells, *kdtree, points, pointcells, dx, 0.0));
+    }
+};
 
-        auto it = gd.getSubDomainIterator(p_lo, p_hi);
-        while(it.isNext())
+/**@brief Builds the Algoim structures of all the local patches in parallel.
+ *
+ * @tparam phi_field Property id on grid for the level set SDF
+ * @tparam grid_type Type of the grid container
+ * @tparam cp_patch_type Type of the patch structures
+ *
+ * @param gd The distributed grid, with phi_field updated in the ghost
+ * @param nb_gamma The width of the narrow band within which closest point estimation is to be done
+ * @param cp_patches Patch structures (output)
+ */
+template<size_t phi_field, typename grid_type, typename cp_patch_type>
+void buildClosestPointPatches(grid_type &gd, const double nb_gamma, std::vector<cp_patch_type> &cp_patches)
+{
+    long int n_patches = gd.getLocalGridsInfo().size();
+    cp_patches.clear();
+    cp_patches.resize(n_patches);
+
+    #pragma omp parallel for schedule(dynamic,1)
+    for(long int i = 0; i < n_patches; i++)
+        cp_patches[i].template build<phi_field>(gd, i, nb_gamma);
+}
+
+/**@brief Computes the closest point coordinate of the given narrow band points in parallel.
+ *
+ * @tparam cp_field Property id on grid for storing closest point coordinates (output)
+ * @tparam grid_type Type of the grid container
+ * @tparam cp_patch_type Type of the patch structures
+ * @tparam key_type Type of the grid keys
+ *
+ * @param gd The distributed grid
+ * @param cp_patches Algoim structures of the local patches
+ * @param keys Keys of the narrow band points
+ */
+template<size_t cp_field, typename grid_type, typename cp_patch_type, typename key_type>
+void computeClosestPoints(grid_type &gd, std::vector<cp_patch_type> &cp_patches, const std::vector<key_type> &keys)
+{
+    const unsigned int dim = grid_type::dims;
+    long int n_keys = keys.size();
+
+    #pragma omp parallel for schedule(dynamic,64)
+    for(long int k = 0; k < n_keys; k++)
+    {
+        auto key = keys[k];
+        const int i = key.getSub();
+        grid_key_dx<dim> p_lo;
+        grid_key_dx<dim> p_hi;
+        getPatchBounds(gd, i, p_lo, p_hi);
+
+        auto key_g = gd.getGKey(key);
+        // NOTE: This is not the real grid coordinates, but internal coordinates for algoim
+        blitz::TinyVector<double,dim> patch_pos, cp;
+        for(int d = 0; d < dim; ++d)
+            patch_pos(d) = (key_g.get(d) - p_lo.get(d) + algoim_padding) * gd.spacing(d);
+
+        if (cp_patches[i].hocp->compute(patch_pos, cp))
+        {
+            for(int d = 0; d < dim; ++d)
+                gd.template get<cp_field>(key)[d] = cp(d);
+        }
+        else
         {
-            auto key = it.get();
-            if(std::abs(gd.template get<phi_field>(key)) < nb_gamma)
+            #pragma omp critical
             {
-                auto key_g = gd.getGKey(key);
-                // NOTE: This is not the real grid coordinates, but internal coordinates for algoim
-                blitz::TinyVector<double,dim> patch_pos, cp;
+                std::cout<<"WARN: Closest point computation fails at : ";
                 for(int d = 0; d < dim; ++d)
-                    patch_pos(d) = (key_g.get(d) - p_lo.get(d) + algoim_padding) * dx(d);
-
-                if (hocp.compute(patch_pos, cp))
-                {
-                    for(int d = 0; d < dim; ++d)
-                        gd.template get<cp_field>(key)[d] = cp(d);
-                }
-                else
                 {
-                    std::cout<<"WARN: Closest point computation fails at : ";
-                    for(int d = 0; d < dim; ++d)
-                    {
-                        std::cout<<key_g.get(d)<<" ";
-                        gd.template get<cp_field>(key)[d] = -100.0;
-                    }
-                    std::cout<<"\n";
+                    std::cout<<key_g.get(d)<<" ";
+                    gd.template get<cp_field>(key)[d] = -100.0;
                 }
+                std::cout<<"\n";
             }
-            ++it;
         }
     }
-    return;
 }
 
-/**@brief Extends a (scalar) field to within nb_gamma from interface. The grid should have level set SDF and closest point field.
+/**@brief Computes closest point, unit normal and mean curvature of the given narrow band points in parallel.
+ *
+ * @details After the closest point of a point is found, the stencil polynomial of phi_field of the cell containing
+ *          the closest point is built once and its gradient and Hessian at the closest point give the normal
+ *          n = grad(phi)/|grad(phi)| and the curvature div(n) = (|g|^2 tr(H) - g^T H g)/|g|^3, without derivative
+ *          passes on the grid. Where the closest point is not found cp is set to -100.0, normal and curvature to 0.
  *
  * @tparam phi_field Property id on grid for the level set SDF
- * @tparam cp_field Property id on grid for storing closest point coordinates
- * @tparam extend_field Property id on grid where the field to be extended resides
- * @tparam extend_field_temp Property id on grid for storing temporary intermediate values
- * @tparam poly_order Type of stencil interpolation (Taylor poly orders between 2 to 5 and Tri/bicubic through -1 is supported)
+ * @tparam cp_field Property id on grid for storing closest point coordinates (output)
+ * @tparam normal_field Property id on grid for storing the unit normal at the closest point (output)
+ * @tparam curvature_field Property id on grid for storing the mean curvature at the closest point (output)
+ * @tparam poly_order Type of stencil interpolation
  * @tparam grid_type Type of the grid container
+ * @tparam cp_patch_type Type of the patch structures
+ * @tparam key_type Type of the grid keys
  *
- * @param gd The distributed grid containing atleast level set SDF field and closest point coordinates
- * @param nb_gamma The width of the narrow band within which extension is required (half band)
+ * @param gd The distributed grid, with phi_field updated in the ghost
+ * @param cp_patches Algoim structures of the local patches
+ * @param keys Keys of the narrow band points
  */
-template<size_t phi_field, size_t cp_field, size_t extend_field, size_t extend_field_temp, int poly_order, typename grid_type>
-void extendLSField(grid_type &gd, const double nb_gamma)
+template<size_t phi_field, size_t cp_field, size_t normal_field, size_t curvature_field, int poly_order,
+         typename grid_type, typename cp_patch_type, typename key_type>
+void computeClosestPointGeometry(grid_type &gd, std::vector<cp_patch_type> &cp_patches, const std::vector<key_type> &keys)
 {
     const unsigned int dim = grid_type::dims;
-    // Update the phi and cp fields in ghost
-    gd.template ghost_get<phi_field, cp_field, extend_field>(KEEP_PROPERTIES);
-
-    // Stencil polynomial object
     using Poly = typename Algoim::StencilPoly<dim, poly_order>::T_Poly;
-    auto &patches = gd.getLocalGridsInfo();
+
     blitz::TinyVector<double,dim> dx;
     for(int d = 0; d < dim; ++d)
         dx(d) = gd.spacing(d);
 
-    grid_key_dx<dim> p_lo;
-    grid_key_dx<dim> p_hi;
+    long int n_keys = keys.size();
 
-    for(int i = 0; i < patches.size();i++)
+    #pragma omp parallel for schedule(dynamic,64)
+    for(long int k = 0; k < n_keys; k++)
     {
+        auto key = keys[k];
+        const int i = key.getSub();
+        grid_key_dx<dim> p_lo;
+        grid_key_dx<dim> p_hi;
+        getPatchBounds(gd, i, p_lo, p_hi);
+
+        auto key_g = gd.getGKey(key);
+        // NOTE: This is not the real grid coordinates, but internal coordinates for algoim
+        blitz::TinyVector<double,dim> patch_pos, cp;
         for(int d = 0; d < dim; ++d)
-        {
-            p_lo.set_d(d, patches.get(i).Dbox.getLow(d) + patches.get(i).origin[d]);
-            p_hi.set_d(d, patches.get(i).Dbox.getHigh(d) + patches.get(i).origin[d]);
-        }
-	
-        auto it = gd.getSubDomainIterator(p_lo, p_hi);
+            patch_pos(d) = (key_g.get(d) - p_lo.get(d) + algoim_padding) * gd.spacing(d);
 
-        while(it.isNext())
+        if (cp_patches[i].hocp->compute(patch_pos, cp) == false)
         {
-            auto key = it.get();
-            if(std::abs(gd.template get<phi_field>(key)) < nb_gamma)
+            #pragma omp critical
             {
-                blitz::TinyVector<int,dim> coord;
-                blitz::TinyVector<double,dim> pos;
-
+                std::cout<<"WARN: Closest point computation fails at : ";
                 for(int d = 0; d < dim; ++d)
                 {
-                    double cp_d = gd.template get<cp_field>(key)[d];
-                    coord(d) = static_cast<int>(floor(cp_d / gd.spacing(d)));
-                    pos(d) = cp_d - coord(d)*gd.spacing(d);
+                    std::cout<<key_g.get(d)<<" ";
+                    gd.template get<cp_field>(key)[d] = -100.0;
+                    gd.template get<normal_field>(key)[d] = 0.0;
                 }
-
-                AlgoimWrapper<extend_field, grid_type> fieldwrap(gd,i);
-		fieldwrap.template extend<extend_field_temp,poly_order>(coord,dx,pos,key);
-                // Poly field_poly = Poly(coord, fieldwrap, dx);
-                // // Extension is first done to the temporary field. Otherwise interpolation will be affected.
-                // gd.template get<extend_field_temp>(key) = field_poly(pos);
+                std::cout<<"\n";
             }
-            ++it;
+            gd.template get<curvature_field>(key) = 0.0;
+            continue;
         }
-    }
 
-    // Copy the results to the actual variable
-    typedef typename boost::mpl::at<typename grid_type::value_type::type,boost::mpl::int_<extend_field>>::type type_to_copy;
-    auto it = gd.getDomainIterator();
-    while(it.isNext())
-    {
-        auto key = it.get();
-        if(std::abs(gd.template get<phi_field>(key)) < nb_gamma)
-	  meta_copy<type_to_copy>::meta_copy_(gd.template get<extend_field_temp>(key),gd.template get<extend_field>(key));
-        ++it;
+        // Polynomial of phi in the cell of the closest point, as in extendFieldAtPoints
+        blitz::TinyVector<int,dim> coord;
+        blitz::TinyVector<double,dim> pos;
+        for(int d = 0; d < dim; ++d)
+        {
+            gd.template get<cp_field>(key)[d] = cp(d);
+            coord(d) = static_cast<int>(floor(cp(d) / gd.spacing(d)));
+            pos(d) = cp(d) - coord(d)*gd.spacing(d);
+        }
+
+        AlgoimWrapper<phi_field, grid_type> phiwrap(gd, i);
+        Poly phi_poly = Poly(coord, phiwrap, dx);
+
+        blitz::TinyVector<double,dim> g = phi_poly.grad(pos);
+        blitz::TinyMatrix<double,dim,dim> H = phi_poly.hessian(pos);
+
+        double g2 = 0.0, trH = 0.0, gHg = 0.0;
+        for(int d = 0; d < dim; ++d)
+        {
+            g2 += g(d)*g(d);
+            trH += H(d,d);
+            for(int e = 0; e < dim; ++e)
+                gHg += g(d)*H(d,e)*g(e);
+        }
+        double g_norm = sqrt(g2);
+
+        if (g_norm < std::numeric_limits<double>::epsilon())
+        {
+            for(int d = 0; d < dim; ++d)
+                gd.template get<normal_field>(key)[d] = 0.0;
+            gd.template get<curvature_field>(key) = 0.0;
+            continue;
+        }
+
+        for(int d = 0; d < dim; ++d)
+            gd.template get<normal_field>(key)[d] = g(d) / g_norm;
+        gd.template get<curvature_field>(key) = (g2*trH - gHg) / (g2*g_norm);
     }
 }
 
-/**@brief Reinitializes the level set Phi field on a grid. The grid should have level set SDF and closest point field.
+/**@brief Extends a field to the given narrow band points in parallel, using the closest point coordinates.
  *
- * @tparam phi_field Property id on grid for the level set SDF
  * @tparam cp_field Property id on grid for storing closest point coordinates
+ * @tparam extend_field Property id on grid where the field to be extended resides
+ * @tparam extend_field_temp Property id on grid for storing temporary intermediate values
+ * @tparam poly_order Type of stencil interpolation
  * @tparam grid_type Type of the grid container
-
- * @param gd The distributed grid containing atleast level set SDF field and closest point coordinates
- * @param nb_gamma The width of the narrow band for reinitialization
+ * @tparam key_type Type of the grid keys
+ *
+ * @param gd The distributed grid, with cp_field and extend_field updated in the ghost
+ * @param keys Keys of the narrow band points
  */
-template<size_t phi_field, size_t cp_field, typename grid_type>
-void reinitializeLS(grid_type &gd, const double nb_gamma)
+template<size_t cp_field, size_t extend_field, size_t extend_field_temp, int poly_order, typename grid_type, typename key_type>
+void extendFieldAtPoints(grid_type &gd, const std::vector<key_type> &keys)
 {
     const unsigned int dim = grid_type::dims;
-
-    // Update the cp_field in ghost
-    gd.template ghost_get<cp_field>(KEEP_PROPERTIES);
-
-    auto &patches = gd.getLocalGridsInfo();
     blitz::TinyVector<double,dim> dx;
     for(int d = 0; d < dim; ++d)
         dx(d) = gd.spacing(d);
 
-    grid_key_dx<dim> p_lo;
-    grid_key_dx<dim> p_hi;
+    long int n_keys = keys.size();
 
-    for(int i = 0; i < patches.size();i++)
+    #pragma omp parallel for schedule(dynamic,64)
+    for(long int k = 0; k < n_keys; k++)
     {
+        auto key = keys[k];
+        blitz::TinyVector<int,dim> coord;
+        blitz::TinyVector<double,dim> pos;
+
         for(int d = 0; d < dim; ++d)
         {
-            p_lo.set_d(d, patches.get(i).Dbox.getLow(d) + patches.get(i).origin[d]);
-            p_hi.set_d(d, patches.get(i).Dbox.getHigh(d) + patches.get(i).origin[d]);
+            double cp_d = gd.template get<cp_field>(key)[d];
+            coord(d) = static_cast<int>(floor(cp_d / gd.spacing(d)));
+            pos(d) = cp_d - coord(d)*gd.spacing(d);
         }
 
-        auto it = gd.getSubDomainIterator(p_lo, p_hi);
+        AlgoimWrapper<extend_field, grid_type> fieldwrap(gd,key.getSub());
+        // Extension is first done to the temporary field. Otherwise interpolation will be affected.
+        fieldwrap.template extend<extend_field_temp,poly_order>(coord,dx,pos,key);
+    }
+
+    // Copy the results to the actual variable
+    typedef typename boost::mpl::at<typename grid_type::value_type::type,boost::mpl::int_<extend_field>>::type type_to_copy;
+    #pragma omp parallel for schedule(static)
+    for(long int k = 0; k < n_keys; k++)
+        meta_copy<type_to_copy>::meta_copy_(gd.template get<extend_field_temp>(keys[k]),gd.template get<extend_field>(keys[k]));
+}
+
+/**@brief Reinitializes the level set Phi field at the given narrow band points in parallel.
+ *
+ * @tparam phi_field Property id on grid for the level set SDF
+ * @tparam cp_field Property id on grid for storing closest point coordinates
+ * @tparam grid_type Type of the grid container
+ * @tparam key_type Type of the grid keys
+ *
+ * @param gd The distributed grid
+ * @param keys Keys of the narrow band points
+ */
+template<size_t phi_field, size_t cp_field, typename grid_type, typename key_type>
+void reinitializeAtPoints(grid_type &gd, const std::vector<key_type> &keys)
+{
+    const unsigned int dim = grid_type::dims;
+    long int n_keys = keys.size();
+
+    #pragma omp parallel for schedule(static)
+    for(long int k = 0; k < n_keys; k++)
+    {
+        auto key = keys[k];
+        grid_key_dx<dim> p_lo;
+        grid_key_dx<dim> p_hi;
+        getPatchBounds(gd, key.getSub(), p_lo, p_hi);
+
+        // Preserve the current sign of the SDF
+        double sign_fn = (gd.template get<phi_field>(key) >= 0.0)?1.0:-1.0;
+        auto key_g = gd.getGKey(key);
 
-        while(it.isNext())
+        // Compute the Euclidean distance from gird coordinate to closest point coordinate
+        double distance = 0.0;
+        for(int d = 0; d < dim; ++d)
         {
-            auto key = it.get();
-            if(std::abs(gd.template get<phi_field>(key)) < nb_gamma)
+            // NOTE: This is not the real grid coordinates, but internal coordinates used for algoim
+            double patch_pos = (key_g.get(d) - p_lo.get(d) + algoim_padding) * gd.spacing(d);
+            double cp_d = gd.template get<cp_field>(key)[d];
+            if(cp_d == -100.0)
             {
-                // Preserve the current sign of the SDF
-                double sign_fn = (gd.template get<phi_field>(key) >= 0.0)?1.0:-1.0;
-                auto key_g = gd.getGKey(key);
+                #pragma omp critical
+                std::cout<<"WARNING: Requesting closest point on nodes where it was not computed."<<std::endl;
+            }
 
-                // Compute the Euclidean distance from gird coordinate to closest point coordinate
-                double distance = 0.0;
-                for(int d = 0; d < dim; ++d)
-                {
-                    // NOTE: This is not the real grid coordinates, but internal coordinates used for algoim
-                    double patch_pos = (key_g.get(d) - p_lo.get(d) + algoim_padding) * gd.spacing(d);
-                    double cp_d = gd.template get<cp_field>(key)[d];
-                    if(cp_d == -100.0)
-                        std::cout<<"WARNING: Requesting closest point on nodes where it was not computed."<<std::endl;
+            distance += ((patch_pos - cp_d)*(patch_pos - cp_d));
+        }
+        distance = sqrt(distance);
 
-                    distance += ((patch_pos - cp_d)*(patch_pos - cp_d));
-                }
-                distance = sqrt(distance);
+        gd.template get<phi_field>(key) = sign_fn*distance;
+    }
+}
 
-                gd.template get<phi_field>(key) = sign_fn*distance;
-            }
-            ++it;
+/**@brief Keeps the Algoim structures (cell polynomials, sampled points, KDTree) and the narrow band points between
+ *        closest point operations, such that they are built once for a given level set.
+ *
+ * @details The cached structures depend only on phi_field and nb_gamma: they are rebuilt when nb_gamma changes or
+ *          after invalidate(), which must be called when phi_field is changed outside of this class.
+ *          reinitializeLS() changes phi_field and invalidates the cache by itself.
+ *
+ * \code
+ * ClosestPointContext<phi, poly_order, grid_type> cp_ctx(gd);
+ * cp_ctx.estimateClosestPoint<cp>(nb_gamma);
+ * cp_ctx.extendLSField<cp, field, field_temp>(nb_gamma);
+ * cp_ctx.reinitializeLS<cp>(nb_gamma);
+ * \endcode
+ *
+ * @tparam phi_field Property id on grid for the level set SDF
+ * @tparam poly_order Type of stencil interpolation (Taylor poly orders between 2 to 5 and Tri/bicubic through -1 is supported)
+ * @tparam grid_type Type of the grid container
+ */
+template<size_t phi_field, int poly_order, typename grid_type>
+class ClosestPointContext
+{
+    //! Dimensionality of the grid
+    static const unsigned int dim = grid_type::dims;
+
+    //! Stencil polynomial type
+    using Poly = typename Algoim::StencilPoly<dim, poly_order>::T_Poly;
+
+    //! The distributed grid
+    grid_type &gd;
+
+    //! Algoim structures of the local patches
+    std::vector<ClosestPointPatch<dim,Poly>> cp_patches;
+
+    //! Keys of the narrow band points
+    std::vector<grid_dist_key_dx<dim>> keys;
+
+    //! Narrow band width of the cached keys
+    double nb_gamma_keys = -1.0;
+
+    //! Narrow band width of the cached patch structures
+    double nb_gamma_patches = -1.0;
+
+    //! Update the narrow band keys if needed
+    void updateKeys(const double nb_gamma)
+    {
+        if (nb_gamma_keys != nb_gamma)
+        {
+            getNarrowBandKeys<phi_field>(gd, nb_gamma, keys);
+            nb_gamma_keys = nb_gamma;
         }
     }
+
+public:
+
+    /**@brief Constructor, nothing is built before the first operation.
+     *
+     * @param gd The distributed grid containing at least the level set SDF field
+     */
+    ClosestPointContext(grid_type &gd)
+    : gd(gd)
+    {}
+
+    //! Discard the cached structures, to be called when phi_field changes
+    void invalidate()
+    {
+        nb_gamma_keys = -1.0;
+        nb_gamma_patches = -1.0;
+    }
+
+    /**@brief Computes the closest point coordinate for each grid point within nb_gamma from interface.
+     *
+     * @tparam cp_field Property id on grid for storing closest point coordinates (output)
+     *
+     * @param nb_gamma The width of the narrow band within which closest point estimation is to be done
+     */
+    template<size_t cp_field>
+    void estimateClosestPoint(const double nb_gamma)
+    {
+        if (nb_gamma_patches != nb_gamma)
+        {
+            // Update the phi field in ghosts
+            gd.template ghost_get<phi_field>(KEEP_PROPERTIES);
+            buildClosestPointPatches<phi_field>(gd, nb_gamma, cp_patches);
+            nb_gamma_patches = nb_gamma;
+        }
+        updateKeys(nb_gamma);
+
+        computeClosestPoints<cp_field>(gd, cp_patches, keys);
+    }
+
+    /**@brief Computes closest point, unit normal and mean curvature for each grid point within nb_gamma from interface.
+     *
+     * @details Same as estimateClosestPoint() followed by normal and curvature passes on phi_field, but normal and
+     *          curvature come from the phi polynomial at the closest point (see #computeClosestPointGeometry()), in
+     *          one pass and without other ghost exchanges.
+     *
+     * @tparam cp_field Property id on grid for storing closest point coordinates (output)
+     * @tparam normal_field Property id on grid for storing the unit normal (output)
+     * @tparam curvature_field Property id on grid for storing the mean curvature (output)
+     *
+     * @param nb_gamma The width of the narrow band within which closest point estimation is to be done
+     */
+    template<size_t cp_field, size_t normal_field, size_t curvature_field>
+    void estimateClosestPointGeometry(const double nb_gamma)
+    {
+        if (nb_gamma_patches != nb_gamma)
+        {
+            // Update the phi field in ghosts
+            gd.template ghost_get<phi_field>(KEEP_PROPERTIES);
+            buildClosestPointPatches<phi_field>(gd, nb_gamma, cp_patches);
+            nb_gamma_patches = nb_gamma;
+        }
+        updateKeys(nb_gamma);
+
+        computeClosestPointGeometry<phi_field, cp_field, normal_field, curvature_field, poly_order>(gd, cp_patches, keys);
+    }
+
+    /**@brief Extends a field to within nb_gamma from interface, using the closest point coordinates.
+     *
+     * @tparam cp_field Property id on grid for storing closest point coordinates
+     * @tparam extend_field Property id on grid where the field to be extended resides
+     * @tparam extend_field_temp Property id on grid for storing temporary intermediate values
+     *
+     * @param nb_gamma The width of the narrow band within which extension is required (half band)
+     */
+    template<size_t cp_field, size_t extend_field, size_t extend_field_temp>
+    void extendLSField(const double nb_gamma)
+    {
+        // Update the phi and cp fields in ghost
+        gd.template ghost_get<phi_field, cp_field, extend_field>(KEEP_PROPERTIES);
+        updateKeys(nb_gamma);
+
+        extendFieldAtPoints<cp_field, extend_field, extend_field_temp, poly_order>(gd, keys);
+    }
+
+    /**@brief Reinitializes the level set Phi field within nb_gamma from interface and invalidates the cache.
+     *
+     * @tparam cp_field Property id on grid for storing closest point coordinates
+     *
+     * @param nb_gamma The width of the narrow band for reinitialization
+     */
+    template<size_t cp_field>
+    void reinitializeLS(const double nb_gamma)
+    {
+        // Update the cp_field in ghost
+        gd.template ghost_get<cp_field>(KEEP_PROPERTIES);
+        updateKeys(nb_gamma);
+
+        reinitializeAtPoints<phi_field, cp_field>(gd, keys);
+        invalidate();
+    }
+};
+
+/**@brief Computes the closest point coordinate for each grid point within nb_gamma from interface.
+ *
+ * @details The Algoim structures of the patches are built in parallel over the patches, then the closest points of
+ *          all the narrow band points are computed in parallel over the points, such that large patches are also
+ *          split among the OpenMP threads. Use #ClosestPointContext to keep the structures between calls.
+ *
+ * @tparam phi_field Property id on grid for the level set SDF (input)
+ * @tparam cp_field Property id on grid for storing closest point coordinates (output)
+ * @tparam poly_order Type of stencil interpolation (Taylor poly orders between 2 to 5 and Tri/bicubic through -1 is supported)
+ * @tparam grid_type Type of the grid container
+ *
+ * @param gd The distributed grid containing at least level set SDF field and placeholder for closest point coordinates
+ * @param nb_gamma The width of the narrow band within which closest point estimation is to be done
+ * 
+ */
+template<size_t phi_field, size_t cp_field, int poly_order, typename grid_type>
+void estimateClosestPoint(grid_type &gd, const double nb_gamma)
+{
+    ClosestPointContext<phi_field, poly_order, grid_type> cp_ctx(gd);
+    cp_ctx.template estimateClosestPoint<cp_field>(nb_gamma);
+}
+
+/**@brief Computes closest point, unit normal and mean curvature for each grid point within nb_gamma from interface.
+ *
+ * @details The normal is grad(phi)/|grad(phi)| and the curvature its divergence, both evaluated at the closest point
+ *          on the phi polynomial used to find it. Use #ClosestPointContext to keep the structures between calls.
+ *
+ * @tparam phi_field Property id on grid for the level set SDF (input)
+ * @tparam cp_field Property id on grid for storing closest point coordinates (output)
+ * @tparam normal_field Property id on grid for storing the unit normal (output)
+ * @tparam curvature_field Property id on grid for storing the mean curvature (output)
+ * @tparam poly_order Type of stencil interpolation (Taylor poly orders between 2 to 5 and Tri/bicubic through -1 is supported)
+ * @tparam grid_type Type of the grid container
+ *
+ * @param gd The distributed grid containing at least level set SDF field and placeholders for the outputs
+ * @param nb_gamma The width of the narrow band within which closest point estimation is to be done
+ */
+template<size_t phi_field, size_t cp_field, size_t normal_field, size_t curvature_field, int poly_order, typename grid_type>
+void estimateClosestPointGeometry(grid_type &gd, const double nb_gamma)
+{
+    ClosestPointContext<phi_field, poly_order, grid_type> cp_ctx(gd);
+    cp_ctx.template estimateClosestPointGeometry<cp_field, normal_field, curvature_field>(nb_gamma);
+}
+
+/**@brief Extends a (scalar) field to within nb_gamma from interface. The grid should have level set SDF and closest point field.
+ *
+ * @details The narrow band points are processed in parallel by the OpenMP threads.
+ *
+ * @tparam phi_field Property id on grid for the level set SDF
+ * @tparam cp_field Property id on grid for storing closest point coordinates
+ * @tparam extend_field Property id on grid where the field to be extended resides
+ * @tparam extend_field_temp Property id on grid for storing temporary intermediate values
+ * @tparam poly_order Type of stencil interpolation (Taylor poly orders between 2 to 5 and Tri/bicubic through -1 is supported)
+ * @tparam grid_type Type of the grid container
+ *
+ * @param gd The distributed grid containing atleast level set SDF field and closest point coordinates
+ * @param nb_gamma The width of the narrow band within which extension is required (half band)
+ */
+template<size_t phi_field, size_t cp_field, size_t extend_field, size_t extend_field_temp, int poly_order, typename grid_type>
+void extendLSField(grid_type &gd, const double nb_gamma)
+{
+    ClosestPointContext<phi_field, poly_order, grid_type> cp_ctx(gd);
+    cp_ctx.template extendLSField<cp_field, extend_field, extend_field_temp>(nb_gamma);
+}
+
+/**@brief Reinitializes the level set Phi field on a grid. The grid should have level set SDF and closest point field.
+ *
+ * @details The narrow band points are processed in parallel by the OpenMP threads.
+ *
+ * @tparam phi_field Property id on grid for the level set SDF
+ * @tparam cp_field Property id on grid for storing closest point coordinates
+ * @tparam grid_type Type of the grid container
+
+ * @param gd The distributed grid containing atleast level set SDF field and closest point coordinates
+ * @param nb_gamma The width of the narrow band for reinitialization
+ */
+template<size_t phi_field, size_t cp_field, typename grid_type>
+void reinitializeLS(grid_type &gd, const double nb_gamma)
+{
+    // Update the cp_field in ghost
+    gd.template ghost_get<cp_field>(KEEP_PROPERTIES);
+
+    std::vector<grid_dist_key_dx<grid_type::dims>> keys;
+    getNarrowBandKeys<phi_field>(gd, nb_gamma, keys);
+    reinitializeAtPoints<phi_field, cp_field>(gd, keys);
 }
 
 #endif //__CLOSEST_POINT_HPP__
@@ -0,0 +1,482 @@
+/**
+ * @file closest_point_gpu.cuh
+ *
+ *
+ * @brief Closest point computation on OpenFPM grids with GPU local grids.
+ *
+ * @details Device version of #estimateClosestPoint(). The same steps as the Algoim engine are done on the device for
+ *          every local grid patch, padded by #algoim_padding nodes:
+ *          - the cells containing the interface are found and a seed point on the interface is computed in each one
+ *            (Newton projection of the cell center along the gradient),
+ *          - every narrow band node looks up the nearest seed in the cells around it (uniform cell lookup, the seeds
+ *            are stored per cell),
+ *          - the closest point is found with the Newton iterations of the Lagrange multiplier formulation
+ *            (R. Saye, "High-order methods for computing distances to implicitly defined surfaces" (2014)), bounded
+ *            to a ball of radius 0.5 dx around the seed.
+ *
+ *          The level set is interpolated by the tensor product cubic polynomial of the 4^dim nodes around the point
+ *          (the bi/tricubic interpolation). The closest points are written in the patch coordinates of
+ *          closest_point.hpp, such that #extendLSField() and #reinitializeLS() can use them (after deviceToHost).
+ */
+
+#ifndef __CLOSEST_POINT_GPU_CUH__
+#define __CLOSEST_POINT_GPU_CUH__
+
+#if defined(__NVCC__)
+
+#include "Grid/grid_dist_id.hpp"
+#include "closest_point.hpp"
+#include "FiniteDifference/FD_grid_gpu.cuh"
+
+//! Value of the closest point coordinates on the nodes where the computation failed (as on the CPU)
+constexpr double cp_gpu_fail = -100.0;
+
+//! Maximum number of Newton iterations
+constexpr int cp_gpu_max_newton = 20;
+
+/**@brief Tensor product cubic interpolation of a grid property, with gradient and Hessian.
+ *
+ * @tparam phi_field Property id on grid for the level set
+ *
+ * @param g Local grid (kernel view)
+ * @param u Point in local grid coordinates (units of the grid spacing, node k at u = k)
+ * @param gd_hi Last allocated node of the local grid, the stencil is clamped to the local grid
+ * @param h Grid spacing
+ * @param val Interpolated value (output)
+ * @param grad Gradient (output)
+ * @param hess Hessian (output)
+ */
+template<unsigned int phi_field, unsigned int dim, typename grid_type>
+__device__ inline void cp_gpu_interpolate(grid_type & g, const double (& u)[dim], const grid_key_dx<dim,int> & gd_hi,
+                                          const double (& h)[dim], double & val, double (& grad)[dim],
+                                          double (& hess)[dim][dim])
+{
+	int base[dim];
+	double B[dim][4], D1[dim][4], D2[dim][4];
+
+	for (unsigned int d = 0 ; d < dim ; d++)
+	{
+		base[d] = (int)floor(u[d]) - 1;
+		double t = u[d] - (base[d] + 1);
+
+		// Lagrange basis on the nodes -1, 0, 1, 2 and its derivatives
+		B[d][0] = -t*(t-1)*(t-2)/6.0;
+		B[d][1] = (t+1)*(t-1)*(t-2)/2.0;
+		B[d][2] = -(t+1)*t*(t-2)/2.0;
+		B[d][3] = (t+1)*t*(t-1)/6.0;
+
+		D1[d][0] = -(3*t*t - 6*t + 2)/6.0 / h[d];
+		D1[d][1] = (3*t*t - 4*t - 1)/2.0 / h[d];
+		D1[d][2] = -(3*t*t - 2*t - 2)/2.0 / h[d];
+		D1[d][3] = (3*t*t - 1)/6.0 / h[d];
+
+		D2[d][0] = -(t-1) / (h[d]*h[d]);
+		D2[d][1] = (3*t-2) / (h[d]*h[d]);
+		D2[d][2] = -(3*t-1) / (h[d]*h[d]);
+		D2[d][3] = t / (h[d]*h[d]);
+	}
+
+	val = 0.0;
+	for (unsigned int d = 0 ; d < dim ; d++)
+	{
+		grad[d] = 0.0;
+		for (unsigned int e = 0 ; e < dim ; e++)	{hess[d][e] = 0.0;}
+	}
+
+	int n_st = 1;
+	for (unsigned int d = 0 ; d < dim ; d++)	{n_st *= 4;}
+
+	for (int s = 0 ; s < n_st ; s++)
+	{
+		int a[dim];
+		grid_key_dx<dim,int> k;
+		int r = s;
+		for (unsigned int d = 0 ; d < dim ; d++)
+		{
+			a[d] = r % 4;
+			r /= 4;
+			int x = base[d] + a[d];
+			x = (x < 0)?0:x;
+			x = (x > gd_hi.get(d))?gd_hi.get(d):x;
+			k.set_d(d,x);
+		}
+
+		double phi = g.template get<phi_field>(k);
+
+		double w = phi;
+		for (unsigned int d = 0 ; d < dim ; d++)	{w *= B[d][a[d]];}
+		val += w;
+
+		for (unsigned int e = 0 ; e < dim ; e++)
+		{
+			double we = phi;
+			for (unsigned int d = 0 ; d < dim ; d++)	{we *= (d == e)?D1[d][a[d]]:B[d][a[d]];}
+			grad[e] += we;
+
+			for (unsigned int f = e ; f < dim ; f++)
+			{
+				double wef = phi;
+				for (unsigned int d = 0 ; d < dim ; d++)
+				{
+					if (d == e && d == f)	{wef *= D2[d][a[d]];}
+					else if (d == e || d == f)	{wef *= D1[d][a[d]];}
+					else	{wef *= B[d][a[d]];}
+				}
+				hess[e][f] += wef;
+			}
+		}
+	}
+
+	for (unsigned int e = 0 ; e < dim ; e++)
+	{
+		for (unsigned int f = 0 ; f < e ; f++)	{hess[e][f] = hess[f][e];}
+	}
+}
+
+/**@brief Solves the linear system A x = b of size n with Gaussian elimination and partial pivoting.
+ *
+ * @return false if the matrix is singular.
+ */
+template<unsigned int n>
+__device__ inline bool cp_gpu_solve(double (& A)[n][n], double (& b)[n], double (& x)[n])
+{
+	for (unsigned int c = 0 ; c < n ; c++)
+	{
+		unsigned int p = c;
+		for (unsigned int r = c + 1 ; r < n ; r++)
+		{
+			if (fabs(A[r][c]) > fabs(A[p][c]))	{p = r;}
+		}
+		if (A[p][c] == 0.0)	{return false;}
+
+		for (unsigned int j = 0 ; j < n ; j++)
+		{
+			double tmp = A[c][j]; A[c][j] = A[p][j]; A[p][j] = tmp;
+		}
+		double tmp = b[c]; b[c] = b[p]; b[p] = tmp;
+
+		for (unsigned int r = c + 1 ; r < n ; r++)
+		{
+			double m = A[r][c] / A[c][c];
+			for (unsigned int j = c ; j < n ; j++)	{A[r][j] -= m * A[c][j];}
+			b[r] -= m * b[c];
+		}
+	}
+
+	for (int r = n - 1 ; r >= 0 ; r--)
+	{
+		double s = b[r];
+		for (unsigned int j = r + 1 ; j < n ; j++)	{s -= A[r][j] * x[j];}
+		x[r] = s / A[r][r];
+	}
+
+	return true;
+}
+
+/**@brief Kernel finding the cells with the interface of a padded patch and their seed point.
+ *
+ * @details The cell with lower corner c contains the interface if phi changes sign on its corners. The seed is the
+ *          cell center projected on the interface with a few Newton steps along the gradient, kept in the cell.
+ *
+ * @param g Local grid (kernel view)
+ * @param ite GPU iterator over the lower corners of the cells of the padded patch
+ * @param gd_hi Last allocated node of the local grid
+ * @param h Grid spacing
+ * @param seeds Seed point (property 0, local grid coordinates) and flag (property 1) of every cell, indexed by the
+ *        linearized lower corner in the local grid
+ */
+template<unsigned int dim, unsigned int phi_field, typename grid_type, typename seeds_type>
+__global__ void cp_gpu_seeds_ker(grid_type g, ite_gpu<dim> ite, grid_key_dx<dim,int> gd_hi, Point<dim,double> h_,
+                                 seeds_type seeds)
+{
+	grid_key_dx<dim,int> c;
+	if (fd_gpu_key(ite,c) == false)	{return;}
+
+	int lin = 0;
+	int stride = 1;
+	for (unsigned int d = 0 ; d < dim ; d++)
+	{
+		lin += c.get(d) * stride;
+		stride *= gd_hi.get(d) + 1;
+	}
+
+	bool pos = false, neg = false;
+	for (int s = 0 ; s < (1 << dim) ; s++)
+	{
+		grid_key_dx<dim,int> k;
+		for (unsigned int d = 0 ; d < dim ; d++)	{k.set_d(d,c.get(d) + ((s >> d) & 1));}
+		double phi = g.template get<phi_field>(k);
+		if (phi >= 0.0)	{pos = true;}
+		if (phi <= 0.0)	{neg = true;}
+	}
+
+	seeds.template get<1>(lin) = 0;
+	if (pos == false || neg == false)	{return;}
+
+	double h[dim];
+	double u[dim];
+	for (unsigned int d = 0 ; d < dim ; d++)
+	{
+		h[d] = h_.get(d);
+		u[d] = c.get(d) + 0.5;
+	}
+
+	for (int it = 0 ; it < 5 ; it++)
+	{
+		double val, grad[dim], hess[dim][dim];
+		cp_gpu_interpolate<phi_field>(g,u,gd_hi,h,val,grad,hess);
+
+		double g2 = 0.0;
+		for (unsigned int d = 0 ; d < dim ; d++)	{g2 += grad[d] * grad[d];}
+		if (g2 == 0.0)	{break;}
+
+		for (unsigned int d = 0 ; d < dim ; d++)
+		{
+			u[d] -= val * grad[d] / g2 / h[d];
+			u[d] = (u[d] < c.get(d))?c.get(d):u[d];
+			u[d] = (u[d] > c.get(d) + 1)?c.get(d) + 1:u[d];
+		}
+	}
+
+	for (unsigned int d = 0 ; d < dim ; d++)	{seeds.template get<0>(lin)[d] = u[d];}
+	seeds.template get<1>(lin) = 1;
+}
+
+/**@brief Kernel computing the closest point of the narrow band nodes of a patch.
+ *
+ * @param g Local grid (kernel view)
+ * @param ite GPU iterator over the domain of the patch
+ * @param gd_hi Last allocated node of the local grid
+ * @param c_lo Lower corner of the cells with seeds (padded patch)
+ * @param c_hi Upper corner of the cells with seeds (padded patch)
+ * @param d_lo Lower corner of the domain of the patch, for the patch coordinates of closest_point.hpp
+ * @param h Grid spacing
+ * @param seeds Seeds of the cells, see #cp_gpu_seeds_ker()
+ * @param nb_gamma The width of the narrow band
+ * @param tol Squared tolerance of the Newton iterations
+ * @param n_fail Number of nodes where the computation failed (output)
+ */
+template<unsigned int dim, unsigned int phi_field, unsigned int cp_field, typename grid_type, typename seeds_type,
+         typename fail_type>
+__global__ void cp_gpu_closest_point_ker(grid_type g, ite_gpu<dim> ite, grid_key_dx<dim,int> gd_hi,
+                                         grid_key_dx<dim,int> c_lo, grid_key_dx<dim,int> c_hi,
+                                         grid_key_dx<dim,int> d_lo, Point<dim,double> h_, seeds_type seeds,
+                                         double nb_gamma, double tol, fail_type n_fail)
+{
+	grid_key_dx<dim,int> key;
+	if (fd_gpu_key(ite,key) == false)	{return;}
+
+	if (fabs(g.template get<phi_field>(key)) >= nb_gamma)	{return;}
+
+	double h[dim];
+	double h_max = 0.0;
+	for (unsigned int d = 0 ; d < dim ; d++)
+	{
+		h[d] = h_.get(d);
+		h_max = (h[d] > h_max)?h[d]:h_max;
+	}
+
+	// Nearest seed within nb_gamma + dx (as the band radius of the CPU engine)
+	double r_search = nb_gamma + h[0];
+	double best = r_search * r_search;
+	double y0[dim];
+	bool found = false;
+
+	int lo[dim], n[dim];
+	int n_cells = 1;
+	for (unsigned int d = 0 ; d < dim ; d++)
+	{
+		int r = (int)ceil(r_search / h[d]);
+		lo[d] = max(key.get(d) - r, c_lo.get(d));
+		int hi = min(key.get(d) + r, c_hi.get(d));
+		n[d] = hi - lo[d] + 1;
+		if (n[d] <= 0)	{n_cells = 0;}
+		n_cells *= (n[d] > 0)?n[d]:1;
+	}
+
+	for (int s = 0 ; s < n_cells ; s++)
+	{
+		int lin = 0;
+		int stride = 1;
+		int r = s;
+		for (unsigned int d = 0 ; d < dim ; d++)
+		{
+			lin += (lo[d] + r % n[d]) * stride;
+			r /= n[d];
+			stride *= gd_hi.get(d) + 1;
+		}
+
+		if (seeds.template get<1>(lin) == 0)	{continue;}
+
+		double dist = 0.0;
+		for (unsigned int d = 0 ; d < dim ; d++)
+		{
+			double dx = (seeds.template get<0>(lin)[d] - key.get(d)) * h[d];
+			dist += dx * dx;
+		}
+		if (dist < best)
+		{
+			best = dist;
+			found = true;
+			for (unsigned int d = 0 ; d < dim ; d++)	{y0[d] = seeds.template get<0>(lin)[d];}
+		}
+	}
+
+	// Newton iterations on (y, lambda): y - x + lambda grad phi(y) = 0, phi(y) = 0, in physical units from the node
+	bool converged = false;
+	double y[dim];
+	if (found == true)
+	{
+		double u[dim], val, grad[dim], hess[dim][dim];
+		for (unsigned int d = 0 ; d < dim ; d++)	{y[d] = (y0[d] - key.get(d)) * h[d]; u[d] = y0[d];}
+
+		cp_gpu_interpolate<phi_field>(g,u,gd_hi,h,val,grad,hess);
+		double g2 = 0.0, lambda = 0.0;
+		for (unsigned int d = 0 ; d < dim ; d++)	{g2 += grad[d] * grad[d]; lambda -= y[d] * grad[d];}
+		lambda = (g2 > 0.0)?lambda / g2:0.0;
+
+		for (int it = 0 ; it < cp_gpu_max_newton && converged == false ; it++)
+		{
+			double A[dim+1][dim+1], b[dim+1], delta[dim+1];
+			for (unsigned int d = 0 ; d < dim ; d++)
+			{
+				for (unsigned int e = 0 ; e < dim ; e++)	{A[d][e] = lambda * hess[d][e] + ((d == e)?1.0:0.0);}
+				A[d][dim] = grad[d];
+				A[dim][d] = grad[d];
+				b[d] = -(y[d] + lambda * grad[d]);
+			}
+			A[dim][dim] = 0.0;
+			b[dim] = -val;
+
+			if (cp_gpu_solve<dim+1>(A,b,delta) == false)	{break;}
+
+			double step2 = 0.0;
+			for (unsigned int d = 0 ; d < dim ; d++)
+			{
+				y[d] += delta[d];
+				step2 += delta[d] * delta[d];
+			}
+			lambda += delta[dim];
+
+			// stay in the ball of radius 0.5 dx around the seed
+			double off2 = 0.0;
+			for (unsigned int d = 0 ; d < dim ; d++)
+			{
+				double o = y[d] - (y0[d] - key.get(d)) * h[d];
+				off2 += o * o;
+			}
+			if (off2 > 0.25 * h_max * h_max)
+			{
+				double scale = 0.5 * h_max / sqrt(off2);
+				for (unsigned int d = 0 ; d < dim ; d++)
+				{
+					double o = y[d] - (y0[d] - key.get(d)) * h[d];
+					y[d] = (y0[d] - key.get(d)) * h[d] + scale * o;
+				}
+			}
+
+			for (unsigned int d = 0 ; d < dim ; d++)	{u[d] = key.get(d) + y[d] / h[d];}
+			cp_gpu_interpolate<phi_field>(g,u,gd_hi,h,val,grad,hess);
+
+			if (step2 < tol)	{converged = true;}
+		}
+	}
+
+	if (converged == true)
+	{
+		// patch coordinates of closest_point.hpp
+		for (unsigned int d = 0 ; d < dim ; d++)
+		{g.template get<cp_field>(key)[d] = (key.get(d) - d_lo.get(d) + algoim_padding) * h[d] + y[d];}
+	}
+	else
+	{
+		for (unsigned int d = 0 ; d < dim ; d++)	{g.template get<cp_field>(key)[d] = cp_gpu_fail;}
+		atomicAdd(&n_fail.template get<0>(0), 1u);
+	}
+}
+
+/**@brief Computes the closest point coordinate for each grid point within nb_gamma from interface, on the device.
+ *
+ * @details Same narrow band (|phi| < nb_gamma) and output of #estimateClosestPoint(): the closest points are written
+ *          in the patch coordinates of closest_point.hpp, the nodes where the Newton iterations do not converge get
+ *          -100. phi_field is read from the device and cp_field is written on the device. The ghost layer should be
+ *          at least #algoim_padding wide.
+ *
+ * @tparam phi_field Property id on grid for the level set SDF (input)
+ * @tparam cp_field Property id on grid for storing closest point coordinates (output)
+ * @tparam grid_type Type of the grid container (GPU local grids)
+ *
+ * @param gd The distributed grid containing at least level set SDF field and placeholder for closest point coordinates
+ * @param nb_gamma The width of the narrow band within which closest point estimation is to be done
+ */
+template<size_t phi_field, size_t cp_field, typename grid_type>
+void estimateClosestPointGPU(grid_type &gd, const double nb_gamma)
+{
+	const unsigned int dim = grid_type::dims;
+	static_assert(dim <= 3, "estimateClosestPointGPU is implemented up to 3D");
+
+	gd.template ghost_get<phi_field>(RUN_ON_DEVICE | KEEP_PROPERTIES);
+
+	Point<dim,double> h;
+	double h_max = 0.0;
+	for (unsigned int d = 0 ; d < dim ; d++)
+	{
+		h.get(d) = gd.spacing(d);
+		h_max = std::max(h_max, (double)gd.spacing(d));
+	}
+	// cubic interpolation: same tolerance of the CPU engine with a third order polynomial
+	double tol = std::max(1.0e-14, std::pow(h_max, 3));
+	tol = tol * tol;
+
+	openfpm::vector_custd<aggregate<double[dim], int>> seeds;
+	openfpm::vector_custd<aggregate<unsigned int>> n_fail;
+	n_fail.resize(1);
+	n_fail.template get<0>(0) = 0;
+	n_fail.template hostToDevice<0>();
+
+	auto & patches = gd.getLocalGridsInfo();
+	for (size_t i = 0 ; i < patches.size() ; i++)
+	{
+		auto & Dbox = patches.get(i).Dbox;
+		auto & GDbox = patches.get(i).GDbox;
+
+		grid_key_dx<dim,int> gd_hi, c_lo, c_hi, d_lo;
+		grid_key_dx<dim,long int> start, stop, d_start, d_stop;
+		bool empty = false;
+		size_t n_alloc = 1;
+		for (unsigned int d = 0 ; d < dim ; d++)
+		{
+			gd_hi.set_d(d,GDbox.getHigh(d) - GDbox.getLow(d));
+			c_lo.set_d(d,std::max((long int)Dbox.getLow(d) - algoim_padding, 0l));
+			c_hi.set_d(d,std::min((long int)Dbox.getHigh(d) + algoim_padding, (long int)gd_hi.get(d) - 1));
+			d_lo.set_d(d,Dbox.getLow(d));
+			start.set_d(d,c_lo.get(d));
+			stop.set_d(d,c_hi.get(d));
+			d_start.set_d(d,Dbox.getLow(d));
+			d_stop.set_d(d,Dbox.getHigh(d));
+			n_alloc *= gd_hi.get(d) + 1;
+			if (Dbox.getHigh(d) < Dbox.getLow(d) || c_hi.get(d) < c_lo.get(d))	{empty = true;}
+		}
+		if (empty == true)	{continue;}
+
+		auto & lg = gd.get_loc_grid(i);
+		seeds.resize(n_alloc);
+
+		auto ite_c = lg.getGPUIterator(start,stop);
+		CUDA_LAUNCH((cp_gpu_seeds_ker<dim,phi_field>),ite_c,lg.toKernel(),ite_c,gd_hi,h,seeds.toKernel());
+
+		auto ite = lg.getGPUIterator(d_start,d_stop);
+		CUDA_LAUNCH((cp_gpu_closest_point_ker<dim,phi_field,cp_field>),ite,lg.toKernel(),ite,gd_hi,c_lo,c_hi,d_lo,h,
+		            seeds.toKernel(),nb_gamma,tol,n_fail.toKernel());
+	}
+
+	n_fail.template deviceToHost<0>();
+	if (n_fail.template get<0>(0) != 0)
+	{
+		std::cout << "WARN: Closest point computation fails at " << n_fail.template get<0>(0) << " nodes\n";
+	}
+}
+
+#endif
+
+#endif //__CLOSEST_POINT_GPU_CUH__
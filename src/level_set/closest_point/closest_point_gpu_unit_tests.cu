@@ -0,0 +1,95 @@
+/* Unit tests for the closest point method on GPU local grids
+ */
+
+#include "config.h"
+#define BOOST_TEST_DYN_LINK
+#include <boost/test/unit_test.hpp>
+
+#ifdef HAVE_ALGOIM
+
+#include "Grid/grid_dist_id.hpp"
+#include "level_set/closest_point/closest_point_gpu.cuh"
+
+BOOST_AUTO_TEST_SUITE( closest_point_gpu_test )
+
+BOOST_AUTO_TEST_CASE( closest_point_gpu_sphere )
+{
+    constexpr int SIM_DIM = 3;
+    constexpr int SIM_GRID_SIZE = 64;
+    constexpr int narrow_band_half_width = 5;
+
+    // Properties - phi, cp
+    typedef aggregate<double,double[SIM_DIM]> props;
+    typedef grid_dist_id<SIM_DIM, double, props, CartDecomposition<SIM_DIM, double, CudaMemory, memory_traits_inte>,
+                         CudaMemory, grid_gpu<SIM_DIM, props>> GridDist;
+
+    const size_t szu[SIM_DIM] = {SIM_GRID_SIZE, SIM_GRID_SIZE, SIM_GRID_SIZE};
+    Box<SIM_DIM,double> domain({-1.5,-1.5,-1.5},{1.5,1.5,1.5});
+
+    constexpr int phi = 0;
+    constexpr int cp = 1;
+
+    periodicity<SIM_DIM> grid_bc = {NON_PERIODIC, NON_PERIODIC, NON_PERIODIC};
+    Ghost <SIM_DIM, long int> grid_ghost(2*narrow_band_half_width);
+    GridDist gdist(szu, domain, grid_ghost, grid_bc);
+
+    // Signed distance of a sphere of radius R, positive inside
+    const double R = 1.0;
+    auto it = gdist.getDomainIterator();
+    while(it.isNext())
+    {
+        auto key = it.get();
+        Point<SIM_DIM, double> coords = gdist.getPos(key);
+        gdist.template get<phi>(key) = R - coords.distance(Point<SIM_DIM, double>({0.0,0.0,0.0}));
+        ++it;
+    }
+    gdist.template hostToDevice<phi>();
+
+    double nb_gamma = narrow_band_half_width * gdist.spacing(0);
+
+    estimateClosestPointGPU<phi, cp>(gdist, nb_gamma);
+    gdist.template deviceToHost<cp>();
+
+    // The closest points are in patch coordinates, they lie on the sphere and on the ray of the node
+    auto &patches = gdist.getLocalGridsInfo();
+    double max_error_r = 0.0;
+    double max_error_dir = 0.0;
+    size_t n_band = 0;
+    auto it2 = gdist.getDomainIterator();
+    while(it2.isNext())
+    {
+        auto key = it2.get();
+
+        if(std::abs(gdist.template get<phi>(key)) < nb_gamma)
+        {
+            Point<SIM_DIM, double> coords = gdist.getPos(key);
+            double norm = coords.distance(Point<SIM_DIM, double>({0.0,0.0,0.0}));
+
+            double estim[SIM_DIM];
+            double r2 = 0.0;
+            for(int d = 0; d < SIM_DIM; ++d)
+            {
+                BOOST_REQUIRE(gdist.template get<cp>(key)[d] != cp_gpu_fail);
+
+                long int p_lo = patches.get(key.getSub()).Dbox.getLow(d) + patches.get(key.getSub()).origin[d];
+                estim[d] = domain.getLow(d) + (p_lo - algoim_padding)*gdist.spacing(d) + gdist.template get<cp>(key)[d];
+                r2 += estim[d]*estim[d];
+            }
+
+            for(int d = 0; d < SIM_DIM; ++d)
+                max_error_dir = std::max(max_error_dir, std::abs(estim[d] - R*coords.get(d)/norm));
+
+            max_error_r = std::max(max_error_r, std::abs(sqrt(r2) - R));
+            n_band++;
+        }
+        ++it2;
+    }
+
+    BOOST_REQUIRE(n_band > 0);
+    BOOST_REQUIRE(max_error_r < 1e-4);
+    BOOST_REQUIRE(max_error_dir < 1e-3);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
+
+#endif
@@ -3,12 +3,17 @@
  * Author : sachin
  */
 
+#include "config.h"
 #include<iostream>
 #include <boost/test/unit_test_log.hpp>
 #include <cmath>
 #define BOOST_TEST_DYN_LINK
 #include <boost/test/unit_test.hpp>
 #include <iostream>
+
+// the closest point methods need Algoim (and blitz)
+#ifdef HAVE_ALGOIM
+
 #include "Grid/grid_dist_id.hpp"
 #include "data_type/aggregate.hpp"
 #include "VCluster/VCluster.hpp"
@@ -398,4 +403,151 @@ BOOST_AUTO_TEST_CASE( extension_unit_sphere )
 
 }
 
-BOOST_AUTO_TEST_SUITE_END()
\ No newline at end of file
+BOOST_AUTO_TEST_CASE( normal_curvature_unit_sphere )
+{
+
+    constexpr int SIM_DIM = 3;
+    constexpr int POLY_ORDER = 5;
+    constexpr int SIM_GRID_SIZE = 128;
+
+    // Fields - phi, cp, normal, curvature
+    using GridDist = grid_dist_id<SIM_DIM,double,aggregate<double,double[SIM_DIM],double[SIM_DIM],double>>;
+
+    const size_t szu[SIM_DIM] = {SIM_GRID_SIZE, SIM_GRID_SIZE, SIM_GRID_SIZE};
+
+    Box<SIM_DIM,double> domain({-1.5,-1.5,-1.5},{1.5,1.5,1.5});
+
+    // Alias for properties on the grid
+    constexpr int phi = 0;
+    constexpr int cp = 1;
+    constexpr int normal = 2;
+    constexpr int curvature = 3;
+
+    periodicity<SIM_DIM> grid_bc = {NON_PERIODIC, NON_PERIODIC, NON_PERIODIC};
+    Ghost <SIM_DIM, long int> grid_ghost(2*narrow_band_half_width);
+    GridDist gdist(szu, domain, grid_ghost, grid_bc);
+
+    EllipseParams params;
+    params.origin[0] = 0.0;
+    params.origin[1] = 0.0;
+    params.origin[2] = 0.0;
+    params.radiusA = 1.0;
+    params.radiusB = 1.0;
+    params.radiusC = 1.0;
+
+    double nb_gamma = narrow_band_half_width * gdist.spacing(0);
+
+    initializeLSEllipsoid<phi>(gdist, params);
+
+    estimateClosestPointGeometry<phi, cp, normal, curvature, POLY_ORDER>(gdist, nb_gamma);
+
+    // phi is positive inside the unit sphere: n = -x/|x| and div(n) = -2
+    double max_error_n = -1.0;
+    double max_error_k = -1.0;
+    auto it = gdist.getDomainIterator();
+    while(it.isNext())
+    {
+        auto key = it.get();
+
+        if(std::abs(gdist.template get<phi>(key)) < nb_gamma)
+        {
+            Point<GridDist::dims, double> coords = gdist.getPos(key);
+            double norm = sqrt(coords.get(0)*coords.get(0) + coords.get(1)*coords.get(1) + coords.get(2)*coords.get(2));
+
+            for(int d = 0; d < SIM_DIM; ++d)
+                max_error_n = std::max(std::abs(gdist.template get<normal>(key)[d] + coords.get(d)/norm), max_error_n);
+
+            max_error_k = std::max(std::abs(gdist.template get<curvature>(key) + 2.0), max_error_k);
+        }
+        ++it;
+    }
+    std::cout<<"Unit sphere normal error : "<<max_error_n<<" curvature error : "<<max_error_k<<std::endl;
+
+    BOOST_TEST( max_error_n < 1e-4 );
+    BOOST_TEST( max_error_k < 1e-3 );
+
+}
+
+BOOST_AUTO_TEST_CASE( closest_point_context_reuse )
+{
+
+    constexpr int SIM_DIM = 3;
+    constexpr int POLY_ORDER = 3;
+    constexpr int SIM_GRID_SIZE = 64;
+
+    // Fields - phi, cp of the free function, cp of the context
+    using GridDist = grid_dist_id<SIM_DIM,double,aggregate<double,double[SIM_DIM],double[SIM_DIM]>>;
+
+    const size_t szu[SIM_DIM] = {SIM_GRID_SIZE, SIM_GRID_SIZE, SIM_GRID_SIZE};
+
+    Box<SIM_DIM,double> domain({-1.5,-1.5,-1.5},{1.5,1.5,1.5});
+
+    // Alias for properties on the grid
+    constexpr int phi = 0;
+    constexpr int cp = 1;
+    constexpr int cp_ctx = 2;
+
+    periodicity<SIM_DIM> grid_bc = {NON_PERIODIC, NON_PERIODIC, NON_PERIODIC};
+    Ghost <SIM_DIM, long int> grid_ghost(2*narrow_band_half_width);
+    GridDist gdist(szu, domain, grid_ghost, grid_bc);
+
+    EllipseParams params;
+    params.origin[0] = 0.0;
+    params.origin[1] = 0.0;
+    params.origin[2] = 0.0;
+    params.radiusA = 1.0;
+    params.radiusB = 1.0;
+    params.radiusC = 1.0;
+
+    double nb_gamma = narrow_band_half_width * gdist.spacing(0);
+
+    initializeLSEllipsoid<phi>(gdist, params);
+
+    ClosestPointContext<phi, POLY_ORDER, GridDist> ctx(gdist);
+
+    // The same closest points of the free function, with the structures built (first call) and reused (second call)
+    auto check = [&]()
+    {
+        estimateClosestPoint<phi, cp, POLY_ORDER>(gdist, nb_gamma);
+
+        size_t n_band = 0;
+        double max_diff = 0.0;
+        auto it = gdist.getDomainIterator();
+        while(it.isNext())
+        {
+            auto key = it.get();
+
+            if(std::abs(gdist.template get<phi>(key)) < nb_gamma)
+            {
+                for(int d = 0; d < SIM_DIM; ++d)
+                    max_diff = std::max(std::abs(gdist.template get<cp>(key)[d] - gdist.template get<cp_ctx>(key)[d]), max_diff);
+                n_band++;
+            }
+            ++it;
+        }
+
+        BOOST_REQUIRE(n_band > 0);
+        BOOST_REQUIRE_EQUAL(max_diff, 0.0);
+    };
+
+    for (int i = 0; i < 2; i++)
+    {
+        ctx.estimateClosestPoint<cp_ctx>(nb_gamma);
+        check();
+    }
+
+    // phi changed outside of the context: after invalidate() the structures are built for the new level set
+    params.radiusA = 0.8;
+    params.radiusB = 0.8;
+    params.radiusC = 0.8;
+    initializeLSEllipsoid<phi>(gdist, params);
+
+    ctx.invalidate();
+    ctx.estimateClosestPoint<cp_ctx>(nb_gamma);
+    check();
+
+}
+
+BOOST_AUTO_TEST_SUITE_END()
+
+#endif
@@ -25,10 +25,20 @@
  */
 
 #include <math.h>
+#include <vector>
+#include <memory>
+#include <algorithm>
+#include <limits>
+#include <utility>
 #include "Vector/vector_dist.hpp"
 #include "regression/regression.hpp"
+#include "util/trace_span.hpp"
+#include "util/memory_report.hpp"
+#ifdef _OPENMP
+#include <omp.h>
+#endif
 
-template<unsigned int dim, unsigned int n_c> using particles_surface = vector_dist<dim, double, aggregate<int, int, double, double[dim], double[n_c]>>;
+template<unsigned int dim, unsigned int n_c> using particles_surface = vector_dist<dim, double, aggregate<int, int, double, double[dim], double[n_c], int>>;
 struct Redist_options
 {
 	size_t max_iter = 1000;	// params for the Newton algorithm for the solution of the constrained
@@ -54,6 +64,16 @@ struct Redist_options
 				   // particle is at the corner of a cell and hence only has neighbors in certain directions)
 	float r_cutoff_factor_min_num_particles; // this is the rcut for the celllist
 	int only_narrowband = 1; // only redistance particles with phi < sampling_radius, or all particles if only_narrowband = 0
+	int batched_newton = 0; // if 1, the query particles sharing the same sample point do their Newton iterations together,
+				// evaluating the polynomial for all of them at once. The verbose mode always uses the per particle version
+	int incremental = 0; // if 1, the surface particles and their interpolants are kept from one run_redistancing to the next. A close
+			     // particle is re-fitted and re-projected only if a particle of its support is new, moved by more than
+			     // incremental_move_factor*H or has a phi that differs by more than incremental_phi_tolerance from the one
+			     // of the last run (the redistanced value if write_sdf). The other ones reuse their coefficients and sample point
+	double incremental_phi_tolerance = 1e-12;
+	double incremental_move_factor = 0.1; // at most 1
+	int batched_regression = 0; // if 1, the supports of the close particles are gathered first and all the interpolants are fitted
+				    // together with RegressionBatch
 };
 
 template <typename particles_in_type, size_t phi_field, size_t closest_point_field, size_t normal_field, size_t curvature_field, unsigned int num_minter_coeffs>
@@ -63,25 +83,53 @@ public:
 	particle_cp_redistancing(particles_in_type & vd, Redist_options &redistOptions) : redistOptions(redistOptions),
 					  	  	  	  	  	  	  vd_in(vd),
 											  vd_s(vd.getDecomposition(), 0),
-											  r_cutoff2(redistOptions.r_cutoff_factor*redistOptions.r_cutoff_factor*redistOptions.H*redistOptions.H),
-											  minterModelpcp(RegressionModel<dim, vd_s_sdf>(
-                                                                                          redistOptions.minter_poly_degree, redistOptions.minter_lp_degree))
+											  vd_s_prev(vd.getDecomposition(), 0),
+											  minterBatch(redistOptions.minter_poly_degree, redistOptions.minter_lp_degree, num_minter_coeffs),
+											  r_cutoff2(redistOptions.r_cutoff_factor*redistOptions.r_cutoff_factor*redistOptions.H*redistOptions.H)
 	{
-		// Constructor
+		// one regression model per thread, reused for all the particles processed by the thread
+		int maxThreads = 1;
+#ifdef _OPENMP
+		maxThreads = omp_get_max_threads();
+#endif
+		for (int t = 0; t < maxThreads; t++)
+		{
+			minterModels.emplace_back(new RegressionModel<dim, vd_s_sdf>(redistOptions.minter_poly_degree, redistOptions.minter_lp_degree));
+		}
 	}
 
 	void run_redistancing()
 	{
+		NUMERICS_TRACE_SPAN("pcp.redistancing");
+
 		if (redistOptions.verbose)
 		{
 			std::cout<<"Verbose mode. Make sure the vd.getProp<4>(a) is an integer that pcp can write surface flags onto."<<std::endl;
 		}
 
+		NN_s_ptr.reset();
+		searches.clear();
+		vd_s.clear();
+		vd_s_in_key.clear();
+
 		detect_surface_particles();
 
+		if (redistOptions.incremental) match_previous_surface_particles();
+
 		interpolate_sdf_field();
 
-		find_closest_point();
+		if (redistOptions.batched_newton && !redistOptions.verbose) find_closest_point_batched();
+		else find_closest_point();
+
+		if (redistOptions.incremental) keep_surface_particles();
+	}
+
+	// memory in byte used on this processor by the surface particles (current and previous run) and the maps between
+	// them and the input particles, the cell list of the surface particles and the regression models are not counted
+	size_t getMemoryUsage()
+	{
+		return particlesMemoryUsage(vd_s) + particlesMemoryUsage(vd_s_prev)
+		       + prev_match.capacity() * sizeof(long int) + vd_s_in_key.capacity() * sizeof(size_t);
 	}
 
 private:
@@ -90,7 +138,7 @@ private:
 	static constexpr size_t vd_s_sdf = 2;
 	static constexpr size_t vd_s_sample = 3;
 	static constexpr size_t minter_coeff = 4;
-	// static constexpr size_t vd_s_minter_model = 5;
+	static constexpr size_t vd_s_unchanged = 5;	// the particle matches a surface particle of the last run (incremental mode)
 	static constexpr size_t vd_in_sdf = phi_field; // this is really required in the vd_in vector, so users need to know about it.
 	static constexpr size_t vd_in_close_part = 4; // this is not needed by the method, but more for debugging purposes, as it shows all particles for which
 						      // interpolation and sampling is performed.
@@ -108,7 +156,73 @@ private:
 
 	particles_surface<dim, n_c> vd_s;
 	double r_cutoff2;
-	RegressionModel<dim, vd_s_sdf> minterModelpcp;
+
+	// incremental mode: surface particles of the last run, with the phi of vd_in at the end of the run
+	particles_surface<dim, n_c> vd_s_prev;
+	bool has_prev = false;
+	// key in vd_s_prev of the matching surface particle of every local particle in vd_s, -1 if it changed
+	std::vector<long int> prev_match;
+	// key in vd_in of every local particle in vd_s
+	std::vector<size_t> vd_s_in_key;
+	// regression models of the threads
+	std::vector<std::unique_ptr<RegressionModel<dim, vd_s_sdf>>> minterModels;
+	// batched fit of the interpolants (batched_regression)
+	RegressionBatch<dim, vd_s_sdf, n_c> minterBatch;
+
+	// cell list of the surface particles, shared by the interpolation and the closest point search
+	typedef decltype(std::declval<particles_surface<dim, n_c> &>().getCellList(0.0)) cell_list_s_type;
+	std::unique_ptr<cell_list_s_type> NN_s_ptr;
+	double NN_s_rcut = -1.0;
+
+	// neighbour searches of the threads on NN_s_ptr, they keep their stencils and buffers across the particles
+	typedef CellNeighbourSearch<particles_surface<dim, n_c>, cell_list_s_type> search_s_type;
+	std::vector<std::unique_ptr<search_s_type>> searches;
+
+	// regression model of the calling thread
+	RegressionModel<dim, vd_s_sdf> & threadModel()
+	{
+		int t = 0;
+#ifdef _OPENMP
+		t = omp_get_thread_num();
+#endif
+		return *minterModels[t];
+	}
+
+	// cell list of vd_s with the given cutoff radius, it is rebuilt only if the radius differs from the last one
+	cell_list_s_type & getSurfaceCellList(double r_cut)
+	{
+		if (NN_s_ptr == nullptr || NN_s_rcut != r_cut)
+		{
+			NN_s_ptr.reset(new cell_list_s_type(vd_s.getCellList(r_cut)));
+			NN_s_rcut = r_cut;
+
+			searches.clear();
+			for (size_t t = 0; t < minterModels.size(); t++)
+			{
+				searches.emplace_back(new search_s_type(vd_s, *NN_s_ptr));
+			}
+		}
+		return *NN_s_ptr;
+	}
+
+	// neighbour search of the calling thread on the last cell list returned by getSurfaceCellList
+	search_s_type & threadSearch()
+	{
+		int t = 0;
+#ifdef _OPENMP
+		t = omp_get_thread_num();
+#endif
+		return *searches[t];
+	}
+
+	// the regression support takes an iterator, this one points to a single particle
+	struct single_particle_iterator
+	{
+		vect_dist_key_dx key;
+
+		vect_dist_key_dx get() const {return key;}
+		vect_dist_key_dx getOrig() const {return key;}
+	};
 
 	int return_sign(double phi)
 	{
@@ -127,26 +241,33 @@ private:
 
 	void detect_surface_particles()
 	{
-		vd_in.template ghost_get<vd_in_sdf>();
+		NUMERICS_TRACE_SPAN("pcp.detect_surface");
+
+		{
+			NUMERICS_TRACE_SPAN("pcp.ghost_get");
+			vd_in.template ghost_get<vd_in_sdf>();
+		}
 
 		auto NN = vd_in.getCellList(sqrt(r_cutoff2) + redistOptions.H);
-		auto part = vd_in.getDomainIterator();
+		long int n_part = vd_in.size_local();
+
+		// classification of the particles: 0 not in the support of any interpolation, 1 surface particle, 2 close particle
+		std::vector<int> part_class(n_part, 0);
+		std::vector<int> part_num_neibs(n_part, 0);
 
-		while (part.isNext())
+		#pragma omp parallel for schedule(dynamic,64) if (redistOptions.verbose == 0)
+		for (long int i = 0; i < n_part; i++)
 		{
-			vect_dist_key_dx akey = part.get();
+			vect_dist_key_dx akey(i);
             		// depending on the application this can spare computational effort
             		if ((redistOptions.only_narrowband) && (std::abs(vd_in.template getProp<vd_in_sdf>(akey)) > redistOptions.sampling_radius))
             		{
-                		++part;
                 		continue;
             		}
 			int surfaceflag = 0;
 			int sgn_a = return_sign(vd_in.template getProp<vd_in_sdf>(akey));
 			Point<dim,double> xa = vd_in.getPos(akey);
 			int num_neibs_a = 0;
-			double min_sdf = abs(vd_in.template getProp<vd_in_sdf>(akey));
-			vect_dist_key_dx min_sdf_key = akey;
 			if (redistOptions.verbose) vd_in.template getProp<vd_in_close_part>(akey) = 0;
 			int isclose = 0;
 
@@ -172,48 +293,196 @@ private:
 
 			}
 
-			if (surfaceflag) // these particles will play a role in the subsequent interpolation: Either they carry interpolation polynomials,
-			{		 // or they will be taken into account in interpolation
-				vd_s.add();
-				for(int k = 0; k < dim; k++) vd_s.getLastPos()[k] = vd_in.getPos(akey)[k];
-				vd_s.template getLastProp<vd_s_sdf>() = vd_in.template getProp<vd_in_sdf>(akey);
-				vd_s.template getLastProp<num_neibs>() = num_neibs_a;
+			if (surfaceflag) part_class[i] = 1 + isclose;
+			part_num_neibs[i] = num_neibs_a;
+		}
 
-				if (isclose) // these guys will carry an interpolation polynomial and a resulting sample point
-				{
-					vd_s.template getLastProp<vd_s_close_part>() = 1;
-					if (redistOptions.verbose) vd_in.template getProp<vd_in_close_part>(akey) = 1;
-				}
-				else // these particles will not carry an interpolation polynomial
+		// the surface particles are added in the order of vd_in, as in a serial iteration
+		for (long int i = 0; i < n_part; i++)
+		{
+			if (part_class[i] == 0) continue;
+
+			vect_dist_key_dx akey(i);
+			// these particles will play a role in the subsequent interpolation: Either they carry interpolation polynomials,
+			// or they will be taken into account in interpolation
+			vd_s.add();
+			for(int k = 0; k < dim; k++) vd_s.getLastPos()[k] = vd_in.getPos(akey)[k];
+			vd_s.template getLastProp<vd_s_sdf>() = vd_in.template getProp<vd_in_sdf>(akey);
+			vd_s.template getLastProp<num_neibs>() = part_num_neibs[i];
+			vd_s.template getLastProp<vd_s_unchanged>() = 0;
+			vd_s_in_key.push_back(i);
+
+			// close particles will carry an interpolation polynomial and a resulting sample point
+			vd_s.template getLastProp<vd_s_close_part>() = (part_class[i] == 2) ? 1 : 0;
+			if (redistOptions.verbose) vd_in.template getProp<vd_in_close_part>(akey) = (part_class[i] == 2) ? 1 : 0;
+		}
+	}
+
+	// incremental mode: match the surface particles with the ones of the last run. A particle is unchanged if a surface
+	// particle of the last run lies within incremental_move_factor*H and has the same phi (within the tolerance).
+	void match_previous_surface_particles()
+	{
+		NUMERICS_TRACE_SPAN("pcp.match_previous");
+
+		long int n_part = vd_s.size_local();
+		prev_match.assign(n_part, -1);
+		if (has_prev == false) return;
+
+		{
+			NUMERICS_TRACE_SPAN("pcp.ghost_get");
+			vd_s_prev.template ghost_get<vd_s_close_part,vd_s_sdf,vd_s_sample,minter_coeff>();
+		}
+
+		const double move_tol = redistOptions.incremental_move_factor*redistOptions.H;
+		auto NN_prev = vd_s_prev.getCellList(std::max(move_tol, redistOptions.H));
+
+		#pragma omp parallel for schedule(dynamic,64)
+		for (long int i = 0; i < n_part; i++)
+		{
+			vect_dist_key_dx a(i);
+			Point<dim, double> xa = vd_s.getPos(a);
+
+			double distance = move_tol;
+			long int b_min = -1;
+			auto Np = NN_prev.getNNIteratorBox(NN_prev.getCell(xa));
+			while (Np.isNext())
+			{
+				vect_dist_key_dx b = Np.get();
+				Point<dim, double> xb = vd_s_prev.getPos(b);
+				double dist_calc = norm(xa - xb);
+				if (dist_calc <= distance)
 				{
-					vd_s.template getLastProp<vd_s_close_part>() = 0;
-					if (redistOptions.verbose) vd_in.template getProp<vd_in_close_part>(akey) = 0;
+					distance = dist_calc;
+					b_min = b.getKey();
 				}
+				++Np;
+			}
+
+			if (b_min != -1 && std::abs(vd_s.template getProp<vd_s_sdf>(a) - vd_s_prev.template getProp<vd_s_sdf>(b_min)) <= redistOptions.incremental_phi_tolerance)
+			{
+				vd_s.template getProp<vd_s_unchanged>(a) = 1;
+				prev_match[i] = b_min;
 			}
-			++part;
+		}
+	}
+
+	// incremental mode: if the close particle a and all the particles of its support are unchanged, copy the interpolant and
+	// the sample point of the matching particle of the last run into a
+	template<typename keys_type>
+	bool reuse_interpolant(vect_dist_key_dx a, const keys_type & keys)
+	{
+		if (redistOptions.incremental == 0 || prev_match[a.getKey()] == -1) return false;
+
+		vect_dist_key_dx b(prev_match[a.getKey()]);
+		if (vd_s_prev.template getProp<vd_s_close_part>(b) != 1) return false;
+
+		for (size_t k = 0; k < keys.size(); k++)
+		{
+			if (vd_s.template getProp<vd_s_unchanged>(keys.get(k)) == 0) return false;
+		}
+
+		for (int k = 0; k < n_c; k++) vd_s.template getProp<minter_coeff>(a)[k] = vd_s_prev.template getProp<minter_coeff>(b)[k];
+		for (int k = 0; k < dim; k++) vd_s.template getProp<vd_s_sample>(a)[k] = vd_s_prev.template getProp<vd_s_sample>(b)[k];
+		return true;
+	}
+
+	// incremental mode: keep the surface particles of this run for the next one, with the phi written in vd_in
+	void keep_surface_particles()
+	{
+		NUMERICS_TRACE_SPAN("pcp.keep_surface");
+
+		vd_s_prev.clear();
+		for (size_t i = 0; i < vd_s.size_local(); i++)
+		{
+			vect_dist_key_dx a(i);
+			vect_dist_key_dx a_in(vd_s_in_key[i]);
+
+			vd_s_prev.add();
+			for(int k = 0; k < dim; k++) vd_s_prev.getLastPos()[k] = vd_s.getPos(a)[k];
+			vd_s_prev.template getLastProp<vd_s_sdf>() = vd_in.template getProp<vd_in_sdf>(a_in);
+			vd_s_prev.template getLastProp<vd_s_close_part>() = vd_s.template getProp<vd_s_close_part>(a);
+			for(int k = 0; k < dim; k++) vd_s_prev.template getLastProp<vd_s_sample>()[k] = vd_s.template getProp<vd_s_sample>(a)[k];
+			for(int k = 0; k < n_c; k++) vd_s_prev.template getLastProp<minter_coeff>()[k] = vd_s.template getProp<minter_coeff>(a)[k];
+		}
+		has_prev = true;
+	}
+
+	// batched regression: build the supports of the close particles in parallel, gather the ones that are not reused in
+	// minterBatch and fit them together. The coefficients are stored in the close particles.
+	void fit_interpolants_batched(std::vector<long int> & batch_index, int & message_insufficient_support)
+	{
+		long int n_part = vd_s.size_local();
+		std::vector<openfpm::vector<size_t>> support_keys(n_part);
+		batch_index.assign(n_part, -1);
+
+		#pragma omp parallel for schedule(dynamic,16) reduction(max:message_insufficient_support)
+		for (long int i = 0; i < n_part; i++)
+		{
+			vect_dist_key_dx a(i);
+			single_particle_iterator part{a};
+			if (vd_s.template getProp<vd_s_close_part>(a) != 1) continue;
+
+			auto regSupport = (redistOptions.min_num_particles == 0) ?
+					RegressionSupport<decltype(vd_s), cell_list_s_type>(vd_s, part, sqrt(r_cutoff2), RADIUS, threadSearch()) :
+					RegressionSupport<decltype(vd_s), cell_list_s_type>(vd_s, part, n_c + 3, AT_LEAST_N_PARTICLES, threadSearch());
+			if (regSupport.getNumParticles() < n_c) message_insufficient_support = 1;
+			if (reuse_interpolant(a, regSupport.getKeys())) continue;
+
+			support_keys[i] = regSupport.getKeys();
+			batch_index[i] = 0;
+		}
+
+		// the supports are added in the order of the particles
+		minterBatch.clear();
+		for (long int i = 0; i < n_part; i++)
+		{
+			if (batch_index[i] != -1) batch_index[i] = minterBatch.add(vd_s, support_keys[i]);
+		}
+
+		minterBatch.fit();
+
+		#pragma omp parallel for schedule(static)
+		for (long int i = 0; i < n_part; i++)
+		{
+			if (batch_index[i] != -1) minterBatch.storeCoeffs(batch_index[i], vd_s.template getProp<minter_coeff>(vect_dist_key_dx(i)));
 		}
 	}
 
 	void interpolate_sdf_field()
 	{
+		NUMERICS_TRACE_SPAN("pcp.interpolate");
+
 		int message_insufficient_support = 0;
 		int message_projection_fail = 0;
 
-		vd_s.template ghost_get<vd_s_sdf>();
+		{
+			NUMERICS_TRACE_SPAN("pcp.ghost_get");
+			vd_s.template ghost_get<vd_s_sdf,vd_s_unchanged>();
+		}
 		double r_cutoff_celllist = sqrt(r_cutoff2);
 		if (redistOptions.min_num_particles != 0) r_cutoff_celllist = redistOptions.r_cutoff_factor_min_num_particles*redistOptions.H;
-		auto NN_s = vd_s.getCellList(r_cutoff_celllist);
-		auto part = vd_s.getDomainIterator();
+		auto & NN_s = getSurfaceCellList(r_cutoff_celllist);
+		long int n_part = vd_s.size_local();
+
+		// batched regression: index in the batch of the close particles fitted in this run, -1 for the others
+		std::vector<long int> batch_index;
+		if (redistOptions.batched_regression) fit_interpolants_batched(batch_index, message_insufficient_support);
 
 		// iterate over particles that will get an interpolation polynomial and generate a sample point
-		while (part.isNext())
+		#pragma omp parallel for schedule(dynamic,16) reduction(max:message_insufficient_support,message_projection_fail) if (redistOptions.verbose == 0)
+		for (long int i = 0; i < n_part; i++)
 		{
-			vect_dist_key_dx a = part.get();
+			vect_dist_key_dx a(i);
+			single_particle_iterator part{a};
+			auto & minterModelpcp = threadModel();
 
 			// only the close particles (a) will get the full treatment (interpolation + projection)
 			if (vd_s.template getProp<vd_s_close_part>(a) != 1)
 			{
-				++part;
+				continue;
+			}
+			if (redistOptions.batched_regression && batch_index[i] == -1)
+			{
 				continue;
 			}
 
@@ -222,21 +491,30 @@ private:
 			int neib = 0;
             		int k_project = 0;
 
-			if(redistOptions.min_num_particles == 0)
+			bool reused = false;
+			if (redistOptions.batched_regression)
+			{
+				minterBatch.loadCoeffs(batch_index[i], minterModelpcp);
+			}
+			else if(redistOptions.min_num_particles == 0)
 			{
-            			auto regSupport = RegressionSupport<decltype(vd_s), decltype(NN_s)>(vd_s, part, sqrt(r_cutoff2), RADIUS, NN_s);
+            			auto regSupport = RegressionSupport<decltype(vd_s), decltype(NN_s)>(vd_s, part, sqrt(r_cutoff2), RADIUS, threadSearch());
 				if (regSupport.getNumParticles() < n_c) message_insufficient_support = 1;
-				minterModelpcp.computeCoeffs(vd_s, regSupport);
+				reused = reuse_interpolant(a, regSupport.getKeys());
+				if (!reused) minterModelpcp.computeCoeffs(vd_s, regSupport);
 			}
 			else
 			{
-            			auto regSupport = RegressionSupport<decltype(vd_s), decltype(NN_s)>(vd_s, part, n_c + 3, AT_LEAST_N_PARTICLES, NN_s);
+            			auto regSupport = RegressionSupport<decltype(vd_s), decltype(NN_s)>(vd_s, part, n_c + 3, AT_LEAST_N_PARTICLES, threadSearch());
 				if (regSupport.getNumParticles() < n_c) message_insufficient_support = 1;
-				minterModelpcp.computeCoeffs(vd_s, regSupport);
+				reused = reuse_interpolant(a, regSupport.getKeys());
+				if (!reused) minterModelpcp.computeCoeffs(vd_s, regSupport);
 			}
+			// the interpolant and the sample point of the last run are still valid
+			if (reused) continue;
 
             		auto& minterModel = minterModelpcp.model;
-			for(int k = 0; k < n_c; k++) vd_s.template getProp<minter_coeff>(a)[k] = minterModel->getCoeffs()[k];
+			minterModelpcp.storeCoeffs(vd_s.template getProp<minter_coeff>(a), n_c);
 
             		double grad_p_minter_mag2;
 
@@ -262,8 +540,6 @@ private:
 				if (redistOptions.verbose) std::cout<<"didnt work for "<<a.getKey()<<std::endl;
 				message_projection_fail = 1;
 			}
-
-			++part;
 		}
 
 		if (message_insufficient_support) std::cout<<"Warning: less number of neighbours than required for interpolation"
@@ -285,25 +561,31 @@ private:
 
 	void find_closest_point()
 	{
+		NUMERICS_TRACE_SPAN("pcp.closest_point");
+
 		// iterate over all particles, i.e. do closest point optimisation for all particles, and initialize
 		// all relevant variables.
 
-		vd_s.template ghost_get<vd_s_close_part,vd_s_sample,minter_coeff>();
+		{
+			NUMERICS_TRACE_SPAN("pcp.ghost_get");
+			vd_s.template ghost_get<vd_s_close_part,vd_s_sample,minter_coeff>();
+		}
 
-		auto NN_s = vd_s.getCellList(redistOptions.sampling_radius);
-		auto part = vd_in.getDomainIterator();
+		auto & NN_s = getSurfaceCellList(redistOptions.sampling_radius);
+		long int n_part = vd_in.size_local();
 
 		int message_step_limitation = 0;
 		int message_convergence_problem = 0;
 
 		// do iteration over all query particles
-		while (part.isNext())
+		#pragma omp parallel for schedule(dynamic,64) reduction(max:message_step_limitation,message_convergence_problem) if (redistOptions.verbose == 0)
+		for (long int i = 0; i < n_part; i++)
 		{
-			vect_dist_key_dx a = part.get();
+			vect_dist_key_dx a(i);
+			auto & minterModelpcp = threadModel();
 
 			if ((redistOptions.only_narrowband) && (std::abs(vd_in.template getProp<vd_in_sdf>(a)) > redistOptions.sampling_radius))
 			{
-				++part;
 				continue;
 			}
 
@@ -349,9 +631,6 @@ private:
 			// point vector, and can probably be made nicer.
 			Point<dim, double> xaa = vd_in.getPos(a);
 
-			// Now we will iterate over the sample points, which means iterating over vd_s.
-			auto Np = NN_s.getNNIteratorBox(NN_s.getCell(vd_in.getPos(a)));
-
 			vect_dist_key_dx b_min = get_closest_neighbor<decltype(NN_s)>(xaa, vd_s, NN_s);
 
 			// set x0 to the sample point which was closest to the query particle
@@ -366,11 +645,7 @@ private:
 			for(int k = 0; k < dim; k++) x00x[k] = 0.0;
 
             		auto& model = minterModelpcp.model;
-			EVectorXd temp(n_c_r, 1);
-			for(int k = 0; k < n_c; k++) temp[k] = vd_s.template getProp<minter_coeff>(b_min)[k];
-		    	Point<dim, int> derivOrder;
-			Point<dim, double> grad_p_minter;
-			model->setCoeffs(temp);
+			minterModelpcp.loadCoeffs(vd_s.template getProp<minter_coeff>(b_min), n_c);
 
 			if(redistOptions.verbose)
 			{
@@ -509,7 +784,6 @@ private:
 				}
 
 			}
-			++part;
 		}
 		if (redistOptions.verbose and message_step_limitation)
 		{
@@ -522,6 +796,217 @@ private:
 
 	}
 
+	// Same optimization as find_closest_point, but the query particles are grouped by the sample point used as
+	// initial guess, as they share the same interpolation polynomial. The Newton iterations of a group are advanced
+	// together: positions, Lagrange multipliers and derivatives are stored as one row per particle, the polynomial and
+	// its derivatives are evaluated for all the active rows at once, and the converged particles are removed from
+	// the active rows.
+	void find_closest_point_batched()
+	{
+		NUMERICS_TRACE_SPAN("pcp.closest_point");
+
+		{
+			NUMERICS_TRACE_SPAN("pcp.ghost_get");
+			vd_s.template ghost_get<vd_s_close_part,vd_s_sample,minter_coeff>();
+		}
+
+		auto & NN_s = getSurfaceCellList(redistOptions.sampling_radius);
+		long int n_part = vd_in.size_local();
+
+		// pairs (sample point, query particle)
+		std::vector<std::pair<size_t, size_t>> queries(n_part, std::make_pair(std::numeric_limits<size_t>::max(), 0));
+
+		#pragma omp parallel for schedule(dynamic,64)
+		for (long int i = 0; i < n_part; i++)
+		{
+			vect_dist_key_dx a(i);
+			if ((redistOptions.only_narrowband) && (std::abs(vd_in.template getProp<vd_in_sdf>(a)) > redistOptions.sampling_radius))
+			{
+				continue;
+			}
+			Point<dim, double> xaa = vd_in.getPos(a);
+			queries[i] = std::make_pair(get_closest_neighbor<decltype(NN_s)>(xaa, vd_s, NN_s).getKey(), (size_t)i);
+		}
+
+		// sorting brings the query particles of the same sample point next to each other, skipped particles go at the end
+		std::sort(queries.begin(), queries.end());
+		while (queries.size() != 0 && queries.back().first == std::numeric_limits<size_t>::max()) queries.pop_back();
+
+		std::vector<size_t> group_start;
+		for (size_t q = 0; q < queries.size(); q++)
+		{
+			if (q == 0 || queries[q].first != queries[q-1].first) group_start.push_back(q);
+		}
+		group_start.push_back(queries.size());
+		long int n_groups = group_start.size() - 1;
+
+		int message_step_limitation = 0;
+		int message_convergence_problem = 0;
+
+		#pragma omp parallel for schedule(dynamic,1) reduction(max:message_step_limitation,message_convergence_problem)
+		for (long int g = 0; g < n_groups; g++)
+		{
+			auto & model = threadModel().model;
+			vect_dist_key_dx b_min(queries[group_start[g]].first);
+			const int n = group_start[g+1] - group_start[g];
+
+			threadModel().loadCoeffs(vd_s.template getProp<minter_coeff>(b_min), n_c);
+
+			// one row per query particle
+			EMatrixXd xa(n, dim_r), x(n, dim_r), grad_p(n, dim_r);
+			EVectorXd p(n), lambda(n), nabla_f_norm(n);
+			std::vector<int> k_newton(n, 0);
+
+			for (int j = 0; j < n; j++)
+			{
+				vect_dist_key_dx a(queries[group_start[g] + j].second);
+				for(int k = 0; k < dim; k++)
+				{
+					xa(j, k) = vd_in.getPos(a)[k];
+					x(j, k) = vd_s.template getProp<vd_s_sample>(b_min)[k];
+				}
+			}
+
+			get_p_grad_minter_batch(x, model, p, grad_p);
+
+			std::vector<int> active;
+			for (int j = 0; j < n; j++)
+			{
+				EMatrix<double, Eigen::Dynamic, 1> xax = (x.row(j) - xa.row(j)).transpose();
+				EMatrix<double, Eigen::Dynamic, 1> grad_p_j = grad_p.row(j).transpose();
+
+				// this guess for the Lagrange multiplier is taken from the original paper by Saye and can be done since
+				// p is approximately zero at the sample point.
+				lambda[j] = -xax.dot(grad_p_j)/grad_p_j.dot(grad_p_j);
+				nabla_f_norm[j] = sqrt((xax + lambda[j]*grad_p_j).squaredNorm() + p[j]*p[j]);
+				if (nabla_f_norm[j] > redistOptions.tolerance) active.push_back(j);
+			}
+
+			EMatrixXd x_act, grad_p_act;
+			EVectorXd p_act;
+			std::vector<EVectorXd> H_p_act(dim*dim);
+
+			for (int it = 0; it < redistOptions.max_iter && active.size() != 0; it++)
+			{
+				const int na = active.size();
+				x_act.resize(na, dim_r);
+				for (int j = 0; j < na; j++) x_act.row(j) = x.row(active[j]);
+
+				get_H_p_minter_batch(x_act, model, H_p_act);
+
+				for (int j = 0; j < na; j++)
+				{
+					const int l = active[j];
+
+					// Assemble Hessian matrix and gradient of the Lagrangian
+					EMatrix<double, dim + 1, dim + 1> H_f;
+					EMatrix<double, dim + 1, 1> nabla_f;
+					for(int k = 0; k < dim; k++)
+					{
+						for(int m = 0; m < dim; m++) H_f(k, m) = lambda[l]*H_p_act[k*dim + m][j];
+						H_f(k, k) += 1.0;
+						H_f(k, dim) = grad_p(l, k);
+						H_f(dim, k) = grad_p(l, k);
+						nabla_f[k] = x(l, k) - xa(l, k) + lambda[l]*grad_p(l, k);
+					}
+					H_f(dim, dim) = 0.0;
+					nabla_f[dim] = p[l];
+
+					// compute Newton increment
+					EMatrix<double, dim + 1, 1> dx = - H_f.inverse()*nabla_f;
+
+					// prevent Newton algorithm from leaving the support radius by scaling step size.
+					while((dx.dot(dx)) > 0.25*r_cutoff2)
+					{
+						message_step_limitation = 1;
+						dx = 0.1*dx;
+					}
+
+					// apply increment
+					for(int k = 0; k < dim; k++) x(l, k) += dx[k];
+					lambda[l] += dx[dim];
+					x_act.row(j) = x.row(l);
+					++k_newton[l];
+				}
+
+				// prepare values for next iteration and update the exit criterion
+				get_p_grad_minter_batch(x_act, model, p_act, grad_p_act);
+
+				std::vector<int> still_active;
+				for (int j = 0; j < na; j++)
+				{
+					const int l = active[j];
+					p[l] = p_act[j];
+					grad_p.row(l) = grad_p_act.row(j);
+					nabla_f_norm[l] = sqrt((x.row(l) - xa.row(l) + lambda[l]*grad_p.row(l)).squaredNorm() + p[l]*p[l]);
+					if (nabla_f_norm[l] > redistOptions.tolerance) still_active.push_back(l);
+				}
+				active.swap(still_active);
+			}
+
+			// Check if the Newton algorithm achieved the required accuracy within the allowed number of iterations.
+			if (active.size() != 0) message_convergence_problem = 1;
+
+			std::vector<EVectorXd> H_p_all(dim*dim);
+			if (redistOptions.compute_curvatures) get_H_p_minter_batch(x, model, H_p_all);
+
+			for (int j = 0; j < n; j++)
+			{
+				vect_dist_key_dx a(queries[group_start[g] + j].second);
+				const double xax_norm = (x.row(j) - xa.row(j)).norm();
+
+				// new sdf value as the distance of the query particle x_a and the closest point x, the initial sign is conserved
+				if (redistOptions.write_sdf) vd_in.template getProp<vd_in_sdf>(a) = return_sign(vd_in.template getProp<vd_in_sdf>(a))*xax_norm;
+				if (redistOptions.write_cp) for(int k = 0; k <dim; k++) vd_in.template getProp<vd_in_cp>(a)[k] = x(j, k);
+				// avoid a 0-sdf, see find_closest_point
+				if ((k_newton[j] == 0) && (xax_norm < redistOptions.tolerance))
+				{
+					vd_in.template getProp<vd_in_sdf>(a) = return_sign(vd_in.template getProp<vd_in_sdf>(a))*redistOptions.tolerance;
+				}
+
+				if (redistOptions.compute_normals)
+				{
+					for(int k = 0; k<dim; k++) vd_in.template getProp<vd_in_normal>(a)[k] = return_sign(vd_in.template getProp<vd_in_sdf>(a))*grad_p(j, k)*1/grad_p.row(j).norm();
+				}
+
+				if (redistOptions.compute_curvatures)
+				{
+					EMatrix<double, dim, dim> H_p;
+					for(int k = 0; k < dim; k++)
+					{
+						for(int m = 0; m < dim; m++) H_p(k, m) = H_p_all[k*dim + m][j];
+					}
+					EMatrix<double, dim, 1> grad_p_j = grad_p.row(j).transpose();
+					vd_in.template getProp<vd_in_curvature>(a) = get_curvature(grad_p_j, H_p);
+				}
+			}
+		}
+		if (redistOptions.verbose and message_step_limitation)
+		{
+			std::cout<<"Step size limitation invoked"<<std::endl;
+		}
+		if (message_convergence_problem)
+		{
+			std::cout<<"Warning: Newton algorithm has reached maximum number of iterations, does not converge for some particles"<<std::endl;
+		}
+	}
+
+	// divergence of the normalized gradient field, from the gradient and the Hessian of the polynomial
+	template<typename grad_type, typename hessian_type>
+	double get_curvature(const grad_type & grad_p, const hessian_type & H_p)
+	{
+		if (dim == 2)
+		{
+			return (H_p(0,0)*grad_p(1)*grad_p(1) - 2*grad_p(1)*grad_p(0)*H_p(0,1) + H_p(1,1)*grad_p(0)*grad_p(0))/std::pow(sqrt(grad_p(0)*grad_p(0) + grad_p(1)*grad_p(1)),3);
+		}
+		else if (dim == 3)
+		{	// fluid mechanical curvature, see find_closest_point
+			return ((H_p(1,1) + H_p(2,2))*std::pow(grad_p(0), 2) + (H_p(0,0) + H_p(2,2))*std::pow(grad_p(1), 2) + (H_p(0,0) + H_p(1,1))*std::pow(grad_p(2), 2)
+			- 2*grad_p(0)*grad_p(1)*H_p(0,1) - 2*grad_p(0)*grad_p(2)*H_p(0,2) - 2*grad_p(1)*grad_p(2)*H_p(1,2))*std::pow(std::pow(grad_p(0), 2) + std::pow(grad_p(1), 2) + std::pow(grad_p(2), 2), -1.5);
+		}
+		return 0.0;
+	}
+
 	template<typename NNlist_type> vect_dist_key_dx get_closest_neighbor(Point<dim, double> & xa, particles_surface<dim, n_c> & vd_surface, NNlist_type & NN_s)
 	{
 		auto Np = NN_s.getNNIteratorBox(NN_s.getCell(xa));
@@ -557,14 +1042,14 @@ private:
 
 	// minterface
 	template<typename PolyType>
-	inline double get_p_minter(EMatrix<double, Eigen::Dynamic, 1> xvector, PolyType model)
+	inline double get_p_minter(const EMatrix<double, Eigen::Dynamic, 1> & xvector, PolyType model)
     	{
         	return(model->eval(xvector.transpose())(0));
     	}
 
 
 	template<typename PolyType>
-	inline EMatrix<double, Eigen::Dynamic, 1> get_grad_p_minter(EMatrix<double, Eigen::Dynamic, 1> xvector, PolyType model)
+	inline EMatrix<double, Eigen::Dynamic, 1> get_grad_p_minter(const EMatrix<double, Eigen::Dynamic, 1> & xvector, PolyType model)
     	{
         	EMatrix<double, Eigen::Dynamic, 1> grad_p(dim_r, 1);
         	std::vector<int> derivOrder(dim, 0);
@@ -577,7 +1062,7 @@ private:
     	}
 
 	template<typename PolyType>
-    	inline EMatrix<double, Eigen::Dynamic, Eigen::Dynamic> get_H_p_minter(EMatrix<double, Eigen::Dynamic, 1> xvector, PolyType model)
+    	inline EMatrix<double, Eigen::Dynamic, Eigen::Dynamic> get_H_p_minter(const EMatrix<double, Eigen::Dynamic, 1> & xvector, PolyType model)
     	{
         	EMatrix<double, Eigen::Dynamic, Eigen::Dynamic> H_p(dim_r, dim_r);
        		std::vector<int> derivOrder(dim, 0);
@@ -594,5 +1079,39 @@ private:
         	return(H_p);
     	}
 
+
+	// value and gradient of the polynomial at all the rows of x
+	template<typename PolyType>
+	inline void get_p_grad_minter_batch(const EMatrixXd & x, PolyType model, EVectorXd & p, EMatrixXd & grad_p)
+	{
+		p = model->eval(x);
+		grad_p.resize(x.rows(), dim_r);
+		std::vector<int> derivOrder(dim, 0);
+		for(int k = 0; k < dim; k++)
+		{
+			std::fill(derivOrder.begin(), derivOrder.end(), 0);
+			derivOrder[k] = 1;
+			grad_p.col(k) = model->deriv_eval(x, derivOrder);
+		}
+	}
+
+	// second derivatives of the polynomial at all the rows of x, H_p[k*dim + l] contains d^2p/dx_k dx_l
+	template<typename PolyType>
+	inline void get_H_p_minter_batch(const EMatrixXd & x, PolyType model, std::vector<EVectorXd> & H_p)
+	{
+		std::vector<int> derivOrder(dim, 0);
+		for(int k = 0; k < dim; k++)
+		{
+			for(int l = k; l < dim; l++)
+			{
+				std::fill(derivOrder.begin(), derivOrder.end(), 0);
+				derivOrder[k]++;
+				derivOrder[l]++;
+				H_p[k*dim + l] = model->deriv_eval(x, derivOrder);
+				H_p[l*dim + k] = H_p[k*dim + l];
+			}
+		}
+	}
+
 };
 
@@ -195,4 +195,196 @@ BOOST_AUTO_TEST_CASE( ellipsoid )
 
 }
 
+BOOST_AUTO_TEST_CASE( ellipsoid_batched_newton )
+{
+	// same set-up as the ellipsoid test, the closest points are computed with the per particle and the batched Newton
+	constexpr int poly_order = 4;
+	const double H = 1.0/64.0;
+	const double perturb_factor = 0.3;
+	const double bandwidth = 12.0*H;
+
+	const double l = 2.0;
+	Box<3, double> domain({-l/2.0, -l/3.0, -l/3.0}, {l/2.0, l/3.0, l/3.0});
+	size_t sz[3] = {(size_t)(l/H + 0.5), (size_t)((2.0/3.0)*l/H + 0.5), (size_t)((2.0/3.0)*l/H + 0.5)};
+	size_t bc[3] = {NON_PERIODIC, NON_PERIODIC, NON_PERIODIC};
+	Ghost<3, double> g(bandwidth);
+
+	constexpr int sdf = 0;
+	constexpr int cp = 1;
+	constexpr int normal = 2;
+	constexpr int curvature = 3;
+	constexpr int ref_cp = 4;
+	constexpr int sdf_init = 5;
+	typedef vector_dist<3, double, aggregate<double, Point<3, double>, Point<3, double>, double, Point<3, double>, double>> particles;
+
+	particles vd(0, domain, bc, g, DEC_GRAN(512));
+	EllipseParameters params;
+	for (int k = 0; k < 3; k++) params.origin[k] = 0.0;
+	params.radiusA = 0.75;
+	params.radiusB = 0.5;
+	params.radiusC = 0.5;
+
+	auto particle_it = DrawParticles::DrawBox(vd, sz, domain, domain);
+	initializeLSEllipsoid<particles, decltype(particle_it), sdf, ref_cp>(vd, particle_it, params, bandwidth, perturb_factor, H);
+
+	auto part_init = vd.getDomainIterator();
+	while(part_init.isNext())
+	{
+		auto a = part_init.get();
+		vd.getProp<sdf_init>(a) = vd.getProp<sdf>(a);
+		++part_init;
+	}
+
+	Redist_options rdistoptions;
+	rdistoptions.minter_poly_degree = poly_order;
+	rdistoptions.H = H;
+	rdistoptions.r_cutoff_factor = 2.4;
+	rdistoptions.sampling_radius = 0.75*bandwidth;
+	rdistoptions.tolerance = 1e-13;
+	rdistoptions.write_cp = 1;
+	rdistoptions.compute_normals = 1;
+	rdistoptions.compute_curvatures = 1;
+	rdistoptions.only_narrowband = 0;
+
+	static constexpr unsigned int num_coeffs = minter_lp_degree_one_num_coeffs(3, poly_order);
+
+	particle_cp_redistancing<particles, sdf, cp, normal, curvature, num_coeffs> pcprdist(vd, rdistoptions);
+	pcprdist.run_redistancing();
+
+	// keep the per particle result in sdf_init and start again from the initial sdf
+	auto part_copy = vd.getDomainIterator();
+	while(part_copy.isNext())
+	{
+		auto a = part_copy.get();
+		double tmp = vd.getProp<sdf>(a);
+		vd.getProp<sdf>(a) = vd.getProp<sdf_init>(a);
+		vd.getProp<sdf_init>(a) = tmp;
+		++part_copy;
+	}
+
+	rdistoptions.batched_newton = 1;
+	particle_cp_redistancing<particles, sdf, cp, normal, curvature, num_coeffs> pcprdist_batched(vd, rdistoptions);
+	pcprdist_batched.run_redistancing();
+
+	double maxdiff = 0.0;
+	auto part = vd.getDomainIterator();
+	while(part.isNext())
+	{
+		auto a = part.get();
+		maxdiff = std::max(maxdiff, std::abs(vd.getProp<sdf>(a) - vd.getProp<sdf_init>(a)));
+		++part;
+	}
+	std::cout<<"Maximum difference of the batched Newton sdf is: "<<maxdiff<<std::endl;
+
+	BOOST_TEST( maxdiff < 1e-10 );
+}
+
+BOOST_AUTO_TEST_CASE( ellipsoid_incremental )
+{
+	// same set-up as the ellipsoid test, the incremental mode reuses the interpolants of the unchanged surface particles
+	constexpr int poly_order = 4;
+	const double H = 1.0/64.0;
+	const double perturb_factor = 0.3;
+	const double bandwidth = 12.0*H;
+
+	const double l = 2.0;
+	Box<3, double> domain({-l/2.0, -l/3.0, -l/3.0}, {l/2.0, l/3.0, l/3.0});
+	size_t sz[3] = {(size_t)(l/H + 0.5), (size_t)((2.0/3.0)*l/H + 0.5), (size_t)((2.0/3.0)*l/H + 0.5)};
+	size_t bc[3] = {NON_PERIODIC, NON_PERIODIC, NON_PERIODIC};
+	Ghost<3, double> g(bandwidth);
+
+	constexpr int sdf = 0;
+	constexpr int cp = 1;
+	constexpr int normal = 2;
+	constexpr int curvature = 3;
+	constexpr int ref_cp = 4;
+	constexpr int sdf_init = 5;
+	typedef vector_dist<3, double, aggregate<double, Point<3, double>, Point<3, double>, double, Point<3, double>, double>> particles;
+
+	particles vd(0, domain, bc, g, DEC_GRAN(512));
+	EllipseParameters params;
+	for (int k = 0; k < 3; k++) params.origin[k] = 0.0;
+	params.radiusA = 0.75;
+	params.radiusB = 0.5;
+	params.radiusC = 0.5;
+
+	auto particle_it = DrawParticles::DrawBox(vd, sz, domain, domain);
+	initializeLSEllipsoid<particles, decltype(particle_it), sdf, ref_cp>(vd, particle_it, params, bandwidth, perturb_factor, H);
+
+	Redist_options rdistoptions;
+	rdistoptions.minter_poly_degree = poly_order;
+	rdistoptions.H = H;
+	rdistoptions.r_cutoff_factor = 2.4;
+	rdistoptions.sampling_radius = 0.75*bandwidth;
+	rdistoptions.tolerance = 1e-13;
+	rdistoptions.only_narrowband = 0;
+
+	static constexpr unsigned int num_coeffs = minter_lp_degree_one_num_coeffs(3, poly_order);
+
+	rdistoptions.incremental = 1;
+	particle_cp_redistancing<particles, sdf, cp, normal, curvature, num_coeffs> pcprdist_incremental(vd, rdistoptions);
+	pcprdist_incremental.run_redistancing();
+
+	// nothing changed since the last run: all the interpolants are reused and the sdf does not change
+	auto part_copy = vd.getDomainIterator();
+	while(part_copy.isNext())
+	{
+		auto a = part_copy.get();
+		vd.getProp<sdf_init>(a) = vd.getProp<sdf>(a);
+		++part_copy;
+	}
+
+	pcprdist_incremental.run_redistancing();
+
+	double maxdiff = 0.0;
+	auto part = vd.getDomainIterator();
+	while(part.isNext())
+	{
+		auto a = part.get();
+		maxdiff = std::max(maxdiff, std::abs(vd.getProp<sdf>(a) - vd.getProp<sdf_init>(a)));
+		++part;
+	}
+	std::cout<<"Maximum difference of the sdf with the reused interpolants is: "<<maxdiff<<std::endl;
+
+	BOOST_TEST( maxdiff < 1e-10 );
+
+	// the interface moves: all the interpolants are fitted again, as without the incremental mode
+	auto part_shift = vd.getDomainIterator();
+	while(part_shift.isNext())
+	{
+		auto a = part_shift.get();
+		vd.getProp<sdf>(a) -= 0.5*H;
+		vd.getProp<sdf_init>(a) = vd.getProp<sdf>(a);
+		++part_shift;
+	}
+
+	pcprdist_incremental.run_redistancing();
+
+	auto part_swap = vd.getDomainIterator();
+	while(part_swap.isNext())
+	{
+		auto a = part_swap.get();
+		double tmp = vd.getProp<sdf>(a);
+		vd.getProp<sdf>(a) = vd.getProp<sdf_init>(a);
+		vd.getProp<sdf_init>(a) = tmp;
+		++part_swap;
+	}
+
+	rdistoptions.incremental = 0;
+	particle_cp_redistancing<particles, sdf, cp, normal, curvature, num_coeffs> pcprdist(vd, rdistoptions);
+	pcprdist.run_redistancing();
+
+	maxdiff = 0.0;
+	auto part2 = vd.getDomainIterator();
+	while(part2.isNext())
+	{
+		auto a = part2.get();
+		maxdiff = std::max(maxdiff, std::abs(vd.getProp<sdf>(a) - vd.getProp<sdf_init>(a)));
+		++part2;
+	}
+	std::cout<<"Maximum difference of the incremental sdf after a change is: "<<maxdiff<<std::endl;
+
+	BOOST_TEST( maxdiff < 1e-10 );
+}
+
 BOOST_AUTO_TEST_SUITE_END()
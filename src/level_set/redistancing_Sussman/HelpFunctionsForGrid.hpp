@@ -14,6 +14,7 @@
 
 #include <iostream>
 #include <limits>
+#include <memory>
 
 #include "HelpFunctions.hpp"
 #include "VCluster/VCluster.hpp"
@@ -301,4 +302,30 @@ auto get_vector_magnitude(gridtype & grid, key_type & key)
 }
 
 
+/**@brief Type of the workspace grid of #RedistancingSussman and #NarrowBand.
+ *
+ * @details The properties are: Phi, gradient of Phi, sign of Phi. The ghost layer is 3 nodes wide.
+ *
+ * @tparam grid_in_type Template type of the input grid.
+ * @tparam phi_type Type of Phi.
+ */
+template <typename grid_in_type, typename phi_type=double>
+using redistancing_workspace_type = grid_dist_id<grid_in_type::dims, typename grid_in_type::stype,
+		aggregate<phi_type, phi_type[grid_in_type::dims], int>>;
+
+/**@brief Allocates a workspace grid that can be shared by #RedistancingSussman and #NarrowBand objects and reused
+ * across calls, instead of allocating one temporary grid per object.
+ *
+ * @tparam phi_type Type of Phi.
+ * @tparam grid_in_type Inferred type of the input grid.
+ * @param grid_in Input grid, the workspace has the same decomposition and size.
+ * @return Shared pointer to the workspace.
+ */
+template <typename phi_type=double, typename grid_in_type>
+std::shared_ptr<redistancing_workspace_type<grid_in_type, phi_type>> create_redistancing_workspace(const grid_in_type & grid_in)
+{
+	return std::make_shared<redistancing_workspace_type<grid_in_type, phi_type>>(grid_in.getDecomposition(),
+			grid_in.getGridInfoVoid().getSize(), Ghost<grid_in_type::dims, long int>(3));
+}
+
 #endif //REDISTANCING_SUSSMAN_HELPFUNCTIONSFORGRID_HPP
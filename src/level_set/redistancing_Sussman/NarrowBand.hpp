@@ -21,6 +21,7 @@
 
 // Include standard library header files
 #include <iostream>
+#include <memory>
 
 // Include OpenFPM header files
 #include "Vector/vector_dist.hpp"
@@ -43,43 +44,40 @@ class NarrowBand
 {
 public:
 	/** @brief Constructor taking the thickness of the narrow band as #grid points in order to initialize the
-	 * lower and upper bound for the narrow band. Initializes the temporary internal grid.
+	 * lower and upper bound for the narrow band. The temporary internal grid is allocated at the first use.
 	 *
 	 * @param grid_in Input grid with min. 1 property: Phi_SDF.
 	 * @param thickness Width of narrow band in # grid points.
 	 */
 	NarrowBand(const grid_in_type & grid_in,
 	           size_t thickness) // thickness in # grid points
-			: g_temp(grid_in.getDecomposition(), grid_in.getGridInfoVoid().getSize(), Ghost<grid_in_type::dims, long int>(3))
 	{
 		set_bounds(thickness, grid_in);
 	}
 	/** @brief Constructor taking the thickness of the narrow band as physical width in space in order to initialize the
-	 * lower and upper bound for the narrow band. Initializes the temporary internal grid.
+	 * lower and upper bound for the narrow band. The temporary internal grid is allocated at the first use.
 	 *
 	 * @param grid_in Input grid with min. 1 property: Phi_SDF.
 	 * @param thickness Width of narrow band as physical width.
 	 */
 	NarrowBand(const grid_in_type & grid_in,
 	           double thickness)    // thickness as physical width
-			: g_temp(grid_in.getDecomposition(), grid_in.getGridInfoVoid().getSize(), Ghost<grid_in_type::dims, long int>(3))
 	{
 		set_bounds(thickness, grid_in);
 	}
 	/** @brief Constructor taking the thickness of the narrow band as physical width in space in order to initialize the
-     * lower and upper bound for the narrow band. Initializes the temporary internal grid.
+     * lower and upper bound for the narrow band. The temporary internal grid is allocated at the first use.
 	 *
      * @param grid_in Input grid with min. 1 property: Phi_SDF.
      * @param thickness Width of narrow band as physical width.
      */
 	NarrowBand(const grid_in_type & grid_in,
 	           float thickness)    // thickness as physical width
-			: g_temp(grid_in.getDecomposition(), grid_in.getGridInfoVoid().getSize(), Ghost<grid_in_type::dims, long int>(3))
 	{
 		set_bounds(thickness, grid_in);
 	}
 	/** @brief Constructor taking the inside and outside physical width of the narrow band in order to initialize the
-	 * lower and upper bound for the narrow band. Initializes the temporary internal grid.
+	 * lower and upper bound for the narrow band. The temporary internal grid is allocated at the first use.
 	 *
 	 * @param grid_in Input grid with min. 1 property: Phi_SDF.
 	 * @param width_outside Extension of narrow band as physical width inside of object (Phi > 0).
@@ -89,7 +87,6 @@ public:
 	NarrowBand(const grid_in_type & grid_in,
 	           width_type width_outside,     // physical width of nb inside of object -> Phi > 0
 	           width_type width_inside)     // physical width nb outside of object -> Phi < 0
-			: g_temp(grid_in.getDecomposition(), grid_in.getGridInfoVoid().getSize(), Ghost<grid_in_type::dims, long int>(3))
 	{
 		set_bounds(width_outside, width_inside, grid_in);
 	}
@@ -100,15 +97,19 @@ public:
 	typedef aggregate<phi_type, phi_type[grid_in_type::dims], int> props_temp;
 	/** @brief Type definition for the temporary grid.
 	 */
-	typedef grid_dist_id<grid_in_type::dims, typename grid_in_type::stype, props_temp> g_temp_type;
-	/**
-	 * @brief Create temporary grid, which is only used inside the class to get the gradients.
+	typedef redistancing_workspace_type<grid_in_type, phi_type> g_temp_type;
+	
+	/** @brief Use an external workspace as temporary grid, for example the one of a #RedistancingSussman object
+	 * (see RedistancingSussman::getWorkspace()), instead of allocating a new one.
 	 *
-	 * @details The grid is needed, when the user wants a narrow band which also contains the upwind gradient of phi.
-	 * It contains the following 4 properties: Phi_SDF (result from redistancing), gradient of Phi, and sign of
-	 * Phi_SDF (for the upwinding).
-	 * */
-	g_temp_type g_temp;
+	 * @details The content of the workspace is overwritten when the gradients are computed.
+	 *
+	 * @param workspace Workspace grid with the same decomposition and size of the input grid.
+	 */
+	void setWorkspace(std::shared_ptr<g_temp_type> workspace)
+	{
+		g_temp_ptr = workspace;
+	}
 	
 	/** @brief Places particles within a narrow band around the interface.
 	 * Only the SDF is copied from the grid properties to the respective particles.
@@ -124,24 +125,15 @@ public:
 	template <size_t Phi_SDF_grid, size_t Phi_SDF_vd, typename vector_type, typename grid_type>
 	void get_narrow_band(grid_type & grid, vector_type & vd)
 	{
-		auto dom = grid.getDomainIterator();
-		while(dom.isNext())
+		add_narrow_band_particles<Phi_SDF_grid>(grid, vd, [&](auto & key, size_t p)
 		{
-			auto key = dom.get();
-			if(within_narrow_band(grid.template get<Phi_SDF_grid>(key)))
+			// assign coordinates and properties from respective grid point to particle
+			for(size_t d = 0; d < grid_type::dims; d++)
 			{
-				// add particle to vd_narrow_band
-				vd.add();
-				// assign coordinates and properties from respective grid point to particle
-				for(size_t d = 0; d < grid_type::dims; d++)
-				{
-					vd.getLastPos()[d] = grid.getPos(key)[d];
-				}
-				vd.template getLastProp<Phi_SDF_vd>() = grid.template get<Phi_SDF_grid>(key);
+				vd.getPos(p)[d] = grid.getPos(key)[d];
 			}
-			++dom;
-		}
-		vd.map();
+			vd.template getProp<Phi_SDF_vd>(p) = grid.template get<Phi_SDF_grid>(key);
+		});
 	}
 	/** @brief Places particles within a narrow band around the interface.
 	 * SDF and Phi_grad_temp are copied from the temp. grid to the respective particle.
@@ -159,25 +151,16 @@ public:
 	void get_narrow_band(grid_type & grid, vector_type & vd)
 	{
 		initialize_temporary_grid<Phi_SDF_grid>(grid);
-		auto dom = grid.getDomainIterator();
-		while(dom.isNext())
+		add_narrow_band_particles<Phi_SDF_grid>(grid, vd, [&](auto & key, size_t p)
 		{
-			auto key = dom.get();
-			if(within_narrow_band(grid.template get<Phi_SDF_temp>(key)))
+			// assign coordinates and properties from respective grid point to particle
+			for(size_t d = 0; d < grid_type::dims; d++)
 			{
-				// add particle to vd_narrow_band
-				vd.add();
-				// assign coordinates and properties from respective grid point to particle
-				for(size_t d = 0; d < grid_type::dims; d++)
-				{
-					vd.getLastPos()[d] = grid.getPos(key)[d];
-					vd.template getLastProp<Phi_grad>()[d] = g_temp.template get<Phi_grad_temp>(key)[d];
-				}
-				vd.template getLastProp<Phi_SDF_vd>() = grid.template get<Phi_SDF_temp>(key);
+				vd.getPos(p)[d] = grid.getPos(key)[d];
+				vd.template getProp<Phi_grad>(p)[d] = g_temp_ptr->template get<Phi_grad_temp>(key)[d];
 			}
-			++dom;
-		}
-		vd.map();
+			vd.template getProp<Phi_SDF_vd>(p) = g_temp_ptr->template get<Phi_SDF_temp>(key);
+		});
 	}
 	/** @brief Places particles within a narrow band around the interface.
 	 * SDF and Phi_grad_temp are copied from the temp. grid to the respective particle.
@@ -197,26 +180,18 @@ public:
 	void get_narrow_band(grid_type & grid, vector_type & vd)
 	{
 		initialize_temporary_grid<Phi_SDF_grid>(grid);
-		auto dom = grid.getDomainIterator();
-		while(dom.isNext())
+		add_narrow_band_particles<Phi_SDF_grid>(grid, vd, [&](auto & key, size_t p)
 		{
-			auto key = dom.get();
-			if(within_narrow_band(grid.template get<Phi_SDF_grid>(key)))
+			// assign coordinates and properties from respective grid point to particle
+			for(size_t d = 0; d < grid_type::dims; d++)
 			{
-				// add particle to vd_narrow_band
-				vd.add();
-				// assign coordinates and properties from respective grid point to particle
-				for(size_t d = 0; d < grid_type::dims; d++)
-				{
-					vd.getLastPos()[d] = grid.getPos(key)[d];
-					vd.template getLastProp<Phi_grad>()[d] = g_temp.template get<Phi_grad_temp>(key)[d];
-				}
-				vd.template getLastProp<Phi_SDF_vd>()      = g_temp.template get<Phi_SDF_temp>(key);
-				vd.template getLastProp<Phi_magnOfGrad>()  = get_vector_magnitude<Phi_grad_temp>(g_temp, key);
+				vd.getPos(p)[d] = grid.getPos(key)[d];
+				vd.template getProp<Phi_grad>(p)[d] = g_temp_ptr->template get<Phi_grad_temp>(key)[d];
 			}
-			++dom;
-		}
-		vd.map();	}
+			vd.template getProp<Phi_SDF_vd>(p)      = g_temp_ptr->template get<Phi_SDF_temp>(key);
+			vd.template getProp<Phi_magnOfGrad>(p)  = get_vector_magnitude<Phi_grad_temp>(*g_temp_ptr, key);
+		});
+	}
 	/** @brief Places particles within a narrow band around the interface. An arbitrary property is copied from the
 	 * grid to the respective particle.
 	 *
@@ -235,24 +210,15 @@ public:
 	template <size_t Phi_SDF_grid, size_t Prop1_grid, size_t Prop1_vd, typename vector_type, typename grid_type>
 	void get_narrow_band_copy_specific_property(grid_type & grid, vector_type & vd)
 	{
-		auto dom = grid.getDomainIterator();
-		while(dom.isNext())
+		add_narrow_band_particles<Phi_SDF_grid>(grid, vd, [&](auto & key, size_t p)
 		{
-			auto key = dom.get();
-			if(within_narrow_band(grid.template get<Phi_SDF_grid>(key)))
+			// assign coordinates and properties from respective grid point to particle
+			for(size_t d = 0; d < grid_type::dims; d++)
 			{
-				// add particle to vd_narrow_band
-				vd.add();
-				// assign coordinates and properties from respective grid point to particle
-				for(size_t d = 0; d < grid_type::dims; d++)
-				{
-					vd.getLastPos()[d] = grid.getPos(key)[d];
-				}
-				vd.template getLastProp<Prop1_vd>() = grid.template get<Prop1_grid>(key);
+				vd.getPos(p)[d] = grid.getPos(key)[d];
 			}
-			++dom;
-		}
-		vd.map();
+			vd.template getProp<Prop1_vd>(p) = grid.template get<Prop1_grid>(key);
+		});
 	}
 	/**@brief Places particles within a narrow band around the interface. An arbitrary property is copied from the
 	 * grid to the respective particle.
@@ -274,31 +240,29 @@ public:
 	Index2Vd, size_t Index3Vd, typename grid_type, typename vector_type>
 	void get_narrow_band_copy_three_scalar_properties(grid_type & grid, vector_type & vd)
 	{
-		
-			auto dom = grid.getDomainIterator();
-			while(dom.isNext())
+		add_narrow_band_particles<Phi_SDF_grid>(grid, vd, [&](auto & key, size_t p)
+		{
+			auto key_g = grid.getGKey(key);
+			// assign coordinates and properties from respective grid point to particle
+			for(size_t d = 0; d < grid_type::dims; d++)
 			{
-				auto key = dom.get();
-				auto key_g = grid.getGKey(key);
-				if(within_narrow_band(grid.template get<Phi_SDF_grid>(key)))
-				{
-					// add particle to vd_narrow_band
-					vd.add();
-					// assign coordinates and properties from respective grid point to particle
-					for(size_t d = 0; d < grid_type::dims; d++)
-					{
-						vd.getLastPos()[d] = key_g.get(d) * grid.getSpacing()[d];
-					}
-					vd.template getLastProp<Index1Vd>() = grid.template get<Index1Grid>(key);
-					vd.template getLastProp<Index2Vd>() = grid.template get<Index2Grid>(key);
-					vd.template getLastProp<Index3Vd>() = grid.template get<Index3Grid>(key);
-				}
-				++dom;
+				vd.getPos(p)[d] = key_g.get(d) * grid.getSpacing()[d];
 			}
-			vd.map();
+			vd.template getProp<Index1Vd>(p) = grid.template get<Index1Grid>(key);
+			vd.template getProp<Index2Vd>(p) = grid.template get<Index2Grid>(key);
+			vd.template getProp<Index3Vd>(p) = grid.template get<Index3Grid>(key);
+		});
 	}
 private:
 	//	Some indices for better readability
+	/**
+	 * @brief Temporary grid, which is only used inside the class to get the gradients.
+	 *
+	 * @details The grid is needed, when the user wants a narrow band which also contains the upwind gradient of phi,
+	 * so it is only allocated then (or set with #setWorkspace()). It contains the following 3 properties: Phi_SDF
+	 * (result from redistancing), gradient of Phi, and sign of Phi_SDF (for the upwinding).
+	 * */
+	std::shared_ptr<g_temp_type> g_temp_ptr;
 	static const size_t Phi_SDF_temp        = 0; ///< Property index of Phi_SDF on the temporary grid.
 	static const size_t Phi_grad_temp       = 1; ///< Property index of gradient of Phi on the temporary grid.
 	static const size_t Phi_sign_temp       = 2; ///< Property index of sign of Phi on the temporary grid.
@@ -353,11 +317,95 @@ private:
 	template <size_t Phi_SDF>
 	void initialize_temporary_grid(const grid_in_type & grid_in)
 	{
+		if (g_temp_ptr == nullptr) g_temp_ptr = create_redistancing_workspace<phi_type>(grid_in);
+		g_temp_type & g_temp = *g_temp_ptr;
 		copy_gridTogrid<Phi_SDF, Phi_SDF_temp>(grid_in, g_temp); // Copy Phi_SDF from the input grid to the temorary grid
 		init_sign_prop<Phi_SDF_temp, Phi_sign_temp>(g_temp); // initialize Phi_sign_temp with the sign of the
 		// input Phi_SDF
 		get_upwind_gradient<Phi_SDF_temp, Phi_sign_temp, Phi_grad_temp>(g_temp, 1, true);   // Get initial gradients
 	}
+	/**@brief Calls f(key) on the domain nodes of the slice x (in the last direction) of the local grid i.
+	 */
+	template<typename grid_type, typename lambda_type>
+	static void for_each_node_of_slice(grid_type & grid, size_t i, long int x, lambda_type f)
+	{
+		const unsigned int dims = grid_type::dims;
+		auto & Dbox = grid.getLocalGridsInfo().get(i).Dbox;
+		
+		size_t n = 1;
+		for (unsigned int d = 0; d < dims - 1; d++) n *= Dbox.getHigh(d) - Dbox.getLow(d) + 1;
+		
+		grid_key_dx<dims> k;
+		k.set_d(dims - 1, x);
+		for (size_t j = 0; j < n; j++)
+		{
+			size_t r = j;
+			for (unsigned int d = 0; d < dims - 1; d++)
+			{
+				const size_t sz_d = Dbox.getHigh(d) - Dbox.getLow(d) + 1;
+				k.set_d(d, Dbox.getLow(d) + r % sz_d);
+				r /= sz_d;
+			}
+			grid_dist_key_dx<dims> key(i, k);
+			f(key);
+		}
+	}
+	
+	/**@brief Adds a particle for every node of the narrow band and maps the particles.
+	 *
+	 * @details Two passes over the slices of the local grids (in the last direction), both in parallel: the nodes of
+	 * the narrow band are counted per slice, the particle vector is resized once, and every slice fills its range of
+	 * particles with fill(key, p).
+	 *
+	 * @tparam Phi_SDF_grid Index of property storing the signed distance function in the input grid.
+	 * @param grid Grid storing the SDF.
+	 * @param vd Particle vector, the particles are added after the existing ones.
+	 * @param fill Functor setting position and properties of the particle p from the node key.
+	 */
+	template <size_t Phi_SDF_grid, typename grid_type, typename vector_type, typename fill_type>
+	void add_narrow_band_particles(grid_type & grid, vector_type & vd, fill_type fill)
+	{
+		const unsigned int dims = grid_type::dims;
+		auto & patches = grid.getLocalGridsInfo();
+		
+		std::vector<std::pair<size_t, long int>> slices;
+		for (size_t i = 0; i < patches.size(); i++)
+		{
+			auto & Dbox = patches.get(i).Dbox;
+			bool empty = false;
+			for (unsigned int d = 0; d < dims; d++) {if (Dbox.getHigh(d) < Dbox.getLow(d)) empty = true;}
+			if (empty) continue;
+			for (long int x = Dbox.getLow(dims - 1); x <= Dbox.getHigh(dims - 1); x++) slices.push_back({i, x});
+		}
+		
+		std::vector<size_t> offset(slices.size() + 1, 0);
+		#pragma omp parallel for schedule(dynamic,1)
+		for (size_t s = 0; s < slices.size(); s++)
+		{
+			size_t count = 0;
+			for_each_node_of_slice(grid, slices[s].first, slices[s].second, [&](auto & key)
+			{
+				if (within_narrow_band(grid.template get<Phi_SDF_grid>(key))) count++;
+			});
+			offset[s + 1] = count;
+		}
+		for (size_t s = 0; s < slices.size(); s++) offset[s + 1] += offset[s];
+		
+		const size_t start = vd.size_local();
+		vd.resize(start + offset.back());
+		
+		#pragma omp parallel for schedule(dynamic,1)
+		for (size_t s = 0; s < slices.size(); s++)
+		{
+			size_t p = start + offset[s];
+			for_each_node_of_slice(grid, slices[s].first, slices[s].second, [&](auto & key)
+			{
+				if (within_narrow_band(grid.template get<Phi_SDF_grid>(key))) fill(key, p++);
+			});
+		}
+		vd.map();
+	}
+	
 	/**@brief Checks if a value for Phi_SDF lays within the narrow band.
 	 *
 	 * @tparam T Template type of parameter Phi.
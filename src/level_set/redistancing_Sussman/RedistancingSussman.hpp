@@ -35,6 +35,9 @@
 #include <iostream>
 #include <string>
 #include <fstream>
+#include <vector>
+#include <memory>
+#include <algorithm>
 // Include OpenFPM header files
 #include "Vector/vector_dist.hpp"
 #include "Grid/grid_dist_id.hpp"
@@ -46,6 +49,8 @@
 #include "HelpFunctionsForGrid.hpp"
 //#include "ComputeGradient.hpp"
 #include "FiniteDifference/Upwind_gradient.hpp"
+#include "util/trace_span.hpp"
+#include "util/memory_report.hpp"
 
 /** @brief Optional convergence criterium checking the total change.
  *
@@ -91,7 +96,12 @@ struct Conv_tol_residual
  * @param max_iter: Maximum number of iterations you want to run the redistancing, even if steady state might not yet
  *                have been reached (Default: 1e12).
  * @param order_space_op: Order of accuracy of the upwind gradient computation when solving the eikonal equation
- *                        during the redistancing. Options are: {1, 3, 5} (Default: 5).
+ *                        during the redistancing. Options are: {1, 3, 5, WENO_Z_5} (Default: 1).
+ * @param order_timestepper: Order of the pseudo-time integration. Options are: 1 (forward Euler), 2 (TVD-RK2) and 3
+ *                           (TVD-RK3) (Default: 1).
+ * @param courant_number: Courant number of the pseudo-time step computed from the CFL condition. The TVD Runge-Kutta
+ *                        schemes stay stable with larger values than forward Euler, e.g. 0.5 instead of 0.1, such
+ *                        that fewer iterations are needed (Default: 0.1).
  * @param convTolChange.value: Convolution tolerance for the normalized total change of Phi in the narrow band between
  *                           two consecutive iterations (Default: 1e-15).
  * @param convTolChange.check: Set true, if you want to use the normalized total change between two iterations as
@@ -111,6 +121,14 @@ struct Conv_tol_residual
  * @param print_steadyState_iter: If true, the number of the steady-state-iteration, the corresponding change
  *                              w.r.t the previous iteration and the residual is printed (Default: false).
  * @param save_temp_grid: If true, save the temporary grid as hdf5 that can be reloaded onto a grid
+ * @param narrow_band_iterations: If true, the redistancing iterations only update the nodes of an active band
+ *                                around the zero level set, the other nodes keep their value (Default: false).
+ * @param width_active_band_in_grid_points: Width of the active band in number of grid points. It is set to at least
+ *                                          the width of the narrow band plus twice the stencil width (Default: 16).
+ * @param local_convergence: If true, the convergence criteria are checked for every local grid (patch) separately
+ *                           and the converged patches stop iterating, while the others continue. Patches without
+ *                           narrow band nodes count as converged. The redistancing finishes when all the patches
+ *                           converged (or max_iter is reached) (Default: false).
  
  */
 template <typename phi_type=double>
@@ -119,6 +137,10 @@ struct Redist_options
 	size_t min_iter = 1e3;
 	size_t max_iter = 1e6;
 	
+	size_t order_space_op = 1;
+	size_t order_timestepper = 1;
+	double courant_number = 0.1;
+	
 	Conv_tol_change<phi_type> convTolChange;
 	Conv_tol_residual<phi_type> convTolResidual;
 	
@@ -127,6 +149,9 @@ struct Redist_options
 	bool print_current_iterChangeResidual = false;
 	bool print_steadyState_iter = true;
 	bool save_temp_grid = false;
+	bool narrow_band_iterations = false;
+	size_t width_active_band_in_grid_points = 16;
+	bool local_convergence = false;
 };
 
 /** @brief Bundles total residual and total change over all the grid points.
@@ -169,15 +194,32 @@ public:
 	 * @param redistOptions User defined options for the Sussman redistancing process
 	 *
 	 */
-	RedistancingSussman(grid_in_type &grid_in, Redist_options<phi_type> &redistOptions) : redistOptions(redistOptions),
-	                                                                            r_grid_in(grid_in),
-	                                                                            g_temp(grid_in.getDecomposition(),
-	                                                                                   grid_in.getGridInfoVoid().getSize(),
-	                                                                                   Ghost<grid_in_type::dims, long int>(3))
+	RedistancingSussman(grid_in_type &grid_in, Redist_options<phi_type> &redistOptions)
+	: RedistancingSussman(grid_in, redistOptions, create_redistancing_workspace<phi_type>(grid_in))
+	{}
+	
+	/** @brief Constructor using an existing workspace as temporary internal grid.
+	 *
+	 * @details The workspace can be shared with other #RedistancingSussman or #NarrowBand objects on the same input
+	 * grid (see create_redistancing_workspace() and getWorkspace()), such that repeated redistancing does not
+	 * allocate a new temporary grid every time.
+	 *
+	 * @param grid_in Input grid with min. 2 properties: 1.) Phi_0, 2.) Phi_SDF <- will be overwritten with
+	 * re-distancing result
+	 * @param redistOptions User defined options for the Sussman redistancing process
+	 * @param workspace Temporary grid with the same decomposition and size as grid_in and ghost 3.
+	 *
+	 */
+	RedistancingSussman(grid_in_type &grid_in, Redist_options<phi_type> &redistOptions,
+	                    std::shared_ptr<redistancing_workspace_type<grid_in_type, phi_type>> workspace)
+	: g_temp_ptr(workspace),
+	  g_temp(*g_temp_ptr),
+	  redistOptions(redistOptions),
+	  r_grid_in(grid_in)
 	{
-		// Get timestep fulfilling CFL condition for velocity=1.0 and courant number=0.1
-		time_step = get_time_step_CFL(grid_in, 1.0, 0.1);
-		order_upwind_gradient = 1;
+		// Get timestep fulfilling CFL condition for velocity=1.0 and the courant number of the options
+		time_step = get_time_step_CFL(grid_in, 1.0, redistOptions.courant_number);
+		order_upwind_gradient = redistOptions.order_space_op;
 #ifdef SE_CLASS1
 		assure_minimal_thickness_of_NB();
 #endif // SE_CLASS1
@@ -194,7 +236,11 @@ public:
 	        props_temp;
 	/** @brief Type definition for the temporary grid.
 	 */
-	typedef grid_dist_id<grid_in_type::dims, typename grid_in_type::stype, props_temp> g_temp_type;
+	typedef redistancing_workspace_type<grid_in_type, phi_type> g_temp_type;
+private:
+	//! Owner of the temporary grid, possibly shared with other objects.
+	std::shared_ptr<g_temp_type> g_temp_ptr;
+public:
 	/**
 	 * @brief Create temporary grid, which is only used inside the class for the redistancing.
 	 *
@@ -203,7 +249,16 @@ public:
 	 * gradient of Phi_{n+1},
 	 * sign of the original input Phi_0 (for the upwinding).
 	 */
-	g_temp_type g_temp;
+	g_temp_type & g_temp;
+	
+	/**@brief Returns the temporary internal grid, such that it can be shared with other objects.
+	 *
+	 * @return Shared pointer to the temporary grid.
+	 */
+	std::shared_ptr<g_temp_type> getWorkspace()
+	{
+		return g_temp_ptr;
+	}
 	
 	/**@brief Runs the Sussman-redistancing.
 	 *
@@ -214,6 +269,8 @@ public:
 	template <size_t Phi_0_in, size_t Phi_SDF_out>
 	void run_redistancing()
 	{
+		NUMERICS_TRACE_SPAN("sussman.redistancing");
+
 		init_temp_grid<Phi_0_in>();
 		init_sign_prop<Phi_n_temp, Phi_0_sign_temp>(g_temp); // Initialize Phi_0_sign_temp with the sign of the
 		// initial (pre-redistancing) Phi_0
@@ -265,6 +322,35 @@ public:
 		return distFromSol.count;
 	}
 	
+	/** @brief Number of nodes (over all processors) updated by the iterations, when
+	 * Redist_options::narrow_band_iterations is true.
+	 */
+	size_t get_numberActiveBandPoints()
+	{
+		return active_band_count;
+	}
+	
+	/** @brief Number of local grids (over all processors) still iterating, when Redist_options::local_convergence is
+	 * true.
+	 */
+	size_t get_numberActivePatches()
+	{
+		return active_patch_count;
+	}
+	
+	/** @brief Memory used by the temporaries of the redistancing in byte on this processor.
+	 *
+	 * @details The temporary grid (counted also when it is shared with other objects), the grid of the band marks,
+	 * the active band and the stage values of the TVD Runge-Kutta steps. The input grid is not counted.
+	 */
+	size_t getMemoryUsage()
+	{
+		size_t mem = gridMemoryUsage(g_temp) + active_band.capacity() * sizeof(grid_dist_key_dx<grid_in_type::dims>)
+		             + phi_rk.capacity() * sizeof(phi_type) + patch_active.capacity() / 8;
+		if (g_band != nullptr) mem += gridMemoryUsage(*g_band);
+		return mem;
+	}
+	
 private:
 	//	Some indices for better readability
 	static constexpr size_t Phi_n_temp          = 0; ///< Property index of Phi_0 on the temporary grid.
@@ -286,6 +372,22 @@ private:
 	 */
 	typename grid_in_type::stype time_step;
 	int order_upwind_gradient;
+	
+	/// Type of the grid marking the nodes of the active band.
+	typedef grid_dist_id<grid_in_type::dims, typename grid_in_type::stype, aggregate<int>> g_band_type;
+	/// Marks of the active band (0 = outside, else 1 + distance from the interface in grid points), created with the
+	/// first narrow band iteration.
+	std::unique_ptr<g_band_type> g_band;
+	/// Domain nodes updated by the narrow band iterations.
+	std::vector<grid_dist_key_dx<grid_in_type::dims>> active_band;
+	/// Number of nodes of the active band over all processors.
+	size_t active_band_count = 0;
+	/// Local grids still iterating (local convergence).
+	std::vector<bool> patch_active;
+	/// Number of local grids still iterating over all processors.
+	size_t active_patch_count = 0;
+	/// Phi_n at the beginning of a Runge-Kutta time step, in the order of #for_each_updated_node().
+	std::vector<phi_type> phi_rk;
 	//	Member functions
 #ifdef SE_CLASS1
 	/** @brief Checks if narrow band thickness >= 4 grid points. Else, sets it to 4 grid points.
@@ -335,12 +437,28 @@ private:
     */
 	void go_one_redistancing_step_whole_grid(g_temp_type &grid)
 	{
-		get_upwind_gradient<Phi_n_temp, Phi_0_sign_temp, Phi_grad_temp>(grid, order_upwind_gradient, true);
-		grid.template ghost_get<Phi_n_temp, Phi_grad_temp>();
+		if (redistOptions.local_convergence)
+		{
+			upwind_gradient_lines<Phi_n_temp, Phi_0_sign_temp, Phi_grad_temp>(grid, true, order_upwind_gradient,
+			                                                                  &patch_active);
+		}
+		else
+		{
+			get_upwind_gradient<Phi_n_temp, Phi_0_sign_temp, Phi_grad_temp>(grid, order_upwind_gradient, true);
+		}
+		{
+			NUMERICS_TRACE_SPAN("sussman.ghost_get");
+			grid.template ghost_get<Phi_n_temp, Phi_grad_temp>();
+		}
 		auto dom = grid.getDomainIterator();
 		while (dom.isNext())
 		{
 			auto key = dom.get();
+			if (redistOptions.local_convergence && patch_active[key.getSub()] == false)
+			{
+				++dom;
+				continue;
+			}
 			const phi_type phi_n = grid.template get<Phi_n_temp>(key);
 			const phi_type phi_n_magnOfGrad = get_vector_magnitude<Phi_grad_temp>(grid, key);
 			phi_type epsilon = phi_n_magnOfGrad * grid.getSpacing()[0];
@@ -350,6 +468,205 @@ private:
 		}
 	}
 
+	/** @brief Builds the list of the nodes updated by the narrow band iterations.
+	 *
+	 * @details The nodes next to a sign change of Phi are marked and the marks are dilated along the grid axes by half
+	 * the width of the active band (one ghost exchange of the marks per grid point). The band is therefore
+	 * defined by the position of the zero level set and does not depend on the scaling of Phi_0. Since the
+	 * redistancing preserves the interface, the band is only re-built at every convergence check.
+	 *
+	 * @param grid Internal temporary grid.
+	 */
+	void build_active_band(g_temp_type &grid)
+	{
+		NUMERICS_TRACE_SPAN("sussman.active_band");
+
+		const unsigned int dims = grid_in_type::dims;
+		
+		// Same decomposition, size and ghost of the temporary grid: the keys of the two grids are the same
+		if (g_band == nullptr)
+		{
+			g_band.reset(new g_band_type(grid.getDecomposition(), grid.getGridInfoVoid().getSize(),
+			                             Ghost<grid_in_type::dims, long int>(3)));
+		}
+		
+		const int half_width = std::max((int)ceil(redistOptions.width_active_band_in_grid_points / 2.0),
+		                                (int)ceil(redistOptions.width_NB_in_grid_points / 2.0) + 3);
+		
+		grid.template ghost_get<Phi_n_temp>(KEEP_PROPERTIES);
+		
+		// Mark the nodes next to the interface
+		auto dom = grid.getDomainIterator();
+		while (dom.isNext())
+		{
+			auto key = dom.get();
+			auto key_g = grid.getGKey(key);
+			const int s = sgn(grid.template get<Phi_n_temp>(key));
+			int mark = (s == 0);
+			for (size_t d = 0; d < dims; d++)
+			{
+				if (key_g.get(d) > 0 && sgn(grid.template get<Phi_n_temp>(key.move(d, -1))) != s) mark = 1;
+				if (key_g.get(d) < grid.size(d) - 1 && sgn(grid.template get<Phi_n_temp>(key.move(d, 1))) != s) mark = 1;
+			}
+			g_band->template get<0>(key) = mark;
+			++dom;
+		}
+		
+		// Dilate the marks, step by step
+		for (int step = 1; step <= half_width; step++)
+		{
+			g_band->template ghost_get<0>();
+			auto dom_b = g_band->getDomainIterator();
+			while (dom_b.isNext())
+			{
+				auto key = dom_b.get();
+				if (g_band->template get<0>(key) == 0)
+				{
+					auto key_g = g_band->getGKey(key);
+					for (size_t d = 0; d < dims; d++)
+					{
+						int m_l = (key_g.get(d) > 0) ? g_band->template get<0>(key.move(d, -1)) : 0;
+						int m_r = (key_g.get(d) < g_band->size(d) - 1) ? g_band->template get<0>(key.move(d, 1)) : 0;
+						if ((m_l > 0 && m_l <= step) || (m_r > 0 && m_r <= step))
+						{
+							g_band->template get<0>(key) = step + 1;
+							break;
+						}
+					}
+				}
+				++dom_b;
+			}
+		}
+		
+		active_band.clear();
+		auto dom_a = grid.getDomainIterator();
+		while (dom_a.isNext())
+		{
+			auto key = dom_a.get();
+			if (g_band->template get<0>(key) > 0) active_band.push_back(key);
+			++dom_a;
+		}
+		
+		// Nodes entering the band need an up to date gradient for the convergence check
+		for (auto & key : active_band)
+		{
+			upwind_gradient_node<Phi_n_temp, Phi_0_sign_temp, Phi_grad_temp>(grid, key, true, order_upwind_gradient);
+		}
+		
+		active_band_count = active_band.size();
+		auto &v_cl = create_vcluster();
+		v_cl.sum(active_band_count);
+		v_cl.execute();
+	}
+	
+	/** @brief Go one re-distancing time-step on the nodes of the active band only.
+	 *
+	 * @details Same update as #go_one_redistancing_step_whole_grid(), the nodes outside of the band keep their value
+	 * and are only read by the stencils of the nodes at the border of the band.
+	 *
+	 * @param grid Internal temporary grid.
+	 */
+	void go_one_redistancing_step_band(g_temp_type &grid)
+	{
+		{
+			NUMERICS_TRACE_SPAN("sussman.ghost_get");
+			grid.template ghost_get<Phi_n_temp>(KEEP_PROPERTIES);
+		}
+		for (auto & key : active_band)
+		{
+			if (redistOptions.local_convergence && patch_active[key.getSub()] == false) continue;
+			upwind_gradient_node<Phi_n_temp, Phi_0_sign_temp, Phi_grad_temp>(grid, key, true, order_upwind_gradient);
+		}
+		for (auto & key : active_band)
+		{
+			if (redistOptions.local_convergence && patch_active[key.getSub()] == false) continue;
+			const phi_type phi_n = grid.template get<Phi_n_temp>(key);
+			const phi_type phi_n_magnOfGrad = get_vector_magnitude<Phi_grad_temp>(grid, key);
+			phi_type epsilon = phi_n_magnOfGrad * grid.getSpacing()[0];
+			grid.template get<Phi_n_temp>(key) = get_phi_nplus1(phi_n, phi_n_magnOfGrad, time_step,
+			                                                         smooth_S(phi_n, epsilon));
+		}
+	}
+	
+	/** @brief Go one forward Euler step, on the whole grid or on the active band.
+	 *
+	 * @param grid Internal temporary grid.
+	 */
+	void go_one_euler_step(g_temp_type &grid)
+	{
+		if (redistOptions.narrow_band_iterations) go_one_redistancing_step_band(grid);
+		else go_one_redistancing_step_whole_grid(grid);
+	}
+	
+	/** @brief Calls f(key, n) on the nodes updated by a time step (the active band or the domain, without the
+	 * converged local grids), n is the running index of the node.
+	 */
+	template<typename lambda_type>
+	void for_each_updated_node(g_temp_type &grid, lambda_type f)
+	{
+		size_t n = 0;
+		if (redistOptions.narrow_band_iterations)
+		{
+			for (auto & key : active_band)
+			{
+				if (redistOptions.local_convergence && patch_active[key.getSub()] == false) continue;
+				f(key, n++);
+			}
+		}
+		else
+		{
+			auto dom = grid.getDomainIterator();
+			while (dom.isNext())
+			{
+				auto key = dom.get();
+				if (!(redistOptions.local_convergence && patch_active[key.getSub()] == false)) f(key, n++);
+				++dom;
+			}
+		}
+	}
+	
+	/** @brief Go one re-distancing time-step, on the whole grid or on the active band.
+	 *
+	 * @details With Redist_options::order_timestepper 2 or 3, the step is the TVD Runge-Kutta scheme of Shu and Osher
+	 * (1988), written as forward Euler stages followed by convex combinations with Phi_n:
+	 * @f[ \phi^{(k)} = a_k \phi_n + (1 - a_k) (\phi^{(k-1)} + \Delta t L(\phi^{(k-1)})) @f] with a = {0, 1/2} for
+	 * TVD-RK2 and a = {0, 3/4, 1/3} for TVD-RK3. Every stage costs the same as a forward Euler step.
+	 *
+	 * @param grid Internal temporary grid.
+	 */
+	void go_one_redistancing_step(g_temp_type &grid)
+	{
+		NUMERICS_TRACE_SPAN("sussman.iteration");
+
+		const size_t order = redistOptions.order_timestepper;
+		if (order <= 1)
+		{
+			go_one_euler_step(grid);
+			return;
+		}
+		
+		static const phi_type a_rk2[] = {0.0, 1.0 / 2.0};
+		static const phi_type a_rk3[] = {0.0, 3.0 / 4.0, 1.0 / 3.0};
+		const phi_type * a = (order == 2) ? a_rk2 : a_rk3;
+		const size_t n_stages = (order == 2) ? 2 : 3;
+		
+		phi_rk.clear();
+		for_each_updated_node(grid, [&](auto & key, size_t n)
+		{
+			phi_rk.push_back(grid.template get<Phi_n_temp>(key));
+		});
+		
+		go_one_euler_step(grid);
+		for (size_t k = 1; k < n_stages; k++)
+		{
+			go_one_euler_step(grid);
+			for_each_updated_node(grid, [&](auto & key, size_t n)
+			{
+				grid.template get<Phi_n_temp>(key) = a[k] * phi_rk[n] + (1 - a[k]) * grid.template get<Phi_n_temp>(key);
+			});
+		}
+	}
+
 	/** @brief Checks if a node lays within the narrow band around the interface.
 	 *
 	 * @param Phi Value of Phi at that specific node.
@@ -371,10 +688,8 @@ private:
 		phi_type max_residual = 0;
 		phi_type max_change = 0;
 		int count = 0;
-		auto dom = grid.getDomainIterator();
-		while (dom.isNext())
+		auto check_node = [&](auto & key)
 		{
-			auto key = dom.get();
 			if (lays_inside_NB(grid.template get<Phi_n_temp>(key)))
 			{
 				count++;
@@ -390,7 +705,21 @@ private:
 				
 				if (abs(phi_n_magnOfGrad - 1) > max_residual) { max_residual = abs(phi_n_magnOfGrad - 1); }
 			}
-			++dom;
+		};
+		if (redistOptions.narrow_band_iterations)
+		{
+			// The gradient is only up to date on the active band
+			for (auto & key : active_band) check_node(key);
+		}
+		else
+		{
+			auto dom = grid.getDomainIterator();
+			while (dom.isNext())
+			{
+				auto key = dom.get();
+				check_node(key);
+				++dom;
+			}
 		}
 		auto &v_cl = create_vcluster();
 		v_cl.max(max_change);
@@ -439,30 +768,92 @@ private:
 	 */
 	bool steady_state_NB(g_temp_type &grid)
 	{
-		bool steady_state = false;
+		if (redistOptions.local_convergence) return steady_state_patches(grid);
 		update_distFromSol(grid);
+		return criterion_met(distFromSol.change, distFromSol.residual, distFromSol.count);
+	}
+	
+	/** @brief Checks the user-defined convergence criteria for a given change, residual and number of narrow band
+	 * points.
+	 *
+	 * @see Conv_tol_change, Conv_tol_residual
+	 */
+	bool criterion_met(phi_type change, phi_type residual, int count)
+	{
+		bool steady_state = false;
 		if (redistOptions.convTolChange.check && redistOptions.convTolResidual.check)
 		{
 			steady_state = (
-					distFromSol.change <= redistOptions.convTolChange.value &&
-					distFromSol.residual <= redistOptions.convTolResidual.value &&
-					distFromSol.count > 0
+					change <= redistOptions.convTolChange.value &&
+					residual <= redistOptions.convTolResidual.value &&
+					count > 0
 					);
 		}
 		else
 		{
 			if (redistOptions.convTolChange.check)
 			{
-				steady_state = (distFromSol.change <= redistOptions.convTolChange.value && distFromSol.count > 0);
+				steady_state = (change <= redistOptions.convTolChange.value && count > 0);
 			}       // Use the normalized total change between two iterations in the narrow bands steady-state criterion
 			if (redistOptions.convTolResidual.check)
 			{
-				steady_state = (distFromSol.residual <= redistOptions.convTolResidual.value && distFromSol.count > 0);
+				steady_state = (residual <= redistOptions.convTolResidual.value && count > 0);
 			} // Use the normalized total residual of phi compared to SDF in the narrow bands steady-state criterion
 		}
 		return steady_state;
 	}
 	
+	/** @brief Checks the convergence of every still iterating local grid, and stops the converged ones.
+	 *
+	 * @details Change and residual are computed like in #update_distFromSol(), but per local grid. A local grid
+	 * without narrow band nodes is converged.
+	 *
+	 * @param grid Internal temporary grid.
+	 *
+	 * @return True, if all the local grids of all the processors converged.
+	 */
+	bool steady_state_patches(g_temp_type &grid)
+	{
+		const size_t n_patches = grid.getLocalGridsInfo().size();
+		std::vector<phi_type> max_change(n_patches, 0), max_residual(n_patches, 0);
+		std::vector<int> count(n_patches, 0);
+		
+		auto dom = grid.getDomainIterator();
+		while (dom.isNext())
+		{
+			auto key = dom.get();
+			const size_t p = key.getSub();
+			if (patch_active[p] && lays_inside_NB(grid.template get<Phi_n_temp>(key)))
+			{
+				count[p]++;
+				phi_type phi_n_magnOfGrad = get_vector_magnitude<Phi_grad_temp>(grid, key);
+				phi_type epsilon = phi_n_magnOfGrad * grid.getSpacing()[0];
+				phi_type phi_nplus1 = get_phi_nplus1(grid.template get<Phi_n_temp>(key), phi_n_magnOfGrad, time_step,
+				                                   smooth_S(grid.template get<Phi_n_temp>(key), epsilon));
+				max_change[p] = std::max(max_change[p], (phi_type)abs(phi_nplus1 - grid.template get<Phi_n_temp>(key)));
+				max_residual[p] = std::max(max_residual[p], (phi_type)abs(phi_n_magnOfGrad - 1));
+			}
+			++dom;
+		}
+		
+		active_patch_count = 0;
+		for (size_t p = 0; p < n_patches; p++)
+		{
+			if (patch_active[p] && (count[p] == 0 || criterion_met(max_change[p], max_residual[p], count[p])))
+			{
+				patch_active[p] = false;
+			}
+			if (patch_active[p]) active_patch_count++;
+		}
+		
+		auto &v_cl = create_vcluster();
+		v_cl.sum(active_patch_count);
+		v_cl.execute();
+		
+		update_distFromSol(grid);
+		return active_patch_count == 0;
+	}
+	
 	/** @brief Runs Sussman re-distancing on the internal temporary grid.
 	 *
 	 * @details The number of iterations is minimum redistOptions.min_iter iterations and finishes when either
@@ -475,13 +866,23 @@ private:
 	void iterative_redistancing(g_temp_type &grid)
 	{
 		int i = 0;
+		patch_active.assign(grid.getLocalGridsInfo().size(), true);
+		active_patch_count = grid.getLocalGridsInfo().size();
+		if (redistOptions.local_convergence)
+		{
+			auto &v_cl = create_vcluster();
+			v_cl.sum(active_patch_count);
+			v_cl.execute();
+		}
+		if (redistOptions.narrow_band_iterations) build_active_band(grid);
 		while (i < redistOptions.max_iter)
 		{
 			for (int j = 0; j < redistOptions.interval_check_convergence; j++)
 			{
-				go_one_redistancing_step_whole_grid(grid);
+				go_one_redistancing_step(grid);
 				++i;
 			}
+			if (redistOptions.narrow_band_iterations) build_active_band(grid);
 			if (redistOptions.print_current_iterChangeResidual)
 			{
 				print_out_iteration_change_residual(grid, i);
@@ -495,6 +896,8 @@ private:
 			}
 			if (i >= redistOptions.min_iter)
 			{
+				NUMERICS_TRACE_SPAN("sussman.convergence_check");
+
 				if (steady_state_NB(grid))
 				{
 					if (redistOptions.print_steadyState_iter)
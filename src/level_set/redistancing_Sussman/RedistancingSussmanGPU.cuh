@@ -0,0 +1,578 @@
+//
+// Sussman redistancing on GPU grids
+//
+/**
+ * @file RedistancingSussmanGPU.cuh
+ *
+ * @brief Device version of #RedistancingSussman for grid_dist_id with GPU local grids.
+ *
+ * @details The whole redistancing runs on the device copy of the grids: the initialization of the temporary grid,
+ * the upwind gradient (#get_upwind_gradient_gpu()), the pseudo-time steps, the reductions of the convergence check
+ * and the ghost exchanges (RUN_ON_DEVICE). Only the three scalars of every convergence check (change, residual and
+ * number of narrow band nodes) are copied to the host, to be reduced over the processors. The scheme is the one of
+ * the CPU version with the whole grid iterations, so both give the same signed distance function.
+ */
+#ifndef REDISTANCING_SUSSMAN_REDISTANCINGSUSSMANGPU_CUH
+#define REDISTANCING_SUSSMAN_REDISTANCINGSUSSMANGPU_CUH
+
+#if defined(__NVCC__)
+
+#include "RedistancingSussman.hpp"
+#include "FiniteDifference/FD_grid_gpu.cuh"
+
+/**@brief Atomic compare and swap of a double (through its bits).
+ */
+__device__ inline double redist_gpu_atomic_cas(double * addr, double assumed, double val)
+{
+	return __longlong_as_double((long long int)atomicCAS((unsigned long long int *)addr,
+	                                                     (unsigned long long int)__double_as_longlong(assumed),
+	                                                     (unsigned long long int)__double_as_longlong(val)));
+}
+
+/**@brief Atomic compare and swap of a float (through its bits).
+ */
+__device__ inline float redist_gpu_atomic_cas(float * addr, float assumed, float val)
+{
+	return __int_as_float(atomicCAS((int *)addr, __float_as_int(assumed), __float_as_int(val)));
+}
+
+/**@brief Atomic min (is_max = false) or max (is_max = true) of a floating point value.
+ *
+ * @param addr Address of the reduced value.
+ * @param val Value of the current thread.
+ */
+template<bool is_max, typename T>
+__device__ inline void redist_gpu_atomic_minmax(T * addr, T val)
+{
+	T old = *addr;
+	while (is_max ? (val > old) : (val < old))
+	{
+		T assumed = old;
+		old = redist_gpu_atomic_cas(addr, assumed, val);
+		if (old == assumed) {break;}
+	}
+}
+
+/**@brief Kernel copying the property prp_src of a grid into the property prp_dst of a grid with the same
+ * decomposition, the local grids can have different ghost layers.
+ *
+ * @param g_src Source local grid (kernel view).
+ * @param g_dst Destination local grid (kernel view).
+ * @param ite GPU iterator over the domain of the destination patch.
+ * @param shift Offset from the destination to the source local key.
+ */
+template<unsigned int dim, unsigned int prp_src, unsigned int prp_dst, typename grid_src_type, typename grid_dst_type>
+__global__ void redist_gpu_copy_ker(grid_src_type g_src, grid_dst_type g_dst, ite_gpu<dim> ite,
+                                    grid_key_dx<dim,int> shift)
+{
+	grid_key_dx<dim,int> key;
+	if (fd_gpu_key(ite,key) == false)	{return;}
+
+	grid_key_dx<dim,int> key_src;
+	for (unsigned int d = 0 ; d < dim ; d++)	{key_src.set_d(d,key.get(d) + shift.get(d));}
+
+	g_dst.template get<prp_dst>(key) = g_src.template get<prp_src>(key_src);
+}
+
+/**@brief Kernel setting the property prp of all the nodes of the iterator to value.
+ */
+template<unsigned int dim, unsigned int prp, typename grid_type, typename T>
+__global__ void redist_gpu_set_ker(grid_type g, ite_gpu<dim> ite, T value)
+{
+	grid_key_dx<dim,int> key;
+	if (fd_gpu_key(ite,key) == false)	{return;}
+
+	g.template get<prp>(key) = value;
+}
+
+/**@brief Kernel reducing the minimum of the property prp over the domain of a patch.
+ */
+template<unsigned int dim, unsigned int prp, typename grid_type, typename red_type>
+__global__ void redist_gpu_min_ker(grid_type g, ite_gpu<dim> ite, red_type red)
+{
+	grid_key_dx<dim,int> key;
+	if (fd_gpu_key(ite,key) == false)	{return;}
+
+	redist_gpu_atomic_minmax<false>(&red.template get<0>(0), g.template get<prp>(key));
+}
+
+/**@brief Kernel storing the sign of Phi.
+ */
+template<unsigned int dim, unsigned int Phi, unsigned int Phi_sign, typename grid_type>
+__global__ void redist_gpu_sign_ker(grid_type g, ite_gpu<dim> ite)
+{
+	grid_key_dx<dim,int> key;
+	if (fd_gpu_key(ite,key) == false)	{return;}
+
+	typedef typename std::decay<decltype(g.template get<Phi>(key))>::type phi_type;
+	phi_type phi = g.template get<Phi>(key);
+	g.template get<Phi_sign>(key) = (phi_type(0) < phi) - (phi < phi_type(0));
+}
+
+/**@brief Gradient magnitude and smooth sign of Phi in a node, as in RedistancingSussman.
+ */
+template<unsigned int dim, unsigned int Phi, unsigned int Phi_grad, typename grid_type, typename T>
+__device__ inline void redist_gpu_magn_S(grid_type & g, const grid_key_dx<dim,int> & key, T h0, T & magn, T & S)
+{
+	magn = 0;
+	for (unsigned int d = 0 ; d < dim ; d++)
+	{magn += g.template get<Phi_grad>(key)[d] * g.template get<Phi_grad>(key)[d];}
+	magn = sqrt(magn);
+
+	T phi = g.template get<Phi>(key);
+	T epsilon = magn * h0;
+	S = phi / sqrt(phi * phi + epsilon * epsilon);
+}
+
+/**@brief Kernel of one forward Euler step of the redistancing on the domain of a patch.
+ *
+ * @param dt Time step.
+ * @param h0 Grid spacing in the first direction (smoothing of the sign).
+ */
+template<unsigned int dim, unsigned int Phi, unsigned int Phi_grad, typename grid_type, typename T>
+__global__ void redist_gpu_euler_ker(grid_type g, ite_gpu<dim> ite, T dt, T h0)
+{
+	grid_key_dx<dim,int> key;
+	if (fd_gpu_key(ite,key) == false)	{return;}
+
+	T magn, S;
+	redist_gpu_magn_S<dim,Phi,Phi_grad>(g,key,h0,magn,S);
+
+	g.template get<Phi>(key) += dt * S * (1 - magn);
+}
+
+/**@brief Kernel of the convex combination of a Runge-Kutta stage with Phi_n: Phi = a Phi_n + (1 - a) Phi.
+ */
+template<unsigned int dim, unsigned int Phi, unsigned int Phi_rk, typename grid_type, typename T>
+__global__ void redist_gpu_rk_ker(grid_type g, ite_gpu<dim> ite, T a)
+{
+	grid_key_dx<dim,int> key;
+	if (fd_gpu_key(ite,key) == false)	{return;}
+
+	g.template get<Phi>(key) = a * g.template get<Phi_rk>(key) + (1 - a) * g.template get<Phi>(key);
+}
+
+/**@brief Kernel reducing change, residual and number of nodes of the narrow band, as
+ * RedistancingSussman::update_distFromSol().
+ *
+ * @param red Output: max. change (property 0), max. residual (property 1), number of nodes (property 2).
+ * @param kappa Half width of the narrow band.
+ */
+template<unsigned int dim, unsigned int Phi, unsigned int Phi_grad, typename grid_type, typename red_type, typename T>
+__global__ void redist_gpu_dist_from_sol_ker(grid_type g, ite_gpu<dim> ite, red_type red, T dt, T h0, T kappa)
+{
+	grid_key_dx<dim,int> key;
+	if (fd_gpu_key(ite,key) == false)	{return;}
+
+	if (fabs(g.template get<Phi>(key)) > kappa)	{return;}
+
+	T magn, S;
+	redist_gpu_magn_S<dim,Phi,Phi_grad>(g,key,h0,magn,S);
+
+	redist_gpu_atomic_minmax<true>(&red.template get<0>(0), (T)fabs(dt * S * (1 - magn)));
+	redist_gpu_atomic_minmax<true>(&red.template get<1>(0), (T)fabs(magn - 1));
+	atomicAdd(&red.template get<2>(0), 1);
+}
+
+/**@brief Type of the temporary grid of #RedistancingSussmanGPU.
+ *
+ * @details The properties are: Phi, gradient of Phi, sign of the initial Phi, Phi at the beginning of a Runge-Kutta
+ * step. The ghost layer is 3 nodes wide.
+ */
+template <typename grid_in_type, typename phi_type=double>
+using redistancing_workspace_gpu_type = grid_dist_id<grid_in_type::dims, typename grid_in_type::stype,
+		aggregate<phi_type, phi_type[grid_in_type::dims], int, phi_type>, typename grid_in_type::decomposition,
+		typename grid_in_type::memory_type, grid_gpu<grid_in_type::dims,
+		aggregate<phi_type, phi_type[grid_in_type::dims], int, phi_type>>>;
+
+/**@brief Class for reinitializing a level-set function into a signed distance function using Sussman redistancing
+ * on GPU grids.
+ *
+ * @details Same interface and options of #RedistancingSussman. Phi_0 is read from the device copy of the input grid
+ * and the signed distance function is written on the device copy, no host to device transfer is done. The
+ * temporary grid is allocated by the constructor and reused by every run_redistancing(), such that the object can be
+ * kept across the time steps of a simulation.
+ *
+ * Redist_options::narrow_band_iterations and Redist_options::local_convergence are not supported, the iterations
+ * always update the whole grid. Redist_options::save_temp_grid is ignored.
+ *
+ * @tparam grid_in_type Type of the input grid with GPU local grids.
+ */
+template <typename grid_in_type, typename phi_type=double>
+class RedistancingSussmanGPU
+{
+public:
+	/** @brief Constructor initializing the redistancing options, the temporary internal grid and reference variable
+	 * to the input grid.
+	 *
+	 * @param grid_in Input grid with min. 2 properties: 1.) Phi_0, 2.) Phi_SDF <- will be overwritten with
+	 * re-distancing result
+	 * @param redistOptions User defined options for the Sussman redistancing process
+	 *
+	 */
+	RedistancingSussmanGPU(grid_in_type &grid_in, Redist_options<phi_type> &redistOptions)
+	: g_temp(grid_in.getDecomposition(), grid_in.getGridInfoVoid().getSize(), Ghost<grid_in_type::dims, long int>(3)),
+	  redistOptions(redistOptions),
+	  r_grid_in(grid_in)
+	{
+		time_step = get_time_step_CFL(grid_in, 1.0, redistOptions.courant_number);
+		order_upwind_gradient = redistOptions.order_space_op;
+		kappa = ceil(redistOptions.width_NB_in_grid_points / 2.0) * get_biggest_spacing(g_temp);
+		red.resize(1);
+	}
+
+	/** @brief Type definition for the temporary grid.
+	 */
+	typedef redistancing_workspace_gpu_type<grid_in_type, phi_type> g_temp_type;
+
+	/**@brief Temporary grid, which is only used inside the class for the redistancing.
+	 */
+	g_temp_type g_temp;
+
+	/**@brief Runs the Sussman-redistancing on the device.
+	 *
+	 * @details Copies Phi_0 from the device copy of the input grid to the temporary grid, runs the redistancing and
+	 * copies the resulting signed distance function to the device copy of Phi_SDF_out.
+	 */
+	template <size_t Phi_0_in, size_t Phi_SDF_out>
+	void run_redistancing()
+	{
+		init_temp_grid<Phi_0_in>();
+		for_each_patch(g_temp, [&](auto & lg, auto & ite)
+		{
+			CUDA_LAUNCH((redist_gpu_sign_ker<dims,Phi_n_temp,Phi_0_sign_temp>),ite,lg.toKernel(),ite);
+		});
+		get_upwind_gradient_gpu<Phi_n_temp, Phi_0_sign_temp, Phi_grad_temp>(g_temp, order_upwind_gradient, true);
+		iterative_redistancing();
+		copy_temp_to_grid_in<Phi_SDF_out>();
+	}
+
+	/** @brief Overwrite the time_step found via CFL condition with an individual time_step.
+	 *
+	 * @param dt Artificial time step by which re-distancing should be performed.
+	 */
+	template<typename T>
+	void set_user_time_step(T dt)
+	{
+		time_step = dt;
+	}
+
+	/** @brief Access the artificial timestep which will be used for the iterative redistancing.
+	 */
+	auto get_time_step()
+	{
+		return time_step;
+	}
+
+	int get_finalIteration()
+	{
+		return final_iter;
+	}
+
+	auto get_finalChange()
+	{
+		return distFromSol.change;
+	}
+
+	auto get_finalResidual()
+	{
+		return distFromSol.residual;
+	}
+
+	int get_finalNumberNbPoints()
+	{
+		return distFromSol.count;
+	}
+
+private:
+	static constexpr unsigned int dims = grid_in_type::dims;
+
+	//	Some indices for better readability
+	static constexpr size_t Phi_n_temp          = 0; ///< Property index of Phi_n on the temporary grid.
+	static constexpr size_t Phi_grad_temp       = 1; ///< Property index of gradient of Phi_n on the temporary grid.
+	static constexpr size_t Phi_0_sign_temp     = 2; ///< Property index of sign of initial (input) Phi_0 (temp. grid).
+	static constexpr size_t Phi_rk_temp         = 3; ///< Property index of Phi_n at the beginning of a RK step.
+
+	Redist_options<phi_type> redistOptions; ///< Instantiate redistancing options.
+	grid_in_type &r_grid_in; ///< Define reference to input grid.
+
+	DistFromSol<phi_type> distFromSol; ///< Distance from solution in terms of change, residual, numb. point in NB.
+	int final_iter = 0; ///< Will be set to the final iteration when redistancing ends.
+
+	phi_type kappa; ///< Physical half-bandwidth of the narrow band.
+	typename grid_in_type::stype time_step; ///< Artificial timestep for the redistancing iterations.
+	int order_upwind_gradient;
+
+	/// Device buffer of the reductions: min. Phi_0 or max. change, max. residual, number of narrow band nodes.
+	openfpm::vector_custd<aggregate<phi_type, phi_type, int>> red;
+
+	/** @brief Launch a kernel on every local grid, over its domain (ghost = false) or over the whole local grid
+	 * (ghost = true).
+	 *
+	 * @param launch Functor called with (local grid, GPU iterator) for every not empty patch.
+	 */
+	template<typename grid_type, typename launch_type>
+	void for_each_patch(grid_type & grid, launch_type launch, bool ghost = false)
+	{
+		auto & patches = grid.getLocalGridsInfo();
+		for (size_t i = 0; i < patches.size(); i++)
+		{
+			launch_patch(grid, i, ghost, [&](auto & ite){launch(grid.get_loc_grid(i), ite);});
+		}
+	}
+
+	/** @brief Launch a kernel on the local grid i, see #for_each_patch().
+	 */
+	template<typename grid_type, typename launch_type>
+	void launch_patch(grid_type & grid, size_t i, bool ghost, launch_type launch)
+	{
+		auto & patch = grid.getLocalGridsInfo().get(i);
+
+		grid_key_dx<dims,long int> start;
+		grid_key_dx<dims,long int> stop;
+		for (unsigned int d = 0; d < dims; d++)
+		{
+			start.set_d(d, (ghost) ? 0 : patch.Dbox.getLow(d));
+			stop.set_d(d, (ghost) ? patch.GDbox.getHigh(d) - patch.GDbox.getLow(d) : patch.Dbox.getHigh(d));
+			if (stop.get(d) < start.get(d)) {return;}
+		}
+
+		auto ite = grid.get_loc_grid(i).getGPUIterator(start,stop);
+		launch(ite);
+	}
+
+	/** @brief Offset from the local keys of the domain of grid_dst to the ones of grid_src, local grid i.
+	 */
+	template<typename grid_src_type, typename grid_dst_type>
+	grid_key_dx<dims,int> local_shift(grid_src_type & grid_src, grid_dst_type & grid_dst, size_t i)
+	{
+		grid_key_dx<dims,int> shift;
+		for (unsigned int d = 0; d < dims; d++)
+		{
+			shift.set_d(d, grid_src.getLocalGridsInfo().get(i).Dbox.getLow(d) -
+			               grid_dst.getLocalGridsInfo().get(i).Dbox.getLow(d));
+		}
+		return shift;
+	}
+
+	/** @brief Copies Phi_0 from the input grid to the temporary grid and initializes the ghost layer with the minimum
+	 * value of Phi_0, as RedistancingSussman::init_temp_grid().
+	 */
+	template<size_t Phi_0_in>
+	void init_temp_grid()
+	{
+		red.template get<0>(0) = std::numeric_limits<phi_type>::max();
+		red.template hostToDevice<0>();
+		for_each_patch(r_grid_in, [&](auto & lg, auto & ite)
+		{
+			CUDA_LAUNCH((redist_gpu_min_ker<dims,Phi_0_in>),ite,lg.toKernel(),ite,red.toKernel());
+		});
+		red.template deviceToHost<0>();
+
+		phi_type min_value = red.template get<0>(0);
+		auto &v_cl = create_vcluster();
+		v_cl.min(min_value);
+		v_cl.execute();
+
+		for_each_patch(g_temp, [&](auto & lg, auto & ite)
+		{
+			CUDA_LAUNCH((redist_gpu_set_ker<dims,Phi_n_temp>),ite,lg.toKernel(),ite,min_value);
+		}, true);
+
+		for (size_t i = 0; i < g_temp.getLocalGridsInfo().size(); i++)
+		{
+			grid_key_dx<dims,int> shift = local_shift(r_grid_in, g_temp, i);
+			launch_patch(g_temp, i, false, [&](auto & ite)
+			{
+				CUDA_LAUNCH((redist_gpu_copy_ker<dims,Phi_0_in,Phi_n_temp>),ite,r_grid_in.get_loc_grid(i).toKernel(),
+				            g_temp.get_loc_grid(i).toKernel(),ite,shift);
+			});
+		}
+	}
+
+	/** @brief Copies the result from the temporary grid to the property Phi_SDF_out of the input grid.
+	 */
+	template<size_t Phi_SDF_out>
+	void copy_temp_to_grid_in()
+	{
+		for (size_t i = 0; i < r_grid_in.getLocalGridsInfo().size(); i++)
+		{
+			grid_key_dx<dims,int> shift = local_shift(g_temp, r_grid_in, i);
+			launch_patch(r_grid_in, i, false, [&](auto & ite)
+			{
+				CUDA_LAUNCH((redist_gpu_copy_ker<dims,Phi_n_temp,Phi_SDF_out>),ite,g_temp.get_loc_grid(i).toKernel(),
+				            r_grid_in.get_loc_grid(i).toKernel(),ite,shift);
+			});
+		}
+	}
+
+	/** @brief Go one forward Euler step on the whole grid.
+	 */
+	void go_one_euler_step()
+	{
+		get_upwind_gradient_gpu<Phi_n_temp, Phi_0_sign_temp, Phi_grad_temp>(g_temp, order_upwind_gradient, true);
+
+		phi_type h0 = g_temp.getSpacing()[0];
+		phi_type dt = time_step;
+		for_each_patch(g_temp, [&](auto & lg, auto & ite)
+		{
+			CUDA_LAUNCH((redist_gpu_euler_ker<dims,Phi_n_temp,Phi_grad_temp>),ite,lg.toKernel(),ite,dt,h0);
+		});
+	}
+
+	/** @brief Go one re-distancing time-step, forward Euler or TVD Runge-Kutta as
+	 * RedistancingSussman::go_one_redistancing_step().
+	 */
+	void go_one_redistancing_step()
+	{
+		const size_t order = redistOptions.order_timestepper;
+		if (order <= 1)
+		{
+			go_one_euler_step();
+			return;
+		}
+
+		static const phi_type a_rk2[] = {0.0, 1.0 / 2.0};
+		static const phi_type a_rk3[] = {0.0, 3.0 / 4.0, 1.0 / 3.0};
+		const phi_type * a = (order == 2) ? a_rk2 : a_rk3;
+		const size_t n_stages = (order == 2) ? 2 : 3;
+
+		for_each_patch(g_temp, [&](auto & lg, auto & ite)
+		{
+			grid_key_dx<dims,int> zero;
+			zero.zero();
+			CUDA_LAUNCH((redist_gpu_copy_ker<dims,Phi_n_temp,Phi_rk_temp>),ite,lg.toKernel(),lg.toKernel(),ite,zero);
+		});
+
+		go_one_euler_step();
+		for (size_t k = 1; k < n_stages; k++)
+		{
+			go_one_euler_step();
+			phi_type a_k = a[k];
+			for_each_patch(g_temp, [&](auto & lg, auto & ite)
+			{
+				CUDA_LAUNCH((redist_gpu_rk_ker<dims,Phi_n_temp,Phi_rk_temp>),ite,lg.toKernel(),ite,a_k);
+			});
+		}
+	}
+
+	/** @brief Re-computes distFromSol on the device, as RedistancingSussman::update_distFromSol().
+	 */
+	void update_distFromSol()
+	{
+		red.template get<0>(0) = 0;
+		red.template get<1>(0) = 0;
+		red.template get<2>(0) = 0;
+		red.template hostToDevice<0,1,2>();
+
+		phi_type h0 = g_temp.getSpacing()[0];
+		phi_type dt = time_step;
+		phi_type k = kappa;
+		for_each_patch(g_temp, [&](auto & lg, auto & ite)
+		{
+			CUDA_LAUNCH((redist_gpu_dist_from_sol_ker<dims,Phi_n_temp,Phi_grad_temp>),ite,lg.toKernel(),ite,
+			            red.toKernel(),dt,h0,k);
+		});
+		red.template deviceToHost<0,1,2>();
+
+		phi_type max_change = red.template get<0>(0);
+		phi_type max_residual = red.template get<1>(0);
+		int count = red.template get<2>(0);
+
+		auto &v_cl = create_vcluster();
+		v_cl.max(max_change);
+		v_cl.max(max_residual);
+		v_cl.sum(count);
+		v_cl.execute();
+
+		distFromSol.change   = max_change;
+		distFromSol.residual = max_residual;
+		distFromSol.count    = count;
+	}
+
+	/** @brief Prints out the iteration number, max. change, max. residual and number of points in the narrow band.
+	 */
+	void print_out_iteration_change_residual(size_t iter)
+	{
+		auto &v_cl = create_vcluster();
+		if (v_cl.rank() == 0)
+		{
+			if (iter == 0)
+			{
+				std::cout << "Iteration,MaxChange,MaxResidual,NumberOfNarrowBandPoints" << std::endl;
+			}
+			std::cout << iter
+			<< "," << to_string_with_precision(distFromSol.change, 15)
+			<< "," << to_string_with_precision(distFromSol.residual, 15)
+			<< "," << distFromSol.count << std::endl;
+		}
+	}
+
+	/** @brief Checks the user-defined convergence criteria, as RedistancingSussman::criterion_met().
+	 */
+	bool criterion_met()
+	{
+		bool steady_state = false;
+		const int count = distFromSol.count;
+		if (redistOptions.convTolChange.check && redistOptions.convTolResidual.check)
+		{
+			steady_state = (distFromSol.change <= redistOptions.convTolChange.value &&
+			                distFromSol.residual <= redistOptions.convTolResidual.value && count > 0);
+		}
+		else
+		{
+			if (redistOptions.convTolChange.check)
+			{
+				steady_state = (distFromSol.change <= redistOptions.convTolChange.value && count > 0);
+			}
+			if (redistOptions.convTolResidual.check)
+			{
+				steady_state = (distFromSol.residual <= redistOptions.convTolResidual.value && count > 0);
+			}
+		}
+		return steady_state;
+	}
+
+	/** @brief Runs Sussman re-distancing on the temporary grid, as RedistancingSussman::iterative_redistancing().
+	 */
+	void iterative_redistancing()
+	{
+		int i = 0;
+		while (i < redistOptions.max_iter)
+		{
+			for (int j = 0; j < redistOptions.interval_check_convergence; j++)
+			{
+				go_one_redistancing_step();
+				++i;
+			}
+
+			// as on the CPU, the gradient is the one of the last step
+			const bool check = (i >= redistOptions.min_iter);
+			if (check || redistOptions.print_current_iterChangeResidual)	{update_distFromSol();}
+			if (redistOptions.print_current_iterChangeResidual)
+			{
+				print_out_iteration_change_residual(i);
+			}
+			if (check && criterion_met())
+			{
+				if (redistOptions.print_steadyState_iter)
+				{
+					auto &v_cl = create_vcluster();
+					if (v_cl.rank() == 0)
+					{
+						std::cout << "Steady state criterion reached at iteration: " << i << std::endl;
+						std::cout << "FinalIteration,MaxChange,MaxResidual" << std::endl;
+					}
+					print_out_iteration_change_residual(i);
+				}
+				break;
+			}
+		}
+		update_distFromSol();
+		final_iter = i;
+	}
+};
+
+#endif
+
+#endif //REDISTANCING_SUSSMAN_REDISTANCINGSUSSMANGPU_CUH
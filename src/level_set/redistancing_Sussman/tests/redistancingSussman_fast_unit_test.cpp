@@ -245,6 +245,238 @@ BOOST_AUTO_TEST_SUITE(RedistancingSussmanFastTestSuite)
 		BOOST_CHECK(lNorms_vd.l2   < 0.0417405);
 		BOOST_CHECK(lNorms_vd.linf < 0.0639717);
 	}
+
+	BOOST_AUTO_TEST_CASE(RedistancingSussman_unit_sphere_fast_narrow_band_iterations_test)
+	{
+		typedef double phi_type;
+		typedef double space_type;
+		const size_t grid_dim = 3;
+		// some indices
+		const size_t x                      = 0;
+		const size_t y                      = 1;
+		const size_t z                      = 2;
+		
+		const size_t Phi_0_grid             = 0;
+		const size_t SDF_sussman_grid       = 1;
+		const size_t SDF_exact_grid         = 2;
+		const size_t Error_grid             = 3;
+		
+		size_t N = 32;
+		const size_t sz[grid_dim] = {N, N, N};
+		const space_type radius = 1.0;
+		const space_type box_lower = -2.0;
+		const space_type box_upper = 2.0;
+		Box<grid_dim, space_type> box({box_lower, box_lower, box_lower}, {box_upper, box_upper, box_upper});
+		Ghost<grid_dim, long int> ghost(0);
+		typedef aggregate<phi_type, phi_type, phi_type, phi_type> props;
+		typedef grid_dist_id<grid_dim, space_type, props > grid_in_type;
+		grid_in_type g_dist(sz, box, ghost);
+		g_dist.setPropNames({"Phi_0", "SDF_sussman", "SDF_exact", "Relative error"});
+		
+		const space_type center[grid_dim] = {(box_upper+box_lower)/(space_type)2,
+		                                     (box_upper+box_lower)/(space_type)2,
+		                                     (box_upper+box_lower)/(space_type)2};
+		
+		init_grid_with_sphere<Phi_0_grid>(g_dist, radius, center[x], center[y], center[z]); // Initialize sphere onto grid
+		
+		Redist_options<phi_type> redist_options;
+		redist_options.min_iter                             = 1e3;
+		redist_options.max_iter                             = 1e3;
+		
+		redist_options.convTolChange.check                  = false;
+		redist_options.convTolResidual.check                = false;
+		
+		redist_options.interval_check_convergence           = 1e2;
+		redist_options.width_NB_in_grid_points              = 4;
+		redist_options.print_current_iterChangeResidual     = false;
+		redist_options.print_steadyState_iter               = true;
+		// Iterate only on a band of 16 grid points around the interface
+		redist_options.narrow_band_iterations               = true;
+		redist_options.width_active_band_in_grid_points     = 16;
+		
+		RedistancingSussman<grid_in_type, phi_type> redist_obj(g_dist, redist_options);
+		redist_obj.run_redistancing<Phi_0_grid, SDF_sussman_grid>();
+		
+		BOOST_CHECK(redist_obj.get_numberActiveBandPoints() > 0);
+		BOOST_CHECK(redist_obj.get_numberActiveBandPoints() < N * N * N);
+		
+		// Compute exact signed distance function at each grid point
+		init_analytic_sdf_sphere<SDF_exact_grid>(g_dist, radius, center[x], center[y], center[z]);
+		
+		// Compute the absolute error between analytical and numerical solution at each grid point
+		get_absolute_error<SDF_sussman_grid, SDF_exact_grid, Error_grid>(g_dist);
+		
+		size_t bc[grid_dim] = {NON_PERIODIC, NON_PERIODIC, NON_PERIODIC};
+		typedef aggregate<phi_type> props_nb;
+		typedef vector_dist<grid_dim, space_type, props_nb> vd_type;
+		Ghost<grid_dim, space_type> ghost_vd(0);
+		vd_type vd_narrow_band(0, box, bc, ghost_vd);
+		vd_narrow_band.setPropNames({"error"});
+		NarrowBand<grid_in_type, phi_type> narrowBand(g_dist, redist_options.width_NB_in_grid_points);
+		const size_t Error_vd = 0;
+		narrowBand.get_narrow_band_copy_specific_property<SDF_sussman_grid, Error_grid, Error_vd>(g_dist,
+		                                                                                          vd_narrow_band);
+		// Compute the L_2- and L_infinity-norm, same bounds of the whole grid iterations
+		LNorms<phi_type> lNorms_vd;
+		lNorms_vd.get_l_norms_vector<Error_vd>(vd_narrow_band);
+		std::cout << lNorms_vd.l2 << ", " << lNorms_vd.linf << std::endl;
+		
+		BOOST_CHECK(lNorms_vd.l2   < 0.044693);
+		BOOST_CHECK(lNorms_vd.linf < 0.066995);
+	}
+	BOOST_AUTO_TEST_CASE(RedistancingSussman_unit_sphere_fast_local_convergence_test)
+	{
+		typedef double phi_type;
+		typedef double space_type;
+		const size_t grid_dim = 3;
+		// some indices
+		const size_t x                      = 0;
+		const size_t y                      = 1;
+		const size_t z                      = 2;
+		
+		const size_t Phi_0_grid             = 0;
+		const size_t SDF_sussman_grid       = 1;
+		const size_t SDF_exact_grid         = 2;
+		const size_t Error_grid             = 3;
+		
+		size_t N = 32;
+		const size_t sz[grid_dim] = {N, N, N};
+		const space_type radius = 1.0;
+		const space_type box_lower = -2.0;
+		const space_type box_upper = 2.0;
+		Box<grid_dim, space_type> box({box_lower, box_lower, box_lower}, {box_upper, box_upper, box_upper});
+		Ghost<grid_dim, long int> ghost(0);
+		typedef aggregate<phi_type, phi_type, phi_type, phi_type> props;
+		typedef grid_dist_id<grid_dim, space_type, props > grid_in_type;
+		grid_in_type g_dist(sz, box, ghost);
+		g_dist.setPropNames({"Phi_0", "SDF_sussman", "SDF_exact", "Relative error"});
+		
+		const space_type center[grid_dim] = {(box_upper+box_lower)/(space_type)2,
+		                                     (box_upper+box_lower)/(space_type)2,
+		                                     (box_upper+box_lower)/(space_type)2};
+		
+		init_grid_with_sphere<Phi_0_grid>(g_dist, radius, center[x], center[y], center[z]); // Initialize sphere onto grid
+		
+		Redist_options<phi_type> redist_options;
+		redist_options.min_iter                             = 1e3;
+		redist_options.max_iter                             = 1e3;
+		
+		redist_options.convTolChange.check                  = false;
+		redist_options.convTolResidual.check                = false;
+		
+		redist_options.interval_check_convergence           = 1e3;
+		redist_options.width_NB_in_grid_points              = 4;
+		redist_options.print_current_iterChangeResidual     = false;
+		redist_options.print_steadyState_iter               = true;
+		// Check the convergence per local grid, without criteria the patches of the interface never stop
+		redist_options.local_convergence                    = true;
+		
+		RedistancingSussman<grid_in_type, phi_type> redist_obj(g_dist, redist_options);
+		redist_obj.run_redistancing<Phi_0_grid, SDF_sussman_grid>();
+		
+		BOOST_CHECK(redist_obj.get_numberActivePatches() > 0);
+		
+		// Compute exact signed distance function at each grid point
+		init_analytic_sdf_sphere<SDF_exact_grid>(g_dist, radius, center[x], center[y], center[z]);
+		
+		// Compute the absolute error between analytical and numerical solution at each grid point
+		get_absolute_error<SDF_sussman_grid, SDF_exact_grid, Error_grid>(g_dist);
+		
+		size_t bc[grid_dim] = {NON_PERIODIC, NON_PERIODIC, NON_PERIODIC};
+		typedef aggregate<phi_type> props_nb;
+		typedef vector_dist<grid_dim, space_type, props_nb> vd_type;
+		Ghost<grid_dim, space_type> ghost_vd(0);
+		vd_type vd_narrow_band(0, box, bc, ghost_vd);
+		vd_narrow_band.setPropNames({"error"});
+		NarrowBand<grid_in_type, phi_type> narrowBand(g_dist, redist_options.width_NB_in_grid_points);
+		const size_t Error_vd = 0;
+		narrowBand.get_narrow_band_copy_specific_property<SDF_sussman_grid, Error_grid, Error_vd>(g_dist,
+		                                                                                          vd_narrow_band);
+		// Compute the L_2- and L_infinity-norm, same bounds of the whole grid iterations
+		LNorms<phi_type> lNorms_vd;
+		lNorms_vd.get_l_norms_vector<Error_vd>(vd_narrow_band);
+		std::cout << lNorms_vd.l2 << ", " << lNorms_vd.linf << std::endl;
+		
+		BOOST_CHECK(lNorms_vd.l2   < 0.044693);
+		BOOST_CHECK(lNorms_vd.linf < 0.066995);
+	}
+	BOOST_AUTO_TEST_CASE(RedistancingSussman_unit_sphere_fast_tvd_rk3_test)
+	{
+		typedef double phi_type;
+		typedef double space_type;
+		const size_t grid_dim = 3;
+		// some indices
+		const size_t x                      = 0;
+		const size_t y                      = 1;
+		const size_t z                      = 2;
+		
+		const size_t Phi_0_grid             = 0;
+		const size_t SDF_sussman_grid       = 1;
+		const size_t SDF_exact_grid         = 2;
+		const size_t Error_grid             = 3;
+		
+		size_t N = 32;
+		const size_t sz[grid_dim] = {N, N, N};
+		const space_type radius = 1.0;
+		const space_type box_lower = -2.0;
+		const space_type box_upper = 2.0;
+		Box<grid_dim, space_type> box({box_lower, box_lower, box_lower}, {box_upper, box_upper, box_upper});
+		Ghost<grid_dim, long int> ghost(0);
+		typedef aggregate<phi_type, phi_type, phi_type, phi_type> props;
+		typedef grid_dist_id<grid_dim, space_type, props > grid_in_type;
+		grid_in_type g_dist(sz, box, ghost);
+		g_dist.setPropNames({"Phi_0", "SDF_sussman", "SDF_exact", "Relative error"});
+		
+		const space_type center[grid_dim] = {(box_upper+box_lower)/(space_type)2,
+		                                     (box_upper+box_lower)/(space_type)2,
+		                                     (box_upper+box_lower)/(space_type)2};
+		
+		init_grid_with_sphere<Phi_0_grid>(g_dist, radius, center[x], center[y], center[z]); // Initialize sphere onto grid
+		
+		// TVD-RK3 with a 5 times larger time step: the same pseudo-time as the forward Euler test with 1/5 of the
+		// iterations
+		Redist_options<phi_type> redist_options;
+		redist_options.min_iter                             = 2e2;
+		redist_options.max_iter                             = 2e2;
+		redist_options.order_timestepper                    = 3;
+		redist_options.courant_number                       = 0.5;
+		
+		redist_options.convTolChange.check                  = false;
+		redist_options.convTolResidual.check                = false;
+		
+		redist_options.interval_check_convergence           = 1e2;
+		redist_options.width_NB_in_grid_points              = 4;
+		redist_options.print_current_iterChangeResidual     = false;
+		redist_options.print_steadyState_iter               = true;
+		
+		RedistancingSussman<grid_in_type, phi_type> redist_obj(g_dist, redist_options);
+		BOOST_CHECK_CLOSE(redist_obj.get_time_step(), 0.5 / (3.0 / (4.0 / N)), 1e-10);
+		redist_obj.run_redistancing<Phi_0_grid, SDF_sussman_grid>();
+		
+		// Compute exact signed distance function at each grid point
+		init_analytic_sdf_sphere<SDF_exact_grid>(g_dist, radius, center[x], center[y], center[z]);
+		
+		// Compute the absolute error between analytical and numerical solution at each grid point
+		get_absolute_error<SDF_sussman_grid, SDF_exact_grid, Error_grid>(g_dist);
+		
+		size_t bc[grid_dim] = {NON_PERIODIC, NON_PERIODIC, NON_PERIODIC};
+		typedef aggregate<phi_type> props_nb;
+		typedef vector_dist<grid_dim, space_type, props_nb> vd_type;
+		Ghost<grid_dim, space_type> ghost_vd(0);
+		vd_type vd_narrow_band(0, box, bc, ghost_vd);
+		vd_narrow_band.setPropNames({"error"});
+		NarrowBand<grid_in_type, phi_type> narrowBand(g_dist, redist_options.width_NB_in_grid_points);
+		const size_t Error_vd = 0;
+		narrowBand.get_narrow_band_copy_specific_property<SDF_sussman_grid, Error_grid, Error_vd>(g_dist,
+		                                                                                          vd_narrow_band);
+		// Compute the L_2- and L_infinity-norm, same bounds of the forward Euler iterations
+		LNorms<phi_type> lNorms_vd;
+		lNorms_vd.get_l_norms_vector<Error_vd>(vd_narrow_band);
+		std::cout << lNorms_vd.l2 << ", " << lNorms_vd.linf << std::endl;
+		
+		BOOST_CHECK(lNorms_vd.l2   < 0.044693);
+		BOOST_CHECK(lNorms_vd.linf < 0.066995);
+	}
 BOOST_AUTO_TEST_SUITE_END()
 
 
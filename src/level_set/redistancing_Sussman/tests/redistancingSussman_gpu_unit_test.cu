@@ -0,0 +1,109 @@
+//
+// Tests of the GPU Sussman redistancing
+//
+#define BOOST_TEST_DYN_LINK
+#include <boost/test/unit_test.hpp>
+
+// Include redistancing files
+#include "level_set/redistancing_Sussman/RedistancingSussmanGPU.cuh"
+// Include header files for testing
+#include "Draw/DrawSphere.hpp"
+#include "l_norms/LNorms.hpp"
+#include "analytical_SDF/AnalyticalSDF.hpp"
+
+BOOST_AUTO_TEST_SUITE(RedistancingSussmanGpuTestSuite)
+
+	BOOST_AUTO_TEST_CASE(RedistancingSussman_unit_sphere_gpu_test)
+	{
+		typedef double phi_type;
+		typedef double space_type;
+		const size_t grid_dim = 3;
+		// some indices
+		const size_t x                      = 0;
+		const size_t y                      = 1;
+		const size_t z                      = 2;
+		
+		const size_t Phi_0_grid             = 0;
+		const size_t SDF_sussman_grid       = 1;
+		const size_t SDF_exact_grid         = 2;
+		const size_t Error_grid             = 3;
+		
+		size_t N = 32;
+		const size_t sz[grid_dim] = {N, N, N};
+		const space_type radius = 1.0;
+		const space_type box_lower = -2.0;
+		const space_type box_upper = 2.0;
+		Box<grid_dim, space_type> box({box_lower, box_lower, box_lower}, {box_upper, box_upper, box_upper});
+		Ghost<grid_dim, long int> ghost(0);
+		typedef aggregate<phi_type, phi_type, phi_type, phi_type> props;
+		typedef grid_dist_id<grid_dim, space_type, props, CartDecomposition<grid_dim, space_type, CudaMemory,
+		memory_traits_inte>, CudaMemory, grid_gpu<grid_dim, props>> grid_in_type;
+		grid_in_type g_dist(sz, box, ghost);
+		g_dist.setPropNames({"Phi_0", "SDF_sussman", "SDF_exact", "Relative error"});
+		
+		const space_type center[grid_dim] = {(box_upper+box_lower)/(space_type)2,
+		                                     (box_upper+box_lower)/(space_type)2,
+		                                     (box_upper+box_lower)/(space_type)2};
+		
+		init_grid_with_sphere<Phi_0_grid>(g_dist, radius, center[x], center[y], center[z]); // Initialize sphere onto grid
+		g_dist.template hostToDevice<Phi_0_grid>();
+		
+		// same options of RedistancingSussman_unit_sphere_fast_double_test
+		Redist_options<phi_type> redist_options;
+		redist_options.min_iter                             = 1e3;
+		redist_options.max_iter                             = 1e3;
+		
+		redist_options.convTolChange.check                  = false;
+		redist_options.convTolResidual.check                = false;
+		
+		redist_options.interval_check_convergence           = 1e3;
+		redist_options.width_NB_in_grid_points              = 4;
+		redist_options.print_current_iterChangeResidual     = true;
+		redist_options.print_steadyState_iter               = true;
+		
+		RedistancingSussmanGPU<grid_in_type, phi_type> redist_obj(g_dist, redist_options);
+		redist_obj.run_redistancing<Phi_0_grid, SDF_sussman_grid>();
+		g_dist.template deviceToHost<SDF_sussman_grid>();
+		
+		BOOST_CHECK(redist_obj.get_finalIteration() == 1000);
+		BOOST_CHECK(redist_obj.get_finalNumberNbPoints() > 0);
+		
+		// Compute exact signed distance function at each grid point
+		init_analytic_sdf_sphere<SDF_exact_grid>(g_dist, radius, center[x], center[y], center[z]);
+		
+		// Compute the absolute error between analytical and numerical solution at each grid point
+		get_absolute_error<SDF_sussman_grid, SDF_exact_grid, Error_grid>(g_dist);
+		
+		// L_2- and L_infinity-norm of the error in the narrow band (the NarrowBand class builds its temporary grid on
+		// the host decomposition)
+		const phi_type half_width = redist_options.width_NB_in_grid_points / 2 * g_dist.spacing(0);
+		phi_type l2 = 0, linf = 0;
+		size_t count = 0;
+		auto dom = g_dist.getDomainIterator();
+		while (dom.isNext())
+		{
+			auto key = dom.get();
+			if (fabs(g_dist.getProp<SDF_exact_grid>(key)) <= half_width)
+			{
+				phi_type e = g_dist.getProp<Error_grid>(key);
+				l2 += e * e;
+				linf = std::max(linf, e);
+				count++;
+			}
+			++dom;
+		}
+		auto &v_cl = create_vcluster();
+		v_cl.sum(l2);
+		v_cl.sum(count);
+		v_cl.max(linf);
+		v_cl.execute();
+		
+		LNorms<phi_type> lNorms_vd;
+		lNorms_vd.l2 = sqrt(l2 / count);
+		lNorms_vd.linf = linf;
+		std::cout << lNorms_vd.l2 << ", " << lNorms_vd.linf << std::endl;
+		
+		BOOST_CHECK(lNorms_vd.l2   < 0.044693);
+		BOOST_CHECK(lNorms_vd.linf < 0.066995);
+	}
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,360 @@
+//
+// Fast sweeping redistancing on grid_dist_id
+//
+/**
+ * @file RedistancingFastSweeping.hpp
+ * @class RedistancingFastSweeping
+ *
+ * @brief Class for reinitializing a level-set function into a signed distance function using the fast sweeping method.
+ *
+ * @details The eikonal equation @f[ |\nabla\phi| = 1 @f] is solved with the first order upwind discretization and
+ * Gauss-Seidel sweeps in the 2^dim alternating orderings of the grid (see: H. Zhao, "A fast sweeping method for
+ * eikonal equations", Math. Comp. 74 (2005)). Compared to #RedistancingSussman, no pseudo-time step is needed and
+ * the number of sweeps does not depend on the grid size for a single processor: the cost goes from
+ * O(N iterations) to O(N).
+ *
+ * The nodes next to the zero level set of Phi_0 are initialized with the distance to the interface found by linear
+ * interpolation of Phi_0 along the grid axes, and they are not changed by the sweeps. Every processor sweeps its
+ * local grids independently, a round of 2^dim sweeps is followed by a ghost exchange, and the rounds continue until
+ * the maximum change over all processors is smaller than the tolerance.
+ */
+
+#ifndef REDISTANCING_FAST_SWEEPING_REDISTANCINGFASTSWEEPING_HPP
+#define REDISTANCING_FAST_SWEEPING_REDISTANCINGFASTSWEEPING_HPP
+
+// Include standard library header files
+#include <iostream>
+#include <limits>
+#include <algorithm>
+#include <cmath>
+// Include OpenFPM header files
+#include "Grid/grid_dist_id.hpp"
+#include "data_type/aggregate.hpp"
+#include "Decomposition/CartDecomposition.hpp"
+
+// Include other header files
+#include "level_set/redistancing_Sussman/HelpFunctions.hpp"
+#include "level_set/redistancing_Sussman/HelpFunctionsForGrid.hpp"
+
+/** @brief Structure to bundle options for the fast sweeping redistancing.
+ * @struct Redist_options_fast_sweeping
+ *
+ * @param max_iter: Maximum number of rounds of 2^dim sweeps (Default: 100).
+ * @param tolerance: The sweeps stop when the maximum change of Phi over one round is below this value (Default: 0,
+ *                   that is until the solution does not change any more).
+ * @param print_steadyState_iter: If true, the number of rounds and the final change are printed (Default: false).
+ */
+template <typename phi_type=double>
+struct Redist_options_fast_sweeping
+{
+	size_t max_iter = 100;
+	phi_type tolerance = 0;
+	bool print_steadyState_iter = false;
+};
+
+/**@brief Class for reinitializing a level-set function into a signed distance function using fast sweeping.
+ * @file RedistancingFastSweeping.hpp
+ * @class RedistancingFastSweeping
+ * @tparam grid_in_type Template type of input grid, which stores the initial level-set function Phi_0.
+ */
+template <typename grid_in_type, typename phi_type=double>
+class RedistancingFastSweeping
+{
+public:
+	/** @brief Constructor initializing the options, the temporary internal grid and reference variable to the input
+	 * grid.
+	 *
+	 * @param grid_in Input grid with min. 2 properties: 1.) Phi_0, 2.) Phi_SDF <- will be overwritten with
+	 * re-distancing result
+	 * @param redistOptions User defined options for the fast sweeping
+	 *
+	 */
+	RedistancingFastSweeping(grid_in_type &grid_in, Redist_options_fast_sweeping<phi_type> &redistOptions)
+	: redistOptions(redistOptions),
+	  r_grid_in(grid_in),
+	  g_temp(grid_in.getDecomposition(),
+	         grid_in.getGridInfoVoid().getSize(),
+	         Ghost<grid_in_type::dims, long int>(1))
+	{}
+
+	/**@brief Aggregated properties for the temporary grid.
+	 *
+	 * @details Phi_0, distance from the interface, 1 if the node is next to the interface (fixed).
+	 */
+	typedef aggregate<phi_type, phi_type, int> props_temp;
+	/** @brief Type definition for the temporary grid.
+	 */
+	typedef grid_dist_id<grid_in_type::dims, typename grid_in_type::stype, props_temp> g_temp_type;
+	/** @brief Temporary grid, which is only used inside the class for the redistancing.
+	 */
+	g_temp_type g_temp;
+
+	/**@brief Runs the fast sweeping redistancing.
+	 *
+	 * @details Copies Phi_0 from input grid to the internal temporary grid, initializes the distance at the
+	 * interface, sweeps until convergence and copies the signed distance to the Phi_SDF_out property of the input
+	 * grid. Nodes that could not be reached (no interface in the domain) keep Phi_0.
+	 */
+	template <size_t Phi_0_in, size_t Phi_SDF_out>
+	void run_redistancing()
+	{
+		copy_gridTogrid<Phi_0_in, Phi_0_temp>(r_grid_in, g_temp);
+		init_interface(g_temp);
+		iterative_sweeping(g_temp);
+
+		// Signed distance
+		auto dom = g_temp.getDomainIterator();
+		while (dom.isNext())
+		{
+			auto key = dom.get();
+			const phi_type phi_0 = g_temp.template get<Phi_0_temp>(key);
+			phi_type & dist = g_temp.template get<Dist_temp>(key);
+			if (dist < far) dist = (phi_0 < 0) ? -dist : dist;
+			else dist = phi_0;
+			++dom;
+		}
+		copy_gridTogrid<Dist_temp, Phi_SDF_out>(g_temp, r_grid_in);
+	}
+
+	/** @brief Number of rounds of 2^dim sweeps done by the last redistancing.
+	 */
+	int get_finalIteration()
+	{
+		return final_iter;
+	}
+
+	/** @brief Maximum change of the distance in the last round of sweeps.
+	 */
+	phi_type get_finalChange()
+	{
+		return final_change;
+	}
+
+private:
+	//	Some indices for better readability
+	static constexpr size_t Phi_0_temp = 0; ///< Property index of Phi_0 on the temporary grid.
+	static constexpr size_t Dist_temp  = 1; ///< Property index of the unsigned distance on the temporary grid.
+	static constexpr size_t Fixed_temp = 2; ///< Property index of the interface flag on the temporary grid.
+
+	/// Distance of the nodes not yet reached by the sweeps.
+	static constexpr phi_type far = std::numeric_limits<phi_type>::max() / 4;
+
+	//	Member variables
+	Redist_options_fast_sweeping<phi_type> redistOptions; ///< Instantiate redistancing options.
+	grid_in_type &r_grid_in; ///< Define reference to input grid.
+
+	int final_iter = 0; ///< Rounds of sweeps of the last redistancing.
+	phi_type final_change = 0; ///< Maximum change of the last round of sweeps.
+
+	/** @brief Checks if the neighbor of a node in direction d exists (inside the domain or periodic).
+	 *
+	 * @param grid Internal temporary grid.
+	 * @param key_g Global key of the node.
+	 * @param d Direction.
+	 * @param s Side, -1 or +1.
+	 * @return True if the neighbor can be used by the stencil.
+	 */
+	template <typename key_g_type>
+	bool has_neighbor(g_temp_type &grid, const key_g_type & key_g, size_t d, int s)
+	{
+		if (grid.getDecomposition().periodicity(d) == PERIODIC) return true;
+		return (s < 0) ? (key_g.get(d) > 0) : (key_g.get(d) < (long int)grid.size(d) - 1);
+	}
+
+	/** @brief Initializes the distance of the nodes next to the interface.
+	 *
+	 * @details For every direction with a sign change of Phi_0 towards a neighbor, the distance to the crossing is
+	 * found by linear interpolation. The distances per direction are combined as
+	 * @f[ d = \left( \sum_d d_d^{-2} \right)^{-1/2} @f] that is the distance to the plane through the crossings.
+	 *
+	 * @param grid Internal temporary grid.
+	 */
+	void init_interface(g_temp_type &grid)
+	{
+		grid.template ghost_get<Phi_0_temp>();
+		auto dom = grid.getDomainIterator();
+		while (dom.isNext())
+		{
+			auto key = dom.get();
+			auto key_g = grid.getGKey(key);
+			const phi_type phi_c = grid.template get<Phi_0_temp>(key);
+
+			phi_type inv_d2 = 0;
+			bool on_interface = (phi_c == 0);
+			for (size_t d = 0; d < grid_in_type::dims; d++)
+			{
+				const phi_type h = grid.getSpacing()[d];
+				phi_type d_min = far;
+				for (int s = -1; s <= 1; s += 2)
+				{
+					if (has_neighbor(grid, key_g, d, s) == false) continue;
+					const phi_type phi_n = grid.template get<Phi_0_temp>(key.move(d, s));
+					if ((phi_c < 0) != (phi_n < 0))
+					{
+						d_min = std::min(d_min, h * phi_c / (phi_c - phi_n));
+					}
+				}
+				if (d_min < far)
+				{
+					on_interface = true;
+					if (d_min == 0) inv_d2 = far;
+					else inv_d2 += 1 / (d_min * d_min);
+				}
+			}
+
+			grid.template get<Fixed_temp>(key) = on_interface;
+			if (phi_c == 0) grid.template get<Dist_temp>(key) = 0;
+			else if (on_interface) grid.template get<Dist_temp>(key) = (inv_d2 >= far) ? 0 : 1 / sqrt(inv_d2);
+			else grid.template get<Dist_temp>(key) = far;
+			++dom;
+		}
+	}
+
+	/** @brief Solves the upwind discretization of the eikonal equation on one node.
+	 *
+	 * @details With a_d the smallest neighbor distance in direction d, sorted increasingly, the solution is the
+	 * largest root of @f[ \sum_{d=1}^{k} \left( \frac{u - a_d}{h_d} \right)^2 = 1 @f] with the smallest k such that
+	 * u <= a_{k+1}.
+	 *
+	 * @param a Smallest neighbor distance in every direction.
+	 * @param h Grid spacing in every direction.
+	 * @return Distance of the node.
+	 */
+	phi_type local_solve(phi_type (& a)[grid_in_type::dims], phi_type (& h)[grid_in_type::dims])
+	{
+		const size_t dims = grid_in_type::dims;
+		size_t idx[dims];
+		for (size_t d = 0; d < dims; d++) idx[d] = d;
+		std::sort(idx, idx + dims, [&](size_t i, size_t j) {return a[i] < a[j];});
+
+		if (a[idx[0]] >= far) return far;
+
+		phi_type u = a[idx[0]] + h[idx[0]];
+		phi_type A = 0, B = 0, C = 0;
+		for (size_t k = 0; k < dims; k++)
+		{
+			const phi_type ak = a[idx[k]];
+			if (ak >= far || u <= ak) break;
+			const phi_type w = 1 / (h[idx[k]] * h[idx[k]]);
+			A += w;
+			B += ak * w;
+			C += ak * ak * w;
+			const phi_type disc = B * B - A * (C - 1);
+			if (disc < 0) break;
+			u = (B + sqrt(disc)) / A;
+		}
+		return u;
+	}
+
+	/** @brief One Gauss-Seidel sweep over the domain of every local grid in the given ordering.
+	 *
+	 * @param grid Internal temporary grid.
+	 * @param dir Bit d set if the direction d is swept backward.
+	 * @return Maximum change of the distance (far if a node has been reached for the first time).
+	 */
+	phi_type sweep(g_temp_type &grid, size_t dir)
+	{
+		const size_t dims = grid_in_type::dims;
+		phi_type max_change = 0;
+		phi_type h[dims];
+		for (size_t d = 0; d < dims; d++) h[d] = grid.getSpacing()[d];
+
+		auto & patches = grid.getLocalGridsInfo();
+		for (size_t i = 0; i < patches.size(); i++)
+		{
+			auto & Dbox = patches.get(i).Dbox;
+
+			long int first[dims], last[dims], step[dims];
+			bool empty = false;
+			for (size_t d = 0; d < dims; d++)
+			{
+				bool back = (dir >> d) & 1;
+				first[d] = back ? Dbox.getHigh(d) : Dbox.getLow(d);
+				last[d] = back ? Dbox.getLow(d) : Dbox.getHigh(d);
+				step[d] = back ? -1 : 1;
+				if (Dbox.getHigh(d) < Dbox.getLow(d)) empty = true;
+			}
+			if (empty) continue;
+
+			grid_key_dx<dims> k;
+			for (size_t d = 0; d < dims; d++) k.set_d(d, first[d]);
+
+			while (true)
+			{
+				grid_dist_key_dx<dims> key(i, k);
+				if (grid.template get<Fixed_temp>(key) == 0)
+				{
+					auto key_g = grid.getGKey(key);
+					phi_type a[dims];
+					for (size_t d = 0; d < dims; d++)
+					{
+						a[d] = far;
+						for (int s = -1; s <= 1; s += 2)
+						{
+							if (has_neighbor(grid, key_g, d, s) == false) continue;
+							a[d] = std::min(a[d], grid.template get<Dist_temp>(key.move(d, s)));
+						}
+					}
+
+					phi_type & u = grid.template get<Dist_temp>(key);
+					const phi_type u_new = local_solve(a, h);
+					if (u_new < u)
+					{
+						max_change = std::max(max_change, (u >= far) ? far : u - u_new);
+						u = u_new;
+					}
+				}
+
+				// next node, direction 0 inner
+				size_t d = 0;
+				for ( ; d < dims; d++)
+				{
+					if (k.get(d) != last[d])
+					{
+						k.set_d(d, k.get(d) + step[d]);
+						break;
+					}
+					k.set_d(d, first[d]);
+				}
+				if (d == dims) break;
+			}
+		}
+		return max_change;
+	}
+
+	/** @brief Rounds of 2^dim sweeps followed by a ghost exchange, until convergence or redistOptions.max_iter.
+	 *
+	 * @param grid Internal temporary grid.
+	 */
+	void iterative_sweeping(g_temp_type &grid)
+	{
+		auto &v_cl = create_vcluster();
+		const size_t n_dir = 1 << grid_in_type::dims;
+
+		size_t iter = 0;
+		phi_type max_change = far;
+		while (iter < redistOptions.max_iter)
+		{
+			grid.template ghost_get<Dist_temp>(KEEP_PROPERTIES);
+			max_change = 0;
+			for (size_t dir = 0; dir < n_dir; dir++)
+			{
+				max_change = std::max(max_change, sweep(grid, dir));
+			}
+			++iter;
+
+			v_cl.max(max_change);
+			v_cl.execute();
+			if (max_change <= redistOptions.tolerance) break;
+		}
+
+		final_iter = iter;
+		final_change = max_change;
+		if (redistOptions.print_steadyState_iter && v_cl.rank() == 0)
+		{
+			std::cout << "Fast sweeping finished after " << iter << " rounds, max change " << max_change << std::endl;
+		}
+	}
+};
+
+#endif //REDISTANCING_FAST_SWEEPING_REDISTANCINGFASTSWEEPING_HPP
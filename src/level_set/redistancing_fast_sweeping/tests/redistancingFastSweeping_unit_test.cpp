@@ -0,0 +1,84 @@
+//
+// Tests of the fast sweeping redistancing
+//
+#define BOOST_TEST_DYN_LINK
+#include <boost/test/unit_test.hpp>
+
+// Include redistancing files
+#include "level_set/redistancing_fast_sweeping/RedistancingFastSweeping.hpp"
+#include "level_set/redistancing_Sussman/NarrowBand.hpp"
+// Include header files for testing
+#include "Draw/DrawSphere.hpp"
+#include "level_set/redistancing_Sussman/tests/l_norms/LNorms.hpp"
+#include "level_set/redistancing_Sussman/tests/analytical_SDF/AnalyticalSDF.hpp"
+
+BOOST_AUTO_TEST_SUITE(RedistancingFastSweepingTestSuite)
+
+	BOOST_AUTO_TEST_CASE(RedistancingFastSweeping_unit_sphere_test)
+	{
+		typedef double phi_type;
+		typedef double space_type;
+		const size_t grid_dim = 3;
+		// some indices
+		const size_t x                      = 0;
+		const size_t y                      = 1;
+		const size_t z                      = 2;
+		
+		const size_t Phi_0_grid             = 0;
+		const size_t SDF_sweeping_grid      = 1;
+		const size_t SDF_exact_grid         = 2;
+		const size_t Error_grid             = 3;
+		
+		size_t N = 32;
+		const size_t sz[grid_dim] = {N, N, N};
+		const space_type radius = 1.0;
+		const space_type box_lower = -2.0;
+		const space_type box_upper = 2.0;
+		Box<grid_dim, space_type> box({box_lower, box_lower, box_lower}, {box_upper, box_upper, box_upper});
+		Ghost<grid_dim, long int> ghost(0);
+		typedef aggregate<phi_type, phi_type, phi_type, phi_type> props;
+		typedef grid_dist_id<grid_dim, space_type, props > grid_in_type;
+		grid_in_type g_dist(sz, box, ghost);
+		g_dist.setPropNames({"Phi_0", "SDF_sweeping", "SDF_exact", "Relative error"});
+		
+		const space_type center[grid_dim] = {(box_upper+box_lower)/(space_type)2,
+		                                     (box_upper+box_lower)/(space_type)2,
+		                                     (box_upper+box_lower)/(space_type)2};
+		
+		init_grid_with_sphere<Phi_0_grid>(g_dist, radius, center[x], center[y], center[z]); // Initialize sphere onto grid
+		
+		Redist_options_fast_sweeping<phi_type> redist_options;
+		redist_options.print_steadyState_iter = true;
+		
+		RedistancingFastSweeping<grid_in_type, phi_type> redist_obj(g_dist, redist_options);
+		redist_obj.run_redistancing<Phi_0_grid, SDF_sweeping_grid>();
+		
+		// The sweeps converge after few rounds, independently of the grid size
+		BOOST_CHECK(redist_obj.get_finalChange() == 0);
+		BOOST_CHECK(redist_obj.get_finalIteration() < 20);
+		
+		// Compute exact signed distance function at each grid point
+		init_analytic_sdf_sphere<SDF_exact_grid>(g_dist, radius, center[x], center[y], center[z]);
+		
+		// Compute the absolute error between analytical and numerical solution at each grid point
+		get_absolute_error<SDF_sweeping_grid, SDF_exact_grid, Error_grid>(g_dist);
+		
+		size_t bc[grid_dim] = {NON_PERIODIC, NON_PERIODIC, NON_PERIODIC};
+		typedef aggregate<phi_type> props_nb;
+		typedef vector_dist<grid_dim, space_type, props_nb> vd_type;
+		Ghost<grid_dim, space_type> ghost_vd(0);
+		vd_type vd_narrow_band(0, box, bc, ghost_vd);
+		vd_narrow_band.setPropNames({"error"});
+		NarrowBand<grid_in_type, phi_type> narrowBand(g_dist, 4);
+		const size_t Error_vd = 0;
+		narrowBand.get_narrow_band_copy_specific_property<SDF_sweeping_grid, Error_grid, Error_vd>(g_dist,
+		                                                                                           vd_narrow_band);
+		// Compute the L_2- and L_infinity-norm
+		LNorms<phi_type> lNorms_vd;
+		lNorms_vd.get_l_norms_vector<Error_vd>(vd_narrow_band);
+		std::cout << lNorms_vd.l2 << ", " << lNorms_vd.linf << std::endl;
+		
+		BOOST_CHECK(lNorms_vd.l2   < 0.023515);
+		BOOST_CHECK(lNorms_vd.linf < 0.053240);
+	}
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,344 @@
+//
+// Sussman redistancing on a sparse grid storing only a band around the interface
+//
+/**
+ * @file RedistancingSparseBand.hpp
+ * @class RedistancingSparseBand
+ *
+ * @brief Level-set tools for a sparse grid (sgrid_dist_id) that stores only the nodes within a band around the
+ * interface.
+ *
+ * @details Only the inserted nodes are stored and iterated, such that memory and work scale with the area of the
+ * interface instead of the volume of the domain. The header contains:
+ *
+ * - init_sparse_band(): inserts the nodes close to the zero level set of a function into a sparse grid,
+ * - copy_band_to_sparse_grid(): copies the band of a dense grid into a sparse grid,
+ * - RedistancingSparseBand: Sussman redistancing restricted to the nodes of the sparse grid,
+ * - get_narrow_band_sparse(): places particles on the band nodes with the SDF and its gradient.
+ *
+ * The derivatives are first order upwind (redistancing) or central (gradient of the SDF) differences, which fall back
+ * to the one-sided difference when a neighbor has not been inserted, as for the one-sided boundary conditions of
+ * #RedistancingSussman. The SDF only overload of NarrowBand::get_narrow_band() works on sparse grids without changes.
+ */
+
+#ifndef REDISTANCING_SPARSE_BAND_HPP
+#define REDISTANCING_SPARSE_BAND_HPP
+
+// Include standard library header files
+#include <iostream>
+#include <vector>
+#include <algorithm>
+#include <cmath>
+#include <type_traits>
+// Include OpenFPM header files
+#include "Grid/grid_dist_id.hpp"
+#include "data_type/aggregate.hpp"
+
+// Include other header files
+#include "level_set/redistancing_Sussman/HelpFunctions.hpp"
+#include "level_set/redistancing_Sussman/HelpFunctionsForGrid.hpp"
+#include "FiniteDifference/Upwind_gradient.hpp"
+
+/**@brief Inserts all the nodes of a sparse grid, at which the absolute value of a function is smaller than the band
+ * width, and stores the function value in the property \p Phi.
+ *
+ * @details The iteration goes over the whole grid without allocating it, only the band nodes are stored.
+ *
+ * @tparam Phi Index of the property that stores the level-set function.
+ * @tparam sgrid_type Inferred type of the sparse grid.
+ * @tparam function_type Inferred type of the function, called with a Point<dims, stype> and returning Phi.
+ * @param grid Sparse grid with ghost >= 1.
+ * @param f Level-set function (for example an analytical SDF).
+ * @param width Half width of the band (physical units).
+ */
+template <size_t Phi, typename sgrid_type, typename function_type>
+void init_sparse_band(sgrid_type & grid, function_type f, typename sgrid_type::stype width)
+{
+	auto it = grid.getGridIterator();
+	while (it.isNext())
+	{
+		auto key = it.get_dist();
+		auto gkey = it.get();
+
+		Point<sgrid_type::dims, typename sgrid_type::stype> pos;
+		for (size_t d = 0; d < sgrid_type::dims; d++)
+		{
+			pos[d] = grid.getDomain().getLow(d) + gkey.get(d) * grid.spacing(d);
+		}
+
+		auto phi = f(pos);
+		if (std::abs(phi) < width)
+		{
+			grid.template insert<Phi>(key) = phi;
+		}
+		++it;
+	}
+	grid.template ghost_get<Phi>();
+}
+
+/**@brief Copies the nodes of a dense grid, at which the absolute value of \p Phi_dense is smaller than the band
+ * width, into a sparse grid.
+ *
+ * @details The two grids must be created on the same decomposition with the same size and ghost, such that the keys
+ * of the dense grid can be used on the sparse grid.
+ *
+ * @tparam Phi_dense Index of the property that stores the level-set function in the dense grid.
+ * @tparam Phi_sparse Index of the property that should store the level-set function in the sparse grid.
+ * @tparam grid_type Inferred type of the dense grid.
+ * @tparam sgrid_type Inferred type of the sparse grid.
+ * @param grid_dense Dense grid storing the level-set function.
+ * @param grid_sparse Sparse grid in which the band is inserted.
+ * @param width Half width of the band (physical units).
+ */
+template <size_t Phi_dense, size_t Phi_sparse, typename grid_type, typename sgrid_type>
+void copy_band_to_sparse_grid(grid_type & grid_dense, sgrid_type & grid_sparse, typename sgrid_type::stype width)
+{
+	auto dom = grid_dense.getDomainIterator();
+	while (dom.isNext())
+	{
+		auto key = dom.get();
+		if (std::abs(grid_dense.template get<Phi_dense>(key)) < width)
+		{
+			grid_sparse.template insert<Phi_sparse>(key) = grid_dense.template get<Phi_dense>(key);
+		}
+		++dom;
+	}
+	grid_sparse.template ghost_get<Phi_sparse>();
+}
+
+/**@brief Forward and backward difference of \p Phi at a node of a sparse grid along one dimension.
+ *
+ * @details If a neighbor has not been inserted, the difference on that side is replaced by the one on the other side.
+ * If none of the neighbors exists, both differences are 0.
+ *
+ * @tparam Phi Index of the property that stores the level-set function.
+ * @tparam sgrid_type Inferred type of the sparse grid.
+ * @tparam key_type Inferred type of the key.
+ * @tparam phi_type Inferred type of Phi.
+ * @param grid Sparse grid.
+ * @param key Key of the node.
+ * @param d Dimension.
+ * @param dplus Forward difference (output).
+ * @param dminus Backward difference (output).
+ */
+template <size_t Phi, typename sgrid_type, typename key_type, typename phi_type>
+void sparse_band_one_sided_differences(sgrid_type & grid, const key_type & key, size_t d, phi_type & dplus,
+		phi_type & dminus)
+{
+	const auto key_p = key.move(d, 1);
+	const auto key_m = key.move(d, -1);
+	const bool exist_p = grid.existPoint(key_p);
+	const bool exist_m = grid.existPoint(key_m);
+
+	const phi_type phi = grid.template get<Phi>(key);
+	dplus = (exist_p) ? (grid.template get<Phi>(key_p) - phi) / grid.spacing(d) : 0;
+	dminus = (exist_m) ? (phi - grid.template get<Phi>(key_m)) / grid.spacing(d) : 0;
+
+	if (!exist_p) dplus = dminus;
+	if (!exist_m) dminus = dplus;
+}
+
+/**@brief Places particles on the band nodes of a sparse grid within a narrow band around the interface. The SDF,
+ * its gradient and the gradient magnitude are copied to the particles.
+ *
+ * @details The gradient is approximated with central differences, one-sided at the border of the band.
+ *
+ * @tparam Phi_SDF_grid Index of property storing the signed distance function in the sparse grid.
+ * @tparam Phi_SDF_vd Index of property that should store the SDF in the narrow band particle vector.
+ * @tparam Phi_grad_vd Index of property that should store the gradient of phi in the narrow band particle vector.
+ * @tparam Phi_magnOfGrad_vd Index of property that should store the gradient magnitude of Phi.
+ * @tparam sgrid_type Inferred type of the sparse grid.
+ * @tparam vector_type Inferred type of the particle vector.
+ * @param grid Sparse grid storing the SDF (result of redistancing).
+ * @param vd Empty vector with same spatial scaling (box) as the grid.
+ * @param width Half width of the narrow band (physical units), can be smaller than the one of the sparse grid.
+ */
+template <size_t Phi_SDF_grid, size_t Phi_SDF_vd, size_t Phi_grad_vd, size_t Phi_magnOfGrad_vd, typename sgrid_type,
+		typename vector_type>
+void get_narrow_band_sparse(sgrid_type & grid, vector_type & vd, typename sgrid_type::stype width)
+{
+	typedef typename std::remove_const_t<std::remove_reference_t<decltype(
+	grid.template get<Phi_SDF_grid>(grid.getDomainIterator().get()))>> phi_type;
+
+	grid.template ghost_get<Phi_SDF_grid>();
+	auto dom = grid.getDomainIterator();
+	while (dom.isNext())
+	{
+		auto key = dom.get();
+		if (std::abs(grid.template get<Phi_SDF_grid>(key)) < width)
+		{
+			vd.add();
+			phi_type magnOfGrad = 0;
+			for (size_t d = 0; d < sgrid_type::dims; d++)
+			{
+				phi_type dplus, dminus;
+				sparse_band_one_sided_differences<Phi_SDF_grid>(grid, key, d, dplus, dminus);
+				vd.getLastPos()[d] = grid.getPos(key)[d];
+				vd.template getLastProp<Phi_grad_vd>()[d] = 0.5 * (dplus + dminus);
+				magnOfGrad += 0.25 * (dplus + dminus) * (dplus + dminus);
+			}
+			vd.template getLastProp<Phi_SDF_vd>() = grid.template get<Phi_SDF_grid>(key);
+			vd.template getLastProp<Phi_magnOfGrad_vd>() = sqrt(magnOfGrad);
+		}
+		++dom;
+	}
+	vd.map();
+}
+
+/** @brief Structure to bundle options for the redistancing on a sparse band.
+ * @struct Redist_options_sparse_band
+ *
+ * @param max_iter: Maximum number of iterations (Default: 1000).
+ * @param convTolChange: The iterations stop when the maximum change of Phi in one iteration is below this value
+ *                       (Default: 1e-5).
+ * @param print_steadyState_iter: If true, the number of iterations and the final change are printed (Default: false).
+ */
+template <typename phi_type=double>
+struct Redist_options_sparse_band
+{
+	size_t max_iter = 1000;
+	phi_type convTolChange = 1e-5;
+	bool print_steadyState_iter = false;
+};
+
+/**@brief Class for reinitializing a level-set function stored on the band nodes of a sparse grid into a signed
+ * distance function.
+ *
+ * @details Solves the Sussman redistancing equation with first order upwinding on the inserted nodes only. The
+ * upwind direction is given by the sign of Phi_0 as in #RedistancingSussman, and the derivatives are one-sided at the
+ * border of the band. Each iteration first computes the gradient magnitude on all the nodes and then updates them,
+ * followed by a ghost exchange, such that the result does not depend on the number of processors.
+ *
+ * @file RedistancingSparseBand.hpp
+ * @class RedistancingSparseBand
+ * @tparam sgrid_type Template type of the sparse input grid, with ghost >= 1.
+ */
+template <typename sgrid_type, typename phi_type=double>
+class RedistancingSparseBand
+{
+public:
+	/** @brief Constructor initializing the options and reference variable to the sparse input grid.
+	 *
+	 * @param grid_in Sparse grid with min. 2 properties: 1.) Phi_0, 2.) Phi_SDF <- will be overwritten with
+	 * re-distancing result
+	 * @param redistOptions User defined options for the redistancing
+	 */
+	RedistancingSparseBand(sgrid_type &grid_in, Redist_options_sparse_band<phi_type> &redistOptions)
+	: redistOptions(redistOptions),
+	  r_grid_in(grid_in)
+	{
+		// Get timestep fulfilling CFL condition for velocity=1.0 and courant number=0.1, as RedistancingSussman
+		time_step = get_time_step_CFL(grid_in, 1.0, 0.1);
+	}
+
+	/**@brief Runs the redistancing on the band nodes.
+	 *
+	 * @tparam Phi_0_in Index of the property that stores the initial level-set function (not modified).
+	 * @tparam Phi_SDF_out Index of the property that stores the resulting signed distance function.
+	 */
+	template <size_t Phi_0_in, size_t Phi_SDF_out>
+	void run_redistancing()
+	{
+		auto dom = r_grid_in.getDomainIterator();
+		while (dom.isNext())
+		{
+			auto key = dom.get();
+			r_grid_in.template get<Phi_SDF_out>(key) = r_grid_in.template get<Phi_0_in>(key);
+			++dom;
+		}
+		r_grid_in.template ghost_get<Phi_0_in, Phi_SDF_out>();
+
+		auto & v_cl = create_vcluster();
+		for (final_iter = 0; final_iter < redistOptions.max_iter; final_iter++)
+		{
+			final_change = go_one_redistancing_step<Phi_0_in, Phi_SDF_out>();
+			v_cl.max(final_change);
+			v_cl.execute();
+
+			if (final_change < redistOptions.convTolChange)
+			{
+				final_iter++;
+				break;
+			}
+		}
+
+		if (redistOptions.print_steadyState_iter && v_cl.rank() == 0)
+		{
+			std::cout << "Sparse band redistancing: iterations = " << final_iter << ", change = " << final_change
+			          << std::endl;
+		}
+	}
+
+	/**@brief Number of iterations done by the last run_redistancing().
+	 *
+	 * @return Number of iterations.
+	 */
+	size_t get_finalIteration()
+	{
+		return final_iter;
+	}
+
+	/**@brief Maximum change of Phi in the last iteration of run_redistancing().
+	 *
+	 * @return Maximum change over all processors.
+	 */
+	phi_type get_finalChange()
+	{
+		return final_change;
+	}
+
+private:
+	Redist_options_sparse_band<phi_type> redistOptions; ///< Instantiate redistancing options.
+	sgrid_type &r_grid_in; ///< Define reference to input grid.
+	typename sgrid_type::stype time_step; ///< Artificial timestep for the redistancing iterations.
+	size_t final_iter = 0; ///< Iterations done by the last run.
+	phi_type final_change = 0; ///< Maximum change in the last iteration.
+	std::vector<phi_type> magnOfGrad; ///< Upwind gradient magnitude at the nodes, in the order of the domain iterator.
+
+	/**@brief Goes one redistancing time-step on the band nodes.
+	 *
+	 * @tparam Phi_0_in Index of the property that stores the initial level-set function.
+	 * @tparam Phi_n Index of the property that stores the current solution.
+	 * @return Maximum change of Phi on this processor.
+	 */
+	template <size_t Phi_0_in, size_t Phi_n>
+	phi_type go_one_redistancing_step()
+	{
+		magnOfGrad.clear();
+		auto dom = r_grid_in.getDomainIterator();
+		while (dom.isNext())
+		{
+			auto key = dom.get();
+			const int sign = sgn(r_grid_in.template get<Phi_0_in>(key));
+			phi_type sum = 0;
+			for (size_t d = 0; d < sgrid_type::dims; d++)
+			{
+				phi_type dplus, dminus;
+				sparse_band_one_sided_differences<Phi_n>(r_grid_in, key, d, dplus, dminus);
+				const phi_type grad = upwinding(dplus, dminus, sign);
+				sum += grad * grad;
+			}
+			magnOfGrad.push_back(sqrt(sum));
+			++dom;
+		}
+
+		phi_type max_change = 0;
+		size_t i = 0;
+		auto dom2 = r_grid_in.getDomainIterator();
+		while (dom2.isNext())
+		{
+			auto key = dom2.get();
+			const phi_type phi_n = r_grid_in.template get<Phi_n>(key);
+			const phi_type epsilon = magnOfGrad[i] * r_grid_in.spacing(0);
+			const phi_type phi_nplus1 = phi_n + time_step * smooth_S(phi_n, epsilon) * (1 - magnOfGrad[i]);
+			max_change = std::max(max_change, (phi_type)std::abs(phi_nplus1 - phi_n));
+			r_grid_in.template get<Phi_n>(key) = phi_nplus1;
+			i++;
+			++dom2;
+		}
+		r_grid_in.template ghost_get<Phi_n>(KEEP_PROPERTIES);
+		return max_change;
+	}
+};
+
+#endif //REDISTANCING_SPARSE_BAND_HPP
@@ -0,0 +1,100 @@
+//
+// Tests of the redistancing on a sparse band
+//
+#define BOOST_TEST_DYN_LINK
+#include <boost/test/unit_test.hpp>
+
+// Include redistancing files
+#include "level_set/sparse_band/RedistancingSparseBand.hpp"
+#include "Grid/grid_dist_id.hpp"
+
+BOOST_AUTO_TEST_SUITE(RedistancingSparseBandTestSuite)
+
+	BOOST_AUTO_TEST_CASE(RedistancingSparseBand_unit_sphere_test)
+	{
+		auto & v_cl = create_vcluster();
+		typedef double phi_type;
+		typedef double space_type;
+		const size_t grid_dim = 3;
+		// some indices
+		const size_t Phi_0_grid             = 0;
+		const size_t SDF_sparse_grid        = 1;
+		const size_t SDF_exact_grid         = 2;
+		
+		size_t N = 32;
+		const size_t sz[grid_dim] = {N, N, N};
+		const space_type radius = 1.0;
+		const space_type box_lower = -2.0;
+		const space_type box_upper = 2.0;
+		Box<grid_dim, space_type> box({box_lower, box_lower, box_lower}, {box_upper, box_upper, box_upper});
+		Ghost<grid_dim, long int> ghost(1);
+		typedef aggregate<phi_type, phi_type, phi_type> props;
+		typedef sgrid_dist_id<grid_dim, space_type, props> sgrid_in_type;
+		sgrid_in_type g_sparse(sz, box, ghost);
+		g_sparse.setPropNames({"Phi_0", "SDF_sparse", "SDF_exact"});
+		
+		const space_type h = g_sparse.spacing(0);
+		
+		// Only the nodes closer than 6 grid points to the sphere are stored
+		auto sdf_sphere = [radius](const Point<grid_dim, space_type> & p) {return p.norm() - radius;};
+		init_sparse_band<SDF_exact_grid>(g_sparse, sdf_sphere, 6 * h);
+		
+		// Initial level-set function that is not a SDF, but has the same zero level set
+		auto dom = g_sparse.getDomainIterator();
+		while (dom.isNext())
+		{
+			auto key = dom.get();
+			Point<grid_dim, space_type> p = g_sparse.getPos(key);
+			g_sparse.template get<Phi_0_grid>(key) = p.norm() * p.norm() - radius * radius;
+			++dom;
+		}
+		
+		size_t band_size = 0;
+		auto dom_count = g_sparse.getDomainIterator();
+		while (dom_count.isNext())
+		{
+			band_size++;
+			++dom_count;
+		}
+		v_cl.sum(band_size);
+		v_cl.execute();
+		// One third of the 32^3 nodes of the dense grid
+		BOOST_CHECK(band_size == 11024);
+		
+		Redist_options_sparse_band<phi_type> redist_options;
+		redist_options.max_iter = 2000;
+		redist_options.convTolChange = 1e-5;
+		redist_options.print_steadyState_iter = true;
+		
+		RedistancingSparseBand<sgrid_in_type, phi_type> redist_obj(g_sparse, redist_options);
+		redist_obj.run_redistancing<Phi_0_grid, SDF_sparse_grid>();
+		
+		BOOST_CHECK(redist_obj.get_finalChange() < redist_options.convTolChange);
+		
+		// L_2- and L_infinity-norm of the error within 3 grid points from the interface
+		phi_type sum_error_sq = 0, max_error = 0;
+		size_t count = 0;
+		auto dom_err = g_sparse.getDomainIterator();
+		while (dom_err.isNext())
+		{
+			auto key = dom_err.get();
+			if (std::abs(g_sparse.template get<SDF_exact_grid>(key)) < 3 * h)
+			{
+				phi_type error = std::abs(g_sparse.template get<SDF_sparse_grid>(key) - g_sparse.template get<SDF_exact_grid>(key));
+				sum_error_sq += error * error;
+				max_error = std::max(max_error, error);
+				count++;
+			}
+			++dom_err;
+		}
+		v_cl.sum(sum_error_sq);
+		v_cl.sum(count);
+		v_cl.max(max_error);
+		v_cl.execute();
+		phi_type l2 = sqrt(sum_error_sq / count);
+		std::cout << l2 << ", " << max_error << std::endl;
+		
+		BOOST_CHECK(l2 < 0.0535);
+		BOOST_CHECK(max_error < 0.0803);
+	}
+BOOST_AUTO_TEST_SUITE_END()
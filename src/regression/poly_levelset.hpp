@@ -11,6 +11,12 @@
 #include "Vector/map_vector.hpp"
 #include "Space/Shape/Point.hpp"
 #include "DMatrix/EMatrix.hpp"
+#include "VCluster/VCluster.hpp"
+
+#include <Eigen/Eigenvalues>
+#include <algorithm>
+#include <limits>
+#include <cmath>
 
 #include "minter/include/minter.h"
 
@@ -19,6 +25,31 @@ template<int spatial_dim, typename MatType = EMatrixXd, typename VecType = EVect
 class PolyLevelset
 {
     minter::LevelsetPoly<spatial_dim, MatType, VecType> *model;
+
+    // positions gathered by the batch functions, reused across calls
+    MatType points_ws;
+
+    // keys of the particles gathered by the batch functions
+    openfpm::vector<size_t> keys_ws;
+
+    // Copy the positions of the particles of the iterator in points_ws and their keys in keys_ws
+    template<typename vector_type, typename iterator_type>
+    void gather_positions(vector_type &vd, iterator_type it)
+    {
+        keys_ws.clear();
+        while(it.isNext())
+        {
+            keys_ws.add(it.get().getKey());
+            ++it;
+        }
+
+        points_ws.resize(keys_ws.size(), spatial_dim);
+        for(size_t i = 0;i < keys_ws.size();++i)
+        {
+            for(int j = 0;j < spatial_dim;++j)
+                points_ws(i,j) = vd.getPos(keys_ws.get(i))[j];
+        }
+    }
     
 public:
     template<typename vector_type>
@@ -80,6 +111,112 @@ public:
         return model->deriv_eval(point, order)(0);
     }
 
+    /*! \brief Evaluate the levelset polynomial at many points with one call
+     *
+     * \param points matrix with one point per row
+     *
+     * \return the values, one per row of points
+     *
+     */
+    VecType eval_batch(const MatType &points)
+    {
+        return model->eval(points);
+    }
+
+    /*! \brief Evaluate the levelset polynomial at the particles of an iterator and store the result in the property prp
+     *
+     * \tparam prp property where to store the value
+     *
+     * \param vd particles
+     * \param it iterator over the particles to evaluate (for example vd.getDomainIterator())
+     *
+     */
+    template<unsigned int prp, typename vector_type, typename iterator_type>
+    void eval_batch(vector_type &vd, iterator_type it)
+    {
+        gather_positions(vd, it);
+        VecType values = model->eval(points_ws);
+
+        for(size_t i = 0;i < keys_ws.size();++i)
+            vd.template getProp<prp>(keys_ws.get(i)) = values(i);
+    }
+
+    /*! \brief Evaluate a derivative of the levelset polynomial at many points with one call
+     *
+     * \param points matrix with one point per row
+     * \param deriv_order order of the derivative along each dimension
+     *
+     * \return the values of the derivative, one per row of points
+     *
+     */
+    template<typename T2>
+    VecType deriv_batch(const MatType &points, T2 deriv_order)
+    {
+        std::vector<int> order;
+        for(int j = 0;j < spatial_dim;++j)
+            order.push_back(deriv_order.get(j));
+
+        return model->deriv_eval(points, order);
+    }
+
+    /*! \brief Evaluate a derivative of the levelset polynomial at the particles of an iterator and store it in the property prp
+     *
+     * \tparam prp property where to store the derivative
+     *
+     * \param vd particles
+     * \param it iterator over the particles to evaluate
+     * \param deriv_order order of the derivative along each dimension
+     *
+     */
+    template<unsigned int prp, typename vector_type, typename iterator_type, typename T2>
+    void deriv_batch(vector_type &vd, iterator_type it, T2 deriv_order)
+    {
+        gather_positions(vd, it);
+        VecType values = deriv_batch(points_ws, deriv_order);
+
+        for(size_t i = 0;i < keys_ws.size();++i)
+            vd.template getProp<prp>(keys_ws.get(i)) = values(i);
+    }
+
+    /*! \brief Estimate the normals at the particles of an iterator and store them in the vector property prp
+     *
+     * \tparam prp property where to store the normal
+     *
+     * \param vd particles
+     * \param it iterator over the particles
+     *
+     */
+    template<unsigned int prp, typename vector_type, typename iterator_type>
+    void estimate_normals_batch(vector_type &vd, iterator_type it)
+    {
+        gather_positions(vd, it);
+        auto normal_minter = model->estimate_normals_at(points_ws);
+
+        for(size_t i = 0;i < keys_ws.size();++i)
+        {
+            for(int j = 0;j < spatial_dim;++j)
+                vd.template getProp<prp>(keys_ws.get(i))[j] = normal_minter(i,j);
+        }
+    }
+
+    /*! \brief Estimate the mean curvature at the particles of an iterator and store it in the property prp
+     *
+     * \tparam prp property where to store the mean curvature
+     *
+     * \param vd particles
+     * \param it iterator over the particles
+     *
+     */
+    template<unsigned int prp, typename vector_type, typename iterator_type>
+    void estimate_mean_curvature_batch(vector_type &vd, iterator_type it)
+    {
+        gather_positions(vd, it);
+        auto mc = model->estimate_mean_curvature_at(points_ws);
+
+        for(size_t i = 0;i < keys_ws.size();++i)
+            vd.template getProp<prp>(keys_ws.get(i)) = mc(i);
+    }
+
     // T : Point<vector_type::dims, typename vector_type::stype>
     template<typename T>
     T estimate_normals_at(T pos)
@@ -114,5 +251,335 @@ public:
 };
 
 
+/*! \brief Levelset polynomial fitted on the particles of all the processors
+ *
+ * PolyLevelset fits an independent polynomial on the local particles of every processor. Here every processor
+ * accumulates the contribution of its particles to the normal equations G = V^T V, where V is the matrix of the
+ * monomials (up to a total degree) evaluated at the particles. The matrices are summed over the processors and the
+ * coefficients are the eigenvector of G with the smallest eigenvalue (the polynomial that is closest to zero on all the
+ * particles in the least square sense). Every processor obtain the same model without gathering the particles.
+ * The points are shifted and scaled to the global bounding box to keep G well conditioned, the sign of the polynomial
+ * is chosen negative at the center of the bounding box.
+ *
+ * \tparam spatial_dim dimensionality
+ *
+ */
+template<int spatial_dim>
+class DistributedPolyLevelset
+{
+    // exponents of the monomials, one per row
+    openfpm::vector<Point<spatial_dim, int>> exponents;
+
+    // coefficients of the monomials
+    EVectorXd coeffs;
+
+    // center and scale of the bounding box of the particles
+    Point<spatial_dim, double> center;
+    double scale = 1.0;
+
+    // maximum total degree
+    unsigned int poly_degree;
+
+    // Create all the monomials with total degree less or equal to poly_degree
+    void create_exponents()
+    {
+        Point<spatial_dim, int> e;
+        for(int j = 0;j < spatial_dim;++j)
+            e.get(j) = 0;
+
+        // count in base poly_degree + 1 and keep the exponents with total degree <= poly_degree
+        while(true)
+        {
+            int deg = 0;
+            for(int j = 0;j < spatial_dim;++j)
+                deg += e.get(j);
+
+            if(deg <= (int)poly_degree)
+                exponents.add(e);
+
+            int j = 0;
+            while(j < spatial_dim && e.get(j) == (int)poly_degree)
+            {
+                e.get(j) = 0;
+                ++j;
+            }
+
+            if(j == spatial_dim)
+                break;
+
+            ++e.get(j);
+        }
+    }
+
+    // Value of the derivative of order order of the monomial m at the scaled point x (given the powers of x)
+    double monomial_deriv(const EMatrixXd &pows, size_t m, const Point<spatial_dim, int> &order)
+    {
+        double val = 1.0;
+        for(int j = 0;j < spatial_dim;++j)
+        {
+            int e = exponents.get(m).get(j);
+            int o = order.get(j);
+            if(o > e)
+                return 0.0;
+
+            for(int k = 0;k < o;++k)
+                val *= e - k;
+
+            val *= pows(j, e - o);
+        }
+        return val;
+    }
+
+    // Powers of the scaled point x up to poly_degree, pows(j,k) = x_j^k
+    template<typename T>
+    void compute_powers(const T &pos, EMatrixXd &pows)
+    {
+        pows.resize(spatial_dim, poly_degree + 1);
+        for(int j = 0;j < spatial_dim;++j)
+        {
+            double x = (pos.get(j) - center.get(j)) / scale;
+            pows(j,0) = 1.0;
+            for(unsigned int k = 1;k <= poly_degree;++k)
+                pows(j,k) = pows(j,k-1) * x;
+        }
+    }
+
+    // Derivative of order order of the polynomial at pos, in the scaled coordinates
+    template<typename T>
+    double deriv_scaled(const T &pos, const Point<spatial_dim, int> &order)
+    {
+        EMatrixXd pows;
+        compute_powers(pos, pows);
+
+        double val = 0.0;
+        for(size_t m = 0;m < exponents.size();++m)
+            val += coeffs(m) * monomial_deriv(pows, m, order);
+
+        return val;
+    }
+
+    // Gradient and Hessian of the polynomial at pos, in the original coordinates
+    template<typename T>
+    void grad_hessian(const T &pos, double (& g)[spatial_dim], double (& H)[spatial_dim][spatial_dim])
+    {
+        EMatrixXd pows;
+        compute_powers(pos, pows);
+
+        Point<spatial_dim, int> order;
+        for(int j = 0;j < spatial_dim;++j)
+        {
+            for(int l = 0;l < spatial_dim;++l)
+                order.get(l) = (l == j);
+
+            g[j] = 0.0;
+            for(size_t m = 0;m < exponents.size();++m)
+                g[j] += coeffs(m) * monomial_deriv(pows, m, order);
+            g[j] /= scale;
+
+            for(int k = 0;k < spatial_dim;++k)
+            {
+                for(int l = 0;l < spatial_dim;++l)
+                    order.get(l) = (l == j) + (l == k);
+
+                H[j][k] = 0.0;
+                for(size_t m = 0;m < exponents.size();++m)
+                    H[j][k] += coeffs(m) * monomial_deriv(pows, m, order);
+                H[j][k] /= scale * scale;
+            }
+        }
+    }
+
+public:
+
+    /*! \brief Fit the levelset polynomial on the domain particles of all the processors
+     *
+     * \param vd particles on the surface
+     * \param poly_degree maximum total degree of the polynomial
+     *
+     */
+    template<typename vector_type>
+    DistributedPolyLevelset(vector_type &vd, unsigned int poly_degree)
+    :poly_degree(poly_degree)
+    {
+        auto & v_cl = create_vcluster();
+
+        create_exponents();
+        const size_t n_mono = exponents.size();
+
+        // global bounding box of the particles
+        double p_min[spatial_dim];
+        double p_max[spatial_dim];
+        for(int j = 0;j < spatial_dim;++j)
+        {
+            p_min[j] = std::numeric_limits<double>::max();
+            p_max[j] = -std::numeric_limits<double>::max();
+        }
+
+        auto it = vd.getDomainIterator();
+        while(it.isNext())
+        {
+            auto key = it.get();
+            for(int j = 0;j < spatial_dim;++j)
+            {
+                p_min[j] = std::min(p_min[j], (double)vd.getPos(key)[j]);
+                p_max[j] = std::max(p_max[j], (double)vd.getPos(key)[j]);
+            }
+            ++it;
+        }
+
+        for(int j = 0;j < spatial_dim;++j)
+        {
+            v_cl.min(p_min[j]);
+            v_cl.max(p_max[j]);
+        }
+        v_cl.execute();
+
+        scale = 0.0;
+        for(int j = 0;j < spatial_dim;++j)
+        {
+            center.get(j) = 0.5 * (p_min[j] + p_max[j]);
+            scale = std::max(scale, 0.5 * (p_max[j] - p_min[j]));
+        }
+        if(scale <= 0.0)
+            scale = 1.0;
+
+        // local contribution to the normal equations
+        EMatrixXd G = EMatrixXd::Zero(n_mono, n_mono);
+        EVectorXd row(n_mono);
+        EMatrixXd pows;
+        Point<spatial_dim, int> zero;
+        for(int j = 0;j < spatial_dim;++j)
+            zero.get(j) = 0;
+
+        auto it2 = vd.getDomainIterator();
+        while(it2.isNext())
+        {
+            auto key = it2.get();
+            Point<spatial_dim, double> pos;
+            for(int j = 0;j < spatial_dim;++j)
+                pos.get(j) = vd.getPos(key)[j];
+
+            compute_powers(pos, pows);
+            for(size_t m = 0;m < n_mono;++m)
+                row(m) = monomial_deriv(pows, m, zero);
+
+            G.noalias() += row * row.transpose();
+            ++it2;
+        }
+
+        // sum the upper triangle over the processors
+        for(size_t m = 0;m < n_mono;++m)
+        {
+            for(size_t l = m;l < n_mono;++l)
+                v_cl.sum(G(m,l));
+        }
+        v_cl.execute();
+
+        for(size_t m = 0;m < n_mono;++m)
+        {
+            for(size_t l = 0;l < m;++l)
+                G(m,l) = G(l,m);
+        }
+
+        // the eigenvalues are sorted in increasing order
+        Eigen::SelfAdjointEigenSolver<EMatrixXd> solver(G);
+        if(solver.info() != Eigen::Success)
+            std::cerr << __FILE__ << ":" << __LINE__ << " error, the eigenvalue problem of the levelset fit did not converge" << std::endl;
+
+        coeffs = solver.eigenvectors().col(0);
+
+        // negative inside
+        if(eval(center) > 0.0)
+            coeffs = -coeffs;
+    }
+
+    /*! \brief Coefficients of the monomials (in the scaled coordinates)
+     *
+     * \return the coefficients
+     *
+     */
+    const EVectorXd & getCoeffs()
+    {
+        return coeffs;
+    }
+
+    // T : Point<vector_type::dims, typename vector_type::stype>
+    template<typename T>
+    double eval(T pos)
+    {
+        Point<spatial_dim, int> zero;
+        for(int j = 0;j < spatial_dim;++j)
+            zero.get(j) = 0;
+
+        return deriv_scaled(pos, zero);
+    }
+
+    // T1 : Point<vector_type::dims, typename vector_type::stype>
+    // T2 : Point<vector_type::dims, int>
+    template<typename T1, typename T2>
+    double deriv(T1 pos, T2 deriv_order)
+    {
+        Point<spatial_dim, int> order;
+        int tot = 0;
+        for(int j = 0;j < spatial_dim;++j)
+        {
+            order.get(j) = deriv_order.get(j);
+            tot += order.get(j);
+        }
+
+        return deriv_scaled(pos, order) / std::pow(scale, tot);
+    }
+
+    // T : Point<vector_type::dims, typename vector_type::stype>
+    template<typename T>
+    T estimate_normals_at(T pos)
+    {
+        double g[spatial_dim];
+        double H[spatial_dim][spatial_dim];
+        grad_hessian(pos, g, H);
+
+        double norm = 0.0;
+        for(int j = 0;j < spatial_dim;++j)
+            norm += g[j] * g[j];
+        norm = std::sqrt(norm);
+
+        T normal;
+        for(int j = 0;j < spatial_dim;++j)
+            normal.get(j) = g[j] / norm;
+
+        return normal;
+    }
+
+    /*! \brief Mean curvature, divergence of the normal divided by (spatial_dim - 1) (1 on the unit sphere)
+     *
+     * \param pos point
+     *
+     * \return the mean curvature
+     *
+     */
+    template<typename T>
+    double estimate_mean_curvature_at(T pos)
+    {
+        double g[spatial_dim];
+        double H[spatial_dim][spatial_dim];
+        grad_hessian(pos, g, H);
+
+        // div(g/|g|) = (|g|^2 tr(H) - g^T H g) / |g|^3
+        double norm2 = 0.0;
+        double trace = 0.0;
+        double gHg = 0.0;
+        for(int j = 0;j < spatial_dim;++j)
+        {
+            norm2 += g[j] * g[j];
+            trace += H[j][j];
+            for(int k = 0;k < spatial_dim;++k)
+                gHg += g[j] * H[j][k] * g[k];
+        }
+
+        return (norm2 * trace - gHg) / (std::pow(norm2, 1.5) * (spatial_dim - 1));
+    }
+};
+
+
 
 #endif /* POLYLEVELSET_HPP_ */
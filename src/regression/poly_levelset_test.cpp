@@ -87,6 +87,56 @@ BOOST_AUTO_TEST_CASE ( PolyLevelset_Sphere )
 
 }
 
+BOOST_AUTO_TEST_CASE ( DistributedPolyLevelset_Sphere )
+{
+    Box<3,double> domain({-2.0,-2.0,-2.0},{2.0,2.0,2.0});
+    size_t bc[3]={PERIODIC,PERIODIC,PERIODIC};
+    Ghost<3,double> g(0.01);
+
+    using vectorType = vector_dist<3,double, aggregate<double> >;
+
+    vectorType vd(1024,domain,bc,g);
+
+    // Initialize points on the upper half of the unit sphere
+    auto it = vd.getDomainIterator();
+    while (it.isNext())
+    {
+        auto key = it.get();
+        double theta = ((double)rand() / RAND_MAX) * M_PI;
+        double phi = ((double)rand() / RAND_MAX) * 2.0 * M_PI;
+
+        vd.getPos(key)[0] = cos(theta) * sin(phi);
+        vd.getPos(key)[1] = cos(theta) * cos(phi);
+        vd.getPos(key)[2] = sin(theta);
+
+        ++it;
+    }
+    vd.map();
+
+    // one model fitted on the particles of all the processors, a quadric represents the sphere exactly
+    DistributedPolyLevelset<3> model(vd, 2);
+
+    double max_err_mc = 0.0;
+    double max_err_n = 0.0;
+    auto it2 = vd.getDomainIterator();
+    while (it2.isNext())
+    {
+        auto key = it2.get();
+        Point<3, double> pos = {vd.getPos(key)[0], vd.getPos(key)[1], vd.getPos(key)[2]};
+
+        max_err_mc = std::max(max_err_mc, std::abs(model.estimate_mean_curvature_at(pos) - 1.0));
+
+        Point<3, double> normal = model.estimate_normals_at(pos);
+        for (int d = 0; d < 3; d++)
+            max_err_n = std::max(max_err_n, std::abs(normal.get(d) - pos.get(d)));
+
+        ++it2;
+    }
+
+    BOOST_REQUIRE(max_err_mc < 1e-8);
+    BOOST_REQUIRE(max_err_n < 1e-8);
+}
+
 
 BOOST_AUTO_TEST_SUITE_END()
 
@@ -12,6 +12,7 @@
 #include "Space/Shape/Point.hpp"
 #include "DMatrix/EMatrix.hpp"
 #include "DCPSE/SupportBuilder.hpp"
+#include "DCPSE/CellNeighbourSearch.hpp"
 #include "minter/include/minter.h"
 
 
@@ -22,30 +23,31 @@ class RegressionSupport
 	
 public:
 
+	typedef CellNeighbourSearch<vector_type_support, NN_type> search_type;
+
 	template<typename iterator_type>
-	RegressionSupport(vector_type_support &vd, iterator_type itPoint, unsigned int requiredSize, support_options opt, NN_type &cellList_in) : domain(vd),
-	cellList(cellList_in)
+	RegressionSupport(vector_type_support &vd, iterator_type itPoint, unsigned int requiredSize, support_options opt, NN_type &cellList_in)
 	{
-		rCut = cellList_in.getCellBox().getHigh(0);
-		// Get spatial position from point iterator
-		vect_dist_key_dx p = itPoint.get();
-		vect_dist_key_dx pOrig = itPoint.getOrig();
-		Point<vector_type_support::dims, typename vector_type_support::stype> pos = domain.getPos(p.getKey());
-
-		// Get cell containing current point and add it to the set of cell keys
-		grid_key_dx<vector_type_support::dims> curCellKey = cellList.getCellGrid(pos); // Here get the key of the cell where the current point is
-		std::set<grid_key_dx<vector_type_support::dims>> supportCells;
-        	supportCells.insert(curCellKey);
-
-		// Make sure to consider a set of cells providing enough points for the support
-		enlargeSetOfCellsUntilSize(supportCells, requiredSize + 1,
-                                   opt); // NOTE: this +1 is because we then remove the point itself
+		search_type search(vd, cellList_in);
+		buildSupport(vd, itPoint, requiredSize, opt, search);
+	}
 
-        	// Now return all the points from the support into a vector
-        	keys = getPointsInSetOfCells(supportCells, p, pOrig, requiredSize, opt);
+	/*! \brief Build the support with an existing neighbour search, its stencils and buffers are reused
+	 *
+	 * \param vd particles
+	 * \param itPoint iterator pointing to the particle of the support
+	 * \param requiredSize number of particles of the support
+	 * \param opt support option (RADIUS, AT_LEAST_N_PARTICLES or N_PARTICLES)
+	 * \param search neighbour search on the cell list of vd
+	 *
+	 */
+	template<typename iterator_type>
+	RegressionSupport(vector_type_support &vd, iterator_type itPoint, unsigned int requiredSize, support_options opt, search_type &search)
+	{
+		buildSupport(vd, itPoint, requiredSize, opt, search);
 	}
 	
-	auto getKeys()
+	const openfpm::vector<size_t> & getKeys()
 	{
 		return keys;
 	}
@@ -57,180 +59,37 @@ public:
 
 private:
 
-	vector_type_support &domain;
-	NN_type &cellList;
-	typename vector_type_support::stype rCut;
-
-
-    	void enlargeSetOfCellsUntilSize(std::set<grid_key_dx<vector_type_support::dims>> &set, unsigned int requiredSize,
-                                    support_options opt) {
-        	if (opt == support_options::RADIUS) {
-            	auto cell = *set.begin();
-            	grid_key_dx<vector_type_support::dims> middle;
-            	int n = std::ceil(rCut / cellList.getCellBox().getHigh(0));
-            	size_t sz[vector_type_support::dims];
-            	for (int i = 0; i < vector_type_support::dims; i++) {
-                	sz[i] = 2 * n + 1;
-                	middle.set_d(i, n);
-            	}
-            	grid_sm<vector_type_support::dims, void> g(sz);
-            	grid_key_dx_iterator<vector_type_support::dims> g_k(g);
-            	while (g_k.isNext()) {
-                	auto key = g_k.get();
-                	key = cell + key - middle;
-                	if (isCellKeyInBounds(key)) {
-                    		set.insert(key);
-                	}
-                	++g_k;
-            	}
-        	}
-	        else if (opt == support_options::AT_LEAST_N_PARTICLES) {
-
-		int done = 0;
-		int n = 1;
-            	auto cell = *set.begin();
-            	grid_key_dx<vector_type_support::dims> middle;
-		size_t sz[vector_type_support::dims];
-		
-		while(true) // loop for the number of cells enlarged per dimension
+	template<typename iterator_type>
+	void buildSupport(vector_type_support &vd, iterator_type itPoint, unsigned int requiredSize, support_options opt, search_type &search)
+	{
+		// the radius of the support is the size of a cell
+		typename vector_type_support::stype rCut = search.getCellSize();
+
+		// Get spatial position from point iterator
+		vect_dist_key_dx p = itPoint.get();
+		Point<vector_type_support::dims, typename vector_type_support::stype> pos = vd.getPos(p.getKey());
+
+		search.clear();
+
+		if (opt == support_options::RADIUS)
 		{
-			std::set<grid_key_dx<vector_type_support::dims>> temp_set;
-            		for (int i = 0; i < vector_type_support::dims; i++) {
-                		sz[i] = 2 * n + 1;
-                		middle.set_d(i, n);
-            		}
-
-            		grid_sm<vector_type_support::dims, void> g(sz);
-            		grid_key_dx_iterator<vector_type_support::dims> g_k(g);
-            		while (g_k.isNext()) {
-                		auto key = g_k.get();
-                		key = cell + key - middle;
-                		if (isCellKeyInBounds(key)) {
-                    			temp_set.insert(key);
-                		}
-                		++g_k;
-            		}
-			if (getNumElementsInSetOfCells(temp_set) < requiredSize) n++;
-			else 
-			{
-				set = temp_set;
-				break;
-			}
+			search.addCube(pos, search.getCubeHalfWidth(rCut));
+			search.selectRadius(keys, rCut);
 		}
+		else if (opt == support_options::AT_LEAST_N_PARTICLES)
+		{
+			// smallest cube of cells (at least 3 cells per dimension) with enough particles
+			search.addShells(pos, requiredSize + 1, search.no_exclude, 1);
+			search.selectAll(keys);
 		}
-		else {
-            	while (getNumElementsInSetOfCells(set) <
-                   5.0 * requiredSize) //Why 5*requiredSize? Becasue it can help with adaptive resolutions.
-            	{
-                	auto tmpSet = set;
-                	for (const auto el: tmpSet) {
-                    	for (unsigned int i = 0; i < vector_type_support::dims; ++i) {
-                        	const auto pOneEl = el.move(i, +1);
-                        	const auto mOneEl = el.move(i, -1);
-                        	if (isCellKeyInBounds(pOneEl)) {
-                            	set.insert(pOneEl);
-                        	}
-                        	if (isCellKeyInBounds(mOneEl)) {
-                            	set.insert(mOneEl);
-                        	}
-                    	}
-                	}
-
-            	}	
-		}   	
-    }
-
-    openfpm::vector<size_t> getPointsInSetOfCells(std::set<grid_key_dx<vector_type_support::dims>> set,
-                                              vect_dist_key_dx &p,
-                                              vect_dist_key_dx &pOrig,
-                                              size_t requiredSupportSize,
-                                              support_options opt) {
-        struct reord {
-            typename vector_type_support::stype dist;
-            size_t offset;
-
-            bool operator<(const reord &p) const { return this->dist < p.dist; }
-        };
-
-        openfpm::vector<reord> rp;
-        openfpm::vector<size_t> points;
-        Point<vector_type_support::dims, typename vector_type_support::stype> xp = domain.getPos(p);
-        for (const auto cellKey: set) {
-            const size_t cellLinId = getCellLinId(cellKey);
-            const size_t elemsInCell = getNumElementsInCell(cellKey);
-            for (size_t k = 0; k < elemsInCell; ++k) {
-                size_t el = cellList.get(cellLinId, k);
-
-                Point<vector_type_support::dims, typename vector_type_support::stype> xq = domain.getPosOrig(el);
-                //points.push_back(el);
-
-                reord pr;
-
-                pr.dist = xp.distance(xq);
-                pr.offset = el;
-                rp.add(pr);
-            }
-        }
-
-        if (opt == support_options::RADIUS) {
-            for (int i = 0; i < rp.size(); i++) {
-                if (rp.get(i).dist < rCut) {
-                    points.add(rp.get(i).offset);
-                }
-            }
-            /*      #ifdef SE_CLASS1
-                    if (points.size()<requiredSupportSize)
-                    {
-                        std::cerr<<__FILE__<<":"<<__LINE__<<"Note that the DCPSE neighbourhood doesn't have asked no. particles (Increase the rCut or reduce the over_sampling factor)";
-                        std::cout<<"Particels asked (minimum*oversampling_factor): "<<requiredSupportSize<<". Particles Possible with given options:"<<points.size()<<"."<<std::endl;
-                    }
-                    #endif*/
-        }
-	else if (opt == support_options::AT_LEAST_N_PARTICLES) {
-	    for (int i = 0; i  < rp.size(); i++) points.add(rp.get(i).offset);
-	    }
-        else {
-            rp.sort();
-            for (int i = 0; i < requiredSupportSize; i++) {
-                    points.add(rp.get(i).offset);
-                }
-            }
-        //MinSpacing=MinSpacing/requiredSupportSize
-        return points;
-    }
-    
-    size_t getCellLinId(const grid_key_dx<vector_type_support::dims> &cellKey) {
-        mem_id id = cellList.getGrid().LinId(cellKey);
-        return static_cast<size_t>(id);
-    }
-
-    size_t getNumElementsInCell(const grid_key_dx<vector_type_support::dims> &cellKey) {
-        const size_t curCellId = getCellLinId(cellKey);
-        size_t numElements = cellList.getNelements(curCellId);
-        return numElements;
-    }
-    size_t getNumElementsInSetOfCells(const std::set<grid_key_dx<vector_type_support::dims>> &set)
-    {
-	    size_t tot = 0;
-	    for (const auto cell : set)
-	    {
-		    tot += getNumElementsInCell(cell);
-	    }
-	    return tot;
-}
-
-    bool isCellKeyInBounds(grid_key_dx<vector_type_support::dims> key)
-    {
-        const size_t *cellGridSize = cellList.getGrid().getSize();
-        for (size_t i = 0; i < vector_type_support::dims; ++i)
-        {
-            if (key.value(i) < 0 || key.value(i) >= cellGridSize[i])
-            {
-                return false;
-            }
-        }
-        return true;
-    }
+		else
+		{
+			// NOTE: this +1 is because we then remove the point itself
+			// Why 5*requiredSize? Becasue it can help with adaptive resolutions.
+			search.addRings(pos, 5.0 * (requiredSize + 1));
+			search.selectNearest(keys, requiredSize);
+		}
+	}
 };
 
 
@@ -238,6 +97,38 @@ template<int spatial_dim, unsigned int prp_id, typename MatType = EMatrixXd, typ
 class RegressionModel
 {
 
+	//! positions of the support, reused by computeCoeffs (no reallocation when the support size does not change)
+	MatType points_ws;
+	//! values on the support, reused by computeCoeffs
+	VecType values_ws;
+	//! coefficients buffer for loadCoeffs
+	VecType coeffs_ws;
+	//! the derivative models have been computed from the current coefficients of model
+	bool deriv_valid = false;
+	//! positions gathered by the batch functions
+	MatType batch_points_ws;
+	//! keys of the particles gathered by the batch functions
+	openfpm::vector<size_t> batch_keys_ws;
+
+	//! Copy the positions of the particles of the iterator in batch_points_ws and their keys in batch_keys_ws
+	template<typename vector_type, typename iterator_type>
+	void gather_positions(vector_type &vd, iterator_type it)
+	{
+		batch_keys_ws.clear();
+		while (it.isNext())
+		{
+			batch_keys_ws.add(it.get().getKey());
+			++it;
+		}
+
+		batch_points_ws.resize(batch_keys_ws.size(), spatial_dim);
+		for(size_t i = 0;i < batch_keys_ws.size();++i)
+		{
+			for(int j = 0;j < spatial_dim;++j)
+				batch_points_ws(i,j) = vd.getPos(batch_keys_ws.get(i))[j];
+		}
+	}
+
 public:
 	minter::PolyModel<spatial_dim, MatType, VecType> *model = nullptr;
 	minter::PolyModel<spatial_dim, MatType, VecType> *deriv_model[spatial_dim];
@@ -373,20 +264,52 @@ public:
         	unsigned int dim = vector_type::dims;
 		auto num_particles = support.getNumParticles();
 
-        	Eigen::MatrixXd points(num_particles, dim);
-        	Eigen::VectorXd values(num_particles);
+		// Eigen reallocates only if the size changes
+        	points_ws.resize(num_particles, dim);
+        	values_ws.resize(num_particles);
 	
-		auto keys = support.getKeys();
+		const auto & keys = support.getKeys();
 		for(int i = 0;i < num_particles;++i)
 		{
 			for(int j = 0;j < dim;++j)
-				points(i,j) = vd.getPos(keys.get(i))[j];
-			values(i) = vd.template getProp<prp_id>(keys.get(i));
+				points_ws(i,j) = vd.getPos(keys.get(i))[j];
+			values_ws(i) = vd.template getProp<prp_id>(keys.get(i));
 		}
 
-	        model->computeCoeffs(points, values);
+	        model->computeCoeffs(points_ws, values_ws);
+		deriv_valid = false;
     	}
 
+	/*! \brief Copy the coefficients of the model into a fixed size array (for example a particle property)
+	 *
+	 * \param coeffs array with at least n_coeffs elements
+	 * \param n_coeffs number of coefficients
+	 *
+	 */
+	template<typename coeff_type>
+	void storeCoeffs(coeff_type & coeffs, unsigned int n_coeffs)
+	{
+		const auto & c = model->getCoeffs();
+		for(int k = 0;k < n_coeffs;++k)
+			coeffs[k] = c[k];
+	}
+
+	/*! \brief Set the coefficients of the model from a fixed size array, the buffer is allocated only at the first call
+	 *
+	 * \param coeffs array with the coefficients
+	 * \param n_coeffs number of coefficients
+	 *
+	 */
+	template<typename coeff_type>
+	void loadCoeffs(const coeff_type & coeffs, unsigned int n_coeffs)
+	{
+		coeffs_ws.resize(n_coeffs);
+		for(int k = 0;k < n_coeffs;++k)
+			coeffs_ws[k] = coeffs[k];
+		model->setCoeffs(coeffs_ws);
+		deriv_valid = false;
+	}
+
 	~RegressionModel()
 	{
 
@@ -429,14 +352,88 @@ public:
 		return model->deriv_eval(point, order)(0);
 	}
 
+	/*! \brief Evaluate the model at many points with one call
+	 *
+	 * \param points matrix with one point per row
+	 *
+	 * \return the values, one per row of points
+	 *
+	 */
+	VecType eval_batch(const MatType & points)
+	{
+		return model->eval(points);
+	}
+
+	/*! \brief Evaluate the model at the particles of an iterator and store the result in the property prp
+	 *
+	 * \tparam prp property where to store the value
+	 *
+	 * \param vd particles
+	 * \param it iterator over the particles to evaluate (for example vd.getDomainIterator())
+	 *
+	 */
+	template<unsigned int prp, typename vector_type, typename iterator_type>
+	void eval_batch(vector_type & vd, iterator_type it)
+	{
+		gather_positions(vd, it);
+		VecType values = model->eval(batch_points_ws);
+
+		for(size_t i = 0;i < batch_keys_ws.size();++i)
+			vd.template getProp<prp>(batch_keys_ws.get(i)) = values(i);
+	}
+
+	/*! \brief Evaluate the gradient of the model at many points, the derivative models are built once and reused
+	 *
+	 * \param points matrix with one point per row
+	 *
+	 * \return matrix with the gradient of each point on the same row
+	 *
+	 */
+	MatType eval_grad_batch(const MatType & points)
+	{
+		if(!deriv_valid)
+			compute_grad();
+
+		MatType grad(points.rows(), spatial_dim);
+		for(int i = 0;i < spatial_dim;++i)
+			grad.col(i) = deriv_model[i]->eval(points);
+
+		return grad;
+	}
+
+	/*! \brief Evaluate the gradient of the model at the particles of an iterator and store it in the vector property prp
+	 *
+	 * \tparam prp property where to store the gradient
+	 *
+	 * \param vd particles
+	 * \param it iterator over the particles to evaluate
+	 *
+	 */
+	template<unsigned int prp, typename vector_type, typename iterator_type>
+	void eval_grad_batch(vector_type & vd, iterator_type it)
+	{
+		gather_positions(vd, it);
+		MatType grad = eval_grad_batch(batch_points_ws);
+
+		for(size_t i = 0;i < batch_keys_ws.size();++i)
+		{
+			for(int j = 0;j < spatial_dim;++j)
+				vd.template getProp<prp>(batch_keys_ws.get(i))[j] = grad(i,j);
+		}
+	}
+
 	void compute_grad()
 	{
 		for(int i = 0;i < spatial_dim;++i)
 		{
+			if(deriv_model[i])
+				delete deriv_model[i];
+
 			std::vector<int> ord(spatial_dim, 0);
 			ord[i] = 1;
 			deriv_model[i] = model->derivative(ord);
 		}
+		deriv_valid = true;
 	}
 
 	// T: Point<vector_type::dims, typename vector_type::stype>
@@ -445,7 +442,7 @@ public:
 	{
 		T res;
 
-		if(!deriv_model[0])
+		if(!deriv_valid)
 			compute_grad();
 
 		for(int i = 0;i < spatial_dim;++i)
@@ -457,4 +454,168 @@ public:
 };
 
 
+/*! \brief Fit many local models with the same degree at once
+ *
+ * The supports are gathered one after the other in one batch of points (with the offset of every support). The model
+ * is linear in its coefficients, so the Vandermonde matrices of all the supports are obtained with n_coeffs evaluations
+ * of a model over the whole batch, with the unit coefficient vectors. Every local least squares problem is then solved
+ * on its block of rows with a Householder QR, in parallel with OpenMP. With n_c known at compile time the blocks have
+ * a fixed number of columns.
+ *
+ * \tparam spatial_dim dimensionality
+ * \tparam prp_id property with the values to fit
+ * \tparam n_c number of coefficients of the model (Eigen::Dynamic if it is known only at runtime)
+ *
+ */
+template<int spatial_dim, unsigned int prp_id, int n_c = Eigen::Dynamic>
+class RegressionBatch
+{
+	//! model with the degree of the batch, it evaluates the basis
+	RegressionModel<spatial_dim, prp_id> basis;
+	//! number of coefficients
+	unsigned int n_coeffs;
+
+	//! points of all the supports
+	EMatrixXd points;
+	//! values of all the supports
+	EVectorXd values;
+	//! offset of every support in points, the last element is the total number of points
+	openfpm::vector<size_t> offset;
+	//! number of points added
+	size_t n_points = 0;
+
+	//! coefficients, one row per support
+	Eigen::Matrix<double, Eigen::Dynamic, n_c> coeffs;
+
+public:
+
+	/*! \brief Constructor
+	 *
+	 * \param poly_degree degree of the models
+	 * \param lp_degree lp degree of the models
+	 * \param n_coeffs number of coefficients of the models
+	 *
+	 */
+	RegressionBatch(unsigned int poly_degree, float lp_degree, unsigned int n_coeffs)
+	:basis(poly_degree, lp_degree), n_coeffs(n_coeffs)
+	{
+		offset.add(0);
+	}
+
+	//! Remove all the supports (the buffers are kept)
+	void clear()
+	{
+		offset.resize(1);
+		n_points = 0;
+	}
+
+	//! Number of supports in the batch
+	size_t size() const
+	{
+		return offset.size() - 1;
+	}
+
+	/*! \brief Add a support to the batch
+	 *
+	 * \param vd particles
+	 * \param keys keys of the particles of the support
+	 *
+	 * \return the index of the support in the batch
+	 *
+	 */
+	template<typename vector_type>
+	size_t add(vector_type & vd, const openfpm::vector<size_t> & keys)
+	{
+		if ((size_t)points.rows() < n_points + keys.size())
+		{
+			size_t n_alloc = std::max(2*(size_t)points.rows(), n_points + keys.size());
+			points.conservativeResize(n_alloc, spatial_dim);
+			values.conservativeResize(n_alloc);
+		}
+
+		for(size_t i = 0;i < keys.size();++i)
+		{
+			for(int j = 0;j < spatial_dim;++j)
+				points(n_points + i,j) = vd.getPos(keys.get(i))[j];
+			values(n_points + i) = vd.template getProp<prp_id>(keys.get(i));
+		}
+
+		n_points += keys.size();
+		offset.add(n_points);
+		return size() - 1;
+	}
+
+	/*! \brief Add a support to the batch
+	 *
+	 * \param vd particles
+	 * \param support support (RegressionSupport)
+	 *
+	 * \return the index of the support in the batch
+	 *
+	 */
+	template<typename vector_type, typename reg_support_type>
+	size_t add(vector_type & vd, reg_support_type & support)
+	{
+		return add(vd, support.getKeys());
+	}
+
+	//! Fit the models of all the supports of the batch
+	void fit()
+	{
+		const long int n_supports = size();
+		Eigen::Matrix<double, Eigen::Dynamic, n_c> V(n_points, n_coeffs);
+		coeffs.resize(n_supports, n_coeffs);
+
+		EMatrixXd batch_points;
+		batch_points = points.topRows(n_points);
+
+		// column k of the Vandermonde matrices is the basis function k on all the points
+		std::vector<double> unit(n_coeffs, 0.0);
+		for(unsigned int k = 0;k < n_coeffs;++k)
+		{
+			unit[k] = 1.0;
+			basis.loadCoeffs(unit, n_coeffs);
+			V.col(k) = basis.eval_batch(batch_points);
+			unit[k] = 0.0;
+		}
+
+		#pragma omp parallel for schedule(dynamic,16)
+		for(long int s = 0;s < n_supports;++s)
+		{
+			const size_t start = offset.get(s);
+			const size_t n = offset.get(s+1) - start;
+
+			Eigen::Matrix<double, Eigen::Dynamic, n_c> V_s = V.middleRows(start, n);
+			coeffs.row(s) = V_s.householderQr().solve(values.segment(start, n)).transpose();
+		}
+	}
+
+	/*! \brief Copy the coefficients of a support into a fixed size array (for example a particle property)
+	 *
+	 * \param s index of the support in the batch
+	 * \param c array with at least n_coeffs elements
+	 *
+	 */
+	template<typename coeff_type>
+	void storeCoeffs(size_t s, coeff_type & c) const
+	{
+		for(unsigned int k = 0;k < n_coeffs;++k)
+			c[k] = coeffs(s,k);
+	}
+
+	/*! \brief Set the coefficients of a model to the ones of a support
+	 *
+	 * \param s index of the support in the batch
+	 * \param model model with the degree of the batch
+	 *
+	 */
+	void loadCoeffs(size_t s, RegressionModel<spatial_dim, prp_id> & model) const
+	{
+		std::vector<double> c(n_coeffs);
+		storeCoeffs(s, c);
+		model.loadCoeffs(c, n_coeffs);
+	}
+};
+
+
 #endif /* REGRESSION_HPP_ */
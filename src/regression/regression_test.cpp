@@ -180,4 +180,160 @@ BOOST_AUTO_TEST_CASE ( Regression_without_domain_initialization)
 }
 
 
+BOOST_AUTO_TEST_CASE ( Regression_load_store_coeffs )
+{
+    Box<2,float> domain({0.0,0.0},{1.0,1.0});
+    size_t bc[2]={PERIODIC,PERIODIC};
+    Ghost<2,float> g(0.01);
+
+    using vectorType = vector_dist<2,float, aggregate<double> >;
+    vectorType vd(256,domain,bc,g);
+    const int scalar = 0;
+
+    auto it = vd.getDomainIterator();
+    while (it.isNext())
+    {
+        auto key = it.get();
+        double posx = (double)rand() / RAND_MAX;
+        double posy = (double)rand() / RAND_MAX;
+
+        vd.getPos(key)[0] = posx;
+        vd.getPos(key)[1] = posy;
+        vd.template getProp<scalar>(key) = sin(posx*posy);
+        ++it;
+    }
+    vd.map();
+
+    auto model = RegressionModel<2, 0>(vd, 4, 2.0);
+    const unsigned int n_coeffs = model.model->getCoeffs().size();
+
+    // coefficients stored inline, as a particle property would do
+    std::vector<double> coeffs(n_coeffs), coeffs_2(n_coeffs);
+    model.storeCoeffs(coeffs, n_coeffs);
+    for (unsigned int k = 0; k < n_coeffs; k++) coeffs_2[k] = 2.0*coeffs[k];
+
+    // the derivative models must follow the coefficients that are loaded
+    RegressionModel<2, 0> model_load(4, 2.0);
+    Point<2, double> pos = {0.3, 0.6};
+    model_load.loadCoeffs(coeffs_2, n_coeffs);
+    Point<2, double> grad_2 = model_load.eval_grad(pos);
+    model_load.loadCoeffs(coeffs, n_coeffs);
+    Point<2, double> grad = model_load.eval_grad(pos);
+    Point<2, double> grad_ref = model.eval_grad(pos);
+
+    BOOST_REQUIRE_CLOSE(model_load.eval(pos), model.eval(pos), 1e-10);
+    for (int d = 0; d < 2; d++)
+    {
+        BOOST_REQUIRE_CLOSE(grad.get(d), grad_ref.get(d), 1e-10);
+        BOOST_REQUIRE_CLOSE(grad_2.get(d), 2.0*grad_ref.get(d), 1e-10);
+    }
+}
+
+
+BOOST_AUTO_TEST_CASE ( Regression_batch_eval )
+{
+    Box<2,float> domain({0.0,0.0},{1.0,1.0});
+    size_t bc[2]={PERIODIC,PERIODIC};
+    Ghost<2,float> g(0.01);
+
+    using vectorType = vector_dist<2,float, aggregate<double, double, double[2]> >;
+    vectorType vd(256,domain,bc,g);
+    const int scalar = 0;
+    const int value = 1;
+    const int gradient = 2;
+
+    auto it = vd.getDomainIterator();
+    while (it.isNext())
+    {
+        auto key = it.get();
+        double posx = (double)rand() / RAND_MAX;
+        double posy = (double)rand() / RAND_MAX;
+
+        vd.getPos(key)[0] = posx;
+        vd.getPos(key)[1] = posy;
+        vd.template getProp<scalar>(key) = sin(posx*posy);
+        ++it;
+    }
+    vd.map();
+
+    auto model = RegressionModel<2, 0>(vd, 4, 2.0);
+
+    // the batch evaluation must give the same result of the point by point one
+    model.eval_batch<value>(vd, vd.getDomainIterator());
+    model.eval_grad_batch<gradient>(vd, vd.getDomainIterator());
+
+    auto it2 = vd.getDomainIterator();
+    while (it2.isNext())
+    {
+        auto key = it2.get();
+        Point<2, double> pos = {vd.getPos(key)[0], vd.getPos(key)[1]};
+        Point<2, double> grad = model.eval_grad(pos);
+
+        BOOST_REQUIRE_CLOSE(vd.template getProp<value>(key), model.eval(pos), 1e-10);
+        for (int d = 0; d < 2; d++)
+            BOOST_REQUIRE_CLOSE(vd.template getProp<gradient>(key)[d], grad.get(d), 1e-10);
+
+        ++it2;
+    }
+}
+
+
+BOOST_AUTO_TEST_CASE ( Regression_batch_fit )
+{
+    Box<2,float> domain({0.0,0.0},{1.0,1.0});
+    size_t bc[2]={PERIODIC,PERIODIC};
+    Ghost<2,float> g(0.01);
+
+    using vectorType = vector_dist<2,float, aggregate<double> >;
+    vectorType vd(1024,domain,bc,g);
+    const int scalar = 0;
+
+    auto it = vd.getDomainIterator();
+    while (it.isNext())
+    {
+        auto key = it.get();
+        double posx = (double)rand() / RAND_MAX;
+        double posy = (double)rand() / RAND_MAX;
+
+        vd.getPos(key)[0] = posx;
+        vd.getPos(key)[1] = posy;
+        vd.template getProp<scalar>(key) = sin(posx*posy);
+        ++it;
+    }
+    vd.map();
+
+    auto NN = vd.getCellList(0.1);
+
+    // the same local fits, one by one and with the batch
+    RegressionModel<2, 0> model(vd, 3, 2.0);
+    const unsigned int n_coeffs = model.model->getCoeffs().size();
+    RegressionBatch<2, 0> batch(3, 2.0, n_coeffs);
+    std::vector<std::vector<double>> coeffs_ref;
+
+    auto it2 = vd.getDomainIterator();
+    for (size_t i = 0; i < 64 && it2.isNext(); i++, ++it2)
+    {
+        auto support = RegressionSupport<vectorType, decltype(NN)>(vd, it2, 20, N_PARTICLES, NN);
+        model.computeCoeffs(vd, support);
+
+        coeffs_ref.push_back(std::vector<double>(n_coeffs));
+        model.storeCoeffs(coeffs_ref.back(), n_coeffs);
+        BOOST_REQUIRE_EQUAL(batch.add(vd, support), i);
+    }
+
+    batch.fit();
+
+    // the coefficients depend on the solver, the fits are compared at the center of the supports
+    RegressionModel<2, 0> model_batch(3, 2.0);
+    for (size_t s = 0; s < batch.size(); s++)
+    {
+        model.loadCoeffs(coeffs_ref[s], n_coeffs);
+        batch.loadCoeffs(s, model_batch);
+
+        Point<2, double> pos = {vd.getPos(s)[0], vd.getPos(s)[1]};
+        BOOST_REQUIRE_CLOSE(model_batch.eval(pos), model.eval(pos), 1e-6);
+    }
+}
+
+
 BOOST_AUTO_TEST_SUITE_END()
@@ -6,6 +6,9 @@
 #define SPHERICALHARMONICS_HPP_
 //#include "util/util_debug.hpp"
 #include <boost/math/special_functions/spherical_harmonic.hpp>
+#include <unordered_map>
+#include <vector>
+#include <cmath>
 
 //type used for dictionary arguments of a spherical harmonic coordinates
 typedef std::tuple <int, int> lm;
@@ -235,6 +238,224 @@ namespace openfpm {
         }
     }
 
+    /*! \brief Index of the mode l,m (-l <= m <= l) in the arrays of SphericalHarmonicsBatch
+     *
+     *  The modes are stored by l and, for every l, from m=-l to m=l
+     *
+     */
+    inline size_t sph_index(int l, int m) {
+        return l*l + l + m;
+    }
+
+    /*! \brief Copy the amplitudes of a dictionary in an array ordered with sph_index
+     *
+     *  \param V Dictionary of amplitudes with arguments l,m (missing modes are zero)
+     *  \param l_max maximum l
+     *
+     *  \return the array of the amplitudes
+     *
+     */
+    inline std::vector<double> sph_coefficients(const std::unordered_map<const lm,double,key_hash,key_equal> &V, unsigned int l_max) {
+        std::vector<double> c((l_max+1)*(l_max+1),0.0);
+        for (int l = 0; l <= (int)l_max; l++) {
+            for (int m = -l; m <= l; m++) {
+                auto E = V.find(std::make_tuple(l,m));
+                if (E != V.end())
+                    c[sph_index(l,m)] = E->second;
+            }
+        }
+        return c;
+    }
+
+    /*! \brief Evaluation of all the spherical harmonics up to l_max
+     *
+     *  It compute the same values of Y, DYdTheta and DYdPhi for every l <= l_max and -l <= m <= l in one pass. The
+     *  normalized associated Legendre functions are computed with the stable three terms recurrence in l (the
+     *  coefficients are tabulated once in the constructor, ordered as they are read), cos(m phi) and sin(m phi) are
+     *  computed once for every m with the angle addition formulas. The results are stored with sph_index.
+     *
+     * \code{.cpp}
+
+       openfpm::math::SphericalHarmonicsBatch<double> sph(K);
+       std::vector<double> Y(sph.size());
+
+       sph.eval(theta,phi,Y.data());
+       double v = Y[openfpm::math::sph_index(l,m)];
+
+     * \endcode
+     *
+     */
+    template<typename T>
+    class SphericalHarmonicsBatch {
+
+        //! maximum l
+        unsigned int l_max;
+
+        //! recurrence coefficients a_lm, in the order of tri_index
+        std::vector<T> A;
+
+        //! recurrence coefficients b_lm, in the order of tri_index
+        std::vector<T> B;
+
+        //! work buffers of eval(theta,phi,...)
+        std::vector<T> P, cm, sm;
+
+        //! index of l,m (0 <= m <= l) in the table of the Legendre functions
+        static size_t tri_index(unsigned int l, unsigned int m) {
+            return l*(l+1)/2 + m;
+        }
+
+        /*! \brief Normalized associated Legendre functions
+         *
+         *  P[tri_index(l,m)] = sqrt((2l+1)/(4 pi) (l-m)!/(l+m)!) P_l^m(cos(theta)), with the Condon-Shortley phase as
+         *  boost::math::legendre_p
+         *
+         */
+        void legendre(T x, T st, T * P) const {
+            P[0] = sqrt(1.0 / (4.0 * boost::math::constants::pi<T>()));
+
+            for (unsigned int m = 0; m <= l_max; m++) {
+                size_t mm = tri_index(m,m);
+
+                if (m > 0)
+                    P[mm] = -sqrt((2.0*m + 1.0) / (2.0*m)) * st * P[tri_index(m-1,m-1)];
+                if (m + 1 <= l_max)
+                    P[tri_index(m+1,m)] = sqrt(2.0*m + 3.0) * x * P[mm];
+
+                for (unsigned int l = m + 2; l <= l_max; l++) {
+                    size_t i = tri_index(l,m);
+                    P[i] = A[i] * (x * P[tri_index(l-1,m)] - B[i] * P[tri_index(l-2,m)]);
+                }
+            }
+        }
+
+        //! cos(m phi) and sin(m phi) for 0 <= m <= l_max
+        void trig(T phi, T * cm, T * sm) const {
+            T c = cos(phi);
+            T s = sin(phi);
+
+            cm[0] = 1.0;
+            sm[0] = 0.0;
+            for (unsigned int m = 1; m <= l_max; m++) {
+                cm[m] = cm[m-1]*c - sm[m-1]*s;
+                sm[m] = sm[m-1]*c + cm[m-1]*s;
+            }
+        }
+
+        //! Combine the Legendre functions and the trigonometric terms
+        void combine(const T * P, const T * cm, const T * sm, T * Y, T * dYdTheta, T * dYdPhi) const {
+            const T sq2 = sqrt(2.0);
+
+            for (int l = 0; l <= (int)l_max; l++) {
+                for (int m = -l; m <= l; m++) {
+                    int am = abs(m);
+
+                    // negative odd m use sin(|m| phi), as Y
+                    bool sign = (m < 0) && (am & 1);
+                    T leg = P[tri_index(l,am)];
+                    T c = sign ? sm[am] : cm[am];
+                    T f = (am != 0) ? sq2 : 1.0;
+                    size_t k = sph_index(l,m);
+
+                    if (Y != NULL)
+                        Y[k] = f * leg * c;
+
+                    if (dYdTheta != NULL) {
+                        T dleg;
+                        if (am == 0)
+                            dleg = (l > 0) ? sqrt(T(l*(l+1))) * P[tri_index(l,1)] : 0.0;
+                        else {
+                            T lp = (am < l) ? sqrt(T((l-am)*(l+am+1))) * P[tri_index(l,am+1)] : 0.0;
+                            T lm = sqrt(T((l+am)*(l-am+1))) * P[tri_index(l,am-1)];
+                            dleg = 0.5 * (lp - lm);
+                        }
+                        dYdTheta[k] = f * dleg * c;
+                    }
+
+                    if (dYdPhi != NULL)
+                        dYdPhi[k] = (am == 0) ? 0.0 : (sign ? am * sq2 * leg * cm[am] : -am * sq2 * leg * sm[am]);
+                }
+            }
+        }
+
+    public:
+
+        /*! \brief Constructor
+         *
+         *  \param l_max maximum l
+         *
+         */
+        SphericalHarmonicsBatch(unsigned int l_max)
+        :l_max(l_max),A(tri_index(l_max,l_max)+1),B(tri_index(l_max,l_max)+1),P(tri_index(l_max,l_max)+1),cm(l_max+1),sm(l_max+1) {
+            for (unsigned int m = 0; m <= l_max; m++) {
+                for (unsigned int l = m + 2; l <= l_max; l++) {
+                    T l2 = T(l)*l;
+                    T m2 = T(m)*m;
+                    A[tri_index(l,m)] = sqrt((4.0*l2 - 1.0) / (l2 - m2));
+                    B[tri_index(l,m)] = sqrt(((l-1.0)*(l-1.0) - m2) / (4.0*(l-1.0)*(l-1.0) - 1.0));
+                }
+            }
+        }
+
+        //! maximum l
+        unsigned int getLMax() const {
+            return l_max;
+        }
+
+        //! number of modes (l_max+1)^2, size of the arrays of one point
+        size_t size() const {
+            return (l_max+1)*(l_max+1);
+        }
+
+        /*! \brief Evaluate all the modes in one point
+         *
+         *  \param theta Polar coordinate theta between 0 and Pi
+         *  \param phi Polar coordinate phi between -Pi and Pi
+         *  \param Y output Y (size() values), NULL to skip it
+         *  \param dYdTheta output DYdTheta (size() values), NULL to skip it
+         *  \param dYdPhi output DYdPhi (size() values), NULL to skip it
+         *
+         */
+        void eval(T theta, T phi, T * Y, T * dYdTheta = NULL, T * dYdPhi = NULL) {
+            legendre(cos(theta),sin(theta),P.data());
+            trig(phi,cm.data(),sm.data());
+            combine(P.data(),cm.data(),sm.data(),Y,dYdTheta,dYdPhi);
+        }
+
+        /*! \brief Evaluate all the modes in n points (in parallel with OpenMP)
+         *
+         *  The values of the point i are stored from i*size()
+         *
+         *  \param n number of points
+         *  \param theta theta of the points
+         *  \param phi phi of the points
+         *  \param Y output Y (n*size() values), NULL to skip it
+         *  \param dYdTheta output DYdTheta (n*size() values), NULL to skip it
+         *  \param dYdPhi output DYdPhi (n*size() values), NULL to skip it
+         *
+         */
+        void eval(size_t n, const T * theta, const T * phi, T * Y, T * dYdTheta = NULL, T * dYdPhi = NULL) const {
+            size_t sz = size();
+
+#ifdef _OPENMP
+            #pragma omp parallel
+#endif
+            {
+                std::vector<T> P_(tri_index(l_max,l_max)+1), cm_(l_max+1), sm_(l_max+1);
+
+#ifdef _OPENMP
+                #pragma omp for schedule(static)
+#endif
+                for (long int i = 0; i < (long int)n; i++) {
+                    legendre(cos(theta[i]),sin(theta[i]),P_.data());
+                    trig(phi[i],cm_.data(),sm_.data());
+                    combine(P_.data(),cm_.data(),sm_.data(),(Y != NULL) ? Y + i*sz : NULL,
+                            (dYdTheta != NULL) ? dYdTheta + i*sz : NULL,(dYdPhi != NULL) ? dYdPhi + i*sz : NULL);
+                }
+            }
+        }
+    };
+
     /*! \brief Returns Stokes Solution Amplitudes for Spherical Harmonics modes l,m
      *
      *  \param nu viscosity for nu*Lap(v)=Grad(P)
@@ -270,6 +491,40 @@ namespace openfpm {
          return {ur,u1,u2,p};
         }
 
+        /*! \brief Cartesian components of a vector spherical harmonic summation (used by sumY)
+         *
+         *  \param coeff function returning the amplitudes (vr,v1,v2) of the mode with index sph_index(l,m)
+         *
+         */
+        template<unsigned int k, typename coeff_type>
+        std::vector<double> sumY_impl(double theta, double phi, coeff_type coeff) {
+            static thread_local SphericalHarmonicsBatch<double> sph(k);
+            static thread_local std::vector<double> Y(sph.size()), DYdTheta(sph.size()), DYdPhi(sph.size());
+
+            sph.eval(theta,phi,Y.data(),DYdTheta.data(),DYdPhi.data());
+
+            double Sum1 = 0.0;
+            double Sum2 = 0.0;
+            double Sum3 = 0.0;
+            double st = sin(theta);
+            for (int l = 0; l <= k; l++) {
+                for (int m = -l; m <= l; m++) {
+                    size_t i = sph_index(l,m);
+                    double vr,v1,v2;
+                    coeff(l,m,i,vr,v1,v2);
+
+                    Sum1 += vr * Y[i];
+                    Sum2 += v1 * DYdTheta[i] - v2 / st * DYdPhi[i];
+                    Sum3 += v2 * DYdTheta[i] + v1 / st * DYdPhi[i];
+                }
+            }
+            double x=Sum2*cos(theta)*cos(phi)-Sum3*sin(phi)+Sum1*cos(phi)*st;
+            double y=Sum3*cos(phi)+Sum2*cos(theta)*sin(phi)+Sum1*sin(phi)*st;
+            double z=Sum1*cos(theta)-Sum2*st;
+
+            return {x,y,z};
+        }
+
         /*! \brief Conversion from Vector spherical Harmonic basis to Cartesian basis
          *
          *  \param r Polar coordinate radius
@@ -283,48 +538,33 @@ namespace openfpm {
          */
         template<unsigned int k>
         std::vector<double> sumY(double r, double theta, double phi,const std::unordered_map<const lm,double,key_hash,key_equal> &Vr,const std::unordered_map<const lm,double,key_hash,key_equal> &V1,const std::unordered_map<const lm,double,key_hash,key_equal> &V2) {
-        double Sum1 = 0.0;
-        double Sum2 = 0.0;
-        double Sum3 = 0.0;
-        for (int l = 0; l <= k; l++) {
-            for (int m = -l; m <= l; m++) {
-                auto Er= Vr.find(std::make_tuple(l,m));
-                auto E1= V1.find(std::make_tuple(l,m));
-                auto E2= V2.find(std::make_tuple(l,m));
-                Sum1 += Er->second * openfpm::math::Y(l, m, theta, phi);
-                double DYdPhi=openfpm::math::DYdPhi(l, m, theta, phi);
-                double DYdTheta=openfpm::math::DYdTheta(l, m, theta, phi);
-                /*if (DYdPhi==0 ||E2->second==0){
-                    Sum2 += E1->second * DYdTheta;
-                }
-                else{*/
-                //assert(theta!=0);
-                Sum2 += E1->second * DYdTheta -
-                                E2->second / sin(theta) * DYdPhi;
-                /*}*/
-                Sum3 += E2->second * DYdTheta +
-                        E1->second/sin(theta) * DYdPhi;
-
-           /*     Sum3 += E2->second *sin(theta)* DYdTheta +
-                        E1->second * DYdPhi;*/
-
-               /*if (DYdPhi==0 ||E1->second==0){
-                        Sum3 += E2->second * DYdTheta;
-                    }
-                else{
-                    Sum3 += E2->second * DYdTheta +
-                            E1->second/sin(theta) * DYdPhi;
-                }*/
-
-            }
+            return sumY_impl<k>(theta,phi,[&](int l, int m, size_t i, double & vr, double & v1, double & v2) {
+                vr = Vr.find(std::make_tuple(l,m))->second;
+                v1 = V1.find(std::make_tuple(l,m))->second;
+                v2 = V2.find(std::make_tuple(l,m))->second;
+            });
         }
-        double x=Sum2*cos(theta)*cos(phi)-Sum3*sin(phi)+Sum1*cos(phi)*sin(theta);
-        double y=Sum3*cos(phi)+Sum2*cos(theta)*sin(phi)+Sum1*sin(phi)*sin(theta);
-        double z=Sum1*cos(theta)-Sum2*sin(theta);
 
-        return {x,y,z};
+        /*! \brief Conversion from Vector spherical Harmonic basis to Cartesian basis
+         *
+         *  \param r Polar coordinate radius
+         *  \param theta Polar coordinate theta between 0 and Pi
+         *  \param phi Polar coordinate phi between -Pi and Pi
+         *  \param Vr amplitudes of Y^hat ordered with sph_index (see sph_coefficients)
+         *  \param V1 amplitudes of Psi^hat ordered with sph_index
+         *  \param V2 amplitudes of Phi^hat ordered with sph_index
+         *  \return std::vector containing the cartesian coordinates corresponding to vector basis summation.
+         *
+         */
+        template<unsigned int k>
+        std::vector<double> sumY(double r, double theta, double phi,const std::vector<double> &Vr,const std::vector<double> &V1,const std::vector<double> &V2) {
+            return sumY_impl<k>(theta,phi,[&](int l, int m, size_t i, double & vr, double & v1, double & v2) {
+                vr = Vr[i];
+                v1 = V1[i];
+                v2 = V2[i];
+            });
+        }
 
-    }
         /*! \brief Conversion from Scalar spherical Harmonic basis to Cartesian basis
          *
          *  \param r viscosity for nu*Lap(v)=Grad(P)
@@ -336,17 +576,45 @@ namespace openfpm {
          */
         template<unsigned int k>
         double sumY_Scalar(double r, double theta, double phi,const std::unordered_map<const lm,double,key_hash,key_equal> &Vr) {
+            static thread_local SphericalHarmonicsBatch<double> sph(k);
+            static thread_local std::vector<double> Y(sph.size());
+
+            sph.eval(theta,phi,Y.data());
+
             double Sum1 = 0.0;
             for (int l = 0; l <= k; l++) {
                 for (int m = -l; m <= l; m++) {
                     auto Er= Vr.find(std::make_tuple(l,m));
-                    Sum1 += Er->second * openfpm::math::Y(l, m, theta, phi);
+                    Sum1 += Er->second * Y[sph_index(l,m)];
                 }
             }
             return Sum1;
 
         }
 
+        /*! \brief Conversion from Scalar spherical Harmonic basis to Cartesian basis
+         *
+         *  \param r Polar coordinate radius
+         *  \param theta Polar coordinate theta between 0 and Pi
+         *  \param phi Polar coordinate phi between -Pi and Pi
+         *  \param Vr amplitudes of Y^hat ordered with sph_index (see sph_coefficients)
+         *  \return double containing the cartesian coordinate corresponding to scalar basis summation.
+         *
+         */
+        template<unsigned int k>
+        double sumY_Scalar(double r, double theta, double phi,const std::vector<double> &Vr) {
+            static thread_local SphericalHarmonicsBatch<double> sph(k);
+            static thread_local std::vector<double> Y(sph.size());
+
+            sph.eval(theta,phi,Y.data());
+
+            double Sum1 = 0.0;
+            for (size_t i = 0; i < sph.size(); i++)
+                Sum1 += Vr[i] * Y[i];
+
+            return Sum1;
+        }
+
 /*        double PsiTheta(unsigned l, int m, double theta, double phi) {
             return DYdTheta(l, m, theta, phi);
         }
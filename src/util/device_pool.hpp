@@ -0,0 +1,294 @@
+/*
+ * device_pool.hpp
+ *
+ * Stream ordered pool of device memory for the temporary buffers of the numerics
+ */
+
+#ifndef OPENFPM_NUMERICS_SRC_UTIL_DEVICE_POOL_HPP_
+#define OPENFPM_NUMERICS_SRC_UTIL_DEVICE_POOL_HPP_
+
+#if defined(__NVCC__) && !defined(CUDA_ON_CPU)
+
+#include <cuda_runtime.h>
+#include <cstdint>
+#include <iostream>
+#include <mutex>
+#include <unordered_map>
+#include "initialize/numerics_backends.hpp"
+
+/*! \brief Pool of device memory shared by the GPU code of the numerics
+ *
+ * The buffers are allocated and freed stream ordered (cudaMallocFromPoolAsync / cudaFreeAsync) on a memory pool of
+ * the device whose release threshold is infinite: the memory freed stays in the pool and the next allocations of the
+ * same size are served from it, without the device synchronization and the fragmentation of cudaMalloc/cudaFree
+ * around every operator update. The allocations are also recorded by the stream capture of gpu_step_graph.
+ * The memory goes back to the device only with trim(). On devices without memory pools it falls back to cudaMalloc
+ *
+ * \code{.cpp}
+
+   device_pool & pool = device_pool::instance();
+   double * tmp = (double *)pool.allocate(n*sizeof(double));
+   ...
+   pool.release(tmp);
+
+   std::cout << pool.getHighWater() << std::endl;
+
+ * \endcode
+ *
+ * getMemoryUsage() returns the memory reserved by the pool, so it can be added to a memory_report
+ *
+ */
+class device_pool
+{
+	//! memory pool
+	cudaMemPool_t pool;
+
+	//! the pool has been initialized
+	bool ready = false;
+
+	//! the device support stream ordered allocations
+	bool async = false;
+
+	//! size of the live allocations
+	std::unordered_map<void *,size_t> sizes;
+
+	//! protect the statistics (allocations from the OpenMP threads)
+	std::mutex mtx;
+
+	//! memory of the live allocations
+	size_t in_use = 0;
+
+	//! maximum of in_use
+	size_t high_water = 0;
+
+	//! number of allocations
+	size_t n_alloc = 0;
+
+	device_pool()
+	{}
+
+	//! Create the pool on the current device
+	void init()
+	{
+		numerics_backends::ensure_device();
+
+		int device;
+		cudaGetDevice(&device);
+
+		int supported = 0;
+		cudaDeviceGetAttribute(&supported,cudaDevAttrMemoryPoolsSupported,device);
+
+		if (supported != 0)
+		{
+			cudaMemPoolProps props = {};
+			props.allocType = cudaMemAllocationTypePinned;
+			props.handleTypes = cudaMemHandleTypeNone;
+			props.location.type = cudaMemLocationTypeDevice;
+			props.location.id = device;
+
+			if (cudaMemPoolCreate(&pool,&props) == cudaSuccess)
+			{
+				// keep the freed memory in the pool
+				uint64_t threshold = UINT64_MAX;
+				cudaMemPoolSetAttribute(pool,cudaMemPoolAttrReleaseThreshold,&threshold);
+				async = true;
+			}
+		}
+
+		ready = true;
+	}
+
+public:
+
+	device_pool(const device_pool &) = delete;
+	device_pool & operator=(const device_pool &) = delete;
+
+	//! The pool of the process (the pool is not destroyed, the memory is given back at the exit)
+	static device_pool & instance()
+	{
+		static device_pool p;
+
+		return p;
+	}
+
+	/*! \brief Allocate a device buffer ordered on a stream
+	 *
+	 * \param bytes size of the buffer
+	 * \param stream the buffer can be used by the work submitted on stream after this call
+	 *
+	 * \return the device pointer (NULL if the allocation failed)
+	 *
+	 */
+	void * allocate(size_t bytes, cudaStream_t stream = 0)
+	{
+		std::lock_guard<std::mutex> lock(mtx);
+
+		if (ready == false)
+		{init();}
+
+		void * ptr = NULL;
+		cudaError_t err = (async == true)?cudaMallocFromPoolAsync(&ptr,bytes,pool,stream):cudaMalloc(&ptr,bytes);
+
+		if (err != cudaSuccess)
+		{
+			std::cerr << __FILE__ << ":" << __LINE__ << " error, allocating " << bytes << " byte on the device failed: " << cudaGetErrorString(err) << std::endl;
+			return NULL;
+		}
+
+		sizes[ptr] = bytes;
+		in_use += bytes;
+		high_water = (in_use > high_water)?in_use:high_water;
+		n_alloc++;
+
+		return ptr;
+	}
+
+	/*! \brief Give back a buffer to the pool, ordered on a stream
+	 *
+	 * \param ptr buffer obtained with allocate
+	 * \param stream the buffer is reused only after the work submitted on stream before this call
+	 *
+	 */
+	void release(void * ptr, cudaStream_t stream = 0)
+	{
+		if (ptr == NULL)
+		{return;}
+
+		std::lock_guard<std::mutex> lock(mtx);
+
+		auto it = sizes.find(ptr);
+		if (it == sizes.end())
+		{
+			std::cerr << __FILE__ << ":" << __LINE__ << " error, the buffer has not been allocated by the device_pool" << std::endl;
+			return;
+		}
+
+		in_use -= it->second;
+		sizes.erase(it);
+
+		if (async == true)
+		{cudaFreeAsync(ptr,stream);}
+		else
+		{cudaFree(ptr);}
+	}
+
+	/*! \brief Give back to the device the memory of the pool not in use
+	 *
+	 * \param keep memory to keep in the pool
+	 *
+	 */
+	void trim(size_t keep = 0)
+	{
+		std::lock_guard<std::mutex> lock(mtx);
+
+		if (async == true)
+		{
+			cudaDeviceSynchronize();
+			cudaMemPoolTrimTo(pool,keep);
+		}
+	}
+
+	//! memory of the live buffers
+	size_t getInUse() const
+	{
+		return in_use;
+	}
+
+	//! maximum memory of the live buffers (since the start or the last resetHighWater)
+	size_t getHighWater() const
+	{
+		return high_water;
+	}
+
+	//! number of allocations
+	size_t getNAllocations() const
+	{
+		return n_alloc;
+	}
+
+	//! memory reserved by the pool on the device (live buffers and cached memory)
+	size_t getReserved() const
+	{
+		if (async == false)
+		{return in_use;}
+
+		uint64_t res = 0;
+		cudaMemPoolGetAttribute(pool,cudaMemPoolAttrReservedMemCurrent,&res);
+
+		return res;
+	}
+
+	//! memory used on the device (for memory_report)
+	size_t getMemoryUsage() const
+	{
+		return getReserved();
+	}
+
+	//! Restart the high water mark from the memory in use
+	void resetHighWater()
+	{
+		std::lock_guard<std::mutex> lock(mtx);
+
+		high_water = in_use;
+	}
+};
+
+/*! \brief Device buffer allocated from the device_pool, it grows and never shrinks
+ *
+ * \tparam T type of the elements
+ *
+ */
+template<typename T>
+class device_pool_buffer
+{
+	//! device pointer
+	T * ptr = NULL;
+
+	//! allocated elements
+	size_t sz = 0;
+
+	//! stream the buffer is ordered on
+	cudaStream_t stream;
+
+public:
+
+	device_pool_buffer(cudaStream_t stream = 0)
+	:stream(stream)
+	{}
+
+	device_pool_buffer(const device_pool_buffer &) = delete;
+	device_pool_buffer & operator=(const device_pool_buffer &) = delete;
+
+	~device_pool_buffer()
+	{
+		device_pool::instance().release(ptr,stream);
+	}
+
+	//! Make space for n elements, the content is lost if it grows
+	T * resize(size_t n)
+	{
+		if (n > sz)
+		{
+			device_pool::instance().release(ptr,stream);
+			ptr = (T *)device_pool::instance().allocate(n*sizeof(T),stream);
+			sz = (ptr != NULL)?n:0;
+		}
+		return ptr;
+	}
+
+	//! device pointer
+	T * get()
+	{
+		return ptr;
+	}
+
+	//! allocated elements
+	size_t capacity() const
+	{
+		return sz;
+	}
+};
+
+#endif
+
+#endif /* OPENFPM_NUMERICS_SRC_UTIL_DEVICE_POOL_HPP_ */
@@ -0,0 +1,57 @@
+/*
+ * device_pool_unit_tests.cu
+ *
+ * Tests of the device memory pool
+ */
+
+#include "config.h"
+
+#define BOOST_TEST_DYN_LINK
+#include <boost/test/unit_test.hpp>
+
+#include "util/device_pool.hpp"
+
+BOOST_AUTO_TEST_SUITE( device_pool_test_suite )
+
+BOOST_AUTO_TEST_CASE(device_pool_high_water)
+{
+#if defined(__NVCC__) && !defined(CUDA_ON_CPU)
+
+	device_pool & pool = device_pool::instance();
+
+	size_t in_use = pool.getInUse();
+	pool.resetHighWater();
+
+	void * a = pool.allocate(1024*1024);
+	void * b = pool.allocate(2*1024*1024);
+	BOOST_REQUIRE(a != NULL);
+	BOOST_REQUIRE(b != NULL);
+	BOOST_REQUIRE_EQUAL(pool.getInUse(),in_use + 3*1024*1024);
+
+	pool.release(a);
+	pool.release(b);
+	BOOST_REQUIRE_EQUAL(pool.getInUse(),in_use);
+	BOOST_REQUIRE_EQUAL(pool.getHighWater(),in_use + 3*1024*1024);
+
+	// the freed memory stays in the pool for the next allocations
+	BOOST_REQUIRE(pool.getReserved() >= in_use);
+
+	{
+		device_pool_buffer<double> buf;
+		double * p = buf.resize(100);
+		BOOST_REQUIRE(p != NULL);
+		BOOST_REQUIRE(buf.resize(50) == p);
+		BOOST_REQUIRE_EQUAL(buf.capacity(),100ul);
+
+		cudaMemset(p,0,100*sizeof(double));
+		BOOST_REQUIRE_EQUAL(cudaDeviceSynchronize(),cudaSuccess);
+	}
+
+	BOOST_REQUIRE_EQUAL(pool.getInUse(),in_use);
+
+	pool.trim();
+
+#endif
+}
+
+BOOST_AUTO_TEST_SUITE_END()
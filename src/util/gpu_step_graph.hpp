@@ -0,0 +1,206 @@
+/*
+ * gpu_step_graph.hpp
+ *
+ * Capture the device launches of a time step in a CUDA (or HIP) graph and replay them
+ */
+
+#ifndef OPENFPM_NUMERICS_SRC_UTIL_GPU_STEP_GRAPH_HPP_
+#define OPENFPM_NUMERICS_SRC_UTIL_GPU_STEP_GRAPH_HPP_
+
+#include <functional>
+#include <iostream>
+
+// the launches without a stream are captured only when they go to the per-thread default stream
+#if defined(__NVCC__) && !defined(CUDA_ON_CPU) && (defined(CUDA_API_PER_THREAD_DEFAULT_STREAM) || defined(HIP_API_PER_THREAD_DEFAULT_STREAM))
+#define OPENFPM_GPU_STEP_GRAPH
+
+#ifdef __HIP__
+#include <hip/hip_runtime.h>
+typedef hipGraph_t gpu_graph_t;
+typedef hipGraphExec_t gpu_graph_exec_t;
+typedef hipStream_t gpu_stream_t;
+typedef hipError_t gpu_error_t;
+#define GPU_GRAPH_SUCCESS hipSuccess
+#define GPU_GRAPH_STREAM hipStreamPerThread
+#define gpuGraphBeginCapture(s) hipStreamBeginCapture(s,hipStreamCaptureModeThreadLocal)
+#define gpuGraphEndCapture hipStreamEndCapture
+#define gpuGraphInstantiate(e,g) hipGraphInstantiate(e,g,NULL,NULL,0)
+#define gpuGraphLaunch hipGraphLaunch
+#define gpuGraphDestroy hipGraphDestroy
+#define gpuGraphExecDestroy hipGraphExecDestroy
+#define gpuGraphGetLastError hipGetLastError
+#define gpuGraphStreamSynchronize hipStreamSynchronize
+#else
+#include <cuda_runtime.h>
+typedef cudaGraph_t gpu_graph_t;
+typedef cudaGraphExec_t gpu_graph_exec_t;
+typedef cudaStream_t gpu_stream_t;
+typedef cudaError_t gpu_error_t;
+#define GPU_GRAPH_SUCCESS cudaSuccess
+#define GPU_GRAPH_STREAM cudaStreamPerThread
+#define gpuGraphBeginCapture(s) cudaStreamBeginCapture(s,cudaStreamCaptureModeThreadLocal)
+#define gpuGraphEndCapture cudaStreamEndCapture
+#define gpuGraphInstantiate(e,g) cudaGraphInstantiate(e,g,NULL,NULL,0)
+#define gpuGraphLaunch cudaGraphLaunch
+#define gpuGraphDestroy cudaGraphDestroy
+#define gpuGraphExecDestroy cudaGraphExecDestroy
+#define gpuGraphGetLastError cudaGetLastError
+#define gpuGraphStreamSynchronize cudaStreamSynchronize
+#endif
+
+#endif
+
+/*! \brief Record the device launches of a time step once and replay them as one graph
+ *
+ * At the first run the step is executed under stream capture: its kernel launches (DCPSE applications, the
+ * expressions of vector_dist_operators_cuda.cuh, the ODE algebra of vector_algebra_ofp_gpu.hpp, ...) are
+ * recorded in a graph, which is then launched. The next runs launch only the graph, paying one launch instead
+ * of one for every kernel.
+ *
+ * \code
+ *
+ * gpu_step_graph step([&]() {
+ *     Dx.computeDifferentialOperatorGPU<0,1>(particles);
+ *     Dy.computeDifferentialOperatorGPU<0,2>(particles);
+ *     P = 0.5*(dFx + dFy);
+ * });
+ *
+ * for (size_t t = 0 ; t < nSteps ; t++)
+ * {
+ *     particles.ghost_get<0>();
+ *     step.run();
+ * }
+ *
+ * \endcode
+ *
+ * The launches are recorded on the per-thread default stream, so the code must be compiled with
+ * --default-stream per-thread. The step must be device-only: no host copies, synchronisations (a CUDA_LAUNCH
+ * compiled with the debug checks synchronises), MPI or ghost exchange; these stay between the runs. A graph
+ * keeps the arguments of the kernels as they were at the capture: the buffers must not be reallocated and the
+ * scalar arguments (for example a time step passed by value) must not change. Call invalidate() after a map,
+ * a ghost_get that changes the number of ghost particles, an operator update or a change of the scalars, the
+ * next run captures again.
+ *
+ * When the capture fails (for example a synchronisation in the step) the step is run directly at every run, and
+ * a warning is printed once. Without a device backend, or with the legacy default stream, the step is always
+ * run directly.
+ *
+ */
+class gpu_step_graph
+{
+	//! launches of one step
+	std::function<void()> step;
+
+	//! the step is replayed from the graph
+	bool captured = false;
+
+	//! the capture failed, the step is run directly
+	bool direct = false;
+
+#ifdef OPENFPM_GPU_STEP_GRAPH
+
+	gpu_graph_t graph;
+	gpu_graph_exec_t exec;
+
+	//! capture the step and instantiate the graph, false if the capture failed
+	bool capture()
+	{
+		if (gpuGraphBeginCapture(GPU_GRAPH_STREAM) != GPU_GRAPH_SUCCESS)
+		{
+			gpuGraphGetLastError();
+			return false;
+		}
+
+		step();
+
+		gpu_error_t err = gpuGraphEndCapture(GPU_GRAPH_STREAM,&graph);
+		if (err != GPU_GRAPH_SUCCESS)
+		{
+			gpuGraphGetLastError();
+			return false;
+		}
+
+		if (gpuGraphInstantiate(&exec,graph) != GPU_GRAPH_SUCCESS)
+		{
+			gpuGraphGetLastError();
+			gpuGraphDestroy(graph);
+			return false;
+		}
+
+		return true;
+	}
+
+#endif
+
+public:
+
+	/*! \brief Constructor
+	 *
+	 * \param step launches of one time step, nothing is captured before the first run
+	 *
+	 */
+	gpu_step_graph(std::function<void()> step)
+	:step(step)
+	{}
+
+	~gpu_step_graph()
+	{
+		invalidate();
+	}
+
+	//! Run the step: the first run captures it, the next ones replay it
+	void run()
+	{
+#ifdef OPENFPM_GPU_STEP_GRAPH
+
+		if (captured == false && direct == false)
+		{
+			captured = capture();
+			if (captured == false)
+			{
+				direct = true;
+				std::cerr << __FILE__ << ":" << __LINE__ << " warning, the step cannot be captured in a graph, it is run without graph" << std::endl;
+			}
+		}
+
+		if (captured == true)
+		{
+			gpuGraphLaunch(exec,GPU_GRAPH_STREAM);
+			return;
+		}
+
+#endif
+
+		step();
+	}
+
+	//! Wait the end of the last replay of the graph
+	void synchronize()
+	{
+#ifdef OPENFPM_GPU_STEP_GRAPH
+		gpuGraphStreamSynchronize(GPU_GRAPH_STREAM);
+#endif
+	}
+
+	//! Drop the graph, the next run captures the step again
+	void invalidate()
+	{
+#ifdef OPENFPM_GPU_STEP_GRAPH
+		if (captured == true)
+		{
+			gpuGraphExecDestroy(exec);
+			gpuGraphDestroy(graph);
+		}
+#endif
+		captured = false;
+		direct = false;
+	}
+
+	//! true if the step is replayed from a graph
+	bool isCaptured() const
+	{
+		return captured;
+	}
+};
+
+#endif /* OPENFPM_NUMERICS_SRC_UTIL_GPU_STEP_GRAPH_HPP_ */
@@ -0,0 +1,186 @@
+/*
+ * memory_report.hpp
+ *
+ * Memory used by the operators, schemes and solvers, reduced across the processors
+ */
+
+#ifndef OPENFPM_NUMERICS_SRC_UTIL_MEMORY_REPORT_HPP_
+#define OPENFPM_NUMERICS_SRC_UTIL_MEMORY_REPORT_HPP_
+
+#include <iostream>
+#include <iomanip>
+#include <string>
+#include <vector>
+#include "VCluster/VCluster.hpp"
+
+/*! \brief Memory used by the local grids of a distributed grid in byte (ghost included)
+ *
+ * \param gd distributed grid
+ *
+ * \return the memory in byte
+ *
+ */
+template<typename grid_type>
+size_t gridMemoryUsage(grid_type & gd)
+{
+	size_t n = 0;
+	for (size_t i = 0 ; i < gd.getN_loc_grid() ; i++)
+	{n += gd.get_loc_grid(i).size();}
+
+	return n*sizeof(typename grid_type::value_type);
+}
+
+/*! \brief Memory used by the positions and the properties of a particle set in byte (ghost included)
+ *
+ * \param vd particle set
+ *
+ * \return the memory in byte
+ *
+ */
+template<typename vector_type>
+size_t particlesMemoryUsage(vector_type & vd)
+{
+	return vd.getPosVector().size()*sizeof(Point<vector_type::dims,typename vector_type::stype>)
+	       + vd.getPropVector().size()*sizeof(typename vector_type::value_type);
+}
+
+/*! \brief Table of the memory used by named objects, reduced across the processors
+ *
+ * Every processor adds the same entries in the same order, print() reduces them with one execute and the
+ * processor 0 prints the minimum, the average, the maximum and the total across the processors
+ *
+ * \code{.cpp}
+
+   memory_report rep;
+   rep.add("Dx",Dx.getMemoryUsage(particles));
+   rep.add("Solver",solver);       // any object with getMemoryUsage()
+   rep.add("particles",particlesMemoryUsage(particles));
+   rep.print();
+
+ * \endcode
+ *
+ */
+class memory_report
+{
+	//! name of the entries
+	std::vector<std::string> names;
+
+	//! memory of the entries on this processor
+	std::vector<size_t> local;
+
+	//! minimum across the processors (after reduce)
+	std::vector<size_t> mem_min;
+
+	//! maximum across the processors (after reduce)
+	std::vector<size_t> mem_max;
+
+	//! sum across the processors (after reduce)
+	std::vector<size_t> mem_sum;
+
+	//! number of processors of the last reduction
+	size_t n_proc = 1;
+
+public:
+
+	/*! \brief Add an entry
+	 *
+	 * \param name name of the entry
+	 * \param bytes memory used on this processor
+	 *
+	 */
+	void add(const std::string & name, size_t bytes)
+	{
+		names.push_back(name);
+		local.push_back(bytes);
+	}
+
+	/*! \brief Add an object with getMemoryUsage()
+	 *
+	 * \param name name of the entry
+	 * \param obj object
+	 *
+	 */
+	template<typename T>
+	void add(const std::string & name, const T & obj)
+	{
+		add(name,(size_t)obj.getMemoryUsage());
+	}
+
+	//! number of entries
+	size_t size() const
+	{
+		return names.size();
+	}
+
+	//! memory of the entry i on this processor
+	size_t getLocal(size_t i) const
+	{
+		return local[i];
+	}
+
+	//! memory of all the entries on this processor
+	size_t getLocalTotal() const
+	{
+		size_t t = 0;
+		for (size_t i = 0 ; i < local.size() ; i++)
+		{t += local[i];}
+
+		return t;
+	}
+
+	//! minimum, maximum and sum of the entry i across the processors (after reduce)
+	size_t getMin(size_t i) const {return mem_min[i];}
+	size_t getMax(size_t i) const {return mem_max[i];}
+	size_t getSum(size_t i) const {return mem_sum[i];}
+
+	/*! \brief Reduce the entries across the processors with one execute, it is collective
+	 *
+	 */
+	void reduce()
+	{
+		auto & v_cl = create_vcluster();
+
+		// the last entry is the total of the processor
+		mem_min = local;
+		mem_min.push_back(getLocalTotal());
+		mem_max = mem_min;
+		mem_sum = mem_min;
+
+		for (size_t i = 0 ; i < mem_min.size() ; i++)
+		{
+			v_cl.min(mem_min[i]);
+			v_cl.max(mem_max[i]);
+			v_cl.sum(mem_sum[i]);
+		}
+		v_cl.execute();
+
+		n_proc = v_cl.size();
+	}
+
+	/*! \brief Reduce the entries and print the table on processor 0, it is collective
+	 *
+	 * \param out stream
+	 *
+	 */
+	void print(std::ostream & out = std::cout)
+	{
+		reduce();
+
+		if (create_vcluster().rank() != 0)
+		{return;}
+
+		const double MB = 1024.0*1024.0;
+
+		out << std::left << std::setw(32) << "object" << std::right
+		    << std::setw(14) << "min [MB]" << std::setw(14) << "avg [MB]" << std::setw(14) << "max [MB]" << std::setw(14) << "total [MB]" << std::endl;
+
+		for (size_t i = 0 ; i < mem_min.size() ; i++)
+		{
+			out << std::left << std::setw(32) << ((i < names.size())?names[i]:std::string("all")) << std::right << std::fixed << std::setprecision(2)
+			    << std::setw(14) << mem_min[i] / MB << std::setw(14) << mem_sum[i] / MB / n_proc
+			    << std::setw(14) << mem_max[i] / MB << std::setw(14) << mem_sum[i] / MB << std::endl;
+		}
+	}
+};
+
+#endif /* OPENFPM_NUMERICS_SRC_UTIL_MEMORY_REPORT_HPP_ */
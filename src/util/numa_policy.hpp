@@ -0,0 +1,153 @@
+/*
+ * numa_policy.hpp
+ *
+ * Placement of the large numerics arrays on the NUMA domains of the threads that use them
+ */
+
+#ifndef OPENFPM_NUMERICS_SRC_UTIL_NUMA_POLICY_HPP_
+#define OPENFPM_NUMERICS_SRC_UTIL_NUMA_POLICY_HPP_
+
+#include <cstdint>
+#include "Vector/map_vector.hpp"
+
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
+#if defined(__linux__)
+#include <sys/mman.h>
+#include <unistd.h>
+#endif
+
+//! Huge pages for the arrays placed with a numa_policy
+enum class numa_huge_pages
+{
+	//! normal pages
+	NONE,
+
+	//! ask transparent huge pages for the array (madvise MADV_HUGEPAGE, Linux only)
+	TRANSPARENT
+};
+
+/*! \brief Allocation policy of the large arrays of the numerics (DCPSE kernels, offsets and supports)
+ *
+ * A page is placed on the NUMA domain of the thread that touches it first. The arrays filled by one thread end
+ * all on one domain, so with first_touch the arrays are copied in new memory by all the threads, each thread
+ * copying the rows it computes and applies: the loops over the rows use the static partition of chunk rows set by
+ * numa_set_schedule, and the rows stay on the domain of the thread that uses them. With huge pages the arrays
+ * are in 2MB pages when the system has transparent huge pages in madvise mode, fewer TLB misses on the random
+ * accesses of the supports
+ *
+ * \code{.cpp}
+
+   Dx.numaPolicy.first_touch = true;
+   Dx.numaPolicy.pages = numa_huge_pages::TRANSPARENT;
+   Dx.initializeUpdate(particles);
+
+ * \endcode
+ *
+ */
+struct numa_policy
+{
+	//! copy the arrays with the static partition of the threads
+	bool first_touch = false;
+
+	//! huge pages for the arrays
+	numa_huge_pages pages = numa_huge_pages::NONE;
+
+	//! rows in a chunk of the static partition
+	int chunk = 64;
+
+	//! Return true if the arrays are placed by the policy
+	bool active() const
+	{
+		return first_touch == true || pages != numa_huge_pages::NONE;
+	}
+};
+
+/*! \brief Set the schedule of the next loops with schedule(runtime) of this thread
+ *
+ * With first touch the rows are split statically in chunks as the arrays were placed, otherwise they are
+ * distributed dynamically
+ *
+ * \param pol policy
+ * \param dynChunk chunk of the dynamic schedule
+ *
+ */
+inline void numa_set_schedule(const numa_policy & pol, int dynChunk = 64)
+{
+#ifdef _OPENMP
+	if (pol.first_touch == true)
+	{omp_set_schedule(omp_sched_static,pol.chunk);}
+	else
+	{omp_set_schedule(omp_sched_dynamic,dynChunk);}
+#endif
+}
+
+/*! \brief Ask transparent huge pages for a memory region
+ *
+ * \param ptr start of the region
+ * \param bytes size of the region
+ *
+ */
+inline void numa_advise_huge_pages(void * ptr, size_t bytes)
+{
+#if defined(__linux__) && defined(MADV_HUGEPAGE)
+	uintptr_t page = sysconf(_SC_PAGESIZE);
+	uintptr_t start = ((uintptr_t)ptr + page - 1) / page * page;
+	uintptr_t stop = ((uintptr_t)ptr + bytes) / page * page;
+
+	if (stop > start)
+	{madvise((void *)start,stop - start,MADV_HUGEPAGE);}
+#endif
+}
+
+/*! \brief Move an array stored by rows in new memory placed by the policy
+ *
+ * The rows are copied with the static partition of numa_set_schedule, so every page goes on the domain of the
+ * thread that computes and applies its rows
+ *
+ * \param v array
+ * \param nRows number of rows
+ * \param rowOffset functor returning the offset in v of the first element of a row, for the rows from 0 to nRows
+ * \param pol policy
+ *
+ */
+template<typename T, typename offset_type>
+void numa_place_rows(openfpm::vector<T> & v, size_t nRows, offset_type rowOffset, const numa_policy & pol)
+{
+	if (pol.active() == false || v.size() == 0)
+	{return;}
+
+	openfpm::vector<T> placed;
+	placed.resize(v.size());
+
+	if (pol.pages == numa_huge_pages::TRANSPARENT)
+	{numa_advise_huge_pages(&placed.get(0),v.size()*sizeof(T));}
+
+	long int n = nRows;
+
+	#pragma omp parallel for schedule(static,pol.chunk) if(pol.first_touch)
+	for (long int r = 0 ; r < n ; r++)
+	{
+		size_t stop = rowOffset(r+1);
+		for (size_t i = rowOffset(r) ; i < stop ; i++)
+		{placed.get(i) = v.get(i);}
+	}
+
+	v.swap(placed);
+}
+
+/*! \brief Move an array with one element per row in new memory placed by the policy
+ *
+ * \param v array
+ * \param pol policy
+ *
+ */
+template<typename T>
+void numa_place(openfpm::vector<T> & v, const numa_policy & pol)
+{
+	numa_place_rows(v,v.size(),[](size_t r){return r;},pol);
+}
+
+#endif /* OPENFPM_NUMERICS_SRC_UTIL_NUMA_POLICY_HPP_ */
@@ -9,6 +9,7 @@
 #define PETSC_UTIL_HPP_
 
 #include <iostream>
+#include "initialize/numerics_backends.hpp"
 
 #define PETSC_SAFE_CALL(call) {\
 	PetscErrorCode err = call;\
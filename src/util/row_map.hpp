@@ -0,0 +1,126 @@
+/*
+ * row_map.hpp
+ *
+ *  Global numbering of the rows of a grid or a particle set, shared between schemes
+ */
+
+#ifndef OPENFPM_NUMERICS_SRC_UTIL_ROW_MAP_HPP_
+#define OPENFPM_NUMERICS_SRC_UTIL_ROW_MAP_HPP_
+
+#include <memory>
+#include <vector>
+
+/*! \brief Global numbering of the points of a grid or a particle set
+ *
+ * Each processor numbers its points with a contiguous range of global ids starting from s_pnt, the ids of the
+ * ghost points are the ones of their owners. It is built by FD_scheme (map = grid) or DCPSE_scheme (map = particles)
+ *
+ * \tparam map_type grid_dist_id or vector_dist that store the global id in the property 0
+ *
+ */
+template<typename map_type>
+struct row_map_data
+{
+	//! global id of the points (with ghost)
+	map_type map;
+
+	//! number of points of each processor
+	openfpm::vector<size_t> pnt;
+
+	//! first global id of this processor
+	size_t s_pnt = 0;
+
+	//! total number of points
+	size_t tot = 0;
+
+	//! geometry the map was built on
+	const void * geom = NULL;
+
+	//! map counter of the geometry when the map was built
+	size_t ctr = 0;
+
+	//! other parameters the map depends on (stencil and padding of the grid map, local and ghost size of the particle map)
+	std::vector<long int> ext;
+
+	template<typename ... Args>
+	row_map_data(Args && ... args)
+	:map(std::forward<Args>(args)...)
+	{}
+};
+
+/*! \brief Row map shared between the schemes built on the same grid or particle set
+ *
+ * A scheme constructed with a row_map reuse the numbering built by the previous scheme on the same geometry,
+ * skipping the communication of the offsets and the ghost_get of the map. The numbering is built again when the
+ * geometry changes: another grid or particle set, a map() of the particle set (its map counter), another number of
+ * local or ghost particles, another stencil.
+ *
+ * For a particle set the reuse is valid only while the particles have not moved since the numbering was built: the
+ * ghost of the numbering is the ghost at that time, and a ghost_get after a displacement (without map) can change the
+ * ghost particles and their order with the same counter and sizes. Call invalidate() after moving the particles
+ * (with SE_CLASS1 DCPSE_scheme checks the positions and reports it).
+ *
+ * \code
+ *
+ * row_map<DCPSE_scheme<equations2d1,vector_type>::p_map_type> rm;
+ *
+ * // at every time step
+ * DCPSE_scheme<equations2d2,vector_type> SolverVel(particles,rm);
+ * DCPSE_scheme<equations2d1,vector_type> SolverP(particles,rm);   // same numbering, nothing is communicated
+ *
+ * \endcode
+ *
+ * The schemes keep the numbering alive, the row_map can be destroyed before them
+ *
+ * \tparam map_type type of the map of the scheme (FD_scheme::g_map_type or DCPSE_scheme::p_map_type)
+ *
+ */
+template<typename map_type>
+class row_map
+{
+	//! last numbering built
+	std::shared_ptr<row_map_data<map_type>> data;
+
+	//! number of times the numbering was reused
+	size_t n_reuse = 0;
+
+public:
+
+	/*! \brief Return the numbering built on geom, or null if it must be built again
+	 *
+	 * \param geom grid or particle set
+	 * \param ctr its map counter
+	 * \param ext other parameters the numbering depends on
+	 *
+	 */
+	std::shared_ptr<row_map_data<map_type>> find(const void * geom, size_t ctr, const std::vector<long int> & ext = std::vector<long int>())
+	{
+		if (data && data->geom == geom && data->ctr == ctr && data->ext == ext)
+		{
+			n_reuse++;
+			return data;
+		}
+
+		return std::shared_ptr<row_map_data<map_type>>();
+	}
+
+	//! Store a numbering built by a scheme (the key is in the numbering)
+	void set(const std::shared_ptr<row_map_data<map_type>> & d)
+	{
+		data = d;
+	}
+
+	//! Drop the numbering, the next scheme build it again (for example after a redecomposition of a grid)
+	void invalidate()
+	{
+		data.reset();
+	}
+
+	//! Number of schemes that reused the numbering instead of building it
+	size_t getNReuse() const
+	{
+		return n_reuse;
+	}
+};
+
+#endif /* OPENFPM_NUMERICS_SRC_UTIL_ROW_MAP_HPP_ */
@@ -0,0 +1,366 @@
+/*
+ * task_graph.hpp
+ *
+ * Persistent thread pool and task graph to overlap the stages of a time step
+ */
+
+#ifndef OPENFPM_NUMERICS_SRC_UTIL_TASK_GRAPH_HPP_
+#define OPENFPM_NUMERICS_SRC_UTIL_TASK_GRAPH_HPP_
+
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <functional>
+#include <vector>
+#include <deque>
+#include <iostream>
+
+/*! \brief Pool of worker threads that live for the whole simulation
+ *
+ * The threads are created once and wait for work, so running a task graph at every time step does not pay the
+ * creation of the threads
+ *
+ */
+class task_graph_pool
+{
+	//! worker threads
+	std::vector<std::thread> workers;
+
+	//! tasks waiting for a worker
+	std::deque<std::function<void()>> queue;
+
+	//! protect the queue
+	std::mutex mtx;
+
+	//! signal a new task or the stop
+	std::condition_variable cv;
+
+	//! the pool is shutting down
+	bool stop = false;
+
+	//! loop of a worker thread
+	void work()
+	{
+		while (true)
+		{
+			std::function<void()> t;
+
+			{
+				std::unique_lock<std::mutex> lock(mtx);
+				cv.wait(lock,[this]{return stop || queue.size() != 0;});
+
+				if (stop && queue.size() == 0)
+					return;
+
+				t = std::move(queue.front());
+				queue.pop_front();
+			}
+
+			t();
+		}
+	}
+
+public:
+
+	/*! \brief Constructor
+	 *
+	 * \param n_threads number of worker threads (0 run every task on the thread of task_graph::run)
+	 *
+	 */
+	task_graph_pool(size_t n_threads)
+	{
+		for (size_t i = 0 ; i < n_threads ; i++)
+			workers.emplace_back(&task_graph_pool::work,this);
+	}
+
+	~task_graph_pool()
+	{
+		{
+			std::unique_lock<std::mutex> lock(mtx);
+			stop = true;
+		}
+		cv.notify_all();
+
+		for (size_t i = 0 ; i < workers.size() ; i++)
+			workers[i].join();
+	}
+
+	//! number of worker threads
+	size_t size() const
+	{
+		return workers.size();
+	}
+
+	//! Give a task to a worker
+	void submit(std::function<void()> t)
+	{
+		{
+			std::unique_lock<std::mutex> lock(mtx);
+			queue.push_back(std::move(t));
+		}
+		cv.notify_one();
+	}
+};
+
+/*! \brief Default pool of the task graphs, one worker for every hardware thread except the calling one
+ *
+ * \return the pool
+ *
+ */
+inline task_graph_pool & getTaskGraphPool()
+{
+	static task_graph_pool pool((std::thread::hardware_concurrency() > 1)?std::thread::hardware_concurrency() - 1:0);
+
+	return pool;
+}
+
+/*! \brief Data read or written by a stage of a task_graph
+ *
+ * It is an object (for example the particle set) and optionally one of its properties, prp = -1 means the
+ * whole object (it conflict with every property of the object)
+ *
+ */
+struct task_data
+{
+	//! object
+	const void * obj;
+
+	//! property, -1 for the whole object
+	int prp;
+
+	task_data(const void * obj, int prp = -1)
+	:obj(obj),prp(prp)
+	{}
+
+	//! Check if two data overlap
+	bool overlap(const task_data & d) const
+	{
+		return obj == d.obj && (prp == -1 || d.prp == -1 || prp == d.prp);
+	}
+};
+
+/*! \brief Get the task_data of the property prp of an object
+ *
+ * \param obj object (for example a vector_dist)
+ *
+ * \return the task_data
+ *
+ */
+template<unsigned int prp, typename T>
+inline task_data task_prop(const T & obj)
+{
+	return task_data(&obj,prp);
+}
+
+/*! \brief Graph of the stages of a time step
+ *
+ * Every stage declares the data it reads and writes, a stage start when the previous stages writing what it read or
+ * write, and reading what it write, are finished (the order of declaration is kept for the conflicting stages).
+ * Independent stages run concurrently on the workers of a persistent task_graph_pool.
+ *
+ * A stage that communicates (ghost_get, map, a solver, or any MPI call) must be declared with on_main = true: it run
+ * on the thread that call run(), and the main stages run in the order of declaration, so the collective calls are
+ * issued in the same order on all the processors. The graph can be run at every time step.
+ *
+ * \code{.cpp}
+
+   task_graph tg;
+
+   tg.addStage([&]{vd.template ghost_get<PHI>();},{},{task_prop<PHI>(vd)},true);
+   tg.addStage([&]{grad_phi = Grad(phi);},{task_prop<PHI>(vd)},{task_prop<GRAD>(vd)});
+   tg.addStage([&]{normals = grad_phi / norm(grad_phi);},{task_prop<GRAD>(vd)},{task_prop<NORMAL>(vd)});
+
+   // independent of the stages above, it run on a worker while the solver run on the main thread
+   tg.addStage([&]{Lap.update(vd2);},{},{task_data(&Lap)});
+   tg.addStage([&]{solver.solve(sol,b);},{task_data(&b)},{task_data(&sol)},true);
+
+   tg.run();
+
+ * \endcode
+ *
+ */
+class task_graph
+{
+	//! stage of the graph
+	struct stage
+	{
+		//! work of the stage
+		std::function<void()> f;
+
+		//! data read
+		std::vector<task_data> reads;
+
+		//! data written
+		std::vector<task_data> writes;
+
+		//! the stage must run on the thread of run()
+		bool on_main;
+
+		//! stages that depend on this stage
+		std::vector<size_t> next;
+
+		//! number of stages this stage depends on
+		size_t n_deps = 0;
+	};
+
+	//! stages
+	std::vector<stage> stages;
+
+	//! pool
+	task_graph_pool & pool;
+
+	//! Check if the stage j must run after the stage i (i < j)
+	bool conflict(const stage & i, const stage & j) const
+	{
+		if (i.on_main && j.on_main)
+			return true;
+
+		for (size_t a = 0 ; a < i.writes.size() ; a++)
+		{
+			for (size_t b = 0 ; b < j.reads.size() ; b++)
+				if (i.writes[a].overlap(j.reads[b])) return true;
+			for (size_t b = 0 ; b < j.writes.size() ; b++)
+				if (i.writes[a].overlap(j.writes[b])) return true;
+		}
+
+		for (size_t a = 0 ; a < i.reads.size() ; a++)
+		{
+			for (size_t b = 0 ; b < j.writes.size() ; b++)
+				if (i.reads[a].overlap(j.writes[b])) return true;
+		}
+
+		return false;
+	}
+
+public:
+
+	/*! \brief Constructor
+	 *
+	 * \param pool pool of worker threads
+	 *
+	 */
+	task_graph(task_graph_pool & pool = getTaskGraphPool())
+	:pool(pool)
+	{}
+
+	/*! \brief Add a stage
+	 *
+	 * \param f work of the stage
+	 * \param reads data read by the stage
+	 * \param writes data written by the stage
+	 * \param on_main run the stage on the thread of run() (required for the stages that communicate)
+	 *
+	 * \return the id of the stage
+	 *
+	 */
+	size_t addStage(std::function<void()> f, std::vector<task_data> reads, std::vector<task_data> writes, bool on_main = false)
+	{
+		stage s;
+		s.f = f;
+		s.reads = reads;
+		s.writes = writes;
+		s.on_main = on_main;
+
+		size_t id = stages.size();
+		stages.push_back(s);
+
+		for (size_t i = 0 ; i < id ; i++)
+		{
+			if (conflict(stages[i],stages[id]))
+			{
+				stages[i].next.push_back(id);
+				stages[id].n_deps++;
+			}
+		}
+
+		return id;
+	}
+
+	//! number of stages
+	size_t size() const
+	{
+		return stages.size();
+	}
+
+	//! Remove all the stages
+	void clear()
+	{
+		stages.clear();
+	}
+
+	//! Run all the stages, it return when all the stages are finished
+	void run()
+	{
+		std::mutex mtx;
+		std::condition_variable cv;
+
+		std::vector<size_t> n_deps(stages.size());
+		for (size_t i = 0 ; i < stages.size() ; i++)
+			n_deps[i] = stages[i].n_deps;
+
+		// main stages ready, in order of declaration
+		std::deque<size_t> main_ready;
+		size_t n_done = 0;
+
+		std::function<void(size_t)> launch;
+
+		// called with mtx locked when the stage i is finished
+		auto finished = [&](size_t i)
+		{
+			n_done++;
+
+			for (size_t k = 0 ; k < stages[i].next.size() ; k++)
+			{
+				size_t j = stages[i].next[k];
+				if (--n_deps[j] == 0)
+					launch(j);
+			}
+
+			cv.notify_all();
+		};
+
+		// called with mtx locked when the stage i is ready
+		launch = [&](size_t i)
+		{
+			if (stages[i].on_main || pool.size() == 0)
+			{
+				main_ready.push_back(i);
+				return;
+			}
+
+			pool.submit([&,i]{
+				stages[i].f();
+
+				std::unique_lock<std::mutex> lock(mtx);
+				finished(i);
+			});
+		};
+
+		std::unique_lock<std::mutex> lock(mtx);
+
+		for (size_t i = 0 ; i < stages.size() ; i++)
+		{
+			if (n_deps[i] == 0)
+				launch(i);
+		}
+
+		while (n_done != stages.size())
+		{
+			cv.wait(lock,[&]{return main_ready.size() != 0 || n_done == stages.size();});
+
+			if (main_ready.size() != 0)
+			{
+				size_t i = main_ready.front();
+				main_ready.pop_front();
+
+				lock.unlock();
+				stages[i].f();
+				lock.lock();
+
+				finished(i);
+			}
+		}
+	}
+};
+
+#endif /* OPENFPM_NUMERICS_SRC_UTIL_TASK_GRAPH_HPP_ */
@@ -0,0 +1,563 @@
+/*
+ * trace_span.hpp
+ *
+ * Scoped tracing spans of the numerics stages, exported as Chrome trace JSON or OTF2
+ */
+
+#ifndef OPENFPM_NUMERICS_SRC_UTIL_TRACE_SPAN_HPP_
+#define OPENFPM_NUMERICS_SRC_UTIL_TRACE_SPAN_HPP_
+
+#include <chrono>
+#include <fstream>
+#include <iostream>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <sstream>
+#include <string>
+#include <vector>
+#include <algorithm>
+#include <mpi.h>
+
+#ifdef OPENFPM_NUMERICS_TRACE_PAPI
+#include <papi.h>
+#include <pthread.h>
+#endif
+
+#ifdef HAVE_OTF2
+#include <otf2/otf2.h>
+#endif
+
+//! A closed span
+struct trace_event
+{
+	//! name of the span (a string literal)
+	const char * name;
+
+	//! start in nanoseconds from the origin of the trace
+	long int start;
+
+	//! end in nanoseconds from the origin of the trace
+	long int end;
+
+	//! double precision floating point operations in the span (-1 if not counted)
+	long long int flops;
+
+	//! bytes moved from the memory in the span, estimated from the last level cache misses (-1 if not counted)
+	long long int bytes;
+};
+
+//! Spans of a thread
+struct trace_thread_buffer
+{
+	//! id of the thread in the trace
+	int tid;
+
+	//! closed spans
+	std::vector<trace_event> events;
+
+#ifdef OPENFPM_NUMERICS_TRACE_PAPI
+	//! PAPI event set of the thread (PAPI_DP_OPS, PAPI_L3_TCM)
+	int event_set = PAPI_NULL;
+
+	//! the event set is running
+	bool counting = false;
+#endif
+};
+
+/*! \brief Recorder of the spans of this processor
+ *
+ * Every thread records its spans in its own buffer, the buffers are merged only when the trace is written. The
+ * spans are created with NUMERICS_TRACE_SPAN("name"), which expands to nothing if OPENFPM_NUMERICS_TRACE is not
+ * defined, so the tracing has no cost when disabled. With OPENFPM_NUMERICS_TRACE_PAPI every span also counts the
+ * double precision FLOPs and the last level cache misses (converted in bytes with a 64 bytes line) with PAPI.
+ *
+ * \code{.cpp}
+
+   // compiled with -DOPENFPM_NUMERICS_TRACE
+   numerics_trace::get().reset();
+
+   for (size_t i = 0 ; i < n_steps ; i++)
+   {
+       NUMERICS_TRACE_SPAN("time_step");
+       ...
+   }
+
+   // one file with the spans of all the processors (pid is the rank)
+   numerics_trace::get().write_chrome_trace("trace.json");
+
+ * \endcode
+ *
+ */
+class numerics_trace
+{
+	//! buffers of the threads
+	std::vector<std::unique_ptr<trace_thread_buffer>> buffers;
+
+	//! protect the registration of the threads
+	std::mutex mtx;
+
+	//! origin of the time stamps
+	std::chrono::steady_clock::time_point origin;
+
+	numerics_trace()
+	:origin(std::chrono::steady_clock::now())
+	{
+#ifdef OPENFPM_NUMERICS_TRACE_PAPI
+		if (PAPI_is_initialized() == PAPI_NOT_INITED)
+		{
+			if (PAPI_library_init(PAPI_VER_CURRENT) != PAPI_VER_CURRENT)
+			{std::cerr << __FILE__ << ":" << __LINE__ << " error PAPI initialization failed, the spans are not counted" << std::endl;}
+			else
+			{PAPI_thread_init(pthread_self);}
+		}
+#endif
+	}
+
+	//! rank of this processor (0 if MPI is not initialized)
+	static int rank()
+	{
+		int init;
+		MPI_Initialized(&init);
+
+		int r = 0;
+		if (init)
+		{MPI_Comm_rank(MPI_COMM_WORLD,&r);}
+
+		return r;
+	}
+
+	//! Escape a name for JSON
+	static std::string json_escape(const char * s)
+	{
+		std::string out;
+		for ( ; *s != 0 ; s++)
+		{
+			if (*s == '"' || *s == '\\')
+			{out += '\\';}
+			out += *s;
+		}
+
+		return out;
+	}
+
+	//! Spans of this processor in Chrome trace format, one event per line
+	std::string chrome_events()
+	{
+		std::lock_guard<std::mutex> lock(mtx);
+		int r = rank();
+
+		std::ostringstream out;
+		for (size_t i = 0 ; i < buffers.size() ; i++)
+		{
+			for (size_t j = 0 ; j < buffers[i]->events.size() ; j++)
+			{
+				const trace_event & e = buffers[i]->events[j];
+
+				out << "{\"name\":\"" << json_escape(e.name) << "\",\"cat\":\"numerics\",\"ph\":\"X\""
+				    << ",\"ts\":" << e.start / 1000.0 << ",\"dur\":" << (e.end - e.start) / 1000.0
+				    << ",\"pid\":" << r << ",\"tid\":" << buffers[i]->tid;
+
+				if (e.flops >= 0)
+				{out << ",\"args\":{\"flops\":" << e.flops << ",\"bytes\":" << e.bytes << "}";}
+
+				out << "},\n";
+			}
+		}
+
+		return out.str();
+	}
+
+public:
+
+	//! The recorder of this processor
+	static numerics_trace & get()
+	{
+		static numerics_trace trace;
+
+		return trace;
+	}
+
+	//! Buffer of the calling thread, registered at the first call
+	trace_thread_buffer & thread_buffer()
+	{
+		thread_local trace_thread_buffer * buf = NULL;
+
+		if (buf == NULL)
+		{
+			std::lock_guard<std::mutex> lock(mtx);
+
+			buffers.emplace_back(new trace_thread_buffer);
+			buf = buffers.back().get();
+			buf->tid = buffers.size() - 1;
+
+#ifdef OPENFPM_NUMERICS_TRACE_PAPI
+			if (PAPI_is_initialized() != PAPI_NOT_INITED &&
+			    PAPI_create_eventset(&buf->event_set) == PAPI_OK &&
+			    PAPI_add_event(buf->event_set,PAPI_DP_OPS) == PAPI_OK &&
+			    PAPI_add_event(buf->event_set,PAPI_L3_TCM) == PAPI_OK &&
+			    PAPI_start(buf->event_set) == PAPI_OK)
+			{buf->counting = true;}
+#endif
+		}
+
+		return *buf;
+	}
+
+	//! nanoseconds from the origin
+	long int now() const
+	{
+		return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - origin).count();
+	}
+
+	/*! \brief Read the counters of the calling thread
+	 *
+	 * \param buf buffer of the thread
+	 * \param flops double precision FLOPs
+	 * \param bytes bytes from the memory
+	 *
+	 */
+	static void counters(trace_thread_buffer & buf, long long int & flops, long long int & bytes)
+	{
+		flops = -1;
+		bytes = -1;
+
+#ifdef OPENFPM_NUMERICS_TRACE_PAPI
+		long long int cnt[2];
+		if (buf.counting == true && PAPI_read(buf.event_set,cnt) == PAPI_OK)
+		{
+			flops = cnt[0];
+			bytes = cnt[1] * 64;
+		}
+#endif
+	}
+
+	/*! \brief Drop the recorded spans and restart the time
+	 *
+	 * It is collective if MPI is initialized, the processors start together so that their spans are aligned
+	 *
+	 */
+	void reset()
+	{
+		int init;
+		MPI_Initialized(&init);
+
+		if (init)
+		{MPI_Barrier(MPI_COMM_WORLD);}
+
+		std::lock_guard<std::mutex> lock(mtx);
+
+		for (size_t i = 0 ; i < buffers.size() ; i++)
+		{buffers[i]->events.clear();}
+
+		origin = std::chrono::steady_clock::now();
+	}
+
+	//! number of spans recorded on this processor
+	size_t size()
+	{
+		std::lock_guard<std::mutex> lock(mtx);
+
+		size_t n = 0;
+		for (size_t i = 0 ; i < buffers.size() ; i++)
+		{n += buffers[i]->events.size();}
+
+		return n;
+	}
+
+	/*! \brief Total time and number of the spans with a name on this processor
+	 *
+	 * \param name name of the span
+	 * \param count number of spans
+	 *
+	 * \return the total time in seconds
+	 *
+	 */
+	double total(const std::string & name, size_t & count)
+	{
+		std::lock_guard<std::mutex> lock(mtx);
+
+		double t = 0.0;
+		count = 0;
+		for (size_t i = 0 ; i < buffers.size() ; i++)
+		{
+			for (size_t j = 0 ; j < buffers[i]->events.size() ; j++)
+			{
+				const trace_event & e = buffers[i]->events[j];
+				if (name == e.name)
+				{
+					t += (e.end - e.start) * 1e-9;
+					count++;
+				}
+			}
+		}
+
+		return t;
+	}
+
+	/*! \brief Call f(buf) for the spans of every thread of this processor
+	 *
+	 * \param f function that receive a const trace_thread_buffer &
+	 *
+	 */
+	template<typename lambda_type>
+	void for_each_thread(lambda_type f)
+	{
+		std::lock_guard<std::mutex> lock(mtx);
+
+		for (size_t i = 0 ; i < buffers.size() ; i++)
+		{f((const trace_thread_buffer &)*buffers[i]);}
+	}
+
+	/*! \brief Write the spans of all the processors in one Chrome trace JSON file (chrome://tracing, Perfetto)
+	 *
+	 * It is collective if MPI is initialized, the file is written by the processor 0 and the pid of the spans is
+	 * the rank
+	 *
+	 * \param file output file
+	 *
+	 */
+	void write_chrome_trace(const std::string & file)
+	{
+		std::string local = chrome_events();
+
+		int init;
+		MPI_Initialized(&init);
+
+		int r = 0;
+		int n_proc = 1;
+		if (init)
+		{
+			MPI_Comm_rank(MPI_COMM_WORLD,&r);
+			MPI_Comm_size(MPI_COMM_WORLD,&n_proc);
+		}
+
+		std::string all;
+		if (n_proc == 1)
+		{all.swap(local);}
+		else
+		{
+			int sz = local.size();
+			std::vector<int> sizes(n_proc);
+			MPI_Gather(&sz,1,MPI_INT,sizes.data(),1,MPI_INT,0,MPI_COMM_WORLD);
+
+			std::vector<int> displs(n_proc,0);
+			if (r == 0)
+			{
+				for (int i = 1 ; i < n_proc ; i++)
+				{displs[i] = displs[i-1] + sizes[i-1];}
+
+				all.resize(displs[n_proc-1] + sizes[n_proc-1]);
+			}
+
+			MPI_Gatherv(&local[0],sz,MPI_CHAR,&all[0],sizes.data(),displs.data(),MPI_CHAR,0,MPI_COMM_WORLD);
+		}
+
+		if (r != 0)
+		{return;}
+
+		// remove the comma of the last event
+		if (all.size() >= 2)
+		{all.resize(all.size() - 2);}
+
+		std::ofstream out(file);
+		if (!out)
+		{
+			std::cerr << __FILE__ << ":" << __LINE__ << " error cannot open " << file << std::endl;
+			return;
+		}
+
+		out << "{\"traceEvents\":[\n" << all << "\n],\"displayTimeUnit\":\"ms\"}\n";
+	}
+
+#ifdef HAVE_OTF2
+
+	/*! \brief Write the spans of this processor in an OTF2 archive (Vampir, Score-P tools)
+	 *
+	 * Every processor writes its own archive path/name_<rank>, one location for every thread
+	 *
+	 * \param path directory of the archives
+	 * \param name name of the archive
+	 *
+	 */
+	void write_otf2(const std::string & path, const std::string & name)
+	{
+		std::lock_guard<std::mutex> lock(mtx);
+		int r = rank();
+
+		std::string archive_name = name + "_" + std::to_string(r);
+
+		OTF2_Archive * archive = OTF2_Archive_Open(path.c_str(),archive_name.c_str(),OTF2_FILEMODE_WRITE,1024*1024,4*1024*1024,OTF2_SUBSTRATE_POSIX,OTF2_COMPRESSION_NONE);
+		if (archive == NULL)
+		{
+			std::cerr << __FILE__ << ":" << __LINE__ << " error cannot open the OTF2 archive " << path << "/" << archive_name << std::endl;
+			return;
+		}
+
+		OTF2_FlushCallbacks flush_callbacks;
+		flush_callbacks.otf2_pre_flush = otf2_pre_flush;
+		flush_callbacks.otf2_post_flush = otf2_post_flush;
+		OTF2_Archive_SetFlushCallbacks(archive,&flush_callbacks,NULL);
+		OTF2_Archive_SetSerialCollectiveCallbacks(archive);
+
+		// regions, one for every name
+		std::map<std::string,uint32_t> regions;
+		long int t_min = 0;
+		long int t_max = 0;
+
+		OTF2_Archive_OpenEvtFiles(archive);
+
+		std::vector<uint64_t> n_events(buffers.size());
+		for (size_t i = 0 ; i < buffers.size() ; i++)
+		{
+			// the spans of a thread are nested, sorted by start (the outer first) they are closed with a stack
+			std::vector<trace_event> ev = buffers[i]->events;
+			std::sort(ev.begin(),ev.end(),[](const trace_event & a, const trace_event & b)
+			                              {return a.start < b.start || (a.start == b.start && a.end > b.end);});
+
+			OTF2_EvtWriter * w = OTF2_Archive_GetEvtWriter(archive,i);
+			std::vector<std::pair<long int,uint32_t>> open;
+
+			for (size_t j = 0 ; j < ev.size() ; j++)
+			{
+				while (open.size() != 0 && open.back().first <= ev[j].start)
+				{
+					OTF2_EvtWriter_Leave(w,NULL,open.back().first,open.back().second);
+					open.pop_back();
+					n_events[i]++;
+				}
+
+				auto it = regions.find(ev[j].name);
+				if (it == regions.end())
+				{it = regions.insert(std::make_pair(std::string(ev[j].name),(uint32_t)regions.size())).first;}
+
+				OTF2_EvtWriter_Enter(w,NULL,ev[j].start,it->second);
+				open.push_back(std::make_pair(ev[j].end,it->second));
+				n_events[i]++;
+
+				t_max = std::max(t_max,ev[j].end);
+			}
+
+			while (open.size() != 0)
+			{
+				OTF2_EvtWriter_Leave(w,NULL,open.back().first,open.back().second);
+				open.pop_back();
+				n_events[i]++;
+			}
+
+			OTF2_Archive_CloseEvtWriter(archive,w);
+		}
+
+		OTF2_Archive_CloseEvtFiles(archive);
+
+		OTF2_Archive_OpenDefFiles(archive);
+		for (size_t i = 0 ; i < buffers.size() ; i++)
+		{
+			OTF2_DefWriter * dw = OTF2_Archive_GetDefWriter(archive,i);
+			OTF2_Archive_CloseDefWriter(archive,dw);
+		}
+		OTF2_Archive_CloseDefFiles(archive);
+
+		OTF2_GlobalDefWriter * gw = OTF2_Archive_GetGlobalDefWriter(archive);
+		OTF2_GlobalDefWriter_WriteClockProperties(gw,1000000000,t_min,t_max - t_min + 1);
+
+		// strings: 0 empty, 1 node, 2 process, then the regions and the threads
+		uint32_t str = 0;
+		OTF2_GlobalDefWriter_WriteString(gw,str++,"");
+		OTF2_GlobalDefWriter_WriteString(gw,str++,"node");
+		OTF2_GlobalDefWriter_WriteString(gw,str++,("rank " + std::to_string(r)).c_str());
+
+		for (auto it = regions.begin() ; it != regions.end() ; ++it)
+		{
+			OTF2_GlobalDefWriter_WriteString(gw,str,it->first.c_str());
+			OTF2_GlobalDefWriter_WriteRegion(gw,it->second,str,str,str,OTF2_REGION_ROLE_FUNCTION,OTF2_PARADIGM_USER,OTF2_REGION_FLAG_NONE,0,0,0);
+			str++;
+		}
+
+		OTF2_GlobalDefWriter_WriteSystemTreeNode(gw,0,1,1,OTF2_UNDEFINED_SYSTEM_TREE_NODE);
+		OTF2_GlobalDefWriter_WriteLocationGroup(gw,0,2,OTF2_LOCATION_GROUP_TYPE_PROCESS,0);
+
+		for (size_t i = 0 ; i < buffers.size() ; i++)
+		{
+			OTF2_GlobalDefWriter_WriteString(gw,str,("thread " + std::to_string(i)).c_str());
+			OTF2_GlobalDefWriter_WriteLocation(gw,i,str,OTF2_LOCATION_TYPE_CPU_THREAD,n_events[i],0);
+			str++;
+		}
+
+		OTF2_Archive_CloseGlobalDefWriter(archive,gw);
+		OTF2_Archive_Close(archive);
+	}
+
+private:
+
+	//! the buffers are flushed when full
+	static OTF2_FlushType otf2_pre_flush(void * userData, OTF2_FileType fileType, OTF2_LocationRef location, void * callerData, bool final)
+	{
+		return OTF2_FLUSH;
+	}
+
+	//! time stamp of the flush
+	static OTF2_TimeStamp otf2_post_flush(void * userData, OTF2_FileType fileType, OTF2_LocationRef location)
+	{
+		return get().now();
+	}
+
+#endif
+};
+
+/*! \brief Span of a stage, recorded from the construction to the destruction
+ *
+ * Use the macro NUMERICS_TRACE_SPAN, the span exists only when the tracing is enabled
+ *
+ */
+class trace_span
+{
+	//! buffer of the thread
+	trace_thread_buffer & buf;
+
+	//! the span
+	trace_event e;
+
+public:
+
+	/*! \brief Open the span
+	 *
+	 * \param name name of the span, it must be a string literal (it is stored as a pointer)
+	 *
+	 */
+	trace_span(const char * name)
+	:buf(numerics_trace::get().thread_buffer())
+	{
+		e.name = name;
+		numerics_trace::counters(buf,e.flops,e.bytes);
+		e.start = numerics_trace::get().now();
+	}
+
+	//! Close the span
+	~trace_span()
+	{
+		e.end = numerics_trace::get().now();
+
+		long long int flops;
+		long long int bytes;
+		numerics_trace::counters(buf,flops,bytes);
+		if (e.flops >= 0)
+		{
+			e.flops = flops - e.flops;
+			e.bytes = bytes - e.bytes;
+		}
+
+		buf.events.push_back(e);
+	}
+};
+
+#define NUMERICS_TRACE_CAT_(a,b) a ## b
+#define NUMERICS_TRACE_CAT(a,b) NUMERICS_TRACE_CAT_(a,b)
+
+#ifdef OPENFPM_NUMERICS_TRACE
+#define NUMERICS_TRACE_SPAN(name) trace_span NUMERICS_TRACE_CAT(trace_span_,__LINE__)(name)
+#else
+#define NUMERICS_TRACE_SPAN(name)
+#endif
+
+#endif /* OPENFPM_NUMERICS_SRC_UTIL_TRACE_SPAN_HPP_ */
@@ -9,6 +9,10 @@
 #define OPENFPM_NUMERICS_SRC_UTIL_UTIL_NUM_UNIT_TESTS_HPP_
 
 #include "util_num.hpp"
+#include "SphericalHarmonics.hpp"
+#include "task_graph.hpp"
+#include "trace_span.hpp"
+#include <thread>
 
 //! [Constant fields struct definition]
 
@@ -103,6 +107,146 @@ BOOST_AUTO_TEST_CASE( util_num )
 	//! [Usage of stub_or_real]
 }
 
+BOOST_AUTO_TEST_CASE( spherical_harmonics_batch )
+{
+	const int K = 12;
+
+	openfpm::math::SphericalHarmonicsBatch<double> sph(K);
+
+	double theta[] = {0.3,1.1,2.7,1.5707963};
+	double phi[] = {-2.9,0.2,1.3,3.0};
+
+	std::vector<double> Y(4*sph.size()), dT(4*sph.size()), dP(4*sph.size());
+	sph.eval(4,theta,phi,Y.data(),dT.data(),dP.data());
+
+	double err = 0.0;
+	for (size_t p = 0 ; p < 4 ; p++)
+	{
+		for (int l = 0 ; l <= K ; l++)
+		{
+			for (int m = -l ; m <= l ; m++)
+			{
+				size_t i = p*sph.size() + openfpm::math::sph_index(l,m);
+
+				err = std::max(err,fabs(Y[i] - openfpm::math::Y(l,m,theta[p],phi[p])));
+				err = std::max(err,fabs(dT[i] - openfpm::math::DYdTheta(l,m,theta[p],phi[p])));
+				err = std::max(err,fabs(dP[i] - openfpm::math::DYdPhi(l,m,theta[p],phi[p])));
+			}
+		}
+	}
+
+	BOOST_REQUIRE(err < 1e-12);
+
+	// the summation with the dictionary and with the contiguous amplitudes give the same result
+	std::unordered_map<const lm,double,key_hash,key_equal> Vr, V1, V2;
+	for (int l = 0 ; l <= K ; l++)
+	{
+		for (int m = -l ; m <= l ; m++)
+		{
+			Vr[std::make_tuple(l,m)] = 0.1*l - 0.03*m;
+			V1[std::make_tuple(l,m)] = 0.2;
+			V2[std::make_tuple(l,m)] = 0.01*m;
+		}
+	}
+
+	std::vector<double> s1 = openfpm::math::sumY<K>(1.0,0.7,0.4,Vr,V1,V2);
+	std::vector<double> s2 = openfpm::math::sumY<K>(1.0,0.7,0.4,openfpm::math::sph_coefficients(Vr,K),
+	                                                openfpm::math::sph_coefficients(V1,K),openfpm::math::sph_coefficients(V2,K));
+
+	for (size_t i = 0 ; i < 3 ; i++)
+		BOOST_REQUIRE_CLOSE(s1[i],s2[i],1e-10);
+
+	double y1 = openfpm::math::sumY_Scalar<K>(1.0,0.7,0.4,Vr);
+	double y2 = openfpm::math::sumY_Scalar<K>(1.0,0.7,0.4,openfpm::math::sph_coefficients(Vr,K));
+	BOOST_REQUIRE_CLOSE(y1,y2,1e-10);
+}
+
+BOOST_AUTO_TEST_CASE( task_graph_dependencies )
+{
+	task_graph_pool pool(2);
+
+	std::thread::id main_id = std::this_thread::get_id();
+	bool on_main = true;
+
+	int a = 0, b = 0, c = 0, d = 0;
+
+	for (size_t rep = 0 ; rep < 100 ; rep++)
+	{
+		a = b = c = d = 0;
+
+		task_graph tg(pool);
+
+		// a -> b -> c with c on the main thread, d independent
+		tg.addStage([&]{a = 1; on_main &= (std::this_thread::get_id() == main_id);},{},{task_data(&a)},true);
+		tg.addStage([&]{b = a + 1;},{task_data(&a)},{task_data(&b)});
+		tg.addStage([&]{d = 7;},{},{task_data(&d)});
+		tg.addStage([&]{c = 10*b + d*0; on_main &= (std::this_thread::get_id() == main_id);},{task_data(&b)},{task_data(&c)},true);
+
+		BOOST_REQUIRE_EQUAL(tg.size(),4ul);
+
+		tg.run();
+
+		BOOST_REQUIRE_EQUAL(a,1);
+		BOOST_REQUIRE_EQUAL(b,2);
+		BOOST_REQUIRE_EQUAL(c,20);
+		BOOST_REQUIRE_EQUAL(d,7);
+	}
+
+	BOOST_REQUIRE_EQUAL(on_main,true);
+
+	// different properties of the same object do not conflict, the whole object conflict with all of them
+	int obj;
+	BOOST_REQUIRE_EQUAL(task_data(&obj,0).overlap(task_data(&obj,1)),false);
+	BOOST_REQUIRE_EQUAL(task_data(&obj,0).overlap(task_data(&obj)),true);
+}
+
+BOOST_AUTO_TEST_CASE( trace_span_test )
+{
+	auto & trace = numerics_trace::get();
+	trace.reset();
+
+	// the spans are used directly, NUMERICS_TRACE_SPAN is empty if OPENFPM_NUMERICS_TRACE is not defined
+	for (size_t i = 0 ; i < 3 ; i++)
+	{
+		trace_span outer("test.outer");
+
+		{
+			trace_span inner("test.inner");
+			std::this_thread::sleep_for(std::chrono::milliseconds(1));
+		}
+	}
+
+	BOOST_REQUIRE_EQUAL(trace.size(),6ul);
+
+	size_t n_outer;
+	size_t n_inner;
+	double t_outer = trace.total("test.outer",n_outer);
+	double t_inner = trace.total("test.inner",n_inner);
+
+	BOOST_REQUIRE_EQUAL(n_outer,3ul);
+	BOOST_REQUIRE_EQUAL(n_inner,3ul);
+	BOOST_REQUIRE(t_inner >= 0.003);
+	BOOST_REQUIRE(t_outer >= t_inner);
+
+	trace.write_chrome_trace("trace_span_test.json");
+
+	int rank;
+	MPI_Comm_rank(MPI_COMM_WORLD,&rank);
+
+	if (rank == 0)
+	{
+		std::ifstream in("trace_span_test.json");
+		std::string json((std::istreambuf_iterator<char>(in)),std::istreambuf_iterator<char>());
+
+		BOOST_REQUIRE(json.find("\"traceEvents\"") != std::string::npos);
+		BOOST_REQUIRE(json.find("\"name\":\"test.inner\"") != std::string::npos);
+		BOOST_REQUIRE(json.find("},\n]") == std::string::npos);
+	}
+
+	trace.reset();
+	BOOST_REQUIRE_EQUAL(trace.size(),0ul);
+}
+
 BOOST_AUTO_TEST_SUITE_END()
 
 #endif /* OPENFPM_NUMERICS_SRC_UTIL_UTIL_NUM_UNIT_TESTS_HPP_ */